@@ -25,7 +25,7 @@ import zipfile
 from dataclasses import asdict
 from typing import BinaryIO, Dict, List, Optional, TextIO
 
-from common.benchmark_definition import CompilationInfo, CompilationResults, CompilationStatistics, ModuleComponentSizes, get_git_commit_hash
+from common.benchmark_definition import CompilationInfo, CompilationProfile, CompilationResults, CompilationStatistics, ModuleComponentSizes, get_git_commit_hash
 from common.benchmark_suite import BenchmarkSuite
 from common import benchmark_config
 from e2e_test_artifacts import iree_artifacts
@@ -119,6 +119,30 @@ def get_module_component_info(module: BinaryIO,
       total_dispatch_component_bytes=total_dispatch_component_bytes)
 
 
+def get_compilation_profile(profile_file: TextIO,
+                            top_pass_count: int = 10) -> CompilationProfile:
+  """Summarizes the profile written by iree-compile with
+  --iree-compile-profile-file.
+  """
+  profile = json.load(profile_file)
+  # Passes are sorted by self time in the profile.
+  top_pass_self_time_ms = dict(
+      (p["name"], int(round(p["self_seconds"] * 1000)))
+      for p in profile["passes"][:top_pass_count])
+  executable_pass_wall_time_ms = {}
+  executable_pass_parallelism = {}
+  for executable_pass in profile["executable_passes"]:
+    name = executable_pass["name"]
+    executable_pass_wall_time_ms[name] = int(
+        round(executable_pass["wall_seconds"] * 1000))
+    executable_pass_parallelism[name] = executable_pass["parallelism"]
+  return CompilationProfile(
+      peak_memory_bytes=profile["peak_memory_bytes"],
+      top_pass_self_time_ms=top_pass_self_time_ms,
+      executable_pass_wall_time_ms=executable_pass_wall_time_ms,
+      executable_pass_parallelism=executable_pass_parallelism)
+
+
 def get_module_path(flag_file: TextIO) -> Optional[str]:
   """Retrieve the module path for compilation statistics from the flag file."""
 
@@ -289,10 +313,18 @@ def main(args: argparse.Namespace):
       raise RuntimeError(
           f"Module path isn't a module cmake target: {module_path}")
     compilation_time_ms = target_build_time_map[cmake_target]
+
+    compilation_profile = None
+    profile_path = module_path.with_name(iree_artifacts.COMPILE_PROFILE_FILENAME)
+    if profile_path.exists():
+      with profile_path.open("r") as profile_file:
+        compilation_profile = get_compilation_profile(profile_file)
+
     compilation_statistics = CompilationStatistics(
         compilation_info=compilation_info,
         module_component_sizes=module_component_sizes,
-        compilation_time_ms=compilation_time_ms)
+        compilation_time_ms=compilation_time_ms,
+        compilation_profile=compilation_profile)
     compilation_statistics_list.append(compilation_statistics)
 
   commit = get_git_commit_hash("HEAD")
@@ -85,6 +85,36 @@ class CollectCompilationStatistics(unittest.TestCase):
         RuntimeError, lambda: get_module_component_info(
             BytesIO(module_file_data), len(module_file_data)))
 
+  def test_get_compilation_profile(self):
+    profile_file = StringIO(
+        json.dumps({
+            "total_seconds": 3.0,
+            "peak_memory_bytes": 1024,
+            "passes": [{
+                "name": "TranslateExecutablesPass",
+                "self_seconds": 2.0
+            }, {
+                "name": "CSE",
+                "self_seconds": 0.5
+            }],
+            "executable_passes": [{
+                "name": "TranslateExecutablesPass",
+                "wall_seconds": 1.5,
+                "parallelism": 3.5
+            }]
+        }))
+
+    profile = collect_compilation_statistics.get_compilation_profile(
+        profile_file, top_pass_count=1)
+
+    self.assertEqual(
+        profile,
+        common.benchmark_definition.CompilationProfile(
+            peak_memory_bytes=1024,
+            top_pass_self_time_ms={"TranslateExecutablesPass": 2000},
+            executable_pass_wall_time_ms={"TranslateExecutablesPass": 1500},
+            executable_pass_parallelism={"TranslateExecutablesPass": 3.5}))
+
   def test_get_module_path(self):
     flag_file = StringIO(f"--module=/abcd.vmfb\n--inputs=1x2x3xf32")
 
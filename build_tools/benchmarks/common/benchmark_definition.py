@@ -526,6 +526,26 @@ class ModuleComponentSizes(object):
     return ModuleComponentSizes(**json_object)
 
 
+@dataclass(frozen=True)
+class CompilationProfile(object):
+  """Summary of the profile written by iree-compile with
+  --iree-compile-profile-file.
+  """
+  # Peak resident memory of the compiler in bytes.
+  peak_memory_bytes: int
+  # Self time in ms of the passes taking the most time keyed by pass name.
+  top_pass_self_time_ms: Dict[str, int]
+  # Wall time in ms of each pass run on executables keyed by pass name.
+  executable_pass_wall_time_ms: Dict[str, int]
+  # Average number of executables processed concurrently by each pass run on
+  # executables keyed by pass name.
+  executable_pass_parallelism: Dict[str, float]
+
+  @staticmethod
+  def from_json_object(json_object: Dict[str, Any]):
+    return CompilationProfile(**json_object)
+
+
 @dataclass(frozen=True)
 class CompilationStatistics(object):
   compilation_info: CompilationInfo
@@ -533,15 +553,21 @@ class CompilationStatistics(object):
   module_component_sizes: ModuleComponentSizes
   # Module compilation time in ms.
   compilation_time_ms: int
+  # Compile-time profile if the module was compiled with profiling.
+  compilation_profile: Optional[CompilationProfile] = None
 
   @staticmethod
   def from_json_object(json_object: Dict[str, Any]):
+    compilation_profile = json_object.get("compilation_profile")
     return CompilationStatistics(
         compilation_info=CompilationInfo.from_json_object(
             json_object["compilation_info"]),
         module_component_sizes=ModuleComponentSizes.from_json_object(
             json_object["module_component_sizes"]),
-        compilation_time_ms=json_object["compilation_time_ms"])
+        compilation_time_ms=json_object["compilation_time_ms"],
+        compilation_profile=(None if compilation_profile is None else
+                             CompilationProfile.from_json_object(
+                                 compilation_profile)))
 
 
 @dataclass(frozen=True)
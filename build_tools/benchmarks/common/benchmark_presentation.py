@@ -30,6 +30,7 @@ BENCHMARK_RESULTS_HEADERS = [
 COMPILATION_TIME_SERIES_SUFFIX = "compilation:module:compilation-time"
 TOTAL_DISPATCH_SIZE_SERIES_SUFFIX = "compilation:module:component-size:total-dispatch-size"
 TOTAL_ARTIFACT_SIZE_SERIES_SUFFIX = "compilation:module:total-artifact-size"
+PEAK_MEMORY_SERIES_SUFFIX = "compilation:module:peak-memory"
 
 
 @dataclass
@@ -52,6 +53,9 @@ class CompilationMetrics:
   base_compilation_time_ms: Optional[int] = None
   base_total_artifact_bytes: Optional[int] = None
   base_total_dispatch_component_bytes: Optional[int] = None
+  # Peak memory of the compiler if the module was compiled with profiling. Not
+  # compared against the base as older commits don't have it.
+  peak_memory_bytes: Optional[int] = None
 
 
 T = TypeVar("T")
@@ -270,13 +274,16 @@ def collect_all_compilation_metrics(
 
     for compile_stats in file_results.compilation_statistics:
       component_sizes = compile_stats.module_component_sizes
+      compilation_profile = compile_stats.compilation_profile
       name = str(compile_stats.compilation_info)
       compile_metrics[name] = CompilationMetrics(
           compilation_info=compile_stats.compilation_info,
           compilation_time_ms=compile_stats.compilation_time_ms,
           total_artifact_bytes=component_sizes.file_bytes,
           total_dispatch_component_bytes=component_sizes.
-          total_dispatch_component_bytes)
+          total_dispatch_component_bytes,
+          peak_memory_bytes=(None if compilation_profile is None else
+                             compilation_profile.peak_memory_bytes))
 
   return compile_metrics
 
@@ -0,0 +1,254 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Utils for detecting noisy benchmark runs on Linux hosts.
+
+A benchmark is run in rounds of Google Benchmark repetitions. The CPU
+frequency policy and thermal state of the host is sampled around each round
+and rounds are repeated until the confidence interval of the mean latency is
+tight enough. Results are flagged as unstable when the state of the host
+changed during a round or the interval never tightened.
+"""
+
+from dataclasses import dataclass, field
+import pathlib
+import statistics
+from typing import Any, Dict, List, Optional, Sequence
+
+# Two-sided 95% critical values of the Student's t-distribution indexed by
+# degrees of freedom. Larger degrees of freedom use the normal value.
+_T_CRITICAL_VALUES_95 = [
+    float("inf"), 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+    2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+    2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+]
+_Z_CRITICAL_VALUE_95 = 1.960
+
+# Aggregates reported by Google Benchmark for repeated runs.
+_AGGREGATE_NAMES = ["mean", "median", "stddev", "cv"]
+
+
+@dataclass
+class LinuxSystemState(object):
+  """Snapshot of the frequency policy and thermal state of a Linux host.
+
+  - scaling_governors: the cpufreq governor keyed by CPU index.
+  - scaling_max_freqs: the cpufreq policy frequency cap in kHz keyed by CPU
+    index. Thermal and power management lower the cap to throttle.
+  - cur_freqs: the current frequency in kHz keyed by CPU index.
+  - throttle_counts: the number of thermal throttling events keyed by CPU
+    index. Only available on x86.
+  - temperatures: the temperature in millidegrees Celsius keyed by thermal
+    zone type.
+  """
+  scaling_governors: Dict[int, str] = field(default_factory=dict)
+  scaling_max_freqs: Dict[int, int] = field(default_factory=dict)
+  cur_freqs: Dict[int, int] = field(default_factory=dict)
+  throttle_counts: Dict[int, int] = field(default_factory=dict)
+  temperatures: Dict[str, int] = field(default_factory=dict)
+
+  def to_json_object(self) -> Dict[str, Any]:
+    return {
+        "scaling_governors": self.scaling_governors,
+        "scaling_max_freqs": self.scaling_max_freqs,
+        "cur_freqs": self.cur_freqs,
+        "throttle_counts": self.throttle_counts,
+        "temperatures": self.temperatures,
+    }
+
+
+def _read_sysfs_value(path: pathlib.Path) -> Optional[str]:
+  try:
+    return path.read_text().strip()
+  except (OSError, ValueError):
+    return None
+
+
+def _list_cpu_dirs(sysfs_root: pathlib.Path) -> Dict[int, pathlib.Path]:
+  cpu_dirs = {}
+  for cpu_dir in (sysfs_root / "devices/system/cpu").glob("cpu[0-9]*"):
+    cpu_dirs[int(cpu_dir.name[len("cpu"):])] = cpu_dir
+  return dict(sorted(cpu_dirs.items()))
+
+
+def read_linux_system_state(
+    sysfs_root: pathlib.Path = pathlib.Path("/sys")) -> LinuxSystemState:
+  """Reads the frequency policy and thermal state from sysfs.
+
+  Values that the kernel doesn't expose are omitted.
+  """
+  state = LinuxSystemState()
+  for cpu_index, cpu_dir in _list_cpu_dirs(sysfs_root).items():
+    governor = _read_sysfs_value(cpu_dir / "cpufreq/scaling_governor")
+    if governor is not None:
+      state.scaling_governors[cpu_index] = governor
+    for attr, values in [("cpufreq/scaling_max_freq", state.scaling_max_freqs),
+                         ("cpufreq/scaling_cur_freq", state.cur_freqs),
+                         ("thermal_throttle/core_throttle_count",
+                          state.throttle_counts)]:
+      value = _read_sysfs_value(cpu_dir / attr)
+      if value is not None and value.isdigit():
+        values[cpu_index] = int(value)
+
+  for zone_dir in sorted((sysfs_root / "class/thermal").glob("thermal_zone*")):
+    zone_type = _read_sysfs_value(zone_dir / "type") or zone_dir.name
+    temperature = _read_sysfs_value(zone_dir / "temp")
+    if temperature is not None and temperature.lstrip("-").isdigit():
+      # Multiple zones can share a type; keep the hottest.
+      state.temperatures[zone_type] = max(
+          int(temperature), state.temperatures.get(zone_type, -(1 << 31)))
+
+  return state
+
+
+def set_linux_cpu_scaling_governor(
+    governor: str,
+    sysfs_root: pathlib.Path = pathlib.Path("/sys")) -> None:
+  """Sets the cpufreq governor of all CPUs. Requires root."""
+  for cpu_dir in _list_cpu_dirs(sysfs_root).values():
+    governor_path = cpu_dir / "cpufreq/scaling_governor"
+    if governor_path.exists():
+      governor_path.write_text(governor)
+
+
+def check_system_state_change(
+    before: LinuxSystemState,
+    after: LinuxSystemState,
+    max_temperature: Optional[float] = None) -> List[str]:
+  """Returns the reasons a benchmark run between the two states is noisy.
+
+  Args:
+    before: the state sampled before the run.
+    after: the state sampled after the run.
+    max_temperature: the maximum temperature in degrees Celsius allowed in any
+      thermal zone before or after the run. Not checked if None.
+
+  Returns:
+    A list of human-readable issues; empty if the run is stable.
+  """
+  issues = []
+  for cpu_index, governor in before.scaling_governors.items():
+    after_governor = after.scaling_governors.get(cpu_index)
+    if after_governor is not None and after_governor != governor:
+      issues.append(f"cpu{cpu_index} governor changed from {governor} to "
+                    f"{after_governor}")
+  for cpu_index, max_freq in before.scaling_max_freqs.items():
+    after_max_freq = after.scaling_max_freqs.get(cpu_index)
+    if after_max_freq is not None and after_max_freq != max_freq:
+      issues.append(f"cpu{cpu_index} max frequency changed from {max_freq} kHz "
+                    f"to {after_max_freq} kHz")
+  for cpu_index, count in before.throttle_counts.items():
+    after_count = after.throttle_counts.get(cpu_index)
+    if after_count is not None and after_count > count:
+      issues.append(f"cpu{cpu_index} thermally throttled "
+                    f"{after_count - count} times")
+  if max_temperature is not None:
+    for label, state in [("before", before), ("after", after)]:
+      for zone_type, temperature in state.temperatures.items():
+        if temperature / 1000.0 > max_temperature:
+          issues.append(f"{zone_type} at {temperature / 1000.0:.1f} C "
+                        f"{label} the run exceeds {max_temperature:.1f} C")
+  return issues
+
+
+def get_relative_confidence_interval(samples: Sequence[float]) -> float:
+  """Returns the half-width of the 95% confidence interval of the mean of
+  |samples| relative to the mean. Returns inf if it can't be estimated.
+  """
+  if len(samples) < 2:
+    return float("inf")
+  mean = statistics.mean(samples)
+  if mean == 0:
+    return float("inf")
+  degrees_of_freedom = len(samples) - 1
+  if degrees_of_freedom < len(_T_CRITICAL_VALUES_95):
+    critical_value = _T_CRITICAL_VALUES_95[degrees_of_freedom]
+  else:
+    critical_value = _Z_CRITICAL_VALUE_95
+  stderr = statistics.stdev(samples) / (len(samples)**0.5)
+  return critical_value * stderr / abs(mean)
+
+
+def get_repetition_real_times(
+    result_json_object: Dict[str, Any]) -> Dict[str, List[float]]:
+  """Returns the real times of each repetition keyed by benchmark run name in
+  Google Benchmark JSON results.
+  """
+  real_times = {}
+  for bench_case in result_json_object["benchmarks"]:
+    if bench_case.get("run_type") != "iteration":
+      continue
+    run_name = bench_case.get("run_name", bench_case["name"])
+    real_times.setdefault(run_name, []).append(bench_case["real_time"])
+  return real_times
+
+
+def _compute_aggregate(aggregate_name: str, samples: Sequence[float]) -> float:
+  if aggregate_name == "mean":
+    return statistics.mean(samples)
+  if aggregate_name == "median":
+    return statistics.median(samples)
+  stddev = statistics.stdev(samples) if len(samples) > 1 else 0.0
+  if aggregate_name == "stddev":
+    return stddev
+  mean = statistics.mean(samples)
+  return stddev / mean if mean else 0.0
+
+
+def merge_benchmark_rounds(
+    result_json_objects: Sequence[Dict[str, Any]]) -> Dict[str, Any]:
+  """Merges the Google Benchmark JSON results of multiple rounds.
+
+  The repetitions of all rounds are concatenated and the aggregates of the
+  first round are recomputed over them, so the merged results can be consumed
+  like the results of a single run with more repetitions.
+  """
+  if not result_json_objects:
+    raise ValueError("No benchmark rounds to merge.")
+  first_round = result_json_objects[0]
+  if len(result_json_objects) == 1:
+    return first_round
+
+  iterations = []
+  for result_json_object in result_json_objects:
+    iterations.extend(bench_case
+                      for bench_case in result_json_object["benchmarks"]
+                      if bench_case.get("run_type") == "iteration")
+  samples = {}
+  for bench_case in iterations:
+    run_name = bench_case.get("run_name", bench_case["name"])
+    run_samples = samples.setdefault(run_name, {
+        "real_time": [],
+        "cpu_time": []
+    })
+    run_samples["real_time"].append(bench_case["real_time"])
+    run_samples["cpu_time"].append(bench_case["cpu_time"])
+
+  aggregates = []
+  for bench_case in first_round["benchmarks"]:
+    aggregate_name = bench_case.get("aggregate_name")
+    if (bench_case.get("run_type") != "aggregate" or
+        aggregate_name not in _AGGREGATE_NAMES):
+      continue
+    run_samples = samples.get(bench_case.get("run_name"))
+    if run_samples is None:
+      continue
+    aggregate = dict(bench_case)
+    aggregate["repetitions"] = len(run_samples["real_time"])
+    for time_key in ["real_time", "cpu_time"]:
+      aggregate[time_key] = _compute_aggregate(aggregate_name,
+                                               run_samples[time_key])
+    aggregates.append(aggregate)
+
+  repetition_indices = {}
+  for bench_case in iterations:
+    run_name = bench_case.get("run_name", bench_case["name"])
+    bench_case["repetition_index"] = repetition_indices.get(run_name, 0)
+    bench_case["repetitions"] = len(samples[run_name]["real_time"])
+    repetition_indices[run_name] = bench_case["repetition_index"] + 1
+
+  merged = dict(first_round)
+  merged["benchmarks"] = iterations + aggregates
+  return merged
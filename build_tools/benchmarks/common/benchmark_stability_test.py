@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import pathlib
+import tempfile
+import unittest
+
+from common import benchmark_stability
+
+
+def _make_results(real_times):
+  benchmarks = [{
+      "name": "BM_main/process_time/real_time",
+      "run_name": "BM_main/process_time/real_time",
+      "run_type": "iteration",
+      "repetitions": len(real_times),
+      "repetition_index": index,
+      "real_time": real_time,
+      "cpu_time": real_time / 2,
+      "time_unit": "ns",
+  } for index, real_time in enumerate(real_times)]
+  for aggregate_name in ["mean", "median", "stddev", "cv"]:
+    benchmarks.append({
+        "name": f"BM_main/process_time/real_time_{aggregate_name}",
+        "run_name": "BM_main/process_time/real_time",
+        "run_type": "aggregate",
+        "aggregate_name": aggregate_name,
+        "repetitions": len(real_times),
+        "real_time": 0,
+        "cpu_time": 0,
+        "time_unit": "ns",
+    })
+  return {"context": {"num_cpus": 8}, "benchmarks": benchmarks}
+
+
+class BenchmarkStabilityTest(unittest.TestCase):
+
+  def test_read_linux_system_state(self):
+    with tempfile.TemporaryDirectory() as tmp_dir:
+      sysfs_root = pathlib.Path(tmp_dir)
+      cpu_dir = sysfs_root / "devices/system/cpu/cpu0"
+      (cpu_dir / "cpufreq").mkdir(parents=True)
+      (cpu_dir / "thermal_throttle").mkdir()
+      (cpu_dir / "cpufreq/scaling_governor").write_text("performance\n")
+      (cpu_dir / "cpufreq/scaling_max_freq").write_text("3000000\n")
+      (cpu_dir / "thermal_throttle/core_throttle_count").write_text("4\n")
+      zone_dir = sysfs_root / "class/thermal/thermal_zone0"
+      zone_dir.mkdir(parents=True)
+      (zone_dir / "type").write_text("x86_pkg_temp\n")
+      (zone_dir / "temp").write_text("55000\n")
+
+      state = benchmark_stability.read_linux_system_state(sysfs_root)
+
+    self.assertEqual(state.scaling_governors, {0: "performance"})
+    self.assertEqual(state.scaling_max_freqs, {0: 3000000})
+    self.assertEqual(state.cur_freqs, {})
+    self.assertEqual(state.throttle_counts, {0: 4})
+    self.assertEqual(state.temperatures, {"x86_pkg_temp": 55000})
+
+  def test_check_system_state_change(self):
+    before = benchmark_stability.LinuxSystemState(
+        scaling_max_freqs={0: 3000000, 1: 3000000},
+        throttle_counts={0: 4, 1: 0},
+        temperatures={"x86_pkg_temp": 70000})
+    after = benchmark_stability.LinuxSystemState(
+        scaling_max_freqs={0: 3000000, 1: 2000000},
+        throttle_counts={0: 6, 1: 0},
+        temperatures={"x86_pkg_temp": 85000})
+
+    self.assertEqual(
+        benchmark_stability.check_system_state_change(before, before,
+                                                      max_temperature=80), [])
+    self.assertEqual(
+        benchmark_stability.check_system_state_change(before,
+                                                      after,
+                                                      max_temperature=80),
+        [
+            "cpu1 max frequency changed from 3000000 kHz to 2000000 kHz",
+            "cpu0 thermally throttled 2 times",
+            "x86_pkg_temp at 85.0 C after the run exceeds 80.0 C",
+        ])
+
+  def test_get_relative_confidence_interval(self):
+    self.assertEqual(
+        benchmark_stability.get_relative_confidence_interval([100]),
+        float("inf"))
+    self.assertEqual(
+        benchmark_stability.get_relative_confidence_interval([100, 100, 100]),
+        0)
+    # stddev = sqrt(2), stderr = 1, t(1) = 12.706.
+    self.assertAlmostEqual(
+        benchmark_stability.get_relative_confidence_interval([99, 101]),
+        12.706 / 100)
+
+  def test_merge_benchmark_rounds(self):
+    merged = benchmark_stability.merge_benchmark_rounds(
+        [_make_results([10, 20]), _make_results([30, 60])])
+
+    self.assertEqual(benchmark_stability.get_repetition_real_times(merged),
+                     {"BM_main/process_time/real_time": [10, 20, 30, 60]})
+    iterations = [
+        b for b in merged["benchmarks"] if b["run_type"] == "iteration"
+    ]
+    self.assertEqual([b["repetition_index"] for b in iterations], [0, 1, 2, 3])
+    aggregates = {
+        b["aggregate_name"]: b
+        for b in merged["benchmarks"]
+        if b["run_type"] == "aggregate"
+    }
+    self.assertEqual(aggregates["mean"]["real_time"], 30)
+    self.assertEqual(aggregates["mean"]["cpu_time"], 15)
+    self.assertEqual(aggregates["median"]["real_time"], 25)
+    self.assertEqual(aggregates["mean"]["repetitions"], 4)
+    self.assertEqual(merged["context"], {"num_cpus": 8})
+
+
+if __name__ == "__main__":
+  unittest.main()
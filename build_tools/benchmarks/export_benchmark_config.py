@@ -63,6 +63,11 @@ BENCHMARK_PRESET_MATCHERS: Dict[str, PresetMatcher] = {
         (config.target_device_spec.architecture.type == common_definitions.
          ArchitectureType.GPU and config.target_device_spec.host_environment.
          platform == "android"),
+    # Autoregressive decode models on any device. The per-invocation latency of
+    # these models is the per-token latency.
+    "decode":
+        lambda config: "decode" in config.module_generation_config.
+        imported_model.model.tags,
 }
 
 
@@ -211,6 +211,52 @@ class ExportBenchmarkConfigTest(unittest.TestCase):
         "dev_a": [run_config_a],
     })
 
+  def test_decode_preset_matches_decode_models(self):
+    decode_model = common_definitions.Model(
+        id="decode_model",
+        name="decode_model",
+        tags=["decode"],
+        source_type=common_definitions.ModelSourceType.EXPORTED_LINALG_MLIR,
+        source_url="",
+        entry_function="decode_step",
+        input_types=["1xf32"])
+    other_model = common_definitions.Model(
+        id="other_model",
+        name="other_model",
+        tags=[],
+        source_type=common_definitions.ModelSourceType.EXPORTED_LINALG_MLIR,
+        source_url="",
+        entry_function="predict",
+        input_types=["1xf32"])
+    compile_config = iree_definitions.CompileConfig(id="1",
+                                                    tags=[],
+                                                    compile_targets=[])
+    device_spec = common_definitions.DeviceSpec(
+        id="dev_a",
+        device_name="dev_a",
+        architecture=common_definitions.DeviceArchitecture.RV64_GENERIC,
+        host_environment=common_definitions.HostEnvironment.ANDROID_ARMV8_2_A)
+    run_configs = [
+        iree_definitions.E2EModelRunConfig(
+            module_generation_config=iree_definitions.ModuleGenerationConfig(
+                imported_model=iree_definitions.ImportedModel.from_model(model),
+                compile_config=compile_config),
+            module_execution_config=COMMON_EXEC_CONFIG,
+            target_device_spec=device_spec,
+            input_data=common_definitions.ZEROS_MODEL_INPUT_DATA)
+        for model in [decode_model, other_model]
+    ]
+
+    run_config_map = export_benchmark_config.filter_and_group_run_configs(
+        run_configs=run_configs,
+        preset_matchers=[
+            export_benchmark_config.BENCHMARK_PRESET_MATCHERS["decode"]
+        ])
+
+    self.assertEqual(run_config_map, {
+        "dev_a": [run_configs[0]],
+    })
+
 
 if __name__ == "__main__":
   unittest.main()
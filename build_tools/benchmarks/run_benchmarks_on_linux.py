@@ -12,7 +12,7 @@ import pathlib
 # Add build_tools python dir to the search path.
 sys.path.insert(0, str(pathlib.Path(__file__).parent.with_name("python")))
 
-from typing import Any, List, Optional
+from typing import Any, Dict, List, Optional
 import typing
 import atexit
 import json
@@ -25,6 +25,7 @@ from common.benchmark_suite import MODEL_FLAGFILE_NAME, BenchmarkCase, Benchmark
 from common.benchmark_config import BenchmarkConfig
 from common.benchmark_definition import execute_cmd, execute_cmd_and_get_output, get_git_commit_hash, get_iree_benchmark_module_arguments, wait_for_iree_benchmark_module_start
 from common.linux_device_utils import get_linux_device_info
+from common import benchmark_stability
 from e2e_test_framework.definitions import iree_definitions
 from e2e_test_framework import serialization
 from e2e_test_artifacts import iree_artifacts
@@ -35,8 +36,23 @@ import common.common_arguments
 class LinuxBenchmarkDriver(BenchmarkDriver):
   """Linux benchmark driver."""
 
-  def __init__(self, gpu_id: str, *args, **kwargs):
+  def __init__(self,
+               gpu_id: str,
+               *args,
+               startup_profile_dir: Optional[pathlib.Path] = None,
+               stability_target_ci: Optional[float] = None,
+               stability_max_rounds: int = 1,
+               max_temperature: Optional[float] = None,
+               **kwargs):
     self.gpu_id = gpu_id
+    self.startup_profile_dir = startup_profile_dir
+    self.startup_profiles: Dict[str, Any] = {}
+    self.stability_target_ci = stability_target_ci
+    self.stability_max_rounds = stability_max_rounds
+    self.max_temperature = max_temperature
+    # Stability reports of the benchmarks that were flagged as noisy keyed by
+    # results filename stem.
+    self.unstable_benchmarks: Dict[str, Dict[str, Any]] = {}
     super().__init__(*args, **kwargs)
 
   def run_benchmark_case(self, benchmark_case: BenchmarkCase,
@@ -107,17 +123,88 @@ class LinuxBenchmarkDriver(BenchmarkDriver):
     cmd = self.__build_tool_cmds(benchmark_case=benchmark_case,
                                  tool_path=tool_path)
 
+    startup_profile_filename = None
     if tool_name == "iree-benchmark-module":
       cmd.extend(
           get_iree_benchmark_module_arguments(
               results_filename=str(results_filename),
               driver_info=benchmark_case.driver_info,
               benchmark_min_time=self.config.benchmark_min_time))
+      if self.startup_profile_dir is not None:
+        startup_profile_filename = (self.startup_profile_dir /
+                                    results_filename.name)
+        cmd.append(f"--startup_profile={startup_profile_filename}")
 
-    result_json = execute_cmd_and_get_output(
-        cmd, cwd=benchmark_case.benchmark_case_dir, verbose=self.verbose)
-    if self.verbose:
-      print(result_json)
+    if tool_name == "iree-benchmark-module":
+      self.__run_stable_benchmark(benchmark_case=benchmark_case,
+                                  cmd=cmd,
+                                  results_filename=results_filename)
+    else:
+      result_json = execute_cmd_and_get_output(
+          cmd, cwd=benchmark_case.benchmark_case_dir, verbose=self.verbose)
+      if self.verbose:
+        print(result_json)
+
+    if startup_profile_filename and startup_profile_filename.exists():
+      self.startup_profiles[results_filename.stem] = json.loads(
+          startup_profile_filename.read_text())
+
+  def __run_stable_benchmark(self, benchmark_case: BenchmarkCase,
+                             cmd: List[Any], results_filename: pathlib.Path):
+    """Runs rounds of the benchmark until the confidence interval of the mean
+    latency is within the target and records the stability in the results.
+
+    Rounds during which the host was throttled or its frequency policy changed
+    are only merged into the results if no clean round was run.
+    """
+    clean_rounds = []
+    noisy_rounds = []
+    issues = []
+    relative_ci = float("inf")
+    for round_index in range(max(self.stability_max_rounds, 1)):
+      before_state = benchmark_stability.read_linux_system_state()
+      result_json = execute_cmd_and_get_output(
+          cmd, cwd=benchmark_case.benchmark_case_dir, verbose=self.verbose)
+      after_state = benchmark_stability.read_linux_system_state()
+      if self.verbose:
+        print(result_json)
+
+      round_results = json.loads(results_filename.read_text())
+      round_issues = benchmark_stability.check_system_state_change(
+          before_state, after_state, max_temperature=self.max_temperature)
+      if round_issues:
+        issues += [f"round {round_index}: {issue}" for issue in round_issues]
+        noisy_rounds.append(round_results)
+      else:
+        clean_rounds.append(round_results)
+
+      merged_results = benchmark_stability.merge_benchmark_rounds(
+          clean_rounds or noisy_rounds)
+      real_times = benchmark_stability.get_repetition_real_times(
+          merged_results)
+      relative_ci = max((benchmark_stability.get_relative_confidence_interval(
+          samples) for samples in real_times.values()),
+                        default=float("inf"))
+      if (self.stability_target_ci is None or
+          (clean_rounds and relative_ci <= self.stability_target_ci / 100)):
+        break
+
+    stable = not issues and (self.stability_target_ci is None or
+                             relative_ci <= self.stability_target_ci / 100)
+    stability = {
+        "stable": stable,
+        "clean_rounds": len(clean_rounds),
+        "noisy_rounds": len(noisy_rounds),
+        "relative_confidence_interval": relative_ci,
+        "issues": issues,
+        "system_state": after_state.to_json_object(),
+    }
+    merged_results["context"]["iree_benchmark_stability"] = stability
+    results_filename.write_text(json.dumps(merged_results, indent=2))
+    if not stable:
+      print(f"Unstable benchmark (95% CI +/-{relative_ci * 100:.2f}%): " +
+            "; ".join(issues))
+      self.unstable_benchmarks[results_filename.stem] = stability
 
   def __run_capture(self, benchmark_case: BenchmarkCase,
                     capture_filename: pathlib.Path):
@@ -164,15 +251,25 @@ def main(args):
     benchmark_suite = BenchmarkSuite.load_from_run_configs(
         run_configs=run_configs)
 
-  benchmark_driver = LinuxBenchmarkDriver(gpu_id=args.gpu_id,
-                                          device_info=device_info,
-                                          benchmark_config=benchmark_config,
-                                          benchmark_suite=benchmark_suite,
-                                          benchmark_grace_time=1.0,
-                                          verbose=args.verbose)
+  startup_profile_dir = None
+  if args.startup_profile_output is not None:
+    startup_profile_dir = args.tmp_dir / "startup-profiles"
+    startup_profile_dir.mkdir(parents=True, exist_ok=True)
+
+  benchmark_driver = LinuxBenchmarkDriver(
+      gpu_id=args.gpu_id,
+      device_info=device_info,
+      benchmark_config=benchmark_config,
+      benchmark_suite=benchmark_suite,
+      benchmark_grace_time=1.0,
+      verbose=args.verbose,
+      startup_profile_dir=startup_profile_dir,
+      stability_target_ci=args.stability_target_ci,
+      stability_max_rounds=args.stability_max_rounds,
+      max_temperature=args.max_temperature)
 
   if args.pin_cpu_freq:
-    raise NotImplementedError("CPU freq pinning is not supported yet.")
+    benchmark_stability.set_linux_cpu_scaling_governor("performance")
   if args.pin_gpu_freq:
     raise NotImplementedError("GPU freq pinning is not supported yet.")
   if not args.no_clean:
@@ -185,6 +282,12 @@ def main(args):
     with args.output.open("w") as f:
       f.write(benchmark_results.to_json_str())
 
+  if args.startup_profile_output is not None:
+    # Startup profiles of the benchmarks run in this invocation keyed by
+    # benchmark name.
+    args.startup_profile_output.write_text(
+        json.dumps(benchmark_driver.startup_profiles, indent=2))
+
   if args.verbose:
     print(benchmark_results.commit)
     print(benchmark_results.benchmarks)
@@ -196,6 +299,11 @@ def main(args):
       for capture_filename in benchmark_driver.get_capture_filenames():
         tar.add(capture_filename)
 
+  if benchmark_driver.unstable_benchmarks:
+    print("Unstable benchmarks:", file=sys.stderr)
+    for name in sorted(benchmark_driver.unstable_benchmarks):
+      print(f"  {name}", file=sys.stderr)
+
   benchmark_errors = benchmark_driver.get_benchmark_errors()
   if benchmark_errors:
     print("Benchmarking completed with errors", file=sys.stderr)
@@ -215,6 +323,33 @@ def parse_argument():
       type=str,
       default="0",
       help="GPU ID to run the benchmark, e.g., '0' or 'GPU-<UUID>'")
+  arg_parser.add_argument(
+      "--startup_profile_output",
+      type=pathlib.Path,
+      default=None,
+      help="Path to write the cold-start breakdown (module load, executable "
+      "preparation, constant upload and first versus steady-state calls) of "
+      "each iree-benchmark-module benchmark as JSON")
+  arg_parser.add_argument(
+      "--stability_target_ci",
+      type=float,
+      default=None,
+      help="Repeat each iree-benchmark-module benchmark until the 95% "
+      "confidence interval of the mean latency is within this percentage of "
+      "the mean. Only one round is run if not set")
+  arg_parser.add_argument(
+      "--stability_max_rounds",
+      type=int,
+      default=5,
+      help="Maximum number of rounds to run each benchmark for when "
+      "--stability_target_ci is set. Benchmarks that don't reach the target "
+      "are flagged as unstable")
+  arg_parser.add_argument(
+      "--max_temperature",
+      type=float,
+      default=None,
+      help="Flag benchmarks as unstable if any thermal zone is above this "
+      "temperature in degrees Celsius before or after a round")
 
   return arg_parser.parse_args()
 
@@ -25,6 +25,7 @@ from typing import Any, Dict, Optional
 
 from common.common_arguments import expand_and_check_file_paths
 from common.benchmark_presentation import (COMPILATION_METRICS_TO_TABLE_MAPPERS,
+                                           PEAK_MEMORY_SERIES_SUFFIX,
                                            collect_all_compilation_metrics)
 from common.benchmark_definition import (BenchmarkResults,
                                          execute_cmd_and_get_output)
@@ -385,6 +386,21 @@ def main(args):
                      dry_run=args.dry_run,
                      verbose=args.verbose)
 
+    if compile_metrics.peak_memory_bytes is not None:
+      series_id = f"{name} [{PEAK_MEMORY_SERIES_SUFFIX}]"
+      add_new_iree_series(series_id=series_id,
+                          series_unit="bytes",
+                          series_description=description,
+                          override=True,
+                          dry_run=args.dry_run,
+                          verbose=args.verbose)
+      add_new_sample(series_id=series_id,
+                     build_id=commit_count,
+                     sample_unit="bytes",
+                     sample_value=compile_metrics.peak_memory_bytes,
+                     dry_run=args.dry_run,
+                     verbose=args.verbose)
+
 
 if __name__ == "__main__":
   main(parse_arguments())
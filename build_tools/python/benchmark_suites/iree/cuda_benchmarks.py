@@ -36,7 +36,7 @@ class Linux_CUDA_Benchmarks(object):
         iree_definitions.ModuleGenerationConfig(
             compile_config=self.SM_80_COMPILE_CONFIG,
             imported_model=iree_definitions.ImportedModel.from_model(model))
-        for model in model_groups.LARGE
+        for model in model_groups.LARGE + model_groups.DECODE
     ]
     sm80_devices = device_collections.DEFAULT_DEVICE_COLLECTION.query_device_specs(
         architecture=common_definitions.DeviceArchitecture.CUDA_SM80,
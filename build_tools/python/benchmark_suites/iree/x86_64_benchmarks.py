@@ -46,7 +46,8 @@ class Linux_x86_64_Benchmarks(object):
         iree_definitions.ModuleGenerationConfig(
             compile_config=self.CASCADELAKE_COMPILE_CONFIG,
             imported_model=iree_definitions.ImportedModel.from_model(model))
-        for model in model_groups.SMALL + model_groups.LARGE
+        for model in model_groups.SMALL + model_groups.LARGE +
+        model_groups.DECODE
     ]
     # TODO(#11174): Excludes ResNet50
     excluded_models_for_experiments = [tf_models.RESNET50_TF_FP32]
@@ -54,7 +55,8 @@ class Linux_x86_64_Benchmarks(object):
         iree_definitions.ModuleGenerationConfig(
             compile_config=self.CASCADELAKE_FUSE_PADDING_COMPILE_CONFIG,
             imported_model=iree_definitions.ImportedModel.from_model(model))
-        for model in model_groups.SMALL + model_groups.LARGE
+        for model in model_groups.SMALL + model_groups.LARGE +
+        model_groups.DECODE
         if model not in excluded_models_for_experiments
     ]
     default_execution_configs = [
@@ -94,6 +94,10 @@ class IreeRuleBuilder(object):
         compile_config=compile_config,
         mlir_dialect_type=imported_model.dialect_type.value
     ) + compile_config.extra_flags
+    if benchmark_collections.COMPILE_STATS_TAG in compile_config.tags:
+      compile_profile_path = (output_file_path.parent /
+                              iree_artifacts.COMPILE_PROFILE_FILENAME)
+      compile_flags.append(f"--iree-compile-profile-file={compile_profile_path}")
 
     # Module target name: iree-module-<model_id>-<compile_config_id>
     target_name = f"iree-module-{imported_model.model.id}-{compile_config.id}"
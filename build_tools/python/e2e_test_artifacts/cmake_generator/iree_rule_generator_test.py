@@ -7,6 +7,7 @@
 import pathlib
 import unittest
 
+from benchmark_suites.iree import benchmark_collections
 from e2e_test_artifacts.cmake_generator import model_rule_generator, iree_rule_generator
 from e2e_test_framework.definitions import common_definitions, iree_definitions
 
@@ -106,6 +107,42 @@ class IreeRuleBuilderTest(unittest.TestCase):
                      f"iree-module-{model_a.id}-{compile_config_a.id}")
     self.assertEqual(rule.output_module_path, output_file_path)
 
+  def test_build_module_compile_rule_compile_stats(self):
+    model_a = common_definitions.Model(
+        id="1234",
+        name="linalg_m",
+        tags=[],
+        source_type=common_definitions.ModelSourceType.EXPORTED_LINALG_MLIR,
+        source_url="https://example.com/xyz.mlir",
+        entry_function="main",
+        input_types=["1xf32"])
+    imported_model_a = iree_definitions.ImportedModel.from_model(model_a)
+    compile_config_a = iree_definitions.CompileConfig(
+        id="config_a",
+        tags=[benchmark_collections.COMPILE_STATS_TAG],
+        compile_targets=[
+            iree_definitions.CompileTarget(
+                target_architecture=common_definitions.DeviceArchitecture.
+                X86_64_CASCADELAKE,
+                target_backend=iree_definitions.TargetBackend.LLVM_CPU,
+                target_abi=iree_definitions.TargetABI.LINUX_GNU)
+        ])
+    model_import_rule = iree_rule_generator.IreeModelImportRule(
+        target_name=f"iree-import-model-abcd",
+        output_file_path=pathlib.PurePath("root/iree/abcd/1234.mlir"),
+        cmake_rules=["abc"])
+    output_file_path = pathlib.PurePath("root/iree/test_output/module.vmfb")
+
+    rule = self._builder.build_module_compile_rule(
+        model_import_rule=model_import_rule,
+        imported_model=imported_model_a,
+        compile_config=compile_config_a,
+        output_file_path=output_file_path)
+
+    self.assertIn(
+        "--iree-compile-profile-file=root/iree/test_output/compile-profile.json",
+        "\n".join(rule.cmake_rules))
+
   def test_build_target_path(self):
     builder = iree_rule_generator.IreeRuleBuilder(package_name="xyz")
 
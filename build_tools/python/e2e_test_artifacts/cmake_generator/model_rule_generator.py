@@ -43,8 +43,18 @@ def generate_model_rule_map(
               output=str(model_path),
               unpack=True)
       ]
+    elif model_url.scheme == "file":
+      # In-tree models are relative to the source root and copied through the
+      # same fetch rule so they are tracked like any other model artifact.
+      cmake_rules = [
+          cmake_builder.rules.build_iree_fetch_artifact(
+              target_name=target_name,
+              source_url=f"file://${{IREE_ROOT_DIR}}/{model_url.path}",
+              output=str(model_path),
+              unpack=False)
+      ]
     else:
-      raise ValueError("Unsupported model url: {model.source_url}.")
+      raise ValueError(f"Unsupported model url: {model.source_url}.")
 
     model_rules[model.id] = ModelRule(target_name=target_name,
                                       file_path=model_path,
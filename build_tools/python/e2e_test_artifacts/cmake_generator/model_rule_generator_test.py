@@ -46,6 +46,26 @@ class CommonGeneratorsTest(unittest.TestCase):
         rule_map[model_b.id].file_path,
         model_artifacts.get_model_path(model=model_b, root_path=root_path))
 
+  def test_generate_model_rule_map_in_tree_model(self):
+    model = common_definitions.Model(
+        id="9012",
+        name="linalg_m",
+        tags=[],
+        source_type=common_definitions.ModelSourceType.EXPORTED_LINALG_MLIR,
+        source_url="file:tests/models/xyz.mlir",
+        entry_function="main",
+        input_types=["1xf32"])
+    root_path = pathlib.PurePath("model_root")
+
+    rule_map = model_rule_generator.generate_model_rule_map(
+        root_path=root_path, models=[model])
+
+    self.assertEqual(
+        rule_map[model.id].file_path,
+        model_artifacts.get_model_path(model=model, root_path=root_path))
+    self.assertIn('"file://${IREE_ROOT_DIR}/tests/models/xyz.mlir"',
+                  "\n".join(rule_map[model.id].cmake_rules))
+
 
 if __name__ == "__main__":
   unittest.main()
@@ -13,6 +13,9 @@ from e2e_test_framework.definitions import common_definitions, iree_definitions
 
 IREE_ARTIFACT_PREFIX = "iree"
 MODULE_FILENAME = "module.vmfb"
+# Compile-time profile written next to the modules built for compilation
+# statistics.
+COMPILE_PROFILE_FILENAME = "compile-profile.json"
 
 
 def _get_model_prefix(imported_model: iree_definitions.ImportedModel) -> str:
@@ -0,0 +1,20 @@
+## Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Defines autoregressive decode models."""
+
+from e2e_test_framework import unique_ids
+from e2e_test_framework.definitions import common_definitions
+
+TRANSFORMER_DECODE_FP32_SEQLEN1024 = common_definitions.Model(
+    id=unique_ids.MODEL_TRANSFORMER_DECODE_FP32_SEQLEN1024,
+    name="TransformerDecode",
+    tags=["fp32", "decode", "seqlen1024"],
+    source_type=common_definitions.ModelSourceType.EXPORTED_LINALG_MLIR,
+    # Single transformer block with a 1024 position KV cache in globals. Each
+    # call attends over one more position than the last until it wraps around.
+    source_url="file:tests/e2e/models/transformer_decode_fake_weights.mlir",
+    entry_function="decode_step",
+    input_types=["1x512xf32"])
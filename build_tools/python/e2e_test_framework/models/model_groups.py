@@ -5,7 +5,7 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 """Defines the groups of models."""
 
-from e2e_test_framework.models import tf_models, tflite_models
+from e2e_test_framework.models import decode_models, tf_models, tflite_models
 
 # Small models that require less computational resources.
 SMALL = [
@@ -30,4 +30,10 @@ LARGE = [
     tf_models.RESNET50_TF_FP32,
 ]
 
-ALL = SMALL + LARGE
+# Autoregressive decode steps with KV-cache state held in globals. Each
+# invocation generates one token so the latency is the per-token latency.
+DECODE = [
+    decode_models.TRANSFORMER_DECODE_FP32_SEQLEN1024,
+]
+
+ALL = SMALL + LARGE + DECODE
@@ -24,6 +24,7 @@ MODEL_MINILM_L12_H384_UNCASED_INT32_SEQLEN128 = "ecf5c970-ee97-49f0-a4ed-df1f34e
 MODEL_BERT_FOR_MASKED_LM_FP32_SEQLEN512_TF = "39d157ad-f0ec-4a76-963b-d783beaed60f"
 MODEL_EFFICIENTNET_V2_S_FP32_TF = "ebe7897f-5613-435b-a330-3cb967704e5e"
 MODEL_RESNET50_TF_FP32 = "c393b4fa-beb4-45d5-982a-c6328aa05d08"
+MODEL_TRANSFORMER_DECODE_FP32_SEQLEN1024 = "a4407779-3058-45b8-a507-ce1cd76238ff"
 
 # Model input data
 MODEL_INPUT_DATA_ZEROS = "8d4a034e-944d-4725-8402-d6f6e61be93c"
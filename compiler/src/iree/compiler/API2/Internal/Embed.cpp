@@ -19,6 +19,7 @@
 #include "iree/compiler/Tools/init_llvmir_translations.h"
 #include "iree/compiler/Tools/init_passes.h"
 #include "iree/compiler/Tools/init_targets.h"
+#include "iree/compiler/Utils/PassProfiling.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -90,6 +91,7 @@ GlobalInit::GlobalInit(bool initializeCommandLine)
     // Register pass manager command-line options like -mlir-print-ir-*.
     mlir::registerPassManagerCLOptions();
     mlir::registerDefaultTimingManagerCLOptions();
+    registerPassProfilingCLOptions();
 
     // Bind session options to the command line environment.
     clBindingOptions = &BindingOptions::FromFlags::get();
@@ -338,6 +340,8 @@ struct Invocation {
 
   Session &session;
   PassManager passManager;
+  // Owned by |passManager| if compile profiling was requested.
+  PassProfiling *passProfiling = nullptr;
 
   // Diagnostic handlers are instantiated upon parsing the source (when we
   // have the SrcMgr) and held for the duration of the invocation. Each will
@@ -365,6 +369,7 @@ Invocation::Invocation(Session &session)
   if (session.globalInit.usesCommandLine) {
     mlir::applyPassManagerCLOptions(passManager);
     mlir::applyDefaultTimingPassManagerCLOptions(passManager);
+    passProfiling = applyPassProfilingCLOptions(passManager);
   }
   passManager.addInstrumentation(std::make_unique<PassTracing>());
 }
@@ -457,10 +462,13 @@ bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
   }
 
   passManager.enableVerifier(enableVerifier);
-  if (failed(passManager.run(parsedModule.get()))) {
+  bool runSucceeded = succeeded(passManager.run(parsedModule.get()));
+  // Profiles are written for failed compilations too as the time spent before
+  // the failure is still useful.
+  if (passProfiling && failed(writePassProfilingReport(*passProfiling))) {
     return false;
   }
-  return true;
+  return runSucceeded;
 }
 
 Error *Invocation::outputIR(Output &output) {
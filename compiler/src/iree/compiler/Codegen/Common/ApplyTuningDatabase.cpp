@@ -0,0 +1,181 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===- ApplyTuningDatabase.cpp --------------------------------------------===//
+//
+// This pass annotates the root ops of dispatches with the compilation info
+// recorded for them in a tuning database so that the configuration picked by
+// an autotuner is used instead of the defaults of the backend.
+//
+// The database is a dictionary attribute keyed by target (`backend/format`)
+// whose values are dictionaries mapping op signatures to compilation infos:
+//
+// {
+//   "llvm-cpu/embedded-elf-x86_64" = {
+//     "linalg.matmul(tensor<128x256xf32>, ...) -> (...)" =
+//         #iree_codegen.compilation_info<...>
+//   }
+// }
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Codegen/Dialect/IREECodegenDialect.h"
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "mlir/AsmParser/AsmParser.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Support/FileUtilities.h"
+
+#define DEBUG_TYPE "iree-codegen-apply-tuning-database"
+
+namespace mlir {
+namespace iree_compiler {
+
+llvm::cl::opt<std::string> clCodegenTuningDatabase(
+    "iree-codegen-tuning-database",
+    llvm::cl::desc("Path to a tuning database holding the compilation info to "
+                   "use for dispatch root ops, as produced by an autotuner."),
+    llvm::cl::init(""));
+
+llvm::cl::opt<bool> clCodegenTuningDatabaseReportMissing(
+    "iree-codegen-tuning-database-report-missing",
+    llvm::cl::desc("Emits a remark with the key of each dispatch root op that "
+                   "has no entry in the tuning database."),
+    llvm::cl::init(false));
+
+/// Returns the key identifying |op| in the tuning database. Ops with the same
+/// key compute the same thing on the same shapes and are expected to perform
+/// best with the same configuration.
+static std::string getTuningKey(Operation *op) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << op->getName() << "(";
+  llvm::interleaveComma(op->getOperandTypes(), os);
+  os << ") -> (";
+  llvm::interleaveComma(op->getResultTypes(), os);
+  os << ")";
+  if (auto genericOp = dyn_cast<linalg::GenericOp>(op)) {
+    os << " " << genericOp.getIndexingMaps() << " "
+       << genericOp.getIteratorTypes();
+  }
+  return os.str();
+}
+
+/// Returns the key of the entries for |targetAttr| in the tuning database.
+static std::string getTargetKey(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  return (targetAttr.getBackend().getValue() + "/" +
+          targetAttr.getFormat().getValue())
+      .str();
+}
+
+namespace {
+
+class ApplyTuningDatabasePass
+    : public ApplyTuningDatabaseBase<ApplyTuningDatabasePass> {
+ public:
+  ApplyTuningDatabasePass() = default;
+  ApplyTuningDatabasePass(StringRef databasePath, bool reportMissing) {
+    this->databasePath = databasePath.str();
+    this->reportMissing = reportMissing;
+  }
+  ApplyTuningDatabasePass(const ApplyTuningDatabasePass &pass)
+      : ApplyTuningDatabasePass(pass.databasePath, pass.reportMissing) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::Codegen::IREECodegenDialect>();
+  }
+
+  LogicalResult initialize(MLIRContext *context) override {
+    if (databasePath.empty()) return success();
+    std::string errorMessage;
+    auto file = openInputFile(databasePath, &errorMessage);
+    if (!file) {
+      return emitError(UnknownLoc::get(context))
+             << "failed to open tuning database '" << databasePath
+             << "': " << errorMessage;
+    }
+    database = llvm::dyn_cast_or_null<DictionaryAttr>(
+        parseAttribute(file->getBuffer(), context));
+    if (!database) {
+      return emitError(UnknownLoc::get(context))
+             << "tuning database '" << databasePath
+             << "' is not a dictionary attribute";
+    }
+    return success();
+  }
+
+  void runOnOperation() override {
+    if (!database) return;
+    IREE::HAL::ExecutableVariantOp variantOp = getOperation();
+    auto targetKey = getTargetKey(variantOp.getTarget());
+    auto entries = database.getAs<DictionaryAttr>(targetKey);
+    ModuleOp moduleOp = variantOp.getInnerModule();
+    llvm::StringMap<IREE::HAL::ExecutableExportOp> exportOps =
+        getAllEntryPoints(moduleOp);
+    for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
+      if (!exportOps.count(funcOp.getName())) continue;
+      SmallVector<Operation *> computeOps;
+      if (failed(getComputeOps(funcOp, computeOps))) continue;
+
+      // Only one op per dispatch may carry a compilation info. Configs set by
+      // hand take precedence over tuned ones.
+      if (llvm::any_of(computeOps, [](Operation *op) {
+            return getCompilationInfo(op) != nullptr;
+          })) {
+        continue;
+      }
+      Operation *tunedOp = nullptr;
+      for (auto *computeOp : computeOps) {
+        if (!entries) break;
+        auto compilationInfo =
+            entries.getAs<IREE::Codegen::CompilationInfoAttr>(
+                getTuningKey(computeOp));
+        if (!compilationInfo) continue;
+        setCompilationInfo(computeOp, compilationInfo);
+        tunedOp = computeOp;
+        break;
+      }
+      LLVM_DEBUG({
+        if (tunedOp) {
+          llvm::dbgs() << "applied tuned config to " << getTuningKey(tunedOp)
+                       << "\n";
+        }
+      });
+
+      // Untuned dispatches report the keys of their candidate root ops so
+      // that an external tuner knows what to populate the database with.
+      if (tunedOp || !reportMissing) continue;
+      for (auto *computeOp : computeOps) {
+        computeOp->emitRemark()
+            << "no tuning database entry for target \"" << targetKey
+            << "\" and key \"" << getTuningKey(computeOp) << "\"";
+      }
+    }
+  }
+
+ private:
+  DictionaryAttr database;
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
+createApplyTuningDatabasePass(StringRef databasePath, bool reportMissing) {
+  return std::make_unique<ApplyTuningDatabasePass>(databasePath, reportMissing);
+}
+
+void addTuningDatabasePasses(OpPassManager &variantPassManager) {
+  if (clCodegenTuningDatabase.empty()) return;
+  variantPassManager.addPass(createApplyTuningDatabasePass(
+      clCodegenTuningDatabase, clCodegenTuningDatabaseReportMissing));
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
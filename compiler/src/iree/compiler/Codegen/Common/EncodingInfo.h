@@ -40,13 +40,17 @@ Optional<MatmulType> getMatmulType(IREE::LinalgExt::TensorEncoding encoding);
 Optional<MatmulOperandRole> getMatmulOperandRole(
     IREE::LinalgExt::TensorEncoding encoding);
 
+/// Returns the number of leading batch dimensions of tensors with `encoding`.
+/// They are kept outermost and are not tiled when materialized.
+int64_t getMatmulNumBatchDims(IREE::LinalgExt::TensorEncoding encoding);
+
 void adjustTileSizesToNarrowStaticShape(
     IREE::LinalgExt::MaterializeEncodingInfo &encodingInfo,
     ArrayRef<int64_t> shape);
 
 IREE::LinalgExt::MaterializeEncodingInfo chooseEncodingInfoForMatmul(
-    MatmulType type, MatmulOperandRole operandRole,
-    MatmulTileParams tileParams);
+    MatmulType type, MatmulOperandRole operandRole, MatmulTileParams tileParams,
+    int64_t numBatchDims);
 
 IREE::LinalgExt::MaterializeEncodingValueFn getMaterializeEncodingValueFn(
     IREE::HAL::ExecutableTargetAttr targetAttr);
@@ -243,8 +243,8 @@ struct MaterializeFlowDispatchTensorStoreOp
 }  // namespace
 
 IREE::LinalgExt::MaterializeEncodingInfo chooseEncodingInfoForMatmul(
-    MatmulType type, MatmulOperandRole operandRole,
-    MatmulTileParams tileParams) {
+    MatmulType type, MatmulOperandRole operandRole, MatmulTileParams tileParams,
+    int64_t numBatchDims) {
   MaterializeEncodingInfo encodingInfo;
   encodingInfo.innerDimsPos = {0, 1};
   switch (operandRole) {
@@ -271,6 +271,18 @@ IREE::LinalgExt::MaterializeEncodingInfo chooseEncodingInfoForMatmul(
       return {};
     }
   }
+  // Batch dimensions stay outermost and are not tiled.
+  if (numBatchDims) {
+    for (int64_t &pos : encodingInfo.innerDimsPos) pos += numBatchDims;
+    if (!encodingInfo.outerDimsPerm.empty()) {
+      SmallVector<int64_t> outerDimsPerm =
+          llvm::to_vector(llvm::seq<int64_t>(0, numBatchDims));
+      for (int64_t dim : encodingInfo.outerDimsPerm) {
+        outerDimsPerm.push_back(dim + numBatchDims);
+      }
+      encodingInfo.outerDimsPerm = std::move(outerDimsPerm);
+    }
+  }
   return encodingInfo;
 }
 
@@ -286,11 +298,19 @@ Optional<MatmulType> getMatmulType(TensorEncoding encoding) {
     case TensorEncoding::MATMUL_F32F32F32_RHS:
     case TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE:
     case TensorEncoding::MATMUL_F32F32F32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
       return MatmulType::F32F32F32;
     case TensorEncoding::MATMUL_I8I8I32_LHS:
     case TensorEncoding::MATMUL_I8I8I32_RHS:
     case TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE:
     case TensorEncoding::MATMUL_I8I8I32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS_TRANSPOSE:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
       return MatmulType::I8I8I32;
     default:
       return std::nullopt;
@@ -301,24 +321,48 @@ Optional<MatmulOperandRole> getMatmulOperandRole(TensorEncoding encoding) {
   switch (encoding) {
     case TensorEncoding::MATMUL_F32F32F32_LHS:
     case TensorEncoding::MATMUL_I8I8I32_LHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
       return MatmulOperandRole::LHS;
     case TensorEncoding::MATMUL_F32F32F32_RHS:
     case TensorEncoding::MATMUL_I8I8I32_RHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
       return MatmulOperandRole::RHS;
     case TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE:
     case TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS_TRANSPOSE:
       return MatmulOperandRole::RHS_TRANSPOSE;
     case TensorEncoding::MATMUL_F32F32F32_RESULT:
     case TensorEncoding::MATMUL_I8I8I32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
       return MatmulOperandRole::RESULT;
     default:
       return std::nullopt;
   }
 }
 
+int64_t getMatmulNumBatchDims(TensorEncoding encoding) {
+  switch (encoding) {
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS_TRANSPOSE:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
 void adjustTileSizesToNarrowStaticShape(MaterializeEncodingInfo &encodingInfo,
                                         ArrayRef<int64_t> shape) {
-  for (size_t i = 0; i < shape.size(); i++) {
+  for (size_t i = 0; i < encodingInfo.innerDimsPos.size(); i++) {
     int64_t size = shape[encodingInfo.innerDimsPos[i]];
     // Dynamic sizes are assumed to be large enough, not to be candidates for
     // narrow kernels.
@@ -366,10 +410,11 @@ chooseDynamicEncodingInfoVMVXMicrokernels(RankedTensorType tensorType,
   } else {
     return failure();
   }
-  SmallVector<Type> tileSizesTypes(tensorType.getRank(),
-                                   builder.getIndexType());
+  // Batch dimensions are not tiled, only query the trailing matrix dimensions.
+  ArrayRef<int64_t> matrixShape = tensorType.getShape().take_back(2);
+  SmallVector<Type> tileSizesTypes(matrixShape.size(), builder.getIndexType());
   SmallVector<Value> shapeValues;
-  for (int64_t i : tensorType.getShape()) {
+  for (int64_t i : matrixShape) {
     shapeValues.push_back(builder.create<arith::ConstantIndexOp>(loc, i));
   }
   auto op = builder.create<IREE::VMVX::QueryTileSizesOp>(
@@ -13,13 +13,26 @@
 namespace mlir {
 namespace iree_compiler {
 
-/// Command line to use native hardware operations instead of polynomial
-/// approximation.
+/// Command line to use native operations instead of polynomial approximation.
+/// This trades speed for accuracy: the approximations are vectorized along with
+/// the surrounding code while native operations are either hardware
+/// instructions of varying precision (GPU) or scalar libm calls (CPU).
+/// This is a boolean because there are only two modes. The upstream
+/// approximations are the fastest lowering that works on every backend, and
+/// the lower-precision variants (e.g. the AVX2 rsqrt) emit target-specific ops
+/// that our pipelines don't lower.
 static llvm::cl::opt<bool> clNativeMathPrecision(
-    "iree-codegen-gpu-native-math-precision",
+    "iree-codegen-native-math-precision",
     llvm::cl::desc(
-        "Skip polynomial lowering for math op natively available on GPU"),
+        "Skip polynomial approximation of math ops that have a native lowering "
+        "on the target (hardware instructions on GPU, libm calls on CPU). Ops "
+        "without one, like math.erf, are always approximated. The VMVX backend "
+        "always lowers math ops to VM ops and is unaffected."),
     llvm::cl::init(false));
+static llvm::cl::alias clNativeMathPrecisionGPU(
+    "iree-codegen-gpu-native-math-precision",
+    llvm::cl::desc("Alias for --iree-codegen-native-math-precision"),
+    llvm::cl::aliasopt(clNativeMathPrecision));
 
 namespace {
 
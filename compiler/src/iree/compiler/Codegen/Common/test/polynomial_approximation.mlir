@@ -0,0 +1,19 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(func.func(iree-codegen-polynomial-approximation))' %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-codegen-native-math-precision --pass-pipeline='builtin.module(func.func(iree-codegen-polynomial-approximation))' %s | FileCheck %s --check-prefix=NATIVE
+
+func.func @gelu_math(%arg0: vector<8xf32>) -> (vector<8xf32>, vector<8xf32>, vector<8xf32>) {
+  %0 = math.erf %arg0 : vector<8xf32>
+  %1 = math.exp %arg0 : vector<8xf32>
+  %2 = math.tanh %arg0 : vector<8xf32>
+  return %0, %1, %2 : vector<8xf32>, vector<8xf32>, vector<8xf32>
+}
+// CHECK-LABEL: func.func @gelu_math
+//   CHECK-NOT:   math.erf
+//   CHECK-NOT:   math.exp
+//   CHECK-NOT:   math.tanh
+//       CHECK:   return {{.+}} : vector<8xf32>, vector<8xf32>, vector<8xf32>
+
+// NATIVE-LABEL: func.func @gelu_math
+//   NATIVE-NOT:   math.erf
+//       NATIVE:   math.exp {{.+}} : vector<8xf32>
+//       NATIVE:   math.tanh {{.+}} : vector<8xf32>
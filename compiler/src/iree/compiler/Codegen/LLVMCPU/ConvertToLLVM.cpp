@@ -275,6 +275,32 @@ struct ConvertHALInterfaceConstantLoadOp
   }
 };
 
+/// Returns the op producing the pointer that |ptr| is derived from by address
+/// computations, looking through memref descriptors, or nullptr if unknown.
+static Operation *getBasePointerOp(Value ptr) {
+  while (Operation *op = ptr.getDefiningOp()) {
+    if (auto gepOp = dyn_cast<LLVM::GEPOp>(op)) {
+      ptr = gepOp.getBase();
+    } else if (auto bitcastOp = dyn_cast<LLVM::BitcastOp>(op)) {
+      ptr = bitcastOp.getArg();
+    } else if (auto extractOp = dyn_cast<LLVM::ExtractValueOp>(op)) {
+      // Find the value inserted at the same position of the descriptor.
+      Value container = extractOp.getContainer();
+      auto insertOp = container.getDefiningOp<LLVM::InsertValueOp>();
+      while (insertOp &&
+             insertOp.getPosition() != extractOp.getPosition()) {
+        insertOp =
+            insertOp.getContainer().getDefiningOp<LLVM::InsertValueOp>();
+      }
+      if (!insertOp) return nullptr;
+      ptr = insertOp.getValue();
+    } else {
+      return op;
+    }
+  }
+  return nullptr;
+}
+
 /// Rewrites hal.interface.binding.subspan to ops loading from the ABI structs.
 ///
 /// The parent LLVMFuncOp must be compatible with HALDispatchABI.
@@ -296,6 +322,15 @@ struct ConvertHALInterfaceBindingSubspanOp
     auto memRefDesc = abi.loadBinding(
         subspanOp, operands.getBindingAttr().getInt(), operands.getByteOffset(),
         memRefType, operands.getDynamicDims(), rewriter);
+    if (subspanOp->hasAttr(kNontemporalBindingAttrName)) {
+      // Tag the binding pointer so the stores derived from it can be found
+      // once everything has been converted.
+      Value alignedPtr = memRefDesc.alignedPtr(rewriter, subspanOp.getLoc());
+      if (Operation *basePtrOp = getBasePointerOp(alignedPtr)) {
+        basePtrOp->setAttr(kNontemporalBindingAttrName,
+                           rewriter.getUnitAttr());
+      }
+    }
     rewriter.replaceOp(subspanOp, {memRefDesc});
     return success();
   }
@@ -517,6 +552,18 @@ void ConvertToLLVMPass::runOnOperation() {
       return signalPassFailure();
   }
 
+  // Make the stores to bindings tagged by LLVMCPUInsertStreamingHints
+  // non-temporal. Masked stores have no non-temporal form and are left as is.
+  module.walk([&](LLVM::StoreOp storeOp) {
+    Operation *basePtrOp = getBasePointerOp(storeOp.getAddr());
+    if (basePtrOp && basePtrOp->hasAttr(kNontemporalBindingAttrName)) {
+      storeOp.setNontemporal(true);
+    }
+  });
+  module.walk([&](Operation *op) {
+    op->removeAttr(kNontemporalBindingAttrName);
+  });
+
   // Post conversion patterns.
   {
     RewritePatternSet postPatterns(&getContext());
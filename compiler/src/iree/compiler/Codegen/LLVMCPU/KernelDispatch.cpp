@@ -161,14 +161,26 @@ static llvm::raw_ostream &operator<<(
   return os;
 }
 
-/// Returns true if all the input and output tensor operands of 'op' are fully
-/// dynamic.
-static bool isFullyDynamicOp(linalg::LinalgOp op) {
+/// Returns true if any of the loops of 'op' has a dynamic range.
+static bool isDynamicOp(linalg::LinalgOp op) {
   SmallVector<int64_t, 4> loopRanges = op.getStaticLoopRanges();
-  return llvm::all_of(loopRanges,
+  return llvm::any_of(loopRanges,
                       [](int64_t size) { return ShapedType::isDynamic(size); });
 }
 
+/// Returns true if the innermost parallel loop of 'op' has a static range. If
+/// 'op' has no parallel loops its innermost loop is checked instead.
+static bool hasStaticInnermostParallelLoop(linalg::LinalgOp op) {
+  SmallVector<int64_t, 4> loopRanges = op.getStaticLoopRanges();
+  SmallVector<utils::IteratorType> iterators = op.getIteratorTypesArray();
+  for (int i = loopRanges.size() - 1; i >= 0; --i) {
+    if (iterators[i] == utils::IteratorType::parallel) {
+      return !ShapedType::isDynamic(loopRanges[i]);
+    }
+  }
+  return !loopRanges.empty() && !ShapedType::isDynamic(loopRanges.back());
+}
+
 /// Returns the vectorization pre-processing strategy (padding, peeling) for the
 /// given LinalgOp, depending on the op traits and the target architecture.
 static VectorPreProcStrategy getVectorPreProcStrategy(
@@ -185,13 +197,19 @@ static VectorPreProcStrategy getVectorPreProcStrategy(
     return VectorPreProcStrategy::None;
   }
 
-  if (isFullyDynamicOp(linalgOp) && enableVectorPeeling) {
-    // Peeling is only enabled on fully dynamic shape ops for now.
-    return VectorPreProcStrategy::Peeling;
-  }
-
   auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(linalgOp);
 
+  if (isDynamicOp(linalgOp) && enableVectorPeeling) {
+    // Dynamic loops would otherwise be tiled by 1, so the remainder iterations
+    // are peeled off instead. This applies to ops with only some dynamic
+    // dimensions too (e.g., a dynamic sequence length). On x86 padding already
+    // handles dynamic outer dimensions, so it is kept there as long as the
+    // innermost parallel dimension, which gets vectorized, is static.
+    bool keepPadding = isX86(targetAttr) && enableVectorPadding &&
+                       hasStaticInnermostParallelLoop(linalgOp);
+    if (!keepPadding) return VectorPreProcStrategy::Peeling;
+  }
+
   // Default X86 specific strategy.
   if (isX86(targetAttr) && enableVectorPadding) {
     // Padding is only enabled on x86. It leads to too much overhead on RISC-V
@@ -574,20 +592,24 @@ static void setVectorSizesForDynamicShapes(
                                           reductionSizes.end());
   setAlwaysVectorizeSizes(op, parallelSizes, reductionSizes);
 
-  // If peeling is enabled and the 'op' is fully dynamic, we only vectorize the
-  // lowest order parallel dimension for now to avoid peeling higher level
-  // dimensions. If no parallel dimension is found to be vectorized, we try to
-  // vectorize the lowest order reduction dimension.
+  // If peeling is enabled and the 'op' has dynamic dimensions, we only
+  // vectorize the lowest order parallel dimension for now to avoid peeling
+  // higher level dimensions. The dimension may already be static, in which case
+  // nothing needs to be peeled. If no parallel dimension is found to be
+  // vectorized, we try to vectorize the lowest order reduction dimension.
 
-  if (!isFullyDynamicOp(op) ||
+  if (!isDynamicOp(op) ||
       vecPreProcStrategy != VectorPreProcStrategy::Peeling) {
     return;
   }
 
+  // Dimensions that were dynamic have been reset to a tile size of one above,
+  // static ones keep their original tile size.
   bool isParallelDimVectorized = false;
   for (int i = origParallelSizes.size() - 1; i >= 0; --i) {
     if (origParallelSizes[i] > 1) {
-      assert(parallelSizes[i] == 1 &&
+      assert((!ShapedType::isDynamic(op.getStaticLoopRanges()[i]) ||
+              parallelSizes[i] == 1) &&
              "This tile size should have been set to one");
       parallelSizes[i] = origParallelSizes[i];
       isParallelDimVectorized = true;
@@ -601,7 +623,8 @@ static void setVectorSizesForDynamicShapes(
 
   for (int i = origReductionSizes.size() - 1; i >= 0; --i) {
     if (origReductionSizes[i] > 1) {
-      assert(reductionSizes[i] == 1 &&
+      assert((!ShapedType::isDynamic(op.getStaticLoopRanges()[i]) ||
+              reductionSizes[i] == 1) &&
              "This tile size should have been set to one");
       reductionSizes[i] = origReductionSizes[i];
       break;
@@ -883,10 +906,54 @@ static SmallVector<int64_t> getMatmulWorkgroupSizes(func::FuncOp entryPointFn,
   return tileSizes;
 }
 
+/// Returns the tile sizes of the cache level of the triple tiling pipeline for
+/// a matmul-like |op| with vector level tile sizes |vectorTileSizes|, or an
+/// empty vector if the op doesn't have M, N and K dimensions.
+///
+/// The reduction dimension is tiled so that the LHS and RHS panels feeding a
+/// vector tile stay in L1. The distributed M and N tiles in |maxTileSizes| are
+/// bounded so that the LHS block stays in L2 and the RHS block in L3.
+static SmallVector<int64_t> getMatmulCacheTileSizes(
+    linalg::LinalgOp op, ArrayRef<int64_t> vectorTileSizes,
+    int64_t elementBytes, const TargetMLTransformInfo &targetMLTransInfo,
+    SmallVectorImpl<int64_t> &maxTileSizes) {
+  unsigned numLoops = op.getNumLoops();
+  if (numLoops < 3 || !targetMLTransInfo.l1CacheSizeInBytes) return {};
+  unsigned mDim = numLoops - 3, nDim = numLoops - 2, kDim = numLoops - 1;
+  int64_t mVecSize = std::max<int64_t>(vectorTileSizes[mDim], 1);
+  int64_t nVecSize = std::max<int64_t>(vectorTileSizes[nDim], 1);
+  int64_t kVecSize = std::max<int64_t>(vectorTileSizes[kDim], 1);
+
+  int64_t l1Elements = targetMLTransInfo.l1CacheSizeInBytes / elementBytes;
+  int64_t kCacheSize = (l1Elements - mVecSize * nVecSize) /
+                       (mVecSize + nVecSize) / kVecSize * kVecSize;
+  kCacheSize = std::max(kCacheSize, kVecSize);
+  int64_t kSize = op.getStaticLoopRanges()[kDim];
+  kCacheSize = getMaxTileSize(0, kSize, kCacheSize, kVecSize);
+
+  // The distribution picks power of 2 tile sizes and doubles them while
+  // they're below the max, so the bound is rounded down to a power of 2 to
+  // keep it from being overshot.
+  auto boundTileSize = [&](unsigned dim, int64_t cacheSize, int64_t vecSize) {
+    if (!cacheSize) return;
+    int64_t size = cacheSize / elementBytes / kCacheSize / vecSize * vecSize;
+    size = llvm::PowerOf2Floor(std::max(size, vecSize));
+    maxTileSizes[dim] = std::min(maxTileSizes[dim], std::max(size, vecSize));
+  };
+  boundTileSize(mDim, targetMLTransInfo.l2CacheSizeInBytes, mVecSize);
+  boundTileSize(nDim, targetMLTransInfo.l3CacheSizeInBytes, nVecSize);
+
+  SmallVector<int64_t> cacheTileSizes(numLoops, 0);
+  cacheTileSizes[kDim] = kCacheSize;
+  LLVM_DEBUG(KD_DBGS() << "Cache tile sizes: " << cacheTileSizes << "\n");
+  return cacheTileSizes;
+}
+
 /// Sets the lowering configuration for dispatch region with root op that
 /// implements the contraction operation interface.
 static LogicalResult setRootConfig(
-    func::FuncOp entryPointFn, linalg::ContractionOpInterface contractionOp) {
+    func::FuncOp entryPointFn, linalg::ContractionOpInterface contractionOp,
+    const TargetMLTransformInfo &targetMLTransInfo) {
   auto linalgOp = cast<linalg::LinalgOp>(contractionOp.getOperation());
   unsigned numLoops = linalgOp.getNumLoops();
   {
@@ -942,6 +1009,17 @@ static LogicalResult setRootConfig(
     maxTileSizes[0] = 1;
   }
 
+  // The triple tiling pipeline adds a tiling level for the data caches. It
+  // also bounds the distributed tile sizes, so it's computed before them.
+  SmallVector<int64_t> cacheTileSizes;
+  if (enableTripleTilingPipeline) {
+    int64_t elementBytes =
+        std::max<int64_t>(lhsShapedType.getElementTypeBitWidth() / 8, 1);
+    cacheTileSizes =
+        getMatmulCacheTileSizes(linalgOp, workgroupTileSizes, elementBytes,
+                                targetMLTransInfo, maxTileSizes);
+  }
+
   // There are hard-coded configurations in DoubleTilingPadExpert, so it only
   // works for linalg.matmul cases. We can relax it once we have better
   // scheduling, e.g., transform dialect.
@@ -986,11 +1064,8 @@ static LogicalResult setRootConfig(
     return setMatmulPadRootConfig(entryPointFn, contractionOp, flowTileSizes,
                                   workgroupTileSizes, vectorSize);
   }
-  // TODO(hanchung): We should make the tile sizes be related to memory
-  // hierarchy. They are derived from experiments for now.
-  if (enableTripleTilingPipeline) {
-    SmallVector<int64_t> l1TileSizes = {0, 0, 384};
-    TileSizesListType tripleTileSizes = {flowTileSizes, l1TileSizes,
+  if (!cacheTileSizes.empty()) {
+    TileSizesListType tripleTileSizes = {flowTileSizes, cacheTileSizes,
                                          workgroupTileSizes};
     if (isNoPadMultiTilingBeneficial(contractionOp, tripleTileSizes)) {
       return setMatmulNoPadRootConfig(entryPointFn, contractionOp,
@@ -1717,8 +1792,9 @@ static LogicalResult setRootConfigImpl(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
         .Case<IREE::LinalgExt::PackOp, tensor::PackOp>(
             [&](auto op) { return setPackOpRootConfig(entryPointFn, op); })
-        .Case<linalg::ContractionOpInterface>(
-            [&](auto op) { return setRootConfig(entryPointFn, op); })
+        .Case<linalg::ContractionOpInterface>([&](auto op) {
+          return setRootConfig(entryPointFn, op, targetMLTransInfo);
+        })
         .Case<linalg::LinalgOp>(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
         .Case<TilingInterface>(
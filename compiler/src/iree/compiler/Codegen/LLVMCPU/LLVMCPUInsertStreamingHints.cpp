@@ -0,0 +1,279 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===- LLVMCPUInsertStreamingHints.cpp ------------------------------------===//
+//
+// Bandwidth bound dispatches (large copies, transposes and elementwise ops)
+// stream through memory without reuse. This pass adds two hints for them:
+//
+// * Software prefetches for read streams whose stride per innermost loop
+//   iteration is at least a cache line. Hardware prefetchers handle unit
+//   stride streams well but lose track of large strides (e.g. the columns
+//   read by a transpose).
+// * Non-temporal stores for write-only bindings larger than the L3 cache,
+//   when the target configuration gives its size. Writing them through the
+//   cache only evicts the inputs being streamed. The bindings are marked here
+//   and the stores to them are made non-temporal during the conversion to
+//   LLVM.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Codegen/LLVMCPU/TargetMLTransformInfo.h"
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-llvmcpu-insert-streaming-hints"
+
+namespace mlir {
+namespace iree_compiler {
+
+/// Returns the binding subspan |memref| is a view of, or nullptr if it isn't a
+/// view of a binding.
+static IREE::HAL::InterfaceBindingSubspanOp getSourceBinding(Value memref) {
+  while (Operation *op = memref.getDefiningOp()) {
+    if (auto subspanOp = dyn_cast<IREE::HAL::InterfaceBindingSubspanOp>(op)) {
+      return subspanOp;
+    }
+    if (!isa<memref::SubViewOp, memref::CastOp, memref::ExpandShapeOp,
+             memref::CollapseShapeOp>(op)) {
+      return nullptr;
+    }
+    memref = op->getOperand(0);
+  }
+  return nullptr;
+}
+
+/// Returns how much |value| changes per iteration of |forOp| in units of the
+/// induction variable, or std::nullopt if it doesn't change linearly.
+static std::optional<int64_t> getInductionCoefficient(Value value,
+                                                      scf::ForOp forOp);
+
+static std::optional<int64_t> getInductionCoefficient(
+    AffineExpr expr, ValueRange dimOperands, ValueRange symbolOperands,
+    scf::ForOp forOp) {
+  if (auto dimExpr = expr.dyn_cast<AffineDimExpr>()) {
+    return getInductionCoefficient(dimOperands[dimExpr.getPosition()], forOp);
+  }
+  if (auto symbolExpr = expr.dyn_cast<AffineSymbolExpr>()) {
+    return getInductionCoefficient(symbolOperands[symbolExpr.getPosition()],
+                                   forOp);
+  }
+  if (expr.isa<AffineConstantExpr>()) return 0;
+  auto binaryExpr = expr.cast<AffineBinaryOpExpr>();
+  auto lhs = getInductionCoefficient(binaryExpr.getLHS(), dimOperands,
+                                     symbolOperands, forOp);
+  if (!lhs) return std::nullopt;
+  switch (expr.getKind()) {
+    case AffineExprKind::Add: {
+      auto rhs = getInductionCoefficient(binaryExpr.getRHS(), dimOperands,
+                                         symbolOperands, forOp);
+      if (!rhs) return std::nullopt;
+      return *lhs + *rhs;
+    }
+    case AffineExprKind::Mul: {
+      auto rhs = binaryExpr.getRHS().dyn_cast<AffineConstantExpr>();
+      if (!rhs) return std::nullopt;
+      return *lhs * rhs.getValue();
+    }
+    default:
+      // Divisions and remainders are only linear if they don't depend on the
+      // induction variable.
+      if (*lhs != 0) return std::nullopt;
+      return 0;
+  }
+}
+
+static std::optional<int64_t> getInductionCoefficient(Value value,
+                                                      scf::ForOp forOp) {
+  if (value == forOp.getInductionVar()) return 1;
+  if (forOp.isDefinedOutsideOfLoop(value)) return 0;
+  Operation *op = value.getDefiningOp();
+  if (!op) return std::nullopt;
+  if (auto applyOp = dyn_cast<AffineApplyOp>(op)) {
+    AffineMap map = applyOp.getAffineMap();
+    return getInductionCoefficient(
+        map.getResult(0), applyOp.getMapOperands().take_front(map.getNumDims()),
+        applyOp.getMapOperands().drop_front(map.getNumDims()), forOp);
+  }
+  if (auto addOp = dyn_cast<arith::AddIOp>(op)) {
+    auto lhs = getInductionCoefficient(addOp.getLhs(), forOp);
+    auto rhs = getInductionCoefficient(addOp.getRhs(), forOp);
+    if (!lhs || !rhs) return std::nullopt;
+    return *lhs + *rhs;
+  }
+  if (auto mulOp = dyn_cast<arith::MulIOp>(op)) {
+    APInt constant;
+    if (matchPattern(mulOp.getRhs(), m_ConstantInt(&constant))) {
+      auto lhs = getInductionCoefficient(mulOp.getLhs(), forOp);
+      if (!lhs) return std::nullopt;
+      return *lhs * constant.getSExtValue();
+    }
+  }
+  if (isa<arith::ConstantOp>(op)) return 0;
+  return std::nullopt;
+}
+
+/// Inserts a prefetch |distance| iterations ahead of the read of |memref| at
+/// |indices| in |forOp| if its stride per iteration is at least
+/// |minStrideInBytes|.
+static void prefetchStridedStream(OpBuilder &builder, Operation *readOp,
+                                  Value memref, ValueRange indices,
+                                  scf::ForOp forOp, int64_t minStrideInBytes,
+                                  int64_t distance) {
+  if (!getSourceBinding(memref)) return;
+  auto memrefType = memref.getType().cast<MemRefType>();
+  SmallVector<int64_t> strides;
+  int64_t offset;
+  if (failed(getStridesAndOffset(memrefType, strides, offset))) return;
+
+  SmallVector<int64_t> coefficients;
+  int64_t strideInElements = 0;
+  for (auto [index, stride] : llvm::zip_equal(indices, strides)) {
+    auto coefficient = getInductionCoefficient(index, forOp);
+    if (!coefficient) return;
+    if (*coefficient != 0) {
+      if (ShapedType::isDynamic(stride)) return;
+      strideInElements += *coefficient * stride;
+    }
+    coefficients.push_back(*coefficient);
+  }
+  if (!memrefType.getElementType().isIntOrFloat()) return;
+  int64_t elementBytes =
+      std::max<int64_t>(memrefType.getElementTypeBitWidth() / 8, 1);
+  auto step = getConstantIntValue(forOp.getStep());
+  if (!step) return;
+  int64_t strideInBytes = std::abs(strideInElements * elementBytes * *step);
+  if (strideInBytes < minStrideInBytes) return;
+
+  LLVM_DEBUG(llvm::dbgs() << "prefetching stream with stride " << strideInBytes
+                          << " bytes read by " << *readOp << "\n");
+  builder.setInsertionPoint(readOp);
+  Location loc = readOp->getLoc();
+  SmallVector<Value> prefetchIndices;
+  for (auto [index, coefficient] : llvm::zip_equal(indices, coefficients)) {
+    if (coefficient == 0) {
+      prefetchIndices.push_back(index);
+      continue;
+    }
+    Value delta = builder.create<arith::ConstantIndexOp>(
+        loc, coefficient * *step * distance);
+    prefetchIndices.push_back(builder.create<arith::AddIOp>(loc, index, delta));
+  }
+  builder.create<memref::PrefetchOp>(loc, memref, prefetchIndices,
+                                     /*isWrite=*/false, /*localityHint=*/3,
+                                     /*isDataCache=*/true);
+}
+
+/// Returns true if all uses of |value|, including those through views, write
+/// to it.
+static bool isWriteOnly(Value value) {
+  for (Operation *user : value.getUsers()) {
+    if (isa<memref::SubViewOp, memref::CastOp, memref::ExpandShapeOp,
+            memref::CollapseShapeOp>(user)) {
+      if (!isWriteOnly(user->getResult(0))) return false;
+      continue;
+    }
+    if (!isa<vector::StoreOp, vector::MaskedStoreOp, vector::TransferWriteOp,
+             memref::StoreOp>(user)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+
+class LLVMCPUInsertStreamingHintsPass
+    : public LLVMCPUInsertStreamingHintsBase<LLVMCPUInsertStreamingHintsPass> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, memref::MemRefDialect>();
+  }
+
+  void runOnOperation() override {
+    func::FuncOp funcOp = getOperation();
+    auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(funcOp);
+    auto targetMLTransInfo =
+        TargetMLTransformInfo::getTargetMLTransformInfo(targetAttr);
+
+    if (targetMLTransInfo.enableSoftwarePrefetch) {
+      // Only innermost loops are considered: the streams of outer loops are
+      // covered by the prefetches of the inner ones.
+      SmallVector<scf::ForOp> innermostLoops;
+      funcOp.walk([&](scf::ForOp forOp) {
+        if (forOp.getBody()->walk([](scf::ForOp) {
+              return WalkResult::interrupt();
+            }).wasInterrupted()) {
+          return;
+        }
+        innermostLoops.push_back(forOp);
+      });
+      OpBuilder builder(&getContext());
+      for (auto forOp : innermostLoops) {
+        SmallVector<std::tuple<Operation *, Value, ValueRange>> reads;
+        forOp.getBody()->walk([&](Operation *op) {
+          if (auto loadOp = dyn_cast<vector::LoadOp>(op)) {
+            reads.emplace_back(op, loadOp.getBase(), loadOp.getIndices());
+          } else if (auto readOp = dyn_cast<vector::TransferReadOp>(op)) {
+            reads.emplace_back(op, readOp.getSource(), readOp.getIndices());
+          } else if (auto loadOp = dyn_cast<memref::LoadOp>(op)) {
+            reads.emplace_back(op, loadOp.getMemRef(), loadOp.getIndices());
+          }
+        });
+        for (auto [readOp, memref, indices] : reads) {
+          if (!memref.getType().isa<MemRefType>()) continue;
+          prefetchStridedStream(builder, readOp, memref, indices, forOp,
+                                targetMLTransInfo.cacheLineSizeInBytes,
+                                targetMLTransInfo.prefetchDistance);
+        }
+      }
+    }
+
+    if (targetMLTransInfo.enableNontemporalStores) {
+      // The L2 size is only a default and is much smaller than the real last
+      // level cache, so outputs are only streamed when the L3 size is known.
+      int64_t lastLevelCacheSize = targetMLTransInfo.l3CacheSizeInBytes;
+      if (!lastLevelCacheSize) return;
+      funcOp.walk([&](IREE::HAL::InterfaceBindingSubspanOp subspanOp) {
+        auto memrefType = subspanOp.getType().dyn_cast<MemRefType>();
+        if (!memrefType || !memrefType.hasStaticShape() ||
+            !memrefType.getElementType().isIntOrFloat()) {
+          return;
+        }
+        int64_t sizeInBytes = memrefType.getNumElements() *
+                              memrefType.getElementTypeBitWidth() / 8;
+        if (sizeInBytes <= lastLevelCacheSize) return;
+        if (!isWriteOnly(subspanOp.getResult())) return;
+        LLVM_DEBUG(llvm::dbgs() << "using non-temporal stores for "
+                                << subspanOp << "\n");
+        subspanOp->setAttr(kNontemporalBindingAttrName,
+                           UnitAttr::get(&getContext()));
+      });
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createLLVMCPUInsertStreamingHintsPass() {
+  return std::make_unique<LLVMCPUInsertStreamingHintsPass>();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
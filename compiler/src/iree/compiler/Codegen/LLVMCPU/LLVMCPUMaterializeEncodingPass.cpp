@@ -124,7 +124,8 @@ void LLVMCPUMaterializeEncodingPass::runOnOperation() {
         MatmulTileParams tileParams =
             chooseMatmulTileParams(*matmulType, targetAttr);
         auto encodingInfo = chooseEncodingInfoForMatmul(
-            *matmulType, *matmulOperandRole, tileParams);
+            *matmulType, *matmulOperandRole, tileParams,
+            getMatmulNumBatchDims(*encoding));
         adjustTileSizesToNarrowStaticShape(encodingInfo, tensorType.getShape());
         return encodingInfo;
       });
@@ -724,6 +724,10 @@ static void addLowerToLLVMPasses(OpPassManager &passManager) {
   passManager.addNestedPass<func::FuncOp>(
       createHoistStaticallyBoundAllocationsPass());
 
+  // Prefetch strided streams and mark outputs for non-temporal stores.
+  passManager.addNestedPass<func::FuncOp>(
+      createLLVMCPUInsertStreamingHintsPass());
+
   // Checking stack allocation before converting to CF dialect is easier.
   // Do not check allocation if hoist-padding is enabled. It intends to allocate
   // big stack buffers for better accessing.
@@ -751,6 +755,7 @@ static void addLowerToLLVMPasses(OpPassManager &passManager) {
 }
 
 void buildLLVMCPUCodegenPassPipeline(OpPassManager &passManager) {
+  addTuningDatabasePasses(passManager);
   passManager.addNestedPass<ModuleOp>(
       createVerifyLinalgTransformLegalityPass());
   passManager.nest<ModuleOp>().addNestedPass<func::FuncOp>(
@@ -20,6 +20,13 @@ struct RISCVTargetMLTransformInfo : TargetMLTransformInfo {
   }
 };
 
+struct X86TargetMLTransformInfo : TargetMLTransformInfo {
+  X86TargetMLTransformInfo() {
+    enableSoftwarePrefetch = true;
+    enableNontemporalStores = true;
+  }
+};
+
 }  // namespace
 
 namespace mlir {
@@ -27,11 +34,22 @@ namespace iree_compiler {
 
 const TargetMLTransformInfo TargetMLTransformInfo::getTargetMLTransformInfo(
     IREE::HAL::ExecutableTargetAttr targetAttr) {
+  TargetMLTransformInfo info;
   if (isRISCV(targetAttr)) {
-    return RISCVTargetMLTransformInfo();
+    info = RISCVTargetMLTransformInfo();
+  } else if (isX86(targetAttr)) {
+    info = X86TargetMLTransformInfo();
   }
 
-  return TargetMLTransformInfo();
+  auto overrideCacheSize = [&](StringRef name, int64_t &size) {
+    if (auto attr = getConfigIntegerAttr(targetAttr, name)) {
+      size = attr->getInt();
+    }
+  };
+  overrideCacheSize("l1_cache_size", info.l1CacheSizeInBytes);
+  overrideCacheSize("l2_cache_size", info.l2CacheSizeInBytes);
+  overrideCacheSize("l3_cache_size", info.l3CacheSizeInBytes);
+  return info;
 };
 
 }  // namespace iree_compiler
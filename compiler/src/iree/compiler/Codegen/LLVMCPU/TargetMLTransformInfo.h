@@ -21,6 +21,23 @@ struct TargetMLTransformInfo {
   unsigned defaultMaxTransposeUnrollFactor =
       std::numeric_limits<unsigned>::max();
 
+  // Sizes of the data caches used to derive the cache tiling levels. A size of
+  // 0 means that the cache level is unknown and is not tiled for. They are
+  // taken from the `l1_cache_size`, `l2_cache_size` and `l3_cache_size`
+  // entries of the target configuration when present.
+  int64_t l1CacheSizeInBytes = 32 * 1024;
+  int64_t l2CacheSizeInBytes = 256 * 1024;
+  int64_t l3CacheSizeInBytes = 0;
+  int64_t cacheLineSizeInBytes = 64;
+
+  // Streaming hints for bandwidth bound dispatches: software prefetches
+  // |prefetchDistance| iterations ahead for read streams with a stride of at
+  // least a cache line, and non-temporal stores for write-only outputs larger
+  // than the L3 cache. The latter need `l3_cache_size` to be set.
+  bool enableSoftwarePrefetch = false;
+  int64_t prefetchDistance = 8;
+  bool enableNontemporalStores = false;
+
   static const TargetMLTransformInfo getTargetMLTransformInfo(
       IREE::HAL::ExecutableTargetAttr targetAttr);
 };
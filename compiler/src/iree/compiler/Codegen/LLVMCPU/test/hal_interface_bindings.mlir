@@ -31,3 +31,26 @@ func.func @binding_ptrs() {
 llvm.func @sink(%arg0: f32) {
   llvm.return
 }
+
+// -----
+
+// CHECK-LABEL: llvm.func @nontemporal_binding_stores
+func.func @nontemporal_binding_stores() {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %in = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<16xf32>
+  %out = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) {iree_codegen.nontemporal} : memref<16xf32>
+
+  // The tag is dropped from the binding pointer once the stores are updated.
+  // CHECK-NOT: iree_codegen.nontemporal
+  // CHECK: %[[VALUE:.+]] = llvm.load %{{.+}} : !llvm.ptr<f32>
+  %value = memref.load %in[%c0] : memref<16xf32>
+
+  // Only the stores to the tagged binding are non-temporal.
+  // CHECK: llvm.store %[[VALUE]], %{{.+}} {nontemporal}
+  memref.store %value, %out[%c1] : memref<16xf32>
+  // CHECK-NOT: nontemporal
+  // CHECK: llvm.store %[[VALUE]], %{{.+}} :
+  memref.store %value, %in[%c1] : memref<16xf32>
+  return
+}
@@ -0,0 +1,80 @@
+// RUN: iree-opt --pass-pipeline='builtin.module(func.func(iree-llvmcpu-insert-streaming-hints))' --split-input-file %s | FileCheck %s
+
+#executable_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  l3_cache_size = 1048576 : index,
+  target_triple = "x86_64-unknown-linux-gnu"
+}>
+func.func @transpose_stream() attributes {hal.executable.target = #executable_target} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %c1024 = arith.constant 1024 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  %in = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : memref<1024x1024xf32>
+  %out = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : memref<1024x1024xf32>
+  scf.for %i = %c0 to %c1024 step %c8 {
+    scf.for %j = %c0 to %c1024 step %c1 {
+      %0 = vector.load %in[%j, %i] : memref<1024x1024xf32>, vector<8xf32>
+      vector.store %0, %out[%i, %j] : memref<1024x1024xf32>, vector<8xf32>
+    }
+  }
+  return
+}
+// The input is read down its columns, 4KB apart, and is prefetched 8
+// iterations ahead. The output is only written and is larger than the L3.
+// CHECK-LABEL: func.func @transpose_stream()
+//       CHECK:   %[[IN:.+]] = hal.interface.binding.subspan set(0) binding(0)
+//   CHECK-NOT:     iree_codegen.nontemporal
+//       CHECK:   %[[OUT:.+]] = hal.interface.binding.subspan set(0) binding(1)
+//  CHECK-SAME:     {iree_codegen.nontemporal}
+//       CHECK:   scf.for %[[I:.+]] =
+//       CHECK:     scf.for %[[J:.+]] =
+//       CHECK:       %[[C8:.+]] = arith.constant 8 : index
+//       CHECK:       %[[AHEAD:.+]] = arith.addi %[[J]], %[[C8]]
+//       CHECK:       memref.prefetch %[[IN]][%[[AHEAD]], %[[I]]], read, locality<3>, data
+//       CHECK:       vector.load %[[IN]][%[[J]], %[[I]]]
+
+// -----
+
+#executable_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  target_triple = "x86_64-unknown-linux-gnu"
+}>
+func.func @small_contiguous_copy() attributes {hal.executable.target = #executable_target} {
+  %c0 = arith.constant 0 : index
+  %c8 = arith.constant 8 : index
+  %c1024 = arith.constant 1024 : index
+  %in = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : memref<1024xf32>
+  %out = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : memref<1024xf32>
+  scf.for %i = %c0 to %c1024 step %c8 {
+    %0 = vector.load %in[%i] : memref<1024xf32>, vector<8xf32>
+    vector.store %0, %out[%i] : memref<1024xf32>, vector<8xf32>
+  }
+  return
+}
+// Unit stride streams are left to the hardware prefetchers and outputs that
+// fit in cache use regular stores.
+// CHECK-LABEL: func.func @small_contiguous_copy()
+//   CHECK-NOT:   memref.prefetch
+//   CHECK-NOT:   iree_codegen.nontemporal
+
+// -----
+
+#executable_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  target_triple = "x86_64-unknown-linux-gnu"
+}>
+func.func @unknown_l3_copy() attributes {hal.executable.target = #executable_target} {
+  %c0 = arith.constant 0 : index
+  %c8 = arith.constant 8 : index
+  %c1048576 = arith.constant 1048576 : index
+  %in = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : memref<1048576xf32>
+  %out = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : memref<1048576xf32>
+  scf.for %i = %c0 to %c1048576 step %c8 {
+    %0 = vector.load %in[%i] : memref<1048576xf32>, vector<8xf32>
+    vector.store %0, %out[%i] : memref<1048576xf32>, vector<8xf32>
+  }
+  return
+}
+// Without the L3 size the last level cache isn't known and large outputs
+// still use regular stores.
+// CHECK-LABEL: func.func @unknown_l3_copy()
+//   CHECK-NOT:   iree_codegen.nontemporal
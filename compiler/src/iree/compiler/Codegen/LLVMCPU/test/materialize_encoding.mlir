@@ -759,3 +759,50 @@ func.func @matmul_lowering_i8i8i32_x86_64_avx512vnni() attributes {
 // CHECK-SAME:       outs(%[[OUTS]] :
 //      CHECK:   flow.dispatch.tensor.store %[[MMT4D]], %[[OUTS_BINDING]]
 // CHECK-SAME:       offsets = [0, 0, 0, 0], sizes = [%[[TILED_M]], %[[TILED_N]], 16, 16], strides = [1, 1, 1, 1]
+
+// -----
+
+func.func @batch_matmul_lowering_f32f32f32_x86_64_avx512f() attributes {
+  hal.executable.target = #hal.executable.target<"xyz", "xyz", {target_triple="x86_64-xyz-xyz", cpu_features="+avx512f"}>
+} {
+  %c0 = arith.constant 0 : index
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readonly:tensor<4x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>>
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readonly:tensor<4x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>>
+  %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readwrite:tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [4, 128, 256], strides = [1, 1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<4x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>>
+      -> tensor<4x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0], sizes = [4, 256, 512], strides = [1, 1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<4x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>>
+      -> tensor<4x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>
+  %5 = flow.dispatch.tensor.load %2, offsets = [0, 0, 0], sizes = [4, 128, 512], strides = [1, 1, 1]
+      : !flow.dispatch.tensor<readwrite:tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>>
+      -> tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  %6 = linalg.batch_matmul
+      ins(%3, %4 : tensor<4x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>,
+                   tensor<4x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>)
+      outs(%5 : tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>)
+      -> tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  flow.dispatch.tensor.store %6, %2, offsets = [0, 0, 0], sizes = [4, 128, 512], strides = [1, 1, 1]
+      : tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+      -> !flow.dispatch.tensor<readwrite:tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>>
+  return
+}
+//      CHECK: func @batch_matmul_lowering_f32f32f32_x86_64_avx512f()
+//      CHECK:   %[[LHS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(0)
+// CHECK-SAME:       !flow.dispatch.tensor<readonly:tensor<4x8x256x16x1xf32>>
+//      CHECK:   %[[RHS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(1)
+// CHECK-SAME:       !flow.dispatch.tensor<readonly:tensor<4x32x256x16x1xf32>>
+//      CHECK:   %[[OUTS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(2)
+// CHECK-SAME:       !flow.dispatch.tensor<readwrite:tensor<4x8x32x16x16xf32>>
+//      CHECK:   %[[LHS:.+]] = flow.dispatch.tensor.load %[[LHS_BINDING]]
+//      CHECK:   %[[RHS:.+]] = flow.dispatch.tensor.load %[[RHS_BINDING]]
+//      CHECK:   %[[OUTS:.+]] = flow.dispatch.tensor.load %[[OUTS_BINDING]]
+//      CHECK:   %[[BATCH_MMT4D:.+]] = linalg.generic
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   flow.dispatch.tensor.store %[[BATCH_MMT4D]], %[[OUTS_BINDING]]
+// CHECK-SAME:       offsets = [0, 0, 0, 0, 0], sizes = [4, 8, 32, 16, 16], strides = [1, 1, 1, 1, 1]
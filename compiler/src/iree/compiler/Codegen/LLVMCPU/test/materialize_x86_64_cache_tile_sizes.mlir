@@ -0,0 +1,108 @@
+// RUN: iree-opt --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(iree-llvmcpu-lower-executable-target{test-lowering-configuration=true})))' --iree-llvmcpu-enable-triple-tiling-pipeline --split-input-file %s | FileCheck %s
+
+// The K tile keeps the 8xK LHS and Kx32 RHS panels of an 8x32 vector tile in
+// L1: K <= (8192 - 8 * 32) / (8 + 32) = 198 elements, which is rounded down to
+// 128, the largest multiple of 16 that divides 2048. M is bounded by L2 to
+// 32768 / 4 / 128 = 64 and N by L3 to 49152 / 4 / 128 = 96, rounded down to
+// 64.
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable private @matmul_cache_tiles  {
+  hal.executable.variant public @embedded_elf_x86_64, target = #hal.executable.target<
+    "llvm-cpu",
+    "embedded-elf-x86_64", {
+      data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+      l1_cache_size = 32768 : index,
+      l2_cache_size = 32768 : index,
+      l3_cache_size = 49152 : index,
+      native_vector_size = 16 : index,
+      target_triple = "x86_64-unknown-unknown-eabi-elf"
+    }> {
+    hal.executable.export public @matmul_cache_tiles layout(#pipeline_layout)
+    builtin.module {
+      func.func @matmul_cache_tiles() {
+        %cst = arith.constant 0.0 : f32
+        %lhs_binding = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<1024x2048xf32>>
+        %rhs_binding = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<2048x1024xf32>>
+        %result_binding = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<1024x1024xf32>>
+        %lhs = flow.dispatch.tensor.load %lhs_binding, offsets = [0, 0], sizes = [1024, 2048], strides = [1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<1024x2048xf32>> -> tensor<1024x2048xf32>
+        %rhs = flow.dispatch.tensor.load %rhs_binding, offsets = [0, 0], sizes = [2048, 1024], strides = [1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<2048x1024xf32>> -> tensor<2048x1024xf32>
+        %init = tensor.empty() : tensor<1024x1024xf32>
+        %fill = linalg.fill ins(%cst : f32) outs(%init : tensor<1024x1024xf32>) -> tensor<1024x1024xf32>
+        %gemm = linalg.matmul ins(%lhs, %rhs : tensor<1024x2048xf32>, tensor<2048x1024xf32>)
+            outs(%fill : tensor<1024x1024xf32>) -> tensor<1024x1024xf32>
+        flow.dispatch.tensor.store %gemm, %result_binding, offsets = [0, 0], sizes = [1024, 1024], strides = [1, 1]
+            : tensor<1024x1024xf32> -> !flow.dispatch.tensor<writeonly:tensor<1024x1024xf32>>
+        return
+      }
+    }
+  }
+}
+
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[64, 64, 0], [0, 0, 128], [8, 32, 0], [0, 0, 16]{{\]}}>
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<CPUTripleTilingExpert>
+//      CHECK: hal.executable.export public @matmul_cache_tiles
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK: linalg.matmul
+// CHECK-SAME:     lowering_config = #[[CONFIG]]
+
+// -----
+
+// Batch matmuls don't have a cache level yet, but the M and N distribution
+// sizes are bounded the same way.
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable private @batch_matmul_cache_tiles  {
+  hal.executable.variant public @embedded_elf_x86_64, target = #hal.executable.target<
+    "llvm-cpu",
+    "embedded-elf-x86_64", {
+      data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+      l1_cache_size = 32768 : index,
+      l2_cache_size = 32768 : index,
+      l3_cache_size = 49152 : index,
+      native_vector_size = 16 : index,
+      target_triple = "x86_64-unknown-unknown-eabi-elf"
+    }> {
+    hal.executable.export public @batch_matmul_cache_tiles layout(#pipeline_layout)
+    builtin.module {
+      func.func @batch_matmul_cache_tiles() {
+        %cst = arith.constant 0.0 : f32
+        %lhs_binding = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<4x1024x2048xf32>>
+        %rhs_binding = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<4x2048x1024xf32>>
+        %result_binding = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<4x1024x1024xf32>>
+        %lhs = flow.dispatch.tensor.load %lhs_binding, offsets = [0, 0, 0], sizes = [4, 1024, 2048], strides = [1, 1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<4x1024x2048xf32>> -> tensor<4x1024x2048xf32>
+        %rhs = flow.dispatch.tensor.load %rhs_binding, offsets = [0, 0, 0], sizes = [4, 2048, 1024], strides = [1, 1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<4x2048x1024xf32>> -> tensor<4x2048x1024xf32>
+        %init = tensor.empty() : tensor<4x1024x1024xf32>
+        %fill = linalg.fill ins(%cst : f32) outs(%init : tensor<4x1024x1024xf32>) -> tensor<4x1024x1024xf32>
+        %bmm = linalg.batch_matmul ins(%lhs, %rhs : tensor<4x1024x2048xf32>, tensor<4x2048x1024xf32>)
+            outs(%fill : tensor<4x1024x1024xf32>) -> tensor<4x1024x1024xf32>
+        flow.dispatch.tensor.store %bmm, %result_binding, offsets = [0, 0, 0], sizes = [4, 1024, 1024], strides = [1, 1, 1]
+            : tensor<4x1024x1024xf32> -> !flow.dispatch.tensor<writeonly:tensor<4x1024x1024xf32>>
+        return
+      }
+    }
+  }
+}
+
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[1, 64, 64, 0], [1, 8, 32, 0], [0, 0, 0, 16]{{\]}}>
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<CPUDoubleTilingExpert>
+//      CHECK: hal.executable.export public @batch_matmul_cache_tiles
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK: linalg.batch_matmul
+// CHECK-SAME:     lowering_config = #[[CONFIG]]
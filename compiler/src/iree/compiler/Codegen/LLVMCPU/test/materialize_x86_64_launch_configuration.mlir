@@ -176,6 +176,52 @@ hal.executable private @dot_dynamic  {
 
 // -----
 
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable private @matmul_partially_dynamic  {
+  hal.executable.variant @llvm, target = <"llvm-cpu", "embedded-elf-x86_64", {
+    data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+    native_vector_size = 16 : index,
+    target_triple = "x86_64-unknown-linux-gnu"
+  }> {
+    hal.executable.export @matmul_partially_dynamic layout(#pipeline_layout)
+    builtin.module {
+      func.func @matmul_partially_dynamic() {
+        %c0 = arith.constant 0 : index
+        %cst = arith.constant 0.000000e+00 : f32
+        %0 = hal.interface.constant.load[0] : i32
+        %1 = arith.index_cast %0 : i32 to index
+        %2 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<128x384xf32>>
+        %3 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<384x?xf32>>{%1}
+        %4 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<128x?xf32>>{%1}
+        %5 = flow.dispatch.tensor.load %2, offsets = [0, 0], sizes = [128, 384], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<128x384xf32>> -> tensor<128x384xf32>
+        %6 = flow.dispatch.tensor.load %3, offsets = [0, 0], sizes = [384, %1], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<384x?xf32>>{%1} -> tensor<384x?xf32>
+        %7 = tensor.empty(%1) : tensor<128x?xf32>
+        %8 = linalg.fill ins(%cst : f32) outs(%7 : tensor<128x?xf32>) -> tensor<128x?xf32>
+        %9 = linalg.matmul ins(%5, %6 : tensor<128x384xf32>, tensor<384x?xf32>) outs(%8 : tensor<128x?xf32>) -> tensor<128x?xf32>
+        flow.dispatch.tensor.store %9, %4, offsets = [0, 0], sizes = [128, %1], strides = [1, 1] : tensor<128x?xf32> -> !flow.dispatch.tensor<writeonly:tensor<128x?xf32>>{%1}
+        return
+      }
+    }
+  }
+}
+// Ops with only some dynamic dimensions are peeled like fully dynamic ones
+// when the innermost parallel dimension is dynamic. Otherwise x86 keeps
+// padding, see @gemm_unit_N.
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<CPUDoubleTilingPeelingExpert>
+//      CHECK: hal.executable.export public @matmul_partially_dynamic
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK: linalg.matmul
+// CHECK-SAME:     lowering_config = #[[CONFIG]]
+
+// -----
+
 #pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
   #hal.descriptor_set.layout<0, bindings = [
     #hal.descriptor_set.binding<0, storage_buffer>,
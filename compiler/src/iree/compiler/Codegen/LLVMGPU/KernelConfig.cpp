@@ -21,6 +21,7 @@
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 
@@ -53,6 +54,13 @@ llvm::cl::opt<std::string> clGPUCodegenTransformDialectDebugTransformTag(
     llvm::cl::desc(
         "tag attribute value for the transform dialect transform op container"),
     llvm::cl::init(""));
+
+llvm::cl::opt<unsigned> clGPUMaxSoftwarePipelineDepth(
+    "iree-codegen-llvmgpu-max-pipeline-depth",
+    llvm::cl::desc("maximum number of shared memory stages used to pipeline "
+                   "the global to shared memory copies of tensorcore matmuls; "
+                   "fewer are used when they don't fit in shared memory"),
+    llvm::cl::init(4));
 }  // namespace iree_compiler
 }  // namespace mlir
 
@@ -63,6 +71,9 @@ struct TargetInfo {
   // TODO: add finer grain control for other tensorcore types.
   bool hasTF32TensorCore = false;
   bool hasWarpShuffle = false;
+  // Shared memory a workgroup may allocate, including dynamic shared memory
+  // that needs to be opted into at kernel launch.
+  int64_t maxSharedMemoryBytes = 48 * 1024;
 };
 
 struct TileWorkgroupSizePair {
@@ -71,8 +82,6 @@ struct TileWorkgroupSizePair {
   std::array<int64_t, 3> workgroupSize;
 };
 
-// Software pipeline depths
-constexpr unsigned softwarePipelineDepthTensorCore = 4;
 // Simt codegen does not do software pipelining.
 constexpr unsigned softwarePipelineDepthSimt = 0;
 }  // namespace
@@ -102,6 +111,12 @@ static void getTensorCoreConfig(
   // to not rely on hardcoded configurations.
   if (isFp16) {
     tileSizes.push_back(TileWorkgroupSizePair({{32, 32, 32}, {64, 2, 1}}));
+    // Smaller fallbacks keep shapes that are only aligned to the native 16x16
+    // fragment on tensor cores instead of falling back to SIMT.
+    tileSizes.push_back(TileWorkgroupSizePair({{32, 32, 16}, {64, 2, 1}}));
+    tileSizes.push_back(TileWorkgroupSizePair({{16, 32, 16}, {64, 1, 1}}));
+    tileSizes.push_back(TileWorkgroupSizePair({{32, 16, 16}, {32, 2, 1}}));
+    tileSizes.push_back(TileWorkgroupSizePair({{16, 16, 16}, {32, 1, 1}}));
   } else {
     tileSizes.push_back(TileWorkgroupSizePair({{32, 32, 16}, {64, 2, 1}}));
     tileSizes.push_back(TileWorkgroupSizePair({{16, 32, 16}, {64, 1, 1}}));
@@ -154,14 +169,50 @@ static TargetInfo getTargetInfo(func::FuncOp entryPoint) {
   }
   int64_t smVersion = version.getZExtValue();
   if (smVersion >= 80) info.hasTF32TensorCore = true;
+  if (smVersion >= 90) {
+    info.maxSharedMemoryBytes = 227 * 1024;
+  } else if (smVersion == 80 || smVersion == 87) {
+    info.maxSharedMemoryBytes = 163 * 1024;
+  } else if (smVersion >= 75) {
+    // sm_75 allows 64KB and sm_86/sm_89 allow 99KB; use the common minimum.
+    info.maxSharedMemoryBytes = 64 * 1024;
+  }
   return info;
 }
 
+/// Returns the software pipeline depth of a tensorcore matmul with a reduction
+/// dimension of size |sizeK| tiled by |tileSizes|. Each stage holds one tile
+/// of the LHS and RHS in shared memory so the depth is the largest one that
+/// fits in the shared memory of the target, is at most the number of
+/// reduction tiles and is at most `clGPUMaxSoftwarePipelineDepth`.
+static unsigned getTensorCorePipelineDepth(const TargetInfo &targetInfo,
+                                           ArrayRef<int64_t> tileSizes,
+                                           int64_t sizeK,
+                                           int64_t elementBytes) {
+  int64_t tileM = tileSizes[0], tileN = tileSizes[1], tileK = tileSizes[2];
+  int64_t stageBytes = (tileM * tileK + tileK * tileN) * elementBytes;
+  int64_t depth = std::min<int64_t>(clGPUMaxSoftwarePipelineDepth,
+                                    targetInfo.maxSharedMemoryBytes /
+                                        stageBytes);
+  depth = std::min(depth, llvm::divideCeil(sizeK, tileK));
+  return std::max<int64_t>(depth, 1);
+}
+
 static bool supportsTensorCore(func::FuncOp entryPoint, linalg::LinalgOp op,
                                const TargetInfo &targetInfo) {
   // Limit tensor core pipeline to matmul as not all combinations of transpose
   // are supported upstream.
   if (!targetInfo.hasTF32TensorCore) return false;
+  // The vector to GPU lowering only handles contractions where the inputs and
+  // the accumulator share an f16 or f32 element type. Mixed precision ops
+  // vectorize into extensions feeding the contraction, which are not folded
+  // into the mma ops, and integer (IMMA) fragments have no lowering yet.
+  Type lhsElementType = getElementTypeOrSelf(op.getDpsInputOperand(0)->get());
+  Type rhsElementType = getElementTypeOrSelf(op.getDpsInputOperand(1)->get());
+  Type outElementType = getElementTypeOrSelf(op.getDpsInitOperand(0)->get());
+  if (lhsElementType != rhsElementType || lhsElementType != outElementType)
+    return false;
+  if (!lhsElementType.isF16() && !lhsElementType.isF32()) return false;
   if (!(isa<linalg::MatmulOp>(op) || isa<linalg::BatchMatmulOp>(op))) {
     assert(linalg::isaContractionOpInterface(op));
     // If this is not a named op matmul check some properties to make sure that
@@ -264,13 +315,8 @@ static LogicalResult setContractConfig(func::FuncOp entryPoint,
     /// Try tensorcore config first.
     if (supportsTensorCore(entryPoint, op, targetInfo)) {
       SmallVector<TileWorkgroupSizePair> TCtileSizeConfig;
-
-      getTensorCoreConfig(TCtileSizeConfig, op.getDpsInputOperand(0)
-                                                ->get()
-                                                .getType()
-                                                .cast<RankedTensorType>()
-                                                .getElementType()
-                                                .isF16());
+      Type elementType = getElementTypeOrSelf(op.getDpsInputOperand(0)->get());
+      getTensorCoreConfig(TCtileSizeConfig, elementType.isF16());
       // Pick the best configuration where the original shape is aligned on the
       // tile size.
       for (TileWorkgroupSizePair &config : TCtileSizeConfig) {
@@ -280,7 +326,9 @@ static LogicalResult setContractConfig(func::FuncOp entryPoint,
           return setMatmulConfig(
               config.tileSize[0], config.tileSize[1], config.tileSize[2],
               config.workgroupSize,
-              sizeK == config.tileSize[2] ? 1 : softwarePipelineDepthTensorCore,
+              getTensorCorePipelineDepth(
+                  targetInfo, config.tileSize, sizeK,
+                  elementType.getIntOrFloatBitWidth() / 8),
               IREE::Codegen::DispatchLoweringPassPipeline::
                   LLVMGPUMatmulTensorCore);
         }
@@ -362,6 +410,38 @@ static LogicalResult setFftConfig(func::FuncOp entryPoint,
       workgroupSize);
 }
 
+/// Sets the configuration of an attention op. After tiling to workgroups the
+/// op is decomposed into a flash attention loop nest that streams tiles of the
+/// keys and values with an online softmax, so the full score matrix is never
+/// materialized. Each workgroup handles one batch and a tile of the query
+/// sequence. The head dimension is left untiled as the decomposition needs
+/// complete dot products, and the query tile is also the step of the loop over
+/// the keys so it must divide both sequence lengths.
+static LogicalResult setAttentionConfig(func::FuncOp entryPoint,
+                                        IREE::LinalgExt::AttentionOp op) {
+  const int64_t maxSequenceTileSize = 64;
+  int64_t querySequenceLength = op.getQueryType().getShape()[1];
+  int64_t keySequenceLength = op.getKeyType().getShape()[1];
+  int64_t sequenceTileSize = 1;
+  if (!ShapedType::isDynamic(querySequenceLength) &&
+      !ShapedType::isDynamic(keySequenceLength)) {
+    for (int64_t tileSize = maxSequenceTileSize; tileSize > 1; tileSize /= 2) {
+      if (querySequenceLength % tileSize == 0 &&
+          keySequenceLength % tileSize == 0) {
+        sequenceTileSize = tileSize;
+        break;
+      }
+    }
+  }
+  TileSizesListType tileSizes = {{1, sequenceTileSize, 0}};
+  // The decomposed ops carry no lowering config and run serially in the
+  // workgroup.
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPoint, op, tileSizes,
+      IREE::Codegen::DispatchLoweringPassPipeline::LLVMGPUDistribute,
+      {1, 1, 1});
+}
+
 static LogicalResult setSortConfig(func::FuncOp entryPoint, Operation *op) {
   TileSizesListType tileSizes;
   auto interfaceOp = cast<PartitionableLoopsInterface>(*op);
@@ -609,9 +689,14 @@ static LogicalResult setWarpReductionConfig(func::FuncOp entryPoint,
   const int64_t maxWorkgroupSize = 1024;
   int64_t groupSize = *dimSize / vectorSize;
   if (groupSize > maxWorkgroupSize) {
-    groupSize = llvm::APIntOps::GreatestCommonDivisor(
-                    {64, uint64_t(groupSize)}, {64, uint64_t(maxWorkgroupSize)})
-                    .getZExtValue();
+    // Each thread loops over the row, so use the largest number of warps that
+    // evenly divides it. The partial results of the warps are combined through
+    // shared memory, which doesn't need a power of two number of warps; this
+    // keeps rows with odd factors from being reduced by a handful of warps.
+    int64_t numWarps = groupSize / cudaWarpSize;
+    int64_t numWarpsPerGroup = maxWorkgroupSize / cudaWarpSize;
+    while (numWarps % numWarpsPerGroup != 0) numWarpsPerGroup--;
+    groupSize = numWarpsPerGroup * cudaWarpSize;
   }
   std::array<int64_t, 3> workgroupSize = {groupSize, 1, 1};
   SmallVector<unsigned> partitionedLoops =
@@ -899,6 +984,9 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
   if (auto sortOp = dyn_cast<IREE::LinalgExt::SortOp>(computeOp)) {
     return setSortConfig(entryPointFn, sortOp);
   }
+  if (auto attentionOp = dyn_cast<IREE::LinalgExt::AttentionOp>(computeOp)) {
+    return setAttentionConfig(entryPointFn, attentionOp);
+  }
   return setRootDefaultConfig(entryPointFn, computeOp);
 }
 
@@ -587,3 +587,172 @@ hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb",
 //  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<LLVMGPUVectorize
 //      CHECK: hal.executable.export public @contract_reduction
 // CHECK-SAME:     translation_info = #[[TRANSLATION]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable @matmul_f16_aligned_16 {
+hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb", {target_arch = "sm_80"}> {
+  hal.executable.export public @matmul_f16_aligned_16 layout(#pipeline_layout)
+  builtin.module {
+    func.func @matmul_f16_aligned_16() {
+      %cst = arith.constant 0.000000e+00 : f16
+      %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<48x32xf16>>
+      %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<32x48xf16>>
+      %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<48x48xf16>>
+      %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [48, 32], strides = [1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<48x32xf16>> -> tensor<48x32xf16>
+      %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [32, 48], strides = [1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<32x48xf16>> -> tensor<32x48xf16>
+      %5 = tensor.empty() : tensor<48x48xf16>
+      %6 = linalg.fill ins(%cst : f16) outs(%5 : tensor<48x48xf16>) -> tensor<48x48xf16>
+      %7 = linalg.matmul
+          ins(%3, %4 : tensor<48x32xf16>, tensor<32x48xf16>) outs(%6 : tensor<48x48xf16>) -> tensor<48x48xf16>
+      flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [48, 48], strides = [1, 1] : tensor<48x48xf16> -> !flow.dispatch.tensor<writeonly:tensor<48x48xf16>>
+      return
+    }
+  }
+}
+}
+
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[16, 16, 16]{{\]}}>
+// The pipeline depth is bounded by the two iterations of the reduction loop.
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<LLVMGPUMatmulTensorCore pipeline_depth = 2>
+//      CHECK: hal.executable.export public @matmul_f16_aligned_16
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+// CHECK-SAME:     workgroup_size = [32 : index, 1 : index, 1 : index]
+//      CHECK:   linalg.matmul
+// CHECK-SAME:       lowering_config = #[[CONFIG]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable @matmul_i8_sm80 {
+hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb", {target_arch = "sm_80"}> {
+  hal.executable.export public @matmul_i8_sm80 layout(#pipeline_layout)
+  builtin.module {
+    func.func @matmul_i8_sm80() {
+      %c0_i32 = arith.constant 0 : i32
+      %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<128x256xi8>>
+      %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<256x1024xi8>>
+      %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<128x1024xi32>>
+      %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [128, 256], strides = [1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<128x256xi8>> -> tensor<128x256xi8>
+      %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [256, 1024], strides = [1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<256x1024xi8>> -> tensor<256x1024xi8>
+      %5 = tensor.empty() : tensor<128x1024xi32>
+      %6 = linalg.fill ins(%c0_i32 : i32) outs(%5 : tensor<128x1024xi32>) -> tensor<128x1024xi32>
+      %7 = linalg.matmul
+          ins(%3, %4 : tensor<128x256xi8>, tensor<256x1024xi8>) outs(%6 : tensor<128x1024xi32>) -> tensor<128x1024xi32>
+      flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [128, 1024], strides = [1, 1] : tensor<128x1024xi32> -> !flow.dispatch.tensor<writeonly:tensor<128x1024xi32>>
+      return
+    }
+  }
+}
+}
+
+// Integer matmuls have no tensor core lowering and stay on the SIMT pipeline.
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<LLVMGPUMatmulSimt
+//      CHECK: hal.executable.export public @matmul_i8_sm80
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>,
+    #hal.descriptor_set.binding<3, storage_buffer>
+  ]>
+]>
+hal.executable @attention {
+hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb", {target_arch = "sm_80"}> {
+  hal.executable.export public @attention layout(#pipeline_layout)
+  builtin.module {
+    func.func @attention() {
+      %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<16x96x64xf32>>
+      %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<16x1024x64xf32>>
+      %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<16x1024x64xf32>>
+      %3 = hal.interface.binding.subspan set(0) binding(3) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<16x96x64xf32>>
+      %4 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [16, 96, 64], strides = [1, 1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<16x96x64xf32>> -> tensor<16x96x64xf32>
+      %5 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0], sizes = [16, 1024, 64], strides = [1, 1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<16x1024x64xf32>> -> tensor<16x1024x64xf32>
+      %6 = flow.dispatch.tensor.load %2, offsets = [0, 0, 0], sizes = [16, 1024, 64], strides = [1, 1, 1]
+          : !flow.dispatch.tensor<readonly:tensor<16x1024x64xf32>> -> tensor<16x1024x64xf32>
+      %7 = tensor.empty() : tensor<16x96x64xf32>
+      %8 = iree_linalg_ext.attention
+          ins(%4, %5, %6 : tensor<16x96x64xf32>, tensor<16x1024x64xf32>, tensor<16x1024x64xf32>)
+          outs(%7 : tensor<16x96x64xf32>) -> tensor<16x96x64xf32>
+      flow.dispatch.tensor.store %8, %3, offsets = [0, 0, 0], sizes = [16, 96, 64], strides = [1, 1, 1] : tensor<16x96x64xf32> -> !flow.dispatch.tensor<writeonly:tensor<16x96x64xf32>>
+      return
+    }
+  }
+}
+}
+
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[1, 32, 0]{{\]}}>
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<LLVMGPUDistribute>
+//      CHECK: hal.executable.export public @attention
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+// CHECK-SAME:     workgroup_size = [1 : index, 1 : index, 1 : index]
+//      CHECK:   iree_linalg_ext.attention
+// CHECK-SAME:       lowering_config = #[[CONFIG]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>
+  ]>
+]>
+hal.executable private @warp_reduction_large_row {
+  hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb"> {
+    hal.executable.export public @warp_reduction_large_row ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @warp_reduction_large_row() {
+        %cst = arith.constant 0.000000e+00 : f32
+        %c0 = arith.constant 0 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<8x27648xf32>>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<8xf32>>
+        %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [8, 27648], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<8x27648xf32>> -> tensor<8x27648xf32>
+        %3 = tensor.empty() : tensor<8xf32>
+        %4 = linalg.fill ins(%cst : f32) outs(%3 : tensor<8xf32>) -> tensor<8xf32>
+        %5 = linalg.generic {
+          indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                           affine_map<(d0, d1) -> (d0)>],
+          iterator_types = ["parallel", "reduction"]}
+          ins(%2 : tensor<8x27648xf32>) outs(%4 : tensor<8xf32>) {
+        ^bb0(%arg0: f32, %arg1: f32):
+          %6 = arith.addf %arg0, %arg1 : f32
+          linalg.yield %6 : f32
+        } -> tensor<8xf32>
+        flow.dispatch.tensor.store %5, %1, offsets = [0], sizes = [8], strides = [1] : tensor<8xf32> -> !flow.dispatch.tensor<writeonly:tensor<8xf32>>
+        return
+      }
+    }
+  }
+}
+
+// The row takes 216 warps; 27 of them divide it evenly.
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[1], [0, 3456]{{\]}}>
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<LLVMGPUWarpReduction>
+//      CHECK: hal.executable.export public @warp_reduction_large_row
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+// CHECK-SAME:     workgroup_size = [864 : index, 1 : index, 1 : index]
+//      CHECK: linalg.generic
+// CHECK-SAME:   lowering_config = #[[CONFIG]]
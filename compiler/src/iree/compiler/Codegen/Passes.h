@@ -49,6 +49,18 @@ void addIREEComprehensiveBufferizePasses(
         std::nullopt,
     Optional<BufferizationOptions::MemCpyFn> memCpyFn = std::nullopt);
 
+/// Adds the pass setting the compilation info recorded in the tuning database
+/// given by `--iree-codegen-tuning-database` on dispatch root ops, if any.
+void addTuningDatabasePasses(OpPassManager &variantPassManager);
+
+/// Pass to set the compilation info recorded in the tuning database at
+/// `databasePath` on the root ops of dispatches that don't have one. The
+/// database maps `backend/format` target keys to dictionaries of op signatures
+/// to `#iree_codegen.compilation_info` attributes.
+std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
+createApplyTuningDatabasePass(StringRef databasePath = "",
+                              bool reportMissing = false);
+
 /// Pass to perform canonicalizations/cleanups related to HAL interface/buffer
 /// allocations and view operations.
 std::unique_ptr<OperationPass<func::FuncOp>> createCleanupBufferAllocViewPass();
@@ -267,6 +279,17 @@ createLLVMCPUEmitVectorizationRemarksPass();
 std::unique_ptr<OperationPass<ModuleOp>>
 createLLVMCPUCheckIRBeforeLLVMConversionPass();
 
+/// Unit attribute marking hal.interface.binding.subspan ops whose stores are
+/// made non-temporal when converting to LLVM.
+constexpr StringLiteral kNontemporalBindingAttrName =
+    "iree_codegen.nontemporal";
+
+/// Inserts software prefetches for strided read streams and marks large
+/// write-only bindings with `kNontemporalBindingAttrName`, as enabled by the
+/// target's TargetMLTransformInfo.
+std::unique_ptr<OperationPass<func::FuncOp>>
+createLLVMCPUInsertStreamingHintsPass();
+
 /// Pass to lower the module an hal.executable.variant operation to external
 /// dialect. Currently this pass lowers to LLVM dialect, but could be
 /// generalized to lower to any "final" dialect like SPIR-V/NVVM, etc.
@@ -16,6 +16,7 @@
 #include "llvm/ADT/TypeSwitch.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/TypeUtilities.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -35,6 +36,17 @@ static LogicalResult setAdrenoMatmulConfig(linalg::LinalgOp op,
   return setMatmulOpConfig(limits, op, workgroupXY, threadMNK);
 }
 
+/// Returns the best per-thread tiling factor for the convolution `op`, given
+/// the `baseTilingFactor` for 32-bit elements. 16-bit elements pack two values
+/// per register so get twice the tile.
+static int64_t getAdrenoConvTilingFactor(linalg::LinalgOp op,
+                                         int64_t baseTilingFactor) {
+  Value image = op.getDpsInputOperand(0)->get();
+  if (getElementTypeOrSelf(image).getIntOrFloatBitWidth() == 16)
+    return baseTilingFactor * 2;
+  return baseTilingFactor;
+}
+
 //===----------------------------------------------------------------------===//
 // Entry Point
 //===----------------------------------------------------------------------===//
@@ -55,11 +67,11 @@ LogicalResult setAdrenoCodeGenConfig(const spirv::TargetEnv &targetEnv,
       .Case<linalg::Conv2DNchwFchwOp, linalg::Conv2DNhwcHwcfOp>(
           [subgroupSize](auto op) {
             return setConvOpConfig(op, subgroupSize,
-                                   /*bestTilingFactor=*/32);
+                                   getAdrenoConvTilingFactor(op, 32));
           })
       .Case<linalg::DepthwiseConv2DNhwcHwcOp>([subgroupSize](auto op) {
         return setConvOpConfig(op, subgroupSize,
-                               /*bestTilingFactor=*/16);
+                               getAdrenoConvTilingFactor(op, 16));
       })
       .Default([](Operation *) { return success(); });
 }
@@ -46,6 +46,7 @@
 #include "mlir/Dialect/SPIRV/IR/SPIRVDialect.h"
 #include "mlir/Dialect/SPIRV/IR/SPIRVOps.h"
 #include "mlir/Dialect/SPIRV/IR/SPIRVTypes.h"
+#include "mlir/Dialect/SPIRV/IR/TargetAndABI.h"
 #include "mlir/Dialect/SPIRV/Transforms/SPIRVConversion.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/Builders.h"
@@ -261,6 +262,93 @@ struct HALInterfaceBindingSubspanConverter final
   const InterfaceResourceMap &interfaceToResourceVars;
 };
 
+/// A pattern to convert vector.reduction <add> over the products of four
+/// extended 8-bit integers into a SPIR-V integer dot product on packed i32
+/// values, for example:
+///
+///   %lhs = arith.extsi %a : vector<4xi8> to vector<4xi32>
+///   %rhs = arith.extsi %b : vector<4xi8> to vector<4xi32>
+///   %mul = arith.muli %lhs, %rhs : vector<4xi32>
+///   %sum = vector.reduction <add>, %mul, %acc : vector<4xi32> into i32
+///
+/// The accumulator is added with a plain spirv.IAdd instead of using
+/// spirv.SDotAccSat, given vector.reduction wraps around on overflow.
+struct VectorReductionToIntegerDotProduct final
+    : public OpConversionPattern<vector::ReductionOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult matchAndRewrite(
+      vector::ReductionOp reductionOp, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    if (reductionOp.getKind() != vector::CombiningKind::ADD) return failure();
+    auto resultType = reductionOp.getType().dyn_cast<IntegerType>();
+    if (!resultType || resultType.getWidth() != 32) return failure();
+
+    spirv::TargetEnv targetEnv(spirv::lookupTargetEnvOrDefault(reductionOp));
+    if (!targetEnv.allows(spirv::Capability::DotProduct) ||
+        !targetEnv.allows(spirv::Capability::DotProductInput4x8BitPacked)) {
+      return failure();
+    }
+
+    auto mulOp = reductionOp.getVector().getDefiningOp<arith::MulIOp>();
+    if (!mulOp) return failure();
+
+    // Returns the vector<4xi8> value extended to |value| and whether it is
+    // sign extended.
+    auto getPackedSource =
+        [](Value value) -> std::optional<std::pair<Value, bool>> {
+      Operation *extOp = value.getDefiningOp();
+      if (!isa_and_nonnull<arith::ExtSIOp, arith::ExtUIOp>(extOp)) {
+        return std::nullopt;
+      }
+      Value source = extOp->getOperand(0);
+      auto sourceType = source.getType().dyn_cast<VectorType>();
+      if (!sourceType || sourceType.getRank() != 1 ||
+          sourceType.getDimSize(0) != 4 ||
+          !sourceType.getElementType().isInteger(8)) {
+        return std::nullopt;
+      }
+      return std::make_pair(source, isa<arith::ExtSIOp>(extOp));
+    };
+    auto lhs = getPackedSource(mulOp.getLhs());
+    auto rhs = getPackedSource(mulOp.getRhs());
+    if (!lhs || !rhs) return failure();
+    // spirv.SUDot expects the signed operand first.
+    if (!lhs->second && rhs->second) std::swap(lhs, rhs);
+
+    Location loc = reductionOp.getLoc();
+    auto i32Type = rewriter.getI32Type();
+    auto packOperand = [&](Value source) -> Value {
+      Value converted = rewriter.getRemappedValue(source);
+      if (!converted || converted.getType() != source.getType()) return {};
+      return rewriter.create<spirv::BitcastOp>(loc, i32Type, converted);
+    };
+    Value packedLhs = packOperand(lhs->first);
+    Value packedRhs = packOperand(rhs->first);
+    if (!packedLhs || !packedRhs) return failure();
+
+    auto format = spirv::PackedVectorFormatAttr::get(
+        rewriter.getContext(),
+        spirv::PackedVectorFormat::PackedVectorFormat4x8Bit);
+    Value dot;
+    if (lhs->second && rhs->second) {
+      dot = rewriter.create<spirv::SDotOp>(loc, i32Type, packedLhs, packedRhs,
+                                           format);
+    } else if (lhs->second) {
+      dot = rewriter.create<spirv::SUDotOp>(loc, i32Type, packedLhs, packedRhs,
+                                            format);
+    } else {
+      dot = rewriter.create<spirv::UDotOp>(loc, i32Type, packedLhs, packedRhs,
+                                           format);
+    }
+    if (Value acc = adaptor.getAcc()) {
+      dot = rewriter.create<spirv::IAddOp>(loc, dot, acc);
+    }
+    rewriter.replaceOp(reductionOp, dot);
+    return success();
+  }
+};
+
 /// Pattern to lower operations that become a no-ops at this level.
 template <typename OpTy>
 struct FoldAsNoOp final : public OpConversionPattern<OpTy> {
@@ -413,6 +501,10 @@ void ConvertToSPIRVPass::runOnOperation() {
 
   // Pull in vector patterns to convert vector ops.
   mlir::populateVectorToSPIRVPatterns(typeConverter, patterns);
+  // Prefer integer dot products over the default vector.reduction lowering
+  // when the target supports them.
+  patterns.insert<VectorReductionToIntegerDotProduct>(typeConverter, context,
+                                                      /*benefit=*/2);
 
   // Pull in builtin func to spirv.func conversion.
   populateBuiltinFuncToSPIRVPatterns(typeConverter, patterns);
@@ -0,0 +1,88 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===- IntelConfig.h - Intel CodeGen Configurations -----------------------===//
+//
+// This file contains CodeGen configurations for Intel GPUs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "iree/compiler/Codegen/SPIRV/KernelConfig.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SPIRV/IR/SPIRVAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#define DEBUG_TYPE "iree-spirv-intel-config"
+
+namespace mlir {
+namespace iree_compiler {
+namespace detail {
+
+constexpr unsigned IntelSimtSoftwarePipelineDepth = 2;
+constexpr unsigned IntelSimtSoftwarePipelineStoreStage = 1;
+
+constexpr unsigned IntelCoopMatrixSoftwarePipelineDepth = 2;
+constexpr unsigned IntelCoopMatrixSoftwarePipelineStoreStage = 1;
+
+constexpr unsigned IntelNumSubgroupsPerWorkgroup = 4;
+// The number of tiles along M and N dimensions per workgroup.
+constexpr unsigned IntelNumMNTilesPerSubgroup = 4;
+
+static LogicalResult setIntelMatmulConfig(linalg::LinalgOp op,
+                                          const spirv::TargetEnv &targetEnv) {
+  // Drivers exposing cooperative matrix properties get the subgroup matrix
+  // path; otherwise fall back to SIMT.
+  if (failed(setCooperativeMatrixConfig(
+          targetEnv, op, IntelNumSubgroupsPerWorkgroup,
+          IntelNumMNTilesPerSubgroup, IntelCoopMatrixSoftwarePipelineDepth,
+          IntelCoopMatrixSoftwarePipelineStoreStage)))
+    return failure();
+  if (getLoweringConfig(op)) return success();
+
+  spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
+  const int subgroupSize = limits.getSubgroupSize();
+  const std::array<int64_t, 2> workgroupXY = {subgroupSize, 4};
+  std::array<int64_t, 3> threadMNK;
+  auto inputType = op.getDpsInputOperand(0)->get().getType().cast<ShapedType>();
+  if (inputType.getElementType().getIntOrFloatBitWidth() == 16) {
+    threadMNK = {8, 8, 32};
+  } else {
+    threadMNK = {8, 4, 16};
+  }
+  return setMatmulOpConfig(limits, op, workgroupXY, threadMNK,
+                           /*enablePromotion=*/true,
+                           IntelSimtSoftwarePipelineDepth,
+                           IntelSimtSoftwarePipelineStoreStage);
+}
+
+// Xe-HPG architecture (Arc A-series):
+//
+// Xe-core is the block for workgroups; it has 16 vector engines (XVE) with
+// 8-wide SIMD ALUs and 8 threads each, plus a shared L1/SLM (shared memory).
+//
+// * 192KB L1/SLM per Xe-core
+// * Max 64KB SLM per workgroup
+// * SIMD8/16/32 subgroups
+
+LogicalResult setIntelCodeGenConfig(const spirv::TargetEnv &targetEnv,
+                                    Operation *rootOp) {
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(rootOp)) {
+    if (isMatmulOrBatchMatmul(linalgOp))
+      return setIntelMatmulConfig(linalgOp, targetEnv);
+  }
+
+  return TypeSwitch<Operation *, LogicalResult>(rootOp)
+      .Case<linalg::BatchMatmulOp, linalg::MatmulOp>(
+          [&](auto op) { return setIntelMatmulConfig(op, targetEnv); })
+      .Default([](Operation *) { return success(); });
+}
+
+}  // namespace detail
+}  // namespace iree_compiler
+}  // namespace mlir
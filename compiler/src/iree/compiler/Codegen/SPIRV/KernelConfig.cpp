@@ -960,6 +960,38 @@ static LogicalResult setFftOpConfig(spirv::ResourceLimitsAttr limits,
       workgroupSize);
 }
 
+//===----------------------------------------------------------------------===//
+// Attention Default Configuration
+//===----------------------------------------------------------------------===//
+
+static LogicalResult setAttentionOpConfig(IREE::LinalgExt::AttentionOp op) {
+  LLVM_DEBUG(llvm::dbgs() << "trying to deduce config as attention...\n");
+  // The op is decomposed into a flash attention loop nest after tiling to
+  // workgroups. Each workgroup handles one batch and a tile of the query
+  // sequence; the head dimension stays untiled and the query tile is also the
+  // step of the loop over keys so it must divide both sequence lengths.
+  const int64_t maxSequenceTileSize = 64;
+  int64_t querySequenceLength = op.getQueryType().getShape()[1];
+  int64_t keySequenceLength = op.getKeyType().getShape()[1];
+  int64_t sequenceTileSize = 1;
+  if (!ShapedType::isDynamic(querySequenceLength) &&
+      !ShapedType::isDynamic(keySequenceLength)) {
+    for (int64_t tileSize = maxSequenceTileSize; tileSize > 1; tileSize /= 2) {
+      if (querySequenceLength % tileSize == 0 &&
+          keySequenceLength % tileSize == 0) {
+        sequenceTileSize = tileSize;
+        break;
+      }
+    }
+  }
+  // The decomposed ops run serially in the workgroup.
+  std::array<int64_t, 3> workgroupSize = {1, 1, 1};
+  TileSizesListType tileSizes = {{1, sequenceTileSize, 0}};
+  return setOpConfigAndEntryPointFnTranslation(
+      op->getParentOfType<func::FuncOp>(), op, tileSizes,
+      CodeGenPipeline::SPIRVBaseDistribute, workgroupSize);
+}
+
 //===----------------------------------------------------------------------===//
 // Winograd Default Configuration
 //===----------------------------------------------------------------------===//
@@ -982,6 +1014,22 @@ static LogicalResult setWinogradOpConfig(spirv::ResourceLimitsAttr limits,
 // Reduction Default Configuration
 //===----------------------------------------------------------------------===//
 
+/// Returns the subgroup sizes the target can run kernels with, in order of
+/// preference. The default subgroup size comes first. Targets that support
+/// VK_EXT_subgroup_size_control can also run with any power of two size within
+/// [min, max], e.g., wave32 and wave64 on AMD RDNA.
+static SmallVector<int64_t> getCandidateSubgroupSizes(
+    spirv::ResourceLimitsAttr limits) {
+  SmallVector<int64_t> sizes = {limits.getSubgroupSize()};
+  Optional<int> minSize = limits.getMinSubgroupSize();
+  Optional<int> maxSize = limits.getMaxSubgroupSize();
+  if (!minSize || !maxSize) return sizes;
+  for (int64_t size = *maxSize; size >= *minSize; size /= 2) {
+    if (size != sizes.front()) sizes.push_back(size);
+  }
+  return sizes;
+}
+
 /// Set the configuration for reductions that can be mapped to warp reductions.
 static LogicalResult setReductionConfig(const spirv::TargetEnv &targetEnv,
                                         linalg::GenericOp op) {
@@ -1013,9 +1061,9 @@ static LogicalResult setReductionConfig(const spirv::TargetEnv &targetEnv,
     return failure();
   }
 
-  const int subgroupSize = targetEnv.getResourceLimits().getSubgroupSize();
+  spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
   Optional<int64_t> dimSize = op.getStaticLoopRanges()[reductionDims[0]];
-  if (!dimSize || *dimSize % subgroupSize != 0) return failure();
+  if (!dimSize) return failure();
 
   const Type elementType =
       op.getOutputs()[0].getType().cast<ShapedType>().getElementType();
@@ -1024,29 +1072,55 @@ static LogicalResult setReductionConfig(const spirv::TargetEnv &targetEnv,
   // Reduction distribution only supports 8/16/32 bit types now.
   if (bitWidth != 32 && bitWidth != 16 && bitWidth != 8) return failure();
 
-  // Let each thread handle `vectorSize` elements.
-  unsigned vectorSize = kMaxVectorNumBits / bitWidth;
-  while ((*dimSize / vectorSize) % subgroupSize != 0) vectorSize /= 2;
-
   // TODO: Add reduction tiling to handle larger reductions.
-  const int64_t maxWorkgroupSize =
-      targetEnv.getResourceLimits().getMaxComputeWorkgroupInvocations();
-  int64_t groupSize = *dimSize / vectorSize;
-  if (groupSize > maxWorkgroupSize) {
-    groupSize = llvm::APIntOps::GreatestCommonDivisor(
-                    {64, uint64_t(groupSize)}, {64, uint64_t(maxWorkgroupSize)})
-                    .getZExtValue();
+  const int64_t maxWorkgroupSize = limits.getMaxComputeWorkgroupInvocations();
+
+  // The warp reduction is only correct if it runs with the subgroup size it
+  // was configured for. Try the subgroup sizes the target can run with and
+  // use the first one we can distribute the reduction to.
+  int64_t subgroupSize = 0, groupSize = 0;
+  unsigned vectorSize = 0;
+  for (int64_t candidate : getCandidateSubgroupSizes(limits)) {
+    if (*dimSize % candidate != 0) continue;
+
+    // Let each thread handle `vectorSize` elements.
+    unsigned candidateVectorSize = kMaxVectorNumBits / bitWidth;
+    while ((*dimSize / candidateVectorSize) % candidate != 0)
+      candidateVectorSize /= 2;
+
+    int64_t candidateGroupSize = *dimSize / candidateVectorSize;
+    if (candidateGroupSize > maxWorkgroupSize) {
+      candidateGroupSize =
+          llvm::APIntOps::GreatestCommonDivisor(
+              {64, uint64_t(candidateGroupSize)},
+              {64, uint64_t(maxWorkgroupSize)})
+              .getZExtValue();
+    }
+    // Current warp reduction pattern is a two step butterfly warp reduce.
+    // First, do warp reductions along multiple subgroups.
+    // Second, reduce results from multiple subgroups using single warp reduce.
+    // The final warp reduce requires numSubgroupUsed > subgroupSize to work.
+    // TODO(raikonenfnu): Add flexible num of warp reduce to handle more
+    // configs. TT::CPU and TT::ARM_Valhall is not going through warp reduce.
+    const int64_t numSubgroupsUsed = candidateGroupSize / candidate;
+    if (numSubgroupsUsed > candidate) continue;
+
+    subgroupSize = candidate;
+    groupSize = candidateGroupSize;
+    vectorSize = candidateVectorSize;
+    break;
   }
-  // Current warp reduction pattern is a two step butterfly warp reduce.
-  // First, do warp reductions along multiple subgroups.
-  // Second, reduce results from multiple subgroups using single warp reduce.
-  // The final warp reduce requires numSubgroupUsed > subgroupSize to work.
-  // TODO(raikonenfnu): Add flexible num of warp reduce to handle more configs.
-  // TT::CPU and TT::ARM_Valhall is not going through warp reduce.
-  const int64_t numSubgroupsUsed = groupSize / subgroupSize;
-  if (numSubgroupsUsed > subgroupSize) {
-    return failure();
+  if (!subgroupSize) return failure();
+  LLVM_DEBUG(llvm::dbgs() << "reduction subgroup size = " << subgroupSize
+                          << "\n");
+
+  // Request the chosen subgroup size when the target allows controlling it so
+  // that the driver cannot pick a different one.
+  Optional<int64_t> requiredSubgroupSize;
+  if (limits.getMinSubgroupSize() && limits.getMaxSubgroupSize()) {
+    requiredSubgroupSize = subgroupSize;
   }
+
   std::array<int64_t, 3> workgroupSize = {groupSize, 1, 1};
   // Tile all the parallel dimension to 1.
   SmallVector<unsigned> partitionedLoops =
@@ -1064,7 +1138,8 @@ static LogicalResult setReductionConfig(const spirv::TargetEnv &targetEnv,
   tileSizes.emplace_back(std::move(reductionTileSizes));  // reduction level
   if (failed(setOpConfigAndEntryPointFnTranslation(
           op->getParentOfType<func::FuncOp>(), op, tileSizes,
-          CodeGenPipeline::SPIRVSubgroupReduce, workgroupSize))) {
+          CodeGenPipeline::SPIRVSubgroupReduce, workgroupSize,
+          requiredSubgroupSize))) {
     return failure();
   }
 
@@ -1331,6 +1406,9 @@ static LogicalResult setSPIRVOpConfig(const spirv::TargetEnv &targetEnv,
     case spirv::Vendor::ARM:
       result = detail::setMaliCodeGenConfig(targetEnv, rootOp);
       break;
+    case spirv::Vendor::Intel:
+      result = detail::setIntelCodeGenConfig(targetEnv, rootOp);
+      break;
     case spirv::Vendor::NVIDIA:
       result = detail::setNVIDIACodeGenConfig(targetEnv, rootOp);
       break;
@@ -1400,6 +1478,10 @@ static LogicalResult setSPIRVOpConfig(const spirv::TargetEnv &targetEnv,
       .Case<IREE::LinalgExt::FftOp>([limits](IREE::LinalgExt::FftOp op) {
         return setFftOpConfig(limits, op);
       })
+      .Case<IREE::LinalgExt::AttentionOp>(
+          [](IREE::LinalgExt::AttentionOp op) {
+            return setAttentionOpConfig(op);
+          })
       .Case<IREE::LinalgExt::WinogradInputTransformOp,
             IREE::LinalgExt::WinogradOutputTransformOp>(
           [&](auto op) { return setWinogradOpConfig(limits, op); })
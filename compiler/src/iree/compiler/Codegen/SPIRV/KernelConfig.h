@@ -88,6 +88,8 @@ LogicalResult setAppleCodeGenConfig(const spirv::TargetEnv &targetEnv,
                                     Operation *rootOp);
 LogicalResult setAMDCodeGenConfig(const spirv::TargetEnv &targetEnv,
                                   Operation *rootOp);
+LogicalResult setIntelCodeGenConfig(const spirv::TargetEnv &targetEnv,
+                                    Operation *rootOp);
 LogicalResult setMaliCodeGenConfig(const spirv::TargetEnv &targetEnv,
                                    Operation *rootOp);
 LogicalResult setNVIDIACodeGenConfig(const spirv::TargetEnv &targetEnv,
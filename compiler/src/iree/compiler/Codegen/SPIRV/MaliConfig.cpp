@@ -17,6 +17,7 @@
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/TypeUtilities.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -36,6 +37,17 @@ static LogicalResult setMaliMatmulConfig(linalg::LinalgOp op,
   return setMatmulOpConfig(limits, op, workgroupXY, threadMNK);
 }
 
+/// Returns the best per-thread tiling factor for the convolution `op`. Padded
+/// inputs need extra bound checks so get smaller tiles; 16-bit elements pack
+/// two values per register so get twice the tile.
+static int64_t getMaliConvTilingFactor(linalg::LinalgOp op) {
+  Value image = op.getDpsInputOperand(0)->get();
+  int64_t tilingFactor = image.getDefiningOp<tensor::PadOp>() ? 8 : 16;
+  if (getElementTypeOrSelf(image).getIntOrFloatBitWidth() == 16)
+    tilingFactor *= 2;
+  return tilingFactor;
+}
+
 //===----------------------------------------------------------------------===//
 // Entry Point
 //===----------------------------------------------------------------------===//
@@ -53,18 +65,9 @@ LogicalResult setMaliCodeGenConfig(const spirv::TargetEnv &targetEnv,
   return TypeSwitch<Operation *, LogicalResult>(rootOp)
       .Case<linalg::BatchMatmulOp, linalg::MatmulOp>(
           [limits](auto op) { return setMaliMatmulConfig(op, limits); })
-      .Case<linalg::Conv2DNchwFchwOp, linalg::Conv2DNhwcHwcfOp>(
-          [subgroupSize](auto op) {
-            bool hasPaddedInput =
-                op.image().template getDefiningOp<tensor::PadOp>();
-            int bestTilingFactor = hasPaddedInput ? 8 : 16;
-            return setConvOpConfig(op, subgroupSize, bestTilingFactor);
-          })
-      .Case<linalg::DepthwiseConv2DNhwcHwcOp>([subgroupSize](auto op) {
-        bool hasPaddedInput =
-            op.image().template getDefiningOp<tensor::PadOp>();
-        int bestTilingFactor = hasPaddedInput ? 8 : 16;
-        return setConvOpConfig(op, subgroupSize, bestTilingFactor);
+      .Case<linalg::Conv2DNchwFchwOp, linalg::Conv2DNhwcHwcfOp,
+            linalg::DepthwiseConv2DNhwcHwcOp>([subgroupSize](auto op) {
+        return setConvOpConfig(op, subgroupSize, getMaliConvTilingFactor(op));
       })
       .Default([](Operation *) { return success(); });
 }
@@ -269,3 +269,41 @@ hal.executable private @interface_wg_count {
 //       CHECK:     %[[ADDR2:.+]] = spirv.mlir.addressof @[[WGCOUNT]]
 //       CHECK:     %[[VAL2:.+]] = spirv.Load "Input" %[[ADDR2]]
 //       CHECK:     %[[WGIDY:.+]] = spirv.CompositeExtract %[[VAL2]][1 : i32]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 1, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>
+  ]>
+]>
+hal.executable private @dot_product_i8 {
+  hal.executable.variant @vulkan, target = <"vulkan-spirv", "vulkan-spirv-fb", {
+      spirv.target_env = #spirv.target_env<#spirv.vce<v1.6, [Shader, Int8, DotProduct, DotProductInput4x8BitPacked], [SPV_KHR_integer_dot_product]>, #spirv.resource_limits<>>}> {
+    hal.executable.export @dot_product_i8 layout(#pipeline_layout) attributes {
+      workgroup_size = [32: index, 1: index, 1: index]
+    }
+    builtin.module {
+      func.func @dot_product_i8() -> i32 {
+        %lhs = arith.constant dense<[1, -2, 3, -4]> : vector<4xi8>
+        %rhs = arith.constant dense<[5, 6, -7, 8]> : vector<4xi8>
+        %acc = hal.interface.constant.load[0] : i32
+        %0 = arith.extsi %lhs : vector<4xi8> to vector<4xi32>
+        %1 = arith.extsi %rhs : vector<4xi8> to vector<4xi32>
+        %2 = arith.muli %0, %1 : vector<4xi32>
+        %3 = vector.reduction <add>, %2, %acc : vector<4xi32> into i32
+        return %3 : i32
+      }
+    }
+  }
+}
+
+// CHECK-LABEL: spirv.module
+//       CHECK:   spirv.func @dot_product_i8
+//   CHECK-DAG:     %[[LHS:.+]] = spirv.Constant dense<[1, -2, 3, -4]> : vector<4xi8>
+//   CHECK-DAG:     %[[RHS:.+]] = spirv.Constant dense<[5, 6, -7, 8]> : vector<4xi8>
+//       CHECK:     %[[ACC:.+]] = spirv.Load "PushConstant"
+//       CHECK:     %[[PACKED_LHS:.+]] = spirv.Bitcast %[[LHS]] : vector<4xi8> to i32
+//       CHECK:     %[[PACKED_RHS:.+]] = spirv.Bitcast %[[RHS]] : vector<4xi8> to i32
+//       CHECK:     %[[DOT:.+]] = spirv.SDot %[[PACKED_LHS]], %[[PACKED_RHS]], <PackedVectorFormat4x8Bit> : i32 -> i32
+//       CHECK:     spirv.IAdd %[[DOT]], %[[ACC]] : i32
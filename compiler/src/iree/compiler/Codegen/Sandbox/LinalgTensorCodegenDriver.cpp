@@ -59,6 +59,43 @@ static FailureOr<Operation *> getRootOp(func::FuncOp funcOp) {
   return rootOp;
 }
 
+/// Translates the |rootTileSizes| of the root op to the loops of |op| if it
+/// is a consumer of the root. Consumers (such as the elementwise epilogue of a
+/// matmul or mmt4d) are tiled like the root result they read so that the root
+/// can be fused into their innermost tile. Returns std::nullopt if |op| is not
+/// a consumer or the mapping is not a permutation.
+static std::optional<SmallVector<int64_t>> getConsumerTileSizes(
+    linalg::LinalgOp op, ArrayRef<int64_t> rootTileSizes) {
+  auto funcOp = op->getParentOfType<func::FuncOp>();
+  if (!funcOp) return std::nullopt;
+  FailureOr<Operation *> rootOp = getRootOp(funcOp);
+  if (failed(rootOp) || rootOp.value() == op.getOperation()) {
+    return std::nullopt;
+  }
+  auto rootLinalgOp = dyn_cast<linalg::LinalgOp>(rootOp.value());
+  if (!rootLinalgOp || rootLinalgOp->getNumResults() != 1) return std::nullopt;
+  Value rootResult = rootLinalgOp->getResult(0);
+  for (OpOperand *operand : op.getDpsInputOperands()) {
+    if (operand->get() != rootResult) continue;
+    AffineMap rootResultMap =
+        rootLinalgOp.getIndexingMapMatchingResult(rootResult.cast<OpResult>());
+    AffineMap operandMap = op.getMatchingIndexingMap(operand);
+    if (!rootResultMap.isProjectedPermutation() ||
+        !operandMap.isProjectedPermutation() ||
+        rootResultMap.getNumResults() != operandMap.getNumResults()) {
+      return std::nullopt;
+    }
+    SmallVector<int64_t> tileSizes(op.getNumLoops(), 0);
+    for (unsigned i = 0; i < operandMap.getNumResults(); ++i) {
+      unsigned rootDim = rootResultMap.getDimPosition(i);
+      if (rootDim >= rootTileSizes.size()) continue;
+      tileSizes[operandMap.getDimPosition(i)] = rootTileSizes[rootDim];
+    }
+    return tileSizes;
+  }
+  return std::nullopt;
+}
+
 /// Builds a proper tile sizes vector for the op.
 /// scf::tileUsingSCFForOp expects the num of tile sizes = num of loops. This
 /// method returns a proper tile sizes vector for each op during tiling.
@@ -67,6 +104,11 @@ static SmallVector<Value> buildTileSizesForOp(OpBuilder &b, Operation *op,
   auto tilingOp = cast<TilingInterface>(op);
 
   SmallVector<int64_t> newTileSizes(tileSizes);
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+    if (auto consumerTileSizes = getConsumerTileSizes(linalgOp, tileSizes)) {
+      newTileSizes = std::move(*consumerTileSizes);
+    }
+  }
   newTileSizes.resize(tilingOp.getLoopIteratorTypes().size(), /*default=*/0);
 
   OpBuilder::InsertionGuard guard(b);
@@ -85,3 +85,38 @@ func.func @matmul_bias_add_static(%arg0 : tensor<20x60xf32>, %arg1 : tensor<60x1
 //      CHECK:       scf.yield %[[INSERT]]
 //      CHECK:     scf.yield %[[YIELD]]
 //      CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @mmt4d_bias_add(%arg0 : tensor<3x5x4x2xf32>, %arg1 : tensor<6x5x8x2xf32>, %arg2 : tensor<6x8xf32>) -> tensor<3x6x4x8xf32> {
+  %cst = arith.constant 0.0 : f32
+  %init = tensor.empty() : tensor<3x6x4x8xf32>
+  %0 = linalg.fill ins(%cst : f32) outs(%init : tensor<3x6x4x8xf32>) -> tensor<3x6x4x8xf32>
+  %1 = linalg.mmt4d {lowering_config = #iree_codegen.lowering_config<tile_sizes = [[1, 1, 0, 4, 8, 0]]>}
+      ins(%arg0, %arg1 : tensor<3x5x4x2xf32>, tensor<6x5x8x2xf32>)
+      outs(%0 : tensor<3x6x4x8xf32>) -> tensor<3x6x4x8xf32>
+  %2 = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>, affine_map<(d0, d1, d2, d3) -> (d1, d3)>, affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>],
+    iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+    ins(%1, %arg2 : tensor<3x6x4x8xf32>, tensor<6x8xf32>)
+    outs(%init : tensor<3x6x4x8xf32>) {
+      ^bb0(%arg3: f32, %arg4: f32, %arg5: f32):
+        %3 = arith.addf %arg3, %arg4 : f32
+        linalg.yield %3 : f32
+    } -> tensor<3x6x4x8xf32>
+  return %2 : tensor<3x6x4x8xf32>
+}
+// The epilogue is tiled like the mmt4d result and not by the positional
+// mmt4d tile sizes so only the outer M1 and N1 loops are materialized.
+//      CHECK: func.func @mmt4d_bias_add(
+//      CHECK:   scf.for
+//      CHECK:     scf.for
+//  CHECK-NOT:       scf.for
+//      CHECK:       %[[CONTRACT:.+]] = vector.contract
+//      CHECK:       %[[ADD:.+]] = arith.addf %[[CONTRACT]]
+//      CHECK:       vector.transfer_write %[[ADD]]
+// CHECK-SAME:         vector<1x1x4x8xf32>, tensor<3x6x4x8xf32>
+//      CHECK:       scf.yield
+//      CHECK:     scf.yield
+//  CHECK-NOT:   scf.for
+//      CHECK:   return
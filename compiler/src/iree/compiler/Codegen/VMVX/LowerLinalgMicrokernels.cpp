@@ -1439,16 +1439,21 @@ class VMVXLowerLinalgMicrokernelsPass
       }
     }
 
-    if (warnOnUnconverted) {
-      getOperation()->walk([](Operation *op) {
-        if (llvm::isa<linalg::LinalgOp>(op)) {
-          auto diag = op->emitWarning(
-              "Linalg op not converted to microkernel and will be implemented "
-              "with fallback scalar loops");
-          diag.attachNote(op->getLoc()) << "unmatched op: " << *op;
-        }
-      });
-    }
+    getOperation()->walk([&](Operation *op) {
+      if (warnOnUnconverted && llvm::isa<linalg::LinalgOp>(op)) {
+        auto diag = op->emitWarning(
+            "Linalg op not converted to microkernel and will be implemented "
+            "with fallback scalar loops");
+        diag.attachNote(op->getLoc()) << "unmatched op: " << *op;
+      } else if (llvm::isa<linalg::Mmt4DOp, IREE::LinalgExt::PackOp,
+                           IREE::LinalgExt::UnPackOp>(op)) {
+        // Data-tiled layouts were chosen for the microkernels and the
+        // fallback is a performance cliff so it's always reported.
+        op->emitRemark(
+            "data-tiled op not converted to microkernel and will be "
+            "implemented with fallback scalar loops");
+      }
+    });
   }
 };
 
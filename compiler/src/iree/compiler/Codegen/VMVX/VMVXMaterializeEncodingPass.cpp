@@ -81,7 +81,8 @@ void VMVXMaterializeEncodingPass::runOnOperation() {
         MatmulTileParams tileParams =
             chooseMatmulTileParams(*matmulType, targetAttr);
         auto encodingInfo = chooseEncodingInfoForMatmul(
-            *matmulType, *matmulOperandRole, tileParams);
+            *matmulType, *matmulOperandRole, tileParams,
+            getMatmulNumBatchDims(*encoding));
         adjustTileSizesToNarrowStaticShape(encodingInfo, tensorType.getShape());
         return encodingInfo;
       });
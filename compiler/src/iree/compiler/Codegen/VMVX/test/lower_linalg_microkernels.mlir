@@ -1,4 +1,4 @@
-// RUN: iree-opt --pass-pipeline="builtin.module(func.func(iree-vmvx-lower-linalg-microkernels, canonicalize, cse))" %s | FileCheck %s
+// RUN: iree-opt --pass-pipeline="builtin.module(func.func(iree-vmvx-lower-linalg-microkernels, canonicalize, cse))" --verify-diagnostics %s | FileCheck %s
 
 // Verifies the indexing math generated in order to resolve subviews to 1D.
 // This incidentally also verifies vmvx.copy (non-transposed) lowering.
@@ -224,6 +224,7 @@ func.func @mmt4d_buffer_layout_edge_case_2(
     %arg0 : memref<5x4x7x3xi32, #map_5x4x7x3_noncontiguous_dim1>,
     %arg1 : memref<5x6x7x8xi8>,
     %arg2 : memref<4x6x3x8xi8>) {
+  // expected-remark @+1 {{data-tiled op not converted to microkernel}}
   linalg.mmt4d
       ins(%arg1, %arg2 : memref<5x6x7x8xi8>, memref<4x6x3x8xi8>)
       outs(%arg0 : memref<5x4x7x3xi32, #map_5x4x7x3_noncontiguous_dim1>)
@@ -238,6 +239,7 @@ func.func @mmt4d_buffer_layout_edge_case_3(
     %arg0 : memref<5x4x7x3xi32, #map_5x4x7x3_noncontiguous_dim2>,
     %arg1 : memref<5x6x7x8xi8>,
     %arg2 : memref<4x6x3x8xi8>) {
+  // expected-remark @+1 {{data-tiled op not converted to microkernel}}
   linalg.mmt4d
       ins(%arg1, %arg2 : memref<5x6x7x8xi8>, memref<4x6x3x8xi8>)
       outs(%arg0 : memref<5x4x7x3xi32, #map_5x4x7x3_noncontiguous_dim2>)
@@ -252,6 +254,7 @@ func.func @mmt4d_buffer_layout_edge_case_4(
     %arg0 : memref<5x4x7x3xi32>,
     %arg1 : memref<5x6x7x8xi8, #map_5x6x7x8_noncontiguous_dim1>,
     %arg2 : memref<4x6x3x8xi8>) {
+  // expected-remark @+1 {{data-tiled op not converted to microkernel}}
   linalg.mmt4d
       ins(%arg1, %arg2 : memref<5x6x7x8xi8, #map_5x6x7x8_noncontiguous_dim1>, memref<4x6x3x8xi8>)
       outs(%arg0 : memref<5x4x7x3xi32>)
@@ -266,6 +269,7 @@ func.func @mmt4d_buffer_layout_edge_case_5(
     %arg0 : memref<5x4x7x3xi32>,
     %arg1 : memref<5x6x7x8xi8>,
     %arg2 : memref<4x6x3x8xi8, #map_4x6x3x8_noncontiguous_dim1>) {
+  // expected-remark @+1 {{data-tiled op not converted to microkernel}}
   linalg.mmt4d
       ins(%arg1, %arg2 : memref<5x6x7x8xi8>, memref<4x6x3x8xi8, #map_4x6x3x8_noncontiguous_dim1>)
       outs(%arg0 : memref<5x4x7x3xi32>)
@@ -608,6 +612,16 @@ func.func @pack_f32f32_transpose_inner_and_outer_dims(%arg0 : memref<34x47xf32>,
   func.return
 }
 
+// Element types without a microkernel keep the op and report the fallback.
+// CHECK-LABEL: @pack_f16f16_fallback
+//       CHECK: iree_linalg_ext.pack
+func.func @pack_f16f16_fallback(%arg0 : memref<34x47xf16>, %arg1 : memref<5x6x7x8xf16>, %arg2 : f16) {
+  // expected-remark @+1 {{data-tiled op not converted to microkernel}}
+  iree_linalg_ext.pack %arg0 padding_value(%arg2 : f16) inner_dims_pos = [0, 1] inner_tiles = [7, 8] into %arg1
+      : (memref<34x47xf16> memref<5x6x7x8xf16>)
+  func.return
+}
+
 // CHECK-LABEL: @unpack_i8i8
 //   CHECK-DAG: %[[BB0:.*]], %[[OFFSET0:.*]], %[[SIZES0:.*]]:4, %[[STRIDES0:.*]]:4 = vmvx.get_buffer_descriptor %arg0
 //   CHECK-DAG: %[[BB1:.*]], %[[OFFSET1:.*]], %[[SIZES1:.*]]:2, %[[STRIDES1:.*]]:2 = vmvx.get_buffer_descriptor %arg1
@@ -10,9 +10,17 @@
 #include "iree/compiler/Pipelines/Pipelines.h"
 #include "iree/compiler/Utils/PassUtils.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/raw_ostream.h"
+#include "mlir/AsmParser/AsmParser.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/IRMapping.h"
@@ -21,12 +29,82 @@
 #define DEBUG_TYPE "iree-const-eval"
 using llvm::dbgs;
 
+static llvm::cl::opt<std::string> clJitGlobalsCacheDir(
+    "iree-consteval-jit-cache-dir",
+    llvm::cl::desc("Directory in which evaluated global initializers are "
+                   "cached across compiler invocations, keyed by a hash of "
+                   "the initializers and the constants they use."),
+    llvm::cl::init(""));
+
 namespace mlir {
 namespace iree_compiler {
 namespace ConstEval {
 
 namespace {
 
+// Bumped whenever the contents of cache entries change in an incompatible way.
+static const char kCacheFormatVersion[] = "iree-consteval-cache-v1";
+
+// Returns printing flags that produce the complete IR independent of any
+// printing flags specified by the user.
+static OpPrintingFlags getCachePrintingFlags() {
+  OpPrintingFlags flags;
+  flags.enableDebugInfo(false);
+  flags.elideLargeElementsAttrs(std::numeric_limits<int64_t>::max());
+  return flags;
+}
+
+// Returns the path of the cache entry for the program in |moduleOp|. The
+// program contains the initializers along with all of their dependencies and
+// constants and as such fully determines the evaluated values.
+static std::string getCacheEntryPath(StringRef cacheDir, ModuleOp moduleOp) {
+  std::string moduleText = kCacheFormatVersion;
+  llvm::raw_string_ostream os(moduleText);
+  moduleOp.print(os, getCachePrintingFlags());
+  os.flush();
+  SmallString<256> path(cacheDir);
+  llvm::sys::path::append(
+      path, llvm::toHex(llvm::SHA256::hash(llvm::arrayRefFromStringRef(
+                            moduleText)),
+                        /*LowerCase=*/true) +
+                ".mlir");
+  return std::string(path);
+}
+
+// Loads the values of globals from the cache entry at |path|, if present.
+static DictionaryAttr loadCachedValues(StringRef path, MLIRContext *context) {
+  auto fileOrErr = llvm::MemoryBuffer::getFile(path);
+  if (!fileOrErr) return {};
+  auto values = llvm::dyn_cast_or_null<DictionaryAttr>(
+      parseAttribute((*fileOrErr)->getBuffer(), context));
+  if (!values) {
+    LLVM_DEBUG(dbgs() << "JitGlobals: ignoring invalid cache entry " << path
+                      << "\n");
+  }
+  return values;
+}
+
+// Stores the values of globals into the cache entry at |path|. The entry is
+// written to a temporary file first so concurrent compilations never observe
+// partial entries. Failures are not fatal as the cache is only an
+// optimization.
+static void storeCachedValues(StringRef path, DictionaryAttr values) {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path))) {
+    LLVM_DEBUG(dbgs() << "JitGlobals: failed to create cache directory\n");
+    return;
+  }
+  AsmState state(values.getContext(), getCachePrintingFlags());
+  if (llvm::Error error =
+          llvm::writeToOutput(path, [&](llvm::raw_ostream &os) {
+            values.print(os, state);
+            return llvm::Error::success();
+          })) {
+    LLVM_DEBUG(dbgs() << "JitGlobals: failed to write cache entry " << path
+                      << ": " << llvm::toString(std::move(error)) << "\n");
+    llvm::consumeError(std::move(error));
+  }
+}
+
 struct ProgramExtractor {
  public:
   ProgramExtractor(Operation *sourceModuleOp, Operation *targetModuleOp)
@@ -204,23 +282,41 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
       return;
     }
 
-    // Run the IREE compiler, transforming the inner module into a vm.module.
-    LLVM_DEBUG(dbgs() << "JIT'ing " << uninitializedGlobals.size()
-                      << " uninitialized globals\n");
-    if (failed(runPipeline(compilePipeline, innerModule))) {
-      return signalPassFailure();
+    // Reuse the values evaluated by a previous compilation of the same
+    // initializers, if any.
+    std::string cachePath;
+    DictionaryAttr cachedValues;
+    if (!clJitGlobalsCacheDir.empty()) {
+      cachePath = getCacheEntryPath(clJitGlobalsCacheDir, innerModule);
+      cachedValues = loadCachedValues(cachePath, &getContext());
     }
 
-    // Generate a binary.
-    InMemoryCompiledBinary binary;
-    if (failed(binary.translateFromModule(innerModule))) {
-      return signalPassFailure();
+    std::optional<InMemoryCompiledBinary> binary;
+    if (!cachedValues) {
+      // Run the IREE compiler, transforming the inner module into a vm.module.
+      LLVM_DEBUG(dbgs() << "JIT'ing " << uninitializedGlobals.size()
+                        << " uninitialized globals\n");
+      if (failed(runPipeline(compilePipeline, innerModule))) {
+        return signalPassFailure();
+      }
+
+      // Generate a binary.
+      binary.emplace();
+      if (failed(binary->translateFromModule(innerModule))) {
+        return signalPassFailure();
+      }
+    } else {
+      LLVM_DEBUG(dbgs() << "Using cached values of "
+                        << uninitializedGlobals.size()
+                        << " uninitialized globals from " << cachePath
+                        << "\n");
     }
 
     // Kill the temporary program we constructed.
     innerModule.erase();
 
     bool modified = false;
+    SmallVector<NamedAttribute> evaluatedValues;
     for (auto &it : uninitializedGlobals) {
       StringAttr funcSymbol = it.first;
       StringAttr globalSymbol = it.second;
@@ -229,13 +325,25 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
       Location loc = targetGlobal->getLoc();
 
       Attribute value =
-          binary.invokeNullaryAsAttribute(loc, funcSymbol.strref());
+          cachedValues
+              ? cachedValues.get(globalSymbol)
+              : binary->invokeNullaryAsAttribute(loc, funcSymbol.strref());
       if (!value) {
+        if (cachedValues) {
+          mlir::emitError(loc) << "missing value in const-eval cache entry "
+                               << cachePath;
+        }
         return signalPassFailure();
       }
 
       modified = true;
       targetGlobal.setInitialValueAttr(value);
+      evaluatedValues.emplace_back(globalSymbol, value);
+    }
+
+    if (!cachedValues && !cachePath.empty()) {
+      storeCachedValues(cachePath,
+                        DictionaryAttr::get(&getContext(), evaluatedValues));
     }
 
     // Delete any ops noted for pruning.
@@ -176,6 +176,10 @@ bool CompiledBinary::isSupportedResultType(Type type) {
 
   // Support tensors.
   if (auto tt = type.dyn_cast<RankedTensorType>()) {
+    // The physical layout of tensors with an encoding (such as data-tiled
+    // weights) is chosen by the target backend materializing it and can't be
+    // produced by the JIT backend.
+    if (tt.getEncoding()) return false;
     return isSupportedResultType(tt.getElementType());
   }
 
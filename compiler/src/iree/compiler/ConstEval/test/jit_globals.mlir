@@ -222,3 +222,21 @@ module @eval_i64_tensor {
     util.initializer.return
   }
 }
+
+// -----
+// CHECK-LABEL: @eval_encoded_tensor
+// Data-tiled layouts are target specific (initializer should remain)
+// CHECK: util.initializer
+module @eval_encoded_tensor {
+  util.global private @hoisted : tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  func.func @main() -> tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>> {
+    %hoisted = util.global.load @hoisted : tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    return %hoisted : tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  }
+  util.initializer {
+    %cst = arith.constant dense<2.0e+2> : tensor<8x4xf32>
+    %0 = iree_linalg_ext.set_encoding %cst : tensor<8x4xf32> -> tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    util.global.store %0, @hoisted : tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    util.initializer.return
+  }
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// RUN: iree-opt --iree-consteval-jit-globals --iree-consteval-jit-cache-dir=%t %s | FileCheck %s
+// Second run reads the values back from the cache entry written by the first.
+// RUN: iree-opt --iree-consteval-jit-globals --iree-consteval-jit-cache-dir=%t %s | FileCheck %s
+
+// CHECK-LABEL: @eval_cached
+// CHECK: util.global private @hoisted = dense<[2.000000e+02, 3.200000e+03]> : tensor<2xf32>
+// CHECK-NOT: util.initializer
+module @eval_cached {
+  util.global private @hoisted : tensor<2xf32>
+  func.func @main() -> tensor<2xf32> {
+    %hoisted = util.global.load @hoisted : tensor<2xf32>
+    return %hoisted : tensor<2xf32>
+  }
+  util.initializer {
+    %cst = arith.constant dense<[2.0e+2, 3.2e+3]> : tensor<2xf32>
+    util.global.store %cst, @hoisted : tensor<2xf32>
+    util.initializer.return
+  }
+}
@@ -1453,6 +1453,32 @@ SmallVector<int64_t, 4> TensorUpdateOp::getTiedResultOperandIndices() {
   return {0};  // target
 }
 
+//===----------------------------------------------------------------------===//
+// flow.collective.all_gather
+//===----------------------------------------------------------------------===//
+
+LogicalResult CollectiveAllGatherOp::verify() {
+  auto sourceType = getSource().getType().cast<RankedTensorType>();
+  auto resultType = getResult().getType().cast<RankedTensorType>();
+  if (sourceType.getRank() == 0 ||
+      sourceType.getRank() != resultType.getRank()) {
+    return emitOpError() << "source and result must have the same non-zero "
+                            "rank";
+  }
+  if (sourceType.getShape().drop_front() !=
+      resultType.getShape().drop_front()) {
+    return emitOpError() << "source and result may only differ in their "
+                            "outermost dimension";
+  }
+  int64_t sourceDim = sourceType.getDimSize(0);
+  int64_t resultDim = resultType.getDimSize(0);
+  if (sourceDim == 0 ? resultDim != 0 : resultDim % sourceDim != 0) {
+    return emitOpError() << "outermost result dimension must be a multiple of "
+                            "the outermost source dimension";
+  }
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // Public methods
 //===----------------------------------------------------------------------===//
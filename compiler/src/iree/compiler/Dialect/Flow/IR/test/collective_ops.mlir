@@ -0,0 +1,17 @@
+// RUN: iree-opt --split-input-file %s | iree-opt --split-input-file | FileCheck %s
+
+// CHECK-LABEL: @collectiveAllReduce
+func.func @collectiveAllReduce(%arg0 : tensor<4x8xf32>) -> tensor<4x8xf32> {
+  // CHECK-NEXT: %0 = flow.collective.all_reduce sum, %arg0 : tensor<4x8xf32>
+  %0 = flow.collective.all_reduce sum, %arg0 : tensor<4x8xf32>
+  return %0 : tensor<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @collectiveAllGather
+func.func @collectiveAllGather(%arg0 : tensor<4x8xf32>) -> tensor<16x8xf32> {
+  // CHECK-NEXT: %0 = flow.collective.all_gather %arg0 : tensor<4x8xf32> -> tensor<16x8xf32>
+  %0 = flow.collective.all_gather %arg0 : tensor<4x8xf32> -> tensor<16x8xf32>
+  return %0 : tensor<16x8xf32>
+}
@@ -0,0 +1,162 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/Analysis/Attributes/Range.h"
+#include "iree/compiler/Dialect/Util/Analysis/DFX/Solver.h"
+#include "iree/compiler/Dialect/Util/Analysis/DFX/State.h"
+#include "iree/compiler/Dialect/Util/Analysis/Explorer.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Utils/Utils.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
+
+#define DEBUG_TYPE "iree-flow-auto-mixed-precision"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+// Largest finite magnitude representable in f16. Operands outside of this
+// range would turn into infinities when truncated.
+constexpr double kMaxF16Magnitude = 65504.0;
+
+// Returns true if |op| computes entirely in f32 on ranked tensors.
+static bool isF32TensorOp(linalg::LinalgOp op) {
+  if (!op.hasTensorSemantics()) return false;
+  return llvm::all_of(op->getOperands(), [](Value operand) {
+    auto type = operand.getType().dyn_cast<RankedTensorType>();
+    return type && type.getElementType().isF32();
+  });
+}
+
+// Returns a tensor with the contents of |input| truncated to |elementType|.
+static Value createTruncation(OpBuilder &builder, Location loc, Value input,
+                              Type elementType) {
+  auto inputType = input.getType().cast<RankedTensorType>();
+  auto resultType = RankedTensorType::get(inputType.getShape(), elementType);
+  SmallVector<Value> dynamicDims =
+      tensor::createDynamicDimValues(builder, loc, input);
+  Value init = builder.create<tensor::EmptyOp>(loc, resultType, dynamicDims);
+  int64_t rank = inputType.getRank();
+  SmallVector<utils::IteratorType> iterators(rank,
+                                             utils::IteratorType::parallel);
+  AffineMap map = builder.getMultiDimIdentityMap(rank);
+  return builder
+      .create<linalg::GenericOp>(
+          loc, resultType, ValueRange{input}, ValueRange{init},
+          ArrayRef<AffineMap>{map, map}, iterators,
+          [=](OpBuilder &b, Location nestedLoc, ValueRange args) {
+            Value trunc =
+                b.create<arith::TruncFOp>(nestedLoc, elementType, args[0]);
+            b.create<linalg::YieldOp>(nestedLoc, trunc);
+          })
+      .getResult(0);
+}
+
+// Recreates |op| with its inputs truncated to |elementType|. The outputs keep
+// their f32 type so that the accumulation stays in f32.
+template <typename OpTy>
+static void demoteInputs(OpTy op, Type elementType) {
+  OpBuilder builder(op);
+  Location loc = op.getLoc();
+  SmallVector<Value> newInputs;
+  for (Value input : op.getInputs()) {
+    newInputs.push_back(createTruncation(builder, loc, input, elementType));
+  }
+  auto newOp = builder.create<OpTy>(loc, op->getResultTypes(), newInputs,
+                                    op.getOutputs(),
+                                    linalg::getPrunedAttributeList(op));
+  op->replaceAllUsesWith(newOp->getResults());
+  op->erase();
+}
+
+namespace {
+
+class AutoMixedPrecisionPass
+    : public AutoMixedPrecisionBase<AutoMixedPrecisionPass> {
+ public:
+  AutoMixedPrecisionPass(bool useBF16) { this->useBF16 = useBF16; }
+  AutoMixedPrecisionPass(const AutoMixedPrecisionPass &pass)
+      : AutoMixedPrecisionPass(pass.useBF16) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    // Only contractions and convolutions are demoted: they dominate the
+    // memory traffic and accumulate in their f32 outputs. Everything else,
+    // including reductions and softmax, stays in f32.
+    SmallVector<linalg::LinalgOp> candidates;
+    getOperation()->walk([&](linalg::LinalgOp op) {
+      if (!isa<linalg::MatmulOp, linalg::BatchMatmulOp,
+               linalg::Conv2DNhwcHwcfOp, linalg::Conv2DNchwFchwOp,
+               linalg::DepthwiseConv2DNhwcHwcOp>(op.getOperation())) {
+        return;
+      }
+      if (isF32TensorOp(op)) candidates.push_back(op);
+    });
+    if (candidates.empty()) return;
+
+    // bf16 keeps the f32 exponent range so it only loses mantissa bits; f16
+    // can overflow and is only used on operands with a known finite range.
+    if (!useBF16) {
+      Explorer explorer(getOperation(), TraversalAction::SHALLOW);
+      llvm::BumpPtrAllocator allocator;
+      DFX::Solver solver(explorer, allocator);
+      for (linalg::LinalgOp op : candidates) {
+        for (OpOperand *input : op.getDpsInputOperands()) {
+          solver.getOrCreateElementFor<IREE::Util::FloatRangeValueElement>(
+              Position::forValue(input->get()));
+        }
+      }
+      if (failed(solver.run())) {
+        return signalPassFailure();
+      }
+      llvm::erase_if(candidates, [&](linalg::LinalgOp op) {
+        return !llvm::all_of(op.getDpsInputOperands(), [&](OpOperand *input) {
+          auto *elt =
+              solver.lookupElementFor<IREE::Util::FloatRangeValueElement>(
+                  Position::forValue(input->get()));
+          if (!elt) return false;
+          IREE::Util::FloatRangeStats stats = elt->getKnown();
+          return stats.valid && stats.isFinite() &&
+                 std::abs(stats.minValue) <= kMaxF16Magnitude &&
+                 std::abs(stats.maxValue) <= kMaxF16Magnitude;
+        });
+      });
+    }
+
+    Builder builder(&getContext());
+    Type elementType = useBF16 ? builder.getBF16Type() : builder.getF16Type();
+    for (linalg::LinalgOp candidate : candidates) {
+      LLVM_DEBUG(llvm::dbgs() << "demoting inputs of " << candidate << "\n");
+      TypeSwitch<Operation *>(candidate.getOperation())
+          .Case<linalg::MatmulOp, linalg::BatchMatmulOp,
+                linalg::Conv2DNhwcHwcfOp, linalg::Conv2DNchwFchwOp,
+                linalg::DepthwiseConv2DNhwcHwcOp>(
+              [&](auto op) { demoteInputs(op, elementType); });
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createAutoMixedPrecisionPass(bool useBF16) {
+  return std::make_unique<AutoMixedPrecisionPass>(useBF16);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowTypes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/ConvertRegionToWorkgroups.h"
+#include "iree/compiler/Dialect/Flow/Transforms/FusionCostModel.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
@@ -568,7 +569,7 @@ static void fuseRootsWithConsumers(MLIRContext *context,
 /// Method to check if the consumer of a use can be fused with its producer.
 static bool isFusableWithProducer(
     OpOperand &operand, const llvm::SmallBitVector &rootOuterParallelLoops,
-    bool aggressiveFusion) {
+    bool aggressiveFusion, const FusionCostModel &costModel) {
   Operation *producer = operand.get().getDefiningOp();
   Operation *consumer = operand.getOwner();
 
@@ -595,8 +596,17 @@ static bool isFusableWithProducer(
     return false;
   }
 
-  return areOpsAggresiveFusable(producer, consumer, rootOuterParallelLoops,
-                                aggressiveFusion);
+  if (!areOpsAggresiveFusable(producer, consumer, rootOuterParallelLoops,
+                              aggressiveFusion)) {
+    return false;
+  }
+
+  // Fused producers of inputs are recomputed by each tile of the root reading
+  // them; make sure that costs less than materializing the input.
+  if (consumerLinalgOp.isDpsInput(&operand)) {
+    return costModel.isProfitable(operand).value_or(true);
+  }
+  return true;
 }
 
 /// Starting from the `root` op, traverse the operand use-def chain
@@ -604,7 +614,8 @@ static bool isFusableWithProducer(
 static void fuseRootsWithProducers(MLIRContext *context, Operation *root,
                                    unsigned groupNum,
                                    DominanceInfo const &dominanceInfo,
-                                   bool aggressiveFusion) {
+                                   bool aggressiveFusion,
+                                   const FusionCostModel &costModel) {
   SmallVector<Operation *> worklist;
   worklist.push_back(root);
   llvm::SmallBitVector rootOuterParallelLoops = getOuterParallelLoops(root);
@@ -623,7 +634,7 @@ static void fuseRootsWithProducers(MLIRContext *context, Operation *root,
       if (!fusableUse || fusableUse.value()->getOwner() != candidate) continue;
 
       if (!isFusableWithProducer(operand, rootOuterParallelLoops,
-                                 aggressiveFusion)) {
+                                 aggressiveFusion, costModel)) {
         continue;
       }
 
@@ -643,7 +654,8 @@ static void fuseRootsWithProducers(MLIRContext *context, Operation *root,
 /// enough to capture any heuristic.
 static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
                                        DominanceInfo const &dominanceInfo,
-                                       bool aggressiveFusion) {
+                                       bool aggressiveFusion,
+                                       const FusionCostModel &costModel) {
   unsigned numRootOps = 0;
   MLIRContext *context = funcOp->getContext();
   OpBuilder builder(context);
@@ -661,7 +673,7 @@ static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
       setRootAttribute(context, &op, newGroup);
 
       fuseRootsWithProducers(context, &op, newGroup, dominanceInfo,
-                             aggressiveFusion);
+                             aggressiveFusion, costModel);
       roots.push_back(&op);
     }
     roots = llvm::to_vector(llvm::reverse(roots));
@@ -739,11 +751,12 @@ static LogicalResult createFusionGroups(TensorDimTrackingRewriter &rewriter,
                                         FunctionOpInterface funcOp,
                                         DominanceInfo const &dominanceInfo,
                                         bool generateWorkloadRegion,
-                                        bool aggressiveFusion) {
+                                        bool aggressiveFusion,
+                                        const FusionCostModel &costModel) {
   // Step 1: Decide fusion groups (heuristic). This marks rootOps with an
   // attribute
-  unsigned numRoots =
-      decideFusableLinalgOps(funcOp, dominanceInfo, aggressiveFusion);
+  unsigned numRoots = decideFusableLinalgOps(funcOp, dominanceInfo,
+                                             aggressiveFusion, costModel);
   SmallVector<Operation *> roots(numRoots, nullptr);
   DenseMap<unsigned, SmallVector<Operation *>> producers;
 
@@ -829,13 +842,16 @@ struct FormDispatchRegionsPass
         .insert<AffineDialect, IREE::Flow::FlowDialect, linalg::LinalgDialect,
                 scf::SCFDialect, tensor::TensorDialect>();
   }
-  FormDispatchRegionsPass(bool aggressiveFusion, bool generateWorkloadRegion) {
+  FormDispatchRegionsPass(bool aggressiveFusion, bool generateWorkloadRegion,
+                          double fusionOpsPerByte) {
     this->aggressiveFusion = aggressiveFusion;
     this->generateWorkloadRegion = generateWorkloadRegion;
+    this->fusionOpsPerByte = fusionOpsPerByte;
   }
   FormDispatchRegionsPass(const FormDispatchRegionsPass &pass)
       : FormDispatchRegionsPass(pass.aggressiveFusion,
-                                pass.generateWorkloadRegion) {}
+                                pass.generateWorkloadRegion,
+                                pass.fusionOpsPerByte) {}
   void runOnOperation() override;
 };
 }  // namespace
@@ -845,8 +861,12 @@ void FormDispatchRegionsPass::runOnOperation() {
   mlir::FunctionOpInterface funcOp = getOperation();
   DominanceInfo const &dominanceInfo = getAnalysis<DominanceInfo>();
   TensorDimTrackingRewriter rewriter(funcOp);
+  FusionCostHints costHints;
+  costHints.opsPerByte = fusionOpsPerByte;
+  FusionCostModel costModel(costHints);
   if (failed(createFusionGroups(rewriter, funcOp, dominanceInfo,
-                                generateWorkloadRegion, aggressiveFusion))) {
+                                generateWorkloadRegion, aggressiveFusion,
+                                costModel))) {
     funcOp->emitOpError("failed to create fusion groups");
     return signalPassFailure();
   }
@@ -854,9 +874,10 @@ void FormDispatchRegionsPass::runOnOperation() {
 
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFormDispatchRegionsPass(bool aggressiveFusion,
-                              bool generateWorkloadRegion) {
-  return std::make_unique<FormDispatchRegionsPass>(aggressiveFusion,
-                                                   generateWorkloadRegion);
+                              bool generateWorkloadRegion,
+                              double fusionOpsPerByte) {
+  return std::make_unique<FormDispatchRegionsPass>(
+      aggressiveFusion, generateWorkloadRegion, fusionOpsPerByte);
 }
 }  // namespace Flow
 }  // namespace IREE
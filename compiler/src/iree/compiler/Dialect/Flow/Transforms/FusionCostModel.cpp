@@ -0,0 +1,101 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/Transforms/FusionCostModel.h"
+
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/BuiltinTypes.h"
+
+#define DEBUG_TYPE "iree-flow-fusion-cost-model"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+/// Returns the number of iterations of the static iteration space of |op|.
+static std::optional<int64_t> getStaticIterationCount(linalg::LinalgOp op) {
+  int64_t count = 1;
+  for (int64_t range : op.getStaticLoopRanges()) {
+    if (ShapedType::isDynamic(range)) return std::nullopt;
+    count *= range;
+  }
+  return count;
+}
+
+/// Returns the number of arithmetic operations per iteration of |op|.
+static int64_t getOpsPerIteration(linalg::LinalgOp op) {
+  auto body = op.getBlock()->without_terminator();
+  // Copies without a body still move each element once.
+  return std::max<int64_t>(std::distance(body.begin(), body.end()), 1);
+}
+
+std::optional<int64_t> FusionCostModel::estimateSavedBytes(
+    OpOperand &fusedOperand) const {
+  auto type = fusedOperand.get().getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape() ||
+      !type.getElementType().isIntOrFloat()) {
+    return std::nullopt;
+  }
+  int64_t bytes =
+      type.getNumElements() *
+      llvm::divideCeil(type.getElementType().getIntOrFloatBitWidth(), 8);
+  // Intermediates with other uses are still written to memory and only the
+  // read by the fused consumer is avoided.
+  bool hasOtherUses = llvm::any_of(
+      fusedOperand.get().getUsers(),
+      [&](Operation *user) { return user != fusedOperand.getOwner(); });
+  return hasOtherUses ? bytes : 2 * bytes;
+}
+
+std::optional<int64_t> FusionCostModel::estimateRecomputedOps(
+    OpOperand &fusedOperand) const {
+  auto producer = fusedOperand.get().getDefiningOp<linalg::LinalgOp>();
+  auto consumer = dyn_cast<linalg::LinalgOp>(fusedOperand.getOwner());
+  if (!producer || !consumer) return std::nullopt;
+  auto type = fusedOperand.get().getType().dyn_cast<RankedTensorType>();
+  std::optional<int64_t> producerIterations =
+      getStaticIterationCount(producer);
+  std::optional<int64_t> consumerIterations =
+      getStaticIterationCount(consumer);
+  if (!type || !type.hasStaticShape() || !producerIterations ||
+      !consumerIterations) {
+    return std::nullopt;
+  }
+
+  // Each element of the intermediate is computed once per consumer iteration
+  // reading it instead of once overall.
+  int64_t elementCount = std::max<int64_t>(type.getNumElements(), 1);
+  if (*consumerIterations <= elementCount) return 0;
+  int64_t extraReads = (*consumerIterations - elementCount) / elementCount;
+  int64_t opsPerElement = std::max<int64_t>(*producerIterations / elementCount,
+                                            1) *
+                          getOpsPerIteration(producer);
+  return extraReads * elementCount * opsPerElement;
+}
+
+std::optional<bool> FusionCostModel::isProfitable(
+    OpOperand &fusedOperand) const {
+  if (!isEnabled()) return std::nullopt;
+  std::optional<int64_t> savedBytes = estimateSavedBytes(fusedOperand);
+  std::optional<int64_t> recomputedOps = estimateRecomputedOps(fusedOperand);
+  if (!savedBytes || !recomputedOps) return std::nullopt;
+  bool profitable = static_cast<double>(*recomputedOps) <=
+                    static_cast<double>(*savedBytes) * hints.opsPerByte;
+  LLVM_DEBUG({
+    llvm::dbgs() << "fusion of " << fusedOperand.get() << " into "
+                 << fusedOperand.getOwner()->getName() << ": saves "
+                 << *savedBytes << " bytes, recomputes " << *recomputedOps
+                 << " ops -> " << (profitable ? "fuse" : "don't fuse") << "\n";
+  });
+  return profitable;
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
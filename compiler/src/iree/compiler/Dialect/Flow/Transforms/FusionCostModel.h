@@ -0,0 +1,70 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_FLOW_TRANSFORMS_FUSIONCOSTMODEL_H_
+#define IREE_COMPILER_DIALECT_FLOW_TRANSFORMS_FUSIONCOSTMODEL_H_
+
+#include <optional>
+
+#include "mlir/IR/Operation.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+/// Target characteristics steering fusion during dispatch region formation.
+struct FusionCostHints {
+  /// Number of arithmetic operations the target executes in the time it takes
+  /// to move one byte through device memory (the ridge point of its roofline).
+  /// Bandwidth-starved targets (such as mobile GPUs) have high values and
+  /// favor recomputation over materializing intermediates; targets with large
+  /// caches and bandwidth (such as server CPUs) have low values.
+  /// 0 disables the cost model.
+  double opsPerByte = 0.0;
+};
+
+/// Estimates whether fusing a producer into a consumer within a dispatch
+/// region is profitable.
+///
+/// Fusing avoids writing the intermediate tensor to memory and reading it back
+/// but, when the consumer iteration space is larger than the intermediate (for
+/// example when the consumer broadcasts it), the tiled producer is recomputed
+/// for each consumer tile reading the same elements. Fusion is profitable when
+/// the recomputation takes less time than the memory traffic it avoids given
+/// the target hints.
+class FusionCostModel {
+ public:
+  FusionCostModel() = default;
+  explicit FusionCostModel(FusionCostHints hints) : hints(hints) {}
+
+  bool isEnabled() const { return hints.opsPerByte > 0.0; }
+
+  /// Returns the number of bytes of memory traffic avoided by fusing the
+  /// producer of |fusedOperand| into its owner, or std::nullopt if the
+  /// intermediate does not have a static shape.
+  std::optional<int64_t> estimateSavedBytes(OpOperand &fusedOperand) const;
+
+  /// Returns the number of arithmetic operations executed again by fusing the
+  /// producer of |fusedOperand| into its owner, or std::nullopt if either op
+  /// does not have a static iteration space.
+  std::optional<int64_t> estimateRecomputedOps(OpOperand &fusedOperand) const;
+
+  /// Returns whether fusing the producer of |fusedOperand| into its owner is
+  /// profitable or std::nullopt if the model is disabled or the cost cannot be
+  /// estimated, in which case the default heuristics apply.
+  std::optional<bool> isProfitable(OpOperand &fusedOperand) const;
+
+ private:
+  FusionCostHints hints;
+};
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_FLOW_TRANSFORMS_FUSIONCOSTMODEL_H_
@@ -0,0 +1,241 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- HorizontalFusion.cpp - Fuse independent ops on tensors -----------===//
+//
+// Merges independent elementwise linalg.generic ops with the same iteration
+// space into a single multi-result linalg.generic. Models with many parallel
+// branches otherwise get one tiny dispatch per branch, each paying the launch
+// overhead; after this pass the branches share a dispatch and its workgroups.
+// This complements the producer/consumer fusion in FusionOfTensorOps.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/TilingInterface.h"
+
+#define DEBUG_TYPE "iree-flow-horizontal-fusion"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+/// Returns true if |op| is a root of dispatch region formation: its
+/// elementwise consumers are fused into its dispatch instead.
+static bool isDispatchRoot(Operation *op) {
+  if (auto genericOp = dyn_cast<linalg::GenericOp>(op)) {
+    return genericOp.getNumReductionLoops() != 0;
+  }
+  return isa<linalg::LinalgOp, TilingInterface>(op) &&
+         !isa<linalg::FillOp, tensor::PadOp>(op);
+}
+
+/// Returns true if |genericOp| can be merged with other independent ops.
+static bool isHorizontallyFusable(linalg::GenericOp genericOp) {
+  if (!genericOp.hasTensorSemantics()) return false;
+  if (genericOp->getParentOfType<IREE::Flow::DispatchRegionOp>() ||
+      genericOp->getParentOfType<IREE::Flow::DispatchWorkgroupsOp>()) {
+    return false;
+  }
+  // Only elementwise ops; reductions are dispatch roots of their own.
+  if (genericOp.getNumLoops() != genericOp.getNumParallelLoops()) return false;
+  // Equal iteration spaces can only be proven for static shapes.
+  if (llvm::any_of(genericOp.getStaticLoopRanges(), ShapedType::isDynamic)) {
+    return false;
+  }
+  if (!llvm::all_of(genericOp.getIndexingMapsArray(), [](AffineMap map) {
+        return map.isProjectedPermutation();
+      })) {
+    return false;
+  }
+  // Ops consuming the result of a root are fused into the root's dispatch,
+  // merging them with other ops would prevent that.
+  return llvm::none_of(genericOp->getOperands(), [](Value operand) {
+    Operation *producer = operand.getDefiningOp();
+    return producer && isDispatchRoot(producer);
+  });
+}
+
+/// Returns true if |lhs| and |rhs| iterate over the same loop nest.
+static bool haveSameIterationSpace(linalg::GenericOp lhs,
+                                   linalg::GenericOp rhs) {
+  return lhs.getIteratorTypesArray() == rhs.getIteratorTypesArray() &&
+         lhs.getStaticLoopRanges() == rhs.getStaticLoopRanges();
+}
+
+/// Returns true if |op| (transitively) uses a result of |earlierOp|, which
+/// precedes it in the same block.
+static bool dependsOn(Operation *op, Operation *earlierOp) {
+  SetVector<Operation *> slice;
+  getBackwardSlice(op, &slice, [&](Operation *sliceOp) {
+    return sliceOp->getBlock() == earlierOp->getBlock() &&
+           !sliceOp->isBeforeInBlock(earlierOp);
+  });
+  return slice.contains(earlierOp);
+}
+
+/// Returns true if a result of |earlierOp| is used before |laterOp| in their
+/// block, in which case the merged op placed at |laterOp| could not replace it.
+static bool hasUsesBefore(Operation *earlierOp, Operation *laterOp) {
+  Block *block = laterOp->getBlock();
+  return llvm::any_of(earlierOp->getUsers(), [&](Operation *user) {
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    return ancestor && ancestor->isBeforeInBlock(laterOp);
+  });
+}
+
+/// Merges |first| and |second| into a single generic op with the operands and
+/// results of |first| followed by those of |second|.
+static linalg::GenericOp fuseHorizontally(RewriterBase &rewriter,
+                                          linalg::GenericOp first,
+                                          linalg::GenericOp second) {
+  rewriter.setInsertionPoint(second);
+  SmallVector<Value> inputs = llvm::to_vector(first.getInputs());
+  llvm::append_range(inputs, second.getInputs());
+  SmallVector<Value> outputs = llvm::to_vector(first.getOutputs());
+  for (Value output : second.getOutputs()) {
+    // Results must not share an init tensor or they would be bufferized into
+    // the same buffer.
+    auto emptyOp = output.getDefiningOp<tensor::EmptyOp>();
+    if (emptyOp && llvm::is_contained(outputs, output)) {
+      output = rewriter.clone(*emptyOp)->getResult(0);
+    }
+    outputs.push_back(output);
+  }
+  SmallVector<AffineMap> indexingMaps;
+  for (linalg::GenericOp op : {first, second}) {
+    for (OpOperand *operand : op.getDpsInputOperands()) {
+      indexingMaps.push_back(op.getMatchingIndexingMap(operand));
+    }
+  }
+  for (linalg::GenericOp op : {first, second}) {
+    for (OpOperand *operand : op.getDpsInitOperands()) {
+      indexingMaps.push_back(op.getMatchingIndexingMap(operand));
+    }
+  }
+  SmallVector<Type> resultTypes(first->getResultTypes());
+  llvm::append_range(resultTypes, second->getResultTypes());
+
+  Location loc = rewriter.getFusedLoc({first.getLoc(), second.getLoc()});
+  auto fusedOp = rewriter.create<linalg::GenericOp>(
+      loc, resultTypes, inputs, outputs, indexingMaps,
+      first.getIteratorTypesArray());
+
+  // Block arguments follow the operand order: all inputs, then all outputs.
+  Block *fusedBlock = rewriter.createBlock(&fusedOp.getRegion());
+  IRMapping mapping;
+  auto mapArguments = [&](linalg::GenericOp op, bool inputArguments) {
+    Block *block = op.getBody();
+    unsigned inputCount = op.getNumDpsInputs();
+    auto arguments = inputArguments
+                         ? block->getArguments().take_front(inputCount)
+                         : block->getArguments().drop_front(inputCount);
+    for (BlockArgument argument : arguments) {
+      mapping.map(argument, fusedBlock->addArgument(argument.getType(),
+                                                    argument.getLoc()));
+    }
+  };
+  mapArguments(first, /*inputArguments=*/true);
+  mapArguments(second, /*inputArguments=*/true);
+  mapArguments(first, /*inputArguments=*/false);
+  mapArguments(second, /*inputArguments=*/false);
+
+  SmallVector<Value> yieldedValues;
+  for (linalg::GenericOp op : {first, second}) {
+    for (Operation &bodyOp : op.getBody()->without_terminator()) {
+      rewriter.clone(bodyOp, mapping);
+    }
+    auto yieldOp = cast<linalg::YieldOp>(op.getBody()->getTerminator());
+    for (Value value : yieldOp.getValues()) {
+      yieldedValues.push_back(mapping.lookupOrDefault(value));
+    }
+  }
+  rewriter.create<linalg::YieldOp>(loc, yieldedValues);
+
+  rewriter.replaceOp(first,
+                     fusedOp.getResults().take_front(first->getNumResults()));
+  rewriter.replaceOp(second,
+                     fusedOp.getResults().drop_front(first->getNumResults()));
+  return fusedOp;
+}
+
+namespace {
+
+struct HorizontalFusionPass
+    : public HorizontalFusionBase<HorizontalFusionPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect>();
+  }
+  HorizontalFusionPass(unsigned maxFusedOps) {
+    this->maxFusedOps = maxFusedOps;
+  }
+  HorizontalFusionPass(const HorizontalFusionPass &pass)
+      : HorizontalFusionPass(pass.maxFusedOps) {}
+
+  void runOnOperation() override {
+    SmallVector<Block *> blocks;
+    getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+    IRRewriter rewriter(&getContext());
+    for (Block *block : blocks) fuseInBlock(rewriter, block);
+  }
+
+ private:
+  void fuseInBlock(RewriterBase &rewriter, Block *block);
+};
+
+}  // namespace
+
+void HorizontalFusionPass::fuseInBlock(RewriterBase &rewriter, Block *block) {
+  // Ops that later ops may still be merged into, with the number of original
+  // ops each one represents.
+  SmallVector<linalg::GenericOp> candidates;
+  DenseMap<Operation *, unsigned> fusedOpCounts;
+  for (Operation &op : llvm::make_early_inc_range(*block)) {
+    auto genericOp = dyn_cast<linalg::GenericOp>(&op);
+    if (!genericOp || !isHorizontallyFusable(genericOp)) continue;
+
+    bool fused = false;
+    for (linalg::GenericOp &candidate : candidates) {
+      unsigned candidateCount = fusedOpCounts.lookup(candidate);
+      if (candidateCount == 0) candidateCount = 1;
+      if (candidateCount >= maxFusedOps ||
+          !haveSameIterationSpace(candidate, genericOp) ||
+          dependsOn(genericOp, candidate) ||
+          hasUsesBefore(candidate, genericOp)) {
+        continue;
+      }
+      LLVM_DEBUG(llvm::dbgs() << "horizontally fusing " << genericOp.getLoc()
+                              << " into " << candidate.getLoc() << "\n");
+      fusedOpCounts.erase(candidate);
+      candidate = fuseHorizontally(rewriter, candidate, genericOp);
+      fusedOpCounts[candidate] = candidateCount + 1;
+      fused = true;
+      break;
+    }
+    if (!fused) candidates.push_back(genericOp);
+  }
+}
+
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createHorizontalFusionPass(unsigned maxFusedOps) {
+  return std::make_unique<HorizontalFusionPass>(maxFusedOps);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
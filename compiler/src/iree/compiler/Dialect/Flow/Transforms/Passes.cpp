@@ -68,6 +68,43 @@ static llvm::cl::opt<bool> clEnableAggressiveFusion(
         "with reduction loops"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> clEnableHorizontalFusion(
+    "iree-flow-enable-horizontal-fusion",
+    llvm::cl::desc("Enable fusing independent elementwise ops with the same "
+                   "iteration space into a single dispatch"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int64_t> clRematerializationMemoryBudget(
+    "iree-flow-rematerialization-memory-budget",
+    llvm::cl::desc(
+        "Bytes of tensors kept alive across ops above which cheap producers "
+        "such as elementwise ops and broadcasts are recomputed next to their "
+        "distant consumers; 0 disables rematerialization"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<double> clFusionOpsPerByte(
+    "iree-flow-fusion-ops-per-byte",
+    llvm::cl::desc(
+        "Overrides the operations per byte of memory traffic of the targets "
+        "used by the fusion cost model when forming dispatch regions; 0 "
+        "disables the cost model"),
+    llvm::cl::init(-1.0));
+
+static llvm::cl::opt<int64_t> clSplitKMinParallelism(
+    "iree-flow-split-k-min-parallelism",
+    llvm::cl::desc(
+        "Overrides the number of output elements of the targets below which "
+        "matmuls with a large reduction dimension are split along it; 0 "
+        "disables the automatic split"),
+    llvm::cl::init(-1));
+
+static llvm::cl::list<int64_t> clDispatchShapeBuckets(
+    "iree-flow-dispatch-shape-buckets",
+    llvm::cl::desc("Sizes to specialize dispatches with a single dynamic "
+                   "dimension for, such as common sequence lengths. The fully "
+                   "dynamic dispatch is kept as a fallback."),
+    llvm::cl::CommaSeparated);
+
 static llvm::cl::opt<bool> clDispatchGenerateWorkloadRegion(
     "iree-flow-dispatch-generate-workload-region",
     llvm::cl::desc("Generate the workload region"), llvm::cl::init(true));
@@ -76,6 +113,25 @@ static llvm::cl::opt<bool> clEnableDataTiling(
     "iree-flow-enable-data-tiling", llvm::cl::desc("Enable data tiling path"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> clEnableConvToWinograd(
+    "iree-flow-enable-conv-winograd-transform",
+    llvm::cl::desc("Convert 3x3 convolutions with constant filters to "
+                   "Winograd F(4x4, 3x3) when it is estimated to be cheaper"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clEnableAutoMixedPrecision(
+    "iree-flow-enable-auto-mixed-precision",
+    llvm::cl::desc("Demote the inputs of f32 matmuls and convolutions to f16 "
+                   "when range analysis proves it safe, keeping accumulation "
+                   "and all other ops in f32"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clAutoMixedPrecisionBF16(
+    "iree-flow-auto-mixed-precision-bf16",
+    llvm::cl::desc("Demote to bf16 instead of f16 when "
+                   "--iree-flow-enable-auto-mixed-precision is set"),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> clNormalizeInputIndexingMap(
     "iree-flow-normalize-input-indexing-map",
     llvm::cl::desc("Enable normalizing input indexing map to identity"),
@@ -174,6 +230,12 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   if (clDemoteI64ToI32) {
     passManager.addPass(IREE::Util::createDemoteI64ToI32Pass());
   }
+  // Mixed precision runs ahead of global optimization so that the truncation
+  // of constant weights is folded away by const-eval.
+  if (clEnableAutoMixedPrecision) {
+    passManager.addPass(IREE::Flow::createAutoMixedPrecisionPass(
+        /*useBF16=*/clAutoMixedPrecisionBF16));
+  }
 
   // Preprocessing passes to get the program into a canonical state.
   FunctionLikeNest(passManager)
@@ -190,6 +252,14 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   passManager.addPass(IREE::Flow::createExpandTensorShapesPass());
   buildGlobalOptimizationPassPipeline(passManager, transformOptions);
 
+  // Winograd needs the filters as constants to fold their transform at compile
+  // time, so run it once global optimization has inlined and folded them.
+  FunctionLikeNest(passManager)
+      .addPredicatedPass(clEnableConvToWinograd, []() {
+        return IREE::LinalgExt::createConvertConv2DToWinogradPass(
+            /*outputTileSize=*/4, /*checkCost=*/true);
+      });
+
   // Pad tensors.
   passManager.addPass(IREE::Flow::createTensorPadToTensorInsertSlicePass(
       /*skipSingleLinalgOpUses=*/clEnableFusePaddingIntoLinalgConsumerOps));
@@ -213,7 +283,12 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       .addPass(mlir::createCSEPass)
       .addPass(createCollapseDimsPass)
       // Split reduction operations into parallel and reduction.
-      .addPass(createSplitReductionPass)
+      .addPass([&]() {
+        int64_t minParallelism = clSplitKMinParallelism >= 0
+                                     ? clSplitKMinParallelism
+                                     : transformOptions.splitKMinParallelism;
+        return createSplitReductionPass(minParallelism);
+      })
       // SplitReductionPass may create reduction dimension that are not the last
       // dimension.
       .addPass(createInterchangeGenericOpsPass)
@@ -222,8 +297,27 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       // transpose.
       .addPredicatedPass(clNormalizeInputIndexingMap,
                          createInterchangeTransposeGenericOpsPass)
+      // Merge independent elementwise ops so that parallel branches share a
+      // dispatch.
+      .addPredicatedPass(clEnableHorizontalFusion,
+                         []() { return createHorizontalFusionPass(); })
+      // Trade recomputation of cheap producers for a lower peak memory.
+      .addPredicatedPass(clRematerializationMemoryBudget > 0,
+                         []() {
+                           return createRematerializeForMemoryPass(
+                               clRematerializationMemoryBudget);
+                         })
       // Enable data tiling after all linalg level transformations.
-      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass)
+      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass);
+
+  // Data tiling introduces the packing of constant weights after the global
+  // optimization pipeline hoisted constant expressions; hoist it as well so
+  // that weights are packed once in initializers instead of on every call.
+  if (clEnableDataTiling && transformOptions.constExprHoisting) {
+    passManager.addPass(IREE::Util::createHoistIntoGlobalsPass());
+  }
+
+  FunctionLikeNest(passManager)
       ////////////////////////////////////////////////////////////////////////
       // Dispatch region formation.
       .addPredicatedPass(!clDispatchTransformFileName.empty(),
@@ -234,8 +328,10 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       // Only want use the transform dialect for some dispatch regions and let
       // the FormDispatchRegions handle the rest.
       .addPass([&]() {
-        return createFormDispatchRegionsPass(clEnableAggressiveFusion,
-                                             clDispatchGenerateWorkloadRegion);
+        return createFormDispatchRegionsPass(
+            clEnableAggressiveFusion, clDispatchGenerateWorkloadRegion,
+            clFusionOpsPerByte >= 0.0 ? clFusionOpsPerByte
+                                      : transformOptions.fusionOpsPerByte);
       })
       // Collapse dimensions of linalg Ops.
       .addPass(createCollapseDimensionsPass)
@@ -247,7 +343,14 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       ////////////////////////////////////////////////////////////////////////
       .addPass(createCaptureDispatchDynamicDimsPass)
       .addPass(mlir::createCanonicalizerPass)
-      .addPass(createCSEPass);
+      .addPass(createCSEPass)
+      // Specialize dynamic dispatches for the expected sizes once all of their
+      // dims have been captured.
+      .addPredicatedPass(!clDispatchShapeBuckets.empty(), []() {
+        return createSpecializeDispatchShapesPass(clDispatchShapeBuckets);
+      })
+      .addPredicatedPass(!clDispatchShapeBuckets.empty(),
+                         mlir::createCanonicalizerPass);
 
   // Initialize any empty tensors to zero.
   passManager.addPass(createInitializeEmptyTensorsPass(clZeroFillEmptyTensors));
@@ -38,6 +38,15 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
   // because constant-evaluators can depend on the whole compiler, of which
   // this is a part, and we maintain strict optionality for this component.
   std::function<void(OpPassManager &passManager)> buildConstEvalPassPipeline;
+
+  // Target hints for the fusion cost model used when forming dispatch regions
+  // (see FusionCostHints). Typically derived from the target backends.
+  double fusionOpsPerByte = 0.0;
+
+  // Number of output elements below which matmuls with a large reduction
+  // dimension are split along it (split-K); 0 disables the automatic split.
+  // Typically derived from the target backends.
+  int64_t splitKMinParallelism = 0;
 };
 
 // Adds a set of passes to the given pass manager that run the required flow
@@ -90,6 +99,16 @@ std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFusionOfTensorOpsPass(bool fuseMultiUse = false,
                             unsigned multiUseFusionIteration = 2);
 
+// Creates a pass to fuse independent elementwise Linalg operations with the
+// same iteration space into multi-result operations so that they share a
+// dispatch.
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createHorizontalFusionPass(unsigned maxFusedOps = 8);
+
+// Demotes the inputs of f32 matmuls and convolutions to f16 (or bf16 when
+// |useBF16| is set) while keeping their accumulation in f32.
+std::unique_ptr<Pass> createAutoMixedPrecisionPass(bool useBF16 = false);
+
 // Infers and inserts util.numeric.optional_narrow ops at points that may be
 // beneficial.
 std::unique_ptr<Pass> createInferNumericNarrowingPass();
@@ -115,6 +134,11 @@ std::unique_ptr<Pass> createConvertToFlowPass();
 // iree-flow-infer-numeric-narrowing.
 std::unique_ptr<Pass> createOptimizeNumericsPass();
 
+// Recomputes cheap producers next to their distant consumers while the
+// tensors kept alive across ops exceed |memoryBudget| bytes.
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createRematerializeForMemoryPass(int64_t memoryBudget = 0);
+
 // Sets encoding for tensors to allow tiled execution of operations.
 std::unique_ptr<Pass> createSetEncodingPass();
 
@@ -132,10 +156,12 @@ std::unique_ptr<Pass> createVerifyInputLegalityPass();
 //===----------------------------------------------------------------------===//
 
 // Pass to form dispatch.region ops from Linalg on tensor ops. A dispatch region
-// is created for each tiled loop nest.
+// is created for each tiled loop nest. A non-zero |fusionOpsPerByte| enables
+// the fusion cost model with the given FusionCostHints::opsPerByte.
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFormDispatchRegionsPass(bool aggressiveFusion = false,
-                              bool generateWorkloadRegion = true);
+                              bool generateWorkloadRegion = true,
+                              double fusionOpsPerByte = 0.0);
 
 // Pass to collapse dimensions of Linalg Ops on tensor ops.
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
@@ -190,8 +216,22 @@ createDeduplicateExecutablesPass();
 // representation.
 std::unique_ptr<Pass> createRaiseSpecialOps();
 
-// Create a pass to split reduction dimension.
-std::unique_ptr<Pass> createSplitReductionPass();
+// Creates a pass partitioning entry points whose arguments are annotated with
+// `iree.sharding.dim` across |shardCount| participants of the default
+// collective channel, each running the same program on its local shards.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createShardTensorsPass(
+    int64_t shardCount = 1);
+
+// Creates a pass specializing dispatches with a single dynamic dimension for
+// each of |buckets| with a runtime selection falling back to the dynamic
+// dispatch.
+std::unique_ptr<Pass> createSpecializeDispatchShapesPass(
+    ArrayRef<int64_t> buckets = {});
+
+// Create a pass to split reduction dimension. A non-zero |minParallelism|
+// splits the reduction of static matmuls with fewer output elements across
+// enough workgroups to reach it (split-K).
+std::unique_ptr<Pass> createSplitReductionPass(int64_t minParallelism = 0);
 
 // Create a pass to collapse reduction dimensions
 std::unique_ptr<Pass> createCollapseDimsPass();
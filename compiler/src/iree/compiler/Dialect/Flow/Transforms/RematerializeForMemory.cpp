@@ -0,0 +1,257 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- RematerializeForMemory.cpp - Trade recomputation for memory ------===//
+//
+// Recomputes cheap producers (elementwise ops, broadcasts, fills) next to
+// their distant consumers when the tensors kept alive across a function
+// exceed a memory budget. The recomputed op is fused into the dispatch of its
+// consumer so the original large intermediate no longer has to be kept alive
+// between its uses, lowering the peak transient memory at the cost of redoing
+// cheap work.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+
+#define DEBUG_TYPE "iree-flow-rematerialize-for-memory"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+/// Returns true if |op| is cheap enough to be computed again next to a
+/// distant consumer.
+static bool isCheapToRecompute(Operation *op) {
+  if (isa<linalg::FillOp>(op)) return true;
+  auto genericOp = dyn_cast<linalg::GenericOp>(op);
+  if (!genericOp || !genericOp.hasTensorSemantics() ||
+      genericOp->getNumResults() != 1) {
+    return false;
+  }
+  // Elementwise and broadcasting ops only; reductions read more than they
+  // write.
+  if (genericOp.getNumLoops() != genericOp.getNumParallelLoops()) return false;
+  return llvm::all_of(genericOp.getIndexingMapsArray(), [](AffineMap map) {
+    return map.isProjectedPermutation();
+  });
+}
+
+/// Returns true if |value| is expected to be fused into the dispatch of its
+/// consumer and never be materialized: it is produced by a cheap op and only
+/// used by the linalg op immediately following it.
+static bool isFusedIntoConsumer(Value value) {
+  Operation *producer = value.getDefiningOp();
+  if (!producer || !isCheapToRecompute(producer) || !value.hasOneUse()) {
+    return false;
+  }
+  Operation *user = *value.getUsers().begin();
+  return user == producer->getNextNode() && isa<linalg::LinalgOp>(user);
+}
+
+/// Returns the size in bytes of the storage of |value| in the function or
+/// 0 if it either has none (arguments are owned by the caller) or can't be
+/// computed statically.
+static int64_t getStorageSize(Value value) {
+  auto type = value.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape() ||
+      !type.getElementType().isIntOrFloat()) {
+    return 0;
+  }
+  if (value.isa<BlockArgument>() || value.getDefiningOp<tensor::EmptyOp>() ||
+      isFusedIntoConsumer(value)) {
+    return 0;
+  }
+  return (type.getNumElements() * type.getElementTypeBitWidth() + 7) / 8;
+}
+
+namespace {
+
+/// Live ranges of the tensors produced in a block, in op positions.
+class BlockLiveness {
+ public:
+  explicit BlockLiveness(Block *block) {
+    int64_t position = 0;
+    for (Operation &op : *block) positions[&op] = position++;
+    for (Operation &op : *block) {
+      for (Value result : op.getResults()) {
+        int64_t size = getStorageSize(result);
+        if (size == 0) continue;
+        LiveRange range = {positions[&op], positions[&op], size};
+        for (Operation *user : result.getUsers()) {
+          Operation *ancestor = block->findAncestorOpInBlock(*user);
+          if (ancestor) range.end = std::max(range.end, positions[ancestor]);
+        }
+        ranges[result] = range;
+      }
+    }
+  }
+
+  /// Returns the position of |op| in the block.
+  int64_t getPosition(Operation *op) const { return positions.lookup(op); }
+
+  /// Returns the number of bytes held after each op of the block.
+  SmallVector<int64_t> getPressure() const {
+    SmallVector<int64_t> pressure(positions.size() + 1, 0);
+    for (auto &it : ranges) {
+      pressure[it.second.start] += it.second.size;
+      pressure[it.second.end] -= it.second.size;
+    }
+    for (size_t i = 1; i < pressure.size(); ++i) pressure[i] += pressure[i - 1];
+    pressure.pop_back();
+    return pressure;
+  }
+
+  /// Returns the position of the last use of |value| or -1 if it is not
+  /// tracked.
+  int64_t getEnd(Value value) const {
+    auto it = ranges.find(value);
+    return it == ranges.end() ? -1 : it->second.end;
+  }
+
+  /// Returns the tracked size of |value|.
+  int64_t getSize(Value value) const {
+    auto it = ranges.find(value);
+    return it == ranges.end() ? 0 : it->second.size;
+  }
+
+  /// Calls |fn| with each tracked value and its range.
+  template <typename Fn>
+  void forEachRange(Fn fn) const {
+    for (auto &it : ranges) fn(it.first, it.second.start, it.second.end);
+  }
+
+ private:
+  struct LiveRange {
+    // Op producing the value.
+    int64_t start;
+    // Last op using the value.
+    int64_t end;
+    int64_t size;
+  };
+  DenseMap<Operation *, int64_t> positions;
+  llvm::MapVector<Value, LiveRange> ranges;
+};
+
+/// A producer to recompute before |insertionPoint| for all uses at or after
+/// it.
+struct Rematerialization {
+  Value value;
+  Operation *insertionPoint = nullptr;
+  int64_t savedBytes = 0;
+};
+
+}  // namespace
+
+/// Finds the value held across the op at |position| whose recomputation next
+/// to its next use saves the most memory.
+static Rematerialization findRematerialization(Block *block,
+                                               const BlockLiveness &liveness,
+                                               int64_t position) {
+  Rematerialization best;
+  liveness.forEachRange([&](Value value, int64_t start, int64_t end) {
+    if (start > position || end <= position) return;
+    Operation *producer = value.getDefiningOp();
+    if (!isCheapToRecompute(producer)) return;
+
+    // The next use after |position| is where the value is recomputed.
+    Operation *nextUser = nullptr;
+    int64_t nextPosition = end;
+    for (Operation *user : value.getUsers()) {
+      Operation *ancestor = block->findAncestorOpInBlock(*user);
+      int64_t userPosition = liveness.getPosition(ancestor);
+      if (userPosition > position && userPosition <= nextPosition) {
+        nextUser = ancestor;
+        nextPosition = userPosition;
+      }
+    }
+    if (!nextUser) return;
+
+    // Inputs of the producer now have to be kept alive until the next use.
+    int64_t savedBytes = liveness.getSize(value);
+    for (Value input : producer->getOperands()) {
+      if (liveness.getEnd(input) < nextPosition) {
+        savedBytes -= liveness.getSize(input);
+      }
+    }
+    if (savedBytes > best.savedBytes) {
+      best = {value, nextUser, savedBytes};
+    }
+  });
+  return best;
+}
+
+/// Recomputes cheap producers in |block| until the bytes held across ops fit
+/// in |memoryBudget| or no producer can be recomputed profitably.
+static void rematerializeInBlock(Block *block, int64_t memoryBudget) {
+  // Each rematerialization shortens a live range so this terminates; the
+  // bound guards against ping-ponging between equivalent choices.
+  for (size_t attempt = 0, e = block->getOperations().size(); attempt < e;
+       ++attempt) {
+    BlockLiveness liveness(block);
+    SmallVector<int64_t> pressure = liveness.getPressure();
+    Rematerialization remat;
+    for (auto [position, bytes] : llvm::enumerate(pressure)) {
+      if (bytes <= memoryBudget) continue;
+      remat = findRematerialization(block, liveness, position);
+      if (remat.value) break;
+    }
+    if (!remat.value) return;
+
+    LLVM_DEBUG(llvm::dbgs() << "recomputing " << remat.value << " before "
+                            << *remat.insertionPoint << " saving "
+                            << remat.savedBytes << " bytes\n");
+    int64_t insertionPosition = liveness.getPosition(remat.insertionPoint);
+    OpBuilder builder(remat.insertionPoint);
+    Operation *producer = remat.value.getDefiningOp();
+    Value clone = builder.clone(*producer)->getResult(0);
+    remat.value.replaceUsesWithIf(clone, [&](OpOperand &use) {
+      Operation *ancestor = block->findAncestorOpInBlock(*use.getOwner());
+      return ancestor && liveness.getPosition(ancestor) >= insertionPosition;
+    });
+    if (producer->use_empty()) producer->erase();
+  }
+}
+
+namespace {
+
+struct RematerializeForMemoryPass
+    : public RematerializeForMemoryBase<RematerializeForMemoryPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect>();
+  }
+  RematerializeForMemoryPass(int64_t memoryBudget) {
+    this->memoryBudget = memoryBudget;
+  }
+  RematerializeForMemoryPass(const RematerializeForMemoryPass &pass)
+      : RematerializeForMemoryPass(pass.memoryBudget) {}
+
+  void runOnOperation() override {
+    if (memoryBudget <= 0) return;
+    SmallVector<Block *> blocks;
+    getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+    for (Block *block : blocks) rematerializeInBlock(block, memoryBudget);
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createRematerializeForMemoryPass(int64_t memoryBudget) {
+  return std::make_unique<RematerializeForMemoryPass>(memoryBudget);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
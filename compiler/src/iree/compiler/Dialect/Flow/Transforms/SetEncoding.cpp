@@ -62,10 +62,12 @@ static FailureOr<Value> getZero(OpBuilder &builder, Location loc,
 }
 
 /// Pads `value` to `padding` if needed. If no padding is specified,
-/// return `value` itself.
+/// return `value` itself. The leading `numBatchDims` dimensions are not tiled
+/// by the encodings and are never padded.
 static FailureOr<Value> padIfNeeded(OpBuilder &builder, Location loc,
                                     Value value,
-                                    Optional<int64_t> padding = std::nullopt) {
+                                    Optional<int64_t> padding = std::nullopt,
+                                    int64_t numBatchDims = 0) {
   if (!padding) return value;
 
   OpFoldResult paddingOfr = builder.getIndexAttr(padding.value());
@@ -86,6 +88,7 @@ static FailureOr<Value> padIfNeeded(OpBuilder &builder, Location loc,
   AffineExpr highPadExpr =
       shapeExpr.ceilDiv(paddingExpr) * paddingExpr - shapeExpr;
   for (auto shape : llvm::enumerate(shape.value())) {
+    if (shape.index() < numBatchDims) continue;
     highPad[shape.index()] = makeComposedFoldedAffineApply(
         builder, loc, highPadExpr, {paddingOfr, shape.value()});
   }
@@ -109,16 +112,19 @@ static FailureOr<Value> padIfNeeded(OpBuilder &builder, Location loc,
 
 namespace {
 
-/// Rewrites the matmul op to work on tensors with encoding. Optionally
-/// also pads the operands.
-struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
+/// Rewrites the matmul or batch_matmul op to work on tensors with encoding.
+/// Optionally also pads the operands.
+template <typename OpTy>
+struct SetMatmulEncoding : public OpRewritePattern<OpTy> {
   SetMatmulEncoding(MLIRContext *context, int64_t padding,
                     PatternBenefit benefit = 1)
-      : OpRewritePattern<linalg::MatmulOp>(context, benefit),
-        padding(padding) {}
+      : OpRewritePattern<OpTy>(context, benefit), padding(padding) {}
 
-  LogicalResult matchAndRewrite(linalg::MatmulOp matmulOp,
+  LogicalResult matchAndRewrite(OpTy matmulOp,
                                 PatternRewriter &rewriter) const override {
+    constexpr bool isBatchMatmul =
+        std::is_same<OpTy, linalg::BatchMatmulOp>::value;
+    constexpr int64_t numBatchDims = isBatchMatmul ? 1 : 0;
     if (!matmulOp.hasTensorSemantics()) return failure();
     auto inputs = matmulOp.getDpsInputOperands();
     auto outputs = matmulOp.getDpsInitOperands();
@@ -154,15 +160,27 @@ struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
     TensorEncoding outEncoding;
 
     if (lhsElemType.isF32() && rhsElemType.isF32() && outElemType.isF32()) {
-      lhsEncoding = TensorEncoding::MATMUL_F32F32F32_LHS;
-      rhsEncoding = TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE;
-      outEncoding = TensorEncoding::MATMUL_F32F32F32_RESULT;
+      if (isBatchMatmul) {
+        lhsEncoding = TensorEncoding::BATCH_MATMUL_F32F32F32_LHS;
+        rhsEncoding = TensorEncoding::BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE;
+        outEncoding = TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT;
+      } else {
+        lhsEncoding = TensorEncoding::MATMUL_F32F32F32_LHS;
+        rhsEncoding = TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE;
+        outEncoding = TensorEncoding::MATMUL_F32F32F32_RESULT;
+      }
     } else if (lhsElemType.isSignlessInteger(8) &&
                rhsElemType.isSignlessInteger(8) &&
                outElemType.isSignlessInteger(32)) {
-      lhsEncoding = TensorEncoding::MATMUL_I8I8I32_LHS;
-      rhsEncoding = TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE;
-      outEncoding = TensorEncoding::MATMUL_I8I8I32_RESULT;
+      if (isBatchMatmul) {
+        lhsEncoding = TensorEncoding::BATCH_MATMUL_I8I8I32_LHS;
+        rhsEncoding = TensorEncoding::BATCH_MATMUL_I8I8I32_RHS_TRANSPOSE;
+        outEncoding = TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT;
+      } else {
+        lhsEncoding = TensorEncoding::MATMUL_I8I8I32_LHS;
+        rhsEncoding = TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE;
+        outEncoding = TensorEncoding::MATMUL_I8I8I32_RESULT;
+      }
     } else {
       return rewriter.notifyMatchFailure(
           matmulOp,
@@ -172,19 +190,22 @@ struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
     Location loc = matmulOp.getLoc();
 
     // Set encoding for LHS (pad if necessary)
-    FailureOr<Value> paddedLhs = padIfNeeded(rewriter, loc, origLhs, padding);
+    FailureOr<Value> paddedLhs =
+        padIfNeeded(rewriter, loc, origLhs, padding, numBatchDims);
     if (failed(paddedLhs)) {
       return rewriter.notifyMatchFailure(matmulOp, "failed to pad lhs");
     }
 
     // Set encoding for RHS (pad if necessary)
-    FailureOr<Value> paddedRhs = padIfNeeded(rewriter, loc, origRhs, padding);
+    FailureOr<Value> paddedRhs =
+        padIfNeeded(rewriter, loc, origRhs, padding, numBatchDims);
     if (failed(paddedRhs)) {
       return rewriter.notifyMatchFailure(matmulOp, "failed to pad rhs");
     }
 
     // Set encoding for OUTS (pad if necessary)
-    FailureOr<Value> paddedOut = padIfNeeded(rewriter, loc, origOut, padding);
+    FailureOr<Value> paddedOut =
+        padIfNeeded(rewriter, loc, origOut, padding, numBatchDims);
     if (failed(paddedOut)) {
       return rewriter.notifyMatchFailure(matmulOp, "failed to pad output");
     }
@@ -196,7 +217,7 @@ struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
     Value encodedOut = rewriter.create<IREE::LinalgExt::SetEncodingOp>(
         loc, paddedOut.value(), outEncoding);
 
-    auto matmulTiled = rewriter.create<linalg::MatmulOp>(
+    auto matmulTiled = rewriter.create<OpTy>(
         loc, encodedOut.getType(), ValueRange{encodedLhs, encodedRhs},
         encodedOut);
     auto unsetEncoding = rewriter.create<IREE::LinalgExt::UnsetEncodingOp>(
@@ -258,6 +279,90 @@ struct FoldFillWithSetEncoding
   }
 };
 
+/// Pattern to fold an `iree_linalg_ext.set_encoding` of the result of an
+/// `iree_linalg_ext.unset_encoding` with the same encoding. This removes the
+/// round trip through the unencoded layout between two ops that both use the
+/// encoded layout.
+struct FoldSetEncodingOfUnsetEncoding
+    : public OpRewritePattern<IREE::LinalgExt::SetEncodingOp> {
+  using OpRewritePattern<IREE::LinalgExt::SetEncodingOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(IREE::LinalgExt::SetEncodingOp encodingOp,
+                                PatternRewriter &rewriter) const override {
+    Value source = encodingOp.getSource();
+    auto unsetEncodingOp =
+        source.getDefiningOp<IREE::LinalgExt::UnsetEncodingOp>();
+    if (!unsetEncodingOp ||
+        unsetEncodingOp.getSource().getType() != encodingOp.getResultType()) {
+      return failure();
+    }
+    rewriter.replaceOp(encodingOp, unsetEncodingOp.getSource());
+    return success();
+  }
+};
+
+/// Pattern to hoist an `iree_linalg_ext.set_encoding` above the elementwise
+/// `linalg.generic` producing its source when one of the inputs of that op is
+/// unset from the same encoding. The elementwise op then works on the encoded
+/// layout and the round trip folds away, so chains of elementwise ops between
+/// ops using encodings do not pack and unpack around each op. Sources that
+/// needed padding are left alone: the elementwise op would not preserve the
+/// padding value.
+struct HoistSetEncodingAboveElementwiseOp
+    : public OpRewritePattern<IREE::LinalgExt::SetEncodingOp> {
+  using OpRewritePattern<IREE::LinalgExt::SetEncodingOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(IREE::LinalgExt::SetEncodingOp encodingOp,
+                                PatternRewriter &rewriter) const override {
+    auto genericOp = encodingOp.getSource().getDefiningOp<linalg::GenericOp>();
+    if (!genericOp || !genericOp.hasTensorSemantics() ||
+        genericOp.hasIndexSemantics() || genericOp->getNumResults() != 1 ||
+        !genericOp->hasOneUse() ||
+        genericOp.getNumLoops() != genericOp.getNumParallelLoops() ||
+        !llvm::all_of(genericOp.getIndexingMapsArray(),
+                      [](AffineMap map) { return map.isIdentity(); })) {
+      return failure();
+    }
+    RankedTensorType encodedType = encodingOp.getResultType();
+    if (llvm::none_of(genericOp.getDpsInputOperands(), [&](OpOperand *input) {
+          auto unsetEncodingOp =
+              input->get().getDefiningOp<IREE::LinalgExt::UnsetEncodingOp>();
+          return unsetEncodingOp &&
+                 unsetEncodingOp.getSource().getType() == encodedType;
+        })) {
+      return rewriter.notifyMatchFailure(
+          encodingOp, "no input unset from the same encoding");
+    }
+
+    // With identity indexing maps all operands have the shape of the result
+    // and can use the same encoding.
+    Location loc = genericOp.getLoc();
+    TensorEncoding encoding = encodingOp.getResultTensorEncoding();
+    SmallVector<Value> inputs;
+    for (OpOperand *input : genericOp.getDpsInputOperands()) {
+      inputs.push_back(rewriter.create<IREE::LinalgExt::SetEncodingOp>(
+          loc, input->get(), encoding));
+    }
+    Value output = genericOp.getDpsInitOperand(0)->get();
+    if (auto emptyOp = output.getDefiningOp<tensor::EmptyOp>()) {
+      output = rewriter.create<tensor::EmptyOp>(
+          loc, emptyOp.getMixedSizes(), encodedType.getElementType(),
+          encodedType.getEncoding());
+    } else {
+      output = rewriter.create<IREE::LinalgExt::SetEncodingOp>(loc, output,
+                                                               encoding);
+    }
+    auto encodedOp = rewriter.create<linalg::GenericOp>(
+        loc, encodedType, inputs, output, genericOp.getIndexingMapsArray(),
+        genericOp.getIteratorTypesArray());
+    rewriter.cloneRegionBefore(genericOp.getRegion(), encodedOp.getRegion(),
+                               encodedOp.getRegion().begin());
+    rewriter.replaceOp(encodingOp, encodedOp->getResults());
+    rewriter.eraseOp(genericOp);
+    return success();
+  }
+};
+
 struct SetEncodingPass : public SetEncodingBase<SetEncodingPass> {
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::LinalgExt::IREELinalgExtDialect>();
@@ -271,9 +376,12 @@ void SetEncodingPass::runOnOperation() {
   MLIRContext *context = &getContext();
   {
     RewritePatternSet patterns(context);
-    patterns.insert<SetMatmulEncoding>(context, defaultPadding);
+    patterns.insert<SetMatmulEncoding<linalg::MatmulOp>,
+                    SetMatmulEncoding<linalg::BatchMatmulOp>>(context,
+                                                              defaultPadding);
     linalg::FillOp::getCanonicalizationPatterns(patterns, context);
-    patterns.insert<FoldFillWithSetEncoding>(context);
+    patterns.insert<FoldFillWithSetEncoding, FoldSetEncodingOfUnsetEncoding,
+                    HoistSetEncodingAboveElementwiseOp>(context);
     memref::populateResolveRankedShapeTypeResultDimsPatterns(patterns);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
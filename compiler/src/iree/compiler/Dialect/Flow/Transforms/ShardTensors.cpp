@@ -0,0 +1,403 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- ShardTensors.cpp - Partition entry points for tensor parallelism -===//
+//
+// Partitions entry points across the participants of the default collective
+// channel. Every participant runs the same program (SPMD) and receives its
+// local shard of the arguments annotated with `iree.sharding.dim`. The split
+// is propagated through matmuls and elementwise ops so that each participant
+// only computes its slice; partial sums are combined with an all-reduce and
+// values that can't stay split are reassembled with an all-gather.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+
+#define DEBUG_TYPE "iree-flow-shard-tensors"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// Attribute on entry point arguments naming the dimension they are split
+// along.
+static constexpr StringLiteral kShardingDimAttr = "iree.sharding.dim";
+
+// A value split along |dim| into equal slices of a tensor of |globalType|, one
+// per participant.
+struct ShardedValue {
+  int64_t dim;
+  RankedTensorType globalType;
+};
+
+// Returns the type of the local shard of |globalType| split along |dim|.
+static RankedTensorType getLocalType(RankedTensorType globalType, int64_t dim,
+                                     int64_t shardCount) {
+  SmallVector<int64_t> shape(globalType.getShape());
+  shape[dim] /= shardCount;
+  return RankedTensorType::get(shape, globalType.getElementType(),
+                               globalType.getEncoding());
+}
+
+// Returns the position of the result of the projected permutation |map|
+// indexed by |loop|, if any.
+static std::optional<int64_t> getResultPosition(AffineMap map, unsigned loop) {
+  for (unsigned i = 0; i < map.getNumResults(); ++i) {
+    if (map.getDimPosition(i) == loop) return i;
+  }
+  return std::nullopt;
+}
+
+// Returns true if |init| is a tensor filled with zeros.
+static bool isZeroFill(Value init) {
+  auto fillOp = init.getDefiningOp<linalg::FillOp>();
+  if (!fillOp) return false;
+  Value value = fillOp.getDpsInputOperand(0)->get();
+  return matchPattern(value, m_AnyZeroFloat()) ||
+         matchPattern(value, m_Zero());
+}
+
+// Returns true if |init| carries no data besides a (fill) value so that its
+// local shard can be created by each participant.
+static bool isLocallyCreatable(Value init) {
+  if (init.getDefiningOp<tensor::EmptyOp>()) return true;
+  auto fillOp = init.getDefiningOp<linalg::FillOp>();
+  return fillOp &&
+         fillOp.getDpsInitOperand(0)->get().getDefiningOp<tensor::EmptyOp>();
+}
+
+// Creates the local shard of type |localType| of the creatable |init|.
+static Value createLocalInit(OpBuilder &builder, Value init,
+                             RankedTensorType localType) {
+  Location loc = init.getLoc();
+  Value emptyTensor = builder.create<tensor::EmptyOp>(
+      loc, localType.getShape(), localType.getElementType());
+  auto fillOp = init.getDefiningOp<linalg::FillOp>();
+  if (!fillOp) return emptyTensor;
+  return builder
+      .create<linalg::FillOp>(loc,
+                              ValueRange{fillOp.getDpsInputOperand(0)->get()},
+                              ValueRange{emptyTensor})
+      ->getResult(0);
+}
+
+// Propagates the sharding of the arguments of a function through its body.
+class Partitioner {
+ public:
+  explicit Partitioner(int64_t shardCount) : shardCount(shardCount) {}
+
+  LogicalResult partition(func::FuncOp funcOp);
+
+ private:
+  // Marks |value| as split along |dim| and changes its type to the one of the
+  // local shard.
+  void markSharded(Value value, int64_t dim) {
+    auto globalType = value.getType().cast<RankedTensorType>();
+    value.setType(getLocalType(globalType, dim, shardCount));
+    shardedValues[value] = {dim, globalType};
+  }
+
+  std::optional<int64_t> getShardDim(Value value) const {
+    auto it = shardedValues.find(value);
+    if (it == shardedValues.end()) return std::nullopt;
+    return it->second.dim;
+  }
+
+  bool partitionMatmul(linalg::MatmulOp matmulOp);
+  bool partitionElementwise(linalg::GenericOp genericOp);
+  void gatherOperands(Operation *op);
+  Value gather(Value value);
+
+  int64_t shardCount;
+  DenseMap<Value, ShardedValue> shardedValues;
+  // Sharded values reassembled on all participants.
+  DenseMap<Value, Value> gatheredValues;
+};
+
+LogicalResult Partitioner::partition(func::FuncOp funcOp) {
+  if (!funcOp.getBody().hasOneBlock()) {
+    return funcOp.emitError()
+           << "sharded arguments are only supported on single block functions";
+  }
+  for (BlockArgument arg : funcOp.getArguments()) {
+    auto dimAttr = funcOp.getArgAttrOfType<IntegerAttr>(arg.getArgNumber(),
+                                                        kShardingDimAttr);
+    if (!dimAttr) continue;
+    int64_t dim = dimAttr.getInt();
+    auto type = arg.getType().dyn_cast<RankedTensorType>();
+    if (!type || !type.hasStaticShape() || dim < 0 || dim >= type.getRank() ||
+        type.getDimSize(dim) % shardCount != 0) {
+      return funcOp.emitError()
+             << "argument " << arg.getArgNumber()
+             << " can't be split along dimension " << dim << " into "
+             << shardCount << " equal shards";
+    }
+    markSharded(arg, dim);
+  }
+
+  for (Operation &op :
+       llvm::make_early_inc_range(funcOp.getBody().front())) {
+    bool partitioned = false;
+    if (auto matmulOp = dyn_cast<linalg::MatmulOp>(op)) {
+      partitioned = partitionMatmul(matmulOp);
+    } else if (auto genericOp = dyn_cast<linalg::GenericOp>(op)) {
+      partitioned = partitionElementwise(genericOp);
+    }
+    if (!partitioned) gatherOperands(&op);
+  }
+
+  // Arguments now receive the local shards.
+  funcOp.setType(FunctionType::get(funcOp.getContext(),
+                                   funcOp.getBody().getArgumentTypes(),
+                                   funcOp.getResultTypes()));
+  return success();
+}
+
+// Matmuls with one operand split along M or N produce a result split the same
+// way. With both operands split along K each participant computes a partial
+// sum that is all-reduced.
+bool Partitioner::partitionMatmul(linalg::MatmulOp matmulOp) {
+  if (!matmulOp.hasTensorSemantics()) return false;
+  Value lhs = matmulOp.getDpsInputOperand(0)->get();
+  Value rhs = matmulOp.getDpsInputOperand(1)->get();
+  OpOperand *initOperand = matmulOp.getDpsInitOperand(0);
+  Value init = initOperand->get();
+  std::optional<int64_t> lhsDim = getShardDim(lhs);
+  std::optional<int64_t> rhsDim = getShardDim(rhs);
+  std::optional<int64_t> initDim = getShardDim(init);
+  Value result = matmulOp->getResult(0);
+
+  if (lhsDim == 1 && rhsDim == 0) {
+    // The init would be accumulated once per participant.
+    if (initDim || !isZeroFill(init)) return false;
+    OpBuilder builder(matmulOp);
+    builder.setInsertionPointAfter(matmulOp);
+    auto allReduceOp = builder.create<CollectiveAllReduceOp>(
+        matmulOp.getLoc(), result.getType(),
+        CollectiveReductionOp::ReductionSum, result);
+    result.replaceAllUsesExcept(allReduceOp.getResult(), allReduceOp);
+    return true;
+  }
+
+  std::optional<int64_t> resultDim;
+  if (lhsDim == 0 && !rhsDim) {
+    resultDim = 0;
+  } else if (rhsDim == 1 && !lhsDim) {
+    resultDim = 1;
+  } else {
+    return false;
+  }
+  if (initDim != resultDim) {
+    if (initDim || !isLocallyCreatable(init)) return false;
+    OpBuilder builder(matmulOp);
+    auto localType = getLocalType(init.getType().cast<RankedTensorType>(),
+                                  *resultDim, shardCount);
+    initOperand->set(createLocalInit(builder, init, localType));
+  }
+  markSharded(result, *resultDim);
+  return true;
+}
+
+// Elementwise ops with all split operands split along the same loop produce
+// results split along it. Replicated inputs may only broadcast along that loop
+// as participants don't hold the slices of them they would need.
+bool Partitioner::partitionElementwise(linalg::GenericOp genericOp) {
+  if (!genericOp.hasTensorSemantics() || genericOp.hasIndexSemantics() ||
+      genericOp.getNumParallelLoops() != genericOp.getNumLoops()) {
+    return false;
+  }
+  if (!llvm::all_of(genericOp.getIndexingMapsArray(), [](AffineMap map) {
+        return map.isProjectedPermutation();
+      })) {
+    return false;
+  }
+
+  std::optional<unsigned> splitLoop;
+  for (OpOperand &operand : genericOp->getOpOperands()) {
+    std::optional<int64_t> dim = getShardDim(operand.get());
+    if (!dim) continue;
+    unsigned loop =
+        genericOp.getMatchingIndexingMap(&operand).getDimPosition(*dim);
+    if (splitLoop && *splitLoop != loop) return false;
+    splitLoop = loop;
+  }
+  if (!splitLoop) return false;
+
+  for (OpOperand *operand : genericOp.getDpsInputOperands()) {
+    if (getShardDim(operand->get())) continue;
+    AffineMap map = genericOp.getMatchingIndexingMap(operand);
+    if (getResultPosition(map, *splitLoop)) return false;
+  }
+  SmallVector<int64_t> resultDims;
+  for (OpOperand *operand : genericOp.getDpsInitOperands()) {
+    AffineMap map = genericOp.getMatchingIndexingMap(operand);
+    std::optional<int64_t> resultDim = getResultPosition(map, *splitLoop);
+    if (!resultDim) return false;
+    std::optional<int64_t> initDim = getShardDim(operand->get());
+    if (initDim ? initDim != resultDim
+                : !isLocallyCreatable(operand->get())) {
+      return false;
+    }
+    resultDims.push_back(*resultDim);
+  }
+
+  OpBuilder builder(genericOp);
+  for (OpOperand *operand : genericOp.getDpsInitOperands()) {
+    if (getShardDim(operand->get())) continue;
+    int64_t resultDim = resultDims[operand->getOperandNumber() -
+                                   genericOp.getNumDpsInputs()];
+    auto localType =
+        getLocalType(operand->get().getType().cast<RankedTensorType>(),
+                     resultDim, shardCount);
+    operand->set(createLocalInit(builder, operand->get(), localType));
+  }
+  for (OpResult result : genericOp->getResults()) {
+    markSharded(result, resultDims[result.getResultNumber()]);
+  }
+  return true;
+}
+
+// Replaces all uses of sharded values in |op| with the reassembled values.
+void Partitioner::gatherOperands(Operation *op) {
+  op->walk([&](Operation *nestedOp) {
+    for (OpOperand &operand : nestedOp->getOpOperands()) {
+      if (shardedValues.count(operand.get())) {
+        operand.set(gather(operand.get()));
+      }
+    }
+  });
+}
+
+// Reassembles the sharded |value| on all participants. The all-gather
+// concatenates the shards along the outermost dimension so shards split along
+// another dimension are transposed into place afterwards.
+Value Partitioner::gather(Value value) {
+  auto it = gatheredValues.find(value);
+  if (it != gatheredValues.end()) return it->second;
+  LLVM_DEBUG(llvm::dbgs() << "gathering " << value << "\n");
+
+  ShardedValue sharded = shardedValues.lookup(value);
+  auto localType = value.getType().cast<RankedTensorType>();
+  Type elementType = localType.getElementType();
+  int64_t rank = localType.getRank();
+  OpBuilder builder(value.getContext());
+  builder.setInsertionPointAfterValue(value);
+  Location loc = value.getLoc();
+
+  SmallVector<int64_t> gatheredShape(localType.getShape());
+  gatheredShape[0] *= shardCount;
+  Value result = builder.create<CollectiveAllGatherOp>(
+      loc, RankedTensorType::get(gatheredShape, elementType), value);
+
+  if (sharded.dim != 0) {
+    // [n * d0, d1, ...] -> [n, d0, d1, ...]
+    SmallVector<int64_t> expandedShape = {shardCount};
+    llvm::append_range(expandedShape, localType.getShape());
+    SmallVector<ReassociationIndices> expandReassociation = {{0, 1}};
+    for (int64_t i = 2; i <= rank; ++i) expandReassociation.push_back({i});
+    result = builder.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get(expandedShape, elementType), result,
+        expandReassociation);
+
+    // [n, d0, d1, ...] -> [d0, ..., n, dk, ...] with k the split dimension.
+    SmallVector<int64_t> transposedShape(localType.getShape());
+    transposedShape.insert(transposedShape.begin() + sharded.dim, shardCount);
+    SmallVector<AffineExpr> inputExprs = {
+        builder.getAffineDimExpr(sharded.dim)};
+    for (int64_t i = 0; i <= rank; ++i) {
+      if (i != sharded.dim) inputExprs.push_back(builder.getAffineDimExpr(i));
+    }
+    SmallVector<AffineMap> indexingMaps = {
+        AffineMap::get(rank + 1, 0, inputExprs, builder.getContext()),
+        builder.getMultiDimIdentityMap(rank + 1)};
+    Value emptyTensor =
+        builder.create<tensor::EmptyOp>(loc, transposedShape, elementType);
+    auto transposeOp = builder.create<linalg::GenericOp>(
+        loc, emptyTensor.getType(), result, emptyTensor, indexingMaps,
+        SmallVector<utils::IteratorType>(rank + 1,
+                                         utils::IteratorType::parallel),
+        [](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+          nestedBuilder.create<linalg::YieldOp>(nestedLoc, args[0]);
+        });
+
+    // [d0, ..., n, dk, ...] -> [d0, ..., n * dk, ...]
+    SmallVector<ReassociationIndices> collapseReassociation;
+    for (int64_t i = 0; i < rank; ++i) {
+      if (i < sharded.dim) {
+        collapseReassociation.push_back({i});
+      } else if (i == sharded.dim) {
+        collapseReassociation.push_back({i, i + 1});
+      } else {
+        collapseReassociation.push_back({i + 1});
+      }
+    }
+    result = builder.create<tensor::CollapseShapeOp>(
+        loc, sharded.globalType, transposeOp.getResult(0),
+        collapseReassociation);
+  }
+
+  gatheredValues[value] = result;
+  return result;
+}
+
+class ShardTensorsPass : public ShardTensorsBase<ShardTensorsPass> {
+ public:
+  ShardTensorsPass() = default;
+  ShardTensorsPass(int64_t shardCount) { this->shardCount = shardCount; }
+  ShardTensorsPass(const ShardTensorsPass &pass)
+      : ShardTensorsPass(pass.shardCount) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::Flow::FlowDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    if (shardCount <= 1) return;
+    ModuleOp moduleOp = getOperation();
+    for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
+      if (funcOp.isExternal()) continue;
+      bool hasShardedArgs =
+          llvm::any_of(funcOp.getArguments(), [&](BlockArgument arg) {
+            return funcOp.getArgAttr(arg.getArgNumber(), kShardingDimAttr);
+          });
+      if (!hasShardedArgs) continue;
+      // Callers would have to be partitioned as well.
+      if (!SymbolTable::symbolKnownUseEmpty(funcOp, moduleOp)) {
+        funcOp.emitError()
+            << "sharded arguments are only supported on entry points";
+        return signalPassFailure();
+      }
+      Partitioner partitioner(shardCount);
+      if (failed(partitioner.partition(funcOp))) return signalPassFailure();
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createShardTensorsPass(
+    int64_t shardCount) {
+  return std::make_unique<ShardTensorsPass>(shardCount);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,167 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-specialize-dispatch-shapes"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// Returns the dynamic dimension shared by all dynamically shaped operands and
+// results of |dispatchOp| or nullptr if there are none or more than one.
+// Specializing on a single dimension (such as a sequence length) keeps the
+// number of variants produced linear in the number of buckets.
+static Value getSharedDynamicDim(IREE::Flow::DispatchWorkgroupsOp dispatchOp) {
+  Value sharedDim;
+  auto updateSharedDim = [&](ValueRange dims) {
+    for (Value dim : dims) {
+      if (matchPattern(dim, m_Constant())) continue;
+      if (sharedDim && sharedDim != dim) return false;
+      sharedDim = dim;
+    }
+    return true;
+  };
+  if (!updateSharedDim(dispatchOp.getArgumentDims()) ||
+      !updateSharedDim(dispatchOp.getResultDims())) {
+    return nullptr;
+  }
+  return sharedDim;
+}
+
+// Clones |dispatchOp| with |dim| replaced by the constant |dimValue| both on
+// the outside and on the inside of the dispatch so that its body can be
+// compiled for static shapes.
+static IREE::Flow::DispatchWorkgroupsOp cloneWithStaticDim(
+    OpBuilder &builder, IREE::Flow::DispatchWorkgroupsOp dispatchOp, Value dim,
+    Value dimValue) {
+  IRMapping mapping;
+  mapping.map(dim, dimValue);
+  auto clonedOp = cast<IREE::Flow::DispatchWorkgroupsOp>(
+      builder.clone(*dispatchOp.getOperation(), mapping));
+
+  // Captured dims are passed as index arguments; use the constant instead.
+  auto innerBuilder = OpBuilder::atBlockBegin(clonedOp.getBody());
+  Value innerValue;
+  for (auto [operand, arg] : llvm::zip(clonedOp.getArguments(),
+                                       clonedOp.getInputBlockArguments())) {
+    if (operand != dimValue) continue;
+    if (!innerValue) {
+      innerValue = innerBuilder.clone(*dimValue.getDefiningOp())->getResult(0);
+    }
+    arg.replaceAllUsesWith(innerValue);
+  }
+  return clonedOp;
+}
+
+// Builds a chain of scf.if ops selecting the variant of |dispatchOp|
+// specialized for the first bucket matching |dim| or the dynamic fallback.
+static SmallVector<Value> buildBucketSelection(
+    OpBuilder &builder, IREE::Flow::DispatchWorkgroupsOp dispatchOp, Value dim,
+    ArrayRef<int64_t> buckets) {
+  Location loc = dispatchOp.getLoc();
+  if (buckets.empty()) {
+    return llvm::to_vector(
+        builder.clone(*dispatchOp.getOperation())->getResults());
+  }
+  Value bucketValue =
+      builder.create<arith::ConstantIndexOp>(loc, buckets.front());
+  Value isBucket = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, dim, bucketValue);
+  auto ifOp = builder.create<scf::IfOp>(loc, dispatchOp->getResultTypes(),
+                                        isBucket, /*withElseRegion=*/true);
+  auto thenBuilder = ifOp.getThenBodyBuilder();
+  auto specializedOp =
+      cloneWithStaticDim(thenBuilder, dispatchOp, dim, bucketValue);
+  thenBuilder.create<scf::YieldOp>(loc, specializedOp->getResults());
+  auto elseBuilder = ifOp.getElseBodyBuilder();
+  elseBuilder.create<scf::YieldOp>(
+      loc, buildBucketSelection(elseBuilder, dispatchOp, dim,
+                                buckets.drop_front()));
+  return llvm::to_vector(ifOp.getResults());
+}
+
+// Replaces |dispatchOp| with variants specialized for each of |buckets| and
+// selected at runtime based on its dynamic dimension.
+static void specializeDispatch(IREE::Flow::DispatchWorkgroupsOp dispatchOp,
+                               ArrayRef<int64_t> buckets) {
+  Value dim = getSharedDynamicDim(dispatchOp);
+  if (!dim) return;
+  LLVM_DEBUG({
+    llvm::dbgs() << "specializing " << dispatchOp.getLoc() << " for "
+                 << buckets.size() << " buckets\n";
+  });
+
+  OpBuilder builder(dispatchOp);
+  SmallVector<Value> results =
+      buildBucketSelection(builder, dispatchOp, dim, buckets);
+
+  // Results of the selection are tied to the dims of the original results as
+  // shape queries cannot see through the scf.if.
+  for (unsigned i = 0; i < results.size(); ++i) {
+    auto resultType = results[i].getType().dyn_cast<RankedTensorType>();
+    if (!resultType || resultType.hasStaticShape()) continue;
+    results[i] = builder.create<IREE::Flow::TensorTieShapeOp>(
+        dispatchOp.getLoc(), resultType, results[i],
+        dispatchOp.getResultDynamicDims(i));
+  }
+  dispatchOp->replaceAllUsesWith(results);
+  dispatchOp.erase();
+}
+
+// Specializes dispatches with a dynamic dimension for a set of expected sizes.
+// Each dispatch is replaced by one variant per bucket with the dimension
+// made static and the original fully dynamic dispatch as a fallback; the host
+// selects the variant to run based on the runtime value of the dimension.
+class SpecializeDispatchShapesPass
+    : public SpecializeDispatchShapesBase<SpecializeDispatchShapesPass> {
+ public:
+  SpecializeDispatchShapesPass() = default;
+  SpecializeDispatchShapesPass(ArrayRef<int64_t> buckets) {
+    this->buckets = buckets;
+  }
+  SpecializeDispatchShapesPass(const SpecializeDispatchShapesPass &pass)
+      : SpecializeDispatchShapesPass(*pass.buckets) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, scf::SCFDialect>();
+  }
+
+  void runOnOperation() override {
+    if (buckets.empty()) return;
+    SmallVector<IREE::Flow::DispatchWorkgroupsOp> dispatchOps;
+    getOperation()->walk([&](IREE::Flow::DispatchWorkgroupsOp dispatchOp) {
+      dispatchOps.push_back(dispatchOp);
+    });
+    for (auto dispatchOp : dispatchOps) {
+      specializeDispatch(dispatchOp, *buckets);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createSpecializeDispatchShapesPass(
+    ArrayRef<int64_t> buckets) {
+  return std::make_unique<SpecializeDispatchShapesPass>(buckets);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -34,6 +34,30 @@ static llvm::cl::list<int64_t> topkSplitReductionRatio(
     llvm::cl::desc("comma separated list of split ratios"),
     llvm::cl::CommaSeparated);
 
+/// Minimum size of the reduction dimension left in each split of an
+/// automatically split matmul so that the partial results written out and
+/// reduced again stay small relative to the work of each split.
+static constexpr int64_t kMinSplitKReductionSize = 256;
+
+/// Returns the ratio to split the reduction dimension of |matmulOp| by so that
+/// its M * N output elements multiplied by the ratio reach |minParallelism|, or
+/// 0 if the matmul has enough parallelism or dynamic shapes. The ratio is a
+/// power of two dividing K.
+static int64_t getSplitKRatio(linalg::MatmulOp matmulOp,
+                              int64_t minParallelism) {
+  SmallVector<int64_t> loopRanges = matmulOp.getStaticLoopRanges();
+  if (llvm::any_of(loopRanges, ShapedType::isDynamic)) return 0;
+  int64_t parallelSize = loopRanges[0] * loopRanges[1];
+  int64_t reductionSize = loopRanges[2];
+  int64_t ratio = 1;
+  while (parallelSize * ratio < minParallelism &&
+         reductionSize % (ratio * 2) == 0 &&
+         reductionSize / (ratio * 2) >= kMinSplitKReductionSize) {
+    ratio *= 2;
+  }
+  return ratio > 1 ? ratio : 0;
+}
+
 namespace {
 /// Pattern to wrap splitReduction transformation. This also propagates
 /// attributes to allow compilation info attribute to not be lost.
@@ -77,12 +101,18 @@ struct LinalgSplitReduction
 };
 
 struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
+  SplitReductionPass(int64_t minParallelism) {
+    this->minParallelism = minParallelism;
+  }
+  SplitReductionPass(const SplitReductionPass &pass)
+      : SplitReductionPass(pass.minParallelism) {}
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<linalg::LinalgDialect>();
   }
 
   void runOnOperation() override {
-    if (splitReductionRatio.getValue() <= 1 &&
+    if (splitReductionRatio.getValue() <= 1 && minParallelism <= 0 &&
         topkSplitReductionRatio.empty()) {
       return;
     }
@@ -92,9 +122,14 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
         &getContext(),
         [&](linalg::LinalgOp op) -> linalg::SplitReductionOptions {
           // For matmul make the new parallel dimension first so that it looks
-          // like a batch_matmul and can follow the same codegen.
-          if (isa<linalg::MatmulOp>(op))
-            return {int64_t(splitReductionRatio), 0, /*innerParallel=*/false};
+          // like a batch_matmul and can follow the same codegen. An explicit
+          // ratio takes precedence over the automatic split-K.
+          if (auto matmulOp = dyn_cast<linalg::MatmulOp>(op.getOperation())) {
+            int64_t ratio = splitReductionRatio > 1
+                                ? int64_t(splitReductionRatio)
+                                : getSplitKRatio(matmulOp, minParallelism);
+            return {ratio, 0, /*innerParallel=*/false};
+          }
           // Currently disable spliting reduction for non-matmul op. This will
           // get enabled after once tests are ready.
           return {int64_t(0), 0, /*innerParallel=*/false};
@@ -138,8 +173,8 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
 
 }  // namespace
 
-std::unique_ptr<Pass> createSplitReductionPass() {
-  return std::make_unique<SplitReductionPass>();
+std::unique_ptr<Pass> createSplitReductionPass(int64_t minParallelism) {
+  return std::make_unique<SplitReductionPass>(minParallelism);
 }
 
 }  // namespace Flow
@@ -0,0 +1,92 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-flow-auto-mixed-precision)" %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-flow-auto-mixed-precision{use-bf16=true})" %s | FileCheck %s --check-prefix=BF16
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @matmul_clamped_lhs(%arg0: tensor<4x3xf32>) -> tensor<4x2xf32> {
+  %lo = arith.constant -6.000000e+00 : f32
+  %hi = arith.constant 6.000000e+00 : f32
+  %zero = arith.constant 0.000000e+00 : f32
+  %rhs = arith.constant dense<[[1.0, -2.0], [3.5, 0.25], [-8.0, 100.0]]> : tensor<3x2xf32>
+  %0 = tensor.empty() : tensor<4x3xf32>
+  %clamped = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%arg0 : tensor<4x3xf32>) outs(%0 : tensor<4x3xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %1 = arith.maxf %in, %lo : f32
+    %2 = arith.minf %1, %hi : f32
+    linalg.yield %2 : f32
+  } -> tensor<4x3xf32>
+  %3 = tensor.empty() : tensor<4x2xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%3 : tensor<4x2xf32>) -> tensor<4x2xf32>
+  %4 = linalg.matmul ins(%clamped, %rhs : tensor<4x3xf32>, tensor<3x2xf32>) outs(%fill : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %4 : tensor<4x2xf32>
+}
+// CHECK-LABEL: func.func @matmul_clamped_lhs
+//       CHECK:   %[[CLAMPED:.+]] = linalg.generic
+//       CHECK:   %[[FILL:.+]] = linalg.fill
+//       CHECK:   %[[LHS:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[CLAMPED]] : tensor<4x3xf32>) outs(%{{.+}} : tensor<4x3xf16>)
+//       CHECK:     arith.truncf %{{.+}} : f32 to f16
+//       CHECK:   %[[RHS:.+]] = linalg.generic
+//  CHECK-SAME:       outs(%{{.+}} : tensor<3x2xf16>)
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:       ins(%[[LHS]], %[[RHS]] : tensor<4x3xf16>, tensor<3x2xf16>)
+//  CHECK-SAME:       outs(%[[FILL]] : tensor<4x2xf32>)
+
+// BF16-LABEL: func.func @matmul_clamped_lhs
+//       BF16:   arith.truncf %{{.+}} : f32 to bf16
+//       BF16:   linalg.matmul
+//  BF16-SAME:       ins(%{{.+}}, %{{.+}} : tensor<4x3xbf16>, tensor<3x2xbf16>)
+//  BF16-SAME:       outs(%{{.+}} : tensor<4x2xf32>)
+
+// -----
+
+func.func @matmul_unknown_range(%arg0: tensor<4x3xf32>, %arg1: tensor<3x2xf32>) -> tensor<4x2xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<4x2xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%0 : tensor<4x2xf32>) -> tensor<4x2xf32>
+  %1 = linalg.matmul ins(%arg0, %arg1 : tensor<4x3xf32>, tensor<3x2xf32>) outs(%fill : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %1 : tensor<4x2xf32>
+}
+// CHECK-LABEL: func.func @matmul_unknown_range
+//   CHECK-NOT:   arith.truncf
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:       ins(%{{.+}}, %{{.+}} : tensor<4x3xf32>, tensor<3x2xf32>)
+
+// BF16-LABEL: func.func @matmul_unknown_range
+//       BF16:   linalg.matmul
+//  BF16-SAME:       ins(%{{.+}}, %{{.+}} : tensor<4x3xbf16>, tensor<3x2xbf16>)
+
+// -----
+
+func.func @matmul_out_of_f16_range(%arg0: tensor<4x3xf32>) -> tensor<4x2xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %lhs = arith.constant dense<1.000000e+05> : tensor<4x3xf32>
+  %rhs = arith.constant dense<1.000000e+00> : tensor<3x2xf32>
+  %0 = tensor.empty() : tensor<4x2xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%0 : tensor<4x2xf32>) -> tensor<4x2xf32>
+  %1 = linalg.matmul ins(%lhs, %rhs : tensor<4x3xf32>, tensor<3x2xf32>) outs(%fill : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %1 : tensor<4x2xf32>
+}
+// CHECK-LABEL: func.func @matmul_out_of_f16_range
+//   CHECK-NOT:   arith.truncf
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:       ins(%{{.+}}, %{{.+}} : tensor<4x3xf32>, tensor<3x2xf32>)
+
+// -----
+
+func.func @softmax_like_reduction_untouched(%arg0: tensor<4x3xf32>) -> tensor<4xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<4xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%0 : tensor<4xf32>) -> tensor<4xf32>
+  %1 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]}
+      ins(%arg0 : tensor<4x3xf32>) outs(%fill : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %2 = math.exp %in : f32
+    %3 = arith.addf %2, %out : f32
+    linalg.yield %3 : f32
+  } -> tensor<4xf32>
+  return %1 : tensor<4xf32>
+}
+// BF16-LABEL: func.func @softmax_like_reduction_untouched
+//   BF16-NOT:   arith.truncf
+//       BF16:   return
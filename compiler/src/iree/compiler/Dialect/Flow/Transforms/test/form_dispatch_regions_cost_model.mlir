@@ -0,0 +1,41 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions{aggressive-fusion=true fusion-ops-per-byte=4.0}, iree-flow-form-dispatch-workgroups), cse, canonicalize, cse)" %s | FileCheck %s --check-prefix=LOW
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions{aggressive-fusion=true fusion-ops-per-byte=1024.0}, iree-flow-form-dispatch-workgroups), cse, canonicalize, cse)" %s | FileCheck %s --check-prefix=HIGH
+
+// The elementwise producer is read 4096 times per element by the reduction.
+// Fusing it saves 1 KiB of memory traffic but recomputes ~512K operations:
+// only targets executing more than ~512 operations per byte moved fuse it.
+
+#map0 = affine_map<(d0) -> (d0)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+#map2 = affine_map<(d0, d1) -> (d0)>
+func.func @broadcast_producer_into_reduction(%a: tensor<128x4096xf32>, %b: tensor<128xf32>) -> tensor<128xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<128xf32>
+  %1 = linalg.generic {indexing_maps = [#map0, #map0], iterator_types = ["parallel"]} ins(%b : tensor<128xf32>) outs(%0 : tensor<128xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %4 = math.exp %arg0 : f32
+    linalg.yield %4 : f32
+  } -> tensor<128xf32>
+  %2 = linalg.fill ins(%cst : f32) outs(%0 : tensor<128xf32>) -> tensor<128xf32>
+  %3 = linalg.generic {indexing_maps = [#map1, #map2, #map2], iterator_types = ["parallel", "reduction"]} ins(%a, %1 : tensor<128x4096xf32>, tensor<128xf32>) outs(%2 : tensor<128xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32, %arg2: f32):
+    %4 = arith.mulf %arg0, %arg1 : f32
+    %5 = arith.addf %4, %arg2 : f32
+    linalg.yield %5 : f32
+  } -> tensor<128xf32>
+  return %3 : tensor<128xf32>
+}
+
+// LOW-LABEL: func.func @broadcast_producer_into_reduction
+//       LOW:   %[[EXP:.+]] = flow.dispatch.workgroups
+//       LOW:     math.exp
+//       LOW:   flow.dispatch.workgroups
+//  LOW-SAME:     %[[EXP]]
+//   LOW-NOT:     math.exp
+//       LOW:     arith.mulf
+
+// HIGH-LABEL: func.func @broadcast_producer_into_reduction
+//       HIGH:   flow.dispatch.workgroups
+//       HIGH:     math.exp
+//       HIGH:     arith.mulf
+//   HIGH-NOT:   flow.dispatch.workgroups
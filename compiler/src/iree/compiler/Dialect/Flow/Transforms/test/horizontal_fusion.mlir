@@ -0,0 +1,77 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-horizontal-fusion))" %s | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @fuse_independent_elementwise(%arg0: tensor<4x16xf32>, %arg1: tensor<4x16xf32>) -> (tensor<4x16xf32>, tensor<4x16xf32>) {
+  %0 = tensor.empty() : tensor<4x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<4x16xf32>) outs(%0 : tensor<4x16xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %3 = math.exp %b0 : f32
+    linalg.yield %3 : f32
+  } -> tensor<4x16xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg1 : tensor<4x16xf32>) outs(%0 : tensor<4x16xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %3 = math.tanh %b0 : f32
+    linalg.yield %3 : f32
+  } -> tensor<4x16xf32>
+  return %1, %2 : tensor<4x16xf32>, tensor<4x16xf32>
+}
+// CHECK-LABEL: func.func @fuse_independent_elementwise
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9]+]]: tensor<4x16xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9]+]]: tensor<4x16xf32>
+//   CHECK-DAG:   %[[EMPTY0:.+]] = tensor.empty()
+//   CHECK-DAG:   %[[EMPTY1:.+]] = tensor.empty()
+//       CHECK:   %[[FUSED:.+]]:2 = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]] :
+//  CHECK-SAME:       outs(%{{.+}}, %{{.+}} :
+//  CHECK-NEXT:   ^bb0(%[[B0:[a-zA-Z0-9_]+]]: f32, %[[B1:[a-zA-Z0-9_]+]]: f32,
+//   CHECK-DAG:     %[[EXP:.+]] = math.exp %[[B0]]
+//   CHECK-DAG:     %[[TANH:.+]] = math.tanh %[[B1]]
+//       CHECK:     linalg.yield %[[EXP]], %[[TANH]]
+//   CHECK-NOT:   linalg.generic
+//       CHECK:   return %[[FUSED]]#0, %[[FUSED]]#1
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @dont_fuse_dependent(%arg0: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %0 = tensor.empty() : tensor<4x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<4x16xf32>) outs(%0 : tensor<4x16xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %3 = math.exp %b0 : f32
+    linalg.yield %3 : f32
+  } -> tensor<4x16xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%1 : tensor<4x16xf32>) outs(%0 : tensor<4x16xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %3 = math.tanh %b0 : f32
+    linalg.yield %3 : f32
+  } -> tensor<4x16xf32>
+  return %2 : tensor<4x16xf32>
+}
+// CHECK-LABEL: func.func @dont_fuse_dependent
+//       CHECK:   %[[EXP:.+]] = linalg.generic
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%[[EXP]] :
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @dont_fuse_different_iteration_spaces(%arg0: tensor<4x16xf32>, %arg1: tensor<16x4xf32>) -> (tensor<4x16xf32>, tensor<16x4xf32>) {
+  %0 = tensor.empty() : tensor<4x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<4x16xf32>) outs(%0 : tensor<4x16xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %4 = math.exp %b0 : f32
+    linalg.yield %4 : f32
+  } -> tensor<4x16xf32>
+  %2 = tensor.empty() : tensor<16x4xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg1 : tensor<16x4xf32>) outs(%2 : tensor<16x4xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %4 = math.tanh %b0 : f32
+    linalg.yield %4 : f32
+  } -> tensor<16x4xf32>
+  return %1, %3 : tensor<4x16xf32>, tensor<16x4xf32>
+}
+// CHECK-LABEL: func.func @dont_fuse_different_iteration_spaces
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<4x16xf32>)
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<16x4xf32>)
@@ -0,0 +1,77 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-rematerialize-for-memory{memory-budget=2621440}))" %s | FileCheck %s
+
+// The 1MiB broadcast is kept alive across the matmul for its second use; with
+// a 2.5MiB budget it is recomputed from the small bias instead.
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+func.func @recompute_broadcast(%arg0: tensor<256x1024xf32>, %bias: tensor<1024xf32>, %w: tensor<1024x1024xf32>) -> tensor<256x1024xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty = tensor.empty() : tensor<256x1024xf32>
+  %bcast = linalg.generic {indexing_maps = [#map1, #map], iterator_types = ["parallel", "parallel"]} ins(%bias : tensor<1024xf32>) outs(%empty : tensor<256x1024xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    linalg.yield %b0 : f32
+  } -> tensor<256x1024xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %add = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0, %bcast : tensor<256x1024xf32>, tensor<256x1024xf32>) outs(%empty : tensor<256x1024xf32>) {
+  ^bb0(%b0: f32, %b1: f32, %b2: f32):
+    %0 = arith.addf %b0, %b1 : f32
+    linalg.yield %0 : f32
+  } -> tensor<256x1024xf32>
+  %mm = linalg.matmul ins(%add, %w : tensor<256x1024xf32>, tensor<1024x1024xf32>) outs(%fill : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %out = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%mm, %bcast : tensor<256x1024xf32>, tensor<256x1024xf32>) outs(%empty : tensor<256x1024xf32>) {
+  ^bb0(%b0: f32, %b1: f32, %b2: f32):
+    %0 = arith.mulf %b0, %b1 : f32
+    linalg.yield %0 : f32
+  } -> tensor<256x1024xf32>
+  return %out : tensor<256x1024xf32>
+}
+// CHECK-LABEL: func.func @recompute_broadcast
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9]+]]: tensor<256x1024xf32>
+//  CHECK-SAME:   %[[BIAS:[a-zA-Z0-9]+]]: tensor<1024xf32>
+//       CHECK:   %[[BCAST:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[BIAS]] : tensor<1024xf32>)
+//       CHECK:   %[[ADD:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG0]], %[[BCAST]] :
+//       CHECK:   %[[MM:.+]] = linalg.matmul
+//  CHECK-SAME:       ins(%[[ADD]],
+//       CHECK:   %[[RECOMPUTED:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[BIAS]] : tensor<1024xf32>)
+//       CHECK:   %[[OUT:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[MM]], %[[RECOMPUTED]] :
+//       CHECK:   return %[[OUT]]
+
+// -----
+
+// Nothing is recomputed when the tensors kept alive fit in the budget: the
+// elementwise chain fuses and only the matmul result is held.
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @within_budget(%arg0: tensor<256x1024xf32>, %w: tensor<1024x1024xf32>) -> tensor<256x1024xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty = tensor.empty() : tensor<256x1024xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %mm = linalg.matmul ins(%arg0, %w : tensor<256x1024xf32>, tensor<1024x1024xf32>) outs(%fill : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %exp = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%mm : tensor<256x1024xf32>) outs(%empty : tensor<256x1024xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %0 = math.exp %b0 : f32
+    linalg.yield %0 : f32
+  } -> tensor<256x1024xf32>
+  %neg = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%exp : tensor<256x1024xf32>) outs(%empty : tensor<256x1024xf32>) {
+  ^bb0(%b0: f32, %b1: f32):
+    %0 = arith.negf %b0 : f32
+    linalg.yield %0 : f32
+  } -> tensor<256x1024xf32>
+  %out = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%mm, %neg : tensor<256x1024xf32>, tensor<256x1024xf32>) outs(%empty : tensor<256x1024xf32>) {
+  ^bb0(%b0: f32, %b1: f32, %b2: f32):
+    %0 = arith.addf %b0, %b1 : f32
+    linalg.yield %0 : f32
+  } -> tensor<256x1024xf32>
+  return %out : tensor<256x1024xf32>
+}
+// CHECK-LABEL: func.func @within_budget
+//       CHECK:   linalg.matmul
+//       CHECK:   math.exp
+//       CHECK:   arith.negf
+//       CHECK:   arith.addf
+//   CHECK-NOT:   linalg.generic
@@ -156,3 +156,67 @@ func.func @fold_fill_with_tensor_pad(%arg0 : index, %arg1 : index, %arg2 : index
 //      CHECK:   %[[FILL:.+]] = linalg.fill
 // CHECK-SAME:       outs(%[[EMPTY]] :
 //      CHECK:   return %[[FILL]]
+
+// -----
+
+func.func @batch_matmul(%arg0 : tensor<8x100x250xf32>, %arg1 : tensor<8x250x500xf32>,
+    %arg2 : tensor<8x100x500xf32>) -> tensor<8x100x500xf32> {
+  %0 = linalg.batch_matmul ins(%arg0, %arg1 : tensor<8x100x250xf32>, tensor<8x250x500xf32>)
+      outs(%arg2 : tensor<8x100x500xf32>) -> tensor<8x100x500xf32>
+  return %0 : tensor<8x100x500xf32>
+}
+//      CHECK: func @batch_matmul(
+// CHECK-SAME:     %[[ARG0:.+]]: tensor<8x100x250xf32>
+// CHECK-SAME:     %[[ARG1:.+]]: tensor<8x250x500xf32>
+// CHECK-SAME:     %[[ARG2:.+]]: tensor<8x100x500xf32>
+//      CHECK:   %[[LHS_PAD:.+]] = tensor.pad %[[ARG0]] low[0, 0, 0] high[0, 12, 6]
+//      CHECK:       tensor<8x100x250xf32> to tensor<8x112x256xf32>
+//      CHECK:   %[[RHS_PAD:.+]] = tensor.pad %[[ARG1]] low[0, 0, 0] high[0, 6, 12]
+//      CHECK:       tensor<8x250x500xf32> to tensor<8x256x512xf32>
+//      CHECK:   %[[OUTS_PAD:.+]] = tensor.pad %[[ARG2]] low[0, 0, 0] high[0, 12, 12]
+//      CHECK:       tensor<8x100x500xf32> to tensor<8x112x512xf32>
+//      CHECK:   %[[LHS:.+]] = iree_linalg_ext.set_encoding %[[LHS_PAD]]
+// CHECK-SAME:       tensor<8x112x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>
+//      CHECK:   %[[RHS:.+]] = iree_linalg_ext.set_encoding %[[RHS_PAD]]
+// CHECK-SAME:       tensor<8x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>
+//      CHECK:   %[[OUTS:.+]] = iree_linalg_ext.set_encoding %[[OUTS_PAD]]
+// CHECK-SAME:       tensor<8x112x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[BATCH_MATMUL:.+]] = linalg.batch_matmul
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   %[[RESULT_PADDED:.+]] = iree_linalg_ext.unset_encoding %[[BATCH_MATMUL]]
+//      CHECK:   %[[RESULT:.+]] = tensor.extract_slice %[[RESULT_PADDED]][0, 0, 0] [8, 100, 500] [1, 1, 1]
+//      CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @hoist_set_encoding_above_elementwise(%arg0 : tensor<128x256xf32>,
+    %arg1 : tensor<256x512xf32>, %arg2 : tensor<128x512xf32>,
+    %arg3 : tensor<128x64xf32>, %arg4 : tensor<64x512xf32>) -> tensor<128x512xf32> {
+  %cst = arith.constant 0.0 : f32
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<128x256xf32>, tensor<256x512xf32>)
+      outs(%arg2 : tensor<128x512xf32>) -> tensor<128x512xf32>
+  %1 = tensor.empty() : tensor<128x512xf32>
+  %2 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%0 : tensor<128x512xf32>) outs(%1 : tensor<128x512xf32>) {
+  ^bb0(%b0 : f32, %b1 : f32):
+    %3 = arith.maxf %b0, %cst : f32
+    linalg.yield %3 : f32
+  } -> tensor<128x512xf32>
+  %4 = linalg.matmul ins(%arg3, %arg4 : tensor<128x64xf32>, tensor<64x512xf32>)
+      outs(%2 : tensor<128x512xf32>) -> tensor<128x512xf32>
+  return %4 : tensor<128x512xf32>
+}
+//      CHECK: func @hoist_set_encoding_above_elementwise(
+//      CHECK:   %[[MATMUL0:.+]] = linalg.matmul
+//  CHECK-NOT:   iree_linalg_ext.unset_encoding
+//      CHECK:   %[[EMPTY:.+]] = tensor.empty() : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[RELU:.+]] = linalg.generic
+// CHECK-SAME:       ins(%[[MATMUL0]] : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+// CHECK-SAME:       outs(%[[EMPTY]] : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+//      CHECK:   %[[MATMUL1:.+]] = linalg.matmul
+// CHECK-SAME:       outs(%[[RELU]] :
+//      CHECK:   %[[RESULT:.+]] = iree_linalg_ext.unset_encoding %[[MATMUL1]]
+//      CHECK:   return %[[RESULT]]
@@ -0,0 +1,75 @@
+// RUN: iree-opt --split-input-file --verify-diagnostics --iree-flow-shard-tensors=shard-count=4 %s | FileCheck %s
+
+// Column-parallel matmul: the result stays split along N and is gathered
+// before being returned.
+
+// CHECK-LABEL: @column_parallel_matmul
+// CHECK-SAME: (%[[LHS:.+]]: tensor<16x32xf32>, %[[RHS:.+]]: tensor<32x16xf32> {iree.sharding.dim = 1 : index}) -> tensor<16x64xf32>
+func.func @column_parallel_matmul(%lhs: tensor<16x32xf32>, %rhs: tensor<32x64xf32> {iree.sharding.dim = 1 : index}) -> tensor<16x64xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty = tensor.empty() : tensor<16x64xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<16x64xf32>) -> tensor<16x64xf32>
+  //      CHECK: %[[LOCAL_EMPTY:.+]] = tensor.empty() : tensor<16x16xf32>
+  //      CHECK: %[[LOCAL_FILL:.+]] = linalg.fill ins(%{{.+}} : f32) outs(%[[LOCAL_EMPTY]] : tensor<16x16xf32>)
+  //      CHECK: %[[MATMUL:.+]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<16x32xf32>, tensor<32x16xf32>) outs(%[[LOCAL_FILL]] : tensor<16x16xf32>)
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<16x32xf32>, tensor<32x64xf32>) outs(%fill : tensor<16x64xf32>) -> tensor<16x64xf32>
+  //      CHECK: %[[GATHER:.+]] = flow.collective.all_gather %[[MATMUL]] : tensor<16x16xf32> -> tensor<64x16xf32>
+  //      CHECK: %[[EXPAND:.+]] = tensor.expand_shape %[[GATHER]] {{\[}}[0, 1], [2]] : tensor<64x16xf32> into tensor<4x16x16xf32>
+  //      CHECK: %[[TRANSPOSE:.+]] = linalg.generic
+  // CHECK-SAME:     ins(%[[EXPAND]] : tensor<4x16x16xf32>)
+  // CHECK-SAME:     -> tensor<16x4x16xf32>
+  //      CHECK: %[[COLLAPSE:.+]] = tensor.collapse_shape %[[TRANSPOSE]] {{\[}}[0], [1, 2]] : tensor<16x4x16xf32> into tensor<16x64xf32>
+  //      CHECK: return %[[COLLAPSE]]
+  return %0 : tensor<16x64xf32>
+}
+
+// -----
+
+// Row-parallel matmul: both operands are split along K and the partial sums
+// are all-reduced.
+
+// CHECK-LABEL: @row_parallel_matmul
+// CHECK-SAME: (%[[LHS:.+]]: tensor<16x8xf32> {iree.sharding.dim = 1 : index}, %[[RHS:.+]]: tensor<8x64xf32> {iree.sharding.dim = 0 : index}) -> tensor<16x64xf32>
+func.func @row_parallel_matmul(%lhs: tensor<16x32xf32> {iree.sharding.dim = 1 : index}, %rhs: tensor<32x64xf32> {iree.sharding.dim = 0 : index}) -> tensor<16x64xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty = tensor.empty() : tensor<16x64xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<16x64xf32>) -> tensor<16x64xf32>
+  //      CHECK: %[[MATMUL:.+]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<16x8xf32>, tensor<8x64xf32>) outs(%{{.+}} : tensor<16x64xf32>)
+  //      CHECK: %[[SUM:.+]] = flow.collective.all_reduce sum, %[[MATMUL]] : tensor<16x64xf32>
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<16x32xf32>, tensor<32x64xf32>) outs(%fill : tensor<16x64xf32>) -> tensor<16x64xf32>
+  //      CHECK: return %[[SUM]]
+  return %0 : tensor<16x64xf32>
+}
+
+// -----
+
+// Elementwise ops keep the split of their operands; replicated operands may
+// only broadcast along the split dimension.
+
+// CHECK-LABEL: @elementwise
+// CHECK-SAME: (%[[ARG0:.+]]: tensor<4x64xf32> {iree.sharding.dim = 0 : index}, %[[BIAS:.+]]: tensor<64xf32>) -> tensor<16x64xf32>
+func.func @elementwise(%arg0: tensor<16x64xf32> {iree.sharding.dim = 0 : index}, %bias: tensor<64xf32>) -> tensor<16x64xf32> {
+  %empty = tensor.empty() : tensor<16x64xf32>
+  //      CHECK: %[[LOCAL_EMPTY:.+]] = tensor.empty() : tensor<4x64xf32>
+  //      CHECK: %[[ADD:.+]] = linalg.generic
+  // CHECK-SAME:     ins(%[[ARG0]], %[[BIAS]] : tensor<4x64xf32>, tensor<64xf32>)
+  // CHECK-SAME:     outs(%[[LOCAL_EMPTY]] : tensor<4x64xf32>)
+  %0 = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>],
+    iterator_types = ["parallel", "parallel"]
+  } ins(%arg0, %bias : tensor<16x64xf32>, tensor<64xf32>) outs(%empty : tensor<16x64xf32>) {
+  ^bb0(%in: f32, %b: f32, %out: f32):
+    %1 = arith.addf %in, %b : f32
+    linalg.yield %1 : f32
+  } -> tensor<16x64xf32>
+  //      CHECK: %[[GATHER:.+]] = flow.collective.all_gather %[[ADD]] : tensor<4x64xf32> -> tensor<16x64xf32>
+  //      CHECK: return %[[GATHER]]
+  return %0 : tensor<16x64xf32>
+}
+
+// -----
+
+func.func @indivisible(%arg0: tensor<6x64xf32> {iree.sharding.dim = 0 : index}) -> tensor<6x64xf32> {
+  // expected-error@-1 {{argument 0 can't be split along dimension 0 into 4 equal shards}}
+  return %arg0 : tensor<6x64xf32>
+}
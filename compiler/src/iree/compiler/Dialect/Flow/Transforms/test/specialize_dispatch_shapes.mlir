@@ -0,0 +1,55 @@
+// RUN: iree-opt --split-input-file --iree-flow-specialize-dispatch-shapes="buckets=128,256" %s | FileCheck %s
+
+// CHECK-LABEL: @specializeSingleDynamicDim
+// CHECK-SAME: (%[[ARG0:.+]]: tensor<?x64xf32>, %[[DIM:.+]]: index)
+func.func @specializeSingleDynamicDim(%arg0: tensor<?x64xf32>, %dim: index) -> tensor<?x64xf32> {
+  //  CHECK-DAG: %[[C128:.+]] = arith.constant 128 : index
+  //      CHECK: %[[IS_128:.+]] = arith.cmpi eq, %[[DIM]], %[[C128]]
+  //      CHECK: %[[IF:.+]] = scf.if %[[IS_128]] -> (tensor<?x64xf32>) {
+  //      CHECK:   %[[STATIC_128:.+]] = flow.dispatch.workgroups[%[[C128]]](%[[ARG0]], %[[C128]]) : (tensor<?x64xf32>{%[[C128]]}, index) -> tensor<?x64xf32>{%[[C128]]}
+  // CHECK-NEXT:       (%[[ARG0_128:.+]]: !flow.dispatch.tensor<readonly:tensor<?x64xf32>>, %{{.+}}: index, %[[RET0_128:.+]]: !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>)
+  // CHECK-NEXT:     %[[INNER_128:.+]] = arith.constant 128 : index
+  //      CHECK:     flow.dispatch.tie_shape %[[ARG0_128]] : !flow.dispatch.tensor<readonly:tensor<?x64xf32>>{%[[INNER_128]]}
+  //      CHECK:   scf.yield %[[STATIC_128]]
+  // CHECK-NEXT: } else {
+  //      CHECK:   %[[C256:.+]] = arith.constant 256 : index
+  //      CHECK:   %[[IS_256:.+]] = arith.cmpi eq, %[[DIM]], %[[C256]]
+  //      CHECK:   %[[IF_256:.+]] = scf.if %[[IS_256]] -> (tensor<?x64xf32>) {
+  //      CHECK:     flow.dispatch.workgroups[%[[C256]]](%[[ARG0]], %[[C256]])
+  //      CHECK:   } else {
+  //      CHECK:     %[[DYNAMIC:.+]] = flow.dispatch.workgroups[%[[DIM]]](%[[ARG0]], %[[DIM]])
+  //      CHECK:     scf.yield %[[DYNAMIC]]
+  //      CHECK:   scf.yield %[[IF_256]]
+  //      CHECK: %[[RESULT:.+]] = flow.tensor.tie_shape %[[IF]] : tensor<?x64xf32>{%[[DIM]]}
+  %0 = flow.dispatch.workgroups[%dim](%arg0, %dim) : (tensor<?x64xf32>{%dim}, index) -> tensor<?x64xf32>{%dim} =
+      (%arg0_capture: !flow.dispatch.tensor<readonly:tensor<?x64xf32>>, %dim_capture: index, %ret0: !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>) {
+    %1 = flow.dispatch.tie_shape %arg0_capture : !flow.dispatch.tensor<readonly:tensor<?x64xf32>>{%dim_capture}
+    %2 = flow.dispatch.tie_shape %ret0 : !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>{%dim_capture}
+    %3 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [%dim_capture, 64], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<?x64xf32>>{%dim_capture} -> tensor<?x64xf32>
+    flow.dispatch.tensor.store %3, %2, offsets = [0, 0], sizes = [%dim_capture, 64], strides = [1, 1] : tensor<?x64xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x64xf32>>{%dim_capture}
+    flow.return
+  } count(%x: index) -> (index, index, index) {
+    %c1 = arith.constant 1 : index
+    flow.return %x, %c1, %c1 : index, index, index
+  }
+  // CHECK: return %[[RESULT]]
+  return %0 : tensor<?x64xf32>
+}
+
+// -----
+
+// Dispatches with more than one dynamic dimension are left alone.
+
+// CHECK-LABEL: @skipMultipleDynamicDims
+func.func @skipMultipleDynamicDims(%arg0: tensor<?x?xf32>, %dim0: index, %dim1: index) -> tensor<?x?xf32> {
+  // CHECK-NOT: scf.if
+  // CHECK: flow.dispatch.workgroups[%{{.+}}, %{{.+}}]
+  %0 = flow.dispatch.workgroups[%dim0, %dim1](%arg0, %dim0, %dim1) : (tensor<?x?xf32>{%dim0, %dim1}, index, index) -> %arg0{%dim0, %dim1} =
+      (%arg0_capture: !flow.dispatch.tensor<readwrite:tensor<?x?xf32>>, %dim0_capture: index, %dim1_capture: index) {
+    flow.return
+  } count(%x: index, %y: index) -> (index, index, index) {
+    %c1 = arith.constant 1 : index
+    flow.return %x, %y, %c1 : index, index, index
+  }
+  return %0 : tensor<?x?xf32>
+}
@@ -0,0 +1,46 @@
+// RUN: iree-opt --split-input-file --iree-flow-split-reduction-ops="min-parallelism=4096" %s | FileCheck %s
+
+// 128 outputs reach the parallelism with 16 splits of K, each reducing 256.
+// CHECK-LABEL: @skinnyMatmul
+// CHECK-SAME: (%[[LHS:.+]]: tensor<8x4096xf32>, %[[RHS:.+]]: tensor<4096x16xf32>
+func.func @skinnyMatmul(%lhs: tensor<8x4096xf32>, %rhs: tensor<4096x16xf32>, %init: tensor<8x16xf32>) -> tensor<8x16xf32> {
+  // CHECK-DAG: %[[EXPANDED_LHS:.+]] = tensor.expand_shape %[[LHS]] {{\[}}[0], [1, 2]] : tensor<8x4096xf32> into tensor<8x16x256xf32>
+  // CHECK-DAG: %[[EXPANDED_RHS:.+]] = tensor.expand_shape %[[RHS]] {{\[}}[0, 1], [2]] : tensor<4096x16xf32> into tensor<16x256x16xf32>
+  //     CHECK: %[[PARTIAL:.+]] = linalg.generic
+  // CHECK-SAME:   ins(%[[EXPANDED_LHS]], %[[EXPANDED_RHS]] : tensor<8x16x256xf32>, tensor<16x256x16xf32>)
+  //     CHECK: %[[RESULT:.+]] = linalg.generic
+  // CHECK-SAME:   ins(%[[PARTIAL]] : tensor<16x8x16xf32>) outs(%{{.+}} : tensor<8x16xf32>)
+  //     CHECK: return %[[RESULT]]
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<8x4096xf32>, tensor<4096x16xf32>) outs(%init : tensor<8x16xf32>) -> tensor<8x16xf32>
+  return %0 : tensor<8x16xf32>
+}
+
+// -----
+
+// Matmuls with enough outputs are left alone.
+// CHECK-LABEL: @wideMatmul
+func.func @wideMatmul(%lhs: tensor<128x4096xf32>, %rhs: tensor<4096x64xf32>, %init: tensor<128x64xf32>) -> tensor<128x64xf32> {
+  // CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<128x4096xf32>, tensor<4096x64xf32>) outs(%init : tensor<128x64xf32>) -> tensor<128x64xf32>
+  return %0 : tensor<128x64xf32>
+}
+
+// -----
+
+// Splitting a short reduction would cost more than it gains.
+// CHECK-LABEL: @shortReductionMatmul
+func.func @shortReductionMatmul(%lhs: tensor<8x256xf32>, %rhs: tensor<256x16xf32>, %init: tensor<8x16xf32>) -> tensor<8x16xf32> {
+  // CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<8x256xf32>, tensor<256x16xf32>) outs(%init : tensor<8x16xf32>) -> tensor<8x16xf32>
+  return %0 : tensor<8x16xf32>
+}
+
+// -----
+
+// The number of outputs of dynamically shaped matmuls is unknown.
+// CHECK-LABEL: @dynamicMatmul
+func.func @dynamicMatmul(%lhs: tensor<?x4096xf32>, %rhs: tensor<4096x16xf32>, %init: tensor<?x16xf32>) -> tensor<?x16xf32> {
+  // CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<?x4096xf32>, tensor<4096x16xf32>) outs(%init : tensor<?x16xf32>) -> tensor<?x16xf32>
+  return %0 : tensor<?x16xf32>
+}
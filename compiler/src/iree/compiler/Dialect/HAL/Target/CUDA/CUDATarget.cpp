@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/HAL/Target/CUDA/CUDATarget.h"
 
 #include "iree/compiler/Codegen/Dialect/IREECodegenDialect.h"
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
 #include "iree/compiler/Codegen/Passes.h"
 #include "iree/compiler/Dialect/HAL/Target/CUDA/LLVMPasses.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
@@ -54,6 +55,14 @@ static llvm::cl::opt<std::string> clTargetChip(
     "iree-hal-cuda-llvm-target-arch", llvm::cl::desc("LLVM target chip."),
     llvm::cl::init("sm_35"));
 
+static llvm::cl::opt<bool> clOccupancyLaunchBounds(
+    "iree-hal-cuda-occupancy-launch-bounds",
+    llvm::cl::desc("Annotate memory bound kernels with the minimum number of "
+                   "thread blocks per multiprocessor (minctasm) reachable by "
+                   "their thread and shared memory usage, so that register "
+                   "allocation doesn't limit occupancy."),
+    llvm::cl::init(true));
+
 namespace llvm {
 class FunctionPass;
 FunctionPass *createNVVMIntrRangePass(unsigned int SmVersion);
@@ -64,6 +73,87 @@ namespace iree_compiler {
 namespace IREE {
 namespace HAL {
 
+namespace {
+/// Resources of a streaming multiprocessor limiting the number of resident
+/// thread blocks.
+struct SMResources {
+  int64_t maxThreads = 2048;
+  int64_t maxBlocks = 16;
+  int64_t numRegisters = 64 * 1024;
+  int64_t sharedMemoryBytes = 48 * 1024;
+};
+}  // namespace
+
+/// Returns the multiprocessor resources of |targetChip| (`sm_XX`).
+static SMResources getSMResources(StringRef targetChip) {
+  SMResources resources;
+  int64_t smVersion = 0;
+  if (!targetChip.consume_front("sm_") ||
+      targetChip.getAsInteger(10, smVersion)) {
+    return resources;
+  }
+  if (smVersion >= 90) {
+    resources.maxBlocks = 32;
+    resources.sharedMemoryBytes = 228 * 1024;
+  } else if (smVersion == 80 || smVersion == 87) {
+    resources.maxBlocks = 32;
+    resources.sharedMemoryBytes = 164 * 1024;
+  } else if (smVersion >= 86) {
+    resources.maxThreads = 1536;
+    resources.sharedMemoryBytes = 100 * 1024;
+  } else if (smVersion == 75) {
+    resources.maxThreads = 1024;
+    resources.sharedMemoryBytes = 64 * 1024;
+  } else if (smVersion >= 50) {
+    resources.maxBlocks = 32;
+    resources.sharedMemoryBytes = 64 * 1024;
+  }
+  return resources;
+}
+
+/// Returns the static shared memory in bytes used by |func|.
+static int64_t getStaticSharedMemoryBytes(const llvm::Function &func) {
+  const llvm::Module &module = *func.getParent();
+  const llvm::DataLayout &dataLayout = module.getDataLayout();
+  int64_t numBytes = 0;
+  for (const llvm::GlobalVariable &global : module.globals()) {
+    // Address space 3 is shared memory on NVPTX.
+    if (global.getAddressSpace() != 3) continue;
+    SmallVector<const llvm::User *> worklist(global.users());
+    while (!worklist.empty()) {
+      const llvm::User *user = worklist.pop_back_val();
+      if (auto *inst = dyn_cast<llvm::Instruction>(user)) {
+        if (inst->getFunction() != &func) continue;
+        numBytes += dataLayout.getTypeAllocSize(global.getValueType());
+        break;
+      }
+      worklist.append(user->user_begin(), user->user_end());
+    }
+  }
+  return numBytes;
+}
+
+/// Returns the number of thread blocks of a kernel that may be resident on a
+/// multiprocessor given its threads and shared memory usage. Registers are
+/// left out as they are what the bound is meant to constrain, but the result
+/// keeps at least |minRegistersPerThread| registers available to each thread
+/// so that bounding the kernel doesn't make it spill.
+static int64_t getOccupancyBlocksPerSM(const SMResources &resources,
+                                       int64_t numThreads,
+                                       int64_t sharedMemoryBytes,
+                                       int64_t minRegistersPerThread) {
+  int64_t numBlocks =
+      std::min(resources.maxBlocks, resources.maxThreads / numThreads);
+  if (sharedMemoryBytes > 0) {
+    numBlocks =
+        std::min(numBlocks, resources.sharedMemoryBytes / sharedMemoryBytes);
+  }
+  int64_t numWarpThreads = llvm::alignTo(numThreads, 32);
+  numBlocks = std::min(numBlocks, resources.numRegisters /
+                                      (numWarpThreads * minRegistersPerThread));
+  return numBlocks;
+}
+
 static std::string translateModuleToISA(llvm::Module &module,
                                         llvm::TargetMachine &targetMachine) {
   std::string targetISA;
@@ -178,6 +268,14 @@ class CUDATargetBackend final : public TargetBackend {
 
   std::string name() const override { return "cuda"; }
 
+  // Discrete GPUs sustain an order of magnitude more flops than bytes of HBM
+  // or GDDR bandwidth.
+  std::optional<double> getOpsPerByte() const override { return 16.0; }
+  // Around a hundred SMs each keeping thousands of threads in flight.
+  std::optional<int64_t> getMinParallelism() const override {
+    return 65536;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<gpu::GPUDialect, nvgpu::NVGPUDialect,
                     IREE::Codegen::IREECodegenDialect>();
@@ -299,9 +397,13 @@ class CUDATargetBackend final : public TargetBackend {
                                         "dialect to the native llvm::Module";
       }
 
-      for (auto [exportOp, workgroupSize] :
+      // Kernels whose performance is limited by memory bandwidth along with
+      // their thread count and dynamic shared memory size.
+      SmallVector<std::tuple<llvm::Function *, int64_t, int64_t>>
+          memoryBoundKernels;
+      for (auto [exportOp, workgroupSize, workgroupLocalMemory] :
            llvm::zip_equal(variantOp.getOps<IREE::HAL::ExecutableExportOp>(),
-                           workgroupSizes)) {
+                           workgroupSizes, workgroupLocalMemories)) {
         auto *llvmFunc = llvmModule->getFunction(exportOp.getName());
         if (llvmFunc->isDeclaration()) continue;
 
@@ -326,6 +428,26 @@ class CUDATargetBackend final : public TargetBackend {
         setMetadataValueI32("maxntidx", workgroupSize[0]);
         setMetadataValueI32("maxntidy", workgroupSize[1]);
         setMetadataValueI32("maxntidz", workgroupSize[2]);
+
+        if (IREE::Codegen::TranslationInfoAttr translationInfo =
+                getTranslationInfo(exportOp)) {
+          switch (translationInfo.getDispatchLoweringPassPipeline()) {
+            case IREE::Codegen::DispatchLoweringPassPipeline::
+                LLVMGPUDistribute:
+            case IREE::Codegen::DispatchLoweringPassPipeline::LLVMGPUVectorize:
+            case IREE::Codegen::DispatchLoweringPassPipeline::
+                LLVMGPUTransposeSharedMem:
+            case IREE::Codegen::DispatchLoweringPassPipeline::
+                LLVMGPUWarpReduction:
+              memoryBoundKernels.emplace_back(
+                  llvmFunc,
+                  workgroupSize[0] * workgroupSize[1] * workgroupSize[2],
+                  workgroupLocalMemory);
+              break;
+            default:
+              break;
+          }
+        }
       }
 
       std::unique_ptr<llvm::TargetMachine> targetMachine;
@@ -348,6 +470,31 @@ class CUDATargetBackend final : public TargetBackend {
 
       llvmModule->setDataLayout(targetMachine->createDataLayout());
 
+      // Memory bound kernels need many resident warps to hide memory latency.
+      // Without a bound LLVM may use enough registers per thread to limit the
+      // occupancy below what threads and shared memory allow.
+      if (clOccupancyLaunchBounds) {
+        SMResources resources = getSMResources(clTargetChip);
+        for (auto [llvmFunc, numThreads, dynamicSharedMemoryBytes] :
+             memoryBoundKernels) {
+          int64_t sharedMemoryBytes =
+              getStaticSharedMemoryBytes(*llvmFunc) + dynamicSharedMemoryBytes;
+          int64_t numBlocks =
+              getOccupancyBlocksPerSM(resources, numThreads, sharedMemoryBytes,
+                                      /*minRegistersPerThread=*/64);
+          if (numBlocks <= 1) continue;
+          llvm::Metadata *llvmMetadata[] = {
+              llvm::ValueAsMetadata::get(llvmFunc),
+              llvm::MDString::get(llvmModule->getContext(), "minctasm"),
+              llvm::ValueAsMetadata::get(llvm::ConstantInt::get(
+                  llvm::Type::getInt32Ty(llvmModule->getContext()),
+                  numBlocks))};
+          llvmModule->getOrInsertNamedMetadata("nvvm.annotations")
+              ->addOperand(
+                  llvm::MDNode::get(llvmModule->getContext(), llvmMetadata));
+        }
+      }
+
       linkAndOptimize(*llvmModule, *targetMachine);
 
       // Serialize CUDA kernel into the binary that we will embed in the
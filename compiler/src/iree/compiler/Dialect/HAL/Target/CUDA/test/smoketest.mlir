@@ -42,6 +42,7 @@ stream.executable public @add_dispatch_0 {
 
 // PTX: .entry add_dispatch_0
 // PTX: .maxntid 64, 1, 1
+// PTX: .minnctapersm 16
 // PTX:   add.rn.f32
 
 //      CHECK:   hal.executable.binary public @cuda_nvptx_fb attributes {
@@ -122,6 +122,13 @@ class LLVMCPUTargetBackend final : public TargetBackend {
 
   std::string name() const override { return "llvm-cpu"; }
 
+  // Typical multi-core CPUs sustain a few flops per byte of DRAM bandwidth.
+  std::optional<double> getOpsPerByte() const override { return 4.0; }
+  // Tens of cores each processing a tile of a few hundred outputs.
+  std::optional<int64_t> getMinParallelism() const override {
+    return 4096;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     mlir::registerLLVMDialectTranslation(registry);
     // TODO: make inclusion of ArmNeon conditional?
@@ -421,26 +428,35 @@ class LLVMCPUTargetBackend final : public TargetBackend {
 
     SmallVector<Artifact> objectFiles;
 
-    // Emit the base object file containing the bulk of our code.
-    // This must come first such that we have the proper library linking order.
+    // Emit the base object files containing the bulk of our code.
+    // These must come first such that we have the proper library linking
+    // order. Large modules can be split into partitions that are compiled in
+    // parallel; static libraries only support one object file per library.
     {
-      // NOTE: today we just use a single object file, however if we wanted to
-      // scale code generation and linking we'd want to generate one per
-      // function (or something like that). A single object file is also
-      // instrumental to static library generation (which only supports one
-      // object file per library).
-      std::string objectData;
-      if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
-                                      llvm::CGFT_ObjectFile, &objectData))) {
+      SmallVector<std::string> objectData;
+      if (options_.codegenPartitions > 1 && !options_.linkStatic &&
+          variantOp.getContext()->isMultithreadingEnabled()) {
+        if (failed(runParallelEmitObjFilePasses(
+                variantOp.getContext(), target, options_, llvmModule.get(),
+                options_.codegenPartitions, objectData))) {
+          return variantOp.emitError()
+                 << "failed to compile LLVM-IR module partitions to object "
+                    "files";
+        }
+      } else if (failed(runEmitObjFilePasses(
+                     targetMachine.get(), llvmModule.get(),
+                     llvm::CGFT_ObjectFile, &objectData.emplace_back()))) {
         return variantOp.emitError()
                << "failed to compile LLVM-IR module to an object file";
       }
-      auto objectFile = Artifact::createTemporary(libraryName, "o");
-      auto &os = objectFile.outputFile->os();
-      os << objectData;
-      os.flush();
-      os.close();
-      objectFiles.push_back(std::move(objectFile));
+      for (auto &data : objectData) {
+        auto objectFile = Artifact::createTemporary(libraryName, "o");
+        auto &os = objectFile.outputFile->os();
+        os << data;
+        os.flush();
+        os.close();
+        objectFiles.push_back(std::move(objectFile));
+      }
     }
 
     // If we are keeping artifacts then let's also add the bitcode and
@@ -739,6 +755,17 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     addConfig("native_vector_size",
               IntegerAttr::get(IndexType::get(context), config_.vectorSize));
 
+    // Set the data cache sizes the target machine knows about. Codegen uses
+    // them to pick cache tile sizes.
+    if (config_.l1CacheSize) {
+      addConfig("l1_cache_size",
+                IntegerAttr::get(IndexType::get(context), config_.l1CacheSize));
+    }
+    if (config_.l2CacheSize) {
+      addConfig("l2_cache_size",
+                IntegerAttr::get(IndexType::get(context), config_.l2CacheSize));
+    }
+
     return IREE::HAL::ExecutableTargetAttr::get(
         context, StringAttr::get(context, "llvm-cpu"),
         StringAttr::get(context, format), DictionaryAttr::get(context, config));
@@ -766,6 +793,12 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     config_.vectorSize = tti.getRegisterBitWidth(
                              llvm::TargetTransformInfo::RGK_FixedWidthVector) /
                          8;
+    config_.l1CacheSize =
+        tti.getCacheSize(llvm::TargetTransformInfo::CacheLevel::L1D)
+            .value_or(0);
+    config_.l2CacheSize =
+        tti.getCacheSize(llvm::TargetTransformInfo::CacheLevel::L2D)
+            .value_or(0);
     LLVM_DEBUG({
       llvm::dbgs() << "CPU : " << targetMachine->getTargetCPU() << "\n";
       llvm::dbgs() << "Target Triple : "
@@ -774,6 +807,8 @@ class LLVMCPUTargetBackend final : public TargetBackend {
                    << targetMachine->getTargetFeatureString() << "\n";
       llvm::dbgs() << "Data Layout : " << config_.dataLayoutStr << "\n";
       llvm::dbgs() << "Vector Width : " << config_.vectorSize << "\n";
+      llvm::dbgs() << "L1 Cache Size : " << config_.l1CacheSize << "\n";
+      llvm::dbgs() << "L2 Cache Size : " << config_.l2CacheSize << "\n";
     });
   }
 
@@ -784,6 +819,9 @@ class LLVMCPUTargetBackend final : public TargetBackend {
   struct AdditionalConfigurationValues {
     std::string dataLayoutStr;
     int64_t vectorSize;
+    // Data cache sizes in bytes, or 0 if unknown.
+    int64_t l1CacheSize;
+    int64_t l2CacheSize;
   } config_;
 };
 
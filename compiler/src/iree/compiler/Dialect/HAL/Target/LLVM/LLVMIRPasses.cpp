@@ -7,6 +7,8 @@
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
 
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -21,6 +23,8 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Instrumentation/AddressSanitizer.h"
 #include "llvm/Transforms/Instrumentation/ThreadSanitizer.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include "mlir/IR/Threading.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -128,6 +132,41 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
   return success();
 }
 
+LogicalResult runParallelEmitObjFilePasses(
+    MLIRContext *context, const LLVMTarget &target,
+    const LLVMTargetOptions &options, llvm::Module *module,
+    unsigned partitionCount, SmallVectorImpl<std::string> &objData) {
+  // LLVM contexts and target machines are not thread-safe so each partition
+  // is round-tripped through bitcode into its own context and compiled with
+  // its own target machine. Locals referenced across partitions are promoted
+  // to hidden symbols.
+  SmallVector<SmallString<0>> partitionBitcode;
+  llvm::SplitModule(
+      *module, partitionCount,
+      [&](std::unique_ptr<llvm::Module> partition) {
+        llvm::raw_svector_ostream os(partitionBitcode.emplace_back());
+        llvm::WriteBitcodeToFile(*partition, os);
+      },
+      /*PreserveLocals=*/false);
+
+  objData.resize(partitionBitcode.size());
+  return failableParallelForEachN(
+      context, 0, partitionBitcode.size(), [&](size_t i) -> LogicalResult {
+        llvm::LLVMContext llvmContext;
+        auto partition = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(partitionBitcode[i].str(), "partition"),
+            llvmContext);
+        if (!partition) {
+          llvm::consumeError(partition.takeError());
+          return failure();
+        }
+        auto machine = createTargetMachine(target, options);
+        if (!machine) return failure();
+        return runEmitObjFilePasses(machine.get(), partition->get(),
+                                    llvm::CGFT_ObjectFile, &objData[i]);
+      });
+}
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
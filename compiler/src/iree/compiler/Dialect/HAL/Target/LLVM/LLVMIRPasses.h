@@ -12,6 +12,7 @@
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMTargetOptions.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Target/TargetMachine.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/Support/LogicalResult.h"
 
 namespace mlir {
@@ -34,6 +35,16 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
                                    llvm::CodeGenFileType fileType,
                                    std::string *objData);
 
+// Splits |module| into |partitionCount| modules and emits an object file for
+// each of them for |target| in parallel on the |context| thread pool. Linking
+// the objects together is equivalent to linking the single object that would
+// have been emitted from |module|. Object files are returned in partition
+// order so the output is deterministic.
+LogicalResult runParallelEmitObjFilePasses(
+    MLIRContext *context, const LLVMTarget &target,
+    const LLVMTargetOptions &options, llvm::Module *module,
+    unsigned partitionCount, SmallVectorImpl<std::string> &objData);
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
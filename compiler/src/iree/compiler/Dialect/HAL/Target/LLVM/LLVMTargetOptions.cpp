@@ -212,6 +212,14 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::init(targetOptions.keepLinkerArtifacts));
   targetOptions.keepLinkerArtifacts = clKeepLinkerArtifacts;
 
+  static llvm::cl::opt<unsigned> clCodegenPartitions(
+      "iree-llvm-codegen-partitions",
+      llvm::cl::desc("Splits the LLVM module of each executable into this "
+                     "many partitions that are compiled to object files in "
+                     "parallel"),
+      llvm::cl::init(targetOptions.codegenPartitions));
+  targetOptions.codegenPartitions = clCodegenPartitions;
+
   static llvm::cl::opt<std::string> clStaticLibraryOutputPath(
       "iree-llvm-static-library-output-path",
       llvm::cl::desc(
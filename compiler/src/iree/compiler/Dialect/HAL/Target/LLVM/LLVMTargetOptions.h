@@ -74,6 +74,12 @@ struct LLVMTargetOptions {
   // True to keep linker artifacts for debugging.
   bool keepLinkerArtifacts = false;
 
+  // Number of partitions the LLVM module of each executable is split into for
+  // parallel code generation. Each partition produces its own object file and
+  // is compiled on the MLIR context thread pool. Ignored when producing static
+  // libraries, which only support a single object file.
+  unsigned codegenPartitions = 1;
+
   // Build for IREE static library loading using this output path for
   // a "{staticLibraryOutput}.o" object file and "{staticLibraryOutput}.h"
   // header file.
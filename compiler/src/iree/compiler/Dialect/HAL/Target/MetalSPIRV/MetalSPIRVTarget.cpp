@@ -44,6 +44,13 @@ class MetalSPIRVTargetBackend : public TargetBackend {
   // NOTE: we could vary this based on the options such as 'metal-v2'.
   std::string name() const override { return "metal"; }
 
+  std::optional<double> getOpsPerByte() const override {
+    return kSPIRVDefaultOpsPerByte;
+  }
+  std::optional<int64_t> getMinParallelism() const override {
+    return kSPIRVDefaultMinParallelism;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::Codegen::IREECodegenDialect, spirv::SPIRVDialect,
                     gpu::GPUDialect>();
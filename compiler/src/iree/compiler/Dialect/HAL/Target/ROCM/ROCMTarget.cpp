@@ -75,6 +75,14 @@ class ROCMTargetBackend final : public TargetBackend {
  public:
   std::string name() const override { return "rocm"; }
 
+  // Discrete GPUs sustain an order of magnitude more flops than bytes of HBM
+  // or GDDR bandwidth.
+  std::optional<double> getOpsPerByte() const override { return 16.0; }
+  // Around a hundred CUs each keeping thousands of threads in flight.
+  std::optional<int64_t> getMinParallelism() const override {
+    return 65536;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     mlir::registerLLVMDialectTranslation(registry);
     mlir::registerROCDLDialectTranslation(registry);
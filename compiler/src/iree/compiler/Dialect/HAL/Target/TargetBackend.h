@@ -8,6 +8,7 @@
 #define IREE_COMPILER_DIALECT_HAL_TARGET_TARGETBACKEND_H_
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -135,6 +136,30 @@ class TargetBackend {
   virtual IREE::HAL::DeviceTargetAttr getDefaultDeviceTarget(
       MLIRContext *context) const = 0;
 
+  // Returns the number of arithmetic operations the target can perform per
+  // byte of memory traffic before becoming compute bound (the ridge point of
+  // its roofline) or std::nullopt if unknown. Used to decide whether fusing
+  // producers and consumers into the same dispatch is profitable when doing so
+  // recomputes values instead of storing and reloading them.
+  virtual std::optional<double> getOpsPerByte() const { return std::nullopt; }
+
+  // Returns the number of independent output elements a dispatch needs to
+  // keep all of the compute units of the target busy or std::nullopt if
+  // unknown. Used to split the reduction of matmuls with few outputs and a
+  // large reduction dimension (split-K) across more workgroups.
+  virtual std::optional<int64_t> getMinParallelism() const {
+    return std::nullopt;
+  }
+
+  // Defaults for getOpsPerByte/getMinParallelism shared by the SPIR-V-based
+  // GPU targets (Vulkan, Metal, WebGPU). These APIs span discrete to mobile
+  // GPUs with no device known at compile time so the defaults assume the most
+  // common case: an integrated or mobile GPU bottlenecked on the memory it
+  // shares with the host, with tens of compute units each running a few
+  // hundred invocations.
+  static constexpr double kSPIRVDefaultOpsPerByte = 32.0;
+  static constexpr int64_t kSPIRVDefaultMinParallelism = 16384;
+
   // Inserts passes used to translate the `hal.executable.variant` op contents.
   // The pass manager will be nested on `hal.executable` such that the pipeline
   // will only run on executable contents.
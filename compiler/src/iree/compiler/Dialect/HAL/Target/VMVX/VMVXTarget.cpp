@@ -31,8 +31,10 @@ namespace HAL {
 
 static llvm::cl::opt<bool> clEnableMicrokernels(
     "iree-vmvx-enable-microkernels",
-    llvm::cl::desc("Enables microkernel lowering for vmvx (experimental)"),
-    llvm::cl::init(false));
+    llvm::cl::desc("Enables microkernel lowering for vmvx; data-tiled ops "
+                   "and supported elementwise ops are lowered to the ukernel "
+                   "library and all others fall back to codegen"),
+    llvm::cl::init(true));
 
 static IREE::HAL::ExecutableTargetAttr getVMVXExecutableTarget(
     MLIRContext *context, StringRef backend, StringRef format) {
@@ -91,6 +91,13 @@ class VulkanSPIRVTargetBackend : public TargetBackend {
   // NOTE: we could vary these based on the options such as 'vulkan-v1.1'.
   std::string name() const override { return "vulkan"; }
 
+  std::optional<double> getOpsPerByte() const override {
+    return kSPIRVDefaultOpsPerByte;
+  }
+  std::optional<int64_t> getMinParallelism() const override {
+    return kSPIRVDefaultMinParallelism;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::Codegen::IREECodegenDialect, Vulkan::VulkanDialect,
                     spirv::SPIRVDialect, gpu::GPUDialect>();
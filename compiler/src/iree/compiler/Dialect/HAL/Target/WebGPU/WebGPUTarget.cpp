@@ -62,6 +62,13 @@ class WebGPUTargetBackend : public TargetBackend {
   // NOTE: we could vary this based on the options such as 'webgpu-v2'.
   std::string name() const override { return "webgpu"; }
 
+  std::optional<double> getOpsPerByte() const override {
+    return kSPIRVDefaultOpsPerByte;
+  }
+  std::optional<int64_t> getMinParallelism() const override {
+    return kSPIRVDefaultMinParallelism;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::Codegen::IREECodegenDialect, spirv::SPIRVDialect,
                     gpu::GPUDialect>();
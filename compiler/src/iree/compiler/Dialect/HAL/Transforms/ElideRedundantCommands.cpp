@@ -47,6 +47,30 @@ struct DescriptorSetState {
   }
 };
 
+// Returns true if |lhs| and |rhs| may reference the same memory. Only buffers
+// from distinct allocations are known not to alias.
+static bool mayAlias(Value lhs, Value rhs) {
+  if (lhs == rhs) return true;
+  auto isAllocation = [](Value buffer) {
+    return isa_and_nonnull<IREE::HAL::AllocatorAllocateOp,
+                           IREE::HAL::AllocatorAllocateInitializedOp,
+                           IREE::HAL::DeviceQueueAllocaOp>(
+        buffer.getDefiningOp());
+  };
+  return !isAllocation(lhs) || !isAllocation(rhs);
+}
+
+struct FillState {
+  IREE::HAL::CommandBufferFillBufferOp op;
+  // Set once a command may have read the filled range.
+  bool isRead = false;
+
+  bool isSameRange(Value buffer, Value offset, Value length) {
+    return op.getTargetBuffer() == buffer && op.getTargetOffset() == offset &&
+           op.getLength() == length;
+  }
+};
+
 struct CommandBufferState {
   // Push constants can only be reused with compatible layouts.
   Value pushConstantLayout;
@@ -62,6 +86,34 @@ struct CommandBufferState {
   // We need to use IPO to track that.
   IREE::HAL::CommandBufferExecutionBarrierOp previousFullBarrier;
 
+  // Cleared when the command buffer is created and set once anything is
+  // recorded into it. Barriers have nothing to order until then.
+  // Command buffers we didn't see created may already contain commands.
+  bool hasCommands = true;
+
+  // Fills whose target ranges are known to still hold their pattern.
+  SmallVector<FillState> fills;
+
+  // Marks the fills of buffers that may alias |buffer| as read.
+  void readBuffer(Value buffer) {
+    for (auto &fill : fills) {
+      if (mayAlias(fill.op.getTargetBuffer(), buffer)) fill.isRead = true;
+    }
+  }
+
+  // Forgets the fills of buffers that may alias |buffer| as they may have been
+  // overwritten. Fills of the same range that were never read are dead and
+  // erased.
+  void writeBuffer(Value buffer, Value offset, Value length) {
+    llvm::erase_if(fills, [&](FillState &fill) {
+      if (!mayAlias(fill.op.getTargetBuffer(), buffer)) return false;
+      if (!fill.isRead && fill.isSameRange(buffer, offset, length)) {
+        fill.op.erase();
+      }
+      return true;
+    });
+  }
+
   Value &getPushConstant(int64_t index) {
     if (index >= pushConstants.size()) {
       pushConstants.resize(index + 1);
@@ -89,6 +141,12 @@ using CommandBufferStateMap = DenseMap<Value, CommandBufferState>;
 
 static void processOp(IREE::HAL::CommandBufferExecutionBarrierOp op,
                       CommandBufferState &state) {
+  if (!state.hasCommands) {
+    // Nothing has been recorded yet and work in prior command buffers is
+    // ordered by the semaphores they signal.
+    op.erase();
+    return;
+  }
   if (state.previousFullBarrier) {
     // We are following a full barrier - this is a no-op (issuing two barriers
     // doesn't make the device barrier any harder).
@@ -112,6 +170,54 @@ static void processOp(IREE::HAL::CommandBufferExecutionBarrierOp op,
   }
 }
 
+static void processOp(IREE::HAL::CommandBufferFinalizeOp op,
+                      CommandBufferState &state) {
+  // A trailing barrier has no commands to order; work submitted after the
+  // command buffer is ordered by the semaphores it signals.
+  if (state.previousFullBarrier) state.previousFullBarrier.erase();
+}
+
+// Returns true if |value| is known to be a multiple of |alignment|.
+static bool isAlignedTo(Value value, int64_t alignment) {
+  if (alignment == 1) return true;
+  APInt valueInt;
+  return matchPattern(value, m_ConstantInt(&valueInt)) &&
+         valueInt.getSExtValue() % alignment == 0;
+}
+
+static void processOp(IREE::HAL::CommandBufferFillBufferOp op,
+                      CommandBufferState &state) {
+  state.writeBuffer(op.getTargetBuffer(), op.getTargetOffset(),
+                    op.getLength());
+  state.fills.push_back({op});
+}
+
+static void processOp(IREE::HAL::CommandBufferCopyBufferOp op,
+                      CommandBufferState &state) {
+  // Copies out of a filled range can fill the target directly instead of
+  // reading the source. Fills require the range be aligned to the pattern.
+  auto *sourceFill = llvm::find_if(state.fills, [&](FillState &fill) {
+    return fill.isSameRange(op.getSourceBuffer(), op.getSourceOffset(),
+                            op.getLength());
+  });
+  if (sourceFill != state.fills.end()) {
+    auto pattern = sourceFill->op.getPattern();
+    int64_t patternSize = pattern.getType().getIntOrFloatBitWidth() / 8;
+    if (isAlignedTo(op.getTargetOffset(), patternSize) &&
+        isAlignedTo(op.getLength(), patternSize)) {
+      auto fillOp = OpBuilder(op).create<IREE::HAL::CommandBufferFillBufferOp>(
+          op.getLoc(), op.getCommandBuffer(), op.getTargetBuffer(),
+          op.getTargetOffset(), op.getLength(), pattern);
+      op.erase();
+      processOp(fillOp, state);
+      return;
+    }
+  }
+  state.readBuffer(op.getSourceBuffer());
+  state.writeBuffer(op.getTargetBuffer(), op.getTargetOffset(),
+                    op.getLength());
+}
+
 static LogicalResult processOp(IREE::HAL::CommandBufferPushConstantsOp op,
                                CommandBufferState &state) {
   // Push constant state is only shared with the same layout.
@@ -214,7 +320,8 @@ class ElideRedundantCommandsPass
   }
 
   StringRef getDescription() const override {
-    return "Elides stateful command buffer ops that set redundant state.";
+    return "Elides stateful command buffer ops that set redundant state and "
+           "commands with no observable effect.";
   }
 
   void runOnOperation() override {
@@ -237,12 +344,19 @@ class ElideRedundantCommandsPass
           auto commandBuffer = op->getOperand(0);
           assert(commandBuffer.getType().isa<IREE::HAL::CommandBufferType>() &&
                  "operand 0 must be a command buffer");
-          stateMap[commandBuffer].previousFullBarrier = {};
+          auto &state = stateMap[commandBuffer];
+          state.previousFullBarrier = {};
+          state.hasCommands = true;
         };
         for (auto &op : llvm::make_early_inc_range(block.getOperations())) {
           if (!op.getDialect()) continue;
           TypeSwitch<Operation *>(&op)
+              .Case([&](IREE::HAL::CommandBufferCreateOp op) {
+                invalidateState(op.getResult());
+                stateMap[op.getResult()].hasCommands = false;
+              })
               .Case([&](IREE::HAL::CommandBufferFinalizeOp op) {
+                processOp(op, stateMap[op.getCommandBuffer()]);
                 invalidateState(op.getCommandBuffer());
               })
               .Case([&](IREE::HAL::CommandBufferExecutionBarrierOp op) {
@@ -260,15 +374,26 @@ class ElideRedundantCommandsPass
                   invalidateState(op.getCommandBuffer());
                 }
               })
-              .Case<IREE::HAL::CommandBufferDeviceOp,
-                    IREE::HAL::CommandBufferBeginDebugGroupOp,
-                    IREE::HAL::CommandBufferEndDebugGroupOp,
-                    IREE::HAL::CommandBufferFillBufferOp,
-                    IREE::HAL::CommandBufferCopyBufferOp,
-                    IREE::HAL::CommandBufferDispatchSymbolOp,
+              .Case([&](IREE::HAL::CommandBufferFillBufferOp op) {
+                resetCommandBufferBarrierBit(op);
+                processOp(op, stateMap[op.getCommandBuffer()]);
+              })
+              .Case([&](IREE::HAL::CommandBufferCopyBufferOp op) {
+                resetCommandBufferBarrierBit(op);
+                processOp(op, stateMap[op.getCommandBuffer()]);
+              })
+              .Case<IREE::HAL::CommandBufferDispatchSymbolOp,
                     IREE::HAL::CommandBufferDispatchOp,
                     IREE::HAL::CommandBufferDispatchIndirectSymbolOp,
                     IREE::HAL::CommandBufferDispatchIndirectOp>(
+                  [&](Operation *op) {
+                    // Dispatches may read and write any bound buffer.
+                    resetCommandBufferBarrierBit(op);
+                    stateMap[op->getOperand(0)].fills.clear();
+                  })
+              .Case<IREE::HAL::CommandBufferDeviceOp,
+                    IREE::HAL::CommandBufferBeginDebugGroupOp,
+                    IREE::HAL::CommandBufferEndDebugGroupOp>(
                   [&](Operation *op) {
                     // Ok - don't impact state.
                     resetCommandBufferBarrierBit(op);
@@ -0,0 +1,127 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-hal-fuse-device-switches"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Returns true if |prevOp| can be fused into |nextOp|: both switch on the same
+// device with the same conditions and have no results.
+static bool canFuseSwitches(IREE::HAL::DeviceSwitchOp prevOp,
+                            IREE::HAL::DeviceSwitchOp nextOp) {
+  if (prevOp.getDevice() != nextOp.getDevice() ||
+      prevOp.getConditions() != nextOp.getConditions()) {
+    return false;
+  }
+  if (prevOp.getNumResults() != 0 || nextOp.getNumResults() != 0) {
+    return false;
+  }
+  auto isSingleBlock = [](Region &region) { return region.hasOneBlock(); };
+  return llvm::all_of(prevOp.getConditionRegions(), isSingleBlock) &&
+         llvm::all_of(nextOp.getConditionRegions(), isSingleBlock);
+}
+
+// Moves the condition regions of |prevOp| and the |interveningOps| recorded
+// between the two switches to the start of the matching regions of |nextOp|.
+//
+// A switch without results executes at most one of its regions and programs
+// are invalid if none matches (inlined switches trap on fallthrough) so the
+// intervening ops still execute exactly once.
+static void fuseSwitches(IREE::HAL::DeviceSwitchOp prevOp,
+                         ArrayRef<Operation *> interveningOps,
+                         IREE::HAL::DeviceSwitchOp nextOp) {
+  LLVM_DEBUG(llvm::dbgs() << "fusing device switch at " << prevOp.getLoc()
+                          << " into " << nextOp.getLoc() << "\n");
+  for (auto [prevRegion, nextRegion] : llvm::zip_equal(
+           prevOp.getConditionRegions(), nextOp.getConditionRegions())) {
+    Block &prevBlock = prevRegion.front();
+    Block &nextBlock = nextRegion.front();
+    auto insertionPoint = nextBlock.begin();
+    nextBlock.getOperations().splice(insertionPoint, prevBlock.getOperations(),
+                                     prevBlock.begin(),
+                                     prevBlock.getTerminator()->getIterator());
+    OpBuilder builder(&nextBlock, insertionPoint);
+    for (auto *op : interveningOps) builder.clone(*op);
+  }
+  for (auto *op : interveningOps) op->erase();
+  prevOp.erase();
+}
+
+// Fuses runs of switches in |block| separated only by ops that are either
+// pure or produce no results.
+static void fuseSwitchesInBlock(Block &block) {
+  IREE::HAL::DeviceSwitchOp prevOp;
+  SmallVector<Operation *> interveningOps;
+  for (auto &op : llvm::make_early_inc_range(block)) {
+    if (auto switchOp = dyn_cast<IREE::HAL::DeviceSwitchOp>(op)) {
+      if (prevOp && canFuseSwitches(prevOp, switchOp)) {
+        fuseSwitches(prevOp, interveningOps, switchOp);
+      }
+      prevOp = switchOp;
+      interveningOps.clear();
+      continue;
+    }
+    if (!prevOp || op.getNumRegions() != 0 ||
+        op.hasTrait<OpTrait::IsTerminator>()) {
+      prevOp = {};
+      continue;
+    }
+    if (op.getNumResults() == 0) {
+      // Ops like barriers are moved into the fused switch to preserve their
+      // order relative to the commands in it.
+      interveningOps.push_back(&op);
+    } else if (!isMemoryEffectFree(&op)) {
+      // Ops producing values may be used after the switch and must stay in
+      // place; that's only possible if they don't need ordering.
+      prevOp = {};
+    }
+  }
+}
+
+class FuseDeviceSwitchesPass
+    : public PassWrapper<FuseDeviceSwitchesPass, OperationPass<void>> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::HAL::HALDialect>();
+  }
+
+  StringRef getArgument() const override {
+    return "iree-hal-fuse-device-switches";
+  }
+
+  StringRef getDescription() const override {
+    return "Fuses back-to-back hal.device.switch ops with the same conditions";
+  }
+
+  void runOnOperation() override {
+    SmallVector<Block *> blocks;
+    getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+    for (auto *block : blocks) fuseSwitchesInBlock(*block);
+  }
+};
+
+std::unique_ptr<OperationPass<void>> createFuseDeviceSwitchesPass() {
+  return std::make_unique<FuseDeviceSwitchesPass>();
+}
+
+static PassRegistration<FuseDeviceSwitchesPass> pass;
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
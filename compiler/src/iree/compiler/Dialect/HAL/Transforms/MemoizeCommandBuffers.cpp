@@ -0,0 +1,273 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <optional>
+
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-hal-memoize-command-buffers"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+namespace {
+
+// The ops recording a command buffer from its creation to its finalization.
+struct Recording {
+  IREE::HAL::CommandBufferCreateOp createOp;
+  IREE::HAL::CommandBufferFinalizeOp finalizeOp;
+  // All ops in the block from createOp to finalizeOp, inclusive.
+  SmallVector<Operation *> ops;
+  // Values defined outside of the recording that the recorded commands depend
+  // on. The recorded command buffer can be reused as long as these are
+  // unchanged.
+  SetVector<Value> keys;
+};
+
+}  // namespace
+
+// Returns true if |op| nested within the recording of |commandBuffer| only
+// contributes to the recorded commands and has no other effects.
+static bool isRecordingOp(Operation *op, Value commandBuffer) {
+  if (isa<IREE::HAL::HALDialect>(op->getDialect()) &&
+      llvm::is_contained(op->getOperands(), commandBuffer)) {
+    return true;
+  }
+  if (op->hasTrait<OpTrait::IsTerminator>()) return true;
+  if (isa<IREE::HAL::DeviceSwitchOp, IREE::HAL::DeviceQueryOp>(op)) {
+    return true;
+  }
+  return isMemoryEffectFree(op);
+}
+
+// Returns true if |value| is guaranteed to be the same on every invocation.
+static bool isInvariant(Value value) {
+  if (matchPattern(value, m_Constant())) return true;
+  // Loads of immutable globals (such as the executables and layouts cached
+  // at initialization time) have no effects.
+  auto loadOp = value.getDefiningOp<IREE::Util::GlobalLoadOp>();
+  return loadOp && isMemoryEffectFree(loadOp);
+}
+
+// Returns true if values of |type| can be compared for reuse.
+static bool isComparableType(Type type) {
+  return type.isa<IREE::Util::ReferenceTypeInterface, IndexType,
+                  IntegerType>();
+}
+
+// Gathers the recording started by |createOp| if it can be memoized.
+static std::optional<Recording> findRecording(
+    IREE::HAL::CommandBufferCreateOp createOp) {
+  Recording recording;
+  recording.createOp = createOp;
+  auto commandBuffer = createOp.getResult();
+  for (auto *user : commandBuffer.getUsers()) {
+    if (auto finalizeOp = dyn_cast<IREE::HAL::CommandBufferFinalizeOp>(user)) {
+      recording.finalizeOp = finalizeOp;
+    }
+  }
+  auto *block = createOp->getBlock();
+  if (!recording.finalizeOp || recording.finalizeOp->getBlock() != block) {
+    return std::nullopt;
+  }
+
+  DenseSet<Operation *> rangeOps;
+  for (auto it = createOp->getIterator();; ++it) {
+    recording.ops.push_back(&*it);
+    rangeOps.insert(&*it);
+    if (&*it == recording.finalizeOp.getOperation()) break;
+  }
+  auto isDefinedInRecording = [&](Value value) {
+    auto *definingOp = value.getDefiningOp();
+    if (!definingOp) {
+      definingOp = value.cast<BlockArgument>().getOwner()->getParentOp();
+    }
+    auto *ancestorOp = block->findAncestorOpInBlock(*definingOp);
+    return ancestorOp && rangeOps.contains(ancestorOp);
+  };
+
+  for (auto *op : recording.ops) {
+    auto walkResult = op->walk([&](Operation *nestedOp) {
+      if (!isRecordingOp(nestedOp, commandBuffer)) {
+        LLVM_DEBUG(llvm::dbgs() << "not memoizing recording at "
+                                << createOp.getLoc() << ": " << *nestedOp
+                                << " has side-effects\n");
+        return WalkResult::interrupt();
+      }
+      for (auto operand : nestedOp->getOperands()) {
+        if (isDefinedInRecording(operand) || isInvariant(operand)) continue;
+        if (!isComparableType(operand.getType())) {
+          return WalkResult::interrupt();
+        }
+        recording.keys.insert(operand);
+      }
+      return WalkResult::advance();
+    });
+    if (walkResult.wasInterrupted()) return std::nullopt;
+
+    // The command buffer itself is the only value that may escape.
+    for (auto result : op->getResults()) {
+      if (result == commandBuffer) continue;
+      for (auto *user : result.getUsers()) {
+        auto *ancestorOp = block->findAncestorOpInBlock(*user);
+        if (!ancestorOp || !rangeOps.contains(ancestorOp)) return std::nullopt;
+      }
+    }
+  }
+  return recording;
+}
+
+// Returns an i1 that is true if |lhs| and |rhs| are equal.
+static Value buildEquality(Location loc, Value lhs, Value rhs,
+                           OpBuilder &builder) {
+  if (lhs.getType().isa<IREE::Util::ReferenceTypeInterface>()) {
+    return builder.create<IREE::Util::CmpEQOp>(loc, lhs, rhs);
+  }
+  return builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq, lhs,
+                                       rhs);
+}
+
+// Moves |recording| into a branch only taken when the command buffer recorded
+// by a prior invocation was recorded with different keys. The command buffer
+// and the keys it was recorded with are kept in mutable globals.
+static void memoizeRecording(Recording &recording, SymbolTable &symbolTable,
+                             OpBuilder &moduleBuilder) {
+  auto createOp = recording.createOp;
+  auto loc = createOp.getLoc();
+  auto commandBufferType = createOp.getResult().getType();
+
+  auto defineGlobal = [&](StringRef name, Type type) {
+    auto globalOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+        loc, name, /*isMutable=*/true, type);
+    globalOp.setPrivate();
+    symbolTable.insert(globalOp);
+    return globalOp;
+  };
+  auto commandBufferGlobalOp =
+      defineGlobal("_memoized_command_buffer", commandBufferType);
+  SmallVector<IREE::Util::GlobalOp> keyGlobalOps;
+  for (auto key : recording.keys) {
+    keyGlobalOps.push_back(defineGlobal(
+        (commandBufferGlobalOp.getName() + "_key").str(), key.getType()));
+  }
+
+  // The memoized command buffer is reusable if it was recorded with the same
+  // keys. It's null until the first invocation records it.
+  OpBuilder builder(createOp);
+  auto memoizedCommandBuffer = builder.create<IREE::Util::GlobalLoadOp>(
+      loc, commandBufferGlobalOp);
+  auto nullCommandBuffer =
+      builder.create<IREE::Util::NullOp>(loc, commandBufferType);
+  Value isNull = builder.create<IREE::Util::CmpEQOp>(
+      loc, memoizedCommandBuffer, nullCommandBuffer);
+  Value isReusable = builder.create<arith::XOrIOp>(
+      loc, isNull,
+      builder.create<arith::ConstantIntOp>(loc, 1, builder.getI1Type()));
+  for (auto [key, keyGlobalOp] :
+       llvm::zip_equal(recording.keys, keyGlobalOps)) {
+    auto memoizedKey =
+        builder.create<IREE::Util::GlobalLoadOp>(loc, keyGlobalOp);
+    isReusable = builder.create<arith::AndIOp>(
+        loc, isReusable, buildEquality(loc, memoizedKey, key, builder));
+  }
+
+  auto ifOp = builder.create<scf::IfOp>(
+      loc, isReusable,
+      [&](OpBuilder &thenBuilder, Location loc) {
+        thenBuilder.create<scf::YieldOp>(loc,
+                                         memoizedCommandBuffer.getResult());
+      },
+      [&](OpBuilder &elseBuilder, Location loc) {
+        elseBuilder.create<scf::YieldOp>(loc, createOp.getResult());
+      });
+
+  // Record and memoize the command buffer when it can't be reused.
+  auto yieldOp = ifOp.elseYield();
+  for (auto *op : recording.ops) op->moveBefore(yieldOp);
+  OpBuilder elseBuilder(yieldOp);
+  elseBuilder.create<IREE::Util::GlobalStoreOp>(
+      loc, createOp.getResult(), commandBufferGlobalOp.getName());
+  for (auto [key, keyGlobalOp] :
+       llvm::zip_equal(recording.keys, keyGlobalOps)) {
+    elseBuilder.create<IREE::Util::GlobalStoreOp>(loc, key,
+                                                  keyGlobalOp.getName());
+  }
+  createOp.getResult().replaceUsesWithIf(
+      ifOp.getResult(0), [&](OpOperand &use) {
+        return !ifOp->isProperAncestor(use.getOwner());
+      });
+
+  // The command buffer is now submitted many times and can't be one-shot nor
+  // executed inline while recording.
+  createOp.setModesAttr(IREE::HAL::CommandBufferModeBitfieldAttr::get(
+      createOp.getContext(), IREE::HAL::CommandBufferModeBitfield::None));
+}
+
+class MemoizeCommandBuffersPass
+    : public PassWrapper<MemoizeCommandBuffersPass, OperationPass<ModuleOp>> {
+ public:
+  StringRef getArgument() const override {
+    return "iree-hal-memoize-command-buffers";
+  }
+
+  StringRef getDescription() const override {
+    return "Reuses command buffers recorded by prior invocations of a "
+           "function when recorded with the same buffers and parameters";
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect>();
+    registry.insert<scf::SCFDialect>();
+    registry.insert<IREE::HAL::HALDialect>();
+    registry.insert<IREE::Util::UtilDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+    auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
+
+    // Initializers only run once and have nothing to reuse.
+    SmallVector<Recording> recordings;
+    for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
+      funcOp.walk([&](IREE::HAL::CommandBufferCreateOp createOp) {
+        if (auto recording = findRecording(createOp)) {
+          recordings.push_back(std::move(*recording));
+        }
+      });
+    }
+    for (auto &recording : recordings) {
+      memoizeRecording(recording, symbolTable, moduleBuilder);
+    }
+  }
+};
+
+std::unique_ptr<OperationPass<ModuleOp>> createMemoizeCommandBuffersPass() {
+  return std::make_unique<MemoizeCommandBuffersPass>();
+}
+
+static PassRegistration<MemoizeCommandBuffersPass> pass;
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
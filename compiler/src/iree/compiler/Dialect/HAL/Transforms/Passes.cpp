@@ -48,6 +48,14 @@ static llvm::cl::opt<unsigned> benchmarkDispatchRepeatCount{
         "meant for command buffers having linear dispatch structures."),
     llvm::cl::init(1)};
 
+static llvm::cl::opt<bool> memoizeCommandBuffers{
+    "iree-hal-memoize-command-buffers",
+    llvm::cl::desc(
+        "Reuses the command buffers recorded by prior invocations of a "
+        "function when they were recorded with the same buffers and "
+        "parameters instead of recording them again on every call."),
+    llvm::cl::init(false)};
+
 }  // namespace
 
 using FunctionLikeNest = MultiOpNest<func::FuncOp, IREE::Util::InitializerOp>;
@@ -182,6 +190,17 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // Device management and specialization
   //----------------------------------------------------------------------------
 
+  // Fuse the device switches of back-to-back dispatches so that the
+  // parameters and workgroup counts of all dispatches in a command buffer can
+  // CSE and fold together and the device is only matched once.
+  FunctionLikeNest(passManager).addPass(createFuseDeviceSwitchesPass);
+
+  // Hoist command buffer recording out of functions while the structure of
+  // the recording is still intact (before device switches are inlined).
+  if (memoizeCommandBuffers) {
+    passManager.addPass(createMemoizeCommandBuffersPass());
+  }
+
   // Inline hal.device.switch ops and memoize their queries such that we can
   // better CSE/fold dispatch logic.
   FunctionLikeNest(passManager).addPass(createInlineDeviceSwitchesPass);
@@ -73,6 +73,11 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createAssignTargetDevicesPass(
 // removed.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createFixupLegacySyncPass();
 
+// Fuses back-to-back hal.device.switch ops on the same device and conditions
+// such that the device is matched once per sequence of dispatches and their
+// parameters and workgroup counts can be computed together.
+std::unique_ptr<OperationPass<void>> createFuseDeviceSwitchesPass();
+
 // Outlines hal.device.switch conditions into functions and inlines conditions.
 std::unique_ptr<OperationPass<void>> createInlineDeviceSwitchesPass();
 
@@ -144,6 +149,11 @@ createMaterializeResourceCachesPass(TargetOptions targetOptions);
 // Elides stateful command buffer ops that set redundant state.
 std::unique_ptr<OperationPass<void>> createElideRedundantCommandsPass();
 
+// Reuses command buffers recorded by prior invocations of a function as long as
+// the buffers and parameters they were recorded with are unchanged.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createMemoizeCommandBuffersPass();
+
 // Repeats dispatches `iree-hal-repeat-dispatch-num` times, which is 1 by
 // default.
 std::unique_ptr<OperationPass<func::FuncOp>> createBenchmarkBatchDispatchesPass(
@@ -164,10 +174,12 @@ inline void registerHALPasses() {
   createElideRedundantCommandsPass();
   createInlineDeviceSwitchesPass();
   createFixupLegacySyncPass();
+  createFuseDeviceSwitchesPass();
   createLinkExecutablesPass();
   createLinkTargetExecutablesPass("");
   createMaterializeInterfacesPass();
   createMaterializeResourceCachesPass(targetOptions);
+  createMemoizeCommandBuffersPass();
   createMemoizeDeviceQueriesPass();
   createResolveExportOrdinalsPass();
   createSerializeExecutablesPass();
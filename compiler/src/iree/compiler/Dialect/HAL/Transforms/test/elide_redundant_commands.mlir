@@ -127,3 +127,97 @@ func.func @elidePushDescriptorSet(%cmd: !hal.command_buffer, %pipeline_layout: !
   // CHECK: return
   return
 }
+
+// -----
+
+// Tests that barriers at the start and end of a command buffer are elided as
+// there are no commands for them to order within it.
+
+// CHECK-LABEL: @elideBoundaryBarriers
+func.func @elideBoundaryBarriers(%device: !hal.device, %buffer: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c42_i32 = arith.constant 42 : i32
+  // CHECK: %[[CMD:.+]] = hal.command_buffer.create
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer|Dispatch") : !hal.command_buffer
+  // CHECK-NOT: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK: hal.command_buffer.fill_buffer<%[[CMD]]
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%buffer : !hal.buffer)[%c0, %c128] pattern(%c42_i32 : i32)
+  // CHECK-NEXT: hal.command_buffer.execution_barrier<%[[CMD]]
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK-NEXT: hal.command_buffer.fill_buffer<%[[CMD]]
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%buffer : !hal.buffer)[%c128, %c128] pattern(%c42_i32 : i32)
+  // CHECK-NEXT: hal.command_buffer.finalize<%[[CMD]]
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  return
+}
+
+// -----
+
+// Tests that fills of ranges overwritten before being read are elided.
+
+// CHECK-LABEL: @elideOverwrittenFill
+func.func @elideOverwrittenFill(%device: !hal.device, %allocator: !hal.allocator) {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c0_i32 = arith.constant 0 : i32
+  // CHECK: %[[SOURCE:.+]] = hal.allocator.allocate
+  %source = hal.allocator.allocate<%allocator : !hal.allocator> type(DeviceLocal) usage(Transfer) : !hal.buffer{%c128}
+  // CHECK: %[[TARGET:.+]] = hal.allocator.allocate
+  %target = hal.allocator.allocate<%allocator : !hal.allocator> type(DeviceLocal) usage(Transfer) : !hal.buffer{%c128}
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer") : !hal.command_buffer
+  // CHECK-NOT: hal.command_buffer.fill_buffer
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%target : !hal.buffer)[%c0, %c128] pattern(%c0_i32 : i32)
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK: hal.command_buffer.copy_buffer
+  // CHECK-SAME: source(%[[SOURCE]] : !hal.buffer)[%c0]
+  // CHECK-SAME: target(%[[TARGET]] : !hal.buffer)[%c0]
+  hal.command_buffer.copy_buffer<%cmd : !hal.command_buffer> source(%source : !hal.buffer)[%c0] target(%target : !hal.buffer)[%c0] length(%c128)
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  return
+}
+
+// -----
+
+// Tests that fills read before being overwritten are preserved.
+
+// CHECK-LABEL: @keepReadFill
+func.func @keepReadFill(%device: !hal.device, %buffer0: !hal.buffer, %buffer1: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c0_i32 = arith.constant 0 : i32
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer") : !hal.command_buffer
+  // CHECK: hal.command_buffer.fill_buffer
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%buffer1 : !hal.buffer)[%c0, %c128] pattern(%c0_i32 : i32)
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // NOTE: %buffer0 may alias %buffer1 and the copy may read the fill.
+  // CHECK: hal.command_buffer.copy_buffer
+  hal.command_buffer.copy_buffer<%cmd : !hal.command_buffer> source(%buffer0 : !hal.buffer)[%c0] target(%buffer1 : !hal.buffer)[%c0] length(%c128)
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  return
+}
+
+// -----
+
+// Tests that copies out of filled ranges are turned into fills of the target.
+
+// CHECK-LABEL: @foldCopyOfFill
+// CHECK-SAME: (%[[DEVICE:.+]]: !hal.device, %[[BUFFER0:.+]]: !hal.buffer, %[[BUFFER1:.+]]: !hal.buffer)
+func.func @foldCopyOfFill(%device: !hal.device, %buffer0: !hal.buffer, %buffer1: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c64 = arith.constant 64 : index
+  %c128 = arith.constant 128 : index
+  // CHECK: %[[PATTERN:.+]] = arith.constant 42
+  %c42_i32 = arith.constant 42 : i32
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer") : !hal.command_buffer
+  // CHECK: hal.command_buffer.fill_buffer{{.+}} target(%[[BUFFER0]] : !hal.buffer)[%c0, %c128] pattern(%[[PATTERN]] : i32)
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer> target(%buffer0 : !hal.buffer)[%c0, %c128] pattern(%c42_i32 : i32)
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK-NOT: hal.command_buffer.copy_buffer
+  // CHECK: hal.command_buffer.fill_buffer{{.+}} target(%[[BUFFER1]] : !hal.buffer)[%c64, %c128] pattern(%[[PATTERN]] : i32)
+  hal.command_buffer.copy_buffer<%cmd : !hal.command_buffer> source(%buffer0 : !hal.buffer)[%c0] target(%buffer1 : !hal.buffer)[%c64] length(%c128)
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  return
+}
@@ -0,0 +1,71 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(func.func(iree-hal-fuse-device-switches))' %s | FileCheck %s
+
+// Tests that switches separated by barriers and pure ops are fused into the
+// last one with the barriers moved into each condition region.
+
+// CHECK-LABEL: @fuseDispatchSwitches
+// CHECK-SAME: (%[[DEVICE:.+]]: !hal.device, %[[CMD:.+]]: !hal.command_buffer)
+func.func @fuseDispatchSwitches(%device: !hal.device, %cmd: !hal.command_buffer) {
+  // CHECK-DAG: %[[C1:.+]] = arith.constant 1
+  %c1 = arith.constant 1 : index
+  // CHECK-NOT: hal.device.switch
+  hal.device.switch<%device : !hal.device>
+  #hal.device.match.id<"vulkan*"> {
+    hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@ex::@vulkan::@dispatch0) workgroups([%c1, %c1, %c1])
+    hal.return
+  },
+  #hal.device.match.id<"llvm-cpu*"> {
+    hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@ex::@cpu::@dispatch0) workgroups([%c1, %c1, %c1])
+    hal.return
+  }
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  // CHECK: %[[C2:.+]] = arith.constant 2
+  %c2 = arith.constant 2 : index
+  //      CHECK: hal.device.switch<%[[DEVICE]] : !hal.device>
+  // CHECK-NEXT: #hal.device.match.id<"vulkan*"> {
+  // CHECK-NEXT:   hal.command_buffer.dispatch.symbol<%[[CMD]] : !hal.command_buffer> target(@ex::@vulkan::@dispatch0) workgroups([%[[C1]], %[[C1]], %[[C1]]])
+  // CHECK-NEXT:   hal.command_buffer.execution_barrier<%[[CMD]] : !hal.command_buffer>
+  // CHECK-NEXT:   hal.command_buffer.dispatch.symbol<%[[CMD]] : !hal.command_buffer> target(@ex::@vulkan::@dispatch1) workgroups([%[[C2]], %[[C2]], %[[C2]]])
+  // CHECK-NEXT:   hal.return
+  // CHECK-NEXT: },
+  // CHECK-NEXT: #hal.device.match.id<"llvm-cpu*"> {
+  // CHECK-NEXT:   hal.command_buffer.dispatch.symbol<%[[CMD]] : !hal.command_buffer> target(@ex::@cpu::@dispatch0) workgroups([%[[C1]], %[[C1]], %[[C1]]])
+  // CHECK-NEXT:   hal.command_buffer.execution_barrier<%[[CMD]] : !hal.command_buffer>
+  // CHECK-NEXT:   hal.command_buffer.dispatch.symbol<%[[CMD]] : !hal.command_buffer> target(@ex::@cpu::@dispatch1) workgroups([%[[C2]], %[[C2]], %[[C2]]])
+  // CHECK-NEXT:   hal.return
+  // CHECK-NEXT: }
+  hal.device.switch<%device : !hal.device>
+  #hal.device.match.id<"vulkan*"> {
+    hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@ex::@vulkan::@dispatch1) workgroups([%c2, %c2, %c2])
+    hal.return
+  },
+  #hal.device.match.id<"llvm-cpu*"> {
+    hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@ex::@cpu::@dispatch1) workgroups([%c2, %c2, %c2])
+    hal.return
+  }
+  // CHECK-NOT: hal.command_buffer.execution_barrier
+  // CHECK: return
+  return
+}
+
+// -----
+
+// Tests that switches with different conditions are not fused.
+
+// CHECK-LABEL: @doNotFuseDifferentConditions
+func.func @doNotFuseDifferentConditions(%device: !hal.device, %cmd: !hal.command_buffer) {
+  %c1 = arith.constant 1 : index
+  // CHECK: hal.device.switch
+  hal.device.switch<%device : !hal.device>
+  #hal.device.match.id<"vulkan*"> {
+    hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@ex::@vulkan::@dispatch0) workgroups([%c1, %c1, %c1])
+    hal.return
+  }
+  // CHECK: hal.device.switch
+  hal.device.switch<%device : !hal.device>
+  #hal.device.match.id<"llvm-cpu*"> {
+    hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@ex::@cpu::@dispatch0) workgroups([%c1, %c1, %c1])
+    hal.return
+  }
+  return
+}
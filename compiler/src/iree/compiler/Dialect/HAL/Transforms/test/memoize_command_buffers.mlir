@@ -0,0 +1,96 @@
+// RUN: iree-opt --split-input-file --iree-hal-memoize-command-buffers %s | FileCheck %s
+
+// Tests that a command buffer is only recorded again when the values it was
+// recorded with change between invocations. Values that are the same on every
+// invocation (constants and cached executables/layouts) need no checks.
+
+// CHECK: util.global private mutable @[[CMD_GLOBAL:.+]] : !hal.command_buffer
+// CHECK: util.global private mutable @[[DEVICE_KEY:.+]] : !hal.device
+// CHECK: util.global private mutable @[[BUFFER_KEY:.+]] : !hal.buffer
+// CHECK: util.global private mutable @[[COUNT_KEY:.+]] : index
+
+util.global private @_executable : !hal.executable
+util.global private @_pipeline_layout : !hal.pipeline_layout
+
+// CHECK-LABEL: @memoizeDispatch
+// CHECK-SAME: (%[[DEVICE:.+]]: !hal.device, %[[BUFFER:.+]]: !hal.buffer, %[[COUNT:.+]]: index, %[[FENCE:.+]]: !hal.fence)
+func.func @memoizeDispatch(%device: !hal.device, %buffer: !hal.buffer, %count: index, %fence: !hal.fence) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  %c-1_i64 = arith.constant -1 : i64
+  %wait_fence = util.null : !hal.fence
+
+  // The command buffer recorded previously is reused if all keys match.
+  //      CHECK: %[[MEMOIZED:.+]] = util.global.load @[[CMD_GLOBAL]] : !hal.command_buffer
+  //      CHECK: %[[NULL:.+]] = util.null : !hal.command_buffer
+  //      CHECK: %[[IS_NULL:.+]] = util.cmp.eq %[[MEMOIZED]], %[[NULL]] : !hal.command_buffer
+  //      CHECK: %[[IS_RECORDED:.+]] = arith.xori %[[IS_NULL]], %true
+  //      CHECK: %[[MEMOIZED_DEVICE:.+]] = util.global.load @[[DEVICE_KEY]] : !hal.device
+  //      CHECK: %[[SAME_DEVICE:.+]] = util.cmp.eq %[[MEMOIZED_DEVICE]], %[[DEVICE]] : !hal.device
+  //      CHECK: %[[REUSABLE0:.+]] = arith.andi %[[IS_RECORDED]], %[[SAME_DEVICE]]
+  //      CHECK: %[[MEMOIZED_BUFFER:.+]] = util.global.load @[[BUFFER_KEY]] : !hal.buffer
+  //      CHECK: %[[SAME_BUFFER:.+]] = util.cmp.eq %[[MEMOIZED_BUFFER]], %[[BUFFER]] : !hal.buffer
+  //      CHECK: %[[REUSABLE1:.+]] = arith.andi %[[REUSABLE0]], %[[SAME_BUFFER]]
+  //      CHECK: %[[MEMOIZED_COUNT:.+]] = util.global.load @[[COUNT_KEY]] : index
+  //      CHECK: %[[SAME_COUNT:.+]] = arith.cmpi eq, %[[MEMOIZED_COUNT]], %[[COUNT]] : index
+  //      CHECK: %[[REUSABLE:.+]] = arith.andi %[[REUSABLE1]], %[[SAME_COUNT]]
+  //      CHECK: %[[CMD:.+]] = scf.if %[[REUSABLE]] -> (!hal.command_buffer) {
+  // CHECK-NEXT:   scf.yield %[[MEMOIZED]]
+  // CHECK-NEXT: } else {
+
+  // Otherwise it is recorded again as a reusable command buffer and memoized.
+  // CHECK-NEXT:   %[[NEW_CMD:.+]] = hal.command_buffer.create device(%[[DEVICE]] : !hal.device) mode("None")
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode("OneShot|AllowInlineExecution") categories("Transfer|Dispatch") : !hal.command_buffer
+  // CHECK: %[[LAYOUT:.+]] = util.global.load @_pipeline_layout
+  %layout = util.global.load @_pipeline_layout : !hal.pipeline_layout
+  // CHECK: hal.command_buffer.push_descriptor_set<%[[NEW_CMD]] : !hal.command_buffer> layout(%[[LAYOUT]] : !hal.pipeline_layout)
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer>
+      layout(%layout : !hal.pipeline_layout)[%c0]
+      bindings([
+        %c0 = (%buffer : !hal.buffer)[%c0, %c128]
+      ])
+  // CHECK: %[[EXECUTABLE:.+]] = util.global.load @_executable
+  %executable = util.global.load @_executable : !hal.executable
+  // CHECK: hal.command_buffer.dispatch<%[[NEW_CMD]] : !hal.command_buffer> target(%[[EXECUTABLE]] : !hal.executable)[0] workgroups([%[[COUNT]], %c1, %c1])
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%count, %c1, %c1])
+  // CHECK: hal.command_buffer.execution_barrier<%[[NEW_CMD]] : !hal.command_buffer>
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|CommandRetire") target("CommandIssue|Dispatch") flags("None")
+  // CHECK: hal.command_buffer.finalize<%[[NEW_CMD]] : !hal.command_buffer>
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  //      CHECK: util.global.store %[[NEW_CMD]], @[[CMD_GLOBAL]] : !hal.command_buffer
+  // CHECK-NEXT: util.global.store %[[DEVICE]], @[[DEVICE_KEY]] : !hal.device
+  // CHECK-NEXT: util.global.store %[[BUFFER]], @[[BUFFER_KEY]] : !hal.buffer
+  // CHECK-NEXT: util.global.store %[[COUNT]], @[[COUNT_KEY]] : index
+  // CHECK-NEXT: scf.yield %[[NEW_CMD]]
+  // CHECK-NEXT: }
+
+  // The submission uses whichever command buffer was selected.
+  // CHECK: hal.device.queue.execute<%[[DEVICE]] : !hal.device>
+  // CHECK-SAME: commands([%[[CMD]]])
+  hal.device.queue.execute<%device : !hal.device>
+      affinity(%c-1_i64)
+      wait(%wait_fence)
+      signal(%fence)
+      commands([%cmd])
+  return
+}
+
+// -----
+
+// Tests that recordings interleaved with side-effecting host work are left
+// alone as the work would be skipped when reusing the command buffer.
+
+func.func private @side_effect()
+
+// CHECK-NOT: util.global
+// CHECK-LABEL: @sideEffectingRecording
+func.func @sideEffectingRecording(%device: !hal.device) -> !hal.command_buffer {
+  // CHECK: hal.command_buffer.create
+  // CHECK-SAME: mode("OneShot|AllowInlineExecution")
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode("OneShot|AllowInlineExecution") categories("Transfer|Dispatch") : !hal.command_buffer
+  // CHECK-NEXT: call @side_effect
+  call @side_effect() : () -> ()
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  return %cmd : !hal.command_buffer
+}
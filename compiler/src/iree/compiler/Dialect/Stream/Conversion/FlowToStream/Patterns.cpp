@@ -256,6 +256,98 @@ struct ConvertTensorTraceOp
   }
 };
 
+// Returns the element type collectives use to transfer |type| elements, if
+// supported.
+static std::optional<IREE::Stream::CollectiveElementType>
+getCollectiveElementType(Type type) {
+  using IREE::Stream::CollectiveElementType;
+  if (type.isF16()) return CollectiveElementType::Float16;
+  if (type.isBF16()) return CollectiveElementType::BFloat16;
+  if (type.isF32()) return CollectiveElementType::Float32;
+  if (type.isF64()) return CollectiveElementType::Float64;
+  auto integerType = type.dyn_cast<IntegerType>();
+  if (!integerType) return std::nullopt;
+  bool isUnsigned = integerType.isUnsigned();
+  switch (integerType.getWidth()) {
+    case 8:
+      return isUnsigned ? CollectiveElementType::Uint8
+                        : CollectiveElementType::Sint8;
+    case 16:
+      return isUnsigned ? CollectiveElementType::Uint16
+                        : CollectiveElementType::Sint16;
+    case 32:
+      return isUnsigned ? CollectiveElementType::Uint32
+                        : CollectiveElementType::Sint32;
+    case 64:
+      return isUnsigned ? CollectiveElementType::Uint64
+                        : CollectiveElementType::Sint64;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Replaces the collective |op| on the tensor |source| with a stream collective
+// of |kind| on the default channel writing into a new resource.
+static LogicalResult replaceWithStreamCollective(
+    Operation *op, IREE::Stream::CollectiveKind kind,
+    std::optional<IREE::Stream::CollectiveReductionOp> reductionOp,
+    Value source, Value convertedSource, ConversionPatternRewriter &rewriter) {
+  auto sourceType = source.getType().cast<RankedTensorType>();
+  auto elementType = getCollectiveElementType(sourceType.getElementType());
+  if (!elementType) {
+    return rewriter.notifyMatchFailure(op, "unsupported element type");
+  }
+  auto collectiveAttr = IREE::Stream::CollectiveAttr::get(
+      op->getContext(), kind, reductionOp, *elementType);
+
+  Location loc = op->getLoc();
+  auto affinityAttr = getAffinityFor(op);
+  auto unknownType = rewriter.getType<IREE::Stream::ResourceType>();
+  auto sourceResource = consumeTensorOperand(loc, convertedSource, rewriter);
+  Value targetSize =
+      buildResultSizeOf(loc, op->getResult(0), ValueRange{}, rewriter);
+  Value target = rewriter.create<IREE::Stream::AsyncAllocaOp>(
+      loc, unknownType, targetSize, affinityAttr);
+  Value channel = rewriter.create<IREE::Stream::ChannelDefaultOp>(
+      loc, rewriter.getType<IREE::Stream::ChannelType>(), affinityAttr);
+  Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+  Value elementCount = rewriter.create<arith::ConstantIndexOp>(
+      loc, sourceType.getNumElements());
+  rewriter.replaceOpWithNewOp<IREE::Stream::AsyncCollectiveOp>(
+      op, unknownType, collectiveAttr, target, targetSize, zero, targetSize,
+      targetSize, sourceResource.resource, sourceResource.resourceSize, zero,
+      sourceResource.resourceSize, sourceResource.resourceSize, elementCount,
+      channel, /*param=*/Value{}, affinityAttr);
+  return success();
+}
+
+struct ConvertCollectiveAllReduceOp
+    : public OpConversionPattern<IREE::Flow::CollectiveAllReduceOp> {
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult matchAndRewrite(
+      IREE::Flow::CollectiveAllReduceOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    // The stream reduction enum has an additional `none` value at 0.
+    auto reductionOp = static_cast<IREE::Stream::CollectiveReductionOp>(
+        static_cast<uint32_t>(op.getReductionOp()) + 1);
+    return replaceWithStreamCollective(
+        op, IREE::Stream::CollectiveKind::AllReduce, reductionOp,
+        op.getSource(), adaptor.getSource(), rewriter);
+  }
+};
+
+struct ConvertCollectiveAllGatherOp
+    : public OpConversionPattern<IREE::Flow::CollectiveAllGatherOp> {
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult matchAndRewrite(
+      IREE::Flow::CollectiveAllGatherOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    return replaceWithStreamCollective(
+        op, IREE::Stream::CollectiveKind::AllGather, std::nullopt,
+        op.getSource(), adaptor.getSource(), rewriter);
+  }
+};
+
 struct ConvertDispatchOp : public OpConversionPattern<IREE::Flow::DispatchOp> {
   using OpConversionPattern::OpConversionPattern;
   LogicalResult matchAndRewrite(
@@ -492,6 +584,8 @@ void populateFlowToStreamConversionPatterns(MLIRContext *context,
       ConvertTensorCloneOp, ConvertTensorSliceOp, ConvertTensorUpdateOp,
       ConvertTensorLoadOp, ConvertTensorStoreOp, ConvertTensorTraceOp>(
       typeConverter, context);
+  patterns.insert<ConvertCollectiveAllReduceOp, ConvertCollectiveAllGatherOp>(
+      typeConverter, context);
   patterns.insert<ConvertDispatchOp>(typeConverter, context);
   patterns.insert<ConvertExecutableOp>(typeConverter, context);
   patterns.insert<ConvertReturnOp>(typeConverter, context);
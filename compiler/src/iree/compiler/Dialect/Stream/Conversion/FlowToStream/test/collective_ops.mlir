@@ -0,0 +1,31 @@
+// RUN: iree-opt --split-input-file --iree-stream-conversion %s | FileCheck %s
+
+// CHECK-LABEL: @collectiveAllReduce
+//  CHECK-SAME: (%[[INPUT:.+]]: !stream.resource<*>, %[[INPUT_SIZE:.+]]: index)
+func.func @collectiveAllReduce(%input: tensor<4x8xf32>) -> tensor<4x8xf32> {
+  // CHECK: %[[RESULT_SIZE:.+]] = stream.tensor.sizeof tensor<4x8xf32> : index
+  // CHECK: %[[TARGET:.+]] = stream.async.alloca : !stream.resource<*>{%[[RESULT_SIZE]]}
+  // CHECK: %[[CHANNEL:.+]] = stream.channel.default : !stream.channel
+  // CHECK: %[[RESULT:.+]] = stream.async.collective<all_reduce with sum : f32>[%c32] channel(%[[CHANNEL]])
+  // CHECK-SAME: %[[INPUT]][%c0 to %[[INPUT_SIZE]] for %[[INPUT_SIZE]]],
+  // CHECK-SAME: %[[TARGET]][%c0 to %[[RESULT_SIZE]] for %[[RESULT_SIZE]]]
+  %0 = flow.collective.all_reduce sum, %input : tensor<4x8xf32>
+  // CHECK: return %[[RESULT]], %[[RESULT_SIZE]] : !stream.resource<*>, index
+  return %0 : tensor<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @collectiveAllGather
+//  CHECK-SAME: (%[[INPUT:.+]]: !stream.resource<*>, %[[INPUT_SIZE:.+]]: index)
+func.func @collectiveAllGather(%input: tensor<4x8xi32>) -> tensor<16x8xi32> {
+  // CHECK: %[[RESULT_SIZE:.+]] = stream.tensor.sizeof tensor<16x8xi32> : index
+  // CHECK: %[[TARGET:.+]] = stream.async.alloca : !stream.resource<*>{%[[RESULT_SIZE]]}
+  // CHECK: %[[CHANNEL:.+]] = stream.channel.default : !stream.channel
+  // CHECK: %[[RESULT:.+]] = stream.async.collective<all_gather : si32>[%c32] channel(%[[CHANNEL]])
+  // CHECK-SAME: %[[INPUT]][%c0 to %[[INPUT_SIZE]] for %[[INPUT_SIZE]]],
+  // CHECK-SAME: %[[TARGET]][%c0 to %[[RESULT_SIZE]] for %[[RESULT_SIZE]]]
+  %0 = flow.collective.all_gather %input : tensor<4x8xi32> -> tensor<16x8xi32>
+  // CHECK: return %[[RESULT]], %[[RESULT_SIZE]] : !stream.resource<*>, index
+  return %0 : tensor<16x8xi32>
+}
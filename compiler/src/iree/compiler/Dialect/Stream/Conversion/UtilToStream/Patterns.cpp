@@ -97,6 +97,12 @@ struct GlobalOpExpansion
             : std::nullopt);
     resourceOp.setVisibility(globalOp.getVisibility());
 
+    // Mutable caches marked for in-place updates keep the marker so that
+    // copy-on-write materialization can avoid cloning them.
+    if (auto inPlaceAttr = globalOp->getAttr("stream.in_place")) {
+      resourceOp->setAttr("stream.in_place", inPlaceAttr);
+    }
+
     // NOTE: we ignore noinline here, possibly to our peril. In earlier dialects
     // noinline indicates that the constant value should not be inlined, while
     // here it would be indicating the reference to the constant value should
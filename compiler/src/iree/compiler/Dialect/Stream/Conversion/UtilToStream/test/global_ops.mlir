@@ -84,3 +84,9 @@ func.func @globalStoreFromExternal(%arg0: !hal.buffer_view) {
 //   util.global.store.indirect %1, %0 : tensor<i32> -> !util.ptr<tensor<i32>>
 //   return
 // }
+
+// -----
+
+// CHECK: util.global public mutable @kv_cache {stream.in_place} : !stream.resource<variable>
+// CHECK: util.global public mutable @kv_cache__size : index
+util.global public mutable @kv_cache {stream.in_place} : tensor<4x64xf32>
@@ -13,11 +13,14 @@
 #include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/raw_ostream.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
@@ -539,6 +542,120 @@ static void dumpJSONStructures(const UsageInfo &usageInfo,
   os << "}\n";
 }
 
+//===----------------------------------------------------------------------===//
+// Embedded cost summaries
+//===----------------------------------------------------------------------===//
+
+// Returns an estimate of the arithmetic operations performed by one dispatch
+// of |funcOp| or -1 if unknown. Each op in the body of a linalg op counts once
+// per iteration; other ops (such as LinalgExt ones) are not counted.
+static int64_t estimateDispatchOpCount(mlir::func::FuncOp funcOp) {
+  int64_t opCount = 0;
+  bool isDynamic = false;
+  funcOp.walk([&](linalg::LinalgOp linalgOp) {
+    int64_t iterationCount = 1;
+    for (int64_t range : linalgOp.getStaticLoopRanges()) {
+      if (ShapedType::isDynamic(range)) {
+        isDynamic = true;
+        return;
+      }
+      iterationCount *= range;
+    }
+    int64_t bodyOpCount =
+        llvm::range_size(linalgOp.getBlock()->without_terminator());
+    opCount += iterationCount * bodyOpCount;
+  });
+  return isDynamic ? -1 : opCount;
+}
+
+// Appends |values| joined with |separator| to |str| with `?` for dynamic ones.
+static void appendConstantValues(ValueRange values, StringRef separator,
+                                 SmallString<64> &str) {
+  for (auto value : llvm::enumerate(values)) {
+    if (value.index() > 0) str.append(separator);
+    APInt constantValue;
+    if (matchPattern(value.value(), m_ConstantInt(&constantValue))) {
+      constantValue.toString(str, 10, /*signed=*/true);
+    } else {
+      str.append("?");
+    }
+  }
+}
+
+// Returns a summary of the cost of all |dispatchOps| to an export such as:
+//   dispatches=2; workloads=128x4,64x4; binding-bytes=4096:512;
+//   total-bytes=9216; ops=1048576
+// Unique workloads and binding lengths are listed once. Totals are `?` if any
+// dispatch has a dynamic size.
+static std::string buildExportCostSummary(
+    mlir::func::FuncOp funcOp,
+    ArrayRef<IREE::Stream::CmdDispatchOp> dispatchOps) {
+  llvm::SetVector<std::string> workloads;
+  llvm::SetVector<std::string> bindingLengths;
+  int64_t totalBytes = 0;
+  bool totalBytesDynamic = false;
+  for (auto dispatchOp : dispatchOps) {
+    SmallString<64> workloadStr;
+    appendConstantValues(dispatchOp.getWorkload(), "x", workloadStr);
+    workloads.insert(workloadStr.str().str());
+    SmallString<64> lengthsStr;
+    appendConstantValues(dispatchOp.getResourceLengths(), ":", lengthsStr);
+    bindingLengths.insert(lengthsStr.str().str());
+    for (auto length : dispatchOp.getResourceLengths()) {
+      APInt lengthValue;
+      if (matchPattern(length, m_ConstantInt(&lengthValue))) {
+        totalBytes += lengthValue.getSExtValue();
+      } else {
+        totalBytesDynamic = true;
+      }
+    }
+  }
+
+  std::string summary;
+  llvm::raw_string_ostream os(summary);
+  os << "dispatches=" << dispatchOps.size();
+  os << "; workloads=" << llvm::join(workloads, ",");
+  os << "; binding-bytes=" << llvm::join(bindingLengths, ",");
+  os << "; total-bytes=";
+  if (totalBytesDynamic) {
+    os << "?";
+  } else {
+    os << totalBytes;
+  }
+  os << "; ops=";
+  int64_t opCount = estimateDispatchOpCount(funcOp);
+  if (opCount < 0) {
+    os << "?";
+  } else {
+    os << opCount * static_cast<int64_t>(dispatchOps.size());
+  }
+  return os.str();
+}
+
+// Embeds a cost summary of each dispatched export in the `iree.reflection`
+// dictionary of |moduleOp| keyed by `iree.cost.<executable>::<export>`.
+// The dictionary is carried through to the module attributes of the VM
+// bytecode module so that tools can report it without the source program.
+static void embedCostSummaries(const UsageInfo &usageInfo,
+                               mlir::ModuleOp moduleOp) {
+  NamedAttrList reflectionAttrs;
+  if (auto existingAttrs =
+          moduleOp->getAttrOfType<DictionaryAttr>("iree.reflection")) {
+    reflectionAttrs.append(existingAttrs.getValue());
+  }
+  auto *context = moduleOp.getContext();
+  for (auto &it : usageInfo.exportDispatchOps) {
+    auto entryPoint = it.second.front().getEntryPoint();
+    std::string key = llvm::formatv("iree.cost.{0}::{1}",
+                                    entryPoint.getRootReference().getValue(),
+                                    entryPoint.getLeafReference().getValue());
+    reflectionAttrs.set(
+        StringAttr::get(context, key),
+        StringAttr::get(context, buildExportCostSummary(it.first, it.second)));
+  }
+  moduleOp->setAttr("iree.reflection", reflectionAttrs.getDictionary(context));
+}
+
 //===----------------------------------------------------------------------===//
 // -iree-stream-dump-statistics
 //===----------------------------------------------------------------------===//
@@ -566,9 +683,11 @@ static std::unique_ptr<llvm::raw_fd_ostream> openOutputFile(
 class DumpStatisticsPass : public DumpStatisticsBase<DumpStatisticsPass> {
  public:
   DumpStatisticsPass() = default;
-  DumpStatisticsPass(DumpOutputFormat outputFormat, std::string outputFile) {
+  DumpStatisticsPass(DumpOutputFormat outputFormat, std::string outputFile,
+                     bool embedCostSummary) {
     this->outputFormat = outputFormat;
     this->outputFile = outputFile;
+    this->embedCostSummary = embedCostSummary;
   }
 
   void getDependentDialects(DialectRegistry &registry) const override {
@@ -577,17 +696,20 @@ class DumpStatisticsPass : public DumpStatisticsBase<DumpStatisticsPass> {
   }
 
   void runOnOperation() override {
-    if (outputFormat == DumpOutputFormat::None) return;
-
-    // Open the output file we'll be streaming to.
-    // Since we are processing the entire module at once we overwrite the file.
-    auto os = openOutputFile(outputFile);
+    if (outputFormat == DumpOutputFormat::None && !embedCostSummary) return;
 
     // Walk the module once to accumulate everything we care about.
     auto moduleOp = getOperation();
     UsageInfo usageInfo;
     usageInfo.analyze(moduleOp);
 
+    if (embedCostSummary) embedCostSummaries(usageInfo, moduleOp);
+    if (outputFormat == DumpOutputFormat::None) return;
+
+    // Open the output file we'll be streaming to.
+    // Since we are processing the entire module at once we overwrite the file.
+    auto os = openOutputFile(outputFile);
+
     switch (outputFormat) {
       case DumpOutputFormat::Pretty:
       case DumpOutputFormat::Verbose:
@@ -611,8 +733,10 @@ class DumpStatisticsPass : public DumpStatisticsBase<DumpStatisticsPass> {
 }  // namespace
 
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createDumpStatisticsPass(
-    DumpOutputFormat outputFormat, std::string outputFile) {
-  return std::make_unique<DumpStatisticsPass>(outputFormat, outputFile);
+    DumpOutputFormat outputFormat, std::string outputFile,
+    bool embedCostSummary) {
+  return std::make_unique<DumpStatisticsPass>(outputFormat, outputFile,
+                                              embedCostSummary);
 }
 
 }  // namespace Stream
@@ -15,6 +15,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IndexSet.h"
+#include "llvm/ADT/Sequence.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -63,31 +64,25 @@ static Value packSlicesWithNoAliasing(
   return builder.createOrFold<IREE::Util::AlignOp>(loc, offset, rangeAlignment);
 }
 
-// Packs a set of statically-sized slices by greedy strip packing.
+// A statically-sized slice with its size aligned to the range alignment.
+struct StaticSlice {
+  const Slice *slice = nullptr;
+  int64_t alignedSize = 0;
+};
+
+// Places each of |slices| in the given |order| into the smallest gap between
+// the reservations of already placed slices with intersecting lifetimes.
 //
 // This is the same algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
-// It's not fantastic and can end up with a significant amount of wastage.
-// They do the packing at runtime and as such care more about performance than
-// we do while doing the packing here offline. For this initial version I
-// wanted to ensure we matched apples/apples their implementation.
-//
-// We should use a set of heuristics and pick the smallest one. There are also
-// some really great papers that have approximations (as all of these are -
-// 2D strip packing is NP-hard) such as
-// https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
-// someone with a brain able to parse mathy papers can try implementing.
+// They do the packing at runtime in a fixed order and as such care more about
+// performance than we do while doing the packing here offline.
 //
-// Slice packed offset SSA values will be updated and start at the given
-// |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value packStaticSlicesGreedily(
-    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
-    IndexSet &indexSet, OpBuilder &builder) {
-  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
-  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
-
+// Populates |offsets| (indexed as |slices|) and returns the high-water mark.
+static int64_t packStaticSlicesBestFit(ArrayRef<StaticSlice> slices,
+                                       ArrayRef<unsigned> order,
+                                       int64_t offsetAlignment,
+                                       SmallVectorImpl<int64_t> &offsets) {
   struct Reservation {
     const Slice *slice = nullptr;
     int64_t staticOffset = 0;
@@ -95,14 +90,14 @@ static Value packStaticSlicesGreedily(
   };
   static constexpr int64_t UNASSIGNED = INT64_MAX;
 
+  offsets.assign(slices.size(), 0);
   std::list<Reservation> reservations;
   int64_t highwaterMark = 0;
-  for (auto &slice : slices) {
+  for (unsigned index : order) {
+    const Slice &slice = *slices[index].slice;
+    int64_t alignedSize = slices[index].alignedSize;
     int64_t bestOffset = UNASSIGNED;
     int64_t bestOffsetFit = UNASSIGNED;
-    int64_t staticSize =
-        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
 
     // Iterate through reservations (sorted by ascending offset) and identify
     // gaps in which the slice will fit. To reduce wastage we want to find the
@@ -121,7 +116,7 @@ static Value packStaticSlicesGreedily(
       if (alignedOffset + alignedSize <= reservation.staticOffset &&
           reservation.staticOffset - alignedOffset < bestOffsetFit) {
         bestOffset = alignedOffset;
-        bestOffsetFit = reservation.staticOffset - currentOffset;
+        bestOffsetFit = reservation.staticOffset - alignedOffset;
       }
       currentOffset = std::max(
           currentOffset, reservation.staticOffset + reservation.staticSize);
@@ -141,15 +136,86 @@ static Value packStaticSlicesGreedily(
       ++insertionIt;
     }
     reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+    offsets[index] = bestOffset;
 
     // Update highwater mark indicating how much memory needs to be allocated
     // for the entire slab.
     highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
   }
+  return highwaterMark;
+}
+
+// Packs a set of statically-sized slices by greedy best-fit strip packing.
+//
+// Greedy packing is sensitive to the order in which slices are placed: large
+// slices placed late often can't reuse the gaps left between small ones. As
+// we pack offline we can afford to try a few orderings known to work well and
+// keep the one with the lowest high-water mark. There are also approximations
+// with better bounds (2D strip packing is NP-hard) such as
+// https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
+// could be added as additional candidates.
+//
+// Slice packed offset SSA values will be updated and start at the given
+// |baseOffset|. Returns |baseOffset| + the total size of the allocation
+// aligned to the requirements of |resourceConfig|. The total size alone is
+// returned in |packedSize|.
+static Value packStaticSlicesGreedily(
+    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
+    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
+    IndexSet &indexSet, OpBuilder &builder, int64_t &packedSize) {
+  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+
+  SmallVector<StaticSlice> staticSlices;
+  staticSlices.reserve(slices.size());
+  for (auto &slice : slices) {
+    int64_t staticSize =
+        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
+    staticSlices.push_back(
+        {&slice, IREE::Util::align(staticSize, rangeAlignment)});
+  }
+
+  // Candidate orderings; ties are broken by the earlier candidate so that the
+  // program order (ascending lifetime) is preferred.
+  auto getArea = [&](unsigned i) {
+    const Slice *slice = staticSlices[i].slice;
+    return staticSlices[i].alignedSize *
+           (slice->lifetimeEnd - slice->lifetimeStart + 1);
+  };
+  SmallVector<unsigned> programOrder =
+      llvm::to_vector(llvm::seq<unsigned>(0, staticSlices.size()));
+  SmallVector<unsigned> sizeOrder = programOrder;
+  llvm::stable_sort(sizeOrder, [&](unsigned lhs, unsigned rhs) {
+    return staticSlices[lhs].alignedSize > staticSlices[rhs].alignedSize;
+  });
+  SmallVector<unsigned> areaOrder = programOrder;
+  llvm::stable_sort(areaOrder, [&](unsigned lhs, unsigned rhs) {
+    return getArea(lhs) > getArea(rhs);
+  });
+
+  SmallVector<int64_t> bestOffsets;
+  int64_t highwaterMark = INT64_MAX;
+  for (ArrayRef<unsigned> order : {ArrayRef<unsigned>(programOrder),
+                                   ArrayRef<unsigned>(sizeOrder),
+                                   ArrayRef<unsigned>(areaOrder)}) {
+    SmallVector<int64_t> offsets;
+    int64_t candidateMark = packStaticSlicesBestFit(
+        staticSlices, order, offsetAlignment, offsets);
+    if (candidateMark < highwaterMark) {
+      highwaterMark = candidateMark;
+      bestOffsets = std::move(offsets);
+    }
+  }
+
+  for (auto [staticSlice, offset] :
+       llvm::zip_equal(staticSlices, bestOffsets)) {
+    staticSlice.slice->packedOffset.replaceAllUsesWith(
+        builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
+                                            indexSet.get(offset)));
+  }
 
   highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+  packedSize = highwaterMark;
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
                                              indexSet.get(highwaterMark));
 }
@@ -260,9 +326,8 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       return;
     }
 
-    // NOTE: we could try several algorithms and compute which packs best. For
-    // now we just pack greedily as it's fast and what most existing ML
-    // frameworks do.
+    // NOTE: static slices are packed greedily under a few orderings and the
+    // smallest result is kept; dynamic slices only alias with equal sizes.
     parentOp.walk([&](IREE::Stream::ResourcePackOp packOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig = IREE::Stream::ResourceConfigAttr::lookup(packOp);
@@ -290,8 +355,26 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       // compile time.
       auto offset = packOp.getOffset() ? packOp.getOffset() : indexSet.get(0);
       if (!staticSlices.empty()) {
+        int64_t packedSize = 0;
         offset = packStaticSlicesGreedily(packOp, offset, staticSlices,
-                                          resourceConfig, indexSet, builder);
+                                          resourceConfig, indexSet, builder,
+                                          packedSize);
+
+        // Report the peak memory required compared to not aliasing at all.
+        int64_t unaliasedSize = 0;
+        for (auto &slice : staticSlices) {
+          int64_t staticSize = cast<arith::ConstantIndexOp>(
+                                   slice.dynamicSize.getDefiningOp())
+                                   .value();
+          unaliasedSize += IREE::Util::align(
+              staticSize, resourceConfig.getMinBufferRangeAlignment());
+        }
+        LLVM_DEBUG(llvm::dbgs()
+                   << "packed " << staticSlices.size() << " static slices at "
+                   << packOp.getLoc() << " into " << packedSize
+                   << " bytes (" << unaliasedSize << " without aliasing)\n");
+        peakStaticBytes.updateMax(packedSize);
+        savedStaticBytes += std::max<int64_t>(unaliasedSize - packedSize, 0);
 
         // TODO(benvanik): make this an option; it can be useful for debugging
         // this code.
@@ -12,6 +12,7 @@
 #include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -20,6 +21,7 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
@@ -62,10 +64,89 @@ static bool isSafeToElideCOW(Value operand, IREE::Stream::ResourceType type) {
   return true;
 }
 
+// Unit attribute on util.global ops marking them as mutable caches that are
+// always updated in-place, such as the KV-cache of a decode loop. Loads of
+// these globals that are mutated and stored back skip the copy on write.
+static constexpr char kInPlaceAttrName[] = "stream.in_place";
+
+// Returns the load of an in-place global that |value| was produced by, looking
+// through transfers, or nullptr if it isn't one.
+static IREE::Util::GlobalLoadOpInterface findInPlaceGlobalLoad(Value value) {
+  while (auto transferOp =
+             value.getDefiningOp<IREE::Stream::AsyncTransferOp>()) {
+    value = transferOp.getSource();
+  }
+  auto loadOp = value.getDefiningOp<IREE::Util::GlobalLoadOpInterface>();
+  if (!loadOp) return {};
+  auto *globalOp =
+      SymbolTable::lookupNearestSymbolFrom(loadOp, loadOp.getGlobalAttr());
+  if (!globalOp || !globalOp->hasAttr(kInPlaceAttrName)) return {};
+  return loadOp;
+}
+
+// Returns true if |value| is stored to the global |globalAttr|, looking
+// through transfers.
+static bool isStoredToGlobal(Value value, FlatSymbolRefAttr globalAttr) {
+  for (Operation *user : value.getUsers()) {
+    if (auto storeOp = dyn_cast<IREE::Util::GlobalStoreOpInterface>(user)) {
+      if (storeOp.getGlobalAttr() == globalAttr) return true;
+    } else if (auto transferOp =
+                   dyn_cast<IREE::Stream::AsyncTransferOp>(user)) {
+      if (isStoredToGlobal(transferOp.getResult(), globalAttr)) return true;
+    }
+  }
+  return false;
+}
+
+// Returns the ops in the block of |op| that its operands are transitively
+// produced by.
+static llvm::SmallPtrSet<Operation *, 16> getTransitiveProducers(
+    Operation *op) {
+  llvm::SmallPtrSet<Operation *, 16> producerOps;
+  SmallVector<Value> worklist(op->getOperands());
+  while (!worklist.empty()) {
+    Operation *producerOp = worklist.pop_back_val().getDefiningOp();
+    if (!producerOp || producerOp->getBlock() != op->getBlock()) continue;
+    if (!producerOps.insert(producerOp).second) continue;
+    worklist.append(producerOp->operand_begin(), producerOp->operand_end());
+  }
+  return producerOps;
+}
+
+// Returns true if |operand| of an in-place global loaded by |loadOp| can be
+// mutated by its owner without a copy. The mutated |result| must be stored
+// back to the global; otherwise later loads would observe a value that was
+// never stored. Every other read of the old contents must be a transitive
+// producer of the owner's operands: after this pass execution order is only
+// derived from SSA def-use edges, so a read that merely comes first in the
+// block may still be scheduled after (or concurrently with) the mutation.
+static bool isSafeInPlaceGlobalUpdate(
+    OpOperand &operand, Value result,
+    IREE::Util::GlobalLoadOpInterface loadOp) {
+  if (!isStoredToGlobal(result, loadOp.getGlobalAttr())) return false;
+  Operation *tiedOp = operand.getOwner();
+  auto producerOps = getTransitiveProducers(tiedOp);
+  Operation *consumerOp = tiedOp;
+  Value value = operand.get();
+  while (true) {
+    for (Operation *user : value.getUsers()) {
+      if (user == consumerOp) continue;
+      if (!producerOps.contains(user)) return false;
+    }
+    auto transferOp = value.getDefiningOp<IREE::Stream::AsyncTransferOp>();
+    if (!transferOp) break;
+    consumerOp = transferOp;
+    value = transferOp.getSource();
+  }
+  return true;
+}
+
 // Materializes a copy for a mutated |operand| on |affinity| if required.
+// |result| is the value tied to the operand.
 // If it's determined that eliding the copy is safe it will be omitted.
 // Returns true if the copy was required and materialized.
 static bool materializeOperandCOW(Location loc, OpOperand &operand,
+                                  Value result,
                                   IREE::Stream::AffinityAttr affinity,
                                   OpBuilder &builder) {
   // If we can safely elide the copy early we do so here to avoid adding too
@@ -76,6 +157,17 @@ static bool materializeOperandCOW(Location loc, OpOperand &operand,
   if (!resourceType) return false;
   if (isSafeToElideCOW(operand.get(), resourceType)) return false;
 
+  // Globals marked in-place are updated on their existing storage whenever it
+  // is legal to do so. Warn when it isn't as the copy is likely the entire
+  // cache and the user asked for it to be avoided.
+  if (auto loadOp = findInPlaceGlobalLoad(operand.get())) {
+    if (isSafeInPlaceGlobalUpdate(operand, result, loadOp)) return false;
+    mlir::emitWarning(loc)
+        << "in-place global " << loadOp.getGlobalAttr()
+        << " requires a copy: its contents are read by ops the mutation does "
+           "not depend on or the mutated value is not stored back to it";
+  }
+
   // Materialize a clone operation just for the operand provided.
   auto sizeAwareType = resourceType.cast<IREE::Util::SizeAwareTypeInterface>();
   auto size = sizeAwareType.queryValueSize(loc, operand.get(), builder);
@@ -105,9 +197,10 @@ static bool materializeTiedOpCOW(IREE::Util::TiedOpInterface tiedOp) {
     int64_t operandIdx = tiedOperandIndices[i];
     if (operandIdx == IREE::Util::TiedOpInterface::kUntiedIndex) continue;
     auto &operand = tiedOp->getOpOperand(operandIdx);
-    didChange =
-        materializeOperandCOW(tiedOp.getLoc(), operand, affinity, builder) ||
-        didChange;
+    didChange = materializeOperandCOW(tiedOp.getLoc(), operand,
+                                      tiedOp->getResult(i), affinity,
+                                      builder) ||
+                didChange;
   }
 
   return didChange;
@@ -13,6 +13,8 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IndexSet.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
@@ -85,9 +87,11 @@ struct StorageResource {
 };
 
 // Buckets |slices| into 1+ storage resources based on |resourceConfig|.
+// Storage resources are no larger than |maxStorageSize| unless a single slice
+// exceeds it in which case it is placed in a storage resource of its own.
 static SmallVector<StorageResource, 8> bucketValuesIntoStorageResources(
     ArrayRef<ConstantSlice> slices,
-    IREE::Stream::ResourceConfigAttr resourceConfig) {
+    IREE::Stream::ResourceConfigAttr resourceConfig, uint64_t maxStorageSize) {
   // TODO(benvanik): replace with a better strategy (best-fit, etc).
   SmallVector<StorageResource, 8> storageBuffers;
   storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
@@ -98,7 +102,8 @@ static SmallVector<StorageResource, 8> bucketValuesIntoStorageResources(
     uint64_t unpaddedLength = slice.getStorageSize();
     uint64_t paddedLength = IREE::Util::align(
         unpaddedLength, resourceConfig.getMinBufferRangeAlignment());
-    if (offset + unpaddedLength > resourceConfig.getMaxAllocationSize()) {
+    if (offset + unpaddedLength > maxStorageSize &&
+        !currentBuffer->spans.empty()) {
       // Spilling buffer; make a new one.
       storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
       currentBuffer = &storageBuffers.back();
@@ -187,7 +192,8 @@ static void packStorageResourceData(StorageResource &storageBuffer,
 // locality/lifetime/etc).
 static SmallVector<StorageResource, 8> computePackingMap(
     ArrayRef<ConstantSlice> slices,
-    IREE::Stream::ResourceConfigAttr resourceConfig, MLIRContext *context) {
+    IREE::Stream::ResourceConfigAttr resourceConfig, uint64_t maxStorageSize,
+    MLIRContext *context) {
   // This is literally all my brain has brain for right now. The ideal here is
   // that we have a basic static (and ideally profile-guided) sorting pass
   // that keeps constant values that are accessed sorted together.
@@ -221,7 +227,7 @@ static SmallVector<StorageResource, 8> computePackingMap(
 
   // Build a list of resources and spans (append to current or spill to new).
   auto storageBuffers =
-      bucketValuesIntoStorageResources(slices, resourceConfig);
+      bucketValuesIntoStorageResources(slices, resourceConfig, maxStorageSize);
 
   // Pack each storage resource bucket into a single data blob.
   for (auto &storageBuffer : storageBuffers) {
@@ -240,44 +246,98 @@ struct AllocatedStorage {
   Value resource;
   // Total size, in bytes, of the storage resource.
   Value resourceSize;
+  // Timepoint when the storage is initialized with the constant values.
+  Value timepoint;
 };
 
 struct UploadResult {
-  // Timepoint when the storage is initialized with the constant values.
-  Value timepoint;
-  // Each (resource, resourceSize) allocated.
+  // Each (resource, resourceSize, timepoint) allocated.
   SmallVector<AllocatedStorage> allocations;
 };
 
+// A copy from a mapped staging resource into its final storage resource.
+struct StagingCopy {
+  Location loc;
+  Value source;
+  Value sourceSize;
+  Value sourceOffset;
+  Value target;
+  Value targetSize;
+  Value targetOffset;
+  Value length;
+};
+
+// Returns a timepoint that is reached once all of |timepoints| are.
+static Value joinTimepoints(Location loc, ArrayRef<Value> timepoints,
+                            OpBuilder &builder) {
+  if (timepoints.size() == 1) return timepoints.front();
+  return builder.create<IREE::Stream::TimepointJoinOp>(
+      loc, timepoints.front().getType(), timepoints);
+}
+
+// Issues all of |copies| in a single execution region and returns the
+// timepoint reached when they have completed.
+static Value buildCopyExecution(Location loc,
+                                IREE::Stream::AffinityAttr affinityAttr,
+                                ArrayRef<StagingCopy> copies,
+                                OpBuilder &builder) {
+  SmallVector<Value> capturedResources;
+  SmallVector<Value> capturedResourceSizes;
+  for (auto &copy : copies) {
+    capturedResources.push_back(copy.source);
+    capturedResourceSizes.push_back(copy.sourceSize);
+    capturedResources.push_back(copy.target);
+    capturedResourceSizes.push_back(copy.targetSize);
+  }
+
+  // Create the execution op capturing the resources.
+  auto executeOp = builder.create<IREE::Stream::CmdExecuteOp>(
+      loc, /*awaitTimepoint=*/Value{}, capturedResources,
+      capturedResourceSizes);
+  if (affinityAttr) executeOp.setAffinityAttr(affinityAttr);
+
+  // Map captured resources into the execution region.
+  IRMapping mapping;
+  auto *entryBlock = new Block();
+  executeOp.getBody().push_back(entryBlock);
+  for (auto outerValue : capturedResources) {
+    auto arg =
+        entryBlock->addArgument(outerValue.getType(), outerValue.getLoc());
+    mapping.map(outerValue, arg);
+  }
+
+  // Issue copies. Note that we use the captured resources.
+  auto executionBuilder = OpBuilder::atBlockBegin(entryBlock);
+  for (auto &copy : copies) {
+    executionBuilder.create<IREE::Stream::CmdCopyOp>(
+        copy.loc, mapping.lookup(copy.source), copy.sourceSize,
+        copy.sourceOffset, mapping.lookup(copy.target), copy.targetSize,
+        copy.targetOffset, copy.length);
+  }
+  executionBuilder.create<IREE::Stream::YieldOp>(executeOp.getLoc());
+
+  return executeOp.getResultTimepoint();
+}
+
 // Maps constants as a staging buffer and then issues copy commands.
 // Per-storage resource we map the source rodata, allocate the result, and then
 // issue an async copy from source to result. To avoid a bunch of overhead when
 // there are multiple storage buffers we invert the logic so that we put all the
-// async copies into a single region.
+// async copies into a single region. If |splitUploads| is set each storage
+// resource is instead copied in its own region so that consumers only need to
+// wait for the storage they use.
 static UploadResult buildStagingUpload(
     Location loc, IREE::Stream::AffinityAttr affinityAttr,
     IREE::Stream::ResourceType resourceType,
     ArrayRef<StorageResource> storageResources, ArrayRef<Value> storageBuffers,
-    IndexSet &indexSet, OpBuilder &builder) {
+    bool splitUploads, IndexSet &indexSet, OpBuilder &builder) {
   UploadResult uploadResult;
   auto stagingType = builder.getType<IREE::Stream::ResourceType>(
       IREE::Stream::Lifetime::Staging);
 
   // Map all of the storage data and allocate the result buffers.
   // This will produce a list of copies we should perform from staging->final.
-  struct Copy {
-    Location loc;
-    Value source;
-    Value sourceSize;
-    Value sourceOffset;
-    Value target;
-    Value targetSize;
-    Value targetOffset;
-    Value length;
-  };
-  SmallVector<Copy> copies;
-  SmallVector<Value> capturedResources;
-  SmallVector<Value> capturedResourceSizes;
+  SmallVector<StagingCopy> copies;
   for (auto [storageResource, storageBuffer] :
        llvm::zip_equal(storageResources, storageBuffers)) {
     // Today we assume 1:1 lengths of storage data and uploaded data, but this
@@ -297,10 +357,11 @@ static UploadResult buildStagingUpload(
     uploadResult.allocations.push_back({
         allocOp.getResults().front(),
         allocOp.getStorageSizes().front(),
+        /*timepoint=*/Value{},
     });
 
     // Queue copy for processing below.
-    Copy copy{
+    copies.push_back({
         storageResource.loc,
         mapOp.getResult(),
         mapOp.getResultSize(),
@@ -309,40 +370,21 @@ static UploadResult buildStagingUpload(
         allocOp.getStorageSizes().front(),
         indexSet.get(0),
         totalLength,
-    };
-    capturedResources.push_back(copy.source);
-    capturedResourceSizes.push_back(copy.sourceSize);
-    capturedResources.push_back(copy.target);
-    capturedResourceSizes.push_back(copy.targetSize);
-    copies.push_back(std::move(copy));
-  }
-
-  // Create the execution op capturing the resources.
-  auto executeOp = builder.create<IREE::Stream::CmdExecuteOp>(
-      loc, /*awaitTimepoint=*/Value{}, capturedResources,
-      capturedResourceSizes);
-  if (affinityAttr) executeOp.setAffinityAttr(affinityAttr);
-  uploadResult.timepoint = executeOp.getResultTimepoint();
-
-  // Map captured resources into the execution region.
-  IRMapping mapping;
-  auto *entryBlock = new Block();
-  executeOp.getBody().push_back(entryBlock);
-  for (auto outerValue : capturedResources) {
-    auto arg =
-        entryBlock->addArgument(outerValue.getType(), outerValue.getLoc());
-    mapping.map(outerValue, arg);
+    });
   }
 
-  // Issue copies. Note that we use the captured resources.
-  auto executionBuilder = OpBuilder::atBlockBegin(entryBlock);
-  for (auto &copy : copies) {
-    executionBuilder.create<IREE::Stream::CmdCopyOp>(
-        copy.loc, mapping.lookup(copy.source), copy.sourceSize,
-        copy.sourceOffset, mapping.lookup(copy.target), copy.targetSize,
-        copy.targetOffset, copy.length);
+  if (splitUploads) {
+    for (auto [copy, allocation] :
+         llvm::zip_equal(copies, uploadResult.allocations)) {
+      allocation.timepoint =
+          buildCopyExecution(copy.loc, affinityAttr, copy, builder);
+    }
+  } else {
+    auto timepoint = buildCopyExecution(loc, affinityAttr, copies, builder);
+    for (auto &allocation : uploadResult.allocations) {
+      allocation.timepoint = timepoint;
+    }
   }
-  executionBuilder.create<IREE::Stream::YieldOp>(executeOp.getLoc());
 
   return uploadResult;
 }
@@ -354,7 +396,7 @@ static UploadResult buildTryMapConstantResources(
     Location loc, IREE::Stream::AffinityAttr affinityAttr,
     IREE::Stream::ResourceType resourceType,
     ArrayRef<StorageResource> storageResources, ArrayRef<Value> storageBuffers,
-    IndexSet &indexSet, OpBuilder &builder) {
+    bool splitUploads, IndexSet &indexSet, OpBuilder &builder) {
   // Try mapping each resource. We do this as an all-or-nothing across the
   // storage: if any fails we fallback to the allocation path. This is mostly
   // just to get more predictable behavior in the face of weird platform
@@ -380,8 +422,10 @@ static UploadResult buildTryMapConstantResources(
   }
 
   // If we are able to directly map the resources then we don't need to wait.
+  // Split uploads produce one timepoint per storage resource.
   auto timepointType = builder.getType<IREE::Stream::TimepointType>();
-  resultTypes.push_back(timepointType);
+  size_t timepointCount = splitUploads ? storageResources.size() : 1;
+  resultTypes.append(timepointCount, timepointType);
 
   // if ok: return mapped resources
   // else: allocate and upload
@@ -390,7 +434,8 @@ static UploadResult buildTryMapConstantResources(
       [&](OpBuilder &thenBuilder, Location loc) {
         // Just return the resources + an immediate timepoint.
         SmallVector<Value> ifResults = mappedResources;
-        ifResults.push_back(
+        ifResults.append(
+            timepointCount,
             thenBuilder.create<IREE::Stream::TimepointImmediateOp>(loc));
         thenBuilder.create<scf::YieldOp>(loc, ifResults);
       },
@@ -398,34 +443,41 @@ static UploadResult buildTryMapConstantResources(
         // Fallback to upload and then
         auto stagingResult = buildStagingUpload(
             loc, affinityAttr, resourceType, storageResources, storageBuffers,
-            indexSet, builder);
+            splitUploads, indexSet, elseBuilder);
         SmallVector<Value> ifResults;
         for (auto &allocation : stagingResult.allocations) {
           ifResults.push_back(allocation.resource);
         }
-        ifResults.push_back(stagingResult.timepoint);
+        for (size_t i = 0; i < timepointCount; ++i) {
+          ifResults.push_back(stagingResult.allocations[i].timepoint);
+        }
         elseBuilder.create<scf::YieldOp>(loc, ifResults);
       });
-  auto ifTimepoint = ifOp.getResults().back();
-  auto ifResources = ifOp.getResults().slice(0, ifOp.getResults().size() - 1);
+  auto ifResources = ifOp.getResults().take_front(storageResources.size());
+  auto ifTimepoints = ifOp.getResults().take_back(timepointCount);
 
   // Use the result of either the direct mapping or the staging upload.
   UploadResult uploadResult;
-  uploadResult.timepoint = ifTimepoint;
-  for (auto [storageResource, ifResource] :
-       llvm::zip_equal(storageResources, ifResources)) {
+  for (auto [i, storageResource] : llvm::enumerate(storageResources)) {
     uploadResult.allocations.push_back({
-        ifResource,
+        ifResources[i],
         indexSet.get(storageResource.totalSize),
+        ifTimepoints[splitUploads ? i : 0],
     });
   }
   return uploadResult;
 }
 
-static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
-                            IREE::Stream::Lifetime lifetime,
-                            IREE::Stream::ResourceConfigAttr resourceConfig,
-                            IndexSet &indexSet, OpBuilder &builder) {
+// Materializes the upload of the constants of |constantsOp| with |lifetime|
+// and returns the timepoint reached when they are all available. Each
+// subview produced for a constant is mapped to the timepoint of its storage in
+// |resourceTimepoints|.
+static Value generateUpload(
+    IREE::Stream::ResourceConstantsOp constantsOp,
+    IREE::Stream::Lifetime lifetime,
+    IREE::Stream::ResourceConfigAttr resourceConfig, uint64_t maxStorageSize,
+    bool splitUploads, llvm::MapVector<Value, Value> &resourceTimepoints,
+    IndexSet &indexSet, OpBuilder &builder) {
   // Gather the slices produced by this constant pooling op.
   SmallVector<ConstantSlice> slices;
   slices.reserve(constantsOp.getResults().size());
@@ -443,8 +495,8 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
 
   // Perform the packing of dense values to compute the storage resources we
   // will need and where each value will be placed.
-  auto storageResources =
-      computePackingMap(slices, resourceConfig, constantsOp.getContext());
+  auto storageResources = computePackingMap(
+      slices, resourceConfig, maxStorageSize, constantsOp.getContext());
   if (storageResources.empty()) return nullptr;
 
   // Emit rodata storage for the constant values.
@@ -468,27 +520,93 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
   if (resourceType.getLifetime() == IREE::Stream::Lifetime::Constant) {
     uploadResult = buildTryMapConstantResources(
         constantsOp.getLoc(), constantsOp.getAffinityAttr(), resourceType,
-        storageResources, storageBuffers, indexSet, builder);
+        storageResources, storageBuffers, splitUploads, indexSet, builder);
   } else {
     uploadResult = buildStagingUpload(
         constantsOp.getLoc(), constantsOp.getAffinityAttr(), resourceType,
-        storageResources, storageBuffers, indexSet, builder);
+        storageResources, storageBuffers, splitUploads, indexSet, builder);
   }
 
   // Build subviews for all packed spans back into storage buffers.
+  SetVector<Value> timepoints;
   for (auto [storageResource, allocatedStorage] :
        llvm::zip_equal(storageResources, uploadResult.allocations)) {
+    timepoints.insert(allocatedStorage.timepoint);
     for (auto &span : storageResource.spans) {
       auto loc = span.slice.result.getLoc();
       auto subviewOp = builder.create<IREE::Stream::ResourceSubviewOp>(
           loc, allocatedStorage.resource, allocatedStorage.resourceSize,
           indexSet.get(span.offset), span.slice.resultSize);
       span.slice.result.replaceAllUsesWith(subviewOp.getResult());
+      resourceTimepoints[subviewOp.getResult()] = allocatedStorage.timepoint;
     }
   }
 
   // Join on storage timepoints for our transitive dependencies to await.
-  return uploadResult.timepoint;
+  return joinTimepoints(constantsOp.getLoc(), timepoints.getArrayRef(),
+                        builder);
+}
+
+// Returns the execution region awaiting |use| of a constant upload timepoint
+// either directly or through a join only it awaits.
+static IREE::Stream::CmdExecuteOp getAwaitingExecuteOp(OpOperand &use) {
+  Value awaitTimepoint = use.get();
+  Operation *user = use.getOwner();
+  if (auto joinOp = dyn_cast<IREE::Stream::TimepointJoinOp>(user)) {
+    awaitTimepoint = joinOp.getResultTimepoint();
+    if (!awaitTimepoint.hasOneUse()) return {};
+    user = *awaitTimepoint.getUsers().begin();
+  }
+  auto executeOp = dyn_cast<IREE::Stream::CmdExecuteOp>(user);
+  if (!executeOp || executeOp.getAwaitTimepoint() != awaitTimepoint) return {};
+  return executeOp;
+}
+
+// Changes execution regions awaiting the |uploadTimepoint| of all constants to
+// only await the uploads of the constants they capture. The remaining uploads
+// are joined with the timepoint of the region so that anything ordered after it
+// (such as users of constants escaping the region) still observes them.
+static void narrowUploadAwaits(
+    Value uploadTimepoint,
+    const llvm::MapVector<Value, Value> &resourceTimepoints) {
+  SetVector<Value> allTimepoints;
+  for (auto &it : resourceTimepoints) allTimepoints.insert(it.second);
+  if (allTimepoints.size() <= 1) return;
+
+  for (auto &use : llvm::make_early_inc_range(uploadTimepoint.getUses())) {
+    auto executeOp = getAwaitingExecuteOp(use);
+    if (!executeOp) continue;
+    SetVector<Value> usedTimepoints;
+    for (auto operand : executeOp.getResourceOperands()) {
+      auto it = resourceTimepoints.find(operand);
+      if (it != resourceTimepoints.end()) usedTimepoints.insert(it->second);
+    }
+    if (usedTimepoints.empty() ||
+        usedTimepoints.size() == allTimepoints.size()) {
+      continue;
+    }
+    LLVM_DEBUG(llvm::dbgs() << "narrowing constant upload await at "
+                            << executeOp.getLoc() << " to "
+                            << usedTimepoints.size() << " of "
+                            << allTimepoints.size() << " uploads\n");
+
+    OpBuilder builder(use.getOwner());
+    use.set(joinTimepoints(executeOp.getLoc(), usedTimepoints.getArrayRef(),
+                           builder));
+
+    SmallVector<Value> resultTimepoints;
+    resultTimepoints.push_back(executeOp.getResultTimepoint());
+    for (auto timepoint : allTimepoints) {
+      if (!usedTimepoints.contains(timepoint)) {
+        resultTimepoints.push_back(timepoint);
+      }
+    }
+    builder.setInsertionPointAfter(executeOp);
+    auto joinOp = builder.create<IREE::Stream::TimepointJoinOp>(
+        executeOp.getLoc(), uploadTimepoint.getType(), resultTimepoints);
+    executeOp.getResultTimepoint().replaceAllUsesExcept(
+        joinOp.getResultTimepoint(), joinOp);
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -507,6 +625,13 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
 
 class PackConstantsPass : public PackConstantsBase<PackConstantsPass> {
  public:
+  PackConstantsPass() = default;
+  PackConstantsPass(int64_t uploadChunkSize) {
+    this->uploadChunkSize = uploadChunkSize;
+  }
+  PackConstantsPass(const PackConstantsPass &pass)
+      : PackConstantsPass(pass.uploadChunkSize) {}
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<mlir::func::FuncDialect>();
     registry.insert<mlir::arith::ArithDialect>();
@@ -527,24 +652,43 @@ class PackConstantsPass : public PackConstantsBase<PackConstantsPass> {
       auto resourceConfig =
           IREE::Stream::ResourceConfigAttr::lookup(constantsOp);
 
+      // When chunking, constants are split across storage resources that are
+      // each uploaded on their own.
+      uint64_t maxStorageSize = resourceConfig.getMaxAllocationSize();
+      bool splitUploads = uploadChunkSize > 0;
+      if (splitUploads) {
+        maxStorageSize =
+            std::min(maxStorageSize, static_cast<uint64_t>(uploadChunkSize));
+      }
+
       OpBuilder builder(constantsOp);
       IndexSet indexSet(constantsOp.getLoc(), builder);
       indexSet.populate(constantsOp.getResultSizes());
 
       // Perform upload/processing for immutable and mutable constants.
       SmallVector<Value> timepoints;
-      if (auto timepoint =
-              generateUpload(constantsOp, IREE::Stream::Lifetime::Constant,
-                             resourceConfig, indexSet, builder)) {
+      llvm::MapVector<Value, Value> resourceTimepoints;
+      if (auto timepoint = generateUpload(
+              constantsOp, IREE::Stream::Lifetime::Constant, resourceConfig,
+              maxStorageSize, splitUploads, resourceTimepoints, indexSet,
+              builder)) {
         timepoints.push_back(timepoint);
       }
-      if (auto timepoint =
-              generateUpload(constantsOp, IREE::Stream::Lifetime::Variable,
-                             resourceConfig, indexSet, builder)) {
+      if (auto timepoint = generateUpload(
+              constantsOp, IREE::Stream::Lifetime::Variable, resourceConfig,
+              maxStorageSize, splitUploads, resourceTimepoints, indexSet,
+              builder)) {
         timepoints.push_back(timepoint);
       }
       if (timepoints.empty()) return;
 
+      // Execution regions using only some of the split uploads can start as
+      // soon as those are ready.
+      if (splitUploads) {
+        narrowUploadAwaits(constantsOp.getResultTimepoint(),
+                           resourceTimepoints);
+      }
+
       // Join on storage timepoints for our transitive dependencies to await.
       // We could do this at a finer granularity if we were to split the
       // constants op into multiple units earlier on.
@@ -564,8 +708,9 @@ class PackConstantsPass : public PackConstantsBase<PackConstantsPass> {
 
 }  // namespace
 
-std::unique_ptr<InterfacePass<CallableOpInterface>> createPackConstantsPass() {
-  return std::make_unique<PackConstantsPass>();
+std::unique_ptr<InterfacePass<CallableOpInterface>> createPackConstantsPass(
+    int64_t uploadChunkSize) {
+  return std::make_unique<PackConstantsPass>(uploadChunkSize);
 }
 
 }  // namespace Stream
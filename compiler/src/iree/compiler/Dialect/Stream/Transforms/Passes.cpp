@@ -149,6 +149,16 @@ void buildStreamAsyncPassPipeline(OpPassManager &passManager,
   // Stream formation and scheduling
   //----------------------------------------------------------------------------
 
+  // Place consecutive dispatches on separate queues so that the stages of
+  // independent invocations can execute concurrently. Values crossing stages
+  // become timepoint-ordered dependencies between execution regions.
+  if (transformOptions.pipelineStages > 1) {
+    FunctionLikeNest(passManager).addPass([&]() {
+      return IREE::Stream::createPipelineStagesPass(
+          transformOptions.pipelineStages);
+    });
+  }
+
   FunctionLikeNest(passManager)
       // Combine async work into execution regions.
       .addPass(IREE::Stream::createScheduleExecutionPass)
@@ -183,7 +193,10 @@ void buildStreamCmdPassPipeline(OpPassManager &passManager,
       // Allocate backing storage for fused constant resources.
       // This expands packed constants into explicit forms with partitioned
       // storage buffers and upload logic.
-      .addPass(IREE::Stream::createPackConstantsPass)
+      .addPass([&]() {
+        return IREE::Stream::createPackConstantsPass(
+            transformOptions.constantUploadChunkSize);
+      })
 
       // Pack fused allocations based on lifetime.
       .addPass(IREE::Stream::createPackAllocationsPass)
@@ -308,10 +321,12 @@ void buildStreamTransformPassPipeline(
   // Dump statistics before the deeper optimizations happen.
   // Optimizations such as dispatch operand fusion remove information we can use
   // to determine memory usage by dispatches.
-  if (transformOptions.dumpStatisticsFormat != DumpOutputFormat::None) {
+  if (transformOptions.dumpStatisticsFormat != DumpOutputFormat::None ||
+      transformOptions.embedCostSummary) {
     passManager.addPass(IREE::Stream::createDumpStatisticsPass(
         transformOptions.dumpStatisticsFormat,
-        transformOptions.dumpStatisticsFile));
+        transformOptions.dumpStatisticsFile,
+        transformOptions.embedCostSummary));
   }
 
   //----------------------------------------------------------------------------
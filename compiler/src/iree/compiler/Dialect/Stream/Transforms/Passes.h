@@ -55,6 +55,29 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
           "File path to write to; or `` for stderr or `-` for stdout."),
       llvm::cl::init(""),
   };
+  Option<bool> embedCostSummary{
+      *this,
+      "embed-cost-summary",
+      llvm::cl::desc("Embeds a summary of the dispatch workloads, binding "
+                     "sizes and estimated operation counts of each executable "
+                     "export in the module reflection attributes."),
+      llvm::cl::init(false),
+  };
+  Option<int> pipelineStages{
+      *this,
+      "pipeline-stages",
+      llvm::cl::desc("Splits the dispatches of entry points into the given "
+                     "number of stages executing on separate queues."),
+      llvm::cl::init(1),
+  };
+  Option<int64_t> constantUploadChunkSize{
+      *this,
+      "constant-upload-chunk-size",
+      llvm::cl::desc("Uploads constants in chunks of at most the given number "
+                     "of bytes such that execution can begin once the chunks "
+                     "it uses are ready; 0 uploads constants together."),
+      llvm::cl::init(0),
+  };
 };
 
 // Adds a set of passes to the given pass manager that run the required flow
@@ -119,6 +142,8 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createRefineUsagePass();
 // Stream formation and scheduling
 //===----------------------------------------------------------------------===//
 
+std::unique_ptr<InterfacePass<CallableOpInterface>> createPipelineStagesPass(
+    int64_t stageCount = 1);
 std::unique_ptr<InterfacePass<CallableOpInterface>>
 createScheduleExecutionPass();
 std::unique_ptr<InterfacePass<CallableOpInterface>>
@@ -134,7 +159,8 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createElideTimepointsPass();
 std::unique_ptr<InterfacePass<CallableOpInterface>>
 createScheduleAllocationPass();
 
-std::unique_ptr<InterfacePass<CallableOpInterface>> createPackConstantsPass();
+std::unique_ptr<InterfacePass<CallableOpInterface>> createPackConstantsPass(
+    int64_t uploadChunkSize = 0);
 std::unique_ptr<InterfacePass<CallableOpInterface>> createPackAllocationsPass();
 std::unique_ptr<InterfacePass<CallableOpInterface>> createLayoutSlicesPass();
 
@@ -164,7 +190,7 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createPackDispatchOperandsPass();
 
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createDumpStatisticsPass(
     DumpOutputFormat outputFormat = DumpOutputFormat::Pretty,
-    std::string outputFile = "");
+    std::string outputFile = "", bool embedCostSummary = false);
 
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createVerifyInputPass();
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
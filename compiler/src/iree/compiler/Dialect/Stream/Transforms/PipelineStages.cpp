@@ -0,0 +1,98 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Stream/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-stream-pipeline-stages"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Stream {
+namespace {
+
+// Queue affinity masks are 64 bits wide.
+static constexpr int64_t kMaxStageCount = 64;
+
+// Splits the dispatches in |block| into |stageCount| contiguous stages of
+// roughly equal length and pins each stage to its own queue.
+//
+// Only dispatches are assigned: other streamable ops (splats, copies, etc)
+// are unconstrained and get partitioned along with their consumers. Values
+// produced in one stage and consumed in another end up crossing execution
+// regions and are ordered by timepoints, which lets the stages of independent
+// invocations run concurrently on their queues.
+static void assignStages(Block *block, int64_t stageCount) {
+  SmallVector<IREE::Stream::AsyncDispatchOp> dispatchOps;
+  for (auto dispatchOp : block->getOps<IREE::Stream::AsyncDispatchOp>()) {
+    // Don't override user placement; mixing the two would be surprising.
+    if (dispatchOp.getAffinity()) return;
+    dispatchOps.push_back(dispatchOp);
+  }
+  if (dispatchOps.size() < 2) return;
+
+  // Stages are balanced on the number of dispatches as their costs are not
+  // known at this level.
+  auto *context = block->getParentOp()->getContext();
+  for (auto [i, dispatchOp] : llvm::enumerate(dispatchOps)) {
+    int64_t stage = i * stageCount / dispatchOps.size();
+    LLVM_DEBUG(llvm::dbgs() << "assigning " << dispatchOp.getEntryPoint()
+                            << " to stage " << stage << "\n");
+    dispatchOp.setAffinityAttr(
+        IREE::HAL::AffinityQueueAttr::get(context, 1ull << stage));
+  }
+}
+
+class PipelineStagesPass : public PipelineStagesBase<PipelineStagesPass> {
+ public:
+  PipelineStagesPass() = default;
+  PipelineStagesPass(int64_t stageCount) { this->stageCount = stageCount; }
+  PipelineStagesPass(const PipelineStagesPass &pass)
+      : PipelineStagesPass(pass.stageCount) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::HAL::HALDialect>();
+    registry.insert<IREE::Stream::StreamDialect>();
+  }
+
+  void runOnOperation() override {
+    if (stageCount <= 1) return;
+    if (stageCount > kMaxStageCount) {
+      getOperation()->emitError()
+          << "at most " << kMaxStageCount << " pipeline stages are supported";
+      return signalPassFailure();
+    }
+
+    // Only entry points are pipelined: initializers run once and internal
+    // functions execute within the stages of their callers.
+    auto funcOp = dyn_cast<func::FuncOp>(getOperation().getOperation());
+    if (!funcOp || funcOp.isPrivate() || funcOp.isExternal()) return;
+    for (auto &block : funcOp.getBody()) {
+      assignStages(&block, stageCount);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<InterfacePass<CallableOpInterface>> createPipelineStagesPass(
+    int64_t stageCount) {
+  return std::make_unique<PipelineStagesPass>(stageCount);
+}
+
+}  // namespace Stream
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
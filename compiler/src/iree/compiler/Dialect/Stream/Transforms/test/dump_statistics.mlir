@@ -1,5 +1,6 @@
 // RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-stream-dump-statistics{output-format=pretty})" %s 2>&1 | FileCheck %s --check-prefix=CHECK-PRETTY
 // RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-stream-dump-statistics{output-format=csv})" %s 2>&1 | FileCheck %s --check-prefix=CHECK-CSV
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-stream-dump-statistics{output-format=csv embed-cost-summary=true})" %s 2>/dev/null | FileCheck %s --check-prefix=CHECK-COST
 
 // CHECK-PRETTY: Aggregate Statistics
 // CHECK-PRETTY:   Constants: 1, 0 B
@@ -20,6 +21,10 @@
 // CHECK-CSV: 0,"copy",,192,,,,
 // CHECK-CSV: 0,"dispatch","@func_a_ex_0::@dispatch_0",,4,"4;1;1",0,3
 
+// CHECK-COST: module attributes {iree.reflection = {
+// CHECK-COST-SAME: "iree.cost.func_a_ex_0::dispatch_0" = "dispatches=2; workloads=4x1x1; binding-bytes=16:16:16; total-bytes=96; ops=?"
+// CHECK-COST-SAME: "iree.cost.func_a_ex_1::dispatch_1" = "dispatches=1; workloads=4x1x1; binding-bytes=16:16:16; total-bytes=48; ops=?"
+
 util.global private mutable @_constant__timepoint = #stream.timepoint<immediate>
 util.global private @_constant : !stream.resource<constant>
 util.initializer {
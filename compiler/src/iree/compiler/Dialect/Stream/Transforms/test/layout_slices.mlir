@@ -29,6 +29,36 @@ func.func @layoutStatic() -> (index, index, index, index, index, index, index)
 
 // -----
 
+#layoutStaticOrderConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Tests that slices are placed largest first when that packs tighter than the
+// program order (which would need 112 + 208 + 304 = 624 bytes).
+
+// CHECK-LABEL: @layoutStaticLargestFirst
+func.func @layoutStaticLargestFirst() -> (index, index, index, index)
+    attributes {stream.resources = #layoutStaticOrderConfig} {
+  %c100 = arith.constant 100 : index
+  %c200 = arith.constant 200 : index
+  %c300 = arith.constant 300 : index
+  %t:4 = stream.resource.pack slices({
+    [0, 1] = %c100,  // +0 (reuse [2, 3])
+    [1, 2] = %c200,  // +304 (after 300 align 16)
+    [2, 3] = %c300,  // +0
+  }) : index
+  // 304 + 208 = 512 total bytes required
+  // CHECK: return %c512
+  // CHECK-SAME: %c0, %c304, %c0
+  return %t#0, %t#1, %t#2, %t#3 : index, index, index, index
+}
+
+// -----
+
 #layoutDynamicConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
   min_buffer_offset_alignment = 16,
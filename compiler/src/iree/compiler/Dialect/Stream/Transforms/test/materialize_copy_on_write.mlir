@@ -1,4 +1,4 @@
-// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(func.func(iree-stream-materialize-copy-on-write))' %s | FileCheck %s
+// RUN: iree-opt --split-input-file --verify-diagnostics --pass-pipeline='builtin.module(func.func(iree-stream-materialize-copy-on-write))' %s | FileCheck %s
 
 // Tests that block arguments (including function arguments) are always cloned.
 // Until a whole-program analysis runs we don't know their semantics.
@@ -150,3 +150,89 @@ func.func @blockArgMove(%cond: i1, %size: index) -> (!stream.resource<*>, !strea
 ^bb2(%bb2_0: !stream.resource<*>, %bb2_1: !stream.resource<*>):
   return %bb2_0, %bb2_1 : !stream.resource<*>, !stream.resource<*>
 }
+
+// -----
+
+// Tests that globals marked in-place are updated without a copy when the old
+// contents are only read by ops the update depends on and the result is stored
+// back.
+
+util.global private mutable @kvCache {stream.in_place} : !stream.resource<variable>
+
+// CHECK-LABEL: @inPlaceGlobalUpdate
+//  CHECK-SAME: (%[[UPDATE_SIZE:.+]]: index, %[[SIZE:.+]]: index, %[[OFFSET:.+]]: index)
+func.func @inPlaceGlobalUpdate(%update_size: index, %size: index, %offset: index) -> !stream.resource<*> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %end = arith.addi %offset, %update_size : index
+  // CHECK: %[[CACHE:.+]] = util.global.load @kvCache
+  %cache = util.global.load @kvCache : !stream.resource<variable>
+  // CHECK: %[[CACHE_T:.+]] = stream.async.transfer %[[CACHE]]
+  %cache_t = stream.async.transfer %cache : !stream.resource<variable>{%size} -> !stream.resource<*>{%size}
+  // CHECK: %[[READ:.+]] = stream.async.dispatch @ex::@attention{{.+}}(%[[CACHE_T]]
+  %read = stream.async.dispatch @ex::@attention[%c1, %c1, %c1](%cache_t[%c0 to %size for %size]) : (!stream.resource<*>{%size}) -> !stream.resource<*>{%size}
+  // CHECK: %[[UPDATE:.+]] = stream.async.dispatch @ex::@project{{.+}}(%[[READ]]
+  %update = stream.async.dispatch @ex::@project[%c1, %c1, %c1](%read[%c0 to %size for %size]) : (!stream.resource<*>{%size}) -> !stream.resource<*>{%update_size}
+  // CHECK-NOT: stream.async.clone
+  // CHECK: %[[UPDATED:.+]] = stream.async.update %[[UPDATE]], %[[CACHE_T]]
+  %updated = stream.async.update %update, %cache_t[%offset to %end] : !stream.resource<*>{%update_size} -> %cache_t as !stream.resource<*>{%size}
+  // CHECK: %[[UPDATED_T:.+]] = stream.async.transfer %[[UPDATED]]
+  %updated_t = stream.async.transfer %updated : !stream.resource<*>{%size} -> !stream.resource<variable>{%size}
+  // CHECK: util.global.store %[[UPDATED_T]], @kvCache
+  util.global.store %updated_t, @kvCache : !stream.resource<variable>
+  // CHECK: return %[[READ]]
+  return %read : !stream.resource<*>
+}
+
+// -----
+
+// Tests that globals marked in-place are still copied when the old contents
+// are read before the update by an op the update doesn't depend on. Nothing
+// orders the two once the block order is dropped during scheduling.
+
+util.global private mutable @kvCacheIndependentRead {stream.in_place} : !stream.resource<variable>
+
+// CHECK-LABEL: @inPlaceGlobalIndependentRead
+func.func @inPlaceGlobalIndependentRead(%update: !stream.resource<*>, %update_size: index, %size: index, %offset: index) -> !stream.resource<*> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %end = arith.addi %offset, %update_size : index
+  %cache = util.global.load @kvCacheIndependentRead : !stream.resource<variable>
+  // CHECK: %[[CACHE_T:.+]] = stream.async.transfer
+  %cache_t = stream.async.transfer %cache : !stream.resource<variable>{%size} -> !stream.resource<*>{%size}
+  // CHECK: stream.async.dispatch @ex::@attention{{.+}}(%[[CACHE_T]]
+  %read = stream.async.dispatch @ex::@attention[%c1, %c1, %c1](%cache_t[%c0 to %size for %size]) : (!stream.resource<*>{%size}) -> !stream.resource<*>{%size}
+  // CHECK: %[[CLONE:.+]] = stream.async.clone %[[CACHE_T]]
+  // CHECK: stream.async.update %{{.+}}, %[[CLONE]]
+  // expected-warning @+1 {{in-place global @kvCacheIndependentRead requires a copy}}
+  %updated = stream.async.update %update, %cache_t[%offset to %end] : !stream.resource<*>{%update_size} -> %cache_t as !stream.resource<*>{%size}
+  %updated_t = stream.async.transfer %updated : !stream.resource<*>{%size} -> !stream.resource<variable>{%size}
+  util.global.store %updated_t, @kvCacheIndependentRead : !stream.resource<variable>
+  return %read : !stream.resource<*>
+}
+
+// -----
+
+// Tests that globals marked in-place are still copied when the old contents
+// are read after the update and that a warning is emitted.
+
+util.global private mutable @kvCacheReadAfter {stream.in_place} : !stream.resource<variable>
+
+// CHECK-LABEL: @inPlaceGlobalReadAfterUpdate
+func.func @inPlaceGlobalReadAfterUpdate(%update: !stream.resource<*>, %update_size: index, %size: index, %offset: index) -> !stream.resource<*> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %end = arith.addi %offset, %update_size : index
+  %cache = util.global.load @kvCacheReadAfter : !stream.resource<variable>
+  // CHECK: %[[CACHE_T:.+]] = stream.async.transfer
+  %cache_t = stream.async.transfer %cache : !stream.resource<variable>{%size} -> !stream.resource<*>{%size}
+  // CHECK: %[[CLONE:.+]] = stream.async.clone %[[CACHE_T]]
+  // CHECK: %[[UPDATED:.+]] = stream.async.update %{{.+}}, %[[CLONE]]
+  // expected-warning @+1 {{in-place global @kvCacheReadAfter requires a copy}}
+  %updated = stream.async.update %update, %cache_t[%offset to %end] : !stream.resource<*>{%update_size} -> %cache_t as !stream.resource<*>{%size}
+  %updated_t = stream.async.transfer %updated : !stream.resource<*>{%size} -> !stream.resource<variable>{%size}
+  util.global.store %updated_t, @kvCacheReadAfter : !stream.resource<variable>
+  // CHECK: stream.async.dispatch @ex::@attention{{.+}}(%[[CACHE_T]]
+  %read = stream.async.dispatch @ex::@attention[%c1, %c1, %c1](%cache_t[%c0 to %size for %size]) : (!stream.resource<*>{%size}) -> !stream.resource<*>{%size}
+  return %read : !stream.resource<*>
+}
@@ -0,0 +1,48 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(func.func(iree-stream-pack-constants{upload-chunk-size=64}))' %s | FileCheck %s
+
+// Tests that constants larger than the upload chunk size are uploaded in
+// independent chunks and that execution only waits for the chunks it uses.
+// Constants escaping through the execution timepoint must still be awaited by
+// anything ordered after it.
+
+// CHECK-LABEL: @splitUploads
+func.func @splitUploads(%target: !stream.resource<transient>) -> (!stream.resource<constant>, !stream.timepoint) {
+  %c0 = arith.constant 0 : index
+  %c64 = arith.constant 64 : index
+
+  // CHECK: %[[RODATA0:.+]] = util.buffer.constant {{.+}} = #composite_of_64b
+  // CHECK: %[[RODATA1:.+]] = util.buffer.constant {{.+}} = #composite_of_64b1
+  %0:3 = stream.resource.constants :
+    !stream.resource<constant>{%c64} = dense<1> : tensor<16xi32>,
+    !stream.resource<constant>{%c64} = dense<2> : tensor<16xi32>
+    => !stream.timepoint
+
+  // Each chunk produces its own timepoint.
+  //      CHECK: %[[IF:.+]]:4 = scf.if {{.+}} -> (!stream.resource<constant>, !stream.resource<constant>, !stream.timepoint, !stream.timepoint) {
+  // CHECK-NEXT:   %[[IMMEDIATE:.+]] = stream.timepoint.immediate => !stream.timepoint
+  // CHECK-NEXT:   scf.yield {{.+}}, {{.+}}, %[[IMMEDIATE]], %[[IMMEDIATE]]
+  // CHECK-NEXT: } else {
+  //      CHECK:   %[[ALLOC0:.+]] = stream.resource.alloc
+  //      CHECK:   %[[ALLOC1:.+]] = stream.resource.alloc
+  //      CHECK:   %[[UPLOAD0:.+]] = stream.cmd.execute
+  // CHECK-NEXT:     stream.cmd.copy
+  // CHECK-NEXT:   } => !stream.timepoint
+  //      CHECK:   %[[UPLOAD1:.+]] = stream.cmd.execute
+  // CHECK-NEXT:     stream.cmd.copy
+  // CHECK-NEXT:   } => !stream.timepoint
+  //      CHECK:   scf.yield %[[ALLOC0]], %[[ALLOC1]], %[[UPLOAD0]], %[[UPLOAD1]]
+
+  // CHECK: %[[CST0:.+]] = stream.resource.subview %[[IF]]#0
+  // CHECK: %[[CST1:.+]] = stream.resource.subview %[[IF]]#1
+
+  // Execution only waits for the chunk containing the constant it uses.
+  // CHECK: %[[EXEC:.+]] = stream.cmd.execute await(%[[IF]]#2) => with(%[[CST0]] as
+  %1 = stream.cmd.execute await(%0#2) => with(%0#0 as %arg0: !stream.resource<constant>{%c64}, %target as %arg1: !stream.resource<transient>{%c64}) {
+    stream.cmd.copy %arg0[%c0], %arg1[%c0], %c64 : !stream.resource<constant>{%c64} -> !stream.resource<transient>{%c64}
+  } => !stream.timepoint
+
+  // The other chunk is joined with the execution for the escaping constant.
+  // CHECK: %[[READY:.+]] = stream.timepoint.join max(%[[EXEC]], %[[IF]]#3)
+  // CHECK: return %[[CST1]], %[[READY]]
+  return %0#1, %1 : !stream.resource<constant>, !stream.timepoint
+}
@@ -0,0 +1,51 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-stream-pipeline-stages{stage-count=2}))" %s | FileCheck %s
+
+// Tests that consecutive dispatches are split into stages on their own queues.
+
+// CHECK-LABEL: @twoStages
+func.func @twoStages(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  // CHECK: stream.async.dispatch on(#hal.affinity.queue<[0]>) @ex::@dispatch_0
+  %0 = stream.async.dispatch @ex::@dispatch_0[%c1](%arg0[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}) -> !stream.resource<transient>{%c20}
+  // CHECK: stream.async.dispatch on(#hal.affinity.queue<[0]>) @ex::@dispatch_1
+  %1 = stream.async.dispatch @ex::@dispatch_1[%c1](%0[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}) -> !stream.resource<transient>{%c20}
+  // CHECK: stream.async.dispatch on(#hal.affinity.queue<[1]>) @ex::@dispatch_2
+  %2 = stream.async.dispatch @ex::@dispatch_2[%c1](%1[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}) -> !stream.resource<transient>{%c20}
+  // CHECK: stream.async.dispatch on(#hal.affinity.queue<[1]>) @ex::@dispatch_3
+  %3 = stream.async.dispatch @ex::@dispatch_3[%c1](%2[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+  return %3 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that user-specified placement is preserved.
+
+// CHECK-LABEL: @userAffinity
+func.func @userAffinity(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  // CHECK: stream.async.dispatch @ex::@dispatch_0
+  %0 = stream.async.dispatch @ex::@dispatch_0[%c1](%arg0[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}) -> !stream.resource<transient>{%c20}
+  // CHECK: stream.async.dispatch on(#hal.affinity.queue<[2]>) @ex::@dispatch_1
+  %1 = stream.async.dispatch on(#hal.affinity.queue<[2]>) @ex::@dispatch_1[%c1](%0[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+  return %1 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that internal functions are left to execute within their callers.
+
+// CHECK-LABEL: @internal
+func.func private @internal(%arg0: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  // CHECK: stream.async.dispatch @ex::@dispatch_0
+  %0 = stream.async.dispatch @ex::@dispatch_0[%c1](%arg0[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}) -> !stream.resource<transient>{%c20}
+  // CHECK: stream.async.dispatch @ex::@dispatch_1
+  %1 = stream.async.dispatch @ex::@dispatch_1[%c1](%0[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+  return %1 : !stream.resource<external>
+}
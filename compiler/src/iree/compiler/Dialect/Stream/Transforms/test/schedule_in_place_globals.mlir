@@ -0,0 +1,34 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-stream-materialize-copy-on-write, iree-stream-schedule-execution, iree-stream-schedule-concurrency))" %s | FileCheck %s
+
+// Tests that an in-place global update without a copy stays ordered after the
+// read of the old contents once scheduled. Only the SSA edges from the read to
+// the update order the two: they end up in the same execution region and are
+// never made concurrent.
+
+util.global private mutable @kvCache {stream.in_place} : !stream.resource<variable>
+
+// CHECK-LABEL: @inPlaceGlobalUpdate
+func.func @inPlaceGlobalUpdate(%update_size: index, %size: index, %offset: index) -> !stream.resource<*> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %end = arith.addi %offset, %update_size : index
+  // CHECK: util.global.load @kvCache
+  %cache = util.global.load @kvCache : !stream.resource<variable>
+  %cache_t = stream.async.transfer %cache : !stream.resource<variable>{%size} -> !stream.resource<*>{%size}
+  // CHECK-NOT: stream.async.clone
+  // CHECK-NOT: stream.async.concurrent
+  // CHECK: stream.async.execute
+  // CHECK-NOT: stream.async.concurrent
+  // CHECK: %[[READ:.+]] = stream.async.dispatch @ex::@attention
+  %read = stream.async.dispatch @ex::@attention[%c1, %c1, %c1](%cache_t[%c0 to %size for %size]) : (!stream.resource<*>{%size}) -> !stream.resource<*>{%size}
+  // CHECK-NOT: stream.async.concurrent
+  // CHECK: %[[UPDATE:.+]] = stream.async.dispatch @ex::@project{{.+}}(%[[READ]]
+  %update = stream.async.dispatch @ex::@project[%c1, %c1, %c1](%read[%c0 to %size for %size]) : (!stream.resource<*>{%size}) -> !stream.resource<*>{%update_size}
+  // CHECK-NOT: stream.async.concurrent
+  // CHECK: stream.async.update %[[UPDATE]]
+  %updated = stream.async.update %update, %cache_t[%offset to %end] : !stream.resource<*>{%update_size} -> %cache_t as !stream.resource<*>{%size}
+  %updated_t = stream.async.transfer %updated : !stream.resource<*>{%size} -> !stream.resource<variable>{%size}
+  // CHECK: util.global.store {{.+}}, @kvCache
+  util.global.store %updated_t, @kvCache : !stream.resource<variable>
+  return %read : !stream.resource<*>
+}
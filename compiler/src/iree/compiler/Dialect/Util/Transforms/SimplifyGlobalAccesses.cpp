@@ -12,8 +12,14 @@
 #include "iree/compiler/Dialect/Util/IR/UtilTraits.h"
 #include "iree/compiler/Dialect/Util/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Util/Transforms/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassRegistry.h"
 
@@ -230,6 +236,197 @@ static bool rearrangeBlockGlobalAccesses(
 
 namespace {
 
+// A natural loop in the CFG of a region.
+struct Loop {
+  // The single block dominating all others in the loop.
+  Block *header = nullptr;
+  // All blocks in the loop including the header and nested loops.
+  SetVector<Block *> blocks;
+};
+
+}  // namespace
+
+// Finds all natural loops in |region|. Outer loops are ordered before the
+// loops nested within them.
+static SmallVector<Loop> findLoops(Region &region, DominanceInfo &domInfo) {
+  llvm::MapVector<Block *, Loop> loops;
+  for (auto &block : region) {
+    if (!domInfo.isReachableFromEntry(&block)) continue;
+    for (auto *successor : block.getSuccessors()) {
+      if (!domInfo.dominates(successor, &block)) continue;
+      // Back edge: everything reaching |block| without passing through the
+      // header is part of the loop.
+      auto &loop = loops[successor];
+      loop.header = successor;
+      loop.blocks.insert(successor);
+      SmallVector<Block *> worklist = {&block};
+      while (!worklist.empty()) {
+        auto *loopBlock = worklist.pop_back_val();
+        if (!domInfo.isReachableFromEntry(loopBlock) ||
+            !loop.blocks.insert(loopBlock)) {
+          continue;
+        }
+        llvm::append_range(worklist, loopBlock->getPredecessors());
+      }
+    }
+  }
+  SmallVector<Loop> result;
+  for (auto &it : loops) result.push_back(std::move(it.second));
+  llvm::stable_sort(result, [](const Loop &lhs, const Loop &rhs) {
+    return lhs.blocks.size() > rhs.blocks.size();
+  });
+  return result;
+}
+
+// Promotes the mutable globals accessed within |loop| to SSA values carried
+// across iterations as block arguments. Promoted globals are loaded once
+// before entering the loop and stored back on each exit instead of being
+// accessed on every iteration.
+//
+// The loop must have a single entry edge and branch to exit blocks that are
+// only reachable from the loop so that there's a place to put the loads and
+// stores. Calls and yields may observe globals and prevent all promotion.
+// Globals accessed from within nested regions are not promoted.
+//
+// Returns true if any global was promoted.
+static bool promoteLoopGlobals(Loop &loop,
+                               DenseSet<StringRef> &immutableGlobals) {
+  BlockOperand *entryEdge = nullptr;
+  for (auto &blockOperand : loop.header->getUses()) {
+    if (loop.blocks.contains(blockOperand.getOwner()->getBlock())) continue;
+    if (entryEdge) return false;  // multiple entries
+    entryEdge = &blockOperand;
+  }
+  if (!entryEdge || !isa<BranchOpInterface>(entryEdge->getOwner())) {
+    return false;
+  }
+  for (auto *block : loop.blocks) {
+    if (!isa<BranchOpInterface>(block->getTerminator())) return false;
+    for (auto *successor : block->getSuccessors()) {
+      if (!loop.blocks.contains(successor) &&
+          !llvm::hasSingleElement(successor->getUses())) {
+        return false;
+      }
+    }
+  }
+
+  // Gather the accesses of each mutable global in program order.
+  llvm::MapVector<StringRef, SmallVector<Operation *>> accesses;
+  DenseSet<StringRef> nestedGlobals;
+  for (auto *block : loop.blocks) {
+    for (auto &op : *block) {
+      auto walkResult = op.walk([&](Operation *nestedOp) {
+        if (isa<mlir::CallOpInterface>(nestedOp) ||
+            nestedOp->hasTrait<OpTrait::IREE::Util::YieldPoint>()) {
+          return WalkResult::interrupt();
+        }
+        StringRef globalName;
+        if (auto loadOp =
+                dyn_cast<IREE::Util::GlobalLoadOpInterface>(nestedOp)) {
+          globalName = loadOp.getGlobalName();
+          if (immutableGlobals.contains(globalName)) {
+            return WalkResult::advance();
+          }
+        } else if (auto storeOp =
+                       dyn_cast<IREE::Util::GlobalStoreOpInterface>(
+                           nestedOp)) {
+          globalName = storeOp.getGlobalName();
+        } else {
+          return WalkResult::advance();
+        }
+        if (nestedOp == &op) {
+          accesses[globalName].push_back(nestedOp);
+        } else {
+          nestedGlobals.insert(globalName);
+        }
+        return WalkResult::advance();
+      });
+      if (walkResult.wasInterrupted()) return false;
+    }
+  }
+
+  bool didPromoteAny = false;
+  for (auto &[globalName, ops] : accesses) {
+    if (nestedGlobals.contains(globalName)) continue;
+
+    // Loads are cloned to get the value on entry; stores are cloned to write
+    // it back on exit.
+    auto loadIt = llvm::find_if(ops, [](Operation *op) {
+      return isa<IREE::Util::GlobalLoadOpInterface>(op);
+    });
+    if (loadIt == ops.end()) continue;
+    Operation *templateLoadOp = *loadIt;
+    Type type = templateLoadOp->getResult(0).getType();
+    SmallVector<Operation *> storeOps;
+    for (auto *op : ops) {
+      if (isa<IREE::Util::GlobalStoreOpInterface>(op)) storeOps.push_back(op);
+    }
+    if (llvm::any_of(storeOps, [&](Operation *op) {
+          return cast<IREE::Util::GlobalStoreOpInterface>(op)
+                     .getStoredGlobalValue()
+                     .getType() != type;
+        })) {
+      continue;
+    }
+    LLVM_DEBUG(llvm::dbgs() << "promoting mutable global " << globalName
+                            << " accessed in loop to SSA values\n");
+    didPromoteAny = true;
+
+    OpBuilder entryBuilder(entryEdge->getOwner());
+    Value entryValue = entryBuilder.clone(*templateLoadOp)->getResult(0);
+
+    // Without stores the value is invariant and loads are just hoisted.
+    if (storeOps.empty()) {
+      for (auto *op : ops) {
+        op->replaceAllUsesWith(ValueRange{entryValue});
+        op->erase();
+      }
+      continue;
+    }
+
+    // Only the header is reachable from outside of the loop and all other
+    // block arguments are passed values from within it.
+    auto entryBranchOp = cast<BranchOpInterface>(entryEdge->getOwner());
+    entryBranchOp.getSuccessorOperands(entryEdge->getOperandNumber())
+        .append(entryValue);
+    DenseMap<Block *, Value> blockValues;
+    for (auto *block : loop.blocks) {
+      blockValues[block] = block->addArgument(type, templateLoadOp->getLoc());
+    }
+    Operation *templateStoreOp = storeOps.front();
+    for (auto *block : loop.blocks) {
+      Value value = blockValues[block];
+      for (auto &op : llvm::make_early_inc_range(*block)) {
+        if (!llvm::is_contained(ops, &op)) continue;
+        if (auto storeOp = dyn_cast<IREE::Util::GlobalStoreOpInterface>(op)) {
+          value = storeOp.getStoredGlobalValue();
+        } else {
+          op.replaceAllUsesWith(ValueRange{value});
+          op.erase();
+        }
+      }
+      auto branchOp = cast<BranchOpInterface>(block->getTerminator());
+      for (unsigned i = 0; i < branchOp->getNumSuccessors(); ++i) {
+        auto *successor = branchOp->getSuccessor(i);
+        if (loop.blocks.contains(successor)) {
+          branchOp.getSuccessorOperands(i).append(value);
+          continue;
+        }
+        IRMapping mapping;
+        mapping.map(cast<IREE::Util::GlobalStoreOpInterface>(templateStoreOp)
+                        .getStoredGlobalValue(),
+                    value);
+        OpBuilder exitBuilder(successor, successor->begin());
+        exitBuilder.clone(*templateStoreOp, mapping);
+      }
+    }
+    for (auto *op : storeOps) op->erase();
+  }
+  return didPromoteAny;
+}
+
+namespace {
+
 class SimplifyGlobalAccessesPass
     : public SimplifyGlobalAccessesBase<SimplifyGlobalAccessesPass> {
  public:
@@ -272,9 +469,18 @@ class SimplifyGlobalAccessesPass
       }
     }
 
+    // Promote globals accessed within loops to SSA values so that they are
+    // accessed once around the loop instead of on every iteration. This
+    // leaves behind redundant block arguments for the canonicalizer.
+    if (!region.hasOneBlock()) {
+      DominanceInfo domInfo(callableOp);
+      for (auto &loop : findLoops(region, domInfo)) {
+        promoteLoopGlobals(loop, immutableGlobals);
+      }
+    }
+
     // For each block in the function hoist loads and sink stores.
-    // This does no cross-block movement, though it really should. Maybe when a
-    // real compiler engineer sees this they'll be inspired to do this properly.
+    // This does no other cross-block movement, though it really should.
     for (auto &block : region) {
       LLVM_DEBUG(llvm::dbgs() << "==== REARRANGING BLOCK ACCESSES ====\n");
       while (rearrangeBlockGlobalAccesses(block, immutableGlobals)) {
@@ -57,3 +57,22 @@ module @broadcast_treated_as_leaf {
   }
   // CHECK-NOT: util.initializer
 }
+
+// -----
+// Verifies that data-tiling encodings of constant weights are hoisted so the
+// packing happens once in an initializer.
+// CHECK-LABEL: @set_encoding_hoisted
+module @set_encoding_hoisted {
+  // CHECK: util.global private @[[HOISTED:.*]] : tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  // CHECK: func.func @main
+  func.func @main() -> (tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>) {
+    %cst = arith.constant dense<2.0e+2> : tensor<8x4xf32>
+    // CHECK-NOT: iree_linalg_ext.set_encoding
+    %0 = iree_linalg_ext.set_encoding %cst : tensor<8x4xf32> -> tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    // CHECK: %[[RESULT:.*]] = util.global.load @[[HOISTED]]
+    // CHECK: return %[[RESULT]]
+    return %0 : tensor<8x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  }
+  // CHECK: util.initializer
+  // CHECK:   iree_linalg_ext.set_encoding
+}
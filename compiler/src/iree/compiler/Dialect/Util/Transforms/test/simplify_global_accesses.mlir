@@ -134,3 +134,56 @@ func.func @side_effects() {
 }
 
 func.func private @other_fn()
+
+// -----
+
+util.global private mutable @varA = 0 : i32
+util.global private mutable @varB = 0 : i32
+
+// CHECK-LABEL: @promote_loop_globals
+// CHECK-SAME: (%[[BOUND:.+]]: i32)
+func.func @promote_loop_globals(%bound: i32) {
+  // CHECK-DAG: %[[INIT_A:.+]] = util.global.load @varA : i32
+  // CHECK-DAG: %[[VAR_B:.+]] = util.global.load @varB : i32
+  // CHECK: cf.br ^bb1(%[[INIT_A]] : i32)
+  cf.br ^bb1
+// CHECK: ^bb1(%[[LOOP_A:.+]]: i32):
+^bb1:
+  // CHECK-NOT: util.global
+  %0 = util.global.load @varA : i32
+  %1 = util.global.load @varB : i32
+  // CHECK: %[[NEXT_A:.+]] = arith.addi %[[LOOP_A]], %[[VAR_B]]
+  %2 = arith.addi %0, %1 : i32
+  util.global.store %2, @varA : i32
+  // CHECK: %[[CMP:.+]] = arith.cmpi slt, %[[NEXT_A]], %[[BOUND]]
+  %cmp = arith.cmpi slt, %2, %bound : i32
+  // CHECK-NEXT: cf.cond_br %[[CMP]], ^bb1(%[[NEXT_A]] : i32), ^bb2
+  cf.cond_br %cmp, ^bb1, ^bb2
+// CHECK: ^bb2:
+^bb2:
+  // CHECK-NEXT: util.global.store %[[NEXT_A]], @varA : i32
+  // CHECK-NEXT: return
+  return
+}
+
+// -----
+
+util.global private mutable @varA = 0 : i32
+
+// CHECK-LABEL: @no_loop_promotion_across_calls
+func.func @no_loop_promotion_across_calls(%bound: i32) {
+  // CHECK-NEXT: cf.br ^bb1
+  cf.br ^bb1
+// CHECK: ^bb1:
+^bb1:
+  // CHECK-NEXT: %[[VAR_A:.+]] = util.global.load @varA : i32
+  %0 = util.global.load @varA : i32
+  // CHECK-NEXT: call @other_fn()
+  call @other_fn() : () -> ()
+  %cmp = arith.cmpi slt, %0, %bound : i32
+  cf.cond_br %cmp, ^bb1, ^bb2
+^bb2:
+  return
+}
+
+func.func private @other_fn()
@@ -23,6 +23,11 @@ VMConversionTarget::nestModuleForConversion(mlir::ModuleOp outerModuleOp) {
     innerModuleOp.getBodyRegion().takeBody(outerModuleOp.getBodyRegion());
     outerModuleOp.getBodyRegion().getBlocks().push_back(new Block());
     outerModuleOp.push_back(innerModuleOp);
+    // Reflection metadata describes the program and moves along with it.
+    if (auto reflectionAttr = outerModuleOp->getAttr("iree.reflection")) {
+      innerModuleOp->setAttr("iree.reflection", reflectionAttr);
+      outerModuleOp->removeAttr("iree.reflection");
+    }
   }
 
   outerModuleOp->setAttr("vm.toplevel",
@@ -3670,6 +3670,10 @@ class ListGetOpConversion : public OpConversionPattern<GetOpTy> {
               return std::make_pair(StringRef("IREE_VM_VALUE_TYPE_I64"),
                                     StringRef("iree_vm_value_get_i64"));
             })
+            .template Case<IREE::VM::ListGetF32Op>([&](auto op) {
+              return std::make_pair(StringRef("IREE_VM_VALUE_TYPE_F32"),
+                                    StringRef("iree_vm_value_get_f32"));
+            })
             .Default([](Operation *) {
               return std::make_pair(std::nullopt, std::nullopt);
             });
@@ -3869,6 +3873,8 @@ class ListSetOpConversion : public OpConversionPattern<SetOpTy> {
                 [&](auto op) { return StringRef("iree_vm_value_make_i32"); })
             .template Case<IREE::VM::ListSetI64Op>(
                 [&](auto op) { return StringRef("iree_vm_value_make_i64"); })
+            .template Case<IREE::VM::ListSetF32Op>(
+                [&](auto op) { return StringRef("iree_vm_value_make_f32"); })
             .Default([](Operation *) { return std::nullopt; });
 
     if (!valueConstructor.has_value()) {
@@ -3971,6 +3977,117 @@ class ListSetRefOpConversion
     return success();
   }
 };
+
+// Convert vm buffer operations to a call of the matching failable helper of
+// iree/vm/ops.h. Buffer operands are passed as iree_vm_ref_t pointers and
+// results are returned through trailing out arguments. Ops allocating new
+// buffers additionally get the module state allocator as first argument.
+template <typename SrcOpTy>
+class BufferOpConversion : public OpConversionPattern<SrcOpTy> {
+  using Adaptor = typename SrcOpTy::Adaptor;
+  using OpConversionPattern<SrcOpTy>::OpConversionPattern;
+
+ public:
+  BufferOpConversion(TypeConverter &typeConverter, MLIRContext *context,
+                     StringRef funcName, bool allocates = false)
+      : OpConversionPattern<SrcOpTy>(typeConverter, context),
+        funcName(funcName),
+        allocates(allocates) {}
+
+ private:
+  LogicalResult matchAndRewrite(
+      SrcOpTy op, Adaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    auto ctx = op.getContext();
+    auto loc = op.getLoc();
+
+    auto funcOp =
+        op.getOperation()->template getParentOfType<mlir::func::FuncOp>();
+    IREE::VM::EmitCTypeConverter *typeConverter =
+        this->template getTypeConverter<IREE::VM::EmitCTypeConverter>();
+
+    auto vmAnalysis = typeConverter->lookupAnalysis(funcOp);
+    if (failed(vmAnalysis)) {
+      return op.emitError() << "parent func op not found in cache.";
+    }
+
+    SmallVector<Value, 6> updatedOperands;
+    SmallVector<Value, 2> movedRefs;
+
+    if (allocates) {
+      const BlockArgument stateArg =
+          funcOp.getArgument(CCONV_ARGUMENT_MODULE_STATE);
+
+      auto allocatorOp = emitc_builders::structPtrMember(
+          rewriter, loc,
+          /*type=*/emitc::OpaqueType::get(ctx, "iree_allocator_t"),
+          /*memberName=*/"allocator",
+          /*operand=*/stateArg);
+      updatedOperands.push_back(allocatorOp);
+    }
+
+    for (auto &operand : llvm::enumerate(op.getOperation()->getOperands())) {
+      if (!operand.value().getType().template isa<IREE::VM::RefType>()) {
+        updatedOperands.push_back(adaptor.getOperands()[operand.index()]);
+        continue;
+      }
+
+      Optional<Value> ref = typeConverter->materializeRef(operand.value());
+
+      if (!ref.has_value()) {
+        return op.emitError() << "local ref not found";
+      }
+
+      updatedOperands.push_back(ref.value());
+      if (vmAnalysis.value().get().isMove(operand.value(),
+                                          op.getOperation())) {
+        movedRefs.push_back(ref.value());
+      }
+    }
+
+    SmallVector<Value, 1> resultValues;
+    for (OpResult result : op.getOperation()->getResults()) {
+      if (result.getType().isa<IREE::VM::RefType>()) {
+        Optional<Value> ref = typeConverter->materializeRef(result);
+
+        if (!ref.has_value()) {
+          return op.emitError() << "local ref not found";
+        }
+
+        resultValues.push_back(ref.value());
+        updatedOperands.push_back(ref.value());
+      } else {
+        Value resultValue =
+            emitc_builders::allocateVariable(rewriter, loc, result.getType());
+        Value resultPtr = emitc_builders::addressOf(rewriter, loc, resultValue);
+
+        resultValues.push_back(resultValue);
+        updatedOperands.push_back(resultPtr);
+      }
+    }
+
+    returnIfError(
+        /*rewriter=*/rewriter,
+        /*location=*/loc,
+        /*callee=*/StringAttr::get(ctx, funcName),
+        /*args=*/ArrayAttr{},
+        /*operands=*/ArrayRef<Value>(updatedOperands),
+        /*typeConverter=*/*typeConverter);
+
+    for (Value ref : movedRefs) {
+      emitc_builders::ireeVmRefRelease(rewriter, loc, ref);
+    }
+
+    rewriter.replaceOp(op, resultValues);
+
+    return success();
+  }
+
+  StringRef funcName;
+
+  // Whether the op allocates a new buffer with the module state allocator.
+  bool allocates;
+};
 }  // namespace
 
 void populateVMToEmitCPatterns(ConversionTarget &conversionTarget,
@@ -4038,6 +4155,40 @@ void populateVMToEmitCPatterns(ConversionTarget &conversionTarget,
                                                             context);
   patterns.add<ListSetRefOpConversion>(typeConverter, context);
 
+  // Buffer ops
+  patterns.add<BufferOpConversion<IREE::VM::BufferAllocOp>>(
+      typeConverter, context, "vm_buffer_alloc", true);
+  patterns.add<BufferOpConversion<IREE::VM::BufferCloneOp>>(
+      typeConverter, context, "vm_buffer_clone", true);
+  patterns.add<BufferOpConversion<IREE::VM::BufferLengthOp>>(
+      typeConverter, context, "vm_buffer_length");
+  patterns.add<BufferOpConversion<IREE::VM::BufferCopyOp>>(
+      typeConverter, context, "vm_buffer_copy");
+  patterns.add<BufferOpConversion<IREE::VM::BufferCompareOp>>(
+      typeConverter, context, "vm_buffer_compare");
+  patterns.add<BufferOpConversion<IREE::VM::BufferFillI8Op>>(
+      typeConverter, context, "vm_buffer_fill_i8");
+  patterns.add<BufferOpConversion<IREE::VM::BufferFillI16Op>>(
+      typeConverter, context, "vm_buffer_fill_i16");
+  patterns.add<BufferOpConversion<IREE::VM::BufferFillI32Op>>(
+      typeConverter, context, "vm_buffer_fill_i32");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadI8UOp>>(
+      typeConverter, context, "vm_buffer_load_i8u");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadI8SOp>>(
+      typeConverter, context, "vm_buffer_load_i8s");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadI16UOp>>(
+      typeConverter, context, "vm_buffer_load_i16u");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadI16SOp>>(
+      typeConverter, context, "vm_buffer_load_i16s");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadI32Op>>(
+      typeConverter, context, "vm_buffer_load_i32");
+  patterns.add<BufferOpConversion<IREE::VM::BufferStoreI8Op>>(
+      typeConverter, context, "vm_buffer_store_i8");
+  patterns.add<BufferOpConversion<IREE::VM::BufferStoreI16Op>>(
+      typeConverter, context, "vm_buffer_store_i16");
+  patterns.add<BufferOpConversion<IREE::VM::BufferStoreI32Op>>(
+      typeConverter, context, "vm_buffer_store_i32");
+
   // Conditional assignment ops
   patterns.add<GenericOpConversion<IREE::VM::SelectI32Op>>(
       typeConverter, context, "vm_select_i32");
@@ -4124,6 +4275,20 @@ void populateVMToEmitCPatterns(ConversionTarget &conversionTarget,
   patterns.add<ConstZeroOpConversion<IREE::VM::ConstF32ZeroOp>>(typeConverter,
                                                                 context);
 
+  // ExtF32: List ops
+  patterns.add<ListGetOpConversion<IREE::VM::ListGetF32Op>>(typeConverter,
+                                                            context);
+  patterns.add<ListSetOpConversion<IREE::VM::ListSetF32Op>>(typeConverter,
+                                                            context);
+
+  // ExtF32: Buffer ops
+  patterns.add<BufferOpConversion<IREE::VM::BufferFillF32Op>>(
+      typeConverter, context, "vm_buffer_fill_f32");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadF32Op>>(
+      typeConverter, context, "vm_buffer_load_f32");
+  patterns.add<BufferOpConversion<IREE::VM::BufferStoreF32Op>>(
+      typeConverter, context, "vm_buffer_store_f32");
+
   // ExtF32: Conditional assignment
   patterns.add<GenericOpConversion<IREE::VM::SelectF32Op>>(
       typeConverter, context, "vm_select_f32");
@@ -4238,6 +4403,14 @@ void populateVMToEmitCPatterns(ConversionTarget &conversionTarget,
   patterns.add<ListSetOpConversion<IREE::VM::ListSetI64Op>>(typeConverter,
                                                             context);
 
+  // ExtI64: Buffer ops
+  patterns.add<BufferOpConversion<IREE::VM::BufferFillI64Op>>(
+      typeConverter, context, "vm_buffer_fill_i64");
+  patterns.add<BufferOpConversion<IREE::VM::BufferLoadI64Op>>(
+      typeConverter, context, "vm_buffer_load_i64");
+  patterns.add<BufferOpConversion<IREE::VM::BufferStoreI64Op>>(
+      typeConverter, context, "vm_buffer_store_i64");
+
   // ExtI64: Conditional assignment ops
   patterns.add<GenericOpConversion<IREE::VM::SelectI64Op>>(
       typeConverter, context, "vm_select_i64");
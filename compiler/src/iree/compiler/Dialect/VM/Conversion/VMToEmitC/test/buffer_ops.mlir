@@ -0,0 +1,72 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(vm.module(iree-vm-ordinal-allocation),vm.module(iree-convert-vm-to-emitc))" %s | FileCheck %s
+
+vm.module @my_module {
+  // CHECK-LABEL: @my_module_buffer_alloc
+  vm.func @buffer_alloc(%arg0: i64) -> !vm.buffer {
+    // CHECK: %[[ALLOCATOR:.+]] = emitc.call "EMITC_STRUCT_PTR_MEMBER"(%arg2) {args = [0 : index, #emitc.opaque<"allocator">]} : (!emitc.ptr<!emitc.opaque<"my_module_state_t">>) -> !emitc.opaque<"iree_allocator_t">
+    // CHECK: %{{.+}} = emitc.call "vm_buffer_alloc"(%[[ALLOCATOR]], %arg3, %{{.+}}) : (!emitc.opaque<"iree_allocator_t">, i64, !emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>) -> !emitc.opaque<"iree_status_t">
+    %0 = vm.buffer.alloc %arg0 : !vm.buffer
+    vm.return %0 : !vm.buffer
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @my_module_buffer_length
+  vm.func @buffer_length(%arg0: !vm.buffer) -> i64 {
+    // CHECK: %[[RESULT:.+]] = "emitc.variable"() {value = #emitc.opaque<"">} : () -> i64
+    // CHECK: %[[RESULT_PTR:.+]] = emitc.apply "&"(%[[RESULT]]) : (i64) -> !emitc.ptr<i64>
+    // CHECK: %{{.+}} = emitc.call "vm_buffer_length"(%{{.+}}, %[[RESULT_PTR]]) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>, !emitc.ptr<i64>) -> !emitc.opaque<"iree_status_t">
+    %0 = vm.buffer.length %arg0 : !vm.buffer -> i64
+    vm.return %0 : i64
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @my_module_buffer_load_i32
+  vm.func @buffer_load_i32(%arg0: !vm.buffer, %arg1: i64) -> i32 {
+    // CHECK: %[[RESULT:.+]] = "emitc.variable"() {value = #emitc.opaque<"">} : () -> i32
+    // CHECK: %[[RESULT_PTR:.+]] = emitc.apply "&"(%[[RESULT]]) : (i32) -> !emitc.ptr<i32>
+    // CHECK: %{{.+}} = emitc.call "vm_buffer_load_i32"(%{{.+}}, %arg4, %[[RESULT_PTR]]) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>, i64, !emitc.ptr<i32>) -> !emitc.opaque<"iree_status_t">
+    %0 = vm.buffer.load.i32 %arg0[%arg1] : !vm.buffer -> i32
+    vm.return %0 : i32
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @my_module_buffer_store_i8
+  vm.func @buffer_store_i8(%arg0: !vm.buffer, %arg1: i64, %arg2: i32) {
+    // CHECK: %{{.+}} = emitc.call "vm_buffer_store_i8"(%{{.+}}, %arg4, %arg5) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>, i64, i32) -> !emitc.opaque<"iree_status_t">
+    vm.buffer.store.i8 %arg2, %arg0[%arg1] : i32 -> !vm.buffer
+    vm.return
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @my_module_buffer_fill_i32
+  vm.func @buffer_fill_i32(%arg0: !vm.buffer, %arg1: i64, %arg2: i64, %arg3: i32) {
+    // CHECK: %{{.+}} = emitc.call "vm_buffer_fill_i32"(%{{.+}}, %arg4, %arg5, %arg6) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>, i64, i64, i32) -> !emitc.opaque<"iree_status_t">
+    vm.buffer.fill.i32 %arg0, %arg1, %arg2, %arg3 : i32 -> !vm.buffer
+    vm.return
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @my_module_buffer_compare
+  vm.func @buffer_compare(%arg0: !vm.buffer, %arg1: !vm.buffer, %arg2: i64) -> i32 {
+    // CHECK: %[[RESULT:.+]] = "emitc.variable"() {value = #emitc.opaque<"">} : () -> i32
+    // CHECK: %[[RESULT_PTR:.+]] = emitc.apply "&"(%[[RESULT]]) : (i32) -> !emitc.ptr<i32>
+    // CHECK: %{{.+}} = emitc.call "vm_buffer_compare"(%{{.+}}, %arg5, %{{.+}}, %arg5, %arg5, %[[RESULT_PTR]]) : (!emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>, i64, !emitc.ptr<!emitc.opaque<"iree_vm_ref_t">>, i64, i64, !emitc.ptr<i32>) -> !emitc.opaque<"iree_status_t">
+    %0 = vm.buffer.compare %arg0, %arg2, %arg1, %arg2, %arg2 : !vm.buffer, !vm.buffer
+    vm.return %0 : i32
+  }
+}
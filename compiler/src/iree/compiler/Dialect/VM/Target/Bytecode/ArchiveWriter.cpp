@@ -6,12 +6,19 @@
 
 #include "iree/compiler/Dialect/VM/Target/Bytecode/ArchiveWriter.h"
 
+#include <algorithm>
+
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/schemas/bytecode_module_def_json_printer.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CRC.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Diagnostics.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -116,6 +123,197 @@ LogicalResult FlatArchiveWriter::flush(FlatbufferBuilder &fbb) {
   return success();
 }
 
+//====---------------------------------------------------------------------===//
+// ExternalFileArchiveWriter
+//====---------------------------------------------------------------------===//
+
+ExternalFileArchiveWriter::ExternalFileArchiveWriter(Location loc,
+                                                     llvm::raw_ostream &os)
+    : loc(loc), os(os) {}
+
+ExternalFileArchiveWriter::~ExternalFileArchiveWriter() { os.flush(); }
+
+ArchiveWriter::File ExternalFileArchiveWriter::declareFile(
+    std::string fileName, uint64_t fileAlignment, uint64_t fileLength,
+    std::function<LogicalResult(llvm::raw_ostream &os)> write) {
+  File file;
+  file.fileName = std::move(fileName);
+  uint64_t alignment =
+      std::max<uint64_t>(fileAlignment, kArchiveSegmentAlignment);
+  file.relativeOffset = IREE::Util::align(tailFileOffset, alignment);
+  tailFileOffset = file.relativeOffset + fileLength;
+  file.fileLength = fileLength;
+  file.write = std::move(write);
+  files.push_back(file);
+  return file;
+}
+
+LogicalResult ExternalFileArchiveWriter::flush(FlatbufferBuilder &fbb) {
+  // Flush all files; offsets are relative to the start of the stream.
+  uint64_t baseOffset = os.tell();
+  for (auto &file : files) {
+    // Pad out with zeros to the start of the file.
+    unsigned filePadding = static_cast<unsigned>(
+        baseOffset + file.relativeOffset + file.prefixLength - os.tell());
+    os.write_zeros(filePadding);
+
+    // Issue the callback to write the file to the stream at the current offset.
+    if (failed(file.write(os))) {
+      return mlir::emitError(loc)
+             << "failed to write external file to the output stream - "
+                "possibly out of memory or storage (file size: "
+             << file.fileLength << ")";
+    }
+  }
+
+  os.flush();
+  return success();
+}
+
+//====---------------------------------------------------------------------===//
+// ContentAddressedArchiveWriter
+//====---------------------------------------------------------------------===//
+
+static std::string getIndexPath(StringRef archivePath) {
+  return (archivePath + ".index").str();
+}
+
+// static
+FailureOr<std::unique_ptr<ContentAddressedArchiveWriter>>
+ContentAddressedArchiveWriter::open(Location loc, StringRef archivePath) {
+  uint64_t archiveSize = 0;
+  if (auto ec = llvm::sys::fs::file_size(archivePath, archiveSize)) {
+    if (ec != std::errc::no_such_file_or_directory) {
+      return mlir::emitError(loc) << "failed to query shared rodata file '"
+                                  << archivePath << "': " << ec.message();
+    }
+    archiveSize = 0;
+  }
+
+  // Load the index of the existing contents, if any.
+  llvm::StringMap<SmallVector<Entry>> entries;
+  auto indexPath = getIndexPath(archivePath);
+  auto indexBuffer = llvm::MemoryBuffer::getFile(indexPath, /*IsText=*/true);
+  if (indexBuffer) {
+    SmallVector<StringRef> lines;
+    (*indexBuffer)->getBuffer().split(lines, '\n', /*MaxSplit=*/-1,
+                                      /*KeepEmpty=*/false);
+    for (auto line : lines) {
+      SmallVector<StringRef, 3> fields;
+      line.trim().split(fields, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+      Entry entry;
+      if (fields.size() != 3 || fields[1].getAsInteger(10, entry.offset) ||
+          fields[2].getAsInteger(10, entry.length)) {
+        return mlir::emitError(loc) << "malformed shared rodata index line '"
+                                    << line << "' in '" << indexPath << "'";
+      }
+      if (entry.offset + entry.length > archiveSize) {
+        return mlir::emitError(loc)
+               << "shared rodata index '" << indexPath
+               << "' references data beyond the end of '" << archivePath
+               << "'; the files are out of sync";
+      }
+      entries[fields[0]].push_back(entry);
+    }
+  } else if (indexBuffer.getError() != std::errc::no_such_file_or_directory) {
+    return mlir::emitError(loc) << "failed to read shared rodata index '"
+                                << indexPath << "': "
+                                << indexBuffer.getError().message();
+  }
+
+  std::error_code ec;
+  auto os = std::make_unique<llvm::raw_fd_ostream>(archivePath, ec,
+                                                   llvm::sys::fs::OF_Append);
+  if (ec) {
+    return mlir::emitError(loc) << "failed to open shared rodata file '"
+                                << archivePath << "': " << ec.message();
+  }
+  auto writer = std::unique_ptr<ContentAddressedArchiveWriter>(
+      new ContentAddressedArchiveWriter(loc, archivePath.str(), std::move(os),
+                                        archiveSize));
+  writer->entries = std::move(entries);
+  return writer;
+}
+
+ContentAddressedArchiveWriter::ContentAddressedArchiveWriter(
+    Location loc, std::string archivePath,
+    std::unique_ptr<llvm::raw_fd_ostream> os, uint64_t tailFileOffset)
+    : loc(loc),
+      archivePath(std::move(archivePath)),
+      os(std::move(os)),
+      tailFileOffset(tailFileOffset) {}
+
+ContentAddressedArchiveWriter::~ContentAddressedArchiveWriter() {
+  os->flush();
+}
+
+ArchiveWriter::File ContentAddressedArchiveWriter::declareFile(
+    std::string fileName, uint64_t fileAlignment, uint64_t fileLength,
+    std::function<LogicalResult(llvm::raw_ostream &os)> write) {
+  File file;
+  file.fileName = std::move(fileName);
+  file.fileLength = fileLength;
+  file.write = [](llvm::raw_ostream &os) { return success(); };
+
+  // Serialize the contents to find whether they are already present.
+  SmallVector<char> contents;
+  llvm::raw_svector_ostream contentsStream(contents);
+  if (failed(write(contentsStream)) || contents.size() != fileLength) {
+    writeResult = mlir::emitError(loc)
+                  << "failed to serialize shared rodata file '"
+                  << file.fileName << "' (file size: " << fileLength << ")";
+    return file;
+  }
+  ArrayRef<uint8_t> contentsData(
+      reinterpret_cast<const uint8_t *>(contents.data()), contents.size());
+  auto hash =
+      llvm::toHex(llvm::SHA256::hash(contentsData), /*LowerCase=*/true);
+  uint64_t alignment =
+      std::max<uint64_t>(fileAlignment, kArchiveSegmentAlignment);
+  auto &hashEntries = entries[hash];
+  for (auto &entry : hashEntries) {
+    if (entry.length == fileLength && entry.offset % alignment == 0) {
+      file.relativeOffset = entry.offset;
+      return file;
+    }
+  }
+
+  // Not present (or not suitably aligned): append to the archive.
+  file.relativeOffset = IREE::Util::align(tailFileOffset, alignment);
+  os->write_zeros(static_cast<unsigned>(file.relativeOffset - tailFileOffset));
+  os->write(contents.data(), contents.size());
+  tailFileOffset = file.relativeOffset + fileLength;
+  hashEntries.push_back({file.relativeOffset, fileLength});
+  newIndexLines += (Twine(hash) + " " + Twine(file.relativeOffset) + " " +
+                    Twine(fileLength) + "\n")
+                       .str();
+  return file;
+}
+
+LogicalResult ContentAddressedArchiveWriter::flush(FlatbufferBuilder &fbb) {
+  if (failed(writeResult)) return failure();
+  os->flush();
+  if (os->has_error()) {
+    return mlir::emitError(loc)
+           << "failed to write shared rodata file '" << archivePath
+           << "': " << os->error().message();
+  }
+
+  // Only record new files in the index once they have been written.
+  if (newIndexLines.empty()) return success();
+  std::error_code ec;
+  llvm::raw_fd_ostream indexStream(
+      getIndexPath(archivePath), ec,
+      llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+  if (ec) {
+    return mlir::emitError(loc) << "failed to open shared rodata index for '"
+                                << archivePath << "': " << ec.message();
+  }
+  indexStream << newIndexLines;
+  newIndexLines.clear();
+  return success();
+}
+
 //====---------------------------------------------------------------------===//
 // ZIP data structures
 //====---------------------------------------------------------------------===//
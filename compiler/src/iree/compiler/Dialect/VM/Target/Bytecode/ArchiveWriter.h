@@ -7,12 +7,15 @@
 #ifndef IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_ARCHIVE_WRITER_H_
 #define IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_ARCHIVE_WRITER_H_
 
+#include <memory>
 #include <string>
 
 #include "iree/compiler/Utils/FlatbufferUtils.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/Location.h"
+#include "mlir/Support/LogicalResult.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -141,6 +144,83 @@ class ZIPArchiveWriter : public ArchiveWriter {
   SmallVector<File> files;
 };
 
+// Standalone file containing only the declared files.
+// Used for rodata stored outside of the module archive; the FlatBuffer is
+// written by the primary archive writer and ignored here.
+//
+// Archive structure:
+//   [declared file 0]
+//   [zero padding to alignment]
+//   [declared file 1]
+//   ...
+class ExternalFileArchiveWriter : public ArchiveWriter {
+ public:
+  explicit ExternalFileArchiveWriter(Location loc, llvm::raw_ostream &os);
+  ~ExternalFileArchiveWriter() override;
+  bool supportsFiles() override { return true; }
+  File declareFile(
+      std::string fileName, uint64_t fileAlignment, uint64_t fileLength,
+      std::function<LogicalResult(llvm::raw_ostream &os)> write) override;
+  LogicalResult flush(FlatbufferBuilder &fbb) override;
+
+ private:
+  Location loc;
+  llvm::raw_ostream &os;
+  uint64_t tailFileOffset = 0;  // unpadded
+  SmallVector<File> files;
+};
+
+// Standalone file shared by multiple modules containing only declared files
+// deduplicated by content. Declared files are appended to the existing file
+// unless an identical file with compatible alignment is already present in
+// which case that one is referenced instead. Existing contents are never
+// moved so modules previously compiled against the file remain valid.
+//
+// Files are written as they are declared as their contents are required to
+// find duplicates. An index of `<sha256> <offset> <length>` lines is kept
+// alongside the file in `<file>.index` so that existing contents need not be
+// rehashed. Neither are safe to update from concurrent compilations.
+//
+// Archive structure:
+//   [declared file 0 (from any module)]
+//   [zero padding to alignment]
+//   [declared file 1 (from any module)]
+//   ...
+class ContentAddressedArchiveWriter : public ArchiveWriter {
+ public:
+  // Opens the archive at |archivePath| for appending, creating it if needed.
+  static FailureOr<std::unique_ptr<ContentAddressedArchiveWriter>> open(
+      Location loc, StringRef archivePath);
+
+  ~ContentAddressedArchiveWriter() override;
+  bool supportsFiles() override { return true; }
+  File declareFile(
+      std::string fileName, uint64_t fileAlignment, uint64_t fileLength,
+      std::function<LogicalResult(llvm::raw_ostream &os)> write) override;
+  LogicalResult flush(FlatbufferBuilder &fbb) override;
+
+ private:
+  struct Entry {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+  };
+
+  ContentAddressedArchiveWriter(Location loc, std::string archivePath,
+                                std::unique_ptr<llvm::raw_fd_ostream> os,
+                                uint64_t tailFileOffset);
+
+  Location loc;
+  std::string archivePath;
+  std::unique_ptr<llvm::raw_fd_ostream> os;
+  uint64_t tailFileOffset = 0;  // unpadded
+  // Hex SHA256 of file contents -> all copies of the file in the archive.
+  llvm::StringMap<SmallVector<Entry>> entries;
+  // Index lines for files appended by this writer.
+  std::string newIndexLines;
+  // Failure of any file written when declared, reported on flush.
+  LogicalResult writeResult = success();
+};
+
 }  // namespace VM
 }  // namespace IREE
 }  // namespace iree_compiler
@@ -341,6 +341,52 @@ class V0BytecodeEncoder : public BytecodeEncoder {
 
 }  // namespace
 
+// Returns the fused compare-and-branch opcode for |op| followed by |nextOp| or
+// std::nullopt if the two cannot be fused. The comparison result must only be
+// used as the condition of the branch as the fused op does not produce it.
+static Optional<std::pair<StringRef, int>> getFusedCondBranchOpcode(
+    Operation &op, Operation *nextOp) {
+  auto condBranchOp = dyn_cast_or_null<IREE::VM::CondBranchOp>(nextOp);
+  if (!condBranchOp || op.getNumResults() != 1 ||
+      condBranchOp.getCondition() != op.getResult(0) ||
+      !op.getResult(0).hasOneUse()) {
+    return std::nullopt;
+  }
+  if (isa<IREE::VM::CmpEQI32Op>(op)) {
+    return std::make_pair(StringRef("CondBranchEQI32"), 0x79);
+  } else if (isa<IREE::VM::CmpNEI32Op>(op)) {
+    return std::make_pair(StringRef("CondBranchNEI32"), 0x7A);
+  } else if (isa<IREE::VM::CmpLTI32SOp>(op)) {
+    return std::make_pair(StringRef("CondBranchLTI32S"), 0x7B);
+  } else if (isa<IREE::VM::CmpLTI32UOp>(op)) {
+    return std::make_pair(StringRef("CondBranchLTI32U"), 0x7C);
+  }
+  return std::nullopt;
+}
+
+// Encodes |cmpOp| and the vm.cond_br |condBranchOp| using its condition as a
+// single fused compare-and-branch op. Matches the runtime
+// DISPATCH_OP_CORE_COND_BRANCH_CMP_I32 decoding.
+static LogicalResult encodeFusedCondBranch(
+    Operation &cmpOp, IREE::VM::CondBranchOp condBranchOp,
+    std::pair<StringRef, int> opcode, BytecodeEncoder &encoder) {
+  if (failed(encoder.beginOp(&cmpOp)) ||
+      failed(encoder.encodeOpcode(opcode.first, opcode.second)) ||
+      failed(encoder.encodeOperand(cmpOp.getOperand(0), 0)) ||
+      failed(encoder.encodeOperand(cmpOp.getOperand(1), 1)) ||
+      failed(encoder.endOp(&cmpOp))) {
+    return failure();
+  }
+  // Successor remapping is computed relative to the branch.
+  return failure(
+      failed(encoder.beginOp(condBranchOp)) ||
+      failed(encoder.encodeBranch(condBranchOp.getTrueDest(),
+                                  condBranchOp.getTrueOperands(), 0)) ||
+      failed(encoder.encodeBranch(condBranchOp.getFalseDest(),
+                                  condBranchOp.getFalseOperands(), 1)) ||
+      failed(encoder.endOp(condBranchOp)));
+}
+
 // static
 Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
@@ -365,7 +411,8 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       return std::nullopt;
     }
 
-    for (auto &op : block.getOperations()) {
+    for (auto opIt = block.begin(); opIt != block.end(); ++opIt) {
+      auto &op = *opIt;
       auto serializableOp = dyn_cast<IREE::VM::VMSerializableOp>(op);
       if (!serializableOp) {
         op.emitOpError() << "is not serializable";
@@ -373,6 +420,24 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       }
       sourceMap.locations.push_back(
           {static_cast<int32_t>(encoder.getOffset()), op.getLoc()});
+
+      // Comparisons feeding the branch that follows them are fused into a
+      // single compare-and-branch superinstruction to save a dispatch and the
+      // condition register write on loop back edges. This is the only fused
+      // sequence today; others (const+add, call+index math) would need
+      // operand-shape analysis in the register allocator.
+      Operation *nextOp = op.getNextNode();
+      if (auto fusedOpcode = getFusedCondBranchOpcode(op, nextOp)) {
+        auto condBranchOp = cast<IREE::VM::CondBranchOp>(nextOp);
+        if (failed(encodeFusedCondBranch(op, condBranchOp, *fusedOpcode,
+                                         encoder))) {
+          op.emitOpError() << "failed to encode fused branch";
+          return std::nullopt;
+        }
+        ++opIt;
+        continue;
+      }
+
       if (failed(encoder.beginOp(&op)) ||
           failed(serializableOp.encode(symbolTable, encoder)) ||
           failed(encoder.endOp(&op))) {
@@ -25,8 +25,10 @@
 #include "iree/schemas/bytecode_module_def_builder.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CRC.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ToolOutputFile.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Diagnostics.h"
@@ -34,6 +36,7 @@
 #include "mlir/IR/Visitors.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/LocationSnapshot.h"
@@ -74,6 +77,10 @@ struct RodataRef {
   uint64_t totalSize = 0;
   // Optional reference to the rodata in the file.
   Optional<ArchiveWriter::File> archiveFile;
+  // True if the archive file is in the external rodata file.
+  bool externalFile = false;
+  // Size of the data prior to compression if zstd compressed.
+  Optional<uint64_t> zstdUncompressedSize;
 };
 
 }  // namespace
@@ -94,6 +101,33 @@ static StringRef mimeTypeToFileExtension(StringRef mimeType) {
       .Default(".bin");
 }
 
+// Serializes |value| and compresses it as a single zstd frame.
+// |compressedData| is left empty if compression is unavailable or would not
+// reduce the size of the data.
+static LogicalResult compressRodataZstd(
+    Location loc, IREE::Util::SerializableAttrInterface value,
+    SmallVectorImpl<uint8_t> &compressedData) {
+  if (!llvm::compression::zstd::isAvailable()) {
+    return mlir::emitError(loc)
+           << "zstd rodata compression requested but the compiler was built "
+              "without zstd support";
+  }
+  SmallVector<char> uncompressedData;
+  if (failed(value.serializeToVector(llvm::support::endianness::little,
+                                     uncompressedData))) {
+    return mlir::emitError(loc) << "failed to serialize rodata value";
+  }
+  llvm::compression::zstd::compress(
+      ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(uncompressedData.data()),
+          uncompressedData.size()),
+      compressedData);
+  if (compressedData.size() >= uncompressedData.size()) {
+    compressedData.clear();
+  }
+  return success();
+}
+
 // Serializes a constant attribute to the FlatBuffer as a binary blob.
 // Returns the size in bytes of the serialized value and the FlatBuffers offset
 // to the uint8 vec containing the data.
@@ -270,6 +304,26 @@ static iree_vm_FunctionSignatureDef_ref_t makeImportFunctionSignatureDef(
                                     cconv.value(), /*attrsRef=*/0, fbb);
 }
 
+// Returns the serialized string key-value pairs of the `iree.reflection`
+// dictionary on |op| or 0 if it has none.
+static iree_vm_AttrDef_vec_ref_t makeReflectionAttrDefs(
+    Operation *op, FlatbufferBuilder &fbb) {
+  auto attrs = op->getAttrOfType<DictionaryAttr>("iree.reflection");
+  if (!attrs) return 0;
+  SmallVector<iree_vm_AttrDef_ref_t, 4> attrRefs;
+  for (auto attr : attrs) {
+    auto key = attr.getName().strref();
+    auto value = attr.getValue().dyn_cast<StringAttr>();
+    if (!value || key.empty()) continue;
+    // NOTE: if we actually want to keep these we should dedupe them (as the
+    // keys and likely several of the values are shared across all functions).
+    auto valueRef = fbb.createString(value.getValue());
+    auto keyRef = fbb.createString(key);
+    attrRefs.push_back(iree_vm_AttrDef_create(fbb, keyRef, valueRef));
+  }
+  return iree_vm_AttrDef_vec_create(fbb, attrRefs.data(), attrRefs.size());
+}
+
 // Returns a serialized function signature.
 static iree_vm_FunctionSignatureDef_ref_t makeExportFunctionSignatureDef(
     IREE::VM::ExportOp exportOp, IREE::VM::FuncOp funcOp,
@@ -279,22 +333,7 @@ static iree_vm_FunctionSignatureDef_ref_t makeExportFunctionSignatureDef(
   if (!cconv.has_value()) return {};
 
   // Reflection attributes.
-  iree_vm_AttrDef_vec_ref_t attrsRef = 0;
-  if (auto attrs = funcOp->getAttrOfType<DictionaryAttr>("iree.reflection")) {
-    SmallVector<iree_vm_AttrDef_ref_t, 4> attrRefs;
-    for (auto attr : attrs) {
-      auto key = attr.getName().strref();
-      auto value = attr.getValue().dyn_cast<StringAttr>();
-      if (!value || key.empty()) continue;
-      // NOTE: if we actually want to keep these we should dedupe them (as the
-      // keys and likely several of the values are shared across all functions).
-      auto valueRef = fbb.createString(value.getValue());
-      auto keyRef = fbb.createString(key);
-      attrRefs.push_back(iree_vm_AttrDef_create(fbb, keyRef, valueRef));
-    }
-    attrsRef =
-        iree_vm_AttrDef_vec_create(fbb, attrRefs.data(), attrRefs.size());
-  }
+  iree_vm_AttrDef_vec_ref_t attrsRef = makeReflectionAttrDefs(funcOp, fbb);
 
   return createFunctionSignatureDef(funcOp.getFunctionType(), typeTable,
                                     cconv.value(), attrsRef, fbb);
@@ -424,7 +463,19 @@ static LogicalResult buildFlatBufferModule(
   for (auto &rodataRef : llvm::reverse(rodataRefs)) {
     if (rodataRef.archiveFile.has_value()) {
       // Data is already in the file at a calculated offset.
+      iree_vm_ZstdDataDef_ref_t zstdDataRef = 0;
+      if (rodataRef.zstdUncompressedSize.has_value()) {
+        zstdDataRef = iree_vm_ZstdDataDef_create(
+            fbb, rodataRef.zstdUncompressedSize.value());
+      }
       iree_vm_RodataSegmentDef_start(fbb);
+      if (zstdDataRef) {
+        iree_vm_RodataSegmentDef_compression_type_add(
+            fbb, iree_vm_CompressionTypeDef_as_ZstdDataDef(zstdDataRef));
+      }
+      if (rodataRef.externalFile) {
+        iree_vm_RodataSegmentDef_external_file_add(fbb, true);
+      }
       iree_vm_RodataSegmentDef_external_data_offset_add(
           fbb, rodataRef.archiveFile->relativeOffset +
                    rodataRef.archiveFile->prefixLength);
@@ -536,11 +587,12 @@ static LogicalResult buildFlatBufferModule(
 
   auto moduleNameRef = fbb.createString(
       moduleOp.getSymName().empty() ? "module" : moduleOp.getSymName());
+  auto moduleAttrsRef = makeReflectionAttrDefs(moduleOp, fbb);
 
   iree_vm_BytecodeModuleDef_name_add(fbb, moduleNameRef);
   iree_vm_BytecodeModuleDef_version_add(fbb,
                                         moduleOp.getVersion().value_or(0u));
-  // TODO(benvanik): iree_vm_BytecodeModuleDef_attrs_add
+  iree_vm_BytecodeModuleDef_attrs_add(fbb, moduleAttrsRef);
   iree_vm_BytecodeModuleDef_types_add(fbb, typesRef);
   iree_vm_BytecodeModuleDef_dependencies_add(fbb, dependenciesRef);
   iree_vm_BytecodeModuleDef_imported_functions_add(fbb, importFuncsRef);
@@ -620,6 +672,31 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
     assert(false && "unhandled output format combination");
   }
 
+  // Optionally route large rodata into a separate file that is provided to the
+  // runtime independently of the module (such as a parameter file).
+  std::unique_ptr<llvm::ToolOutputFile> externalRodataFile;
+  std::unique_ptr<ArchiveWriter> externalRodataWriter;
+  bool useExternalRodata = !targetOptions.externalRodataPath.empty() &&
+                           archiveWriter->supportsFiles();
+  if (useExternalRodata && targetOptions.externalRodataShared) {
+    // Shared files are appended to and deduplicated across modules.
+    auto sharedRodataWriter = ContentAddressedArchiveWriter::open(
+        moduleOp.getLoc(), targetOptions.externalRodataPath);
+    if (failed(sharedRodataWriter)) return failure();
+    externalRodataWriter = std::move(*sharedRodataWriter);
+  } else if (useExternalRodata) {
+    std::string errorMessage;
+    externalRodataFile =
+        mlir::openOutputFile(targetOptions.externalRodataPath, &errorMessage);
+    if (!externalRodataFile) {
+      return moduleOp.emitError()
+             << "failed to open external rodata file '"
+             << targetOptions.externalRodataPath << "': " << errorMessage;
+    }
+    externalRodataWriter = std::make_unique<ExternalFileArchiveWriter>(
+        moduleOp.getLoc(), externalRodataFile->os());
+  }
+
   // Declare all rodata entries we want to end up as external data first. This
   // allows us to compute offsets if needed without having had to perform
   // serialization yet. Note that not all rodata ends up as external data: if
@@ -655,12 +732,43 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
           (rodataOp.getName() +
            mimeTypeToFileExtension(rodataOp.getMimeType().value_or("")))
               .str();
-      rodataRef.archiveFile = archiveWriter->declareFile(
-          fileName, rodataRef.alignment, rodataRef.totalSize,
-          [=](llvm::raw_ostream &os) {
-            return rodataValue.serializeToStream(
-                llvm::support::endianness::little, os);
-          });
+
+      // Only plain data is moved out of the module or compressed; rodata with
+      // a mime type (executables, etc) stays in the archive as-is so that it
+      // can be inspected and referenced in-place.
+      bool isPlainData = !rodataOp.getMimeType().has_value();
+      ArchiveWriter *fileWriter = archiveWriter.get();
+      if (externalRodataWriter && isPlainData) {
+        fileWriter = externalRodataWriter.get();
+        rodataRef.externalFile = true;
+      }
+
+      auto compressedData = std::make_shared<SmallVector<uint8_t>>();
+      if (targetOptions.rodataCompression == BytecodeRodataCompression::kZstd &&
+          isPlainData) {
+        if (failed(compressRodataZstd(rodataOp.getLoc(), rodataValue,
+                                      *compressedData))) {
+          return failure();
+        }
+      }
+      if (!compressedData->empty()) {
+        rodataRef.zstdUncompressedSize = rodataRef.totalSize;
+        rodataRef.totalSize = compressedData->size();
+        rodataRef.archiveFile = fileWriter->declareFile(
+            fileName + ".zst", rodataRef.alignment, rodataRef.totalSize,
+            [=](llvm::raw_ostream &os) {
+              os.write(reinterpret_cast<const char *>(compressedData->data()),
+                       compressedData->size());
+              return success();
+            });
+      } else {
+        rodataRef.archiveFile = fileWriter->declareFile(
+            fileName, rodataRef.alignment, rodataRef.totalSize,
+            [=](llvm::raw_ostream &os) {
+              return rodataValue.serializeToStream(
+                  llvm::support::endianness::little, os);
+            });
+      }
     }
     rodataRefs[rodataOp.getOrdinal()->getLimitedValue()] = rodataRef;
   }
@@ -677,6 +785,13 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
     return failure();
   }
   archiveWriter.reset();
+  if (externalRodataWriter) {
+    if (failed(externalRodataWriter->flush(fbb))) {
+      return failure();
+    }
+    externalRodataWriter.reset();
+    if (externalRodataFile) externalRodataFile->keep();
+  }
 
   return success();
 }
@@ -732,6 +847,28 @@ void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Enables output files to be viewed as zip files for debugging "
           "(only applies to binary targets)"));
+  binder.opt<BytecodeRodataCompression>(
+      "iree-vm-bytecode-module-rodata-compression", rodataCompression,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Compression applied to large rodata segments that are "
+                     "decompressed lazily on first access at runtime"),
+      llvm::cl::values(
+          clEnumValN(BytecodeRodataCompression::kNone, "none",
+                     "Rodata is stored uncompressed and accessed in-place"),
+          clEnumValN(BytecodeRodataCompression::kZstd, "zstd",
+                     "Rodata is zstd compressed when it reduces size")));
+  binder.opt<std::string>(
+      "iree-vm-bytecode-module-external-rodata-path", externalRodataPath,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Writes large rodata segments to the given file instead "
+                     "of the module; the file must be provided to the runtime "
+                     "when loading the module"));
+  binder.opt<bool>(
+      "iree-vm-bytecode-module-external-rodata-shared", externalRodataShared,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Appends to the external rodata file and reuses segments "
+                     "already present in it by content hash so that one file "
+                     "can be shared by multiple modules"));
 }
 
 }  // namespace VM
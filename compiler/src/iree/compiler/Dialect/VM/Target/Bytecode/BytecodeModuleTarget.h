@@ -32,6 +32,14 @@ enum class BytecodeOutputFormat {
   kAnnotatedMlirText,
 };
 
+// Defines the compression applied to large rodata segments.
+enum class BytecodeRodataCompression {
+  // Rodata is stored uncompressed and accessed in-place at runtime.
+  kNone,
+  // Rodata is zstd compressed and decompressed on first access at runtime.
+  kZstd,
+};
+
 // Options that can be provided to bytecode translation.
 struct BytecodeTargetOptions {
   // Format of the module written to the output stream.
@@ -56,6 +64,21 @@ struct BytecodeTargetOptions {
   // should be disabled in release builds.
   bool emitPolyglotZip = true;
 
+  // Compression applied to large rodata segments without a mime type.
+  // Segments are only stored compressed if doing so reduces their size.
+  BytecodeRodataCompression rodataCompression =
+      BytecodeRodataCompression::kNone;
+
+  // Path of a separate file large rodata segments are written to instead of
+  // being appended to the module. The runtime must be provided the file
+  // contents when loading the module (usually by mapping the file).
+  std::string externalRodataPath;
+  // Appends to the external rodata file instead of overwriting it such that it
+  // can be shared by multiple modules. Segments identical to ones already in
+  // the file (such as weights shared by variants of a model) are referenced
+  // instead of being written again.
+  bool externalRodataShared = false;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<BytecodeTargetOptions>;
 };
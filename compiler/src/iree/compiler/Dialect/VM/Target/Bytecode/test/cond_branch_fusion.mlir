@@ -0,0 +1,43 @@
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN: --iree-vm-bytecode-module-output-format=flatbuffer-text %s | FileCheck %s
+
+// Tests that an i32 comparison feeding the vm.cond_br following it is encoded
+// as a single compare-and-branch op.
+
+// CHECK: "name": "cond_branch_fusion"
+vm.module @cond_branch_fusion {
+  vm.export @select_lt
+
+  //      CHECK: "bytecode_data": [
+  // CondBranchLTI32S %arg0, %arg1
+  // CHECK-NEXT:   123,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   1,
+  // CHECK-NEXT:   0,
+  // ^bb1 at pc 18, alignment padding, and an empty remap list.
+  // CHECK-NEXT:   18,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // ^bb2 at pc 24 with an empty remap list.
+  // CHECK-NEXT:   24,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // ^bb1: vm.return
+  // CHECK-NEXT:   90,
+  vm.func @select_lt(%arg0 : i32, %arg1 : i32) -> i32 {
+    %cmp = vm.cmp.lt.i32.s %arg0, %arg1 : i32
+    vm.cond_br %cmp, ^bb1, ^bb2
+  ^bb1:
+    vm.return %arg0 : i32
+  ^bb2:
+    vm.return %arg1 : i32
+  }
+}
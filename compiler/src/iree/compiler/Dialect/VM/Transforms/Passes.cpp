@@ -100,6 +100,10 @@ void buildVMTransformPassPipeline(OpPassManager &passManager,
   passManager.addNestedPass<IREE::VM::ModuleOp>(createResolveRodataLoadsPass());
 
   // Catch any inlining opportunities we created during lowering.
+  // NOTE: there's no size/benefit cost model: every call to a function not
+  // marked noinline is inlined (recursion aside) as a vm.call costs a frame
+  // push/pop in the interpreter that outweighs the bytecode size increase.
+  // Constant arguments are specialized by canonicalization post-inlining.
   passManager.addPass(mlir::createInlinerPass());
   passManager.addPass(mlir::createSymbolDCEPass());
 
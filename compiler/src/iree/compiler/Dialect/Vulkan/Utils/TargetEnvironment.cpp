@@ -75,6 +75,9 @@ void convertExtensions(Vulkan::TargetEnvAttr vkTargetEnv,
       case Extension::VK_NV_cooperative_matrix:
         extensions.push_back(spirv::Extension::SPV_NV_cooperative_matrix);
         break;
+      case Extension::VK_KHR_shader_integer_dot_product:
+        extensions.push_back(spirv::Extension::SPV_KHR_integer_dot_product);
+        break;
     }
   }
 }
@@ -146,6 +149,10 @@ void convertCapabilities(Vulkan::TargetEnvAttr vkTargetEnv,
       capabilities.push_back(spirv::Capability::CooperativeMatrixNV);
     }
   }
+  if (vkCapabilities.getShaderIntegerDotProduct()) {
+    capabilities.push_back(spirv::Capability::DotProduct);
+    capabilities.push_back(spirv::Capability::DotProductInput4x8BitPacked);
+  }
 }
 
 /// Gets the corresponding SPIR-V resource limits for the given Vulkan target
@@ -39,6 +39,8 @@ spirv::Vendor getVendor(const TargetTriple &triple) {
       return spirv::Vendor::ARM;
     case TargetTripleArch::Apple_M1:
       return spirv::Vendor::Apple;
+    case TargetTripleArch::Intel_Arc:
+      return spirv::Vendor::Intel;
     case TargetTripleArch::NV_Turing:
     case TargetTripleArch::NV_Ampere:
       return spirv::Vendor::NVIDIA;
@@ -67,6 +69,7 @@ spirv::DeviceType getDeviceType(const TargetTriple &triple) {
     case TargetTripleArch::AMD_RDNAv1:
     case TargetTripleArch::AMD_RDNAv2:
     case TargetTripleArch::AMD_RDNAv3:
+    case TargetTripleArch::Intel_Arc:
     case TargetTripleArch::NV_Turing:
     case TargetTripleArch::NV_Ampere:
       return spirv::DeviceType::DiscreteGPU;
@@ -177,10 +180,11 @@ void getExtensions(const TargetTriple &triple,
   }
 
   // Desktop GPUs typically support all extensions we care.
-  const std::array<Extension, 7> desktop = {
+  const std::array<Extension, 8> desktop = {
       Extension::VK_KHR_16bit_storage,
       Extension::VK_KHR_8bit_storage,
       Extension::VK_KHR_shader_float16_int8,
+      Extension::VK_KHR_shader_integer_dot_product,
       Extension::VK_KHR_spirv_1_4,
       Extension::VK_KHR_storage_buffer_storage_class,
       Extension::VK_KHR_variable_pointers,
@@ -222,6 +226,8 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
 
   bool variablePointers = false, variablePointersStorageBuffer = false;
 
+  bool shaderIntegerDotProduct = false;
+
   SmallVector<Attribute, 4> coopmatCases;
 
   Builder builder(context);
@@ -271,6 +277,7 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
       uniformAndStorageBuffer8BitAccess = true;
 
       variablePointers = variablePointersStorageBuffer = true;
+      shaderIntegerDotProduct = true;
       break;
     case TargetTripleArch::Apple_M1:
       // Example: https://vulkan.gpuinfo.org/displayreport.php?id=14673
@@ -357,6 +364,7 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
       uniformAndStorageBuffer8BitAccess = true;
 
       variablePointers = variablePointersStorageBuffer = true;
+      shaderIntegerDotProduct = true;
 
       auto i8t = builder.getIntegerType(8);
       auto i32t = builder.getIntegerType(32);
@@ -377,6 +385,31 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
           /*mSize=*/16, /*nSize=*/16, /*kSize=*/16, /*aType=*/f16t,
           /*bType=*/f16t, /*cType=*/f32t, /*resultType=*/f32t, scope));
     } break;
+    case TargetTripleArch::Intel_Arc:
+      // Arc A-series (Alchemist) discrete GPUs.
+      maxComputeSharedMemorySize = 65536;
+      maxComputeWorkGroupInvocations = 1024;
+      maxComputeWorkGroupSize = {1024, 1024, 64};
+
+      subgroupSize = 32, minSubgroupSize = 8, maxSubgroupSize = 32;
+      subgroupFeatures = SubgroupFeature::Basic | SubgroupFeature::Vote |
+                         SubgroupFeature::Arithmetic | SubgroupFeature::Ballot |
+                         SubgroupFeature::Shuffle |
+                         SubgroupFeature::ShuffleRelative |
+                         SubgroupFeature::Clustered | SubgroupFeature::Quad;
+
+      // Arc drops native fp64 support.
+      shaderFloat16 = true;
+      shaderInt8 = shaderInt16 = shaderInt64 = true;
+
+      storageBuffer16BitAccess = storagePushConstant16 = true;
+      uniformAndStorageBuffer16BitAccess = true;
+      storageBuffer8BitAccess = true, storagePushConstant8 = true;
+      uniformAndStorageBuffer8BitAccess = true;
+
+      variablePointers = variablePointersStorageBuffer = true;
+      shaderIntegerDotProduct = true;
+      break;
     case TargetTripleArch::QC_Adreno:
       // Example: https://vulkan.gpuinfo.org/displayreport.php?id=10983 (11)
       // Example: https://vulkan.gpuinfo.org/displayreport.php?id=16312 (12)
@@ -427,7 +460,7 @@ CapabilitiesAttr getCapabilities(const TargetTriple &triple,
       getBoolAttr(uniformAndStorageBuffer8BitAccess),
       getBoolAttr(shaderFloat16), getBoolAttr(shaderInt8),
       getBoolAttr(variablePointersStorageBuffer), getBoolAttr(variablePointers),
-      builder.getArrayAttr(coopmatCases));
+      getBoolAttr(shaderIntegerDotProduct), builder.getArrayAttr(coopmatCases));
 }
 }  // namespace
 
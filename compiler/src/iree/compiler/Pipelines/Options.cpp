@@ -123,6 +123,31 @@ void SchedulingOptions::bindOptions(OptionsBinder &binder) {
                           llvm::cl::desc("File path to write statistics to; or "
                                          "`` for stderr or `-` for stdout."),
                           llvm::cl::cat(category));
+  binder.opt<bool>(
+      "iree-scheduling-embed-cost-summary", embedCostSummary,
+      llvm::cl::desc("Embeds the dispatch workloads, binding sizes and "
+                     "estimated operation counts of each executable in the "
+                     "compiled module for reporting with iree-dump-module."),
+      llvm::cl::cat(category));
+  binder.opt<int>(
+      "iree-scheduling-tensor-parallel-shards", tensorParallelShards,
+      llvm::cl::desc("Partitions entry points with arguments annotated with "
+                     "`iree.sharding.dim` across this many participants of "
+                     "the default collective channel (SPMD)."),
+      llvm::cl::cat(category));
+  binder.opt<int>(
+      "iree-scheduling-pipeline-stages", pipelineStages,
+      llvm::cl::desc("Splits the dispatches of entry points into this many "
+                     "stages executing on separate queues such that stages "
+                     "of successive asynchronous invocations overlap."),
+      llvm::cl::cat(category));
+  binder.opt<int64_t>(
+      "iree-scheduling-constant-upload-chunk-size", constantUploadChunkSize,
+      llvm::cl::desc("Splits constant uploads into chunks of at most this "
+                     "many bytes that execution awaits individually, "
+                     "overlapping the upload of later constants with compute "
+                     "using earlier ones."),
+      llvm::cl::cat(category));
 }
 
 void PreprocessingOptions::bindOptions(OptionsBinder &binder) {
@@ -119,6 +119,18 @@ struct SchedulingOptions {
   DumpOutputFormat dumpStatisticsFormat = DumpOutputFormat::None;
   // File path to write statistics to; or `` for stderr or `-` for stdout.
   std::string dumpStatisticsFile = "";
+  // Embeds a cost summary of each dispatched executable export in the module
+  // reflection attributes for tools such as iree-dump-module to report.
+  bool embedCostSummary = false;
+  // Number of participants of the default collective channel that entry
+  // points with sharded arguments are partitioned across; 1 disables it.
+  int tensorParallelShards = 1;
+  // Number of pipeline stages entry points are split into, each executing on
+  // its own queue so that successive invocations overlap; 1 disables it.
+  int pipelineStages = 1;
+  // Maximum size in bytes of each constant upload such that execution can
+  // start as soon as the constants it uses are resident; 0 disables it.
+  int64_t constantUploadChunkSize = 0;
 
   // TODO(benvanik): favor size/speed/etc for partitioning.
   // TODO(benvanik): execution model to optimize for (unified/discrete memory,
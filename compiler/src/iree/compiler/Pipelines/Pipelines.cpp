@@ -9,6 +9,7 @@
 #include "iree/compiler/Bindings/Native/Transforms/Passes.h"
 #include "iree/compiler/Bindings/TFLite/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Util/Transforms/Passes.h"
@@ -73,6 +74,14 @@ void buildIREEVMTransformPassPipeline(
   IREE_TRACE_ADD_END_FRAME_PASS(passManager, "Input");
   if (compileTo == IREEVMPipelinePhase::Input) return;  // early-exit
 
+  // Partition entry points for tensor parallelism while their signatures can
+  // still change: sharded arguments receive the local shard of each
+  // participant.
+  if (schedulingOptions.tensorParallelShards > 1) {
+    passManager.addPass(IREE::Flow::createShardTensorsPass(
+        schedulingOptions.tensorParallelShards));
+  }
+
   // Now that inputs are legalized, generate wrapper for entry functions.
   IREE_TRACE_ADD_BEGIN_FRAME_PASS(passManager, "ABI");
   IREE::ABI::InvocationOptions invocationOptions;
@@ -96,6 +105,27 @@ void buildIREEVMTransformPassPipeline(
   flowOptions.numericPrecisionReduction =
       highLevelOptimizationOptions.numericPrecisionReduction;
 
+  // Fusion decisions are made once for all targets so use the lowest ratio:
+  // fusions profitable with it are profitable on every target.
+  for (auto &targetBackend :
+       IREE::HAL::getTargetBackends(executableOptions.targets)) {
+    std::optional<double> opsPerByte = targetBackend->getOpsPerByte();
+    if (!opsPerByte) continue;
+    if (flowOptions.fusionOpsPerByte <= 0.0 ||
+        *opsPerByte < flowOptions.fusionOpsPerByte) {
+      flowOptions.fusionOpsPerByte = *opsPerByte;
+    }
+  }
+  // Split-K decisions are also shared so use the highest parallelism needed to
+  // fill any of the targets.
+  for (auto &targetBackend :
+       IREE::HAL::getTargetBackends(executableOptions.targets)) {
+    std::optional<int64_t> minParallelism = targetBackend->getMinParallelism();
+    if (minParallelism && *minParallelism > flowOptions.splitKMinParallelism) {
+      flowOptions.splitKMinParallelism = *minParallelism;
+    }
+  }
+
   // Enable const-eval via hook. For debug builds, we assert if enabled without
   // a hook. For release, we just silently skip enabling const-eval.
   if (highLevelOptimizationOptions.constEval) {
@@ -120,6 +150,10 @@ void buildIREEVMTransformPassPipeline(
   streamOptions.dumpStatisticsFormat =
       (IREE::Stream::DumpOutputFormat)schedulingOptions.dumpStatisticsFormat;
   streamOptions.dumpStatisticsFile = schedulingOptions.dumpStatisticsFile;
+  streamOptions.embedCostSummary = schedulingOptions.embedCostSummary;
+  streamOptions.pipelineStages = schedulingOptions.pipelineStages;
+  streamOptions.constantUploadChunkSize =
+      schedulingOptions.constantUploadChunkSize;
 
   switch (schedulingOptions.executionModel) {
     case SchedulingOptions::ExecutionModel::HostOnly:
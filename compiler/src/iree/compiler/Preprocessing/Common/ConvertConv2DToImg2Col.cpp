@@ -42,6 +42,36 @@ static Value createMul(Location loc, Value x, Value y, bool isInt,
 
 namespace {
 
+// Per-convolution cost model choosing between img2col and the alternatives.
+// When disabled every supported convolution is converted.
+struct Img2ColCostModel {
+  bool enabled = false;
+  // Largest img2col tensor, in bytes, worth materializing.
+  int64_t maxColTensorBytes = 0;
+};
+
+}  // namespace
+
+// Returns true if a convolution whose img2col tensor has |colTensorShape|
+// should be converted. |isPointwise| marks 1x1, unit-stride, single-batch
+// convolutions that are matmuls over the unmodified input.
+static bool isImg2ColProfitable(const Img2ColCostModel &costModel,
+                                ArrayRef<int64_t> colTensorShape,
+                                Type elementType, bool isPointwise) {
+  if (!costModel.enabled) return true;
+  // iree-flow-convert-1x1-filter-conv2d-to-matmul handles these by reshaping
+  // the input instead of copying it into a col tensor.
+  if (isPointwise) return false;
+  // The col tensor repeats each input element up to Kh x Kw times. Past the
+  // budget the copy costs more memory traffic than the matmul saves, so the
+  // convolution is kept for codegen to tile directly.
+  int64_t colTensorBytes = ShapedType::getNumElements(colTensorShape) *
+                           elementType.getIntOrFloatBitWidth() / 8;
+  return colTensorBytes <= costModel.maxColTensorBytes;
+}
+
+namespace {
+
 // Convert linalg.conv_2d_nhwc_hwcf into linalg.generic (for img2col packing)
 // and linalg.matmul.
 //
@@ -72,13 +102,12 @@ namespace {
 //
 // In general for 2D case with (N, H, W, C) input and (Kh, Kw, C, D) filter
 // and output (N, Ho, Wo, D) the convolutin is the following matrix-matrix
-// multiplication (Ho x Wo, Kh x Kw x C) * (Kh x Kw x C, D) for each input in
-// the N input. For the case where N > 1 its a batched matrxi-matrix
-// multplication.
+// multiplication (N x Ho x Wo, Kh x Kw x C) * (Kh x Kw x C, D).
 class ConvertConv2DNhwcHwcf final
     : public OpRewritePattern<linalg::Conv2DNhwcHwcfOp> {
  public:
-  using OpRewritePattern::OpRewritePattern;
+  ConvertConv2DNhwcHwcf(MLIRContext *context, Img2ColCostModel costModel)
+      : OpRewritePattern(context), costModel(costModel) {}
 
   LogicalResult matchAndRewrite(linalg::Conv2DNhwcHwcfOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -111,6 +140,12 @@ class ConvertConv2DNhwcHwcf final
     auto loc = convOp.getLoc();
 
     SmallVector<int64_t, 4> colTensorShape = {n, oh, ow, fh, fw, ic};
+    bool isPointwise = fh == 1 && fw == 1 && n == 1 &&
+                       hasAllOneValues(convOp.getStrides());
+    if (!isImg2ColProfitable(costModel, colTensorShape,
+                             inputType.getElementType(), isPointwise)) {
+      return failure();
+    }
 
     Value colTensor = rewriter.create<tensor::EmptyOp>(
         loc, colTensorShape, inputType.getElementType());
@@ -129,7 +164,6 @@ class ConvertConv2DNhwcHwcf final
     auto nloops = colTensorShape.size();
 
     auto parallel = utils::IteratorType::parallel;
-    auto reduction = utils::IteratorType::reduction;
     SmallVector<utils::IteratorType, 3> img2colIterators(nloops, parallel);
 
     SmallVector<AffineMap, 4> img2colIndexingMaps = {
@@ -144,26 +178,17 @@ class ConvertConv2DNhwcHwcf final
           nestedBuilder.create<linalg::YieldOp>(nestedLoc, args[0]);
         });
 
-    SmallVector<ReassociationIndices> img2ColTensorReassocIndices;
-    SmallVector<ReassociationIndices> outputReassocIndices;
-    RankedTensorType reshapedImg2ColTensorType, reshapedOutputType;
-    if (n == 1) {
-      img2ColTensorReassocIndices = {{0, 1, 2}, {3, 4, 5}};
-      outputReassocIndices = {{0, 1, 2}, {3}};
-
-      reshapedImg2ColTensorType = RankedTensorType::get(
-          {oh * ow, fh * fw * ic}, inputType.getElementType());
-      reshapedOutputType =
-          RankedTensorType::get({oh * ow, oc}, outputType.getElementType());
-    } else {
-      img2ColTensorReassocIndices = {{0}, {1, 2}, {3, 4, 5}};
-      outputReassocIndices = {{0}, {1, 2}, {3}};
-
-      reshapedImg2ColTensorType = RankedTensorType::get(
-          {n, oh * ow, fh * fw * ic}, inputType.getElementType());
-      reshapedOutputType =
-          RankedTensorType::get({n, oh * ow, oc}, outputType.getElementType());
-    }
+    // The batch dimension is folded into the rows of the img2col matrix and
+    // of the output: both are contiguous in the NHWC layout and the filter is
+    // shared by all batches. This keeps the contraction a plain linalg.matmul
+    // that data-tiling (SetEncoding) and the matmul codegen paths handle.
+    SmallVector<ReassociationIndices> img2ColTensorReassocIndices = {
+        {0, 1, 2}, {3, 4, 5}};
+    SmallVector<ReassociationIndices> outputReassocIndices = {{0, 1, 2}, {3}};
+    auto reshapedImg2ColTensorType = RankedTensorType::get(
+        {n * oh * ow, fh * fw * ic}, inputType.getElementType());
+    auto reshapedOutputType =
+        RankedTensorType::get({n * oh * ow, oc}, outputType.getElementType());
 
     SmallVector<ReassociationIndices> filterReassocIndices = {{0, 1, 2}, {3}};
     auto reshapedFilterType =
@@ -179,39 +204,11 @@ class ConvertConv2DNhwcHwcf final
     Value reshapedOutput = rewriter.create<tensor::CollapseShapeOp>(
         loc, reshapedOutputType, output, outputReassocIndices);
 
-    Value result;
-    if (n == 1) {
-      auto matmulOp = rewriter.create<linalg::MatmulOp>(
-          loc, reshapedOutputType,
-          ArrayRef<Value>{reshapedImg2ColTensor, reshapedFilter},
-          ArrayRef<Value>{reshapedOutput});
-      result = matmulOp.getResults().front();
-    } else {
-      // For cases where batch is not 1, we need to keep the batch dimension
-      // separate. Because the filter does not share the same batch dimension,
-      // the batch dimension is only used in indexing the input and output. Thus
-      // we cannot use existing linalg named ops like linalg.batch_matmul.
-      // i.e. (B x) M x K * K x N = (B x) M x N
-      AffineExpr bDim, mDim, nDim, kDim;
-      bindDims(getContext(), bDim, mDim, nDim, kDim);
-      auto lhsMap = AffineMap::get(4, 0, {bDim, mDim, kDim}, getContext());
-      auto rhsMap = AffineMap::get(4, 0, {kDim, nDim}, getContext());
-      auto resultMap = AffineMap::get(4, 0, {bDim, mDim, nDim}, getContext());
-      SmallVector<utils::IteratorType> genericIterators = {parallel, parallel,
-                                                           parallel, reduction};
-      bool isInt = outputType.getElementType().isa<IntegerType>();
-      auto genericOp = rewriter.create<linalg::GenericOp>(
-          loc, reshapedOutputType,
-          /*inputs=*/ValueRange{reshapedImg2ColTensor, reshapedFilter},
-          /*outputs=*/ValueRange{reshapedOutput},
-          ArrayRef<AffineMap>{lhsMap, rhsMap, resultMap}, genericIterators,
-          [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
-            Value mul = createMul(loc, args[0], args[1], isInt, nestedBuilder);
-            Value add = createAdd(loc, mul, args[2], isInt, nestedBuilder);
-            nestedBuilder.create<linalg::YieldOp>(nestedLoc, add);
-          });
-      result = genericOp.getResults().front();
-    }
+    auto matmulOp = rewriter.create<linalg::MatmulOp>(
+        loc, reshapedOutputType,
+        ArrayRef<Value>{reshapedImg2ColTensor, reshapedFilter},
+        ArrayRef<Value>{reshapedOutput});
+    Value result = matmulOp.getResults().front();
 
     auto reshapedResult = rewriter.create<tensor::ExpandShapeOp>(
         loc, outputType, result, outputReassocIndices);
@@ -220,6 +217,9 @@ class ConvertConv2DNhwcHwcf final
 
     return success();
   }
+
+ private:
+  Img2ColCostModel costModel;
 };
 
 // Similar to the conv pattern above except there is no reduction among the
@@ -229,7 +229,9 @@ class ConvertConv2DNhwcHwcf final
 class ConvertDepthwiseConv2DNhwcHwc final
     : public OpRewritePattern<linalg::DepthwiseConv2DNhwcHwcOp> {
  public:
-  using OpRewritePattern<linalg::DepthwiseConv2DNhwcHwcOp>::OpRewritePattern;
+  ConvertDepthwiseConv2DNhwcHwc(MLIRContext *context,
+                                Img2ColCostModel costModel)
+      : OpRewritePattern(context), costModel(costModel) {}
 
   LogicalResult matchAndRewrite(linalg::DepthwiseConv2DNhwcHwcOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -244,6 +246,24 @@ class ConvertDepthwiseConv2DNhwcHwc final
     // TODO: Support dilation.
     if (!hasAllOneValues(convOp.getDilations())) return failure();
 
+    auto filterShape = filterType.getShape();
+    auto outputShape = outputType.getShape();
+
+    const int n = outputShape[0];
+    const int oh = outputShape[1];
+    const int ow = outputShape[2];
+    const int c = outputShape[3];
+    const int fh = filterShape[0];
+    const int fw = filterShape[1];
+
+    SmallVector<int64_t, 4> colTensorShape = {n, c, oh, ow, fh, fw};
+    // Decide before the transposes below create any IR.
+    if (!isImg2ColProfitable(costModel, colTensorShape,
+                             inputType.getElementType(),
+                             /*isPointwise=*/false)) {
+      return failure();
+    }
+
     auto loc = convOp.getLoc();
 
     auto transposeOperand = [&](Value operand, ArrayRef<int64_t> indices) {
@@ -289,17 +309,6 @@ class ConvertDepthwiseConv2DNhwcHwc final
     // Transpose input, filter so channels are outermost
     auto inputT = transposeOperand(input, {0, 3, 1, 2});
     auto filterT = transposeOperand(filter, {2, 0, 1});
-    auto filterTShape = filterT.getType().cast<RankedTensorType>().getShape();
-    auto outputShape = outputType.getShape();
-
-    const int n = outputShape[0];
-    const int oh = outputShape[1];
-    const int ow = outputShape[2];
-    const int c = outputShape[3];
-    const int fh = filterTShape[1];
-    const int fw = filterTShape[2];
-
-    SmallVector<int64_t, 4> colTensorShape = {n, c, oh, ow, fh, fw};
     Value transposedOutputTensor = transposeOperand(output, {0, 3, 1, 2});
 
     AffineExpr nDim, cDim, ohDim, owDim, khDim, kwDim;
@@ -373,6 +382,9 @@ class ConvertDepthwiseConv2DNhwcHwc final
     rewriter.replaceOp(convOp, ArrayRef<Value>{transposedResult});
     return success();
   }
+
+ private:
+  Img2ColCostModel costModel;
 };
 
 // For nchw, because the channels are to the left of the image shape dimensions,
@@ -382,7 +394,8 @@ class ConvertDepthwiseConv2DNhwcHwc final
 class ConvertConv2DNchwFchw final
     : public OpRewritePattern<linalg::Conv2DNchwFchwOp> {
  public:
-  using OpRewritePattern::OpRewritePattern;
+  ConvertConv2DNchwFchw(MLIRContext *context, Img2ColCostModel costModel)
+      : OpRewritePattern(context), costModel(costModel) {}
 
   LogicalResult matchAndRewrite(linalg::Conv2DNchwFchwOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -415,6 +428,12 @@ class ConvertConv2DNchwFchw final
     auto loc = convOp.getLoc();
 
     SmallVector<int64_t, 4> colTensorShape = {n, ic, fh, fw, oh, ow};
+    bool isPointwise = fh == 1 && fw == 1 && n == 1 &&
+                       hasAllOneValues(convOp.getStrides());
+    if (!isImg2ColProfitable(costModel, colTensorShape,
+                             inputType.getElementType(), isPointwise)) {
+      return failure();
+    }
 
     Value colTensor = rewriter.create<tensor::EmptyOp>(
         loc, colTensorShape, inputType.getElementType());
@@ -523,6 +542,9 @@ class ConvertConv2DNchwFchw final
 
     return success();
   }
+
+ private:
+  Img2ColCostModel costModel;
 };
 
 struct ConvertConv2DToImg2ColPass
@@ -532,9 +554,12 @@ struct ConvertConv2DToImg2ColPass
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
+    Img2ColCostModel costModel;
+    costModel.enabled = useCostModel;
+    costModel.maxColTensorBytes = maxColTensorBytes;
     RewritePatternSet patterns(&getContext());
     patterns.insert<ConvertConv2DNhwcHwcf, ConvertDepthwiseConv2DNhwcHwc,
-                    ConvertConv2DNchwFchw>(context);
+                    ConvertConv2DNchwFchw>(context, costModel);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
       return signalPassFailure();
@@ -0,0 +1,254 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Utils/PassProfiling.h"
+
+#include <algorithm>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Support/FileUtilities.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif  // __linux__ || __APPLE__
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+struct PassProfilingCLOptions {
+  llvm::cl::opt<std::string> file{
+      "iree-compile-profile-file",
+      llvm::cl::desc("Writes a JSON report of the time and peak memory spent "
+                     "in each pass and of the time spent translating and "
+                     "serializing each executable to the given file."),
+      llvm::cl::init("")};
+};
+
+// A pass run in progress on the current thread.
+struct ActivePass {
+  Pass *pass;
+  std::chrono::steady_clock::time_point startTime;
+  // Time spent in passes nested within this one on the same thread.
+  double nestedSeconds;
+  int64_t startPeakMemoryBytes;
+};
+
+thread_local llvm::SmallVector<ActivePass, 8> activePasses;
+
+}  // namespace
+
+static llvm::ManagedStatic<PassProfilingCLOptions> clOptions;
+
+// Returns the peak resident memory of the process in bytes or 0 if unknown.
+static int64_t getPeakMemoryBytes() {
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif  // __APPLE__
+#else
+  return 0;
+#endif  // __linux__ || __APPLE__
+}
+
+// Returns the qualified symbol name of |op| (such as `@executable::@variant`)
+// or an empty string if it has no symbol name.
+static std::string getQualifiedSymbolName(Operation *op) {
+  auto symbolName =
+      op->getAttrOfType<StringAttr>(SymbolTable::getSymbolAttrName());
+  if (!symbolName) return "";
+  std::string parentName;
+  if (Operation *parentOp = op->getParentOp()) {
+    parentName = getQualifiedSymbolName(parentOp);
+  }
+  if (parentName.empty()) return ("@" + symbolName.getValue()).str();
+  return parentName + "::@" + symbolName.getValue().str();
+}
+
+static bool isExecutableOp(Operation *op) {
+  StringRef opName = op->getName().getStringRef();
+  return opName == "hal.executable" || opName == "hal.executable.variant";
+}
+
+PassProfiling::PassProfiling() : startTime(Clock::now()) {}
+
+void PassProfiling::runBeforePass(Pass *pass, Operation *op) {
+  activePasses.push_back({pass, Clock::now(), 0.0, getPeakMemoryBytes()});
+}
+
+void PassProfiling::runAfterPass(Pass *pass, Operation *op) {
+  endPass(pass, op);
+}
+
+void PassProfiling::runAfterPassFailed(Pass *pass, Operation *op) {
+  endPass(pass, op);
+}
+
+void PassProfiling::endPass(Pass *pass, Operation *op) {
+  auto endTime = Clock::now();
+  if (activePasses.empty() || activePasses.back().pass != pass) return;
+  ActivePass activePass = activePasses.pop_back_val();
+  double seconds =
+      std::chrono::duration<double>(endTime - activePass.startTime).count();
+  if (!activePasses.empty()) activePasses.back().nestedSeconds += seconds;
+  int64_t peakMemoryGrowthBytes =
+      getPeakMemoryBytes() - activePass.startPeakMemoryBytes;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &statistics = passStatistics[pass->getName()];
+  if (statistics.count == 0) statistics.argument = pass->getArgument().str();
+  ++statistics.count;
+  statistics.totalSeconds += seconds;
+  statistics.selfSeconds += seconds - activePass.nestedSeconds;
+  statistics.maxSeconds = std::max(statistics.maxSeconds, seconds);
+  statistics.peakMemoryGrowthBytes += peakMemoryGrowthBytes;
+
+  if (isExecutableOp(op)) {
+    ExecutableRun run;
+    run.passName = pass->getName().str();
+    run.opName = op->getName().getStringRef().str();
+    run.symbolName = getQualifiedSymbolName(op);
+    run.startSeconds =
+        std::chrono::duration<double>(activePass.startTime - startTime)
+            .count();
+    run.durationSeconds = seconds;
+    run.threadId = llvm::get_threadid();
+    executableRuns.push_back(std::move(run));
+  }
+}
+
+void PassProfiling::printJSON(llvm::raw_ostream &os) {
+  std::lock_guard<std::mutex> lock(mutex);
+  double totalSeconds =
+      std::chrono::duration<double>(Clock::now() - startTime).count();
+
+  // Passes taking the most time come first.
+  llvm::SmallVector<const llvm::StringMapEntry<PassStatistics> *> passes;
+  for (auto &entry : passStatistics) passes.push_back(&entry);
+  llvm::sort(passes, [](const auto *lhs, const auto *rhs) {
+    return lhs->second.selfSeconds > rhs->second.selfSeconds;
+  });
+
+  // Executable runs grouped by pass in the order the passes first ran.
+  llvm::SmallVector<std::string> executablePassNames;
+  llvm::StringMap<llvm::SmallVector<const ExecutableRun *>> executablesByPass;
+  for (auto &run : executableRuns) {
+    auto &runs = executablesByPass[run.passName];
+    if (runs.empty()) executablePassNames.push_back(run.passName);
+    runs.push_back(&run);
+  }
+
+  // Threads are numbered in the order they were first seen.
+  llvm::DenseMap<uint64_t, int64_t> threadIndices;
+  for (auto &run : executableRuns) {
+    threadIndices.try_emplace(run.threadId, threadIndices.size());
+  }
+
+  llvm::json::OStream json(os, /*IndentSize=*/2);
+  json.object([&] {
+    json.attribute("total_seconds", totalSeconds);
+    json.attribute("peak_memory_bytes", getPeakMemoryBytes());
+    json.attributeArray("passes", [&] {
+      for (auto *entry : passes) {
+        const auto &statistics = entry->second;
+        json.object([&] {
+          json.attribute("name", entry->first());
+          json.attribute("argument", statistics.argument);
+          json.attribute("count", statistics.count);
+          json.attribute("total_seconds", statistics.totalSeconds);
+          json.attribute("self_seconds", statistics.selfSeconds);
+          json.attribute("max_seconds", statistics.maxSeconds);
+          json.attribute("peak_memory_growth_bytes",
+                         statistics.peakMemoryGrowthBytes);
+        });
+      }
+    });
+    json.attributeArray("executable_passes", [&] {
+      for (auto &passName : executablePassNames) {
+        auto runs = executablesByPass[passName];
+        llvm::sort(runs, [](const auto *lhs, const auto *rhs) {
+          return lhs->durationSeconds > rhs->durationSeconds;
+        });
+        double firstStart = runs.front()->startSeconds;
+        double lastEnd = 0.0;
+        double busySeconds = 0.0;
+        llvm::DenseMap<uint64_t, int64_t> passThreads;
+        for (auto *run : runs) {
+          firstStart = std::min(firstStart, run->startSeconds);
+          lastEnd = std::max(lastEnd, run->startSeconds + run->durationSeconds);
+          busySeconds += run->durationSeconds;
+          passThreads.try_emplace(run->threadId, 0);
+        }
+        double wallSeconds = lastEnd - firstStart;
+        json.object([&] {
+          json.attribute("name", passName);
+          json.attribute("executable_count", static_cast<int64_t>(runs.size()));
+          json.attribute("thread_count",
+                         static_cast<int64_t>(passThreads.size()));
+          json.attribute("wall_seconds", wallSeconds);
+          json.attribute("busy_seconds", busySeconds);
+          // Average number of executables processed concurrently.
+          json.attribute("parallelism",
+                         wallSeconds > 0.0 ? busySeconds / wallSeconds : 1.0);
+          // Executables taking the most time come first; the first one bounds
+          // the wall time regardless of the available parallelism.
+          json.attributeArray("executables", [&] {
+            for (auto *run : runs) {
+              json.object([&] {
+                json.attribute("op", run->opName);
+                json.attribute("symbol", run->symbolName);
+                json.attribute("start_seconds", run->startSeconds);
+                json.attribute("duration_seconds", run->durationSeconds);
+                json.attribute("thread", threadIndices[run->threadId]);
+              });
+            }
+          });
+        });
+      }
+    });
+  });
+  os << "\n";
+}
+
+void registerPassProfilingCLOptions() {
+  // Make sure that the options struct has been constructed.
+  *clOptions;
+}
+
+PassProfiling *applyPassProfilingCLOptions(PassManager &passManager) {
+  if (!clOptions.isConstructed() || clOptions->file.empty()) return nullptr;
+  auto profiling = std::make_unique<PassProfiling>();
+  auto *profilingPtr = profiling.get();
+  passManager.addInstrumentation(std::move(profiling));
+  return profilingPtr;
+}
+
+LogicalResult writePassProfilingReport(PassProfiling &profiling) {
+  std::string errorMessage;
+  auto file = openOutputFile(clOptions->file, &errorMessage);
+  if (!file) {
+    llvm::errs() << "failed to open compile profile file '" << clOptions->file
+                 << "': " << errorMessage << "\n";
+    return failure();
+  }
+  profiling.printJSON(file->os());
+  file->keep();
+  return success();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,97 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_UTILS_PASSPROFILING_H_
+#define IREE_COMPILER_UTILS_PASSPROFILING_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Pass/PassManager.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Instruments passes to produce a JSON report of where compile time and
+// memory go.
+//
+// For each pass the report includes the number of times it ran, the wall time
+// including nested pipelines, the self time excluding the nested passes run on
+// the same thread, the longest single run and how much the process peak
+// resident memory grew while it ran. Runs anchored on hal.executable and
+// hal.executable.variant ops (such as those made by the executable translation
+// and serialization passes) are also reported individually with the thread
+// they ran on so that the parallelism achieved across executables and the
+// executables on the critical path can be identified.
+//
+// Usage:
+//   auto profiling = std::make_unique<PassProfiling>();
+//   auto *profilingPtr = profiling.get();
+//   passManager.addInstrumentation(std::move(profiling));
+//   ...
+//   profilingPtr->printJSON(os);
+class PassProfiling : public PassInstrumentation {
+ public:
+  PassProfiling();
+  ~PassProfiling() override = default;
+
+  void runBeforePass(Pass *pass, Operation *op) override;
+  void runAfterPass(Pass *pass, Operation *op) override;
+  void runAfterPassFailed(Pass *pass, Operation *op) override;
+
+  // Prints the report of all passes run so far to |os| as JSON.
+  void printJSON(llvm::raw_ostream &os);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PassStatistics {
+    std::string argument;
+    int64_t count = 0;
+    double totalSeconds = 0.0;
+    double selfSeconds = 0.0;
+    double maxSeconds = 0.0;
+    int64_t peakMemoryGrowthBytes = 0;
+  };
+
+  struct ExecutableRun {
+    std::string passName;
+    std::string opName;
+    std::string symbolName;
+    double startSeconds = 0.0;
+    double durationSeconds = 0.0;
+    uint64_t threadId = 0;
+  };
+
+  void endPass(Pass *pass, Operation *op);
+
+  Clock::time_point startTime;
+
+  std::mutex mutex;
+  llvm::StringMap<PassStatistics> passStatistics;
+  llvm::SmallVector<ExecutableRun> executableRuns;
+};
+
+// Registers the --iree-compile-profile-file command line option.
+void registerPassProfilingCLOptions();
+
+// Adds a PassProfiling instrumentation to |passManager| if requested on the
+// command line. Returns the instrumentation owned by |passManager| or nullptr.
+PassProfiling *applyPassProfilingCLOptions(PassManager &passManager);
+
+// Writes the report of |profiling| to the file specified on the command line.
+LogicalResult writePassProfilingReport(PassProfiling &profiling);
+
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_UTILS_PASSPROFILING_H_
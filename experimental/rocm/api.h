@@ -20,11 +20,29 @@ extern "C" {
 // iree_hal_rocm_driver_t
 //===----------------------------------------------------------------------===//
 
+// ncclUniqueId exposed without exporting the RCCL headers.
+typedef struct iree_hal_rocm_rccl_id_t {
+  char data[128];
+} iree_hal_rocm_rccl_id_t;
+
 // ROCM driver creation options.
 typedef struct iree_hal_rocm_driver_options_t {
   // Index of the default ROCM device to use within the list of available
   // devices.
   int default_device_index;
+
+  // Opaque RCCL ID used during channel creation when empty IDs are provided.
+  // If all zeros and |rccl_default_count| is set the driver generates one with
+  // ncclGetUniqueId, which requires NCCL_COMM_ID to be set so that all
+  // participants agree on it.
+  iree_hal_rocm_rccl_id_t rccl_default_id;
+  // Default rank of this participant used when IREE_HAL_CHANNEL_RANK_DEFAULT
+  // is specified on channel creation.
+  int rccl_default_rank;
+  // Default total number of participants used when
+  // IREE_HAL_CHANNEL_COUNT_DEFAULT is specified on channel creation. RCCL is
+  // only loaded by the driver when this is non-zero.
+  int rccl_default_count;
 } iree_hal_rocm_driver_options_t;
 
 IREE_API_EXPORT void iree_hal_rocm_driver_options_initialize(
@@ -13,10 +13,14 @@
 #include "experimental/rocm/dynamic_symbols.h"
 #include "experimental/rocm/native_executable.h"
 #include "experimental/rocm/pipeline_layout.h"
+#include "experimental/rocm/rccl_channel.h"
 #include "experimental/rocm/rocm_buffer.h"
 #include "experimental/rocm/status_util.h"
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/utils/collective_batch.h"
+#include "iree/hal/utils/resource_set.h"
 
 // Command buffer implementation that directly maps to rocm direct.
 // This records the commands on the calling thread without additional threading
@@ -27,15 +31,21 @@ typedef struct {
   iree_hal_rocm_context_wrapper_t* context;
   iree_arena_block_pool_t* block_pool;
 
+  // Maintains a reference to the channels and buffers used by collectives
+  // until the command buffer is destroyed.
+  iree_hal_resource_set_t* resource_set;
+
+  // Scratch storage for |collective_batch|. Reset on each begin.
+  iree_arena_allocator_t arena;
+
+  // Iteratively constructed batch of collective operations.
+  iree_hal_collective_batch_t collective_batch;
+
   // Keep track of the current set of kernel arguments.
   int32_t push_constant[IREE_HAL_ROCM_MAX_PUSH_CONSTANT_COUNT];
   void* current_descriptor[];
 } iree_hal_rocm_direct_command_buffer_t;
 
-#define IREE_HAL_ROCM_MAX_BINDING_COUNT 64
-// Kernel arguments contains binding and push constants.
-#define IREE_HAL_ROCM_MAX_KERNEL_ARG 128
-
 static const iree_hal_command_buffer_vtable_t
     iree_hal_rocm_direct_command_buffer_vtable;
 
@@ -83,8 +93,18 @@ iree_status_t iree_hal_rocm_direct_command_buffer_create(
     for (size_t i = 0; i < IREE_HAL_ROCM_MAX_KERNEL_ARG; i++) {
       command_buffer->current_descriptor[i] = &device_ptrs[i];
     }
-
+    iree_arena_initialize(block_pool, &command_buffer->arena);
+    status = iree_hal_resource_set_allocate(block_pool,
+                                            &command_buffer->resource_set);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_collective_batch_initialize(&command_buffer->arena,
+                                         command_buffer->resource_set,
+                                         &command_buffer->collective_batch);
     *out_command_buffer = &command_buffer->base;
+  } else if (command_buffer) {
+    iree_arena_deinitialize(&command_buffer->arena);
+    iree_allocator_free(context->host_allocator, command_buffer);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -97,6 +117,9 @@ static void iree_hal_rocm_direct_command_buffer_destroy(
       iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
+  iree_hal_resource_set_free(command_buffer->resource_set);
+  iree_arena_deinitialize(&command_buffer->arena);
   iree_allocator_free(command_buffer->context->host_allocator, command_buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -117,14 +140,45 @@ static void* iree_hal_rocm_direct_command_buffer_dyn_cast(
   return NULL;
 }
 
+// Flushes any pending batched collective operations.
+// Must be called before any other non-collective commands are issued or a
+// barrier is encountered.
+static iree_status_t iree_hal_rocm_direct_command_buffer_flush_collectives(
+    iree_hal_rocm_direct_command_buffer_t* command_buffer) {
+  if (IREE_LIKELY(iree_hal_collective_batch_is_empty(
+          &command_buffer->collective_batch))) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
+  // access proper stream from command buffer
+  iree_status_t status = iree_hal_rocm_rccl_submit_batch(
+      command_buffer->context, &command_buffer->collective_batch,
+      /*stream=*/NULL);
+  iree_hal_collective_batch_reset(&command_buffer->collective_batch);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_rocm_direct_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_rocm_direct_command_buffer_t* command_buffer =
+      iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+  // Batch entries live in the arena; re-initialize the batch over the reset
+  // arena so it does not reference the prior recording's storage.
+  iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
+  iree_arena_reset(&command_buffer->arena);
+  iree_hal_collective_batch_initialize(&command_buffer->arena,
+                                       command_buffer->resource_set,
+                                       &command_buffer->collective_batch);
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
-  return iree_ok_status();
+  iree_hal_rocm_direct_command_buffer_t* command_buffer =
+      iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+  return iree_hal_rocm_direct_command_buffer_flush_collectives(command_buffer);
 }
 
 static void iree_hal_rocm_direct_command_buffer_begin_debug_group(
@@ -148,8 +202,10 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_execution_barrier(
     const iree_hal_memory_barrier_t* memory_barriers,
     iree_host_size_t buffer_barrier_count,
     const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_rocm_direct_command_buffer_t* command_buffer =
+      iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
   // TODO: Implement barrier
-  return iree_ok_status();
+  return iree_hal_rocm_direct_command_buffer_flush_collectives(command_buffer);
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_signal_event(
@@ -175,8 +231,10 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_wait_events(
     const iree_hal_memory_barrier_t* memory_barriers,
     iree_host_size_t buffer_barrier_count,
     const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_rocm_direct_command_buffer_t* command_buffer =
+      iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
   // TODO: Implement barrier
-  return iree_ok_status();
+  return iree_hal_rocm_direct_command_buffer_flush_collectives(command_buffer);
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_discard_buffer(
@@ -192,6 +250,8 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_fill_buffer(
     iree_host_size_t pattern_length) {
   iree_hal_rocm_direct_command_buffer_t* command_buffer =
       iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_direct_command_buffer_flush_collectives(command_buffer));
 
   hipDeviceptr_t target_device_buffer = iree_hal_rocm_buffer_device_pointer(
       iree_hal_buffer_allocated_buffer(target_buffer));
@@ -244,6 +304,8 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_copy_buffer(
     iree_device_size_t length) {
   iree_hal_rocm_direct_command_buffer_t* command_buffer =
       iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_direct_command_buffer_flush_collectives(command_buffer));
 
   hipDeviceptr_t target_device_buffer = iree_hal_rocm_buffer_device_pointer(
       iree_hal_buffer_allocated_buffer(target_buffer));
@@ -267,8 +329,11 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_collective(
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "need rocm implementation");
+  iree_hal_rocm_direct_command_buffer_t* command_buffer =
+      iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+  return iree_hal_collective_batch_append(&command_buffer->collective_batch,
+                                          channel, op, param, send_binding,
+                                          recv_binding, element_count);
 }
 
 static iree_status_t iree_hal_rocm_direct_command_buffer_push_constants(
@@ -343,7 +408,8 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_dispatch(
     uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
   iree_hal_rocm_direct_command_buffer_t* command_buffer =
       iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
-  iree_hal_rocm_direct_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_direct_command_buffer_flush_collectives(command_buffer));
   iree_hal_pipeline_layout_t* layout =
       iree_hal_rocm_executable_get_layout(executable, entry_point);
   iree_host_size_t num_constants =
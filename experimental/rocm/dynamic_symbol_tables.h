@@ -47,3 +47,64 @@ RC_PFN_DECL(hipStreamCreateWithFlags, hipStream_t *, unsigned int)
 RC_PFN_DECL(hipStreamDestroy, hipStream_t)
 RC_PFN_DECL(hipStreamSynchronize, hipStream_t)
 RC_PFN_DECL(hipStreamWaitEvent, hipStream_t, hipEvent_t, unsigned int)
+RC_PFN_DECL(hipDeviceGetAttribute, int *, hipDeviceAttribute_t, int)
+RC_PFN_DECL(hipEventCreateWithFlags, hipEvent_t *, unsigned int)
+RC_PFN_DECL(hipEventDestroy, hipEvent_t)
+RC_PFN_DECL(hipEventQuery, hipEvent_t)
+RC_PFN_DECL(hipEventRecord, hipEvent_t, hipStream_t)
+RC_PFN_DECL(hipEventSynchronize, hipEvent_t)
+RC_PFN_DECL(hipLaunchHostFunc, hipStream_t, hipHostFn_t, void *)
+RC_PFN_DECL(hipGraphCreate, hipGraph_t *, unsigned int)
+RC_PFN_DECL(hipGraphDestroy, hipGraph_t)
+RC_PFN_DECL(hipGraphAddEmptyNode, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t)
+RC_PFN_DECL(hipGraphAddKernelNode, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, const hipKernelNodeParams *)
+RC_PFN_DECL(hipGraphAddMemsetNode, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, const hipMemsetParams *)
+RC_PFN_DECL(hipGraphAddMemcpyNode1D, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, void *, const void *, size_t,
+            hipMemcpyKind)
+RC_PFN_DECL(hipGraphAddChildGraphNode, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, hipGraph_t)
+RC_PFN_DECL(hipGraphInstantiate, hipGraphExec_t *, hipGraph_t,
+            hipGraphNode_t *, char *, size_t)
+RC_PFN_DECL(hipGraphExecDestroy, hipGraphExec_t)
+RC_PFN_DECL(hipGraphLaunch, hipGraphExec_t, hipStream_t)
+RC_PFN_DECL(hipStreamBeginCapture, hipStream_t, hipStreamCaptureMode)
+RC_PFN_DECL(hipStreamEndCapture, hipStream_t, hipGraph_t *)
+RC_PFN_DECL(hipMemPoolCreate, hipMemPool_t *, const hipMemPoolProps *)
+RC_PFN_DECL(hipMemPoolDestroy, hipMemPool_t)
+RC_PFN_DECL(hipMemPoolSetAttribute, hipMemPool_t, hipMemPoolAttr, void *)
+RC_PFN_DECL(hipMemPoolTrimTo, hipMemPool_t, size_t)
+RC_PFN_DECL(hipMallocFromPoolAsync, void **, size_t, hipMemPool_t,
+            hipStream_t)
+RC_PFN_DECL(hipFreeAsync, void *, hipStream_t)
+
+// RCCL symbols are loaded from a separate library and only when collectives
+// are requested; see iree_hal_rocm_rccl_dynamic_symbols_initialize.
+RCCL_PFN_DECL(ncclGetVersion, int *)
+RCCL_PFN_DECL(ncclGetUniqueId, ncclUniqueId *)
+RCCL_PFN_DECL(ncclCommInitRank, ncclComm_t *, int, ncclUniqueId, int)
+RCCL_PFN_DECL(ncclCommDestroy, ncclComm_t)
+RCCL_PFN_DECL(ncclCommAbort, ncclComm_t)
+RCCL_PFN_STR_DECL(ncclGetErrorString, ncclResult_t)
+RCCL_PFN_DECL(ncclCommGetAsyncError, ncclComm_t, ncclResult_t *)
+RCCL_PFN_DECL(ncclCommCount, const ncclComm_t, int *)
+RCCL_PFN_DECL(ncclCommUserRank, const ncclComm_t, int *)
+RCCL_PFN_DECL(ncclReduce, const void *, void *, size_t, ncclDataType_t,
+              ncclRedOp_t, int, ncclComm_t, hipStream_t)
+RCCL_PFN_DECL(ncclBroadcast, const void *, void *, size_t, ncclDataType_t, int,
+              ncclComm_t, hipStream_t)
+RCCL_PFN_DECL(ncclAllReduce, const void *, void *, size_t, ncclDataType_t,
+              ncclRedOp_t, ncclComm_t, hipStream_t)
+RCCL_PFN_DECL(ncclReduceScatter, const void *, void *, size_t, ncclDataType_t,
+              ncclRedOp_t, ncclComm_t, hipStream_t)
+RCCL_PFN_DECL(ncclAllGather, const void *, void *, size_t, ncclDataType_t,
+              ncclComm_t, hipStream_t)
+RCCL_PFN_DECL(ncclSend, const void *, size_t, ncclDataType_t, int, ncclComm_t,
+              hipStream_t)
+RCCL_PFN_DECL(ncclRecv, void *, size_t, ncclDataType_t, int, ncclComm_t,
+              hipStream_t)
+RCCL_PFN_DECL(ncclGroupStart)
+RCCL_PFN_DECL(ncclGroupEnd)
@@ -20,6 +20,14 @@ static const char* kROCMLoaderSearchNames[] = {
 #endif
 };
 
+static const char* kRCCLLoaderSearchNames[] = {
+#if defined(IREE_PLATFORM_WINDOWS)
+    "rccl.dll",
+#else
+    "librccl.so",
+#endif
+};
+
 static iree_status_t iree_hal_rocm_dynamic_symbols_resolve_all(
     iree_hal_rocm_dynamic_symbols_t* syms) {
 #define RC_PFN_DECL(rocmSymbolName, ...)                              \
@@ -29,9 +37,33 @@ static iree_status_t iree_hal_rocm_dynamic_symbols_resolve_all(
         syms->loader_library, kName, (void**)&syms->rocmSymbolName)); \
   }
 #define RC_PFN_STR_DECL(rocmSymbolName, ...) RC_PFN_DECL(rocmSymbolName, ...)
+#define RCCL_PFN_DECL(rcclSymbolName, ...)
+#define RCCL_PFN_STR_DECL(rcclSymbolName, ...)
 #include "experimental/rocm/dynamic_symbol_tables.h"  // IWYU pragma: keep
 #undef RC_PFN_DECL
 #undef RC_PFN_STR_DECL
+#undef RCCL_PFN_DECL
+#undef RCCL_PFN_STR_DECL
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_rocm_rccl_dynamic_symbols_resolve_all(
+    iree_hal_rocm_dynamic_symbols_t* syms) {
+#define RC_PFN_DECL(rocmSymbolName, ...)
+#define RC_PFN_STR_DECL(rocmSymbolName, ...)
+#define RCCL_PFN_DECL(rcclSymbolName, ...)                          \
+  {                                                                 \
+    static const char* kName = #rcclSymbolName;                     \
+    IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(        \
+        syms->rccl_library, kName, (void**)&syms->rcclSymbolName)); \
+  }
+#define RCCL_PFN_STR_DECL(rcclSymbolName, ...) \
+  RCCL_PFN_DECL(rcclSymbolName, ...)
+#include "experimental/rocm/dynamic_symbol_tables.h"  // IWYU pragma: keep
+#undef RC_PFN_DECL
+#undef RC_PFN_STR_DECL
+#undef RCCL_PFN_DECL
+#undef RCCL_PFN_STR_DECL
   return iree_ok_status();
 }
 
@@ -58,10 +90,58 @@ iree_status_t iree_hal_rocm_dynamic_symbols_initialize(
   return status;
 }
 
+iree_status_t iree_hal_rocm_rccl_dynamic_symbols_initialize(
+    iree_allocator_t allocator, iree_hal_rocm_dynamic_symbols_t* syms) {
+  if (!syms->loader_library) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "ROCM dynamic symbols must be loaded before RCCL");
+  }
+  if (syms->rccl_library) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_dynamic_library_load_from_files(
+      IREE_ARRAYSIZE(kRCCLLoaderSearchNames), kRCCLLoaderSearchNames,
+      IREE_DYNAMIC_LIBRARY_FLAG_NONE, allocator, &syms->rccl_library);
+  if (iree_status_is_not_found(status)) {
+    iree_status_ignore(status);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "RCCL runtime library not available; ensure installed and on path");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_rccl_dynamic_symbols_resolve_all(syms);
+  }
+
+  // RCCL follows the NCCL versioning scheme: only the minor version may be
+  // newer than the headers we were compiled against.
+  if (iree_status_is_ok(status)) {
+    int version = 0;
+    if (syms->ncclGetVersion(&version) != ncclSuccess) {
+      status = iree_make_status(IREE_STATUS_INTERNAL,
+                                "unable to query the RCCL version");
+    } else if (version / 10000 != NCCL_MAJOR ||
+               version < NCCL_VERSION(NCCL_MAJOR, NCCL_MINOR, 0)) {
+      status = iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "RCCL version %d.%d found but %d.%d or a newer %d.x is required",
+          version / 10000, (version % 10000) / 100, NCCL_MAJOR, NCCL_MINOR,
+          NCCL_MAJOR);
+    }
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_dynamic_library_release(syms->rccl_library);
+    syms->rccl_library = NULL;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 void iree_hal_rocm_dynamic_symbols_deinitialize(
     iree_hal_rocm_dynamic_symbols_t* syms) {
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_dynamic_library_release(syms->loader_library);
+  iree_dynamic_library_release(syms->rccl_library);
   memset(syms, 0, sizeof(*syms));
   IREE_TRACE_ZONE_END(z0);
 }
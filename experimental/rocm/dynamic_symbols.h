@@ -10,6 +10,7 @@
 #include "experimental/rocm/rocm_headers.h"
 #include "iree/base/api.h"
 #include "iree/base/internal/dynamic_library.h"
+#include "rccl/rccl.h"  // IWYU pragma: export
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,14 +22,22 @@ extern "C" {
 // the declarations in `hipruntime.h`.
 typedef struct iree_hal_rocm_dynamic_symbols_t {
   iree_dynamic_library_t* loader_library;
+  // Only loaded by iree_hal_rocm_rccl_dynamic_symbols_initialize.
+  iree_dynamic_library_t* rccl_library;
 
 #define RC_PFN_DECL(rocmSymbolName, ...) \
   hipError_t (*rocmSymbolName)(__VA_ARGS__);
 #define RC_PFN_STR_DECL(rocmSymbolName, ...) \
   const char* (*rocmSymbolName)(__VA_ARGS__);
+#define RCCL_PFN_DECL(rcclSymbolName, ...) \
+  ncclResult_t (*rcclSymbolName)(__VA_ARGS__);
+#define RCCL_PFN_STR_DECL(rcclSymbolName, ...) \
+  const char* (*rcclSymbolName)(__VA_ARGS__);
 #include "experimental/rocm/dynamic_symbol_tables.h"  // IWYU pragma: export
 #undef RC_PFN_DECL
 #undef RC_PFN_STR_DECL
+#undef RCCL_PFN_DECL
+#undef RCCL_PFN_STR_DECL
 } iree_hal_rocm_dynamic_symbols_t;
 
 // Initializes |out_syms| in-place with dynamically loaded ROCM symbols.
@@ -37,6 +46,13 @@ typedef struct iree_hal_rocm_dynamic_symbols_t {
 iree_status_t iree_hal_rocm_dynamic_symbols_initialize(
     iree_allocator_t allocator, iree_hal_rocm_dynamic_symbols_t* out_syms);
 
+// Initializes the RCCL symbols in |syms| in-place from the RCCL runtime
+// library. |syms| must already have been initialized with
+// iree_hal_rocm_dynamic_symbols_initialize. Returns IREE_STATUS_UNAVAILABLE if
+// the library cannot be found.
+iree_status_t iree_hal_rocm_rccl_dynamic_symbols_initialize(
+    iree_allocator_t allocator, iree_hal_rocm_dynamic_symbols_t* syms);
+
 // Deinitializes |syms| by unloading the backing library. All function pointers
 // will be invalidated. They _may_ still work if there are other reasons the
 // library remains loaded so be careful.
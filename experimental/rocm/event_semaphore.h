@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include "experimental/rocm/context_wrapper.h"
+#include "experimental/rocm/rocm_headers.h"
 #include "experimental/rocm/status_util.h"
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
@@ -23,6 +24,24 @@ iree_status_t iree_hal_rocm_semaphore_create(
     iree_hal_rocm_context_wrapper_t* context, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore);
 
+// Returns true if |semaphore| is a ROCm semaphore.
+bool iree_hal_rocm_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Makes work subsequently issued on |stream| wait until the ROCm |semaphore|
+// reaches |value|. If the signal has been enqueued on a stream the wait is
+// performed on the device with the event recorded for that signal. Otherwise
+// this blocks the calling thread until the signal is enqueued or made on the
+// host as HIP does not support wait-before-signal.
+iree_status_t iree_hal_rocm_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* semaphore, uint64_t value, hipStream_t stream);
+
+// Enqueues a signal of the ROCm |semaphore| to |value| once all work
+// previously issued on |stream| completes. Host queries and waits observe the
+// new value once the stream reaches the signal and other streams can wait on it
+// with iree_hal_rocm_semaphore_enqueue_wait.
+iree_status_t iree_hal_rocm_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* semaphore, uint64_t value, hipStream_t stream);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
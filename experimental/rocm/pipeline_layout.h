@@ -16,6 +16,9 @@ extern "C" {
 #endif  // __cplusplus
 
 #define IREE_HAL_ROCM_MAX_PUSH_CONSTANT_COUNT 64
+#define IREE_HAL_ROCM_MAX_BINDING_COUNT 64
+// Kernel arguments contains binding and push constants.
+#define IREE_HAL_ROCM_MAX_KERNEL_ARG 128
 
 //===----------------------------------------------------------------------===//
 // iree_hal_rocm_descriptor_set_layout_t
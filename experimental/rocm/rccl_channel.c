@@ -0,0 +1,331 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/rocm/rccl_channel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "experimental/rocm/dynamic_symbols.h"
+#include "experimental/rocm/rocm_buffer.h"
+#include "experimental/rocm/status_util.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+// Returns the same value as RCCL's init.cc hashUniqueId.
+// Only to be used for correlating debug logging/traces.
+static uint64_t iree_hal_rocm_rccl_hash_id(const iree_hal_rocm_rccl_id_t* id) {
+  uint64_t hash = 0xDEADBEEF;
+  for (iree_host_size_t i = 0; i < sizeof(*id); i++) {
+    hash ^= hash >> 32;
+    hash *= 0x8DB3DB47FA2994ADull;
+    hash += id->data[i];
+  }
+  return hash;
+}
+
+typedef struct iree_hal_rocm_rccl_channel_t {
+  iree_hal_resource_t resource;
+  iree_hal_rocm_context_wrapper_t* context_wrapper;
+
+  // Hash of the unique ID used to create the communicator.
+  // Not guaranteed to be unique - only use for informational purposes.
+  uint64_t id_hash;
+
+  // This participant's rank in the communicator.
+  // Equivalent to ncclCommUserRank.
+  int rank;
+  // Total number of participants in the communicator.
+  // Equivalent to ncclCommCount.
+  int count;
+
+  // Communicator handle.
+  ncclComm_t comm;
+} iree_hal_rocm_rccl_channel_t;
+
+static const iree_hal_channel_vtable_t iree_hal_rocm_rccl_channel_vtable;
+
+static iree_hal_rocm_rccl_channel_t* iree_hal_rocm_rccl_channel_cast(
+    iree_hal_channel_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_rocm_rccl_channel_vtable);
+  return (iree_hal_rocm_rccl_channel_t*)base_value;
+}
+
+iree_status_t iree_hal_rocm_rccl_channel_create(
+    iree_hal_rocm_context_wrapper_t* context_wrapper,
+    const iree_hal_rocm_rccl_id_t* id, int rank, int count,
+    iree_hal_channel_t** out_channel) {
+  IREE_ASSERT_ARGUMENT(context_wrapper);
+  IREE_ASSERT_ARGUMENT(id);
+  IREE_ASSERT_ARGUMENT(out_channel);
+  *out_channel = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const uint64_t id_hash = iree_hal_rocm_rccl_hash_id(id);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, id_hash);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, rank);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, count);
+
+  ncclComm_t comm = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, RCCL_RESULT_TO_STATUS(
+              context_wrapper->syms,
+              ncclCommInitRank(&comm, count, *((const ncclUniqueId*)id), rank),
+              "ncclCommInitRank"));
+
+  iree_hal_rocm_rccl_channel_t* channel = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      context_wrapper->host_allocator, sizeof(*channel), (void**)&channel);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_rocm_rccl_channel_vtable,
+                                 &channel->resource);
+    channel->context_wrapper = context_wrapper;
+    channel->id_hash = id_hash;
+    channel->rank = rank;
+    channel->count = count;
+    channel->comm = comm;
+    *out_channel = (iree_hal_channel_t*)channel;
+  } else {
+    RCCL_IGNORE_ERROR(context_wrapper->syms, ncclCommDestroy(comm));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_rocm_rccl_channel_destroy(
+    iree_hal_channel_t* base_channel) {
+  iree_hal_rocm_rccl_channel_t* channel =
+      iree_hal_rocm_rccl_channel_cast(base_channel);
+  iree_allocator_t host_allocator = channel->context_wrapper->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->id_hash);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->rank);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, channel->count);
+
+  // Blocks until all outstanding operations on the communicator complete.
+  RCCL_IGNORE_ERROR(channel->context_wrapper->syms,
+                    ncclCommDestroy(channel->comm));
+  iree_allocator_free(host_allocator, channel);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_rocm_rccl_channel_query_rank_and_count(
+    const iree_hal_channel_t* base_channel, int32_t* out_rank,
+    int32_t* out_count) {
+  IREE_ASSERT_ARGUMENT(base_channel);
+  iree_hal_rocm_rccl_channel_t* channel =
+      iree_hal_rocm_rccl_channel_cast((iree_hal_channel_t*)base_channel);
+  // NOTE: since it's cheap we keep rank/count local - this lets us trace them
+  // out without needing to call into RCCL each time.
+  *out_rank = channel->rank;
+  *out_count = channel->count;
+}
+
+static iree_status_t iree_hal_rocm_get_rccl_data_type(
+    iree_hal_collective_element_type_t in, ncclDataType_t* out) {
+  switch (in) {
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_8:
+      *out = ncclInt8;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_8:
+      *out = ncclUint8;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_16:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "SINT16 is not supported for collective op");
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_16:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "UINT16 is not supported for collective op");
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_32:
+      *out = ncclInt32;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_32:
+      *out = ncclUint32;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_64:
+      *out = ncclInt64;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_64:
+      *out = ncclUint64;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_16:
+      *out = ncclFloat16;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32:
+      *out = ncclFloat32;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_64:
+      *out = ncclFloat64;
+      break;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_BFLOAT_16:
+      *out = ncclBfloat16;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled element type for collective op");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_rocm_get_rccl_red_type(
+    iree_hal_collective_reduction_t in, ncclRedOp_t* out) {
+  switch (in) {
+    case IREE_HAL_COLLECTIVE_REDUCTION_SUM:
+      *out = ncclSum;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:
+      *out = ncclProd;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:
+      *out = ncclMin;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:
+      *out = ncclMax;
+      break;
+    case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:
+      *out = ncclAvg;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled reduction type for collective op");
+  }
+  return iree_ok_status();
+}
+
+// Returns the device pointer to the start of |binding|.
+static void* iree_hal_rocm_rccl_binding_ptr(iree_hal_buffer_binding_t binding) {
+  return (uint8_t*)iree_hal_rocm_buffer_device_pointer(
+             iree_hal_buffer_allocated_buffer(binding.buffer)) +
+         iree_hal_buffer_byte_offset(binding.buffer) + binding.offset;
+}
+
+static iree_status_t iree_hal_rocm_rccl_submit_batch_entry(
+    const iree_hal_collective_batch_entry_t* entry, hipStream_t stream) {
+  IREE_ASSERT_ARGUMENT(entry);
+
+  iree_hal_rocm_rccl_channel_t* channel =
+      iree_hal_rocm_rccl_channel_cast(entry->channel);
+  iree_hal_rocm_dynamic_symbols_t* syms = channel->context_wrapper->syms;
+  ncclComm_t comm = channel->comm;
+  ncclDataType_t datatype;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_rocm_get_rccl_data_type(entry->op.element_type, &datatype));
+
+  switch (entry->op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER: {
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclAllGather(iree_hal_rocm_rccl_binding_ptr(entry->send_binding),
+                        iree_hal_rocm_rccl_binding_ptr(entry->recv_binding),
+                        entry->element_count, datatype, comm, stream),
+          "ncclAllGather");
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE: {
+      ncclRedOp_t redop;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_rocm_get_rccl_red_type(entry->op.reduction, &redop));
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclAllReduce(iree_hal_rocm_rccl_binding_ptr(entry->send_binding),
+                        iree_hal_rocm_rccl_binding_ptr(entry->recv_binding),
+                        entry->element_count, datatype, redop, comm, stream),
+          "ncclAllReduce");
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST: {
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclBroadcast(iree_hal_rocm_rccl_binding_ptr(entry->send_binding),
+                        iree_hal_rocm_rccl_binding_ptr(entry->recv_binding),
+                        entry->element_count, datatype, entry->param, comm,
+                        stream),
+          "ncclBroadcast");
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE: {
+      ncclRedOp_t redop;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_rocm_get_rccl_red_type(entry->op.reduction, &redop));
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclReduce(iree_hal_rocm_rccl_binding_ptr(entry->send_binding),
+                     iree_hal_rocm_rccl_binding_ptr(entry->recv_binding),
+                     entry->element_count, datatype, redop, entry->param, comm,
+                     stream),
+          "ncclReduce");
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER: {
+      ncclRedOp_t redop;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_rocm_get_rccl_red_type(entry->op.reduction, &redop));
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclReduceScatter(
+              iree_hal_rocm_rccl_binding_ptr(entry->send_binding),
+              iree_hal_rocm_rccl_binding_ptr(entry->recv_binding),
+              entry->element_count, datatype, redop, comm, stream),
+          "ncclReduceScatter");
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_SEND: {
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclSend(iree_hal_rocm_rccl_binding_ptr(entry->send_binding),
+                   entry->element_count, datatype, entry->param, comm, stream),
+          "ncclSend");
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_RECV: {
+      RCCL_RETURN_IF_ERROR(
+          syms,
+          ncclRecv(iree_hal_rocm_rccl_binding_ptr(entry->recv_binding),
+                   entry->element_count, datatype, entry->param, comm, stream),
+          "ncclRecv");
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled collective op kind %d",
+                              (int)entry->op.kind);
+  }  // switch
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_rocm_rccl_submit_batch(
+    iree_hal_rocm_context_wrapper_t* context,
+    const iree_hal_collective_batch_t* batch, hipStream_t stream) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(batch);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)batch->count);
+
+  // Issue all collective operations in the batch as part of a group.
+  // RCCL may be able to fuse or reduce overheads by issuing like this and
+  // paired send/recv operations require it to avoid deadlocking.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, RCCL_RESULT_TO_STATUS(context->syms, ncclGroupStart(),
+                                "ncclGroupStart"));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < batch->count; ++i) {
+    status = iree_hal_rocm_rccl_submit_batch_entry(&batch->entries[i], stream);
+    if (!iree_status_is_ok(status)) break;
+  }
+  // Always close the group so that RCCL is usable again on failure.
+  status = iree_status_join(
+      status,
+      RCCL_RESULT_TO_STATUS(context->syms, ncclGroupEnd(), "ncclGroupEnd"));
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static const iree_hal_channel_vtable_t iree_hal_rocm_rccl_channel_vtable = {
+    .destroy = iree_hal_rocm_rccl_channel_destroy,
+    .query_rank_and_count = iree_hal_rocm_rccl_channel_query_rank_and_count,
+};
@@ -0,0 +1,42 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_ROCM_RCCL_CHANNEL_H_
+#define IREE_HAL_ROCM_RCCL_CHANNEL_H_
+
+#include "experimental/rocm/api.h"
+#include "experimental/rocm/context_wrapper.h"
+#include "experimental/rocm/rocm_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/collective_batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a channel backed by an RCCL communicator for participant |rank| of
+// |count|. Blocks until all participants have joined the communicator
+// identified by |id|. RCCL symbols must have been loaded into
+// |context_wrapper| with iree_hal_rocm_rccl_dynamic_symbols_initialize.
+iree_status_t iree_hal_rocm_rccl_channel_create(
+    iree_hal_rocm_context_wrapper_t* context_wrapper,
+    const iree_hal_rocm_rccl_id_t* id, int rank, int count,
+    iree_hal_channel_t** out_channel);
+
+// Performs a non-blocking submission of |batch| to |stream|.
+// The backing storage of |batch| is dropped immediately but all resources
+// referenced will be retained by the parent command buffer for its lifetime.
+// Note that operations in the batch may apply to different channels.
+iree_status_t iree_hal_rocm_rccl_submit_batch(
+    iree_hal_rocm_context_wrapper_t* context,
+    const iree_hal_collective_batch_t* batch, hipStream_t stream);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_ROCM_RCCL_CHANNEL_H_
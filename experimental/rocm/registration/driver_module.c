@@ -8,6 +8,7 @@
 
 #include <inttypes.h>
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "experimental/rocm/api.h"
 #include "iree/base/api.h"
@@ -26,6 +27,42 @@ static iree_status_t iree_hal_rocm_driver_factory_enumerate(
   return iree_ok_status();
 }
 
+// Populates the default RCCL rank and count from the environment.
+// Collectives are disabled unless IREE_ROCM_RCCL_NPROCS is set.
+static iree_status_t iree_hal_rocm_init_rccl_rank_and_count(
+    iree_hal_rocm_driver_options_t *options) {
+  options->rccl_default_count = 0;
+  options->rccl_default_rank = 0;
+
+  char *nprocs_str = getenv("IREE_ROCM_RCCL_NPROCS");
+  if (!nprocs_str) return iree_ok_status();
+  int nprocs = atoi(nprocs_str);
+  if (nprocs <= 0) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "IREE_ROCM_RCCL_NPROCS has invalid value '%s'; expected integer > 0",
+        nprocs_str);
+  }
+
+  char *procid_str = getenv("IREE_ROCM_RCCL_PROCID");
+  if (!procid_str) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "IREE_ROCM_RCCL_PROCID must be set when IREE_ROCM_RCCL_NPROCS is set");
+  }
+  int procid = atoi(procid_str);
+  if (procid < 0 || procid >= nprocs) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "IREE_ROCM_RCCL_PROCID has invalid value '%s'; "
+                            "expected integer in [0, %d)",
+                            procid_str, nprocs);
+  }
+
+  options->rccl_default_count = nprocs;
+  options->rccl_default_rank = procid;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_rocm_driver_factory_try_create(
     void *self, iree_string_view_t driver_name, iree_allocator_t host_allocator,
     iree_hal_driver_t **out_driver) {
@@ -39,8 +76,12 @@ static iree_status_t iree_hal_rocm_driver_factory_try_create(
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_hal_rocm_driver_options_t driver_options;
   iree_hal_rocm_driver_options_initialize(&driver_options);
-  iree_status_t status = iree_hal_rocm_driver_create(
-      driver_name, &driver_options, host_allocator, out_driver);
+  iree_status_t status =
+      iree_hal_rocm_init_rccl_rank_and_count(&driver_options);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_driver_create(driver_name, &driver_options,
+                                         host_allocator, out_driver);
+  }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
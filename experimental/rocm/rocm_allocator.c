@@ -7,6 +7,8 @@
 #include "experimental/rocm/rocm_allocator.h"
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "experimental/rocm/dynamic_symbols.h"
 #include "experimental/rocm/rocm_buffer.h"
@@ -18,6 +20,11 @@ typedef struct iree_hal_rocm_allocator_t {
   iree_hal_resource_t resource;
   iree_hal_device_t* base_device;
   iree_hal_rocm_context_wrapper_t* context;
+  hipDevice_t device;
+
+  // Memory pool used for queue-ordered allocations or NULL if the device does
+  // not support them.
+  hipMemPool_t async_pool;
 
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_rocm_allocator_t;
@@ -30,9 +37,54 @@ static iree_hal_rocm_allocator_t* iree_hal_rocm_allocator_cast(
   return (iree_hal_rocm_allocator_t*)base_value;
 }
 
+// Creates the memory pool used for queue-ordered allocations if the device
+// supports it. Devices without memory pool support fall back to synchronous
+// allocations.
+static iree_status_t iree_hal_rocm_allocator_create_async_pool(
+    iree_hal_rocm_allocator_t* allocator) {
+  int supports_memory_pools = 0;
+  IREE_RETURN_IF_ERROR(ROCM_RESULT_TO_STATUS(
+      allocator->context->syms,
+      hipDeviceGetAttribute(&supports_memory_pools,
+                            hipDeviceAttributeMemoryPoolsSupported,
+                            allocator->device),
+      "hipDeviceGetAttribute"));
+  if (!supports_memory_pools) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  hipMemPoolProps pool_props;
+  memset(&pool_props, 0, sizeof(pool_props));
+  pool_props.allocType = hipMemAllocationTypePinned;
+  pool_props.location.type = hipMemLocationTypeDevice;
+  pool_props.location.id = allocator->device;
+  hipMemPool_t pool = NULL;
+  iree_status_t status = ROCM_RESULT_TO_STATUS(
+      allocator->context->syms, hipMemPoolCreate(&pool, &pool_props),
+      "hipMemPoolCreate");
+
+  // The pool otherwise releases all unused memory at every synchronization
+  // point, making each allocation after a sync as expensive as hipMalloc.
+  if (iree_status_is_ok(status)) {
+    uint64_t threshold = UINT64_MAX;
+    status = ROCM_RESULT_TO_STATUS(
+        allocator->context->syms,
+        hipMemPoolSetAttribute(pool, hipMemPoolAttrReleaseThreshold,
+                               &threshold),
+        "hipMemPoolSetAttribute");
+  }
+
+  if (iree_status_is_ok(status)) {
+    allocator->async_pool = pool;
+  } else if (pool) {
+    ROCM_IGNORE_ERROR(allocator->context->syms, hipMemPoolDestroy(pool));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_rocm_allocator_create(
     iree_hal_device_t* base_device, iree_hal_rocm_context_wrapper_t* context,
-    iree_hal_allocator_t** out_allocator) {
+    hipDevice_t device, iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(base_device);
   IREE_ASSERT_ARGUMENT(context);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -44,7 +96,14 @@ iree_status_t iree_hal_rocm_allocator_create(
                                  &allocator->resource);
     allocator->context = context;
     allocator->base_device = base_device;
-    *out_allocator = (iree_hal_allocator_t*)allocator;
+    allocator->device = device;
+    allocator->async_pool = NULL;
+    status = iree_hal_rocm_allocator_create_async_pool(allocator);
+    if (iree_status_is_ok(status)) {
+      *out_allocator = (iree_hal_allocator_t*)allocator;
+    } else {
+      iree_hal_allocator_release((iree_hal_allocator_t*)allocator);
+    }
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -58,6 +117,10 @@ static void iree_hal_rocm_allocator_destroy(
   iree_allocator_t host_allocator = allocator->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (allocator->async_pool) {
+    ROCM_IGNORE_ERROR(allocator->context->syms,
+                      hipMemPoolDestroy(allocator->async_pool));
+  }
   iree_allocator_free(host_allocator, allocator);
 
   IREE_TRACE_ZONE_END(z0);
@@ -72,6 +135,15 @@ static iree_allocator_t iree_hal_rocm_allocator_host_allocator(
 
 static iree_status_t iree_hal_rocm_allocator_trim(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_rocm_allocator_t* allocator =
+      iree_hal_rocm_allocator_cast(base_allocator);
+  // Release the memory the pool keeps reserved; memory still in use (or not
+  // yet freed in stream order) is unaffected.
+  if (allocator->async_pool) {
+    ROCM_RETURN_IF_ERROR(allocator->context->syms,
+                         hipMemPoolTrimTo(allocator->async_pool, 0),
+                         "hipMemPoolTrimTo");
+  }
   return iree_ok_status();
 }
 
@@ -172,15 +244,23 @@ iree_hal_rocm_allocator_query_buffer_compatibility(
 }
 
 static void iree_hal_rocm_buffer_free(iree_hal_rocm_context_wrapper_t* context,
-                                      iree_hal_memory_type_t memory_type,
+                                      iree_hal_rocm_buffer_type_t buffer_type,
                                       hipDeviceptr_t device_ptr,
                                       void* host_ptr) {
-  if (iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
-    // Device local.
-    ROCM_IGNORE_ERROR(context->syms, hipFree(device_ptr));
-  } else {
-    // Host local.
-    ROCM_IGNORE_ERROR(context->syms, hipHostFree(host_ptr));
+  switch (buffer_type) {
+    case IREE_HAL_ROCM_BUFFER_TYPE_DEVICE:
+      ROCM_IGNORE_ERROR(context->syms, hipFree(device_ptr));
+      break;
+    case IREE_HAL_ROCM_BUFFER_TYPE_HOST:
+      ROCM_IGNORE_ERROR(context->syms, hipHostFree(host_ptr));
+      break;
+    case IREE_HAL_ROCM_BUFFER_TYPE_ASYNC:
+      // Buffers released without a queue-ordered deallocation are freed
+      // synchronously; those already freed in queue order have no pointer.
+      if (device_ptr) {
+        ROCM_IGNORE_ERROR(context->syms, hipFree(device_ptr));
+      }
+      break;
   }
 }
 
@@ -202,6 +282,7 @@ static iree_status_t iree_hal_rocm_allocator_allocate_buffer(
   }
 
   iree_status_t status = iree_ok_status();
+  iree_hal_rocm_buffer_type_t buffer_type = IREE_HAL_ROCM_BUFFER_TYPE_DEVICE;
   void* host_ptr = NULL;
   hipDeviceptr_t device_ptr = 0;
   if (iree_all_bits_set(compat_params.type,
@@ -219,6 +300,7 @@ static iree_status_t iree_hal_rocm_allocator_allocate_buffer(
                                      hipMalloc(&device_ptr, allocation_size));
     }
   } else {
+    buffer_type = IREE_HAL_ROCM_BUFFER_TYPE_HOST;
     unsigned int flags = hipHostMallocMapped;
     if (!iree_all_bits_set(compat_params.type,
                            IREE_HAL_MEMORY_TYPE_HOST_CACHED)) {
@@ -240,7 +322,8 @@ static iree_status_t iree_hal_rocm_allocator_allocate_buffer(
         (iree_hal_allocator_t*)allocator, compat_params.type,
         compat_params.access, compat_params.usage, allocation_size,
         /*byte_offset=*/0,
-        /*byte_length=*/allocation_size, device_ptr, host_ptr, &buffer);
+        /*byte_length=*/allocation_size, buffer_type, device_ptr, host_ptr,
+        &buffer);
   }
 
   // Copy the initial contents into the buffer. This may require staging.
@@ -261,8 +344,8 @@ static iree_status_t iree_hal_rocm_allocator_allocate_buffer(
     *out_buffer = buffer;
   } else {
     if (!buffer) {
-      iree_hal_rocm_buffer_free(allocator->context, compat_params.type,
-                                device_ptr, host_ptr);
+      iree_hal_rocm_buffer_free(allocator->context, buffer_type, device_ptr,
+                                host_ptr);
     } else {
       iree_hal_buffer_release(buffer);
     }
@@ -277,13 +360,20 @@ static void iree_hal_rocm_allocator_deallocate_buffer(
       iree_hal_rocm_allocator_cast(base_allocator);
 
   iree_hal_memory_type_t memory_type = iree_hal_buffer_memory_type(base_buffer);
-  iree_hal_rocm_buffer_free(allocator->context, memory_type,
-                            iree_hal_rocm_buffer_device_pointer(base_buffer),
+  hipDeviceptr_t device_ptr = iree_hal_rocm_buffer_device_pointer(base_buffer);
+  iree_hal_rocm_buffer_free(allocator->context,
+                            iree_hal_rocm_buffer_type(base_buffer), device_ptr,
                             iree_hal_rocm_buffer_host_pointer(base_buffer));
 
-  IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
-      &allocator->statistics, memory_type,
-      iree_hal_buffer_allocation_size(base_buffer)));
+  // Queue-ordered frees are recorded by iree_hal_rocm_allocator_free_async and
+  // leave the buffer without a device pointer.
+  if (iree_hal_rocm_buffer_type(base_buffer) !=
+          IREE_HAL_ROCM_BUFFER_TYPE_ASYNC ||
+      device_ptr) {
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+        &allocator->statistics, memory_type,
+        iree_hal_buffer_allocation_size(base_buffer)));
+  }
 
   iree_hal_buffer_destroy(base_buffer);
 }
@@ -308,6 +398,93 @@ static iree_status_t iree_hal_rocm_allocator_export_buffer(
                           "exporting to external buffers not supported");
 }
 
+bool iree_hal_rocm_allocator_supports_async(
+    iree_hal_allocator_t* base_allocator,
+    const iree_hal_buffer_params_t* params) {
+  if (!iree_hal_resource_is(base_allocator, &iree_hal_rocm_allocator_vtable)) {
+    return false;
+  }
+  iree_hal_rocm_allocator_t* allocator =
+      iree_hal_rocm_allocator_cast(base_allocator);
+  // Pool memory is device-only; host-visible buffers take the synchronous path.
+  return allocator->async_pool &&
+         iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) &&
+         !iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE);
+}
+
+iree_status_t iree_hal_rocm_allocator_alloc_async(
+    iree_hal_allocator_t* base_allocator, hipStream_t stream,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  iree_hal_rocm_allocator_t* allocator =
+      iree_hal_rocm_allocator_cast(base_allocator);
+  IREE_ASSERT(allocator->async_pool);
+
+  iree_hal_buffer_params_t compat_params = *params;
+  if (!iree_all_bits_set(iree_hal_rocm_allocator_query_buffer_compatibility(
+                             base_allocator, &compat_params, &allocation_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, allocation_size);
+  hipDeviceptr_t device_ptr = 0;
+  iree_status_t status = ROCM_RESULT_TO_STATUS(
+      allocator->context->syms,
+      hipMallocFromPoolAsync(&device_ptr, allocation_size,
+                             allocator->async_pool, stream),
+      "hipMallocFromPoolAsync");
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_buffer_wrap(
+        base_allocator, compat_params.type, compat_params.access,
+        compat_params.usage, allocation_size,
+        /*byte_offset=*/0,
+        /*byte_length=*/allocation_size, IREE_HAL_ROCM_BUFFER_TYPE_ASYNC,
+        device_ptr, /*host_ptr=*/NULL, &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, compat_params.type, allocation_size));
+    *out_buffer = buffer;
+  } else if (device_ptr) {
+    ROCM_IGNORE_ERROR(allocator->context->syms,
+                      hipFreeAsync(device_ptr, stream));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_rocm_allocator_free_async(
+    iree_hal_allocator_t* base_allocator, hipStream_t stream,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_rocm_allocator_t* allocator =
+      iree_hal_rocm_allocator_cast(base_allocator);
+  IREE_ASSERT_EQ(iree_hal_rocm_buffer_type(buffer),
+                 IREE_HAL_ROCM_BUFFER_TYPE_ASYNC);
+  hipDeviceptr_t device_ptr = iree_hal_rocm_buffer_device_pointer(buffer);
+  if (!device_ptr) return iree_ok_status();  // already freed
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status =
+      ROCM_RESULT_TO_STATUS(allocator->context->syms,
+                            hipFreeAsync(device_ptr, stream), "hipFreeAsync");
+  if (iree_status_is_ok(status)) {
+    iree_hal_rocm_buffer_set_device_pointer(buffer, 0);
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+        &allocator->statistics, iree_hal_buffer_memory_type(buffer),
+        iree_hal_buffer_allocation_size(buffer)));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static const iree_hal_allocator_vtable_t iree_hal_rocm_allocator_vtable = {
     .destroy = iree_hal_rocm_allocator_destroy,
     .host_allocator = iree_hal_rocm_allocator_host_allocator,
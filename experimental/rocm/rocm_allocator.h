@@ -17,9 +17,31 @@ extern "C" {
 #endif  // __cplusplus
 
 // Create a ROCM allocator.
+// If the device supports memory pools one is created for queue-ordered
+// allocations that keeps all unused memory reserved until trimmed.
 iree_status_t iree_hal_rocm_allocator_create(
     iree_hal_device_t* base_device, iree_hal_rocm_context_wrapper_t* context,
-    iree_hal_allocator_t** out_allocator);
+    hipDevice_t device, iree_hal_allocator_t** out_allocator);
+
+// Returns true if |allocator| is a ROCM allocator that can service
+// queue-ordered allocations of buffers with the given |params|.
+bool iree_hal_rocm_allocator_supports_async(
+    iree_hal_allocator_t* allocator, const iree_hal_buffer_params_t* params);
+
+// Allocates a device-local buffer from the allocator memory pool in the order
+// of |stream|. The buffer contents are only valid for work issued on |stream|
+// after this call or work ordered after it with events.
+iree_status_t iree_hal_rocm_allocator_alloc_async(
+    iree_hal_allocator_t* allocator, hipStream_t stream,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Frees the memory of an IREE_HAL_ROCM_BUFFER_TYPE_ASYNC |buffer| in the order
+// of |stream|. The buffer object remains valid until released but its contents
+// must not be accessed by work ordered after the free.
+iree_status_t iree_hal_rocm_allocator_free_async(
+    iree_hal_allocator_t* allocator, hipStream_t stream,
+    iree_hal_buffer_t* buffer);
 
 #ifdef __cplusplus
 }  // extern "C"
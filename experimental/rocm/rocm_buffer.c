@@ -15,6 +15,7 @@
 
 typedef struct iree_hal_rocm_buffer_t {
   iree_hal_buffer_t base;
+  iree_hal_rocm_buffer_type_t type;
   void* host_ptr;
   hipDeviceptr_t device_ptr;
 } iree_hal_rocm_buffer_t;
@@ -27,12 +28,19 @@ static iree_hal_rocm_buffer_t* iree_hal_rocm_buffer_cast(
   return (iree_hal_rocm_buffer_t*)base_value;
 }
 
+static const iree_hal_rocm_buffer_t* iree_hal_rocm_buffer_const_cast(
+    const iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_rocm_buffer_vtable);
+  return (const iree_hal_rocm_buffer_t*)base_value;
+}
+
 iree_status_t iree_hal_rocm_buffer_wrap(
     iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
     iree_hal_memory_access_t allowed_access,
     iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
     iree_device_size_t byte_offset, iree_device_size_t byte_length,
-    hipDeviceptr_t device_ptr, void* host_ptr, iree_hal_buffer_t** out_buffer) {
+    iree_hal_rocm_buffer_type_t buffer_type, hipDeviceptr_t device_ptr,
+    void* host_ptr, iree_hal_buffer_t** out_buffer) {
   IREE_ASSERT_ARGUMENT(allocator);
   IREE_ASSERT_ARGUMENT(out_buffer);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -47,6 +55,7 @@ iree_status_t iree_hal_rocm_buffer_wrap(
                                allocation_size, byte_offset, byte_length,
                                memory_type, allowed_access, allowed_usage,
                                &iree_hal_rocm_buffer_vtable, &buffer->base);
+    buffer->type = buffer_type;
     buffer->host_ptr = host_ptr;
     buffer->device_ptr = device_ptr;
     *out_buffer = &buffer->base;
@@ -115,12 +124,29 @@ static iree_status_t iree_hal_rocm_buffer_flush_range(
   return iree_ok_status();
 }
 
+bool iree_hal_rocm_buffer_isa(const iree_hal_buffer_t* buffer) {
+  return iree_hal_resource_is(buffer, &iree_hal_rocm_buffer_vtable);
+}
+
+iree_hal_rocm_buffer_type_t iree_hal_rocm_buffer_type(
+    const iree_hal_buffer_t* base_buffer) {
+  const iree_hal_rocm_buffer_t* buffer =
+      iree_hal_rocm_buffer_const_cast(base_buffer);
+  return buffer->type;
+}
+
 hipDeviceptr_t iree_hal_rocm_buffer_device_pointer(
     iree_hal_buffer_t* base_buffer) {
   iree_hal_rocm_buffer_t* buffer = iree_hal_rocm_buffer_cast(base_buffer);
   return buffer->device_ptr;
 }
 
+void iree_hal_rocm_buffer_set_device_pointer(iree_hal_buffer_t* base_buffer,
+                                             hipDeviceptr_t device_ptr) {
+  iree_hal_rocm_buffer_t* buffer = iree_hal_rocm_buffer_cast(base_buffer);
+  buffer->device_ptr = device_ptr;
+}
+
 void* iree_hal_rocm_buffer_host_pointer(iree_hal_buffer_t* base_buffer) {
   iree_hal_rocm_buffer_t* buffer = iree_hal_rocm_buffer_cast(base_buffer);
   return buffer->host_ptr;
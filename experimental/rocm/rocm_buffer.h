@@ -15,19 +15,43 @@
 extern "C" {
 #endif  // __cplusplus
 
+typedef enum iree_hal_rocm_buffer_type_e {
+  // hipMalloc/hipMallocManaged + hipFree
+  IREE_HAL_ROCM_BUFFER_TYPE_DEVICE = 1u << 0,
+  // hipMemAllocHost + hipHostFree
+  IREE_HAL_ROCM_BUFFER_TYPE_HOST = 1u << 1,
+  // hipMallocFromPoolAsync + hipFreeAsync (or hipFree if the buffer is
+  // released without a queue-ordered deallocation).
+  IREE_HAL_ROCM_BUFFER_TYPE_ASYNC = 1u << 2,
+} iree_hal_rocm_buffer_type_t;
+
 // Wraps a ROCm allocation in an iree_hal_buffer_t.
 iree_status_t iree_hal_rocm_buffer_wrap(
     iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
     iree_hal_memory_access_t allowed_access,
     iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
     iree_device_size_t byte_offset, iree_device_size_t byte_length,
-    hipDeviceptr_t device_ptr, void* host_ptr, iree_hal_buffer_t** out_buffer);
+    iree_hal_rocm_buffer_type_t buffer_type, hipDeviceptr_t device_ptr,
+    void* host_ptr, iree_hal_buffer_t** out_buffer);
+
+// Returns true if |buffer| is a ROCm buffer.
+bool iree_hal_rocm_buffer_isa(const iree_hal_buffer_t* buffer);
+
+// Returns the underlying ROCm buffer type.
+iree_hal_rocm_buffer_type_t iree_hal_rocm_buffer_type(
+    const iree_hal_buffer_t* buffer);
 
 // Returns the ROCm base pointer for the given |buffer|.
 // This is the entire allocated_buffer and must be offset by the buffer
 // byte_offset and byte_length when used.
 hipDeviceptr_t iree_hal_rocm_buffer_device_pointer(iree_hal_buffer_t* buffer);
 
+// Replaces the ROCm base pointer of |buffer|. Used to drop the pointer of an
+// IREE_HAL_ROCM_BUFFER_TYPE_ASYNC buffer once it has been freed in queue order
+// so that the allocation is not freed again when the buffer is destroyed.
+void iree_hal_rocm_buffer_set_device_pointer(iree_hal_buffer_t* buffer,
+                                             hipDeviceptr_t device_ptr);
+
 // Returns the ROCm host pointer for the given |buffer|, if available.
 void* iree_hal_rocm_buffer_host_pointer(iree_hal_buffer_t* buffer);
 
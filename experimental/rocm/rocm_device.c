@@ -14,19 +14,35 @@
 #include "experimental/rocm/direct_command_buffer.h"
 #include "experimental/rocm/dynamic_symbols.h"
 #include "experimental/rocm/event_semaphore.h"
+#include "experimental/rocm/graph_command_buffer.h"
 #include "experimental/rocm/nop_executable_cache.h"
 #include "experimental/rocm/pipeline_layout.h"
+#include "experimental/rocm/rccl_channel.h"
 #include "experimental/rocm/rocm_allocator.h"
+#include "experimental/rocm/rocm_buffer.h"
 #include "experimental/rocm/rocm_event.h"
 #include "experimental/rocm/status_util.h"
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/resource_set.h"
+#include "iree/hal/utils/semaphore_base.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_rocm_device_t
 //===----------------------------------------------------------------------===//
 
+// A submission that may still be executing on the device stream.
+// Resources used by the submission are retained until the completion event has
+// been reached.
+typedef struct iree_hal_rocm_submission_t {
+  struct iree_hal_rocm_submission_t* next;
+  hipEvent_t completion_event;
+  iree_hal_resource_set_t* resource_set;
+} iree_hal_rocm_submission_t;
+
 typedef struct iree_hal_rocm_device_t {
   iree_hal_resource_t resource;
   iree_string_view_t identifier;
@@ -46,6 +62,17 @@ typedef struct iree_hal_rocm_device_t {
   iree_hal_rocm_context_wrapper_t context_wrapper;
   iree_hal_allocator_t* device_allocator;
 
+  // Defaults used for channels created without an explicit ID/rank/count.
+  iree_hal_rocm_rccl_id_t rccl_default_id;
+  int rccl_default_rank;
+  int rccl_default_count;
+
+  // Guards submission to the stream and the submission list.
+  iree_slim_mutex_t mutex;
+
+  // FIFO of submissions not yet known to have completed in stream order.
+  iree_hal_rocm_submission_t* submission_head IREE_GUARDED_BY(mutex);
+  iree_hal_rocm_submission_t* submission_tail IREE_GUARDED_BY(mutex);
 } iree_hal_rocm_device_t;
 
 static const iree_hal_device_vtable_t iree_hal_rocm_device_vtable;
@@ -56,16 +83,53 @@ static iree_hal_rocm_device_t* iree_hal_rocm_device_cast(
   return (iree_hal_rocm_device_t*)base_value;
 }
 
+// Releases resources of all submissions that have completed.
+// If |wait| is true then blocks until all submissions have completed.
+// Must be called with the device mutex held.
+static iree_status_t iree_hal_rocm_device_retire_submissions(
+    iree_hal_rocm_device_t* device, bool wait) {
+  iree_hal_rocm_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  iree_status_t status = iree_ok_status();
+  while (device->submission_head) {
+    iree_hal_rocm_submission_t* submission = device->submission_head;
+    hipError_t result =
+        wait ? syms->hipEventSynchronize(submission->completion_event)
+             : syms->hipEventQuery(submission->completion_event);
+    if (result == hipErrorNotReady) break;
+    if (result != hipSuccess) {
+      status = iree_hal_rocm_result_to_status(syms, result, __FILE__, __LINE__);
+      break;
+    }
+    device->submission_head = submission->next;
+    if (!device->submission_head) device->submission_tail = NULL;
+    ROCM_IGNORE_ERROR(syms, hipEventDestroy(submission->completion_event));
+    iree_hal_resource_set_free(submission->resource_set);
+    iree_allocator_free(device->context_wrapper.host_allocator, submission);
+  }
+  return status;
+}
+
 static void iree_hal_rocm_device_destroy(iree_hal_device_t* base_device) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Wait for all in-flight work and release the resources it retained.
+  ROCM_IGNORE_ERROR(device->context_wrapper.syms,
+                    hipStreamSynchronize(device->stream));
+  iree_slim_mutex_lock(&device->mutex);
+  iree_status_ignore(
+      iree_hal_rocm_device_retire_submissions(device, /*wait=*/true));
+  iree_slim_mutex_unlock(&device->mutex);
+
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
   ROCM_IGNORE_ERROR(device->context_wrapper.syms,
                     hipStreamDestroy(device->stream));
 
+  iree_arena_block_pool_deinitialize(&device->block_pool);
+  iree_slim_mutex_deinitialize(&device->mutex);
+
   // Finally, destroy the device.
   iree_hal_driver_release(device->driver);
 
@@ -76,9 +140,9 @@ static void iree_hal_rocm_device_destroy(iree_hal_device_t* base_device) {
 
 static iree_status_t iree_hal_rocm_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
-    hipDevice_t rocm_device, hipStream_t stream, hipCtx_t context,
-    iree_hal_rocm_dynamic_symbols_t* syms, iree_allocator_t host_allocator,
-    iree_hal_device_t** out_device) {
+    const iree_hal_rocm_driver_options_t* options, hipDevice_t rocm_device,
+    hipStream_t stream, hipCtx_t context, iree_hal_rocm_dynamic_symbols_t* syms,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_rocm_device_t* device = NULL;
   iree_host_size_t total_size = sizeof(*device) + identifier.size;
   IREE_RETURN_IF_ERROR(
@@ -95,8 +159,14 @@ static iree_status_t iree_hal_rocm_device_create_internal(
   device->context_wrapper.rocm_context = context;
   device->context_wrapper.host_allocator = host_allocator;
   device->context_wrapper.syms = syms;
+  device->rccl_default_id = options->rccl_default_id;
+  device->rccl_default_rank = options->rccl_default_rank;
+  device->rccl_default_count = options->rccl_default_count;
+  iree_arena_block_pool_initialize(32 * 1024, host_allocator,
+                                   &device->block_pool);
+  iree_slim_mutex_initialize(&device->mutex);
   iree_status_t status = iree_hal_rocm_allocator_create(
-      (iree_hal_device_t*)device, &device->context_wrapper,
+      (iree_hal_device_t*)device, &device->context_wrapper, rocm_device,
       &device->device_allocator);
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
@@ -106,12 +176,11 @@ static iree_status_t iree_hal_rocm_device_create_internal(
   return status;
 }
 
-iree_status_t iree_hal_rocm_device_create(iree_hal_driver_t* driver,
-                                          iree_string_view_t identifier,
-                                          iree_hal_rocm_dynamic_symbols_t* syms,
-                                          hipDevice_t device,
-                                          iree_allocator_t host_allocator,
-                                          iree_hal_device_t** out_device) {
+iree_status_t iree_hal_rocm_device_create(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_rocm_driver_options_t* options,
+    iree_hal_rocm_dynamic_symbols_t* syms, hipDevice_t device,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   IREE_TRACE_ZONE_BEGIN(z0);
   hipCtx_t context;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -121,9 +190,9 @@ iree_status_t iree_hal_rocm_device_create(iree_hal_driver_t* driver,
       syms, hipStreamCreateWithFlags(&stream, hipStreamNonBlocking));
 
   if (iree_status_is_ok(status)) {
-    status = iree_hal_rocm_device_create_internal(driver, identifier, device,
-                                                  stream, context, syms,
-                                                  host_allocator, out_device);
+    status = iree_hal_rocm_device_create_internal(
+        driver, identifier, options, device, stream, context, syms,
+        host_allocator, out_device);
   }
   if (!iree_status_is_ok(status)) {
     if (stream) {
@@ -184,15 +253,72 @@ static iree_status_t iree_hal_rocm_device_query_i64(
 
 static iree_status_t iree_hal_rocm_device_trim(iree_hal_device_t* base_device) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  iree_slim_mutex_lock(&device->mutex);
+  iree_status_t status =
+      iree_hal_rocm_device_retire_submissions(device, /*wait=*/false);
+  iree_slim_mutex_unlock(&device->mutex);
+  IREE_RETURN_IF_ERROR(status);
   iree_arena_block_pool_trim(&device->block_pool);
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
+// Returns true if |id| is all zeros indicating an empty ID.
+static bool iree_hal_rocm_rccl_id_is_empty(const iree_hal_rocm_rccl_id_t* id) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(id->data); ++i) {
+    if (id->data[i] != 0) return false;
+  }
+  return true;
+}
+
 static iree_status_t iree_hal_rocm_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not implemented");
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  if (!device->context_wrapper.syms->rccl_library) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "RCCL is not loaded; the driver must be created with a non-zero "
+        "rccl_default_count (IREE_ROCM_RCCL_NPROCS) to use collectives");
+  }
+
+  // Try to use the ID specified in the parameters and fall back to the default.
+  iree_hal_rocm_rccl_id_t id;
+  if (iree_const_byte_span_is_empty(params.id)) {
+    id = device->rccl_default_id;
+  } else if (params.id.data_length != IREE_ARRAYSIZE(id.data)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "RCCL ID must be %d bytes matching the ncclUniqueId struct",
+        (int)IREE_ARRAYSIZE(id.data));
+  } else {
+    // User provided the ID - we treat it as opaque here and let RCCL validate.
+    memcpy(id.data, params.id.data, IREE_ARRAYSIZE(id.data));
+  }
+  if (iree_hal_rocm_rccl_id_is_empty(&id)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "no default RCCL ID specified (all zeros)");
+  }
+
+  // Only a single logical device per channel is supported.
+  int requested_count = iree_math_count_ones_u64(queue_affinity);
+  if (requested_count != 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "exactly one participant is allowed in a "
+                            "channel but %d were specified",
+                            requested_count);
+  }
+
+  int rank = params.rank;
+  if (rank == IREE_HAL_CHANNEL_RANK_DEFAULT) {
+    rank = device->rccl_default_rank;
+  }
+  int count = params.count;
+  if (count == IREE_HAL_CHANNEL_COUNT_DEFAULT) {
+    count = device->rccl_default_count;
+  }
+
+  return iree_hal_rocm_rccl_channel_create(&device->context_wrapper, &id, rank,
+                                           count, out_channel);
 }
 
 static iree_status_t iree_hal_rocm_device_create_command_buffer(
@@ -201,7 +327,18 @@ static iree_status_t iree_hal_rocm_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  return iree_hal_rocm_direct_command_buffer_create(
+  if (iree_all_bits_set(mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
+    // The caller has indicated the command buffer can be executed as it is
+    // recorded so the direct command buffer can issue commands immediately.
+    return iree_hal_rocm_direct_command_buffer_create(
+        base_device, &device->context_wrapper, mode, command_categories,
+        queue_affinity, binding_capacity, &device->block_pool,
+        out_command_buffer);
+  }
+  // Other command buffers are recorded into graphs so that submission is a
+  // single launch instead of one API call per command.
+  return iree_hal_rocm_graph_command_buffer_create(
       base_device, &device->context_wrapper, mode, command_categories,
       queue_affinity, binding_capacity, &device->block_pool,
       out_command_buffer);
@@ -255,10 +392,148 @@ static iree_status_t iree_hal_rocm_device_create_semaphore(
 static iree_hal_semaphore_compatibility_t
 iree_hal_rocm_device_query_semaphore_compatibility(
     iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
-  // TODO: implement ROCM semaphores.
+  if (iree_hal_rocm_semaphore_isa(semaphore)) {
+    // ROCM semaphores are waited and signaled on the stream with events.
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
+  // Other semaphores are waited and signaled from the host.
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+// Issues |command_buffers| on the device stream. Direct command buffers have
+// already executed on the default stream as they were recorded and only need
+// to be ordered before the work that follows.
+// Must be called with the device mutex held.
+static iree_status_t iree_hal_rocm_device_issue_command_buffers(
+    iree_hal_rocm_device_t* device, iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  bool did_synchronize = false;
+  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
+    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
+    if (iree_hal_rocm_graph_command_buffer_isa(command_buffer)) {
+      hipGraphExec_t exec =
+          iree_hal_rocm_graph_command_buffer_handle(command_buffer);
+      ROCM_RETURN_IF_ERROR(device->context_wrapper.syms,
+                           hipGraphLaunch(exec, device->stream),
+                           "hipGraphLaunch");
+    } else if (!did_synchronize) {
+      // TODO(raikonenfnu): currently direct command buffers run on the
+      // default/null stream; when they work with device->stream this can be
+      // dropped.
+      ROCM_RETURN_IF_ERROR(device->context_wrapper.syms,
+                           hipStreamSynchronize(0), "hipStreamSynchronize");
+      did_synchronize = true;
+    }
+  }
+  return iree_ok_status();
+}
+
+// Tracks a submission of |command_buffers| by recording an event after it on
+// the device stream. The command buffers and the semaphores in
+// |signal_semaphore_list| (which have host functions pending on the stream) are
+// retained until the event is reached.
+// Must be called with the device mutex held.
+static iree_status_t iree_hal_rocm_device_track_submission(
+    iree_hal_rocm_device_t* device,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_hal_rocm_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  iree_hal_rocm_submission_t* submission = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      device->context_wrapper.host_allocator, sizeof(*submission),
+      (void**)&submission));
+  memset(submission, 0, sizeof(*submission));
+
+  iree_status_t status = iree_hal_resource_set_allocate(
+      &device->block_pool, &submission->resource_set);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(submission->resource_set,
+                                          command_buffer_count,
+                                          command_buffers);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(submission->resource_set,
+                                          signal_semaphore_list.count,
+                                          signal_semaphore_list.semaphores);
+  }
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(
+        syms, hipEventCreateWithFlags(&submission->completion_event,
+                                      hipEventDisableTiming));
+  }
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(
+        syms, hipEventRecord(submission->completion_event, device->stream));
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (device->submission_tail) {
+      device->submission_tail->next = submission;
+    } else {
+      device->submission_head = submission;
+    }
+    device->submission_tail = submission;
+  } else {
+    if (submission->completion_event) {
+      ROCM_IGNORE_ERROR(syms, hipEventDestroy(submission->completion_event));
+    }
+    iree_hal_resource_set_free(submission->resource_set);
+    iree_allocator_free(device->context_wrapper.host_allocator, submission);
+  }
+  return status;
+}
+
+// Makes the device stream wait on the events recorded for semaphore signals.
+// Semaphores from other devices are waited on the host. This may block until
+// the signals are enqueued so it must be called without holding the device
+// lock that the signaling submissions may need.
+static iree_status_t iree_hal_rocm_device_enqueue_waits(
+    iree_hal_rocm_device_t* device,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    uint64_t value = wait_semaphore_list.payload_values[i];
+    if (iree_hal_rocm_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_rocm_semaphore_enqueue_wait(
+          semaphore, value, device->stream));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(semaphore, value,
+                                                   iree_infinite_timeout()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Signals |signal_semaphore_list| once the device stream reaches this point.
+// Semaphores from other devices can only be signaled from the host after the
+// stream drains.
+// Must be called with the device mutex held.
+static iree_status_t iree_hal_rocm_device_enqueue_signals(
+    iree_hal_rocm_device_t* device,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  bool did_synchronize = false;
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    uint64_t value = signal_semaphore_list.payload_values[i];
+    if (iree_hal_rocm_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_rocm_semaphore_enqueue_signal(
+          semaphore, value, device->stream));
+      continue;
+    }
+    if (!did_synchronize) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z0, "hipStreamSynchronize");
+      iree_status_t status = ROCM_RESULT_TO_STATUS(
+          device->context_wrapper.syms, hipStreamSynchronize(device->stream));
+      IREE_TRACE_ZONE_END(z0);
+      IREE_RETURN_IF_ERROR(status);
+      did_synchronize = true;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_signal(semaphore, value));
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_rocm_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -266,14 +541,54 @@ static iree_status_t iree_hal_rocm_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO: queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  iree_hal_allocator_t* allocator = iree_hal_device_allocator(base_device);
+
+  // Allocations the memory pool cannot service (host-visible memory, or a
+  // replaced device allocator) are made synchronously on the host.
+  if (!iree_hal_rocm_allocator_supports_async(allocator, &params)) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
+                                                      iree_infinite_timeout()));
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        allocator, params, allocation_size, iree_const_byte_span_empty(),
+        out_buffer));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_list_signal(signal_semaphore_list));
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status =
+      iree_hal_rocm_device_enqueue_waits(device, wait_semaphore_list);
+
+  // The allocation is ordered on the stream after the waits so the memory pool
+  // can reuse memory freed by prior work without synchronizing.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_slim_mutex_lock(&device->mutex);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_retire_submissions(device, /*wait=*/false);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_allocator_alloc_async(
+        allocator, device->stream, &params, allocation_size, &buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_hal_rocm_device_enqueue_signals(device, signal_semaphore_list);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_track_submission(
+        device, signal_semaphore_list, 0, NULL);
+  }
+  iree_slim_mutex_unlock(&device->mutex);
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_queue_dealloca(
@@ -281,10 +596,44 @@ static iree_status_t iree_hal_rocm_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO: queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+
+  // Only buffers allocated with queue_alloca from the memory pool can be freed
+  // in queue order. Others are released when their last reference is dropped.
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_rocm_buffer_isa(allocated_buffer) ||
+      iree_hal_rocm_buffer_type(allocated_buffer) !=
+          IREE_HAL_ROCM_BUFFER_TYPE_ASYNC) {
+    return iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                         wait_semaphore_list,
+                                         signal_semaphore_list);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status =
+      iree_hal_rocm_device_enqueue_waits(device, wait_semaphore_list);
+
+  iree_slim_mutex_lock(&device->mutex);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_retire_submissions(device, /*wait=*/false);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_allocator_free_async(
+        allocated_buffer->device_allocator, device->stream, allocated_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_hal_rocm_device_enqueue_signals(device, signal_semaphore_list);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_track_submission(
+        device, signal_semaphore_list, 0, NULL);
+  }
+  iree_slim_mutex_unlock(&device->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_queue_execute(
@@ -292,16 +641,45 @@ static iree_status_t iree_hal_rocm_device_queue_execute(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
+  // NOTE: command buffers with binding tables are not yet supported and fail
+  // creation so any binding tables provided are unused.
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  // TODO(raikonenfnu): Once semaphore is implemented wait for semaphores
-  // TODO(thomasraoux): implement semaphores - for now this conservatively
-  // synchronizes after every submit.
-  // TODO(raikonenfnu): currently run on default/null stream, when cmd buffer
-  // stream work with device->stream, we'll change
-  ROCM_RETURN_IF_ERROR(device->context_wrapper.syms, hipStreamSynchronize(0),
-                       "hipStreamSynchronize");
-  return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status =
+      iree_hal_rocm_device_enqueue_waits(device, wait_semaphore_list);
+
+  // Submissions are issued in order on the device stream.
+  iree_slim_mutex_lock(&device->mutex);
+
+  // Release resources from prior submissions that have completed.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_retire_submissions(device, /*wait=*/false);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_issue_command_buffers(
+        device, command_buffer_count, command_buffers);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_hal_rocm_device_enqueue_signals(device, signal_semaphore_list);
+  }
+
+  // Track the submission after the signals so that its completion implies the
+  // signal host functions have run.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_device_track_submission(
+        device, signal_semaphore_list, command_buffer_count, command_buffers);
+  }
+
+  iree_slim_mutex_unlock(&device->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_queue_flush(
@@ -313,8 +691,30 @@ static iree_status_t iree_hal_rocm_device_queue_flush(
 static iree_status_t iree_hal_rocm_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "semaphore not implemented");
+  bool all_rocm = true;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    all_rocm &= iree_hal_rocm_semaphore_isa(semaphore_list.semaphores[i]);
+  }
+  if (all_rocm && semaphore_list.count > 1) {
+    // ROCM semaphores notify their timepoints when signaled from the host or
+    // by stream host functions so we can wait on all of them at once.
+    return iree_hal_semaphore_multi_wait(
+        wait_mode, semaphore_list, timeout, IREE_HAL_SEMAPHORE_WAIT_SPIN_NS,
+        iree_hal_device_host_allocator(base_device));
+  } else if (wait_mode == IREE_HAL_WAIT_MODE_ANY && semaphore_list.count > 1) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "wait-any on semaphores from multiple devices not implemented");
+  }
+  // Waiting on each semaphore in turn is equivalent to waiting on all of them
+  // as the deadline is absolute.
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+        semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+        iree_make_deadline(deadline_ns)));
+  }
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_rocm_device_profiling_begin(
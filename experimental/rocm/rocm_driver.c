@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "experimental/rocm/api.h"
@@ -22,7 +23,9 @@ typedef struct iree_hal_rocm_driver_t {
   // We allow overriding so that multiple ROCM versions can be exposed in the
   // same process.
   iree_string_view_t identifier;
-  int default_device_index;
+  // Options the driver was created with. The RCCL defaults are passed to the
+  // devices created from the driver.
+  iree_hal_rocm_driver_options_t options;
   // ROCM symbols.
   iree_hal_rocm_dynamic_symbols_t syms;
 } iree_hal_rocm_driver_t;
@@ -44,6 +47,42 @@ IREE_API_EXPORT void iree_hal_rocm_driver_options_initialize(
   out_options->default_device_index = 0;
 }
 
+// Returns true if |id| is all zeros indicating an empty ID.
+static bool iree_hal_rocm_rccl_id_is_empty(const iree_hal_rocm_rccl_id_t* id) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(id->data); ++i) {
+    if (id->data[i] != 0) return false;
+  }
+  return true;
+}
+
+// Loads RCCL and populates the default RCCL ID if one was not provided.
+// ncclGetUniqueId derives the ID from NCCL_COMM_ID when set so that all
+// participants agree on it without exchanging IDs out of band.
+static iree_status_t iree_hal_rocm_driver_initialize_rccl(
+    iree_hal_rocm_driver_t* driver) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_rocm_rccl_dynamic_symbols_initialize(driver->host_allocator,
+                                                        &driver->syms));
+  if (iree_hal_rocm_rccl_id_is_empty(&driver->options.rccl_default_id)) {
+    if (!getenv("NCCL_COMM_ID")) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "expected NCCL_COMM_ID environment variable to "
+                              "be set when using the default RCCL "
+                              "configuration");
+    }
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, RCCL_RESULT_TO_STATUS(
+                &driver->syms,
+                ncclGetUniqueId(
+                    (ncclUniqueId*)&driver->options.rccl_default_id),
+                "ncclGetUniqueId"));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_rocm_driver_create_internal(
     iree_string_view_t identifier,
     const iree_hal_rocm_driver_options_t* options,
@@ -57,9 +96,12 @@ static iree_status_t iree_hal_rocm_driver_create_internal(
   iree_string_view_append_to_buffer(
       identifier, &driver->identifier,
       (char*)driver + total_size - identifier.size);
-  driver->default_device_index = options->default_device_index;
+  driver->options = *options;
   iree_status_t status =
       iree_hal_rocm_dynamic_symbols_initialize(host_allocator, &driver->syms);
+  if (iree_status_is_ok(status) && options->rccl_default_count > 0) {
+    status = iree_hal_rocm_driver_initialize_rccl(driver);
+  }
   if (iree_status_is_ok(status)) {
     *out_driver = (iree_hal_driver_t*)driver;
   } else {
@@ -199,16 +241,16 @@ static iree_status_t iree_hal_rocm_driver_create_device_by_id(
   if (device == 0) {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
         z0, iree_hal_rocm_driver_select_default_device(
-                &driver->syms, driver->default_device_index, host_allocator,
-                &device));
+                &driver->syms, driver->options.default_device_index,
+                host_allocator, &device));
   }
 
   iree_string_view_t device_name = iree_make_cstring_view("rocm");
 
   // Attempt to create the device.
-  iree_status_t status =
-      iree_hal_rocm_device_create(base_driver, device_name, &driver->syms,
-                                  device, host_allocator, out_device);
+  iree_status_t status = iree_hal_rocm_device_create(
+      base_driver, device_name, &driver->options, &driver->syms, device,
+      host_allocator, out_device);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -30,3 +30,34 @@ iree_status_t iree_hal_rocm_result_to_status(
                           "rocm driver error '%s' (%d): %s", error_name, result,
                           error_string);
 }
+
+iree_status_t iree_hal_rocm_rccl_result_to_status(
+    iree_hal_rocm_dynamic_symbols_t *syms, ncclResult_t result,
+    const char *file, uint32_t line) {
+  iree_status_code_t code;
+  switch (result) {
+    case ncclSuccess:
+      return iree_ok_status();
+    case ncclUnhandledCudaError:
+      code = IREE_STATUS_FAILED_PRECONDITION;
+      break;
+    case ncclInvalidArgument:
+      code = IREE_STATUS_INVALID_ARGUMENT;
+      break;
+    case ncclInvalidUsage:
+      code = IREE_STATUS_FAILED_PRECONDITION;
+      break;
+    case ncclRemoteError:
+      code = IREE_STATUS_UNAVAILABLE;
+      break;
+    case ncclInProgress:
+      code = IREE_STATUS_DEFERRED;
+      break;
+    default:
+      code = IREE_STATUS_INTERNAL;
+      break;
+  }
+  return iree_make_status_with_location(file, line, code, "RCCL error %d: %s",
+                                        result,
+                                        syms->ncclGetErrorString(result));
+}
@@ -47,6 +47,38 @@ iree_status_t iree_hal_rocm_result_to_status(
     iree_hal_rocm_dynamic_symbols_t* syms, hipError_t result, const char* file,
     uint32_t line);
 
+// Converts a ncclResult_t to an iree_status_t.
+//
+// Usage:
+//   iree_status_t status = RCCL_RESULT_TO_STATUS(ncclDoThing(...));
+#define RCCL_RESULT_TO_STATUS(syms, expr, ...)                          \
+  iree_hal_rocm_rccl_result_to_status((syms), ((syms)->expr), __FILE__, \
+                                      __LINE__)
+
+// IREE_RETURN_IF_ERROR but implicitly converts the ncclResult_t return value to
+// a Status.
+//
+// Usage:
+//   RCCL_RETURN_IF_ERROR(ncclDoThing(...), "message");
+#define RCCL_RETURN_IF_ERROR(syms, expr, ...)                           \
+  IREE_RETURN_IF_ERROR(iree_hal_rocm_rccl_result_to_status(             \
+                           (syms), ((syms)->expr), __FILE__, __LINE__), \
+                       __VA_ARGS__)
+
+// IREE_IGNORE_ERROR but implicitly converts the ncclResult_t return value to a
+// Status.
+//
+// Usage:
+//   RCCL_IGNORE_ERROR(ncclDoThing(...));
+#define RCCL_IGNORE_ERROR(syms, expr)                    \
+  IREE_IGNORE_ERROR(iree_hal_rocm_rccl_result_to_status( \
+      (syms), ((syms)->expr), __FILE__, __LINE__))
+
+// Converts a ncclResult_t to a Status object.
+iree_status_t iree_hal_rocm_rccl_result_to_status(
+    iree_hal_rocm_dynamic_symbols_t* syms, ncclResult_t result,
+    const char* file, uint32_t line);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -19,6 +19,9 @@
 #   * Download program source files (.tflite files from GCS)
 #   * Import programs into MLIR (.tflite -> .mlir)
 #   * Compile programs for WebAssembly (.mlir -> .vmfb, intermediates)
+#   * If sample_dynamic was built and Chrome is available, run benchmarks.html
+#     in headless Chrome and report the startup and inference times of both
+#     the sync and multithreaded (Web Workers + wasm SIMD128) runtime builds
 #   * (TODO) Print statistics that can be produced by a script (i.e. no
 #     launching a webpage and waiting for benchmark results there)
 #
@@ -35,6 +38,11 @@
 #
 #   then open http://localhost:8000/benchmarks.html (for automated benchmarks)
 #   or open http://localhost:8000/ (for interactive benchmarks)
+#
+# The headless benchmarks use the Chrome binary from the CHROME_PATH
+# environment variable (default google-chrome), serve the sample on
+# BENCHMARK_PORT (default 8001) and give each run BENCHMARK_TIMEOUT seconds
+# (default 600).
 
 set -eo pipefail
 
@@ -148,6 +156,29 @@ function compile_program_wasm {
   fi
 }
 
+# compile_program_vmvx helper
+#   Args: program_name
+#   Compiles program_name.tflite.mlir to program_name_vmvx.vmfb. VMVX programs
+#   run on both the sync and multithreaded builds of sample_dynamic, the latter
+#   using the wasm SIMD128 ukernels.
+function compile_program_vmvx {
+  INPUT_FILE=./"$1".tflite.mlir
+  OUTPUT_FILE=./"$1"_vmvx.vmfb
+  echo "Compiling '${INPUT_FILE}' to '${OUTPUT_FILE}'..."
+
+  "${IREE_COMPILE_PATH?}" "${INPUT_FILE}" \
+    --iree-input-type=tosa \
+    --iree-hal-target-backends=vmvx \
+    --iree-vmvx-enable-microkernels \
+    --iree-flow-enable-data-tiling \
+    --o "${OUTPUT_FILE}"
+
+  if [[ -d "$SAMPLE_BINARY_DIR" ]]; then
+    echo "Copying '${OUTPUT_FILE}' to '${SAMPLE_BINARY_DIR}' for benchmarking"
+    cp "${OUTPUT_FILE}" "${SAMPLE_BINARY_DIR}"
+  fi
+}
+
 # compile_program_native helper
 #   Args: program_name
 #   Compiles program_name.tflite.mlir to program_name_native.vmfb, dumping
@@ -178,9 +209,11 @@ function compile_program_native {
 
 # compile_program helper
 #   Args: program_name
-#   Wraps compile_program_wasm and compile_program_native.
+#   Wraps compile_program_wasm, compile_program_vmvx and
+#   compile_program_native.
 function compile_program {
   compile_program_wasm $1
+  compile_program_vmvx $1
   compile_program_native $1
 }
 
@@ -191,6 +224,62 @@ compile_program "mobilebertsquad"
 compile_program "mobilenet_v2_1.0_224"
 compile_program "MobileNetV3SmallStaticBatch"
 
+###############################################################################
+# Run web benchmarks                                                          #
+###############################################################################
+
+CHROME_PATH="${CHROME_PATH:-google-chrome}"
+BENCHMARK_PORT="${BENCHMARK_PORT:-8001}"
+BENCHMARK_TIMEOUT="${BENCHMARK_TIMEOUT:-600}"
+
+# run_web_benchmarks helper
+#   Args: variant, backend
+#   Runs benchmarks.html for the given runtime variant (sync, multithreaded)
+#   and program backend (wasm, vmvx) in headless Chrome, then prints the
+#   startup and inference times that the page logged to the console.
+function run_web_benchmarks {
+  LOG_FILE=./benchmarks_"$1"_"$2".log
+  echo "Running '$1' benchmarks of '$2' programs, logging to '${LOG_FILE}'..."
+
+  "${CHROME_PATH}" --headless=new --enable-logging=stderr --v=0 \
+    --user-data-dir="$(mktemp -d)" \
+    "http://localhost:${BENCHMARK_PORT}/benchmarks.html?variant=$1&backend=$2" \
+    > "${LOG_FILE}" 2>&1 &
+  CHROME_PID=$!
+
+  # The page keeps running after the benchmarks, so stop the browser once it
+  # logs that it has finished (or failed).
+  for (( i = 0; i < BENCHMARK_TIMEOUT; ++i )); do
+    if grep -q "Finished running benchmarks\|Error: '" "${LOG_FILE}"; then
+      break
+    fi
+    sleep 1
+  done
+  kill "${CHROME_PID}" 2> /dev/null || true
+  wait "${CHROME_PID}" 2> /dev/null || true
+
+  echo "=== Web benchmarks: $1 runtime, $2 programs ==="
+  # Console messages are logged as
+  #   [...:INFO:CONSOLE(N)] "message", source: URL (N)
+  sed -n 's/.*:CONSOLE([0-9]*)\] "\(.*\)", source: .*benchmarks\.html.*/\1/p' \
+    "${LOG_FILE}"
+}
+
+if [[ -d "$SAMPLE_BINARY_DIR" ]] && command -v "${CHROME_PATH}" &> /dev/null
+then
+  python3 "${ROOT_DIR}"/build_tools/scripts/local_web_server.py \
+    --directory "${SAMPLE_BINARY_DIR}" "${BENCHMARK_PORT}" &
+  SERVER_PID=$!
+  trap "kill ${SERVER_PID} 2> /dev/null; deactivate 2> /dev/null" EXIT
+  sleep 1
+
+  run_web_benchmarks "sync" "wasm"
+  run_web_benchmarks "sync" "vmvx"
+  run_web_benchmarks "multithreaded" "vmvx"
+else
+  echo "Skipping web benchmarks: build sample_dynamic and set CHROME_PATH"
+fi
+
 ###############################################################################
 # TODO: collect/summarize statistics (manual inspection or scripted)
 #   * .vmfb size
@@ -19,9 +19,11 @@
 # Otherwise, it looks for an install directory under path set in the environment
 # variable IREE_HOST_BUILD_DIR (default build-host). The build directory for the
 # emscripten build is taken from the environment variable
-# IREE_EMPSCRIPTEN_BUILD_DIR, defaulting to "build-emscripten". Designed for
-# CI, but can be run manually. It reuses the build directory if it already
-# exists.
+# IREE_EMPSCRIPTEN_BUILD_DIR, defaulting to "build-emscripten". The
+# multithreaded variant of the runtime is built with different compiler flags
+# in the same path with a "-multithreaded" suffix, then copied next to the sync
+# variant. Designed for CI, but can be run manually. It reuses the build
+# directories if they already exist.
 #
 # NOTE: This is different from most of build scripts we use for CI because it is
 # intended to also be runnable by humans with minimal configuration.
@@ -32,6 +34,7 @@ ROOT_DIR=$(git rev-parse --show-toplevel)
 
 HOST_BUILD_DIR="${IREE_HOST_BUILD_DIR:-${ROOT_DIR}/build-host}"
 BUILD_DIR="${IREE_EMPSCRIPTEN_BUILD_DIR:-build-emscripten}"
+MT_BUILD_DIR="${BUILD_DIR}-multithreaded"
 INSTALL_ROOT="$(realpath ${1:-${HOST_BUILD_DIR}/install})"
 SOURCE_DIR=${ROOT_DIR}/experimental/web/sample_dynamic
 BINARY_DIR=${BUILD_DIR}/experimental/web/sample_dynamic
@@ -68,10 +71,23 @@ compile_sample() {
     --o "${BINARY_DIR}/$1.vmfb"
 }
 
+# VMVX programs run on both runtime variants and use the runtime's ukernels,
+# including the wasm SIMD128 tiles in the multithreaded variant.
+compile_sample_vmvx() {
+  echo "  Compiling '$1' sample for VMVX..."
+  "${COMPILE_TOOL}" "$2" \
+    --iree-input-type=mhlo \
+    --iree-hal-target-backends=vmvx \
+    --iree-vmvx-enable-microkernels \
+    --o "${BINARY_DIR}/$1_vmvx.vmfb"
+}
+
 echo "=== Compiling sample MLIR files to VM FlatBuffer outputs (.vmfb) ==="
 compile_sample "simple_abs"     "${ROOT_DIR}/samples/models/simple_abs.mlir"
 compile_sample "fullyconnected" "${ROOT_DIR}/tests/e2e/models/fullyconnected.mlir"
 compile_sample "collatz"        "${ROOT_DIR}/tests/e2e/models/collatz.mlir"
+compile_sample_vmvx "simple_abs"     "${ROOT_DIR}/samples/models/simple_abs.mlir"
+compile_sample_vmvx "fullyconnected" "${ROOT_DIR}/tests/e2e/models/fullyconnected.mlir"
 
 ###############################################################################
 # Build the web artifacts using Emscripten                                    #
@@ -98,6 +114,32 @@ emcmake "${CMAKE_BIN}" \
 "${CMAKE_BIN}" --build "${BUILD_DIR}" --target \
   iree_experimental_web_sample_dynamic_sync
 
+# Every library in the multithreaded variant must be compiled with -pthread for
+# shared memory, and -msimd128 enables the wasm SIMD128 ukernel tiles, so it
+# gets its own build directory.
+MT_FLAGS="-pthread -msimd128"
+emcmake "${CMAKE_BIN}" \
+  -B "${MT_BUILD_DIR}" \
+  -G Ninja \
+  -DPython3_EXECUTABLE="${IREE_PYTHON3_EXECUTABLE}" \
+  -DPYTHON_EXECUTABLE="${IREE_PYTHON3_EXECUTABLE}" \
+  -DCMAKE_BUILD_TYPE=RelWithDebInfo \
+  -DCMAKE_C_FLAGS="${MT_FLAGS}" \
+  -DCMAKE_CXX_FLAGS="${MT_FLAGS}" \
+  -DIREE_HOST_BIN_DIR="${INSTALL_ROOT}/bin" \
+  -DIREE_BUILD_EXPERIMENTAL_WEB_SAMPLES=ON \
+  -DIREE_HAL_DRIVER_DEFAULTS=OFF \
+  -DIREE_HAL_DRIVER_LOCAL_TASK=ON \
+  -DIREE_BUILD_COMPILER=OFF \
+  -DIREE_BUILD_TESTS=OFF \
+  .
+
+"${CMAKE_BIN}" --build "${MT_BUILD_DIR}" --target \
+  iree_experimental_web_sample_dynamic_multithreaded
+
+MT_BINARY_DIR=${MT_BUILD_DIR}/experimental/web/sample_dynamic
+cp "${MT_BINARY_DIR}"/web-sample-dynamic-multithreaded.* "${BINARY_DIR}"
+
 echo "=== Copying static files (.html, .js) to the build directory ==="
 
 cp "${SOURCE_DIR}/index.html" "${BINARY_DIR}"
@@ -55,15 +55,24 @@ function _callIntoWorker(baseMessage) {
 
 // Initializes IREE's web worker asynchronously.
 //
+// |variant| selects the runtime build to load:
+//   * 'sync' runs programs on the IREE worker itself, using the local-sync
+//     device
+//   * 'multithreaded' runs programs on the local-task device, with worker
+//     threads backed by Web Workers and SharedArrayBuffer. This requires the
+//     page to be cross-origin isolated (see serve_sample.sh).
+//
 // Resolves with no return value when the worker is fully initialized.
-function ireeInitializeWorker() {
+function ireeInitializeWorker(variant = 'sync') {
   return new Promise((resolve, reject) => {
     pendingPromises['initialize'] = {
       'resolve': resolve,
       'reject': reject,
     };
 
-    ireeWorker = new Worker('iree_worker.js', {name: 'IREE-main'});
+    ireeWorker = new Worker(
+        'iree_worker.js?variant=' + encodeURIComponent(variant),
+        {name: 'IREE-main'});
     ireeWorker.onmessage = _handleMessageFromWorker;
   });
 }
@@ -4,9 +4,11 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-// TODO(scotttodd): configure this through the build system / scripts?
-// const MAIN_SCRIPT_URL = 'web-sample-dynamic-multithreaded.js';
-const MAIN_SCRIPT_URL = 'web-sample-dynamic-sync.js';
+// The runtime variant is selected by ireeInitializeWorker() through the
+// 'variant' URL parameter of this script: 'sync' (default) or 'multithreaded'.
+const MAIN_SCRIPT_VARIANT =
+    new URLSearchParams(self.location.search).get('variant') || 'sync';
+const MAIN_SCRIPT_URL = 'web-sample-dynamic-' + MAIN_SCRIPT_VARIANT + '.js';
 
 let wasmSetupSampleFn;
 let wasmCleanupSampleFn;
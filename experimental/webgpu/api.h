@@ -0,0 +1,78 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// See iree/base/api.h for documentation on the API conventions used.
+
+#ifndef IREE_HAL_WEBGPU_API_H_
+#define IREE_HAL_WEBGPU_API_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_device_t
+//===----------------------------------------------------------------------===//
+
+// WebGPU device creation options.
+typedef struct iree_hal_webgpu_device_options_t {
+  // Size in bytes of the blocks that command buffers stage push constants and
+  // buffer updates in. Larger updates are given their own staging buffer.
+  iree_host_size_t staging_block_size;
+} iree_hal_webgpu_device_options_t;
+
+IREE_API_EXPORT void iree_hal_webgpu_device_options_initialize(
+    iree_hal_webgpu_device_options_t* out_options);
+
+// Wraps an existing WGPUDevice in a HAL device.
+// The device is referenced for the lifetime of the HAL device. This is how
+// devices requested from JavaScript (which is asynchronous and cannot be done
+// from within a synchronous driver call) are used on the web.
+//
+// |out_device| must be released by the caller (see |iree_hal_device_release|).
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_wrap_device(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_device_options_t* options, WGPUDevice handle,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_driver_t
+//===----------------------------------------------------------------------===//
+
+// WebGPU driver creation options.
+typedef struct iree_hal_webgpu_driver_options_t {
+  // Power preference used when requesting an adapter natively. On the web the
+  // device is requested from JavaScript and this is unused.
+  WGPUPowerPreference power_preference;
+
+  // Options used for all devices created from the driver.
+  iree_hal_webgpu_device_options_t device_options;
+} iree_hal_webgpu_driver_options_t;
+
+IREE_API_EXPORT void iree_hal_webgpu_driver_options_initialize(
+    iree_hal_webgpu_driver_options_t* out_options);
+
+// Creates a WebGPU HAL driver.
+//
+// Natively the driver requests an adapter and device from Dawn. On the web the
+// driver uses the device that JavaScript placed in
+// Module.preinitializedWebGPUDevice before the program started.
+//
+// |out_driver| must be released by the caller (see |iree_hal_driver_release|).
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_driver_create(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_driver_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_driver_t** out_driver);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_API_H_
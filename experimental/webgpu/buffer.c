@@ -0,0 +1,224 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/platform.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_hal_webgpu_buffer_t {
+  iree_hal_buffer_t base;
+  WGPUDevice device;
+  WGPUBuffer handle;
+  WGPUBufferUsageFlags handle_usage;
+  // Number of outstanding mappings of the buffer. WebGPU buffers can only be
+  // mapped once at a time so the whole buffer is mapped while this is
+  // non-zero and ranges are returned from that mapping.
+  int32_t map_count;
+} iree_hal_webgpu_buffer_t;
+
+static const iree_hal_buffer_vtable_t iree_hal_webgpu_buffer_vtable;
+
+static iree_hal_webgpu_buffer_t* iree_hal_webgpu_buffer_cast(
+    iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_buffer_vtable);
+  return (iree_hal_webgpu_buffer_t*)base_value;
+}
+
+static const iree_hal_webgpu_buffer_t* iree_hal_webgpu_buffer_const_cast(
+    const iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_buffer_vtable);
+  return (const iree_hal_webgpu_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_buffer_wrap(
+    iree_hal_allocator_t* allocator, WGPUDevice device, WGPUBuffer handle,
+    WGPUBufferUsageFlags handle_usage, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree_device_size_t byte_offset, iree_device_size_t byte_length,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(allocator);
+  iree_hal_webgpu_buffer_t* buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(host_allocator, allocator, &buffer->base,
+                               allocation_size, byte_offset, byte_length,
+                               memory_type, allowed_access, allowed_usage,
+                               &iree_hal_webgpu_buffer_vtable, &buffer->base);
+    buffer->device = device;
+    buffer->handle = handle;
+    buffer->handle_usage = handle_usage;
+    buffer->map_count = 0;
+    *out_buffer = &buffer->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_buffer_destroy(iree_hal_buffer_t* base_buffer) {
+  iree_hal_webgpu_buffer_t* buffer = iree_hal_webgpu_buffer_cast(base_buffer);
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Destruction is deferred by WebGPU until submitted work using the buffer
+  // has completed.
+  wgpuBufferDestroy(buffer->handle);
+  wgpuBufferRelease(buffer->handle);
+  iree_allocator_free(host_allocator, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+typedef struct iree_hal_webgpu_map_request_t {
+  bool completed;
+  WGPUBufferMapAsyncStatus result;
+} iree_hal_webgpu_map_request_t;
+
+static void iree_hal_webgpu_buffer_map_callback(WGPUBufferMapAsyncStatus result,
+                                                void* userdata) {
+  iree_hal_webgpu_map_request_t* request =
+      (iree_hal_webgpu_map_request_t*)userdata;
+  request->result = result;
+  request->completed = true;
+}
+
+// Maps the entire buffer with wgpuBufferMapAsync and blocks until the mapping
+// completes. The mapping waits for all submitted work using the buffer.
+static iree_status_t iree_hal_webgpu_buffer_map_all(
+    iree_hal_webgpu_buffer_t* buffer, WGPUMapModeFlags mode) {
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_platform_check_can_block());
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_webgpu_map_request_t request = {
+      .completed = false,
+      .result = WGPUBufferMapAsyncStatus_Unknown,
+  };
+  wgpuBufferMapAsync(buffer->handle, mode, 0,
+                     (size_t)iree_hal_buffer_allocation_size(&buffer->base),
+                     iree_hal_webgpu_buffer_map_callback, &request);
+  while (!request.completed) {
+    iree_hal_webgpu_platform_process_events(buffer->device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  if (request.result != WGPUBufferMapAsyncStatus_Success) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuBufferMapAsync failed with status %d",
+                            (int)request.result);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_webgpu_buffer_t* buffer = iree_hal_webgpu_buffer_cast(base_buffer);
+
+  // Device-local buffers cannot be mapped in WebGPU; their contents must be
+  // transferred through the queue.
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_validate_memory_type(
+      iree_hal_buffer_memory_type(base_buffer),
+      IREE_HAL_MEMORY_TYPE_HOST_VISIBLE));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_buffer_validate_usage(iree_hal_buffer_allowed_usage(base_buffer),
+                                     IREE_HAL_BUFFER_USAGE_MAPPING));
+
+  // Readback buffers are mapped for reading and upload buffers for writing;
+  // the allocator restricts their allowed access to match.
+  bool is_readback =
+      iree_all_bits_set(buffer->handle_usage, WGPUBufferUsage_MapRead);
+  if (buffer->map_count == 0) {
+    IREE_RETURN_IF_ERROR(iree_hal_webgpu_buffer_map_all(
+        buffer, is_readback ? WGPUMapMode_Read : WGPUMapMode_Write));
+  }
+  ++buffer->map_count;
+
+  size_t allocation_size =
+      (size_t)iree_hal_buffer_allocation_size(&buffer->base);
+  uint8_t* data_ptr =
+      is_readback ? (uint8_t*)wgpuBufferGetConstMappedRange(buffer->handle, 0,
+                                                            allocation_size)
+                  : (uint8_t*)wgpuBufferGetMappedRange(buffer->handle, 0,
+                                                       allocation_size);
+  if (!data_ptr) {
+    --buffer->map_count;
+    if (buffer->map_count == 0) wgpuBufferUnmap(buffer->handle);
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuBufferGetMappedRange returned no memory");
+  }
+  data_ptr += local_byte_offset;
+
+#ifndef NDEBUG
+  if (iree_any_bit_set(memory_access, IREE_HAL_MEMORY_ACCESS_DISCARD)) {
+    memset(data_ptr, 0xCD, local_byte_length);
+  }
+#endif  // !NDEBUG
+
+  mapping->contents = iree_make_byte_span(data_ptr, local_byte_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_webgpu_buffer_t* buffer = iree_hal_webgpu_buffer_cast(base_buffer);
+  IREE_ASSERT_GT(buffer->map_count, 0);
+  if (--buffer->map_count == 0) {
+    // Writes become visible to the device on unmap.
+    wgpuBufferUnmap(buffer->handle);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  // Nothing to do: mapping waits for all work using the buffer.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  // Nothing to do: writes are flushed when the buffer is unmapped.
+  return iree_ok_status();
+}
+
+bool iree_hal_webgpu_buffer_isa(const iree_hal_buffer_t* buffer) {
+  return iree_hal_resource_is(buffer, &iree_hal_webgpu_buffer_vtable);
+}
+
+WGPUBuffer iree_hal_webgpu_buffer_handle(const iree_hal_buffer_t* buffer) {
+  return iree_hal_webgpu_buffer_const_cast(buffer)->handle;
+}
+
+WGPUBufferUsageFlags iree_hal_webgpu_buffer_handle_usage(
+    const iree_hal_buffer_t* buffer) {
+  return iree_hal_webgpu_buffer_const_cast(buffer)->handle_usage;
+}
+
+static const iree_hal_buffer_vtable_t iree_hal_webgpu_buffer_vtable = {
+    .recycle = iree_hal_buffer_recycle,
+    .destroy = iree_hal_webgpu_buffer_destroy,
+    .map_range = iree_hal_webgpu_buffer_map_range,
+    .unmap_range = iree_hal_webgpu_buffer_unmap_range,
+    .invalidate_range = iree_hal_webgpu_buffer_invalidate_range,
+    .flush_range = iree_hal_webgpu_buffer_flush_range,
+};
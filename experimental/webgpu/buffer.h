@@ -0,0 +1,42 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_BUFFER_H_
+#define IREE_HAL_WEBGPU_BUFFER_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Wraps the WebGPU |handle| in a HAL buffer and takes ownership of it.
+// |device| is used to process events while mapping the buffer and must remain
+// valid for the lifetime of the buffer.
+iree_status_t iree_hal_webgpu_buffer_wrap(
+    iree_hal_allocator_t* allocator, WGPUDevice device, WGPUBuffer handle,
+    WGPUBufferUsageFlags handle_usage, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree_device_size_t byte_offset, iree_device_size_t byte_length,
+    iree_hal_buffer_t** out_buffer);
+
+bool iree_hal_webgpu_buffer_isa(const iree_hal_buffer_t* buffer);
+
+// Returns the WebGPU buffer handle backing |buffer|.
+WGPUBuffer iree_hal_webgpu_buffer_handle(const iree_hal_buffer_t* buffer);
+
+// Returns the WebGPU usage the buffer handle was created with.
+WGPUBufferUsageFlags iree_hal_webgpu_buffer_handle_usage(
+    const iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_BUFFER_H_
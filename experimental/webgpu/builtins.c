@@ -0,0 +1,180 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/builtins.h"
+
+#include <string.h>
+
+#include "iree/base/tracing.h"
+
+static const char iree_hal_webgpu_fill_buffer_wgsl[] =
+    "struct Params {\n"
+    "  offset : u32,\n"
+    "  length : u32,\n"
+    "  pattern : u32,\n"
+    "  reserved : u32,\n"
+    "};\n"
+    "@group(0) @binding(0) var<storage, read_write> buffer : array<u32>;\n"
+    "@group(0) @binding(1) var<uniform> params : Params;\n"
+    "@compute @workgroup_size(64)\n"
+    "fn main(@builtin(global_invocation_id) id : vec3<u32>) {\n"
+    "  if (id.x >= params.length) { return; }\n"
+    "  buffer[params.offset + id.x] = params.pattern;\n"
+    "}\n";
+
+static iree_status_t iree_hal_webgpu_builtins_initialize_fill_buffer(
+    WGPUDevice device, iree_hal_webgpu_builtins_t* builtins) {
+  const WGPUBindGroupLayoutEntry entries[2] = {
+      {
+          .binding = 0,
+          .visibility = WGPUShaderStage_Compute,
+          .buffer = {.type = WGPUBufferBindingType_Storage},
+      },
+      {
+          .binding = 1,
+          .visibility = WGPUShaderStage_Compute,
+          .buffer =
+              {
+                  .type = WGPUBufferBindingType_Uniform,
+                  .minBindingSize =
+                      sizeof(iree_hal_webgpu_fill_buffer_params_t),
+              },
+      },
+  };
+  const WGPUBindGroupLayoutDescriptor layout_descriptor = {
+      .label = "iree_hal_webgpu_fill_buffer",
+      .entryCount = IREE_ARRAYSIZE(entries),
+      .entries = entries,
+  };
+  builtins->fill_buffer.bind_group_layout =
+      wgpuDeviceCreateBindGroupLayout(device, &layout_descriptor);
+  if (!builtins->fill_buffer.bind_group_layout) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "failed to create the fill_buffer layout");
+  }
+
+  const WGPUPipelineLayoutDescriptor pipeline_layout_descriptor = {
+      .label = "iree_hal_webgpu_fill_buffer",
+      .bindGroupLayoutCount = 1,
+      .bindGroupLayouts = &builtins->fill_buffer.bind_group_layout,
+  };
+  WGPUPipelineLayout pipeline_layout =
+      wgpuDeviceCreatePipelineLayout(device, &pipeline_layout_descriptor);
+
+  const WGPUShaderModuleWGSLDescriptor wgsl_descriptor = {
+      .chain =
+          {
+              .next = NULL,
+              .sType = WGPUSType_ShaderModuleWGSLDescriptor,
+          },
+      .code = iree_hal_webgpu_fill_buffer_wgsl,
+  };
+  const WGPUShaderModuleDescriptor module_descriptor = {
+      .nextInChain = &wgsl_descriptor.chain,
+      .label = "iree_hal_webgpu_fill_buffer",
+  };
+  WGPUShaderModule module =
+      wgpuDeviceCreateShaderModule(device, &module_descriptor);
+
+  if (pipeline_layout && module) {
+    const WGPUComputePipelineDescriptor pipeline_descriptor = {
+        .label = "iree_hal_webgpu_fill_buffer",
+        .layout = pipeline_layout,
+        .compute =
+            {
+                .module = module,
+                .entryPoint = "main",
+            },
+    };
+    builtins->fill_buffer.pipeline =
+        wgpuDeviceCreateComputePipeline(device, &pipeline_descriptor);
+  }
+  if (module) wgpuShaderModuleRelease(module);
+  if (pipeline_layout) wgpuPipelineLayoutRelease(pipeline_layout);
+  if (!builtins->fill_buffer.pipeline) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "failed to create the fill_buffer pipeline");
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_webgpu_builtins_initialize(
+    WGPUDevice device, iree_hal_webgpu_builtins_t* out_builtins) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_builtins);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_builtins, 0, sizeof(*out_builtins));
+
+  const WGPUBindGroupLayoutDescriptor empty_layout_descriptor = {
+      .label = "iree_hal_webgpu_empty",
+      .entryCount = 0,
+      .entries = NULL,
+  };
+  out_builtins->empty_bind_group_layout =
+      wgpuDeviceCreateBindGroupLayout(device, &empty_layout_descriptor);
+  if (out_builtins->empty_bind_group_layout) {
+    const WGPUBindGroupDescriptor empty_group_descriptor = {
+        .label = "iree_hal_webgpu_empty",
+        .layout = out_builtins->empty_bind_group_layout,
+        .entryCount = 0,
+        .entries = NULL,
+    };
+    out_builtins->empty_bind_group =
+        wgpuDeviceCreateBindGroup(device, &empty_group_descriptor);
+  }
+
+  const WGPUBindGroupLayoutEntry params_entry = {
+      .binding = 0,
+      .visibility = WGPUShaderStage_Compute,
+      .buffer = {.type = WGPUBufferBindingType_Uniform},
+  };
+  const WGPUBindGroupLayoutDescriptor params_layout_descriptor = {
+      .label = "iree_hal_webgpu_params",
+      .entryCount = 1,
+      .entries = &params_entry,
+  };
+  out_builtins->params_bind_group_layout =
+      wgpuDeviceCreateBindGroupLayout(device, &params_layout_descriptor);
+
+  iree_status_t status = iree_ok_status();
+  if (!out_builtins->empty_bind_group ||
+      !out_builtins->params_bind_group_layout) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "failed to create the shared bind group layouts");
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_hal_webgpu_builtins_initialize_fill_buffer(device, out_builtins);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_webgpu_builtins_deinitialize(out_builtins);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_webgpu_builtins_deinitialize(
+    iree_hal_webgpu_builtins_t* builtins) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (builtins->fill_buffer.pipeline) {
+    wgpuComputePipelineRelease(builtins->fill_buffer.pipeline);
+  }
+  if (builtins->fill_buffer.bind_group_layout) {
+    wgpuBindGroupLayoutRelease(builtins->fill_buffer.bind_group_layout);
+  }
+  if (builtins->params_bind_group_layout) {
+    wgpuBindGroupLayoutRelease(builtins->params_bind_group_layout);
+  }
+  if (builtins->empty_bind_group) {
+    wgpuBindGroupRelease(builtins->empty_bind_group);
+  }
+  if (builtins->empty_bind_group_layout) {
+    wgpuBindGroupLayoutRelease(builtins->empty_bind_group_layout);
+  }
+  memset(builtins, 0, sizeof(*builtins));
+  IREE_TRACE_ZONE_END(z0);
+}
@@ -0,0 +1,60 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_BUILTINS_H_
+#define IREE_HAL_WEBGPU_BUILTINS_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Workgroup size of the fill_buffer builtin.
+#define IREE_HAL_WEBGPU_FILL_BUFFER_WORKGROUP_SIZE 64
+
+// Parameters of the fill_buffer builtin, in 32-bit words.
+typedef struct iree_hal_webgpu_fill_buffer_params_t {
+  uint32_t offset;
+  uint32_t length;
+  uint32_t pattern;
+  uint32_t reserved;
+} iree_hal_webgpu_fill_buffer_params_t;
+
+// Device-wide layouts and pipelines used by all command buffers.
+typedef struct iree_hal_webgpu_builtins_t {
+  // Bind group layout without bindings and its bind group. Pipeline layouts
+  // use it for the sets below the push constant bind group they do not use.
+  WGPUBindGroupLayout empty_bind_group_layout;
+  WGPUBindGroup empty_bind_group;
+
+  // Bind group layout of the uniform buffer emulating push constants. Shared
+  // by all pipeline layouts so that the bind group can be reused across
+  // dispatches.
+  WGPUBindGroupLayout params_bind_group_layout;
+
+  // Fills a range of 32-bit words of a storage buffer with a pattern, for
+  // fill_buffer commands with patterns clearBuffer cannot produce.
+  // Binding 0 is the target storage buffer and binding 1 the uniform
+  // iree_hal_webgpu_fill_buffer_params_t.
+  struct {
+    WGPUBindGroupLayout bind_group_layout;
+    WGPUComputePipeline pipeline;
+  } fill_buffer;
+} iree_hal_webgpu_builtins_t;
+
+iree_status_t iree_hal_webgpu_builtins_initialize(
+    WGPUDevice device, iree_hal_webgpu_builtins_t* out_builtins);
+
+void iree_hal_webgpu_builtins_deinitialize(
+    iree_hal_webgpu_builtins_t* builtins);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_BUILTINS_H_
@@ -0,0 +1,777 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/command_buffer.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/buffer.h"
+#include "experimental/webgpu/executable.h"
+#include "experimental/webgpu/pipeline_layout.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+// Alignment of staged ranges. This is the default (and maximum)
+// minUniformBufferOffsetAlignment limit so that any range can be bound.
+#define IREE_HAL_WEBGPU_STAGING_ALIGNMENT 256
+
+// Maximum number of workgroups in a single dimension of a dispatch.
+#define IREE_HAL_WEBGPU_MAX_WORKGROUP_COUNT 65535
+
+// A mapped uniform buffer that staging ranges are suballocated from.
+typedef struct iree_hal_webgpu_staging_block_t {
+  struct iree_hal_webgpu_staging_block_t* next;
+  WGPUBuffer handle;
+  // Mapped contents of the block while recording; NULL once unmapped.
+  uint8_t* mapped_ptr;
+  iree_device_size_t capacity;
+  iree_device_size_t offset;
+} iree_hal_webgpu_staging_block_t;
+
+typedef struct iree_hal_webgpu_command_buffer_t {
+  iree_hal_command_buffer_t base;
+  iree_allocator_t host_allocator;
+  WGPUDevice device;
+  const iree_hal_webgpu_builtins_t* builtins;
+  iree_device_size_t staging_block_size;
+
+  // All staging blocks with the current one at the head.
+  iree_hal_webgpu_staging_block_t* staging_blocks;
+
+  // Valid between begin and end.
+  WGPUCommandEncoder encoder;
+  // Compute pass opened on the first dispatch after any non-dispatch command.
+  WGPUComputePassEncoder compute_pass;
+  // Valid after end.
+  WGPUCommandBuffer handle;
+
+  struct {
+    uint32_t push_constants[IREE_HAL_WEBGPU_MAX_PUSH_CONSTANT_COUNT];
+    // Bind group of the staged push constants; NULL when they have changed
+    // since it was created.
+    WGPUBindGroup params_bind_group;
+    WGPUBindGroup bind_groups[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_COUNT];
+  } state;
+} iree_hal_webgpu_command_buffer_t;
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_webgpu_command_buffer_vtable;
+
+static iree_hal_webgpu_command_buffer_t* iree_hal_webgpu_command_buffer_cast(
+    iree_hal_command_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_command_buffer_vtable);
+  return (iree_hal_webgpu_command_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_command_buffer_create(
+    iree_hal_device_t* device, WGPUDevice handle,
+    const iree_hal_webgpu_builtins_t* builtins,
+    iree_device_size_t staging_block_size,
+    iree_hal_command_category_t command_categories,
+    iree_allocator_t host_allocator,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(builtins);
+  IREE_ASSERT_ARGUMENT(out_command_buffer);
+  *out_command_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_command_buffer_t* command_buffer = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*command_buffer), (void**)&command_buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_command_buffer_initialize(
+        device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT, command_categories,
+        IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0,
+        &iree_hal_webgpu_command_buffer_vtable, &command_buffer->base);
+    command_buffer->host_allocator = host_allocator;
+    command_buffer->device = handle;
+    command_buffer->builtins = builtins;
+    command_buffer->staging_block_size = iree_device_align(
+        iree_max(staging_block_size, IREE_HAL_WEBGPU_STAGING_ALIGNMENT),
+        IREE_HAL_WEBGPU_STAGING_ALIGNMENT);
+    *out_command_buffer = &command_buffer->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_command_buffer_reset_state(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  if (command_buffer->state.params_bind_group) {
+    wgpuBindGroupRelease(command_buffer->state.params_bind_group);
+  }
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(command_buffer->state.bind_groups); ++i) {
+    if (command_buffer->state.bind_groups[i]) {
+      wgpuBindGroupRelease(command_buffer->state.bind_groups[i]);
+    }
+  }
+  memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+}
+
+static void iree_hal_webgpu_command_buffer_destroy(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  iree_allocator_t host_allocator = command_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_command_buffer_reset_state(command_buffer);
+  if (command_buffer->compute_pass) {
+    wgpuComputePassEncoderRelease(command_buffer->compute_pass);
+  }
+  if (command_buffer->encoder) {
+    wgpuCommandEncoderRelease(command_buffer->encoder);
+  }
+  if (command_buffer->handle) {
+    wgpuCommandBufferRelease(command_buffer->handle);
+  }
+  // Destroying the staging buffers is deferred by WebGPU until the command
+  // buffer using them has completed.
+  iree_hal_webgpu_staging_block_t* block = command_buffer->staging_blocks;
+  while (block) {
+    iree_hal_webgpu_staging_block_t* next = block->next;
+    wgpuBufferDestroy(block->handle);
+    wgpuBufferRelease(block->handle);
+    iree_allocator_free(host_allocator, block);
+    block = next;
+  }
+  iree_allocator_free(host_allocator, command_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_webgpu_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_dyn_cast(
+      command_buffer, &iree_hal_webgpu_command_buffer_vtable);
+}
+
+static void* iree_hal_webgpu_command_buffer_dyn_cast(
+    iree_hal_command_buffer_t* command_buffer, const void* vtable) {
+  if (vtable == &iree_hal_webgpu_command_buffer_vtable) {
+    IREE_HAL_ASSERT_TYPE(command_buffer, vtable);
+    return command_buffer;
+  }
+  return NULL;
+}
+
+WGPUCommandBuffer iree_hal_webgpu_command_buffer_handle(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  return command_buffer->handle;
+}
+
+// Resolves |buffer| to the WebGPU buffer backing it and adds the offset of
+// |buffer| within that to |*inout_offset|.
+static iree_status_t iree_hal_webgpu_resolve_buffer(
+    iree_hal_buffer_t* buffer, iree_device_size_t* inout_offset,
+    WGPUBuffer* out_handle) {
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_webgpu_buffer_isa(allocated_buffer)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "buffer is not a WebGPU buffer");
+  }
+  *inout_offset += iree_hal_buffer_byte_offset(buffer);
+  *out_handle = iree_hal_webgpu_buffer_handle(allocated_buffer);
+  return iree_ok_status();
+}
+
+// Suballocates |length| bytes from the staging blocks, returning the buffer
+// and offset to bind or copy from along with the mapped pointer to write the
+// contents to.
+static iree_status_t iree_hal_webgpu_command_buffer_stage(
+    iree_hal_webgpu_command_buffer_t* command_buffer,
+    iree_device_size_t length, WGPUBuffer* out_handle,
+    iree_device_size_t* out_offset, void** out_ptr) {
+  length = iree_device_align(length, IREE_HAL_WEBGPU_STAGING_ALIGNMENT);
+  iree_hal_webgpu_staging_block_t* block = command_buffer->staging_blocks;
+  if (!block || block->offset + length > block->capacity) {
+    // Updates larger than a block get a block of their own.
+    iree_device_size_t capacity =
+        iree_max(command_buffer->staging_block_size, length);
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        command_buffer->host_allocator, sizeof(*block), (void**)&block));
+    const WGPUBufferDescriptor descriptor = {
+        .label = "iree_hal_webgpu_staging",
+        .usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopySrc,
+        .size = capacity,
+        .mappedAtCreation = true,
+    };
+    block->handle = wgpuDeviceCreateBuffer(command_buffer->device, &descriptor);
+    if (!block->handle) {
+      iree_allocator_free(command_buffer->host_allocator, block);
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "failed to create a staging buffer of %" PRIu64
+                              " bytes",
+                              (uint64_t)capacity);
+    }
+    block->mapped_ptr =
+        (uint8_t*)wgpuBufferGetMappedRange(block->handle, 0, capacity);
+    block->capacity = capacity;
+    block->offset = 0;
+    block->next = command_buffer->staging_blocks;
+    command_buffer->staging_blocks = block;
+  }
+  *out_handle = block->handle;
+  *out_offset = block->offset;
+  *out_ptr = block->mapped_ptr + block->offset;
+  block->offset += length;
+  return iree_ok_status();
+}
+
+// Unmaps all staging blocks so that the encoded commands can read them.
+static void iree_hal_webgpu_command_buffer_unmap_staging(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  for (iree_hal_webgpu_staging_block_t* block = command_buffer->staging_blocks;
+       block; block = block->next) {
+    if (block->mapped_ptr) {
+      wgpuBufferUnmap(block->handle);
+      block->mapped_ptr = NULL;
+    }
+  }
+}
+
+static WGPUComputePassEncoder iree_hal_webgpu_command_buffer_acquire_pass(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  if (!command_buffer->compute_pass) {
+    const WGPUComputePassDescriptor descriptor = {0};
+    command_buffer->compute_pass = wgpuCommandEncoderBeginComputePass(
+        command_buffer->encoder, &descriptor);
+  }
+  return command_buffer->compute_pass;
+}
+
+// Ends the open compute pass, if any. Must be called before any command
+// encoded directly into the command encoder.
+static void iree_hal_webgpu_command_buffer_end_pass(
+    iree_hal_webgpu_command_buffer_t* command_buffer) {
+  if (command_buffer->compute_pass) {
+    wgpuComputePassEncoderEnd(command_buffer->compute_pass);
+    wgpuComputePassEncoderRelease(command_buffer->compute_pass);
+    command_buffer->compute_pass = NULL;
+  }
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_begin(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (command_buffer->encoder || command_buffer->handle) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "WebGPU command buffers can only be recorded once");
+  }
+  const WGPUCommandEncoderDescriptor descriptor = {0};
+  command_buffer->encoder =
+      wgpuDeviceCreateCommandEncoder(command_buffer->device, &descriptor);
+  if (!command_buffer->encoder) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuDeviceCreateCommandEncoder failed");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_end(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+  iree_hal_webgpu_command_buffer_unmap_staging(command_buffer);
+  iree_hal_webgpu_command_buffer_reset_state(command_buffer);
+
+  const WGPUCommandBufferDescriptor descriptor = {0};
+  command_buffer->handle =
+      wgpuCommandEncoderFinish(command_buffer->encoder, &descriptor);
+  wgpuCommandEncoderRelease(command_buffer->encoder);
+  command_buffer->encoder = NULL;
+  if (!command_buffer->handle) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuCommandEncoderFinish failed");
+  }
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_command_buffer_begin_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
+    iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+  // The label must be NUL-terminated; long labels are truncated.
+  char label_str[128];
+  iree_host_size_t label_length = iree_min(label.size, sizeof(label_str) - 1);
+  memcpy(label_str, label.data, label_length);
+  label_str[label_length] = 0;
+  wgpuCommandEncoderPushDebugGroup(command_buffer->encoder, label_str);
+}
+
+static void iree_hal_webgpu_command_buffer_end_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+  wgpuCommandEncoderPopDebugGroup(command_buffer->encoder);
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_execution_barrier(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  // WebGPU tracks resource usage and synchronizes each dispatch and transfer
+  // with the preceding ones itself.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_signal_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  // Commands execute in order, see execution_barrier.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_reset_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  // Commands execute in order, see execution_barrier.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_wait_events(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_host_size_t event_count, const iree_hal_event_t** events,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  // Commands execute in order, see execution_barrier.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_discard_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_buffer_t* buffer) {
+  return iree_ok_status();
+}
+
+// Fills 32-bit words with |pattern| using the fill_buffer builtin.
+static iree_status_t iree_hal_webgpu_command_buffer_fill_words(
+    iree_hal_webgpu_command_buffer_t* command_buffer, WGPUBuffer target,
+    iree_device_size_t target_offset, iree_device_size_t length,
+    uint32_t pattern) {
+  const iree_hal_webgpu_builtins_t* builtins = command_buffer->builtins;
+  const iree_device_size_t max_word_count =
+      (iree_device_size_t)IREE_HAL_WEBGPU_MAX_WORKGROUP_COUNT *
+      IREE_HAL_WEBGPU_FILL_BUFFER_WORKGROUP_SIZE;
+  iree_device_size_t word_offset = target_offset / 4;
+  iree_device_size_t word_count = length / 4;
+  while (word_count > 0) {
+    iree_device_size_t chunk_word_count = iree_min(word_count, max_word_count);
+
+    WGPUBuffer params_handle = NULL;
+    iree_device_size_t params_offset = 0;
+    iree_hal_webgpu_fill_buffer_params_t* params = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_stage(
+        command_buffer, sizeof(*params), &params_handle, &params_offset,
+        (void**)&params));
+    params->offset = (uint32_t)word_offset;
+    params->length = (uint32_t)chunk_word_count;
+    params->pattern = pattern;
+    params->reserved = 0;
+
+    // Storage bindings must be aligned to minStorageBufferOffsetAlignment so
+    // the whole buffer is bound and the offset is passed in the params.
+    const WGPUBindGroupEntry entries[2] = {
+        {
+            .binding = 0,
+            .buffer = target,
+            .offset = 0,
+            .size = WGPU_WHOLE_SIZE,
+        },
+        {
+            .binding = 1,
+            .buffer = params_handle,
+            .offset = params_offset,
+            .size = sizeof(*params),
+        },
+    };
+    const WGPUBindGroupDescriptor descriptor = {
+        .layout = builtins->fill_buffer.bind_group_layout,
+        .entryCount = IREE_ARRAYSIZE(entries),
+        .entries = entries,
+    };
+    WGPUBindGroup bind_group =
+        wgpuDeviceCreateBindGroup(command_buffer->device, &descriptor);
+    if (!bind_group) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "failed to create the fill_buffer bind group");
+    }
+
+    // Dispatches reset all bind groups they use, so changing the pipeline
+    // here needs no restoring afterwards.
+    WGPUComputePassEncoder pass =
+        iree_hal_webgpu_command_buffer_acquire_pass(command_buffer);
+    wgpuComputePassEncoderSetPipeline(pass, builtins->fill_buffer.pipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, bind_group, 0, NULL);
+    wgpuComputePassEncoderDispatchWorkgroups(
+        pass,
+        (uint32_t)((chunk_word_count +
+                    IREE_HAL_WEBGPU_FILL_BUFFER_WORKGROUP_SIZE - 1) /
+                   IREE_HAL_WEBGPU_FILL_BUFFER_WORKGROUP_SIZE),
+        1, 1);
+    wgpuBindGroupRelease(bind_group);
+
+    word_offset += chunk_word_count;
+    word_count -= chunk_word_count;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_fill_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, const void* pattern,
+    iree_host_size_t pattern_length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+
+  WGPUBuffer target = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_resolve_buffer(target_buffer, &target_offset, &target));
+  if ((target_offset % 4) != 0 || (length % 4) != 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "fills must be 4-byte aligned in WebGPU");
+  }
+
+  // Splat the pattern to 32 bits.
+  uint32_t pattern_bits = 0;
+  switch (pattern_length) {
+    case 1:
+      pattern_bits = *(const uint8_t*)pattern;
+      pattern_bits |= pattern_bits << 8;
+      pattern_bits |= pattern_bits << 16;
+      break;
+    case 2:
+      pattern_bits = *(const uint16_t*)pattern;
+      pattern_bits |= pattern_bits << 16;
+      break;
+    case 4:
+      pattern_bits = *(const uint32_t*)pattern;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unsupported fill pattern length %zu",
+                              pattern_length);
+  }
+
+  WGPUBufferUsageFlags usage = iree_hal_webgpu_buffer_handle_usage(
+      iree_hal_buffer_allocated_buffer(target_buffer));
+  if (pattern_bits == 0 && (usage & WGPUBufferUsage_CopyDst)) {
+    iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+    wgpuCommandEncoderClearBuffer(command_buffer->encoder, target,
+                                  target_offset, length);
+    return iree_ok_status();
+  }
+  if (!(usage & WGPUBufferUsage_Storage)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "non-zero fills require a storage buffer");
+  }
+  return iree_hal_webgpu_command_buffer_fill_words(
+      command_buffer, target, target_offset, length, pattern_bits);
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_update_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
+    iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+
+  WGPUBuffer target = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_resolve_buffer(target_buffer, &target_offset, &target));
+  if ((target_offset % 4) != 0 || (length % 4) != 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "updates must be 4-byte aligned in WebGPU");
+  }
+
+  WGPUBuffer staging = NULL;
+  iree_device_size_t staging_offset = 0;
+  void* staging_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_stage(
+      command_buffer, length, &staging, &staging_offset, &staging_ptr));
+  memcpy(staging_ptr, (const uint8_t*)source_buffer + source_offset,
+         (size_t)length);
+
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+  wgpuCommandEncoderCopyBufferToBuffer(command_buffer->encoder, staging,
+                                       staging_offset, target, target_offset,
+                                       length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_copy_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+
+  WGPUBuffer source = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_resolve_buffer(source_buffer, &source_offset, &source));
+  WGPUBuffer target = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_webgpu_resolve_buffer(target_buffer, &target_offset, &target));
+  if ((source_offset % 4) != 0 || (target_offset % 4) != 0 ||
+      (length % 4) != 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "copies must be 4-byte aligned in WebGPU");
+  }
+
+  iree_hal_webgpu_command_buffer_end_pass(command_buffer);
+  wgpuCommandEncoderCopyBufferToBuffer(command_buffer->encoder, source,
+                                       source_offset, target, target_offset,
+                                       length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_collective(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
+    iree_hal_collective_op_t op, uint32_t param,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "collectives not supported in WebGPU");
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_push_constants(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t offset,
+    const void* values, iree_host_size_t values_length) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (IREE_UNLIKELY(offset + values_length >
+                    sizeof(command_buffer->state.push_constants))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "push constant range %zu (length=%zu) out of range",
+                            offset, values_length);
+  }
+  memcpy((uint8_t*)command_buffer->state.push_constants + offset, values,
+         values_length);
+  // Restaged on the next dispatch.
+  if (command_buffer->state.params_bind_group) {
+    wgpuBindGroupRelease(command_buffer->state.params_bind_group);
+    command_buffer->state.params_bind_group = NULL;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_push_descriptor_set(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  if (IREE_UNLIKELY(set >= IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_COUNT)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "descriptor set %u out of range", set);
+  }
+
+  WGPUBindGroupEntry* entries =
+      (WGPUBindGroupEntry*)iree_alloca(binding_count * sizeof(*entries));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    const iree_hal_descriptor_set_binding_t* binding = &bindings[i];
+    if (IREE_UNLIKELY(!binding->buffer)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding %u has no buffer", binding->binding);
+    }
+    iree_device_size_t offset = binding->offset;
+    WGPUBuffer handle = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_webgpu_resolve_buffer(binding->buffer, &offset, &handle));
+    iree_device_size_t length =
+        binding->length == IREE_WHOLE_BUFFER
+            ? iree_hal_buffer_byte_length(binding->buffer) - binding->offset
+            : binding->length;
+    entries[i] = (WGPUBindGroupEntry){
+        .binding = binding->binding,
+        .buffer = handle,
+        .offset = offset,
+        .size = length,
+    };
+  }
+  const WGPUBindGroupDescriptor descriptor = {
+      .layout =
+          iree_hal_webgpu_pipeline_layout_set_handle(pipeline_layout, set),
+      .entryCount = (uint32_t)binding_count,
+      .entries = entries,
+  };
+  WGPUBindGroup bind_group =
+      wgpuDeviceCreateBindGroup(command_buffer->device, &descriptor);
+  if (!bind_group) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuDeviceCreateBindGroup failed");
+  }
+
+  if (command_buffer->state.bind_groups[set]) {
+    wgpuBindGroupRelease(command_buffer->state.bind_groups[set]);
+  }
+  command_buffer->state.bind_groups[set] = bind_group;
+  return iree_ok_status();
+}
+
+// Sets the pipeline of |entry_point| and all bind groups of its layout,
+// staging the push constants if they changed since the last dispatch.
+static iree_status_t iree_hal_webgpu_command_buffer_prepare_dispatch(
+    iree_hal_webgpu_command_buffer_t* command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    WGPUComputePassEncoder* out_pass) {
+  iree_hal_pipeline_layout_t* layout =
+      iree_hal_webgpu_executable_layout(executable, entry_point);
+  iree_host_size_t set_count =
+      iree_hal_webgpu_pipeline_layout_set_layout_count(layout);
+  iree_host_size_t push_constant_count =
+      iree_hal_webgpu_pipeline_layout_push_constant_count(layout);
+
+  if (push_constant_count > 0 && !command_buffer->state.params_bind_group) {
+    // The compiler packs the constants into vec4s.
+    iree_device_size_t params_length =
+        iree_device_align(push_constant_count * sizeof(uint32_t), 16);
+    WGPUBuffer params_handle = NULL;
+    iree_device_size_t params_offset = 0;
+    void* params_ptr = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_stage(
+        command_buffer, params_length, &params_handle, &params_offset,
+        &params_ptr));
+    memcpy(params_ptr, command_buffer->state.push_constants, params_length);
+    const WGPUBindGroupEntry entry = {
+        .binding = IREE_HAL_WEBGPU_PARAMS_BINDING_INDEX,
+        .buffer = params_handle,
+        .offset = params_offset,
+        .size = params_length,
+    };
+    const WGPUBindGroupDescriptor descriptor = {
+        .layout = command_buffer->builtins->params_bind_group_layout,
+        .entryCount = 1,
+        .entries = &entry,
+    };
+    command_buffer->state.params_bind_group =
+        wgpuDeviceCreateBindGroup(command_buffer->device, &descriptor);
+    if (!command_buffer->state.params_bind_group) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "failed to create the params bind group");
+    }
+  }
+
+  WGPUComputePassEncoder pass =
+      iree_hal_webgpu_command_buffer_acquire_pass(command_buffer);
+  wgpuComputePassEncoderSetPipeline(
+      pass, iree_hal_webgpu_executable_pipeline(executable, entry_point));
+  for (iree_host_size_t i = 0; i < set_count; ++i) {
+    if (IREE_UNLIKELY(!command_buffer->state.bind_groups[i])) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "descriptor set %zu not pushed before dispatch",
+                              i);
+    }
+    wgpuComputePassEncoderSetBindGroup(
+        pass, (uint32_t)i, command_buffer->state.bind_groups[i], 0, NULL);
+  }
+  if (push_constant_count > 0) {
+    for (iree_host_size_t i = set_count;
+         i < IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX; ++i) {
+      wgpuComputePassEncoderSetBindGroup(
+          pass, (uint32_t)i, command_buffer->builtins->empty_bind_group, 0,
+          NULL);
+    }
+    wgpuComputePassEncoderSetBindGroup(
+        pass, IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX,
+        command_buffer->state.params_bind_group, 0, NULL);
+  }
+
+  *out_pass = pass;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  WGPUComputePassEncoder pass = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_prepare_dispatch(
+      command_buffer, executable, entry_point, &pass));
+  wgpuComputePassEncoderDispatchWorkgroups(pass, workgroup_x, workgroup_y,
+                                           workgroup_z);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_dispatch_indirect(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    iree_hal_buffer_t* workgroups_buffer,
+    iree_device_size_t workgroups_offset) {
+  iree_hal_webgpu_command_buffer_t* command_buffer =
+      iree_hal_webgpu_command_buffer_cast(base_command_buffer);
+  WGPUBuffer workgroups = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_resolve_buffer(
+      workgroups_buffer, &workgroups_offset, &workgroups));
+  WGPUComputePassEncoder pass = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_prepare_dispatch(
+      command_buffer, executable, entry_point, &pass));
+  wgpuComputePassEncoderDispatchWorkgroupsIndirect(pass, workgroups,
+                                                   workgroups_offset);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_command_buffer_execute_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* base_commands,
+    iree_hal_buffer_binding_table_t binding_table) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "secondary command buffers not supported in WebGPU");
+}
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_webgpu_command_buffer_vtable = {
+        .destroy = iree_hal_webgpu_command_buffer_destroy,
+        .dyn_cast = iree_hal_webgpu_command_buffer_dyn_cast,
+        .begin = iree_hal_webgpu_command_buffer_begin,
+        .end = iree_hal_webgpu_command_buffer_end,
+        .begin_debug_group = iree_hal_webgpu_command_buffer_begin_debug_group,
+        .end_debug_group = iree_hal_webgpu_command_buffer_end_debug_group,
+        .execution_barrier = iree_hal_webgpu_command_buffer_execution_barrier,
+        .signal_event = iree_hal_webgpu_command_buffer_signal_event,
+        .reset_event = iree_hal_webgpu_command_buffer_reset_event,
+        .wait_events = iree_hal_webgpu_command_buffer_wait_events,
+        .discard_buffer = iree_hal_webgpu_command_buffer_discard_buffer,
+        .fill_buffer = iree_hal_webgpu_command_buffer_fill_buffer,
+        .update_buffer = iree_hal_webgpu_command_buffer_update_buffer,
+        .copy_buffer = iree_hal_webgpu_command_buffer_copy_buffer,
+        .collective = iree_hal_webgpu_command_buffer_collective,
+        .push_constants = iree_hal_webgpu_command_buffer_push_constants,
+        .push_descriptor_set =
+            iree_hal_webgpu_command_buffer_push_descriptor_set,
+        .dispatch = iree_hal_webgpu_command_buffer_dispatch,
+        .dispatch_indirect = iree_hal_webgpu_command_buffer_dispatch_indirect,
+        .execute_commands = iree_hal_webgpu_command_buffer_execute_commands,
+};
@@ -0,0 +1,51 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_COMMAND_BUFFER_H_
+#define IREE_HAL_WEBGPU_COMMAND_BUFFER_H_
+
+#include "experimental/webgpu/builtins.h"
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a one-shot command buffer that encodes commands into a
+// WGPUCommandEncoder as they are recorded.
+//
+// Devices record into deferred command buffers and apply them to one of these
+// at submission: WebGPU command buffers can only be submitted once and the
+// staging buffers used for push constants and buffer updates must be mapped
+// while recording, so encoding as late as possible keeps both cheap.
+//
+// Push constants, buffer updates and fill parameters are staged in mapped
+// uniform buffers of |staging_block_size| bytes that live as long as the
+// command buffer.
+iree_status_t iree_hal_webgpu_command_buffer_create(
+    iree_hal_device_t* device, WGPUDevice handle,
+    const iree_hal_webgpu_builtins_t* builtins,
+    iree_device_size_t staging_block_size,
+    iree_hal_command_category_t command_categories,
+    iree_allocator_t host_allocator,
+    iree_hal_command_buffer_t** out_command_buffer);
+
+// Returns true if |command_buffer| is a WebGPU command buffer.
+bool iree_hal_webgpu_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer);
+
+// Returns the WGPUCommandBuffer encoded by |command_buffer|.
+// Only valid after the command buffer has ended and until it is destroyed.
+WGPUCommandBuffer iree_hal_webgpu_command_buffer_handle(
+    iree_hal_command_buffer_t* command_buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_COMMAND_BUFFER_H_
@@ -0,0 +1,269 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/executable.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "experimental/webgpu/pipeline_layout.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+// flatcc schemas:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/wgsl_executable_def_reader.h"
+#include "iree/schemas/wgsl_executable_def_verifier.h"
+
+typedef struct iree_hal_webgpu_entry_point_t {
+  WGPUComputePipeline pipeline;
+  iree_hal_pipeline_layout_t* layout;
+} iree_hal_webgpu_entry_point_t;
+
+typedef struct iree_hal_webgpu_executable_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_host_size_t entry_point_count;
+  iree_hal_webgpu_entry_point_t entry_points[];
+} iree_hal_webgpu_executable_t;
+
+static const iree_hal_executable_vtable_t iree_hal_webgpu_executable_vtable;
+
+static iree_hal_webgpu_executable_t* iree_hal_webgpu_executable_cast(
+    iree_hal_executable_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_executable_vtable);
+  return (iree_hal_webgpu_executable_t*)base_value;
+}
+
+// Verifies the structure of the flatbuffer so that we can avoid doing so during
+// runtime.
+static iree_status_t iree_hal_webgpu_executable_flatbuffer_verify(
+    iree_const_byte_span_t flatbuffer_data,
+    iree_host_size_t expected_entry_point_count) {
+  if (!flatbuffer_data.data || flatbuffer_data.data_length < 16) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "FlatBuffer data is not present or less than 16 bytes (%zu total)",
+        flatbuffer_data.data_length);
+  }
+
+  // Run flatcc generated verification. This ensures all pointers are in-bounds
+  // and that we can safely walk the file, but not that the actual contents of
+  // the FlatBuffer meet our expectations.
+  int verify_ret = iree_WGSLExecutableDef_verify_as_root(
+      flatbuffer_data.data, flatbuffer_data.data_length);
+  if (verify_ret != flatcc_verify_ok) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "FlatBuffer verification failed: %s",
+                            flatcc_verify_error_string(verify_ret));
+  }
+
+  iree_WGSLExecutableDef_table_t executable_def =
+      iree_WGSLExecutableDef_as_root(flatbuffer_data.data);
+
+  iree_WGSLShaderModuleDef_vec_t shader_modules_vec =
+      iree_WGSLExecutableDef_shader_modules_get(executable_def);
+  size_t shader_module_count =
+      iree_WGSLShaderModuleDef_vec_len(shader_modules_vec);
+  for (size_t i = 0; i < shader_module_count; ++i) {
+    iree_WGSLShaderModuleDef_table_t shader_module_def =
+        iree_WGSLShaderModuleDef_vec_at(shader_modules_vec, i);
+    if (!flatbuffers_string_len(
+            iree_WGSLShaderModuleDef_code_get(shader_module_def))) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "shader module %zu WGSL code is missing/empty",
+                              i);
+    }
+  }
+
+  flatbuffers_int32_vec_t entry_points_vec =
+      iree_WGSLExecutableDef_entry_points_get(executable_def);
+  size_t entry_point_count = flatbuffers_int32_vec_len(entry_points_vec);
+  if (entry_point_count != expected_entry_point_count) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable provides %zu entry points but caller "
+                            "provided %zu; must match",
+                            entry_point_count, expected_entry_point_count);
+  }
+  for (size_t i = 0; i < entry_point_count; ++i) {
+    int32_t shader_module_ordinal =
+        flatbuffers_int32_vec_at(entry_points_vec, i);
+    if (shader_module_ordinal < 0 ||
+        (size_t)shader_module_ordinal >= shader_module_count) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable entry point %zu references an "
+                              "invalid shader module %d",
+                              i, shader_module_ordinal);
+    }
+  }
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_create_shader_module(
+    WGPUDevice device, iree_WGSLShaderModuleDef_table_t shader_module_def,
+    WGPUShaderModule* out_shader_module) {
+  const WGPUShaderModuleWGSLDescriptor wgsl_descriptor = {
+      .chain =
+          {
+              .next = NULL,
+              .sType = WGPUSType_ShaderModuleWGSLDescriptor,
+          },
+      .code = iree_WGSLShaderModuleDef_code_get(shader_module_def),
+  };
+  const WGPUShaderModuleDescriptor descriptor = {
+      .nextInChain = &wgsl_descriptor.chain,
+  };
+  *out_shader_module = wgpuDeviceCreateShaderModule(device, &descriptor);
+  if (!*out_shader_module) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuDeviceCreateShaderModule failed");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_create_pipeline(
+    WGPUDevice device, WGPUShaderModule shader_module, uint32_t entry_ordinal,
+    iree_hal_pipeline_layout_t* pipeline_layout,
+    WGPUComputePipeline* out_pipeline) {
+  // The compiler names entry points by their ordinal.
+  char entry_point_name[16];
+  snprintf(entry_point_name, sizeof(entry_point_name), "d%u", entry_ordinal);
+  const WGPUComputePipelineDescriptor descriptor = {
+      .layout = iree_hal_webgpu_pipeline_layout_handle(pipeline_layout),
+      .compute =
+          {
+              .module = shader_module,
+              .entryPoint = entry_point_name,
+          },
+  };
+  *out_pipeline = wgpuDeviceCreateComputePipeline(device, &descriptor);
+  if (!*out_pipeline) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "wgpuDeviceCreateComputePipeline failed for "
+                            "entry point %u",
+                            entry_ordinal);
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_webgpu_executable_create(
+    WGPUDevice device, const iree_hal_executable_params_t* executable_params,
+    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(executable_params);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  *out_executable = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_webgpu_executable_flatbuffer_verify(
+              executable_params->executable_data,
+              executable_params->pipeline_layout_count));
+  iree_WGSLExecutableDef_table_t executable_def =
+      iree_WGSLExecutableDef_as_root(executable_params->executable_data.data);
+  iree_WGSLShaderModuleDef_vec_t shader_modules_vec =
+      iree_WGSLExecutableDef_shader_modules_get(executable_def);
+  iree_host_size_t shader_module_count =
+      iree_WGSLShaderModuleDef_vec_len(shader_modules_vec);
+  flatbuffers_int32_vec_t entry_points_vec =
+      iree_WGSLExecutableDef_entry_points_get(executable_def);
+  iree_host_size_t entry_point_count =
+      flatbuffers_int32_vec_len(entry_points_vec);
+
+  iree_hal_webgpu_executable_t* executable = NULL;
+  iree_host_size_t total_size =
+      sizeof(*executable) +
+      entry_point_count * sizeof(executable->entry_points[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&executable));
+  iree_hal_resource_initialize(&iree_hal_webgpu_executable_vtable,
+                               &executable->resource);
+  executable->host_allocator = host_allocator;
+  executable->entry_point_count = entry_point_count;
+
+  // Shader modules are only needed while creating the pipelines.
+  WGPUShaderModule* shader_modules = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, shader_module_count * sizeof(*shader_modules),
+      (void**)&shader_modules);
+  if (iree_status_is_ok(status)) {
+    memset(shader_modules, 0, shader_module_count * sizeof(*shader_modules));
+    for (iree_host_size_t i = 0;
+         i < shader_module_count && iree_status_is_ok(status); ++i) {
+      status = iree_hal_webgpu_create_shader_module(
+          device, iree_WGSLShaderModuleDef_vec_at(shader_modules_vec, i),
+          &shader_modules[i]);
+    }
+  }
+
+  for (iree_host_size_t i = 0;
+       i < entry_point_count && iree_status_is_ok(status); ++i) {
+    iree_hal_webgpu_entry_point_t* entry_point = &executable->entry_points[i];
+    entry_point->layout = executable_params->pipeline_layouts[i];
+    iree_hal_pipeline_layout_retain(entry_point->layout);
+    status = iree_hal_webgpu_create_pipeline(
+        device,
+        shader_modules[flatbuffers_int32_vec_at(entry_points_vec, i)],
+        (uint32_t)i, entry_point->layout, &entry_point->pipeline);
+  }
+
+  if (shader_modules) {
+    for (iree_host_size_t i = 0; i < shader_module_count; ++i) {
+      if (shader_modules[i]) wgpuShaderModuleRelease(shader_modules[i]);
+    }
+    iree_allocator_free(host_allocator, shader_modules);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_executable = (iree_hal_executable_t*)executable;
+  } else {
+    iree_hal_executable_destroy((iree_hal_executable_t*)executable);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_webgpu_executable_t* executable =
+      iree_hal_webgpu_executable_cast(base_executable);
+  iree_allocator_t host_allocator = executable->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < executable->entry_point_count; ++i) {
+    iree_hal_webgpu_entry_point_t* entry_point = &executable->entry_points[i];
+    if (entry_point->pipeline) {
+      wgpuComputePipelineRelease(entry_point->pipeline);
+    }
+    iree_hal_pipeline_layout_release(entry_point->layout);
+  }
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+WGPUComputePipeline iree_hal_webgpu_executable_pipeline(
+    iree_hal_executable_t* base_executable, uint32_t entry_point) {
+  iree_hal_webgpu_executable_t* executable =
+      iree_hal_webgpu_executable_cast(base_executable);
+  IREE_ASSERT_LT(entry_point, executable->entry_point_count);
+  return executable->entry_points[entry_point].pipeline;
+}
+
+iree_hal_pipeline_layout_t* iree_hal_webgpu_executable_layout(
+    iree_hal_executable_t* base_executable, uint32_t entry_point) {
+  iree_hal_webgpu_executable_t* executable =
+      iree_hal_webgpu_executable_cast(base_executable);
+  IREE_ASSERT_LT(entry_point, executable->entry_point_count);
+  return executable->entry_points[entry_point].layout;
+}
+
+static const iree_hal_executable_vtable_t iree_hal_webgpu_executable_vtable = {
+    .destroy = iree_hal_webgpu_executable_destroy,
+};
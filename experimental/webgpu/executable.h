@@ -0,0 +1,41 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_EXECUTABLE_H_
+#define IREE_HAL_WEBGPU_EXECUTABLE_H_
+
+#include <stdint.h>
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Executable format produced by the compiler's WebGPU target.
+#define IREE_HAL_WEBGPU_EXECUTABLE_FORMAT "webgpu-wgsl-fb"
+
+// Creates an executable with a compute pipeline per entry point from a
+// WGSLExecutableDef flatbuffer.
+iree_status_t iree_hal_webgpu_executable_create(
+    WGPUDevice device, const iree_hal_executable_params_t* executable_params,
+    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable);
+
+// Returns the compute pipeline of |entry_point|.
+WGPUComputePipeline iree_hal_webgpu_executable_pipeline(
+    iree_hal_executable_t* executable, uint32_t entry_point);
+
+// Returns the pipeline layout of |entry_point|.
+iree_hal_pipeline_layout_t* iree_hal_webgpu_executable_layout(
+    iree_hal_executable_t* executable, uint32_t entry_point);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_EXECUTABLE_H_
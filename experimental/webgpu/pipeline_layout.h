@@ -0,0 +1,80 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_PIPELINE_LAYOUT_H_
+#define IREE_HAL_WEBGPU_PIPELINE_LAYOUT_H_
+
+#include "experimental/webgpu/builtins.h"
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// WebGPU has no push constants: the compiler replaces them with a uniform
+// buffer at a fixed binding that command buffers stage the constants into.
+// These must match the compiler (WGSLReplacePushConstants.cpp).
+#define IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX 3
+#define IREE_HAL_WEBGPU_PARAMS_BINDING_INDEX 0
+
+#define IREE_HAL_WEBGPU_MAX_PUSH_CONSTANT_COUNT 64
+// Descriptor sets available below the push constant bind group.
+#define IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_COUNT \
+  IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_descriptor_set_layout_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_hal_webgpu_descriptor_set_layout_create(
+    WGPUDevice device, iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_allocator_t host_allocator,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout);
+
+// Returns the bind group layout of the descriptor set layout.
+WGPUBindGroupLayout iree_hal_webgpu_descriptor_set_layout_handle(
+    iree_hal_descriptor_set_layout_t* descriptor_set_layout);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_pipeline_layout_t
+//===----------------------------------------------------------------------===//
+
+// Creates a pipeline layout with a bind group per descriptor set and, when
+// there are push constants, the shared params bind group layout of
+// |builtins| at IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX. Unused bind groups
+// in between use the empty bind group layout of |builtins|.
+iree_status_t iree_hal_webgpu_pipeline_layout_create(
+    WGPUDevice device, const iree_hal_webgpu_builtins_t* builtins,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_host_size_t push_constant_count, iree_allocator_t host_allocator,
+    iree_hal_pipeline_layout_t** out_pipeline_layout);
+
+// Returns the WebGPU pipeline layout of the pipeline layout.
+WGPUPipelineLayout iree_hal_webgpu_pipeline_layout_handle(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+// Returns the number of descriptor sets in the pipeline layout.
+iree_host_size_t iree_hal_webgpu_pipeline_layout_set_layout_count(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+// Returns the bind group layout of descriptor set |set|.
+WGPUBindGroupLayout iree_hal_webgpu_pipeline_layout_set_handle(
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t set);
+
+// Returns the number of 32-bit push constants in the pipeline layout.
+iree_host_size_t iree_hal_webgpu_pipeline_layout_push_constant_count(
+    iree_hal_pipeline_layout_t* pipeline_layout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_PIPELINE_LAYOUT_H_
@@ -0,0 +1,44 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/platform.h"
+
+#include "iree/base/internal/threading.h"
+
+#if defined(__EMSCRIPTEN__)
+
+#include <emscripten.h>
+
+iree_status_t iree_hal_webgpu_platform_check_can_block(void) {
+  if (!emscripten_has_asyncify()) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "blocking on WebGPU work requires building with -sASYNCIFY; without "
+        "it callbacks only run once control returns to the browser event "
+        "loop and waits must be satisfied before being made");
+  }
+  return iree_ok_status();
+}
+
+void iree_hal_webgpu_platform_process_events(WGPUDevice device) {
+  // Yields to the browser event loop which runs the pending callbacks.
+  emscripten_sleep(0);
+}
+
+#else
+
+iree_status_t iree_hal_webgpu_platform_check_can_block(void) {
+  return iree_ok_status();
+}
+
+void iree_hal_webgpu_platform_process_events(WGPUDevice device) {
+  // Dawn runs the callbacks of completed work from wgpuDeviceTick. Yield
+  // afterwards so that polling waits do not starve other threads.
+  wgpuDeviceTick(device);
+  iree_thread_yield();
+}
+
+#endif  // __EMSCRIPTEN__
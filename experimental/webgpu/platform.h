@@ -0,0 +1,37 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_PLATFORM_H_
+#define IREE_HAL_WEBGPU_PLATFORM_H_
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// WebGPU reports buffer mapping and queue completion with callbacks that only
+// run when the implementation processes events. Natively Dawn does so when
+// ticked from any thread, but in browsers callbacks only run once control
+// returns to the JavaScript event loop. Blocking on them from the main thread
+// is only possible when the program is built with -sASYNCIFY so that the wait
+// can yield to the event loop.
+
+// Returns OK if the calling thread can block until WebGPU callbacks run and
+// otherwise an UNAVAILABLE status explaining why it cannot.
+iree_status_t iree_hal_webgpu_platform_check_can_block(void);
+
+// Processes pending WebGPU events on |device|, running any callbacks for work
+// that has completed. Must only be called after
+// iree_hal_webgpu_platform_check_can_block has succeeded.
+void iree_hal_webgpu_platform_process_events(WGPUDevice device);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_PLATFORM_H_
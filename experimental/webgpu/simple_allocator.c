@@ -0,0 +1,323 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/simple_allocator.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/buffer.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_hal_webgpu_simple_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  WGPUDevice device;
+  IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
+} iree_hal_webgpu_simple_allocator_t;
+
+static const iree_hal_allocator_vtable_t
+    iree_hal_webgpu_simple_allocator_vtable;
+
+static iree_hal_webgpu_simple_allocator_t*
+iree_hal_webgpu_simple_allocator_cast(iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_simple_allocator_vtable);
+  return (iree_hal_webgpu_simple_allocator_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_simple_allocator_create(
+    WGPUDevice device, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_webgpu_simple_allocator_t* allocator = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*allocator), (void**)&allocator);
+  if (iree_status_is_ok(status)) {
+    memset(allocator, 0, sizeof(*allocator));
+    iree_hal_resource_initialize(&iree_hal_webgpu_simple_allocator_vtable,
+                                 &allocator->resource);
+    allocator->host_allocator = host_allocator;
+    allocator->device = device;
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_simple_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_webgpu_simple_allocator_t* allocator =
+      iree_hal_webgpu_simple_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_free(host_allocator, allocator);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_webgpu_simple_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_webgpu_simple_allocator_t* allocator =
+      (iree_hal_webgpu_simple_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_webgpu_simple_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_simple_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  IREE_STATISTICS({
+    iree_hal_webgpu_simple_allocator_t* allocator =
+        iree_hal_webgpu_simple_allocator_cast(base_allocator);
+    memcpy(out_statistics, &allocator->statistics, sizeof(*out_statistics));
+  });
+}
+
+static iree_status_t iree_hal_webgpu_simple_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  const iree_host_size_t count = 2;
+  if (out_count) *out_count = count;
+  if (capacity < count) {
+    // NOTE: lightweight as this is hit in normal pre-sizing usage.
+    return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+  }
+
+  // WebGPU does not expose memory heaps or their limits.
+  const iree_device_size_t max_allocation_size = ~(iree_device_size_t)0;
+  const iree_device_size_t min_alignment = 16;
+
+  // Device-local memory (dispatch resources):
+  heaps[0] = (iree_hal_allocator_memory_heap_t){
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .allowed_usage =
+          IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH,
+      .max_allocation_size = max_allocation_size,
+      .min_alignment = min_alignment,
+  };
+
+  // Mappable host-local memory (upload and readback only):
+  heaps[1] = (iree_hal_allocator_memory_heap_t){
+      .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+              IREE_HAL_MEMORY_TYPE_HOST_COHERENT |
+              IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+      .allowed_usage =
+          IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING,
+      .max_allocation_size = max_allocation_size,
+      .min_alignment = min_alignment,
+  };
+
+  return iree_ok_status();
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_webgpu_simple_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  // WebGPU buffers are either mappable or usable by dispatches but never both.
+  // Mappable buffers requested for dispatch are made device-local instead and
+  // their contents must be transferred through the queue.
+  if (iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+      iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_DISPATCH)) {
+    params->type &= ~(IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
+                      IREE_HAL_MEMORY_TYPE_HOST_CACHED);
+    params->type |= IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params->usage &= ~IREE_HAL_BUFFER_USAGE_MAPPING;
+  }
+
+  // Mappable buffers can only be mapped in one direction: buffers that are
+  // transferred into are read back and all others are uploaded from.
+  if (iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    if (iree_any_bit_set(params->usage,
+                         IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET)) {
+      params->usage &= ~IREE_HAL_BUFFER_USAGE_TRANSFER_SOURCE;
+      params->access &= ~IREE_HAL_MEMORY_ACCESS_WRITE;
+    } else {
+      params->usage &= ~IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET;
+    }
+  }
+
+  iree_hal_buffer_compatibility_t compatibility =
+      IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE;
+  if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
+  }
+  if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_DISPATCH)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH;
+  }
+
+  // We are now optimal.
+  params->type &= ~IREE_HAL_MEMORY_TYPE_OPTIMAL;
+
+  // WebGPU requires buffer sizes (and mapped ranges) to be 4-byte aligned and
+  // does not allow empty buffers to be bound.
+  *allocation_size = iree_max(4, iree_device_align(*allocation_size, 4));
+
+  return compatibility;
+}
+
+// Returns the WebGPU usage of buffers allocated with |params|.
+static WGPUBufferUsageFlags iree_hal_webgpu_select_buffer_usage(
+    const iree_hal_buffer_params_t* params) {
+  if (iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    return iree_any_bit_set(params->usage,
+                            IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET)
+               ? WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst
+               : WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc;
+  }
+  WGPUBufferUsageFlags usage = WGPUBufferUsage_Storage |
+                               WGPUBufferUsage_CopySrc |
+                               WGPUBufferUsage_CopyDst;
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ)) {
+    usage |= WGPUBufferUsage_Uniform;
+  }
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS)) {
+    usage |= WGPUBufferUsage_Indirect;
+  }
+  return usage;
+}
+
+static iree_status_t iree_hal_webgpu_simple_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_webgpu_simple_allocator_t* allocator =
+      iree_hal_webgpu_simple_allocator_cast(base_allocator);
+
+  // Coerce options into those required by WebGPU.
+  iree_hal_buffer_params_t compat_params = *params;
+  if (!iree_all_bits_set(
+          iree_hal_webgpu_simple_allocator_query_buffer_compatibility(
+              base_allocator, &compat_params, &allocation_size),
+          IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+  if (initial_data.data_length > allocation_size) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "initial data of %zu bytes exceeds the %" PRIu64
+                            " byte allocation",
+                            initial_data.data_length,
+                            (uint64_t)allocation_size);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)allocation_size);
+
+  // Buffers with initial data are created mapped so the data can be written
+  // without a queue operation, which works for all buffer usages.
+  WGPUBufferUsageFlags usage =
+      iree_hal_webgpu_select_buffer_usage(&compat_params);
+  const WGPUBufferDescriptor descriptor = {
+      .nextInChain = NULL,
+      .label = NULL,
+      .usage = usage,
+      .size = allocation_size,
+      .mappedAtCreation = !iree_const_byte_span_is_empty(initial_data),
+  };
+  WGPUBuffer handle = wgpuDeviceCreateBuffer(allocator->device, &descriptor);
+  iree_status_t status = iree_ok_status();
+  if (!handle) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "unable to allocate buffer of size %" PRIu64,
+                              (uint64_t)allocation_size);
+  }
+
+  if (iree_status_is_ok(status) && descriptor.mappedAtCreation) {
+    void* mapped_ptr =
+        wgpuBufferGetMappedRange(handle, 0, (size_t)allocation_size);
+    if (mapped_ptr) {
+      memcpy(mapped_ptr, initial_data.data, initial_data.data_length);
+    } else {
+      status = iree_make_status(IREE_STATUS_INTERNAL,
+                                "wgpuBufferGetMappedRange returned no memory");
+    }
+    wgpuBufferUnmap(handle);
+  }
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_webgpu_buffer_wrap(
+        base_allocator, allocator->device, handle, usage, compat_params.type,
+        compat_params.access, compat_params.usage, allocation_size,
+        /*byte_offset=*/0, /*byte_length=*/allocation_size, &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, compat_params.type, allocation_size));
+    *out_buffer = buffer;
+  } else if (handle) {
+    wgpuBufferDestroy(handle);
+    wgpuBufferRelease(handle);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_simple_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_webgpu_simple_allocator_t* allocator =
+      iree_hal_webgpu_simple_allocator_cast(base_allocator);
+  IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+      &allocator->statistics, iree_hal_buffer_memory_type(base_buffer),
+      iree_hal_buffer_allocation_size(base_buffer)));
+  (void)allocator;
+  iree_hal_buffer_destroy(base_buffer);
+}
+
+static iree_status_t iree_hal_webgpu_simple_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "importing from external buffers not supported");
+}
+
+static iree_status_t iree_hal_webgpu_simple_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "exporting to external buffers not supported");
+}
+
+static const iree_hal_allocator_vtable_t
+    iree_hal_webgpu_simple_allocator_vtable = {
+        .destroy = iree_hal_webgpu_simple_allocator_destroy,
+        .host_allocator = iree_hal_webgpu_simple_allocator_host_allocator,
+        .trim = iree_hal_webgpu_simple_allocator_trim,
+        .query_statistics = iree_hal_webgpu_simple_allocator_query_statistics,
+        .query_memory_heaps =
+            iree_hal_webgpu_simple_allocator_query_memory_heaps,
+        .query_buffer_compatibility =
+            iree_hal_webgpu_simple_allocator_query_buffer_compatibility,
+        .allocate_buffer = iree_hal_webgpu_simple_allocator_allocate_buffer,
+        .deallocate_buffer =
+            iree_hal_webgpu_simple_allocator_deallocate_buffer,
+        .import_buffer = iree_hal_webgpu_simple_allocator_import_buffer,
+        .export_buffer = iree_hal_webgpu_simple_allocator_export_buffer,
+};
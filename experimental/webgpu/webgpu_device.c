@@ -0,0 +1,744 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/webgpu_device.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/buffer.h"
+#include "experimental/webgpu/builtins.h"
+#include "experimental/webgpu/command_buffer.h"
+#include "experimental/webgpu/executable.h"
+#include "experimental/webgpu/nop_event.h"
+#include "experimental/webgpu/nop_executable_cache.h"
+#include "experimental/webgpu/pipeline_layout.h"
+#include "experimental/webgpu/platform.h"
+#include "experimental/webgpu/simple_allocator.h"
+#include "experimental/webgpu/webgpu_semaphore.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/resource_set.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_device_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_webgpu_device_t {
+  iree_hal_resource_t resource;
+  iree_string_view_t identifier;
+  iree_allocator_t host_allocator;
+
+  // Optional driver that created the device; retained for our lifetime.
+  iree_hal_driver_t* driver;
+
+  WGPUDevice handle;
+  WGPUQueue queue;
+  iree_hal_webgpu_device_options_t options;
+
+  // Block pool used for deferred command buffers and submission resource sets.
+  iree_arena_block_pool_t block_pool;
+
+  iree_hal_allocator_t* device_allocator;
+
+  // Layouts and pipelines shared by all command buffers.
+  iree_hal_webgpu_builtins_t builtins;
+
+  // Guards |error_status|.
+  iree_slim_mutex_t mutex;
+
+  // First error reported by WebGPU through the uncaptured error callback.
+  // WebGPU reports validation and out-of-memory errors asynchronously, so
+  // they are returned from the next submission instead of the call that
+  // caused them.
+  iree_status_t error_status IREE_GUARDED_BY(mutex);
+} iree_hal_webgpu_device_t;
+
+static const iree_hal_device_vtable_t iree_hal_webgpu_device_vtable;
+
+static iree_hal_webgpu_device_t* iree_hal_webgpu_device_cast(
+    iree_hal_device_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_device_vtable);
+  return (iree_hal_webgpu_device_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_webgpu_device_options_initialize(
+    iree_hal_webgpu_device_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->staging_block_size = 64 * 1024;
+}
+
+static void iree_hal_webgpu_device_uncaptured_error_callback(
+    WGPUErrorType type, const char* message, void* user_data) {
+  iree_hal_webgpu_device_t* device = (iree_hal_webgpu_device_t*)user_data;
+  iree_status_code_t code = type == WGPUErrorType_OutOfMemory
+                                ? IREE_STATUS_RESOURCE_EXHAUSTED
+                                : IREE_STATUS_INTERNAL;
+  iree_slim_mutex_lock(&device->mutex);
+  if (iree_status_is_ok(device->error_status)) {
+    device->error_status = iree_make_status(code, "WebGPU error %d: %s",
+                                            (int)type, message ? message : "");
+  }
+  iree_slim_mutex_unlock(&device->mutex);
+}
+
+// Returns a clone of the first error reported by WebGPU, if any.
+static iree_status_t iree_hal_webgpu_device_check_error(
+    iree_hal_webgpu_device_t* device) {
+  iree_slim_mutex_lock(&device->mutex);
+  iree_status_t status = iree_status_clone(device->error_status);
+  iree_slim_mutex_unlock(&device->mutex);
+  return status;
+}
+
+static void iree_hal_webgpu_device_destroy(iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Submissions retain the device so all of them have completed by now.
+  wgpuDeviceSetUncapturedErrorCallback(device->handle, NULL, NULL);
+
+  // There should be no more buffers live that use the allocator.
+  iree_hal_allocator_release(device->device_allocator);
+  iree_hal_webgpu_builtins_deinitialize(&device->builtins);
+  if (device->queue) wgpuQueueRelease(device->queue);
+  wgpuDeviceRelease(device->handle);
+
+  iree_arena_block_pool_deinitialize(&device->block_pool);
+  iree_status_ignore(device->error_status);
+  iree_slim_mutex_deinitialize(&device->mutex);
+
+  // Finally, destroy the device.
+  iree_hal_driver_release(device->driver);
+
+  iree_allocator_free(host_allocator, device);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_webgpu_device_create(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_webgpu_device_options_t* options, WGPUDevice handle,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(out_device);
+  *out_device = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_device_t* device = NULL;
+  iree_host_size_t total_size = sizeof(*device) + identifier.size;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+  memset(device, 0, total_size);
+  iree_hal_resource_initialize(&iree_hal_webgpu_device_vtable,
+                               &device->resource);
+  device->host_allocator = host_allocator;
+  device->driver = driver;
+  iree_hal_driver_retain(device->driver);
+  uint8_t* buffer_ptr = (uint8_t*)device + sizeof(*device);
+  buffer_ptr += iree_string_view_append_to_buffer(
+      identifier, &device->identifier, (char*)buffer_ptr);
+  wgpuDeviceReference(handle);
+  device->handle = handle;
+  device->queue = wgpuDeviceGetQueue(handle);
+  device->options = *options;
+  iree_arena_block_pool_initialize(32 * 1024, host_allocator,
+                                   &device->block_pool);
+  iree_slim_mutex_initialize(&device->mutex);
+  wgpuDeviceSetUncapturedErrorCallback(
+      handle, iree_hal_webgpu_device_uncaptured_error_callback, device);
+
+  iree_status_t status =
+      iree_hal_webgpu_builtins_initialize(handle, &device->builtins);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_webgpu_simple_allocator_create(
+        handle, host_allocator, &device->device_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_device = (iree_hal_device_t*)device;
+  } else {
+    iree_hal_device_release((iree_hal_device_t*)device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_wrap_device(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_device_options_t* options, WGPUDevice handle,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  return iree_hal_webgpu_device_create(/*driver=*/NULL, identifier, options,
+                                       handle, host_allocator, out_device);
+}
+
+static iree_string_view_t iree_hal_webgpu_device_id(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return device->identifier;
+}
+
+static iree_allocator_t iree_hal_webgpu_device_host_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return device->host_allocator;
+}
+
+static iree_hal_allocator_t* iree_hal_webgpu_device_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return device->device_allocator;
+}
+
+static void iree_hal_webgpu_replace_device_allocator(
+    iree_hal_device_t* base_device, iree_hal_allocator_t* new_allocator) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  iree_hal_allocator_retain(new_allocator);
+  iree_hal_allocator_release(device->device_allocator);
+  device->device_allocator = new_allocator;
+}
+
+static iree_status_t iree_hal_webgpu_device_trim(
+    iree_hal_device_t* base_device) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  iree_arena_block_pool_trim(&device->block_pool);
+  return iree_hal_allocator_trim(device->device_allocator);
+}
+
+static iree_status_t iree_hal_webgpu_device_query_i64(
+    iree_hal_device_t* base_device, iree_string_view_t category,
+    iree_string_view_t key, int64_t* out_value) {
+  *out_value = 0;
+
+  if (iree_string_view_equal(category,
+                             iree_make_cstring_view("hal.executable.format"))) {
+    *out_value = iree_string_view_equal(
+                     key, iree_make_cstring_view(
+                              IREE_HAL_WEBGPU_EXECUTABLE_FORMAT))
+                     ? 1
+                     : 0;
+    return iree_ok_status();
+  }
+
+  return iree_make_status(
+      IREE_STATUS_NOT_FOUND,
+      "unknown device configuration key value '%.*s :: %.*s'",
+      (int)category.size, category.data, (int)key.size, key.data);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_channel(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "collectives not supported in WebGPU");
+}
+
+static iree_status_t iree_hal_webgpu_device_create_command_buffer(
+    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  // Commands are recorded and encoded into a WebGPU command buffer on
+  // submission, see iree_hal_webgpu_command_buffer_create.
+  return iree_hal_deferred_command_buffer_create(
+      base_device, mode, command_categories, binding_capacity,
+      &device->block_pool, device->host_allocator, out_command_buffer);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_descriptor_set_layout(
+    iree_hal_device_t* base_device,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_descriptor_set_layout_create(
+      device->handle, flags, binding_count, bindings, device->host_allocator,
+      out_descriptor_set_layout);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_event(
+    iree_hal_device_t* base_device, iree_hal_event_t** out_event) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_nop_event_create(device->host_allocator, out_event);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_executable_cache(
+    iree_hal_device_t* base_device, iree_string_view_t identifier,
+    iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_nop_executable_cache_create(
+      device->handle, identifier, device->host_allocator,
+      out_executable_cache);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_pipeline_layout(
+    iree_hal_device_t* base_device, iree_host_size_t push_constants,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_pipeline_layout_create(
+      device->handle, &device->builtins, set_layout_count, set_layouts,
+      push_constants, device->host_allocator, out_pipeline_layout);
+}
+
+static iree_status_t iree_hal_webgpu_device_create_semaphore(
+    iree_hal_device_t* base_device, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  return iree_hal_webgpu_semaphore_create(device->handle, initial_value,
+                                          device->host_allocator,
+                                          out_semaphore);
+}
+
+static iree_hal_semaphore_compatibility_t
+iree_hal_webgpu_device_query_semaphore_compatibility(
+    iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
+  if (iree_hal_webgpu_semaphore_isa(semaphore)) {
+    // WebGPU semaphores are signaled on queue completion and waits on them
+    // are satisfied by queue order where possible.
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
+  // Other semaphores are waited and signaled from the host.
+  return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
+}
+
+// A submission to the device queue that has not yet completed.
+// The resources it uses are retained until wgpuQueueOnSubmittedWorkDone
+// reports the completion and the signal semaphores are signaled.
+typedef struct iree_hal_webgpu_submission_t {
+  iree_hal_webgpu_device_t* device;
+  iree_hal_resource_set_t* resource_set;
+  iree_hal_semaphore_list_t signal_semaphore_list;
+} iree_hal_webgpu_submission_t;
+
+static void iree_hal_webgpu_submission_work_done_callback(
+    WGPUQueueWorkDoneStatus work_done_status, void* user_data) {
+  iree_hal_webgpu_submission_t* submission =
+      (iree_hal_webgpu_submission_t*)user_data;
+  iree_hal_webgpu_device_t* device = submission->device;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (work_done_status == WGPUQueueWorkDoneStatus_Success) {
+    iree_status_t status =
+        iree_hal_semaphore_list_signal(submission->signal_semaphore_list);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_semaphore_list_fail(submission->signal_semaphore_list, status);
+    }
+  } else {
+    iree_hal_semaphore_list_fail(
+        submission->signal_semaphore_list,
+        iree_make_status(IREE_STATUS_ABORTED,
+                         "WebGPU queue work failed with status %d",
+                         (int)work_done_status));
+  }
+
+  iree_hal_resource_set_free(submission->resource_set);
+  iree_allocator_free(device->host_allocator, submission);
+  iree_hal_device_release((iree_hal_device_t*)device);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Tracks the completion of all work submitted to the queue so far, signaling
+// |signal_semaphore_list| and releasing |resource_set| when it completes.
+// Takes ownership of |resource_set| on success.
+static iree_status_t iree_hal_webgpu_device_track_submission(
+    iree_hal_webgpu_device_t* device,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_resource_set_t* resource_set) {
+  iree_hal_webgpu_submission_t* submission = NULL;
+  iree_host_size_t total_size =
+      sizeof(*submission) +
+      signal_semaphore_list.count *
+          (sizeof(*signal_semaphore_list.semaphores) +
+           sizeof(*signal_semaphore_list.payload_values));
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      device->host_allocator, total_size, (void**)&submission));
+  iree_status_t status = iree_hal_resource_set_insert(
+      resource_set, signal_semaphore_list.count,
+      signal_semaphore_list.semaphores);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(device->host_allocator, submission);
+    return status;
+  }
+
+  // The semaphores are retained by the resource set.
+  uint8_t* ptr = (uint8_t*)submission + sizeof(*submission);
+  submission->signal_semaphore_list.count = signal_semaphore_list.count;
+  submission->signal_semaphore_list.semaphores = (iree_hal_semaphore_t**)ptr;
+  memcpy(ptr, signal_semaphore_list.semaphores,
+         signal_semaphore_list.count *
+             sizeof(*signal_semaphore_list.semaphores));
+  ptr += signal_semaphore_list.count *
+         sizeof(*signal_semaphore_list.semaphores);
+  submission->signal_semaphore_list.payload_values = (uint64_t*)ptr;
+  memcpy(ptr, signal_semaphore_list.payload_values,
+         signal_semaphore_list.count *
+             sizeof(*signal_semaphore_list.payload_values));
+  submission->resource_set = resource_set;
+  submission->device = device;
+  iree_hal_device_retain((iree_hal_device_t*)device);
+
+  // Waits on the semaphores by work submitted after this are satisfied by
+  // queue order.
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    if (iree_hal_webgpu_semaphore_isa(signal_semaphore_list.semaphores[i])) {
+      iree_hal_webgpu_semaphore_enqueue_signal(
+          signal_semaphore_list.semaphores[i],
+          signal_semaphore_list.payload_values[i]);
+    }
+  }
+
+  wgpuQueueOnSubmittedWorkDone(device->queue, /*signalValue=*/0,
+                               iree_hal_webgpu_submission_work_done_callback,
+                               submission);
+  return iree_ok_status();
+}
+
+// Waits for |wait_semaphore_list| before work is submitted to the queue.
+// Waits on WebGPU semaphores signaled by work already submitted to the queue
+// are satisfied by queue order; all others block the host.
+static iree_status_t iree_hal_webgpu_device_wait_for_submission(
+    iree_hal_webgpu_device_t* device,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    uint64_t value = wait_semaphore_list.payload_values[i];
+    if (iree_hal_webgpu_semaphore_isa(semaphore) &&
+        iree_hal_webgpu_semaphore_is_ordered_before(semaphore, device->handle,
+                                                    value)) {
+      continue;
+    }
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout()));
+  }
+  return iree_ok_status();
+}
+
+// Encodes |command_buffer| (recorded as a deferred command buffer) into a new
+// WebGPU command buffer retained by |resource_set|.
+static iree_status_t iree_hal_webgpu_device_encode_command_buffer(
+    iree_hal_webgpu_device_t* device, iree_hal_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_resource_set_t* resource_set, WGPUCommandBuffer* out_handle) {
+  iree_hal_command_buffer_t* encoding_command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_webgpu_command_buffer_create(
+      (iree_hal_device_t*)device, device->handle, &device->builtins,
+      device->options.staging_block_size,
+      iree_hal_command_buffer_allowed_categories(command_buffer),
+      device->host_allocator, &encoding_command_buffer));
+  iree_status_t status =
+      iree_hal_resource_set_insert(resource_set, 1, &encoding_command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_deferred_command_buffer_apply(
+        command_buffer, encoding_command_buffer, binding_table);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_handle =
+        iree_hal_webgpu_command_buffer_handle(encoding_command_buffer);
+  }
+  iree_hal_command_buffer_release(encoding_command_buffer);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_execute(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status =
+      iree_hal_webgpu_device_wait_for_submission(device, wait_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_webgpu_device_check_error(device);
+  }
+
+  iree_hal_resource_set_t* resource_set = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_allocate(&device->block_pool, &resource_set);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(resource_set, command_buffer_count,
+                                          command_buffers);
+  }
+
+  WGPUCommandBuffer* handles =
+      (WGPUCommandBuffer*)iree_alloca(command_buffer_count * sizeof(*handles));
+  for (iree_host_size_t i = 0;
+       i < command_buffer_count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_webgpu_device_encode_command_buffer(
+        device, command_buffers[i],
+        binding_tables ? binding_tables[i]
+                       : iree_hal_buffer_binding_table_empty(),
+        resource_set, &handles[i]);
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (command_buffer_count > 0) {
+      wgpuQueueSubmit(device->queue, (uint32_t)command_buffer_count, handles);
+    }
+    status = iree_hal_webgpu_device_track_submission(
+        device, signal_semaphore_list, resource_set);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_resource_set_free(resource_set);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  // WebGPU has no queue-ordered allocations: allocate immediately and signal
+  // in queue order.
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(base_device), params, allocation_size,
+      iree_const_byte_span_empty(), out_buffer));
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_buffer_release(*out_buffer);
+    *out_buffer = NULL;
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  // The buffer is freed when its last reference is released; submissions
+  // using it retain it until they complete.
+  return iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                       wait_semaphore_list,
+                                       signal_semaphore_list);
+}
+
+static iree_status_t iree_hal_webgpu_device_queue_flush(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
+  // Currently unused; we flush as submissions are made.
+  return iree_ok_status();
+}
+
+// Returns true if |buffer| can be mapped for |access| on the host.
+static bool iree_hal_webgpu_buffer_is_mappable(
+    iree_hal_buffer_t* buffer, iree_hal_memory_access_t access) {
+  return iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                           IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+         iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                           IREE_HAL_BUFFER_USAGE_MAPPING) &&
+         iree_all_bits_set(iree_hal_buffer_allowed_access(buffer), access);
+}
+
+// Copies between two device buffers with a one-off command buffer.
+static iree_status_t iree_hal_webgpu_device_copy_buffer(
+    iree_hal_webgpu_device_t* device, iree_hal_buffer_t* source_buffer,
+    iree_device_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  source_offset += iree_hal_buffer_byte_offset(source_buffer);
+  target_offset += iree_hal_buffer_byte_offset(target_buffer);
+  if ((source_offset % 4) != 0 || (target_offset % 4) != 0 ||
+      (length % 4) != 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "transfers must be 4-byte aligned in WebGPU");
+  }
+  const WGPUCommandEncoderDescriptor encoder_descriptor = {0};
+  WGPUCommandEncoder encoder =
+      wgpuDeviceCreateCommandEncoder(device->handle, &encoder_descriptor);
+  wgpuCommandEncoderCopyBufferToBuffer(
+      encoder,
+      iree_hal_webgpu_buffer_handle(
+          iree_hal_buffer_allocated_buffer(source_buffer)),
+      source_offset,
+      iree_hal_webgpu_buffer_handle(
+          iree_hal_buffer_allocated_buffer(target_buffer)),
+      target_offset, length);
+  const WGPUCommandBufferDescriptor descriptor = {0};
+  WGPUCommandBuffer command_buffer =
+      wgpuCommandEncoderFinish(encoder, &descriptor);
+  wgpuCommandEncoderRelease(encoder);
+  wgpuQueueSubmit(device->queue, 1, &command_buffer);
+  wgpuCommandBufferRelease(command_buffer);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  if (data_length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Transfers are ordered with all prior submissions by the queue and mapping
+  // waits for the work using the buffer, so nothing waits on the timeout.
+  iree_status_t status = iree_ok_status();
+  if (!source.device_buffer && !target.device_buffer) {
+    memcpy(target.host_buffer.data + target_offset,
+           source.host_buffer.data + source_offset, (size_t)data_length);
+  } else if (!source.device_buffer) {
+    // Host -> device.
+    iree_hal_buffer_t* target_buffer = target.device_buffer;
+    const void* source_ptr = source.host_buffer.data + source_offset;
+    if (iree_hal_webgpu_buffer_is_mappable(target_buffer,
+                                           IREE_HAL_MEMORY_ACCESS_WRITE)) {
+      status = iree_hal_buffer_map_write(target_buffer, target_offset,
+                                         source_ptr, data_length);
+    } else {
+      iree_device_size_t offset =
+          iree_hal_buffer_byte_offset(target_buffer) + target_offset;
+      if ((offset % 4) != 0 || (data_length % 4) != 0) {
+        status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                  "transfers must be 4-byte aligned in WebGPU");
+      } else {
+        wgpuQueueWriteBuffer(device->queue,
+                             iree_hal_webgpu_buffer_handle(
+                                 iree_hal_buffer_allocated_buffer(
+                                     target_buffer)),
+                             offset, source_ptr, (size_t)data_length);
+      }
+    }
+  } else if (!target.device_buffer) {
+    // Device -> host.
+    iree_hal_buffer_t* source_buffer = source.device_buffer;
+    void* target_ptr = target.host_buffer.data + target_offset;
+    if (iree_hal_webgpu_buffer_is_mappable(source_buffer,
+                                           IREE_HAL_MEMORY_ACCESS_READ)) {
+      status = iree_hal_buffer_map_read(source_buffer, source_offset,
+                                        target_ptr, data_length);
+    } else {
+      // Copy into a readback buffer and map that.
+      const iree_hal_buffer_params_t params = {
+          .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+                  IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+          .usage = IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET |
+                   IREE_HAL_BUFFER_USAGE_MAPPING,
+          .access = IREE_HAL_MEMORY_ACCESS_READ,
+      };
+      iree_hal_buffer_t* staging_buffer = NULL;
+      status = iree_hal_allocator_allocate_buffer(
+          device->device_allocator, params, data_length,
+          iree_const_byte_span_empty(), &staging_buffer);
+      if (iree_status_is_ok(status)) {
+        status = iree_hal_webgpu_device_copy_buffer(
+            device, source_buffer, source_offset, staging_buffer, 0,
+            data_length);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_hal_buffer_map_read(staging_buffer, 0, target_ptr,
+                                          data_length);
+      }
+      iree_hal_buffer_release(staging_buffer);
+    }
+  } else {
+    // Device -> device.
+    status = iree_hal_webgpu_device_copy_buffer(
+        device, source.device_buffer, source_offset, target.device_buffer,
+        target_offset, data_length);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_device_wait_semaphores(
+    iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  if (wait_mode == IREE_HAL_WAIT_MODE_ALL || semaphore_list.count <= 1) {
+    // Waiting on each semaphore in turn is equivalent to waiting on all of
+    // them as the deadline is absolute.
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+          semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+          iree_make_deadline(deadline_ns)));
+    }
+    return iree_ok_status();
+  }
+
+  // Wait-any: poll the semaphores while processing WebGPU events, which is
+  // how all of them make progress.
+  bool checked_can_block = false;
+  while (true) {
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      uint64_t value = 0;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_query(semaphore_list.semaphores[i], &value));
+      if (value >= semaphore_list.payload_values[i]) return iree_ok_status();
+    }
+    if (iree_time_now() >= deadline_ns) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    if (!checked_can_block) {
+      IREE_RETURN_IF_ERROR(iree_hal_webgpu_platform_check_can_block());
+      checked_can_block = true;
+    }
+    iree_hal_webgpu_platform_process_events(device->handle);
+  }
+}
+
+static iree_status_t iree_hal_webgpu_device_profiling_begin(
+    iree_hal_device_t* base_device,
+    const iree_hal_device_profiling_options_t* options) {
+  // Unimplemented (and that's ok).
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_device_profiling_end(
+    iree_hal_device_t* base_device) {
+  // Unimplemented (and that's ok).
+  return iree_ok_status();
+}
+
+static const iree_hal_device_vtable_t iree_hal_webgpu_device_vtable = {
+    .destroy = iree_hal_webgpu_device_destroy,
+    .id = iree_hal_webgpu_device_id,
+    .host_allocator = iree_hal_webgpu_device_host_allocator,
+    .device_allocator = iree_hal_webgpu_device_allocator,
+    .replace_device_allocator = iree_hal_webgpu_replace_device_allocator,
+    .trim = iree_hal_webgpu_device_trim,
+    .query_i64 = iree_hal_webgpu_device_query_i64,
+    .create_channel = iree_hal_webgpu_device_create_channel,
+    .create_command_buffer = iree_hal_webgpu_device_create_command_buffer,
+    .create_descriptor_set_layout =
+        iree_hal_webgpu_device_create_descriptor_set_layout,
+    .create_event = iree_hal_webgpu_device_create_event,
+    .create_executable_cache = iree_hal_webgpu_device_create_executable_cache,
+    .create_pipeline_layout = iree_hal_webgpu_device_create_pipeline_layout,
+    .create_semaphore = iree_hal_webgpu_device_create_semaphore,
+    .query_semaphore_compatibility =
+        iree_hal_webgpu_device_query_semaphore_compatibility,
+    .transfer_range = iree_hal_webgpu_device_transfer_range,
+    .queue_alloca = iree_hal_webgpu_device_queue_alloca,
+    .queue_dealloca = iree_hal_webgpu_device_queue_dealloca,
+    .queue_execute = iree_hal_webgpu_device_queue_execute,
+    .queue_flush = iree_hal_webgpu_device_queue_flush,
+    .wait_semaphores = iree_hal_webgpu_device_wait_semaphores,
+    .profiling_begin = iree_hal_webgpu_device_profiling_begin,
+    .profiling_end = iree_hal_webgpu_device_profiling_end,
+};
@@ -0,0 +1,249 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <string.h>
+
+#include "experimental/webgpu/api.h"
+#include "experimental/webgpu/webgpu_device.h"
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+
+typedef struct iree_hal_webgpu_driver_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  // Identifier used for the driver in the IREE driver registry.
+  iree_string_view_t identifier;
+  iree_hal_webgpu_driver_options_t options;
+#if !defined(__EMSCRIPTEN__)
+  // Instance that adapters are requested from. On the web the device is
+  // requested from JavaScript instead.
+  WGPUInstance instance;
+#endif  // !__EMSCRIPTEN__
+} iree_hal_webgpu_driver_t;
+
+static const iree_hal_driver_vtable_t iree_hal_webgpu_driver_vtable;
+
+static iree_hal_webgpu_driver_t* iree_hal_webgpu_driver_cast(
+    iree_hal_driver_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_driver_vtable);
+  return (iree_hal_webgpu_driver_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_webgpu_driver_options_initialize(
+    iree_hal_webgpu_driver_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->power_preference = WGPUPowerPreference_HighPerformance;
+  iree_hal_webgpu_device_options_initialize(&out_options->device_options);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_webgpu_driver_create(
+    iree_string_view_t identifier,
+    const iree_hal_webgpu_driver_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_driver_t** out_driver) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_driver);
+  *out_driver = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_driver_t* driver = NULL;
+  iree_host_size_t total_size = sizeof(*driver) + identifier.size;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&driver));
+  iree_hal_resource_initialize(&iree_hal_webgpu_driver_vtable,
+                               &driver->resource);
+  driver->host_allocator = host_allocator;
+  iree_string_view_append_to_buffer(
+      identifier, &driver->identifier,
+      (char*)driver + total_size - identifier.size);
+  driver->options = *options;
+
+  iree_status_t status = iree_ok_status();
+#if !defined(__EMSCRIPTEN__)
+  const WGPUInstanceDescriptor instance_descriptor = {0};
+  driver->instance = wgpuCreateInstance(&instance_descriptor);
+  if (!driver->instance) {
+    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "failed to create a WebGPU instance");
+  }
+#endif  // !__EMSCRIPTEN__
+
+  if (iree_status_is_ok(status)) {
+    *out_driver = (iree_hal_driver_t*)driver;
+  } else {
+    iree_hal_driver_release((iree_hal_driver_t*)driver);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_driver_destroy(iree_hal_driver_t* base_driver) {
+  iree_hal_webgpu_driver_t* driver = iree_hal_webgpu_driver_cast(base_driver);
+  iree_allocator_t host_allocator = driver->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+#if !defined(__EMSCRIPTEN__)
+  if (driver->instance) wgpuInstanceRelease(driver->instance);
+#endif  // !__EMSCRIPTEN__
+  iree_allocator_free(host_allocator, driver);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_webgpu_driver_query_available_devices(
+    iree_hal_driver_t* base_driver, iree_allocator_t host_allocator,
+    iree_host_size_t* out_device_info_count,
+    iree_hal_device_info_t** out_device_infos) {
+  // WebGPU exposes a single adapter chosen by the implementation (or the page
+  // on the web), so only the default device is listed.
+  iree_hal_device_info_t* device_infos = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*device_infos), (void**)&device_infos));
+  memset(device_infos, 0, sizeof(*device_infos));
+  device_infos[0].device_id = IREE_HAL_DEVICE_ID_DEFAULT;
+  device_infos[0].name = iree_make_cstring_view("default");
+  *out_device_info_count = 1;
+  *out_device_infos = device_infos;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_webgpu_driver_dump_device_info(
+    iree_hal_driver_t* base_driver, iree_hal_device_id_t device_id,
+    iree_string_builder_t* builder) {
+  // TODO: dump the adapter properties.
+  return iree_ok_status();
+}
+
+#if defined(__EMSCRIPTEN__)
+
+static iree_status_t iree_hal_webgpu_driver_acquire_device(
+    iree_hal_webgpu_driver_t* driver, WGPUDevice* out_handle) {
+  // The device must have been requested from JavaScript and stored in
+  // Module.preinitializedWebGPUDevice before the program started.
+  *out_handle = emscripten_webgpu_get_device();
+  if (!*out_handle) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "no WebGPU device; set "
+                            "Module.preinitializedWebGPUDevice before "
+                            "creating the driver");
+  }
+  return iree_ok_status();
+}
+
+#else
+
+typedef struct iree_hal_webgpu_request_t {
+  bool done;
+  iree_status_t status;
+  WGPUAdapter adapter;
+  WGPUDevice device;
+} iree_hal_webgpu_request_t;
+
+static void iree_hal_webgpu_request_adapter_callback(
+    WGPURequestAdapterStatus status, WGPUAdapter adapter, const char* message,
+    void* user_data) {
+  iree_hal_webgpu_request_t* request = (iree_hal_webgpu_request_t*)user_data;
+  if (status == WGPURequestAdapterStatus_Success) {
+    request->adapter = adapter;
+  } else {
+    request->status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                       "WebGPU adapter request failed: %s",
+                                       message ? message : "");
+  }
+  request->done = true;
+}
+
+static void iree_hal_webgpu_request_device_callback(
+    WGPURequestDeviceStatus status, WGPUDevice device, const char* message,
+    void* user_data) {
+  iree_hal_webgpu_request_t* request = (iree_hal_webgpu_request_t*)user_data;
+  if (status == WGPURequestDeviceStatus_Success) {
+    request->device = device;
+  } else {
+    request->status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                       "WebGPU device request failed: %s",
+                                       message ? message : "");
+  }
+  request->done = true;
+}
+
+static iree_status_t iree_hal_webgpu_driver_acquire_device(
+    iree_hal_webgpu_driver_t* driver, WGPUDevice* out_handle) {
+  iree_hal_webgpu_request_t request = {0};
+  const WGPURequestAdapterOptions adapter_options = {
+      .powerPreference = driver->options.power_preference,
+  };
+  wgpuInstanceRequestAdapter(driver->instance, &adapter_options,
+                             iree_hal_webgpu_request_adapter_callback,
+                             &request);
+  while (!request.done) wgpuInstanceProcessEvents(driver->instance);
+  IREE_RETURN_IF_ERROR(request.status);
+
+  request.done = false;
+  const WGPUDeviceDescriptor device_descriptor = {
+      .label = "iree",
+  };
+  wgpuAdapterRequestDevice(request.adapter, &device_descriptor,
+                           iree_hal_webgpu_request_device_callback, &request);
+  while (!request.done) wgpuInstanceProcessEvents(driver->instance);
+  wgpuAdapterRelease(request.adapter);
+  IREE_RETURN_IF_ERROR(request.status);
+
+  *out_handle = request.device;
+  return iree_ok_status();
+}
+
+#endif  // __EMSCRIPTEN__
+
+static iree_status_t iree_hal_webgpu_driver_create_device_by_id(
+    iree_hal_driver_t* base_driver, iree_hal_device_id_t device_id,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  iree_hal_webgpu_driver_t* driver = iree_hal_webgpu_driver_cast(base_driver);
+  if (device_id != IREE_HAL_DEVICE_ID_DEFAULT) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "WebGPU only provides the default device");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  WGPUDevice handle = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_webgpu_driver_acquire_device(driver, &handle));
+
+  // The device references the handle itself.
+  iree_status_t status = iree_hal_webgpu_device_create(
+      base_driver, iree_make_cstring_view("webgpu"),
+      &driver->options.device_options, handle, host_allocator, out_device);
+  wgpuDeviceRelease(handle);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_driver_create_device_by_path(
+    iree_hal_driver_t* base_driver, iree_string_view_t driver_name,
+    iree_string_view_t device_path, iree_host_size_t param_count,
+    const iree_string_pair_t* params, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device) {
+  if (!iree_string_view_is_empty(device_path)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "device paths not yet implemented");
+  }
+  return iree_hal_webgpu_driver_create_device_by_id(
+      base_driver, IREE_HAL_DEVICE_ID_DEFAULT, param_count, params,
+      host_allocator, out_device);
+}
+
+static const iree_hal_driver_vtable_t iree_hal_webgpu_driver_vtable = {
+    .destroy = iree_hal_webgpu_driver_destroy,
+    .query_available_devices = iree_hal_webgpu_driver_query_available_devices,
+    .dump_device_info = iree_hal_webgpu_driver_dump_device_info,
+    .create_device_by_id = iree_hal_webgpu_driver_create_device_by_id,
+    .create_device_by_path = iree_hal_webgpu_driver_create_device_by_path,
+};
@@ -0,0 +1,18 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_WEBGPU_HEADERS_H_
+#define IREE_HAL_WEBGPU_WEBGPU_HEADERS_H_
+
+// The WebGPU C API is implemented by emscripten (-sUSE_WEBGPU=1) when
+// targeting the web and by Dawn when building natively.
+#include <webgpu/webgpu.h>  // IWYU pragma: export
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/html5_webgpu.h>  // IWYU pragma: export
+#endif  // __EMSCRIPTEN__
+
+#endif  // IREE_HAL_WEBGPU_WEBGPU_HEADERS_H_
@@ -0,0 +1,234 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/webgpu_semaphore.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "experimental/webgpu/platform.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/semaphore_base.h"
+
+// Sentinel used when the semaphore has failed and an error status is set.
+#define IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE UINT64_MAX
+
+typedef struct iree_hal_webgpu_semaphore_t {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+
+  // Device whose events are processed while waiting and whose queue
+  // submissions are ordered with respect to the semaphore. Referenced.
+  WGPUDevice device;
+
+  iree_slim_mutex_t mutex;
+
+  // Current signaled value. May be IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE to
+  // indicate that the semaphore has failed and |failure_status| has the error.
+  uint64_t current_value IREE_GUARDED_BY(mutex);
+
+  // Largest value that submitted queue work will signal upon completion.
+  uint64_t enqueued_value IREE_GUARDED_BY(mutex);
+
+  // OK or the status passed to iree_hal_semaphore_fail. Owned by the semaphore.
+  iree_status_t failure_status IREE_GUARDED_BY(mutex);
+} iree_hal_webgpu_semaphore_t;
+
+static const iree_hal_semaphore_vtable_t iree_hal_webgpu_semaphore_vtable;
+
+static iree_hal_webgpu_semaphore_t* iree_hal_webgpu_semaphore_cast(
+    iree_hal_semaphore_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_semaphore_vtable);
+  return (iree_hal_webgpu_semaphore_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_semaphore_create(
+    WGPUDevice device, uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_semaphore);
+  *out_semaphore = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*semaphore), (void**)&semaphore);
+  if (iree_status_is_ok(status)) {
+    iree_hal_semaphore_initialize(&iree_hal_webgpu_semaphore_vtable,
+                                  &semaphore->base);
+    semaphore->host_allocator = host_allocator;
+    semaphore->device = device;
+    wgpuDeviceReference(device);
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->current_value = initial_value;
+    semaphore->enqueued_value = initial_value;
+    semaphore->failure_status = iree_ok_status();
+    *out_semaphore = &semaphore->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_semaphore_destroy(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_ignore(semaphore->failure_status);
+  iree_slim_mutex_deinitialize(&semaphore->mutex);
+  wgpuDeviceRelease(semaphore->device);
+
+  iree_hal_semaphore_deinitialize(&semaphore->base);
+  iree_allocator_free(host_allocator, semaphore);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_webgpu_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(semaphore, &iree_hal_webgpu_semaphore_vtable);
+}
+
+void iree_hal_webgpu_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (value > semaphore->enqueued_value) semaphore->enqueued_value = value;
+  iree_slim_mutex_unlock(&semaphore->mutex);
+}
+
+bool iree_hal_webgpu_semaphore_is_ordered_before(
+    iree_hal_semaphore_t* base_semaphore, WGPUDevice device, uint64_t value) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_slim_mutex_lock(&semaphore->mutex);
+  bool is_ordered = false;
+  if (semaphore->current_value == IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE) {
+    // Let the host wait observe the failure.
+    is_ordered = false;
+  } else if (semaphore->current_value >= value) {
+    is_ordered = true;
+  } else {
+    is_ordered =
+        semaphore->device == device && semaphore->enqueued_value >= value;
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return is_ordered;
+}
+
+static iree_status_t iree_hal_webgpu_semaphore_query(
+    iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_slim_mutex_lock(&semaphore->mutex);
+  *out_value = semaphore->current_value;
+  iree_status_t status = iree_ok_status();
+  if (*out_value >= IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE) {
+    status = iree_status_clone(semaphore->failure_status);
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return status;
+}
+
+static iree_status_t iree_hal_webgpu_semaphore_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (new_value <= semaphore->current_value) {
+    uint64_t current_value IREE_ATTRIBUTE_UNUSED = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; current_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            current_value, new_value);
+  }
+  semaphore->current_value = new_value;
+  if (new_value > semaphore->enqueued_value) {
+    semaphore->enqueued_value = new_value;
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Notify timepoints of the new value.
+  iree_hal_semaphore_notify(&semaphore->base, new_value, IREE_STATUS_OK);
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
+                                           iree_status_t status) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  const iree_status_code_t status_code = iree_status_code(status);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  // Only the first failure is preserved.
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    IREE_IGNORE_ERROR(status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return;
+  }
+
+  semaphore->current_value = IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE;
+  semaphore->failure_status = status;
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Notify timepoints of the failure.
+  iree_hal_semaphore_notify(&semaphore->base,
+                            IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE,
+                            status_code);
+}
+
+static iree_status_t iree_hal_webgpu_semaphore_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  // Signals are made from WebGPU callbacks so waiting requires processing
+  // events until the value is reached.
+  bool can_block = false;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&semaphore->mutex);
+    uint64_t current_value = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    if (current_value == IREE_HAL_WEBGPU_SEMAPHORE_FAILURE_VALUE) {
+      status = iree_status_from_code(IREE_STATUS_ABORTED);
+      break;
+    } else if (current_value >= value) {
+      break;
+    } else if (iree_time_now() >= deadline_ns) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    if (!can_block) {
+      status = iree_hal_webgpu_platform_check_can_block();
+      if (!iree_status_is_ok(status)) break;
+      can_block = true;
+    }
+    iree_hal_webgpu_platform_process_events(semaphore->device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static const iree_hal_semaphore_vtable_t iree_hal_webgpu_semaphore_vtable = {
+    .destroy = iree_hal_webgpu_semaphore_destroy,
+    .query = iree_hal_webgpu_semaphore_query,
+    .signal = iree_hal_webgpu_semaphore_signal,
+    .fail = iree_hal_webgpu_semaphore_fail,
+    .wait = iree_hal_webgpu_semaphore_wait,
+};
@@ -0,0 +1,51 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_WEBGPU_WEBGPU_SEMAPHORE_H_
+#define IREE_HAL_WEBGPU_WEBGPU_SEMAPHORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "experimental/webgpu/webgpu_headers.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// WebGPU has no semaphores or fences: the only completion signal is the
+// wgpuQueueOnSubmittedWorkDone callback. Semaphores are emulated with a host
+// timeline that submissions signal from that callback. Waits made by later
+// submissions to the same device are satisfied by queue order once the signal
+// has been submitted and need no host synchronization; all other waits pump
+// WebGPU events on the host until the value is reached.
+
+// Creates a timeline semaphore for use with |device|.
+iree_status_t iree_hal_webgpu_semaphore_create(
+    WGPUDevice device, uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore);
+
+// Returns true if |semaphore| is a WebGPU semaphore.
+bool iree_hal_webgpu_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Records that work submitted to the queue of the semaphore's device will
+// signal |semaphore| to |value| when it completes.
+void iree_hal_webgpu_semaphore_enqueue_signal(iree_hal_semaphore_t* semaphore,
+                                              uint64_t value);
+
+// Returns true if |semaphore| has reached |value| or will reach it when work
+// already submitted to the queue of |device| completes. Work submitted to that
+// queue afterwards is then ordered after the signal.
+bool iree_hal_webgpu_semaphore_is_ordered_before(
+    iree_hal_semaphore_t* semaphore, WGPUDevice device, uint64_t value);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_WEBGPU_WEBGPU_SEMAPHORE_H_
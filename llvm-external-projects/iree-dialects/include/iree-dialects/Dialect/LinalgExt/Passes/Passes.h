@@ -171,6 +171,8 @@ createTileAndDecomposeWinogradTransformPass();
 // linalg_ext.winograd.* ops and linalg.batch_matmul ops using the winograd
 // tranformation.
 std::unique_ptr<Pass> createConvertConv2DToWinogradPass();
+std::unique_ptr<Pass> createConvertConv2DToWinogradPass(int64_t outputTileSize,
+                                                        bool checkCost);
 
 // Creates a pass to convert the softmax op into a sequence of
 // linalg generic ops.
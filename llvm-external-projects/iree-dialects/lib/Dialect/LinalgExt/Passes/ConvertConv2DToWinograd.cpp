@@ -43,9 +43,23 @@ static bool hasAllOneValues(DenseIntElementsAttr attr) {
   return llvm::all_of(attr, [](APInt element) { return element.isOne(); });
 }
 
-// TODO: Make this a user-settable parameter once we have support
-// for more tile sizes
-static constexpr int64_t outputTileSize = 6;
+/// Minimum estimated reduction in arithmetic for the Winograd form of a
+/// convolution to be used when the cost check is enabled. The transforms are
+/// memory bound, so require a clear win on compute to offset them.
+static constexpr double kMinWinogradSpeedup = 1.5;
+
+/// Returns the filter transform matrix G for the given output tile size or
+/// nullptr if the tile size is not supported.
+static const float *getFilterTransformMatrix(int64_t outputTileSize) {
+  switch (outputTileSize) {
+  case 4:
+    return IREE::LinalgExt::Winograd::G_4x4_3x3;
+  case 6:
+    return IREE::LinalgExt::Winograd::G_6x6_3x3;
+  default:
+    return nullptr;
+  }
+}
 
 /// This function computes the Winograd filter transform when
 /// the filter is known to be a constant. Specifically, this
@@ -128,12 +142,44 @@ static bool isValidConv2d(Operation *op, bool &isNchw) {
                  : hasValidStridesAndDilations<linalg::Conv2DNhwcHwcfOp>(op));
 }
 
+/// Returns true if the Winograd form of a static 3x3 convolution is
+/// estimated to need sufficiently fewer multiply-adds than the direct form.
+/// The estimate counts the batch matmul plus the two dense i x i matrix
+/// products applied per tile by the input and output transforms; the filter
+/// transform is folded at compile time and is free.
+static bool isWinogradProfitable(ShapedType inputType, ShapedType outputType,
+                                 bool isNchw, int64_t outputTileSize) {
+  SmallVector<int64_t> inputShape(inputType.getShape());
+  SmallVector<int64_t> outputShape(outputType.getShape());
+  if (isNchw) {
+    permute<IREE::LinalgExt::Permutation::NCHW_TO_NHWC>(outputShape);
+    permute<IREE::LinalgExt::Permutation::NCHW_TO_NHWC>(inputShape);
+  }
+  const double kernelSize = 3;
+  const double r = outputTileSize;
+  const double i = r + kernelSize - 1;
+  const double n = outputShape[0], oh = outputShape[1], ow = outputShape[2];
+  const double f = outputShape[3], c = inputShape[3];
+  const double numTiles = n * std::ceil(oh / r) * std::ceil(ow / r);
+
+  const double directCost = n * oh * ow * f * c * kernelSize * kernelSize;
+  const double batchMatmulCost = i * i * numTiles * c * f;
+  const double inputTransformCost = numTiles * c * 2 * i * i * i;
+  const double outputTransformCost = numTiles * f * (r * i * i + r * r * i);
+  const double winogradCost =
+      batchMatmulCost + inputTransformCost + outputTransformCost;
+  return directCost >= kMinWinogradSpeedup * winogradCost;
+}
+
 namespace {
 
 template <typename ConvOp>
 class FoldWinogradFilterTransform final : public OpRewritePattern<ConvOp> {
 public:
-  using OpRewritePattern<ConvOp>::OpRewritePattern;
+  FoldWinogradFilterTransform(MLIRContext *context, int64_t outputTileSize,
+                              bool checkCost)
+      : OpRewritePattern<ConvOp>(context), outputTileSize(outputTileSize),
+        checkCost(checkCost) {}
 
   LogicalResult matchAndRewrite(ConvOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -142,6 +188,19 @@ public:
     if (!isValidConv2d(convOp, isNchw))
       return failure();
 
+    const float *G = getFilterTransformMatrix(outputTileSize);
+    if (!G)
+      return failure();
+
+    // Folding the filter commits to the Winograd form; the conversion below
+    // needs static image shapes, so check for them before rewriting anything.
+    Value input = convOp.getInputs()[0];
+    Value output = convOp.getOutputs()[0];
+    auto inputType = input.getType().cast<ShapedType>();
+    auto outputType = output.getType().cast<ShapedType>();
+    if (!inputType.hasStaticShape() || !outputType.hasStaticShape())
+      return failure();
+
     // Check that kernel size = 3x3
     Value kernel = convOp.getInputs()[1];
     auto kernelType = kernel.getType().cast<ShapedType>();
@@ -162,6 +221,10 @@ public:
       return failure();
     }
 
+    if (checkCost &&
+        !isWinogradProfitable(inputType, outputType, isNchw, outputTileSize))
+      return failure();
+
     Operation *constOp = kernel.getDefiningOp();
     ShapedType type = constOp->getResult(0).getType().cast<ShapedType>();
     auto elemType = type.getElementType().cast<FloatType>();
@@ -181,12 +244,16 @@ public:
     }
     auto resultType = RankedTensorType::get(resultShape, elemType);
     auto foldedKernelAttr =
-        foldFilterTransform(shape, inputTileSize, kernelSize, resultType,
-                            IREE::LinalgExt::Winograd::G_6x6_3x3, isSplat,
-                            splatValue, nonSplatValues, elemType, isNchw);
+        foldFilterTransform(shape, inputTileSize, kernelSize, resultType, G,
+                            isSplat, splatValue, nonSplatValues, elemType,
+                            isNchw);
     rewriter.replaceOpWithNewOp<arith::ConstantOp>(constOp, foldedKernelAttr);
     return success();
   }
+
+private:
+  int64_t outputTileSize;
+  bool checkCost;
 };
 
 } // namespace
@@ -282,7 +349,8 @@ namespace {
 template <typename ConvOp>
 class ConvertConvToWinograd final : public OpRewritePattern<ConvOp> {
 public:
-  using OpRewritePattern<ConvOp>::OpRewritePattern;
+  ConvertConvToWinograd(MLIRContext *context, int64_t outputTileSize)
+      : OpRewritePattern<ConvOp>(context), outputTileSize(outputTileSize) {}
 
   LogicalResult matchAndRewrite(ConvOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -416,21 +484,39 @@ public:
     result.replaceAllUsesWith(winogradOutput);
     return success();
   }
+
+private:
+  int64_t outputTileSize;
 };
 
 struct ConvertConv2DToWinogradPass
     : ConvertConv2DToWinogradBase<ConvertConv2DToWinogradPass> {
+  ConvertConv2DToWinogradPass() = default;
+  ConvertConv2DToWinogradPass(int64_t outputTileSize, bool checkCost) {
+    this->outputTileSize = outputTileSize;
+    this->checkCost = checkCost;
+  }
+  ConvertConv2DToWinogradPass(const ConvertConv2DToWinogradPass &pass)
+      : ConvertConv2DToWinogradPass(pass.outputTileSize, pass.checkCost) {}
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry
         .insert<linalg::LinalgDialect, IREE::LinalgExt::IREELinalgExtDialect>();
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
+    if (!getFilterTransformMatrix(outputTileSize)) {
+      getOperation()->emitError("unsupported Winograd output tile size ")
+          << outputTileSize;
+      return signalPassFailure();
+    }
     RewritePatternSet patterns(&getContext());
     patterns.insert<FoldWinogradFilterTransform<linalg::Conv2DNchwFchwOp>,
-                    FoldWinogradFilterTransform<linalg::Conv2DNhwcHwcfOp>,
-                    ConvertConvToWinograd<linalg::Conv2DNhwcHwcfOp>,
-                    ConvertConvToWinograd<linalg::Conv2DNchwFchwOp>>(context);
+                    FoldWinogradFilterTransform<linalg::Conv2DNhwcHwcfOp>>(
+        context, outputTileSize, checkCost);
+    patterns.insert<ConvertConvToWinograd<linalg::Conv2DNhwcHwcfOp>,
+                    ConvertConvToWinograd<linalg::Conv2DNchwFchwOp>>(
+        context, outputTileSize);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
       return signalPassFailure();
@@ -444,6 +530,12 @@ std::unique_ptr<Pass> createConvertConv2DToWinogradPass() {
   return std::make_unique<ConvertConv2DToWinogradPass>();
 }
 
+std::unique_ptr<Pass> createConvertConv2DToWinogradPass(int64_t outputTileSize,
+                                                        bool checkCost) {
+  return std::make_unique<ConvertConv2DToWinogradPass>(outputTileSize,
+                                                       checkCost);
+}
+
 } // namespace LinalgExt
 } // namespace IREE
 } // namespace iree_compiler
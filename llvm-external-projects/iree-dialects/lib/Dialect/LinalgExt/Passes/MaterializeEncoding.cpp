@@ -9,6 +9,7 @@
 #include "iree-dialects/Dialect/LinalgExt/Passes/Passes.h"
 #include "iree-dialects/Dialect/LinalgExt/Utils/Utils.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/MemRef/Transforms/Passes.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -91,6 +92,22 @@ chooseEncodingInfo(RankedTensorType tensorType) {
   case TensorEncoding::MATMUL_I8I8I32_RESULT:
     return MaterializeEncodingInfo{{0, 1}, {8, 8}, {}};
     break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
+    return MaterializeEncodingInfo{{1, 2}, {8, 4}, {}};
+    break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
+    return MaterializeEncodingInfo{{1, 2}, {4, 8}, {}};
+    break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS_TRANSPOSE:
+    return MaterializeEncodingInfo{{2, 1}, {8, 4}, {0, 2, 1}};
+    break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
+    return MaterializeEncodingInfo{{1, 2}, {8, 8}, {}};
+    break;
   default:
     return failure();
   }
@@ -234,6 +251,121 @@ lowerOpWithEncoding(RewriterBase &rewriter, linalg::MatmulOp matmulOp,
   return mmt4DOp;
 }
 
+/// Utility method to convert from `linalg.batch_matmul` with
+/// - lhs encoding of BATCH_MATMUL_*_LHS
+/// - rhs encoding of BATCH_MATMUL_*_RHS_TRANSPOSE
+/// - result encoding of BATCH_MATMUL_*_RESULT
+/// to a `linalg.generic` computing an mmt4d for each batch. The batch
+/// dimension stays outermost in all the materialized operands.
+static FailureOr<Operation *>
+lowerOpWithEncoding(RewriterBase &rewriter, linalg::BatchMatmulOp batchMatmulOp,
+                    ValueRange convertedInputOperands,
+                    ValueRange convertedOutputOperands, MaterializeEncodingFn,
+                    MaterializeEncodingValueFn) {
+  if (!batchMatmulOp.hasTensorSemantics())
+    return failure();
+  auto inputs = batchMatmulOp.getDpsInputOperands();
+  auto outputs = batchMatmulOp.getDpsInitOperands();
+  Optional<TensorEncoding> lhsEncoding =
+      getEncoding(inputs[0]->get().getType().cast<RankedTensorType>());
+  Optional<TensorEncoding> rhsEncoding =
+      getEncoding(inputs[1]->get().getType().cast<RankedTensorType>());
+  Optional<TensorEncoding> resultEncoding =
+      getEncoding(outputs[0]->get().getType().cast<RankedTensorType>());
+  if (!lhsEncoding ||
+      (lhsEncoding.value() != TensorEncoding::BATCH_MATMUL_F32F32F32_LHS &&
+       lhsEncoding.value() != TensorEncoding::BATCH_MATMUL_I8I8I32_LHS) ||
+      !rhsEncoding ||
+      (rhsEncoding.value() !=
+           TensorEncoding::BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE &&
+       rhsEncoding.value() !=
+           TensorEncoding::BATCH_MATMUL_I8I8I32_RHS_TRANSPOSE) ||
+      !resultEncoding ||
+      (resultEncoding.value() !=
+           TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT &&
+       resultEncoding.value() != TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT)) {
+    return failure();
+  }
+
+  // Loops are (b, m1, n1, k1, m0, n0, k0) where the `0` dimensions are the
+  // inner tiles of the materialized operands.
+  MLIRContext *context = rewriter.getContext();
+  AffineExpr b, m1, n1, k1, m0, n0, k0;
+  bindDims(context, b, m1, n1, k1, m0, n0, k0);
+  SmallVector<AffineMap> indexingMaps = {
+      AffineMap::get(7, 0, {b, m1, k1, m0, k0}, context),
+      AffineMap::get(7, 0, {b, n1, k1, n0, k0}, context),
+      AffineMap::get(7, 0, {b, m1, n1, m0, n0}, context)};
+  utils::IteratorType parallel = utils::IteratorType::parallel;
+  utils::IteratorType reduction = utils::IteratorType::reduction;
+  SmallVector<utils::IteratorType> iteratorTypes = {
+      parallel, parallel, parallel, reduction, parallel, parallel, reduction};
+  Type accType = getElementTypeOrSelf(convertedOutputOperands[0].getType());
+  Operation *batchMmt4DOp = rewriter.create<linalg::GenericOp>(
+      batchMatmulOp.getLoc(), convertedOutputOperands[0].getType(),
+      convertedInputOperands, convertedOutputOperands, indexingMaps,
+      iteratorTypes,
+      [&](OpBuilder &builder, Location loc, ValueRange args) {
+        Value lhs = args[0];
+        Value rhs = args[1];
+        Value result;
+        if (accType.isa<FloatType>()) {
+          Value mul = builder.create<arith::MulFOp>(loc, lhs, rhs);
+          result = builder.create<arith::AddFOp>(loc, mul, args[2]);
+        } else {
+          lhs = builder.create<arith::ExtSIOp>(loc, accType, lhs);
+          rhs = builder.create<arith::ExtSIOp>(loc, accType, rhs);
+          Value mul = builder.create<arith::MulIOp>(loc, lhs, rhs);
+          result = builder.create<arith::AddIOp>(loc, mul, args[2]);
+        }
+        builder.create<linalg::YieldOp>(loc, result);
+      });
+  return batchMmt4DOp;
+}
+
+/// Utility method to convert an elementwise `linalg.generic` whose operands
+/// all have the same encoding to a `linalg.generic` on the materialized
+/// type. As all operands are materialized into the same layout the op stays
+/// elementwise with identity indexing maps over the materialized rank.
+static FailureOr<Operation *>
+lowerOpWithEncoding(RewriterBase &rewriter, linalg::GenericOp genericOp,
+                    ValueRange convertedInputOperands,
+                    ValueRange convertedOutputOperands, MaterializeEncodingFn,
+                    MaterializeEncodingValueFn) {
+  if (!genericOp.hasTensorSemantics() || genericOp.hasIndexSemantics() ||
+      genericOp.getNumLoops() != genericOp.getNumParallelLoops() ||
+      !llvm::all_of(genericOp.getIndexingMapsArray(),
+                    [](AffineMap map) { return map.isIdentity(); })) {
+    return failure();
+  }
+  Optional<TensorEncoding> encoding;
+  for (OpOperand &operand : genericOp->getOpOperands()) {
+    auto tensorType = operand.get().getType().dyn_cast<RankedTensorType>();
+    if (!tensorType)
+      return failure();
+    Optional<TensorEncoding> operandEncoding = getEncoding(tensorType);
+    if (!operandEncoding || (encoding && *encoding != *operandEncoding))
+      return failure();
+    encoding = operandEncoding;
+  }
+
+  auto convertedType =
+      convertedOutputOperands[0].getType().cast<RankedTensorType>();
+  int64_t rank = convertedType.getRank();
+  SmallVector<AffineMap> indexingMaps(genericOp->getNumOperands(),
+                                      rewriter.getMultiDimIdentityMap(rank));
+  SmallVector<utils::IteratorType> iteratorTypes(rank,
+                                                 utils::IteratorType::parallel);
+  SmallVector<Type> resultTypes = llvm::to_vector(llvm::map_range(
+      convertedOutputOperands, [](Value v) { return v.getType(); }));
+  auto materializedOp = rewriter.create<linalg::GenericOp>(
+      genericOp.getLoc(), resultTypes, convertedInputOperands,
+      convertedOutputOperands, indexingMaps, iteratorTypes);
+  rewriter.inlineRegionBefore(genericOp.getRegion(), materializedOp.getRegion(),
+                              materializedOp.getRegion().begin());
+  return materializedOp.getOperation();
+}
+
 /// Utility method to convert from `linalg.fill` on `tensor` type with encoding
 /// to fill of the materialized type
 static FailureOr<Operation *>
@@ -463,6 +595,8 @@ void populateMaterializeEncodingPatterns(
   // Add all patterns for converting from encoded type to the materialized type
   patterns.insert<MaterializeDPSOperation<linalg::FillOp>,
                   MaterializeDPSOperation<linalg::MatmulOp>,
+                  MaterializeDPSOperation<linalg::BatchMatmulOp>,
+                  MaterializeDPSOperation<linalg::GenericOp>,
                   MaterializeOperation<tensor::EmptyOp>,
                   SetEncodingOpToPackOpConversion,
                   UnsetEncodingOpToPackOpConversion>(
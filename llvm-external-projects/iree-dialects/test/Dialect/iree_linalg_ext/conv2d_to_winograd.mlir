@@ -1,4 +1,5 @@
 // RUN: iree-dialects-opt --split-input-file -iree-linalg-ext-convert-conv2d-to-winograd -mlir-elide-elementsattrs-if-larger=4 %s | FileCheck %s
+// RUN: iree-dialects-opt --split-input-file -iree-linalg-ext-convert-conv2d-to-winograd='output-tile-size=4 check-cost=true' -mlir-elide-elementsattrs-if-larger=4 %s | FileCheck %s --check-prefix=COST
 
 func.func @conv_16433136(%arg0: tensor<1x16x16x4xf32>, %arg2: tensor<1x14x14x16xf32>) -> tensor<1x14x14x16xf32> {
   %c0 = arith.constant dense<0.1> : tensor<3x3x4x16xf32>
@@ -36,6 +37,11 @@ func.func @conv_16433136(%arg0: tensor<1x16x16x4xf32>, %arg2: tensor<1x14x14x16x
 // CHECK:        return %[[EXTRACTED_SLICE]] : tensor<1x14x14x16xf32>
 // CHECK:      }
 
+// Too few channels for the transforms to pay off.
+// COST-LABEL: func.func @conv_16433136
+//       COST:   linalg.conv_2d_nhwc_hwcf
+//   COST-NOT:   iree_linalg_ext.winograd
+
 // -----
 
 func.func @conv2d_non_splat_weights(%inputs : tensor<1x4x4x1xf32>, %arg2: tensor<1x2x2x1xf32>) -> tensor<1x2x2x1xf32> {
@@ -144,3 +150,23 @@ func.func @conv2d_nchw_non_splat_weights(%inputs : tensor<1x1x4x4xf32>, %arg2: t
 // CHECK-SAME:     tensor<1x1x6x6xf32> to tensor<1x1x2x2xf32>
 // CHECK:        return %[[EXTRACTED_SLICE]] : tensor<1x1x2x2xf32>
 // CHECK:      }
+
+// -----
+
+func.func @conv_1x56x56x64(%arg0: tensor<1x58x58x64xf32>, %arg1: tensor<1x56x56x64xf32>) -> tensor<1x56x56x64xf32> {
+  %c0 = arith.constant dense<0.1> : tensor<3x3x64x64xf32>
+  %0 = linalg.conv_2d_nhwc_hwcf
+    {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64> }
+     ins(%arg0, %c0: tensor<1x58x58x64xf32>, tensor<3x3x64x64xf32>)
+    outs(%arg1: tensor<1x56x56x64xf32>) -> tensor<1x56x56x64xf32>
+  return %0 : tensor<1x56x56x64xf32>
+}
+// COST-LABEL: func.func @conv_1x56x56x64
+//       COST:   %[[CST:.+]] = arith.constant dense_resource<__elided__> : tensor<36x64x64xf32>
+//       COST:   %[[D1:.+]] = iree_linalg_ext.winograd.input_transform output_tile_size(4) kernel_size(3)
+//  COST-SAME:     -> tensor<6x6x1x14x14x64xf32>
+//       COST:   %[[COLLAPSED:.+]] = tensor.collapse_shape %[[D1]]
+//       COST:   linalg.batch_matmul ins(%[[COLLAPSED]], %[[CST]] : tensor<36x196x64xf32>, tensor<36x64x64xf32>)
+//       COST:   iree_linalg_ext.winograd.output_transform output_tile_size(4) kernel_size(3)
+//  COST-SAME:     -> tensor<1x56x56x64xf32>
+//   COST-NOT:   linalg.conv_2d_nhwc_hwcf
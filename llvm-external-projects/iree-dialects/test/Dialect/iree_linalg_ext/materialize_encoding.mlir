@@ -175,3 +175,69 @@ func.func @pack_gemm_fill_dynamic(%arg0 : tensor<?x?xf32>, %arg1 : tensor<?x?xf3
 // CHECK-SAME:       outs(%[[FILL]] :
 //      CHECK:   %[[UNPACK:.+]] = iree_linalg_ext.unpack %[[MMT4D]]
 //      CHECK:   return %[[UNPACK]]
+
+// -----
+
+func.func @pack_batch_gemm(%arg0 : tensor<4x128x256xf32>, %arg1 : tensor<4x256x512xf32>, %arg2 : tensor<4x128x512xf32>) -> tensor<4x128x512xf32> {
+  %0 = iree_linalg_ext.set_encoding %arg0 : tensor<4x128x256xf32> -> tensor<4x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>
+  %1 = iree_linalg_ext.set_encoding %arg1 : tensor<4x256x512xf32> -> tensor<4x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>
+  %2 = iree_linalg_ext.set_encoding %arg2 : tensor<4x128x512xf32> -> tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  %3 = linalg.batch_matmul ins(%0, %1 : tensor<4x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>, tensor<4x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS_TRANSPOSE>>)
+      outs(%2 : tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>) -> tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  %4 = iree_linalg_ext.unset_encoding %3 : tensor<4x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>> -> tensor<4x128x512xf32>
+  return %4 : tensor<4x128x512xf32>
+}
+//  CHECK-DAG: #[[LHS_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d3, d4, d6)>
+//  CHECK-DAG: #[[RHS_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d2, d3, d5, d6)>
+//  CHECK-DAG: #[[RESULT_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d2, d4, d5)>
+//      CHECK: func @pack_batch_gemm(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<4x128x256xf32>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<4x256x512xf32>
+// CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<4x128x512xf32>
+//      CHECK:   %[[INIT_LHS:.+]] = tensor.empty() : tensor<4x16x64x8x4xf32>
+//      CHECK:   %[[PACK_LHS:.+]] = iree_linalg_ext.pack
+// CHECK-SAME:     %[[ARG0]] inner_dims_pos = [1, 2] inner_tiles = [8, 4] into %[[INIT_LHS]]
+//      CHECK:   %[[INIT_RHS:.+]] = tensor.empty() : tensor<4x64x64x8x4xf32>
+//      CHECK:   %[[PACK_RHS:.+]] = iree_linalg_ext.pack
+// CHECK-SAME:     %[[ARG1]] outer_dims_perm = [0, 2, 1] inner_dims_pos = [2, 1] inner_tiles = [8, 4] into %[[INIT_RHS]]
+//      CHECK:   %[[INIT_RESULT:.+]] = tensor.empty() : tensor<4x16x64x8x8xf32>
+//      CHECK:   %[[PACK_RESULT:.+]] = iree_linalg_ext.pack
+// CHECK-SAME:     %[[ARG2]] inner_dims_pos = [1, 2] inner_tiles = [8, 8] into %[[INIT_RESULT]]
+//      CHECK:   %[[BATCH_MMT4D:.+]] = linalg.generic
+// CHECK-SAME:       indexing_maps = [#[[LHS_MAP]], #[[RHS_MAP]], #[[RESULT_MAP]]]
+// CHECK-SAME:       iterator_types = ["parallel", "parallel", "parallel", "reduction", "parallel", "parallel", "reduction"]
+// CHECK-SAME:       ins(%[[PACK_LHS]], %[[PACK_RHS]] :
+// CHECK-SAME:       outs(%[[PACK_RESULT]] :
+//      CHECK:     arith.mulf
+//      CHECK:     arith.addf
+//      CHECK:   %[[UNPACK:.+]] = iree_linalg_ext.unpack %[[BATCH_MMT4D]] inner_dims_pos = [1, 2] inner_tiles = [8, 8]
+//      CHECK:   return %[[UNPACK]]
+
+// -----
+
+func.func @pack_elementwise(%arg0 : tensor<128x512xf32>, %arg1 : tensor<128x512xf32>) -> tensor<128x512xf32> {
+  %0 = iree_linalg_ext.set_encoding %arg0 : tensor<128x512xf32> -> tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  %1 = iree_linalg_ext.set_encoding %arg1 : tensor<128x512xf32> -> tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  %2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+      ins(%0 : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+      outs(%1 : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>) {
+  ^bb0(%b0 : f32, %b1 : f32):
+    %3 = arith.addf %b0, %b1 : f32
+    linalg.yield %3 : f32
+  } -> tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  %4 = iree_linalg_ext.unset_encoding %2 : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>> -> tensor<128x512xf32>
+  return %4 : tensor<128x512xf32>
+}
+//  CHECK-DAG: #[[MAP:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+//      CHECK: func @pack_elementwise(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<128x512xf32>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<128x512xf32>
+//      CHECK:   %[[PACK_ARG0:.+]] = iree_linalg_ext.pack %[[ARG0]]
+//      CHECK:   %[[PACK_ARG1:.+]] = iree_linalg_ext.pack %[[ARG1]]
+//      CHECK:   %[[ADD:.+]] = linalg.generic
+// CHECK-SAME:       indexing_maps = [#[[MAP]], #[[MAP]]]
+// CHECK-SAME:       iterator_types = ["parallel", "parallel", "parallel", "parallel"]
+// CHECK-SAME:       ins(%[[PACK_ARG0]] : tensor<16x64x8x8xf32>) outs(%[[PACK_ARG1]] : tensor<16x64x8x8xf32>)
+//      CHECK:     arith.addf
+//      CHECK:   %[[UNPACK:.+]] = iree_linalg_ext.unpack %[[ADD]]
+//      CHECK:   return %[[UNPACK]]
@@ -0,0 +1,72 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BINDINGS_PYTHON_IREE_RT_DLPACK_H_
+#define IREE_BINDINGS_PYTHON_IREE_RT_DLPACK_H_
+
+#include <stdint.h>
+
+// The subset of the DLPack ABI (https://github.com/dmlc/dlpack, v0.8) used to
+// exchange tensors with other frameworks via `__dlpack__` and `from_dlpack`.
+// The ABI is stable and declared here to avoid a dependency on the header.
+
+namespace iree {
+namespace python {
+
+enum DLDeviceType : int32_t {
+  kDLCPU = 1,
+  kDLCUDA = 2,
+  kDLCUDAHost = 3,
+  kDLCUDAManaged = 13,
+};
+
+struct DLDevice {
+  DLDeviceType device_type;
+  int32_t device_id;
+};
+
+enum DLDataTypeCode : uint8_t {
+  kDLInt = 0,
+  kDLUInt = 1,
+  kDLFloat = 2,
+  kDLOpaqueHandle = 3,
+  kDLBfloat = 4,
+  kDLComplex = 5,
+  kDLBool = 6,
+};
+
+struct DLDataType {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+};
+
+struct DLTensor {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  // Strides in elements or nullptr for a compact row-major tensor.
+  int64_t* strides;
+  uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(DLManagedTensor* self);
+};
+
+// Names of the PyCapsule holding a DLManagedTensor before and after it has
+// been consumed.
+constexpr const char kDLTensorCapsuleName[] = "dltensor";
+constexpr const char kUsedDLTensorCapsuleName[] = "used_dltensor";
+
+}  // namespace python
+}  // namespace iree
+
+#endif  // IREE_BINDINGS_PYTHON_IREE_RT_DLPACK_H_
@@ -6,11 +6,13 @@
 
 #include "./hal.h"
 
+#include "./dlpack.h"
 #include "./vm.h"
 #include "iree/base/internal/path.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
+#include "iree/tooling/safetensors_io.h"
 #include "pybind11/numpy.h"
 
 namespace iree {
@@ -57,9 +59,17 @@ py::dict HalAllocator::QueryStatistics() {
   items["host_bytes_peak"] = stats.host_bytes_peak;
   items["host_bytes_allocated"] = stats.host_bytes_allocated;
   items["host_bytes_freed"] = stats.host_bytes_freed;
+  items["host_bytes_pooled"] = stats.host_bytes_pooled;
+  items["host_allocation_count"] = stats.host_allocation_count;
+  items["host_allocation_count_peak"] = stats.host_allocation_count_peak;
   items["device_bytes_peak"] = stats.device_bytes_peak;
   items["device_bytes_allocated"] = stats.device_bytes_allocated;
   items["device_bytes_freed"] = stats.device_bytes_freed;
+  items["device_bytes_pooled"] = stats.device_bytes_pooled;
+  items["device_allocation_count"] = stats.device_allocation_count;
+  items["device_allocation_count_peak"] = stats.device_allocation_count_peak;
+  items["budget_trim_count"] = stats.budget_trim_count;
+  items["budget_rejection_count"] = stats.budget_rejection_count;
 #endif
   return items;
 }
@@ -80,26 +90,10 @@ py::str HalAllocator::FormattedStatistics() {
   return result;
 }
 
-py::object HalAllocator::AllocateBufferCopy(
-    int memory_type, int allowed_usage, py::object buffer,
-    std::optional<iree_hal_element_types_t> element_type) {
-  IREE_TRACE_SCOPE0("HalAllocator::AllocateBufferCopy");
-  // Request a view of the buffer (use the raw python C API to avoid
-  // some allocation and copying at the pybind level).
-  Py_buffer py_view;
-  // Note that only C-Contiguous ND-arrays are presently supported, so
-  // only request that via PyBUF_ND. Long term, we should consult an
-  // "oracle" in the runtime to determine the precise required format
-  // and set flags accordingly (and fallback/copy on failure).
-  int flags = PyBUF_FORMAT | PyBUF_ND;
-
-  // Acquire the backing buffer and setup RAII release.
-  if (PyObject_GetBuffer(buffer.ptr(), &py_view, flags) != 0) {
-    // The GetBuffer call is required to set an appropriate error.
-    throw py::error_already_set();
-  }
-  PyBufferReleaser py_view_releaser(py_view);
-
+// Allocates a buffer initialized with the contents of |py_view|.
+static iree_hal_buffer_t* AllocateBufferFromView(
+    iree_hal_allocator_t* allocator, int memory_type, int allowed_usage,
+    Py_buffer& py_view) {
   iree_hal_buffer_params_t params = {0};
   // TODO: Should not require host visible :(
   params.type = memory_type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
@@ -110,32 +104,71 @@ py::object HalAllocator::AllocateBufferCopy(
   {
     py::gil_scoped_release release;
     status = iree_hal_allocator_allocate_buffer(
-        raw_ptr(), params, py_view.len,
+        allocator, params, py_view.len,
         iree_make_const_byte_span(py_view.buf, py_view.len), &hal_buffer);
   }
   CheckApiStatus(status, "Failed to allocate device visible buffer");
+  return hal_buffer;
+}
 
-  if (!element_type) {
-    return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
+// Requests a view of |buffer| (using the raw python C API to avoid some
+// allocation and copying at the pybind level).
+static void GetPyBufferView(py::handle buffer, Py_buffer& py_view) {
+  // Note that only C-Contiguous ND-arrays are presently supported, so
+  // only request that via PyBUF_ND. Long term, we should consult an
+  // "oracle" in the runtime to determine the precise required format
+  // and set flags accordingly (and fallback/copy on failure).
+  int flags = PyBUF_FORMAT | PyBUF_ND;
+  if (PyObject_GetBuffer(buffer.ptr(), &py_view, flags) != 0) {
+    // The GetBuffer call is required to set an appropriate error.
+    throw py::error_already_set();
+  }
+}
+
+py::object HalAllocator::AllocateBufferCopy(
+    int memory_type, int allowed_usage, py::object buffer,
+    std::optional<iree_hal_element_types_t> element_type) {
+  IREE_TRACE_SCOPE0("HalAllocator::AllocateBufferCopy");
+  if (element_type) {
+    return py::cast(HalBufferView::StealFromRawPtr(AllocateBufferViewCopy(
+                        memory_type, allowed_usage, buffer, *element_type)),
                     py::return_value_policy::move);
   }
 
+  // Acquire the backing buffer and setup RAII release.
+  Py_buffer py_view;
+  GetPyBufferView(buffer, py_view);
+  PyBufferReleaser py_view_releaser(py_view);
+  iree_hal_buffer_t* hal_buffer =
+      AllocateBufferFromView(raw_ptr(), memory_type, allowed_usage, py_view);
+  return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
+                  py::return_value_policy::move);
+}
+
+iree_hal_buffer_view_t* HalAllocator::AllocateBufferViewCopy(
+    int memory_type, int allowed_usage, py::handle buffer,
+    iree_hal_element_type_t element_type) {
+  IREE_TRACE_SCOPE0("HalAllocator::AllocateBufferViewCopy");
+  // Acquire the backing buffer and setup RAII release.
+  Py_buffer py_view;
+  GetPyBufferView(buffer, py_view);
+  PyBufferReleaser py_view_releaser(py_view);
+  iree_hal_buffer_t* hal_buffer =
+      AllocateBufferFromView(raw_ptr(), memory_type, allowed_usage, py_view);
+
   // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
   // copy).
   iree_hal_encoding_type_t encoding_type =
       IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
   std::vector<iree_hal_dim_t> dims(py_view.ndim);
   std::copy(py_view.shape, py_view.shape + py_view.ndim, dims.begin());
-  iree_hal_buffer_view_t* hal_buffer_view;
-  CheckApiStatus(
-      iree_hal_buffer_view_create(
-          hal_buffer, dims.size(), dims.data(), *element_type, encoding_type,
-          iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view),
-      "Error allocating buffer_view");
+  iree_hal_buffer_view_t* hal_buffer_view = nullptr;
+  iree_status_t status = iree_hal_buffer_view_create(
+      hal_buffer, dims.size(), dims.data(), element_type, encoding_type,
+      iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view);
   iree_hal_buffer_release(hal_buffer);
-
-  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
-                  py::return_value_policy::move);
+  CheckApiStatus(status, "Error allocating buffer_view");
+  return hal_buffer_view;
 }
 
 //------------------------------------------------------------------------------
@@ -208,6 +241,320 @@ py::str HalBufferView::Repr() {
   return py::str(repr);
 }
 
+//------------------------------------------------------------------------------
+// DLPack interop
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Owns the shape of a buffer view exported to DLPack and a reference to its
+// Python object, which keeps the device owning the memory alive.
+struct DLPackExportContext {
+  DLManagedTensor managed_tensor;
+  py::object owner;
+  std::vector<int64_t> shape;
+};
+
+void DeleteDLPackExport(DLManagedTensor* managed_tensor) {
+  auto* context =
+      static_cast<DLPackExportContext*>(managed_tensor->manager_ctx);
+  if (!Py_IsInitialized()) {
+    // Leak the owner rather than touch a finalized interpreter.
+    context->owner.release();
+    delete context;
+    return;
+  }
+  // Consumers may call the deleter from any thread.
+  py::gil_scoped_acquire acquire;
+  delete context;
+}
+
+// Deletes the managed tensor of a capsule that was never consumed.
+void DestroyDLPackCapsule(PyObject* capsule) {
+  if (PyCapsule_IsValid(capsule, kUsedDLTensorCapsuleName)) return;
+  auto* managed_tensor = static_cast<DLManagedTensor*>(
+      PyCapsule_GetPointer(capsule, kDLTensorCapsuleName));
+  if (!managed_tensor) {
+    PyErr_WriteUnraisable(capsule);
+    return;
+  }
+  if (managed_tensor->deleter) managed_tensor->deleter(managed_tensor);
+}
+
+// Calls the producer's deleter once the HAL no longer uses the memory
+// of an imported DLPack tensor. |user_data| is the DLManagedTensor*.
+void ReleaseDLPackImport(void* user_data, iree_hal_buffer_t* buffer) {
+  auto* managed_tensor = static_cast<DLManagedTensor*>(user_data);
+  if (!managed_tensor->deleter || !Py_IsInitialized()) return;
+  // Deleters release references to Python objects and buffers may be released
+  // from any thread.
+  py::gil_scoped_acquire acquire;
+  managed_tensor->deleter(managed_tensor);
+}
+
+std::optional<DLDataType> MapElementTypeToDLDataType(
+    iree_hal_element_type_t element_type) {
+  DLDataType dtype;
+  dtype.bits = iree_hal_element_bit_count(element_type);
+  dtype.lanes = 1;
+  switch (iree_hal_element_numerical_type(element_type)) {
+    case IREE_HAL_NUMERICAL_TYPE_BOOLEAN:
+      dtype.code = kDLBool;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER:
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER_SIGNED:
+      dtype.code = kDLInt;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER_UNSIGNED:
+      dtype.code = kDLUInt;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_IEEE:
+      dtype.code = kDLFloat;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_BRAIN:
+      dtype.code = kDLBfloat;
+      break;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_COMPLEX:
+      dtype.code = kDLComplex;
+      break;
+    default:
+      return std::nullopt;
+  }
+  return dtype;
+}
+
+std::optional<iree_hal_element_type_t> MapDLDataTypeToElementType(
+    DLDataType dtype) {
+  if (dtype.lanes != 1) return std::nullopt;
+  iree_hal_numerical_type_t numerical_type;
+  switch (dtype.code) {
+    case kDLBool:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_BOOLEAN;
+      break;
+    case kDLInt:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_INTEGER_SIGNED;
+      break;
+    case kDLUInt:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_INTEGER_UNSIGNED;
+      break;
+    case kDLFloat:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_IEEE;
+      break;
+    case kDLBfloat:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_BRAIN;
+      break;
+    case kDLComplex:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_COMPLEX;
+      break;
+    default:
+      return std::nullopt;
+  }
+  return iree_hal_make_element_type(numerical_type, dtype.bits);
+}
+
+// Exports |buffer| as a host allocation (read as kDLCPU) or as a device
+// allocation (read as kDLCUDA, the only driver exporting them), preferring the
+// one matching where the buffer is local.
+void ExportDLPackBuffer(iree_hal_buffer_t* buffer,
+                        iree_hal_external_buffer_t* out_external_buffer,
+                        DLDevice* out_device) {
+  iree_hal_allocator_t* allocator = iree_hal_buffer_device_allocator(buffer);
+  if (!allocator) {
+    throw RaiseValueError("Buffer was not allocated by a HAL allocator");
+  }
+  iree_hal_external_buffer_type_t types[2] = {
+      IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION,
+  };
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
+    std::swap(types[0], types[1]);
+  }
+  iree_status_t status = iree_ok_status();
+  for (auto type : types) {
+    iree_status_ignore(status);
+    status = iree_hal_allocator_export_buffer(
+        allocator, buffer, type, IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+        out_external_buffer);
+    if (iree_status_is_ok(status)) break;
+  }
+  CheckApiStatus(status, "Buffer cannot be exported to DLPack");
+  out_device->device_type =
+      out_external_buffer->type == IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION
+          ? kDLCPU
+          : kDLCUDA;
+  // TODO: track the ordinal of CUDA devices for multi-GPU exchange.
+  out_device->device_id = 0;
+}
+
+}  // namespace
+
+py::capsule HalBufferView::ToDLPack(py::object owner, py::object stream) {
+  // The stream is accepted for protocol compatibility: the contents of HAL
+  // buffer views are available once they are handed to Python.
+  (void)stream;
+  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(raw_ptr());
+  iree_hal_external_buffer_t external_buffer;
+  DLDevice device;
+  ExportDLPackBuffer(buffer, &external_buffer, &device);
+  auto dtype =
+      MapElementTypeToDLDataType(iree_hal_buffer_view_element_type(raw_ptr()));
+  if (!dtype) {
+    throw RaiseValueError("Buffer view element type has no DLPack dtype");
+  }
+
+  auto* context = new DLPackExportContext();
+  iree_host_size_t rank = iree_hal_buffer_view_shape_rank(raw_ptr());
+  const iree_hal_dim_t* dims = iree_hal_buffer_view_shape_dims(raw_ptr());
+  context->shape.assign(dims, dims + rank);
+  context->owner = std::move(owner);
+
+  DLTensor& tensor = context->managed_tensor.dl_tensor;
+  tensor.data =
+      external_buffer.type == IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION
+          ? external_buffer.handle.host_allocation.ptr
+          : reinterpret_cast<void*>(
+                static_cast<uintptr_t>(
+                    external_buffer.handle.device_allocation.ptr));
+  tensor.device = device;
+  tensor.ndim = static_cast<int32_t>(rank);
+  tensor.dtype = *dtype;
+  tensor.shape = context->shape.data();
+  tensor.strides = nullptr;
+  tensor.byte_offset = 0;
+  context->managed_tensor.manager_ctx = context;
+  context->managed_tensor.deleter = DeleteDLPackExport;
+
+  PyObject* capsule = PyCapsule_New(&context->managed_tensor,
+                                    kDLTensorCapsuleName, DestroyDLPackCapsule);
+  if (!capsule) {
+    DeleteDLPackExport(&context->managed_tensor);
+    throw py::error_already_set();
+  }
+  return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+py::tuple HalBufferView::DLPackDevice() {
+  iree_hal_external_buffer_t external_buffer;
+  DLDevice device;
+  ExportDLPackBuffer(iree_hal_buffer_view_buffer(raw_ptr()), &external_buffer,
+                     &device);
+  return py::make_tuple(static_cast<int>(device.device_type),
+                        device.device_id);
+}
+
+py::object HalAllocator::ImportDLPack(py::object tensor,
+                                      std::optional<int> memory_type,
+                                      int allowed_usage) {
+  IREE_TRACE_SCOPE0("HalAllocator::ImportDLPack");
+  py::object capsule = tensor;
+  if (py::hasattr(tensor, "__dlpack__")) {
+    capsule = tensor.attr("__dlpack__")();
+  }
+  auto* managed_tensor = static_cast<DLManagedTensor*>(
+      PyCapsule_GetPointer(capsule.ptr(), kDLTensorCapsuleName));
+  if (!managed_tensor) {
+    throw py::error_already_set();
+  }
+  const DLTensor& dl_tensor = managed_tensor->dl_tensor;
+
+  auto element_type = MapDLDataTypeToElementType(dl_tensor.dtype);
+  if (!element_type || dl_tensor.dtype.bits % 8 != 0) {
+    throw RaiseValueError("Unsupported DLPack dtype");
+  }
+  std::vector<iree_hal_dim_t> dims(dl_tensor.shape,
+                                   dl_tensor.shape + dl_tensor.ndim);
+  iree_device_size_t byte_length = dl_tensor.dtype.bits / 8;
+  for (auto dim : dims) byte_length *= dim;
+  if (dl_tensor.strides) {
+    // Only compact row-major tensors can be aliased.
+    int64_t expected_stride = 1;
+    for (int32_t i = dl_tensor.ndim - 1; i >= 0; --i) {
+      if (dl_tensor.shape[i] != 1 && dl_tensor.strides[i] != expected_stride) {
+        throw RaiseValueError(
+            "Only compact row-major DLPack tensors can be imported");
+      }
+      expected_stride *= dl_tensor.shape[i];
+    }
+  }
+
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+  external_buffer.size = byte_length;
+  uint8_t* data = static_cast<uint8_t*>(dl_tensor.data) + dl_tensor.byte_offset;
+  iree_hal_buffer_params_t params = {0};
+  switch (dl_tensor.device.device_type) {
+    case kDLCPU:
+    case kDLCUDAHost:
+      external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+      external_buffer.handle.host_allocation.ptr = data;
+      params.type =
+          IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+      break;
+    case kDLCUDA:
+    case kDLCUDAManaged:
+      external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION;
+      external_buffer.handle.device_allocation.ptr =
+          static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
+      params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+      break;
+    default:
+      throw RaiseValueError("Unsupported DLPack device type");
+  }
+  if (memory_type) params.type = *memory_type;
+  params.usage = allowed_usage;
+  params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+
+  iree_hal_buffer_release_callback_t release_callback = {ReleaseDLPackImport,
+                                                         managed_tensor};
+  iree_hal_buffer_t* hal_buffer = nullptr;
+  CheckApiStatus(
+      iree_hal_allocator_import_buffer(raw_ptr(), params, &external_buffer,
+                                       release_callback, &hal_buffer),
+      "Failed to import DLPack tensor");
+  // The buffer now owns the managed tensor.
+  PyCapsule_SetName(capsule.ptr(), kUsedDLTensorCapsuleName);
+
+  iree_hal_buffer_view_t* hal_buffer_view = nullptr;
+  iree_status_t status = iree_hal_buffer_view_create(
+      hal_buffer, dims.size(), dims.data(), *element_type,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view);
+  iree_hal_buffer_release(hal_buffer);
+  CheckApiStatus(status, "Error allocating buffer_view");
+  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
+                  py::return_value_policy::move);
+}
+
+//------------------------------------------------------------------------------
+// HalFence
+//------------------------------------------------------------------------------
+
+bool HalFence::Query() {
+  iree_status_t status = iree_hal_fence_query(raw_ptr());
+  if (iree_status_is_deferred(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, "Fence failed");
+  return true;
+}
+
+void HalFence::Wait(std::optional<double> timeout_seconds) {
+  iree_timeout_t timeout = iree_infinite_timeout();
+  if (timeout_seconds) {
+    timeout = iree_make_timeout_ns(
+        static_cast<iree_duration_t>(*timeout_seconds * 1000000000.0));
+  }
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_hal_fence_wait(raw_ptr(), timeout);
+  }
+  CheckApiStatus(status, "Error waiting on fence");
+}
+
 //------------------------------------------------------------------------------
 // HalDevice
 //------------------------------------------------------------------------------
@@ -244,6 +591,102 @@ void HalDevice::EndProfiling() {
                  "ending device profiling");
 }
 
+HalFence HalDevice::QueueCopy(HalBuffer& source,
+                              iree_device_size_t source_offset,
+                              HalBuffer& target,
+                              iree_device_size_t target_offset,
+                              iree_device_size_t length) {
+  iree_hal_transfer_command_t command;
+  memset(&command, 0, sizeof(command));
+  command.type = IREE_HAL_TRANSFER_COMMAND_TYPE_COPY;
+  command.copy.source_buffer = source.raw_ptr();
+  command.copy.source_offset = source_offset;
+  command.copy.target_buffer = target.raw_ptr();
+  command.copy.target_offset = target_offset;
+  command.copy.length = length;
+
+  iree_hal_command_buffer_t* command_buffer = nullptr;
+  iree_hal_semaphore_t* semaphore = nullptr;
+  iree_hal_fence_t* signal_fence = nullptr;
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_hal_create_transfer_command_buffer(
+        raw_ptr(), IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_QUEUE_AFFINITY_ANY, 1, &command, &command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_semaphore_create(raw_ptr(), 0ull, &semaphore);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_fence_create_at(semaphore, 1ull,
+                                        iree_allocator_system(), &signal_fence);
+    }
+    if (iree_status_is_ok(status)) {
+      uint64_t signal_value = 1ull;
+      iree_hal_semaphore_list_t signal_semaphores = {1, &semaphore,
+                                                     &signal_value};
+      status = iree_hal_device_queue_execute(
+          raw_ptr(), IREE_HAL_QUEUE_AFFINITY_ANY,
+          iree_hal_semaphore_list_empty(), signal_semaphores, 1,
+          &command_buffer, /*binding_tables=*/nullptr);
+    }
+    iree_hal_semaphore_release(semaphore);
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_fence_release(signal_fence);
+    CheckApiStatus(status, "Error enqueuing buffer copy");
+  }
+  return HalFence::StealFromRawPtr(signal_fence);
+}
+
+py::tuple HalDevice::LoadSafetensors(
+    const std::string& path, std::optional<std::vector<std::string>> names,
+    int memory_type, int allowed_usage, iree_device_size_t batch_size) {
+  std::vector<iree_string_view_t> name_views;
+  if (names) {
+    if (names->empty()) {
+      throw RaiseValueError("Expected at least one tensor name");
+    }
+    for (auto& name : *names) {
+      name_views.push_back(iree_make_string_view(name.data(), name.size()));
+    }
+  }
+  iree_hal_buffer_params_t params = {0};
+  params.type = memory_type;
+  params.usage = allowed_usage;
+
+  // Buffer views are collected without the GIL and wrapped afterwards.
+  std::vector<std::pair<std::string, iree_hal_buffer_view_t*>> buffer_views;
+  auto append = +[](void* user_data, iree_string_view_t name,
+                    iree_hal_buffer_view_t* buffer_view) -> iree_status_t {
+    auto* buffer_views = static_cast<
+        std::vector<std::pair<std::string, iree_hal_buffer_view_t*>>*>(
+        user_data);
+    iree_hal_buffer_view_retain(buffer_view);
+    buffer_views->emplace_back(std::string(name.data, name.size), buffer_view);
+    return iree_ok_status();
+  };
+  iree_hal_fence_t* ready_fence = nullptr;
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_safetensors_upload_file(
+        path.c_str(), name_views.size(), name_views.data(), params, batch_size,
+        raw_ptr(), iree_allocator_system(), append, &buffer_views,
+        &ready_fence);
+  }
+
+  py::dict results;
+  for (auto& [name, buffer_view] : buffer_views) {
+    results[py::str(name)] = py::cast(
+        HalBufferView::StealFromRawPtr(buffer_view),
+        py::return_value_policy::move);
+  }
+  CheckApiStatus(status, "Error loading safetensors file");
+  return py::make_tuple(results, HalFence::StealFromRawPtr(ready_fence));
+}
+
 //------------------------------------------------------------------------------
 // HalDriver
 //------------------------------------------------------------------------------
@@ -572,7 +1015,7 @@ void SetupHalBindings(pybind11::module m) {
       .export_values()
       .def_static("map_to_dtype", &MapElementTypeToDType);
 
-  py::class_<HalDevice>(m, "HalDevice")
+  py::class_<HalDevice>(m, "HalDevice", py::dynamic_attr())
       .def_property_readonly(
           "allocator",
           [](HalDevice& self) {
@@ -580,7 +1023,22 @@ void SetupHalBindings(pybind11::module m) {
           },
           py::keep_alive<0, 1>())
       .def("begin_profiling", &HalDevice::BeginProfiling)
-      .def("end_profiling", &HalDevice::EndProfiling);
+      .def("end_profiling", &HalDevice::EndProfiling)
+      .def("queue_copy", &HalDevice::QueueCopy, py::arg("source"),
+           py::arg("source_offset"), py::arg("target"),
+           py::arg("target_offset"), py::arg("length"),
+           "Enqueues a copy between two buffers and returns a HalFence "
+           "signaled when it completes. Both buffers must be kept alive until "
+           "then.")
+      .def("load_safetensors", &HalDevice::LoadSafetensors, py::arg("path"),
+           py::arg("names") = py::none(),
+           py::arg("memory_type") = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+           py::arg("allowed_usage") = IREE_HAL_BUFFER_USAGE_DEFAULT,
+           py::arg("batch_size") = 64 << 20,
+           "Maps a safetensors file and streams its tensors (or only those in "
+           "`names`) into device buffers with asynchronous transfers. Returns "
+           "a tuple of a dict of HalBufferViews by tensor name and a HalFence "
+           "signaled once their contents are ready.");
 
   py::class_<HalDriver>(m, "HalDriver")
       .def_static("query", &HalDriver::Query)
@@ -660,9 +1118,29 @@ void SetupHalBindings(pybind11::module m) {
            "object. If an element type is specified, wraps in a BufferView "
            "matching the characteristics of the Python buffer. The format is "
            "requested as ND/C-Contiguous, which may incur copies if not "
-           "already in that format.");
+           "already in that format.")
+      .def("from_dlpack", &HalAllocator::ImportDLPack, py::arg("tensor"),
+           py::arg("memory_type") = py::none(),
+           py::arg("allowed_usage") = IREE_HAL_BUFFER_USAGE_DEFAULT,
+           py::keep_alive<0, 1>(),
+           "Imports a tensor implementing `__dlpack__` (or a DLPack capsule) "
+           "as a BufferView aliasing its memory without copies. CPU tensors "
+           "are imported as host allocations and CUDA tensors as device "
+           "allocations. The tensor is kept alive until the buffer is "
+           "released.");
 
   py::class_<HalBuffer>(m, "HalBuffer")
+      .def_property_readonly("byte_length", &HalBuffer::byte_length)
+      .def_property_readonly("memory_type",
+                             [](HalBuffer& self) -> int {
+                               return iree_hal_buffer_memory_type(
+                                   self.raw_ptr());
+                             })
+      .def_property_readonly("allowed_usage",
+                             [](HalBuffer& self) -> int {
+                               return iree_hal_buffer_allowed_usage(
+                                   self.raw_ptr());
+                             })
       .def("fill_zero", &HalBuffer::FillZero, py::arg("byte_offset"),
            py::arg("byte_length"))
       .def("create_view", &HalBuffer::CreateView, py::arg("shape"),
@@ -691,8 +1169,29 @@ void SetupHalBindings(pybind11::module m) {
           [](HalBufferView& self) {
             return iree_hal_buffer_view_element_type(self.raw_ptr());
           })
+      .def_property_readonly(
+          "buffer",
+          [](HalBufferView& self) {
+            return HalBuffer::BorrowFromRawPtr(
+                iree_hal_buffer_view_buffer(self.raw_ptr()));
+          },
+          py::keep_alive<0, 1>())
+      .def(
+          "__dlpack__",
+          [](py::object self, py::object stream) {
+            return py::cast<HalBufferView&>(self).ToDLPack(self, stream);
+          },
+          py::arg("stream") = py::none())
+      .def("__dlpack_device__", &HalBufferView::DLPackDevice)
       .def("__repr__", &HalBufferView::Repr);
 
+  auto hal_fence = py::class_<HalFence>(m, "HalFence");
+  VmRef::BindRefProtocol(hal_fence, iree_hal_fence_type_id,
+                         iree_hal_fence_retain_ref, iree_hal_fence_deref,
+                         iree_hal_fence_isa);
+  hal_fence.def("query", &HalFence::Query)
+      .def("wait", &HalFence::Wait, py::arg("timeout") = py::none());
+
   py::class_<HalMappedMemory>(m, "MappedMemory", py::buffer_protocol())
       .def_buffer(&HalMappedMemory::ToBufferInfo)
       .def("asarray",
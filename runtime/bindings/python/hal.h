@@ -76,10 +76,19 @@ struct ApiPtrAdapter<iree_hal_buffer_view_t> {
   }
 };
 
+template <>
+struct ApiPtrAdapter<iree_hal_fence_t> {
+  static void Retain(iree_hal_fence_t* f) { iree_hal_fence_retain(f); }
+  static void Release(iree_hal_fence_t* f) { iree_hal_fence_release(f); }
+};
+
 //------------------------------------------------------------------------------
 // ApiRefCounted types
 //------------------------------------------------------------------------------
 
+class HalBuffer;
+class HalFence;
+
 class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
  public:
   iree_hal_allocator_t* allocator() {
@@ -88,6 +97,22 @@ class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
 
   void BeginProfiling(const py::kwargs& kwargs);
   void EndProfiling();
+
+  // Enqueues a copy of |length| bytes between two buffers on the device queue
+  // and returns a fence signaled when it has completed. Both buffers must be
+  // kept alive by the caller until then.
+  HalFence QueueCopy(HalBuffer& source, iree_device_size_t source_offset,
+                     HalBuffer& target, iree_device_size_t target_offset,
+                     iree_device_size_t length);
+
+  // Streams the tensors of the safetensors file at |path| (only those in
+  // |names| if given) into buffers with the given memory type and usage.
+  // Returns a tuple of a dict of buffer views by tensor name and a fence
+  // signaled when all transfers have completed.
+  py::tuple LoadSafetensors(const std::string& path,
+                            std::optional<std::vector<std::string>> names,
+                            int memory_type, int allowed_usage,
+                            iree_device_size_t batch_size);
 };
 
 class HalDriver : public ApiRefCounted<HalDriver, iree_hal_driver_t> {
@@ -110,6 +135,18 @@ class HalAllocator : public ApiRefCounted<HalAllocator, iree_hal_allocator_t> {
   py::object AllocateBufferCopy(
       int memory_type, int allowed_usage, py::object buffer,
       std::optional<iree_hal_element_types_t> element_type);
+
+  // Allocates a buffer view initialized with the contents of the C-contiguous
+  // host |buffer| without creating intermediate Python objects. Returns a
+  // buffer view owned by the caller.
+  iree_hal_buffer_view_t* AllocateBufferViewCopy(
+      int memory_type, int allowed_usage, py::handle buffer,
+      iree_hal_element_type_t element_type);
+
+  // Imports a tensor implementing the DLPack protocol (or a DLPack capsule)
+  // as a buffer view aliasing its memory without copies.
+  py::object ImportDLPack(py::object tensor, std::optional<int> memory_type,
+                          int allowed_usage);
 };
 
 struct HalShape {
@@ -127,6 +164,13 @@ class HalBufferView
     : public ApiRefCounted<HalBufferView, iree_hal_buffer_view_t> {
  public:
   py::str Repr();
+
+  // Exports the buffer view as a DLPack capsule aliasing its memory. |owner|
+  // is the Python object of this buffer view and is kept alive until the
+  // consumer deletes the tensor.
+  py::capsule ToDLPack(py::object owner, py::object stream);
+  // Returns the DLPack (device_type, device_id) of the buffer view memory.
+  py::tuple DLPackDevice();
 };
 
 class HalBuffer : public ApiRefCounted<HalBuffer, iree_hal_buffer_t> {
@@ -159,6 +203,15 @@ class HalBuffer : public ApiRefCounted<HalBuffer, iree_hal_buffer_t> {
   py::str Repr();
 };
 
+class HalFence : public ApiRefCounted<HalFence, iree_hal_fence_t> {
+ public:
+  // Returns true if the fence has been reached and raises if it failed.
+  bool Query();
+  // Blocks until the fence is reached or |timeout_seconds| elapses (forever
+  // if unspecified). The GIL is released while waiting.
+  void Wait(std::optional<double> timeout_seconds);
+};
+
 // Wrapper around an iree_hal_buffer_mapping_t and iree_hal_buffer_view_t
 // which retains the latter and unmaps/releases on deallocation.
 class HalMappedMemory {
@@ -13,6 +13,7 @@
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
 #include "iree/vm/api.h"
+#include "pybind11/numpy.h"
 
 namespace iree {
 namespace python {
@@ -37,6 +38,27 @@ class InvokeContext {
 using PackCallback =
     std::function<void(InvokeContext &, iree_vm_list_t *, py::handle)>;
 
+// Converts the element at an index of a VM list to a Python value. The
+// device is the Python HalDevice object results are placed on.
+using UnpackCallback = std::function<py::object(
+    py::handle device, iree_vm_list_t *list, iree_host_size_t index)>;
+
+// Converts all elements of a VM list to a Python structure.
+using ListUnpackCallback =
+    std::function<py::object(py::handle device, iree_vm_list_t *list)>;
+
+// Throws if |list| does not have |expected_size| elements.
+void CheckListSize(iree_vm_list_t *list, size_t expected_size) {
+  iree_host_size_t size = iree_vm_list_size(list);
+  if (size != expected_size) {
+    std::string message("mismatched return arity: ");
+    message.append(std::to_string(size));
+    message.append(" vs ");
+    message.append(std::to_string(expected_size));
+    throw std::invalid_argument(std::move(message));
+  }
+}
+
 class InvokeStatics {
  public:
   ~InvokeStatics() {
@@ -49,6 +71,7 @@ class InvokeStatics {
   py::str kSlistTag = py::str("slist");
   py::str kStupleTag = py::str("stuple");
   py::str kSdictTag = py::str("sdict");
+  py::str kPyHomogeneousListTag = py::str("py_homogeneous_list");
 
   py::int_ kZero = py::int_(0);
   py::int_ kOne = py::int_(1);
@@ -60,6 +83,8 @@ class InvokeStatics {
   py::str kDtypeAttr = py::str("dtype");
 
   // Primitive type names.
+  py::str kBF16 = py::str("bf16");
+  py::str kF16 = py::str("f16");
   py::str kF32 = py::str("f32");
   py::str kF64 = py::str("f64");
   py::str kI1 = py::str("i1");
@@ -73,6 +98,7 @@ class InvokeStatics {
 
   // Attribute names.
   py::str kAttrBufferView = py::str("_buffer_view");
+  py::str kAttrIsNative = py::str("isnative");
 
   // Module 'numpy'.
   py::module &numpy_module() { return numpy_module_; }
@@ -112,8 +138,11 @@ class InvokeStatics {
   }
 
   enum iree_hal_element_types_t MapDtypeToElementType(py::object dtype) {
-    // TODO: Consider porting this from a py func to C++ as it can be on
-    // the critical path.
+    // Builtin numeric dtypes are mapped directly as this can be on the
+    // critical path. Others are left to array_interop.
+    if (auto element_type = MapBuiltinDtypeToElementType(dtype)) {
+      return *element_type;
+    }
     try {
       py::object element_type =
           array_interop_module().attr(kMapDtypeToElementTypeAttr)(dtype);
@@ -130,6 +159,106 @@ class InvokeStatics {
     }
   }
 
+  // Returns true if |value| is a C-contiguous numpy array.
+  static bool IsContiguousHostArray(py::handle value) {
+    if (!py::isinstance<py::array>(value)) return false;
+    auto array = py::reinterpret_borrow<py::array>(value);
+    return (array.flags() & py::array::c_style) != 0;
+  }
+
+  // Returns true if |value| is a C-contiguous numpy array of |dtype| that can
+  // be copied to the device without conversion.
+  static bool IsCompatibleHostArray(py::handle value, py::handle dtype) {
+    return IsContiguousHostArray(value) &&
+           py::reinterpret_borrow<py::array>(value).dtype().equal(dtype);
+  }
+
+  // Maps native numpy bool, integer, float and complex dtypes to their HAL
+  // element type.
+  std::optional<enum iree_hal_element_types_t> MapBuiltinDtypeToElementType(
+      py::handle dtype) {
+    if (!py::isinstance<py::dtype>(dtype)) return std::nullopt;
+    auto np_dtype = py::reinterpret_borrow<py::dtype>(dtype);
+    if (!py::cast<bool>(np_dtype.attr(kAttrIsNative))) return std::nullopt;
+    switch (np_dtype.kind()) {
+      case 'b':
+        if (np_dtype.itemsize() == 1) return IREE_HAL_ELEMENT_TYPE_BOOL_8;
+        break;
+      case 'i':
+        switch (np_dtype.itemsize()) {
+          case 1:
+            return IREE_HAL_ELEMENT_TYPE_SINT_8;
+          case 2:
+            return IREE_HAL_ELEMENT_TYPE_SINT_16;
+          case 4:
+            return IREE_HAL_ELEMENT_TYPE_SINT_32;
+          case 8:
+            return IREE_HAL_ELEMENT_TYPE_SINT_64;
+        }
+        break;
+      case 'u':
+        switch (np_dtype.itemsize()) {
+          case 1:
+            return IREE_HAL_ELEMENT_TYPE_UINT_8;
+          case 2:
+            return IREE_HAL_ELEMENT_TYPE_UINT_16;
+          case 4:
+            return IREE_HAL_ELEMENT_TYPE_UINT_32;
+          case 8:
+            return IREE_HAL_ELEMENT_TYPE_UINT_64;
+        }
+        break;
+      case 'f':
+        switch (np_dtype.itemsize()) {
+          case 2:
+            return IREE_HAL_ELEMENT_TYPE_FLOAT_16;
+          case 4:
+            return IREE_HAL_ELEMENT_TYPE_FLOAT_32;
+          case 8:
+            return IREE_HAL_ELEMENT_TYPE_FLOAT_64;
+        }
+        break;
+      case 'c':
+        switch (np_dtype.itemsize()) {
+          case 8:
+            return IREE_HAL_ELEMENT_TYPE_COMPLEX_FLOAT_64;
+          case 16:
+            return IREE_HAL_ELEMENT_TYPE_COMPLEX_FLOAT_128;
+        }
+        break;
+    }
+    return std::nullopt;
+  }
+
+  // Copies the host array |host_array| (converting it to |dtype| first if
+  // needed) to a new device buffer view and returns a ref to it.
+  iree_vm_ref_t CopyHostArrayToDevice(InvokeContext &c, py::handle host_array,
+                                      const py::object &dtype,
+                                      iree_hal_element_type_t element_type) {
+    py::object converted_array;
+    if (!dtype.is_none() && !IsCompatibleHostArray(host_array, dtype)) {
+      try {
+        converted_array =
+            numpy_module().attr(kAsArray)(host_array, dtype, kContiguousArg);
+      } catch (std::exception &e) {
+        std::string msg("could not convert value to numpy array: dtype=");
+        msg.append(py::cast<std::string>(py::repr(dtype)));
+        msg.append(", error='");
+        msg.append(e.what());
+        msg.append("', value=");
+        msg.append(py::cast<std::string>(py::repr(host_array)));
+        throw std::invalid_argument(std::move(msg));
+      }
+      host_array = converted_array;
+    }
+    iree_hal_buffer_view_t *buffer_view =
+        c.allocator().AllocateBufferViewCopy(
+            IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+            IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
+            host_array, element_type);
+    return iree_hal_buffer_view_move_ref(buffer_view);
+  }
+
   PackCallback AbiTypeToPackCallback(py::handle desc) {
     return AbiTypeToPackCallback(
         std::move(desc), /*desc_is_list=*/py::isinstance<py::list>(desc));
@@ -156,7 +285,8 @@ class InvokeStatics {
 
         // Map abi element type to dtype.
         py::object abi_type = desc[kOne];
-        py::object target_dtype = MapElementAbiTypeToDtype(abi_type);
+        py::dtype target_dtype =
+            py::dtype::from_args(MapElementAbiTypeToDtype(abi_type));
         auto hal_element_type = MapDtypeToElementType(target_dtype);
 
         return [this, target_dtype = std::move(target_dtype), hal_element_type,
@@ -164,50 +294,32 @@ class InvokeStatics {
                                                   iree_vm_list_t *list,
                                                   py::handle py_value) {
           IREE_TRACE_SCOPE0("ArgumentPacker::ReflectionNdarray");
-          HalBufferView *bv = nullptr;
-          py::object retained_bv;
+          iree_vm_ref_t buffer_view_ref;
           if (py::isinstance(py_value, device_array_type())) {
             // Short-circuit: If a DeviceArray is provided, assume it is
             // correct.
             IREE_TRACE_SCOPE0("PackDeviceArray");
-            bv = py::cast<HalBufferView *>(py_value.attr(kAttrBufferView));
+            HalBufferView *bv =
+                py::cast<HalBufferView *>(py_value.attr(kAttrBufferView));
+            buffer_view_ref = iree_hal_buffer_view_retain_ref(bv->raw_ptr());
           } else if (py::isinstance(py_value, hal_buffer_view_type())) {
             // Short-circuit: If a HalBufferView is provided directly.
             IREE_TRACE_SCOPE0("PackBufferView");
-            bv = py::cast<HalBufferView *>(py_value);
+            HalBufferView *bv = py::cast<HalBufferView *>(py_value);
+            buffer_view_ref = iree_hal_buffer_view_retain_ref(bv->raw_ptr());
           } else {
-            // Fall back to the array protocol to generate a host side
-            // array and then convert that.
+            // Copy from the buffer of host arrays that already match the
+            // target. Anything else goes through the array protocol to
+            // generate a host side array and then converts that.
             IREE_TRACE_SCOPE0("PackHostArray");
-            py::object host_array;
-            try {
-              host_array = numpy_module().attr(kAsArray)(py_value, target_dtype,
-                                                         kContiguousArg);
-            } catch (std::exception &e) {
-              std::string msg("could not convert value to numpy array: dtype=");
-              msg.append(py::cast<std::string>(py::repr(target_dtype)));
-              msg.append(", error='");
-              msg.append(e.what());
-              msg.append("', value=");
-              msg.append(py::cast<std::string>(py::repr(py_value)));
-              throw std::invalid_argument(std::move(msg));
-            }
-
-            retained_bv = c.allocator().AllocateBufferCopy(
-                IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
-                IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
-                host_array, hal_element_type);
-            bv = py::cast<HalBufferView *>(retained_bv);
+            buffer_view_ref = CopyHostArrayToDevice(c, py_value, target_dtype,
+                                                    hal_element_type);
           }
 
           // TODO: Add some shape verification. Not strictly necessary as the VM
           // will check, but may make error reporting nicer.
           // TODO: It is theoretically possible to enqueue further conversions
           // on the device, but for now we require things to line up closely.
-          // TODO: If adding further manipulation here, please make this common
-          // with the generic access case.
-          iree_vm_ref_t buffer_view_ref =
-              iree_hal_buffer_view_retain_ref(bv->raw_ptr());
           CheckApiStatus(iree_vm_list_push_ref_move(list, &buffer_view_ref),
                          "could not push buffer view to list");
         };
@@ -362,6 +474,121 @@ class InvokeStatics {
     }
   }
 
+  // Given an ABI desc, return a callback that converts the corresponding
+  // element of a VM list to Python.
+  UnpackCallback AbiTypeToUnpackCallback(py::handle desc) {
+    if (py::isinstance<py::list>(desc)) {
+      // Compound type.
+      py::object compound_type = desc[kZero];
+      if (compound_type.equal(kNdarray)) {
+        // Has format:
+        //   ["ndarray", "f32", rank, dim0, dim1, ...]
+        // Results are wrapped in a DeviceArray of the ABI dtype.
+        py::object abi_type = desc[kOne];
+        py::object dtype = MapElementAbiTypeToDtype(abi_type);
+        return [this, dtype = std::move(dtype)](
+                   py::handle device, iree_vm_list_t *list,
+                   iree_host_size_t index) -> py::object {
+          IREE_TRACE_SCOPE0("ResultUnpacker::Ndarray");
+          iree_vm_ref_t ref = {0};
+          CheckApiStatus(iree_vm_list_get_ref_assign(list, index, &ref),
+                         "could not access list element");
+          iree_hal_buffer_view_t *buffer_view = nullptr;
+          CheckApiStatus(iree_hal_buffer_view_check_deref(ref, &buffer_view),
+                         "expected a buffer view result");
+          py::object py_buffer_view =
+              py::cast(HalBufferView::BorrowFromRawPtr(buffer_view),
+                       py::return_value_policy::move);
+          return device_array_type()(device, py_buffer_view,
+                                     py::arg("implicit_host_transfer") = true,
+                                     py::arg("override_dtype") = dtype);
+        };
+      } else if (compound_type.equal(kPyHomogeneousListTag)) {
+        // The descriptor is like:
+        //   ['py_homogeneous_list', element_type]
+        UnpackCallback element_unpacker = AbiTypeToUnpackCallback(desc[kOne]);
+        return [element_unpacker = std::move(element_unpacker)](
+                   py::handle device, iree_vm_list_t *list,
+                   iree_host_size_t index) -> py::object {
+          iree_vm_list_t *sub_list = GetSubList(list, index);
+          iree_host_size_t size = iree_vm_list_size(sub_list);
+          py::list items(size);
+          for (iree_host_size_t i = 0; i < size; ++i) {
+            items[i] = element_unpacker(device, sub_list, i);
+          }
+          return std::move(items);
+        };
+      }
+      ListUnpackCallback list_unpacker = AbiTypeToListUnpackCallback(desc);
+      return [list_unpacker = std::move(list_unpacker)](
+                 py::handle device, iree_vm_list_t *list,
+                 iree_host_size_t index) -> py::object {
+        return list_unpacker(device, GetSubList(list, index));
+      };
+    }
+
+    // Primitive type.
+    py::str prim_type = py::cast<py::str>(desc);
+    if (prim_type.equal(kI8) || prim_type.equal(kI16) ||
+        prim_type.equal(kI32) || prim_type.equal(kI64)) {
+      return MakeScalarUnpackCallback(/*is_float=*/false);
+    } else if (prim_type.equal(kF16) || prim_type.equal(kF32) ||
+               prim_type.equal(kF64) || prim_type.equal(kBF16)) {
+      return MakeScalarUnpackCallback(/*is_float=*/true);
+    }
+    std::string message("cannot map VM type to Python: ");
+    message.append(py::cast<std::string>(prim_type));
+    throw std::invalid_argument(message);
+  }
+
+  // Given the ABI desc of a structure (slist, stuple or sdict), return a
+  // callback that converts all elements of a VM list to it.
+  ListUnpackCallback AbiTypeToListUnpackCallback(py::handle desc) {
+    py::object compound_type = desc[kZero];
+    if (compound_type.equal(kSlistTag) || compound_type.equal(kStupleTag)) {
+      // The descriptor is like:
+      //   ['slist', item1, ...]
+      bool is_tuple = compound_type.equal(kStupleTag);
+      std::vector<UnpackCallback> sub_unpackers(py::len(desc) - 1);
+      for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+        sub_unpackers[i] = AbiTypeToUnpackCallback(desc[py::int_(i + 1)]);
+      }
+      return [is_tuple, sub_unpackers = std::move(sub_unpackers)](
+                 py::handle device, iree_vm_list_t *list) -> py::object {
+        CheckListSize(list, sub_unpackers.size());
+        py::list items(sub_unpackers.size());
+        for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+          items[i] = sub_unpackers[i](device, list, i);
+        }
+        if (is_tuple) return py::tuple(std::move(items));
+        return std::move(items);
+      };
+    } else if (compound_type.equal(kSdictTag)) {
+      // The descriptor is like:
+      //   ['sdict', ['key1', value1], ...]
+      std::vector<std::pair<py::object, UnpackCallback>> sub_unpackers(
+          py::len(desc) - 1);
+      for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+        py::object sub_desc = desc[py::int_(i + 1)];
+        sub_unpackers[i] = std::make_pair(
+            sub_desc[kZero], AbiTypeToUnpackCallback(sub_desc[kOne]));
+      }
+      return [sub_unpackers = std::move(sub_unpackers)](
+                 py::handle device, iree_vm_list_t *list) -> py::object {
+        CheckListSize(list, sub_unpackers.size());
+        py::dict items;
+        for (size_t i = 0; i < sub_unpackers.size(); ++i) {
+          items[sub_unpackers[i].first] =
+              sub_unpackers[i].second(device, list, i);
+        }
+        return std::move(items);
+      };
+    }
+    std::string message("cannot map VM type to Python: ");
+    message.append(py::cast<std::string>(py::repr(compound_type)));
+    throw std::invalid_argument(message);
+  }
+
   PackCallback GetGenericPackCallbackFor(py::handle arg) {
     PopulatePyTypeToPackCallbacks();
     py::type clazz = py::type::of(arg);
@@ -378,36 +605,78 @@ class InvokeStatics {
   }
 
  private:
+  // Returns the list stored in element |index| of |list|.
+  static iree_vm_list_t *GetSubList(iree_vm_list_t *list,
+                                    iree_host_size_t index) {
+    iree_vm_ref_t ref = {0};
+    CheckApiStatus(iree_vm_list_get_ref_assign(list, index, &ref),
+                   "could not access list element");
+    iree_vm_list_t *sub_list = nullptr;
+    CheckApiStatus(iree_vm_list_check_deref(ref, &sub_list),
+                   "expected a list result");
+    return sub_list;
+  }
+
+  static UnpackCallback MakeScalarUnpackCallback(bool is_float) {
+    return [is_float](py::handle device, iree_vm_list_t *list,
+                      iree_host_size_t index) -> py::object {
+      iree_vm_variant_t v = iree_vm_variant_empty();
+      CheckApiStatus(iree_vm_list_get_variant(list, index, &v),
+                     "could not access list element");
+      if (iree_vm_type_def_is_value(&v.type)) {
+        switch (v.type.value_type) {
+          case IREE_VM_VALUE_TYPE_I8:
+            if (!is_float) return py::int_(v.i8);
+            break;
+          case IREE_VM_VALUE_TYPE_I16:
+            if (!is_float) return py::int_(v.i16);
+            break;
+          case IREE_VM_VALUE_TYPE_I32:
+            if (!is_float) return py::int_(v.i32);
+            break;
+          case IREE_VM_VALUE_TYPE_I64:
+            if (!is_float) return py::int_(v.i64);
+            break;
+          case IREE_VM_VALUE_TYPE_F32:
+            if (is_float) return py::float_(v.f32);
+            break;
+          case IREE_VM_VALUE_TYPE_F64:
+            if (is_float) return py::float_(v.f64);
+            break;
+          default:
+            break;
+        }
+      }
+      throw std::invalid_argument(is_float ? "expected a float value"
+                                           : "expected an int value");
+    };
+  }
+
   PackCallback GetGenericPackCallbackForNdarray() {
     return [this](InvokeContext &c, iree_vm_list_t *list, py::handle py_value) {
       IREE_TRACE_SCOPE0("ArgumentPacker::GenericNdarray");
       py::object host_array;
-      try {
-        host_array = numpy_module().attr(kAsArray)(
-            py_value, /*dtype=*/py::none(), kContiguousArg);
-      } catch (std::exception &e) {
-        std::string msg("could not convert value to numpy array: ");
-        msg.append("error='");
-        msg.append(e.what());
-        msg.append("', value=");
-        msg.append(py::cast<std::string>(py::repr(py_value)));
-        throw std::invalid_argument(std::move(msg));
+      if (IsContiguousHostArray(py_value)) {
+        host_array = py::reinterpret_borrow<py::object>(py_value);
+      } else {
+        try {
+          host_array = numpy_module().attr(kAsArray)(
+              py_value, /*dtype=*/py::none(), kContiguousArg);
+        } catch (std::exception &e) {
+          std::string msg("could not convert value to numpy array: ");
+          msg.append("error='");
+          msg.append(e.what());
+          msg.append("', value=");
+          msg.append(py::cast<std::string>(py::repr(py_value)));
+          throw std::invalid_argument(std::move(msg));
+        }
       }
 
+      // Put it on the device.
       auto hal_element_type =
           MapDtypeToElementType(host_array.attr(kDtypeAttr));
-
-      // Put it on the device.
-      py::object retained_bv = c.allocator().AllocateBufferCopy(
-          IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
-          IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
-          host_array, hal_element_type);
-      HalBufferView *bv = py::cast<HalBufferView *>(retained_bv);
-
-      // TODO: If adding further manipulation here, please make this common
-      // with the reflection access case.
-      iree_vm_ref_t buffer_view_ref =
-          iree_hal_buffer_view_retain_ref(bv->raw_ptr());
+      iree_vm_ref_t buffer_view_ref = CopyHostArrayToDevice(
+          c, host_array, /*dtype=*/py::none(), hal_element_type);
       CheckApiStatus(iree_vm_list_push_ref_move(list, &buffer_view_ref),
                      "could not append value");
     };
@@ -692,6 +961,52 @@ class ArgumentPacker {
   bool dynamic_dispatch_ = false;
 };
 
+/// Object that converts the results of a specific function from a VM List to
+/// Python values as described by its reflection metadata.
+class ResultUnpacker {
+ public:
+  ResultUnpacker(InvokeStatics &statics, py::list ret_descs) {
+    IREE_TRACE_SCOPE0("ResultUnpacker::Init");
+    // Results described by a single slist/stuple/sdict are inlined with the
+    // function results rather than returned as a nested list.
+    if (py::len(ret_descs) == 1) {
+      py::handle desc = ret_descs[statics.kZero];
+      if (py::isinstance<py::list>(desc) && py::len(desc) > 0) {
+        py::object compound_type = desc[statics.kZero];
+        if (compound_type.equal(statics.kSlistTag) ||
+            compound_type.equal(statics.kStupleTag) ||
+            compound_type.equal(statics.kSdictTag)) {
+          inlined_unpacker_ = statics.AbiTypeToListUnpackCallback(desc);
+          return;
+        }
+      }
+    }
+    for (py::handle desc : ret_descs) {
+      unpackers_.push_back(statics.AbiTypeToUnpackCallback(desc));
+    }
+  }
+
+  /// Converts |results| to Python. Returns None if there are no results, the
+  /// value of a single result or a tuple of multiple results.
+  py::object Unpack(py::handle device, VmVariantList &results) {
+    IREE_TRACE_SCOPE0("ResultUnpacker::Unpack");
+    iree_vm_list_t *list = results.raw_ptr();
+    if (inlined_unpacker_) return inlined_unpacker_(device, list);
+    CheckListSize(list, unpackers_.size());
+    if (unpackers_.empty()) return py::none();
+    if (unpackers_.size() == 1) return unpackers_.front()(device, list, 0);
+    py::tuple values(unpackers_.size());
+    for (size_t i = 0; i < unpackers_.size(); ++i) {
+      values[i] = unpackers_[i](device, list, i);
+    }
+    return std::move(values);
+  }
+
+ private:
+  std::vector<UnpackCallback> unpackers_;
+  ListUnpackCallback inlined_unpacker_;
+};
+
 }  // namespace
 
 void SetupInvokeBindings(pybind11::module &m) {
@@ -700,6 +1015,10 @@ void SetupInvokeBindings(pybind11::module &m) {
   py::class_<ArgumentPacker>(m, "ArgumentPacker")
       .def(py::init<InvokeStatics &, std::optional<py::list>>())
       .def("pack", &ArgumentPacker::Pack);
+  py::class_<ResultUnpacker>(m, "ResultUnpacker")
+      .def(py::init<InvokeStatics &, py::list>())
+      .def("unpack", &ResultUnpacker::Unpack, py::arg("device"),
+           py::arg("results"));
 
   m.attr("_invoke_statics") = py::cast(InvokeStatics());
 }
@@ -23,6 +23,7 @@ from ._binding import (
     HalDevice,
     HalDriver,
     HalElementType,
+    HalFence,
     MemoryAccess,
     MemoryType,
     PyModuleInterface,
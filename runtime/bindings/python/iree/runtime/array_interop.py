@@ -5,23 +5,31 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 """BufferView and Python Array Protocol interop."""
 
-from typing import Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 import logging
+import threading
 import numpy as np
 import numpy.lib.mixins
 
 from ._binding import (
     BufferUsage,
+    HalBuffer,
     HalBufferView,
     HalDevice,
     HalElementType,
+    HalFence,
     MappedMemory,
     MemoryType,
+    Shape,
 )
 
 __all__ = [
     "asdevicearray",
     "DeviceArray",
+    "from_dlpack",
+    "get_host_staging_pool",
+    "HostStagingPool",
+    "load_safetensors",
 ]
 
 _DEVICE_HANDLED_FUNCTIONS = {}
@@ -37,6 +45,107 @@ def _device_implements(np_function):
   return decorator
 
 
+class HostStagingPool:
+  """Reusable host staging buffers used to read back device memory.
+
+  Device arrays whose memory cannot be mapped by the host are read back by
+  copying them into host local staging buffers on the device queue. Such
+  buffers are expensive to allocate (they are typically pinned), so released
+  ones are kept and reused for later readbacks of up to the same size. Sizes
+  are rounded up to a power of two so that buffers can be shared between
+  arrays of similar sizes.
+
+  Thread-safe.
+  """
+
+  # Smallest staging buffer allocated.
+  MIN_BUFFER_SIZE = 4096
+
+  def __init__(self, device: HalDevice, max_pooled_bytes: int = 256 << 20):
+    self._device = device
+    self.max_pooled_bytes = max_pooled_bytes
+    self._lock = threading.Lock()
+    self._free_buffers: Dict[int, List[HalBuffer]] = {}
+    self._pooled_bytes = 0
+
+  @property
+  def pooled_bytes(self) -> int:
+    """Total size of the released buffers kept for reuse."""
+    return self._pooled_bytes
+
+  def acquire(self, byte_length: int) -> HalBuffer:
+    """Returns a staging buffer of at least `byte_length` bytes."""
+    capacity = max(self.MIN_BUFFER_SIZE,
+                   1 << (max(byte_length, 1) - 1).bit_length())
+    with self._lock:
+      free_buffers = self._free_buffers.get(capacity)
+      if free_buffers:
+        self._pooled_bytes -= capacity
+        return free_buffers.pop()
+    return self._device.allocator.allocate_buffer(
+        memory_type=MemoryType.HOST_LOCAL | MemoryType.DEVICE_VISIBLE,
+        allowed_usage=BufferUsage.TRANSFER | BufferUsage.MAPPING,
+        allocation_size=capacity)
+
+  def release(self, buffer: HalBuffer):
+    """Returns a buffer from `acquire` to the pool once no longer in use."""
+    capacity = buffer.byte_length
+    with self._lock:
+      if self._pooled_bytes + capacity > self.max_pooled_bytes:
+        return
+      self._free_buffers.setdefault(capacity, []).append(buffer)
+      self._pooled_bytes += capacity
+
+  def trim(self):
+    """Releases all pooled buffers."""
+    with self._lock:
+      self._free_buffers.clear()
+      self._pooled_bytes = 0
+
+
+def get_host_staging_pool(device: HalDevice) -> HostStagingPool:
+  """Returns the staging pool used to read back arrays of `device`."""
+  pool = getattr(device, "_host_staging_pool", None)
+  if pool is None:
+    pool = HostStagingPool(device)
+    device._host_staging_pool = pool
+  return pool
+
+
+class _PendingReadback:
+  """A readback of a byte range of a buffer into a staging buffer."""
+  __slots__ = ["source", "staging", "byte_length", "fence", "pool"]
+
+  def __init__(self, pool: HostStagingPool, source: HalBuffer,
+               byte_offset: int, byte_length: int):
+    self.pool = pool
+    self.source = source
+    self.byte_length = byte_length
+    self.staging = pool.acquire(byte_length)
+    try:
+      self.fence = pool._device.queue_copy(source, byte_offset, self.staging,
+                                           0, byte_length)
+    except Exception:
+      pool.release(self.staging)
+      raise
+
+  def finish(self, dtype, shape) -> np.ndarray:
+    """Waits for the readback and returns a copy of the data."""
+    try:
+      self.fence.wait()
+      staging_view = self.staging.create_view(Shape([self.byte_length]), 1)
+      mapped_memory = staging_view.map()
+      host_array = np.array(mapped_memory.asarray([self.byte_length],
+                                                  np.uint8),
+                            copy=True).view(dtype).reshape(shape)
+      del mapped_memory
+      del staging_view
+    finally:
+      self.pool.release(self.staging)
+      self.staging = None
+    return host_array
+
+
 class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
   """An IREE device array.
 
@@ -58,6 +167,12 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
       implicit transfer back to the host will trigger appropriate waits and
       be performed automatically (this is the common case for function return
       values if not otherwise configured, as an example).
+
+  Arrays in memory that the host can map are accessed in place. Others are
+  read back by copying them to a pooled staging buffer (see HostStagingPool):
+  `prefetch_to_host` starts that copy early so that it overlaps with other
+  work, and indexing the leading dimension of an array that is still device
+  resident only reads back the selected rows.
   """
 
   def __init__(self,
@@ -73,6 +188,8 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
     # If the array is host accessible, these will be non-None.
     self._mapped_memory: Optional[MappedMemory] = None
     self._host_array: Optional[np.ndarray] = None
+    # Readback of the whole array started by prefetch_to_host.
+    self._pending_readback: Optional[_PendingReadback] = None
 
   def __array__(self, dtype=None):
     self._transfer_to_host(True)
@@ -93,6 +210,18 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
   def __repr__(self):
     return f"<IREE DeviceArray: shape={np.shape(self)}, dtype={self.dtype}>"
 
+  def __dlpack__(self, stream=None):
+    """Exports the array to DLPack without copies (see from_dlpack)."""
+    if self._override_dtype is not None and (self._override_dtype !=
+                                             self._get_raw_dtype()):
+      raise ValueError(
+          f"DeviceArray with dtype {self._override_dtype} stored as "
+          f"{self._get_raw_dtype()} cannot be exported to DLPack")
+    return self._buffer_view.__dlpack__(stream=stream)
+
+  def __dlpack_device__(self):
+    return self._buffer_view.__dlpack_device__()
+
   @property
   def is_host_accessible(self):
     """Whether this array is currently host accessible."""
@@ -102,6 +231,26 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
     self._transfer_to_host(False)
     return self._host_array
 
+  def prefetch_to_host(self) -> "DeviceArray":
+    """Starts transferring the array to the host without waiting for it.
+
+    The transfer is completed by the first access needing host data. This is
+    a no-op for arrays that are already host accessible or in memory the host
+    can map.
+    """
+    if (self._host_array is not None or self._pending_readback is not None or
+        self._is_mappable()):
+      return self
+    buffer = self._buffer_view.buffer
+    self._pending_readback = _PendingReadback(
+        get_host_staging_pool(self._device), buffer, 0, buffer.byte_length)
+    return self
+
+  def _is_mappable(self) -> bool:
+    buffer = self._buffer_view.buffer
+    return (bool(buffer.memory_type & int(MemoryType.HOST_VISIBLE)) and
+            bool(buffer.allowed_usage & int(BufferUsage.MAPPING)))
+
   def _transfer_to_host(self, implicit):
     if self._host_array is not None:
       return
@@ -111,18 +260,30 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
           "if necessary, do an explicit transfer via .to_host()")
     self._mapped_memory, self._host_array = self._map_to_host()
 
-  def _map_to_host(self) -> Tuple[MappedMemory, np.ndarray]:
+  def _map_to_host(self) -> Tuple[Optional[MappedMemory], np.ndarray]:
     # TODO: When synchronization is enabled, need to block here.
     raw_dtype = self._get_raw_dtype()
-    mapped_memory = self._buffer_view.map()
-    host_array = mapped_memory.asarray(self._buffer_view.shape, raw_dtype)
+    if self._pending_readback is None and self._is_mappable():
+      mapped_memory = self._buffer_view.map()
+      host_array = mapped_memory.asarray(self._buffer_view.shape, raw_dtype)
+    else:
+      # Read back through a staging buffer, reusing a prefetch if started.
+      self.prefetch_to_host()
+      readback = self._pending_readback
+      self._pending_readback = None
+      mapped_memory = None
+      host_array = readback.finish(raw_dtype, self._buffer_view.shape)
+    return mapped_memory, self._apply_override_dtype(host_array)
+
+  def _apply_override_dtype(self, host_array: np.ndarray) -> np.ndarray:
+    raw_dtype = self._get_raw_dtype()
     # Detect if we need to force an explicit conversion. This happens when
     # we were requested to pretend that the array is in a specific dtype,
     # even if that is not representable on the device. You guessed it:
     # this is to support bools.
     if self._override_dtype is not None and self._override_dtype != raw_dtype:
       host_array = host_array.astype(self._override_dtype)
-    return mapped_memory, host_array
+    return host_array
 
   def _get_raw_dtype(self):
     return HalElementType.map_to_dtype(self._buffer_view.element_type)
@@ -154,14 +315,66 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
     return host_ary.__iter__()
 
   def __getitem__(self, index):
+    if (self._host_array is None and self._pending_readback is None and
+        not self._is_mappable()):
+      # Only read back the selected rows of device resident arrays.
+      region = self._get_leading_region(index)
+      if region is not None:
+        start, stop, region_index = region
+        return self._read_rows(start, stop)[region_index]
     host_ary = self.to_host()
     return host_ary.__getitem__(index)
 
+  def _get_leading_region(self, index):
+    """Returns the (start, stop) rows selected by an index of the leading
+    dimension and the index to apply to them, or None if not contiguous."""
+    shape = self._buffer_view.shape
+    if not shape:
+      return None
+    if isinstance(index, tuple):
+      if not index:
+        return None
+      first, rest = index[0], index[1:]
+    else:
+      first, rest = index, ()
+    if isinstance(first, (int, np.integer)):
+      row = int(first)
+      if row < 0:
+        row += shape[0]
+      if row < 0 or row >= shape[0]:
+        raise IndexError(
+            f"index {first} is out of bounds for axis 0 with size {shape[0]}")
+      return row, row + 1, (0,) + rest
+    if isinstance(first, slice):
+      start, stop, step = first.indices(shape[0])
+      if step != 1:
+        return None
+      return start, max(start, stop), (slice(None),) + rest
+    return None
+
+  def _read_rows(self, start: int, stop: int) -> np.ndarray:
+    """Reads back rows [start, stop) of the leading dimension."""
+    shape = self._buffer_view.shape
+    raw_dtype = np.dtype(self._get_raw_dtype())
+    row_byte_length = (int(np.prod(shape[1:], dtype=np.int64)) *
+                       raw_dtype.itemsize)
+    region_shape = [stop - start] + list(shape[1:])
+    if start == stop or row_byte_length == 0:
+      return self._apply_override_dtype(np.empty(region_shape, raw_dtype))
+    readback = _PendingReadback(get_host_staging_pool(self._device),
+                                self._buffer_view.buffer,
+                                start * row_byte_length,
+                                (stop - start) * row_byte_length)
+    return self._apply_override_dtype(readback.finish(raw_dtype, region_shape))
+
   def __reduce__(self):
     # Since this is used for making deep copies and pickling, we map
     # separately from any interactive state. We just reduce to the actual
     # host ndarray, which supports the necessary serialization protocols.
-    _, host_array = self._map_to_host()
+    if self._host_array is not None:
+      host_array = self._host_array
+    else:
+      _, host_array = self._map_to_host()
     return _restore_reduced_array, (host_array,)
 
 
@@ -224,6 +437,68 @@ def asdevicearray(device: HalDevice,
                      override_dtype=a.dtype)
 
 
+def from_dlpack(device: HalDevice,
+                tensor,
+                *,
+                implicit_host_transfer: bool = False,
+                memory_type: Optional[MemoryType] = None,
+                allowed_usage=BufferUsage.DEFAULT) -> DeviceArray:
+  """Creates a DeviceArray aliasing the memory of a DLPack tensor.
+
+  `tensor` is any object implementing `__dlpack__` (such as numpy arrays and
+  PyTorch, CuPy and JAX tensors) or a DLPack capsule. No copies are made: CPU
+  tensors are imported as host allocations and CUDA tensors as device
+  allocations, which must have been allocated on the same CUDA device. The
+  tensor memory must be compact and row-major. The tensor is kept alive until
+  the returned array and anything using its buffer are released.
+
+  The opposite direction is available on DeviceArray and HalBufferView via
+  `__dlpack__`, so `np.from_dlpack(device_array)` or
+  `torch.from_dlpack(device_array)` alias the device memory.
+  """
+  buffer_view = device.allocator.from_dlpack(tensor,
+                                             memory_type=memory_type,
+                                             allowed_usage=allowed_usage)
+  return DeviceArray(device,
+                     buffer_view,
+                     implicit_host_transfer=implicit_host_transfer)
+
+
+def load_safetensors(device: HalDevice,
+                     path: str,
+                     names: Optional[List[str]] = None,
+                     *,
+                     implicit_host_transfer: bool = False,
+                     memory_type=MemoryType.DEVICE_LOCAL,
+                     allowed_usage=BufferUsage.DEFAULT,
+                     batch_size: int = 64 << 20) -> Dict[str, DeviceArray]:
+  """Loads the tensors of a safetensors file into device arrays by name.
+
+  The file is mapped rather than read and no copies are made in Python. Devices
+  that can use host memory directly alias the mapping. Otherwise tensors are
+  copied into device memory by asynchronous transfers submitted in batches of up
+  to `batch_size` bytes, which overlap with preparing the following tensors, so
+  loading takes time proportional to the transfer bandwidth. Only the tensors
+  in `names` are loaded if given.
+
+  Returns once all transfers have completed. Use `HalDevice.load_safetensors`
+  directly to get the fence signaled on completion instead of waiting.
+  """
+  buffer_views, ready_fence = device.load_safetensors(
+      path,
+      names=names,
+      memory_type=memory_type,
+      allowed_usage=allowed_usage,
+      batch_size=batch_size)
+  ready_fence.wait()
+  return {
+      name: DeviceArray(device,
+                        buffer_view,
+                        implicit_host_transfer=implicit_host_transfer)
+      for name, buffer_view in buffer_views.items()
+  }
+
+
 # NOTE: Numpy dtypes are not hashable and exist in a hierarchy that should
 # be queried via isinstance checks. This should be done as a fallback but
 # this is a linear list for quick access to the most common. There may also
@@ -7,6 +7,10 @@
 
 Provides convenient methods for invoking IREE's benchmarking tooling from
 python. This allows easy benchmarking results from within python.
+
+`benchmark_function` times a function in-process on its existing context and
+device and returns structured results, while `benchmark_module` runs the
+`iree-benchmark-module` tool in a subprocess.
 """
 
 # pylint: disable=protected-access
@@ -16,20 +20,184 @@ python. This allows easy benchmarking results from within python.
 # TODO(#4131) python>=3.7: Use postponed type annotations.
 
 from collections import namedtuple
+from typing import Dict, List, Optional
 
 import iree.runtime
 import numpy
 import os
 import subprocess
+import time
+
+from .function import FunctionInvoker
 
 __all__ = [
     "benchmark_exe",
+    "benchmark_function",
     "benchmark_module",
+    "FunctionBenchmarkResult",
 ]
 
 BenchmarkResult = namedtuple(
     "BenchmarkResult", "benchmark_name time cpu_time iterations user_counters")
 
+
+class FunctionBenchmarkResult:
+  """Results of timing a function in-process with `benchmark_function`.
+
+  Latencies are in seconds and cover the invocation of the function and the
+  wait for the completion of its device work, excluding the conversion of
+  arguments and results.
+  """
+
+  PERCENTILES = (50, 90, 95, 99)
+
+  def __init__(self, function_name: str, latencies: List[float],
+               wall_seconds: float, allocator_statistics: Dict[str, int]):
+    self.function_name = function_name
+    self.latencies = latencies
+    # Total time of the timed iterations including argument conversions.
+    self.wall_seconds = wall_seconds
+    # Changes of the device allocator statistics (see
+    # HalAllocator.statistics) over the timed iterations. Empty if the
+    # runtime was built without statistics.
+    self.allocator_statistics = allocator_statistics
+
+  @property
+  def iterations(self) -> int:
+    return len(self.latencies)
+
+  @property
+  def mean(self) -> float:
+    return float(numpy.mean(self.latencies))
+
+  @property
+  def stddev(self) -> float:
+    return float(numpy.std(self.latencies))
+
+  @property
+  def min(self) -> float:
+    return float(numpy.min(self.latencies))
+
+  @property
+  def max(self) -> float:
+    return float(numpy.max(self.latencies))
+
+  def percentile(self, q: float) -> float:
+    """Returns the `q`th percentile latency (0 <= q <= 100)."""
+    return float(numpy.percentile(self.latencies, q))
+
+  def to_dict(self) -> dict:
+    """Returns the summary of the results as a JSON serializable dict."""
+    summary = {
+        "function": self.function_name,
+        "iterations": self.iterations,
+        "wall_seconds": self.wall_seconds,
+        "mean_seconds": self.mean,
+        "stddev_seconds": self.stddev,
+        "min_seconds": self.min,
+        "max_seconds": self.max,
+    }
+    for q in self.PERCENTILES:
+      summary[f"p{q}_seconds"] = self.percentile(q)
+    summary["allocator_statistics"] = dict(self.allocator_statistics)
+    return summary
+
+  def __repr__(self):
+    percentiles = ", ".join(
+        f"p{q}={self.percentile(q) * 1e3:.3f}ms" for q in self.PERCENTILES)
+    return (f"<FunctionBenchmarkResult {self.function_name}: "
+            f"iterations={self.iterations}, mean={self.mean * 1e3:.3f}ms, "
+            f"{percentiles}>")
+
+
+def _diff_allocator_statistics(before: Dict[str, int],
+                               after: Dict[str, int]) -> Dict[str, int]:
+  statistics = {}
+  for key, value in after.items():
+    # Peaks are reported as-is while counters are reported as deltas.
+    if key.endswith("_peak"):
+      statistics[key] = value
+    else:
+      statistics[key] = value - before.get(key, 0)
+  return statistics
+
+
+def benchmark_function(function: FunctionInvoker,
+                       *args,
+                       iterations: Optional[int] = None,
+                       min_time_seconds: float = 0.5,
+                       max_iterations: int = 1000000,
+                       warmup_iterations: int = 1,
+                       profiling_mode: Optional[str] = None,
+                       **kwargs) -> FunctionBenchmarkResult:
+  """Times a function in-process on its existing context and device.
+
+  Args:
+    function: Function to benchmark, as returned by indexing a BoundModule
+      (such as `context.modules.module["main"]`).
+    *args: Arguments passed to each invocation of the function.
+    iterations: Number of timed iterations. If None, iterations run until
+      `min_time_seconds` have elapsed (and at most `max_iterations`).
+    min_time_seconds: Minimum time spent in timed iterations when `iterations`
+      is None.
+    max_iterations: Maximum number of timed iterations when `iterations` is
+      None.
+    warmup_iterations: Number of untimed iterations run first to exclude
+      one-time costs such as executable loading and pool growth.
+    profiling_mode: If set, device profiling (`HalDevice.begin_profiling`) is
+      enabled in this mode (`queue`, `dispatch` or `executable`) around the
+      timed iterations so that per-dispatch timing can be captured by the
+      device's profiling tools.
+    **kwargs: Keyword arguments passed to each invocation of the function.
+
+  Returns:
+    A FunctionBenchmarkResult.
+  """
+  if iterations is not None and iterations < 1:
+    raise ValueError(f"Expected at least one iteration (got {iterations})")
+
+  device = function._device
+
+  def run_iteration() -> float:
+    arg_list, ret_list = function._pack(args, kwargs)
+    start_time = time.perf_counter()
+    function._invoke_and_wait(arg_list, ret_list)
+    latency = time.perf_counter() - start_time
+    # Results are unpacked to include releasing them in each iteration but
+    # are outside of the measured latency.
+    function._unpack(ret_list, None)
+    return latency
+
+  for _ in range(warmup_iterations):
+    run_iteration()
+
+  allocator = device.allocator
+  statistics_before = allocator.statistics
+  if profiling_mode is not None:
+    device.begin_profiling(mode=profiling_mode)
+  latencies = []
+  wall_start_time = time.perf_counter()
+  try:
+    if iterations is not None:
+      for _ in range(iterations):
+        latencies.append(run_iteration())
+    else:
+      deadline = wall_start_time + min_time_seconds
+      while not latencies or (time.perf_counter() < deadline and
+                              len(latencies) < max_iterations):
+        latencies.append(run_iteration())
+  finally:
+    if profiling_mode is not None:
+      device.end_profiling()
+  wall_seconds = time.perf_counter() - wall_start_time
+  allocator_statistics = _diff_allocator_statistics(statistics_before,
+                                                    allocator.statistics)
+
+  return FunctionBenchmarkResult(function_name=repr(function),
+                                 latencies=latencies,
+                                 wall_seconds=wall_seconds,
+                                 allocator_statistics=allocator_statistics)
+
 DTYPE_TO_ABI_TYPE = {
     numpy.dtype(numpy.float32): "f32",
     numpy.dtype(numpy.int32): "i32",
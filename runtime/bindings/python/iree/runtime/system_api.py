@@ -28,6 +28,7 @@ __all__ = [
 ]
 
 import logging
+import mmap
 import os
 import sys
 
@@ -159,9 +160,9 @@ class BoundModule:
       raise AttributeError(name)
 
   def __getitem__(self, name):
-    vm_function = self._lazy_functions.get(name)
-    if vm_function is not None:
-      return vm_function
+    invoker = self._lazy_functions.get(name)
+    if invoker is not None:
+      return invoker
 
     vm_function = self._vm_module.lookup_function(name)
     if vm_function is None:
@@ -170,9 +171,11 @@ class BoundModule:
     # TODO: Needing to know the precise device to allocate on here is bad
     # layering and will need to be fixed in some fashion if/when doing
     # heterogenous dispatch.
-    return FunctionInvoker(self._context.vm_context,
-                           self._context.config.device, vm_function,
-                           self._context._tracer)
+    invoker = FunctionInvoker(self._context.vm_context,
+                              self._context.config.device, vm_function,
+                              self._context._tracer)
+    self._lazy_functions[name] = invoker
+    return invoker
 
   def __repr__(self):
     return f"<BoundModule {repr(self._vm_module)}>"
@@ -290,16 +293,17 @@ def load_vm_flatbuffer(vm_flatbuffer: bytes,
   return bound_module
 
 
-# TODO: There should be an API for mmap'ing the file which should be used
-# instead of reading into memory.
 def load_vm_flatbuffer_file(path: str,
                             *,
                             driver: Optional[str] = None,
                             backend: Optional[str] = None) -> BoundModule:
   """Loads a file containing a VM Flatbuffer into a callable module.
 
+  The file is memory mapped read-only so that its contents are paged in lazily
+  and shared across processes; it must not be modified while loaded.
+
   Either 'driver' or 'backend' must be specified.
   """
   with open(path, "rb") as f:
-    vm_flatbuffer = f.read()
+    vm_flatbuffer = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
   return load_vm_flatbuffer(vm_flatbuffer, driver=driver, backend=backend)
@@ -6,7 +6,11 @@
 
 import copy
 import gc
+import json
 import numpy as np
+import os
+import struct
+import tempfile
 import unittest
 
 import iree.runtime
@@ -163,6 +167,133 @@ class DeviceHalTest(unittest.TestCase):
     self.assertEqual(repr(ary), "<IREE DeviceArray: shape=[3, 4], dtype=bool>")
     np.testing.assert_array_equal(ary.to_host(), init_ary)
 
+  def testToDLPack(self):
+    init_ary = np.arange(12, dtype=np.float32).reshape([3, 4])
+    ary = iree.runtime.asdevicearray(self.device, init_ary)
+    self.assertEqual(ary.__dlpack_device__(), (1, 0))
+    host_ary = np.from_dlpack(ary)
+    self.assertEqual(host_ary.shape, (3, 4))
+    self.assertEqual(host_ary.dtype, np.float32)
+    np.testing.assert_array_equal(host_ary, init_ary)
+
+  def testFromDLPack(self):
+    init_ary = np.arange(12, dtype=np.int32).reshape([3, 4])
+    ary = iree.runtime.from_dlpack(self.device, init_ary)
+    self.assertEqual(ary.shape, [3, 4])
+    self.assertEqual(ary.dtype, np.int32)
+    np.testing.assert_array_equal(ary.to_host(), init_ary)
+    # The imported buffer aliases the numpy memory.
+    init_ary[1, 2] = 42
+    self.assertEqual(ary.to_host()[1, 2], 42)
+
+  def testFromDLPackKeepsProducerAlive(self):
+    ary = iree.runtime.from_dlpack(self.device,
+                                   np.zeros([8], dtype=np.float32) + 3)
+    gc.collect()
+    np.testing.assert_array_equal(ary.to_host(), np.zeros([8]) + 3)
+
+  def testFromDLPackNonContiguous(self):
+    init_ary = np.zeros([4, 4], dtype=np.float32)[:, ::2]
+    with self.assertRaises(ValueError):
+      _ = iree.runtime.from_dlpack(self.device, init_ary)
+
+  def _create_unmappable_array(self, init_ary):
+    return iree.runtime.asdevicearray(
+        self.device,
+        init_ary,
+        allowed_usage=(iree.runtime.BufferUsage.TRANSFER |
+                       iree.runtime.BufferUsage.DISPATCH_STORAGE))
+
+  def testStagedHostTransfer(self):
+    init_ary = np.arange(12, dtype=np.float32).reshape([3, 4])
+    ary = self._create_unmappable_array(init_ary)
+    np.testing.assert_array_equal(ary.to_host(), init_ary)
+    self.assertTrue(ary.is_host_accessible)
+
+  def testPrefetchToHost(self):
+    init_ary = np.arange(12, dtype=np.int32).reshape([3, 4])
+    ary = self._create_unmappable_array(init_ary)
+    self.assertIs(ary.prefetch_to_host(), ary)
+    self.assertFalse(ary.is_host_accessible)
+    np.testing.assert_array_equal(ary.to_host(), init_ary)
+
+  def testPartialReadback(self):
+    init_ary = np.arange(24, dtype=np.int32).reshape([6, 4])
+    ary = self._create_unmappable_array(init_ary)
+    np.testing.assert_array_equal(ary[2], init_ary[2])
+    np.testing.assert_array_equal(ary[-1], init_ary[-1])
+    np.testing.assert_array_equal(ary[1:4], init_ary[1:4])
+    np.testing.assert_array_equal(ary[1:4, 2], init_ary[1:4, 2])
+    np.testing.assert_array_equal(ary[::2], init_ary[::2])
+    self.assertEqual(ary[5:2].shape, (0, 4))
+    with self.assertRaises(IndexError):
+      _ = ary[6]
+    # Partial reads do not transfer the whole array.
+    self.assertFalse(ary.is_host_accessible)
+
+  def testPartialReadbackBool(self):
+    init_ary = np.zeros([3, 4], dtype=np.bool_)
+    init_ary[1] = True
+    ary = self._create_unmappable_array(init_ary)
+    self.assertEqual(ary[1].dtype, np.bool_)
+    np.testing.assert_array_equal(ary[1], init_ary[1])
+
+  def testLoadSafetensors(self):
+    weight = np.arange(6, dtype=np.float32).reshape(2, 3)
+    bias = np.array([-1, 0, 1, 2], dtype=np.int8)
+    header = json.dumps({
+        "__metadata__": {
+            "format": "pt"
+        },
+        "weight": {
+            "dtype": "F32",
+            "shape": [2, 3],
+            "data_offsets": [0, weight.nbytes]
+        },
+        "bias": {
+            "dtype": "I8",
+            "shape": [4],
+            "data_offsets": [weight.nbytes, weight.nbytes + bias.nbytes]
+        },
+    }).encode("utf-8")
+    header += b" " * (-len(header) % 8)
+    with tempfile.TemporaryDirectory() as tmpdir:
+      path = os.path.join(tmpdir, "weights.safetensors")
+      with open(path, "wb") as f:
+        f.write(struct.pack("<Q", len(header)))
+        f.write(header)
+        f.write(weight.tobytes())
+        f.write(bias.tobytes())
+
+      arrays = iree.runtime.load_safetensors(self.device, path)
+      self.assertEqual(sorted(arrays.keys()), ["bias", "weight"])
+      np.testing.assert_array_equal(arrays["weight"].to_host(), weight)
+      np.testing.assert_array_equal(arrays["bias"].to_host(), bias)
+
+      arrays = iree.runtime.load_safetensors(self.device, path, ["bias"])
+      self.assertEqual(list(arrays.keys()), ["bias"])
+
+      with self.assertRaises(ValueError):
+        iree.runtime.load_safetensors(self.device, path, [])
+
+  def testHostStagingPoolReuse(self):
+    pool = iree.runtime.get_host_staging_pool(self.device)
+    self.assertIs(pool, iree.runtime.get_host_staging_pool(self.device))
+    pool.trim()
+    buffer = pool.acquire(100)
+    self.assertEqual(buffer.byte_length, pool.MIN_BUFFER_SIZE)
+    pool.release(buffer)
+    self.assertEqual(pool.pooled_bytes, pool.MIN_BUFFER_SIZE)
+    self.assertIs(pool.acquire(200), buffer)
+    self.assertEqual(pool.pooled_bytes, 0)
+
+  def testHostStagingPoolLimit(self):
+    pool = iree.runtime.HostStagingPool(self.device, max_pooled_bytes=4096)
+    buffer = pool.acquire(5000)
+    self.assertEqual(buffer.byte_length, 8192)
+    pool.release(buffer)
+    self.assertEqual(pool.pooled_bytes, 0)
+
 
 if __name__ == "__main__":
   unittest.main()
@@ -0,0 +1,97 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import json
+import time
+import unittest
+
+from iree import runtime as rt
+from iree.runtime.function import FunctionInvoker
+
+
+class MockVmContext:
+
+  def __init__(self, invoke_callback):
+    self._invoke_callback = invoke_callback
+    self.invocation_count = 0
+
+  def invoke(self, vm_function, arg_list, ret_list):
+    self._invoke_callback(arg_list, ret_list)
+    self.invocation_count += 1
+
+  def invoke_async(self, vm_function, arg_list, ret_list, device):
+    self.invoke(vm_function, arg_list, ret_list)
+    return None
+
+
+class MockVmFunction:
+
+  def __init__(self, reflection):
+    self.reflection = reflection
+
+
+class BenchmarkFunctionTest(unittest.TestCase):
+
+  @classmethod
+  def setUpClass(cls):
+    config = rt.Config("local-task")
+    cls.device = config.device
+
+  def _create_invoker(self, invoke):
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={
+        "iree.abi": json.dumps({
+            "a": ["i32"],
+            "r": ["i32"],
+        })
+    })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    return vm_context, invoker
+
+  def testFixedIterations(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(arg_list.get_variant(0) + 1)
+
+    vm_context, invoker = self._create_invoker(invoke)
+    result = rt.benchmark_function(invoker,
+                                   1,
+                                   iterations=10,
+                                   warmup_iterations=2)
+    self.assertEqual(result.iterations, 10)
+    self.assertEqual(vm_context.invocation_count, 12)
+    self.assertLessEqual(result.min, result.percentile(50))
+    self.assertLessEqual(result.percentile(50), result.max)
+    self.assertGreaterEqual(result.wall_seconds, sum(result.latencies))
+    summary = result.to_dict()
+    self.assertEqual(summary["iterations"], 10)
+    self.assertIn("p99_seconds", summary)
+    self.assertIsInstance(summary["allocator_statistics"], dict)
+    json.dumps(summary)
+
+  def testMinTime(self):
+
+    def invoke(arg_list, ret_list):
+      time.sleep(0.001)
+      ret_list.push_int(0)
+
+    _, invoker = self._create_invoker(invoke)
+    result = rt.benchmark_function(invoker,
+                                   1,
+                                   min_time_seconds=0.02,
+                                   warmup_iterations=0)
+    self.assertGreater(result.iterations, 1)
+    self.assertGreaterEqual(result.wall_seconds, 0.02)
+    self.assertGreaterEqual(result.min, 0.001)
+
+  def testInvalidIterations(self):
+    _, invoker = self._create_invoker(lambda arg_list, ret_list: None)
+    with self.assertRaises(ValueError):
+      rt.benchmark_function(invoker, 1, iterations=0)
+
+
+if __name__ == "__main__":
+  unittest.main()
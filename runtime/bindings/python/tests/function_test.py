@@ -4,6 +4,7 @@
 # See https://llvm.org/LICENSE.txt for license information.
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+import asyncio
 import json
 import numpy as np
 import unittest
@@ -28,6 +29,10 @@ class MockVmContext:
     self.invocations.append((vm_function, arg_list, ret_list))
     print(f"INVOKE: {arg_list} -> {ret_list}")
 
+  def invoke_async(self, vm_function, arg_list, ret_list, device):
+    self.invoke(vm_function, arg_list, ret_list)
+    return None
+
   @property
   def mock_arg_reprs(self):
     return repr([arg_list for _, arg_list, _ in self.invocations])
@@ -398,6 +403,53 @@ class FunctionTest(unittest.TestCase):
     self.assertEqual("<VmVariantList(1): [HalBufferView(2:0x20000011)]>",
                      repr(invoked_arg_list))
 
+  def testNdarrayArgConversions(self):
+    # Strided and differently typed arrays are converted before the copy.
+    arg_arrays = [
+        np.asarray([1, 7, 0, 7], dtype=np.int32)[::2],
+        np.asarray([1, 0], dtype=np.int64),
+        [1, 0],
+    ]
+
+    invoked_arg_list = None
+
+    def invoke(arg_list, ret_list):
+      nonlocal invoked_arg_list
+      invoked_arg_list = arg_list
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={
+        "iree.abi": json.dumps({
+            "a": [["ndarray", "i32", 1, 2]],
+            "r": [],
+        })
+    })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    for arg_array in arg_arrays:
+      invoker(arg_array)
+      self.assertEqual("<VmVariantList(1): [HalBufferView(2:0x20000011)]>",
+                       repr(invoked_arg_list))
+      np.testing.assert_array_equal(
+          rt.DeviceArray(self.device,
+                         invoked_arg_list.get_as_object(0, rt.HalBufferView),
+                         implicit_host_transfer=True), [1, 0])
+
+  def testReturnArityMismatch(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(3)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={
+        "iree.abi": json.dumps({
+            "a": [],
+            "r": ["i32", "i32"],
+        })
+    })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    with self.assertRaisesRegex(ValueError, "mismatched return arity"):
+      invoker()
+
   def testDeviceArrayArg(self):
     # Note that since the device array is set up to disallow implicit host
     # transfers, this also verifies that no accidental/automatic transfers
@@ -589,6 +641,40 @@ class FunctionTest(unittest.TestCase):
     result = invoker()
     self.assertEqual("[1, 2]", repr(result))
 
+  def testInvokeAsync(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(3)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(
+        reflection={
+            "iree.abi":
+                json.dumps({
+                    "a": ["i32", ["named", "a", "i32"]],
+                    "r": ["i32",],
+                })
+        })
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    result = asyncio.run(invoker.invoke_async(-1, a=1))
+    self.assertEqual("[<VmVariantList(2): [-1, 1]>]",
+                     vm_context.mock_arg_reprs)
+    self.assertEqual(3, result)
+
+  def testAbiParsedOnce(self):
+    reflection = {
+        "iree.abi": json.dumps({
+            "a": ["i32", "i32"],
+            "r": ["i32",],
+        })
+    }
+    vm_context = MockVmContext(lambda arg_list, ret_list: None)
+    invoker0 = FunctionInvoker(vm_context, self.device,
+                               MockVmFunction(reflection), tracer=None)
+    invoker1 = FunctionInvoker(vm_context, self.device,
+                               MockVmFunction(reflection), tracer=None)
+    self.assertIs(invoker0._abi, invoker1._abi)
+
 
 if __name__ == "__main__":
   unittest.main()
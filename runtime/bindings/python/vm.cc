@@ -6,6 +6,7 @@
 
 #include "./vm.h"
 
+#include "./hal.h"
 #include "./status_utils.h"
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
@@ -125,6 +126,63 @@ void VmContext::Invoke(iree_vm_function_t f, VmVariantList& inputs,
   CheckApiStatus(status, "Error invoking function");
 }
 
+// Appends the (wait, signal) fence pair of the coarse-fences ABI to |inputs|.
+// The invocation does not wait and the signal fence is a 0->1 transition on a
+// new semaphore returned in |out_signal_fence|.
+static iree_status_t AppendAsyncFenceInputs(
+    iree_vm_list_t* inputs, iree_hal_device_t* device,
+    iree_hal_fence_t** out_signal_fence) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(device, 0ull, &semaphore));
+  iree_hal_fence_t* signal_fence = NULL;
+  iree_status_t status = iree_hal_fence_create_at(
+      semaphore, 1ull, iree_hal_device_host_allocator(device), &signal_fence);
+  iree_hal_semaphore_release(semaphore);
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t wait_fence_ref = iree_vm_ref_null();
+    status = iree_vm_list_push_ref_move(inputs, &wait_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(inputs, &signal_fence_ref);
+    iree_vm_ref_release(&signal_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_signal_fence = signal_fence;
+  } else {
+    iree_hal_fence_release(signal_fence);
+  }
+  return status;
+}
+
+py::object VmContext::InvokeAsync(iree_vm_function_t f, VmVariantList& inputs,
+                                  VmVariantList& outputs, HalDevice& device) {
+  iree_string_view_t model =
+      iree_vm_function_lookup_attr_by_name(&f, IREE_SV("iree.abi.model"));
+  bool is_async = iree_string_view_equal(model, IREE_SV("coarse-fences"));
+  iree_hal_fence_t* signal_fence = NULL;
+  iree_status_t status = iree_ok_status();
+  {
+    py::gil_scoped_release release;
+    if (is_async) {
+      status = AppendAsyncFenceInputs(inputs.raw_ptr(), device.raw_ptr(),
+                                      &signal_fence);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invoke(raw_ptr(), f, IREE_VM_INVOCATION_FLAG_NONE,
+                              nullptr, inputs.raw_ptr(), outputs.raw_ptr(),
+                              iree_allocator_system());
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_fence_release(signal_fence);
+    CheckApiStatus(status, "Error invoking function");
+  }
+  if (!signal_fence) return py::none();
+  return py::cast(HalFence::StealFromRawPtr(signal_fence),
+                  py::return_value_policy::move);
+}
+
 //------------------------------------------------------------------------------
 // VmModule
 //------------------------------------------------------------------------------
@@ -626,7 +684,9 @@ void SetupVmBindings(pybind11::module m) {
            py::arg("modules") = std::optional<std::vector<VmModule*>>())
       .def("register_modules", &VmContext::RegisterModules)
       .def_property_readonly("context_id", &VmContext::context_id)
-      .def("invoke", &VmContext::Invoke);
+      .def("invoke", &VmContext::Invoke)
+      .def("invoke_async", &VmContext::InvokeAsync, py::arg("function"),
+           py::arg("inputs"), py::arg("outputs"), py::arg("device"));
 
   py::class_<VmModule>(m, "VmModule")
       .def_static("from_flatbuffer", &VmModule::FromFlatbufferBlob)
@@ -19,6 +19,7 @@ namespace iree {
 namespace python {
 
 class FunctionAbi;
+class HalDevice;
 
 //------------------------------------------------------------------------------
 // Retain/release bindings
@@ -168,6 +169,14 @@ class VmContext : public ApiRefCounted<VmContext, iree_vm_context_t> {
   // Synchronously invokes the given function.
   void Invoke(iree_vm_function_t f, VmVariantList& inputs,
               VmVariantList& outputs);
+
+  // Invokes the given function without holding the GIL and returns a HalFence
+  // signaled when its results are ready. Functions using the coarse-fences
+  // ABI have a (wait, signal) fence pair allocated on |device| appended to
+  // |inputs| and return as soon as their work is queued. Other functions
+  // complete before returning and None is returned.
+  py::object InvokeAsync(iree_vm_function_t f, VmVariantList& inputs,
+                         VmVariantList& outputs, HalDevice& device);
 };
 
 class VmInvocation : public ApiRefCounted<VmInvocation, iree_vm_invocation_t> {
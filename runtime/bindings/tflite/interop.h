@@ -0,0 +1,64 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BINDINGS_TFLITE_INTEROP_H_
+#define IREE_BINDINGS_TFLITE_INTEROP_H_
+
+#include "iree/hal/api.h"
+
+// NOTE: we pull in our own copy here in case the tflite API changes upstream.
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// IREE HAL interop
+//===----------------------------------------------------------------------===//
+// Extensions to the tflite API exposing the HAL buffers backing tensors. These
+// fill the role of delegate buffer handles in tflite: buffers produced on the
+// device (camera frames, results of other IREE programs, etc) can be bound
+// directly as interpreter inputs without round-tripping through the host.
+//
+// Tensors allocated by the interpreter are host-visible and mapped for their
+// lifetime: writing inputs through TfLiteTensorData and reading outputs
+// through it performs no copies. Tensors backed by buffers the host cannot map
+// return NULL from TfLiteTensorData and are transferred through the device by
+// TfLiteTensorCopyFromBuffer/TfLiteTensorCopyToBuffer.
+
+// Returns the HAL device the interpreter executes on. Buffers bound to the
+// interpreter must be allocated from or imported into its allocator.
+// The device remains valid for the lifetime of the interpreter.
+TFL_CAPI_EXPORT extern iree_hal_device_t* iree_tflite_interpreter_device(
+    const TfLiteInterpreter* interpreter);
+
+// Returns the HAL buffer backing |tensor| or NULL if not yet allocated.
+// The buffer is owned by the tensor and remains valid until the next call to
+// TfLiteInterpreterAllocateTensors or TfLiteInterpreterInvoke (for outputs);
+// retain it to use it beyond that.
+TFL_CAPI_EXPORT extern iree_hal_buffer_t* iree_tflite_tensor_buffer(
+    const TfLiteTensor* tensor);
+
+// Binds |buffer| as the storage of the input tensor at |input_index| in place
+// of the buffer allocated by the interpreter. The buffer is retained and used
+// by all following invocations until another buffer is bound. Passing NULL
+// unbinds the buffer and the interpreter allocates its own on the next call to
+// TfLiteInterpreterAllocateTensors.
+//
+// Must be called after TfLiteInterpreterAllocateTensors and the buffer must
+// have the size of the tensor with its current shape (see
+// TfLiteTensorByteSize). Resizing the input to a shape of a different size
+// fails allocation until a buffer of the new size is bound.
+TFL_CAPI_EXPORT extern TfLiteStatus iree_tflite_interpreter_bind_input_buffer(
+    TfLiteInterpreter* interpreter, int32_t input_index,
+    iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BINDINGS_TFLITE_INTEROP_H_
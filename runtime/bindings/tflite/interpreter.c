@@ -7,64 +7,189 @@
 #include "runtime/bindings/tflite/interpreter.h"
 
 #include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
-#include "iree/hal/drivers/init.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/loaders/registration/init.h"
 #include "iree/modules/hal/module.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+#include "runtime/bindings/tflite/interop.h"
 #include "runtime/bindings/tflite/model.h"
 #include "runtime/bindings/tflite/shim.h"
 #include "runtime/bindings/tflite/tensor.h"
 
 //===----------------------------------------------------------------------===//
-// HAL / driver support
+// HAL device support
 //===----------------------------------------------------------------------===//
+// Interpreters run on local-task devices that are shared process-wide: all
+// interpreters created with the same TfLiteInterpreterOptionsSetNumThreads
+// value share one device and its task executor so that applications running
+// several models do not spin up a set of worker threads (and pools and loaded
+// executables) per model and oversubscribe the cores. Devices are created on
+// first use and released when the last interpreter using them is deleted.
 
-static iree_once_flag _TfLiteInterpreterRegisterDriverFlag =
-    IREE_ONCE_FLAG_INIT;
-static void _TfLiteInterpreterRegisterDrivers(void) {
-  IREE_IGNORE_ERROR(iree_hal_register_all_available_drivers(
-      iree_hal_driver_registry_default()));
+// Maximum number of distinct thread counts in use at a time. Applications
+// should generally use a single one across all interpreters.
+#define IREE_BINDINGS_TFLITE_MAX_SHARED_DEVICES 8
+
+typedef struct {
+  // Thread count requested by the interpreter options (-1 for default).
+  int32_t num_threads;
+  // Number of interpreters using the device.
+  iree_host_size_t use_count;
+  iree_hal_device_t* device;
+} _TfLiteSharedDevice;
+
+static struct {
+  iree_slim_mutex_t mutex;
+  iree_host_size_t count;
+  _TfLiteSharedDevice devices[IREE_BINDINGS_TFLITE_MAX_SHARED_DEVICES];
+} _TfLiteSharedDevices;
+
+static iree_once_flag _TfLiteSharedDevicesInitFlag = IREE_ONCE_FLAG_INIT;
+static void _TfLiteSharedDevicesInitialize(void) {
+  iree_slim_mutex_initialize(&_TfLiteSharedDevices.mutex);
+}
+
+// Initializes |out_topology| for the tflite |num_threads| option.
+// As in tflite -1 lets the implementation decide (we use one worker per
+// physical core) and any other value is the maximum number of threads.
+static void _TfLiteInitializeTopology(int32_t num_threads,
+                                      iree_task_topology_t* out_topology) {
+  iree_host_size_t max_core_count = IREE_TASK_EXECUTOR_MAX_WORKER_COUNT;
+  if (num_threads != -1) {
+    max_core_count = (iree_host_size_t)iree_max(1, num_threads);
+  }
+  iree_task_topology_initialize_from_physical_cores(
+      IREE_TASK_TOPOLOGY_NODE_ID_ANY, max_core_count, out_topology);
+}
+
+// Creates a new local-task device with an executor for |num_threads|.
+static iree_status_t _TfLiteCreateDevice(int32_t num_threads,
+                                         iree_allocator_t host_allocator,
+                                         iree_hal_device_t** out_device) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, num_threads);
+
+  iree_task_topology_t topology;
+  _TfLiteInitializeTopology(num_threads, &topology);
+  iree_task_executor_options_t executor_options;
+  iree_task_executor_options_initialize(&executor_options);
+  iree_task_executor_t* executor = NULL;
+  iree_status_t status = iree_task_executor_create(
+      executor_options, &topology, host_allocator, &executor);
+  iree_task_topology_deinitialize(&topology);
+
+  // Create all executable loaders linked into the binary.
+  iree_hal_executable_loader_t* loaders[8] = {NULL};
+  iree_host_size_t loader_count = 0;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_create_all_available_executable_loaders(
+        iree_hal_executable_import_provider_default(), IREE_ARRAYSIZE(loaders),
+        &loader_count, loaders, host_allocator);
+  }
+
+  iree_hal_allocator_t* device_allocator = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_allocator_create_heap(iree_make_cstring_view("local"),
+                                            host_allocator, host_allocator,
+                                            &device_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    status = iree_hal_task_device_create(
+        iree_make_cstring_view("local-task"), &params, /*queue_count=*/1,
+        &executor, loader_count, loaders, device_allocator, host_allocator,
+        out_device);
+  }
+
+  iree_hal_allocator_release(device_allocator);
+  for (iree_host_size_t i = 0; i < loader_count; ++i) {
+    iree_hal_executable_loader_release(loaders[i]);
+  }
+  iree_task_executor_release(executor);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Acquires the shared device for |num_threads|, creating it if needed.
+// Must be released with _TfLiteReleaseSharedDevice.
+static iree_status_t _TfLiteAcquireSharedDevice(
+    int32_t num_threads, iree_hal_device_t** out_device) {
+  *out_device = NULL;
+  iree_call_once(&_TfLiteSharedDevicesInitFlag,
+                 _TfLiteSharedDevicesInitialize);
+  if (num_threads != -1 && num_threads < 1) num_threads = 1;
+
+  iree_slim_mutex_lock(&_TfLiteSharedDevices.mutex);
+  iree_status_t status = iree_ok_status();
+  _TfLiteSharedDevice* shared_device = NULL;
+  for (iree_host_size_t i = 0; i < _TfLiteSharedDevices.count; ++i) {
+    if (_TfLiteSharedDevices.devices[i].num_threads == num_threads) {
+      shared_device = &_TfLiteSharedDevices.devices[i];
+      break;
+    }
+  }
+  if (!shared_device) {
+    if (_TfLiteSharedDevices.count ==
+        IREE_ARRAYSIZE(_TfLiteSharedDevices.devices)) {
+      status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                "too many distinct thread counts in use by "
+                                "interpreters (max %d)",
+                                IREE_BINDINGS_TFLITE_MAX_SHARED_DEVICES);
+    } else {
+      iree_hal_device_t* device = NULL;
+      status = _TfLiteCreateDevice(num_threads, iree_allocator_system(),
+                                   &device);
+      if (iree_status_is_ok(status)) {
+        shared_device =
+            &_TfLiteSharedDevices.devices[_TfLiteSharedDevices.count++];
+        shared_device->num_threads = num_threads;
+        shared_device->use_count = 0;
+        shared_device->device = device;
+      }
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    ++shared_device->use_count;
+    *out_device = shared_device->device;
+    iree_hal_device_retain(*out_device);
+  }
+  iree_slim_mutex_unlock(&_TfLiteSharedDevices.mutex);
+  return status;
+}
+
+// Releases a device acquired with _TfLiteAcquireSharedDevice. The device (and
+// its worker threads) are destroyed once no interpreter uses it.
+static void _TfLiteReleaseSharedDevice(iree_hal_device_t* device) {
+  if (!device) return;
+  iree_slim_mutex_lock(&_TfLiteSharedDevices.mutex);
+  for (iree_host_size_t i = 0; i < _TfLiteSharedDevices.count; ++i) {
+    _TfLiteSharedDevice* shared_device = &_TfLiteSharedDevices.devices[i];
+    if (shared_device->device != device) continue;
+    if (--shared_device->use_count == 0) {
+      iree_hal_device_release(shared_device->device);
+      _TfLiteSharedDevices.devices[i] =
+          _TfLiteSharedDevices.devices[--_TfLiteSharedDevices.count];
+    }
+    break;
+  }
+  iree_slim_mutex_unlock(&_TfLiteSharedDevices.mutex);
+  iree_hal_device_release(device);
 }
 
 // TODO(#3977): if already provided a HAL device in the options use that.
 static iree_status_t _TfLiteInterpreterPrepareHAL(
     TfLiteInterpreter* interpreter) {
-  iree_call_once(&_TfLiteInterpreterRegisterDriverFlag,
-                 _TfLiteInterpreterRegisterDrivers);
-
-  iree_hal_driver_registry_t* driver_registry =
-      iree_hal_driver_registry_default();
-
-  iree_host_size_t driver_info_count = 0;
-  iree_hal_driver_info_t* driver_infos = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_driver_registry_enumerate(
-      driver_registry, interpreter->allocator, &driver_info_count,
-      &driver_infos));
-
-  // TODO(benvanik): figure out how we want to emulate device selection; may
-  // just say "whatever is first" on a query.
-  // iree_string_view_t driver_name = driver_infos[0].driver_name;
-  // NOTE: currently the sample file is compiled only with vmvx.
-  iree_string_view_t driver_name = iree_make_cstring_view("local-task");
-
-  // TODO(benvanik): switch to iree_hal_driver_registry_try_create when
-  // implemented.
-  iree_status_t status = iree_hal_driver_registry_try_create(
-      driver_registry, driver_name, interpreter->allocator,
-      &interpreter->driver);
-  iree_allocator_free(interpreter->allocator, driver_infos);
-  IREE_RETURN_IF_ERROR(status, "failed to create driver '%.*s'",
-                       (int)driver_name.size, driver_name.data);
-
-  IREE_RETURN_IF_ERROR(
-      iree_hal_driver_create_default_device(
-          interpreter->driver, interpreter->allocator, &interpreter->device),
-      "failed creating the default device for driver '%.*s'",
-      (int)driver_name.size, driver_name.data);
-
+  IREE_RETURN_IF_ERROR(_TfLiteAcquireSharedDevice(
+      interpreter->options.num_threads, &interpreter->device));
   IREE_RETURN_IF_ERROR(iree_hal_module_create(
       interpreter->instance, interpreter->device, IREE_HAL_MODULE_FLAG_NONE,
       interpreter->allocator, &interpreter->hal_module));
-
   return iree_ok_status();
 }
 
@@ -222,6 +347,119 @@ static iree_status_t _TfLiteInterpreterRefreshIOShapes(
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// Shape-keyed I/O cache
+//===----------------------------------------------------------------------===//
+
+static void _TfLiteShapeFromTensor(const TfLiteTensor* tensor,
+                                   _TfLiteShape* out_shape) {
+  out_shape->rank = tensor->shape_rank;
+  memcpy(out_shape->dims, tensor->shape_dims,
+         tensor->shape_rank * sizeof(out_shape->dims[0]));
+}
+
+static void _TfLiteShapeToTensor(const _TfLiteShape* shape,
+                                 TfLiteTensor* tensor) {
+  tensor->shape_rank = shape->rank;
+  memcpy(tensor->shape_dims, shape->dims,
+         shape->rank * sizeof(tensor->shape_dims[0]));
+}
+
+static bool _TfLiteShapeEqualsTensor(const _TfLiteShape* shape,
+                                     const TfLiteTensor* tensor) {
+  return shape->rank == tensor->shape_rank &&
+         memcmp(shape->dims, tensor->shape_dims,
+                shape->rank * sizeof(shape->dims[0])) == 0;
+}
+
+// Releases the resources of the cache |entry| and marks it unused.
+static void _TfLiteShapeCacheEntryReset(TfLiteInterpreter* interpreter,
+                                        _TfLiteShapeCacheEntry* entry) {
+  for (int32_t i = 0; i < interpreter->model->input_count; ++i) {
+    iree_hal_buffer_release(entry->input_buffers[i]);
+    entry->input_buffers[i] = NULL;
+  }
+  entry->last_use = 0;
+}
+
+// Returns the cache entry matching the current input tensor shapes or NULL.
+static _TfLiteShapeCacheEntry* _TfLiteShapeCacheLookup(
+    TfLiteInterpreter* interpreter) {
+  for (iree_host_size_t i = 0; i < IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY;
+       ++i) {
+    _TfLiteShapeCacheEntry* entry = &interpreter->shape_cache[i];
+    if (!entry->last_use) continue;
+    bool matches = true;
+    for (int32_t j = 0; j < interpreter->model->input_count && matches; ++j) {
+      matches = _TfLiteShapeEqualsTensor(&entry->input_shapes[j],
+                                         &interpreter->input_tensors[j]);
+    }
+    if (matches) {
+      entry->last_use = ++interpreter->shape_cache_clock;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Records the current I/O shapes and input buffers in the cache, evicting the
+// least recently used entry if full.
+static void _TfLiteShapeCacheInsert(TfLiteInterpreter* interpreter) {
+  _TfLiteShapeCacheEntry* entry = &interpreter->shape_cache[0];
+  for (iree_host_size_t i = 1; i < IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY;
+       ++i) {
+    if (interpreter->shape_cache[i].last_use < entry->last_use) {
+      entry = &interpreter->shape_cache[i];
+    }
+  }
+  _TfLiteShapeCacheEntryReset(interpreter, entry);
+  for (int32_t i = 0; i < interpreter->model->input_count; ++i) {
+    TfLiteTensor* tensor = &interpreter->input_tensors[i];
+    _TfLiteShapeFromTensor(tensor, &entry->input_shapes[i]);
+    if (!tensor->is_buffer_bound) {
+      entry->input_buffers[i] = tensor->buffer;
+      iree_hal_buffer_retain(entry->input_buffers[i]);
+    }
+  }
+  for (int32_t i = 0; i < interpreter->model->output_count; ++i) {
+    _TfLiteShapeFromTensor(&interpreter->output_tensors[i],
+                           &entry->output_shapes[i]);
+  }
+  entry->last_use = ++interpreter->shape_cache_clock;
+}
+
+// Restores the output shapes and input buffers of a cache |entry|.
+static iree_status_t _TfLiteShapeCacheRestore(TfLiteInterpreter* interpreter,
+                                              _TfLiteShapeCacheEntry* entry) {
+  for (int32_t i = 0; i < interpreter->model->output_count; ++i) {
+    _TfLiteShapeToTensor(&entry->output_shapes[i],
+                         &interpreter->output_tensors[i]);
+  }
+  for (int32_t i = 0; i < interpreter->model->input_count; ++i) {
+    TfLiteTensor* tensor = &interpreter->input_tensors[i];
+    if (tensor->is_buffer_bound) {
+      // Validates the bound buffer still matches the shape.
+      IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
+          tensor, iree_hal_device_allocator(interpreter->device),
+          interpreter->allocator));
+    } else if (entry->input_buffers[i]) {
+      if (tensor->buffer != entry->input_buffers[i]) {
+        IREE_RETURN_IF_ERROR(
+            _TfLiteTensorBind(tensor, entry->input_buffers[i]));
+      }
+    } else {
+      // The input was bound when the entry was cached and has since been
+      // unbound; allocate a buffer and remember it for next time.
+      IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
+          tensor, iree_hal_device_allocator(interpreter->device),
+          interpreter->allocator));
+      entry->input_buffers[i] = tensor->buffer;
+      iree_hal_buffer_retain(entry->input_buffers[i]);
+    }
+  }
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // Creation and static initialization
 //===----------------------------------------------------------------------===//
@@ -240,6 +478,10 @@ static iree_host_size_t _TfLiteInterpreterCalculateSize(
       iree_vm_list_storage_size(&buffer_view_type_def, model->output_count);
   total_size += sizeof(TfLiteTensor) * model->input_count;
   total_size += sizeof(TfLiteTensor) * model->output_count;
+  total_size += IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY *
+                (sizeof(iree_hal_buffer_t*) * model->input_count +
+                 sizeof(_TfLiteShape) *
+                     (model->input_count + model->output_count));
 
   return total_size;
 }
@@ -283,7 +525,22 @@ static iree_status_t _TfLiteInterpreterAllocate(
   interpreter->input_tensors = (TfLiteTensor*)p;
   p += sizeof(TfLiteTensor) * model->input_count;
   interpreter->output_tensors = (TfLiteTensor*)p;
-  // p += sizeof(TfLiteTensor) * model->output_count;
+  p += sizeof(TfLiteTensor) * model->output_count;
+
+  for (iree_host_size_t i = 0; i < IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY;
+       ++i) {
+    _TfLiteShapeCacheEntry* entry = &interpreter->shape_cache[i];
+    entry->input_buffers = (iree_hal_buffer_t**)p;
+    p += sizeof(iree_hal_buffer_t*) * model->input_count;
+  }
+  for (iree_host_size_t i = 0; i < IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY;
+       ++i) {
+    _TfLiteShapeCacheEntry* entry = &interpreter->shape_cache[i];
+    entry->input_shapes = (_TfLiteShape*)p;
+    p += sizeof(_TfLiteShape) * model->input_count;
+    entry->output_shapes = (_TfLiteShape*)p;
+    p += sizeof(_TfLiteShape) * model->output_count;
+  }
 
   return iree_ok_status();
 }
@@ -304,6 +561,7 @@ static iree_status_t _TfLiteInterpreterPopulateIO(
   for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
     TfLiteTensor* tensor = &interpreter->input_tensors[i];
     memset(tensor, 0, sizeof(*tensor));
+    tensor->device = interpreter->device;
     iree_string_view_t io_name_part = iree_string_view_empty();
     iree_string_view_split(io_names_attr, ';', &io_name_part, &io_names_attr);
     iree_string_view_t io_type_part = iree_string_view_empty();
@@ -318,6 +576,7 @@ static iree_status_t _TfLiteInterpreterPopulateIO(
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
     TfLiteTensor* tensor = &interpreter->output_tensors[i];
     memset(tensor, 0, sizeof(*tensor));
+    tensor->device = interpreter->device;
     iree_string_view_t io_name_part = iree_string_view_empty();
     iree_string_view_split(io_names_attr, ';', &io_name_part, &io_names_attr);
     iree_string_view_t io_type_part = iree_string_view_empty();
@@ -415,6 +674,10 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterDelete(
     TfLiteInterpreter* interpreter) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY;
+       ++i) {
+    _TfLiteShapeCacheEntryReset(interpreter, &interpreter->shape_cache[i]);
+  }
   for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
     _TfLiteTensorReset(&interpreter->input_tensors[i], interpreter->allocator);
   }
@@ -427,7 +690,7 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterDelete(
   iree_vm_context_release(interpreter->context);
   iree_vm_module_release(interpreter->hal_module);
   iree_vm_module_release(interpreter->user_module);
-  iree_hal_driver_release(interpreter->driver);
+  _TfLiteReleaseSharedDevice(interpreter->device);
   iree_vm_instance_release(interpreter->instance);
 
   _TfLiteModelRelease(interpreter->model);
@@ -484,23 +747,43 @@ static iree_status_t _TfLiteInterpreterResizeInputTensor(
                             "model has no dynamic shapes");
   }
 
+  if (input_dims_size < 0 || input_dims_size > IREE_BINDINGS_TFLITE_MAX_RANK) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "input rank %d out of range (0 <= rank <= %d)",
+                            input_dims_size, IREE_BINDINGS_TFLITE_MAX_RANK);
+  }
+
+  // Resizing to the current shape is a no-op.
+  TfLiteTensor* tensor = &interpreter->input_tensors[input_index];
+  if (tensor->shape_rank == input_dims_size &&
+      memcmp(tensor->shape_dims, input_dims,
+             input_dims_size * sizeof(tensor->shape_dims[0])) == 0) {
+    return iree_ok_status();
+  }
+
   _TfLiteInterpreterShapeFrame frame;
   IREE_RETURN_IF_ERROR(_TfLiteInterpreterShapeFrameInitialize(&frame));
 
   // Poke the model and let it update its internal shape.
   // TODO(#3975): return bool to allow model to say it failed.
-  TfLiteTensor* tensor = &interpreter->input_tensors[input_index];
   iree_status_t status = _TfLiteInterpreterShapeFrameWriteValue(
-      &frame, tensor->shape_rank, tensor->shape_dims);
+      &frame, input_dims_size, input_dims);
   if (iree_status_is_ok(status)) {
     status = _TfLiteInterpreterShapeFrameApply(
         &frame, interpreter, interpreter->model->exports._resize_input_shape,
         input_index);
   }
 
+  // Track the requested shape so that TfLiteInterpreterAllocateTensors can
+  // look up the I/O for the new input shapes in the shape cache.
   // NOTE: the allocation may now not match the requested shape. This is just
   // how the tflite API works unfortunately; until
   // TfLiteInterpreterAllocateTensors it will remain in an indeterminate state.
+  if (iree_status_is_ok(status)) {
+    tensor->shape_rank = input_dims_size;
+    memcpy(tensor->shape_dims, input_dims,
+           input_dims_size * sizeof(tensor->shape_dims[0]));
+  }
 
   _TfLiteInterpreterShapeFrameDeinitialize(&frame);
   return status;
@@ -523,21 +806,32 @@ static iree_status_t _TfLiteInterpreterAllocateTensors(
   // reallocated upon resize. That's no good. Instead, we realloc each tensor
   // if their size has changed.
 
-  // Refresh all shapes from the model. It should have all of the
-  // non-data-dependent output shapes.
-  IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshIOShapes(interpreter));
-
   // Drop all input tensors we hang on to in the input list. This way we aren't
   // double-allocating during the resize.
   IREE_RETURN_IF_ERROR(iree_vm_list_resize(interpreter->input_list, 0));
 
-  // Reallocate input tensors (if needed).
+  _TfLiteShapeCacheEntry* cache_entry = _TfLiteShapeCacheLookup(interpreter);
+  if (cache_entry) {
+    // Input shapes used recently; reuse their output shapes and buffers.
+    IREE_RETURN_IF_ERROR(_TfLiteShapeCacheRestore(interpreter, cache_entry));
+  } else {
+    // Refresh all shapes from the model. It should have all of the
+    // non-data-dependent output shapes.
+    IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshIOShapes(interpreter));
+
+    // Reallocate input tensors (if needed).
+    for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
+      IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
+          &interpreter->input_tensors[i],
+          iree_hal_device_allocator(interpreter->device),
+          interpreter->allocator));
+    }
+    _TfLiteShapeCacheInsert(interpreter);
+  }
+
   for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
-    TfLiteTensor* tensor = &interpreter->input_tensors[i];
-    IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
-        tensor, iree_hal_device_allocator(interpreter->device),
-        interpreter->allocator));
-    iree_vm_ref_t buffer_ref = iree_hal_buffer_retain_ref(tensor->buffer);
+    iree_vm_ref_t buffer_ref =
+        iree_hal_buffer_retain_ref(interpreter->input_tensors[i].buffer);
     IREE_RETURN_IF_ERROR(
         iree_vm_list_push_ref_move(interpreter->input_list, &buffer_ref));
   }
@@ -628,3 +922,64 @@ TFL_CAPI_EXPORT extern const TfLiteTensor* TfLiteInterpreterGetOutputTensor(
   }
   return &interpreter->output_tensors[output_index];
 }
+
+//===----------------------------------------------------------------------===//
+// IREE HAL interop
+//===----------------------------------------------------------------------===//
+
+TFL_CAPI_EXPORT extern iree_hal_device_t* iree_tflite_interpreter_device(
+    const TfLiteInterpreter* interpreter) {
+  return interpreter->device;
+}
+
+static iree_status_t _TfLiteInterpreterBindInputBuffer(
+    TfLiteInterpreter* interpreter, int32_t input_index,
+    iree_hal_buffer_t* buffer) {
+  if (input_index < 0 || input_index >= interpreter->model->input_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "input_index out of range (0 <= %d < %d)",
+                            input_index, interpreter->model->input_count);
+  }
+  if (iree_vm_list_size(interpreter->input_list) !=
+      interpreter->model->input_count) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "tensors must be allocated before binding buffers");
+  }
+  TfLiteTensor* tensor = &interpreter->input_tensors[input_index];
+
+  if (!buffer) {
+    // Unbind; the next allocation will allocate a new buffer.
+    _TfLiteTensorDiscardBuffer(tensor);
+    return iree_vm_list_resize(interpreter->input_list, 0);
+  }
+
+  iree_device_size_t byte_length = 0;
+  IREE_RETURN_IF_ERROR(_TfLiteTensorComputeByteLength(tensor, &byte_length));
+  if (iree_hal_buffer_byte_length(buffer) != byte_length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "buffer has %" PRIdsz
+                            " bytes but the tensor requires %" PRIdsz " bytes",
+                            iree_hal_buffer_byte_length(buffer), byte_length);
+  }
+
+  // Retain before binding as the tensor may already hold the same buffer.
+  iree_hal_buffer_retain(buffer);
+  iree_status_t status = _TfLiteTensorBind(tensor, buffer);
+  iree_hal_buffer_release(buffer);
+  IREE_RETURN_IF_ERROR(status);
+  tensor->is_buffer_bound = true;
+
+  iree_vm_ref_t buffer_ref = iree_hal_buffer_retain_ref(buffer);
+  return iree_vm_list_set_ref_move(interpreter->input_list, input_index,
+                                   &buffer_ref);
+}
+
+TFL_CAPI_EXPORT extern TfLiteStatus iree_tflite_interpreter_bind_input_buffer(
+    TfLiteInterpreter* interpreter, int32_t input_index,
+    iree_hal_buffer_t* buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status =
+      _TfLiteInterpreterBindInputBuffer(interpreter, input_index, buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return _TfLiteStatusFromIREEStatus(status);
+}
@@ -12,12 +12,35 @@
 #include "iree/vm/api.h"
 #include "runtime/bindings/tflite/model.h"
 #include "runtime/bindings/tflite/options.h"
+#include "runtime/bindings/tflite/tensor.h"
 
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_experimental.h"
 
+// Number of input shape combinations whose I/O metadata and input buffers are
+// cached by each interpreter.
+#define IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY 4
+
+typedef struct {
+  int32_t rank;
+  int32_t dims[IREE_BINDINGS_TFLITE_MAX_RANK];
+} _TfLiteShape;
+
+// Input and output shapes for one combination of input shapes along with the
+// input buffers allocated for them. Cached so that workloads alternating
+// between a few input shapes don't query the output shapes from the module and
+// reallocate inputs each time they switch.
+typedef struct {
+  // Value of the interpreter shape_cache_clock when last used; 0 if unused.
+  uint64_t last_use;
+  _TfLiteShape* input_shapes;   // [input_count]
+  _TfLiteShape* output_shapes;  // [output_count]
+  // Retained buffers or NULL for inputs bound by the application.
+  iree_hal_buffer_t** input_buffers;  // [input_count]
+} _TfLiteShapeCacheEntry;
+
 struct TfLiteInterpreter {
   iree_allocator_t allocator;
 
@@ -25,7 +48,7 @@ struct TfLiteInterpreter {
   TfLiteInterpreterOptions options;
 
   iree_vm_instance_t* instance;
-  iree_hal_driver_t* driver;
+  // Shared with other interpreters using the same number of threads.
   iree_hal_device_t* device;
 
   union {
@@ -43,6 +66,10 @@ struct TfLiteInterpreter {
   iree_vm_list_t* output_list;
   TfLiteTensor* input_tensors;
   TfLiteTensor* output_tensors;
+
+  // LRU cache of recently allocated input shape combinations.
+  uint64_t shape_cache_clock;
+  _TfLiteShapeCacheEntry shape_cache[IREE_BINDINGS_TFLITE_SHAPE_CACHE_CAPACITY];
 };
 
 #endif  // IREE_BINDINGS_TFLITE_INTERPRETER_H_
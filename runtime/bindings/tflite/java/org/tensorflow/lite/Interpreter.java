@@ -8,9 +8,11 @@
 
 package org.tensorflow.lite;
 
+import android.hardware.HardwareBuffer;
 import androidx.annotation.NonNull;
 import java.nio.Buffer;
 import java.nio.ByteBuffer;
+import java.util.Arrays;
 import java.util.HashMap;
 import java.util.Map;
 
@@ -83,6 +85,26 @@ import java.util.Map;
  *  // Cleanup same as above.
  * }</pre>
  *
+ * <p>For streaming inference (such as on camera frames) the per-run copies can be avoided. Inputs
+ * can be written and outputs read in place through {@link Tensor#buffer()}, or caller-owned
+ * direct buffers and {@link HardwareBuffer}s can be bound persistently as inputs with {@link
+ * #bindInput(int, Buffer)} and {@link #bindInput(int, HardwareBuffer)}. Destinations for outputs
+ * can likewise be bound with {@link #bindOutput(int, Buffer)}, after which each {@link #invoke()}
+ * runs inference on the bound inputs and fills the bound outputs without further arguments:
+ *
+ * <pre>{@code
+ *  interpreter.allocateTensors();
+ *  ByteBuffer frame = ... direct buffer the camera pipeline writes into ...
+ *  interpreter.bindInput(0, frame);
+ *  FloatBuffer scores = ... direct buffer of the output size ...
+ *  interpreter.bindOutput(0, scores);
+ *  while (... each frame ...) {
+ *    ... write frame ...
+ *    interpreter.invoke();
+ *    ... read scores ...
+ *  }
+ * }</pre>
+ *
  * <p>Orders of inputs and outputs are determined when converting TensorFlow
  * model to TensorFlow Lite model with TOCO, as are the default shapes of the
  * inputs.
@@ -122,6 +144,9 @@ public final class Interpreter implements AutoCloseable {
   private final int outputTensorCount;
   private final Tensor[] inputTensors;
   private final Tensor[] outputTensors;
+  // References to the memory bound to inputs, keeping it alive while bound.
+  private final Object[] boundInputs;
+  private final Buffer[] boundOutputs;
   private final long nativeAddress;
 
   private long inferenceDurationNanoseconds;
@@ -152,6 +177,8 @@ public final class Interpreter implements AutoCloseable {
     outputTensorCount = nativeOutputTensorCount();
     inputTensors = new Tensor[inputTensorCount];
     outputTensors = new Tensor[outputTensorCount];
+    boundInputs = new Object[inputTensorCount];
+    boundOutputs = new Buffer[outputTensorCount];
   }
 
   /**
@@ -221,6 +248,11 @@ public final class Interpreter implements AutoCloseable {
    *
    * <p>Runs model inference if the model takes multiple inputs, or returns multiple outputs.
    *
+   * <p>Inputs that are bound with {@link #bindInput(int, Buffer)} may be passed as null or as the
+   * bound buffer, and inputs given as the {@link Tensor#buffer()} of the input tensor are used in
+   * place; none of these are copied. Outputs bound with {@link #bindOutput(int, Buffer)} are filled
+   * in addition to {@code outputs}.
+   *
    * @param inputs an array of input {@link java.nio.Buffer}s. The inputs should be in the same
    *     order as inputs of the model.
    * @param outputs a map mapping output indices to {@link java.nio.Buffer}s. The caller must ensure
@@ -243,9 +275,126 @@ public final class Interpreter implements AutoCloseable {
     }
 
     for (int i = 0; i < inputs.length; ++i) {
+      if (boundInputs[i] != null && (inputs[i] == null || inputs[i] == boundInputs[i])) {
+        continue;
+      }
       getInputTensor(i).copyFromBuffer(inputs[i]);
     }
 
+    invokeAndCopyBoundOutputs();
+
+    for (Map.Entry<Integer, Buffer> output : outputs.entrySet()) {
+      getOutputTensor(output.getKey()).copyToBuffer(output.getValue());
+    }
+  }
+
+  /**
+   * Runs model inference on the current contents of the input tensors and fills the outputs bound
+   * with {@link #bindOutput(int, Buffer)}.
+   *
+   * <p>Inputs are either bound with {@link #bindInput(int, Buffer)} or written through {@link
+   * Tensor#buffer()}. Unbound outputs can be read through {@link Tensor#buffer()} of the output
+   * tensors until the next inference.
+   *
+   * @throws IllegalStateException if inference fails.
+   */
+  public void invoke() {
+    if (!tensorsAllocated) {
+      allocateTensors();
+    }
+    invokeAndCopyBoundOutputs();
+  }
+
+  /**
+   * Binds a direct buffer as the storage of an input tensor, replacing the memory allocated by the
+   * interpreter.
+   *
+   * <p>The buffer is used in place by all following inferences until it is unbound with {@link
+   * #unbindInput(int)} or another buffer is bound: contents written to it between inferences are
+   * used without copies. The interpreter keeps a reference to the buffer while it is bound.
+   *
+   * @param inputIndex index of the input to bind.
+   * @param buffer a direct {@link java.nio.Buffer} in native {@link java.nio.ByteOrder} with the
+   *     capacity of the input tensor (see {@link Tensor#numBytes()}).
+   * @throws IllegalArgumentException if the buffer is not direct, has the wrong capacity or cannot
+   *     be bound to the input.
+   */
+  public void bindInput(int inputIndex, @NonNull Buffer buffer) {
+    if (!Tensor.isDirectBuffer(buffer)) {
+      throw new IllegalArgumentException("Only direct buffers can be bound to inputs.");
+    }
+    if (!tensorsAllocated) {
+      allocateTensors();
+    }
+    Tensor tensor = getInputTensor(inputIndex);
+    tensor.checkBufferCapacity(buffer);
+    if (nativeBindInputBuffer(inputIndex, buffer, tensor.numBytes()) != 0) {
+      throw new IllegalArgumentException(
+          String.format("Unable to bind buffer to input tensor(%d).", inputIndex));
+    }
+    boundInputs[inputIndex] = buffer;
+  }
+
+  /**
+   * Binds a {@link HardwareBuffer} as the storage of an input tensor, replacing the memory allocated
+   * by the interpreter.
+   *
+   * <p>The buffer must be CPU-readable ({@link HardwareBuffer#USAGE_CPU_READ_OFTEN}) and be either
+   * a {@link HardwareBuffer#BLOB} or a packed RGB(A) image with at least the byte size of the input
+   * tensor. It is locked for CPU reads while bound and used in place by all following inferences;
+   * producers must not write to it until it is unbound with {@link #unbindInput(int)}.
+   *
+   * @param inputIndex index of the input to bind.
+   * @param buffer the hardware buffer to bind.
+   * @throws IllegalArgumentException if the buffer cannot be bound to the input.
+   */
+  public void bindInput(int inputIndex, @NonNull HardwareBuffer buffer) {
+    if (!tensorsAllocated) {
+      allocateTensors();
+    }
+    Tensor tensor = getInputTensor(inputIndex);
+    if (nativeBindInputHardwareBuffer(inputIndex, buffer, tensor.numBytes()) != 0) {
+      throw new IllegalArgumentException(
+          String.format("Unable to bind hardware buffer to input tensor(%d).", inputIndex));
+    }
+    boundInputs[inputIndex] = buffer;
+  }
+
+  /**
+   * Unbinds the memory bound to an input with {@code bindInput}. The interpreter allocates its own
+   * memory for the input again.
+   *
+   * @throws IllegalArgumentException if {@code inputIndex} is invalid.
+   */
+  public void unbindInput(int inputIndex) {
+    getInputTensor(inputIndex);
+    if (boundInputs[inputIndex] == null) {
+      return;
+    }
+    if (nativeUnbindInput(inputIndex) != 0) {
+      throw new IllegalArgumentException(
+          String.format("Unable to unbind input tensor(%d).", inputIndex));
+    }
+    boundInputs[inputIndex] = null;
+    allocateTensors();
+  }
+
+  /**
+   * Binds a buffer to be filled with the contents of an output tensor after each inference.
+   *
+   * <p>Outputs are produced into memory allocated by the interpreter; direct buffers are filled
+   * with a single native copy. Pass null to unbind the output.
+   *
+   * @param outputIndex index of the output to bind.
+   * @param buffer a {@link java.nio.Buffer} with the capacity of the output tensor, or null.
+   * @throws IllegalArgumentException if {@code outputIndex} is invalid.
+   */
+  public void bindOutput(int outputIndex, Buffer buffer) {
+    getOutputTensor(outputIndex);
+    boundOutputs[outputIndex] = buffer;
+  }
+
+  private void invokeAndCopyBoundOutputs() {
     long inferenceStartNanos = System.nanoTime();
     int status = nativeInvoke();
     inferenceDurationNanoseconds = System.nanoTime() - inferenceStartNanos;
@@ -255,8 +404,10 @@ public final class Interpreter implements AutoCloseable {
           String.format("Failed to run Interpreter. Returned status code: %d", status));
     }
 
-    for (Map.Entry<Integer, Buffer> output : outputs.entrySet()) {
-      getOutputTensor(output.getKey()).copyToBuffer(output.getValue());
+    for (int i = 0; i < boundOutputs.length; ++i) {
+      if (boundOutputs[i] != null) {
+        getOutputTensor(i).copyToBuffer(boundOutputs[i]);
+      }
     }
   }
 
@@ -386,7 +537,10 @@ public final class Interpreter implements AutoCloseable {
   /** Release resources associated with the {@code Interpreter}. */
   @Override
   public void close() {
+    // Releases the bound memory (unlocking hardware buffers) with the interpreter.
     nativeFree();
+    Arrays.fill(boundInputs, null);
+    Arrays.fill(boundOutputs, null);
   }
 
   private native long nativeNew(ByteBuffer modelByteBuffer, int numThreads);
@@ -402,4 +556,11 @@ public final class Interpreter implements AutoCloseable {
   private native int nativeResizeInputTensor(int inputIndex, int[] dims);
 
   private native int nativeInvoke();
+
+  private native int nativeBindInputBuffer(int inputIndex, Buffer buffer, int byteLength);
+
+  private native int nativeBindInputHardwareBuffer(
+      int inputIndex, HardwareBuffer buffer, int byteLength);
+
+  private native int nativeUnbindInput(int inputIndex);
 }
@@ -162,19 +162,48 @@ public final class Tensor {
     return quantizationParams;
   }
 
+  /**
+   * Returns a direct {@link ByteBuffer} in native {@link ByteOrder} aliasing the memory backing the
+   * tensor.
+   *
+   * <p>Inputs written and outputs read through the buffer are not copied. Passing the buffer (or a
+   * view of it, such as {@link ByteBuffer#asFloatBuffer()}) to {@link Interpreter#run(Buffer,
+   * Buffer)} performs no copies either.
+   *
+   * <p>The buffer is invalidated when the tensor is reallocated: by {@link
+   * Interpreter#allocateTensors()} after resizing, by binding an input with {@link
+   * Interpreter#bindInput(int, Buffer)} and, for outputs, by every inference. Fetch it again
+   * afterwards.
+   *
+   * @throws IllegalStateException if the tensor is not allocated or its memory is not accessible
+   *     by the host.
+   */
+  public ByteBuffer buffer() {
+    ByteBuffer buffer = nativeGetByteBuffer();
+    if (buffer == null) {
+      throw new IllegalStateException(
+          String.format("Tensor(%d) memory is not accessible by the host", tensorIndex));
+    }
+    return buffer.order(ByteOrder.nativeOrder());
+  }
+
   void copyFromBuffer(Buffer inputBuffer) {
     checkBufferCapacity(inputBuffer);
     if (isDirectBuffer(inputBuffer)) {
       copyFromDirectBuffer(inputBuffer);
     } else {
-      if (inputBuffer instanceof ByteBuffer) {
-        ((ByteBuffer) inputBuffer).put(getNativeBuffer());
-      } else if (inputBuffer instanceof FloatBuffer) {
-        ((FloatBuffer) inputBuffer).put(getNativeBuffer().asFloatBuffer());
-      } else if (inputBuffer instanceof IntBuffer) {
-        ((IntBuffer) inputBuffer).put(getNativeBuffer().asIntBuffer());
-      } else if (inputBuffer instanceof LongBuffer) {
-        ((LongBuffer) inputBuffer).put(getNativeBuffer().asLongBuffer());
+      // As with direct buffers the whole capacity is copied regardless of the position, which is
+      // left untouched by copying from a duplicate.
+      Buffer source = duplicate(inputBuffer);
+      source.clear();
+      if (source instanceof ByteBuffer) {
+        buffer().put((ByteBuffer) source);
+      } else if (source instanceof FloatBuffer) {
+        buffer().asFloatBuffer().put((FloatBuffer) source);
+      } else if (source instanceof IntBuffer) {
+        buffer().asIntBuffer().put((IntBuffer) source);
+      } else if (source instanceof LongBuffer) {
+        buffer().asLongBuffer().put((LongBuffer) source);
       } else {
         throw new IllegalArgumentException(
             "Unexpected input buffer type: " + inputBuffer.getClass());
@@ -187,14 +216,16 @@ public final class Tensor {
     if (isDirectBuffer(outputBuffer)) {
       copyToDirectBuffer(outputBuffer);
     } else {
-      if (outputBuffer instanceof ByteBuffer) {
-        getNativeBuffer().put((ByteBuffer) outputBuffer);
-      } else if (outputBuffer instanceof FloatBuffer) {
-        getNativeBuffer().asFloatBuffer().put((FloatBuffer) outputBuffer);
-      } else if (outputBuffer instanceof IntBuffer) {
-        getNativeBuffer().asIntBuffer().put((IntBuffer) outputBuffer);
-      } else if (outputBuffer instanceof LongBuffer) {
-        getNativeBuffer().asLongBuffer().put((LongBuffer) outputBuffer);
+      Buffer target = duplicate(outputBuffer);
+      target.clear();
+      if (target instanceof ByteBuffer) {
+        ((ByteBuffer) target).put(buffer());
+      } else if (target instanceof FloatBuffer) {
+        ((FloatBuffer) target).put(buffer().asFloatBuffer());
+      } else if (target instanceof IntBuffer) {
+        ((IntBuffer) target).put(buffer().asIntBuffer());
+      } else if (target instanceof LongBuffer) {
+        ((LongBuffer) target).put(buffer().asLongBuffer());
       } else {
         throw new IllegalArgumentException(
             "Unexpected output buffer type: " + outputBuffer.getClass());
@@ -202,7 +233,23 @@ public final class Tensor {
     }
   }
 
-  private boolean isDirectBuffer(Buffer object) {
+  private static Buffer duplicate(Buffer object) {
+    if (object instanceof ByteBuffer) {
+      return ((ByteBuffer) object).duplicate();
+    }
+    if (object instanceof LongBuffer) {
+      return ((LongBuffer) object).duplicate();
+    }
+    if (object instanceof FloatBuffer) {
+      return ((FloatBuffer) object).duplicate();
+    }
+    if (object instanceof IntBuffer) {
+      return ((IntBuffer) object).duplicate();
+    }
+    return object;
+  }
+
+  static boolean isDirectBuffer(Buffer object) {
     if (object instanceof ByteBuffer) {
       ByteBuffer buffer = (ByteBuffer) object;
       return buffer.isDirect();
@@ -222,7 +269,7 @@ public final class Tensor {
     return false;
   }
 
-  private void checkBufferCapacity(Buffer otherBuffer) {
+  void checkBufferCapacity(Buffer otherBuffer) {
     int numBytes = numBytes();
     int otherBytes = otherBuffer.capacity();
     // Non ByteBuffers report capacity based on the number of elements rather raw bytes.
@@ -261,10 +308,6 @@ public final class Tensor {
     }
   }
 
-  private ByteBuffer getNativeBuffer() {
-    return nativeGetByteBuffer().order(ByteOrder.nativeOrder());
-  }
-
   private final long nativeAddress;
   private final int tensorIndex;
   private final QuantizationParams quantizationParams;
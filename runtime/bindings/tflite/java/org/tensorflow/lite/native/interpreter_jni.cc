@@ -4,13 +4,18 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <android/hardware_buffer.h>
+#include <android/hardware_buffer_jni.h>
 #include <jni.h>
+#include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/hal/api.h"
 
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+#include "runtime/bindings/tflite/interop.h"
 
 #define JNI_FUNC extern "C" JNIEXPORT
 #define JNI_PREFIX(METHOD) Java_org_tensorflow_lite_Interpreter_##METHOD
@@ -33,6 +38,80 @@ static TfLiteInterpreter* GetInterpreter(JNIEnv* env, jobject obj) {
   return reinterpret_cast<TfLiteInterpreter*>(env->GetLongField(obj, field));
 }
 
+// Imports |byte_length| bytes of host memory at |data| into the allocator of
+// the interpreter and binds it as the storage of the input at |input_index|.
+// |release_callback| is called once the interpreter no longer uses the memory.
+static jint BindInputHostAllocation(
+    TfLiteInterpreter* interpreter, jint input_index, void* data,
+    iree_device_size_t byte_length,
+    iree_hal_buffer_release_callback_t release_callback) {
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+  external_buffer.size = byte_length;
+  external_buffer.handle.host_allocation.ptr = data;
+  iree_hal_buffer_params_t params = {0};
+  params.type =
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+  params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+
+  iree_hal_allocator_t* allocator = iree_hal_device_allocator(
+      iree_tflite_interpreter_device(interpreter));
+  iree_hal_buffer_t* buffer = nullptr;
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      allocator, params, &external_buffer, release_callback, &buffer);
+  if (!iree_status_is_ok(status)) {
+    // The memory was not imported and the callback will never be called.
+    iree_status_ignore(status);
+    if (release_callback.fn) {
+      release_callback.fn(release_callback.user_data, nullptr);
+    }
+    return kTfLiteError;
+  }
+
+  // The interpreter retains the buffer for as long as it is bound.
+  TfLiteStatus bind_status =
+      iree_tflite_interpreter_bind_input_buffer(interpreter, input_index,
+                                                buffer);
+  iree_hal_buffer_release(buffer);
+  return (jint)bind_status;
+}
+
+// Unlocks and releases a hardware buffer bound as an input.
+static void ReleaseHardwareBuffer(void* user_data, iree_hal_buffer_t* buffer) {
+  AHardwareBuffer* hardware_buffer = static_cast<AHardwareBuffer*>(user_data);
+  AHardwareBuffer_unlock(hardware_buffer, /*fence=*/nullptr);
+  AHardwareBuffer_release(hardware_buffer);
+}
+
+// Returns the number of bytes of CPU-addressable storage of a hardware
+// buffer described by |desc| or 0 if its format has no linear byte layout.
+static iree_device_size_t HardwareBufferByteLength(
+    const AHardwareBuffer_Desc& desc) {
+  iree_device_size_t pixel_size = 0;
+  switch (desc.format) {
+    case AHARDWAREBUFFER_FORMAT_BLOB:
+      // BLOB buffers store |width| bytes.
+      return desc.width;
+    case AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM:
+    case AHARDWAREBUFFER_FORMAT_R8G8B8X8_UNORM:
+      pixel_size = 4;
+      break;
+    case AHARDWAREBUFFER_FORMAT_R8G8B8_UNORM:
+      pixel_size = 3;
+      break;
+    case AHARDWAREBUFFER_FORMAT_R16G16B16A16_FLOAT:
+      pixel_size = 8;
+      break;
+    default:
+      return 0;
+  }
+  return (iree_device_size_t)desc.stride * desc.height * desc.layers *
+         pixel_size;
+}
+
 }  // namespace
 
 JNI_FUNC jlong JNI_PREFIX(nativeNew)(JNIEnv* env, jobject thiz,
@@ -111,3 +190,74 @@ JNI_FUNC jint JNI_PREFIX(nativeInvoke)(JNIEnv* env, jobject thiz) {
 
   return (jint)TfLiteInterpreterInvoke(interpreter);
 }
+
+JNI_FUNC jint JNI_PREFIX(nativeBindInputBuffer)(JNIEnv* env, jobject thiz,
+                                                jint input_index,
+                                                jobject input_buffer,
+                                                jint byte_length) {
+  TfLiteInterpreter* interpreter = GetInterpreter(env, thiz);
+  if (!interpreter) {
+    return kTfLiteError;  // Failed get handle. Returning to error in Java.
+  }
+
+  void* data = env->GetDirectBufferAddress(input_buffer);
+  if (!data) {
+    return kTfLiteError;  // Not a direct buffer.
+  }
+
+  // The Interpreter holds a reference to the buffer for as long as it is
+  // bound to keep the memory alive so no release callback is required.
+  return BindInputHostAllocation(interpreter, input_index, data,
+                                 (iree_device_size_t)byte_length,
+                                 iree_hal_buffer_release_callback_null());
+}
+
+JNI_FUNC jint JNI_PREFIX(nativeBindInputHardwareBuffer)(JNIEnv* env,
+                                                        jobject thiz,
+                                                        jint input_index,
+                                                        jobject hardware_buffer,
+                                                        jint byte_length) {
+  TfLiteInterpreter* interpreter = GetInterpreter(env, thiz);
+  if (!interpreter) {
+    return kTfLiteError;  // Failed get handle. Returning to error in Java.
+  }
+
+  AHardwareBuffer* buffer =
+      AHardwareBuffer_fromHardwareBuffer(env, hardware_buffer);
+  if (!buffer) {
+    return kTfLiteError;
+  }
+  AHardwareBuffer_Desc desc;
+  AHardwareBuffer_describe(buffer, &desc);
+  if (!(desc.usage & AHARDWAREBUFFER_USAGE_CPU_READ_MASK) ||
+      HardwareBufferByteLength(desc) < (iree_device_size_t)byte_length) {
+    return kTfLiteError;  // Not readable by the CPU or too small.
+  }
+
+  // The CPU executes the program so the buffer is locked for reading for as
+  // long as it is bound. Producers must wait for the interpreter to unbind it
+  // (or be closed) before writing to it again.
+  AHardwareBuffer_acquire(buffer);
+  void* data = nullptr;
+  if (AHardwareBuffer_lock(buffer, AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN,
+                           /*fence=*/-1, /*rect=*/nullptr, &data) != 0) {
+    AHardwareBuffer_release(buffer);
+    return kTfLiteError;
+  }
+  iree_hal_buffer_release_callback_t release_callback = {ReleaseHardwareBuffer,
+                                                         buffer};
+  return BindInputHostAllocation(interpreter, input_index, data,
+                                 (iree_device_size_t)byte_length,
+                                 release_callback);
+}
+
+JNI_FUNC jint JNI_PREFIX(nativeUnbindInput)(JNIEnv* env, jobject thiz,
+                                            jint input_index) {
+  TfLiteInterpreter* interpreter = GetInterpreter(env, thiz);
+  if (!interpreter) {
+    return kTfLiteError;  // Failed get handle. Returning to error in Java.
+  }
+
+  return (jint)iree_tflite_interpreter_bind_input_buffer(interpreter,
+                                                         input_index, nullptr);
+}
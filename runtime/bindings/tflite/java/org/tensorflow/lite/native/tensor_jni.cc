@@ -158,7 +158,11 @@ JNI_FUNC jobject JNI_PREFIX(nativeGetByteBuffer)(JNIEnv* env, jobject thiz) {
   if (!tensor) {
     return nullptr;  // Failed get handle. Returning to error in Java.
   }
+  void* data = TfLiteTensorData(tensor);
+  if (!data) {
+    return nullptr;  // Not allocated or not host-visible.
+  }
   return env->NewDirectByteBuffer(
-      static_cast<void*>(TfLiteTensorData(tensor)),
+      data,
       static_cast<jlong>(TfLiteTensorByteSize(tensor)));
 }
@@ -69,6 +69,45 @@ public final class InterpreterTest {
     }
   }
 
+  @Test
+  public void testInPlaceAndBoundBuffers() throws Exception {
+    Context context = ApplicationProvider.getApplicationContext();
+    Resources resources = context.getResources();
+    InputStream moduleInputStream = resources.openRawResource(R.raw.simple_add_bytecode_module);
+    ByteBuffer moduleByteBuffer = convertInputStreamToByteBuffer(moduleInputStream);
+
+    try (Interpreter interpreter = new Interpreter(moduleByteBuffer, new Options())) {
+      interpreter.allocateTensors();
+
+      // Inputs written and outputs read through the tensor memory.
+      interpreter.getInputTensor(0).buffer().asFloatBuffer().put(new float[] {1, 3});
+      interpreter.invoke();
+      float[] output = new float[2];
+      interpreter.getOutputTensor(0).buffer().asFloatBuffer().get(output);
+      assertArrayEquals(new float[] {2, 6}, output, EPSILON);
+
+      // Bound buffers persist between inferences.
+      FloatBuffer inputBuffer = allocateNativeFloatBuffer(2);
+      FloatBuffer outputBuffer = allocateNativeFloatBuffer(2);
+      interpreter.bindInput(0, inputBuffer);
+      interpreter.bindOutput(0, outputBuffer);
+      for (int i = 0; i < 3; ++i) {
+        inputBuffer.put(0, i).put(1, -i);
+        interpreter.invoke();
+        assertEquals(2 * i, outputBuffer.get(0), EPSILON);
+        assertEquals(-2 * i, outputBuffer.get(1), EPSILON);
+      }
+
+      // Unbound inputs are copied again.
+      interpreter.unbindInput(0);
+      interpreter.bindOutput(0, null);
+      inputBuffer.put(0, 5).put(1, 7);
+      interpreter.run(inputBuffer, outputBuffer);
+      assertEquals(10, outputBuffer.get(0), EPSILON);
+      assertEquals(14, outputBuffer.get(1), EPSILON);
+    }
+  }
+
   private static FloatBuffer allocateNativeFloatBuffer(int floatLength) {
     return ByteBuffer.allocateDirect(BYTES_IN_FLOAT * floatLength)
         .order(ByteOrder.nativeOrder())
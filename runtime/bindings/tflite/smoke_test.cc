@@ -26,10 +26,12 @@ limitations under the License.
 #include <vector>
 
 #include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
 
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+#include "runtime/bindings/tflite/interop.h"
 
 // Test model is available both on the filesystem and here for embedding testing
 // embedding the module directly in a binary.
@@ -214,6 +216,95 @@ TEST(CApiSimple, StaticSmoke) {
   TfLiteInterpreterDelete(interpreter);
 }
 
+// Tests that switching back to a previously allocated input shape restores the
+// output shapes and input buffers cached for it and that buffers bound by the
+// application are never cached.
+TEST(CApiSimple, ResizeShapeCache) {
+  TfLiteModel* model = TfLiteModelCreate(
+      IREE_BINDINGS_TFLITE_TESTDATA_ADD_DYNAMIC_EMBEDDED_DATA,
+      IREE_BINDINGS_TFLITE_TESTDATA_ADD_DYNAMIC_EMBEDDED_SIZE);
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  TfLiteModelDelete(model);
+
+  TfLiteTensor* input_tensor = TfLiteInterpreterGetInputTensor(interpreter, 0);
+  ASSERT_NE(input_tensor, nullptr);
+  const TfLiteTensor* output_tensor =
+      TfLiteInterpreterGetOutputTensor(interpreter, 0);
+  ASSERT_NE(output_tensor, nullptr);
+
+  // Shape A.
+  const std::array<int, 1> dims_a = {2};
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, dims_a.data(),
+                                               dims_a.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  iree_hal_buffer_t* buffer_a = iree_tflite_tensor_buffer(input_tensor);
+  ASSERT_NE(buffer_a, nullptr);
+  EXPECT_EQ(TfLiteTensorDim(output_tensor, 0), 2);
+
+  // Shape B gets its own input buffer while A's remains cached.
+  const std::array<int, 1> dims_b = {4};
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, dims_b.data(),
+                                               dims_b.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  EXPECT_NE(iree_tflite_tensor_buffer(input_tensor), buffer_a);
+  EXPECT_EQ(TfLiteTensorByteSize(input_tensor), sizeof(float) * 4);
+  EXPECT_EQ(TfLiteTensorDim(output_tensor, 0), 4);
+
+  // Back to shape A restores its output shape and input buffer.
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, dims_a.data(),
+                                               dims_a.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  EXPECT_EQ(iree_tflite_tensor_buffer(input_tensor), buffer_a);
+  EXPECT_EQ(TfLiteTensorByteSize(input_tensor), sizeof(float) * 2);
+  EXPECT_EQ(TfLiteTensorDim(output_tensor, 0), 2);
+
+  // Shape C is first allocated with a buffer bound by the application.
+  const std::array<int, 1> dims_c = {3};
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, dims_c.data(),
+                                               dims_c.size()),
+            kTfLiteOk);
+  iree_hal_buffer_params_t params = {0};
+  params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                 IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_buffer_t* bound_buffer = nullptr;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(iree_tflite_interpreter_device(interpreter)),
+      params, sizeof(float) * 3, iree_const_byte_span_empty(), &bound_buffer));
+  ASSERT_EQ(
+      iree_tflite_interpreter_bind_input_buffer(interpreter, 0, bound_buffer),
+      kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  EXPECT_EQ(iree_tflite_tensor_buffer(input_tensor), bound_buffer);
+  EXPECT_EQ(TfLiteTensorDim(output_tensor, 0), 3);
+  ASSERT_EQ(iree_tflite_interpreter_bind_input_buffer(interpreter, 0, nullptr),
+            kTfLiteOk);
+
+  // Switching away from and back to shape C after unbinding allocates a new
+  // buffer instead of reusing the one the application bound.
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, dims_a.data(),
+                                               dims_a.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  EXPECT_EQ(iree_tflite_tensor_buffer(input_tensor), buffer_a);
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, dims_c.data(),
+                                               dims_c.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  EXPECT_NE(iree_tflite_tensor_buffer(input_tensor), nullptr);
+  EXPECT_NE(iree_tflite_tensor_buffer(input_tensor), bound_buffer);
+  EXPECT_EQ(TfLiteTensorDim(output_tensor, 0), 3);
+
+  iree_hal_buffer_release(bound_buffer);
+  TfLiteInterpreterDelete(interpreter);
+}
+
 // TODO(#3971): fix cmake data deps.
 // TODO(#3972): plumb through quantization params.
 TEST(CApiSimple, DISABLED_QuantizationParams) {
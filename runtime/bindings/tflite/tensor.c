@@ -7,6 +7,7 @@
 #include "runtime/bindings/tflite/tensor.h"
 
 #include "iree/base/tracing.h"
+#include "runtime/bindings/tflite/interop.h"
 #include "runtime/bindings/tflite/shim.h"
 
 iree_status_t _TfLiteTensorParseNameAttr(TfLiteTensor* tensor,
@@ -103,29 +104,79 @@ static iree_status_t _TfLiteTypeToElementType(
   return iree_ok_status();
 }
 
-iree_status_t _TfLiteTensorReallocateIfNeeded(
-    TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
-    iree_allocator_t heap_allocator) {
-  IREE_TRACE_ZONE_BEGIN(z0);
+iree_status_t _TfLiteTensorComputeByteLength(
+    const TfLiteTensor* tensor, iree_device_size_t* out_byte_length) {
+  *out_byte_length = 0;
 
   // Format conversion; ensure we can support the type.
   iree_hal_element_type_t element_type = IREE_HAL_ELEMENT_TYPE_NONE;
   iree_host_size_t storage_scalar = 1;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
+  IREE_RETURN_IF_ERROR(
       _TfLiteTypeToElementType(tensor->type, &element_type, &storage_scalar));
 
   // Compute the total allocation size required, possibly with padding.
   iree_hal_dim_t shape_dims[IREE_BINDINGS_TFLITE_MAX_RANK];
   for (int32_t i = 0; i < tensor->shape_rank; ++i) {
+    if (tensor->shape_dims[i] < 0) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "tensor dimension %d is dynamic; resize the "
+                              "tensor and allocate tensors first",
+                              i);
+    }
     shape_dims[i] = (iree_hal_dim_t)tensor->shape_dims[i];
   }
+  iree_device_size_t byte_length = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_compute_view_size(
+      tensor->shape_rank, shape_dims, element_type,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, &byte_length));
+  *out_byte_length = byte_length * storage_scalar;
+  return iree_ok_status();
+}
+
+// Maps |buffer| into |tensor|'s persistent mapping if the host can access it.
+// Buffers that are not host-mappable (such as device-local buffers bound by
+// the application) are left unmapped.
+static iree_status_t _TfLiteTensorMapIfPossible(TfLiteTensor* tensor,
+                                                iree_hal_buffer_t* buffer) {
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+      !iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                         IREE_HAL_BUFFER_USAGE_MAPPING)) {
+    return iree_ok_status();
+  }
+  // The tflite API doesn't let us know if this should be read or read/write -
+  // or if we even need to map at all. We could move this to an on-demand
+  // mapping when the user calls TfLiteTensorData but this at least puts
+  // potential errors in the same easy to find place.
+  return iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, 0,
+      IREE_WHOLE_BUFFER, &tensor->buffer_mapping);
+}
+
+iree_status_t _TfLiteTensorReallocateIfNeeded(
+    TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
+    iree_allocator_t heap_allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
   iree_device_size_t allocation_size = 0;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_buffer_compute_view_size(
-              tensor->shape_rank, shape_dims, element_type,
-              IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, &allocation_size));
-  allocation_size *= storage_scalar;
+      z0, _TfLiteTensorComputeByteLength(tensor, &allocation_size));
+
+  // Buffers bound by the application are used as-is.
+  if (tensor->is_buffer_bound) {
+    iree_device_size_t byte_length =
+        iree_hal_buffer_byte_length(tensor->buffer);
+    IREE_TRACE_ZONE_END(z0);
+    if (byte_length != allocation_size) {
+      return iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "bound input buffer has %" PRIdsz
+          " bytes but the tensor requires %" PRIdsz " bytes",
+          byte_length, allocation_size);
+    }
+    return iree_ok_status();
+  }
 
   // If the old buffer is the same size then no need to realloc.
   if (tensor->buffer &&
@@ -133,6 +184,7 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
     IREE_TRACE_ZONE_END(z0);
     return iree_ok_status();
   }
+  _TfLiteTensorDiscardBuffer(tensor);
 
   // Allocate the underlying buffer for the tensor.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -172,17 +224,8 @@ iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
     return iree_ok_status();
   }
 
-  // Attempt to map the buffer. The tflite API doesn't let us know if this
-  // should be read or read/write - or if we even need to map at all. We could
-  // move this to an on-demand mapping when the user calls TfLiteTensorData but
-  // this at least puts potential errors in the same easy to find place.
-  iree_device_size_t byte_offset = 0;
-  iree_device_size_t byte_length = IREE_WHOLE_BUFFER;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_buffer_map_range(
-              buffer, IREE_HAL_MAPPING_MODE_SCOPED,
-              IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE,
-              byte_offset, byte_length, &tensor->buffer_mapping));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0,
+                                    _TfLiteTensorMapIfPossible(tensor, buffer));
 
   // Retain the buffer view until discarded/reset.
   tensor->buffer = buffer;
@@ -197,8 +240,10 @@ void _TfLiteTensorDiscardBuffer(TfLiteTensor* tensor) {
   if (tensor->buffer_mapping.contents.data != NULL) {
     iree_hal_buffer_unmap_range(&tensor->buffer_mapping);
   }
+  memset(&tensor->buffer_mapping, 0, sizeof(tensor->buffer_mapping));
   iree_hal_buffer_release(tensor->buffer);
   tensor->buffer = NULL;
+  tensor->is_buffer_bound = false;
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -242,36 +287,62 @@ TFL_CAPI_EXPORT extern TfLiteQuantizationParams TfLiteTensorQuantizationParams(
 
 TFL_CAPI_EXPORT extern TfLiteStatus TfLiteTensorCopyFromBuffer(
     TfLiteTensor* tensor, const void* input_data, size_t input_data_size) {
-  if (input_data_size != tensor->buffer_mapping.contents.data_length) {
+  if (!tensor->buffer ||
+      input_data_size != iree_hal_buffer_byte_length(tensor->buffer)) {
     return kTfLiteApplicationError;
   }
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE(z0, tensor->buffer_mapping.contents.data_length);
-
-  // NOTE: we could use a iree_hal_buffer_map_write here but we already
-  // have the buffer mapped. If we knew the user would never use
-  // TfLiteTensorData and could avoid mapping the buffer it would be more
-  // efficient and portable to do the iree_hal_buffer_map_copy.
-  memcpy(tensor->buffer_mapping.contents.data, input_data, input_data_size);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, input_data_size);
+
+  iree_status_t status = iree_ok_status();
+  if (tensor->buffer_mapping.contents.data == input_data) {
+    // Written in place through TfLiteTensorData (or a view of it).
+  } else if (tensor->buffer_mapping.contents.data) {
+    // NOTE: we could use a iree_hal_buffer_map_write here but we already
+    // have the buffer mapped. If we knew the user would never use
+    // TfLiteTensorData and could avoid mapping the buffer it would be more
+    // efficient and portable to do the iree_hal_buffer_map_copy.
+    memcpy(tensor->buffer_mapping.contents.data, input_data, input_data_size);
+  } else {
+    // Buffers the host cannot map are written through the device.
+    status = iree_hal_device_transfer_h2d(
+        tensor->device, input_data, tensor->buffer, 0, input_data_size,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+  }
 
   IREE_TRACE_ZONE_END(z0);
-  return kTfLiteOk;
+  return _TfLiteStatusFromIREEStatus(status);
 }
 
 TFL_CAPI_EXPORT extern TfLiteStatus TfLiteTensorCopyToBuffer(
     const TfLiteTensor* output_tensor, void* output_data,
     size_t output_data_size) {
-  if (output_data_size != output_tensor->buffer_mapping.contents.data_length) {
+  if (!output_tensor->buffer ||
+      output_data_size != iree_hal_buffer_byte_length(output_tensor->buffer)) {
     return kTfLiteApplicationError;
   }
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE(
-      z0, output_tensor->buffer_mapping.contents.data_length);
-
-  // NOTE: as with above we should use an iree_hal_buffer_map_read here.
-  memcpy(output_data, output_tensor->buffer_mapping.contents.data,
-         output_data_size);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, output_data_size);
+
+  iree_status_t status = iree_ok_status();
+  if (output_tensor->buffer_mapping.contents.data == output_data) {
+    // Read in place through TfLiteTensorData (or a view of it).
+  } else if (output_tensor->buffer_mapping.contents.data) {
+    // NOTE: as with above we should use an iree_hal_buffer_map_read here.
+    memcpy(output_data, output_tensor->buffer_mapping.contents.data,
+           output_data_size);
+  } else {
+    status = iree_hal_device_transfer_d2h(
+        output_tensor->device, output_tensor->buffer, 0, output_data,
+        output_data_size, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout());
+  }
 
   IREE_TRACE_ZONE_END(z0);
-  return kTfLiteOk;
+  return _TfLiteStatusFromIREEStatus(status);
+}
+
+TFL_CAPI_EXPORT extern iree_hal_buffer_t* iree_tflite_tensor_buffer(
+    const TfLiteTensor* tensor) {
+  return tensor->buffer;
 }
@@ -34,9 +34,18 @@ struct TfLiteTensor {
   int32_t shape_rank;
   int32_t shape_dims[IREE_BINDINGS_TFLITE_MAX_RANK];
 
+  // Device used to transfer data to and from buffers the host cannot map.
+  // Unretained as the interpreter owning the tensor retains it.
+  iree_hal_device_t* device;
+
   // Allocated buffer view referencing the backing tensor memory.
   iree_hal_buffer_t* buffer;
+  // True if |buffer| was bound by the application with
+  // iree_tflite_interpreter_bind_input_buffer and must not be reallocated.
+  bool is_buffer_bound;
   // Persistently mapped buffer; invalidated when buffer is resized.
+  // Empty if the buffer is not host-mappable in which case data is transferred
+  // through |device| by TfLiteTensorCopyFromBuffer/TfLiteTensorCopyToBuffer.
   iree_hal_buffer_mapping_t buffer_mapping;
 };
 
@@ -53,14 +62,19 @@ iree_status_t _TfLiteTensorParseTypeAttr(TfLiteTensor* tensor,
 iree_status_t _TfLiteTensorParseQuantAttr(TfLiteTensor* tensor,
                                           iree_string_view_t attr);
 
+// Computes the size in bytes of the tensor storage with its current shape.
+iree_status_t _TfLiteTensorComputeByteLength(
+    const TfLiteTensor* tensor, iree_device_size_t* out_byte_length);
+
 // Reallocates and remaps the tensor buffer view if needed.
 // No-op if the buffer view is already allocated and its shape matches the
-// current tensor shape.
+// current tensor shape. Buffers bound by the application are never reallocated
+// and must match the current tensor shape.
 iree_status_t _TfLiteTensorReallocateIfNeeded(
     TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
     iree_allocator_t heap_allocator);
 
-// Binds the given |buffer| to the tensor and maps it.
+// Binds the given |buffer| to the tensor and maps it if it is host-mappable.
 // The tensor shape will be overwritten with the buffer view shape.
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer);
@@ -197,6 +197,30 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_HAL_COMMAND_BUFFER_VALIDATION_ENABLE 1
 #endif  // IREE_HAL_COMMAND_BUFFER_VALIDATION_ENABLE
 
+#if !defined(IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE)
+// Enables an optimization pass over deferred command buffers when recording
+// ends that merges adjacent fills/copies, redundant barriers, and push constant
+// updates. Disable to replay commands exactly as they were recorded when
+// debugging or benchmarking command buffers.
+#define IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE 1
+#endif  // IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+
+#if !defined(IREE_HAL_COLLECTIVE_BATCH_FUSION_BUCKET_SIZE)
+// Maximum size in bytes of a fused allreduce built by collective batches from
+// smaller allreduces on the same channel over contiguous buffer ranges. Many
+// tiny allreduces are latency bound and fusing them into fewer channel calls
+// amortizes the per-call overhead. Set to 0 to disable fusion.
+#define IREE_HAL_COLLECTIVE_BATCH_FUSION_BUCKET_SIZE (25 * 1024 * 1024)
+#endif  // IREE_HAL_COLLECTIVE_BATCH_FUSION_BUCKET_SIZE
+
+#if !defined(IREE_HAL_SEMAPHORE_WAIT_SPIN_NS)
+// Duration in nanoseconds that host waits on multiple semaphores spin before
+// blocking in the system wait APIs. Waits that are expected to be short (such
+// as fanning in many fences that are nearly complete) avoid the cost of a
+// sleep/wake cycle. Set to 0 to always block immediately.
+#define IREE_HAL_SEMAPHORE_WAIT_SPIN_NS (2 * 1000)
+#endif  // IREE_HAL_SEMAPHORE_WAIT_SPIN_NS
+
 #if !defined(IREE_HAL_MODULE_STRING_UTIL_ENABLE)
 // Enables HAL module methods that perform string printing/parsing.
 // This functionality pulls in a large amount of string manipulation code that
@@ -221,6 +245,13 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_BACKTRACE_ENABLE 1
 #endif  // !IREE_VM_BACKTRACE_ENABLE
 
+#if !defined(IREE_VM_PROFILING_ENABLE)
+// Enables sampling of VM stacks by an iree_vm_profiler_t when one is attached
+// to a context. When no profiler is attached the only overhead is a branch on
+// each function enter/leave.
+#define IREE_VM_PROFILING_ENABLE 1
+#endif  // !IREE_VM_PROFILING_ENABLE
+
 #if !defined(IREE_VM_EXECUTION_TRACING_ENABLE)
 // Enables disassembly of vm bytecode functions and stderr dumping of execution.
 // Increases code size quite, lowers VM performance, and is generally unsafe;
@@ -258,6 +289,29 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE 0
 #endif  // IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 
+#if !defined(IREE_VM_BYTECODE_JIT_ENABLE)
+// Enables the experimental baseline JIT for bytecode functions. Loops that
+// take enough backward branches are translated to native code covering the
+// integer ops and branches within them and fall back to the interpreter for
+// everything else. Only x86_64 Linux/Android/macOS hosts generate code; the
+// interpreter is used unchanged on others and when the host does not allow
+// mapping pages as executable.
+#define IREE_VM_BYTECODE_JIT_ENABLE 0
+#endif  // !IREE_VM_BYTECODE_JIT_ENABLE
+
+#if !defined(IREE_VM_REF_NONATOMIC_UNSAFE)
+// Uses non-atomic read-modify-write sequences when the VM retains and releases
+// ref objects (iree_vm_ref_t). This removes locked instructions from the
+// retain/release traffic of list- and buffer-heavy programs but requires that
+// every object the VM references is only ever retained or released on a
+// single thread - including by HAL drivers and executors that may release
+// resources from their own threads. Reference counts are stored in the objects
+// themselves and are shared by all contexts so this cannot be scoped to a
+// single context. Only enable with synchronous drivers (such as local-sync) in
+// single-threaded hosts.
+#define IREE_VM_REF_NONATOMIC_UNSAFE 0
+#endif  // !IREE_VM_REF_NONATOMIC_UNSAFE
+
 #if !defined(IREE_VM_EXT_F32_ENABLE)
 // Enables the 32-bit floating-point instruction extension.
 // Targeted from the compiler with `-iree-vm-target-extension-f32`.
@@ -11,6 +11,221 @@
 
 #include "iree/base/tracing.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define IREE_ARENA_HAVE_PAGE_MAPPING 1
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define IREE_ARENA_HAVE_PAGE_MAPPING 1
+#endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// Block page mapping
+//===----------------------------------------------------------------------===//
+
+// Flags that require blocks to be mapped directly from the system.
+#define IREE_ARENA_BLOCK_POOL_PAGE_MAPPING_FLAGS \
+  (IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES | IREE_ARENA_BLOCK_POOL_FLAG_LOCKED)
+
+// Returns the normal system page size.
+static iree_host_size_t iree_arena_page_size(void) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return system_info.dwPageSize;
+#elif defined(IREE_ARENA_HAVE_PAGE_MAPPING)
+  return (iree_host_size_t)sysconf(_SC_PAGESIZE);
+#else
+  return 4096;
+#endif  // IREE_PLATFORM_*
+}
+
+// Touches each page in |base| so that it is faulted in.
+static void iree_arena_prefault_pages(uint8_t* base, iree_host_size_t size,
+                                      iree_host_size_t page_size) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, size);
+  for (iree_host_size_t offset = 0; offset < size; offset += page_size) {
+    ((volatile uint8_t*)base)[offset] = 0;
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+#if defined(IREE_ARENA_HAVE_PAGE_MAPPING)
+
+// Returns the size of the page mapping used for blocks of |total_block_size|.
+static iree_host_size_t iree_arena_block_mapping_size(
+    iree_host_size_t total_block_size) {
+  return iree_host_align(total_block_size, iree_arena_page_size());
+}
+
+// Maps |size| bytes of read/write pages as requested by |flags|.
+static iree_status_t iree_arena_map_pages(iree_arena_block_pool_flags_t flags,
+                                          iree_host_size_t size,
+                                          void** out_base) {
+  const bool large_pages =
+      (flags & IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES) &&
+      (size % IREE_ARENA_LARGE_PAGE_SIZE) == 0;
+  void* base = NULL;
+
+#if defined(IREE_PLATFORM_WINDOWS)
+  // Large pages require SeLockMemoryPrivilege and are always locked; when
+  // unavailable we fall back to normal pages.
+  if (large_pages && GetLargePageMinimum() != 0 &&
+      (size % GetLargePageMinimum()) == 0) {
+    base = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                        PAGE_READWRITE);
+  }
+  if (!base) {
+    base = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  }
+  if (!base) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "VirtualAlloc of %" PRIhsz " byte block failed",
+                            size);
+  }
+  if (flags & IREE_ARENA_BLOCK_POOL_FLAG_LOCKED) {
+    // NOTE: best-effort; the working set may be too small to lock the block.
+    VirtualLock(base, size);
+  }
+#else
+  base = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+  // Explicit huge pages only succeed if the system has them reserved.
+  if (large_pages) {
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif  // MAP_HUGETLB
+  if (base == MAP_FAILED && large_pages) {
+    // Transparent huge pages require large page alignment so we over-allocate
+    // and unmap the unaligned head and tail.
+    uint8_t* unaligned_base =
+        (uint8_t*)mmap(NULL, size + IREE_ARENA_LARGE_PAGE_SIZE,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                       0);
+    if ((void*)unaligned_base != MAP_FAILED) {
+      uint8_t* aligned_base = (uint8_t*)iree_host_align(
+          (uintptr_t)unaligned_base, IREE_ARENA_LARGE_PAGE_SIZE);
+      iree_host_size_t head_size = aligned_base - unaligned_base;
+      iree_host_size_t tail_size = IREE_ARENA_LARGE_PAGE_SIZE - head_size;
+      if (head_size) munmap(unaligned_base, head_size);
+      if (tail_size) munmap(aligned_base + size, tail_size);
+      base = aligned_base;
+#if defined(MADV_HUGEPAGE)
+      madvise(base, size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+    }
+  }
+  if (base == MAP_FAILED) {
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (base == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mmap of %" PRIhsz " byte block failed", size);
+  }
+  if (flags & IREE_ARENA_BLOCK_POOL_FLAG_LOCKED) {
+    // NOTE: best-effort; RLIMIT_MEMLOCK may prevent locking the block.
+    mlock(base, size);
+  }
+#endif  // IREE_PLATFORM_WINDOWS
+
+  *out_base = base;
+  return iree_ok_status();
+}
+
+// Unmaps pages previously mapped with iree_arena_map_pages.
+static void iree_arena_unmap_pages(void* base, iree_host_size_t size) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  VirtualFree(base, 0, MEM_RELEASE);
+#else
+  munmap(base, size);
+#endif  // IREE_PLATFORM_WINDOWS
+}
+
+#endif  // IREE_ARENA_HAVE_PAGE_MAPPING
+
+// Allocates the storage for a single block of the |block_pool|.
+static iree_status_t iree_arena_block_pool_allocate_block(
+    iree_arena_block_pool_t* block_pool, uint8_t** out_block_base) {
+#if defined(IREE_ARENA_HAVE_PAGE_MAPPING)
+  if (block_pool->flags & IREE_ARENA_BLOCK_POOL_PAGE_MAPPING_FLAGS) {
+    iree_host_size_t mapping_size =
+        iree_arena_block_mapping_size(block_pool->total_block_size);
+    IREE_RETURN_IF_ERROR(iree_arena_map_pages(block_pool->flags, mapping_size,
+                                              (void**)out_block_base));
+    if (block_pool->flags & IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT) {
+      iree_arena_prefault_pages(*out_block_base, mapping_size,
+                                iree_arena_page_size());
+    }
+    return iree_ok_status();
+  }
+#endif  // IREE_ARENA_HAVE_PAGE_MAPPING
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+      block_pool->block_allocator, block_pool->total_block_size,
+      (void**)out_block_base));
+  if (block_pool->flags & IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT) {
+    iree_arena_prefault_pages(*out_block_base, block_pool->total_block_size,
+                              iree_arena_page_size());
+  }
+  return iree_ok_status();
+}
+
+// Frees the storage for a single block allocated with
+// iree_arena_block_pool_allocate_block.
+static void iree_arena_block_pool_free_block(
+    iree_arena_block_pool_t* block_pool, uint8_t* block_base) {
+#if defined(IREE_ARENA_HAVE_PAGE_MAPPING)
+  if (block_pool->flags & IREE_ARENA_BLOCK_POOL_PAGE_MAPPING_FLAGS) {
+    iree_arena_unmap_pages(
+        block_base,
+        iree_arena_block_mapping_size(block_pool->total_block_size));
+    return;
+  }
+#endif  // IREE_ARENA_HAVE_PAGE_MAPPING
+  iree_allocator_free(block_pool->block_allocator, block_base);
+}
+
+iree_status_t iree_arena_allocate_pages(iree_arena_block_pool_flags_t flags,
+                                        iree_host_size_t size,
+                                        void** out_base) {
+  IREE_ASSERT_ARGUMENT(out_base);
+  *out_base = NULL;
+#if defined(IREE_ARENA_HAVE_PAGE_MAPPING)
+  if (flags & IREE_ARENA_BLOCK_POOL_PAGE_MAPPING_FLAGS) {
+    iree_host_size_t mapping_size = iree_arena_block_mapping_size(size);
+    IREE_RETURN_IF_ERROR(iree_arena_map_pages(flags, mapping_size, out_base));
+    if (flags & IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT) {
+      iree_arena_prefault_pages((uint8_t*)*out_base, mapping_size,
+                                iree_arena_page_size());
+    }
+    return iree_ok_status();
+  }
+#endif  // IREE_ARENA_HAVE_PAGE_MAPPING
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(iree_allocator_system(), size, out_base));
+  if (flags & IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT) {
+    iree_arena_prefault_pages((uint8_t*)*out_base, size,
+                              iree_arena_page_size());
+  }
+  return iree_ok_status();
+}
+
+void iree_arena_free_pages(iree_arena_block_pool_flags_t flags,
+                           iree_host_size_t size, void* base) {
+  if (!base) return;
+#if defined(IREE_ARENA_HAVE_PAGE_MAPPING)
+  if (flags & IREE_ARENA_BLOCK_POOL_PAGE_MAPPING_FLAGS) {
+    iree_arena_unmap_pages(base, iree_arena_block_mapping_size(size));
+    return;
+  }
+#endif  // IREE_ARENA_HAVE_PAGE_MAPPING
+  iree_allocator_free(iree_allocator_system(), base);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_arena_block_pool_t
 //===----------------------------------------------------------------------===//
@@ -18,12 +233,21 @@
 void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
                                       iree_allocator_t block_allocator,
                                       iree_arena_block_pool_t* out_block_pool) {
+  iree_arena_block_pool_initialize_with_flags(
+      total_block_size, IREE_ARENA_BLOCK_POOL_FLAG_NONE, block_allocator,
+      out_block_pool);
+}
+
+void iree_arena_block_pool_initialize_with_flags(
+    iree_host_size_t total_block_size, iree_arena_block_pool_flags_t flags,
+    iree_allocator_t block_allocator, iree_arena_block_pool_t* out_block_pool) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   memset(out_block_pool, 0, sizeof(*out_block_pool));
   out_block_pool->total_block_size = total_block_size;
   out_block_pool->usable_block_size =
       total_block_size - sizeof(iree_arena_block_t);
+  out_block_pool->flags = flags;
   out_block_pool->block_allocator = block_allocator;
   iree_atomic_arena_block_slist_initialize(&out_block_pool->available_slist);
 
@@ -49,9 +273,9 @@ void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
       &block_pool->available_slist,
       IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
   while (head) {
-    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
+    uint8_t* block_base = (uint8_t*)head - block_pool->usable_block_size;
     head = head->next;
-    iree_allocator_free(block_pool->block_allocator, ptr);
+    iree_arena_block_pool_free_block(block_pool, block_base);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -73,9 +297,7 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
     // to be a need for more anyway.
     uint8_t* block_base = NULL;
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_allocator_malloc_uninitialized(block_pool->block_allocator,
-                                                block_pool->total_block_size,
-                                                (void**)&block_base));
+        z0, iree_arena_block_pool_allocate_block(block_pool, &block_base));
     block = (iree_arena_block_t*)(block_base + block_pool->usable_block_size);
   }
 
@@ -86,6 +308,31 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
   return iree_ok_status();
 }
 
+iree_status_t iree_arena_block_pool_preallocate(
+    iree_arena_block_pool_t* block_pool, iree_host_size_t block_count) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, block_count);
+
+  // Allocate the blocks into a local list so a failure can return them all.
+  iree_arena_block_t* head = NULL;
+  iree_arena_block_t* tail = NULL;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < block_count; ++i) {
+    uint8_t* block_base = NULL;
+    status = iree_arena_block_pool_allocate_block(block_pool, &block_base);
+    if (!iree_status_is_ok(status)) break;
+    iree_arena_block_t* block =
+        (iree_arena_block_t*)(block_base + block_pool->usable_block_size);
+    block->next = head;
+    head = block;
+    if (!tail) tail = block;
+  }
+  if (head) iree_arena_block_pool_release(block_pool, head, tail);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
                                    iree_arena_block_t* block_head,
                                    iree_arena_block_t* block_tail) {
@@ -34,6 +34,50 @@ typedef struct iree_arena_block_t {
 IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
                                 offsetof(iree_arena_block_t, next));
 
+// Size of the large pages used to back blocks when
+// IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES is specified. 2MB is the large page
+// size on common x86-64 and arm64 configurations.
+#define IREE_ARENA_LARGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Controls how blocks in an iree_arena_block_pool_t are allocated.
+enum iree_arena_block_pool_flag_bits_t {
+  IREE_ARENA_BLOCK_POOL_FLAG_NONE = 0u,
+
+  // Blocks are mapped directly from the system instead of allocated from the
+  // block allocator and backed by large pages (IREE_ARENA_LARGE_PAGE_SIZE) to
+  // reduce TLB pressure. Explicit huge pages are used when the system has them
+  // reserved and otherwise transparent huge pages are requested. Only takes
+  // effect when the total block size is a multiple of the large page size;
+  // other blocks are backed by normal pages.
+  IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES = 1u << 0,
+
+  // Blocks are pre-faulted when allocated so that the first use of each block
+  // does not take page faults.
+  IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT = 1u << 1,
+
+  // Blocks are mapped directly from the system and locked into physical memory
+  // so that they are never paged out. Locking is best-effort and blocks are
+  // still returned if the system limits (such as RLIMIT_MEMLOCK) are exceeded.
+  IREE_ARENA_BLOCK_POOL_FLAG_LOCKED = 1u << 2,
+};
+typedef uint32_t iree_arena_block_pool_flags_t;
+
+// Allocates at least |size| bytes of zero-initialized read/write memory for
+// long-lived scratch use as controlled by |flags| (any
+// iree_arena_block_pool_flag_bits_t). Allocations that request large pages or
+// locking are mapped directly from the system where supported and otherwise
+// allocated from the system allocator. Memory mapped from the system is only
+// faulted in on first touch (unless IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT is
+// set) so on NUMA systems it is placed on the node of the first thread to
+// touch it. Must be freed with iree_arena_free_pages using the same |flags|
+// and |size|.
+iree_status_t iree_arena_allocate_pages(iree_arena_block_pool_flags_t flags,
+                                        iree_host_size_t size, void** out_base);
+
+// Frees memory allocated with iree_arena_allocate_pages.
+void iree_arena_free_pages(iree_arena_block_pool_flags_t flags,
+                           iree_host_size_t size, void* base);
+
 // A simple atomic fixed-size block pool.
 // Blocks are allocated from the system as required and kept in the pool to
 // satisfy future requests. Blocks are all of a uniform size specified when the
@@ -49,7 +93,11 @@ typedef struct iree_arena_block_pool_t {
   iree_host_size_t total_block_size;
   // Block size, in bytes, of the usable bytes within a block.
   iree_host_size_t usable_block_size;
+  // Flags controlling how blocks are allocated.
+  iree_arena_block_pool_flags_t flags;
   // Allocator used for allocating/freeing each allocation block.
+  // Unused for blocks mapped directly from the system as requested by |flags|
+  // but still used for oversized arena allocations.
   iree_allocator_t block_allocator;
   // Linked list of free blocks (LIFO).
   iree_atomic_arena_block_slist_t available_slist;
@@ -63,6 +111,13 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
                                       iree_allocator_t block_allocator,
                                       iree_arena_block_pool_t* out_block_pool);
 
+// Initializes a new block pool in |out_block_pool| as with
+// iree_arena_block_pool_initialize but with |flags| controlling how the blocks
+// are allocated.
+void iree_arena_block_pool_initialize_with_flags(
+    iree_host_size_t total_block_size, iree_arena_block_pool_flags_t flags,
+    iree_allocator_t block_allocator, iree_arena_block_pool_t* out_block_pool);
+
 // Deinitializes a block pool and frees all allocations.
 // All blocks that were acquired from the pool must have already been released
 // back to it.
@@ -72,6 +127,13 @@ void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool);
 // Acquired blocks are not freed and remain valid.
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool);
 
+// Allocates |block_count| blocks and adds them to the pool so that future
+// acquisitions do not need to allocate. Combined with
+// IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT this moves the cost of the first use of
+// the blocks to the time of the call.
+iree_status_t iree_arena_block_pool_preallocate(
+    iree_arena_block_pool_t* block_pool, iree_host_size_t block_count);
+
 // Acquires a single block from the pool and returns it in |out_block|.
 // The block may be either a new allocation with undefined contents or a reused
 // prior allocation with undefined contents.
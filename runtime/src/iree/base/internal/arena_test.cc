@@ -0,0 +1,80 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/arena.h"
+
+#include <cstring>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Acquires and writes to two blocks from a pool initialized with |flags| and
+// returns them to the pool.
+static void AcquireAndReleaseBlocks(iree_host_size_t total_block_size,
+                                    iree_arena_block_pool_flags_t flags) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize_with_flags(
+      total_block_size, flags, iree_allocator_system(), &block_pool);
+
+  IREE_ASSERT_OK(iree_arena_block_pool_preallocate(&block_pool, 1));
+
+  iree_arena_block_t* block_a = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block_a));
+  iree_arena_block_t* block_b = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block_b));
+  ASSERT_NE(block_a, block_b);
+  memset((uint8_t*)block_a - block_pool.usable_block_size, 0xAA,
+         block_pool.usable_block_size);
+  memset((uint8_t*)block_b - block_pool.usable_block_size, 0xBB,
+         block_pool.usable_block_size);
+
+  block_a->next = block_b;
+  iree_arena_block_pool_release(&block_pool, block_a, block_b);
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+TEST(ArenaBlockPoolTest, DefaultBlocks) {
+  AcquireAndReleaseBlocks(4096, IREE_ARENA_BLOCK_POOL_FLAG_NONE);
+}
+
+TEST(ArenaBlockPoolTest, PrefaultedBlocks) {
+  AcquireAndReleaseBlocks(32 * 1024, IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT);
+}
+
+// Large pages are used opportunistically and fall back to normal pages when
+// unavailable on the system.
+TEST(ArenaBlockPoolTest, LargePageBlocks) {
+  AcquireAndReleaseBlocks(IREE_ARENA_LARGE_PAGE_SIZE,
+                          IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES |
+                              IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT);
+}
+
+// Block sizes need not be a multiple of the page size.
+TEST(ArenaBlockPoolTest, LockedUnalignedBlocks) {
+  AcquireAndReleaseBlocks(4096 + 123, IREE_ARENA_BLOCK_POOL_FLAG_LOCKED);
+}
+
+TEST(ArenaTest, AllocateFromPrefaultedPool) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize_with_flags(
+      4096, IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT, iree_allocator_system(),
+      &block_pool);
+  iree_arena_allocator_t arena;
+  iree_arena_initialize(&block_pool, &arena);
+  void* small_ptr = NULL;
+  IREE_ASSERT_OK(iree_arena_allocate(&arena, 128, &small_ptr));
+  memset(small_ptr, 0xCD, 128);
+  // Oversized allocations still go to the block allocator.
+  void* large_ptr = NULL;
+  IREE_ASSERT_OK(iree_arena_allocate(&arena, 16 * 1024, &large_ptr));
+  memset(large_ptr, 0xCD, 16 * 1024);
+  iree_arena_deinitialize(&arena);
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+}  // namespace
@@ -0,0 +1,136 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/atomic_ring.h"
+
+#include <string.h>
+
+#include "iree/base/tracing.h"
+
+// Returns the signed distance from position |b| to position |a|.
+// Positions are free-running and wrap so the math is done unsigned.
+static inline intptr_t iree_atomic_ring_distance(intptr_t a, intptr_t b) {
+  return (intptr_t)((uintptr_t)a - (uintptr_t)b);
+}
+
+static inline intptr_t iree_atomic_ring_advance(intptr_t position,
+                                                uintptr_t amount) {
+  return (intptr_t)((uintptr_t)position + amount);
+}
+
+iree_status_t iree_atomic_ring_initialize(iree_host_size_t capacity,
+                                          iree_allocator_t allocator,
+                                          iree_atomic_ring_t* out_ring) {
+  IREE_ASSERT_ARGUMENT(out_ring);
+  memset(out_ring, 0, sizeof(*out_ring));
+  if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "ring capacity must be a power of two >= 2 but got "
+                            "%" PRIhsz,
+                            capacity);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, capacity);
+
+  iree_atomic_ring_cell_t* cells = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, capacity * sizeof(*cells),
+                                (void**)&cells));
+  for (iree_host_size_t i = 0; i < capacity; ++i) {
+    iree_atomic_store_intptr(&cells[i].sequence, (intptr_t)i,
+                             iree_memory_order_relaxed);
+  }
+
+  out_ring->allocator = allocator;
+  out_ring->capacity_mask = (uintptr_t)capacity - 1;
+  out_ring->cells = cells;
+  iree_atomic_store_intptr(&out_ring->enqueue_position, 0,
+                           iree_memory_order_relaxed);
+  iree_atomic_store_intptr(&out_ring->dequeue_position, 0,
+                           iree_memory_order_relaxed);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_atomic_ring_deinitialize(iree_atomic_ring_t* ring) {
+  if (!ring->cells) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_free(ring->allocator, ring->cells);
+  ring->cells = NULL;
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_atomic_ring_try_push(iree_atomic_ring_t* ring, void* value) {
+  iree_atomic_ring_cell_t* cell = NULL;
+  intptr_t position = iree_atomic_load_intptr(&ring->enqueue_position,
+                                              iree_memory_order_relaxed);
+  for (;;) {
+    cell = &ring->cells[(uintptr_t)position & ring->capacity_mask];
+    intptr_t sequence =
+        iree_atomic_load_intptr(&cell->sequence, iree_memory_order_acquire);
+    intptr_t distance = iree_atomic_ring_distance(sequence, position);
+    if (distance == 0) {
+      // Cell is free for this position; try to claim it. On failure |position|
+      // is updated to the current enqueue position.
+      if (iree_atomic_compare_exchange_weak_intptr(
+              &ring->enqueue_position, &position,
+              iree_atomic_ring_advance(position, 1), iree_memory_order_relaxed,
+              iree_memory_order_relaxed)) {
+        break;
+      }
+    } else if (distance < 0) {
+      // Cell still holds the value from the previous lap: ring is full.
+      return false;
+    } else {
+      // Another producer claimed the position; catch up.
+      position = iree_atomic_load_intptr(&ring->enqueue_position,
+                                         iree_memory_order_relaxed);
+    }
+  }
+  cell->value = value;
+  iree_atomic_store_intptr(&cell->sequence,
+                           iree_atomic_ring_advance(position, 1),
+                           iree_memory_order_release);
+  return true;
+}
+
+bool iree_atomic_ring_try_pop(iree_atomic_ring_t* ring, void** out_value) {
+  iree_atomic_ring_cell_t* cell = NULL;
+  intptr_t position = iree_atomic_load_intptr(&ring->dequeue_position,
+                                              iree_memory_order_relaxed);
+  for (;;) {
+    cell = &ring->cells[(uintptr_t)position & ring->capacity_mask];
+    intptr_t sequence =
+        iree_atomic_load_intptr(&cell->sequence, iree_memory_order_acquire);
+    intptr_t distance = iree_atomic_ring_distance(
+        sequence, iree_atomic_ring_advance(position, 1));
+    if (distance == 0) {
+      // Cell holds the value for this position; try to claim it. On failure
+      // |position| is updated to the current dequeue position.
+      if (iree_atomic_compare_exchange_weak_intptr(
+              &ring->dequeue_position, &position,
+              iree_atomic_ring_advance(position, 1), iree_memory_order_relaxed,
+              iree_memory_order_relaxed)) {
+        break;
+      }
+    } else if (distance < 0) {
+      // Cell has not yet been written for this position: ring is empty.
+      return false;
+    } else {
+      // Another consumer claimed the position; catch up.
+      position = iree_atomic_load_intptr(&ring->dequeue_position,
+                                         iree_memory_order_relaxed);
+    }
+  }
+  *out_value = cell->value;
+  // Mark the cell as free for the producer one lap ahead.
+  iree_atomic_store_intptr(
+      &cell->sequence,
+      iree_atomic_ring_advance(position, ring->capacity_mask + 1),
+      iree_memory_order_release);
+  return true;
+}
@@ -0,0 +1,92 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: the best kind of synchronization is no synchronization; always try to
+// design your algorithm so that you don't need anything from this file :)
+// See https://travisdowns.github.io/blog/2020/07/06/concurrency-costs.html
+
+#ifndef IREE_BASE_INTERNAL_ATOMIC_RING_H_
+#define IREE_BASE_INTERNAL_ATOMIC_RING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iree/base/alignment.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// DO NOT USE: implementation detail.
+typedef struct iree_atomic_ring_cell_t {
+  // Position of the value in the cell relative to the ring positions; used to
+  // determine whether the cell is ready to be written or read.
+  iree_atomic_intptr_t sequence;
+  void* value;
+} iree_atomic_ring_cell_t;
+
+// Bounded lock-free multi-producer/multi-consumer FIFO queue of pointers.
+// Based on Dmitry Vyukov's bounded MPMC queue:
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+//
+// Each push and pop costs a single CAS on the producer or consumer position in
+// the uncontended case and producers and consumers only contend with each other
+// on the cell they are accessing. Unlike iree_atomic_slist_t values are
+// returned in the order they were pushed (for pushes that are ordered with
+// respect to each other) and no list reversal is required to get FIFO order.
+//
+// The queue has a fixed capacity specified at initialization and pushes fail
+// when it is full. Pops fail when the queue is empty; callers needing to block
+// must pair the ring with a notification (see iree_notification_t).
+//
+// Thread-safe; multiple threads may push and pop concurrently.
+typedef struct iree_atomic_ring_t {
+  // Immutable after initialization.
+  iree_allocator_t allocator;
+  uintptr_t capacity_mask;
+  iree_atomic_ring_cell_t* cells;
+
+  // Producer and consumer positions live on their own cache lines so that
+  // producers and consumers don't false share.
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_atomic_intptr_t enqueue_position;
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_atomic_intptr_t dequeue_position;
+} iree_atomic_ring_t;
+
+// Initializes a ring in |out_ring| that can hold up to |capacity| values.
+// |capacity| must be a power of two >= 2.
+// |allocator| is used to allocate the ring storage.
+iree_status_t iree_atomic_ring_initialize(iree_host_size_t capacity,
+                                          iree_allocator_t allocator,
+                                          iree_atomic_ring_t* out_ring);
+
+// Deinitializes a ring and frees its storage. Any values still in the ring are
+// dropped.
+void iree_atomic_ring_deinitialize(iree_atomic_ring_t* ring);
+
+// Returns the total number of values the ring can hold.
+static inline iree_host_size_t iree_atomic_ring_capacity(
+    const iree_atomic_ring_t* ring) {
+  return (iree_host_size_t)ring->capacity_mask + 1;
+}
+
+// Pushes |value| to the back of the ring.
+// Returns false if the ring is full and the value was not pushed.
+bool iree_atomic_ring_try_push(iree_atomic_ring_t* ring, void* value);
+
+// Pops a value from the front of the ring and returns it in |out_value|.
+// Returns false if the ring is empty.
+bool iree_atomic_ring_try_pop(iree_atomic_ring_t* ring, void** out_value);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // IREE_BASE_INTERNAL_ATOMIC_RING_H_
@@ -0,0 +1,105 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Compares FIFO handoff through iree_atomic_ring_t against the
+// iree_atomic_slist_t flush-and-reverse pattern it can replace.
+
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/internal/atomic_ring.h"
+#include "iree/base/internal/atomic_slist.h"
+
+namespace {
+
+// Number of values each thread pushes and then pops per iteration.
+constexpr int kValuesPerIteration = 8;
+
+//==============================================================================
+// iree_atomic_ring_t
+//==============================================================================
+
+void BM_AtomicRing(benchmark::State& state) {
+  static iree_atomic_ring_t* ring = ([]() -> iree_atomic_ring_t* {
+    auto ring = new iree_atomic_ring_t();
+    IREE_CHECK_OK(
+        iree_atomic_ring_initialize(1024, iree_allocator_system(), ring));
+    return ring;
+  })();
+  for (auto _ : state) {
+    for (int i = 0; i < kValuesPerIteration; ++i) {
+      while (!iree_atomic_ring_try_push(ring, (void*)(uintptr_t)(i + 1))) {
+      }
+    }
+    for (int i = 0; i < kValuesPerIteration; ++i) {
+      void* value = NULL;
+      while (!iree_atomic_ring_try_pop(ring, &value)) {
+      }
+      benchmark::DoNotOptimize(value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kValuesPerIteration);
+}
+BENCHMARK(BM_AtomicRing)->UseRealTime()->Threads(1)->ThreadPerCpu();
+
+//==============================================================================
+// iree_atomic_slist_t
+//==============================================================================
+
+typedef struct slist_entry_t {
+  iree_atomic_slist_intrusive_ptr_t slist_next;
+  uintptr_t value;
+} slist_entry_t;
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(bm, slist_entry_t,
+                                offsetof(slist_entry_t, slist_next));
+
+// Pushes to a shared slist and flushes it in FIFO order as done by the task
+// system today. Each thread pops whatever has been published, which may
+// include values from other threads.
+void BM_AtomicSList(benchmark::State& state) {
+  static bm_slist_t* list = ([]() -> bm_slist_t* {
+    auto list = new bm_slist_t();
+    bm_slist_initialize(list);
+    return list;
+  })();
+  slist_entry_t entries[kValuesPerIteration];
+  for (int i = 0; i < kValuesPerIteration; ++i) entries[i].value = i + 1;
+  for (auto _ : state) {
+    for (int i = 0; i < kValuesPerIteration; ++i) {
+      bm_slist_push(list, &entries[i]);
+    }
+    // Keep popping until we have reclaimed our own entries; the entries of
+    // other threads we pull out are handed back.
+    int remaining = kValuesPerIteration;
+    while (remaining > 0) {
+      slist_entry_t* head = NULL;
+      slist_entry_t* tail = NULL;
+      if (!bm_slist_flush(list, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
+                          &head, &tail)) {
+        continue;
+      }
+      slist_entry_t* others_head = NULL;
+      slist_entry_t* others_tail = NULL;
+      while (head) {
+        slist_entry_t* next = bm_slist_get_next(head);
+        if (head >= entries && head < entries + kValuesPerIteration) {
+          benchmark::DoNotOptimize(head->value);
+          --remaining;
+        } else {
+          bm_slist_set_next(head, others_head);
+          if (!others_tail) others_tail = head;
+          others_head = head;
+        }
+        head = next;
+      }
+      if (others_head) bm_slist_concat(list, others_head, others_tail);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kValuesPerIteration);
+}
+BENCHMARK(BM_AtomicSList)->UseRealTime()->Threads(1)->ThreadPerCpu();
+
+}  // namespace
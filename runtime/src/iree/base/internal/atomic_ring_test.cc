@@ -0,0 +1,142 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/atomic_ring.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+TEST(AtomicRing, InvalidCapacity) {
+  iree_atomic_ring_t ring;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_INVALID_ARGUMENT,
+      iree_atomic_ring_initialize(0, iree_allocator_system(), &ring));
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_INVALID_ARGUMENT,
+      iree_atomic_ring_initialize(1, iree_allocator_system(), &ring));
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_INVALID_ARGUMENT,
+      iree_atomic_ring_initialize(12, iree_allocator_system(), &ring));
+}
+
+TEST(AtomicRing, BasicUsage) {
+  iree_atomic_ring_t ring;
+  IREE_ASSERT_OK(
+      iree_atomic_ring_initialize(4, iree_allocator_system(), &ring));
+  EXPECT_EQ(4, iree_atomic_ring_capacity(&ring));
+
+  // Ring starts empty.
+  void* value = NULL;
+  EXPECT_FALSE(iree_atomic_ring_try_pop(&ring, &value));
+
+  // Fill the ring; pushes fail once it is full.
+  for (uintptr_t i = 1; i <= 4; ++i) {
+    EXPECT_TRUE(iree_atomic_ring_try_push(&ring, (void*)i));
+  }
+  EXPECT_FALSE(iree_atomic_ring_try_push(&ring, (void*)5));
+
+  // Values come out in FIFO order.
+  for (uintptr_t i = 1; i <= 4; ++i) {
+    ASSERT_TRUE(iree_atomic_ring_try_pop(&ring, &value));
+    EXPECT_EQ(i, (uintptr_t)value);
+  }
+  EXPECT_FALSE(iree_atomic_ring_try_pop(&ring, &value));
+
+  iree_atomic_ring_deinitialize(&ring);
+}
+
+// Interleaves pushes and pops for many laps around the ring.
+TEST(AtomicRing, Wraparound) {
+  iree_atomic_ring_t ring;
+  IREE_ASSERT_OK(
+      iree_atomic_ring_initialize(4, iree_allocator_system(), &ring));
+  uintptr_t next_push = 1;
+  uintptr_t next_pop = 1;
+  for (int lap = 0; lap < 100; ++lap) {
+    ASSERT_TRUE(iree_atomic_ring_try_push(&ring, (void*)next_push++));
+    ASSERT_TRUE(iree_atomic_ring_try_push(&ring, (void*)next_push++));
+    ASSERT_TRUE(iree_atomic_ring_try_push(&ring, (void*)next_push++));
+    void* value = NULL;
+    ASSERT_TRUE(iree_atomic_ring_try_pop(&ring, &value));
+    EXPECT_EQ(next_pop++, (uintptr_t)value);
+    ASSERT_TRUE(iree_atomic_ring_try_pop(&ring, &value));
+    EXPECT_EQ(next_pop++, (uintptr_t)value);
+    ASSERT_TRUE(iree_atomic_ring_try_pop(&ring, &value));
+    EXPECT_EQ(next_pop++, (uintptr_t)value);
+  }
+  iree_atomic_ring_deinitialize(&ring);
+}
+
+// Tests that all values pushed by multiple producers are popped exactly once
+// by multiple consumers and that each producer's values stay in order.
+TEST(AtomicRing, MultipleProducersConsumers) {
+  constexpr int kProducerCount = 4;
+  constexpr int kConsumerCount = 4;
+  constexpr uintptr_t kValuesPerProducer = 20000;
+  iree_atomic_ring_t ring;
+  IREE_ASSERT_OK(
+      iree_atomic_ring_initialize(64, iree_allocator_system(), &ring));
+
+  // Values encode the producer in the high bits and a 1-based sequence number
+  // in the low bits.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kProducerCount; ++i) {
+    threads.emplace_back([&ring, i]() {
+      for (uintptr_t j = 1; j <= kValuesPerProducer; ++j) {
+        void* value = (void*)(((uintptr_t)i << 24) | j);
+        while (!iree_atomic_ring_try_push(&ring, value)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::atomic<uintptr_t> popped_count = {0};
+  std::vector<std::vector<uintptr_t>> popped_values(kConsumerCount);
+  for (int i = 0; i < kConsumerCount; ++i) {
+    threads.emplace_back([&, i]() {
+      while (popped_count.load() < kProducerCount * kValuesPerProducer) {
+        void* value = NULL;
+        if (iree_atomic_ring_try_pop(&ring, &value)) {
+          popped_values[i].push_back((uintptr_t)value);
+          ++popped_count;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // Each consumer must observe each producer's values in increasing order and
+  // every value must be popped once.
+  std::vector<uintptr_t> producer_sums(kProducerCount, 0);
+  for (const auto& values : popped_values) {
+    std::vector<uintptr_t> last_sequence(kProducerCount, 0);
+    for (uintptr_t value : values) {
+      uintptr_t producer = value >> 24;
+      uintptr_t sequence = value & 0xFFFFFF;
+      ASSERT_LT(producer, kProducerCount);
+      EXPECT_GT(sequence, last_sequence[producer]);
+      last_sequence[producer] = sequence;
+      producer_sums[producer] += sequence;
+    }
+  }
+  for (uintptr_t sum : producer_sums) {
+    EXPECT_EQ(sum, kValuesPerProducer * (kValuesPerProducer + 1) / 2);
+  }
+  void* value = NULL;
+  EXPECT_FALSE(iree_atomic_ring_try_pop(&ring, &value));
+
+  iree_atomic_ring_deinitialize(&ring);
+}
+
+}  // namespace
@@ -16,7 +16,103 @@
 // Platform-specific processor data queries
 //===----------------------------------------------------------------------===//
 
-#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#if defined(IREE_ARCH_X86_64)
+
+// CPUID and XGETBV are available to user code on all x86-64 operating systems
+// so the feature bits are queried directly from the processor. The OS must also
+// have enabled saving of the extended register state in XCR0 for the AVX
+// feature bits to be usable.
+
+#if defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif  // IREE_COMPILER_MSVC
+
+static void iree_cpu_cpuid(uint32_t leaf, uint32_t subleaf,
+                           uint32_t* out_regs) {
+#if defined(IREE_COMPILER_MSVC)
+  int regs[4];
+  __cpuidex(regs, (int)leaf, (int)subleaf);
+  for (int i = 0; i < 4; ++i) out_regs[i] = (uint32_t)regs[i];
+#else
+  __cpuid_count(leaf, subleaf, out_regs[0], out_regs[1], out_regs[2],
+                out_regs[3]);
+#endif  // IREE_COMPILER_MSVC
+}
+
+static uint64_t iree_cpu_xgetbv0(void) {
+#if defined(IREE_COMPILER_MSVC)
+  return _xgetbv(0);
+#else
+  // Emitted directly so that no -mxsave is required to compile this file.
+  uint32_t eax = 0, edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+#endif  // IREE_COMPILER_MSVC
+}
+
+#define IREE_CPUID_1_ECX_FMA (1u << 12)
+#define IREE_CPUID_1_ECX_OSXSAVE (1u << 27)
+#define IREE_CPUID_1_ECX_AVX (1u << 28)
+#define IREE_CPUID_7_EBX_AVX2 (1u << 5)
+#define IREE_CPUID_7_EBX_AVX512F (1u << 16)
+#define IREE_CPUID_7_EBX_AVX512DQ (1u << 17)
+#define IREE_CPUID_7_EBX_AVX512CD (1u << 28)
+#define IREE_CPUID_7_EBX_AVX512BW (1u << 30)
+#define IREE_CPUID_7_EBX_AVX512VL (1u << 31)
+#define IREE_CPUID_7_ECX_AVX512VNNI (1u << 11)
+#define IREE_CPUID_7_1_EAX_AVX512BF16 (1u << 5)
+// XMM and YMM state.
+#define IREE_XCR0_AVX_STATE 0x06ull
+// XMM, YMM, opmask, ZMM_Hi256 and Hi16_ZMM state.
+#define IREE_XCR0_AVX512_STATE 0xE6ull
+
+static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
+                                              uint64_t* out_fields) {
+  uint32_t regs[4] = {0};
+  iree_cpu_cpuid(0, 0, regs);
+  uint32_t max_leaf = regs[0];
+  if (max_leaf < 7) return;
+  iree_cpu_cpuid(1, 0, regs);
+  uint32_t leaf1_ecx = regs[2];
+  if (!iree_all_bits_set(leaf1_ecx,
+                         IREE_CPUID_1_ECX_OSXSAVE | IREE_CPUID_1_ECX_AVX)) {
+    return;
+  }
+  uint64_t xcr0 = iree_cpu_xgetbv0();
+  iree_cpu_cpuid(7, 0, regs);
+  uint32_t leaf7_max_subleaf = regs[0];
+  uint32_t leaf7_ebx = regs[1];
+  uint32_t leaf7_ecx = regs[2];
+  uint32_t leaf7_1_eax = 0;
+  if (leaf7_max_subleaf >= 1) {
+    iree_cpu_cpuid(7, 1, regs);
+    leaf7_1_eax = regs[0];
+  }
+
+  if (iree_all_bits_set(xcr0, IREE_XCR0_AVX_STATE) &&
+      iree_all_bits_set(leaf7_ebx, IREE_CPUID_7_EBX_AVX2) &&
+      iree_all_bits_set(leaf1_ecx, IREE_CPUID_1_ECX_FMA)) {
+    out_fields[0] |= IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA;
+  }
+  const uint32_t avx512_base_bits =
+      IREE_CPUID_7_EBX_AVX512F | IREE_CPUID_7_EBX_AVX512DQ |
+      IREE_CPUID_7_EBX_AVX512CD | IREE_CPUID_7_EBX_AVX512BW |
+      IREE_CPUID_7_EBX_AVX512VL;
+  if (iree_all_bits_set(xcr0, IREE_XCR0_AVX512_STATE) &&
+      iree_all_bits_set(leaf7_ebx, avx512_base_bits)) {
+    out_fields[0] |= IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE;
+    if (iree_all_bits_set(leaf7_ecx, IREE_CPUID_7_ECX_AVX512VNNI)) {
+      out_fields[0] |= IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI;
+    }
+    if (iree_all_bits_set(leaf7_1_eax, IREE_CPUID_7_1_EAX_AVX512BF16)) {
+      out_fields[0] |= IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16;
+    }
+  }
+}
+
+#elif defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 // NOTE: not all kernel versions have all of the cap bits we need defined so as
 // a practice we always define the feature bits we need locally.
@@ -35,13 +131,48 @@
 
 // https://docs.kernel.org/arm64/elf_hwcaps.html
 #define IREE_HWCAP_ASIMDDP (1 << 20)
+#define IREE_HWCAP_SVE (1 << 22)
+#define IREE_HWCAP2_SVE2 (1 << 1)
 #define IREE_HWCAP2_I8MM (1 << 13)
+#define IREE_HWCAP2_SME (1 << 23)
+
+// https://docs.kernel.org/arm64/sve.html and sme.html
+#include <sys/prctl.h>
+#define IREE_PR_SVE_GET_VL 51
+#define IREE_PR_SME_GET_VL 64
+#define IREE_PR_VL_LEN_MASK 0xFFFF
+
+// Returns the vector length in bytes reported by the prctl |option| or 0 if
+// the kernel does not support it.
+static uint64_t iree_cpu_query_vector_length(int option) {
+  int result = prctl(option, 0, 0, 0, 0);
+  return result < 0 ? 0 : (uint64_t)(result & IREE_PR_VL_LEN_MASK);
+}
+
 static void iree_cpu_query_data_arch_hwcaps(uint32_t hwcap, uint32_t hwcap2,
                                             uint64_t* out_fields) {
   IREE_SET_IF_HWCAP(hwcap, IREE_HWCAP_ASIMDDP, out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD);
   IREE_SET_IF_HWCAP(hwcap2, IREE_HWCAP2_I8MM, out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
+  if (iree_all_bits_set(hwcap, IREE_HWCAP_SVE)) {
+    uint64_t vector_bytes = iree_cpu_query_vector_length(IREE_PR_SVE_GET_VL);
+    if (vector_bytes) {
+      out_fields[0] |= IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE;
+      IREE_SET_IF_HWCAP(hwcap2, IREE_HWCAP2_SVE2, out_fields[0],
+                        IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE2);
+      out_fields[1] |= vector_bytes
+                       << IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES_SHIFT;
+    }
+  }
+  if (iree_all_bits_set(hwcap2, IREE_HWCAP2_SME)) {
+    uint64_t vector_bytes = iree_cpu_query_vector_length(IREE_PR_SME_GET_VL);
+    if (vector_bytes) {
+      out_fields[0] |= IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME;
+      out_fields[1] |= vector_bytes
+                       << IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES_SHIFT;
+    }
+  }
 }
 
 #else
@@ -81,6 +212,20 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD);
   IREE_QUERY_SYSCTL("hw.optional.arm.FEAT_I8MM", out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
+  IREE_QUERY_SYSCTL("hw.optional.arm.FEAT_SME", out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME);
+  if (out_fields[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME) {
+    int64_t svl_bytes = 0;
+    size_t svl_bytes_size = sizeof svl_bytes;
+    if (0 == sysctlbyname("hw.optional.arm.sme_max_svl_b", &svl_bytes,
+                          &svl_bytes_size, NULL, 0) &&
+        svl_bytes > 0) {
+      out_fields[1] |= (uint64_t)svl_bytes
+                       << IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES_SHIFT;
+    } else {
+      out_fields[0] &= ~IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME;
+    }
+  }
 #endif
 }
 
@@ -103,6 +248,13 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
     return true;                                                        \
   }
 
+#define IREE_TEST_FIELD_VALUE(field_key, field_value, field_name)    \
+  if (iree_string_view_equal(key, IREE_SV(field_key))) {             \
+    *out_value = (int64_t)(((field_value) & field_name##_MASK) >>    \
+                           field_name##_SHIFT);                      \
+    return true;                                                     \
+  }
+
 #if defined(IREE_ARCH_ARM_64)
 
 static bool iree_cpu_lookup_data_by_key_for_arch(
@@ -112,6 +264,32 @@ static bool iree_cpu_lookup_data_by_key_for_arch(
                       IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD);
   IREE_TEST_FIELD_BIT("i8mm", fields[0],
                       IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
+  IREE_TEST_FIELD_BIT("sve", fields[0],
+                      IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE);
+  IREE_TEST_FIELD_BIT("sve2", fields[0],
+                      IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE2);
+  IREE_TEST_FIELD_BIT("sme", fields[0],
+                      IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME);
+  IREE_TEST_FIELD_VALUE("sve_vector_bytes", fields[1],
+                        IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES);
+  IREE_TEST_FIELD_VALUE("sme_vector_bytes", fields[1],
+                        IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES);
+  return false;
+}
+
+#elif defined(IREE_ARCH_X86_64)
+
+static bool iree_cpu_lookup_data_by_key_for_arch(
+    const uint64_t* fields, iree_string_view_t key,
+    int64_t* IREE_RESTRICT out_value) {
+  IREE_TEST_FIELD_BIT("avx2_fma", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+  IREE_TEST_FIELD_BIT("avx512_base", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE);
+  IREE_TEST_FIELD_BIT("avx512vnni", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI);
+  IREE_TEST_FIELD_BIT("avx512bf16", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16);
   return false;
 }
 
@@ -127,6 +305,7 @@ static bool iree_cpu_lookup_data_by_key_for_arch(
 #endif  // IREE_ARCH_*
 
 #undef IREE_TEST_FIELD_BIT
+#undef IREE_TEST_FIELD_VALUE
 
 //===----------------------------------------------------------------------===//
 // Processor data query
@@ -135,10 +314,13 @@ static bool iree_cpu_lookup_data_by_key_for_arch(
 static iree_alignas(64) uint64_t
     iree_cpu_data_cache_[IREE_CPU_DATA_FIELD_COUNT] = {0};
 
+static void iree_cpu_dispatch_repatch_all(void);
+
 void iree_cpu_initialize(iree_allocator_t temp_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
   memset(iree_cpu_data_cache_, 0, sizeof(iree_cpu_data_cache_));
   iree_cpu_initialize_from_platform(temp_allocator, iree_cpu_data_cache_);
+  iree_cpu_dispatch_repatch_all();
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -148,6 +330,7 @@ void iree_cpu_initialize_with_data(iree_host_size_t field_count,
   memcpy(iree_cpu_data_cache_, fields,
          iree_min(field_count, IREE_ARRAYSIZE(iree_cpu_data_cache_)) *
              sizeof(*iree_cpu_data_cache_));
+  iree_cpu_dispatch_repatch_all();
 }
 
 const uint64_t* iree_cpu_data_fields(void) { return iree_cpu_data_cache_; }
@@ -175,6 +358,70 @@ iree_status_t iree_cpu_lookup_data_by_key(iree_string_view_t key,
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Function variant selection
+//===----------------------------------------------------------------------===//
+
+// Singly-linked list of all resolved dispatches. Dispatches are only ever
+// pushed and never removed as they have static storage duration.
+static iree_atomic_intptr_t iree_cpu_dispatch_registry_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+iree_host_size_t iree_cpu_select_variant(iree_host_size_t variant_count,
+                                         const iree_cpu_variant_t* variants,
+                                         const uint64_t* fields) {
+  for (iree_host_size_t i = 0; i < variant_count; ++i) {
+    bool supported = true;
+    for (iree_host_size_t j = 0; j < IREE_CPU_DATA_FIELD_COUNT; ++j) {
+      if (!iree_all_bits_set(fields[j], variants[i].required_fields[j])) {
+        supported = false;
+        break;
+      }
+    }
+    if (supported) return i;
+  }
+  return variant_count;
+}
+
+static intptr_t iree_cpu_dispatch_select(iree_cpu_dispatch_t* dispatch) {
+  iree_host_size_t index = iree_cpu_select_variant(
+      dispatch->variant_count, dispatch->variants, iree_cpu_data_cache_);
+  return index < dispatch->variant_count
+             ? (intptr_t)dispatch->variants[index].fn
+             : 0;
+}
+
+void* iree_cpu_dispatch_resolve_slow(iree_cpu_dispatch_t* dispatch) {
+  intptr_t fn = iree_cpu_dispatch_select(dispatch);
+  iree_atomic_store_intptr(&dispatch->fn, fn, iree_memory_order_release);
+
+  // Register the dispatch exactly once so that it is re-patched if the CPU
+  // data changes.
+  int32_t expected = 0;
+  if (iree_atomic_compare_exchange_strong_int32(
+          &dispatch->registered, &expected, 1, iree_memory_order_acq_rel,
+          iree_memory_order_relaxed)) {
+    intptr_t head = iree_atomic_load_intptr(&iree_cpu_dispatch_registry_,
+                                            iree_memory_order_relaxed);
+    do {
+      dispatch->next = (iree_cpu_dispatch_t*)head;
+    } while (!iree_atomic_compare_exchange_weak_intptr(
+        &iree_cpu_dispatch_registry_, &head, (intptr_t)dispatch,
+        iree_memory_order_release, iree_memory_order_relaxed));
+  }
+
+  return (void*)fn;
+}
+
+static void iree_cpu_dispatch_repatch_all(void) {
+  iree_cpu_dispatch_t* dispatch = (iree_cpu_dispatch_t*)iree_atomic_load_intptr(
+      &iree_cpu_dispatch_registry_, iree_memory_order_acquire);
+  for (; dispatch != NULL; dispatch = dispatch->next) {
+    iree_atomic_store_intptr(&dispatch->fn, iree_cpu_dispatch_select(dispatch),
+                             iree_memory_order_release);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Processor identification
 //===----------------------------------------------------------------------===//
@@ -10,6 +10,7 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/schemas/cpu_data.h"
 
 #ifdef __cplusplus
@@ -22,10 +23,13 @@ extern "C" {
 
 // Initializes cached CPU data using |temp_allocator| for any temporary
 // allocations required during initialization.
+// Re-patches all resolved iree_cpu_dispatch_t with the new data. Must not be
+// called concurrently with dispatch resolution.
 void iree_cpu_initialize(iree_allocator_t temp_allocator);
 
 // Initializes cached CPU data with the given fields.
 // Extraneous fields will be ignored and unspecified fields will be set to zero.
+// Re-patches all resolved iree_cpu_dispatch_t with the new data.
 void iree_cpu_initialize_with_data(iree_host_size_t field_count,
                                    const uint64_t* fields);
 
@@ -58,6 +62,77 @@ void iree_cpu_read_data(iree_host_size_t field_count, uint64_t* out_fields);
 iree_status_t iree_cpu_lookup_data_by_key(iree_string_view_t key,
                                           int64_t* IREE_RESTRICT out_value);
 
+//===----------------------------------------------------------------------===//
+// Function variant selection
+//===----------------------------------------------------------------------===//
+// An ifunc-style facility for choosing among multiple implementations of a
+// function based on the cached CPU data. Call sites declare a static
+// iree_cpu_dispatch_t listing their variants and resolve it to a function
+// pointer; the first resolution selects the variant and caches it such that
+// subsequent resolves are a single load and the hot path never needs to
+// re-check iree_cpu_data_field. Resolved dispatches are registered and are
+// re-patched whenever the CPU data is reinitialized.
+//
+// Example:
+//  static const iree_cpu_variant_t my_fn_variants[] = {
+//      {.fn = (void*)my_fn_dotprod,
+//       .required_fields = {IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD}},
+//      {.fn = (void*)my_fn_generic},
+//  };
+//  static iree_cpu_dispatch_t my_fn_dispatch =
+//      IREE_CPU_DISPATCH_INITIALIZER(my_fn_variants);
+//  my_fn_t my_fn = (my_fn_t)iree_cpu_dispatch_resolve(&my_fn_dispatch);
+
+// A function implementation requiring a set of CPU features.
+typedef struct iree_cpu_variant_t {
+  // Function pointer of the implementation.
+  void* fn;
+  // Bits that must all be set in the CPU data field of the same index for the
+  // variant to be selected. A variant with no bits set is always supported.
+  uint64_t required_fields[IREE_CPU_DATA_FIELD_COUNT];
+} iree_cpu_variant_t;
+
+// Returns the index of the first variant in |variants| whose required fields
+// are all set in |fields| or |variant_count| if none are supported.
+// Variants should be ordered from most to least specialized.
+iree_host_size_t iree_cpu_select_variant(iree_host_size_t variant_count,
+                                         const iree_cpu_variant_t* variants,
+                                         const uint64_t* fields);
+
+// A lazily-resolved function pointer selected from a list of variants.
+// Must have static storage duration once resolved as it is registered for
+// re-patching when CPU data changes. Initialize with
+// IREE_CPU_DISPATCH_INITIALIZER.
+typedef struct iree_cpu_dispatch_t {
+  // Selected function pointer or 0 if not yet resolved.
+  iree_atomic_intptr_t fn;
+  // Nonzero once the dispatch has been added to the registry.
+  iree_atomic_int32_t registered;
+  // Next dispatch in the registry.
+  struct iree_cpu_dispatch_t* next;
+  iree_host_size_t variant_count;
+  const iree_cpu_variant_t* variants;
+} iree_cpu_dispatch_t;
+
+// Initializes an iree_cpu_dispatch_t with a static array of variants.
+#define IREE_CPU_DISPATCH_INITIALIZER(variants)                     \
+  {IREE_ATOMIC_VAR_INIT(0), IREE_ATOMIC_VAR_INIT(0), NULL,          \
+   IREE_ARRAYSIZE(variants), (variants)}
+
+// Selects the variant of |dispatch| supported by the current CPU data and
+// caches it. Returns NULL if no variant is supported.
+// Prefer iree_cpu_dispatch_resolve which avoids the call once resolved.
+void* iree_cpu_dispatch_resolve_slow(iree_cpu_dispatch_t* dispatch);
+
+// Returns the function pointer of the variant of |dispatch| supported by the
+// current CPU data or NULL if no variant is supported.
+static inline void* iree_cpu_dispatch_resolve(iree_cpu_dispatch_t* dispatch) {
+  intptr_t fn = iree_atomic_load_intptr(&dispatch->fn,
+                                        iree_memory_order_acquire);
+  if (IREE_LIKELY(fn)) return (void*)fn;
+  return iree_cpu_dispatch_resolve_slow(dispatch);
+}
+
 //===----------------------------------------------------------------------===//
 // Processor identification
 //===----------------------------------------------------------------------===//
@@ -80,4 +155,4 @@ void iree_cpu_requery_processor_id(iree_cpu_processor_tag_t* IREE_RESTRICT tag,
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_BASE_INTERNAL_ARENA_H_
+#endif  // IREE_BASE_INTERNAL_CPU_H_
@@ -0,0 +1,66 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/cpu.h"
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+static int VariantA() { return 1; }
+static int VariantB() { return 2; }
+static int VariantGeneric() { return 3; }
+typedef int (*variant_fn_t)();
+
+static const iree_cpu_variant_t kVariants[] = {
+    {(void*)VariantA, {1ull << 0 | 1ull << 1}},
+    {(void*)VariantB, {0, 1ull << 5}},
+    {(void*)VariantGeneric, {0}},
+};
+
+TEST(CpuTest, SelectVariant) {
+  uint64_t fields[IREE_CPU_DATA_FIELD_COUNT] = {0};
+  EXPECT_EQ(iree_cpu_select_variant(IREE_ARRAYSIZE(kVariants), kVariants,
+                                    fields),
+            2);
+  fields[0] = 1ull << 0;
+  EXPECT_EQ(iree_cpu_select_variant(IREE_ARRAYSIZE(kVariants), kVariants,
+                                    fields),
+            2);
+  fields[0] = 1ull << 0 | 1ull << 1;
+  EXPECT_EQ(iree_cpu_select_variant(IREE_ARRAYSIZE(kVariants), kVariants,
+                                    fields),
+            0);
+  fields[0] = 0;
+  fields[1] = 1ull << 5;
+  EXPECT_EQ(iree_cpu_select_variant(IREE_ARRAYSIZE(kVariants), kVariants,
+                                    fields),
+            1);
+  // No supported variant.
+  EXPECT_EQ(iree_cpu_select_variant(1, kVariants, fields), 1);
+}
+
+// Tests that resolved dispatches are re-patched when CPU data changes.
+TEST(CpuTest, DispatchRepatches) {
+  static iree_cpu_dispatch_t dispatch =
+      IREE_CPU_DISPATCH_INITIALIZER(kVariants);
+
+  uint64_t fields[IREE_CPU_DATA_FIELD_COUNT] = {0};
+  iree_cpu_initialize_with_data(IREE_ARRAYSIZE(fields), fields);
+  variant_fn_t fn = (variant_fn_t)iree_cpu_dispatch_resolve(&dispatch);
+  ASSERT_NE(fn, nullptr);
+  EXPECT_EQ(fn(), 3);
+  EXPECT_EQ((variant_fn_t)iree_cpu_dispatch_resolve(&dispatch), fn);
+
+  fields[0] = 1ull << 0 | 1ull << 1;
+  iree_cpu_initialize_with_data(IREE_ARRAYSIZE(fields), fields);
+  fn = (variant_fn_t)iree_cpu_dispatch_resolve(&dispatch);
+  EXPECT_EQ(fn(), 1);
+
+  iree_cpu_initialize(iree_allocator_system());
+}
+
+}  // namespace
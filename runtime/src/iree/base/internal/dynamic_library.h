@@ -47,6 +47,11 @@ iree_status_t iree_dynamic_library_load_from_files(
 // Opens a dynamic library from a range of bytes in memory.
 // |identifier| will be used as the module name in debugging/profiling tools.
 // |buffer| must remain live for the lifetime of the library.
+//
+// On POSIX platforms setting the IREE_DYLIB_CACHE_DIR environment variable to
+// a directory causes libraries to be written to files named by their contents
+// in that directory so that processes loading the same library share its
+// read-only pages.
 iree_status_t iree_dynamic_library_load_from_memory(
     iree_string_view_t identifier, iree_const_byte_span_t buffer,
     iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
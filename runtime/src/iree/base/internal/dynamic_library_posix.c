@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -221,6 +222,155 @@ static void iree_dynamic_library_init_temp_dir(void) {
       stat(path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR;
 }
 
+static iree_once_flag iree_dynamic_library_cache_dir_init_once_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static const char* iree_dynamic_library_cache_dir_path_;
+
+static void iree_dynamic_library_init_cache_dir(void) {
+  // Semantics of IREE_DYLIB_CACHE_DIR:
+  // * If the environment variable is not set libraries loaded from memory are
+  //   written to unique temp files that are removed once loaded.
+  // * If the environment variable is set to the path of a directory libraries
+  //   loaded from memory are written to files named by a hash of their
+  //   contents in that directory and reused by all processes loading the same
+  //   library. Example:
+  //     $ IREE_DYLIB_CACHE_DIR=/dev/shm/iree iree-run-module ...
+  //   As all processes map the same file the read-only pages of the library
+  //   (code and constants) are shared through the page cache instead of each
+  //   process holding a private copy. The cache is never pruned.
+  const char* path = getenv("IREE_DYLIB_CACHE_DIR");
+  if (iree_dynamic_library_path_is_null_or_empty(path)) return;
+  struct stat s;
+  if (stat(path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR) {
+    iree_dynamic_library_cache_dir_path_ = path;
+  }
+}
+
+// Returns true if the file at |file_path| exists and contains |source_data|.
+static bool iree_dynamic_library_file_matches(
+    const char* file_path, iree_const_byte_span_t source_data) {
+  struct stat s;
+  if (stat(file_path, &s) != 0 ||
+      (iree_host_size_t)s.st_size != source_data.data_length) {
+    return false;
+  }
+  FILE* file_handle = fopen(file_path, "rb");
+  if (file_handle == NULL) return false;
+  bool matches = true;
+  uint8_t chunk[4096];
+  for (iree_host_size_t offset = 0;
+       matches && offset < source_data.data_length;) {
+    iree_host_size_t chunk_length =
+        iree_min(sizeof(chunk), source_data.data_length - offset);
+    matches = fread(chunk, 1, chunk_length, file_handle) == chunk_length &&
+              memcmp(chunk, source_data.data + offset, chunk_length) == 0;
+    offset += chunk_length;
+  }
+  fclose(file_handle);
+  return matches;
+}
+
+// Writes |source_data| to a temp file next to |file_path| and atomically
+// publishes it as |file_path|.
+static iree_status_t iree_dynamic_library_publish_cache_file(
+    iree_const_byte_span_t source_data, const char* file_path) {
+  char temp_path[512];
+  if (snprintf(temp_path, sizeof(temp_path), "%s.XXXXXX", file_path) >=
+      sizeof(temp_path)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "cache path too long (>%zu chars)",
+                            sizeof(temp_path));
+  }
+  int fd = mkstemp(temp_path);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to mkstemp file '%s'", temp_path);
+  }
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t offset = 0; offset < source_data.data_length;) {
+    ssize_t written = write(fd, source_data.data + offset,
+                            source_data.data_length - offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to write file span of %zu bytes to "
+                                "'%s'",
+                                source_data.data_length, temp_path);
+      break;
+    }
+    offset += (iree_host_size_t)written;
+  }
+  // Cached files are shared and must be readable by other processes.
+  if (iree_status_is_ok(status) && fchmod(fd, 0644) != 0) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to chmod '%s'", temp_path);
+  }
+  close(fd);
+  if (iree_status_is_ok(status) && link(temp_path, file_path) != 0) {
+    if (errno != EEXIST ||
+        !iree_dynamic_library_file_matches(file_path, source_data)) {
+      if (rename(temp_path, file_path) != 0) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "unable to publish cache file '%s'",
+                                  file_path);
+      }
+    }
+  }
+  remove(temp_path);
+  return status;
+}
+
+// Returns the path of the file in the cache |cache_dir| containing
+// |source_data| in |out_file_path|, writing it if it is not yet present.
+// Concurrent writers race to publish the file with an atomic link and all
+// observe the same contents.
+static iree_status_t iree_dynamic_library_write_cache_file(
+    iree_const_byte_span_t source_data, const char* extension,
+    iree_allocator_t allocator, const char* cache_dir, char** out_file_path) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_file_path = NULL;
+
+  // FNV-1a over the contents; the size is included in the name and the
+  // contents of existing files are verified so collisions only cost a reload.
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < source_data.data_length; ++i) {
+    hash = (hash ^ source_data.data[i]) * 0x100000001B3ull;
+  }
+  int file_path_length =
+      snprintf(NULL, 0, "%s/iree_dylib_%016" PRIx64 "_%zu.%s", cache_dir,
+               hash, source_data.data_length, extension);
+  if (file_path_length < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unable to form cache path string");
+  }
+  char* file_path = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, file_path_length + /*NUL=*/1,
+                                (void**)&file_path));
+  snprintf(file_path, file_path_length + /*NUL=*/1,
+           "%s/iree_dylib_%016" PRIx64 "_%zu.%s", cache_dir, hash,
+           source_data.data_length, extension);
+  iree_file_path_canonicalize(file_path, file_path_length);
+
+  iree_status_t status = iree_ok_status();
+  if (!iree_dynamic_library_file_matches(file_path, source_data)) {
+    // Write to a private temp file in the cache directory and publish it under
+    // the content name. link() fails if another process won the race in which
+    // case we use theirs. A mismatched file (from a hash collision or a
+    // truncated write) is replaced.
+    status = iree_dynamic_library_publish_cache_file(source_data, file_path);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_file_path = file_path;
+  } else {
+    iree_allocator_free(allocator, file_path);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // TODO(#3845): use dlopen on an fd with either dlopen(/proc/self/fd/NN),
 // fdlopen, or android_dlopen_ext to avoid needing to write the file to disk.
 // Can fallback to memfd_create + dlopen where available, and fallback from
@@ -233,6 +383,22 @@ iree_status_t iree_dynamic_library_load_from_memory(
   IREE_ASSERT_ARGUMENT(out_library);
   *out_library = NULL;
 
+  // Use the shared content-addressed cache if one is configured.
+  iree_call_once(&iree_dynamic_library_cache_dir_init_once_flag_,
+                 iree_dynamic_library_init_cache_dir);
+  if (iree_dynamic_library_cache_dir_path_) {
+    char* cache_path = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_dynamic_library_write_cache_file(
+                buffer, "so", allocator, iree_dynamic_library_cache_dir_path_,
+                &cache_path));
+    iree_status_t status = iree_dynamic_library_load_from_file(
+        cache_path, flags, allocator, out_library);
+    iree_allocator_free(allocator, cache_path);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   iree_call_once(&iree_dynamic_library_temp_dir_init_once_flag_,
                  iree_dynamic_library_init_temp_dir);
 
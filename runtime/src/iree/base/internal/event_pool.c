@@ -21,14 +21,22 @@ struct iree_event_pool_t {
   // relatively low contention: callers are rate limited by how fast they can
   // signal and wait on the events they get.
   iree_slim_mutex_t mutex;
-  // Maximum number of events that will be maintained in the pool. More events
-  // may be allocated at any time but when they are no longer needed they will
-  // be disposed directly.
+  // Number of events preallocated by the pool. Trimming the pool retains up to
+  // this many available events.
+  iree_host_size_t initial_capacity;
+  // Capacity of |available_list|. Grows on demand when more events are
+  // released to the pool than it can currently hold.
   iree_host_size_t available_capacity;
   // Total number of available
   iree_host_size_t available_count;
   // Dense left-aligned list of available_count events.
-  iree_event_t available_list[];
+  iree_event_t* available_list;
+  // Number of events currently acquired from the pool.
+  iree_host_size_t acquired_count;
+  // Maximum value of acquired_count observed.
+  iree_host_size_t high_water_count;
+  // Total number of events created by the pool.
+  iree_host_size_t created_count;
 };
 
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
@@ -39,22 +47,36 @@ iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_event_pool_t* event_pool = NULL;
-  iree_host_size_t total_size =
-      sizeof(*event_pool) +
-      available_capacity * sizeof(event_pool->available_list[0]);
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(host_allocator, total_size, (void**)&event_pool));
+      z0, iree_allocator_malloc(host_allocator, sizeof(*event_pool),
+                                (void**)&event_pool));
   event_pool->host_allocator = host_allocator;
-  event_pool->available_capacity = available_capacity;
+  iree_slim_mutex_initialize(&event_pool->mutex);
+  event_pool->initial_capacity = available_capacity;
+  event_pool->available_capacity = 0;
   event_pool->available_count = 0;
+  event_pool->available_list = NULL;
 
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < available_capacity; ++i) {
+  if (available_capacity > 0) {
+    status = iree_allocator_malloc(
+        host_allocator,
+        available_capacity * sizeof(event_pool->available_list[0]),
+        (void**)&event_pool->available_list);
+  }
+  if (iree_status_is_ok(status)) {
+    event_pool->available_capacity = available_capacity;
+  }
+
+  for (iree_host_size_t i = 0;
+       i < event_pool->available_capacity && iree_status_is_ok(status); ++i) {
     status = iree_event_initialize(
         /*initial_state=*/false,
-        &event_pool->available_list[event_pool->available_count++]);
-    if (!iree_status_is_ok(status)) break;
+        &event_pool->available_list[event_pool->available_count]);
+    if (iree_status_is_ok(status)) {
+      ++event_pool->available_count;
+      ++event_pool->created_count;
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -73,6 +95,7 @@ void iree_event_pool_free(iree_event_pool_t* event_pool) {
   for (iree_host_size_t i = 0; i < event_pool->available_count; ++i) {
     iree_event_deinitialize(&event_pool->available_list[i]);
   }
+  iree_allocator_free(host_allocator, event_pool->available_list);
   iree_slim_mutex_deinitialize(&event_pool->mutex);
   iree_allocator_free(host_allocator, event_pool);
 
@@ -102,6 +125,10 @@ iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
     event_pool->available_count -= from_pool_count;
     remaining_count -= from_pool_count;
   }
+  event_pool->acquired_count += event_count;
+  event_pool->high_water_count =
+      iree_max(event_pool->high_water_count, event_pool->acquired_count);
+  event_pool->created_count += remaining_count;
   iree_slim_mutex_unlock(&event_pool->mutex);
 
   // Allocate the rest of the events.
@@ -112,7 +139,13 @@ iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
       status = iree_event_initialize(/*initial_state=*/false,
                                      &out_events[from_pool_count + i]);
       if (!iree_status_is_ok(status)) {
-        // Must release all events we've acquired so far.
+        // Must release all events we've acquired so far and stop counting the
+        // ones we failed to create.
+        iree_host_size_t failed_count = remaining_count - i;
+        iree_slim_mutex_lock(&event_pool->mutex);
+        event_pool->acquired_count -= failed_count;
+        event_pool->created_count -= failed_count;
+        iree_slim_mutex_unlock(&event_pool->mutex);
         iree_event_pool_release(event_pool, from_pool_count + i, out_events);
         IREE_TRACE_ZONE_END(z0);
         return status;
@@ -124,38 +157,53 @@ iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
   return iree_ok_status();
 }
 
-void iree_event_pool_release(iree_event_pool_t* event_pool,
-                             iree_host_size_t event_count,
-                             iree_event_t* events) {
-  IREE_ASSERT_ARGUMENT(event_pool);
-  if (!event_count) return;
-  IREE_ASSERT_ARGUMENT(events);
-
-  // We'll try to release all we can back to the pool and then deinitialize
-  // the ones that won't fit.
-  iree_host_size_t remaining_count = event_count;
+// Releases |events| back to the pool. If |needs_reset| is false the events
+// must already be unsignaled.
+static void iree_event_pool_release_events(iree_event_pool_t* event_pool,
+                                           iree_host_size_t event_count,
+                                           iree_event_t* events,
+                                           bool needs_reset) {
+  // Reset the events we add back to the pool so that they are ready to be
+  // acquired again. This is a syscall per event so we do it outside the lock.
+  if (needs_reset) {
+    for (iree_host_size_t i = 0; i < event_count; ++i) {
+      iree_event_reset(&events[i]);
+    }
+  }
 
-  // Try first to release to the pool.
-  // Note that we reset the events we add back to the pool so that they are
-  // ready to be acquired again.
   iree_slim_mutex_lock(&event_pool->mutex);
+  event_pool->acquired_count -= event_count;
+
+  // Grow the pool if needed so that we retain all released events; creating
+  // events again later is much more expensive than holding on to them. If we
+  // fail to grow we fall back to disposing of what doesn't fit.
+  iree_host_size_t required_capacity =
+      event_pool->available_count + event_count;
+  if (required_capacity > event_pool->available_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(required_capacity, event_pool->available_capacity * 2);
+    iree_event_t* new_list = event_pool->available_list;
+    iree_status_t status = iree_allocator_realloc(
+        event_pool->host_allocator, new_capacity * sizeof(new_list[0]),
+        (void**)&new_list);
+    if (iree_status_is_ok(status)) {
+      event_pool->available_list = new_list;
+      event_pool->available_capacity = new_capacity;
+    } else {
+      iree_status_ignore(status);
+    }
+  }
+
   iree_host_size_t to_pool_count =
       iree_min(event_pool->available_capacity - event_pool->available_count,
                event_count);
-  if (to_pool_count > 0) {
-    iree_host_size_t pool_base_index = event_pool->available_count;
-    for (iree_host_size_t i = 0; i < to_pool_count; ++i) {
-      iree_event_reset(&events[i]);
-    }
-    memcpy(&event_pool->available_list[pool_base_index], events,
-           to_pool_count * sizeof(iree_event_t));
-    event_pool->available_count += to_pool_count;
-    remaining_count -= to_pool_count;
-  }
+  memcpy(&event_pool->available_list[event_pool->available_count], events,
+         to_pool_count * sizeof(iree_event_t));
+  event_pool->available_count += to_pool_count;
   iree_slim_mutex_unlock(&event_pool->mutex);
 
-  // Deallocate the rest of the events. We don't bother resetting them as we are
-  // getting rid of them.
+  // Deallocate the rest of the events.
+  iree_host_size_t remaining_count = event_count - to_pool_count;
   if (remaining_count > 0) {
     IREE_TRACE_ZONE_BEGIN(z0);
     for (iree_host_size_t i = 0; i < remaining_count; ++i) {
@@ -164,3 +212,137 @@ void iree_event_pool_release(iree_event_pool_t* event_pool,
     IREE_TRACE_ZONE_END(z0);
   }
 }
+
+void iree_event_pool_release(iree_event_pool_t* event_pool,
+                             iree_host_size_t event_count,
+                             iree_event_t* events) {
+  IREE_ASSERT_ARGUMENT(event_pool);
+  if (!event_count) return;
+  IREE_ASSERT_ARGUMENT(events);
+  iree_event_pool_release_events(event_pool, event_count, events,
+                                 /*needs_reset=*/true);
+}
+
+void iree_event_pool_trim(iree_event_pool_t* event_pool) {
+  IREE_ASSERT_ARGUMENT(event_pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&event_pool->mutex);
+  while (event_pool->available_count > event_pool->initial_capacity) {
+    iree_event_deinitialize(
+        &event_pool->available_list[--event_pool->available_count]);
+  }
+  iree_slim_mutex_unlock(&event_pool->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_event_pool_query_statistics(
+    iree_event_pool_t* event_pool,
+    iree_event_pool_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(event_pool);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_slim_mutex_lock(&event_pool->mutex);
+  out_statistics->available_count = event_pool->available_count;
+  out_statistics->acquired_count = event_pool->acquired_count;
+  out_statistics->high_water_count = event_pool->high_water_count;
+  out_statistics->created_count = event_pool->created_count;
+  iree_slim_mutex_unlock(&event_pool->mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_event_pool_cache_t
+//===----------------------------------------------------------------------===//
+
+// Number of events exchanged with the pool at a time.
+#define IREE_EVENT_POOL_CACHE_BATCH_SIZE (IREE_EVENT_POOL_CACHE_CAPACITY / 2)
+
+void iree_event_pool_cache_initialize(iree_event_pool_t* event_pool,
+                                      iree_event_pool_cache_t* out_cache) {
+  IREE_ASSERT_ARGUMENT(event_pool);
+  IREE_ASSERT_ARGUMENT(out_cache);
+  out_cache->event_pool = event_pool;
+  out_cache->count = 0;
+}
+
+void iree_event_pool_cache_deinitialize(iree_event_pool_cache_t* cache) {
+  iree_event_pool_cache_flush(cache);
+}
+
+void iree_event_pool_cache_flush(iree_event_pool_cache_t* cache) {
+  IREE_ASSERT_ARGUMENT(cache);
+  if (!cache->count) return;
+  iree_event_pool_release_events(cache->event_pool, cache->count, cache->events,
+                                 /*needs_reset=*/false);
+  cache->count = 0;
+}
+
+iree_status_t iree_event_pool_cache_acquire(iree_event_pool_cache_t* cache,
+                                            iree_host_size_t event_count,
+                                            iree_event_t* out_events) {
+  IREE_ASSERT_ARGUMENT(cache);
+  if (!event_count) return iree_ok_status();
+  IREE_ASSERT_ARGUMENT(out_events);
+
+  // Take what we can from the top of the cache.
+  iree_host_size_t from_cache_count = iree_min(cache->count, event_count);
+  cache->count -= from_cache_count;
+  memcpy(out_events, &cache->events[cache->count],
+         from_cache_count * sizeof(iree_event_t));
+  iree_host_size_t remaining_count = event_count - from_cache_count;
+  if (!remaining_count) return iree_ok_status();
+
+  // Large requests go directly to the pool; otherwise we refill the (now
+  // empty) cache with a batch and take the rest from it.
+  iree_event_t* remaining_events = &out_events[from_cache_count];
+  iree_status_t status = iree_ok_status();
+  if (remaining_count >= IREE_EVENT_POOL_CACHE_BATCH_SIZE) {
+    status = iree_event_pool_acquire(cache->event_pool, remaining_count,
+                                     remaining_events);
+  } else {
+    status = iree_event_pool_acquire(
+        cache->event_pool, IREE_EVENT_POOL_CACHE_BATCH_SIZE, cache->events);
+    if (iree_status_is_ok(status)) {
+      cache->count = IREE_EVENT_POOL_CACHE_BATCH_SIZE - remaining_count;
+      memcpy(remaining_events, &cache->events[cache->count],
+             remaining_count * sizeof(iree_event_t));
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    // Return the events we took from the cache; they are still unsignaled.
+    memcpy(&cache->events[cache->count], out_events,
+           from_cache_count * sizeof(iree_event_t));
+    cache->count += from_cache_count;
+  }
+  return status;
+}
+
+void iree_event_pool_cache_release(iree_event_pool_cache_t* cache,
+                                   iree_host_size_t event_count,
+                                   iree_event_t* events) {
+  IREE_ASSERT_ARGUMENT(cache);
+  if (!event_count) return;
+  IREE_ASSERT_ARGUMENT(events);
+
+  // Large releases go directly to the pool.
+  if (event_count >= IREE_EVENT_POOL_CACHE_BATCH_SIZE) {
+    iree_event_pool_release(cache->event_pool, event_count, events);
+    return;
+  }
+
+  // Move the older half of the cache to the pool if the events don't fit.
+  if (cache->count + event_count > IREE_EVENT_POOL_CACHE_CAPACITY) {
+    iree_event_pool_release_events(cache->event_pool,
+                                   IREE_EVENT_POOL_CACHE_BATCH_SIZE,
+                                   cache->events, /*needs_reset=*/false);
+    cache->count -= IREE_EVENT_POOL_CACHE_BATCH_SIZE;
+    memmove(cache->events, &cache->events[IREE_EVENT_POOL_CACHE_BATCH_SIZE],
+            cache->count * sizeof(iree_event_t));
+  }
+
+  // Events must be unsignaled when acquired again.
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    iree_event_reset(&events[i]);
+  }
+  memcpy(&cache->events[cache->count], events,
+         event_count * sizeof(iree_event_t));
+  cache->count += event_count;
+}
@@ -16,10 +16,18 @@ extern "C" {
 
 // A simple pool of iree_event_ts to recycle.
 //
+// The pool grows on demand: events released back to the pool are retained
+// even when more than the initial capacity are live at once such that
+// steady-state usage never needs to create new events. Use
+// iree_event_pool_trim to dispose of events retained beyond the initial
+// capacity after a burst.
+//
 // Thread-safe; multiple threads may acquire and release events from the pool.
+// Threads that frequently acquire and release events can use an
+// iree_event_pool_cache_t to avoid contending on the shared pool.
 typedef struct iree_event_pool_t iree_event_pool_t;
 
-// Allocates a new event pool with up to |available_capacity| events.
+// Allocates a new event pool with |available_capacity| events preallocated.
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
                                        iree_allocator_t host_allocator,
                                        iree_event_pool_t** out_event_pool);
@@ -42,6 +50,76 @@ void iree_event_pool_release(iree_event_pool_t* event_pool,
                              iree_host_size_t event_count,
                              iree_event_t* events);
 
+// Destroys available events retained beyond the initial capacity of the pool.
+void iree_event_pool_trim(iree_event_pool_t* event_pool);
+
+// Statistics of an event pool since it was allocated.
+typedef struct iree_event_pool_statistics_t {
+  // Number of events currently available in the pool.
+  iree_host_size_t available_count;
+  // Number of events currently acquired from the pool. Events held in an
+  // iree_event_pool_cache_t are counted as acquired.
+  iree_host_size_t acquired_count;
+  // Maximum value of |acquired_count| observed.
+  iree_host_size_t high_water_count;
+  // Total number of events created by the pool. Any creation beyond the
+  // initial capacity happened on the acquisition path.
+  iree_host_size_t created_count;
+} iree_event_pool_statistics_t;
+
+// Queries the current statistics of |event_pool|.
+void iree_event_pool_query_statistics(
+    iree_event_pool_t* event_pool,
+    iree_event_pool_statistics_t* out_statistics);
+
+//===----------------------------------------------------------------------===//
+// iree_event_pool_cache_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of events held by an iree_event_pool_cache_t.
+#define IREE_EVENT_POOL_CACHE_CAPACITY 16
+
+// A thread-local cache of events acquired from or released to a shared pool.
+// Acquisitions and releases are batched by exchanging
+// IREE_EVENT_POOL_CACHE_CAPACITY/2 events with the pool at a time such that
+// the shared pool is only locked once per batch instead of once per event.
+// Events acquired from a cache may be released to the pool or any other cache
+// of the same pool.
+//
+// Caches are not thread-safe and must only be used by a single thread at a
+// time (such as a worker or a thread holding a lock). All cached events are
+// returned to the pool when the cache is flushed or deinitialized.
+typedef struct iree_event_pool_cache_t {
+  // Pool the cache acquires events from and releases events to.
+  iree_event_pool_t* event_pool;
+  // Number of events in |events|.
+  iree_host_size_t count;
+  // Cached unsignaled events used as a stack (LIFO).
+  iree_event_t events[IREE_EVENT_POOL_CACHE_CAPACITY];
+} iree_event_pool_cache_t;
+
+// Initializes an empty cache for |event_pool|.
+void iree_event_pool_cache_initialize(iree_event_pool_t* event_pool,
+                                      iree_event_pool_cache_t* out_cache);
+
+// Flushes all cached events back to the pool and deinitializes the cache.
+void iree_event_pool_cache_deinitialize(iree_event_pool_cache_t* cache);
+
+// Returns all cached events to the pool.
+void iree_event_pool_cache_flush(iree_event_pool_cache_t* cache);
+
+// Acquires one or more events from the cache, refilling it from the pool if it
+// is empty. The returned events will be unsignaled.
+iree_status_t iree_event_pool_cache_acquire(iree_event_pool_cache_t* cache,
+                                            iree_host_size_t event_count,
+                                            iree_event_t* out_events);
+
+// Releases one or more events to the cache, moving half of the cached events
+// to the pool if it is full.
+void iree_event_pool_cache_release(iree_event_pool_cache_t* cache,
+                                   iree_host_size_t event_count,
+                                   iree_event_t* events);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
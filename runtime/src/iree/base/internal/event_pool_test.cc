@@ -0,0 +1,110 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/event_pool.h"
+
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+static iree_event_pool_statistics_t QueryStatistics(
+    iree_event_pool_t* event_pool) {
+  iree_event_pool_statistics_t statistics;
+  iree_event_pool_query_statistics(event_pool, &statistics);
+  return statistics;
+}
+
+// Tests that the pool retains events released beyond its initial capacity so
+// that a repeated burst only creates events the first time.
+TEST(EventPoolTest, GrowsOnDemand) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(iree_event_pool_allocate(/*available_capacity=*/4,
+                                          iree_allocator_system(),
+                                          &event_pool));
+  EXPECT_EQ(QueryStatistics(event_pool).created_count, 4);
+
+  std::vector<iree_event_t> events(16);
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(
+        iree_event_pool_acquire(event_pool, events.size(), events.data()));
+    iree_event_pool_statistics_t statistics = QueryStatistics(event_pool);
+    EXPECT_EQ(statistics.available_count, 0);
+    EXPECT_EQ(statistics.acquired_count, events.size());
+    EXPECT_EQ(statistics.created_count, events.size());
+    iree_event_pool_release(event_pool, events.size(), events.data());
+    EXPECT_EQ(QueryStatistics(event_pool).available_count, events.size());
+  }
+  EXPECT_EQ(QueryStatistics(event_pool).high_water_count, events.size());
+
+  // Trimming drops back down to the initial capacity.
+  iree_event_pool_trim(event_pool);
+  EXPECT_EQ(QueryStatistics(event_pool).available_count, 4);
+
+  iree_event_pool_free(event_pool);
+}
+
+// Tests that released events are reset before they are reused.
+TEST(EventPoolTest, ReleasedEventsAreReset) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(iree_event_pool_allocate(/*available_capacity=*/1,
+                                          iree_allocator_system(),
+                                          &event_pool));
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_pool_acquire(event_pool, 1, &event));
+  iree_event_set(&event);
+  iree_event_pool_release(event_pool, 1, &event);
+  IREE_ASSERT_OK(iree_event_pool_acquire(event_pool, 1, &event));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                        iree_wait_one(&event, IREE_TIME_INFINITE_PAST));
+  iree_event_pool_release(event_pool, 1, &event);
+  iree_event_pool_free(event_pool);
+}
+
+// Tests that a cache batches acquisitions from the pool and returns all of its
+// events on deinitialization.
+TEST(EventPoolTest, Cache) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(iree_event_pool_allocate(/*available_capacity=*/0,
+                                          iree_allocator_system(),
+                                          &event_pool));
+  iree_event_pool_cache_t cache;
+  iree_event_pool_cache_initialize(event_pool, &cache);
+
+  // The first acquire refills the cache with a batch.
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_pool_cache_acquire(&cache, 1, &event));
+  EXPECT_EQ(QueryStatistics(event_pool).acquired_count,
+            IREE_EVENT_POOL_CACHE_CAPACITY / 2);
+
+  // Events released to the cache stay in the cache and are reset.
+  iree_event_set(&event);
+  iree_event_pool_cache_release(&cache, 1, &event);
+  IREE_ASSERT_OK(iree_event_pool_cache_acquire(&cache, 1, &event));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                        iree_wait_one(&event, IREE_TIME_INFINITE_PAST));
+  EXPECT_EQ(QueryStatistics(event_pool).acquired_count,
+            IREE_EVENT_POOL_CACHE_CAPACITY / 2);
+
+  // Overflowing the cache moves half of it back to the pool.
+  std::vector<iree_event_t> events(IREE_EVENT_POOL_CACHE_CAPACITY);
+  IREE_ASSERT_OK(iree_event_pool_acquire(event_pool, events.size() - 1,
+                                         events.data()));
+  events.back() = event;
+  for (auto& e : events) iree_event_pool_cache_release(&cache, 1, &e);
+  EXPECT_LE(cache.count, IREE_EVENT_POOL_CACHE_CAPACITY);
+
+  iree_event_pool_cache_deinitialize(&cache);
+  iree_event_pool_statistics_t statistics = QueryStatistics(event_pool);
+  EXPECT_EQ(statistics.acquired_count, 0);
+  EXPECT_EQ(statistics.available_count, statistics.created_count);
+
+  iree_event_pool_free(event_pool);
+}
+
+}  // namespace
@@ -26,6 +26,14 @@
 #define IREE_SET_BINARY_MODE(handle) ((void)0)
 #endif  // IREE_PLATFORM_WINDOWS
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define IREE_FILE_IO_HAVE_MMAP 1
+#endif  // IREE_PLATFORM_*
+
 // We could take alignment as an arg, but roughly page aligned should be
 // acceptable for all uses - if someone cares about memory usage they won't
 // be using this method.
@@ -85,6 +93,17 @@ bool iree_file_is_at(FILE* file, uint64_t position) {
   return iree_ftell64(file) == position;
 }
 
+// Unmaps the contents of a file mapped with iree_file_map_contents, if mapped.
+static void iree_file_contents_unmap(iree_file_contents_t* contents) {
+  if (!contents->mapping) return;
+#if defined(IREE_PLATFORM_WINDOWS)
+  UnmapViewOfFile(contents->mapping);
+#elif defined(IREE_FILE_IO_HAVE_MMAP)
+  munmap(contents->mapping, contents->buffer.data_length);
+#endif  // IREE_PLATFORM_*
+  contents->mapping = NULL;
+}
+
 iree_status_t iree_file_contents_allocator_ctl(void* self,
                                                iree_allocator_command_t command,
                                                const void* params,
@@ -99,6 +118,7 @@ iree_status_t iree_file_contents_allocator_ctl(void* self,
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "only the file contents buffer is valid");
   }
+  iree_file_contents_unmap(contents);
   iree_allocator_t allocator = contents->allocator;
   iree_allocator_free(allocator, contents);
   return iree_ok_status();
@@ -116,6 +136,7 @@ iree_allocator_t iree_file_contents_deallocator(
 void iree_file_contents_free(iree_file_contents_t* contents) {
   if (!contents) return;
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_file_contents_unmap(contents);
   iree_allocator_free(contents->allocator, contents);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -149,7 +170,7 @@ static iree_status_t iree_file_read_contents_impl(
   contents->buffer.data_length = file_size;
 
   // Attempt to read the file into memory.
-  if (fread(contents->buffer.data, file_size, 1, file) != 1) {
+  if (file_size > 0 && fread(contents->buffer.data, file_size, 1, file) != 1) {
     iree_allocator_free(allocator, contents);
     return iree_make_status(iree_status_code_from_errno(errno),
                             "unable to read entire %zu file bytes", file_size);
@@ -189,6 +210,164 @@ iree_status_t iree_file_read_contents(const char* path,
   return status;
 }
 
+#if defined(IREE_PLATFORM_WINDOWS)
+
+// Maps |path| into memory and returns the base address and length of the
+// mapping. Returns IREE_STATUS_OUT_OF_RANGE if the file is empty.
+static iree_status_t iree_file_map_platform(const char* path,
+                                            iree_file_map_flags_t flags,
+                                            void** out_base,
+                                            iree_host_size_t* out_length) {
+  HANDLE file = CreateFileA(
+      path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+      (flags & IREE_FILE_MAP_FLAG_RANDOM_ACCESS) ? FILE_FLAG_RANDOM_ACCESS
+                                                 : FILE_ATTRIBUTE_NORMAL,
+      NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "failed to open file '%s'", path);
+  }
+
+  iree_status_t status = iree_ok_status();
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    status = iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                              "failed to query file size");
+  } else if (file_size.QuadPart == 0) {
+    status = iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+  } else if ((uint64_t)file_size.QuadPart > IREE_HOST_SIZE_MAX) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "file length exceeds host address range");
+  }
+
+  // The view retains the mapping object so both handles can be closed.
+  HANDLE mapping = NULL;
+  if (iree_status_is_ok(status)) {
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+      status =
+          iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                           "failed to create file mapping");
+    }
+  }
+  void* base = NULL;
+  if (iree_status_is_ok(status)) {
+    base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+      status =
+          iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                           "failed to map view of file");
+    }
+  }
+  if (mapping) CloseHandle(mapping);
+  CloseHandle(file);
+
+  if (iree_status_is_ok(status)) {
+    if (flags & IREE_FILE_MAP_FLAG_PREFETCH) {
+      WIN32_MEMORY_RANGE_ENTRY range = {base, (SIZE_T)file_size.QuadPart};
+      PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+    *out_base = base;
+    *out_length = (iree_host_size_t)file_size.QuadPart;
+  }
+  return status;
+}
+
+#elif defined(IREE_FILE_IO_HAVE_MMAP)
+
+// Maps |path| into memory and returns the base address and length of the
+// mapping. Returns IREE_STATUS_OUT_OF_RANGE if the file is empty.
+static iree_status_t iree_file_map_platform(const char* path,
+                                            iree_file_map_flags_t flags,
+                                            void** out_base,
+                                            iree_host_size_t* out_length) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open file '%s'", path);
+  }
+
+  iree_status_t status = iree_ok_status();
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to query file size");
+  } else if (stat_buf.st_size == 0) {
+    status = iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+  } else if ((uint64_t)stat_buf.st_size > IREE_HOST_SIZE_MAX) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "file length exceeds host address range");
+  }
+
+  // The mapping retains the file so the descriptor can be closed.
+  void* base = MAP_FAILED;
+  iree_host_size_t length = (iree_host_size_t)stat_buf.st_size;
+  if (iree_status_is_ok(status)) {
+    base = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to map file");
+    }
+  }
+  close(fd);
+
+  if (iree_status_is_ok(status)) {
+    // NOTE: hints only; failures are ignored.
+    if (flags & IREE_FILE_MAP_FLAG_RANDOM_ACCESS) {
+      madvise(base, length, MADV_RANDOM);
+    }
+    if (flags & IREE_FILE_MAP_FLAG_PREFETCH) {
+      madvise(base, length, MADV_WILLNEED);
+    }
+    *out_base = base;
+    *out_length = length;
+  }
+  return status;
+}
+
+#endif  // IREE_PLATFORM_*
+
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_file_map_flags_t flags,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path);
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+
+#if defined(IREE_PLATFORM_WINDOWS) || defined(IREE_FILE_IO_HAVE_MMAP)
+  iree_file_contents_t* contents = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*contents),
+                                (void**)&contents));
+  contents->allocator = allocator;
+  void* base = NULL;
+  iree_host_size_t length = 0;
+  iree_status_t status = iree_file_map_platform(path, flags, &base, &length);
+  if (iree_status_is_ok(status)) {
+    contents->mapping = base;
+    contents->buffer = iree_make_byte_span(base, length);
+    *out_contents = contents;
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  iree_allocator_free(allocator, contents);
+  if (!iree_status_is_out_of_range(status)) {
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  // Empty files cannot be mapped.
+  iree_status_ignore(status);
+#endif  // IREE_PLATFORM_WINDOWS || IREE_FILE_IO_HAVE_MMAP
+
+  iree_status_t read_status =
+      iree_file_read_contents(path, allocator, out_contents);
+  IREE_TRACE_ZONE_END(z0);
+  return read_status;
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -300,6 +479,13 @@ iree_status_t iree_file_read_contents(const char* path,
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
 }
 
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_file_map_flags_t flags,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
@@ -36,6 +36,9 @@ typedef struct iree_file_contents_t {
     iree_byte_span_t buffer;
     iree_const_byte_span_t const_buffer;
   };
+  // Base address of the read-only file mapping when the contents were mapped
+  // with iree_file_map_contents or NULL if the contents were read into memory.
+  void* mapping;
 } iree_file_contents_t;
 
 // Returns an allocator that deallocates the |contents|.
@@ -54,6 +57,35 @@ iree_status_t iree_file_read_contents(const char* path,
                                       iree_allocator_t allocator,
                                       iree_file_contents_t** out_contents);
 
+// Hints controlling how mapped file contents will be accessed.
+enum iree_file_map_flag_bits_t {
+  IREE_FILE_MAP_FLAG_NONE = 0u,
+  // Contents will be accessed in a mostly random order and the system should
+  // avoid speculative read-ahead of pages that have not been touched.
+  IREE_FILE_MAP_FLAG_RANDOM_ACCESS = 1u << 0,
+  // Contents will be accessed soon and the system should begin paging in the
+  // entire file asynchronously.
+  IREE_FILE_MAP_FLAG_PREFETCH = 1u << 1,
+};
+typedef uint32_t iree_file_map_flags_t;
+
+// Maps a file's contents into memory as read-only.
+//
+// Returns the contents of the file in |out_contents|. Unlike
+// iree_file_read_contents the contents are paged in lazily as they are
+// accessed and physical pages are shared with all other processes mapping the
+// same file. The contents are page aligned but are *not* NUL terminated. The
+// file must not be modified while mapped.
+//
+// Falls back to iree_file_read_contents on platforms that do not support
+// mapping files and for empty files. |allocator| is used to allocate the
+// tracking structure (and the contents when falling back) and the caller must
+// use iree_file_contents_free to release the mapping.
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_file_map_flags_t flags,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents);
+
 // Synchronously writes a byte buffer into a file.
 // Existing contents are overwritten.
 iree_status_t iree_file_write_contents(const char* path,
@@ -94,6 +94,58 @@ TEST(FileIO, ReadWriteContents) {
   iree_file_contents_free(read_contents);
 }
 
+TEST(FileIO, MapContents) {
+  constexpr const char* kUniqueName = "MapContents";
+  auto path = GetUniquePath(kUniqueName);
+
+  // Write the contents to disk.
+  auto write_contents = GetUniqueContents(kUniqueName);
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  // Map the contents and expect they are equal.
+  iree_file_contents_t* mapped_contents = NULL;
+  IREE_ASSERT_OK(iree_file_map_contents(
+      path.c_str(), IREE_FILE_MAP_FLAG_PREFETCH, iree_allocator_system(),
+      &mapped_contents));
+  EXPECT_EQ(write_contents.size(), mapped_contents->const_buffer.data_length);
+  EXPECT_EQ(memcmp(write_contents.data(), mapped_contents->const_buffer.data,
+                   mapped_contents->const_buffer.data_length),
+            0);
+
+  // Release the mapping via the deallocator as the VM does.
+  iree_allocator_t deallocator =
+      iree_file_contents_deallocator(mapped_contents);
+  iree_allocator_free(deallocator, mapped_contents->buffer.data);
+}
+
+TEST(FileIO, MapEmptyContents) {
+  constexpr const char* kUniqueName = "MapEmptyContents";
+  auto path = GetUniquePath(kUniqueName);
+  IREE_ASSERT_OK(
+      iree_file_write_contents(path.c_str(), iree_const_byte_span_empty()));
+
+  // Empty files can't be mapped but still produce (empty) contents.
+  iree_file_contents_t* mapped_contents = NULL;
+  IREE_ASSERT_OK(iree_file_map_contents(path.c_str(), IREE_FILE_MAP_FLAG_NONE,
+                                        iree_allocator_system(),
+                                        &mapped_contents));
+  EXPECT_EQ(0, mapped_contents->const_buffer.data_length);
+  iree_file_contents_free(mapped_contents);
+}
+
+TEST(FileIO, MapMissingFile) {
+  auto path = GetUniquePath("MapMissingFile");
+  iree_file_contents_t* mapped_contents = NULL;
+  iree_status_t status =
+      iree_file_map_contents(path.c_str(), IREE_FILE_MAP_FLAG_NONE,
+                             iree_allocator_system(), &mapped_contents);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, status);
+  iree_status_free(status);
+  EXPECT_EQ(NULL, mapped_contents);
+}
+
 }  // namespace
 }  // namespace file_io
 }  // namespace iree
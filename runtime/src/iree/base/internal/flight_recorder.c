@@ -0,0 +1,462 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/flight_recorder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "iree/base/target_platform.h"
+
+#if defined(IREE_PLATFORM_WINDOWS)
+#include <io.h>
+#include <process.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_WINDOWS
+
+//===----------------------------------------------------------------------===//
+// Per-thread rings
+//===----------------------------------------------------------------------===//
+
+#if (IREE_FLIGHT_RECORDER_RING_CAPACITY & \
+     (IREE_FLIGHT_RECORDER_RING_CAPACITY - 1)) != 0
+#error "IREE_FLIGHT_RECORDER_RING_CAPACITY must be a power of two"
+#endif  // IREE_FLIGHT_RECORDER_RING_CAPACITY
+
+#if defined(IREE_COMPILER_MSVC)
+#define IREE_FLIGHT_RECORDER_THREAD_LOCAL __declspec(thread)
+#else
+#define IREE_FLIGHT_RECORDER_THREAD_LOCAL __thread
+#endif  // IREE_COMPILER_MSVC
+
+typedef struct iree_flight_recorder_event_t {
+  iree_time_t timestamp_ns;
+  const char* name;
+  uint64_t value;
+  uint32_t category;
+  uint32_t phase;
+} iree_flight_recorder_event_t;
+
+typedef struct iree_flight_recorder_ring_t {
+  // Total number of events ever recorded by the thread. The next event will be
+  // written to events[write_position % IREE_FLIGHT_RECORDER_RING_CAPACITY].
+  // Only the owning thread writes; dumps read it with acquire order to see
+  // fully written events.
+  iree_atomic_int64_t write_position;
+  iree_flight_recorder_event_t events[IREE_FLIGHT_RECORDER_RING_CAPACITY];
+} iree_flight_recorder_ring_t;
+
+iree_atomic_int32_t iree_flight_recorder_enabled_ = IREE_ATOMIC_VAR_INIT(0);
+
+// Total number of threads that have attempted to register a ring. May exceed
+// IREE_FLIGHT_RECORDER_MAX_THREADS in which case the excess threads have none.
+static iree_atomic_int32_t iree_flight_recorder_thread_count_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Registered rings indexed by thread ordinal; NULL until the ring of the thread
+// has been allocated.
+static iree_atomic_intptr_t
+    iree_flight_recorder_rings_[IREE_FLIGHT_RECORDER_MAX_THREADS];
+
+// Ring of the current thread or NULL if it has not yet recorded any events.
+static IREE_FLIGHT_RECORDER_THREAD_LOCAL iree_flight_recorder_ring_t*
+    iree_flight_recorder_thread_ring_ = NULL;
+
+// True if the current thread failed to register a ring and should drop events.
+static IREE_FLIGHT_RECORDER_THREAD_LOCAL bool
+    iree_flight_recorder_thread_dropped_ = false;
+
+void iree_flight_recorder_set_enabled(bool enabled) {
+  iree_atomic_store_int32(&iree_flight_recorder_enabled_, enabled ? 1 : 0,
+                          iree_memory_order_relaxed);
+}
+
+static iree_flight_recorder_ring_t* iree_flight_recorder_register_thread(void) {
+  if (iree_flight_recorder_thread_dropped_) return NULL;
+  iree_flight_recorder_thread_dropped_ = true;
+
+  int32_t ordinal = iree_atomic_fetch_add_int32(
+      &iree_flight_recorder_thread_count_, 1, iree_memory_order_relaxed);
+  if (ordinal >= IREE_FLIGHT_RECORDER_MAX_THREADS) return NULL;
+
+  // NOTE: rings are intentionally never freed so that the history of threads
+  // that have exited remains available to dumps.
+  iree_flight_recorder_ring_t* ring = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      iree_allocator_system(), sizeof(*ring), (void**)&ring);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return NULL;
+  }
+  iree_atomic_store_int64(&ring->write_position, 0, iree_memory_order_relaxed);
+  iree_atomic_store_intptr(&iree_flight_recorder_rings_[ordinal],
+                           (intptr_t)ring, iree_memory_order_release);
+
+  iree_flight_recorder_thread_dropped_ = false;
+  iree_flight_recorder_thread_ring_ = ring;
+  return ring;
+}
+
+void iree_flight_recorder_record(iree_flight_recorder_category_t category,
+                                 iree_flight_recorder_phase_t phase,
+                                 const char* name, uint64_t value) {
+  iree_flight_recorder_ring_t* ring = iree_flight_recorder_thread_ring_;
+  if (IREE_UNLIKELY(!ring)) {
+    ring = iree_flight_recorder_register_thread();
+    if (!ring) return;
+  }
+  int64_t position =
+      iree_atomic_load_int64(&ring->write_position, iree_memory_order_relaxed);
+  iree_flight_recorder_event_t* event =
+      &ring->events[position & (IREE_FLIGHT_RECORDER_RING_CAPACITY - 1)];
+  event->timestamp_ns = iree_time_now();
+  event->name = name;
+  event->value = value;
+  event->category = (uint32_t)category;
+  event->phase = (uint32_t)phase;
+  iree_atomic_store_int64(&ring->write_position, position + 1,
+                          iree_memory_order_release);
+}
+
+//===----------------------------------------------------------------------===//
+// Chrome trace event JSON
+//===----------------------------------------------------------------------===//
+// Format reference:
+// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+//
+// Everything here must be async-signal-safe: we only use stack memory and
+// write(2) and format numbers by hand instead of using snprintf.
+
+typedef struct iree_flight_recorder_writer_t {
+  int fd;
+  iree_host_size_t length;
+  char buffer[4096];
+} iree_flight_recorder_writer_t;
+
+static void iree_flight_recorder_writer_flush(
+    iree_flight_recorder_writer_t* writer) {
+  const char* data = writer->buffer;
+  iree_host_size_t remaining = writer->length;
+  while (remaining > 0) {
+#if defined(IREE_PLATFORM_WINDOWS)
+    int written = _write(writer->fd, data, (unsigned int)remaining);
+#else
+    ssize_t written = write(writer->fd, data, remaining);
+#endif  // IREE_PLATFORM_WINDOWS
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      break;  // nothing we can do; drop the rest
+    }
+    data += written;
+    remaining -= (iree_host_size_t)written;
+  }
+  writer->length = 0;
+}
+
+static void iree_flight_recorder_writer_append(
+    iree_flight_recorder_writer_t* writer, const char* data,
+    iree_host_size_t length) {
+  while (length > 0) {
+    if (writer->length == sizeof(writer->buffer)) {
+      iree_flight_recorder_writer_flush(writer);
+    }
+    iree_host_size_t chunk =
+        iree_min(length, sizeof(writer->buffer) - writer->length);
+    memcpy(&writer->buffer[writer->length], data, chunk);
+    writer->length += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+static void iree_flight_recorder_writer_append_cstring(
+    iree_flight_recorder_writer_t* writer, const char* value) {
+  iree_flight_recorder_writer_append(writer, value, strlen(value));
+}
+
+// Appends |value| as a JSON string body, escaping characters that would
+// otherwise produce invalid JSON.
+static void iree_flight_recorder_writer_append_escaped(
+    iree_flight_recorder_writer_t* writer, const char* value) {
+  for (const char* c = value; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      char escaped[2] = {'\\', *c};
+      iree_flight_recorder_writer_append(writer, escaped, 2);
+    } else if ((unsigned char)*c >= 0x20) {
+      iree_flight_recorder_writer_append(writer, c, 1);
+    }
+  }
+}
+
+static void iree_flight_recorder_writer_append_uint64(
+    iree_flight_recorder_writer_t* writer, uint64_t value) {
+  char digits[20];
+  int digit_count = 0;
+  do {
+    digits[sizeof(digits) - 1 - digit_count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  iree_flight_recorder_writer_append(
+      writer, &digits[sizeof(digits) - digit_count], digit_count);
+}
+
+// Appends a nanosecond timestamp as fractional microseconds.
+static void iree_flight_recorder_writer_append_timestamp(
+    iree_flight_recorder_writer_t* writer, iree_time_t timestamp_ns) {
+  uint64_t value = timestamp_ns > 0 ? (uint64_t)timestamp_ns : 0;
+  iree_flight_recorder_writer_append_uint64(writer, value / 1000);
+  uint64_t fraction = value % 1000;
+  char fraction_digits[4] = {'.', (char)('0' + fraction / 100),
+                             (char)('0' + (fraction / 10) % 10),
+                             (char)('0' + fraction % 10)};
+  iree_flight_recorder_writer_append(writer, fraction_digits, 4);
+}
+
+static const char* iree_flight_recorder_category_name(uint32_t category) {
+  switch (category) {
+    case IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH:
+      return "dispatch";
+    case IREE_FLIGHT_RECORDER_CATEGORY_SUBMISSION:
+      return "submission";
+    case IREE_FLIGHT_RECORDER_CATEGORY_ALLOCATION:
+      return "allocation";
+    default:
+      return "user";
+  }
+}
+
+static uint64_t iree_flight_recorder_process_id(void) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  return (uint64_t)_getpid();
+#else
+  return (uint64_t)getpid();
+#endif  // IREE_PLATFORM_WINDOWS
+}
+
+// Appends the common `"pid":N,"tid":N` fields.
+static void iree_flight_recorder_writer_append_ids(
+    iree_flight_recorder_writer_t* writer, uint64_t process_id,
+    int32_t ordinal) {
+  iree_flight_recorder_writer_append_cstring(writer, "\"pid\":");
+  iree_flight_recorder_writer_append_uint64(writer, process_id);
+  iree_flight_recorder_writer_append_cstring(writer, ",\"tid\":");
+  iree_flight_recorder_writer_append_uint64(writer, (uint64_t)ordinal);
+}
+
+static void iree_flight_recorder_writer_append_event(
+    iree_flight_recorder_writer_t* writer, uint64_t process_id,
+    int32_t ordinal, const iree_flight_recorder_event_t* event) {
+  iree_flight_recorder_writer_append_cstring(writer, ",\n{\"name\":\"");
+  iree_flight_recorder_writer_append_escaped(
+      writer, event->name ? event->name : "(null)");
+  iree_flight_recorder_writer_append_cstring(writer, "\",\"cat\":\"");
+  iree_flight_recorder_writer_append_cstring(
+      writer, iree_flight_recorder_category_name(event->category));
+  switch (event->phase) {
+    case IREE_FLIGHT_RECORDER_PHASE_BEGIN:
+      iree_flight_recorder_writer_append_cstring(writer, "\",\"ph\":\"B\",");
+      break;
+    case IREE_FLIGHT_RECORDER_PHASE_END:
+      iree_flight_recorder_writer_append_cstring(writer, "\",\"ph\":\"E\",");
+      break;
+    default:
+      iree_flight_recorder_writer_append_cstring(
+          writer, "\",\"ph\":\"i\",\"s\":\"t\",");
+      break;
+  }
+  iree_flight_recorder_writer_append_cstring(writer, "\"ts\":");
+  iree_flight_recorder_writer_append_timestamp(writer, event->timestamp_ns);
+  iree_flight_recorder_writer_append_cstring(writer, ",");
+  iree_flight_recorder_writer_append_ids(writer, process_id, ordinal);
+  if (event->phase != IREE_FLIGHT_RECORDER_PHASE_END) {
+    iree_flight_recorder_writer_append_cstring(writer,
+                                               ",\"args\":{\"value\":");
+    iree_flight_recorder_writer_append_uint64(writer, event->value);
+    iree_flight_recorder_writer_append_cstring(writer, "}");
+  }
+  iree_flight_recorder_writer_append_cstring(writer, "}");
+}
+
+static void iree_flight_recorder_writer_append_ring(
+    iree_flight_recorder_writer_t* writer, uint64_t process_id,
+    int32_t ordinal, iree_flight_recorder_ring_t* ring) {
+  // Name the thread track so that it is distinguishable in the viewer.
+  iree_flight_recorder_writer_append_cstring(
+      writer, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",");
+  iree_flight_recorder_writer_append_ids(writer, process_id, ordinal);
+  iree_flight_recorder_writer_append_cstring(
+      writer, ",\"args\":{\"name\":\"iree-thread-");
+  iree_flight_recorder_writer_append_uint64(writer, (uint64_t)ordinal);
+  iree_flight_recorder_writer_append_cstring(writer, "\"}}");
+
+  int64_t end_position =
+      iree_atomic_load_int64(&ring->write_position, iree_memory_order_acquire);
+  // NOTE: the slot of the oldest event may be getting overwritten by the
+  // owning thread if it is recording concurrently so we skip it.
+  int64_t start_position =
+      iree_max(0, end_position - (IREE_FLIGHT_RECORDER_RING_CAPACITY - 1));
+  for (int64_t position = start_position; position < end_position;
+       ++position) {
+    iree_flight_recorder_event_t event = ring->events[
+        position & (IREE_FLIGHT_RECORDER_RING_CAPACITY - 1)];
+    // The owning thread may have lapped us while we were reading; drop any
+    // event that may have been overwritten during the copy.
+    int64_t current_position = iree_atomic_load_int64(
+        &ring->write_position, iree_memory_order_acquire);
+    if (current_position - IREE_FLIGHT_RECORDER_RING_CAPACITY >= position) {
+      continue;
+    }
+    iree_flight_recorder_writer_append_event(writer, process_id, ordinal,
+                                             &event);
+  }
+}
+
+void iree_flight_recorder_dump_to_fd(int fd) {
+  iree_flight_recorder_writer_t writer;
+  writer.fd = fd;
+  writer.length = 0;
+  uint64_t process_id = iree_flight_recorder_process_id();
+
+  // The first entry is a process name so that every following entry can be
+  // prefixed with a comma.
+  iree_flight_recorder_writer_append_cstring(
+      &writer, "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",");
+  iree_flight_recorder_writer_append_ids(&writer, process_id, 0);
+  iree_flight_recorder_writer_append_cstring(
+      &writer, ",\"args\":{\"name\":\"iree\"}}");
+
+  int32_t thread_count = iree_min(
+      iree_atomic_load_int32(&iree_flight_recorder_thread_count_,
+                             iree_memory_order_acquire),
+      IREE_FLIGHT_RECORDER_MAX_THREADS);
+  for (int32_t ordinal = 0; ordinal < thread_count; ++ordinal) {
+    iree_flight_recorder_ring_t* ring =
+        (iree_flight_recorder_ring_t*)iree_atomic_load_intptr(
+            &iree_flight_recorder_rings_[ordinal], iree_memory_order_acquire);
+    if (!ring) continue;  // still registering or failed to allocate
+    iree_flight_recorder_writer_append_ring(&writer, process_id, ordinal,
+                                            ring);
+  }
+
+  iree_flight_recorder_writer_append_cstring(
+      &writer, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  iree_flight_recorder_writer_flush(&writer);
+}
+
+iree_status_t iree_flight_recorder_dump_to_file(const char* path) {
+  IREE_ASSERT_ARGUMENT(path);
+#if defined(IREE_PLATFORM_WINDOWS)
+  int fd = _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif  // IREE_PLATFORM_WINDOWS
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open flight recorder dump file '%s'",
+                            path);
+  }
+  iree_flight_recorder_dump_to_fd(fd);
+#if defined(IREE_PLATFORM_WINDOWS)
+  _close(fd);
+#else
+  close(fd);
+#endif  // IREE_PLATFORM_WINDOWS
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Crash handler
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_PLATFORM_WINDOWS) || defined(IREE_PLATFORM_EMSCRIPTEN) || \
+    defined(IREE_PLATFORM_GENERIC)
+
+iree_status_t iree_flight_recorder_install_crash_handler(const char* path) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "flight recorder crash handlers require POSIX "
+                          "signals");
+}
+
+#else
+
+static const int iree_flight_recorder_crash_signals_[] = {
+    SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT,
+};
+
+// Copied path as we can't rely on the caller memory remaining valid.
+static char iree_flight_recorder_crash_path_[1024];
+
+// Handlers that were installed before ours and are restored on crash.
+static struct sigaction iree_flight_recorder_previous_actions_[IREE_ARRAYSIZE(
+    iree_flight_recorder_crash_signals_)];
+
+// Set once a crash dump has started so that nested faults don't dump again.
+static iree_atomic_int32_t iree_flight_recorder_crashed_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+static void iree_flight_recorder_crash_handler(int signal_number) {
+  if (iree_atomic_exchange_int32(&iree_flight_recorder_crashed_, 1,
+                                 iree_memory_order_acq_rel) == 0) {
+    int fd = open(iree_flight_recorder_crash_path_,
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+      iree_flight_recorder_dump_to_fd(fd);
+      close(fd);
+    }
+  }
+
+  // Restore the previous handler and re-raise; the signal is blocked while we
+  // are in the handler so it is delivered to the previous handler (or the
+  // default action) as soon as we return.
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(iree_flight_recorder_crash_signals_); ++i) {
+    if (iree_flight_recorder_crash_signals_[i] == signal_number) {
+      sigaction(signal_number, &iree_flight_recorder_previous_actions_[i],
+                NULL);
+      break;
+    }
+  }
+  raise(signal_number);
+}
+
+iree_status_t iree_flight_recorder_install_crash_handler(const char* path) {
+  IREE_ASSERT_ARGUMENT(path);
+  iree_host_size_t path_length = strlen(path);
+  if (path_length >= sizeof(iree_flight_recorder_crash_path_)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "flight recorder crash dump path too long");
+  }
+  memcpy(iree_flight_recorder_crash_path_, path, path_length + 1);
+
+  // Only install once; otherwise we'd chain to ourselves. Later calls just
+  // update the path.
+  static bool installed = false;
+  if (installed) return iree_ok_status();
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = iree_flight_recorder_crash_handler;
+  sigemptyset(&action.sa_mask);
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(iree_flight_recorder_crash_signals_); ++i) {
+    if (sigaction(iree_flight_recorder_crash_signals_[i], &action,
+                  &iree_flight_recorder_previous_actions_[i]) != 0) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to install flight recorder crash "
+                              "handler");
+    }
+  }
+
+  installed = true;
+  iree_flight_recorder_set_enabled(true);
+  return iree_ok_status();
+}
+
+#endif  // IREE_PLATFORM_*
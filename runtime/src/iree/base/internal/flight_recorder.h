@@ -0,0 +1,154 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_FLIGHT_RECORDER_H_
+#define IREE_BASE_INTERNAL_FLIGHT_RECORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Flight recorder
+//===----------------------------------------------------------------------===//
+// A lightweight always-available event recorder independent of Tracy
+// (IREE_TRACE_*). Each thread records timestamped events into its own
+// fixed-size ring buffer that overwrites the oldest events when full so that
+// the most recent history of every thread is always available. The recorded
+// events can be dumped as Chrome trace event JSON (loadable in Perfetto and
+// chrome://tracing) on demand or when the process crashes.
+//
+// Recording is disabled at runtime by default and costs a single relaxed load
+// per event site when disabled. When enabled recording an event is a clock
+// query and a few stores into the thread ring; no locks are ever taken and
+// the ring of a thread is allocated on its first recorded event. Rings are
+// retained for the lifetime of the process so that events of threads that have
+// exited can still be dumped. Define IREE_FLIGHT_RECORDER_ENABLE=0 to compile
+// all recording out.
+//
+// Event names must be string literals (or otherwise outlive the process) as
+// only their pointers are recorded.
+
+#if !defined(IREE_FLIGHT_RECORDER_ENABLE)
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#define IREE_FLIGHT_RECORDER_ENABLE 0
+#else
+#define IREE_FLIGHT_RECORDER_ENABLE 1
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#endif  // !IREE_FLIGHT_RECORDER_ENABLE
+
+// Number of event slots in each thread ring. Must be a power of two. One slot
+// is reserved for the event being recorded so dumps contain at most
+// IREE_FLIGHT_RECORDER_RING_CAPACITY - 1 events per thread.
+#if !defined(IREE_FLIGHT_RECORDER_RING_CAPACITY)
+#define IREE_FLIGHT_RECORDER_RING_CAPACITY 4096
+#endif  // !IREE_FLIGHT_RECORDER_RING_CAPACITY
+
+// Maximum number of threads that can record events. Threads beyond this limit
+// silently drop their events.
+#if !defined(IREE_FLIGHT_RECORDER_MAX_THREADS)
+#define IREE_FLIGHT_RECORDER_MAX_THREADS 256
+#endif  // !IREE_FLIGHT_RECORDER_MAX_THREADS
+
+// Category of a recorded event.
+typedef enum iree_flight_recorder_category_e {
+  IREE_FLIGHT_RECORDER_CATEGORY_USER = 0,
+  // Task dispatch execution.
+  IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH = 1,
+  // Work submission to an executor or device queue.
+  IREE_FLIGHT_RECORDER_CATEGORY_SUBMISSION = 2,
+  // Memory allocation.
+  IREE_FLIGHT_RECORDER_CATEGORY_ALLOCATION = 3,
+  IREE_FLIGHT_RECORDER_CATEGORY_COUNT,
+} iree_flight_recorder_category_t;
+
+// Phase of a recorded event.
+typedef enum iree_flight_recorder_phase_e {
+  // A point-in-time event.
+  IREE_FLIGHT_RECORDER_PHASE_INSTANT = 0,
+  // Begins a duration on the current thread; must be paired with an END.
+  IREE_FLIGHT_RECORDER_PHASE_BEGIN = 1,
+  // Ends the most recent duration on the current thread.
+  IREE_FLIGHT_RECORDER_PHASE_END = 2,
+} iree_flight_recorder_phase_t;
+
+// DO NOT USE: implementation detail of iree_flight_recorder_is_enabled.
+extern iree_atomic_int32_t iree_flight_recorder_enabled_;
+
+// Returns true if events are currently being recorded.
+static inline bool iree_flight_recorder_is_enabled(void) {
+  return iree_atomic_load_int32(&iree_flight_recorder_enabled_,
+                                iree_memory_order_relaxed) != 0;
+}
+
+// Enables or disables recording for all threads.
+void iree_flight_recorder_set_enabled(bool enabled);
+
+// Records an event on the calling thread. |name| must outlive the process.
+// Prefer the IREE_FLIGHT_RECORD_* macros that check whether recording is
+// enabled first.
+void iree_flight_recorder_record(iree_flight_recorder_category_t category,
+                                 iree_flight_recorder_phase_t phase,
+                                 const char* name, uint64_t value);
+
+// Writes all recorded events of all threads to |fd| as Chrome trace event JSON.
+// Async-signal-safe: does not allocate or lock and may be called from a signal
+// handler. Events recorded concurrently with the dump may be omitted.
+void iree_flight_recorder_dump_to_fd(int fd);
+
+// Writes all recorded events to the file at |path|, replacing its contents.
+iree_status_t iree_flight_recorder_dump_to_file(const char* path);
+
+// Enables recording and installs handlers for fatal signals (SIGSEGV, SIGBUS,
+// SIGILL, SIGFPE, SIGABRT) that dump all recorded events to |path| before
+// chaining to the previously installed handlers. |path| is copied.
+// Returns UNAVAILABLE on platforms without POSIX signals.
+iree_status_t iree_flight_recorder_install_crash_handler(const char* path);
+
+#if IREE_FLIGHT_RECORDER_ENABLE
+
+// DO NOT USE: implementation detail of the IREE_FLIGHT_RECORD_* macros.
+#define IREE_FLIGHT_RECORD_EVENT_(category, phase, name, value)             \
+  do {                                                                      \
+    if (IREE_UNLIKELY(iree_flight_recorder_is_enabled())) {                 \
+      iree_flight_recorder_record((category), (phase), (name),              \
+                                  (uint64_t)(value));                       \
+    }                                                                       \
+  } while (0)
+
+// Records a point-in-time event with an associated |value|.
+#define IREE_FLIGHT_RECORD_INSTANT(category, name, value) \
+  IREE_FLIGHT_RECORD_EVENT_(category, IREE_FLIGHT_RECORDER_PHASE_INSTANT, \
+                            name, value)
+
+// Begins a duration event with an associated |value|.
+#define IREE_FLIGHT_RECORD_BEGIN(category, name, value) \
+  IREE_FLIGHT_RECORD_EVENT_(category, IREE_FLIGHT_RECORDER_PHASE_BEGIN, name, \
+                            value)
+
+// Ends the duration event begun with IREE_FLIGHT_RECORD_BEGIN.
+#define IREE_FLIGHT_RECORD_END(category, name) \
+  IREE_FLIGHT_RECORD_EVENT_(category, IREE_FLIGHT_RECORDER_PHASE_END, name, 0)
+
+#else
+
+#define IREE_FLIGHT_RECORD_INSTANT(category, name, value)
+#define IREE_FLIGHT_RECORD_BEGIN(category, name, value)
+#define IREE_FLIGHT_RECORD_END(category, name)
+
+#endif  // IREE_FLIGHT_RECORDER_ENABLE
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_FLIGHT_RECORDER_H_
@@ -0,0 +1,100 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/flight_recorder.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Dumps the flight recorder to a temporary file and returns its contents.
+static std::string DumpToString() {
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TMPDIR");
+  if (!tmpdir) tmpdir = "/tmp";
+  std::string path = std::string(tmpdir) + "/flight_recorder_test.json";
+  IREE_CHECK_OK(iree_flight_recorder_dump_to_file(path.c_str()));
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  std::remove(path.c_str());
+  return contents.str();
+}
+
+static int CountOccurrences(const std::string& haystack,
+                            const std::string& needle) {
+  int count = 0;
+  for (size_t pos = haystack.find(needle); pos != std::string::npos;
+       pos = haystack.find(needle, pos + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(FlightRecorderTest, DisabledRecordsNothing) {
+  iree_flight_recorder_set_enabled(false);
+  IREE_FLIGHT_RECORD_INSTANT(IREE_FLIGHT_RECORDER_CATEGORY_USER,
+                             "disabled_event", 1);
+  EXPECT_EQ(DumpToString().find("disabled_event"), std::string::npos);
+}
+
+TEST(FlightRecorderTest, RecordsAcrossThreads) {
+  iree_flight_recorder_set_enabled(true);
+  IREE_FLIGHT_RECORD_BEGIN(IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH,
+                           "main_span", 123);
+  std::thread thread([]() {
+    IREE_FLIGHT_RECORD_INSTANT(IREE_FLIGHT_RECORDER_CATEGORY_ALLOCATION,
+                               "thread_alloc", 4096);
+  });
+  thread.join();
+  IREE_FLIGHT_RECORD_END(IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH, "main_span");
+  iree_flight_recorder_set_enabled(false);
+
+  std::string json = DumpToString();
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_NE(json.find("\"name\":\"main_span\",\"cat\":\"dispatch\","
+                      "\"ph\":\"B\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"main_span\",\"cat\":\"dispatch\","
+                      "\"ph\":\"E\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"value\":123}"), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"thread_alloc\",\"cat\":\"allocation\","
+                      "\"ph\":\"i\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"value\":4096}"), std::string::npos);
+}
+
+// Tests that a thread that records more events than fit in its ring only keeps
+// the most recent ones.
+TEST(FlightRecorderTest, RingOverwritesOldest) {
+  iree_flight_recorder_set_enabled(true);
+  std::thread thread([]() {
+    IREE_FLIGHT_RECORD_INSTANT(IREE_FLIGHT_RECORDER_CATEGORY_USER,
+                               "overwritten_event", 0);
+    for (int i = 0; i < IREE_FLIGHT_RECORDER_RING_CAPACITY; ++i) {
+      IREE_FLIGHT_RECORD_INSTANT(IREE_FLIGHT_RECORDER_CATEGORY_SUBMISSION,
+                                 "retained_event", i);
+    }
+  });
+  thread.join();
+  iree_flight_recorder_set_enabled(false);
+
+  std::string json = DumpToString();
+  EXPECT_EQ(json.find("overwritten_event"), std::string::npos);
+  EXPECT_EQ(CountOccurrences(json, "\"name\":\"retained_event\""),
+            IREE_FLIGHT_RECORDER_RING_CAPACITY - 1);
+}
+
+}  // namespace
@@ -0,0 +1,396 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/slab_allocator.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+
+#if defined(IREE_PLATFORM_WINDOWS)
+// FlsAlloc is used for thread exit notification.
+#elif !IREE_SYNCHRONIZATION_DISABLE_UNSAFE && !defined(IREE_PLATFORM_GENERIC)
+#include <pthread.h>
+#define IREE_SLAB_ALLOCATOR_HAVE_PTHREAD_KEY 1
+#endif  // IREE_PLATFORM_*
+
+#if defined(IREE_COMPILER_MSVC)
+#define IREE_SLAB_ALLOCATOR_THREAD_LOCAL __declspec(thread)
+#else
+#define IREE_SLAB_ALLOCATOR_THREAD_LOCAL __thread
+#endif  // IREE_COMPILER_MSVC
+
+//===----------------------------------------------------------------------===//
+// Blocks
+//===----------------------------------------------------------------------===//
+
+// Every allocation is prefixed with a header of this size that records the size
+// class of the block so that frees and reallocs can route it. Padded to the
+// maximum alignment so that the returned pointer retains system alignment.
+#define IREE_SLAB_ALLOCATOR_HEADER_SIZE iree_max_align_t
+
+// Size class recorded for allocations forwarded to the system allocator.
+#define IREE_SLAB_ALLOCATOR_LARGE_CLASS UINT32_MAX
+
+// A free block in a thread cache or depot. Overlays the block header.
+typedef struct iree_slab_free_block_t {
+  struct iree_slab_free_block_t* next;
+} iree_slab_free_block_t;
+
+static inline iree_host_size_t iree_slab_class_block_size(uint32_t size_class) {
+  return (iree_host_size_t)IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE << size_class;
+}
+
+static inline iree_host_size_t iree_slab_class_stride(uint32_t size_class) {
+  return IREE_SLAB_ALLOCATOR_HEADER_SIZE +
+         iree_slab_class_block_size(size_class);
+}
+
+// Returns the size class serving |byte_length| or
+// IREE_SLAB_ALLOCATOR_LARGE_CLASS if it is too large.
+static inline uint32_t iree_slab_select_class(iree_host_size_t byte_length) {
+  uint32_t size_class = 0;
+  iree_host_size_t block_size = IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE;
+  while (block_size < byte_length) {
+    if (++size_class == IREE_SLAB_ALLOCATOR_CLASS_COUNT) {
+      return IREE_SLAB_ALLOCATOR_LARGE_CLASS;
+    }
+    block_size <<= 1;
+  }
+  return size_class;
+}
+
+static inline uint32_t* iree_slab_block_header(void* ptr) {
+  return (uint32_t*)((uint8_t*)ptr - IREE_SLAB_ALLOCATOR_HEADER_SIZE);
+}
+
+//===----------------------------------------------------------------------===//
+// Shared depot
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_slab_depot_t {
+  iree_slim_mutex_t mutex;
+  // Free blocks available to any thread.
+  iree_slab_free_block_t* head;
+  // Guarded by |mutex|.
+  iree_slab_allocator_class_statistics_t statistics;
+} iree_slab_depot_t;
+
+static iree_slab_depot_t iree_slab_depots_[IREE_SLAB_ALLOCATOR_CLASS_COUNT];
+static iree_once_flag iree_slab_depots_once_ = IREE_ONCE_FLAG_INIT;
+static iree_atomic_int64_t iree_slab_large_allocation_count_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+static void iree_slab_thread_exit(void* cache_ptr);
+
+#if defined(IREE_PLATFORM_WINDOWS)
+static DWORD iree_slab_thread_key_ = FLS_OUT_OF_INDEXES;
+static void NTAPI iree_slab_thread_exit_callback(void* cache_ptr) {
+  iree_slab_thread_exit(cache_ptr);
+}
+#elif defined(IREE_SLAB_ALLOCATOR_HAVE_PTHREAD_KEY)
+static pthread_key_t iree_slab_thread_key_;
+static bool iree_slab_thread_key_valid_ = false;
+#endif  // IREE_PLATFORM_*
+
+static void iree_slab_depots_initialize(void) {
+  for (uint32_t i = 0; i < IREE_SLAB_ALLOCATOR_CLASS_COUNT; ++i) {
+    iree_slab_depot_t* depot = &iree_slab_depots_[i];
+    iree_slim_mutex_initialize(&depot->mutex);
+    depot->head = NULL;
+    memset(&depot->statistics, 0, sizeof(depot->statistics));
+  }
+#if defined(IREE_PLATFORM_WINDOWS)
+  iree_slab_thread_key_ = FlsAlloc(iree_slab_thread_exit_callback);
+#elif defined(IREE_SLAB_ALLOCATOR_HAVE_PTHREAD_KEY)
+  iree_slab_thread_key_valid_ =
+      pthread_key_create(&iree_slab_thread_key_, iree_slab_thread_exit) == 0;
+#endif  // IREE_PLATFORM_*
+}
+
+// Pops up to |max_count| blocks from the depot of |size_class| into a list,
+// allocating a new slab if the depot is empty. Returns the number of blocks.
+static iree_host_size_t iree_slab_depot_acquire(
+    uint32_t size_class, iree_host_size_t max_count,
+    iree_slab_free_block_t** out_head) {
+  iree_slab_depot_t* depot = &iree_slab_depots_[size_class];
+  iree_slim_mutex_lock(&depot->mutex);
+
+  if (!depot->head) {
+    // Carve a new slab into blocks. Slabs are never returned to the system.
+    const iree_host_size_t stride = iree_slab_class_stride(size_class);
+    const iree_host_size_t block_count =
+        iree_max(IREE_SLAB_ALLOCATOR_SLAB_SIZE / stride, 1);
+    uint8_t* slab = (uint8_t*)malloc(block_count * stride);
+    if (!slab) {
+      iree_slim_mutex_unlock(&depot->mutex);
+      *out_head = NULL;
+      return 0;
+    }
+    for (iree_host_size_t i = 0; i < block_count; ++i) {
+      iree_slab_free_block_t* block =
+          (iree_slab_free_block_t*)(slab + (block_count - i - 1) * stride);
+      block->next = depot->head;
+      depot->head = block;
+    }
+    ++depot->statistics.slab_count;
+    depot->statistics.block_count += block_count;
+    depot->statistics.depot_block_count += block_count;
+  }
+
+  iree_slab_free_block_t* head = depot->head;
+  iree_slab_free_block_t* tail = head;
+  iree_host_size_t count = 1;
+  while (count < max_count && tail->next) {
+    tail = tail->next;
+    ++count;
+  }
+  depot->head = tail->next;
+  tail->next = NULL;
+  depot->statistics.depot_block_count -= count;
+  ++depot->statistics.refill_count;
+
+  iree_slim_mutex_unlock(&depot->mutex);
+  *out_head = head;
+  return count;
+}
+
+// Pushes the list of |count| blocks from |head| to |tail| into the depot.
+static void iree_slab_depot_release(uint32_t size_class,
+                                    iree_slab_free_block_t* head,
+                                    iree_slab_free_block_t* tail,
+                                    iree_host_size_t count) {
+  iree_slab_depot_t* depot = &iree_slab_depots_[size_class];
+  iree_slim_mutex_lock(&depot->mutex);
+  tail->next = depot->head;
+  depot->head = head;
+  depot->statistics.depot_block_count += count;
+  ++depot->statistics.flush_count;
+  iree_slim_mutex_unlock(&depot->mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// Thread caches
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_slab_thread_class_t {
+  iree_slab_free_block_t* head;
+  iree_host_size_t count;
+} iree_slab_thread_class_t;
+
+typedef struct iree_slab_thread_cache_t {
+  // True once the depots are initialized and the thread exit handler is set.
+  bool registered;
+  iree_slab_thread_class_t classes[IREE_SLAB_ALLOCATOR_CLASS_COUNT];
+} iree_slab_thread_cache_t;
+
+static IREE_SLAB_ALLOCATOR_THREAD_LOCAL iree_slab_thread_cache_t
+    iree_slab_thread_cache_;
+
+static void iree_slab_thread_cache_register(iree_slab_thread_cache_t* cache) {
+  iree_call_once(&iree_slab_depots_once_, iree_slab_depots_initialize);
+#if defined(IREE_PLATFORM_WINDOWS)
+  if (iree_slab_thread_key_ != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(iree_slab_thread_key_, cache);
+  }
+#elif defined(IREE_SLAB_ALLOCATOR_HAVE_PTHREAD_KEY)
+  if (iree_slab_thread_key_valid_) {
+    pthread_setspecific(iree_slab_thread_key_, cache);
+  }
+#endif  // IREE_PLATFORM_*
+  cache->registered = true;
+}
+
+// Moves up to |count| blocks of |size_class| from |cache| to the depot.
+static void iree_slab_thread_cache_flush_class(iree_slab_thread_cache_t* cache,
+                                               uint32_t size_class,
+                                               iree_host_size_t count) {
+  iree_slab_thread_class_t* list = &cache->classes[size_class];
+  count = iree_min(count, list->count);
+  if (!count) return;
+  iree_slab_free_block_t* head = list->head;
+  iree_slab_free_block_t* tail = head;
+  for (iree_host_size_t i = 1; i < count; ++i) tail = tail->next;
+  list->head = tail->next;
+  list->count -= count;
+  iree_slab_depot_release(size_class, head, tail, count);
+}
+
+static void iree_slab_thread_cache_flush(iree_slab_thread_cache_t* cache) {
+  if (!cache->registered) return;
+  for (uint32_t i = 0; i < IREE_SLAB_ALLOCATOR_CLASS_COUNT; ++i) {
+    iree_slab_thread_cache_flush_class(cache, i, cache->classes[i].count);
+  }
+}
+
+static void iree_slab_thread_exit(void* cache_ptr) {
+  iree_slab_thread_cache_flush((iree_slab_thread_cache_t*)cache_ptr);
+}
+
+void iree_allocator_slab_flush_thread_cache(void) {
+  iree_slab_thread_cache_flush(&iree_slab_thread_cache_);
+}
+
+// Pops a block of |size_class| from the thread cache, refilling the cache from
+// the depot if it is empty. Returns NULL if the system is out of memory.
+static void* iree_slab_thread_cache_acquire(uint32_t size_class) {
+  iree_slab_thread_cache_t* cache = &iree_slab_thread_cache_;
+  iree_slab_thread_class_t* list = &cache->classes[size_class];
+  if (IREE_UNLIKELY(!list->head)) {
+    if (IREE_UNLIKELY(!cache->registered)) {
+      iree_slab_thread_cache_register(cache);
+    }
+    list->count = iree_slab_depot_acquire(
+        size_class, IREE_SLAB_ALLOCATOR_CACHE_CAPACITY / 2, &list->head);
+    if (IREE_UNLIKELY(!list->head)) return NULL;
+  }
+  iree_slab_free_block_t* block = list->head;
+  list->head = block->next;
+  --list->count;
+  *(uint32_t*)block = size_class;
+  return (uint8_t*)block + IREE_SLAB_ALLOCATOR_HEADER_SIZE;
+}
+
+// Pushes the block at |ptr| of |size_class| onto the thread cache, moving half
+// of the cache to the depot if it overflows.
+static void iree_slab_thread_cache_release(uint32_t size_class, void* ptr) {
+  iree_slab_thread_cache_t* cache = &iree_slab_thread_cache_;
+  if (IREE_UNLIKELY(!cache->registered)) {
+    // Block was allocated on another thread.
+    iree_slab_thread_cache_register(cache);
+  }
+  iree_slab_thread_class_t* list = &cache->classes[size_class];
+  iree_slab_free_block_t* block =
+      (iree_slab_free_block_t*)iree_slab_block_header(ptr);
+  block->next = list->head;
+  list->head = block;
+  if (IREE_UNLIKELY(++list->count > IREE_SLAB_ALLOCATOR_CACHE_CAPACITY)) {
+    iree_slab_thread_cache_flush_class(cache, size_class,
+                                       IREE_SLAB_ALLOCATOR_CACHE_CAPACITY / 2);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_allocator_slab
+//===----------------------------------------------------------------------===//
+
+static void* iree_slab_large_allocate(iree_host_size_t byte_length,
+                                      bool zero) {
+  iree_host_size_t total_length = IREE_SLAB_ALLOCATOR_HEADER_SIZE + byte_length;
+  uint8_t* base =
+      (uint8_t*)(zero ? calloc(1, total_length) : malloc(total_length));
+  if (!base) return NULL;
+  *(uint32_t*)base = IREE_SLAB_ALLOCATOR_LARGE_CLASS;
+  iree_atomic_fetch_add_int64(&iree_slab_large_allocation_count_, 1,
+                              iree_memory_order_relaxed);
+  return base + IREE_SLAB_ALLOCATOR_HEADER_SIZE;
+}
+
+static void* iree_slab_allocate(iree_host_size_t byte_length, bool zero) {
+  uint32_t size_class = iree_slab_select_class(byte_length);
+  if (size_class == IREE_SLAB_ALLOCATOR_LARGE_CLASS) {
+    return iree_slab_large_allocate(byte_length, zero);
+  }
+  void* ptr = iree_slab_thread_cache_acquire(size_class);
+  if (ptr && zero) memset(ptr, 0, byte_length);
+  return ptr;
+}
+
+static void iree_slab_free(void* ptr) {
+  uint32_t size_class = *iree_slab_block_header(ptr);
+  if (size_class == IREE_SLAB_ALLOCATOR_LARGE_CLASS) {
+    free(iree_slab_block_header(ptr));
+  } else {
+    iree_slab_thread_cache_release(size_class, ptr);
+  }
+}
+
+static void* iree_slab_reallocate(void* ptr, iree_host_size_t byte_length) {
+  uint32_t size_class = *iree_slab_block_header(ptr);
+  if (size_class == IREE_SLAB_ALLOCATOR_LARGE_CLASS) {
+    uint8_t* base = (uint8_t*)realloc(iree_slab_block_header(ptr),
+                                      IREE_SLAB_ALLOCATOR_HEADER_SIZE +
+                                          byte_length);
+    return base ? base + IREE_SLAB_ALLOCATOR_HEADER_SIZE : NULL;
+  }
+  iree_host_size_t block_size = iree_slab_class_block_size(size_class);
+  if (byte_length <= block_size) return ptr;
+  void* new_ptr = iree_slab_allocate(byte_length, /*zero=*/false);
+  if (!new_ptr) return NULL;
+  memcpy(new_ptr, ptr, block_size);
+  iree_slab_thread_cache_release(size_class, ptr);
+  return new_ptr;
+}
+
+iree_status_t iree_allocator_slab_ctl(void* self,
+                                      iree_allocator_command_t command,
+                                      const void* params, void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(inout_ptr);
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC:
+    case IREE_ALLOCATOR_COMMAND_REALLOC: {
+      IREE_ASSERT_ARGUMENT(params);
+      iree_host_size_t byte_length =
+          ((const iree_allocator_alloc_params_t*)params)->byte_length;
+      if (IREE_UNLIKELY(byte_length == 0)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "allocations must be >0 bytes");
+      }
+      void* existing_ptr = *inout_ptr;
+      void* new_ptr = NULL;
+      if (existing_ptr && command == IREE_ALLOCATOR_COMMAND_REALLOC) {
+        new_ptr = iree_slab_reallocate(existing_ptr, byte_length);
+      } else {
+        existing_ptr = NULL;
+        new_ptr = iree_slab_allocate(
+            byte_length, command == IREE_ALLOCATOR_COMMAND_CALLOC);
+      }
+      if (!new_ptr) {
+        return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                "slab allocator failed the request");
+      }
+      if (existing_ptr) {
+        IREE_TRACE_FREE(existing_ptr);
+      }
+      IREE_TRACE_ALLOC(new_ptr, byte_length);
+      *inout_ptr = new_ptr;
+      return iree_ok_status();
+    }
+    case IREE_ALLOCATOR_COMMAND_FREE: {
+      void* ptr = *inout_ptr;
+      if (IREE_LIKELY(ptr != NULL)) {
+        IREE_TRACE_FREE(ptr);
+        iree_slab_free(ptr);
+        *inout_ptr = NULL;
+      }
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported slab allocator command");
+  }
+}
+
+void iree_allocator_slab_query_statistics(
+    iree_slab_allocator_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  iree_call_once(&iree_slab_depots_once_, iree_slab_depots_initialize);
+  for (uint32_t i = 0; i < IREE_SLAB_ALLOCATOR_CLASS_COUNT; ++i) {
+    iree_slab_depot_t* depot = &iree_slab_depots_[i];
+    iree_slim_mutex_lock(&depot->mutex);
+    out_statistics->classes[i] = depot->statistics;
+    iree_slim_mutex_unlock(&depot->mutex);
+    out_statistics->classes[i].block_size = iree_slab_class_block_size(i);
+  }
+  out_statistics->large_allocation_count = (uint64_t)iree_atomic_load_int64(
+      &iree_slab_large_allocation_count_, iree_memory_order_relaxed);
+}
@@ -0,0 +1,110 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_SLAB_ALLOCATOR_H_
+#define IREE_BASE_INTERNAL_SLAB_ALLOCATOR_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_allocator_slab
+//===----------------------------------------------------------------------===//
+// A process-wide size-class allocator for small host allocations.
+//
+// Small allocations are rounded up to a power-of-two size class and served
+// from per-thread free lists without taking any locks. Thread caches exchange
+// batches of blocks with a shared per-class depot when they run empty or
+// overflow and the depot carves new blocks out of slabs allocated from the
+// system allocator. Allocations larger than the largest size class go directly
+// to the system allocator.
+//
+// Freed blocks are retained for reuse for the lifetime of the process so the
+// memory held is bounded by the peak small allocation usage. Blocks may be
+// freed on any thread; threads flush their caches back to the depot when they
+// exit.
+//
+// Memory allocated with iree_allocator_slab() must only be freed or
+// reallocated with iree_allocator_slab().
+
+// Number of power-of-two size classes starting at
+// IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE bytes.
+#if !defined(IREE_SLAB_ALLOCATOR_CLASS_COUNT)
+#define IREE_SLAB_ALLOCATOR_CLASS_COUNT 8
+#endif  // !IREE_SLAB_ALLOCATOR_CLASS_COUNT
+
+// Size in bytes of the smallest size class.
+#define IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE 16
+
+// Size in bytes of the largest size class. Larger allocations are forwarded to
+// the system allocator.
+#define IREE_SLAB_ALLOCATOR_MAX_BLOCK_SIZE \
+  (IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE << (IREE_SLAB_ALLOCATOR_CLASS_COUNT - 1))
+
+// Maximum number of free blocks of each size class held by a thread.
+#if !defined(IREE_SLAB_ALLOCATOR_CACHE_CAPACITY)
+#define IREE_SLAB_ALLOCATOR_CACHE_CAPACITY 64
+#endif  // !IREE_SLAB_ALLOCATOR_CACHE_CAPACITY
+
+// Size in bytes of each slab allocated from the system allocator.
+#if !defined(IREE_SLAB_ALLOCATOR_SLAB_SIZE)
+#define IREE_SLAB_ALLOCATOR_SLAB_SIZE (64 * 1024)
+#endif  // !IREE_SLAB_ALLOCATOR_SLAB_SIZE
+
+// Statistics for a single size class.
+typedef struct iree_slab_allocator_class_statistics_t {
+  // Maximum allocation size in bytes served by the class.
+  iree_host_size_t block_size;
+  // Total number of slabs allocated from the system allocator.
+  iree_host_size_t slab_count;
+  // Total number of blocks carved from slabs.
+  iree_host_size_t block_count;
+  // Number of free blocks in the shared depot (excludes thread caches).
+  iree_host_size_t depot_block_count;
+  // Number of times a thread cache was refilled from the depot.
+  uint64_t refill_count;
+  // Number of times a thread cache overflowed into the depot.
+  uint64_t flush_count;
+} iree_slab_allocator_class_statistics_t;
+
+// Statistics for the process-wide slab allocator.
+typedef struct iree_slab_allocator_statistics_t {
+  iree_slab_allocator_class_statistics_t
+      classes[IREE_SLAB_ALLOCATOR_CLASS_COUNT];
+  // Total number of allocations forwarded to the system allocator.
+  uint64_t large_allocation_count;
+} iree_slab_allocator_statistics_t;
+
+// Slab allocator controller; see iree_allocator_slab.
+iree_status_t iree_allocator_slab_ctl(void* self,
+                                      iree_allocator_command_t command,
+                                      const void* params, void** inout_ptr);
+
+// Returns an allocator that serves small allocations from per-thread size-class
+// free lists and forwards large ones to the system allocator.
+static inline iree_allocator_t iree_allocator_slab(void) {
+  iree_allocator_t v = {NULL, iree_allocator_slab_ctl};
+  return v;
+}
+
+// Queries the current statistics of the slab allocator.
+void iree_allocator_slab_query_statistics(
+    iree_slab_allocator_statistics_t* out_statistics);
+
+// Returns all free blocks cached by the calling thread to the shared depot so
+// that other threads may reuse them.
+void iree_allocator_slab_flush_thread_cache(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_SLAB_ALLOCATOR_H_
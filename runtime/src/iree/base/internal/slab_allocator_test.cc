@@ -0,0 +1,104 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/slab_allocator.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+static iree_slab_allocator_statistics_t QueryStatistics() {
+  iree_slab_allocator_statistics_t statistics;
+  iree_allocator_slab_query_statistics(&statistics);
+  return statistics;
+}
+
+TEST(SlabAllocatorTest, SizeClasses) {
+  iree_slab_allocator_statistics_t statistics = QueryStatistics();
+  for (int i = 0; i < IREE_SLAB_ALLOCATOR_CLASS_COUNT; ++i) {
+    EXPECT_EQ(statistics.classes[i].block_size,
+              IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE << i);
+  }
+  EXPECT_EQ(statistics.classes[IREE_SLAB_ALLOCATOR_CLASS_COUNT - 1].block_size,
+            IREE_SLAB_ALLOCATOR_MAX_BLOCK_SIZE);
+}
+
+// Tests allocations across all size classes and the large allocation path.
+TEST(SlabAllocatorTest, AllocateFree) {
+  iree_allocator_t allocator = iree_allocator_slab();
+  uint64_t large_count = QueryStatistics().large_allocation_count;
+  std::vector<std::pair<uint8_t*, size_t>> allocations;
+  for (size_t size = 1; size <= IREE_SLAB_ALLOCATOR_MAX_BLOCK_SIZE * 2;
+       size = size * 2 + 1) {
+    uint8_t* ptr = NULL;
+    IREE_ASSERT_OK(iree_allocator_malloc(allocator, size, (void**)&ptr));
+    EXPECT_EQ((uintptr_t)ptr % iree_max_align_t, 0u);
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(ptr[i], 0);
+    memset(ptr, 0xCD, size);
+    allocations.push_back({ptr, size});
+  }
+  EXPECT_GT(QueryStatistics().large_allocation_count, large_count);
+  for (auto& allocation : allocations) {
+    iree_allocator_free(allocator, allocation.first);
+  }
+}
+
+// Tests that reallocation preserves contents when moving between classes.
+TEST(SlabAllocatorTest, Realloc) {
+  iree_allocator_t allocator = iree_allocator_slab();
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 8, (void**)&ptr));
+  for (int i = 0; i < 8; ++i) ptr[i] = (uint8_t)i;
+
+  // Growing within the class keeps the same block.
+  uint8_t* same_ptr = ptr;
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 16, (void**)&ptr));
+  EXPECT_EQ(ptr, same_ptr);
+
+  // Growing into another class and then into a large allocation copies.
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 100, (void**)&ptr));
+  IREE_ASSERT_OK(iree_allocator_realloc(
+      allocator, IREE_SLAB_ALLOCATOR_MAX_BLOCK_SIZE * 4, (void**)&ptr));
+  for (int i = 0; i < 8; ++i) EXPECT_EQ(ptr[i], i);
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 32, (void**)&ptr));
+  for (int i = 0; i < 8; ++i) EXPECT_EQ(ptr[i], i);
+  iree_allocator_free(allocator, ptr);
+}
+
+// Tests that blocks freed beyond the thread cache capacity overflow into the
+// depot and that exiting threads return their cached blocks.
+TEST(SlabAllocatorTest, CacheOverflowAndThreadExit) {
+  iree_allocator_t allocator = iree_allocator_slab();
+  const int size_class = 3;
+  const size_t size = IREE_SLAB_ALLOCATOR_MIN_BLOCK_SIZE << size_class;
+  uint64_t flush_count = QueryStatistics().classes[size_class].flush_count;
+
+  std::thread thread([&]() {
+    std::vector<void*> ptrs(IREE_SLAB_ALLOCATOR_CACHE_CAPACITY * 2);
+    for (auto& ptr : ptrs) {
+      IREE_ASSERT_OK(iree_allocator_malloc(allocator, size, &ptr));
+    }
+    for (auto ptr : ptrs) iree_allocator_free(allocator, ptr);
+  });
+  thread.join();
+
+  iree_slab_allocator_class_statistics_t statistics =
+      QueryStatistics().classes[size_class];
+  EXPECT_GT(statistics.flush_count, flush_count);
+  EXPECT_GE(statistics.block_count, IREE_SLAB_ALLOCATOR_CACHE_CAPACITY * 2);
+
+  // Everything not held by this thread's cache is back in the depot.
+  iree_allocator_slab_flush_thread_cache();
+  statistics = QueryStatistics().classes[size_class];
+  EXPECT_EQ(statistics.depot_block_count, statistics.block_count);
+}
+
+}  // namespace
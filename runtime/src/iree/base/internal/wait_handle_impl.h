@@ -41,9 +41,14 @@
 #define IREE_WAIT_API_PPOLL 4
 #define IREE_WAIT_API_EPOLL 5
 #define IREE_WAIT_API_KQUEUE 6
+#define IREE_WAIT_API_IO_URING 7
 
 // We allow overriding the wait API via command line flags. If unspecified we
 // try to guess based on the target platform.
+//
+// IO_URING is opt-in (-DIREE_WAIT_API=7) on Linux: it keeps poll registrations
+// alive across waits and is worth it when thousands of handles are waited on
+// at once. It falls back to ppoll at runtime if io_uring is unavailable.
 #if !defined(IREE_WAIT_API)
 
 // NOTE: we could be tighter here, but we today only have win32 or not-win32.
@@ -73,7 +78,8 @@
 #if (IREE_WAIT_API == IREE_WAIT_API_POLL) ||  \
     (IREE_WAIT_API == IREE_WAIT_API_PPOLL) || \
     (IREE_WAIT_API == IREE_WAIT_API_EPOLL) || \
-    (IREE_WAIT_API == IREE_WAIT_API_KQUEUE)
+    (IREE_WAIT_API == IREE_WAIT_API_KQUEUE) || \
+    (IREE_WAIT_API == IREE_WAIT_API_IO_URING)
 #define IREE_WAIT_API_POSIX_LIKE 1
 #endif  // IREE_WAIT_API = posix-like
 
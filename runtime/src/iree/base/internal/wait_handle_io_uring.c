@@ -0,0 +1,771 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first to ensure that we can define settings for all includes.
+#include "iree/base/internal/wait_handle_impl.h"
+
+#if IREE_WAIT_API == IREE_WAIT_API_IO_URING
+
+#include <errno.h>
+#include <endian.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iree/base/internal/wait_handle_posix.h"
+#include "iree/base/tracing.h"
+
+// The poll and ppoll implementations hand the kernel the full fd list on every
+// wait and the kernel has to register (and then unregister) a wakeup on each
+// of them. With thousands of outstanding fences that dominates the wait.
+//
+// Here each handle in the set gets a one-shot IORING_OP_POLL_ADD request that
+// stays registered in the ring across waits; only handles that fired during a
+// previous wait need to be rearmed and only handles erased from the set need to
+// be removed. All of those requests are queued in the submission ring and sent
+// to the kernel in a single io_uring_enter that also performs the wait.
+//
+// Rearming a fired handle at the start of the next wait gives us the same
+// level-triggered behavior as poll: a poll request on an fd that is already
+// readable completes inline during submission.
+//
+// io_uring may be unavailable at runtime (old kernels, seccomp filters in
+// containers, io_uring_disabled sysctls, etc). In that case the set falls back
+// to ppoll over the same slot list.
+//
+// Documentation: https://man7.org/linux/man-pages/man7/io_uring.7.html
+
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// Upper bound on the submission ring size. Queued requests are flushed to the
+// kernel (without waiting) when the ring fills up so this only bounds how many
+// requests can be batched into a single syscall.
+#define IREE_IO_URING_MAX_SQ_ENTRIES 4096
+
+// Upper bound on the completion ring size (IORING_MAX_CQ_ENTRIES).
+#define IREE_IO_URING_MAX_CQ_ENTRIES 65536
+
+typedef struct iree_io_uring_t {
+  // Ring file descriptor or -1 if io_uring is not available.
+  int fd;
+
+  // Mapped submission and completion rings. These may alias if the kernel
+  // supports IORING_FEAT_SINGLE_MMAP.
+  void* sq_ring_ptr;
+  size_t sq_ring_size;
+  void* cq_ring_ptr;
+  size_t cq_ring_size;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t* sq_array;
+  uint32_t sq_mask;
+  uint32_t sq_entries;
+  // Tail of the requests we've filled in but not yet published.
+  uint32_t sq_local_tail;
+  // Tail of the requests the kernel has consumed.
+  uint32_t sq_submitted_tail;
+
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  struct io_uring_cqe* cqes;
+} iree_io_uring_t;
+
+static int iree_syscall_io_uring_setup(uint32_t entries,
+                                       struct io_uring_params* params) {
+  return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int iree_syscall_io_uring_enter(int fd, uint32_t to_submit,
+                                       uint32_t min_complete, uint32_t flags,
+                                       void* arg, size_t arg_size) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      arg, arg_size);
+}
+
+static void iree_io_uring_deinitialize(iree_io_uring_t* ring) {
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring_ptr && ring->cq_ring_ptr != ring->sq_ring_ptr) {
+    munmap(ring->cq_ring_ptr, ring->cq_ring_size);
+  }
+  if (ring->sq_ring_ptr) munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+  if (ring->fd >= 0) close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+// Sets up a ring with at least |sq_entries| submission entries and
+// |cq_entries| completion entries. Returns false and leaves the ring with
+// fd = -1 if io_uring is not available or lacks the features we need.
+static bool iree_io_uring_initialize(uint32_t sq_entries, uint32_t cq_entries,
+                                     iree_io_uring_t* out_ring) {
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = cq_entries;
+  int fd = iree_syscall_io_uring_setup(sq_entries, &params);
+  if (fd < 0) return false;
+  out_ring->fd = fd;
+
+  // We rely on the kernel never dropping completions (we may have more
+  // stale requests in flight than there are completion entries) and on being
+  // able to pass a timeout to io_uring_enter.
+  const uint32_t required_features = IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((params.features & required_features) != required_features) {
+    iree_io_uring_deinitialize(out_ring);
+    return false;
+  }
+
+  out_ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  out_ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    out_ring->sq_ring_size =
+        iree_max(out_ring->sq_ring_size, out_ring->cq_ring_size);
+    out_ring->cq_ring_size = out_ring->sq_ring_size;
+  }
+  void* sq_ring_ptr =
+      mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ptr == MAP_FAILED) {
+    iree_io_uring_deinitialize(out_ring);
+    return false;
+  }
+  out_ring->sq_ring_ptr = sq_ring_ptr;
+  void* cq_ring_ptr = sq_ring_ptr;
+  if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+    cq_ring_ptr = mmap(NULL, out_ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring_ptr == MAP_FAILED) {
+      iree_io_uring_deinitialize(out_ring);
+      return false;
+    }
+  }
+  out_ring->cq_ring_ptr = cq_ring_ptr;
+  out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(NULL, out_ring->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    iree_io_uring_deinitialize(out_ring);
+    return false;
+  }
+  out_ring->sqes = (struct io_uring_sqe*)sqes;
+
+  uint8_t* sq_base = (uint8_t*)sq_ring_ptr;
+  out_ring->sq_head = (uint32_t*)(sq_base + params.sq_off.head);
+  out_ring->sq_tail = (uint32_t*)(sq_base + params.sq_off.tail);
+  out_ring->sq_array = (uint32_t*)(sq_base + params.sq_off.array);
+  out_ring->sq_mask = *(uint32_t*)(sq_base + params.sq_off.ring_mask);
+  out_ring->sq_entries = params.sq_entries;
+  out_ring->sq_local_tail = *out_ring->sq_tail;
+  out_ring->sq_submitted_tail = out_ring->sq_local_tail;
+  uint8_t* cq_base = (uint8_t*)cq_ring_ptr;
+  out_ring->cq_head = (uint32_t*)(cq_base + params.cq_off.head);
+  out_ring->cq_tail = (uint32_t*)(cq_base + params.cq_off.tail);
+  out_ring->cq_mask = *(uint32_t*)(cq_base + params.cq_off.ring_mask);
+  out_ring->cqes = (struct io_uring_cqe*)(cq_base + params.cq_off.cqes);
+
+  // Submission entries are always used in order so the indirection array is
+  // the identity mapping.
+  for (uint32_t i = 0; i < params.sq_entries; ++i) {
+    out_ring->sq_array[i] = i;
+  }
+
+  return true;
+}
+
+// Submits and optionally waits for at least |min_complete| completions or
+// until |deadline_ns| elapses. Returns DEADLINE_EXCEEDED on timeout.
+static iree_status_t iree_io_uring_enter(iree_io_uring_t* ring,
+                                         uint32_t min_complete,
+                                         iree_time_t deadline_ns) {
+  // Publish all queued requests to the kernel.
+  __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+  int rv = -1;
+  do {
+    uint32_t to_submit = ring->sq_local_tail - ring->sq_submitted_tail;
+    uint32_t flags = 0;
+    struct __kernel_timespec timeout_ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    if (min_complete > 0) {
+      flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+      // Must be recomputed every iteration of the loop as a previous enter may
+      // have taken some of the time.
+      if (deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+        iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+        if (timeout_ns < 0) timeout_ns = 0;
+        timeout_ts.tv_sec = (int64_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long long)(timeout_ns % 1000000000ull);
+        arg.ts = (uint64_t)(uintptr_t)&timeout_ts;
+      }
+    } else if (to_submit == 0) {
+      return iree_ok_status();
+    }
+    rv = iree_syscall_io_uring_enter(ring->fd, to_submit, min_complete, flags,
+                                     flags ? &arg : NULL,
+                                     flags ? sizeof(arg) : 0);
+    if (rv >= 0) ring->sq_submitted_tail += (uint32_t)rv;
+  } while (rv < 0 && errno == EINTR);
+  if (rv < 0) {
+    if (errno == ETIME) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    } else if (errno == EBUSY || errno == EAGAIN) {
+      // Completion ring is backed up; the caller will reap and retry.
+      return iree_ok_status();
+    }
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring_enter failure %d", errno);
+  }
+  return iree_ok_status();
+}
+
+// Returns the next free submission entry, flushing queued entries to the
+// kernel if the ring is full. Returns NULL if no entry could be acquired.
+static struct io_uring_sqe* iree_io_uring_acquire_sqe(iree_io_uring_t* ring) {
+  uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  if (ring->sq_local_tail - head >= ring->sq_entries) {
+    iree_status_t status =
+        iree_io_uring_enter(ring, /*min_complete=*/0, IREE_TIME_INFINITE_PAST);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      return NULL;
+    }
+    head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->sq_entries) return NULL;
+  }
+  struct io_uring_sqe* sqe = &ring->sqes[ring->sq_local_tail & ring->sq_mask];
+  ++ring->sq_local_tail;
+  memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_wait_set_t
+//===----------------------------------------------------------------------===//
+
+// Sentinel slot index used to terminate the slot free list.
+#define IREE_WAIT_SET_SLOT_NONE UINT16_MAX
+
+// user_data for requests whose completions we don't care about (removals).
+#define IREE_WAIT_SET_IGNORED_USER_DATA UINT64_MAX
+
+typedef enum iree_wait_set_slot_state_e {
+  IREE_WAIT_SET_SLOT_FREE = 0,
+  // The handle has no fd and can never be signaled (poll ignores these too).
+  IREE_WAIT_SET_SLOT_INERT,
+  // A poll request is queued or in flight.
+  IREE_WAIT_SET_SLOT_ARMED,
+  // The poll request completed with |result|; the slot will be rearmed on the
+  // next wait.
+  IREE_WAIT_SET_SLOT_FIRED,
+} iree_wait_set_slot_state_t;
+
+typedef struct iree_wait_set_slot_t {
+  iree_wait_handle_t user_handle;
+  int fd;
+  // Incremented each time the slot is erased; completions carry the generation
+  // they were submitted with so that stale ones can be dropped.
+  uint32_t generation;
+  // Poll revents mask or -errno when FIRED.
+  int32_t result;
+  // Index in iree_wait_set_t::fired_slots when FIRED.
+  uint16_t fired_index;
+  // Next free slot when FREE.
+  uint16_t next_free;
+  uint8_t state;
+} iree_wait_set_slot_t;
+
+struct iree_wait_set_t {
+  iree_allocator_t allocator;
+
+  // Total capacity of each handle list.
+  iree_host_size_t handle_capacity;
+
+  // Total number of handles inserted into the set.
+  iree_host_size_t handle_count;
+
+  // io_uring used to poll handles; fd is -1 if we fell back to ppoll.
+  iree_io_uring_t ring;
+
+  // Slots that handles are stored in. Slot indices are stable while a handle
+  // is in the set so that they can be used to route completions.
+  iree_wait_set_slot_t* slots;
+  // Number of slots at the head of |slots| that have ever been used.
+  iree_host_size_t slot_high_water;
+  // Head of the free list of slots below |slot_high_water|.
+  uint16_t free_head;
+
+  // Indices of all FIRED slots.
+  uint16_t* fired_slots;
+  iree_host_size_t fired_count;
+
+  // ppoll fallback scratch lists used when the ring is not available.
+  struct pollfd* poll_fds;
+  uint16_t* poll_slots;
+};
+
+static uint64_t iree_wait_set_slot_user_data(const iree_wait_set_slot_t* slot,
+                                             uint16_t slot_index) {
+  return ((uint64_t)slot->generation << 32) | slot_index;
+}
+
+static void iree_wait_set_push_fired(iree_wait_set_t* set, uint16_t slot_index,
+                                     int32_t result) {
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+  slot->state = IREE_WAIT_SET_SLOT_FIRED;
+  slot->result = result;
+  slot->fired_index = (uint16_t)set->fired_count;
+  set->fired_slots[set->fired_count++] = slot_index;
+}
+
+static void iree_wait_set_remove_fired(iree_wait_set_t* set,
+                                       iree_wait_set_slot_t* slot) {
+  uint16_t tail_slot_index = set->fired_slots[--set->fired_count];
+  if (slot->fired_index != set->fired_count) {
+    set->fired_slots[slot->fired_index] = tail_slot_index;
+    set->slots[tail_slot_index].fired_index = slot->fired_index;
+  }
+}
+
+// Queues a poll request for the slot. The request is not submitted to the
+// kernel until the next wait.
+static iree_status_t iree_wait_set_arm_slot(iree_wait_set_t* set,
+                                            uint16_t slot_index) {
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+  if (set->ring.fd >= 0) {
+    struct io_uring_sqe* sqe = iree_io_uring_acquire_sqe(&set->ring);
+    if (IREE_UNLIKELY(!sqe)) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "io_uring submission queue full");
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = slot->fd;
+    uint32_t poll_events = POLLIN | POLLPRI;  // implicit POLLERR | POLLHUP
+#if __BYTE_ORDER == __BIG_ENDIAN
+    poll_events = (poll_events << 16) | (poll_events >> 16);
+#endif  // __BIG_ENDIAN
+    sqe->poll32_events = poll_events;
+    sqe->user_data = iree_wait_set_slot_user_data(slot, slot_index);
+  }
+  slot->state = IREE_WAIT_SET_SLOT_ARMED;
+  return iree_ok_status();
+}
+
+// Rearms all slots that fired during a previous wait.
+static iree_status_t iree_wait_set_rearm_fired(iree_wait_set_t* set) {
+  while (set->fired_count > 0) {
+    uint16_t slot_index = set->fired_slots[set->fired_count - 1];
+    IREE_RETURN_IF_ERROR(iree_wait_set_arm_slot(set, slot_index));
+    --set->fired_count;
+  }
+  return iree_ok_status();
+}
+
+static void iree_wait_set_erase_slot(iree_wait_set_t* set,
+                                     uint16_t slot_index) {
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+  if (slot->state == IREE_WAIT_SET_SLOT_ARMED && set->ring.fd >= 0) {
+    // NOTE: if we fail to queue the removal the request stays in flight until
+    // the fd is signaled or the ring is destroyed; the generation bump below
+    // ensures its completion is dropped either way.
+    struct io_uring_sqe* sqe = iree_io_uring_acquire_sqe(&set->ring);
+    if (sqe) {
+      sqe->opcode = IORING_OP_POLL_REMOVE;
+      sqe->fd = -1;
+      sqe->addr = iree_wait_set_slot_user_data(slot, slot_index);
+      sqe->user_data = IREE_WAIT_SET_IGNORED_USER_DATA;
+    }
+  } else if (slot->state == IREE_WAIT_SET_SLOT_FIRED) {
+    iree_wait_set_remove_fired(set, slot);
+  }
+  ++slot->generation;
+  slot->state = IREE_WAIT_SET_SLOT_FREE;
+  slot->next_free = set->free_head;
+  set->free_head = slot_index;
+  --set->handle_count;
+}
+
+// Reaps all available completions and marks their slots as fired.
+static void iree_wait_set_reap(iree_wait_set_t* set) {
+  iree_io_uring_t* ring = &set->ring;
+  uint32_t head = *ring->cq_head;
+  uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+    if (cqe->user_data == IREE_WAIT_SET_IGNORED_USER_DATA) continue;
+    uint16_t slot_index = (uint16_t)(cqe->user_data & 0xFFFF);
+    uint32_t generation = (uint32_t)(cqe->user_data >> 32);
+    if (slot_index >= set->slot_high_water) continue;
+    iree_wait_set_slot_t* slot = &set->slots[slot_index];
+    if (slot->generation != generation ||
+        slot->state != IREE_WAIT_SET_SLOT_ARMED) {
+      continue;  // stale completion from an erased handle
+    }
+    iree_wait_set_push_fired(set, slot_index, cqe->res);
+  }
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Converts a ppoll deadline into the timespec expected by the syscall.
+static struct timespec* iree_wait_set_make_poll_timeout(
+    iree_time_t deadline_ns, struct timespec* timeout_ts) {
+  if (deadline_ns == IREE_TIME_INFINITE_FUTURE) return NULL;
+  memset(timeout_ts, 0, sizeof(*timeout_ts));
+  if (deadline_ns == IREE_TIME_INFINITE_PAST) return timeout_ts;
+  iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+  if (timeout_ns > 0) {
+    timeout_ts->tv_sec = (time_t)(timeout_ns / 1000000000ull);
+    timeout_ts->tv_nsec = (long)(timeout_ns % 1000000000ull);
+  }
+  return timeout_ts;
+}
+
+// Fallback used when io_uring is not available: ppolls all armed slots and
+// marks the signaled ones as fired.
+static iree_status_t iree_wait_set_poll_armed(iree_wait_set_t* set,
+                                              iree_time_t deadline_ns) {
+  nfds_t poll_fd_count = 0;
+  for (iree_host_size_t i = 0; i < set->slot_high_water; ++i) {
+    if (set->slots[i].state != IREE_WAIT_SET_SLOT_ARMED) continue;
+    struct pollfd* poll_fd = &set->poll_fds[poll_fd_count];
+    poll_fd->fd = set->slots[i].fd;
+    poll_fd->events = POLLIN | POLLPRI;  // implicit POLLERR | POLLHUP
+    poll_fd->revents = 0;
+    set->poll_slots[poll_fd_count] = (uint16_t)i;
+    ++poll_fd_count;
+  }
+  int rv = -1;
+  do {
+    struct timespec timeout_ts;
+    rv = ppoll(set->poll_fds, poll_fd_count,
+               iree_wait_set_make_poll_timeout(deadline_ns, &timeout_ts), NULL);
+  } while (rv < 0 && errno == EINTR);
+  if (rv < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "ppoll failure %d", errno);
+  } else if (rv == 0) {
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  for (nfds_t i = 0; i < poll_fd_count; ++i) {
+    if (set->poll_fds[i].revents == 0) continue;
+    iree_wait_set_push_fired(set, set->poll_slots[i],
+                             set->poll_fds[i].revents);
+  }
+  return iree_ok_status();
+}
+
+// Submits all queued requests and waits until at least one completion arrives
+// or |deadline_ns| elapses. Returns DEADLINE_EXCEEDED on timeout.
+static iree_status_t iree_wait_set_pump(iree_wait_set_t* set,
+                                        iree_time_t deadline_ns) {
+  if (set->ring.fd < 0) return iree_wait_set_poll_armed(set, deadline_ns);
+  bool is_polling = deadline_ns == IREE_TIME_INFINITE_PAST ||
+                    (deadline_ns != IREE_TIME_INFINITE_FUTURE &&
+                     deadline_ns <= iree_time_now());
+  // NOTE: when polling we only submit: poll requests on fds that are already
+  // signaled complete inline during submission.
+  iree_status_t status = iree_io_uring_enter(
+      &set->ring, /*min_complete=*/is_polling ? 0 : 1, deadline_ns);
+  iree_wait_set_reap(set);
+  if (iree_status_is_ok(status) && is_polling) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  return status;
+}
+
+// Maps a fired slot result to a status (on failure) and an indicator of whether
+// the handle was signaled.
+static iree_status_t iree_wait_set_resolve_slot(
+    const iree_wait_set_slot_t* slot, bool* out_signaled) {
+  *out_signaled = false;
+  if (slot->result < 0) {
+    return iree_make_status(iree_status_code_from_errno(-slot->result),
+                            "io_uring poll failure %d", -slot->result);
+  } else if (slot->result & POLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "POLLERR on fd");
+  } else if (slot->result & POLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "POLLHUP on fd");
+  } else if (slot->result & POLLNVAL) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "POLLNVAL on fd");
+  }
+  *out_signaled = (slot->result & POLLIN) != 0;
+  return iree_ok_status();
+}
+
+iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
+                                     iree_allocator_t allocator,
+                                     iree_wait_set_t** out_set) {
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // Slot indices must fit in iree_wait_handle_t::set_internal.index.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Each slot has at most one poll request queued; removals beyond the ring
+  // size flush early. Completions may also include removals and stale polls so
+  // we leave headroom (and the kernel buffers any overflow for us).
+  iree_io_uring_t ring;
+  uint32_t sq_entries = (uint32_t)iree_min(
+      iree_max(capacity, 8), (iree_host_size_t)IREE_IO_URING_MAX_SQ_ENTRIES);
+  uint32_t cq_entries = (uint32_t)iree_min(
+      iree_max(2 * capacity, 2 * sq_entries),
+      (iree_host_size_t)IREE_IO_URING_MAX_CQ_ENTRIES);
+  bool has_ring = iree_io_uring_initialize(sq_entries, cq_entries, &ring);
+
+  iree_host_size_t slot_list_size =
+      capacity * iree_sizeof_struct(iree_wait_set_slot_t);
+  iree_host_size_t fired_list_size = iree_host_align(
+      capacity * sizeof(uint16_t), iree_max_align_t);
+  iree_host_size_t poll_fd_list_size =
+      has_ring ? 0 : capacity * sizeof(struct pollfd);
+  iree_host_size_t poll_slot_list_size =
+      has_ring ? 0 : capacity * sizeof(uint16_t);
+  iree_host_size_t total_size = iree_sizeof_struct(iree_wait_set_t) +
+                                slot_list_size + fired_list_size +
+                                poll_fd_list_size + poll_slot_list_size;
+
+  iree_wait_set_t* set = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(allocator, total_size, (void**)&set);
+  if (!iree_status_is_ok(status)) {
+    iree_io_uring_deinitialize(&ring);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  memset(set, 0, total_size);
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->ring = ring;
+  set->free_head = IREE_WAIT_SET_SLOT_NONE;
+
+  uint8_t* ptr = (uint8_t*)set + iree_sizeof_struct(iree_wait_set_t);
+  set->slots = (iree_wait_set_slot_t*)ptr;
+  ptr += slot_list_size;
+  set->fired_slots = (uint16_t*)ptr;
+  ptr += fired_list_size;
+  if (!has_ring) {
+    set->poll_fds = (struct pollfd*)ptr;
+    ptr += poll_fd_list_size;
+    set->poll_slots = (uint16_t*)ptr;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_wait_set_free(iree_wait_set_t* set) {
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // NOTE: closing the ring cancels all in-flight requests.
+  iree_io_uring_deinitialize(&set->ring);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count == 0;
+}
+
+iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
+                                   iree_wait_handle_t handle) {
+  if (set->handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity reached");
+  }
+
+  uint16_t slot_index = set->free_head;
+  if (slot_index != IREE_WAIT_SET_SLOT_NONE) {
+    set->free_head = set->slots[slot_index].next_free;
+  } else {
+    slot_index = (uint16_t)set->slot_high_water++;
+  }
+  ++set->handle_count;
+
+  iree_wait_set_slot_t* slot = &set->slots[slot_index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value,
+                                  &slot->user_handle);
+  slot->fd = iree_wait_primitive_get_read_fd(&handle);
+  slot->result = 0;
+  if (slot->fd < 0) {
+    slot->state = IREE_WAIT_SET_SLOT_INERT;
+    return iree_ok_status();
+  }
+  iree_status_t status = iree_wait_set_arm_slot(set, slot_index);
+  if (!iree_status_is_ok(status)) {
+    slot->state = IREE_WAIT_SET_SLOT_INERT;
+    iree_wait_set_erase_slot(set, slot_index);
+  }
+  return status;
+}
+
+void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
+  // Find the user handle in the set. This either requires a linear scan to
+  // find the matching user handle or - if valid - we can use the slot index
+  // set after an iree_wait_any wake to do a quick lookup.
+  iree_host_size_t index = handle.set_internal.index;
+  if (IREE_UNLIKELY(index >= set->slot_high_water) ||
+      set->slots[index].state == IREE_WAIT_SET_SLOT_FREE ||
+      IREE_UNLIKELY(!iree_wait_primitive_compare_identical(
+          &set->slots[index].user_handle, &handle))) {
+    // Fallback to a linear scan of (hopefully) a small list.
+    index = IREE_WAIT_SET_SLOT_NONE;
+    for (iree_host_size_t i = 0; i < set->slot_high_water; ++i) {
+      if (set->slots[i].state != IREE_WAIT_SET_SLOT_FREE &&
+          iree_wait_primitive_compare_identical(&set->slots[i].user_handle,
+                                                &handle)) {
+        index = i;
+        break;
+      }
+    }
+    if (index == IREE_WAIT_SET_SLOT_NONE) return;
+  }
+  iree_wait_set_erase_slot(set, (uint16_t)index);
+}
+
+void iree_wait_set_clear(iree_wait_set_t* set) {
+  for (iree_host_size_t i = 0; i < set->slot_high_water; ++i) {
+    if (set->slots[i].state == IREE_WAIT_SET_SLOT_FREE) continue;
+    iree_wait_set_erase_slot(set, (uint16_t)i);
+  }
+  // NOTE: slot generations are preserved so that completions for requests
+  // still in flight are dropped when the slots are reused.
+  set->slot_high_water = 0;
+  set->free_head = IREE_WAIT_SET_SLOT_NONE;
+}
+
+iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wait-all requires that we repeatedly wait until all handles have fired.
+  // Handles that fired remain in the fired list (and don't get rearmed) until
+  // the next wait so each round only has to wait on the remaining ones.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_wait_set_rearm_fired(set));
+  iree_status_t status = iree_ok_status();
+  while (set->fired_count < set->handle_count) {
+    iree_host_size_t fired_start = set->fired_count;
+    status = iree_wait_set_pump(set, deadline_ns);
+    for (iree_host_size_t i = fired_start;
+         i < set->fired_count && iree_status_is_ok(status); ++i) {
+      bool signaled = false;
+      status = iree_wait_set_resolve_slot(&set->slots[set->fired_slots[i]],
+                                          &signaled);
+    }
+    if (!iree_status_is_ok(status)) {
+      // NOTE: a deadline may have been hit just as the last handle fired.
+      if (set->fired_count == set->handle_count &&
+          iree_status_is_deadline_exceeded(status)) {
+        iree_status_ignore(status);
+        status = iree_ok_status();
+      }
+      break;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
+                            iree_wait_handle_t* out_wake_handle) {
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_wait_set_rearm_fired(set));
+  iree_status_t status = iree_ok_status();
+  while (set->fired_count == 0) {
+    status = iree_wait_set_pump(set, deadline_ns);
+    if (set->fired_count > 0) {
+      iree_status_ignore(status);
+      status = iree_ok_status();
+    } else if (!iree_status_is_ok(status)) {
+      break;
+    }
+  }
+
+  // Find at least one signaled handle.
+  for (iree_host_size_t i = 0;
+       i < set->fired_count && iree_status_is_ok(status); ++i) {
+    uint16_t slot_index = set->fired_slots[i];
+    const iree_wait_set_slot_t* slot = &set->slots[slot_index];
+    bool signaled = false;
+    status = iree_wait_set_resolve_slot(slot, &signaled);
+    if (iree_status_is_ok(status) && signaled) {
+      memcpy(out_wake_handle, &slot->user_handle, sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = slot_index;
+      break;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_wait_one(iree_wait_handle_t* handle,
+                            iree_time_t deadline_ns) {
+  struct pollfd poll_fds;
+  poll_fds.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fds.fd == -1) return iree_ok_status();
+  poll_fds.events = POLLIN;
+  poll_fds.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // A single handle isn't worth the ring setup; a ppoll is a single syscall
+  // that doesn't need to keep any registration around.
+  int rv = -1;
+  do {
+    struct timespec timeout_ts;
+    rv = ppoll(&poll_fds, 1,
+               iree_wait_set_make_poll_timeout(deadline_ns, &timeout_ts), NULL);
+  } while (rv < 0 && errno == EINTR);
+  iree_status_t status = iree_ok_status();
+  if (rv < 0) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "ppoll failure %d", errno);
+  } else if (rv == 0) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#endif  // IREE_WAIT_API == IREE_WAIT_API_IO_URING
@@ -13,6 +13,7 @@
 #include <cstddef>
 #include <cstring>
 #include <thread>
+#include <vector>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -796,6 +797,58 @@ TEST(WaitSet, WaitAnyEraseSplit) {
   iree_event_deinitialize(&ev_set);
 }
 
+// Tests that a large set can be repeatedly waited on as handles are signaled,
+// reset, and erased across waits.
+TEST(WaitSet, WaitAnyManyHandles) {
+  constexpr int kEventCount = 1000;
+  std::vector<iree_event_t> events(kEventCount);
+  iree_wait_set_t* wait_set = NULL;
+  IREE_ASSERT_OK(
+      iree_wait_set_allocate(kEventCount, iree_allocator_system(), &wait_set));
+  for (int i = 0; i < kEventCount; ++i) {
+    IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &events[i]));
+    IREE_ASSERT_OK(iree_wait_set_insert(wait_set, events[i]));
+  }
+
+  iree_wait_handle_t wake_handle;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+
+  // Signaled handles must be reported again on subsequent waits until they are
+  // reset and must not be reported once reset.
+  iree_event_set(&events[kEventCount / 2]);
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(
+        iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+    EXPECT_EQ(0, memcmp(&events[kEventCount / 2].value, &wake_handle.value,
+                        sizeof(wake_handle.value)));
+  }
+  iree_event_reset(&events[kEventCount / 2]);
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+
+  // Signal and erase from the back so that the remaining handles stay
+  // registered across every wait.
+  for (int i = kEventCount - 1; i >= kEventCount - 10; --i) {
+    iree_event_set(&events[i]);
+    IREE_ASSERT_OK(iree_wait_any(wait_set, iree_time_now() + kShortTimeoutNS,
+                                 &wake_handle));
+    EXPECT_EQ(0, memcmp(&events[i].value, &wake_handle.value,
+                        sizeof(wake_handle.value)));
+    iree_wait_set_erase(wait_set, wake_handle);
+  }
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+
+  iree_wait_set_free(wait_set);
+  for (int i = 0; i < kEventCount; ++i) {
+    iree_event_deinitialize(&events[i]);
+  }
+}
+
 // Tests iree_wait_one when polling (deadline_ns = IREE_TIME_INFINITE_PAST).
 TEST(WaitSet, WaitOnePolling) {
   iree_event_t ev_unset, ev_set;
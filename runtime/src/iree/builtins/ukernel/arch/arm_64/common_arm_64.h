@@ -0,0 +1,34 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_64_H_
+
+#include "iree/builtins/ukernel/common.h"
+#include "iree/schemas/cpu_data.h"
+
+// Returns the SVE vector length in 32-bit words, or 0 if SVE is unavailable.
+static inline int iree_uk_arm_64_sve_vector_words(
+    const iree_uk_uint64_t* cpu_data) {
+  if (!(cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE)) return 0;
+  iree_uk_uint64_t vector_bytes =
+      (cpu_data[1] & IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES_MASK) >>
+      IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES_SHIFT;
+  return (int)(vector_bytes / 4);
+}
+
+// Returns the SME streaming vector length in 32-bit words, or 0 if SME is
+// unavailable.
+static inline int iree_uk_arm_64_sme_vector_words(
+    const iree_uk_uint64_t* cpu_data) {
+  if (!(cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME)) return 0;
+  iree_uk_uint64_t vector_bytes =
+      (cpu_data[1] & IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES_MASK) >>
+      IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES_SHIFT;
+  return (int)(vector_bytes / 4);
+}
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_64_H_
@@ -278,4 +278,41 @@ static inline void iree_uk_neon_copy_8x4_unstrided_to_strided(
   vst1q_lane_s32(out_ptr + 7 * out_stride, v1, 3);
 }
 
+// Returns a vector of floats with the given bit pattern.
+static inline float32x4_t iree_uk_neon_dup_f32_bits(iree_uk_uint32_t bits) {
+  return vreinterpretq_f32_u32(vdupq_n_u32(bits));
+}
+
+// Computes exp(x) with the Cephes polynomial also used by MLIR's polynomial
+// approximation of math.exp. Results smaller than the smallest normal float
+// are flushed to zero.
+static inline float32x4_t iree_uk_neon_exp_f32(float32x4_t x) {
+  const float32x4_t max_x = vdupq_n_f32(88.7228391f);   // log(FLT_MAX)
+  const float32x4_t min_x = vdupq_n_f32(-87.3365448f);  // log(FLT_MIN)
+  float32x4_t clamped = vminq_f32(vmaxq_f32(x, min_x), max_x);
+  // exp(x) = 2^k * exp(r) with k = round(x / ln(2)) and |r| <= ln(2) / 2.
+  float32x4_t k = vrndmq_f32(
+      vfmaq_n_f32(vdupq_n_f32(0.5f), clamped, 1.44269504088896341f));
+  float32x4_t r = vfmsq_n_f32(clamped, k, 0.693359375f);
+  r = vfmsq_n_f32(r, k, -2.12194440e-4f);
+  float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+  p = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+  float32x4_t y = vfmaq_f32(r, p, vmulq_f32(r, r));
+  y = vaddq_f32(y, vdupq_n_f32(1.0f));
+  // k is in [-126, 128] so 2^k is applied in two halves that are both normal.
+  int32x4_t ki = vcvtq_s32_f32(k);
+  int32x4_t k0 = vshrq_n_s32(ki, 1);
+  int32x4_t k1 = vsubq_s32(ki, k0);
+  const int32x4_t bias = vdupq_n_s32(127);
+  y = vmulq_f32(y, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(k0, bias), 23)));
+  y = vmulq_f32(y, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(k1, bias), 23)));
+  y = vbslq_f32(vcgtq_f32(x, max_x), iree_uk_neon_dup_f32_bits(0x7F800000), y);
+  y = vbslq_f32(vcltq_f32(x, min_x), vdupq_n_f32(0.0f), y);
+  return vbslq_f32(vceqq_f32(x, x), y, x);
+}
+
 #endif  // IREE_BUILTINS_UKERNEL_ARCH_ARM_64_COMMON_ARM_NEON_H_
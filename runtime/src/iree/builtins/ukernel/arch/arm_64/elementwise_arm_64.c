@@ -0,0 +1,314 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/elementwise_arm_64.h"
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_neon.h"
+
+//===----------------------------------------------------------------------===//
+// Vector helpers.
+//===----------------------------------------------------------------------===//
+
+// Divides signed 32-bit integers, rounding towards zero. Every quotient of two
+// 32-bit integers is exactly truncated from the quotient of their conversions
+// to double, as the distance from a non-integral quotient to the nearest
+// integer is larger than its rounding error.
+static inline int32x4_t iree_uk_neon_div_s32(int32x4_t a, int32x4_t b) {
+  float64x2_t q_lo = vdivq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(a))),
+                               vcvtq_f64_s64(vmovl_s32(vget_low_s32(b))));
+  float64x2_t q_hi = vdivq_f64(vcvtq_f64_s64(vmovl_high_s32(a)),
+                               vcvtq_f64_s64(vmovl_high_s32(b)));
+  return vcombine_s32(vmovn_s64(vcvtq_s64_f64(q_lo)),
+                      vmovn_s64(vcvtq_s64_f64(q_hi)));
+}
+
+// Divides unsigned 32-bit integers, rounding towards zero. See
+// iree_uk_neon_div_s32.
+static inline uint32x4_t iree_uk_neon_div_u32(uint32x4_t a, uint32x4_t b) {
+  float64x2_t q_lo = vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(a))),
+                               vcvtq_f64_u64(vmovl_u32(vget_low_u32(b))));
+  float64x2_t q_hi = vdivq_f64(vcvtq_f64_u64(vmovl_high_u32(a)),
+                               vcvtq_f64_u64(vmovl_high_u32(b)));
+  return vcombine_u32(vmovn_u64(vcvtq_u64_f64(q_lo)),
+                      vmovn_u64(vcvtq_u64_f64(q_hi)));
+}
+
+// Computes log(x) with the Cephes polynomial also used by MLIR's polynomial
+// approximation of math.log. Denormal inputs are treated as the smallest
+// normal float.
+static inline float32x4_t iree_uk_neon_log_f32(float32x4_t x) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t inf = iree_uk_neon_dup_f32_bits(0x7F800000);
+  // Split x = m * 2^e with m in [0.5, 1).
+  uint32x4_t xi = vreinterpretq_u32_f32(
+      vmaxq_f32(x, iree_uk_neon_dup_f32_bits(0x00800000)));
+  float32x4_t e = vcvtq_f32_s32(vsubq_s32(
+      vreinterpretq_s32_u32(vshrq_n_u32(xi, 23)), vdupq_n_s32(126)));
+  float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(
+      vandq_u32(xi, vdupq_n_u32(0x007FFFFF)), vdupq_n_u32(0x3F000000)));
+  // Shift m to [sqrt(0.5) - 1, sqrt(2) - 1) so that the polynomial is
+  // evaluated on an interval centered on 0.
+  uint32x4_t small = vcltq_f32(m, vdupq_n_f32(0.707106781186547524f));
+  e = vsubq_f32(e, vreinterpretq_f32_u32(
+                       vandq_u32(vreinterpretq_u32_f32(one), small)));
+  m = vaddq_f32(vsubq_f32(m, one), vreinterpretq_f32_u32(vandq_u32(
+                                       vreinterpretq_u32_f32(m), small)));
+  float32x4_t z = vmulq_f32(m, m);
+  float32x4_t p = vdupq_n_f32(7.0376836292e-2f);
+  p = vfmaq_f32(vdupq_n_f32(-1.1514610310e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(1.1676998740e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(-1.2420140846e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(1.4249322787e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(-1.6668057665e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(2.0000714765e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(-2.4999993993e-1f), p, m);
+  p = vfmaq_f32(vdupq_n_f32(3.3333331174e-1f), p, m);
+  float32x4_t y = vmulq_f32(vmulq_f32(p, m), z);
+  y = vfmaq_n_f32(y, e, -2.12194440e-4f);
+  y = vfmsq_n_f32(y, z, 0.5f);
+  y = vaddq_f32(m, y);
+  y = vfmaq_n_f32(y, e, 0.693359375f);
+  // log(x < 0) = NaN, log(0) = -inf, log(inf) = inf and log(NaN) = NaN.
+  y = vbslq_f32(vcltq_f32(x, zero), iree_uk_neon_dup_f32_bits(0x7FC00000), y);
+  y = vbslq_f32(vceqq_f32(x, zero), iree_uk_neon_dup_f32_bits(0xFF800000), y);
+  y = vbslq_f32(vceqq_f32(x, inf), x, y);
+  return vbslq_f32(vceqq_f32(x, x), y, x);
+}
+
+//===----------------------------------------------------------------------===//
+// Ops on vectors of 4 32-bit elements.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_NEON_F32(a) vreinterpretq_f32_u32(a)
+#define IREE_UK_NEON_S32(a) vreinterpretq_s32_u32(a)
+#define IREE_UK_NEON_U32_F32(a) vreinterpretq_u32_f32(a)
+#define IREE_UK_NEON_U32_S32(a) vreinterpretq_u32_s32(a)
+
+static inline uint32x4_t iree_uk_neon_addf(uint32x4_t a, uint32x4_t b) {
+  return IREE_UK_NEON_U32_F32(
+      vaddq_f32(IREE_UK_NEON_F32(a), IREE_UK_NEON_F32(b)));
+}
+static inline uint32x4_t iree_uk_neon_addi(uint32x4_t a, uint32x4_t b) {
+  return vaddq_u32(a, b);
+}
+static inline uint32x4_t iree_uk_neon_andi(uint32x4_t a, uint32x4_t b) {
+  return vandq_u32(a, b);
+}
+static inline uint32x4_t iree_uk_neon_divf(uint32x4_t a, uint32x4_t b) {
+  return IREE_UK_NEON_U32_F32(
+      vdivq_f32(IREE_UK_NEON_F32(a), IREE_UK_NEON_F32(b)));
+}
+static inline uint32x4_t iree_uk_neon_divsi(uint32x4_t a, uint32x4_t b) {
+  return IREE_UK_NEON_U32_S32(
+      iree_uk_neon_div_s32(IREE_UK_NEON_S32(a), IREE_UK_NEON_S32(b)));
+}
+static inline uint32x4_t iree_uk_neon_divui(uint32x4_t a, uint32x4_t b) {
+  return iree_uk_neon_div_u32(a, b);
+}
+static inline uint32x4_t iree_uk_neon_mulf(uint32x4_t a, uint32x4_t b) {
+  return IREE_UK_NEON_U32_F32(
+      vmulq_f32(IREE_UK_NEON_F32(a), IREE_UK_NEON_F32(b)));
+}
+static inline uint32x4_t iree_uk_neon_muli(uint32x4_t a, uint32x4_t b) {
+  return vmulq_u32(a, b);
+}
+static inline uint32x4_t iree_uk_neon_ori(uint32x4_t a, uint32x4_t b) {
+  return vorrq_u32(a, b);
+}
+// The NEON shifts by register shift left by a signed amount, so right shifts
+// are left shifts by the negated amount.
+static inline uint32x4_t iree_uk_neon_shli(uint32x4_t a, uint32x4_t b) {
+  return vshlq_u32(a, IREE_UK_NEON_S32(b));
+}
+static inline uint32x4_t iree_uk_neon_shrsi(uint32x4_t a, uint32x4_t b) {
+  return IREE_UK_NEON_U32_S32(
+      vshlq_s32(IREE_UK_NEON_S32(a), vnegq_s32(IREE_UK_NEON_S32(b))));
+}
+static inline uint32x4_t iree_uk_neon_shrui(uint32x4_t a, uint32x4_t b) {
+  return vshlq_u32(a, vnegq_s32(IREE_UK_NEON_S32(b)));
+}
+static inline uint32x4_t iree_uk_neon_subf(uint32x4_t a, uint32x4_t b) {
+  return IREE_UK_NEON_U32_F32(
+      vsubq_f32(IREE_UK_NEON_F32(a), IREE_UK_NEON_F32(b)));
+}
+static inline uint32x4_t iree_uk_neon_subi(uint32x4_t a, uint32x4_t b) {
+  return vsubq_u32(a, b);
+}
+static inline uint32x4_t iree_uk_neon_xori(uint32x4_t a, uint32x4_t b) {
+  return veorq_u32(a, b);
+}
+
+static inline uint32x4_t iree_uk_neon_absf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(vabsq_f32(IREE_UK_NEON_F32(a)));
+}
+static inline uint32x4_t iree_uk_neon_ceilf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(vrndpq_f32(IREE_UK_NEON_F32(a)));
+}
+static inline uint32x4_t iree_uk_neon_ctlz(uint32x4_t a) {
+  return vclzq_u32(a);
+}
+static inline uint32x4_t iree_uk_neon_expf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(iree_uk_neon_exp_f32(IREE_UK_NEON_F32(a)));
+}
+static inline uint32x4_t iree_uk_neon_floorf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(vrndmq_f32(IREE_UK_NEON_F32(a)));
+}
+static inline uint32x4_t iree_uk_neon_logf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(iree_uk_neon_log_f32(IREE_UK_NEON_F32(a)));
+}
+static inline uint32x4_t iree_uk_neon_negf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(vnegq_f32(IREE_UK_NEON_F32(a)));
+}
+static inline uint32x4_t iree_uk_neon_rsqrtf(uint32x4_t a) {
+  return IREE_UK_NEON_U32_F32(
+      vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(IREE_UK_NEON_F32(a))));
+}
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+// Defines iree_uk_x32b_{op}_row_arm_64, applying iree_uk_neon_{op} to 4
+// elements at a time. The last partial vector of the row goes through a
+// zero-padded stack buffer.
+#define IREE_UK_X32B_ROW_FUNC_ARM_64(op)                                    \
+  static void iree_uk_x32b_##op##_row_arm_64(                               \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,             \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {       \
+    iree_uk_ssize_t i = 0;                                                  \
+    for (; i + 4 <= size; i += 4) {                                         \
+      vst1q_u32(out + i,                                                    \
+                iree_uk_neon_##op(vld1q_u32(lhs + i), vld1q_u32(rhs + i))); \
+    }                                                                       \
+    if (i < size) {                                                         \
+      iree_uk_uint32_t lhs_buf[4] = {0};                                    \
+      iree_uk_uint32_t rhs_buf[4] = {0};                                    \
+      iree_uk_uint32_t out_buf[4];                                          \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                      \
+        lhs_buf[j] = lhs[i + j];                                            \
+        rhs_buf[j] = rhs[i + j];                                            \
+      }                                                                     \
+      vst1q_u32(out_buf,                                                    \
+                iree_uk_neon_##op(vld1q_u32(lhs_buf), vld1q_u32(rhs_buf))); \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                      \
+        out[i + j] = out_buf[j];                                            \
+      }                                                                     \
+    }                                                                       \
+  }
+
+// Defines iree_uk_x32u_{op}_row_arm_64. See IREE_UK_X32B_ROW_FUNC_ARM_64.
+#define IREE_UK_X32U_ROW_FUNC_ARM_64(op)                                  \
+  static void iree_uk_x32u_##op##_row_arm_64(                             \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out, \
+      iree_uk_ssize_t size) {                                             \
+    iree_uk_ssize_t i = 0;                                                \
+    for (; i + 4 <= size; i += 4) {                                       \
+      vst1q_u32(out + i, iree_uk_neon_##op(vld1q_u32(in + i)));           \
+    }                                                                     \
+    if (i < size) {                                                       \
+      iree_uk_uint32_t in_buf[4] = {0};                                   \
+      iree_uk_uint32_t out_buf[4];                                        \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                    \
+        in_buf[j] = in[i + j];                                            \
+      }                                                                   \
+      vst1q_u32(out_buf, iree_uk_neon_##op(vld1q_u32(in_buf)));           \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                    \
+        out[i + j] = out_buf[j];                                          \
+      }                                                                   \
+    }                                                                     \
+  }
+
+IREE_UK_X32B_ROW_FUNC_ARM_64(addf)
+IREE_UK_X32B_ROW_FUNC_ARM_64(addi)
+IREE_UK_X32B_ROW_FUNC_ARM_64(andi)
+IREE_UK_X32B_ROW_FUNC_ARM_64(divf)
+IREE_UK_X32B_ROW_FUNC_ARM_64(divsi)
+IREE_UK_X32B_ROW_FUNC_ARM_64(divui)
+IREE_UK_X32B_ROW_FUNC_ARM_64(mulf)
+IREE_UK_X32B_ROW_FUNC_ARM_64(muli)
+IREE_UK_X32B_ROW_FUNC_ARM_64(ori)
+IREE_UK_X32B_ROW_FUNC_ARM_64(shli)
+IREE_UK_X32B_ROW_FUNC_ARM_64(shrsi)
+IREE_UK_X32B_ROW_FUNC_ARM_64(shrui)
+IREE_UK_X32B_ROW_FUNC_ARM_64(subf)
+IREE_UK_X32B_ROW_FUNC_ARM_64(subi)
+IREE_UK_X32B_ROW_FUNC_ARM_64(xori)
+
+IREE_UK_X32U_ROW_FUNC_ARM_64(absf)
+IREE_UK_X32U_ROW_FUNC_ARM_64(ceilf)
+IREE_UK_X32U_ROW_FUNC_ARM_64(ctlz)
+IREE_UK_X32U_ROW_FUNC_ARM_64(expf)
+IREE_UK_X32U_ROW_FUNC_ARM_64(floorf)
+IREE_UK_X32U_ROW_FUNC_ARM_64(logf)
+IREE_UK_X32U_ROW_FUNC_ARM_64(negf)
+IREE_UK_X32U_ROW_FUNC_ARM_64(rsqrtf)
+
+// NEON is part of the arm64 baseline, so |cpu_data| is not needed.
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_arm_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_arm_64;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_arm_64;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_arm_64;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_arm_64;
+    case IREE_UK_X32B_DIVSI:
+      return iree_uk_x32b_divsi_row_arm_64;
+    case IREE_UK_X32B_DIVUI:
+      return iree_uk_x32b_divui_row_arm_64;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_arm_64;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_arm_64;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_arm_64;
+    case IREE_UK_X32B_SHLI:
+      return iree_uk_x32b_shli_row_arm_64;
+    case IREE_UK_X32B_SHRSI:
+      return iree_uk_x32b_shrsi_row_arm_64;
+    case IREE_UK_X32B_SHRUI:
+      return iree_uk_x32b_shrui_row_arm_64;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_arm_64;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_arm_64;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_arm_64;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_arm_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_arm_64;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_arm_64;
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_ctlz_row_arm_64;
+    case IREE_UK_X32U_EXPF:
+      return iree_uk_x32u_expf_row_arm_64;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_arm_64;
+    case IREE_UK_X32U_LOGF:
+      return iree_uk_x32u_logf_row_arm_64;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_arm_64;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_arm_64;
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,22 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_ARM_64_ELEMENTWISE_ARM_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_ARM_64_ELEMENTWISE_ARM_64_H_
+
+#include "iree/builtins/ukernel/elementwise.h"
+
+// Returns the arm64 row function to use for the x32b op with the given
+// opcode, or NULL if no suitable arm64 row function exists for this opcode
+// and |cpu_data|, in which case the caller may fall back to a generic loop.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_arm_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+// Same as iree_uk_x32b_select_row_func_arm_64 for x32u ops.
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_arm_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_ARM_64_ELEMENTWISE_ARM_64_H_
@@ -6,6 +6,7 @@
 
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64.h"
 
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
 #include "iree/builtins/ukernel/arch/arm_64/config.h"
 #include "iree/schemas/cpu_data.h"
 
@@ -13,6 +14,46 @@ IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8x8x1_arm_64)
 IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x1_arm_64)
 IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x4_arm_64_dotprod)
 IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x8_arm_64_i8mm)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8xVLx1_arm_64_sve)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8xVLx4_arm_64_sve)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_2VLx2VLx1_arm_64_sme)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_2VLx2VLx4_arm_64_sme)
+
+// Returns the SME tile function for the given params if SME is available and
+// M0 and N0 are both twice the streaming vector length in 32-bit words.
+static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_sme(
+    const iree_uk_mmt4d_params_t* params,
+    iree_uk_mmt4d_tile_func_t tile_func) {
+#ifdef IREE_UK_BUILD_ARM_64_SME
+  int sme_vector_words = iree_uk_arm_64_sme_vector_words(params->cpu_data);
+  if (sme_vector_words && params->M0 == 2 * sme_vector_words &&
+      params->N0 == 2 * sme_vector_words) {
+    return tile_func;
+  }
+#else
+  (void)params;
+  (void)tile_func;
+#endif
+  return 0;
+}
+
+// Returns the SVE tile function for the given params if SVE is available,
+// M0 == 8 and N0 is the SVE vector length in 32-bit words.
+static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_sve(
+    const iree_uk_mmt4d_params_t* params,
+    iree_uk_mmt4d_tile_func_t tile_func) {
+#ifdef IREE_UK_BUILD_ARM_64_SVE
+  int sve_vector_words = iree_uk_arm_64_sve_vector_words(params->cpu_data);
+  if (sve_vector_words && params->M0 == 8 &&
+      params->N0 == sve_vector_words) {
+    return tile_func;
+  }
+#else
+  (void)params;
+  (void)tile_func;
+#endif
+  return 0;
+}
 
 static iree_uk_mmt4d_tile_func_t
 iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32_8x8x8(
@@ -43,6 +84,17 @@ iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32_8x8x4(
 static iree_uk_mmt4d_tile_func_t
 iree_uk_mmt4d_select_tile_func_arm_64_f32f32f32(
     const iree_uk_mmt4d_params_t* params) {
+  if (params->K0 == 1) {
+    iree_uk_mmt4d_tile_func_t tile_func =
+        iree_uk_mmt4d_select_tile_func_arm_64_sme(
+            params, iree_uk_mmt4d_tile_f32f32f32_2VLx2VLx1_arm_64_sme);
+    if (tile_func) return tile_func;
+    // Checked before the NEON tile since with 256-bit SVE the tile formats
+    // are the same.
+    tile_func = iree_uk_mmt4d_select_tile_func_arm_64_sve(
+        params, iree_uk_mmt4d_tile_f32f32f32_8xVLx1_arm_64_sve);
+    if (tile_func) return tile_func;
+  }
   if (params->M0 == 8 && params->N0 == 8 && params->K0 == 1) {
     return iree_uk_mmt4d_tile_f32f32f32_8x8x1_arm_64;
   }
@@ -51,6 +103,17 @@ iree_uk_mmt4d_select_tile_func_arm_64_f32f32f32(
 
 static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32(
     const iree_uk_mmt4d_params_t* params) {
+  if (params->K0 == 4) {
+    iree_uk_mmt4d_tile_func_t tile_func =
+        iree_uk_mmt4d_select_tile_func_arm_64_sme(
+            params, iree_uk_mmt4d_tile_i8i8i32_2VLx2VLx4_arm_64_sme);
+    if (tile_func) return tile_func;
+    // Checked before the dotprod tile since with 256-bit SVE the tile formats
+    // are the same.
+    tile_func = iree_uk_mmt4d_select_tile_func_arm_64_sve(
+        params, iree_uk_mmt4d_tile_i8i8i32_8xVLx4_arm_64_sve);
+    if (tile_func) return tile_func;
+  }
   if (params->M0 == 8 && params->N0 == 8 && params->K0 == 1) {
     return iree_uk_mmt4d_tile_i8i8i32_8x8x1_arm_64;
   }
@@ -71,7 +134,6 @@ iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64(
     case iree_uk_mmt4d_type_i8i8i32:
       return iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32(params);
     default:
-      IREE_UK_ASSUME_UNREACHABLE;
       return 0;
   }
 }
@@ -6,23 +6,62 @@
 
 #include "iree/builtins/ukernel/arch/arm_64/query_tile_sizes_arm_64.h"
 
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
 #include "iree/builtins/ukernel/arch/arm_64/config.h"
 #include "iree/schemas/cpu_data.h"
 
+// SVE tiles are only preferred over the fixed-width NEON ones when the vector
+// length is at least 256 bits; at 128 bits they would only be 4 columns wide.
+static int iree_uk_query_sve_vector_words_arm_64(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_SVE
+  int sve_vector_words = iree_uk_arm_64_sve_vector_words(params->cpu_data);
+  if (sve_vector_words >= 8) return sve_vector_words;
+#endif
+  return 0;
+}
+
+static int iree_uk_query_sme_vector_words_arm_64(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_SME
+  return iree_uk_arm_64_sme_vector_words(params->cpu_data);
+#else
+  return 0;
+#endif
+}
+
 static iree_uk_matmul_tile_sizes_t
 iree_uk_query_matmul_tile_sizes_arm_64_f32f32f32(
     const iree_uk_query_tile_sizes_2d_params_t* params) {
+  int sme_vector_words = iree_uk_query_sme_vector_words_arm_64(params);
+  if (sme_vector_words) {
+    return (iree_uk_matmul_tile_sizes_t){
+        .M = 2 * sme_vector_words, .K = 1, .N = 2 * sme_vector_words};
+  }
+  int sve_vector_words = iree_uk_query_sve_vector_words_arm_64(params);
+  if (sve_vector_words) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = sve_vector_words};
+  }
   return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
 }
 
 static iree_uk_matmul_tile_sizes_t
 iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(
     const iree_uk_query_tile_sizes_2d_params_t* params) {
+  int sme_vector_words = iree_uk_query_sme_vector_words_arm_64(params);
+  if (sme_vector_words) {
+    return (iree_uk_matmul_tile_sizes_t){
+        .M = 2 * sme_vector_words, .K = 4, .N = 2 * sme_vector_words};
+  }
 #ifdef IREE_UK_BUILD_ARM_64_I8MM
   if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM) {
     return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 8, .N = 8};
   }
 #endif
+  int sve_vector_words = iree_uk_query_sve_vector_words_arm_64(params);
+  if (sve_vector_words) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 4, .N = sve_vector_words};
+  }
 #ifdef IREE_UK_BUILD_ARM_64_DOTPROD
   if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD) {
     return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 4, .N = 8};
@@ -48,4 +87,17 @@ bool iree_uk_query_matmul_tile_sizes_arm_64(
     IREE_UK_ASSUME_UNREACHABLE;
     return false;
   }
-}
\ No newline at end of file
+}
+
+bool iree_uk_query_cache_sizes_arm_64(const iree_uk_uint64_t* cpu_data,
+                                      iree_uk_cache_sizes_t* out_cache_sizes) {
+  // Cores since Cortex-A76 and Neoverse N1 have 64KiB of L1D and 256KiB to
+  // 1MiB of L2. SVE is a proxy for the server-class cores with 1MiB of L2.
+  bool large_l2 = cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE;
+  *out_cache_sizes = (iree_uk_cache_sizes_t){
+      .l1 = 64 * 1024,
+      .l2 = (large_l2 ? 1024 : 512) * 1024,
+      .l3 = 1024 * 1024,
+  };
+  return true;
+}
@@ -13,4 +13,7 @@ bool iree_uk_query_matmul_tile_sizes_arm_64(
     const iree_uk_query_tile_sizes_2d_params_t* params,
     iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes);
 
+bool iree_uk_query_cache_sizes_arm_64(const iree_uk_uint64_t* cpu_data,
+                                      iree_uk_cache_sizes_t* out_cache_sizes);
+
 #endif  // IREE_BUILTINS_UKERNEL_ARCH_ARM_64_QUERY_TILE_SIZES_ARM_64_H_
@@ -0,0 +1,150 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/reduction_arm_64.h"
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_neon.h"
+
+// Loads the |count| < 4 last elements of a row, taking the other lanes from
+// |fill|.
+static inline float32x4_t iree_uk_neon_load_partial_f32(const float* in,
+                                                        iree_uk_ssize_t count,
+                                                        float32x4_t fill) {
+  float buf[4];
+  vst1q_f32(buf, fill);
+  for (iree_uk_ssize_t i = 0; i < count; ++i) buf[i] = in[i];
+  return vld1q_f32(buf);
+}
+
+// Stores the |count| < 4 first lanes of |v|.
+static inline void iree_uk_neon_store_partial_f32(float* out,
+                                                  iree_uk_ssize_t count,
+                                                  float32x4_t v) {
+  float buf[4];
+  vst1q_f32(buf, v);
+  for (iree_uk_ssize_t i = 0; i < count; ++i) out[i] = buf[i];
+}
+
+static void iree_uk_softmax_row_arm_64(const float* in, float* out,
+                                       iree_uk_ssize_t size) {
+  // Lane-wise running maxima and sums of exp(x - max). The main loop takes 4
+  // vectors per step so that the sums are only rescaled once per 16 elements.
+  // See iree_uk_softmax_row_generic for why the maxima start at -FLT_MAX.
+  float32x4_t max = vdupq_n_f32(-IREE_UK_FLOAT32_MAX);
+  float32x4_t sum = vdupq_n_f32(0.0f);
+  iree_uk_ssize_t j = 0;
+  for (; j + 16 <= size; j += 16) {
+    float32x4_t x0 = vld1q_f32(in + j + 0);
+    float32x4_t x1 = vld1q_f32(in + j + 4);
+    float32x4_t x2 = vld1q_f32(in + j + 8);
+    float32x4_t x3 = vld1q_f32(in + j + 12);
+    float32x4_t new_max =
+        vmaxq_f32(max, vmaxq_f32(vmaxq_f32(x0, x1), vmaxq_f32(x2, x3)));
+    float32x4_t e01 = vaddq_f32(iree_uk_neon_exp_f32(vsubq_f32(x0, new_max)),
+                                iree_uk_neon_exp_f32(vsubq_f32(x1, new_max)));
+    float32x4_t e23 = vaddq_f32(iree_uk_neon_exp_f32(vsubq_f32(x2, new_max)),
+                                iree_uk_neon_exp_f32(vsubq_f32(x3, new_max)));
+    sum = vfmaq_f32(vaddq_f32(e01, e23), sum,
+                    iree_uk_neon_exp_f32(vsubq_f32(max, new_max)));
+    max = new_max;
+  }
+  // Remaining vectors, the last one partial. Lanes past the end of the row
+  // read as -inf, which contributes exp(-inf) = 0 to the sums.
+  const float32x4_t minus_inf = iree_uk_neon_dup_f32_bits(0xFF800000);
+  for (; j < size; j += 4) {
+    float32x4_t x = j + 4 <= size
+                        ? vld1q_f32(in + j)
+                        : iree_uk_neon_load_partial_f32(in + j, size - j,
+                                                        minus_inf);
+    float32x4_t new_max = vmaxq_f32(max, x);
+    sum = vfmaq_f32(iree_uk_neon_exp_f32(vsubq_f32(x, new_max)), sum,
+                    iree_uk_neon_exp_f32(vsubq_f32(max, new_max)));
+    max = new_max;
+  }
+  // Combine the lanes, rescaling each lane sum to the row maximum.
+  float32x4_t row_max = vdupq_n_f32(vmaxvq_f32(max));
+  float row_sum = vaddvq_f32(
+      vmulq_f32(sum, iree_uk_neon_exp_f32(vsubq_f32(max, row_max))));
+  float inv_sum = 1.0f / row_sum;
+  for (j = 0; j + 4 <= size; j += 4) {
+    float32x4_t e = iree_uk_neon_exp_f32(vsubq_f32(vld1q_f32(in + j), row_max));
+    vst1q_f32(out + j, vmulq_n_f32(e, inv_sum));
+  }
+  if (j < size) {
+    float32x4_t x = iree_uk_neon_load_partial_f32(in + j, size - j, row_max);
+    iree_uk_neon_store_partial_f32(
+        out + j, size - j,
+        vmulq_n_f32(iree_uk_neon_exp_f32(vsubq_f32(x, row_max)), inv_sum));
+  }
+}
+
+static void iree_uk_layer_norm_row_arm_64(const float* in, float* out,
+                                          iree_uk_ssize_t size,
+                                          const float* gamma,
+                                          const float* beta, float epsilon) {
+  // Lane-wise Welford updates over the full vectors. All lanes have seen the
+  // same count n of elements, so the update uses a scalar 1 / n.
+  float32x4_t mean_v = vdupq_n_f32(0.0f);
+  float32x4_t m2_v = vdupq_n_f32(0.0f);
+  iree_uk_ssize_t vector_count = size / 4;
+  for (iree_uk_ssize_t n = 1; n <= vector_count; ++n) {
+    float32x4_t x = vld1q_f32(in + 4 * (n - 1));
+    float32x4_t delta = vsubq_f32(x, mean_v);
+    mean_v = vfmaq_n_f32(mean_v, delta, 1.0f / (float)n);
+    m2_v = vfmaq_f32(m2_v, delta, vsubq_f32(x, mean_v));
+  }
+  // Combine the lanes, which all have the same count, then continue with the
+  // remaining elements one at a time.
+  float mean = vaddvq_f32(mean_v) * 0.25f;
+  float32x4_t lane_delta = vsubq_f32(mean_v, vdupq_n_f32(mean));
+  float m2 = vaddvq_f32(vfmaq_n_f32(
+      m2_v, vmulq_f32(lane_delta, lane_delta), (float)vector_count));
+  for (iree_uk_ssize_t j = 4 * vector_count; j < size; ++j) {
+    float x = in[j];
+    float delta = x - mean;
+    mean += delta / (float)(j + 1);
+    m2 += delta * (x - mean);
+  }
+  float inv_stddev = 1.0f / vgetq_lane_f32(
+      vsqrtq_f32(vdupq_n_f32(m2 / (float)size + epsilon)), 0);
+  float32x4_t mean_b = vdupq_n_f32(mean);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  for (iree_uk_ssize_t j = 0; j < size; j += 4) {
+    iree_uk_ssize_t count = size - j;
+    bool full = count >= 4;
+    float32x4_t x = full ? vld1q_f32(in + j)
+                         : iree_uk_neon_load_partial_f32(in + j, count, zero);
+    float32x4_t scale = vdupq_n_f32(inv_stddev);
+    if (gamma) {
+      scale = vmulq_f32(
+          scale, full ? vld1q_f32(gamma + j)
+                      : iree_uk_neon_load_partial_f32(gamma + j, count, zero));
+    }
+    float32x4_t bias = zero;
+    if (beta) {
+      bias = full ? vld1q_f32(beta + j)
+                  : iree_uk_neon_load_partial_f32(beta + j, count, zero);
+    }
+    float32x4_t y = vfmaq_f32(bias, vsubq_f32(x, mean_b), scale);
+    if (full) {
+      vst1q_f32(out + j, y);
+    } else {
+      iree_uk_neon_store_partial_f32(out + j, count, y);
+    }
+  }
+}
+
+iree_uk_softmax_row_func_t iree_uk_softmax_select_row_func_arm_64(
+    const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+  return iree_uk_softmax_row_arm_64;
+}
+
+iree_uk_layer_norm_row_func_t iree_uk_layer_norm_select_row_func_arm_64(
+    const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+  return iree_uk_layer_norm_row_arm_64;
+}
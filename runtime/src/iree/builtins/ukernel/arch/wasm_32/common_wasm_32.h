@@ -0,0 +1,92 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_WASM_32_COMMON_WASM_32_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_WASM_32_COMMON_WASM_32_H_
+
+#include "iree/builtins/ukernel/common.h"
+
+// WebAssembly has no runtime CPU feature detection: a module using SIMD128
+// instructions fails validation on engines without SIMD128 support. So unlike
+// the other architectures, the SIMD tile functions are only built when the
+// whole build targets SIMD128 (-msimd128), and their selection then needs no
+// check of cpu_data.
+#if defined(__wasm_simd128__)
+#define IREE_UK_BUILD_WASM_32_SIMD128 1
+#include <wasm_simd128.h>
+#endif  // defined(__wasm_simd128__)
+
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+// Transposes a 4x4 matrix of 32-bit elements held in 4 rows.
+static inline void iree_uk_wasm_transpose_4x4xi32(v128_t* v) {
+  v128_t t0 = wasm_i32x4_shuffle(v[0], v[1], 0, 4, 1, 5);
+  v128_t t1 = wasm_i32x4_shuffle(v[2], v[3], 0, 4, 1, 5);
+  v128_t t2 = wasm_i32x4_shuffle(v[0], v[1], 2, 6, 3, 7);
+  v128_t t3 = wasm_i32x4_shuffle(v[2], v[3], 2, 6, 3, 7);
+  v[0] = wasm_i64x2_shuffle(t0, t1, 0, 2);
+  v[1] = wasm_i64x2_shuffle(t0, t1, 1, 3);
+  v[2] = wasm_i64x2_shuffle(t2, t3, 0, 2);
+  v[3] = wasm_i64x2_shuffle(t2, t3, 1, 3);
+}
+
+// Transposes an 8x8 matrix of 16-bit elements held in 8 rows.
+static inline void iree_uk_wasm_transpose_8x8xi16(v128_t* v) {
+  v128_t a[8];
+  for (int i = 0; i < 4; ++i) {
+    a[i] = wasm_i16x8_shuffle(v[2 * i], v[2 * i + 1], 0, 8, 1, 9, 2, 10, 3,
+                              11);
+    a[i + 4] = wasm_i16x8_shuffle(v[2 * i], v[2 * i + 1], 4, 12, 5, 13, 6, 14,
+                                  7, 15);
+  }
+  // a[0..3] hold the interleaved columns 0-3 and a[4..7] the columns 4-7;
+  // each half is now a 4x4 transpose of 32-bit pairs.
+  iree_uk_wasm_transpose_4x4xi32(a);
+  iree_uk_wasm_transpose_4x4xi32(a + 4);
+  for (int i = 0; i < 8; ++i) v[i] = a[i];
+}
+
+// Copies a |rows|x4 block of 32-bit elements (|rows| a multiple of 4) from
+// rows |in_stride| elements apart to the transposed 4x|rows| block with rows
+// |out_stride| elements apart.
+static inline void iree_uk_wasm_copy_Nx4xi32_transpose_strided_to_strided(
+    iree_uk_int32_t* IREE_UK_RESTRICT out_ptr,
+    const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr, iree_uk_ssize_t rows,
+    iree_uk_ssize_t out_stride, iree_uk_ssize_t in_stride) {
+  for (iree_uk_ssize_t r0 = 0; r0 < rows; r0 += 4) {
+    v128_t v[4];
+    for (int r = 0; r < 4; ++r) {
+      v[r] = wasm_v128_load(in_ptr + (r0 + r) * in_stride);
+    }
+    iree_uk_wasm_transpose_4x4xi32(v);
+    for (int c = 0; c < 4; ++c) {
+      wasm_v128_store(out_ptr + c * out_stride + r0, v[c]);
+    }
+  }
+}
+
+// Copies a |rows|x8 block of 16-bit elements (|rows| a multiple of 8) from
+// rows |in_stride| bytes apart to the transposed 8x|rows| block with rows
+// |out_stride| bytes apart.
+static inline void iree_uk_wasm_copy_Nx8xi16_transpose_strided_to_strided(
+    char* IREE_UK_RESTRICT out_ptr, const char* IREE_UK_RESTRICT in_ptr,
+    iree_uk_ssize_t rows, iree_uk_ssize_t out_stride,
+    iree_uk_ssize_t in_stride) {
+  for (iree_uk_ssize_t r0 = 0; r0 < rows; r0 += 8) {
+    v128_t v[8];
+    for (int r = 0; r < 8; ++r) {
+      v[r] = wasm_v128_load(in_ptr + (r0 + r) * in_stride);
+    }
+    iree_uk_wasm_transpose_8x8xi16(v);
+    for (int c = 0; c < 8; ++c) {
+      wasm_v128_store(out_ptr + c * out_stride + r0 * 2, v[c]);
+    }
+  }
+}
+
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_WASM_32_COMMON_WASM_32_H_
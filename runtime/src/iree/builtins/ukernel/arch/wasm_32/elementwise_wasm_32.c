@@ -0,0 +1,236 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/wasm_32/elementwise_wasm_32.h"
+
+#include "iree/builtins/ukernel/arch/wasm_32/common_wasm_32.h"
+
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+//===----------------------------------------------------------------------===//
+// Vector helpers.
+//===----------------------------------------------------------------------===//
+
+// Divides signed 32-bit integers, rounding towards zero, through f64 as on
+// arm_64: every quotient of two 32-bit integers is exactly truncated from the
+// quotient of their conversions to double.
+static inline v128_t iree_uk_wasm_div_s32(v128_t a, v128_t b) {
+  v128_t a_hi = wasm_i32x4_shuffle(a, a, 2, 3, 2, 3);
+  v128_t b_hi = wasm_i32x4_shuffle(b, b, 2, 3, 2, 3);
+  v128_t q_lo = wasm_i32x4_trunc_sat_f64x2_zero(wasm_f64x2_div(
+      wasm_f64x2_convert_low_i32x4(a), wasm_f64x2_convert_low_i32x4(b)));
+  v128_t q_hi = wasm_i32x4_trunc_sat_f64x2_zero(wasm_f64x2_div(
+      wasm_f64x2_convert_low_i32x4(a_hi), wasm_f64x2_convert_low_i32x4(b_hi)));
+  return wasm_i64x2_shuffle(q_lo, q_hi, 0, 2);
+}
+
+// Divides unsigned 32-bit integers, rounding towards zero. See
+// iree_uk_wasm_div_s32.
+static inline v128_t iree_uk_wasm_div_u32(v128_t a, v128_t b) {
+  v128_t a_hi = wasm_i32x4_shuffle(a, a, 2, 3, 2, 3);
+  v128_t b_hi = wasm_i32x4_shuffle(b, b, 2, 3, 2, 3);
+  v128_t q_lo = wasm_u32x4_trunc_sat_f64x2_zero(wasm_f64x2_div(
+      wasm_f64x2_convert_low_u32x4(a), wasm_f64x2_convert_low_u32x4(b)));
+  v128_t q_hi = wasm_u32x4_trunc_sat_f64x2_zero(wasm_f64x2_div(
+      wasm_f64x2_convert_low_u32x4(a_hi), wasm_f64x2_convert_low_u32x4(b_hi)));
+  return wasm_i64x2_shuffle(q_lo, q_hi, 0, 2);
+}
+
+//===----------------------------------------------------------------------===//
+// Ops on vectors of 4 32-bit elements.
+//===----------------------------------------------------------------------===//
+
+// v128_t is untyped so, unlike on arm_64, no reinterpretation is needed.
+// SIMD128 has no per-lane variable shifts, count-leading-zeros or
+// transcendental functions, so those ops are left to the generic loop.
+
+static inline v128_t iree_uk_wasm_addf(v128_t a, v128_t b) {
+  return wasm_f32x4_add(a, b);
+}
+static inline v128_t iree_uk_wasm_addi(v128_t a, v128_t b) {
+  return wasm_i32x4_add(a, b);
+}
+static inline v128_t iree_uk_wasm_andi(v128_t a, v128_t b) {
+  return wasm_v128_and(a, b);
+}
+static inline v128_t iree_uk_wasm_divf(v128_t a, v128_t b) {
+  return wasm_f32x4_div(a, b);
+}
+static inline v128_t iree_uk_wasm_divsi(v128_t a, v128_t b) {
+  return iree_uk_wasm_div_s32(a, b);
+}
+static inline v128_t iree_uk_wasm_divui(v128_t a, v128_t b) {
+  return iree_uk_wasm_div_u32(a, b);
+}
+static inline v128_t iree_uk_wasm_mulf(v128_t a, v128_t b) {
+  return wasm_f32x4_mul(a, b);
+}
+static inline v128_t iree_uk_wasm_muli(v128_t a, v128_t b) {
+  return wasm_i32x4_mul(a, b);
+}
+static inline v128_t iree_uk_wasm_ori(v128_t a, v128_t b) {
+  return wasm_v128_or(a, b);
+}
+static inline v128_t iree_uk_wasm_subf(v128_t a, v128_t b) {
+  return wasm_f32x4_sub(a, b);
+}
+static inline v128_t iree_uk_wasm_subi(v128_t a, v128_t b) {
+  return wasm_i32x4_sub(a, b);
+}
+static inline v128_t iree_uk_wasm_xori(v128_t a, v128_t b) {
+  return wasm_v128_xor(a, b);
+}
+
+static inline v128_t iree_uk_wasm_absf(v128_t a) { return wasm_f32x4_abs(a); }
+static inline v128_t iree_uk_wasm_ceilf(v128_t a) {
+  return wasm_f32x4_ceil(a);
+}
+static inline v128_t iree_uk_wasm_floorf(v128_t a) {
+  return wasm_f32x4_floor(a);
+}
+static inline v128_t iree_uk_wasm_negf(v128_t a) { return wasm_f32x4_neg(a); }
+static inline v128_t iree_uk_wasm_rsqrtf(v128_t a) {
+  return wasm_f32x4_div(wasm_f32x4_splat(1.0f), wasm_f32x4_sqrt(a));
+}
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+// Defines iree_uk_x32b_{op}_row_wasm_32, applying iree_uk_wasm_{op} to 4
+// elements at a time. The last partial vector of the row goes through a
+// zero-padded stack buffer.
+#define IREE_UK_X32B_ROW_FUNC_WASM_32(op)                                     \
+  static void iree_uk_x32b_##op##_row_wasm_32(                                \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,               \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {         \
+    iree_uk_ssize_t i = 0;                                                    \
+    for (; i + 4 <= size; i += 4) {                                           \
+      wasm_v128_store(out + i, iree_uk_wasm_##op(wasm_v128_load(lhs + i),     \
+                                                 wasm_v128_load(rhs + i)));   \
+    }                                                                         \
+    if (i < size) {                                                           \
+      iree_uk_uint32_t lhs_buf[4] = {0};                                      \
+      iree_uk_uint32_t rhs_buf[4] = {0};                                      \
+      iree_uk_uint32_t out_buf[4];                                            \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                        \
+        lhs_buf[j] = lhs[i + j];                                              \
+        rhs_buf[j] = rhs[i + j];                                              \
+      }                                                                       \
+      wasm_v128_store(out_buf, iree_uk_wasm_##op(wasm_v128_load(lhs_buf),     \
+                                                 wasm_v128_load(rhs_buf)));   \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                        \
+        out[i + j] = out_buf[j];                                              \
+      }                                                                       \
+    }                                                                         \
+  }
+
+// Defines iree_uk_x32u_{op}_row_wasm_32. See IREE_UK_X32B_ROW_FUNC_WASM_32.
+#define IREE_UK_X32U_ROW_FUNC_WASM_32(op)                                 \
+  static void iree_uk_x32u_##op##_row_wasm_32(                            \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out, \
+      iree_uk_ssize_t size) {                                             \
+    iree_uk_ssize_t i = 0;                                                \
+    for (; i + 4 <= size; i += 4) {                                       \
+      wasm_v128_store(out + i,                                            \
+                      iree_uk_wasm_##op(wasm_v128_load(in + i)));         \
+    }                                                                     \
+    if (i < size) {                                                       \
+      iree_uk_uint32_t in_buf[4] = {0};                                   \
+      iree_uk_uint32_t out_buf[4];                                        \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                    \
+        in_buf[j] = in[i + j];                                            \
+      }                                                                   \
+      wasm_v128_store(out_buf,                                            \
+                      iree_uk_wasm_##op(wasm_v128_load(in_buf)));         \
+      for (iree_uk_ssize_t j = 0; j < size - i; ++j) {                    \
+        out[i + j] = out_buf[j];                                          \
+      }                                                                   \
+    }                                                                     \
+  }
+
+IREE_UK_X32B_ROW_FUNC_WASM_32(addf)
+IREE_UK_X32B_ROW_FUNC_WASM_32(addi)
+IREE_UK_X32B_ROW_FUNC_WASM_32(andi)
+IREE_UK_X32B_ROW_FUNC_WASM_32(divf)
+IREE_UK_X32B_ROW_FUNC_WASM_32(divsi)
+IREE_UK_X32B_ROW_FUNC_WASM_32(divui)
+IREE_UK_X32B_ROW_FUNC_WASM_32(mulf)
+IREE_UK_X32B_ROW_FUNC_WASM_32(muli)
+IREE_UK_X32B_ROW_FUNC_WASM_32(ori)
+IREE_UK_X32B_ROW_FUNC_WASM_32(subf)
+IREE_UK_X32B_ROW_FUNC_WASM_32(subi)
+IREE_UK_X32B_ROW_FUNC_WASM_32(xori)
+
+IREE_UK_X32U_ROW_FUNC_WASM_32(absf)
+IREE_UK_X32U_ROW_FUNC_WASM_32(ceilf)
+IREE_UK_X32U_ROW_FUNC_WASM_32(floorf)
+IREE_UK_X32U_ROW_FUNC_WASM_32(negf)
+IREE_UK_X32U_ROW_FUNC_WASM_32(rsqrtf)
+
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_wasm_32(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_wasm_32;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_wasm_32;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_wasm_32;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_wasm_32;
+    case IREE_UK_X32B_DIVSI:
+      return iree_uk_x32b_divsi_row_wasm_32;
+    case IREE_UK_X32B_DIVUI:
+      return iree_uk_x32b_divui_row_wasm_32;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_wasm_32;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_wasm_32;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_wasm_32;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_wasm_32;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_wasm_32;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_wasm_32;
+    default:
+      return 0;
+  }
+#else
+  (void)opcode;
+  return 0;
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_wasm_32(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_wasm_32;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_wasm_32;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_wasm_32;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_wasm_32;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_wasm_32;
+    default:
+      return 0;
+  }
+#else
+  (void)opcode;
+  return 0;
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+}
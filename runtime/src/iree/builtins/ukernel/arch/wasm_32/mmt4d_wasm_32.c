@@ -0,0 +1,105 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/wasm_32/mmt4d_wasm_32.h"
+
+#include "iree/builtins/ukernel/arch/wasm_32/common_wasm_32.h"
+
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+// The 8x8 accumulator tile takes 16 of the 128-bit vectors. Engines map them
+// to host registers, so on hosts with only 16 vector registers some of them
+// are spilled, but this is still well ahead of the scalar generic tile.
+static void iree_uk_mmt4d_tile_f32f32f32_8x8x1_wasm_32_simd128(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  v128_t acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_v128_load(out_ptr + i * 4);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_f32x4_splat(0.0f);
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    v128_t rhs0 = wasm_v128_load(rhs_ptr);
+    v128_t rhs1 = wasm_v128_load(rhs_ptr + 4);
+    rhs_ptr += 8;
+    for (int i = 0; i < 8; ++i) {
+      v128_t lhs = wasm_v128_load32_splat(lhs_ptr + i);
+      acc[2 * i + 0] =
+          wasm_f32x4_add(acc[2 * i + 0], wasm_f32x4_mul(lhs, rhs0));
+      acc[2 * i + 1] =
+          wasm_f32x4_add(acc[2 * i + 1], wasm_f32x4_mul(lhs, rhs1));
+    }
+    lhs_ptr += 8;
+  }
+  for (int i = 0; i < 16; ++i) wasm_v128_store(out_ptr + i * 4, acc[i]);
+}
+
+// The i8 operands are sign-extended to i16 so that i32x4.dot_i16x8_s computes
+// the K0=2 dot products of one LHS row with 4 RHS columns in one instruction,
+// as VPMADDWD does in the x86-64 AVX2 tile.
+static void iree_uk_mmt4d_tile_i8i8i32_8x8x2_wasm_32_simd128(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  v128_t acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_v128_load(out_ptr + i * 4);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = wasm_i32x4_splat(0);
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    v128_t rhs = wasm_v128_load(rhs_ptr);
+    rhs_ptr += 16;
+    v128_t rhs0 = wasm_i16x8_extend_low_i8x16(rhs);
+    v128_t rhs1 = wasm_i16x8_extend_high_i8x16(rhs);
+    for (int i = 0; i < 8; ++i) {
+      // Broadcast the (i8, i8) pair of LHS row i to all 16-bit lanes, then
+      // sign-extend the low 8 bytes to the (i16, i16) pair in all 32-bit lanes.
+      v128_t lhs_i =
+          wasm_i16x8_extend_low_i8x16(wasm_v128_load16_splat(lhs_ptr + 2 * i));
+      acc[2 * i + 0] =
+          wasm_i32x4_add(acc[2 * i + 0], wasm_i32x4_dot_i16x8(lhs_i, rhs0));
+      acc[2 * i + 1] =
+          wasm_i32x4_add(acc[2 * i + 1], wasm_i32x4_dot_i16x8(lhs_i, rhs1));
+    }
+    lhs_ptr += 16;
+  }
+  for (int i = 0; i < 16; ++i) wasm_v128_store(out_ptr + i * 4, acc[i]);
+}
+
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_wasm_32(
+    const iree_uk_mmt4d_params_t* params) {
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+  if (params->M0 != 8 || params->N0 != 8) return 0;
+  switch (params->type) {
+    case iree_uk_mmt4d_type_f32f32f32:
+      if (params->K0 == 1) {
+        return iree_uk_mmt4d_tile_f32f32f32_8x8x1_wasm_32_simd128;
+      }
+      return 0;
+    case iree_uk_mmt4d_type_i8i8i32:
+      if (params->K0 == 2) {
+        return iree_uk_mmt4d_tile_i8i8i32_8x8x2_wasm_32_simd128;
+      }
+      return 0;
+    default:
+      return 0;
+  }
+#else
+  (void)params;
+  return 0;
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+}
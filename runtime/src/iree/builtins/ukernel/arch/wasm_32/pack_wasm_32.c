@@ -0,0 +1,127 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/wasm_32/pack_wasm_32.h"
+
+#include "iree/builtins/ukernel/arch/wasm_32/common_wasm_32.h"
+
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+static void iree_uk_pack_tile_8x1_x32_wasm_32_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 8);
+  IREE_UK_ASSERT(tile_size1 == 1);
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 4; outer_size1 -= 4) {
+    iree_uk_wasm_copy_Nx4xi32_transpose_strided_to_strided(
+        out_ptr, in_ptr, 8, out_stride1, in_stride0);
+    out_ptr += 4 * out_stride1;
+    in_ptr += 4;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < 8; ++i) {
+      out_ptr[i] = in_ptr[i * in_stride0];
+    }
+    out_ptr += out_stride1;
+    in_ptr += 1;
+  }
+}
+
+static void iree_uk_pack_tile_8x1_x32_wasm_32_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 1);
+  IREE_UK_ASSERT(tile_size1 == 8);
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    wasm_v128_store(out_ptr, wasm_v128_load(in_ptr));
+    wasm_v128_store(out_ptr + 4, wasm_v128_load(in_ptr + 4));
+    out_ptr += out_stride1;
+    in_ptr += 8;
+  }
+}
+
+// Treats each pair of elements along dimension 1 as a single 16-bit element,
+// as on x86-64.
+static void iree_uk_pack_tile_8x2_x8_wasm_32_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 8);
+  IREE_UK_ASSERT(tile_size1 == 2);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 8; outer_size1 -= 8) {
+    iree_uk_wasm_copy_Nx8xi16_transpose_strided_to_strided(
+        out_ptr, in_ptr, 8, out_stride1, in_stride0);
+    out_ptr += 8 * out_stride1;
+    in_ptr += 16;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < 8; ++i) {
+      iree_uk_memcpy(out_ptr + i * 2, in_ptr + i * in_stride0, 2);
+    }
+    out_ptr += out_stride1;
+    in_ptr += 2;
+  }
+}
+
+static void iree_uk_pack_tile_8x2_x8_wasm_32_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 2);
+  IREE_UK_ASSERT(tile_size1 == 8);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    v128_t row0 = wasm_v128_load64_zero(in_ptr);
+    v128_t row1 = wasm_v128_load64_zero(in_ptr + in_stride0);
+    wasm_v128_store(out_ptr,
+                    wasm_i8x16_shuffle(row0, row1, 0, 16, 1, 17, 2, 18, 3, 19,
+                                       4, 20, 5, 21, 6, 22, 7, 23));
+    out_ptr += out_stride1;
+    in_ptr += 8;
+  }
+}
+
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+
+iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_wasm_32(
+    const iree_uk_pack_params_t* params) {
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+  // As on arm_64, only the element type size matters for now.
+  int esize = iree_uk_type_size(iree_uk_pack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER;
+  if (esize == 4 && params->out_size2 == 8 && params->out_size3 == 1) {
+    return transpose ? iree_uk_pack_tile_8x1_x32_wasm_32_transpose
+                     : iree_uk_pack_tile_8x1_x32_wasm_32_direct;
+  } else if (esize == 1 && params->out_size2 == 8 && params->out_size3 == 2) {
+    return transpose ? iree_uk_pack_tile_8x2_x8_wasm_32_transpose
+                     : iree_uk_pack_tile_8x2_x8_wasm_32_direct;
+  }
+#else
+  (void)params;
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+  return 0;
+}
@@ -0,0 +1,34 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/wasm_32/query_tile_sizes_wasm_32.h"
+
+#include "iree/builtins/ukernel/arch/wasm_32/common_wasm_32.h"
+
+// Returns the tile sizes of the SIMD128 tile functions in mmt4d_wasm_32.c.
+// Without SIMD128 there are no wasm32 tile functions and the generic tile
+// sizes are used.
+bool iree_uk_query_matmul_tile_sizes_wasm_32(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+#if defined(IREE_UK_BUILD_WASM_32_SIMD128)
+  iree_uk_uint32_t op = iree_uk_query_tile_sizes_operation(params->flags);
+  if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32) {
+    *out_matmul_tile_sizes =
+        (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32) {
+    *out_matmul_tile_sizes =
+        (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 2, .N = 8};
+    return true;
+  }
+  return false;
+#else
+  (void)params;
+  (void)out_matmul_tile_sizes;
+  return false;
+#endif  // defined(IREE_UK_BUILD_WASM_32_SIMD128)
+}
@@ -0,0 +1,96 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_X86_64_COMMON_X86_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_X86_64_COMMON_X86_64_H_
+
+#include <emmintrin.h>
+
+#include "iree/builtins/ukernel/common.h"
+
+// Helpers for the pack and unpack tile functions. These only use SSE2, which
+// is part of the x86-64 baseline, so that the tile functions using them need
+// no runtime CPU feature check.
+
+// Transposes a 4x4 matrix of 32-bit elements held in 4 rows.
+static inline void iree_uk_sse2_transpose_4x4xi32(__m128i* v) {
+  __m128i t0 = _mm_unpacklo_epi32(v[0], v[1]);
+  __m128i t1 = _mm_unpacklo_epi32(v[2], v[3]);
+  __m128i t2 = _mm_unpackhi_epi32(v[0], v[1]);
+  __m128i t3 = _mm_unpackhi_epi32(v[2], v[3]);
+  v[0] = _mm_unpacklo_epi64(t0, t1);
+  v[1] = _mm_unpackhi_epi64(t0, t1);
+  v[2] = _mm_unpacklo_epi64(t2, t3);
+  v[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+// Transposes an 8x8 matrix of 16-bit elements held in 8 rows.
+static inline void iree_uk_sse2_transpose_8x8xi16(__m128i* v) {
+  __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+  __m128i a1 = _mm_unpacklo_epi16(v[2], v[3]);
+  __m128i a2 = _mm_unpacklo_epi16(v[4], v[5]);
+  __m128i a3 = _mm_unpacklo_epi16(v[6], v[7]);
+  __m128i a4 = _mm_unpackhi_epi16(v[0], v[1]);
+  __m128i a5 = _mm_unpackhi_epi16(v[2], v[3]);
+  __m128i a6 = _mm_unpackhi_epi16(v[4], v[5]);
+  __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+  __m128i b0 = _mm_unpacklo_epi32(a0, a1);
+  __m128i b1 = _mm_unpacklo_epi32(a2, a3);
+  __m128i b2 = _mm_unpackhi_epi32(a0, a1);
+  __m128i b3 = _mm_unpackhi_epi32(a2, a3);
+  __m128i b4 = _mm_unpacklo_epi32(a4, a5);
+  __m128i b5 = _mm_unpacklo_epi32(a6, a7);
+  __m128i b6 = _mm_unpackhi_epi32(a4, a5);
+  __m128i b7 = _mm_unpackhi_epi32(a6, a7);
+  v[0] = _mm_unpacklo_epi64(b0, b1);
+  v[1] = _mm_unpackhi_epi64(b0, b1);
+  v[2] = _mm_unpacklo_epi64(b2, b3);
+  v[3] = _mm_unpackhi_epi64(b2, b3);
+  v[4] = _mm_unpacklo_epi64(b4, b5);
+  v[5] = _mm_unpackhi_epi64(b4, b5);
+  v[6] = _mm_unpacklo_epi64(b6, b7);
+  v[7] = _mm_unpackhi_epi64(b6, b7);
+}
+
+// Copies a |rows|x4 block of 32-bit elements (|rows| a multiple of 4) from
+// rows |in_stride| elements apart to the transposed 4x|rows| block with rows
+// |out_stride| elements apart.
+static inline void iree_uk_sse2_copy_Nx4xi32_transpose_strided_to_strided(
+    iree_uk_int32_t* IREE_UK_RESTRICT out_ptr,
+    const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr, iree_uk_ssize_t rows,
+    iree_uk_ssize_t out_stride, iree_uk_ssize_t in_stride) {
+  for (iree_uk_ssize_t r0 = 0; r0 < rows; r0 += 4) {
+    __m128i v[4];
+    for (int r = 0; r < 4; ++r) {
+      v[r] = _mm_loadu_si128((const __m128i*)(in_ptr + (r0 + r) * in_stride));
+    }
+    iree_uk_sse2_transpose_4x4xi32(v);
+    for (int c = 0; c < 4; ++c) {
+      _mm_storeu_si128((__m128i*)(out_ptr + c * out_stride + r0), v[c]);
+    }
+  }
+}
+
+// Copies a |rows|x8 block of 16-bit elements (|rows| a multiple of 8) from
+// rows |in_stride| bytes apart to the transposed 8x|rows| block with rows
+// |out_stride| bytes apart.
+static inline void iree_uk_sse2_copy_Nx8xi16_transpose_strided_to_strided(
+    char* IREE_UK_RESTRICT out_ptr, const char* IREE_UK_RESTRICT in_ptr,
+    iree_uk_ssize_t rows, iree_uk_ssize_t out_stride,
+    iree_uk_ssize_t in_stride) {
+  for (iree_uk_ssize_t r0 = 0; r0 < rows; r0 += 8) {
+    __m128i v[8];
+    for (int r = 0; r < 8; ++r) {
+      v[r] = _mm_loadu_si128((const __m128i*)(in_ptr + (r0 + r) * in_stride));
+    }
+    iree_uk_sse2_transpose_8x8xi16(v);
+    for (int c = 0; c < 8; ++c) {
+      _mm_storeu_si128((__m128i*)(out_ptr + c * out_stride + r0 * 2), v[c]);
+    }
+  }
+}
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_X86_64_COMMON_X86_64_H_
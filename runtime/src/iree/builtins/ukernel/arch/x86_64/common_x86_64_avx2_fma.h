@@ -0,0 +1,64 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_X86_64_COMMON_X86_64_AVX2_FMA_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_X86_64_COMMON_X86_64_AVX2_FMA_H_
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/common.h"
+
+// Vector helpers shared by the AVX2+FMA row functions. Only to be included
+// from files compiled with -mavx2 -mfma.
+
+// Returns a vector of floats with the given bit pattern.
+static inline __m256 iree_uk_avx2_set1_ps_bits(iree_uk_uint32_t bits) {
+  return _mm256_castsi256_ps(_mm256_set1_epi32((int)bits));
+}
+
+// Returns a mask of the first |count| 32-bit lanes, for |count| in [0, 8].
+static inline __m256i iree_uk_avx2_first_lanes_mask(iree_uk_ssize_t count) {
+  const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)count), iota);
+}
+
+// Computes exp(x) with the Cephes polynomial also used by MLIR's polynomial
+// approximation of math.exp. Results smaller than the smallest normal float
+// are flushed to zero.
+static inline __m256 iree_uk_avx2_exp_ps(__m256 x) {
+  const __m256 max_x = _mm256_set1_ps(88.7228391f);   // log(FLT_MAX)
+  const __m256 min_x = _mm256_set1_ps(-87.3365448f);  // log(FLT_MIN)
+  __m256 clamped = _mm256_min_ps(_mm256_max_ps(x, min_x), max_x);
+  // exp(x) = 2^k * exp(r) with k = round(x / ln(2)) and |r| <= ln(2) / 2.
+  __m256 k = _mm256_floor_ps(_mm256_fmadd_ps(
+      clamped, _mm256_set1_ps(1.44269504088896341f), _mm256_set1_ps(0.5f)));
+  __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(0.693359375f), clamped);
+  r = _mm256_fnmadd_ps(k, _mm256_set1_ps(-2.12194440e-4f), r);
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  __m256 y = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), r);
+  y = _mm256_add_ps(y, _mm256_set1_ps(1.0f));
+  // k is in [-126, 128] so 2^k is applied in two halves that are both normal.
+  __m256i ki = _mm256_cvtps_epi32(k);
+  __m256i k0 = _mm256_srai_epi32(ki, 1);
+  __m256i k1 = _mm256_sub_epi32(ki, k0);
+  const __m256i bias = _mm256_set1_epi32(127);
+  y = _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(
+                           _mm256_add_epi32(k0, bias), 23)));
+  y = _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(
+                           _mm256_add_epi32(k1, bias), 23)));
+  y = _mm256_blendv_ps(y, iree_uk_avx2_set1_ps_bits(0x7F800000),
+                       _mm256_cmp_ps(x, max_x, _CMP_GT_OQ));
+  y = _mm256_blendv_ps(y, _mm256_setzero_ps(),
+                       _mm256_cmp_ps(x, min_x, _CMP_LT_OQ));
+  return _mm256_blendv_ps(y, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_X86_64_COMMON_X86_64_AVX2_FMA_H_
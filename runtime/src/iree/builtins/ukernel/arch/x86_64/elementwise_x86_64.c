@@ -0,0 +1,41 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/schemas/cpu_data.h"
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_avx2_fma(
+    iree_uk_x32b_opcode_t opcode);
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_avx2_fma(
+    iree_uk_x32u_opcode_t opcode);
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return iree_uk_x32b_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#else
+  (void)opcode;
+  (void)cpu_data;
+#endif
+  return 0;
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return iree_uk_x32u_select_row_func_x86_64_avx2_fma(opcode);
+  }
+#else
+  (void)opcode;
+  (void)cpu_data;
+#endif
+  return 0;
+}
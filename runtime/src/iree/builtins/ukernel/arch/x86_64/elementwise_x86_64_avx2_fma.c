@@ -0,0 +1,335 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64_avx2_fma.h"
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+
+//===----------------------------------------------------------------------===//
+// Vector helpers.
+//===----------------------------------------------------------------------===//
+
+// Divides signed 32-bit integers, rounding towards zero. Every quotient of two
+// 32-bit integers is exactly truncated from the quotient of their conversions
+// to double, as the distance from a non-integral quotient to the nearest
+// integer is larger than its rounding error.
+static inline __m256i iree_uk_avx2_div_epi32(__m256i a, __m256i b) {
+  __m256d q_lo = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(a)),
+                               _mm256_cvtepi32_pd(_mm256_castsi256_si128(b)));
+  __m256d q_hi =
+      _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1)),
+                    _mm256_cvtepi32_pd(_mm256_extracti128_si256(b, 1)));
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm256_cvttpd_epi32(q_lo)),
+      _mm256_cvttpd_epi32(q_hi), 1);
+}
+
+// Converts 4 unsigned 32-bit integers to double.
+static inline __m256d iree_uk_avx2_cvtepu32_pd(__m128i a) {
+  __m256d biased =
+      _mm256_cvtepi32_pd(_mm_xor_si128(a, _mm_set1_epi32(IREE_UK_INT32_MIN)));
+  return _mm256_add_pd(biased, _mm256_set1_pd(2147483648.0));
+}
+
+// Converts 4 doubles holding integral values in [0, 2^32) to unsigned 32-bit
+// integers.
+static inline __m128i iree_uk_avx2_cvtpd_epu32(__m256d a) {
+  __m128i biased =
+      _mm256_cvtpd_epi32(_mm256_sub_pd(a, _mm256_set1_pd(2147483648.0)));
+  return _mm_xor_si128(biased, _mm_set1_epi32(IREE_UK_INT32_MIN));
+}
+
+// Divides unsigned 32-bit integers, rounding towards zero. See
+// iree_uk_avx2_div_epi32.
+static inline __m256i iree_uk_avx2_div_epu32(__m256i a, __m256i b) {
+  const int round_to_zero = _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC;
+  __m256d q_lo = _mm256_round_pd(
+      _mm256_div_pd(iree_uk_avx2_cvtepu32_pd(_mm256_castsi256_si128(a)),
+                    iree_uk_avx2_cvtepu32_pd(_mm256_castsi256_si128(b))),
+      round_to_zero);
+  __m256d q_hi = _mm256_round_pd(
+      _mm256_div_pd(iree_uk_avx2_cvtepu32_pd(_mm256_extracti128_si256(a, 1)),
+                    iree_uk_avx2_cvtepu32_pd(_mm256_extracti128_si256(b, 1))),
+      round_to_zero);
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(iree_uk_avx2_cvtpd_epu32(q_lo)),
+      iree_uk_avx2_cvtpd_epu32(q_hi), 1);
+}
+
+// Counts the leading zero bits of 32-bit integers. The leading one bit is
+// isolated and converted to float, which is exact, and its position read
+// from the exponent.
+static inline __m256i iree_uk_avx2_clz_epi32(__m256i a) {
+  __m256i v = _mm256_or_si256(a, _mm256_srli_epi32(a, 1));
+  v = _mm256_or_si256(v, _mm256_srli_epi32(v, 2));
+  v = _mm256_or_si256(v, _mm256_srli_epi32(v, 4));
+  v = _mm256_or_si256(v, _mm256_srli_epi32(v, 8));
+  v = _mm256_or_si256(v, _mm256_srli_epi32(v, 16));
+  __m256i leading_one = _mm256_andnot_si256(_mm256_srli_epi32(v, 1), v);
+  // The leading one 1<<31 converts to -2^31, so the sign bit is masked off.
+  __m256i biased_exponent = _mm256_and_si256(
+      _mm256_srli_epi32(
+          _mm256_castps_si256(_mm256_cvtepi32_ps(leading_one)), 23),
+      _mm256_set1_epi32(0xFF));
+  // 0 has a biased exponent of 0, which saturates to 32.
+  return _mm256_min_epu32(
+      _mm256_sub_epi32(_mm256_set1_epi32(127 + 31), biased_exponent),
+      _mm256_set1_epi32(32));
+}
+
+// Computes log(x) with the Cephes polynomial also used by MLIR's polynomial
+// approximation of math.log. Denormal inputs are treated as the smallest
+// normal float.
+static inline __m256 iree_uk_avx2_log_ps(__m256 x) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 inf = iree_uk_avx2_set1_ps_bits(0x7F800000);
+  // Split x = m * 2^e with m in [0.5, 1).
+  __m256i xi = _mm256_castps_si256(
+      _mm256_max_ps(x, iree_uk_avx2_set1_ps_bits(0x00800000)));
+  __m256 e = _mm256_cvtepi32_ps(
+      _mm256_sub_epi32(_mm256_srli_epi32(xi, 23), _mm256_set1_epi32(126)));
+  __m256 m = _mm256_castsi256_ps(
+      _mm256_or_si256(_mm256_and_si256(xi, _mm256_set1_epi32(0x007FFFFF)),
+                      _mm256_set1_epi32(0x3F000000)));
+  // Shift m to [sqrt(0.5) - 1, sqrt(2) - 1) so that the polynomial is
+  // evaluated on an interval centered on 0.
+  __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f),
+                               _CMP_LT_OQ);
+  e = _mm256_sub_ps(e, _mm256_and_ps(one, small));
+  m = _mm256_add_ps(_mm256_sub_ps(m, one), _mm256_and_ps(m, small));
+  __m256 z = _mm256_mul_ps(m, m);
+  __m256 p = _mm256_set1_ps(7.0376836292e-2f);
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.1514610310e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.1676998740e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.2420140846e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.4249322787e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.6668057665e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(2.0000714765e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-2.4999993993e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(3.3333331174e-1f));
+  __m256 y = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+  y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  y = _mm256_add_ps(m, y);
+  y = _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), y);
+  // log(x < 0) = NaN, log(0) = -inf, log(inf) = inf and log(NaN) = NaN.
+  y = _mm256_blendv_ps(y, iree_uk_avx2_set1_ps_bits(0x7FC00000),
+                       _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+  y = _mm256_blendv_ps(y, iree_uk_avx2_set1_ps_bits(0xFF800000),
+                       _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+  y = _mm256_blendv_ps(y, x, _mm256_cmp_ps(x, inf, _CMP_EQ_OQ));
+  return _mm256_blendv_ps(y, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+//===----------------------------------------------------------------------===//
+// Ops on vectors of 8 32-bit elements.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_AVX2_PS(a) _mm256_castsi256_ps(a)
+#define IREE_UK_AVX2_SI(a) _mm256_castps_si256(a)
+
+static inline __m256i iree_uk_avx2_addf(__m256i a, __m256i b) {
+  return IREE_UK_AVX2_SI(_mm256_add_ps(IREE_UK_AVX2_PS(a), IREE_UK_AVX2_PS(b)));
+}
+static inline __m256i iree_uk_avx2_addi(__m256i a, __m256i b) {
+  return _mm256_add_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_andi(__m256i a, __m256i b) {
+  return _mm256_and_si256(a, b);
+}
+static inline __m256i iree_uk_avx2_divf(__m256i a, __m256i b) {
+  return IREE_UK_AVX2_SI(_mm256_div_ps(IREE_UK_AVX2_PS(a), IREE_UK_AVX2_PS(b)));
+}
+static inline __m256i iree_uk_avx2_divsi(__m256i a, __m256i b) {
+  return iree_uk_avx2_div_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_divui(__m256i a, __m256i b) {
+  return iree_uk_avx2_div_epu32(a, b);
+}
+static inline __m256i iree_uk_avx2_mulf(__m256i a, __m256i b) {
+  return IREE_UK_AVX2_SI(_mm256_mul_ps(IREE_UK_AVX2_PS(a), IREE_UK_AVX2_PS(b)));
+}
+static inline __m256i iree_uk_avx2_muli(__m256i a, __m256i b) {
+  return _mm256_mullo_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_ori(__m256i a, __m256i b) {
+  return _mm256_or_si256(a, b);
+}
+static inline __m256i iree_uk_avx2_shli(__m256i a, __m256i b) {
+  return _mm256_sllv_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_shrsi(__m256i a, __m256i b) {
+  return _mm256_srav_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_shrui(__m256i a, __m256i b) {
+  return _mm256_srlv_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_subf(__m256i a, __m256i b) {
+  return IREE_UK_AVX2_SI(_mm256_sub_ps(IREE_UK_AVX2_PS(a), IREE_UK_AVX2_PS(b)));
+}
+static inline __m256i iree_uk_avx2_subi(__m256i a, __m256i b) {
+  return _mm256_sub_epi32(a, b);
+}
+static inline __m256i iree_uk_avx2_xori(__m256i a, __m256i b) {
+  return _mm256_xor_si256(a, b);
+}
+
+static inline __m256i iree_uk_avx2_absf(__m256i a) {
+  return _mm256_and_si256(a, _mm256_set1_epi32(0x7FFFFFFF));
+}
+static inline __m256i iree_uk_avx2_ceilf(__m256i a) {
+  return IREE_UK_AVX2_SI(_mm256_ceil_ps(IREE_UK_AVX2_PS(a)));
+}
+static inline __m256i iree_uk_avx2_ctlz(__m256i a) {
+  return iree_uk_avx2_clz_epi32(a);
+}
+static inline __m256i iree_uk_avx2_expf(__m256i a) {
+  return IREE_UK_AVX2_SI(iree_uk_avx2_exp_ps(IREE_UK_AVX2_PS(a)));
+}
+static inline __m256i iree_uk_avx2_floorf(__m256i a) {
+  return IREE_UK_AVX2_SI(_mm256_floor_ps(IREE_UK_AVX2_PS(a)));
+}
+static inline __m256i iree_uk_avx2_logf(__m256i a) {
+  return IREE_UK_AVX2_SI(iree_uk_avx2_log_ps(IREE_UK_AVX2_PS(a)));
+}
+static inline __m256i iree_uk_avx2_negf(__m256i a) {
+  return _mm256_xor_si256(a, _mm256_set1_epi32(IREE_UK_INT32_MIN));
+}
+static inline __m256i iree_uk_avx2_rsqrtf(__m256i a) {
+  return IREE_UK_AVX2_SI(
+      _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(IREE_UK_AVX2_PS(a))));
+}
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+// Defines iree_uk_x32b_{op}_row_x86_64_avx2_fma, applying
+// iree_uk_avx2_{op} to 8 elements at a time. The last partial vector of the
+// row is accessed with masked loads and stores.
+#define IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(op)                        \
+  static void iree_uk_x32b_##op##_row_x86_64_avx2_fma(                   \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,          \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {    \
+    iree_uk_ssize_t i = 0;                                               \
+    for (; i + 8 <= size; i += 8) {                                      \
+      __m256i a = _mm256_loadu_si256((const __m256i*)(lhs + i));         \
+      __m256i b = _mm256_loadu_si256((const __m256i*)(rhs + i));         \
+      _mm256_storeu_si256((__m256i*)(out + i), iree_uk_avx2_##op(a, b)); \
+    }                                                                    \
+    if (i < size) {                                                      \
+      __m256i mask = iree_uk_avx2_first_lanes_mask(size - i);            \
+      __m256i a = _mm256_maskload_epi32((const int*)(lhs + i), mask);    \
+      __m256i b = _mm256_maskload_epi32((const int*)(rhs + i), mask);    \
+      _mm256_maskstore_epi32((int*)(out + i), mask,                      \
+                             iree_uk_avx2_##op(a, b));                   \
+    }                                                                    \
+  }
+
+// Defines iree_uk_x32u_{op}_row_x86_64_avx2_fma. See
+// IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA.
+#define IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(op)                          \
+  static void iree_uk_x32u_##op##_row_x86_64_avx2_fma(                     \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out,  \
+      iree_uk_ssize_t size) {                                              \
+    iree_uk_ssize_t i = 0;                                                 \
+    for (; i + 8 <= size; i += 8) {                                        \
+      __m256i a = _mm256_loadu_si256((const __m256i*)(in + i));            \
+      _mm256_storeu_si256((__m256i*)(out + i), iree_uk_avx2_##op(a));      \
+    }                                                                      \
+    if (i < size) {                                                        \
+      __m256i mask = iree_uk_avx2_first_lanes_mask(size - i);              \
+      __m256i a = _mm256_maskload_epi32((const int*)(in + i), mask);       \
+      _mm256_maskstore_epi32((int*)(out + i), mask, iree_uk_avx2_##op(a)); \
+    }                                                                      \
+  }
+
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(addf)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(addi)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(andi)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(divf)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(divsi)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(divui)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(mulf)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(muli)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(ori)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(shli)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(shrsi)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(shrui)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(subf)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(subi)
+IREE_UK_X32B_ROW_FUNC_X86_64_AVX2_FMA(xori)
+
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(absf)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(ceilf)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(ctlz)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(expf)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(floorf)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(logf)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(negf)
+IREE_UK_X32U_ROW_FUNC_X86_64_AVX2_FMA(rsqrtf)
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_avx2_fma(
+    iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_DIVSI:
+      return iree_uk_x32b_divsi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_DIVUI:
+      return iree_uk_x32b_divui_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHLI:
+      return iree_uk_x32b_shli_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHRSI:
+      return iree_uk_x32b_shrsi_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SHRUI:
+      return iree_uk_x32b_shrui_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_x86_64_avx2_fma;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_x86_64_avx2_fma;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_avx2_fma(
+    iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_ctlz_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_EXPF:
+      return iree_uk_x32u_expf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_LOGF:
+      return iree_uk_x32u_logf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_x86_64_avx2_fma;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_x86_64_avx2_fma;
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,220 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+void iree_uk_mmt4d_tile_f32f32f32_8x8x1_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m256 acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_loadu_ps(out_ptr + i * 8);
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m256 rhs = _mm256_loadu_ps(rhs_ptr);
+    rhs_ptr += 8;
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + i), rhs, acc[i]);
+    }
+    lhs_ptr += 8;
+  }
+  for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out_ptr + i * 8, acc[i]);
+}
+
+// The i8 operands are sign-extended to i16 so that VPMADDWD computes the
+// K0=2 dot products of one LHS row with all 8 RHS columns in one instruction.
+// Products of i8 values are at most 2^14 in magnitude so the pairwise i32 sums
+// are exact.
+void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m256i acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_loadu_si256((const __m256i*)(out_ptr + i * 8));
+    }
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_si256();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m256i rhs = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128((const __m128i*)rhs_ptr));
+    __m256i lhs = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128((const __m128i*)lhs_ptr));
+    rhs_ptr += 16;
+    lhs_ptr += 16;
+    for (int i = 0; i < 8; ++i) {
+      // Broadcast the (i16, i16) pair of LHS row i to all 32-bit lanes.
+      __m256i lhs_i = _mm256_permutevar8x32_epi32(lhs, _mm256_set1_epi32(i));
+      acc[i] = _mm256_add_epi32(acc[i], _mm256_madd_epi16(lhs_i, rhs));
+    }
+  }
+  for (int i = 0; i < 8; ++i) {
+    _mm256_storeu_si256((__m256i*)(out_ptr + i * 8), acc[i]);
+  }
+}
+
+// Converts 8 f16 values to f32. AVX2+FMA does not imply F16C, so this is done
+// with integer operations: shifting the exponent and mantissa into place and
+// multiplying by 2^112 rebiases the exponent, also turning f16 denormals into
+// f32 normals. Only Inf and NaN need fixing up.
+static inline __m256 iree_uk_avx2_cvtph_ps(__m128i h) {
+  __m256i x = _mm256_cvtepu16_epi32(h);
+  __m256i sign =
+      _mm256_slli_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0x8000)), 16);
+  __m256i exp_mant = _mm256_and_si256(x, _mm256_set1_epi32(0x7FFF));
+  __m256i shifted = _mm256_slli_epi32(exp_mant, 13);
+  __m256 rebiased = _mm256_mul_ps(
+      _mm256_castsi256_ps(shifted),
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x77800000)));
+  __m256i is_inf_or_nan =
+      _mm256_cmpgt_epi32(exp_mant, _mm256_set1_epi32(0x7BFF));
+  __m256i inf_or_nan =
+      _mm256_or_si256(shifted, _mm256_set1_epi32(0x7F800000));
+  __m256i bits = _mm256_blendv_epi8(_mm256_castps_si256(rebiased), inf_or_nan,
+                                    is_inf_or_nan);
+  return _mm256_castsi256_ps(_mm256_or_si256(bits, sign));
+}
+
+// Returns the zero points of the 8 columns of a tile in i32 lanes, plus 8. See
+// iree_uk_avx2_unpack_int4_8x2.
+static inline __m256i iree_uk_avx2_load_int4_offsets(
+    const iree_uk_int8_t* zero_points) {
+  __m256i eight = _mm256_set1_epi32(8);
+  if (!zero_points) return eight;
+  __m256i z =
+      _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)zero_points));
+  return _mm256_add_epi32(z, eight);
+}
+
+// Unpacks the 8 bytes of one K iteration of a 8x2 RHS tile of INT_4 elements,
+// each holding the K0=2 elements of one column, to i32 lanes minus the zero
+// points. |k0_0| gets the low nibbles and |k0_1| the high nibbles. A nibble n
+// is sign-extended as (n ^ 8) - 8, the - 8 being folded into |offsets|.
+static inline void iree_uk_avx2_unpack_int4_8x2(const iree_uk_uint8_t* ptr,
+                                                __m256i offsets, __m256i* k0_0,
+                                                __m256i* k0_1) {
+  __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)ptr));
+  __m256i eight = _mm256_set1_epi32(8);
+  __m256i low = _mm256_and_si256(bytes, _mm256_set1_epi32(0xF));
+  __m256i high = _mm256_srli_epi32(bytes, 4);
+  *k0_0 = _mm256_sub_epi32(_mm256_xor_si256(low, eight), offsets);
+  *k0_1 = _mm256_sub_epi32(_mm256_xor_si256(high, eight), offsets);
+}
+
+// As in iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma, VPMADDWD computes the
+// K0=2 dot products, here accumulated in i32 over each quantization group. The
+// unpacked RHS values are at most 15 in magnitude so their i16 products with
+// i8 values can't overflow.
+void iree_uk_mmt4d_quant_tile_i8i4f32_8x8x2_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, const float* scales,
+    const iree_uk_int8_t* zero_points, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_uint8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  iree_uk_int32_t group_K = params->rhs_quant->group_size / 2;
+  iree_uk_ssize_t group_stride = params->N * 8;
+  __m256 acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_loadu_ps(out_ptr + i * 8);
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_ps();
+  }
+  for (iree_uk_int32_t k_group = 0; k_group < K; k_group += group_K) {
+    iree_uk_int32_t k_end = iree_uk_ssize_clamp(k_group + group_K, 0, K);
+    __m256i offsets = iree_uk_avx2_load_int4_offsets(zero_points);
+    __m256i group_acc[8];
+    for (int i = 0; i < 8; ++i) group_acc[i] = _mm256_setzero_si256();
+    for (iree_uk_int32_t k = k_group; k < k_end; ++k) {
+      __m256i rhs_k0_0, rhs_k0_1;
+      iree_uk_avx2_unpack_int4_8x2(rhs_ptr, offsets, &rhs_k0_0, &rhs_k0_1);
+      // Interleave to one (k0=0, k0=1) pair of i16 per 32-bit lane.
+      __m256i rhs = _mm256_or_si256(
+          _mm256_and_si256(rhs_k0_0, _mm256_set1_epi32(0xFFFF)),
+          _mm256_slli_epi32(rhs_k0_1, 16));
+      __m256i lhs = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128((const __m128i*)lhs_ptr));
+      rhs_ptr += 8;
+      lhs_ptr += 16;
+      for (int i = 0; i < 8; ++i) {
+        __m256i lhs_i = _mm256_permutevar8x32_epi32(lhs, _mm256_set1_epi32(i));
+        group_acc[i] =
+            _mm256_add_epi32(group_acc[i], _mm256_madd_epi16(lhs_i, rhs));
+      }
+    }
+    __m256 scale = _mm256_loadu_ps(scales);
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_fmadd_ps(_mm256_cvtepi32_ps(group_acc[i]), scale, acc[i]);
+    }
+    scales += group_stride;
+    if (zero_points) zero_points += group_stride;
+  }
+  for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out_ptr + i * 8, acc[i]);
+}
+
+// The RHS values are dequantized to f32 as they are unpacked, so that each K
+// iteration is 16 FMAs into the 8 accumulators as in the f32 kernels.
+void iree_uk_mmt4d_quant_tile_f16i4f32_8x8x2_x86_64_avx2_fma(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, const float* scales,
+    const iree_uk_int8_t* zero_points, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_uint8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  iree_uk_int32_t group_K = params->rhs_quant->group_size / 2;
+  iree_uk_ssize_t group_stride = params->N * 8;
+  __m256 acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_loadu_ps(out_ptr + i * 8);
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_ps();
+  }
+  for (iree_uk_int32_t k_group = 0; k_group < K; k_group += group_K) {
+    iree_uk_int32_t k_end = iree_uk_ssize_clamp(k_group + group_K, 0, K);
+    __m256i offsets = iree_uk_avx2_load_int4_offsets(zero_points);
+    __m256 scale = _mm256_loadu_ps(scales);
+    for (iree_uk_int32_t k = k_group; k < k_end; ++k) {
+      __m256i rhs_k0_0, rhs_k0_1;
+      iree_uk_avx2_unpack_int4_8x2(rhs_ptr, offsets, &rhs_k0_0, &rhs_k0_1);
+      __m256 rhs[2] = {
+          _mm256_mul_ps(_mm256_cvtepi32_ps(rhs_k0_0), scale),
+          _mm256_mul_ps(_mm256_cvtepi32_ps(rhs_k0_1), scale),
+      };
+      // The (k0=0, k0=1) pairs of LHS rows 0..3 and 4..7.
+      __m256 lhs[2] = {
+          iree_uk_avx2_cvtph_ps(_mm_loadu_si128((const __m128i*)lhs_ptr)),
+          iree_uk_avx2_cvtph_ps(_mm_loadu_si128((const __m128i*)lhs_ptr + 1)),
+      };
+      rhs_ptr += 8;
+      lhs_ptr += 16;
+      for (int i = 0; i < 8; ++i) {
+        for (int k0 = 0; k0 < 2; ++k0) {
+          __m256 lhs_i_k0 = _mm256_permutevar8x32_ps(
+              lhs[i / 4], _mm256_set1_epi32((i % 4) * 2 + k0));
+          acc[i] = _mm256_fmadd_ps(lhs_i_k0, rhs[k0], acc[i]);
+        }
+      }
+    }
+    scales += group_stride;
+    if (zero_points) zero_points += group_stride;
+  }
+  for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out_ptr + i * 8, acc[i]);
+}
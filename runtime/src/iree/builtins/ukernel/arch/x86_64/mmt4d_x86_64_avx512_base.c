@@ -0,0 +1,122 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+void iree_uk_mmt4d_tile_f32f32f32_16x16x1_x86_64_avx512_base(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_loadu_ps(out_ptr + i * 16);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512 rhs = _mm512_loadu_ps(rhs_ptr);
+    rhs_ptr += 16;
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[i]), rhs, acc[i]);
+    }
+    lhs_ptr += 16;
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out_ptr + i * 16, acc[i]);
+}
+
+// See iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma.
+void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_base(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m512i acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_loadu_si512(out_ptr + i * 16);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_si512();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512i rhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)rhs_ptr));
+    __m512i lhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)lhs_ptr));
+    rhs_ptr += 32;
+    lhs_ptr += 32;
+    for (int i = 0; i < 16; ++i) {
+      __m512i lhs_i = _mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_add_epi32(acc[i], _mm512_madd_epi16(lhs_i, rhs));
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_si512(out_ptr + i * 16, acc[i]);
+}
+
+// The f16 operands are widened with VCVTPH2PS and accumulated in f32. The f16
+// output case rounds to f16 once when storing the tile.
+static inline void iree_uk_mmt4d_tile_f16f16_16x16x1_x86_64_avx512_base_impl(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    bool out_is_f16) {
+  const iree_uk_uint16_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      if (out_is_f16) {
+        acc[i] = _mm512_cvtph_ps(
+            _mm256_loadu_si256((const __m256i*)out_tile_untyped + i));
+      } else {
+        acc[i] = _mm512_loadu_ps((const float*)out_tile_untyped + i * 16);
+      }
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512 rhs = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)rhs_ptr));
+    __m512 lhs = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)lhs_ptr));
+    rhs_ptr += 16;
+    lhs_ptr += 16;
+    for (int i = 0; i < 16; ++i) {
+      __m512 lhs_i = _mm512_permutexvar_ps(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_fmadd_ps(lhs_i, rhs, acc[i]);
+    }
+  }
+  for (int i = 0; i < 16; ++i) {
+    if (out_is_f16) {
+      _mm256_storeu_si256((__m256i*)out_tile_untyped + i,
+                          _mm512_cvtps_ph(acc[i], _MM_FROUND_TO_NEAREST_INT |
+                                                      _MM_FROUND_NO_EXC));
+    } else {
+      _mm512_storeu_ps((float*)out_tile_untyped + i * 16, acc[i]);
+    }
+  }
+}
+
+void iree_uk_mmt4d_tile_f16f16f32_16x16x1_x86_64_avx512_base(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_f16f16_16x16x1_x86_64_avx512_base_impl(
+      out_tile, lhs_panel, rhs_panel, K, flags, /*out_is_f16=*/false);
+}
+
+void iree_uk_mmt4d_tile_f16f16f16_16x16x1_x86_64_avx512_base(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_f16f16_16x16x1_x86_64_avx512_base_impl(
+      out_tile, lhs_panel, rhs_panel, K, flags, /*out_is_f16=*/true);
+}
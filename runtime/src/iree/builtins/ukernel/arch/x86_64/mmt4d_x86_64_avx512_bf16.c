@@ -0,0 +1,69 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+// VDPBF16PS computes the K0=2 dot products of one LHS row with all 16 RHS
+// columns, accumulating in f32. The bf16 output case rounds to bf16 once when
+// storing the tile.
+static inline void iree_uk_mmt4d_tile_bf16bf16_16x16x2_x86_64_avx512_bf16_impl(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    bool out_is_bf16) {
+  const iree_uk_uint16_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      if (out_is_bf16) {
+        __m512i widened = _mm512_cvtepu16_epi32(
+            _mm256_loadu_si256((const __m256i*)out_tile_untyped + i));
+        acc[i] = _mm512_castsi512_ps(_mm512_slli_epi32(widened, 16));
+      } else {
+        acc[i] = _mm512_loadu_ps((const float*)out_tile_untyped + i * 16);
+      }
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512i rhs = _mm512_loadu_si512(rhs_ptr);
+    __m512i lhs = _mm512_loadu_si512(lhs_ptr);
+    rhs_ptr += 32;
+    lhs_ptr += 32;
+    for (int i = 0; i < 16; ++i) {
+      // Broadcast the (bf16, bf16) pair of LHS row i to all 32-bit lanes.
+      __m512i lhs_i = _mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_dpbf16_ps(acc[i], (__m512bh)lhs_i, (__m512bh)rhs);
+    }
+  }
+  for (int i = 0; i < 16; ++i) {
+    if (out_is_bf16) {
+      _mm256_storeu_si256((__m256i*)out_tile_untyped + i,
+                          (__m256i)_mm512_cvtneps_pbh(acc[i]));
+    } else {
+      _mm512_storeu_ps((float*)out_tile_untyped + i * 16, acc[i]);
+    }
+  }
+}
+
+void iree_uk_mmt4d_tile_bf16bf16f32_16x16x2_x86_64_avx512_bf16(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_bf16bf16_16x16x2_x86_64_avx512_bf16_impl(
+      out_tile, lhs_panel, rhs_panel, K, flags, /*out_is_bf16=*/false);
+}
+
+void iree_uk_mmt4d_tile_bf16bf16bf16_16x16x2_x86_64_avx512_bf16(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_bf16bf16_16x16x2_x86_64_avx512_bf16_impl(
+      out_tile, lhs_panel, rhs_panel, K, flags, /*out_is_bf16=*/true);
+}
@@ -0,0 +1,41 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+// Same as iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_base but with the
+// multiply and accumulation fused into a single VPDPWSSD.
+void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_vnni(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel_untyped;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel_untyped;
+  __m512i acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_loadu_si512(out_ptr + i * 16);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_si512();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512i rhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)rhs_ptr));
+    __m512i lhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)lhs_ptr));
+    rhs_ptr += 32;
+    lhs_ptr += 32;
+    for (int i = 0; i < 16; ++i) {
+      __m512i lhs_i = _mm512_permutexvar_epi32(_mm512_set1_epi32(i), lhs);
+      acc[i] = _mm512_dpwssd_epi32(acc[i], lhs_i, rhs);
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_si512(out_ptr + i * 16, acc[i]);
+}
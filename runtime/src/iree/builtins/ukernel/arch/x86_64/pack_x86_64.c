@@ -0,0 +1,143 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/pack_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64.h"
+
+// Handles the 8x1 and 16x1 tiles of 32-bit elements.
+static void iree_uk_pack_tile_Nx1_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 8 || tile_size0 == 16);
+  IREE_UK_ASSERT(tile_size1 == 1);
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 4; outer_size1 -= 4) {
+    iree_uk_sse2_copy_Nx4xi32_transpose_strided_to_strided(
+        out_ptr, in_ptr, tile_size0, out_stride1, in_stride0);
+    out_ptr += 4 * out_stride1;
+    in_ptr += 4;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; ++i) {
+      out_ptr[i] = in_ptr[i * in_stride0];
+    }
+    out_ptr += out_stride1;
+    in_ptr += 1;
+  }
+}
+
+// Handles the 8x1 and 16x1 tiles of 32-bit elements.
+static void iree_uk_pack_tile_Nx1_x32_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 1);
+  IREE_UK_ASSERT(tile_size1 == 8 || tile_size1 == 16);
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    iree_uk_memcpy(out_ptr, in_ptr, tile_size1 * 4);
+    out_ptr += out_stride1;
+    in_ptr += tile_size1;
+  }
+}
+
+// Handles the 8x2 and 16x2 tiles of 8-bit elements by treating each pair of
+// elements along dimension 1 as a single 16-bit element.
+static void iree_uk_pack_tile_Nx2_x8_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 8 || tile_size0 == 16);
+  IREE_UK_ASSERT(tile_size1 == 2);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 8; outer_size1 -= 8) {
+    iree_uk_sse2_copy_Nx8xi16_transpose_strided_to_strided(
+        out_ptr, in_ptr, tile_size0, out_stride1, in_stride0);
+    out_ptr += 8 * out_stride1;
+    in_ptr += 16;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; ++i) {
+      iree_uk_memcpy(out_ptr + i * 2, in_ptr + i * in_stride0, 2);
+    }
+    out_ptr += out_stride1;
+    in_ptr += 2;
+  }
+}
+
+static void iree_uk_pack_tile_8x2_x8_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 2);
+  IREE_UK_ASSERT(tile_size1 == 8);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    __m128i row0 = _mm_loadl_epi64((const __m128i*)in_ptr);
+    __m128i row1 = _mm_loadl_epi64((const __m128i*)(in_ptr + in_stride0));
+    _mm_storeu_si128((__m128i*)out_ptr, _mm_unpacklo_epi8(row0, row1));
+    out_ptr += out_stride1;
+    in_ptr += 8;
+  }
+}
+
+static void iree_uk_pack_tile_16x2_x8_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 2);
+  IREE_UK_ASSERT(tile_size1 == 16);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    __m128i row0 = _mm_loadu_si128((const __m128i*)in_ptr);
+    __m128i row1 = _mm_loadu_si128((const __m128i*)(in_ptr + in_stride0));
+    _mm_storeu_si128((__m128i*)out_ptr, _mm_unpacklo_epi8(row0, row1));
+    _mm_storeu_si128((__m128i*)(out_ptr + 16), _mm_unpackhi_epi8(row0, row1));
+    out_ptr += out_stride1;
+    in_ptr += 16;
+  }
+}
+
+iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_x86_64(
+    const iree_uk_pack_params_t* params) {
+  // As on arm_64, only the element type size matters for now.
+  int esize = iree_uk_type_size(iree_uk_pack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER;
+  bool size2_supported = params->out_size2 == 8 || params->out_size2 == 16;
+  if (esize == 4 && size2_supported && params->out_size3 == 1) {
+    return transpose ? iree_uk_pack_tile_Nx1_x32_x86_64_transpose
+                     : iree_uk_pack_tile_Nx1_x32_x86_64_direct;
+  } else if (esize == 1 && params->out_size2 == 8 && params->out_size3 == 2) {
+    return transpose ? iree_uk_pack_tile_8x2_x8_x86_64_transpose
+                     : iree_uk_pack_tile_Nx2_x8_x86_64_direct;
+  } else if (esize == 1 && params->out_size2 == 16 && params->out_size3 == 2) {
+    return transpose ? iree_uk_pack_tile_16x2_x8_x86_64_transpose
+                     : iree_uk_pack_tile_Nx2_x8_x86_64_direct;
+  }
+  return 0;
+}
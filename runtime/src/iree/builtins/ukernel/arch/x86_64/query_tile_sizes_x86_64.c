@@ -0,0 +1,84 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/query_tile_sizes_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/schemas/cpu_data.h"
+
+// Returns false when no x86-64 tile function is available for the CPU, in
+// which case the generic tile sizes are used.
+static bool iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    *out_matmul_tile_sizes =
+        (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 1, .N = 16};
+    return true;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    *out_matmul_tile_sizes =
+        (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+    return true;
+  }
+#endif
+  (void)params;
+  return false;
+}
+
+static bool iree_uk_query_matmul_tile_sizes_x86_64_i8i8i32(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    *out_matmul_tile_sizes =
+        (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 2, .N = 16};
+    return true;
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    *out_matmul_tile_sizes =
+        (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 2, .N = 8};
+    return true;
+  }
+#endif
+  (void)params;
+  return false;
+}
+
+bool iree_uk_query_matmul_tile_sizes_x86_64(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+  iree_uk_uint32_t op = iree_uk_query_tile_sizes_operation(params->flags);
+  if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32) {
+    return iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(
+        params, out_matmul_tile_sizes);
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32) {
+    return iree_uk_query_matmul_tile_sizes_x86_64_i8i8i32(
+        params, out_matmul_tile_sizes);
+  } else {
+    // Can't happen, validated earlier.
+    IREE_UK_ASSUME_UNREACHABLE;
+    return false;
+  }
+}
+
+bool iree_uk_query_cache_sizes_x86_64(const iree_uk_uint64_t* cpu_data,
+                                      iree_uk_cache_sizes_t* out_cache_sizes) {
+  // AVX-512 is a proxy for the server-class cores with at least 1MiB of L2.
+  // Client cores from the AVX2 generations may have as little as 256KiB.
+  bool large_l2 = cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE;
+  *out_cache_sizes = (iree_uk_cache_sizes_t){
+      .l1 = 32 * 1024,
+      .l2 = (large_l2 ? 1024 : 256) * 1024,
+      .l3 = 1024 * 1024,
+  };
+  return true;
+}
@@ -0,0 +1,41 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/reduction_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/schemas/cpu_data.h"
+
+void iree_uk_softmax_row_x86_64_avx2_fma(const float* in, float* out,
+                                         iree_uk_ssize_t size);
+void iree_uk_layer_norm_row_x86_64_avx2_fma(const float* in, float* out,
+                                            iree_uk_ssize_t size,
+                                            const float* gamma,
+                                            const float* beta, float epsilon);
+
+iree_uk_softmax_row_func_t iree_uk_softmax_select_row_func_x86_64(
+    const iree_uk_uint64_t* cpu_data) {
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return iree_uk_softmax_row_x86_64_avx2_fma;
+  }
+#else
+  (void)cpu_data;
+#endif
+  return 0;
+}
+
+iree_uk_layer_norm_row_func_t iree_uk_layer_norm_select_row_func_x86_64(
+    const iree_uk_uint64_t* cpu_data) {
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return iree_uk_layer_norm_row_x86_64_avx2_fma;
+  }
+#else
+  (void)cpu_data;
+#endif
+  return 0;
+}
@@ -0,0 +1,21 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_X86_64_REDUCTION_X86_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_X86_64_REDUCTION_X86_64_H_
+
+#include "iree/builtins/ukernel/reduction.h"
+
+// Returns the x86-64 softmax row function to use for |cpu_data|, or NULL if
+// there is none, in which case the caller falls back to generic code.
+iree_uk_softmax_row_func_t iree_uk_softmax_select_row_func_x86_64(
+    const iree_uk_uint64_t* cpu_data);
+
+// Same as iree_uk_softmax_select_row_func_x86_64 for layer normalization.
+iree_uk_layer_norm_row_func_t iree_uk_layer_norm_select_row_func_x86_64(
+    const iree_uk_uint64_t* cpu_data);
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_X86_64_REDUCTION_X86_64_H_
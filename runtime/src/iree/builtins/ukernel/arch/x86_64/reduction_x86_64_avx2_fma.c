@@ -0,0 +1,140 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64_avx2_fma.h"
+#include "iree/builtins/ukernel/arch/x86_64/reduction_x86_64.h"
+
+// Returns the maximum of the 8 lanes of |v|.
+static inline float iree_uk_avx2_reduce_max_ps(__m256 v) {
+  __m128 m =
+      _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  m = _mm_max_ss(m, _mm_movehdup_ps(m));
+  return _mm_cvtss_f32(m);
+}
+
+// Returns the sum of the 8 lanes of |v|.
+static inline float iree_uk_avx2_reduce_add_ps(__m256 v) {
+  __m128 s =
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_movehdup_ps(s));
+  return _mm_cvtss_f32(s);
+}
+
+void iree_uk_softmax_row_x86_64_avx2_fma(const float* in, float* out,
+                                         iree_uk_ssize_t size) {
+  // Lane-wise running maxima and sums of exp(x - max). The main loop takes 4
+  // vectors per step so that the sums are only rescaled once per 32 elements.
+  // See iree_uk_softmax_row_generic for why the maxima start at -FLT_MAX.
+  __m256 max = _mm256_set1_ps(-IREE_UK_FLOAT32_MAX);
+  __m256 sum = _mm256_setzero_ps();
+  iree_uk_ssize_t j = 0;
+  for (; j + 32 <= size; j += 32) {
+    __m256 x0 = _mm256_loadu_ps(in + j + 0);
+    __m256 x1 = _mm256_loadu_ps(in + j + 8);
+    __m256 x2 = _mm256_loadu_ps(in + j + 16);
+    __m256 x3 = _mm256_loadu_ps(in + j + 24);
+    __m256 new_max = _mm256_max_ps(
+        max, _mm256_max_ps(_mm256_max_ps(x0, x1), _mm256_max_ps(x2, x3)));
+    __m256 e01 =
+        _mm256_add_ps(iree_uk_avx2_exp_ps(_mm256_sub_ps(x0, new_max)),
+                      iree_uk_avx2_exp_ps(_mm256_sub_ps(x1, new_max)));
+    __m256 e23 =
+        _mm256_add_ps(iree_uk_avx2_exp_ps(_mm256_sub_ps(x2, new_max)),
+                      iree_uk_avx2_exp_ps(_mm256_sub_ps(x3, new_max)));
+    __m256 rescale = iree_uk_avx2_exp_ps(_mm256_sub_ps(max, new_max));
+    sum = _mm256_fmadd_ps(sum, rescale, _mm256_add_ps(e01, e23));
+    max = new_max;
+  }
+  // Remaining vectors, the last one partial. Lanes past the end of the row
+  // read as -inf, which contributes exp(-inf) = 0 to the sums.
+  const __m256 minus_inf = iree_uk_avx2_set1_ps_bits(0xFF800000);
+  for (; j < size; j += 8) {
+    __m256i mask = iree_uk_avx2_first_lanes_mask(size - j);
+    __m256 x = _mm256_blendv_ps(minus_inf, _mm256_maskload_ps(in + j, mask),
+                                _mm256_castsi256_ps(mask));
+    __m256 new_max = _mm256_max_ps(max, x);
+    __m256 rescale = iree_uk_avx2_exp_ps(_mm256_sub_ps(max, new_max));
+    sum = _mm256_fmadd_ps(sum, rescale,
+                          iree_uk_avx2_exp_ps(_mm256_sub_ps(x, new_max)));
+    max = new_max;
+  }
+  // Combine the lanes, rescaling each lane sum to the row maximum.
+  __m256 row_max = _mm256_set1_ps(iree_uk_avx2_reduce_max_ps(max));
+  float row_sum = iree_uk_avx2_reduce_add_ps(_mm256_mul_ps(
+      sum, iree_uk_avx2_exp_ps(_mm256_sub_ps(max, row_max))));
+  __m256 inv_sum = _mm256_set1_ps(1.0f / row_sum);
+  for (j = 0; j + 8 <= size; j += 8) {
+    __m256 x = _mm256_loadu_ps(in + j);
+    __m256 e = iree_uk_avx2_exp_ps(_mm256_sub_ps(x, row_max));
+    _mm256_storeu_ps(out + j, _mm256_mul_ps(e, inv_sum));
+  }
+  if (j < size) {
+    __m256i mask = iree_uk_avx2_first_lanes_mask(size - j);
+    __m256 x = _mm256_maskload_ps(in + j, mask);
+    __m256 e = iree_uk_avx2_exp_ps(_mm256_sub_ps(x, row_max));
+    _mm256_maskstore_ps(out + j, mask, _mm256_mul_ps(e, inv_sum));
+  }
+}
+
+void iree_uk_layer_norm_row_x86_64_avx2_fma(const float* in, float* out,
+                                            iree_uk_ssize_t size,
+                                            const float* gamma,
+                                            const float* beta, float epsilon) {
+  // Lane-wise Welford updates over the full vectors. All lanes have seen the
+  // same count n of elements, so the update uses a scalar 1 / n.
+  __m256 mean_v = _mm256_setzero_ps();
+  __m256 m2_v = _mm256_setzero_ps();
+  iree_uk_ssize_t vector_count = size / 8;
+  for (iree_uk_ssize_t n = 1; n <= vector_count; ++n) {
+    __m256 x = _mm256_loadu_ps(in + 8 * (n - 1));
+    __m256 delta = _mm256_sub_ps(x, mean_v);
+    mean_v = _mm256_fmadd_ps(delta, _mm256_set1_ps(1.0f / (float)n), mean_v);
+    m2_v = _mm256_fmadd_ps(delta, _mm256_sub_ps(x, mean_v), m2_v);
+  }
+  // Combine the lanes, which all have the same count, then continue with the
+  // remaining elements one at a time.
+  float mean = iree_uk_avx2_reduce_add_ps(mean_v) * 0.125f;
+  __m256 lane_delta = _mm256_sub_ps(mean_v, _mm256_set1_ps(mean));
+  float m2 = iree_uk_avx2_reduce_add_ps(
+      _mm256_fmadd_ps(_mm256_mul_ps(lane_delta, lane_delta),
+                      _mm256_set1_ps((float)vector_count), m2_v));
+  for (iree_uk_ssize_t j = 8 * vector_count; j < size; ++j) {
+    float x = in[j];
+    float delta = x - mean;
+    mean += delta / (float)(j + 1);
+    m2 += delta * (x - mean);
+  }
+  __m128 variance = _mm_set_ss(m2 / (float)size + epsilon);
+  __m256 inv_stddev_b =
+      _mm256_set1_ps(1.0f / _mm_cvtss_f32(_mm_sqrt_ss(variance)));
+  __m256 mean_b = _mm256_set1_ps(mean);
+  iree_uk_ssize_t j = 0;
+  for (; j < size; j += 8) {
+    __m256i mask = iree_uk_avx2_first_lanes_mask(size - j);
+    bool full = j + 8 <= size;
+    __m256 x =
+        full ? _mm256_loadu_ps(in + j) : _mm256_maskload_ps(in + j, mask);
+    __m256 scale = inv_stddev_b;
+    if (gamma) {
+      __m256 g = full ? _mm256_loadu_ps(gamma + j)
+                      : _mm256_maskload_ps(gamma + j, mask);
+      scale = _mm256_mul_ps(scale, g);
+    }
+    __m256 bias = _mm256_setzero_ps();
+    if (beta) {
+      bias = full ? _mm256_loadu_ps(beta + j)
+                  : _mm256_maskload_ps(beta + j, mask);
+    }
+    __m256 y = _mm256_fmadd_ps(_mm256_sub_ps(x, mean_b), scale, bias);
+    if (full) {
+      _mm256_storeu_ps(out + j, y);
+    } else {
+      _mm256_maskstore_ps(out + j, mask, y);
+    }
+  }
+}
@@ -0,0 +1,158 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/unpack_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64.h"
+
+// Handles the 8x1 and 16x1 tiles of 32-bit elements.
+static void iree_uk_unpack_tile_Nx1_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 8 || tile_size0 == 16);
+  IREE_UK_ASSERT(tile_size1 == 1);
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 4; outer_size1 -= 4) {
+    for (iree_uk_ssize_t i0 = 0; i0 < tile_size0; i0 += 4) {
+      iree_uk_sse2_copy_Nx4xi32_transpose_strided_to_strided(
+          out_ptr + i0 * out_stride0, in_ptr + i0, 4, out_stride0, in_stride1);
+    }
+    out_ptr += 4;
+    in_ptr += 4 * in_stride1;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; ++i) {
+      out_ptr[i * out_stride0] = in_ptr[i];
+    }
+    out_ptr += 1;
+    in_ptr += in_stride1;
+  }
+}
+
+// Handles the 8x1 and 16x1 tiles of 32-bit elements.
+static void iree_uk_unpack_tile_Nx1_x32_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 1);
+  IREE_UK_ASSERT(tile_size1 == 8 || tile_size1 == 16);
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    iree_uk_memcpy(out_ptr, in_ptr, tile_size1 * 4);
+    out_ptr += tile_size1;
+    in_ptr += in_stride1;
+  }
+}
+
+// Handles the 8x2 and 16x2 tiles of 8-bit elements by treating each pair of
+// elements along dimension 1 as a single 16-bit element.
+static void iree_uk_unpack_tile_Nx2_x8_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 8 || tile_size0 == 16);
+  IREE_UK_ASSERT(tile_size1 == 2);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 8; outer_size1 -= 8) {
+    for (iree_uk_ssize_t i0 = 0; i0 < tile_size0; i0 += 8) {
+      iree_uk_sse2_copy_Nx8xi16_transpose_strided_to_strided(
+          out_ptr + i0 * out_stride0, in_ptr + i0 * 2, 8, out_stride0,
+          in_stride1);
+    }
+    out_ptr += 16;
+    in_ptr += 8 * in_stride1;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; ++i) {
+      iree_uk_memcpy(out_ptr + i * out_stride0, in_ptr + i * 2, 2);
+    }
+    out_ptr += 2;
+    in_ptr += in_stride1;
+  }
+}
+
+static void iree_uk_unpack_tile_8x2_x8_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 2);
+  IREE_UK_ASSERT(tile_size1 == 8);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  const __m128i low_bytes = _mm_set1_epi16(0xFF);
+  const __m128i zero = _mm_setzero_si128();
+  for (; outer_size1 > 0; --outer_size1) {
+    // Deinterleaves the even and odd bytes into the two output rows.
+    __m128i in = _mm_loadu_si128((const __m128i*)in_ptr);
+    __m128i even = _mm_packus_epi16(_mm_and_si128(in, low_bytes), zero);
+    __m128i odd = _mm_packus_epi16(_mm_srli_epi16(in, 8), zero);
+    _mm_storel_epi64((__m128i*)out_ptr, even);
+    _mm_storel_epi64((__m128i*)(out_ptr + out_stride0), odd);
+    out_ptr += 8;
+    in_ptr += in_stride1;
+  }
+}
+
+static void iree_uk_unpack_tile_16x2_x8_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 1);
+  IREE_UK_ASSERT(tile_size0 == 2);
+  IREE_UK_ASSERT(tile_size1 == 16);
+  char* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const char* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  const __m128i low_bytes = _mm_set1_epi16(0xFF);
+  for (; outer_size1 > 0; --outer_size1) {
+    __m128i in0 = _mm_loadu_si128((const __m128i*)in_ptr);
+    __m128i in1 = _mm_loadu_si128((const __m128i*)(in_ptr + 16));
+    __m128i even = _mm_packus_epi16(_mm_and_si128(in0, low_bytes),
+                                    _mm_and_si128(in1, low_bytes));
+    __m128i odd =
+        _mm_packus_epi16(_mm_srli_epi16(in0, 8), _mm_srli_epi16(in1, 8));
+    _mm_storeu_si128((__m128i*)out_ptr, even);
+    _mm_storeu_si128((__m128i*)(out_ptr + out_stride0), odd);
+    out_ptr += 16;
+    in_ptr += in_stride1;
+  }
+}
+
+iree_uk_unpack_tile_func_t iree_uk_unpack_select_tile_func_x86_64(
+    const iree_uk_unpack_params_t* params) {
+  // As on arm_64, only the element type size matters for now.
+  int esize = iree_uk_type_size(iree_uk_unpack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_INNER;
+  bool size2_supported = params->in_size2 == 8 || params->in_size2 == 16;
+  if (esize == 4 && size2_supported && params->in_size3 == 1) {
+    return transpose ? iree_uk_unpack_tile_Nx1_x32_x86_64_transpose
+                     : iree_uk_unpack_tile_Nx1_x32_x86_64_direct;
+  } else if (esize == 1 && params->in_size2 == 8 && params->in_size3 == 2) {
+    return transpose ? iree_uk_unpack_tile_8x2_x8_x86_64_transpose
+                     : iree_uk_unpack_tile_Nx2_x8_x86_64_direct;
+  } else if (esize == 1 && params->in_size2 == 16 && params->in_size3 == 2) {
+    return transpose ? iree_uk_unpack_tile_16x2_x8_x86_64_transpose
+                     : iree_uk_unpack_tile_Nx2_x8_x86_64_direct;
+  }
+  return 0;
+}
@@ -218,6 +218,13 @@ extern "C" {
 #define IREE_UK_ATTRIBUTE_ALIGNED(N)
 #endif  // IREE_UK_HAVE_ATTRIBUTE(noinline)
 
+// Hints that the cache line containing |ptr| will soon be read.
+#if IREE_UK_HAVE_BUILTIN(__builtin_prefetch) || defined(__GNUC__)
+#define IREE_UK_PREFETCH_RO(ptr) __builtin_prefetch((ptr), /*rw=*/0)
+#else
+#define IREE_UK_PREFETCH_RO(ptr)
+#endif  // IREE_UK_HAVE_BUILTIN(__builtin_prefetch)
+
 //===----------------------------------------------------------------------===//
 // Local replacements for stdint.h types and constants
 // Refer to the comment at the top of this file for why we can't include
@@ -259,6 +266,7 @@ IREE_UK_STATIC_ASSERT(sizeof(iree_uk_uint64_t) == 8);
 #define IREE_UK_UINT16_MAX 0xffff
 #define IREE_UK_UINT32_MAX 0xffffffffU
 #define IREE_UK_UINT64_MAX 0xffffffffffffffffULL
+#define IREE_UK_FLOAT32_MAX 3.40282347e+38f
 
 // Helper for microkernel input validation
 #define IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(VALUE, BIT_COUNT) \
@@ -412,6 +420,7 @@ enum {
   IREE_UK_TYPE_OPAQUE_16 = IREE_UK_TYPE_CATEGORY_OPAQUE | 4,
   IREE_UK_TYPE_OPAQUE_32 = IREE_UK_TYPE_CATEGORY_OPAQUE | 5,
   IREE_UK_TYPE_OPAQUE_64 = IREE_UK_TYPE_CATEGORY_OPAQUE | 6,
+  IREE_UK_TYPE_INT_4 = IREE_UK_TYPE_CATEGORY_INTEGER | 2,
   IREE_UK_TYPE_INT_8 = IREE_UK_TYPE_CATEGORY_INTEGER | 3,
   IREE_UK_TYPE_INT_16 = IREE_UK_TYPE_CATEGORY_INTEGER | 4,
   IREE_UK_TYPE_INT_32 = IREE_UK_TYPE_CATEGORY_INTEGER | 5,
@@ -459,6 +468,16 @@ static inline int iree_uk_type_size(iree_uk_type_t t) {
   return 1 << iree_uk_type_size_log2(t);
 }
 
+// Returns the size in bytes of |count| elements of type |t|. Unlike
+// iree_uk_type_size, this supports sub-byte types, as long as the |count|
+// elements make up a whole number of bytes.
+static inline iree_uk_ssize_t iree_uk_type_size_of_count(
+    iree_uk_type_t t, iree_uk_ssize_t count) {
+  iree_uk_ssize_t bits = count << iree_uk_type_bit_count_log2(t);
+  IREE_UK_ASSERT(!(bits & 7));
+  return bits >> 3;
+}
+
 //===----------------------------------------------------------------------===//
 // Tuples of types, packed ("tied") into a word.
 //===----------------------------------------------------------------------===//
@@ -502,6 +521,110 @@ static inline void iree_uk_memset(void* buf, int val, iree_uk_ssize_t n) {
   for (iree_uk_ssize_t i = 0; i < n; ++i) ((char*)buf)[i] = val;
 }
 
+//===----------------------------------------------------------------------===//
+// 16-bit floating point conversions
+//===----------------------------------------------------------------------===//
+// 16-bit float values are stored as their bit patterns in iree_uk_uint16_t.
+// Conversions to narrower types round to nearest, ties to even.
+
+static inline float iree_uk_f32_from_bits(iree_uk_uint32_t bits) {
+  float f;
+  iree_uk_memcpy(&f, &bits, sizeof f);
+  return f;
+}
+
+static inline iree_uk_uint32_t iree_uk_f32_to_bits(float f) {
+  iree_uk_uint32_t bits;
+  iree_uk_memcpy(&bits, &f, sizeof bits);
+  return bits;
+}
+
+static inline float iree_uk_f16_to_f32(iree_uk_uint16_t h) {
+  iree_uk_uint32_t sign = (iree_uk_uint32_t)(h & 0x8000) << 16;
+  iree_uk_uint32_t exp = (h >> 10) & 0x1F;
+  iree_uk_uint32_t mant = h & 0x3FF;
+  if (exp == 0x1F) {
+    // Inf or NaN.
+    return iree_uk_f32_from_bits(sign | 0x7F800000 | (mant << 13));
+  } else if (exp == 0) {
+    if (mant == 0) return iree_uk_f32_from_bits(sign);
+    // Denormal: normalize the mantissa.
+    int shift = 0;
+    while (!(mant & 0x400)) {
+      mant <<= 1;
+      ++shift;
+    }
+    iree_uk_uint32_t biased_exp = 113 - shift;
+    return iree_uk_f32_from_bits(sign | (biased_exp << 23) |
+                                 ((mant & 0x3FF) << 13));
+  }
+  return iree_uk_f32_from_bits(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+static inline iree_uk_uint16_t iree_uk_f32_to_f16(float f) {
+  iree_uk_uint32_t u = iree_uk_f32_to_bits(f);
+  iree_uk_uint16_t sign = (u >> 16) & 0x8000;
+  u &= 0x7FFFFFFF;
+  if (u >= 0x7F800000) {
+    // Inf or NaN; NaNs are quieted.
+    return sign | 0x7C00 | (u > 0x7F800000 ? 0x200 : 0);
+  } else if (u >= 0x477FF000) {
+    // Rounds to a magnitude greater than the largest finite f16.
+    return sign | 0x7C00;
+  } else if (u >= 0x38800000) {
+    // Normal f16: rebias the exponent and round the mantissa.
+    u += 0xFFF + ((u >> 13) & 1);
+    return sign | ((u - 0x38000000) >> 13);
+  }
+  // Denormal f16 or zero.
+  int exp = u >> 23;
+  if (exp < 102) return sign;
+  iree_uk_uint32_t mant = (u & 0x7FFFFF) | 0x800000;
+  int shift = 126 - exp;
+  iree_uk_uint32_t result = mant >> shift;
+  iree_uk_uint32_t rem = mant & ((1u << shift) - 1);
+  iree_uk_uint32_t half = 1u << (shift - 1);
+  if (rem > half || (rem == half && (result & 1))) ++result;
+  return sign | result;
+}
+
+static inline float iree_uk_bf16_to_f32(iree_uk_uint16_t h) {
+  return iree_uk_f32_from_bits((iree_uk_uint32_t)h << 16);
+}
+
+static inline iree_uk_uint16_t iree_uk_f32_to_bf16(float f) {
+  iree_uk_uint32_t u = iree_uk_f32_to_bits(f);
+  if ((u & 0x7FFFFFFF) > 0x7F800000) {
+    // NaN; quieted so that the truncation cannot produce an Inf.
+    return (u >> 16) | 0x40;
+  }
+  u += 0x7FFF + ((u >> 16) & 1);
+  return u >> 16;
+}
+
+//===----------------------------------------------------------------------===//
+// 4-bit integers
+//===----------------------------------------------------------------------===//
+// Buffers of INT_4 elements hold two elements per byte, the element of even
+// index in the low nibble.
+
+// Returns the sign-extended INT_4 element of index |index| in |buffer|.
+static inline iree_uk_int32_t iree_uk_int4_load(const void* buffer,
+                                                iree_uk_ssize_t index) {
+  iree_uk_uint8_t byte = ((const iree_uk_uint8_t*)buffer)[index >> 1];
+  iree_uk_int32_t nibble = (index & 1) ? byte >> 4 : byte & 0xF;
+  return (nibble ^ 8) - 8;
+}
+
+// Stores the low 4 bits of |value| to the INT_4 element of index |index| in
+// |buffer|, leaving the other element in the same byte unchanged.
+static inline void iree_uk_int4_store(void* buffer, iree_uk_ssize_t index,
+                                      iree_uk_int32_t value) {
+  iree_uk_uint8_t* byte = (iree_uk_uint8_t*)buffer + (index >> 1);
+  int shift = (index & 1) ? 4 : 0;
+  *byte = (*byte & ~(0xF << shift)) | ((value & 0xF) << shift);
+}
+
 //===----------------------------------------------------------------------===//
 // Count leading zeros (extracted from base/internal/math.h and adapted
 // to be able to be used standalone).
@@ -19,7 +19,8 @@ extern "C" {
 
 // Binary ukernel func 2d, x32.
 // It takes lhs, rhs, out buffers and size, returning 0 on success and !0 on
-// error.
+// error. |cpu_data| is the CPU data (see iree/schemas/cpu_data.h) used to
+// select architecture-specific code paths.
 typedef int (*iree_uk_x32b_2d_func_t)(
     const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_offset,
     iree_uk_ssize_t lhs_stride0, iree_uk_ssize_t lhs_stride1,
@@ -27,7 +28,8 @@ typedef int (*iree_uk_x32b_2d_func_t)(
     iree_uk_ssize_t rhs_stride0, iree_uk_ssize_t rhs_stride1,
     iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
     iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1,
-    iree_uk_ssize_t size0, iree_uk_ssize_t size1);
+    iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
@@ -40,7 +42,8 @@ typedef int (*iree_uk_x32b_2d_func_t)(
       iree_uk_ssize_t rhs_stride0, iree_uk_ssize_t rhs_stride1, \
       dtype* IREE_UK_RESTRICT out, iree_uk_ssize_t out_offset,  \
       iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1, \
-      iree_uk_ssize_t size0, iree_uk_ssize_t size1)
+      iree_uk_ssize_t size0, iree_uk_ssize_t size1,             \
+      const iree_uk_uint64_t* cpu_data)
 
 DECLARE_UKERNEL_BINARY_2D(addf, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(addi, iree_uk_uint32_t, x32b);
@@ -64,13 +67,14 @@ DECLARE_UKERNEL_BINARY_2D(xori, iree_uk_uint32_t, x32b);
 
 // Unary ukernel func 2d, x32.
 // It takes in, out buffers and size, returning 0 on success and !0 on
-// error.
+// error. |cpu_data| is as for iree_uk_x32b_2d_func_t.
 typedef int (*iree_uk_x32u_2d_func_t)(
     const iree_uk_uint32_t* in, iree_uk_ssize_t in_offset,
     iree_uk_ssize_t in_stride0, iree_uk_ssize_t in_stride1,
     iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
     iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1,
-    iree_uk_ssize_t size0, iree_uk_ssize_t size1);
+    iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
@@ -82,7 +86,7 @@ typedef int (*iree_uk_x32u_2d_func_t)(
       iree_uk_ssize_t in_stride1, dtype* IREE_UK_RESTRICT out,                \
       iree_uk_ssize_t out_offset, iree_uk_ssize_t out_stride0,                \
       iree_uk_ssize_t out_stride1, iree_uk_ssize_t size0,                     \
-      iree_uk_ssize_t size1)
+      iree_uk_ssize_t size1, const iree_uk_uint64_t* cpu_data)
 
 DECLARE_UKERNEL_UNARY_2D(absf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(ceilf, iree_uk_uint32_t, x32u);
@@ -93,6 +97,61 @@ DECLARE_UKERNEL_UNARY_2D(logf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(negf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(rsqrtf, iree_uk_uint32_t, x32u);
 
+//===----------------------------------------------------------------------===//
+// Internal implementation details.
+//===----------------------------------------------------------------------===//
+
+// Opcodes for generic functions operating on 32-bit operands and result.
+// Since the outer dispatcher only differentiates based on width, all other
+// type specificity is carried by the opcode.
+// Binary opcodes are named "X32B" and unary opcodes "X32U".
+// The initial list was sorted, and it is encouraged to sort extensions, but
+// each opcode must be numerically stable, so the list is not expected to
+// be sorted over time.
+typedef enum {
+  IREE_UK_X32B_ADDF = 0,
+  IREE_UK_X32B_ADDI = 1,
+  IREE_UK_X32B_ANDI = 2,
+  IREE_UK_X32B_DIVF = 3,
+  IREE_UK_X32B_DIVSI = 4,
+  IREE_UK_X32B_DIVUI = 5,
+  IREE_UK_X32B_MULF = 6,
+  IREE_UK_X32B_MULI = 7,
+  IREE_UK_X32B_ORI = 8,
+  IREE_UK_X32B_SHLI = 9,
+  IREE_UK_X32B_SHRSI = 10,
+  IREE_UK_X32B_SHRUI = 11,
+  IREE_UK_X32B_SUBF = 12,
+  IREE_UK_X32B_SUBI = 13,
+  IREE_UKENREL_X32B_XORI = 14,
+} iree_uk_x32b_opcode_t;
+
+typedef enum {
+  IREE_UK_X32U_ABSF,
+  IREE_UK_X32U_CEILF,
+  IREE_UK_X32U_CTLZ,
+  IREE_UK_X32U_EXPF,
+  IREE_UK_X32U_FLOORF,
+  IREE_UK_X32U_LOGF,
+  IREE_UK_X32U_NEGF,
+  IREE_UK_X32U_RSQRTF,
+} iree_uk_x32u_opcode_t;
+
+// Function pointer type for row functions, i.e. typically architecture
+// specific functions computing one row of |size| contiguous elements of a
+// binary op. The generic 2d loop calls them on each row when all the inner
+// strides are 1.
+typedef void (*iree_uk_x32b_row_func_t)(const iree_uk_uint32_t* lhs,
+                                        const iree_uk_uint32_t* rhs,
+                                        iree_uk_uint32_t* IREE_UK_RESTRICT out,
+                                        iree_uk_ssize_t size);
+
+// Function pointer type for row functions of unary ops. See
+// iree_uk_x32b_row_func_t.
+typedef void (*iree_uk_x32u_row_func_t)(const iree_uk_uint32_t* in,
+                                        iree_uk_uint32_t* IREE_UK_RESTRICT out,
+                                        iree_uk_ssize_t size);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
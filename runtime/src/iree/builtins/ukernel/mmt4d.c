@@ -7,6 +7,7 @@
 #include "iree/builtins/ukernel/mmt4d.h"
 
 #include "iree/builtins/ukernel/mmt4d_tile.h"
+#include "iree/builtins/ukernel/query_tile_sizes.h"
 
 #define OUTSIDE_UINT_RANGE(value, bits) (((value) < 0) || ((value) >> (bits)))
 
@@ -14,7 +15,13 @@ static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
 #ifdef IREE_UK_ENABLE_ASSERTS
   IREE_UK_ASSERT(!(params->flags & ~IREE_UK_FLAG_ACCUMULATE));
   IREE_UK_ASSERT(params->type == iree_uk_mmt4d_type_f32f32f32 ||
-                 params->type == iree_uk_mmt4d_type_i8i8i32);
+                 params->type == iree_uk_mmt4d_type_i8i8i32 ||
+                 params->type == iree_uk_mmt4d_type_f16f16f32 ||
+                 params->type == iree_uk_mmt4d_type_f16f16f16 ||
+                 params->type == iree_uk_mmt4d_type_bf16bf16f32 ||
+                 params->type == iree_uk_mmt4d_type_bf16bf16bf16 ||
+                 params->type == iree_uk_mmt4d_type_i8i4f32 ||
+                 params->type == iree_uk_mmt4d_type_f16i4f32);
   // Some implementations may wish to avoid supporting absurdly wide types. For
   // instance, K is the innermost (i.e. hottest) loop bound, so some 32bit
   // targets may benefit from K being int32, not int64. We still let K be of
@@ -28,17 +35,104 @@ static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
   IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->N0, 15));
   IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->K0, 15));
   // Ensure iree_uk_mmt4d_tile_generic_max_bytes large enough for this tile.
-  IREE_UK_ASSERT(params->M0 * params->N0 *
-                     iree_uk_type_size(iree_uk_mmt4d_out_type(params->type)) <=
+  // 16-bit float outputs are accumulated in f32.
+  int acc_type_size = iree_uk_type_size(iree_uk_mmt4d_out_type(params->type));
+  if (acc_type_size < 4) acc_type_size = 4;
+  IREE_UK_ASSERT(params->M0 * params->N0 * acc_type_size <=
                  iree_uk_mmt4d_tile_generic_max_bytes);
+  if (iree_uk_mmt4d_rhs_type(params->type) == IREE_UK_TYPE_INT_4) {
+    // RHS tiles and panels must start on byte boundaries.
+    IREE_UK_ASSERT(!((params->N0 * params->K0) & 1));
+    IREE_UK_ASSERT(!(params->rhs_stride & 1));
+    IREE_UK_ASSERT(params->rhs_quant);
+    IREE_UK_ASSERT(params->rhs_quant->scales);
+    IREE_UK_ASSERT(params->rhs_quant->group_size > 0);
+    IREE_UK_ASSERT(params->rhs_quant->group_size % params->K0 == 0);
+  } else {
+    IREE_UK_ASSERT(!params->rhs_quant);
+  }
+  if (params->rhs_sparsity) {
+    IREE_UK_ASSERT(!params->rhs_quant);
+    IREE_UK_ASSERT(params->rhs_sparsity->panel_offsets);
+    IREE_UK_ASSERT(params->rhs_sparsity->panel_offsets[0] == 0);
+    IREE_UK_ASSERT(params->rhs_sparsity->k_indices ||
+                   params->rhs_sparsity->panel_offsets[params->N] == 0);
+  }
+  if (params->epilogue) {
+    const iree_uk_mmt4d_epilogue_t* epilogue = params->epilogue;
+    iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params->type);
+    IREE_UK_ASSERT(!(epilogue->flags & ~IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP));
+    IREE_UK_ASSERT(acc_type == IREE_UK_TYPE_FLOAT_32 ||
+                   acc_type == IREE_UK_TYPE_INT_32);
+    IREE_UK_ASSERT(epilogue->out_type == acc_type ||
+                   (params->type == iree_uk_mmt4d_type_i8i8i32 &&
+                    epilogue->out_type == IREE_UK_TYPE_INT_8));
+    if (epilogue->out_type != acc_type) {
+      // The previous output can't be used as the accumulator.
+      IREE_UK_ASSERT(!(params->flags & IREE_UK_FLAG_ACCUMULATE));
+      IREE_UK_ASSERT(epilogue->scales);
+    }
+  }
 #endif  // IREE_UK_ENABLE_ASSERTS
 }
 
+// Numbers of K iterations (K1) and of M and N tiles (M1, N1) in the blocks
+// that the outer loops of iree_uk_mmt4d_using_tile_func iterate over.
+typedef struct iree_uk_mmt4d_block_sizes_t {
+  iree_uk_int32_t M1;
+  iree_uk_int32_t N1;
+  iree_uk_int32_t K1;
+} iree_uk_mmt4d_block_sizes_t;
+
+// Returns the block sizes for which the K1 slices of one LHS and one RHS panel
+// fit in half of L1, the N1 RHS panels of a block fit in half of L2 and the M1
+// LHS panels of a block fit in half of the L3 share of one core. The other
+// halves are left for the output tiles and the data of other ukernels.
+static iree_uk_mmt4d_block_sizes_t iree_uk_mmt4d_select_block_sizes(
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_cache_sizes_t cache_sizes =
+      iree_uk_query_cache_sizes(params->cpu_data);
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  iree_uk_ssize_t lhs_bytes_per_k =
+      (params->M0 * params->K0) << iree_uk_type_size_log2(lhs_type);
+  iree_uk_ssize_t rhs_bytes_per_k =
+      (params->N0 * params->K0) << iree_uk_type_size_log2(rhs_type);
+  iree_uk_mmt4d_block_sizes_t block_sizes = {
+      .M1 = params->M, .N1 = params->N, .K1 = params->K};
+  // Splitting K stores and reloads the accumulators between K blocks, which
+  // would round 16-bit outputs more than once.
+  if (iree_uk_type_size(out_type) >= 4) {
+    iree_uk_ssize_t K1 =
+        (cache_sizes.l1 / 2) / (lhs_bytes_per_k + rhs_bytes_per_k);
+    if (K1 < 1) K1 = 1;
+    if (K1 < block_sizes.K1) block_sizes.K1 = K1;
+  }
+  iree_uk_ssize_t N1 =
+      (cache_sizes.l2 / 2) / (block_sizes.K1 * rhs_bytes_per_k);
+  if (N1 < 1) N1 = 1;
+  if (N1 < block_sizes.N1) block_sizes.N1 = N1;
+  if (cache_sizes.l3) {
+    iree_uk_ssize_t M1 =
+        (cache_sizes.l3 / 2) / (block_sizes.K1 * lhs_bytes_per_k);
+    if (M1 < 1) M1 = 1;
+    if (M1 < block_sizes.M1) block_sizes.M1 = M1;
+  }
+  return block_sizes;
+}
+
 // General mmt4d implementation, shared among all cases. The idea is that the
 // only really performance-critical part is the inner-most loop, and that's
 // handled by the tile_func passed as argument here. Sharing the outer loops
 // across all cases is a roughly 2x code shrink compared to if we were
 // emitting the whole loop nest for each case.
+//
+// The outer loops are blocked for the caches (see
+// iree_uk_mmt4d_select_block_sizes): within a K block, the LHS panel of the
+// current row stays in L1 while the RHS panels of the current N block are
+// streamed from L2. K blocks after the first accumulate into the output. The
+// start of the next RHS panel is prefetched ahead of each tile.
 static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
                                           iree_uk_mmt4d_tile_func_t tile_func) {
   const iree_uk_int32_t M = params->M;
@@ -46,14 +140,185 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
   const iree_uk_int32_t K = params->K;
   const iree_uk_int16_t M0 = params->M0;
   const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_int16_t K0 = params->K0;
   const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
   const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
   const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
   const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
   const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
   const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const iree_uk_mmt4d_block_sizes_t block_sizes =
+      iree_uk_mmt4d_select_block_sizes(params);
+  iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
+  iree_uk_ssize_t lhs_panel_stride = params->lhs_stride << lhs_elem_size_log2;
+  iree_uk_ssize_t rhs_panel_stride = params->rhs_stride << rhs_elem_size_log2;
+  iree_uk_ssize_t out_stride = params->out_stride << out_elem_size_log2;
+  iree_uk_ssize_t lhs_k_block_stride =
+      (block_sizes.K1 * M0 * K0) << lhs_elem_size_log2;
+  iree_uk_ssize_t rhs_k_block_stride =
+      (block_sizes.K1 * N0 * K0) << rhs_elem_size_log2;
+  const char* lhs_k_block = params->lhs_buffer;
+  const char* rhs_k_block = params->rhs_buffer;
+  for (iree_uk_int32_t k1 = 0; k1 < K; k1 += block_sizes.K1) {
+    iree_uk_int32_t K1 = iree_uk_ssize_clamp(K - k1, 0, block_sizes.K1);
+    iree_uk_uint32_t flags =
+        k1 ? params->flags | IREE_UK_FLAG_ACCUMULATE : params->flags;
+    for (iree_uk_int32_t i1 = 0; i1 < M; i1 += block_sizes.M1) {
+      iree_uk_int32_t i_end = iree_uk_ssize_clamp(i1 + block_sizes.M1, 0, M);
+      for (iree_uk_int32_t j1 = 0; j1 < N; j1 += block_sizes.N1) {
+        iree_uk_int32_t j_end = iree_uk_ssize_clamp(j1 + block_sizes.N1, 0, N);
+        for (iree_uk_int32_t i = i1; i < i_end; ++i) {
+          char* out_tile = (char*)params->out_buffer + i * out_stride +
+                           j1 * out_tile_size;
+          const char* lhs_panel = lhs_k_block + i * lhs_panel_stride;
+          const char* rhs_panel = rhs_k_block + j1 * rhs_panel_stride;
+          for (iree_uk_int32_t j = j1; j < j_end; ++j) {
+            IREE_UK_PREFETCH_RO(rhs_panel + rhs_panel_stride);
+            tile_func(out_tile, lhs_panel, rhs_panel, K1, flags, params);
+            out_tile += out_tile_size;
+            rhs_panel += rhs_panel_stride;
+          }
+        }
+      }
+    }
+    lhs_k_block += lhs_k_block_stride;
+    rhs_k_block += rhs_k_block_stride;
+  }
+}
+
+// Function pointer type for functions applying the epilogue of |params| to the
+// M0xN0 accumulator tile |acc_tile| and storing the result to |out_tile|.
+// |channel| is the output channel of the first column of the tile.
+typedef void (*iree_uk_mmt4d_epilogue_func_t)(
+    const iree_uk_mmt4d_params_t* params, const void* acc_tile, void* out_tile,
+    iree_uk_ssize_t channel);
+
+static void iree_uk_mmt4d_epilogue_f32(const iree_uk_mmt4d_params_t* params,
+                                       const void* acc_tile_untyped,
+                                       void* out_tile_untyped,
+                                       iree_uk_ssize_t channel) {
+  const iree_uk_mmt4d_epilogue_t* epilogue = params->epilogue;
+  const float* IREE_UK_RESTRICT acc_tile = acc_tile_untyped;
+  float* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const float* bias = epilogue->bias ? (const float*)epilogue->bias + channel
+                                     : 0;
+  bool clamp = epilogue->flags & IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP;
+  float clamp_min = epilogue->clamp_min_f32;
+  float clamp_max = epilogue->clamp_max_f32;
+  for (iree_uk_int32_t i0 = 0; i0 < params->M0; ++i0) {
+    for (iree_uk_int32_t j0 = 0; j0 < params->N0; ++j0) {
+      float value = *acc_tile++;
+      if (bias) value += bias[j0];
+      if (clamp) {
+        value = value < clamp_min ? clamp_min : value;
+        value = value > clamp_max ? clamp_max : value;
+      }
+      *out_tile++ = value;
+    }
+  }
+}
+
+static void iree_uk_mmt4d_epilogue_i32(const iree_uk_mmt4d_params_t* params,
+                                       const void* acc_tile_untyped,
+                                       void* out_tile_untyped,
+                                       iree_uk_ssize_t channel) {
+  const iree_uk_mmt4d_epilogue_t* epilogue = params->epilogue;
+  const iree_uk_int32_t* IREE_UK_RESTRICT acc_tile = acc_tile_untyped;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_int32_t* bias =
+      epilogue->bias ? (const iree_uk_int32_t*)epilogue->bias + channel : 0;
+  bool clamp = epilogue->flags & IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP;
+  iree_uk_int32_t clamp_min = epilogue->clamp_min_i32;
+  iree_uk_int32_t clamp_max = epilogue->clamp_max_i32;
+  for (iree_uk_int32_t i0 = 0; i0 < params->M0; ++i0) {
+    for (iree_uk_int32_t j0 = 0; j0 < params->N0; ++j0) {
+      iree_uk_int32_t value = *acc_tile++;
+      if (bias) value += bias[j0];
+      if (clamp) {
+        value = value < clamp_min ? clamp_min : value;
+        value = value > clamp_max ? clamp_max : value;
+      }
+      *out_tile++ = value;
+    }
+  }
+}
+
+static void iree_uk_mmt4d_epilogue_i32_requantize_i8(
+    const iree_uk_mmt4d_params_t* params, const void* acc_tile_untyped,
+    void* out_tile_untyped, iree_uk_ssize_t channel) {
+  const iree_uk_mmt4d_epilogue_t* epilogue = params->epilogue;
+  const iree_uk_int32_t* IREE_UK_RESTRICT acc_tile = acc_tile_untyped;
+  iree_uk_int8_t* IREE_UK_RESTRICT out_tile = out_tile_untyped;
+  const iree_uk_int32_t* bias =
+      epilogue->bias ? (const iree_uk_int32_t*)epilogue->bias + channel : 0;
+  const float* scales =
+      epilogue->per_channel_scales ? epilogue->scales + channel : 0;
+  float scale = epilogue->scales[0];
+  iree_uk_int32_t zero_point = epilogue->zero_point;
+  iree_uk_int32_t out_min = -128;
+  iree_uk_int32_t out_max = 127;
+  if (epilogue->flags & IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP) {
+    if (epilogue->clamp_min_i32 > out_min) out_min = epilogue->clamp_min_i32;
+    if (epilogue->clamp_max_i32 < out_max) out_max = epilogue->clamp_max_i32;
+  }
+  // Clamping happens in float before rounding, relative to the zero point, so
+  // that the rounding only ever sees values of small magnitude.
+  float scaled_min = (float)(out_min - zero_point);
+  float scaled_max = (float)(out_max - zero_point);
+  for (iree_uk_int32_t i0 = 0; i0 < params->M0; ++i0) {
+    for (iree_uk_int32_t j0 = 0; j0 < params->N0; ++j0) {
+      iree_uk_int32_t value = *acc_tile++;
+      if (bias) value += bias[j0];
+      float scaled = (float)value * (scales ? scales[j0] : scale);
+      scaled = scaled < scaled_min ? scaled_min : scaled;
+      scaled = scaled > scaled_max ? scaled_max : scaled;
+      // Adding 1.5 * 2^23 rounds to the nearest even integer, which is then
+      // read from the low mantissa bits. Valid for magnitudes below 2^22.
+      iree_uk_int32_t rounded =
+          (iree_uk_int32_t)iree_uk_f32_to_bits(scaled + 12582912.0f) -
+          0x4B400000;
+      *out_tile++ = (iree_uk_int8_t)(rounded + zero_point);
+    }
+  }
+}
+
+static iree_uk_mmt4d_epilogue_func_t iree_uk_mmt4d_select_epilogue_func(
+    const iree_uk_mmt4d_params_t* params) {
+  if (params->epilogue->out_type == IREE_UK_TYPE_INT_8) {
+    return iree_uk_mmt4d_epilogue_i32_requantize_i8;
+  }
+  return iree_uk_mmt4d_out_type(params->type) == IREE_UK_TYPE_INT_32
+             ? iree_uk_mmt4d_epilogue_i32
+             : iree_uk_mmt4d_epilogue_f32;
+}
+
+// Variant of iree_uk_mmt4d_using_tile_func applying the epilogue. Each tile is
+// accumulated into a local buffer that stays in L1 and the epilogue reads it
+// from there as it writes the output, so the output is only written once.
+static void iree_uk_mmt4d_using_tile_func_with_epilogue(
+    const iree_uk_mmt4d_params_t* params, iree_uk_mmt4d_tile_func_t tile_func) {
+  const iree_uk_int32_t M = params->M;
+  const iree_uk_int32_t N = params->N;
+  const iree_uk_int32_t K = params->K;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_type_t out_type = params->epilogue->out_type;
+  const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
+  const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
+  const iree_uk_int16_t acc_elem_size_log2 = iree_uk_type_size_log2(acc_type);
+  const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const bool accumulate = params->flags & IREE_UK_FLAG_ACCUMULATE;
+  iree_uk_mmt4d_epilogue_func_t epilogue_func =
+      iree_uk_mmt4d_select_epilogue_func(params);
+  IREE_UK_ATTRIBUTE_ALIGNED(64)
+  iree_uk_int32_t acc_tile[iree_uk_mmt4d_tile_generic_max_bytes /
+                           sizeof(iree_uk_int32_t)];
   char* out_tile_row = params->out_buffer;
   const char* lhs_panel = params->lhs_buffer;
+  iree_uk_int32_t acc_tile_size = (M0 * N0) << acc_elem_size_log2;
   iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
   iree_uk_ssize_t lhs_panel_stride = params->lhs_stride << lhs_elem_size_log2;
   iree_uk_ssize_t rhs_panel_stride = params->rhs_stride << rhs_elem_size_log2;
@@ -62,7 +327,16 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
     char* out_tile = out_tile_row;
     const char* rhs_panel = params->rhs_buffer;
     for (iree_uk_int32_t j = 0; j < N; ++j) {
-      tile_func(out_tile, lhs_panel, rhs_panel, K, params->flags, params);
+      // Accumulating is only allowed when the output has the accumulator type.
+      if (accumulate) {
+        iree_uk_memcpy(acc_tile, out_tile, acc_tile_size);
+      }
+      if (K) {
+        tile_func(acc_tile, lhs_panel, rhs_panel, K, params->flags, params);
+      } else if (!accumulate) {
+        iree_uk_memset(acc_tile, 0, acc_tile_size);
+      }
+      epilogue_func(params, acc_tile, out_tile, j * N0);
       out_tile += out_tile_size;
       rhs_panel += rhs_panel_stride;
     }
@@ -71,6 +345,138 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
   }
 }
 
+// Variant of iree_uk_mmt4d_using_tile_func for the types with a quantized RHS,
+// also applying the epilogue if any. The loops are not blocked along K, as the
+// tiles would then have to start in the middle of a quantization group.
+static void iree_uk_mmt4d_using_quant_tile_func(
+    const iree_uk_mmt4d_params_t* params,
+    iree_uk_mmt4d_quant_tile_func_t tile_func) {
+  const iree_uk_int32_t M = params->M;
+  const iree_uk_int32_t N = params->N;
+  const iree_uk_int32_t K = params->K;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_mmt4d_epilogue_t* epilogue = params->epilogue;
+  const iree_uk_type_t out_type = epilogue ? epilogue->out_type : acc_type;
+  const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
+  const iree_uk_int16_t acc_elem_size_log2 = iree_uk_type_size_log2(acc_type);
+  const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const bool accumulate = params->flags & IREE_UK_FLAG_ACCUMULATE;
+  const iree_uk_mmt4d_rhs_quant_t* rhs_quant = params->rhs_quant;
+  iree_uk_mmt4d_epilogue_func_t epilogue_func =
+      epilogue ? iree_uk_mmt4d_select_epilogue_func(params) : 0;
+  IREE_UK_ATTRIBUTE_ALIGNED(64)
+  iree_uk_int32_t acc_tile[iree_uk_mmt4d_tile_generic_max_bytes /
+                           sizeof(iree_uk_int32_t)];
+  char* out_tile_row = params->out_buffer;
+  const char* lhs_panel = params->lhs_buffer;
+  iree_uk_int32_t acc_tile_size = (M0 * N0) << acc_elem_size_log2;
+  iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
+  iree_uk_ssize_t lhs_panel_stride = params->lhs_stride << lhs_elem_size_log2;
+  iree_uk_ssize_t rhs_panel_stride =
+      iree_uk_type_size_of_count(rhs_type, params->rhs_stride);
+  iree_uk_ssize_t out_stride = params->out_stride << out_elem_size_log2;
+  for (iree_uk_int32_t i = 0; i < M; ++i) {
+    char* out_tile = out_tile_row;
+    const char* rhs_panel = params->rhs_buffer;
+    for (iree_uk_int32_t j = 0; j < N; ++j) {
+      const float* scales = rhs_quant->scales + j * N0;
+      const iree_uk_int8_t* zero_points =
+          rhs_quant->zero_points ? rhs_quant->zero_points + j * N0 : 0;
+      // With an epilogue, accumulate into acc_tile as in
+      // iree_uk_mmt4d_using_tile_func_with_epilogue.
+      void* dst_tile = epilogue ? (void*)acc_tile : (void*)out_tile;
+      if (epilogue && accumulate) {
+        iree_uk_memcpy(acc_tile, out_tile, acc_tile_size);
+      }
+      if (K) {
+        tile_func(dst_tile, lhs_panel, rhs_panel, scales, zero_points, K,
+                  params->flags, params);
+      } else if (!accumulate) {
+        iree_uk_memset(dst_tile, 0, acc_tile_size);
+      }
+      if (epilogue) epilogue_func(params, acc_tile, out_tile, j * N0);
+      out_tile += out_tile_size;
+      rhs_panel += rhs_panel_stride;
+    }
+    out_tile_row += out_stride;
+    lhs_panel += lhs_panel_stride;
+  }
+}
+
+// Variant of iree_uk_mmt4d_using_tile_func for a block-sparse RHS, also
+// applying the epilogue if any. Each output tile accumulates the runs of
+// consecutive K indices among the nonzero RHS tiles of its panel, one
+// tile_func call per run, and is zeroed if the panel has no nonzero tile. The
+// loops are not blocked, as the nonzero tiles of a block are not known ahead.
+static void iree_uk_mmt4d_using_sparse_tile_func(
+    const iree_uk_mmt4d_params_t* params, iree_uk_mmt4d_tile_func_t tile_func) {
+  const iree_uk_int32_t M = params->M;
+  const iree_uk_int32_t N = params->N;
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_int16_t K0 = params->K0;
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
+  const iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_mmt4d_epilogue_t* epilogue = params->epilogue;
+  const iree_uk_type_t out_type = epilogue ? epilogue->out_type : acc_type;
+  const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
+  const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
+  const iree_uk_int16_t acc_elem_size_log2 = iree_uk_type_size_log2(acc_type);
+  const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
+  const bool accumulate = params->flags & IREE_UK_FLAG_ACCUMULATE;
+  const iree_uk_int32_t* panel_offsets = params->rhs_sparsity->panel_offsets;
+  const iree_uk_int32_t* k_indices = params->rhs_sparsity->k_indices;
+  iree_uk_mmt4d_epilogue_func_t epilogue_func =
+      epilogue ? iree_uk_mmt4d_select_epilogue_func(params) : 0;
+  IREE_UK_ATTRIBUTE_ALIGNED(64)
+  iree_uk_int32_t acc_tile[iree_uk_mmt4d_tile_generic_max_bytes /
+                           sizeof(iree_uk_int32_t)];
+  char* out_tile_row = params->out_buffer;
+  const char* lhs_panel = params->lhs_buffer;
+  iree_uk_int32_t acc_tile_size = (M0 * N0) << acc_elem_size_log2;
+  iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
+  iree_uk_ssize_t lhs_tile_size = (M0 * K0) << lhs_elem_size_log2;
+  iree_uk_ssize_t rhs_tile_size = (N0 * K0) << rhs_elem_size_log2;
+  iree_uk_ssize_t lhs_panel_stride = params->lhs_stride << lhs_elem_size_log2;
+  iree_uk_ssize_t out_stride = params->out_stride << out_elem_size_log2;
+  for (iree_uk_int32_t i = 0; i < M; ++i) {
+    char* out_tile = out_tile_row;
+    for (iree_uk_int32_t j = 0; j < N; ++j) {
+      // With an epilogue, accumulate into acc_tile as in
+      // iree_uk_mmt4d_using_tile_func_with_epilogue.
+      void* dst_tile = epilogue ? (void*)acc_tile : (void*)out_tile;
+      if (epilogue && accumulate) {
+        iree_uk_memcpy(acc_tile, out_tile, acc_tile_size);
+      }
+      iree_uk_uint32_t flags = params->flags;
+      iree_uk_int32_t t_end = panel_offsets[j + 1];
+      for (iree_uk_int32_t t = panel_offsets[j]; t < t_end;) {
+        iree_uk_int32_t k = k_indices[t];
+        iree_uk_int32_t run = 1;
+        while (t + run < t_end && k_indices[t + run] == k + run) ++run;
+        const char* rhs_tile =
+            (const char*)params->rhs_buffer + t * rhs_tile_size;
+        tile_func(dst_tile, lhs_panel + k * lhs_tile_size, rhs_tile, run,
+                  flags, params);
+        flags |= IREE_UK_FLAG_ACCUMULATE;
+        t += run;
+      }
+      if (!(flags & IREE_UK_FLAG_ACCUMULATE)) {
+        iree_uk_memset(dst_tile, 0, acc_tile_size);
+      }
+      if (epilogue) epilogue_func(params, acc_tile, out_tile, j * N0);
+      out_tile += out_tile_size;
+    }
+    out_tile_row += out_stride;
+    lhs_panel += lhs_panel_stride;
+  }
+}
+
 // Helper for early-return path when K==0 and we just need to clear the output.
 static void iree_uk_mmt4d_zero_out(const iree_uk_mmt4d_params_t* params) {
   iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
@@ -94,7 +500,8 @@ static bool iree_uk_mmt4d_early(const iree_uk_mmt4d_params_t* params) {
   if (params->M == 0 || params->N == 0) {
     return true;
   }
-  if (params->K == 0) {
+  // With an epilogue the K==0 case still needs the epilogue applied.
+  if (params->K == 0 && !params->epilogue) {
     if (params->flags & IREE_UK_FLAG_ACCUMULATE) {
       // Nothing to do!
     } else {
@@ -108,6 +515,17 @@ static bool iree_uk_mmt4d_early(const iree_uk_mmt4d_params_t* params) {
   return false;
 }
 
+// Runs the outer loops matching |params| with |tile_func|, as selected by
+// iree_uk_mmt4d_select_tile_func. Not used for the types with a quantized RHS.
+static void iree_uk_mmt4d_using_selected_tile_func(
+    const iree_uk_mmt4d_params_t* params, iree_uk_mmt4d_tile_func_t tile_func) {
+  if (params->epilogue) {
+    iree_uk_mmt4d_using_tile_func_with_epilogue(params, tile_func);
+  } else {
+    iree_uk_mmt4d_using_tile_func(params, tile_func);
+  }
+}
+
 IREE_UK_EXPORT void iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params) {
   iree_uk_mmt4d_validate(params);
 
@@ -116,8 +534,64 @@ IREE_UK_EXPORT void iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params) {
   // targets that want to handle the entire loop nest in target-specific code.
   if (iree_uk_mmt4d_early(params)) return;
 
+  if (params->rhs_quant) {
+    iree_uk_mmt4d_using_quant_tile_func(
+        params, iree_uk_mmt4d_select_quant_tile_func(params));
+    return;
+  }
+
+  if (params->rhs_sparsity) {
+    iree_uk_mmt4d_using_sparse_tile_func(
+        params, iree_uk_mmt4d_select_tile_func(params));
+    return;
+  }
+
   // Select a target-specific tile_func (inner loop on K, computing one M0xN0
   // tile) and use that with generic outer loops.
-  iree_uk_mmt4d_tile_func_t tile_func = iree_uk_mmt4d_select_tile_func(params);
-  iree_uk_mmt4d_using_tile_func(params, tile_func);
+  iree_uk_mmt4d_using_selected_tile_func(
+      params, iree_uk_mmt4d_select_tile_func(params));
+}
+
+static void iree_uk_batch_mmt4d_validate(
+    const iree_uk_batch_mmt4d_params_t* params) {
+#ifdef IREE_UK_ENABLE_ASSERTS
+  iree_uk_mmt4d_validate(&params->mmt4d);
+  IREE_UK_ASSERT(!params->mmt4d.rhs_quant);
+  IREE_UK_ASSERT(!params->mmt4d.rhs_sparsity);
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(params->batch_size, 31));
+#endif  // IREE_UK_ENABLE_ASSERTS
+}
+
+IREE_UK_EXPORT void iree_uk_batch_mmt4d(
+    const iree_uk_batch_mmt4d_params_t* params) {
+  iree_uk_batch_mmt4d_validate(params);
+
+  iree_uk_mmt4d_params_t mmt4d_params = params->mmt4d;
+  if (params->batch_size == 0 || mmt4d_params.M == 0 || mmt4d_params.N == 0) {
+    return;
+  }
+  const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_params.type);
+  const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_params.type);
+  const iree_uk_type_t out_type =
+      mmt4d_params.epilogue ? mmt4d_params.epilogue->out_type
+                            : iree_uk_mmt4d_out_type(mmt4d_params.type);
+  iree_uk_ssize_t lhs_batch_stride =
+      params->lhs_batch_stride << iree_uk_type_size_log2(lhs_type);
+  iree_uk_ssize_t rhs_batch_stride =
+      params->rhs_batch_stride << iree_uk_type_size_log2(rhs_type);
+  iree_uk_ssize_t out_batch_stride =
+      params->out_batch_stride << iree_uk_type_size_log2(out_type);
+  // The tile function only depends on the parameters shared by all batches.
+  iree_uk_mmt4d_tile_func_t tile_func =
+      iree_uk_mmt4d_select_tile_func(&mmt4d_params);
+  for (iree_uk_ssize_t b = 0; b < params->batch_size; ++b) {
+    if (!iree_uk_mmt4d_early(&mmt4d_params)) {
+      iree_uk_mmt4d_using_selected_tile_func(&mmt4d_params, tile_func);
+    }
+    mmt4d_params.lhs_buffer =
+        (const char*)mmt4d_params.lhs_buffer + lhs_batch_stride;
+    mmt4d_params.rhs_buffer =
+        (const char*)mmt4d_params.rhs_buffer + rhs_batch_stride;
+    mmt4d_params.out_buffer = (char*)mmt4d_params.out_buffer + out_batch_stride;
+  }
 }
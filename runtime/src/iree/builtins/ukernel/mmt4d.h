@@ -18,8 +18,28 @@ typedef enum iree_uk_mmt4d_type_t {
       IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_32, FLOAT_32, FLOAT_32),
   iree_uk_mmt4d_type_i8i8i32 =
       IREE_UK_TIE_3_TYPES_LITERAL(INT_8, INT_8, INT_32),
+  iree_uk_mmt4d_type_f16f16f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, FLOAT_16, FLOAT_32),
+  iree_uk_mmt4d_type_f16f16f16 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, FLOAT_16, FLOAT_16),
+  iree_uk_mmt4d_type_bf16bf16f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(BFLOAT_16, BFLOAT_16, FLOAT_32),
+  iree_uk_mmt4d_type_bf16bf16bf16 =
+      IREE_UK_TIE_3_TYPES_LITERAL(BFLOAT_16, BFLOAT_16, BFLOAT_16),
+  iree_uk_mmt4d_type_i8i4f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(INT_8, INT_4, FLOAT_32),
+  iree_uk_mmt4d_type_f16i4f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, INT_4, FLOAT_32),
 } iree_uk_mmt4d_type_t;
 
+// The 16-bit float types accumulate in f32 within a tile. Cases with a 16-bit
+// float output type round the accumulators to the output type only once when
+// storing the tile, after all K iterations.
+//
+// The types with an INT_4 RHS are for weight-only quantization and require
+// rhs_quant (see iree_uk_mmt4d_rhs_quant_t). Each RHS tile holds its N0 * K0
+// elements two per byte, so N0 * K0 must be even.
+
 static inline iree_uk_type_t iree_uk_mmt4d_lhs_type(iree_uk_mmt4d_type_t type) {
   return iree_uk_untie_type(0, type);
 }
@@ -32,6 +52,84 @@ static inline iree_uk_type_t iree_uk_mmt4d_out_type(iree_uk_mmt4d_type_t type) {
   return iree_uk_untie_type(2, type);
 }
 
+// Optional epilogue fused into a mmt4d operation. It is applied to each
+// accumulator tile after its last K iteration and before it is stored to the
+// output, instead of in a separate pass reading and writing the whole output.
+//
+// For each element of the output, with c its column in the unpacked output
+// (i.e. its output channel, in [0, N * N0)), the epilogue computes:
+//   1. If |bias| is not NULL: acc += bias[c], in the accumulator type.
+//   2. If |out_type| is INT_8 (requantization, i8i8i32 only):
+//        acc = round_to_nearest_even((float)acc * scale) + zero_point
+//      where scale is scales[c] if |per_channel_scales| is set or scales[0].
+//   3. If IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP is set:
+//        acc = min(max(acc, clamp_min), clamp_max)
+//      For INT_8 outputs the result is always clamped to [-128, 127]. ReLU is
+//      clamp_min == zero point and ReLU6 additionally sets clamp_max to the
+//      quantized value of 6.
+//   4. Stores acc as |out_type|.
+typedef struct iree_uk_mmt4d_epilogue_t {
+  // Bitfield of IREE_UK_MMT4D_EPILOGUE_FLAG_*.
+  iree_uk_uint32_t flags;
+  // Element type of the output buffer: either the out type of the mmt4d type
+  // (the accumulator type) or INT_8 when requantizing i8i8i32 accumulators.
+  iree_uk_type_t out_type;
+  // Optional per-output-channel bias of N * N0 accumulator-typed values.
+  const void* bias;
+  // Requantization scales: N * N0 values if |per_channel_scales| or else 1.
+  const float* scales;
+  bool per_channel_scales;
+  // Requantization zero point added after scaling.
+  iree_uk_int32_t zero_point;
+  // Clamp bounds used with IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP. Integer outputs
+  // use the i32 bounds and float outputs use the f32 bounds.
+  iree_uk_int32_t clamp_min_i32;
+  iree_uk_int32_t clamp_max_i32;
+  float clamp_min_f32;
+  float clamp_max_f32;
+} iree_uk_mmt4d_epilogue_t;
+
+// Clamps the result to the epilogue clamp bounds.
+#define IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP 0x1u
+
+// Group-wise quantization of an INT_4 RHS. The RHS element q at row k (in
+// [0, K * K0)) and column c (in [0, N * N0)) of the unpacked RHS stands for
+//   (q - zero_points[g * N * N0 + c]) * scales[g * N * N0 + c]
+// where g = k / group_size is its quantization group.
+//
+// The i8i4f32 case accumulates the integer products of each group in i32 and
+// then adds the i32 sums times the group scales to the f32 accumulators. The
+// f16i4f32 case dequantizes the RHS elements to f32 before multiplying them.
+//
+// Unsigned 4-bit weights q_u with zero points z_u in [0, 15] are expressed as
+// q = q_u - 8 and zero point z_u - 8.
+typedef struct iree_uk_mmt4d_rhs_quant_t {
+  // Number of consecutive rows of the unpacked RHS sharing scales and zero
+  // points. Must be a multiple of K0.
+  iree_uk_int32_t group_size;
+  // ceil(K * K0 / group_size) * N * N0 values.
+  const float* scales;
+  // Optional, NULL means that all zero points are 0. Same shape as |scales|.
+  const iree_uk_int8_t* zero_points;
+} iree_uk_mmt4d_rhs_quant_t;
+
+// Block sparsity of the RHS at the granularity of its N0xK0 tiles, for weights
+// pruned in blocks that are multiples of the tile. Only the nonzero tiles are
+// stored, contiguously in |rhs_buffer| and panel by panel: the nonzero tiles of
+// RHS panel j (in [0, N)) are tiles panel_offsets[j] to panel_offsets[j+1] - 1
+// and tile t is at K index k_indices[t]. The K indices increase within a panel.
+//
+// The zero tiles are skipped along with the multiply-adds and LHS loads that
+// they would take. Runs of consecutive K indices go to the tile function in
+// one call. Finer-grained sparsity that leaves no whole tile zero, such as 2:4
+// structured sparsity, gains nothing here and should use the dense layout.
+typedef struct iree_uk_mmt4d_rhs_sparsity_t {
+  // N + 1 offsets, in units of tiles, of the nonzero tiles of each RHS panel.
+  const iree_uk_int32_t* panel_offsets;
+  // K index of each nonzero tile, panel_offsets[N] values.
+  const iree_uk_int32_t* k_indices;
+} iree_uk_mmt4d_rhs_sparsity_t;
+
 // Parameters for a mmt4d operation.
 typedef struct iree_uk_mmt4d_params_t {
   iree_uk_mmt4d_type_t type;
@@ -49,8 +147,35 @@ typedef struct iree_uk_mmt4d_params_t {
   const void* rhs_buffer;
   void* out_buffer;
   const iree_uk_uint64_t* cpu_data;
+  // Optional epilogue, NULL if none. When set, |out_buffer| and |out_stride|
+  // are in units of the epilogue out_type. IREE_UK_FLAG_ACCUMULATE is only
+  // supported if that is the accumulator type.
+  const iree_uk_mmt4d_epilogue_t* epilogue;
+  // Quantization of the RHS, required for the types with an INT_4 RHS and NULL
+  // otherwise. |rhs_stride| is still in units of RHS elements.
+  const iree_uk_mmt4d_rhs_quant_t* rhs_quant;
+  // Optional block sparsity of the RHS, NULL if the RHS is dense. When set,
+  // |rhs_stride| is unused. Not supported with |rhs_quant|. Cases with a
+  // 16-bit float output type round the accumulators once per run of nonzero
+  // tiles instead of once per tile.
+  const iree_uk_mmt4d_rhs_sparsity_t* rhs_sparsity;
 } iree_uk_mmt4d_params_t;
 
+// Parameters for a batch_mmt4d operation: |batch_size| mmt4d operations
+// sharing all the |mmt4d| parameters except the buffers. Batch b uses the
+// buffers of |mmt4d| offset by b times the batch strides, which are in units
+// of elements like the other strides. Validation and tile function selection
+// happen once for the whole batch. RHS quantization and sparsity are not
+// supported, as the scales and the sparsity metadata would need their own
+// batch strides.
+typedef struct iree_uk_batch_mmt4d_params_t {
+  iree_uk_mmt4d_params_t mmt4d;
+  iree_uk_ssize_t batch_size;
+  iree_uk_ssize_t lhs_batch_stride;
+  iree_uk_ssize_t rhs_batch_stride;
+  iree_uk_ssize_t out_batch_stride;
+} iree_uk_batch_mmt4d_params_t;
+
 // Function pointer type for tile functions, i.e. typically architecture
 // specific functions computing one M0xN0 tile of the output matrix, i.e.
 // the inner-most loop of the matmul, i.e. the thing that we should actually
@@ -74,6 +199,25 @@ typedef void (*iree_uk_mmt4d_tile_func_t)(
             iree_uk_int32_t K, iree_uk_uint32_t flags,                    \
             const iree_uk_mmt4d_params_t* params);
 
+// Function pointer type for the tile functions of the types with a quantized
+// RHS. |scales| and |zero_points| point to the rhs_quant values of the first
+// group for the first column of the tile; those of the next group are
+// params->N * params->N0 values further. |zero_points| may be NULL. Only
+// called with the whole K range, so that the tile starts at group 0.
+typedef void (*iree_uk_mmt4d_quant_tile_func_t)(
+    void* /*out_tile*/, const void* /*lhs_panel*/, const void* /*rhs_panel*/,
+    const float* /*scales*/, const iree_uk_int8_t* /*zero_points*/,
+    iree_uk_int32_t /*K*/, iree_uk_uint32_t /*flags*/,
+    const iree_uk_mmt4d_params_t* /*params*/);
+
+// Quantized tile kernel declarations. Prototype matches
+// iree_uk_mmt4d_quant_tile_func_t.
+#define IREE_UK_MMT4D_QUANT_TILE_FUNC_DECL(NAME)                          \
+  void NAME(void* out_tile, const void* lhs_panel, const void* rhs_panel, \
+            const float* scales, const iree_uk_int8_t* zero_points,       \
+            iree_uk_int32_t K, iree_uk_uint32_t flags,                    \
+            const iree_uk_mmt4d_params_t* params);
+
 // In order to be helpful as a reference for future architecture-specific
 // kernels, the generic kernels are structured like an actual optimized kernel,
 // using an "accumulator tile" that in this case is a stack array (which would
@@ -95,6 +239,10 @@ enum { iree_uk_mmt4d_tile_generic_max_bytes = 4096 };
 // Main entry point.
 IREE_UK_EXPORT void iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params);
 
+// Batched entry point, equivalent to calling iree_uk_mmt4d on each batch.
+IREE_UK_EXPORT void iree_uk_batch_mmt4d(
+    const iree_uk_batch_mmt4d_params_t* params);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
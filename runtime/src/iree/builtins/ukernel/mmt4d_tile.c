@@ -8,6 +8,10 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+#elif defined(IREE_UK_ARCH_WASM_32)
+#include "iree/builtins/ukernel/arch/wasm_32/mmt4d_wasm_32.h"
 #endif
 
 // Generic implementation of matmul tile, i8*i8->i32 case.
@@ -82,6 +86,211 @@ static void iree_uk_mmt4d_tile_f32f32f32_generic(
   for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
 }
 
+// Converts the 16-bit float |value| of type |type| to f32.
+static inline float iree_uk_mmt4d_16bit_float_to_f32(iree_uk_uint16_t value,
+                                                     iree_uk_type_t type) {
+  return type == IREE_UK_TYPE_BFLOAT_16 ? iree_uk_bf16_to_f32(value)
+                                        : iree_uk_f16_to_f32(value);
+}
+
+// Generic implementation of matmul tile, 16-bit float inputs case. The output
+// is either f32 or the input type; |in_type| and |out_type| are constants in
+// each caller so that the type dispatch folds away.
+static inline void iree_uk_mmt4d_tile_16bit_float_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params, iree_uk_type_t in_type,
+    iree_uk_type_t out_type) {
+  const iree_uk_uint16_t* lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint16_t* rhs_panel = rhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  bool out_is_f32 = out_type == IREE_UK_TYPE_FLOAT_32;
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(float)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) {
+      acc[i] = out_is_f32 ? ((const float*)out_tile_untyped)[i]
+                          : iree_uk_mmt4d_16bit_float_to_f32(
+                                ((const iree_uk_uint16_t*)out_tile_untyped)[i],
+                                out_type);
+    }
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop.
+  for (iree_uk_ssize_t k = 0; k < K; ++k) {
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+          float lhs_val = iree_uk_mmt4d_16bit_float_to_f32(
+              lhs_panel[i0 * K0 + k0], in_type);
+          float rhs_val = iree_uk_mmt4d_16bit_float_to_f32(
+              rhs_panel[j0 * K0 + k0], in_type);
+          acc[i0 * N0 + j0] += lhs_val * rhs_val;
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_panel += N0 * K0;
+  }
+  // Store the local accumulator tile to the destination, rounding to a 16-bit
+  // output type once here.
+  if (out_is_f32) {
+    for (int i = 0; i < M0 * N0; ++i) ((float*)out_tile_untyped)[i] = acc[i];
+  } else if (out_type == IREE_UK_TYPE_BFLOAT_16) {
+    iree_uk_uint16_t* out_tile = out_tile_untyped;
+    for (int i = 0; i < M0 * N0; ++i) out_tile[i] = iree_uk_f32_to_bf16(acc[i]);
+  } else {
+    iree_uk_uint16_t* out_tile = out_tile_untyped;
+    for (int i = 0; i < M0 * N0; ++i) out_tile[i] = iree_uk_f32_to_f16(acc[i]);
+  }
+}
+
+static void iree_uk_mmt4d_tile_f16f16f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16bit_float_generic(out_tile, lhs_panel, rhs_panel, K,
+                                         flags, params, IREE_UK_TYPE_FLOAT_16,
+                                         IREE_UK_TYPE_FLOAT_32);
+}
+
+static void iree_uk_mmt4d_tile_f16f16f16_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16bit_float_generic(out_tile, lhs_panel, rhs_panel, K,
+                                         flags, params, IREE_UK_TYPE_FLOAT_16,
+                                         IREE_UK_TYPE_FLOAT_16);
+}
+
+static void iree_uk_mmt4d_tile_bf16bf16f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16bit_float_generic(out_tile, lhs_panel, rhs_panel, K,
+                                         flags, params, IREE_UK_TYPE_BFLOAT_16,
+                                         IREE_UK_TYPE_FLOAT_32);
+}
+
+static void iree_uk_mmt4d_tile_bf16bf16bf16_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16bit_float_generic(out_tile, lhs_panel, rhs_panel, K,
+                                         flags, params, IREE_UK_TYPE_BFLOAT_16,
+                                         IREE_UK_TYPE_BFLOAT_16);
+}
+
+// Generic implementation of matmul tile, i8*i4->f32 case with a quantized RHS.
+// The integer products of each quantization group are accumulated in i32,
+// then scaled and added to the f32 accumulators.
+static void iree_uk_mmt4d_quant_tile_i8i4f32_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel, const float* scales,
+    const iree_uk_int8_t* zero_points, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* out_tile = out_tile_untyped;
+  const iree_uk_int8_t* lhs_panel = lhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  iree_uk_int32_t group_K = params->rhs_quant->group_size / K0;
+  iree_uk_ssize_t group_stride = params->N * N0;
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  iree_uk_int32_t group_acc[iree_uk_mmt4d_tile_generic_max_bytes /
+                            sizeof(iree_uk_int32_t)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Index of the first INT_4 element of the current RHS tile.
+  iree_uk_ssize_t rhs_index = 0;
+  // Accumulation loop, one quantization group at a time.
+  for (iree_uk_int32_t k_group = 0; k_group < K; k_group += group_K) {
+    iree_uk_int32_t k_end = iree_uk_ssize_clamp(k_group + group_K, 0, K);
+    for (int i = 0; i < M0 * N0; ++i) group_acc[i] = 0;
+    for (iree_uk_int32_t k = k_group; k < k_end; ++k) {
+      for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+          iree_uk_int32_t zero_point = zero_points ? zero_points[j0] : 0;
+          for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+            iree_uk_int32_t lhs_val_int32 = lhs_panel[i0 * K0 + k0];
+            iree_uk_int32_t rhs_val_int32 =
+                iree_uk_int4_load(rhs_panel, rhs_index + j0 * K0 + k0) -
+                zero_point;
+            group_acc[i0 * N0 + j0] += lhs_val_int32 * rhs_val_int32;
+          }
+        }
+      }
+      lhs_panel += M0 * K0;
+      rhs_index += N0 * K0;
+    }
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        acc[i0 * N0 + j0] += scales[j0] * (float)group_acc[i0 * N0 + j0];
+      }
+    }
+    scales += group_stride;
+    if (zero_points) zero_points += group_stride;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
+// Generic implementation of matmul tile, f16*i4->f32 case with a quantized
+// RHS. The RHS elements are dequantized to f32 before the multiplication.
+static void iree_uk_mmt4d_quant_tile_f16i4f32_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel, const float* scales,
+    const iree_uk_int8_t* zero_points, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* out_tile = out_tile_untyped;
+  const iree_uk_uint16_t* lhs_panel = lhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  iree_uk_int32_t group_K = params->rhs_quant->group_size / K0;
+  iree_uk_ssize_t group_stride = params->N * N0;
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Index of the first INT_4 element of the current RHS tile.
+  iree_uk_ssize_t rhs_index = 0;
+  // Accumulation loop.
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    if (k && k % group_K == 0) {
+      scales += group_stride;
+      if (zero_points) zero_points += group_stride;
+    }
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        iree_uk_int32_t zero_point = zero_points ? zero_points[j0] : 0;
+        for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+          float lhs_val = iree_uk_f16_to_f32(lhs_panel[i0 * K0 + k0]);
+          float rhs_val =
+              (float)(iree_uk_int4_load(rhs_panel, rhs_index + j0 * K0 + k0) -
+                      zero_point) *
+              scales[j0];
+          acc[i0 * N0 + j0] += lhs_val * rhs_val;
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_index += N0 * K0;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
 static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
     const iree_uk_mmt4d_params_t* params) {
   switch (params->type) {
@@ -89,6 +298,14 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
       return iree_uk_mmt4d_tile_f32f32f32_generic;
     case iree_uk_mmt4d_type_i8i8i32:
       return iree_uk_mmt4d_tile_i8i8i32_generic;
+    case iree_uk_mmt4d_type_f16f16f32:
+      return iree_uk_mmt4d_tile_f16f16f32_generic;
+    case iree_uk_mmt4d_type_f16f16f16:
+      return iree_uk_mmt4d_tile_f16f16f16_generic;
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      return iree_uk_mmt4d_tile_bf16bf16f32_generic;
+    case iree_uk_mmt4d_type_bf16bf16bf16:
+      return iree_uk_mmt4d_tile_bf16bf16bf16_generic;
     default:
       // shouldn't happen, validated earlier.
       IREE_UK_ASSUME_UNREACHABLE;
@@ -100,6 +317,10 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
     const iree_uk_mmt4d_params_t* params) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_mmt4d_select_tile_func_arm_64(params);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_mmt4d_select_tile_func_x86_64(params);
+#elif defined(IREE_UK_ARCH_WASM_32)
+  return iree_uk_mmt4d_select_tile_func_wasm_32(params);
 #endif
   return 0;
 }
@@ -111,3 +332,35 @@ iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func(
   if (arch_tile_func) return arch_tile_func;
   return iree_uk_mmt4d_select_tile_func_generic(params);
 }
+
+static iree_uk_mmt4d_quant_tile_func_t
+iree_uk_mmt4d_select_quant_tile_func_generic(
+    const iree_uk_mmt4d_params_t* params) {
+  switch (params->type) {
+    case iree_uk_mmt4d_type_i8i4f32:
+      return iree_uk_mmt4d_quant_tile_i8i4f32_generic;
+    case iree_uk_mmt4d_type_f16i4f32:
+      return iree_uk_mmt4d_quant_tile_f16i4f32_generic;
+    default:
+      // shouldn't happen, validated earlier.
+      IREE_UK_ASSUME_UNREACHABLE;
+      return 0;
+  }
+}
+
+static iree_uk_mmt4d_quant_tile_func_t
+iree_uk_mmt4d_select_quant_tile_func_arch(
+    const iree_uk_mmt4d_params_t* params) {
+#if defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_mmt4d_select_quant_tile_func_x86_64(params);
+#endif
+  return 0;
+}
+
+iree_uk_mmt4d_quant_tile_func_t iree_uk_mmt4d_select_quant_tile_func(
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_quant_tile_func_t arch_tile_func =
+      iree_uk_mmt4d_select_quant_tile_func_arch(params);
+  if (arch_tile_func) return arch_tile_func;
+  return iree_uk_mmt4d_select_quant_tile_func_generic(params);
+}
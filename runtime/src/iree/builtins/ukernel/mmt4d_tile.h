@@ -13,4 +13,9 @@
 iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func(
     const iree_uk_mmt4d_params_t* params);
 
+// Returns the quantized tile function to use for the mmt4d op with the given
+// params, which must have a quantized RHS.
+iree_uk_mmt4d_quant_tile_func_t iree_uk_mmt4d_select_quant_tile_func(
+    const iree_uk_mmt4d_params_t* params);
+
 #endif  // IREE_BUILTINS_UKERNEL_MMT4D_TILE_H_
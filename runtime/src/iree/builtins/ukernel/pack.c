@@ -59,7 +59,10 @@ static void iree_uk_pack_validate(const iree_uk_pack_params_t* params) {
   IREE_UK_ASSERT(!(params->flags & ~allflags));
   IREE_UK_ASSERT(params->type == iree_uk_pack_type_f32f32 ||
                  params->type == iree_uk_pack_type_i8i8 ||
-                 params->type == iree_uk_pack_type_i32i32);
+                 params->type == iree_uk_pack_type_i32i32 ||
+                 params->type == iree_uk_pack_type_f16f16 ||
+                 params->type == iree_uk_pack_type_bf16bf16 ||
+                 params->type == iree_uk_pack_type_i4i4);
   IREE_UK_ASSERT(params->in_stride0 >= 0);
   IREE_UK_ASSERT(params->out_stride0 >= 0);
   IREE_UK_ASSERT(params->in_size0 >= 0);
@@ -86,13 +89,20 @@ static void iree_uk_pack_validate(const iree_uk_pack_params_t* params) {
   // IREE_UK_ASSERT((outer_size0 - 1) * tile_size0 < params->in_size0);
   // IREE_UK_ASSERT((outer_size1 - 1) * tile_size1 < params->in_size1);
 
+  iree_uk_type_t elem_type = iree_uk_pack_in_type(params->type);
+  if (elem_type == IREE_UK_TYPE_INT_4) {
+    // Output tiles and rows must start on byte boundaries.
+    IREE_UK_ASSERT(!(params->out_stride0 & 1));
+    IREE_UK_ASSERT(!((params->out_size2 * params->out_size3) & 1));
+    return;
+  }
+
   // Initialize a padding helper, just to get the assertion that the tile size
   // does not exceed the internal temporary buffer size, without having to
   // duplicate this arithmetic. Generally, we want to hit all failure modes
   // in the validation function so that the subsequent ukernel code can be
   // treated as infallible.
   iree_uk_pack_tmpbuf_helper_t padding_helper;
-  iree_uk_type_t elem_type = iree_uk_pack_in_type(params->type);
   iree_uk_ssize_t elem_size = iree_uk_type_size(elem_type);
   iree_uk_pack_tmpbuf_helper_t_init(tile_size0, tile_size1, elem_size,
                                     params->padding_value, &padding_helper);
@@ -227,11 +237,52 @@ static void iree_uk_pack_using_tile_func(const iree_uk_pack_params_t* params,
   }
 }
 
+// Implementation of the INT_4 case, one element at a time. The tile functions
+// work on whole bytes, which would hold elements of two different rows or
+// columns of the input.
+static void iree_uk_pack_int4(const iree_uk_pack_params_t* params) {
+  bool transpose_outer = params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_OUTER;
+  bool transpose_inner = params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER;
+  iree_uk_ssize_t tile_size0 =
+      transpose_inner ? params->out_size3 : params->out_size2;
+  iree_uk_ssize_t tile_size1 =
+      transpose_inner ? params->out_size2 : params->out_size3;
+  iree_uk_int32_t padding = *(const iree_uk_uint8_t*)params->padding_value;
+  iree_uk_ssize_t out_index = 0;
+  for (iree_uk_ssize_t out_i0 = 0; out_i0 < params->out_size0; ++out_i0) {
+    out_index = out_i0 * params->out_stride0;
+    for (iree_uk_ssize_t out_i1 = 0; out_i1 < params->out_size1; ++out_i1) {
+      iree_uk_ssize_t outer_i0 = transpose_outer ? out_i1 : out_i0;
+      iree_uk_ssize_t outer_i1 = transpose_outer ? out_i0 : out_i1;
+      for (iree_uk_ssize_t out_i2 = 0; out_i2 < params->out_size2; ++out_i2) {
+        for (iree_uk_ssize_t out_i3 = 0; out_i3 < params->out_size3;
+             ++out_i3) {
+          iree_uk_ssize_t in_i0 =
+              outer_i0 * tile_size0 + (transpose_inner ? out_i3 : out_i2);
+          iree_uk_ssize_t in_i1 =
+              outer_i1 * tile_size1 + (transpose_inner ? out_i2 : out_i3);
+          iree_uk_int32_t value =
+              in_i0 < params->in_size0 && in_i1 < params->in_size1
+                  ? iree_uk_int4_load(params->in_buffer,
+                                      in_i0 * params->in_stride0 + in_i1)
+                  : padding;
+          iree_uk_int4_store(params->out_buffer, out_index++, value);
+        }
+      }
+    }
+  }
+}
+
 IREE_UK_EXPORT void iree_uk_pack(const iree_uk_pack_params_t* params) {
   iree_uk_pack_validate(params);
 
   if (iree_uk_pack_early(params)) return;
 
+  if (iree_uk_pack_in_type(params->type) == IREE_UK_TYPE_INT_4) {
+    iree_uk_pack_int4(params);
+    return;
+  }
+
   // Select a target-specific tile_func and use that with generic outer loops.
   iree_uk_pack_tile_func_t tile_func = iree_uk_pack_select_tile_func(params);
   iree_uk_pack_using_tile_func(params, tile_func);
@@ -17,8 +17,18 @@ typedef enum iree_uk_pack_type_t {
   iree_uk_pack_type_f32f32 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_32, FLOAT_32),
   iree_uk_pack_type_i8i8 = IREE_UK_TIE_2_TYPES_LITERAL(INT_8, INT_8),
   iree_uk_pack_type_i32i32 = IREE_UK_TIE_2_TYPES_LITERAL(INT_32, INT_32),
+  iree_uk_pack_type_f16f16 = IREE_UK_TIE_2_TYPES_LITERAL(FLOAT_16, FLOAT_16),
+  iree_uk_pack_type_bf16bf16 =
+      IREE_UK_TIE_2_TYPES_LITERAL(BFLOAT_16, BFLOAT_16),
+  iree_uk_pack_type_i4i4 = IREE_UK_TIE_2_TYPES_LITERAL(INT_4, INT_4),
 } iree_uk_pack_type_t;
 
+// For INT_4 elements, which are stored two per byte (see iree_uk_int4_load),
+// strides and sizes are in units of elements, out_stride0 and
+// out_size2 * out_size3 must be even, and the padding value is the low nibble
+// of the byte at padding_value. This case is meant for packing weights ahead
+// of time and has no architecture-specific code.
+
 static inline iree_uk_type_t iree_uk_pack_in_type(iree_uk_pack_type_t type) {
   return iree_uk_untie_type(0, type);
 }
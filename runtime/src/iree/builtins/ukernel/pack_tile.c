@@ -8,6 +8,10 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/pack_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/pack_x86_64.h"
+#elif defined(IREE_UK_ARCH_WASM_32)
+#include "iree/builtins/ukernel/arch/wasm_32/pack_wasm_32.h"
 #endif
 
 static void iree_uk_pack_tile_generic_direct(
@@ -69,6 +73,10 @@ static iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_arch(
     const iree_uk_pack_params_t* params) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_pack_select_tile_func_arm_64(params);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_pack_select_tile_func_x86_64(params);
+#elif defined(IREE_UK_ARCH_WASM_32)
+  return iree_uk_pack_select_tile_func_wasm_32(params);
 #endif
   return 0;
 }
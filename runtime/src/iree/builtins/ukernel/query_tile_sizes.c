@@ -8,6 +8,10 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/query_tile_sizes_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/query_tile_sizes_x86_64.h"
+#elif defined(IREE_UK_ARCH_WASM_32)
+#include "iree/builtins/ukernel/arch/wasm_32/query_tile_sizes_wasm_32.h"
 #endif
 
 static bool iree_uk_query_tile_sizes_operation_is_matmul(
@@ -47,10 +51,36 @@ static bool iree_uk_query_matmul_tile_sizes_arch(
     iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_query_matmul_tile_sizes_arm_64(params, out_matmul_tile_sizes);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_query_matmul_tile_sizes_x86_64(params, out_matmul_tile_sizes);
+#elif defined(IREE_UK_ARCH_WASM_32)
+  return iree_uk_query_matmul_tile_sizes_wasm_32(params, out_matmul_tile_sizes);
 #endif
   return false;
 }
 
+static bool iree_uk_query_cache_sizes_arch(
+    const iree_uk_uint64_t* cpu_data,
+    iree_uk_cache_sizes_t* out_cache_sizes) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_query_cache_sizes_arm_64(cpu_data, out_cache_sizes);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_query_cache_sizes_x86_64(cpu_data, out_cache_sizes);
+#endif
+  return false;
+}
+
+iree_uk_cache_sizes_t iree_uk_query_cache_sizes(
+    const iree_uk_uint64_t* cpu_data) {
+  iree_uk_cache_sizes_t cache_sizes;
+  if (!iree_uk_query_cache_sizes_arch(cpu_data, &cache_sizes)) {
+    // Conservative values that hold for most CPUs with an L2 cache.
+    cache_sizes =
+        (iree_uk_cache_sizes_t){.l1 = 32 * 1024, .l2 = 256 * 1024, .l3 = 0};
+  }
+  return cache_sizes;
+}
+
 static void iree_uk_query_tile_sizes_2d_matmul(
     const iree_uk_query_tile_sizes_2d_params_t* params,
     iree_uk_query_tile_sizes_2d_out_params_t* out_params) {
@@ -42,6 +42,21 @@ typedef struct iree_uk_matmul_tile_sizes_t {
   int M, K, N;
 } iree_uk_matmul_tile_sizes_t;
 
+// Internal use only. Cache capacities in bytes available to a single thread,
+// used to block the outer loops of ukernels such as mmt4d. Shared caches are
+// given as the share of one core, as other threads run ukernels concurrently
+// on the other cores.
+typedef struct iree_uk_cache_sizes_t {
+  iree_uk_ssize_t l1;
+  iree_uk_ssize_t l2;
+  iree_uk_ssize_t l3;
+} iree_uk_cache_sizes_t;
+
+// Internal use only. Returns the cache capacities to block for on the CPU
+// described by |cpu_data|.
+iree_uk_cache_sizes_t iree_uk_query_cache_sizes(
+    const iree_uk_uint64_t* cpu_data);
+
 // Main entry point.
 IREE_UK_EXPORT void iree_uk_query_tile_sizes_2d(
     const iree_uk_query_tile_sizes_2d_params_t* params,
@@ -0,0 +1,148 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/reduction.h"
+
+#if defined(IREE_UK_ARCH_ARM_64)
+#include "iree/builtins/ukernel/arch/arm_64/reduction_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/reduction_x86_64.h"
+#endif
+
+// Like elementwise_impl.c.inc, the generic fallbacks use libm.
+#include <math.h>
+
+static void iree_uk_validate_row_params(const float* in_buffer,
+                                        iree_uk_ssize_t in_stride0,
+                                        float* out_buffer,
+                                        iree_uk_ssize_t out_stride0,
+                                        iree_uk_ssize_t size0,
+                                        iree_uk_ssize_t size1) {
+#ifdef IREE_UK_ENABLE_ASSERTS
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(size0, 31));
+  IREE_UK_ASSERT(IREE_UK_VALUE_IN_UNSIGNED_INT_RANGE(size1, 31));
+  IREE_UK_ASSERT(in_stride0 >= size1 || size0 <= 1);
+  IREE_UK_ASSERT(out_stride0 >= size1 || size0 <= 1);
+  // In-place operation is supported, but not partially overlapping rows.
+  IREE_UK_ASSERT((const float*)out_buffer != in_buffer ||
+                 out_stride0 == in_stride0);
+#endif  // IREE_UK_ENABLE_ASSERTS
+}
+
+//===----------------------------------------------------------------------===//
+// Softmax.
+//===----------------------------------------------------------------------===//
+
+static void iree_uk_softmax_row_generic(const float* in, float* out,
+                                        iree_uk_ssize_t size) {
+  // The running maximum starts at the lowest finite float rather than -inf so
+  // that rescaling the partial sum never computes exp(-inf - -inf).
+  float max = -IREE_UK_FLOAT32_MAX;
+  float sum = 0.0f;
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    float x = in[j];
+    if (x > max) {
+      sum *= expf(max - x);
+      max = x;
+    }
+    sum += expf(x - max);
+  }
+  float inv_sum = 1.0f / sum;
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    out[j] = expf(in[j] - max) * inv_sum;
+  }
+}
+
+static iree_uk_softmax_row_func_t iree_uk_softmax_select_row_func_arch(
+    const iree_uk_uint64_t* cpu_data) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_softmax_select_row_func_arm_64(cpu_data);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_softmax_select_row_func_x86_64(cpu_data);
+#else
+  return 0;
+#endif
+}
+
+static iree_uk_softmax_row_func_t iree_uk_softmax_select_row_func(
+    const iree_uk_uint64_t* cpu_data) {
+  iree_uk_softmax_row_func_t arch_row_func =
+      iree_uk_softmax_select_row_func_arch(cpu_data);
+  if (arch_row_func) return arch_row_func;
+  return iree_uk_softmax_row_generic;
+}
+
+IREE_UK_EXPORT void iree_uk_softmax(const iree_uk_softmax_params_t* params) {
+  iree_uk_validate_row_params(params->in_buffer, params->in_stride0,
+                              params->out_buffer, params->out_stride0,
+                              params->size0, params->size1);
+  if (params->size0 == 0 || params->size1 == 0) return;
+  iree_uk_softmax_row_func_t row_func =
+      iree_uk_softmax_select_row_func(params->cpu_data);
+  for (iree_uk_ssize_t i = 0; i < params->size0; ++i) {
+    row_func(params->in_buffer + i * params->in_stride0,
+             params->out_buffer + i * params->out_stride0, params->size1);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Layer normalization.
+//===----------------------------------------------------------------------===//
+
+static void iree_uk_layer_norm_row_generic(const float* in, float* out,
+                                           iree_uk_ssize_t size,
+                                           const float* gamma,
+                                           const float* beta, float epsilon) {
+  float mean = 0.0f;
+  float m2 = 0.0f;
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    float x = in[j];
+    float delta = x - mean;
+    mean += delta / (float)(j + 1);
+    m2 += delta * (x - mean);
+  }
+  float inv_stddev = 1.0f / sqrtf(m2 / (float)size + epsilon);
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    float y = (in[j] - mean) * inv_stddev;
+    if (gamma) y *= gamma[j];
+    if (beta) y += beta[j];
+    out[j] = y;
+  }
+}
+
+static iree_uk_layer_norm_row_func_t iree_uk_layer_norm_select_row_func_arch(
+    const iree_uk_uint64_t* cpu_data) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_layer_norm_select_row_func_arm_64(cpu_data);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_layer_norm_select_row_func_x86_64(cpu_data);
+#else
+  return 0;
+#endif
+}
+
+static iree_uk_layer_norm_row_func_t iree_uk_layer_norm_select_row_func(
+    const iree_uk_uint64_t* cpu_data) {
+  iree_uk_layer_norm_row_func_t arch_row_func =
+      iree_uk_layer_norm_select_row_func_arch(cpu_data);
+  if (arch_row_func) return arch_row_func;
+  return iree_uk_layer_norm_row_generic;
+}
+
+IREE_UK_EXPORT void iree_uk_layer_norm(
+    const iree_uk_layer_norm_params_t* params) {
+  iree_uk_validate_row_params(params->in_buffer, params->in_stride0,
+                              params->out_buffer, params->out_stride0,
+                              params->size0, params->size1);
+  if (params->size0 == 0 || params->size1 == 0) return;
+  iree_uk_layer_norm_row_func_t row_func =
+      iree_uk_layer_norm_select_row_func(params->cpu_data);
+  for (iree_uk_ssize_t i = 0; i < params->size0; ++i) {
+    row_func(params->in_buffer + i * params->in_stride0,
+             params->out_buffer + i * params->out_stride0, params->size1,
+             params->gamma, params->beta, params->epsilon);
+  }
+}
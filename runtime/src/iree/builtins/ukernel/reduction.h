@@ -0,0 +1,74 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_REDUCTION_H_
+#define IREE_BUILTINS_UKERNEL_REDUCTION_H_
+
+#include "iree/builtins/ukernel/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Row-wise normalizations of a size0 x size1 f32 matrix, reducing along
+// dimension 1. Each row is read twice: once to compute the statistics of the
+// row and once to write the normalized row. Strides are in units of elements.
+// The output may alias the input if both have the same stride.
+
+// Parameters for a softmax operation:
+//   out[i, j] = exp(in[i, j] - max_j in[i, j]) / sum_j exp(in[i, j] - max)
+// The maximum and the sum are computed in the same pass over the row ("online
+// softmax"), rescaling the partial sum whenever the running maximum grows.
+typedef struct iree_uk_softmax_params_t {
+  const float* in_buffer;
+  iree_uk_ssize_t in_stride0;
+  float* out_buffer;
+  iree_uk_ssize_t out_stride0;
+  iree_uk_ssize_t size0;
+  iree_uk_ssize_t size1;
+  const iree_uk_uint64_t* cpu_data;
+} iree_uk_softmax_params_t;
+
+// Parameters for a layer normalization operation:
+//   out[i, j] = (in[i, j] - mean) / sqrt(variance + epsilon) * gamma[j]
+//               + beta[j]
+// with the mean and the (biased) variance of row i computed in one pass with
+// Welford's algorithm.
+typedef struct iree_uk_layer_norm_params_t {
+  const float* in_buffer;
+  iree_uk_ssize_t in_stride0;
+  float* out_buffer;
+  iree_uk_ssize_t out_stride0;
+  iree_uk_ssize_t size0;
+  iree_uk_ssize_t size1;
+  // Optional size1 scale and bias values, NULL meaning 1 and 0 respectively.
+  const float* gamma;
+  const float* beta;
+  float epsilon;
+  const iree_uk_uint64_t* cpu_data;
+} iree_uk_layer_norm_params_t;
+
+// Function pointer types for the functions normalizing one row of |size|
+// elements, |size| > 0. Architecture-specific implementations are selected
+// at runtime based on cpu_data.
+typedef void (*iree_uk_softmax_row_func_t)(const float* in, float* out,
+                                           iree_uk_ssize_t size);
+typedef void (*iree_uk_layer_norm_row_func_t)(const float* in, float* out,
+                                              iree_uk_ssize_t size,
+                                              const float* gamma,
+                                              const float* beta,
+                                              float epsilon);
+
+// Main entry points.
+IREE_UK_EXPORT void iree_uk_softmax(const iree_uk_softmax_params_t* params);
+IREE_UK_EXPORT void iree_uk_layer_norm(
+    const iree_uk_layer_norm_params_t* params);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BUILTINS_UKERNEL_REDUCTION_H_
@@ -0,0 +1,166 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdlib.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/flags.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/testing/benchmark.h"
+
+IREE_FLAG(int64_t, batch_min_traversal_size, 1000000000,
+          "Minimum number of bytes to be traversed in each batch.");
+
+IREE_FLAG(
+    int64_t, working_set_size, 1000000,
+    "Number of bytes to be traversed by the benchmark workload (input and "
+    "output buffers together). Matrix shapes are computed accordingly.");
+
+// Row length of the benchmarked matrices. The number of rows is computed
+// from FLAG_working_set_size.
+#define IREE_ELEMENTWISE_BENCHMARK_SIZE1 256
+
+typedef struct iree_elementwise_benchmark_user_data_t {
+  // Exactly one of x32b_func, x32u_func is set.
+  iree_uk_x32b_2d_func_t x32b_func;
+  iree_uk_x32u_2d_func_t x32u_func;
+  const iree_uk_uint64_t* cpu_data;
+} iree_elementwise_benchmark_user_data_t;
+
+static iree_status_t iree_elementwise_benchmark(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_elementwise_benchmark_user_data_t* user_data =
+      benchmark_def->user_data;
+  int buffer_count = user_data->x32b_func ? 3 : 2;
+  iree_uk_ssize_t size1 = IREE_ELEMENTWISE_BENCHMARK_SIZE1;
+  iree_uk_ssize_t size0 = iree_max(
+      1, FLAG_working_set_size / (buffer_count * size1 * sizeof(float)));
+  iree_uk_ssize_t buffer_size = size0 * size1 * sizeof(float);
+  float* lhs_buffer = malloc(buffer_size);
+  float* rhs_buffer = malloc(buffer_size);
+  float* out_buffer = malloc(buffer_size);
+  // Positive, nonzero values in the domain of all the ops, so that no op
+  // takes a special-value path or divides by zero, whether the bits are
+  // interpreted as floats or as integers.
+  for (iree_uk_ssize_t i = 0; i < size0 * size1; ++i) {
+    lhs_buffer[i] = 1.0f + (i & 0xFF) / 256.0f;
+    rhs_buffer[i] = 1.0f + ((i * 7) & 0xFF) / 256.0f;
+    out_buffer[i] = 0.0f;
+  }
+  const iree_uk_uint32_t* lhs = (const iree_uk_uint32_t*)lhs_buffer;
+  const iree_uk_uint32_t* rhs = (const iree_uk_uint32_t*)rhs_buffer;
+  iree_uk_uint32_t* out = (iree_uk_uint32_t*)out_buffer;
+  iree_uk_int64_t total_iterations = 0;
+  iree_uk_int64_t batch_count =
+      (FLAG_batch_min_traversal_size + FLAG_working_set_size - 1) /
+      FLAG_working_set_size;
+  while (iree_benchmark_keep_running(benchmark_state,
+                                     /*batch_count=*/batch_count)) {
+    for (int i = 0; i < batch_count; ++i) {
+      if (user_data->x32b_func) {
+        user_data->x32b_func(lhs, 0, size1, 1, rhs, 0, size1, 1, out, 0, size1,
+                             1, size0, size1, user_data->cpu_data);
+      } else {
+        user_data->x32u_func(lhs, 0, size1, 1, out, 0, size1, 1, size0, size1,
+                             user_data->cpu_data);
+      }
+    }
+    total_iterations += batch_count;
+  }
+  // Report bytes per second, so that can be easily compared to known memory
+  // system performance metrics (e.g. RAM bandwidth, to tell whether this is
+  // memory-bound).
+  iree_benchmark_set_items_processed(
+      benchmark_state, total_iterations * buffer_count * buffer_size);
+  free(lhs_buffer);
+  free(rhs_buffer);
+  free(out_buffer);
+  return iree_ok_status();
+}
+
+static void iree_elementwise_benchmark_register(
+    const iree_elementwise_benchmark_user_data_t* user_data, const char* name) {
+  // Does this benchmark require an optional CPU feature?
+  if (user_data->cpu_data[0]) {
+    if ((iree_cpu_data_field(0) & user_data->cpu_data[0]) !=
+        user_data->cpu_data[0]) {
+      // The CPU does not meet this benchmark's requirements. The builtin
+      // would crash.
+      return;
+    }
+  }
+
+  // benchmark_def does not need to be static, it will be cloned.
+  const iree_benchmark_def_t benchmark_def = {
+      .flags = IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+      .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+      .minimum_duration_ns = 0,
+      .iteration_count = 0,
+      .run = iree_elementwise_benchmark,
+      .user_data = user_data,
+  };
+  iree_benchmark_register(IREE_SV(name), &benchmark_def);
+}
+
+#define ELEMENTWISE_BENCHMARK_REGISTER(_category, _opcode, _cpu_data_field_0, \
+                                       _label)                                \
+  do {                                                                        \
+    static const iree_uk_uint64_t local_cpu_data[IREE_CPU_DATA_FIELD_COUNT] = \
+        {_cpu_data_field_0};                                                  \
+    static const iree_elementwise_benchmark_user_data_t user_data = {         \
+        ._category##_func = iree_uk_##_category##_##_opcode##_2d,             \
+        .cpu_data = local_cpu_data,                                           \
+    };                                                                        \
+    iree_elementwise_benchmark_register(                                      \
+        &user_data, "iree_uk_" #_category "_" #_opcode "_" #_label);          \
+  } while (0)
+
+// A few representative ops: cheap float and integer arithmetic, integer
+// division, and the transcendental functions.
+#define ELEMENTWISE_BENCHMARK_REGISTER_OPS(_cpu_data_field_0, _label)     \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32b, addf, _cpu_data_field_0, _label);  \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32b, mulf, _cpu_data_field_0, _label);  \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32b, addi, _cpu_data_field_0, _label);  \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32b, divsi, _cpu_data_field_0, _label); \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32u, absf, _cpu_data_field_0, _label);  \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32u, expf, _cpu_data_field_0, _label);  \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32u, logf, _cpu_data_field_0, _label);  \
+  ELEMENTWISE_BENCHMARK_REGISTER(x32u, rsqrtf, _cpu_data_field_0, _label);
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage("elementwise_benchmark",
+                       "Benchmarks the elementwise microkernels.\n"
+                       "\n");
+
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
+  iree_benchmark_initialize(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+
+// ARM_64 benchmarks. NEON is part of the arm64 baseline, so there is no
+// generic code path to compare against.
+#if defined(IREE_UK_ARCH_ARM_64)
+
+  ELEMENTWISE_BENCHMARK_REGISTER_OPS(0, arm_64);
+
+#else
+
+  // Generic code paths, to get a sense of how slow generic code goes vs
+  // SIMD kernels.
+  ELEMENTWISE_BENCHMARK_REGISTER_OPS(0, generic);
+
+#if defined(IREE_UK_ARCH_X86_64)
+
+  ELEMENTWISE_BENCHMARK_REGISTER_OPS(
+      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA, x86_64_avx2_fma);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+#endif  // defined(IREE_UK_ARCH_ARM_64)
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -0,0 +1,351 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/testing/gtest.h"
+
+namespace {
+
+float AsFloat(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof f);
+  return f;
+}
+
+uint32_t AsBits(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof bits);
+  return bits;
+}
+
+// Returns the distance in ULPs between two floats, 0 if both are NaN.
+int64_t UlpDistance(float a, float b) {
+  if (std::isnan(a) || std::isnan(b)) {
+    return std::isnan(a) && std::isnan(b) ? 0 : INT64_MAX;
+  }
+  auto ordered = [](float f) {
+    int64_t i = (int32_t)AsBits(f);
+    return i < 0 ? INT32_MIN - i : i;
+  };
+  return std::abs(ordered(a) - ordered(b));
+}
+
+// How results are compared to the reference.
+enum class Compare {
+  // Bitwise equality.
+  kExact,
+  // Float equality within kMaxTranscendentalUlps.
+  kApproximate,
+};
+
+// Maximum error of the polynomial approximations of exp and log.
+constexpr int64_t kMaxTranscendentalUlps = 4;
+
+typedef uint32_t (*Generator)(std::mt19937& engine);
+
+uint32_t AnyBits(std::mt19937& engine) { return engine(); }
+
+uint32_t AnyFloat(std::mt19937& engine) {
+  return AsBits(std::uniform_real_distribution<float>(-1e3f, 1e3f)(engine));
+}
+
+uint32_t PositiveFloat(std::mt19937& engine) {
+  // Log-uniform so that all binades are covered.
+  return AsBits(
+      std::exp(std::uniform_real_distribution<float>(-80.f, 80.f)(engine)));
+}
+
+uint32_t ExpDomainFloat(std::mt19937& engine) {
+  return AsBits(std::uniform_real_distribution<float>(-87.f, 88.f)(engine));
+}
+
+uint32_t NonZeroFloat(std::mt19937& engine) {
+  float f;
+  do {
+    f = AsFloat(AnyFloat(engine));
+  } while (f == 0.f);
+  return AsBits(f);
+}
+
+uint32_t NonZeroInt(std::mt19937& engine) {
+  uint32_t i;
+  do {
+    // Vary the magnitude so that quotients are not mostly 0.
+    i = engine() >> std::uniform_int_distribution<int>(0, 31)(engine);
+    if (engine() & 1) i = 0u - i;
+  } while (i == 0 || i == 0xFFFFFFFFu);
+  return i;
+}
+
+uint32_t ShiftAmount(std::mt19937& engine) {
+  return std::uniform_int_distribution<uint32_t>(0, 31)(engine);
+}
+
+// Calls |test| with the CPU data disabling all architecture-specific code paths
+// and with the CPU data of this device.
+template <typename F>
+void ForEachCpuData(F test) {
+  static const iree_uk_uint64_t no_cpu_data[IREE_CPU_DATA_FIELD_COUNT] = {0};
+  test(no_cpu_data);
+  test((const iree_uk_uint64_t*)iree_cpu_data_fields());
+}
+
+struct Shape {
+  iree_uk_ssize_t size0;
+  iree_uk_ssize_t size1;
+  iree_uk_ssize_t stride1;
+};
+
+// Sizes around multiples of the vector widths, as well as strided rows that
+// don't use the row functions.
+const Shape kShapes[] = {
+    {1, 1, 1},  {1, 3, 1},  {2, 4, 1},   {3, 7, 1},  {1, 8, 1},
+    {2, 9, 1},  {4, 16, 1}, {3, 17, 1},  {2, 100, 1}, {1, 1, 2},
+    {3, 7, 2},  {2, 33, 3},
+};
+
+bool ElementsMatch(uint32_t actual, uint32_t expected, Compare compare) {
+  if (compare == Compare::kExact) return actual == expected;
+  return UlpDistance(AsFloat(actual), AsFloat(expected)) <=
+         kMaxTranscendentalUlps;
+}
+
+void TestX32b(iree_uk_x32b_2d_func_t func, uint32_t (*reference)(uint32_t,
+                                                                 uint32_t),
+              Generator lhs_generator, Generator rhs_generator,
+              Compare compare) {
+  std::mt19937 engine;
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    for (const Shape& shape : kShapes) {
+      // A row padding that isn't a multiple of the vector widths.
+      iree_uk_ssize_t stride0 = shape.size1 * shape.stride1 + 3;
+      iree_uk_ssize_t length = shape.size0 * stride0;
+      std::vector<uint32_t> lhs(length), rhs(length), out(length, 0);
+      for (iree_uk_ssize_t i = 0; i < length; ++i) {
+        lhs[i] = lhs_generator(engine);
+        rhs[i] = rhs_generator(engine);
+      }
+      ASSERT_EQ(0, func(lhs.data(), 0, stride0, shape.stride1, rhs.data(), 0,
+                        stride0, shape.stride1, out.data(), 0, stride0,
+                        shape.stride1, shape.size0, shape.size1, cpu_data));
+      for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+        for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+          iree_uk_ssize_t k = i * stride0 + j * shape.stride1;
+          uint32_t expected = reference(lhs[k], rhs[k]);
+          ASSERT_TRUE(ElementsMatch(out[k], expected, compare))
+              << "lhs=0x" << std::hex << lhs[k] << " rhs=0x" << rhs[k]
+              << " out=0x" << out[k] << " expected=0x" << expected;
+        }
+      }
+    }
+  });
+}
+
+void TestX32u(iree_uk_x32u_2d_func_t func, uint32_t (*reference)(uint32_t),
+              Generator in_generator, Compare compare) {
+  std::mt19937 engine;
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    for (const Shape& shape : kShapes) {
+      iree_uk_ssize_t stride0 = shape.size1 * shape.stride1 + 3;
+      iree_uk_ssize_t length = shape.size0 * stride0;
+      std::vector<uint32_t> in(length), out(length, 0);
+      for (iree_uk_ssize_t i = 0; i < length; ++i) {
+        in[i] = in_generator(engine);
+      }
+      ASSERT_EQ(0, func(in.data(), 0, stride0, shape.stride1, out.data(), 0,
+                        stride0, shape.stride1, shape.size0, shape.size1,
+                        cpu_data));
+      for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+        for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+          iree_uk_ssize_t k = i * stride0 + j * shape.stride1;
+          uint32_t expected = reference(in[k]);
+          ASSERT_TRUE(ElementsMatch(out[k], expected, compare))
+              << "in=0x" << std::hex << in[k] << " out=0x" << out[k]
+              << " expected=0x" << expected;
+        }
+      }
+    }
+  });
+}
+
+// Applies |func| to each value of |in| as a single row.
+std::vector<float> ApplyX32u(iree_uk_x32u_2d_func_t func,
+                             const std::vector<float>& in,
+                             const iree_uk_uint64_t* cpu_data) {
+  std::vector<float> out(in.size());
+  EXPECT_EQ(0, func((const iree_uk_uint32_t*)in.data(), 0, in.size(), 1,
+                    (iree_uk_uint32_t*)out.data(), 0, in.size(), 1, 1,
+                    in.size(), cpu_data));
+  return out;
+}
+
+#define F32(expr) [](uint32_t a, uint32_t b) { \
+    float x = AsFloat(a), y = AsFloat(b);        \
+    (void)x;                                     \
+    (void)y;                                     \
+    return AsBits(expr);                         \
+  }
+#define I32(expr) [](uint32_t a, uint32_t b) { \
+    int32_t x = (int32_t)a, y = (int32_t)b;    \
+    (void)x;                                   \
+    (void)y;                                   \
+    return (uint32_t)(expr);                   \
+  }
+#define U32(expr) [](uint32_t a, uint32_t b) { \
+    (void)a;                                   \
+    (void)b;                                   \
+    return (uint32_t)(expr);                   \
+  }
+#define F32U(expr) [](uint32_t a) { \
+    float x = AsFloat(a);           \
+    return AsBits(expr);            \
+  }
+
+TEST(ElementwiseTest, x32b_addf) {
+  TestX32b(iree_uk_x32b_addf_2d, F32(x + y), AnyFloat, AnyFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_addi) {
+  TestX32b(iree_uk_x32b_addi_2d, U32(a + b), AnyBits, AnyBits,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_andi) {
+  TestX32b(iree_uk_x32b_andi_2d, U32(a & b), AnyBits, AnyBits,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_divf) {
+  TestX32b(iree_uk_x32b_divf_2d, F32(x / y), AnyFloat, NonZeroFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_divsi) {
+  TestX32b(iree_uk_x32b_divsi_2d, I32(x / y), AnyBits, NonZeroInt,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_divui) {
+  TestX32b(iree_uk_x32b_divui_2d, U32(a / b), AnyBits, NonZeroInt,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_mulf) {
+  TestX32b(iree_uk_x32b_mulf_2d, F32(x * y), AnyFloat, AnyFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_muli) {
+  TestX32b(iree_uk_x32b_muli_2d, U32(a * b), AnyBits, AnyBits,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_ori) {
+  TestX32b(iree_uk_x32b_ori_2d, U32(a | b), AnyBits, AnyBits,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_shli) {
+  TestX32b(iree_uk_x32b_shli_2d, U32(a << b), AnyBits, ShiftAmount,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_shrsi) {
+  TestX32b(iree_uk_x32b_shrsi_2d, I32(x >> y), AnyBits, ShiftAmount,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_shrui) {
+  TestX32b(iree_uk_x32b_shrui_2d, U32(a >> b), AnyBits, ShiftAmount,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_subf) {
+  TestX32b(iree_uk_x32b_subf_2d, F32(x - y), AnyFloat, AnyFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_subi) {
+  TestX32b(iree_uk_x32b_subi_2d, U32(a - b), AnyBits, AnyBits,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32b_xori) {
+  TestX32b(iree_uk_x32b_xori_2d, U32(a ^ b), AnyBits, AnyBits,
+           Compare::kExact);
+}
+
+TEST(ElementwiseTest, x32u_absf) {
+  TestX32u(iree_uk_x32u_absf_2d, F32U(std::fabs(x)), AnyFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32u_ceilf) {
+  TestX32u(iree_uk_x32u_ceilf_2d, F32U(std::ceil(x)), AnyFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32u_ctlz) {
+  // Shift random bits by random amounts to cover all leading zero counts.
+  TestX32u(
+      iree_uk_x32u_ctlz_2d,
+      [](uint32_t a) { return a ? (uint32_t)__builtin_clz(a) : 32u; },
+      [](std::mt19937& engine) -> uint32_t {
+        return NonZeroInt(engine) & engine();
+      },
+      Compare::kExact);
+}
+TEST(ElementwiseTest, x32u_expf) {
+  TestX32u(iree_uk_x32u_expf_2d, F32U(std::exp(x)), ExpDomainFloat,
+           Compare::kApproximate);
+}
+TEST(ElementwiseTest, x32u_floorf) {
+  TestX32u(iree_uk_x32u_floorf_2d, F32U(std::floor(x)), AnyFloat,
+           Compare::kExact);
+}
+TEST(ElementwiseTest, x32u_logf) {
+  TestX32u(iree_uk_x32u_logf_2d, F32U(std::log(x)), PositiveFloat,
+           Compare::kApproximate);
+}
+TEST(ElementwiseTest, x32u_negf) {
+  TestX32u(iree_uk_x32u_negf_2d, F32U(-x), AnyFloat, Compare::kExact);
+}
+TEST(ElementwiseTest, x32u_rsqrtf) {
+  TestX32u(iree_uk_x32u_rsqrtf_2d, F32U(1.0f / std::sqrt(x)), PositiveFloat,
+           Compare::kExact);
+}
+
+TEST(ElementwiseTest, x32u_expf_special_values) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    std::vector<float> out = ApplyX32u(
+        iree_uk_x32u_expf_2d, {-inf, -200.f, 0.f, 100.f, inf, nan}, cpu_data);
+    EXPECT_EQ(out[0], 0.f);
+    EXPECT_LE(out[1], std::numeric_limits<float>::min());
+    EXPECT_EQ(out[2], 1.f);
+    EXPECT_EQ(out[3], inf);
+    EXPECT_EQ(out[4], inf);
+    EXPECT_TRUE(std::isnan(out[5]));
+  });
+}
+
+TEST(ElementwiseTest, x32u_logf_special_values) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    std::vector<float> out = ApplyX32u(
+        iree_uk_x32u_logf_2d, {-1.f, -0.f, 0.f, 1.f, inf, nan}, cpu_data);
+    EXPECT_TRUE(std::isnan(out[0]));
+    EXPECT_EQ(out[1], -inf);
+    EXPECT_EQ(out[2], -inf);
+    EXPECT_EQ(out[3], 0.f);
+    EXPECT_EQ(out[4], inf);
+    EXPECT_TRUE(std::isnan(out[5]));
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+  return RUN_ALL_TESTS();
+}
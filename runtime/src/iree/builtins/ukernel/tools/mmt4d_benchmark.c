@@ -28,6 +28,11 @@ IREE_FLAG(
 IREE_FLAG(bool, accumulate, false,
           "Whether the kernel should accumulate into the existing accumulator "
           "tile values, or zero the accumulator tile.");
+IREE_FLAG(string, shapes, "",
+          "Comma-separated list of MxNxK shapes, e.g. `1x1x256,64x64x4096`, "
+          "to benchmark each tile format with, overriding --m_size, --n_size "
+          "and --k_size. Reported items/s are FLOP/s and bytes/s count the "
+          "LHS, RHS and output traffic.");
 
 struct iree_mmt4d_benchmark_user_data_t {
   iree_uk_mmt4d_type_t type;
@@ -35,6 +40,10 @@ struct iree_mmt4d_benchmark_user_data_t {
   int N0;
   int K0;
   const iree_uk_uint64_t* cpu_data;
+  // Shape, or zeros to use --m_size, --n_size and --k_size.
+  int M;
+  int N;
+  int K;
 };
 
 typedef struct iree_mmt4d_benchmark_user_data_t
@@ -48,9 +57,9 @@ static iree_status_t iree_mmt4d_benchmark(
   memset(&params, 0, sizeof params);
   params.type = user_data->type;
   params.flags = FLAG_accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
-  params.M = FLAG_m_size;
-  params.N = FLAG_n_size;
-  params.K = FLAG_k_size;
+  params.M = user_data->M ? user_data->M : FLAG_m_size;
+  params.N = user_data->N ? user_data->N : FLAG_n_size;
+  params.K = user_data->K ? user_data->K : FLAG_k_size;
   params.M0 = user_data->M0;
   params.N0 = user_data->N0;
   params.K0 = user_data->K0;
@@ -96,6 +105,13 @@ static iree_status_t iree_mmt4d_benchmark(
   iree_benchmark_set_items_processed(
       benchmark_state, total_iterations * 2 * params.M * params.N * params.K *
                            params.M0 * params.N0 * params.K0);
+  // Each mmt4d reads the LHS and RHS once and writes the output, also reading
+  // it first when accumulating.
+  iree_uk_int64_t bytes_per_iteration =
+      lhs_buffer_size + rhs_buffer_size +
+      (FLAG_accumulate ? 2 : 1) * out_buffer_size;
+  iree_benchmark_set_bytes_processed(benchmark_state,
+                                     total_iterations * bytes_per_iteration);
   free(lhs_buffer);
   free(rhs_buffer);
   free(out_buffer);
@@ -115,7 +131,7 @@ static void iree_mmt4d_benchmark_register(
   }
 
   // benchmark_def does not need to be static, it will be cloned.
-  const iree_benchmark_def_t benchmark_def = {
+  iree_benchmark_def_t benchmark_def = {
       .flags = IREE_BENCHMARK_FLAG_USE_REAL_TIME,
       .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
       .minimum_duration_ns = 0,
@@ -123,7 +139,33 @@ static void iree_mmt4d_benchmark_register(
       .run = iree_mmt4d_benchmark,
       .user_data = user_data,
   };
-  iree_benchmark_register(IREE_SV(name), &benchmark_def);
+  iree_string_view_t shapes = iree_make_cstring_view(FLAG_shapes);
+  if (iree_string_view_is_empty(shapes)) {
+    iree_benchmark_register(IREE_SV(name), &benchmark_def);
+    return;
+  }
+  // Register one benchmark per shape. The user data of each must outlive the
+  // benchmark registry, which lives until the process exits.
+  while (!iree_string_view_is_empty(shapes)) {
+    iree_string_view_t shape;
+    iree_string_view_split(shapes, ',', &shape, &shapes);
+    iree_mmt4d_benchmark_user_data_t* shape_user_data =
+        malloc(sizeof(*shape_user_data));
+    *shape_user_data = *user_data;
+    char shape_str[64] = {0};
+    memcpy(shape_str, shape.data,
+           iree_min(shape.size, sizeof(shape_str) - 1));
+    if (sscanf(shape_str, "%dx%dx%d", &shape_user_data->M, &shape_user_data->N,
+               &shape_user_data->K) != 3) {
+      fprintf(stderr, "Invalid --shapes entry: %s\n", shape_str);
+      exit(1);
+    }
+    char shape_name[256];
+    snprintf(shape_name, sizeof shape_name, "%s/%s", name, shape_str);
+    benchmark_def.user_data = shape_user_data;
+    iree_benchmark_register(iree_make_cstring_view(shape_name),
+                            &benchmark_def);
+  }
 }
 
 #define MMT4D_BENCHMARK_REGISTER(_type, _m0, _n0, _k0, _cpu_data_field_0,      \
@@ -154,6 +196,12 @@ static void iree_mmt4d_benchmark_register(
                            IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##_cpu_feature,  \
                            arm_64_##_cpu_feature)
 
+#define MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(_type, _m0, _n0, _k0, \
+                                                         _cpu_feature)         \
+  MMT4D_BENCHMARK_REGISTER(_type, _m0, _n0, _k0,                               \
+                           IREE_CPU_DATA_FIELD_0_X86_64_HAVE_##_cpu_feature,   \
+                           x86_64_##_cpu_feature)
+
 int main(int argc, char** argv) {
   iree_flags_set_usage("mmt4d_benchmark",
                        "Benchmarks the mmt4d microkernel.\n"
@@ -179,6 +227,21 @@ int main(int argc, char** argv) {
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 benchmarks.
+#if defined(IREE_UK_ARCH_X86_64)
+
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1,
+                                                   AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 8, 8, 2, AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32f32f32, 16, 16, 1,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2,
+                                                   AVX512_VNNI);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
   iree_benchmark_run_specified();
   return 0;
 }
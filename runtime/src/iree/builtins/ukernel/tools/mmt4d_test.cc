@@ -43,6 +43,8 @@
 // things that we would otherwise prefer to keep internal in the mmt4d builtin
 // implementation, and would make e2e/matmul tests even more expensive.
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -88,6 +90,78 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
   }
 }
 
+static float iree_mmt4d_reference_to_f32(const void* buffer, iree_uk_ssize_t i,
+                                         iree_uk_type_t type) {
+  switch (type) {
+    case IREE_UK_TYPE_FLOAT_32:
+      return ((const float*)buffer)[i];
+    case IREE_UK_TYPE_FLOAT_16:
+      return iree_uk_f16_to_f32(((const iree_uk_uint16_t*)buffer)[i]);
+    case IREE_UK_TYPE_BFLOAT_16:
+      return iree_uk_bf16_to_f32(((const iree_uk_uint16_t*)buffer)[i]);
+    default:
+      assert(false && "unknown type");
+      return 0.f;
+  }
+}
+
+static void iree_mmt4d_reference_from_f32(void* buffer, iree_uk_ssize_t i,
+                                          iree_uk_type_t type, float value) {
+  switch (type) {
+    case IREE_UK_TYPE_FLOAT_32:
+      ((float*)buffer)[i] = value;
+      return;
+    case IREE_UK_TYPE_FLOAT_16:
+      ((iree_uk_uint16_t*)buffer)[i] = iree_uk_f32_to_f16(value);
+      return;
+    case IREE_UK_TYPE_BFLOAT_16:
+      ((iree_uk_uint16_t*)buffer)[i] = iree_uk_f32_to_bf16(value);
+      return;
+    default:
+      assert(false && "unknown type");
+  }
+}
+
+// Reference for the 16-bit float input cases: accumulates in f32 and rounds
+// to the output type once, matching the documented ukernel semantics.
+static void iree_mmt4d_reference_16bit_float(
+    const iree_uk_mmt4d_params_t& params) {
+  iree_uk_type_t in_type = iree_uk_mmt4d_lhs_type(params.type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params.type);
+  bool accumulate = params.flags & IREE_UK_FLAG_ACCUMULATE;
+  iree_uk_ssize_t lhs_tile_size = params.M0 * params.K0;
+  iree_uk_ssize_t rhs_tile_size = params.N0 * params.K0;
+  iree_uk_ssize_t out_tile_size = params.M0 * params.N0;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      iree_uk_ssize_t out_tile_offset =
+          i * params.out_stride + j * out_tile_size;
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          iree_uk_ssize_t lhs_offset = i * params.lhs_stride + i0 * params.K0;
+          iree_uk_ssize_t rhs_offset = j * params.rhs_stride + j0 * params.K0;
+          iree_uk_ssize_t out_offset = out_tile_offset + i0 * params.N0 + j0;
+          float acc = accumulate ? iree_mmt4d_reference_to_f32(
+                                       params.out_buffer, out_offset, out_type)
+                                 : 0.f;
+          for (iree_uk_ssize_t k = 0; k < params.K; ++k) {
+            for (iree_uk_ssize_t k0 = 0; k0 < params.K0; ++k0) {
+              acc += iree_mmt4d_reference_to_f32(params.lhs_buffer,
+                                                 lhs_offset + k0, in_type) *
+                     iree_mmt4d_reference_to_f32(params.rhs_buffer,
+                                                 rhs_offset + k0, in_type);
+            }
+            lhs_offset += lhs_tile_size;
+            rhs_offset += rhs_tile_size;
+          }
+          iree_mmt4d_reference_from_f32(params.out_buffer, out_offset, out_type,
+                                        acc);
+        }
+      }
+    }
+  }
+}
+
 static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
   switch (params.type) {
     case iree_uk_mmt4d_type_f32f32f32:
@@ -97,6 +171,12 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
       iree_mmt4d_reference<iree_uk_int8_t, iree_uk_int8_t, iree_uk_int32_t>(
           params);
       break;
+    case iree_uk_mmt4d_type_f16f16f32:
+    case iree_uk_mmt4d_type_f16f16f16:
+    case iree_uk_mmt4d_type_bf16bf16f32:
+    case iree_uk_mmt4d_type_bf16bf16bf16:
+      iree_mmt4d_reference_16bit_float(params);
+      break;
     default:
       assert(false && "unknown type");
   }
@@ -236,6 +316,8 @@ static void test_matmuls_for_various_MNK_shapes_and_flags(
       {1, 2, 1},
       {2, 2, 2},
       {5, 7, 13},
+      // Large enough to be split into several cache blocks along N and K.
+      {3, 37, 600},
   };
   for (shape_mnk_t shape : shapes) {
     params.M = shape.m;
@@ -275,8 +357,10 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
   test_matmuls_for_various_MNK_shapes_and_flags(params, engine);
   // If this is nonzero, we are asked to test again with this CPU feature.
   if (cpu_data_field_0_bit) {
+    // Field 1 holds values such as vector lengths, not features, so it is
+    // taken from the actual CPU.
     const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] =
-        {cpu_data_field_0_bit};
+        {cpu_data_field_0_bit, iree_cpu_data_field(1)};
     params.cpu_data = local_cpu_data_with_bit;
     // Check if the CPU supports the feature (otherwise, we crash).
     bool supported = iree_cpu_data_field(0) & params.cpu_data[0];
@@ -295,6 +379,514 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
   iree_uk_test_random_engine_destroy(engine);
 }
 
+// Reference epilogue, applied to the accumulators |acc| of the mmt4d with the
+// given |params|, storing the result to |out|.
+static void iree_mmt4d_reference_epilogue(const iree_uk_mmt4d_params_t& params,
+                                          const void* acc, void* out) {
+  const iree_uk_mmt4d_epilogue_t& epilogue = *params.epilogue;
+  bool is_float = iree_uk_mmt4d_out_type(params.type) == IREE_UK_TYPE_FLOAT_32;
+  bool clamp = epilogue.flags & IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          iree_uk_ssize_t c = j * params.N0 + j0;
+          iree_uk_ssize_t offset = i * params.out_stride +
+                                   (j * params.M0 + i0) * params.N0 + j0;
+          if (is_float) {
+            float value = ((const float*)acc)[offset];
+            if (epilogue.bias) value += ((const float*)epilogue.bias)[c];
+            if (clamp) {
+              value = std::min(std::max(value, epilogue.clamp_min_f32),
+                               epilogue.clamp_max_f32);
+            }
+            ((float*)out)[offset] = value;
+            continue;
+          }
+          iree_uk_int32_t value = ((const iree_uk_int32_t*)acc)[offset];
+          if (epilogue.bias) {
+            value += ((const iree_uk_int32_t*)epilogue.bias)[c];
+          }
+          if (epilogue.out_type == IREE_UK_TYPE_INT_32) {
+            if (clamp) {
+              value = std::min(std::max(value, epilogue.clamp_min_i32),
+                               epilogue.clamp_max_i32);
+            }
+            ((iree_uk_int32_t*)out)[offset] = value;
+            continue;
+          }
+          float scale = epilogue.scales[epilogue.per_channel_scales ? c : 0];
+          iree_uk_int32_t quantized =
+              (iree_uk_int32_t)std::nearbyint((float)value * scale) +
+              epilogue.zero_point;
+          quantized = std::min(std::max(quantized, -128), 127);
+          if (clamp) {
+            quantized = std::min(std::max(quantized, epilogue.clamp_min_i32),
+                                 epilogue.clamp_max_i32);
+          }
+          ((iree_uk_int8_t*)out)[offset] = (iree_uk_int8_t)quantized;
+        }
+      }
+    }
+  }
+}
+
+// Tests mmt4d with an epilogue of the given |out_type| against mmt4d without
+// an epilogue followed by the reference epilogue. The tile function is selected
+// for the actual CPU.
+static void mmt4d_epilogue_test(iree_uk_mmt4d_type_t type, int M0, int N0,
+                                int K0, iree_uk_type_t out_type,
+                                bool per_channel_scales, bool clamp) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(type);
+  iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(type);
+  struct shape_mnk_t {
+    int m, n, k;
+  };
+  for (shape_mnk_t shape : {shape_mnk_t{1, 1, 0}, shape_mnk_t{1, 1, 1},
+                            shape_mnk_t{2, 3, 5}, shape_mnk_t{5, 7, 13}}) {
+    iree_uk_mmt4d_params_t params;
+    memset(&params, 0, sizeof params);
+    params.type = type;
+    params.M = shape.m;
+    params.N = shape.n;
+    params.K = shape.k;
+    params.M0 = M0;
+    params.N0 = N0;
+    params.K0 = K0;
+    params.lhs_stride = params.K * M0 * K0;
+    params.rhs_stride = params.K * N0 * K0;
+    params.out_stride = params.N * M0 * N0;
+    params.cpu_data = (const iree_uk_uint64_t*)iree_cpu_data_fields();
+    std::vector<char> lhs(
+        iree_uk_test_2d_buffer_length(lhs_type, params.M, params.lhs_stride));
+    std::vector<char> rhs(
+        iree_uk_test_2d_buffer_length(rhs_type, params.N, params.rhs_stride));
+    std::vector<char> bias(
+        iree_uk_test_2d_buffer_length(acc_type, 1, params.N * N0));
+    iree_uk_test_write_random_buffer(lhs.data(), lhs.size(), lhs_type, engine);
+    iree_uk_test_write_random_buffer(rhs.data(), rhs.size(), rhs_type, engine);
+    iree_uk_test_write_random_buffer(bias.data(), bias.size(), acc_type,
+                                     engine);
+    params.lhs_buffer = lhs.data();
+    params.rhs_buffer = rhs.data();
+    // Powers of two keep the products exact so that only the final rounding,
+    // including ties, is tested.
+    std::vector<float> scales(params.N * N0);
+    for (size_t c = 0; c < scales.size(); ++c) {
+      scales[c] = 1.0f / (float)(1 << (c % 4));
+    }
+    iree_uk_mmt4d_epilogue_t epilogue;
+    memset(&epilogue, 0, sizeof epilogue);
+    epilogue.flags = clamp ? IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP : 0;
+    epilogue.out_type = out_type;
+    epilogue.bias = bias.data();
+    epilogue.scales = scales.data();
+    epilogue.per_channel_scales = per_channel_scales;
+    epilogue.zero_point = out_type == IREE_UK_TYPE_INT_8 ? -3 : 0;
+    epilogue.clamp_min_i32 = out_type == IREE_UK_TYPE_INT_8 ? -3 : 0;
+    epilogue.clamp_max_i32 = out_type == IREE_UK_TYPE_INT_8 ? 20 : 200;
+    epilogue.clamp_min_f32 = 0.0f;
+    epilogue.clamp_max_f32 = 6.0f;
+    // Accumulators from mmt4d without an epilogue.
+    std::vector<char> acc(
+        iree_uk_test_2d_buffer_length(acc_type, params.M, params.out_stride));
+    params.out_buffer = acc.data();
+    iree_uk_mmt4d(&params);
+    std::vector<char> expected(
+        iree_uk_test_2d_buffer_length(out_type, params.M, params.out_stride));
+    std::vector<char> actual(expected.size());
+    params.epilogue = &epilogue;
+    iree_mmt4d_reference_epilogue(params, acc.data(), expected.data());
+    params.out_buffer = actual.data();
+    iree_uk_mmt4d(&params);
+    if (memcmp(actual.data(), expected.data(), expected.size())) {
+      fprintf(stderr, "mmt4d epilogue test failure: M=%d, N=%d, K=%d\n",
+              (int)params.M, (int)params.N, (int)params.K);
+      iree_abort();
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+// Tests iree_uk_batch_mmt4d against iree_uk_mmt4d called on each batch, with
+// padded batch strides. If |epilogue_out_type| is not IREE_UK_TYPE_NONE, the
+// mmt4d operations have a bias epilogue with that output type. The tile
+// function is selected for the actual CPU.
+static void mmt4d_batch_test(iree_uk_mmt4d_type_t type, int M0, int N0,
+                             int K0, iree_uk_type_t epilogue_out_type) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(type);
+  iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(type);
+  bool has_epilogue = epilogue_out_type != IREE_UK_TYPE_NONE;
+  iree_uk_type_t out_type = has_epilogue ? epilogue_out_type : acc_type;
+  struct shape_bmnk_t {
+    int batch, m, n, k;
+  };
+  for (shape_bmnk_t shape :
+       {shape_bmnk_t{0, 1, 1, 1}, shape_bmnk_t{3, 0, 1, 1},
+        shape_bmnk_t{3, 2, 3, 0}, shape_bmnk_t{1, 2, 3, 5},
+        shape_bmnk_t{4, 5, 7, 13}}) {
+    for (bool accumulate : {false, true}) {
+      if (accumulate && out_type != acc_type) continue;
+      iree_uk_batch_mmt4d_params_t params;
+      memset(&params, 0, sizeof params);
+      iree_uk_mmt4d_params_t& mmt4d = params.mmt4d;
+      mmt4d.type = type;
+      mmt4d.flags = accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
+      mmt4d.M = shape.m;
+      mmt4d.N = shape.n;
+      mmt4d.K = shape.k;
+      mmt4d.M0 = M0;
+      mmt4d.N0 = N0;
+      mmt4d.K0 = K0;
+      mmt4d.lhs_stride = mmt4d.K * M0 * K0;
+      mmt4d.rhs_stride = mmt4d.K * N0 * K0;
+      mmt4d.out_stride = mmt4d.N * M0 * N0;
+      mmt4d.cpu_data = (const iree_uk_uint64_t*)iree_cpu_data_fields();
+      params.batch_size = shape.batch;
+      params.lhs_batch_stride = mmt4d.M * mmt4d.lhs_stride + 1;
+      params.rhs_batch_stride = mmt4d.N * mmt4d.rhs_stride + 2;
+      params.out_batch_stride = mmt4d.M * mmt4d.out_stride + 3;
+      std::vector<char> lhs(iree_uk_test_2d_buffer_length(
+          lhs_type, shape.batch, params.lhs_batch_stride));
+      std::vector<char> rhs(iree_uk_test_2d_buffer_length(
+          rhs_type, shape.batch, params.rhs_batch_stride));
+      std::vector<char> bias(
+          iree_uk_test_2d_buffer_length(acc_type, 1, mmt4d.N * N0));
+      std::vector<char> expected(iree_uk_test_2d_buffer_length(
+          out_type, shape.batch, params.out_batch_stride));
+      iree_uk_test_write_random_buffer(lhs.data(), lhs.size(), lhs_type,
+                                       engine);
+      iree_uk_test_write_random_buffer(rhs.data(), rhs.size(), rhs_type,
+                                       engine);
+      iree_uk_test_write_random_buffer(bias.data(), bias.size(), acc_type,
+                                       engine);
+      iree_uk_test_write_random_buffer(expected.data(), expected.size(),
+                                       out_type, engine);
+      std::vector<char> actual(expected);
+      float scale = 0.25f;
+      iree_uk_mmt4d_epilogue_t epilogue;
+      memset(&epilogue, 0, sizeof epilogue);
+      epilogue.out_type = out_type;
+      epilogue.bias = bias.data();
+      epilogue.scales = &scale;
+      if (has_epilogue) mmt4d.epilogue = &epilogue;
+      int lhs_elem_size = iree_uk_type_size(lhs_type);
+      int rhs_elem_size = iree_uk_type_size(rhs_type);
+      int out_elem_size = iree_uk_type_size(out_type);
+      for (int b = 0; b < shape.batch; ++b) {
+        iree_uk_mmt4d_params_t batch_params = mmt4d;
+        batch_params.lhs_buffer =
+            lhs.data() + b * params.lhs_batch_stride * lhs_elem_size;
+        batch_params.rhs_buffer =
+            rhs.data() + b * params.rhs_batch_stride * rhs_elem_size;
+        batch_params.out_buffer =
+            expected.data() + b * params.out_batch_stride * out_elem_size;
+        iree_uk_mmt4d(&batch_params);
+      }
+      mmt4d.lhs_buffer = lhs.data();
+      mmt4d.rhs_buffer = rhs.data();
+      mmt4d.out_buffer = actual.data();
+      iree_uk_batch_mmt4d(&params);
+      if (memcmp(actual.data(), expected.data(), expected.size())) {
+        fprintf(stderr,
+                "batch_mmt4d test failure: batch=%d, M=%d, N=%d, K=%d, "
+                "accumulate=%d\n",
+                shape.batch, shape.m, shape.n, shape.k, accumulate);
+        iree_abort();
+      }
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+// Reference for the types with an INT_4 RHS, following the numerics
+// documented on iree_uk_mmt4d_rhs_quant_t.
+static void iree_mmt4d_reference_quant(const iree_uk_mmt4d_params_t& params) {
+  const iree_uk_mmt4d_rhs_quant_t& quant = *params.rhs_quant;
+  bool is_i8 = params.type == iree_uk_mmt4d_type_i8i4f32;
+  bool accumulate = params.flags & IREE_UK_FLAG_ACCUMULATE;
+  iree_uk_ssize_t N_total = params.N * params.N0;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          iree_uk_ssize_t c = j * params.N0 + j0;
+          float* out_ptr = (float*)params.out_buffer + i * params.out_stride +
+                           (j * params.M0 + i0) * params.N0 + j0;
+          float acc = accumulate ? *out_ptr : 0.f;
+          iree_uk_int32_t group_acc = 0;
+          for (iree_uk_ssize_t k = 0; k < params.K; ++k) {
+            for (iree_uk_ssize_t k0 = 0; k0 < params.K0; ++k0) {
+              iree_uk_ssize_t row = k * params.K0 + k0;
+              iree_uk_ssize_t q = (row / quant.group_size) * N_total + c;
+              iree_uk_int32_t zero_point =
+                  quant.zero_points ? quant.zero_points[q] : 0;
+              iree_uk_int32_t rhs_int = iree_uk_int4_load(
+                  params.rhs_buffer,
+                  j * params.rhs_stride + (k * params.N0 + j0) * params.K0 +
+                      k0);
+              iree_uk_ssize_t lhs_index = i * params.lhs_stride +
+                                          (k * params.M0 + i0) * params.K0 +
+                                          k0;
+              if (is_i8) {
+                group_acc +=
+                    ((const iree_uk_int8_t*)params.lhs_buffer)[lhs_index] *
+                    (rhs_int - zero_point);
+                if ((row + 1) % quant.group_size == 0 ||
+                    row + 1 == params.K * params.K0) {
+                  acc += quant.scales[q] * (float)group_acc;
+                  group_acc = 0;
+                }
+              } else {
+                acc += iree_uk_f16_to_f32(((const iree_uk_uint16_t*)
+                                               params.lhs_buffer)[lhs_index]) *
+                       ((float)(rhs_int - zero_point) * quant.scales[q]);
+              }
+            }
+          }
+          *out_ptr = acc;
+        }
+      }
+    }
+  }
+}
+
+// Tests mmt4d with the given type with an INT_4 RHS, quantized in groups of
+// |group_K| K0-tiles. If cpu_data_field_0_bit is nonzero, the tests are run a
+// second time with that CPU feature enabled, like mmt4d_test. Also tests the
+// combination with an epilogue.
+static void mmt4d_quant_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
+                             int group_K,
+                             iree_uk_uint64_t cpu_data_field_0_bit) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(type);
+  const iree_uk_uint64_t local_cpu_data_default[IREE_CPU_DATA_FIELD_COUNT] = {
+      0};
+  const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] = {
+      cpu_data_field_0_bit};
+  std::vector<const iree_uk_uint64_t*> cpu_datas{local_cpu_data_default};
+  if (cpu_data_field_0_bit) {
+    char cpu_feat_str[32];
+    iree_uk_test_cpu_features_str(cpu_feat_str, sizeof cpu_feat_str,
+                                  local_cpu_data_with_bit, 1);
+    if ((iree_cpu_data_field(0) & cpu_data_field_0_bit) ==
+        cpu_data_field_0_bit) {
+      printf("Device supports CPU feature: %s\n", cpu_feat_str);
+      cpu_datas.push_back(local_cpu_data_with_bit);
+    } else {
+      printf("Skipped: device does not support CPU feature: %s\n",
+             cpu_feat_str);
+    }
+  }
+  struct shape_mnk_t {
+    int m, n, k;
+  };
+  // K values that are not multiples of group_K exercise a partial last group.
+  std::vector<shape_mnk_t> shapes{{1, 1, 0},          {1, 1, 1},
+                                  {1, 1, group_K},    {2, 3, group_K + 1},
+                                  {5, 7, 3 * group_K}, {3, 2, 100}};
+  for (const iree_uk_uint64_t* cpu_data : cpu_datas) {
+    for (shape_mnk_t shape : shapes) {
+      for (bool accumulate : {false, true}) {
+        iree_uk_mmt4d_params_t params;
+        memset(&params, 0, sizeof params);
+        params.type = type;
+        params.flags = accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
+        params.M = shape.m;
+        params.N = shape.n;
+        params.K = shape.k;
+        params.M0 = M0;
+        params.N0 = N0;
+        params.K0 = K0;
+        params.cpu_data = cpu_data;
+        // The RHS stride must be even, so only the other strides are padded.
+        params.lhs_stride = params.K * M0 * K0 +
+                            iree_uk_test_random_engine_get_0_1(engine);
+        params.rhs_stride = params.K * N0 * K0;
+        params.out_stride = params.N * M0 * N0 +
+                            iree_uk_test_random_engine_get_0_1(engine);
+        std::vector<char> lhs(iree_uk_test_2d_buffer_length(
+            lhs_type, params.M, params.lhs_stride));
+        std::vector<char> rhs(iree_uk_test_2d_buffer_length(
+            rhs_type, params.N, params.rhs_stride));
+        iree_uk_test_write_random_buffer(lhs.data(), lhs.size(), lhs_type,
+                                         engine);
+        iree_uk_test_write_random_buffer(rhs.data(), rhs.size(), rhs_type,
+                                         engine);
+        params.lhs_buffer = lhs.data();
+        params.rhs_buffer = rhs.data();
+        // Powers of two keep all the arithmetic exact. At least one group, as
+        // the scales are required even when K == 0.
+        iree_uk_ssize_t group_count =
+            std::max(1, (shape.k + group_K - 1) / group_K) * params.N * N0;
+        std::vector<float> scales(group_count);
+        std::vector<iree_uk_int8_t> zero_points(group_count);
+        for (iree_uk_ssize_t g = 0; g < group_count; ++g) {
+          scales[g] = 1.0f / (float)(1 << (g % 3));
+          zero_points[g] =
+              iree_uk_test_random_engine_get_minus16_plus15(engine) / 2;
+        }
+        iree_uk_mmt4d_rhs_quant_t quant;
+        quant.group_size = group_K * K0;
+        quant.scales = scales.data();
+        quant.zero_points = shape.m == 1 ? nullptr : zero_points.data();
+        params.rhs_quant = &quant;
+        iree_uk_ssize_t out_buffer_size = iree_uk_test_2d_buffer_length(
+            IREE_UK_TYPE_FLOAT_32, params.M, params.out_stride);
+        std::vector<char> expected(out_buffer_size);
+        iree_uk_test_write_random_buffer(expected.data(), expected.size(),
+                                         IREE_UK_TYPE_FLOAT_32, engine);
+        std::vector<char> actual(expected);
+        std::vector<char> actual_with_epilogue(expected);
+        params.out_buffer = expected.data();
+        iree_mmt4d_reference_quant(params);
+        params.out_buffer = actual.data();
+        iree_uk_mmt4d(&params);
+        bool ok = !memcmp(actual.data(), expected.data(), expected.size());
+        if (ok && !accumulate) {
+          // Bias and clamp, which are exact too.
+          std::vector<char> bias(iree_uk_test_2d_buffer_length(
+              IREE_UK_TYPE_FLOAT_32, 1, params.N * N0));
+          iree_uk_test_write_random_buffer(bias.data(), bias.size(),
+                                           IREE_UK_TYPE_FLOAT_32, engine);
+          iree_uk_mmt4d_epilogue_t epilogue;
+          memset(&epilogue, 0, sizeof epilogue);
+          epilogue.flags = IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP;
+          epilogue.out_type = IREE_UK_TYPE_FLOAT_32;
+          epilogue.bias = bias.data();
+          epilogue.clamp_min_f32 = -4.0f;
+          epilogue.clamp_max_f32 = 6.0f;
+          params.epilogue = &epilogue;
+          iree_mmt4d_reference_epilogue(params, actual.data(),
+                                        expected.data());
+          params.out_buffer = actual_with_epilogue.data();
+          iree_uk_mmt4d(&params);
+          ok = !memcmp(actual_with_epilogue.data(), expected.data(),
+                       expected.size());
+        }
+        if (!ok) {
+          char types_str[32];
+          iree_uk_test_type_triple_str(types_str, sizeof types_str, type);
+          fprintf(stderr,
+                  "mmt4d quant test failure: types: %s, M=%d, N=%d, K=%d, "
+                  "accumulate=%d, epilogue=%d, cpu data: 0x%llx\n",
+                  types_str, (int)params.M, (int)params.N, (int)params.K,
+                  accumulate, params.epilogue != nullptr,
+                  (unsigned long long)cpu_data[0]);
+          iree_abort();
+        }
+      }
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+// Tests mmt4d with a block-sparse RHS against mmt4d with the dense RHS that
+// has zeros in place of the skipped tiles, with and without accumulating and
+// an epilogue. The products of the random values are small integers, so both
+// are exact. The tile function is selected for the actual CPU.
+static void mmt4d_sparse_test(iree_uk_mmt4d_type_t type, int M0, int N0,
+                              int K0) {
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(type);
+  iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(type);
+  struct shape_mnk_t {
+    int m, n, k;
+  };
+  for (shape_mnk_t shape : {shape_mnk_t{1, 1, 0}, shape_mnk_t{1, 1, 1},
+                            shape_mnk_t{2, 3, 5}, shape_mnk_t{5, 7, 13},
+                            shape_mnk_t{3, 4, 40}}) {
+    for (bool accumulate : {false, true}) {
+      for (bool has_epilogue : {false, true}) {
+        iree_uk_mmt4d_params_t params;
+        memset(&params, 0, sizeof params);
+        params.type = type;
+        params.flags = accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
+        params.M = shape.m;
+        params.N = shape.n;
+        params.K = shape.k;
+        params.M0 = M0;
+        params.N0 = N0;
+        params.K0 = K0;
+        params.lhs_stride = params.K * M0 * K0;
+        params.rhs_stride = params.K * N0 * K0;
+        params.out_stride = params.N * M0 * N0;
+        params.cpu_data = (const iree_uk_uint64_t*)iree_cpu_data_fields();
+        std::vector<char> lhs(iree_uk_test_2d_buffer_length(
+            lhs_type, params.M, params.lhs_stride));
+        std::vector<char> rhs(iree_uk_test_2d_buffer_length(
+            rhs_type, params.N, params.rhs_stride));
+        std::vector<char> bias(
+            iree_uk_test_2d_buffer_length(acc_type, 1, params.N * N0));
+        std::vector<char> expected(iree_uk_test_2d_buffer_length(
+            acc_type, params.M, params.out_stride));
+        iree_uk_test_write_random_buffer(lhs.data(), lhs.size(), lhs_type,
+                                         engine);
+        iree_uk_test_write_random_buffer(rhs.data(), rhs.size(), rhs_type,
+                                         engine);
+        iree_uk_test_write_random_buffer(bias.data(), bias.size(), acc_type,
+                                         engine);
+        iree_uk_test_write_random_buffer(expected.data(), expected.size(),
+                                         acc_type, engine);
+        std::vector<char> actual(expected);
+        // Zero about half of the RHS tiles and gather the others.
+        iree_uk_ssize_t rhs_tile_size =
+            iree_uk_test_2d_buffer_length(rhs_type, 1, N0 * K0);
+        std::vector<char> sparse_rhs;
+        std::vector<iree_uk_int32_t> panel_offsets{0};
+        std::vector<iree_uk_int32_t> k_indices;
+        for (int j = 0; j < shape.n; ++j) {
+          for (int k = 0; k < shape.k; ++k) {
+            char* tile = rhs.data() + (j * shape.k + k) * rhs_tile_size;
+            if (iree_uk_test_random_engine_get_0_1(engine)) {
+              memset(tile, 0, rhs_tile_size);
+            } else {
+              sparse_rhs.insert(sparse_rhs.end(), tile, tile + rhs_tile_size);
+              k_indices.push_back(k);
+            }
+          }
+          panel_offsets.push_back(k_indices.size());
+        }
+        iree_uk_mmt4d_epilogue_t epilogue;
+        memset(&epilogue, 0, sizeof epilogue);
+        epilogue.flags = IREE_UK_MMT4D_EPILOGUE_FLAG_CLAMP;
+        epilogue.out_type = acc_type;
+        epilogue.bias = bias.data();
+        epilogue.clamp_min_i32 = -100;
+        epilogue.clamp_max_i32 = 100;
+        epilogue.clamp_min_f32 = -100.0f;
+        epilogue.clamp_max_f32 = 100.0f;
+        if (has_epilogue) params.epilogue = &epilogue;
+        params.lhs_buffer = lhs.data();
+        params.rhs_buffer = rhs.data();
+        params.out_buffer = expected.data();
+        iree_uk_mmt4d(&params);
+        iree_uk_mmt4d_rhs_sparsity_t sparsity;
+        sparsity.panel_offsets = panel_offsets.data();
+        sparsity.k_indices = k_indices.data();
+        params.rhs_sparsity = &sparsity;
+        params.rhs_buffer = sparse_rhs.data();
+        params.out_buffer = actual.data();
+        iree_uk_mmt4d(&params);
+        if (memcmp(actual.data(), expected.data(), expected.size())) {
+          fprintf(stderr,
+                  "mmt4d sparse test failure: M=%d, N=%d, K=%d, "
+                  "accumulate=%d, epilogue=%d\n",
+                  shape.m, shape.n, shape.k, accumulate, has_epilogue);
+          iree_abort();
+        }
+      }
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
 #define MMT4D_TEST(type, M0, N0, K0, test_suffix, feature_bit)      \
   TEST(Mmt4dTest, type##_tile_##M0##x##N0##x##K0##_##test_suffix) { \
     mmt4d_test(iree_uk_mmt4d_type_##type, M0, N0, K0, feature_bit); \
@@ -305,6 +897,62 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
 // power-of-two assumption
 MMT4D_TEST(f32f32f32, 3, 5, 7, generic, 0)
 MMT4D_TEST(i8i8i32, 9, 6, 3, generic, 0)
+MMT4D_TEST(f16f16f32, 3, 5, 2, generic, 0)
+MMT4D_TEST(f16f16f16, 3, 5, 2, generic, 0)
+MMT4D_TEST(bf16bf16f32, 3, 5, 2, generic, 0)
+MMT4D_TEST(bf16bf16bf16, 3, 5, 2, generic, 0)
+
+// Epilogue tests. The epilogue is independent of the tile function, so these
+// use the tile formats that have architecture-specific tile functions on the
+// most targets.
+TEST(Mmt4dTest, f32f32f32_epilogue_bias_clamp) {
+  mmt4d_epilogue_test(iree_uk_mmt4d_type_f32f32f32, 8, 8, 1,
+                      IREE_UK_TYPE_FLOAT_32, false, true);
+}
+TEST(Mmt4dTest, i8i8i32_epilogue_bias_clamp) {
+  mmt4d_epilogue_test(iree_uk_mmt4d_type_i8i8i32, 8, 8, 1, IREE_UK_TYPE_INT_32,
+                      false, true);
+}
+TEST(Mmt4dTest, i8i8i32_epilogue_requantize) {
+  mmt4d_epilogue_test(iree_uk_mmt4d_type_i8i8i32, 3, 5, 2, IREE_UK_TYPE_INT_8,
+                      false, false);
+}
+TEST(Mmt4dTest, i8i8i32_epilogue_requantize_per_channel_clamp) {
+  mmt4d_epilogue_test(iree_uk_mmt4d_type_i8i8i32, 8, 8, 2, IREE_UK_TYPE_INT_8,
+                      true, true);
+}
+
+// Batch tests. Like the epilogue tests, these use tile formats that have
+// architecture-specific tile functions on the most targets.
+TEST(Mmt4dTest, f32f32f32_batch) {
+  mmt4d_batch_test(iree_uk_mmt4d_type_f32f32f32, 8, 8, 1, IREE_UK_TYPE_NONE);
+}
+TEST(Mmt4dTest, i8i8i32_batch) {
+  mmt4d_batch_test(iree_uk_mmt4d_type_i8i8i32, 8, 8, 2, IREE_UK_TYPE_NONE);
+}
+TEST(Mmt4dTest, f16f16f16_batch) {
+  mmt4d_batch_test(iree_uk_mmt4d_type_f16f16f16, 3, 5, 2, IREE_UK_TYPE_NONE);
+}
+TEST(Mmt4dTest, i8i8i32_batch_epilogue_requantize) {
+  mmt4d_batch_test(iree_uk_mmt4d_type_i8i8i32, 8, 8, 1, IREE_UK_TYPE_INT_8);
+}
+
+// Tests of the types with an INT_4 RHS, with groups of 2 K0-tiles.
+TEST(Mmt4dTest, i8i4f32_tile_3x4x2_generic) {
+  mmt4d_quant_test(iree_uk_mmt4d_type_i8i4f32, 3, 4, 2, 2, 0);
+}
+TEST(Mmt4dTest, f16i4f32_tile_3x4x2_generic) {
+  mmt4d_quant_test(iree_uk_mmt4d_type_f16i4f32, 3, 4, 2, 2, 0);
+}
+
+// Block-sparse RHS tests, with a generic tile format and a tile format that
+// has architecture-specific tile functions on the most targets.
+TEST(Mmt4dTest, f32f32f32_sparse_rhs) {
+  mmt4d_sparse_test(iree_uk_mmt4d_type_f32f32f32, 8, 8, 1);
+}
+TEST(Mmt4dTest, i8i8i32_sparse_rhs) {
+  mmt4d_sparse_test(iree_uk_mmt4d_type_i8i8i32, 3, 5, 2);
+}
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -320,8 +968,73 @@ MMT4D_ARM_64_TEST(f32f32f32, 8, 8, 1)
 MMT4D_ARM_64_TEST(i8i8i32, 8, 8, 1)
 MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 4, DOTPROD)
 MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 8, I8MM)
+
+// Returns the vector length in 32-bit words in the field 1 value selected by
+// |mask| and |shift| of the actual CPU.
+static int mmt4d_test_vector_words(iree_uk_uint64_t mask, int shift) {
+  return (int)((iree_cpu_data_field(1) & mask) >> shift) / 4;
+}
+
+// Tests of tile formats that scale with the vector length. |M0| and |N0| are
+// expressions in terms of |vector_words|, the SVE or SME vector length of the
+// actual CPU in 32-bit words.
+#define MMT4D_ARM_64_SCALABLE_TEST(type, M0, N0, K0, FEATURE, name)          \
+  TEST(Mmt4dTest, type##_tile_##name##_arm_64_##FEATURE) {                   \
+    int vector_words = mmt4d_test_vector_words(                              \
+        IREE_CPU_DATA_FIELD_1_AARCH64_##FEATURE##_VECTOR_BYTES_MASK,         \
+        IREE_CPU_DATA_FIELD_1_AARCH64_##FEATURE##_VECTOR_BYTES_SHIFT);       \
+    if (!vector_words) {                                                     \
+      printf("Skipped: device does not support CPU feature: " #FEATURE "\n"); \
+      return;                                                                \
+    }                                                                        \
+    mmt4d_test(iree_uk_mmt4d_type_##type, M0, N0, K0,                        \
+               IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##FEATURE);                \
+  }
+
+MMT4D_ARM_64_SCALABLE_TEST(f32f32f32, 8, vector_words, 1, SVE, 8xVLx1)
+MMT4D_ARM_64_SCALABLE_TEST(i8i8i32, 8, vector_words, 4, SVE, 8xVLx4)
+MMT4D_ARM_64_SCALABLE_TEST(f32f32f32, 2 * vector_words, 2 * vector_words, 1,
+                           SME, 2VLx2VLx1)
+MMT4D_ARM_64_SCALABLE_TEST(i8i8i32, 2 * vector_words, 2 * vector_words, 4, SME,
+                           2VLx2VLx4)
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 tests.
+#if defined(IREE_UK_ARCH_X86_64)
+
+#define MMT4D_X86_64_TEST_WITH_CPU_FEATURE(type, M0, N0, K0, FEATURE) \
+  MMT4D_TEST(type, M0, N0, K0, x86_64_##FEATURE,                      \
+             IREE_CPU_DATA_FIELD_0_X86_64_HAVE_##FEATURE)
+
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 2, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32f32f32, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2, AVX512_VNNI)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f16f16f32, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f16f16f16, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2, AVX512_BF16)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(bf16bf16bf16, 16, 16, 2, AVX512_BF16)
+
+TEST(Mmt4dTest, i8i4f32_tile_8x8x2_x86_64_AVX2_FMA) {
+  mmt4d_quant_test(iree_uk_mmt4d_type_i8i4f32, 8, 8, 2, 4,
+                   IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+}
+TEST(Mmt4dTest, f16i4f32_tile_8x8x2_x86_64_AVX2_FMA) {
+  mmt4d_quant_test(iree_uk_mmt4d_type_f16i4f32, 8, 8, 2, 4,
+                   IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+}
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+// WASM_32 tests. These only exercise the SIMD128 tiles when built with
+// -msimd128, otherwise they fall back to the generic tiles.
+#if defined(IREE_UK_ARCH_WASM_32)
+
+MMT4D_TEST(f32f32f32, 8, 8, 1, wasm_32, 0)
+MMT4D_TEST(i8i8i32, 8, 8, 2, wasm_32, 0)
+
+#endif  // defined(IREE_UK_ARCH_WASM_32)
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
@@ -18,7 +18,8 @@
 static void iree_pack_reference(const iree_uk_pack_params_t& params) {
   // For now, the input and output element types are always the same.
   iree_uk_type_t elem_type = iree_uk_pack_in_type(params.type);
-  iree_uk_ssize_t elem_size = iree_uk_type_size(elem_type);
+  bool is_int4 = elem_type == IREE_UK_TYPE_INT_4;
+  iree_uk_ssize_t elem_size = is_int4 ? 0 : iree_uk_type_size(elem_type);
   iree_uk_ssize_t outer_size0 = params.out_size0;
   iree_uk_ssize_t outer_size1 = params.out_size1;
   iree_uk_ssize_t tile_size0 = params.out_size2;
@@ -46,6 +47,15 @@ static void iree_pack_reference(const iree_uk_pack_params_t& params) {
               outer_i1 * out_stride_l1 + tile_i1 * out_stride_l3;
           iree_uk_ssize_t i0 = outer_i0 * tile_size0 + tile_i0;
           iree_uk_ssize_t i1 = outer_i1 * tile_size1 + tile_i1;
+          if (is_int4) {
+            bool is_padding = i0 >= params.in_size0 || i1 >= params.in_size1;
+            iree_uk_int4_store(
+                params.out_buffer, out_offset,
+                is_padding ? *(const iree_uk_uint8_t*)params.padding_value
+                           : iree_uk_int4_load(params.in_buffer,
+                                               i1 + i0 * params.in_stride0));
+            continue;
+          }
           char* out_ptr = ((char*)params.out_buffer) + out_offset * elem_size;
           if (i0 >= params.in_size0 || i1 >= params.in_size1) {
             memcpy(out_ptr, params.padding_value, elem_size);
@@ -197,7 +207,7 @@ static void pack_test_for_various_tile_shapes_and_flags(
                 std::max<iree_uk_ssize_t>(0, params.in_size0 - pad_size1);
           }
           iree_uk_type_t out_type = iree_uk_pack_out_type(type);
-          int out_elem_size = iree_uk_type_size(out_type);
+          int out_elem_size = iree_uk_test_2d_buffer_length(out_type, 1, 1);
           void* padding_value_buffer = malloc(out_elem_size);
           iree_uk_test_write_random_buffer(padding_value_buffer, out_elem_size,
                                            out_type, engine);
@@ -255,6 +265,10 @@ PACK_TEST(f32f32, 3, 5, generic, 0)
 PACK_TEST(i8i8, 4, 2, generic, 0)
 PACK_TEST(i32i32, 3, 4, generic, 0)
 PACK_TEST(i8i8, 8, 8, generic, 0)
+PACK_TEST(f16f16, 3, 5, generic, 0)
+PACK_TEST(bf16bf16, 16, 2, generic, 0)
+PACK_TEST(i4i4, 3, 4, generic, 0)
+PACK_TEST(i4i4, 8, 1, generic, 0)
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -274,6 +288,31 @@ PACK_ARM_64_TEST_WITH_CPU_FEATURE(i8i8, 8, 8, I8MM)
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 tests.
+#if defined(IREE_UK_ARCH_X86_64)
+
+#define PACK_X86_64_TEST(type, tile_size0, tile_size1) \
+  PACK_TEST(type, tile_size0, tile_size1, x86_64, 0)
+
+PACK_X86_64_TEST(f32f32, 8, 1)
+PACK_X86_64_TEST(f32f32, 16, 1)
+PACK_X86_64_TEST(i8i8, 8, 2)
+PACK_X86_64_TEST(i8i8, 16, 2)
+PACK_X86_64_TEST(i32i32, 8, 1)
+PACK_X86_64_TEST(i32i32, 16, 1)
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+// WASM_32 tests. These only exercise the SIMD128 tiles when built with
+// -msimd128, otherwise they fall back to the generic tiles.
+#if defined(IREE_UK_ARCH_WASM_32)
+
+PACK_TEST(f32f32, 8, 1, wasm_32, 0)
+PACK_TEST(i8i8, 8, 2, wasm_32, 0)
+PACK_TEST(i32i32, 8, 1, wasm_32, 0)
+
+#endif  // defined(IREE_UK_ARCH_WASM_32)
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
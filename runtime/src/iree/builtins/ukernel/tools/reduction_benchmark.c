@@ -0,0 +1,169 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdlib.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/flags.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/testing/benchmark.h"
+
+IREE_FLAG(int64_t, batch_min_traversal_size, 1000000000,
+          "Minimum number of bytes to be traversed in each batch.");
+
+IREE_FLAG(
+    int64_t, working_set_size, 1000000,
+    "Number of bytes to be traversed by the benchmark workload (input and "
+    "output buffers together). Matrix shapes are computed accordingly.");
+
+IREE_FLAG(int32_t, size1, 1024,
+          "Row length of the benchmarked matrices, i.e. the length of the "
+          "reduced dimension. The number of rows is computed from "
+          "--working_set_size.");
+
+typedef enum iree_reduction_benchmark_op_e {
+  iree_reduction_benchmark_op_softmax,
+  iree_reduction_benchmark_op_layer_norm,
+} iree_reduction_benchmark_op_t;
+
+typedef struct iree_reduction_benchmark_user_data_t {
+  iree_reduction_benchmark_op_t op;
+  const iree_uk_uint64_t* cpu_data;
+} iree_reduction_benchmark_user_data_t;
+
+static iree_status_t iree_reduction_benchmark(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_reduction_benchmark_user_data_t* user_data =
+      benchmark_def->user_data;
+  iree_uk_ssize_t size1 = iree_max(1, FLAG_size1);
+  iree_uk_ssize_t size0 =
+      iree_max(1, FLAG_working_set_size / (2 * size1 * sizeof(float)));
+  iree_uk_ssize_t buffer_size = size0 * size1 * sizeof(float);
+  float* in_buffer = malloc(buffer_size);
+  float* out_buffer = malloc(buffer_size);
+  for (iree_uk_ssize_t i = 0; i < size0 * size1; ++i) {
+    in_buffer[i] = ((i * 7) & 0xFF) / 32.0f - 4.0f;
+    out_buffer[i] = 0.0f;
+  }
+  iree_uk_softmax_params_t softmax_params = {
+      .in_buffer = in_buffer,
+      .in_stride0 = size1,
+      .out_buffer = out_buffer,
+      .out_stride0 = size1,
+      .size0 = size0,
+      .size1 = size1,
+      .cpu_data = user_data->cpu_data,
+  };
+  iree_uk_layer_norm_params_t layer_norm_params = {
+      .in_buffer = in_buffer,
+      .in_stride0 = size1,
+      .out_buffer = out_buffer,
+      .out_stride0 = size1,
+      .size0 = size0,
+      .size1 = size1,
+      .epsilon = 1e-5f,
+      .cpu_data = user_data->cpu_data,
+  };
+  iree_uk_int64_t total_iterations = 0;
+  iree_uk_int64_t batch_count =
+      (FLAG_batch_min_traversal_size + FLAG_working_set_size - 1) /
+      FLAG_working_set_size;
+  while (iree_benchmark_keep_running(benchmark_state,
+                                     /*batch_count=*/batch_count)) {
+    for (int i = 0; i < batch_count; ++i) {
+      switch (user_data->op) {
+        case iree_reduction_benchmark_op_softmax:
+          iree_uk_softmax(&softmax_params);
+          break;
+        case iree_reduction_benchmark_op_layer_norm:
+          iree_uk_layer_norm(&layer_norm_params);
+          break;
+      }
+    }
+    total_iterations += batch_count;
+  }
+  // Report bytes per second of input and output, as in elementwise_benchmark.
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     total_iterations * 2 * buffer_size);
+  free(in_buffer);
+  free(out_buffer);
+  return iree_ok_status();
+}
+
+static void iree_reduction_benchmark_register(
+    const iree_reduction_benchmark_user_data_t* user_data, const char* name) {
+  // Does this benchmark require an optional CPU feature?
+  if (user_data->cpu_data[0]) {
+    if ((iree_cpu_data_field(0) & user_data->cpu_data[0]) !=
+        user_data->cpu_data[0]) {
+      // The CPU does not meet this benchmark's requirements. The builtin
+      // would crash.
+      return;
+    }
+  }
+
+  // benchmark_def does not need to be static, it will be cloned.
+  const iree_benchmark_def_t benchmark_def = {
+      .flags = IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+      .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+      .minimum_duration_ns = 0,
+      .iteration_count = 0,
+      .run = iree_reduction_benchmark,
+      .user_data = user_data,
+  };
+  iree_benchmark_register(IREE_SV(name), &benchmark_def);
+}
+
+#define REDUCTION_BENCHMARK_REGISTER(_op, _cpu_data_field_0, _label)          \
+  do {                                                                        \
+    static const iree_uk_uint64_t local_cpu_data[IREE_CPU_DATA_FIELD_COUNT] = \
+        {_cpu_data_field_0};                                                  \
+    static const iree_reduction_benchmark_user_data_t user_data = {           \
+        .op = iree_reduction_benchmark_op_##_op,                              \
+        .cpu_data = local_cpu_data,                                           \
+    };                                                                        \
+    iree_reduction_benchmark_register(&user_data,                             \
+                                      "iree_uk_" #_op "_" #_label);           \
+  } while (0)
+
+#define REDUCTION_BENCHMARK_REGISTER_OPS(_cpu_data_field_0, _label) \
+  REDUCTION_BENCHMARK_REGISTER(softmax, _cpu_data_field_0, _label); \
+  REDUCTION_BENCHMARK_REGISTER(layer_norm, _cpu_data_field_0, _label);
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage("reduction_benchmark",
+                       "Benchmarks the softmax and layer-norm microkernels.\n"
+                       "\n");
+
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
+  iree_benchmark_initialize(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+
+// ARM_64 benchmarks. NEON is part of the arm64 baseline, so there is no
+// generic code path to compare against.
+#if defined(IREE_UK_ARCH_ARM_64)
+
+  REDUCTION_BENCHMARK_REGISTER_OPS(0, arm_64);
+
+#else
+
+  // Generic code paths, to get a sense of how slow generic code goes vs
+  // SIMD kernels.
+  REDUCTION_BENCHMARK_REGISTER_OPS(0, generic);
+
+#if defined(IREE_UK_ARCH_X86_64)
+
+  REDUCTION_BENCHMARK_REGISTER_OPS(IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA,
+                                   x86_64_avx2_fma);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+#endif  // defined(IREE_UK_ARCH_ARM_64)
+
+  iree_benchmark_run_specified();
+  return 0;
+}
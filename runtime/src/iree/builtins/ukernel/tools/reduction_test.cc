@@ -0,0 +1,227 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// Calls |test| with the CPU data disabling all optional CPU features and with
+// the CPU data of this device.
+template <typename F>
+void ForEachCpuData(F test) {
+  static const iree_uk_uint64_t no_cpu_data[IREE_CPU_DATA_FIELD_COUNT] = {0};
+  test(no_cpu_data);
+  test((const iree_uk_uint64_t*)iree_cpu_data_fields());
+}
+
+// Row lengths around multiples of the vector widths and of the unrolled main
+// loops, and one long row.
+const iree_uk_ssize_t kRowSizes[] = {1,  2,  3,  4,  5,  7,  8,   9,
+                                     15, 16, 17, 31, 32, 33, 100, 4097};
+
+// Returns a size0 x stride0 matrix of random values uniform in
+// [center - radius, center + radius].
+std::vector<float> RandomMatrix(std::mt19937& engine, iree_uk_ssize_t size0,
+                                iree_uk_ssize_t stride0, float center,
+                                float radius) {
+  std::uniform_real_distribution<float> distribution(center - radius,
+                                                     center + radius);
+  std::vector<float> matrix(size0 * stride0);
+  for (float& value : matrix) value = distribution(engine);
+  return matrix;
+}
+
+void ReferenceSoftmaxRow(const float* in, float* out, iree_uk_ssize_t size) {
+  double max = *std::max_element(in, in + size);
+  double sum = 0;
+  for (iree_uk_ssize_t j = 0; j < size; ++j) sum += std::exp(in[j] - max);
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    out[j] = std::exp(in[j] - max) / sum;
+  }
+}
+
+void ReferenceLayerNormRow(const float* in, float* out, iree_uk_ssize_t size,
+                           const float* gamma, const float* beta,
+                           float epsilon) {
+  double mean = 0;
+  for (iree_uk_ssize_t j = 0; j < size; ++j) mean += in[j];
+  mean /= size;
+  double variance = 0;
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    variance += (in[j] - mean) * (in[j] - mean);
+  }
+  variance /= size;
+  double inv_stddev = 1 / std::sqrt(variance + epsilon);
+  for (iree_uk_ssize_t j = 0; j < size; ++j) {
+    double y = (in[j] - mean) * inv_stddev;
+    if (gamma) y *= gamma[j];
+    if (beta) y += beta[j];
+    out[j] = y;
+  }
+}
+
+// Tests softmax on 3 rows of random values in [center - radius,
+// center + radius], in place and not.
+void TestSoftmax(float center, float radius) {
+  std::mt19937 engine;
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    for (iree_uk_ssize_t size1 : kRowSizes) {
+      for (bool in_place : {false, true}) {
+        iree_uk_ssize_t size0 = 3;
+        // A row padding that isn't a multiple of the vector widths.
+        iree_uk_ssize_t stride0 = size1 + 3;
+        std::vector<float> in =
+            RandomMatrix(engine, size0, stride0, center, radius);
+        std::vector<float> out(in.size(), 0.f);
+        std::vector<float> expected(in.size(), 0.f);
+        for (iree_uk_ssize_t i = 0; i < size0; ++i) {
+          ReferenceSoftmaxRow(in.data() + i * stride0,
+                              expected.data() + i * stride0, size1);
+        }
+        if (in_place) out = in;
+        iree_uk_softmax_params_t params = {};
+        params.in_buffer = in_place ? out.data() : in.data();
+        params.in_stride0 = stride0;
+        params.out_buffer = out.data();
+        params.out_stride0 = stride0;
+        params.size0 = size0;
+        params.size1 = size1;
+        params.cpu_data = cpu_data;
+        iree_uk_softmax(&params);
+        for (iree_uk_ssize_t i = 0; i < size0; ++i) {
+          for (iree_uk_ssize_t j = 0; j < size1; ++j) {
+            iree_uk_ssize_t k = i * stride0 + j;
+            ASSERT_NEAR(out[k], expected[k], 1e-5f * expected[k] + 1e-7f)
+                << "size1=" << size1 << " i=" << i << " j=" << j;
+          }
+          // The row padding is untouched.
+          for (iree_uk_ssize_t j = size1; j < stride0 && !in_place; ++j) {
+            ASSERT_EQ(out[i * stride0 + j], 0.f);
+          }
+        }
+      }
+    }
+  });
+}
+
+// Tests layer normalization on rows of random values in
+// [center - radius, center + radius], with and without gamma and beta.
+void TestLayerNorm(float center, float radius) {
+  std::mt19937 engine;
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    for (iree_uk_ssize_t size1 : kRowSizes) {
+      for (bool affine : {false, true}) {
+        iree_uk_ssize_t size0 = 3;
+        iree_uk_ssize_t stride0 = size1 + 3;
+        std::vector<float> in =
+            RandomMatrix(engine, size0, stride0, center, radius);
+        std::vector<float> gamma = RandomMatrix(engine, 1, size1, 1.f, 0.5f);
+        std::vector<float> beta = RandomMatrix(engine, 1, size1, 0.f, 1.f);
+        std::vector<float> out(in.size(), 0.f);
+        std::vector<float> expected(in.size(), 0.f);
+        float epsilon = 1e-5f;
+        for (iree_uk_ssize_t i = 0; i < size0; ++i) {
+          ReferenceLayerNormRow(
+              in.data() + i * stride0, expected.data() + i * stride0, size1,
+              affine ? gamma.data() : nullptr, affine ? beta.data() : nullptr,
+              epsilon);
+        }
+        iree_uk_layer_norm_params_t params = {};
+        params.in_buffer = in.data();
+        params.in_stride0 = stride0;
+        params.out_buffer = out.data();
+        params.out_stride0 = stride0;
+        params.size0 = size0;
+        params.size1 = size1;
+        params.gamma = affine ? gamma.data() : nullptr;
+        params.beta = affine ? beta.data() : nullptr;
+        params.epsilon = epsilon;
+        params.cpu_data = cpu_data;
+        iree_uk_layer_norm(&params);
+        // The rounding of the inputs to the mean dominates the error.
+        float tolerance = 1e-4f * std::max(1.f, std::abs(center) / radius);
+        for (iree_uk_ssize_t i = 0; i < size0; ++i) {
+          for (iree_uk_ssize_t j = 0; j < size1; ++j) {
+            iree_uk_ssize_t k = i * stride0 + j;
+            ASSERT_NEAR(out[k], expected[k], tolerance)
+                << "size1=" << size1 << " i=" << i << " j=" << j;
+          }
+        }
+      }
+    }
+  });
+}
+
+TEST(ReductionTest, softmax) { TestSoftmax(0.f, 10.f); }
+
+// Large values, whose exponentials would overflow without subtracting the
+// maximum.
+TEST(ReductionTest, softmax_large_values) { TestSoftmax(500.f, 50.f); }
+
+TEST(ReductionTest, softmax_minus_inf) {
+  // A masked-out attention score contributes 0.
+  float in[5] = {1.f, -INFINITY, 2.f, -INFINITY, 3.f};
+  float out[5];
+  float expected[5];
+  ReferenceSoftmaxRow(in, expected, 5);
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    iree_uk_softmax_params_t params = {};
+    params.in_buffer = in;
+    params.in_stride0 = 5;
+    params.out_buffer = out;
+    params.out_stride0 = 5;
+    params.size0 = 1;
+    params.size1 = 5;
+    params.cpu_data = cpu_data;
+    iree_uk_softmax(&params);
+    for (int j = 0; j < 5; ++j) {
+      EXPECT_NEAR(out[j], expected[j], 1e-6f);
+    }
+  });
+}
+
+TEST(ReductionTest, layer_norm) { TestLayerNorm(0.f, 1.f); }
+
+// Rows with a large mean relative to their deviation, which the single-pass
+// computation of the variance must handle without cancellation.
+TEST(ReductionTest, layer_norm_large_mean) { TestLayerNorm(100.f, 1.f); }
+
+TEST(ReductionTest, layer_norm_constant_row) {
+  // The variance is 0, so the output is 0 (times gamma) plus beta.
+  std::vector<float> in(37, 3.f);
+  std::vector<float> out(in.size());
+  std::vector<float> beta(in.size(), 0.5f);
+  ForEachCpuData([&](const iree_uk_uint64_t* cpu_data) {
+    iree_uk_layer_norm_params_t params = {};
+    params.in_buffer = in.data();
+    params.in_stride0 = in.size();
+    params.out_buffer = out.data();
+    params.out_stride0 = out.size();
+    params.size0 = 1;
+    params.size1 = in.size();
+    params.beta = beta.data();
+    params.epsilon = 1e-5f;
+    params.cpu_data = cpu_data;
+    iree_uk_layer_norm(&params);
+    for (float value : out) EXPECT_EQ(value, 0.5f);
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+  return RUN_ALL_TESTS();
+}
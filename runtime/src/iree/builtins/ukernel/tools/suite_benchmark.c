@@ -0,0 +1,777 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Benchmarks a suite of ukernel ops and shapes given by a manifest, reporting
+// each against the roofline of this machine: the lesser of its compute peak
+// and its memory bandwidth times the arithmetic intensity of the op. Both
+// peaks are measured by probes at startup unless given by flags.
+//
+// The suite is meant to be run with --benchmark_format=json (or
+// --benchmark_out=<file>), which records the measured peaks in the context
+// and a `roofline_pct` counter for each benchmark, so that results can be
+// compared across commits with the compare.py tool of the benchmark library.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/flags.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/builtins/ukernel/tools/ukernel_test_utils.h"
+#include "iree/testing/benchmark.h"
+
+#if defined(IREE_UK_ARCH_ARM_64)
+#include <arm_neon.h>
+#elif defined(IREE_UK_ARCH_X86_64)
+#include <immintrin.h>
+#endif
+
+IREE_FLAG(string, manifest, "",
+          "Path to a manifest file listing the benchmarks to run, one per "
+          "line, as `op type tile shape cpu`. Lines starting with `#` are "
+          "comments. See iree_suite_default_manifest for the format. If "
+          "empty, runs the default manifest for this architecture.");
+IREE_FLAG(double, peak_gflops, 0.0,
+          "Single-core f32 compute peak in GFLOP/s to report against. If 0, "
+          "measured by an FMA throughput probe.");
+IREE_FLAG(double, peak_gbps, 0.0,
+          "Single-core memory bandwidth in GB/s to report against. If 0, "
+          "measured by a STREAM triad probe.");
+IREE_FLAG(int64_t, stream_size, 256 * 1024 * 1024,
+          "Number of bytes traversed by the STREAM triad probe. Must be "
+          "several times the size of the last-level cache.");
+IREE_FLAG(int32_t, probe_repetitions, 5,
+          "Number of runs of each probe, keeping the fastest.");
+
+// The default manifest. Fields are separated by whitespace:
+//   op:    mmt4d, pack, unpack, softmax or layer_norm.
+//   type:  the op type, e.g. f32f32f32 for mmt4d or f32f32 for pack. The
+//          f32-only softmax and layer_norm take f32.
+//   tile:  M0xN0xK0 for mmt4d, the inner tile sizes for pack and unpack, and
+//          `-` for softmax and layer_norm.
+//   shape: MxNxK for mmt4d, and the rows x columns of the unpacked matrix for
+//          the other ops. Shapes are rounded up to whole tiles.
+//   cpu:   `host` for the CPU data of this device, `baseline` for none of the
+//          optional CPU features, or `+`-separated CPU feature names as in
+//          iree/schemas/cpu_data.h, e.g. `avx512_base+avx512vnni`.
+//          Benchmarks requiring features that this CPU lacks are skipped.
+// The shapes are those of a transformer encoder layer (BERT-base, sequence
+// length 384) and of token generation in a decoder (matrix-vector products).
+#if defined(IREE_UK_ARCH_ARM_64)
+#define IREE_SUITE_F32_TILE "8x8x1"
+#define IREE_SUITE_I8_TILE "8x8x4"
+#define IREE_SUITE_GEMV_TILE "1x8x1"
+#define IREE_SUITE_PACK_TILE "8x1"
+#define IREE_SUITE_UNPACK_TILE "8x8"
+#elif defined(IREE_UK_ARCH_X86_64)
+#define IREE_SUITE_F32_TILE "8x8x1"
+#define IREE_SUITE_I8_TILE "8x8x2"
+#define IREE_SUITE_GEMV_TILE "1x8x1"
+#define IREE_SUITE_PACK_TILE "8x1"
+#define IREE_SUITE_UNPACK_TILE "8x8"
+#else
+#define IREE_SUITE_F32_TILE "4x4x1"
+#define IREE_SUITE_I8_TILE "4x4x1"
+#define IREE_SUITE_GEMV_TILE "1x4x1"
+#define IREE_SUITE_PACK_TILE "4x1"
+#define IREE_SUITE_UNPACK_TILE "4x4"
+#endif  // IREE_UK_ARCH_*
+static const char iree_suite_default_manifest[] =
+    "mmt4d f32f32f32 " IREE_SUITE_F32_TILE " 384x768x768 host\n"
+    "mmt4d f32f32f32 " IREE_SUITE_F32_TILE " 384x3072x768 host\n"
+    "mmt4d f32f32f32 " IREE_SUITE_F32_TILE " 384x768x3072 host\n"
+    "mmt4d f32f32f32 " IREE_SUITE_F32_TILE " 384x384x64 host\n"
+    "mmt4d i8i8i32 " IREE_SUITE_I8_TILE " 384x768x768 host\n"
+    "mmt4d i8i8i32 " IREE_SUITE_I8_TILE " 384x3072x768 host\n"
+    "mmt4d f32f32f32 " IREE_SUITE_GEMV_TILE " 1x4096x4096 host\n"
+    "pack f32f32 " IREE_SUITE_PACK_TILE " 384x768 host\n"
+    "pack i8i8 " IREE_SUITE_PACK_TILE " 384x768 host\n"
+    "unpack f32f32 " IREE_SUITE_UNPACK_TILE " 384x768 host\n"
+    "unpack i32i32 " IREE_SUITE_UNPACK_TILE " 384x768 host\n"
+    "softmax f32 - 4608x384 host\n"
+    "layer_norm f32 - 384x768 host\n";
+
+typedef enum iree_suite_op_e {
+  iree_suite_op_mmt4d,
+  iree_suite_op_pack,
+  iree_suite_op_unpack,
+  iree_suite_op_softmax,
+  iree_suite_op_layer_norm,
+} iree_suite_op_t;
+
+// One manifest entry. The user data of each benchmark must outlive the
+// benchmark registry, which lives until the process exits.
+typedef struct iree_suite_benchmark_user_data_t {
+  iree_suite_op_t op;
+  // An iree_uk_{mmt4d,pack,unpack}_type_t, unused by softmax and layer_norm.
+  iree_uk_uint32_t type;
+  // M0, N0, K0 for mmt4d, the 2 inner tile sizes for pack and unpack.
+  int tile[3];
+  // M, N, K for mmt4d, rows and columns of the unpacked matrix otherwise.
+  int shape[3];
+  iree_uk_uint64_t cpu_data[IREE_CPU_DATA_FIELD_COUNT];
+} iree_suite_benchmark_user_data_t;
+
+// The peaks that benchmarks are reported against, in FLOP/s and bytes/s.
+static double iree_suite_peak_flops = 0.0;
+static double iree_suite_peak_bandwidth = 0.0;
+
+//===----------------------------------------------------------------------===//
+// Peak probes
+//===----------------------------------------------------------------------===//
+
+IREE_UK_ATTRIBUTE_NOINLINE static void iree_suite_stream_triad(
+    float* IREE_RESTRICT a, const float* IREE_RESTRICT b,
+    const float* IREE_RESTRICT c, float scalar, iree_host_size_t size) {
+  for (iree_host_size_t i = 0; i < size; ++i) a[i] = b[i] + scalar * c[i];
+}
+
+// Returns the memory bandwidth in bytes/s achieved by the STREAM triad over
+// buffers totalling FLAG_stream_size bytes, counting 3 accesses per element as
+// STREAM does.
+static double iree_suite_probe_bandwidth(void) {
+  iree_host_size_t size = FLAG_stream_size / (3 * sizeof(float));
+  float* a = malloc(size * sizeof(float));
+  float* b = malloc(size * sizeof(float));
+  float* c = malloc(size * sizeof(float));
+  for (iree_host_size_t i = 0; i < size; ++i) {
+    a[i] = 0.0f;
+    b[i] = 1.0f;
+    c[i] = 2.0f;
+  }
+  iree_time_t best_ns = IREE_TIME_INFINITE_FUTURE;
+  for (int r = 0; r < FLAG_probe_repetitions; ++r) {
+    iree_time_t start_ns = iree_time_now();
+    iree_suite_stream_triad(a, b, c, 3.0f, size);
+    best_ns = iree_min(best_ns, iree_time_now() - start_ns);
+  }
+  free(a);
+  free(b);
+  free(c);
+  return 3.0 * size * sizeof(float) / (iree_max(best_ns, 1) * 1e-9);
+}
+
+// Defines a function |_name| running |iterations| steps of |_accumulators|
+// independent chains of the vector multiply-add |_fma|, enough to cover the
+// FMA latency on the targeted cores, and returning the number of FLOPs.
+#define IREE_SUITE_ACCUMULATORS_12(_macro, ...)                    \
+  _macro(0, __VA_ARGS__) _macro(1, __VA_ARGS__) _macro(2, __VA_ARGS__)   \
+      _macro(3, __VA_ARGS__) _macro(4, __VA_ARGS__) _macro(5, __VA_ARGS__) \
+      _macro(6, __VA_ARGS__) _macro(7, __VA_ARGS__) _macro(8, __VA_ARGS__) \
+      _macro(9, __VA_ARGS__) _macro(10, __VA_ARGS__) _macro(11, __VA_ARGS__)
+#define IREE_SUITE_ACCUMULATORS_16(_macro, ...)                         \
+  IREE_SUITE_ACCUMULATORS_12(_macro, __VA_ARGS__) _macro(12, __VA_ARGS__) \
+      _macro(13, __VA_ARGS__) _macro(14, __VA_ARGS__) _macro(15, __VA_ARGS__)
+#define IREE_SUITE_FMA_DECLARE(_i, _vector_t, _set1) \
+  _vector_t acc##_i = _set1((float)_i);
+#define IREE_SUITE_FMA_STEP(_i, _fma) acc##_i = _fma(acc##_i, m, a);
+#define IREE_SUITE_FMA_SUM(_i, _add) sum = _add(sum, acc##_i);
+#define IREE_SUITE_DEFINE_FMA_PROBE(_name, _target, _vector_t, _lanes, _set1, \
+                                    _fma, _add, _accumulators)               \
+  _target IREE_UK_ATTRIBUTE_NOINLINE static double _name(                    \
+      iree_host_size_t iterations, float* result) {                          \
+    _vector_t m = _set1(0.999999f);                                          \
+    _vector_t a = _set1(1e-6f);                                              \
+    _vector_t sum = _set1(0.0f);                                             \
+    IREE_SUITE_ACCUMULATORS_##_accumulators(IREE_SUITE_FMA_DECLARE,          \
+                                            _vector_t, _set1)                \
+    for (iree_host_size_t i = 0; i < iterations; ++i) {                      \
+      IREE_SUITE_ACCUMULATORS_##_accumulators(IREE_SUITE_FMA_STEP, _fma)     \
+    }                                                                        \
+    IREE_SUITE_ACCUMULATORS_##_accumulators(IREE_SUITE_FMA_SUM, _add)        \
+    float lanes[_lanes];                                                     \
+    memcpy(lanes, &sum, sizeof lanes);                                       \
+    *result = lanes[0];                                                      \
+    return 2.0 * _lanes * _accumulators * iterations;                        \
+  }
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IREE_SUITE_TARGET(_features) __attribute__((target(_features)))
+#else
+#define IREE_SUITE_TARGET(_features)
+#endif
+
+#if defined(IREE_UK_ARCH_ARM_64)
+
+#define IREE_SUITE_NEON_FMA(acc, m, a) vfmaq_f32(a, acc, m)
+IREE_SUITE_DEFINE_FMA_PROBE(iree_suite_fma_probe_neon, , float32x4_t, 4,
+                            vdupq_n_f32, IREE_SUITE_NEON_FMA, vaddq_f32, 16)
+
+#elif defined(IREE_UK_ARCH_X86_64)
+
+// SSE has no FMA: a multiply and an add count as 2 FLOPs as well.
+#define IREE_SUITE_SSE_FMA(acc, m, a) _mm_add_ps(_mm_mul_ps(acc, m), a)
+IREE_SUITE_DEFINE_FMA_PROBE(iree_suite_fma_probe_sse, , __m128, 4, _mm_set1_ps,
+                            IREE_SUITE_SSE_FMA, _mm_add_ps, 12)
+// 12 accumulators, leaving room for |m| and |a| in the 16 YMM registers.
+IREE_SUITE_DEFINE_FMA_PROBE(iree_suite_fma_probe_avx2_fma,
+                            IREE_SUITE_TARGET("avx2,fma"), __m256, 8,
+                            _mm256_set1_ps, _mm256_fmadd_ps, _mm256_add_ps, 12)
+IREE_SUITE_DEFINE_FMA_PROBE(iree_suite_fma_probe_avx512,
+                            IREE_SUITE_TARGET("avx512f"), __m512, 16,
+                            _mm512_set1_ps, _mm512_fmadd_ps, _mm512_add_ps, 16)
+
+#else
+
+#define IREE_SUITE_SCALAR_SET1(x) (x)
+#define IREE_SUITE_SCALAR_FMA(acc, m, a) ((acc) * (m) + (a))
+#define IREE_SUITE_SCALAR_ADD(x, y) ((x) + (y))
+IREE_SUITE_DEFINE_FMA_PROBE(iree_suite_fma_probe_scalar, , float, 1,
+                            IREE_SUITE_SCALAR_SET1, IREE_SUITE_SCALAR_FMA,
+                            IREE_SUITE_SCALAR_ADD, 16)
+
+#endif  // IREE_UK_ARCH_*
+
+typedef double (*iree_suite_fma_probe_t)(iree_host_size_t iterations,
+                                         float* result);
+
+// Returns the f32 compute peak in FLOP/s of the widest FMA available on this
+// CPU, and its name in |out_name|. Integer types with dot-product
+// instructions can exceed it.
+static double iree_suite_probe_flops(const char** out_name) {
+  iree_suite_fma_probe_t probe = 0;
+#if defined(IREE_UK_ARCH_ARM_64)
+  probe = iree_suite_fma_probe_neon;
+  *out_name = "neon";
+#elif defined(IREE_UK_ARCH_X86_64)
+  iree_uk_uint64_t cpu_data_0 = iree_cpu_data_field(0);
+  if (cpu_data_0 & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    probe = iree_suite_fma_probe_avx512;
+    *out_name = "avx512";
+  } else if (cpu_data_0 & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    probe = iree_suite_fma_probe_avx2_fma;
+    *out_name = "avx2_fma";
+  } else {
+    probe = iree_suite_fma_probe_sse;
+    *out_name = "sse";
+  }
+#else
+  probe = iree_suite_fma_probe_scalar;
+  *out_name = "scalar";
+#endif  // IREE_UK_ARCH_*
+  const iree_host_size_t iterations = 1 << 22;
+  double best = 0.0;
+  for (int r = 0; r < FLAG_probe_repetitions; ++r) {
+    float result = 0.0f;
+    iree_time_t start_ns = iree_time_now();
+    double flops = probe(iterations, &result);
+    iree_time_t duration_ns = iree_max(iree_time_now() - start_ns, 1);
+    // The result is only used to keep the loop alive.
+    if (result < 0.0f) fprintf(stderr, "unexpected FMA probe result\n");
+    best = iree_max(best, flops / (duration_ns * 1e-9));
+  }
+  return best;
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmarks
+//===----------------------------------------------------------------------===//
+
+static iree_uk_ssize_t iree_suite_ceildiv(iree_uk_ssize_t a,
+                                          iree_uk_ssize_t b) {
+  return (a + b - 1) / b;
+}
+
+// Returns a buffer of |*size| bytes of random |type| values, |*size| being
+// computed from a 2D shape.
+static void* iree_suite_random_buffer(iree_uk_type_t type,
+                                      iree_uk_ssize_t size0,
+                                      iree_uk_ssize_t size1,
+                                      iree_uk_ssize_t* out_size) {
+  *out_size = iree_uk_test_2d_buffer_length(type, size0, size1);
+  void* buffer = malloc(*out_size);
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  iree_uk_test_write_random_buffer(buffer, *out_size, type, engine);
+  iree_uk_test_random_engine_destroy(engine);
+  return buffer;
+}
+
+// Reports the throughput of |iterations| ops run in |duration_ns|, each
+// performing |flops| FLOPs (0 for data movement ops) and traversing |bytes|
+// bytes, and the achieved percentage of the roofline at the arithmetic
+// intensity flops / bytes. The bandwidth peak is that of the memory, so ops
+// whose working set fits in the caches can exceed 100%.
+static void iree_suite_report(iree_benchmark_state_t* benchmark_state,
+                              iree_uk_int64_t iterations,
+                              iree_time_t duration_ns, double flops,
+                              double bytes) {
+  iree_benchmark_set_bytes_processed(benchmark_state, iterations * bytes);
+  double seconds = iree_max(duration_ns, 1) * 1e-9;
+  double roofline_pct = 0.0;
+  if (flops > 0.0) {
+    iree_benchmark_set_items_processed(benchmark_state, iterations * flops);
+    double attainable_flops = iree_min(
+        iree_suite_peak_flops, iree_suite_peak_bandwidth * (flops / bytes));
+    roofline_pct = 100.0 * iterations * flops / (seconds * attainable_flops);
+    iree_benchmark_set_counter(benchmark_state, "arith_intensity",
+                               flops / bytes);
+  } else {
+    roofline_pct =
+        100.0 * iterations * bytes / (seconds * iree_suite_peak_bandwidth);
+  }
+  iree_benchmark_set_counter(benchmark_state, "roofline_pct", roofline_pct);
+}
+
+static iree_status_t iree_suite_mmt4d_benchmark(
+    const iree_suite_benchmark_user_data_t* user_data,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_uk_mmt4d_params_t params;
+  memset(&params, 0, sizeof params);
+  params.type = user_data->type;
+  params.M0 = user_data->tile[0];
+  params.N0 = user_data->tile[1];
+  params.K0 = user_data->tile[2];
+  params.M = iree_suite_ceildiv(user_data->shape[0], params.M0);
+  params.N = iree_suite_ceildiv(user_data->shape[1], params.N0);
+  params.K = iree_suite_ceildiv(user_data->shape[2], params.K0);
+  params.lhs_stride = params.K * params.M0 * params.K0;
+  params.rhs_stride = params.K * params.N0 * params.K0;
+  params.out_stride = params.N * params.M0 * params.N0;
+  params.cpu_data = user_data->cpu_data;
+  iree_uk_ssize_t lhs_size, rhs_size, out_size;
+  void* lhs_buffer =
+      iree_suite_random_buffer(iree_uk_mmt4d_lhs_type(params.type), params.M,
+                               params.lhs_stride, &lhs_size);
+  void* rhs_buffer =
+      iree_suite_random_buffer(iree_uk_mmt4d_rhs_type(params.type), params.N,
+                               params.rhs_stride, &rhs_size);
+  void* out_buffer =
+      iree_suite_random_buffer(iree_uk_mmt4d_out_type(params.type), params.M,
+                               params.out_stride, &out_size);
+  params.lhs_buffer = lhs_buffer;
+  params.rhs_buffer = rhs_buffer;
+  params.out_buffer = out_buffer;
+  iree_uk_int64_t iterations = 0;
+  iree_time_t start_ns = iree_time_now();
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_uk_mmt4d(&params);
+    ++iterations;
+  }
+  iree_time_t duration_ns = iree_time_now() - start_ns;
+  // Padded FLOPs, i.e. the work done by the kernel.
+  double flops = 2.0 * params.M * params.N * params.K * params.M0 * params.N0 *
+                 params.K0;
+  iree_suite_report(benchmark_state, iterations, duration_ns, flops,
+                    lhs_size + rhs_size + out_size);
+  free(lhs_buffer);
+  free(rhs_buffer);
+  free(out_buffer);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_suite_pack_benchmark(
+    const iree_suite_benchmark_user_data_t* user_data,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_uk_pack_params_t params;
+  memset(&params, 0, sizeof params);
+  params.type = user_data->type;
+  params.in_size0 = user_data->shape[0];
+  params.in_size1 = user_data->shape[1];
+  params.in_stride0 = params.in_size1;
+  params.out_size2 = user_data->tile[0];
+  params.out_size3 = user_data->tile[1];
+  params.out_size0 = iree_suite_ceildiv(params.in_size0, params.out_size2);
+  params.out_size1 = iree_suite_ceildiv(params.in_size1, params.out_size3);
+  params.out_stride0 = params.out_size1 * params.out_size2 * params.out_size3;
+  params.cpu_data = user_data->cpu_data;
+  iree_uk_type_t out_type = iree_uk_pack_out_type(params.type);
+  iree_uk_ssize_t in_size, out_size;
+  void* in_buffer =
+      iree_suite_random_buffer(iree_uk_pack_in_type(params.type),
+                               params.in_size0, params.in_stride0, &in_size);
+  void* out_buffer = iree_suite_random_buffer(out_type, params.out_size0,
+                                              params.out_stride0, &out_size);
+  iree_uk_ssize_t padding_size = iree_max(1, iree_uk_type_size(out_type));
+  void* padding_value_buffer = calloc(1, padding_size);
+  params.in_buffer = in_buffer;
+  params.out_buffer = out_buffer;
+  params.padding_value = padding_value_buffer;
+  iree_uk_int64_t iterations = 0;
+  iree_time_t start_ns = iree_time_now();
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_uk_pack(&params);
+    ++iterations;
+  }
+  iree_time_t duration_ns = iree_time_now() - start_ns;
+  iree_suite_report(benchmark_state, iterations, duration_ns, 0.0,
+                    in_size + out_size);
+  free(in_buffer);
+  free(out_buffer);
+  free(padding_value_buffer);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_suite_unpack_benchmark(
+    const iree_suite_benchmark_user_data_t* user_data,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_uk_unpack_params_t params;
+  memset(&params, 0, sizeof params);
+  params.type = user_data->type;
+  params.out_size0 = user_data->shape[0];
+  params.out_size1 = user_data->shape[1];
+  params.out_stride0 = params.out_size1;
+  params.in_size2 = user_data->tile[0];
+  params.in_size3 = user_data->tile[1];
+  params.in_size0 = iree_suite_ceildiv(params.out_size0, params.in_size2);
+  params.in_size1 = iree_suite_ceildiv(params.out_size1, params.in_size3);
+  params.in_stride0 = params.in_size1 * params.in_size2 * params.in_size3;
+  params.cpu_data = user_data->cpu_data;
+  iree_uk_ssize_t in_size, out_size;
+  void* in_buffer =
+      iree_suite_random_buffer(iree_uk_unpack_in_type(params.type),
+                               params.in_size0, params.in_stride0, &in_size);
+  void* out_buffer =
+      iree_suite_random_buffer(iree_uk_unpack_out_type(params.type),
+                               params.out_size0, params.out_stride0, &out_size);
+  params.in_buffer = in_buffer;
+  params.out_buffer = out_buffer;
+  iree_uk_int64_t iterations = 0;
+  iree_time_t start_ns = iree_time_now();
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_uk_unpack(&params);
+    ++iterations;
+  }
+  iree_time_t duration_ns = iree_time_now() - start_ns;
+  iree_suite_report(benchmark_state, iterations, duration_ns, 0.0,
+                    in_size + out_size);
+  free(in_buffer);
+  free(out_buffer);
+  return iree_ok_status();
+}
+
+// Softmax and layer_norm: memory-bound, reported against the bandwidth.
+static iree_status_t iree_suite_reduction_benchmark(
+    const iree_suite_benchmark_user_data_t* user_data,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_uk_ssize_t size0 = user_data->shape[0];
+  iree_uk_ssize_t size1 = user_data->shape[1];
+  iree_uk_ssize_t in_size, out_size;
+  float* in_buffer =
+      iree_suite_random_buffer(IREE_UK_TYPE_FLOAT_32, size0, size1, &in_size);
+  float* out_buffer =
+      iree_suite_random_buffer(IREE_UK_TYPE_FLOAT_32, size0, size1, &out_size);
+  iree_uk_softmax_params_t softmax_params = {
+      .in_buffer = in_buffer,
+      .in_stride0 = size1,
+      .out_buffer = out_buffer,
+      .out_stride0 = size1,
+      .size0 = size0,
+      .size1 = size1,
+      .cpu_data = user_data->cpu_data,
+  };
+  iree_uk_layer_norm_params_t layer_norm_params = {
+      .in_buffer = in_buffer,
+      .in_stride0 = size1,
+      .out_buffer = out_buffer,
+      .out_stride0 = size1,
+      .size0 = size0,
+      .size1 = size1,
+      .epsilon = 1e-5f,
+      .cpu_data = user_data->cpu_data,
+  };
+  iree_uk_int64_t iterations = 0;
+  iree_time_t start_ns = iree_time_now();
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    if (user_data->op == iree_suite_op_softmax) {
+      iree_uk_softmax(&softmax_params);
+    } else {
+      iree_uk_layer_norm(&layer_norm_params);
+    }
+    ++iterations;
+  }
+  iree_time_t duration_ns = iree_time_now() - start_ns;
+  iree_suite_report(benchmark_state, iterations, duration_ns, 0.0,
+                    in_size + out_size);
+  free(in_buffer);
+  free(out_buffer);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_suite_benchmark(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_suite_benchmark_user_data_t* user_data = benchmark_def->user_data;
+  switch (user_data->op) {
+    case iree_suite_op_mmt4d:
+      return iree_suite_mmt4d_benchmark(user_data, benchmark_state);
+    case iree_suite_op_pack:
+      return iree_suite_pack_benchmark(user_data, benchmark_state);
+    case iree_suite_op_unpack:
+      return iree_suite_unpack_benchmark(user_data, benchmark_state);
+    case iree_suite_op_softmax:
+    case iree_suite_op_layer_norm:
+      return iree_suite_reduction_benchmark(user_data, benchmark_state);
+  }
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "unhandled op");
+}
+
+//===----------------------------------------------------------------------===//
+// Manifest parsing
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_suite_name_value_t {
+  const char* name;
+  iree_uk_uint64_t value;
+} iree_suite_name_value_t;
+
+static const iree_suite_name_value_t iree_suite_ops[] = {
+    {"mmt4d", iree_suite_op_mmt4d},
+    {"pack", iree_suite_op_pack},
+    {"unpack", iree_suite_op_unpack},
+    {"softmax", iree_suite_op_softmax},
+    {"layer_norm", iree_suite_op_layer_norm},
+};
+
+// The mmt4d types with an INT_4 RHS are left out, as they need quantization
+// scales.
+static const iree_suite_name_value_t iree_suite_mmt4d_types[] = {
+    {"f32f32f32", iree_uk_mmt4d_type_f32f32f32},
+    {"i8i8i32", iree_uk_mmt4d_type_i8i8i32},
+    {"f16f16f32", iree_uk_mmt4d_type_f16f16f32},
+    {"f16f16f16", iree_uk_mmt4d_type_f16f16f16},
+    {"bf16bf16f32", iree_uk_mmt4d_type_bf16bf16f32},
+    {"bf16bf16bf16", iree_uk_mmt4d_type_bf16bf16bf16},
+};
+
+static const iree_suite_name_value_t iree_suite_pack_types[] = {
+    {"f32f32", iree_uk_pack_type_f32f32},
+    {"i8i8", iree_uk_pack_type_i8i8},
+    {"i32i32", iree_uk_pack_type_i32i32},
+    {"f16f16", iree_uk_pack_type_f16f16},
+    {"bf16bf16", iree_uk_pack_type_bf16bf16},
+};
+
+static const iree_suite_name_value_t iree_suite_unpack_types[] = {
+    {"f32f32", iree_uk_unpack_type_f32f32},
+    {"i8i8", iree_uk_unpack_type_i8i8},
+    {"i32i32", iree_uk_unpack_type_i32i32},
+    {"f16f16", iree_uk_unpack_type_f16f16},
+    {"bf16bf16", iree_uk_unpack_type_bf16bf16},
+};
+
+static const iree_suite_name_value_t iree_suite_reduction_types[] = {
+    {"f32", 0},
+};
+
+static const iree_suite_name_value_t iree_suite_cpu_features[] = {
+#if defined(IREE_UK_ARCH_ARM_64)
+    {"dotprod", IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD},
+    {"i8mm", IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM},
+    {"sve", IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE},
+    {"sve2", IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE2},
+    {"sme", IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME},
+#elif defined(IREE_UK_ARCH_X86_64)
+    {"avx2_fma", IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA},
+    {"avx512_base", IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE},
+    {"avx512vnni", IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI},
+    {"avx512bf16", IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16},
+#endif  // IREE_UK_ARCH_*
+    {"", 0},  // Keeps the array non-empty on other architectures.
+};
+
+static bool iree_suite_lookup(const iree_suite_name_value_t* table,
+                              iree_host_size_t table_size,
+                              iree_string_view_t name,
+                              iree_uk_uint64_t* out_value) {
+  for (iree_host_size_t i = 0; i < table_size; ++i) {
+    if (iree_string_view_equal(name, iree_make_cstring_view(table[i].name))) {
+      *out_value = table[i].value;
+      return true;
+    }
+  }
+  return false;
+}
+
+#define IREE_SUITE_LOOKUP(_table, _name, _out_value) \
+  iree_suite_lookup(_table, IREE_ARRAYSIZE(_table), _name, _out_value)
+
+// Parses the `cpu` field of a manifest entry into |cpu_data|. Returns false
+// if the field is invalid.
+static bool iree_suite_parse_cpu_data(const char* str,
+                                      iree_uk_uint64_t* cpu_data) {
+  memset(cpu_data, 0, IREE_CPU_DATA_FIELD_COUNT * sizeof(*cpu_data));
+  iree_string_view_t features = iree_make_cstring_view(str);
+  if (iree_string_view_equal(features, IREE_SV("host"))) {
+    memcpy(cpu_data, iree_cpu_data_fields(),
+           IREE_CPU_DATA_FIELD_COUNT * sizeof(*cpu_data));
+    return true;
+  }
+  if (iree_string_view_equal(features, IREE_SV("baseline"))) return true;
+  while (!iree_string_view_is_empty(features)) {
+    iree_string_view_t feature;
+    iree_string_view_split(features, '+', &feature, &features);
+    iree_uk_uint64_t bit = 0;
+    if (!IREE_SUITE_LOOKUP(iree_suite_cpu_features, feature, &bit) || !bit) {
+      return false;
+    }
+    cpu_data[0] |= bit;
+  }
+  return true;
+}
+
+// Parses a manifest line into |user_data| and |name|. Returns false if the
+// line is invalid.
+static bool iree_suite_parse_entry(const char* line,
+                                   iree_suite_benchmark_user_data_t* user_data,
+                                   char* name, iree_host_size_t name_capacity) {
+  char op_str[32], type_str[32], tile_str[32], shape_str[32], cpu_str[128];
+  if (sscanf(line, "%31s %31s %31s %31s %127s", op_str, type_str, tile_str,
+             shape_str, cpu_str) != 5) {
+    return false;
+  }
+  memset(user_data, 0, sizeof(*user_data));
+  iree_uk_uint64_t op = 0;
+  if (!IREE_SUITE_LOOKUP(iree_suite_ops, iree_make_cstring_view(op_str),
+                         &op)) {
+    return false;
+  }
+  user_data->op = (iree_suite_op_t)op;
+  iree_string_view_t type_name = iree_make_cstring_view(type_str);
+  iree_uk_uint64_t type = 0;
+  bool type_found = false;
+  int tile_count = 2;
+  switch (user_data->op) {
+    case iree_suite_op_mmt4d:
+      type_found = IREE_SUITE_LOOKUP(iree_suite_mmt4d_types, type_name, &type);
+      tile_count = 3;
+      break;
+    case iree_suite_op_pack:
+      type_found = IREE_SUITE_LOOKUP(iree_suite_pack_types, type_name, &type);
+      break;
+    case iree_suite_op_unpack:
+      type_found = IREE_SUITE_LOOKUP(iree_suite_unpack_types, type_name, &type);
+      break;
+    case iree_suite_op_softmax:
+    case iree_suite_op_layer_norm:
+      type_found =
+          IREE_SUITE_LOOKUP(iree_suite_reduction_types, type_name, &type);
+      tile_count = 0;
+      break;
+  }
+  if (!type_found) return false;
+  user_data->type = (iree_uk_uint32_t)type;
+  int* tile = user_data->tile;
+  int* shape = user_data->shape;
+  if (tile_count == 3) {
+    if (sscanf(tile_str, "%dx%dx%d", &tile[0], &tile[1], &tile[2]) != 3 ||
+        sscanf(shape_str, "%dx%dx%d", &shape[0], &shape[1], &shape[2]) != 3) {
+      return false;
+    }
+  } else {
+    if (tile_count == 2 &&
+        sscanf(tile_str, "%dx%d", &tile[0], &tile[1]) != 2) {
+      return false;
+    }
+    if (sscanf(shape_str, "%dx%d", &shape[0], &shape[1]) != 2) return false;
+  }
+  for (int i = 0; i < tile_count; ++i) {
+    if (tile[i] <= 0) return false;
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (shape[i] < 0) return false;
+  }
+  if (!iree_suite_parse_cpu_data(cpu_str, user_data->cpu_data)) return false;
+  if (tile_count) {
+    snprintf(name, name_capacity, "iree_uk_%s_%s_%s/%s/%s", op_str, type_str,
+             tile_str, shape_str, cpu_str);
+  } else {
+    snprintf(name, name_capacity, "iree_uk_%s_%s/%s/%s", op_str, type_str,
+             shape_str, cpu_str);
+  }
+  return true;
+}
+
+// Registers the benchmarks of all the entries of |manifest| whose CPU
+// features this CPU has.
+static iree_status_t iree_suite_register_manifest(
+    iree_string_view_t manifest) {
+  int line_number = 0;
+  while (!iree_string_view_is_empty(manifest)) {
+    iree_string_view_t line;
+    iree_string_view_split(manifest, '\n', &line, &manifest);
+    ++line_number;
+    line = iree_string_view_trim(line);
+    if (iree_string_view_is_empty(line) ||
+        iree_string_view_starts_with(line, IREE_SV("#"))) {
+      continue;
+    }
+    char line_str[256] = {0};
+    memcpy(line_str, line.data, iree_min(line.size, sizeof(line_str) - 1));
+    iree_suite_benchmark_user_data_t* user_data = malloc(sizeof(*user_data));
+    char name[256];
+    if (!iree_suite_parse_entry(line_str, user_data, name, sizeof name)) {
+      free(user_data);
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid manifest line %d: %s", line_number,
+                              line_str);
+    }
+    // Does this benchmark require an optional CPU feature that this CPU
+    // lacks? The builtin would crash.
+    if ((iree_cpu_data_field(0) & user_data->cpu_data[0]) !=
+        user_data->cpu_data[0]) {
+      free(user_data);
+      continue;
+    }
+    // benchmark_def does not need to be static, it will be cloned.
+    const iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_suite_benchmark,
+        .user_data = user_data,
+    };
+    iree_benchmark_register(iree_make_cstring_view(name), &benchmark_def);
+  }
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage(
+      "suite_benchmark",
+      "Benchmarks the ukernels on the shapes of a manifest, reporting their\n"
+      "percentage of the roofline of this machine. Use\n"
+      "--benchmark_format=json to compare results across commits.\n"
+      "\n");
+
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
+  iree_benchmark_initialize(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+
+  iree_file_contents_t* manifest_contents = NULL;
+  iree_string_view_t manifest = iree_make_cstring_view(
+      iree_suite_default_manifest);
+  if (strlen(FLAG_manifest)) {
+    IREE_CHECK_OK(iree_file_read_contents(
+        FLAG_manifest, iree_allocator_system(), &manifest_contents));
+    manifest = iree_make_string_view(
+        (const char*)manifest_contents->const_buffer.data,
+        manifest_contents->const_buffer.data_length);
+  }
+  IREE_CHECK_OK(iree_suite_register_manifest(manifest));
+  iree_file_contents_free(manifest_contents);
+
+  const char* fma_probe_name = "flag";
+  iree_suite_peak_flops = FLAG_peak_gflops > 0.0
+                              ? FLAG_peak_gflops * 1e9
+                              : iree_suite_probe_flops(&fma_probe_name);
+  iree_suite_peak_bandwidth = FLAG_peak_gbps > 0.0
+                                  ? FLAG_peak_gbps * 1e9
+                                  : iree_suite_probe_bandwidth();
+  char value[64];
+  snprintf(value, sizeof value, "%.2f", iree_suite_peak_flops * 1e-9);
+  iree_benchmark_add_context("peak_gflops", value);
+  iree_benchmark_add_context("peak_gflops_source", fma_probe_name);
+  snprintf(value, sizeof value, "%.2f", iree_suite_peak_bandwidth * 1e-9);
+  iree_benchmark_add_context("peak_gbps", value);
+  iree_benchmark_add_context("peak_gbps_source",
+                             FLAG_peak_gbps > 0.0 ? "flag" : "stream_triad");
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -30,8 +30,10 @@ extern "C" void iree_uk_assert_fail(const char* file, int line,
 iree_uk_ssize_t iree_uk_test_2d_buffer_length(iree_uk_type_t type,
                                               iree_uk_ssize_t size0,
                                               iree_uk_ssize_t stride0) {
-  // Just for testing purposes, so it's OK to overestimate size.
-  return size0 * stride0 << iree_uk_type_size_log2(type);
+  // Just for testing purposes, so it's OK to overestimate size. Rounds up for
+  // sub-byte types.
+  iree_uk_ssize_t bits = size0 * stride0 << iree_uk_type_bit_count_log2(type);
+  return (bits + 7) / 8;
 }
 
 bool iree_uk_test_2d_buffers_equal(const void* buf1, const void* buf2,
@@ -111,6 +113,27 @@ void iree_uk_test_write_random_buffer(void* buffer,
       iree_uk_test_write_random_buffer(static_cast<iree_uk_int8_t*>(buffer),
                                        size_in_bytes, engine);
       return;
+    case IREE_UK_TYPE_FLOAT_16:
+    case IREE_UK_TYPE_BFLOAT_16: {
+      // Small integers are exactly representable in both 16-bit float types.
+      iree_uk_uint16_t* buffer_u16 = static_cast<iree_uk_uint16_t*>(buffer);
+      for (iree_uk_ssize_t i = 0; i < size_in_bytes / 2; ++i) {
+        float random_val =
+            iree_uk_test_random_engine_get_minus16_plus15(engine);
+        buffer_u16[i] = type == IREE_UK_TYPE_FLOAT_16
+                            ? iree_uk_f32_to_f16(random_val)
+                            : iree_uk_f32_to_bf16(random_val);
+      }
+      return;
+    }
+    case IREE_UK_TYPE_INT_4: {
+      // All 4-bit values are small integers, so any byte will do.
+      iree_uk_uint8_t* buffer_u8 = static_cast<iree_uk_uint8_t*>(buffer);
+      for (iree_uk_ssize_t i = 0; i < size_in_bytes; ++i) {
+        buffer_u8[i] = iree_uk_test_random_engine_get_0_65535(engine);
+      }
+      return;
+    }
     default:
       IREE_UK_ASSERT(false && "unknown type");
   }
@@ -190,7 +213,30 @@ int iree_uk_test_cpu_features_str(char* buf, int buf_length,
   if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD) {
     return snprintf(buf, buf_length, "dotprod");
   }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE) {
+    return snprintf(buf, buf_length, "sve");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE2) {
+    return snprintf(buf, buf_length, "sve2");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME) {
+    return snprintf(buf, buf_length, "sme");
+  }
 #endif  // defined(IREE_UK_ARCH_ARM_64)
+#if defined(IREE_UK_ARCH_X86_64)
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return snprintf(buf, buf_length, "avx2_fma");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    return snprintf(buf, buf_length, "avx512_base");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI) {
+    return snprintf(buf, buf_length, "avx512vnni");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16) {
+    return snprintf(buf, buf_length, "avx512bf16");
+  }
+#endif  // defined(IREE_UK_ARCH_X86_64)
   IREE_UK_ASSERT(false && "unknown CPU feature");
   return snprintf(buf, buf_length, "(unknown CPU feature)");
 }
@@ -23,18 +23,32 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
   IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
       builder,
       "  HOST_LOCAL: %12" PRIdsz "B peak / %12" PRIdsz
-      "B allocated / %12" PRIdsz "B freed / %12" PRIdsz "B live\n",
+      "B allocated / %12" PRIdsz "B freed / %12" PRIdsz "B live / %12" PRIdsz
+      "B pooled / %8" PRIhsz " live allocations / %8" PRIhsz " peak\n",
       statistics->host_bytes_peak, statistics->host_bytes_allocated,
       statistics->host_bytes_freed,
-      (statistics->host_bytes_allocated - statistics->host_bytes_freed)));
+      (statistics->host_bytes_allocated - statistics->host_bytes_freed),
+      statistics->host_bytes_pooled, statistics->host_allocation_count,
+      statistics->host_allocation_count_peak));
 
   IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
       builder,
       "DEVICE_LOCAL: %12" PRIdsz "B peak / %12" PRIdsz
-      "B allocated / %12" PRIdsz "B freed / %12" PRIdsz "B live\n",
+      "B allocated / %12" PRIdsz "B freed / %12" PRIdsz "B live / %12" PRIdsz
+      "B pooled / %8" PRIhsz " live allocations / %8" PRIhsz " peak\n",
       statistics->device_bytes_peak, statistics->device_bytes_allocated,
       statistics->device_bytes_freed,
-      (statistics->device_bytes_allocated - statistics->device_bytes_freed)));
+      (statistics->device_bytes_allocated - statistics->device_bytes_freed),
+      statistics->device_bytes_pooled, statistics->device_allocation_count,
+      statistics->device_allocation_count_peak));
+
+  if (statistics->budget_trim_count || statistics->budget_rejection_count) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "      BUDGET: %12" PRIu64 "  soft limit trims / %12" PRIu64
+        "  hard limit rejections\n",
+        statistics->budget_trim_count, statistics->budget_rejection_count));
+  }
 
 #else
   // No-op when disabled.
@@ -265,6 +265,17 @@ typedef enum iree_hal_external_buffer_type_e {
   //  Uses VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT.
   IREE_HAL_EXTERNAL_BUFFER_TYPE_OPAQUE_WIN32 = 3,
 
+  // A device pointer allocated from an external allocator in the address
+  // space of the device (such as by another framework sharing the device).
+  // An imported/exported buffer does not own a reference to the memory and the
+  // caller is responsible for ensuring the memory remains live for as long as
+  // the iree_hal_buffer_t referencing it.
+  //
+  // CUDA:
+  //  Requires the allocation to be made in the same CUDA context.
+  //  Uses the CUdeviceptr directly.
+  IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION = 4,
+
   // TODO(benvanik): additional memory types:
   //  shared memory fd (shmem)/mapped file
   //  VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT
@@ -303,6 +314,11 @@ typedef struct iree_hal_external_buffer_t {
     struct {
       void* handle;
     } opaque_win32;
+    // IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION
+    struct {
+      // Device memory pointer.
+      uint64_t ptr;
+    } device_allocation;
   } handle;
 } iree_hal_external_buffer_t;
 
@@ -335,9 +351,23 @@ typedef struct iree_hal_allocator_statistics_t {
   iree_device_size_t host_bytes_peak;
   iree_device_size_t host_bytes_allocated;
   iree_device_size_t host_bytes_freed;
+  // Bytes counted as live that are retained by a pooling allocator for reuse
+  // and not referenced by any user buffer. Relative to the live bytes this is
+  // the fraction of memory held by caches.
+  iree_device_size_t host_bytes_pooled;
+  // Number of live allocations and the high-water mark of the count.
+  iree_host_size_t host_allocation_count;
+  iree_host_size_t host_allocation_count_peak;
   iree_device_size_t device_bytes_peak;
   iree_device_size_t device_bytes_allocated;
   iree_device_size_t device_bytes_freed;
+  iree_device_size_t device_bytes_pooled;
+  iree_host_size_t device_allocation_count;
+  iree_host_size_t device_allocation_count_peak;
+  // Number of allocations that crossed a soft memory budget limit and trimmed.
+  uint64_t budget_trim_count;
+  // Number of allocations rejected for exceeding a hard memory budget limit.
+  uint64_t budget_rejection_count;
   // TODO(benvanik): mapping information (discarded, mapping ranges,
   //                 flushed/invalidated, etc).
 #else
@@ -584,11 +614,19 @@ static inline void iree_hal_allocator_statistics_record_alloc(
     statistics->host_bytes_peak =
         iree_max(statistics->host_bytes_peak, statistics->host_bytes_allocated -
                                                   statistics->host_bytes_freed);
+    ++statistics->host_allocation_count;
+    statistics->host_allocation_count_peak =
+        iree_max(statistics->host_allocation_count_peak,
+                 statistics->host_allocation_count);
   } else {
     statistics->device_bytes_allocated += allocation_size;
     statistics->device_bytes_peak = iree_max(
         statistics->device_bytes_peak,
         statistics->device_bytes_allocated - statistics->device_bytes_freed);
+    ++statistics->device_allocation_count;
+    statistics->device_allocation_count_peak =
+        iree_max(statistics->device_allocation_count_peak,
+                 statistics->device_allocation_count);
   }
 }
 
@@ -598,8 +636,10 @@ static inline void iree_hal_allocator_statistics_record_free(
     iree_hal_memory_type_t memory_type, iree_device_size_t allocation_size) {
   if (iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
     statistics->host_bytes_freed += allocation_size;
+    --statistics->host_allocation_count;
   } else {
     statistics->device_bytes_freed += allocation_size;
+    --statistics->device_allocation_count;
   }
 }
 
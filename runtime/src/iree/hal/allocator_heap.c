@@ -7,6 +7,7 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
@@ -193,6 +194,8 @@ static iree_status_t iree_hal_heap_allocator_allocate_buffer(
   }
 
   // Allocate the buffer (both the wrapper and the contents).
+  IREE_FLIGHT_RECORD_INSTANT(IREE_FLIGHT_RECORDER_CATEGORY_ALLOCATION,
+                             "heap_allocate_buffer", allocation_size);
   iree_hal_heap_allocator_statistics_t* statistics = NULL;
   IREE_STATISTICS(statistics = &allocator->statistics);
   iree_hal_buffer_t* buffer = NULL;
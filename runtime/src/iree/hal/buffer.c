@@ -530,6 +530,12 @@ IREE_API_EXPORT iree_hal_buffer_t* iree_hal_buffer_allocated_buffer(
   return buffer->allocated_buffer;
 }
 
+IREE_API_EXPORT iree_hal_allocator_t* iree_hal_buffer_device_allocator(
+    const iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  return buffer->allocated_buffer->device_allocator;
+}
+
 IREE_API_EXPORT iree_device_size_t
 iree_hal_buffer_allocation_size(const iree_hal_buffer_t* buffer) {
   IREE_ASSERT_ARGUMENT(buffer);
@@ -583,6 +583,11 @@ IREE_API_EXPORT void iree_hal_buffer_release(iree_hal_buffer_t* buffer);
 IREE_API_EXPORT iree_hal_buffer_t* iree_hal_buffer_allocated_buffer(
     const iree_hal_buffer_t* buffer);
 
+// Returns the allocator that allocated or imported the allocated buffer of
+// |buffer| or NULL if it was not made by an allocator.
+IREE_API_EXPORT iree_hal_allocator_t* iree_hal_buffer_device_allocator(
+    const iree_hal_buffer_t* buffer);
+
 // Returns the size of the resource memory allocation in bytes.
 // This may be rounded up from the originally requested size or the ideal
 // size for the resource based on device restrictions.
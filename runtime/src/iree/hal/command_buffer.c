@@ -176,11 +176,12 @@ IREE_API_EXPORT iree_status_t iree_hal_command_buffer_create(
                               "inline command buffers cannot be nested");
     }
   }
-  if (binding_capacity > 0 &&
-      !iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "command buffer bindings are only supported for "
-                            "nested command buffers (today)");
+  if (binding_capacity > IREE_HAL_COMMAND_BUFFER_MAX_BINDING_CAPACITY) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "binding capacity %" PRIhsz
+                            " exceeds the maximum of %u",
+                            binding_capacity,
+                            IREE_HAL_COMMAND_BUFFER_MAX_BINDING_CAPACITY);
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -426,6 +426,10 @@ typedef struct iree_hal_command_buffer_validation_state_t {
   // TODO(benvanik): valid push constant bit ranges.
 } iree_hal_command_buffer_validation_state_t;
 
+// Maximum number of binding table slots a command buffer may reference.
+// Limited by the width of iree_hal_descriptor_set_binding_t::buffer_slot.
+#define IREE_HAL_COMMAND_BUFFER_MAX_BINDING_CAPACITY ((1u << 24) - 1)
+
 // Maximum size of any update in iree_hal_command_buffer_update_buffer.
 // 64KB is the limit on Vulkan and we uniformly use that today across all
 // targets as to not need too much command buffer memory.
@@ -471,8 +475,12 @@ typedef struct iree_hal_command_buffer_t iree_hal_command_buffer_t;
 //
 // |binding_capacity| specifies the maximum number of indirect binding slots
 // available for use by iree_hal_command_buffer_push_descriptor_set commands
-// referencing the binding table. Must only be non-zero for command buffer modes
-// supporting indirect bindings.
+// referencing the binding table. Primary command buffers with a non-zero
+// capacity resolve their slots against the binding table provided to each
+// iree_hal_device_queue_execute call and nested command buffers against the
+// table provided to iree_hal_command_buffer_execute_commands. Implementations
+// may defer native recording until the bindings are known and such command
+// buffers should be recorded once and reused.
 //
 // |queue_affinity| specifies the device queues the command buffer may be
 // submitted to. The queue affinity provided to iree_hal_device_queue_execute
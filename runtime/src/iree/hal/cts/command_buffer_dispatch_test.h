@@ -165,6 +165,91 @@ TEST_P(command_buffer_dispatch_test, DispatchAbs) {
   CleanupExecutable();
 }
 
+// Records a dispatch once against binding table slots and executes it twice
+// with different buffers bound to those slots.
+TEST_P(command_buffer_dispatch_test, DispatchAbsIndirect) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  iree_status_t status = iree_hal_command_buffer_create(
+      device_, /*mode=*/0,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/2, &command_buffer);
+  if (iree_status_is_unimplemented(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "indirect command buffers not supported";
+  }
+  IREE_ASSERT_OK(status);
+
+  PrepareAbsExecutable();
+
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  iree_hal_descriptor_set_binding_t descriptor_set_bindings[] = {
+      {
+          /*binding=*/0,
+          /*buffer_slot=*/0,
+          /*buffer=*/NULL,
+          /*offset=*/0,
+          IREE_WHOLE_BUFFER,
+      },
+      {
+          /*binding=*/1,
+          /*buffer_slot=*/1,
+          /*buffer=*/NULL,
+          /*offset=*/0,
+          IREE_WHOLE_BUFFER,
+      },
+  };
+  IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+      command_buffer, pipeline_layout_, /*set=*/0,
+      IREE_ARRAYSIZE(descriptor_set_bindings), descriptor_set_bindings));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+      command_buffer, executable_, /*entry_point=*/0,
+      /*workgroup_x=*/1, /*workgroup_y=*/1, /*workgroup_z=*/1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                        IREE_HAL_BUFFER_USAGE_TRANSFER |
+                        IREE_HAL_BUFFER_USAGE_MAPPING;
+  const float input_values[2] = {-2.5f, -4.0f};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(input_values); ++i) {
+    iree_hal_buffer_t* input_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, sizeof(float),
+        iree_make_const_byte_span(&input_values[i], sizeof(float)),
+        &input_buffer));
+    iree_hal_buffer_t* output_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, buffer_params, sizeof(float),
+        iree_const_byte_span_empty(), &output_buffer));
+
+    iree_hal_buffer_binding_t bindings[2] = {
+        {input_buffer, 0, IREE_WHOLE_BUFFER},
+        {output_buffer, 0, IREE_WHOLE_BUFFER},
+    };
+    iree_hal_buffer_binding_table_t binding_table = {
+        IREE_ARRAYSIZE(bindings),
+        bindings,
+    };
+    IREE_ASSERT_OK(
+        SubmitCommandBuffersAndWait(1, &command_buffer, &binding_table));
+
+    float output_value = 0.0f;
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, output_buffer,
+        /*source_offset=*/0, &output_value, sizeof(output_value),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_EQ(-input_values[i], output_value);
+
+    iree_hal_buffer_release(output_buffer);
+    iree_hal_buffer_release(input_buffer);
+  }
+
+  iree_hal_command_buffer_release(command_buffer);
+  CleanupExecutable();
+}
+
 }  // namespace cts
 }  // namespace hal
 }  // namespace iree
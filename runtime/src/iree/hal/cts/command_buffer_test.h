@@ -259,6 +259,53 @@ TEST_P(command_buffer_test, CopySubBuffer) {
   iree_hal_buffer_release(host_buffer);
 }
 
+// Submits a reusable (non-ONE_SHOT) command buffer multiple times and ensures
+// each submission executes the recorded commands again.
+TEST_P(command_buffer_test, SubmitReusableMultipleTimes) {
+  iree_hal_buffer_t* device_buffer = NULL;
+  CreateZeroedDeviceBuffer(kDefaultAllocationSize, &device_buffer);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, /*mode=*/0,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/0, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  uint8_t pattern = 0x2A;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, device_buffer, /*target_offset=*/0,
+      kDefaultAllocationSize / 2, &pattern, sizeof(pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer,
+      /*source_stage_mask=*/IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      /*target_stage_mask=*/IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+      /*memory_barriers=*/NULL,
+      /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, device_buffer, /*source_offset=*/0, device_buffer,
+      /*target_offset=*/kDefaultAllocationSize / 2,
+      kDefaultAllocationSize / 2));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  std::vector<uint8_t> reference_buffer(kDefaultAllocationSize, pattern);
+  for (int i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK(
+        iree_hal_buffer_map_zero(device_buffer, 0, IREE_WHOLE_BUFFER));
+    IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+    std::vector<uint8_t> actual_data(kDefaultAllocationSize);
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, device_buffer, /*source_offset=*/0,
+        /*target_buffer=*/actual_data.data(),
+        /*data_length=*/kDefaultAllocationSize,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+  }
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(device_buffer);
+}
+
 TEST_P(command_buffer_test, FillBuffer_pattern1_size1_offset0_length1) {
   iree_device_size_t buffer_size = 1;
   iree_device_size_t target_offset = 0;
@@ -95,10 +95,12 @@ class CtsTestBase : public ::testing::TestWithParam<std::string> {
   }
 
   // Submits |command_buffers| to the device and waits for them to complete
-  // before returning.
+  // before returning. |binding_tables| optionally provides one binding table
+  // per command buffer.
   iree_status_t SubmitCommandBuffersAndWait(
       iree_host_size_t command_buffer_count,
-      iree_hal_command_buffer_t** command_buffers) {
+      iree_hal_command_buffer_t** command_buffers,
+      const iree_hal_buffer_binding_table_t* binding_tables = NULL) {
     // No wait semaphores.
     iree_hal_semaphore_list_t wait_semaphores = iree_hal_semaphore_list_empty();
 
@@ -115,7 +117,8 @@ class CtsTestBase : public ::testing::TestWithParam<std::string> {
 
     iree_status_t status = iree_hal_device_queue_execute(
         device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphores,
-        signal_semaphores, command_buffer_count, command_buffers);
+        signal_semaphores, command_buffer_count, command_buffers,
+        binding_tables);
     if (iree_status_is_ok(status)) {
       status = iree_hal_semaphore_wait(signal_semaphore, target_payload_value,
                                        iree_infinite_timeout());
@@ -35,7 +35,8 @@ TEST_P(semaphore_submission_test, SubmitWithNoCommandBuffers) {
   IREE_ASSERT_OK(iree_hal_device_queue_execute(device_,
                                                /*queue_affinity=*/0,
                                                iree_hal_semaphore_list_empty(),
-                                               signal_semaphores, 0, NULL));
+                                               signal_semaphores, 0, NULL,
+                                               /*binding_tables=*/NULL));
   IREE_ASSERT_OK(
       iree_hal_semaphore_wait(signal_semaphore, 1ull, iree_infinite_timeout()));
 
@@ -65,7 +66,7 @@ TEST_P(semaphore_submission_test, SubmitAndSignal) {
   IREE_ASSERT_OK(iree_hal_device_queue_execute(
       device_,
       /*queue_affinity=*/0, iree_hal_semaphore_list_empty(), signal_semaphores,
-      1, &command_buffer));
+      1, &command_buffer, /*binding_tables=*/NULL));
   IREE_ASSERT_OK(
       iree_hal_semaphore_wait(signal_semaphore, 1ull, iree_infinite_timeout()));
 
@@ -104,7 +105,8 @@ TEST_P(semaphore_submission_test, SubmitWithWait) {
   IREE_ASSERT_OK(
       iree_hal_device_queue_execute(device_,
                                     /*queue_affinity=*/0, wait_semaphores,
-                                    signal_semaphores, 1, &command_buffer));
+                                    signal_semaphores, 1, &command_buffer,
+                                    /*binding_tables=*/NULL));
 
   // Work shouldn't start until the wait semaphore reaches its payload value.
   uint64_t value;
@@ -160,7 +162,8 @@ TEST_P(semaphore_submission_test, SubmitWithMultipleSemaphores) {
   IREE_ASSERT_OK(
       iree_hal_device_queue_execute(device_,
                                     /*queue_affinity=*/0, wait_semaphores,
-                                    signal_semaphores, 1, &command_buffer));
+                                    signal_semaphores, 1, &command_buffer,
+                                    /*binding_tables=*/NULL));
 
   // Work shouldn't start until all wait semaphores reach their payload values.
   uint64_t value;
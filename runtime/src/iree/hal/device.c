@@ -209,7 +209,8 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_execute(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
   IREE_ASSERT_ARGUMENT(device);
   IREE_ASSERT_ARGUMENT(
       !wait_semaphore_list.count ||
@@ -239,11 +240,30 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_execute(
           "inline command buffer submitted with a wait; inline command "
           "buffers must be ready to execute immediately");
     }
+
+    // Indirect command buffers must be provided enough bindings to cover all
+    // slots they may have referenced during recording.
+    const iree_host_size_t binding_capacity =
+        command_buffers[i]->binding_capacity;
+    const iree_host_size_t binding_count =
+        binding_tables ? binding_tables[i].count : 0;
+    if (binding_count < binding_capacity) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "command buffer %" PRIhsz " requires a binding table with %" PRIhsz
+          " bindings but %" PRIhsz " were provided",
+          i, binding_capacity, binding_count);
+    } else if (binding_count > 0 && !binding_tables[i].bindings) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding table %" PRIhsz " has no storage", i);
+    }
   }
 
   iree_status_t status = _VTABLE_DISPATCH(device, queue_execute)(
       device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
-      command_buffer_count, command_buffers);
+      command_buffer_count, command_buffers, binding_tables);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -257,7 +277,7 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_barrier(
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_status_t status =
       iree_hal_device_queue_execute(device, queue_affinity, wait_semaphore_list,
-                                    signal_semaphore_list, 0, NULL);
+                                    signal_semaphore_list, 0, NULL, NULL);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
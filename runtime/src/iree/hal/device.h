@@ -396,12 +396,22 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_dealloca(
 // executing its command buffers in the order they are defined but allowing the
 // command buffers to complete out-of-order. See:
 // https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/vkQueueSubmit.html
+//
+// |binding_tables| is either NULL or contains one binding table per command
+// buffer. Command buffers created with a non-zero binding capacity must be
+// provided a table with at least that many bindings; the indirect bindings
+// referenced during recording are resolved against the table for this
+// submission only. This allows a command buffer to be recorded once and
+// submitted many times with different buffers. Tables are only read during the
+// call but the buffers they reference must remain live until the submission
+// completes.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_execute(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers);
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables);
 
 // Enqueues a barrier waiting for |wait_semaphore_list| and signaling
 // |signal_semaphore_list| when reached.
@@ -557,7 +567,8 @@ typedef struct iree_hal_device_vtable_t {
       const iree_hal_semaphore_list_t wait_semaphore_list,
       const iree_hal_semaphore_list_t signal_semaphore_list,
       iree_host_size_t command_buffer_count,
-      iree_hal_command_buffer_t* const* command_buffers);
+      iree_hal_command_buffer_t* const* command_buffers,
+      const iree_hal_buffer_binding_table_t* binding_tables);
 
   iree_status_t(IREE_API_PTR* queue_flush)(
       iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity);
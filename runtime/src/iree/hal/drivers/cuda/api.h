@@ -34,7 +34,10 @@ typedef struct {
 typedef struct iree_hal_cuda_device_params_t {
   // Number of queues exposed on the device.
   // Each queue acts as a separate synchronization scope where all work executes
-  // concurrently unless prohibited by semaphores.
+  // concurrently unless prohibited by semaphores. Each queue has its own CUDA
+  // stream and queue affinities are mapped onto queues modulo the queue count.
+  // Semaphores signaled on one queue and waited on another are lowered to CUDA
+  // events. At most 64 queues can be addressed by queue affinities.
   iree_host_size_t queue_count;
 
   // Total size of each block in the device shared block pool.
@@ -45,6 +48,32 @@ typedef struct iree_hal_cuda_device_params_t {
   // Specifies how command buffers are recorded and executed.
   iree_hal_cuda_command_buffer_mode_t command_buffer_mode;
 
+  // Size of each cuMemAlloc block that device-local buffers are suballocated
+  // from. cuMemAlloc/cuMemFree are expensive and may synchronize the device so
+  // suballocating avoids them for all but the first allocations of a given
+  // size. Buffers larger than the block size receive a dedicated allocation.
+  // 0 disables suballocation and allocates each buffer with cuMemAlloc.
+  iree_device_size_t suballocator_block_size;
+
+  // Enables queue-ordered allocations: queue_alloca and queue_dealloca of
+  // device-local buffers allocate and free from a per-device CUDA memory pool
+  // with cuMemAllocFromPoolAsync/cuMemFreeAsync in the order of the queue
+  // stream instead of blocking the host. Ignored if the device does not
+  // support memory pools.
+  bool async_allocations;
+
+  // Bytes of unused memory the memory pool keeps reserved at synchronization
+  // points instead of releasing it back to the system. Reserved memory makes
+  // subsequent queue-ordered allocations nearly free. UINT64_MAX keeps all
+  // memory reserved until the device allocator is trimmed.
+  uint64_t async_release_threshold;
+
+  // Enables peer access between this device and all other devices with an
+  // active CUDA context that support it (over NVLink or PCIe). Copies and
+  // dispatches can then directly access buffers allocated on those devices
+  // instead of staging through host memory.
+  bool peer_access;
+
   // Allow executing command buffers against CUDA streams as they are recorded.
   // Only command buffers produced by the compiler that have the
   // IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION bit set will use this.
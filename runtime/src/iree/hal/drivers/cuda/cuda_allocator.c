@@ -13,6 +13,7 @@
 #include "iree/hal/drivers/cuda/cuda_buffer.h"
 #include "iree/hal/drivers/cuda/dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/status_util.h"
+#include "iree/hal/utils/suballocator.h"
 
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_ALLOCATION_TRACKING
 static const char* IREE_HAL_CUDA_ALLOCATOR_ID = "CUDA";
@@ -25,6 +26,18 @@ typedef struct iree_hal_cuda_allocator_t {
   CUdevice device;
   CUstream stream;
   bool supports_concurrent_managed_access;
+  // Integrated devices share physical memory with the host and page-locked
+  // host memory can be used by the device without copies.
+  bool integrated;
+
+  // Suballocates device-only buffers from large cuMemAlloc blocks.
+  // Only initialized if use_suballocator is true.
+  bool use_suballocator;
+  iree_hal_suballocator_t suballocator;
+
+  // Memory pool used for queue-ordered allocations.
+  // NULL if disabled or unsupported by the device.
+  CUmemoryPool async_pool;
 
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_cuda_allocator_t;
@@ -37,9 +50,91 @@ static iree_hal_cuda_allocator_t* iree_hal_cuda_allocator_cast(
   return (iree_hal_cuda_allocator_t*)base_value;
 }
 
+static iree_status_t iree_hal_cuda_allocator_allocate_block(
+    void* self, iree_device_size_t block_size, void** out_user_data) {
+  iree_hal_cuda_allocator_t* allocator = (iree_hal_cuda_allocator_t*)self;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, block_size);
+  CUdeviceptr device_ptr = 0;
+  iree_status_t status =
+      CU_RESULT_TO_STATUS(allocator->context->syms,
+                          cuMemAlloc(&device_ptr, block_size), "cuMemAlloc");
+  if (iree_status_is_ok(status)) {
+    *out_user_data = (void*)(uintptr_t)device_ptr;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_cuda_allocator_free_block(void* self,
+                                               iree_device_size_t block_size,
+                                               void* user_data) {
+  iree_hal_cuda_allocator_t* allocator = (iree_hal_cuda_allocator_t*)self;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, block_size);
+  // See iree_hal_cuda_allocator_deallocate_buffer for why errors are ignored.
+  CUDA_IGNORE_ERROR(allocator->context->syms,
+                    cuMemFree((CUdeviceptr)(uintptr_t)user_data));
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Returns a suballocated range to the suballocator when its buffer is
+// destroyed. |user_data| is the iree_hal_suballocator_range_t*.
+static void iree_hal_cuda_allocator_release_range(void* user_data,
+                                                  iree_hal_buffer_t* buffer) {
+  iree_hal_suballocator_release((iree_hal_suballocator_range_t*)user_data);
+}
+
+// Creates the memory pool used for queue-ordered allocations if the device
+// supports it. Devices without memory pool support fall back to synchronous
+// allocations.
+static iree_status_t iree_hal_cuda_allocator_create_async_pool(
+    iree_hal_cuda_allocator_t* allocator, uint64_t release_threshold) {
+  int supports_memory_pools = 0;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      allocator->context->syms,
+      cuDeviceGetAttribute(&supports_memory_pools,
+                           CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED,
+                           allocator->device),
+      "cuDeviceGetAttribute"));
+  if (!supports_memory_pools) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  CUmemPoolProps pool_props;
+  memset(&pool_props, 0, sizeof(pool_props));
+  pool_props.allocType = CU_MEM_ALLOCATION_TYPE_PINNED;
+  pool_props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  pool_props.location.id = allocator->device;
+  CUmemoryPool pool = NULL;
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      allocator->context->syms, cuMemPoolCreate(&pool, &pool_props),
+      "cuMemPoolCreate");
+
+  // The pool otherwise releases all unused memory at every synchronization
+  // point, making each allocation after a sync as expensive as cuMemAlloc.
+  if (iree_status_is_ok(status)) {
+    cuuint64_t threshold = (cuuint64_t)release_threshold;
+    status = CU_RESULT_TO_STATUS(
+        allocator->context->syms,
+        cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                              &threshold),
+        "cuMemPoolSetAttribute");
+  }
+
+  if (iree_status_is_ok(status)) {
+    allocator->async_pool = pool;
+  } else if (pool) {
+    CUDA_IGNORE_ERROR(allocator->context->syms, cuMemPoolDestroy(pool));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_cuda_allocator_create(
     iree_hal_device_t* base_device, iree_hal_cuda_context_wrapper_t* context,
-    CUdevice device, CUstream stream, iree_hal_allocator_t** out_allocator) {
+    CUdevice device, CUstream stream,
+    iree_device_size_t suballocator_block_size, bool async_allocations,
+    uint64_t async_release_threshold, iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(base_device);
   IREE_ASSERT_ARGUMENT(context);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -65,6 +160,18 @@ iree_status_t iree_hal_cuda_allocator_create(
               : "no CONCURRENT_MANAGED_ACCESS (expect slow accesses on "
                 "device-local + host-visible memory)");
 
+  // Integrated devices (Jetson/Tegra) have no dedicated memory: device-local
+  // and host-local memory are the same and we expose unified heaps instead of
+  // forcing copies between them.
+  int integrated = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, CU_RESULT_TO_STATUS(
+              context->syms,
+              cuDeviceGetAttribute(&integrated, CU_DEVICE_ATTRIBUTE_INTEGRATED,
+                                   device),
+              "cuDeviceGetAttribute"));
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, integrated ? "INTEGRATED" : "DISCRETE");
+
   iree_hal_cuda_allocator_t* allocator = NULL;
   iree_status_t status = iree_allocator_malloc(
       context->host_allocator, sizeof(*allocator), (void**)&allocator);
@@ -77,7 +184,37 @@ iree_status_t iree_hal_cuda_allocator_create(
     allocator->stream = stream;
     allocator->supports_concurrent_managed_access =
         supports_concurrent_managed_access != 0;
+    allocator->integrated = integrated != 0;
+    allocator->use_suballocator = false;
+  }
+
+  if (iree_status_is_ok(status) && suballocator_block_size > 0) {
+    iree_hal_suballocator_params_t suballocator_params;
+    iree_hal_suballocator_params_initialize(&suballocator_params);
+    suballocator_params.block_size = suballocator_block_size;
+    const iree_hal_suballocator_block_allocator_t block_allocator = {
+        .self = allocator,
+        .allocate = iree_hal_cuda_allocator_allocate_block,
+        .free = iree_hal_cuda_allocator_free_block,
+    };
+    status = iree_hal_suballocator_initialize(
+        &suballocator_params, block_allocator, context->host_allocator,
+        &allocator->suballocator);
+    allocator->use_suballocator = iree_status_is_ok(status);
+  }
+
+  if (iree_status_is_ok(status) && async_allocations) {
+    status = iree_hal_cuda_allocator_create_async_pool(
+        allocator, async_release_threshold);
+  }
+
+  if (iree_status_is_ok(status)) {
     *out_allocator = (iree_hal_allocator_t*)allocator;
+  } else if (allocator) {
+    if (allocator->use_suballocator) {
+      iree_hal_suballocator_deinitialize(&allocator->suballocator);
+    }
+    iree_allocator_free(context->host_allocator, allocator);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -91,6 +228,13 @@ static void iree_hal_cuda_allocator_destroy(
   iree_allocator_t host_allocator = allocator->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (allocator->use_suballocator) {
+    iree_hal_suballocator_deinitialize(&allocator->suballocator);
+  }
+  if (allocator->async_pool) {
+    CUDA_IGNORE_ERROR(allocator->context->syms,
+                      cuMemPoolDestroy(allocator->async_pool));
+  }
   iree_allocator_free(host_allocator, allocator);
 
   IREE_TRACE_ZONE_END(z0);
@@ -105,6 +249,18 @@ static iree_allocator_t iree_hal_cuda_allocator_host_allocator(
 
 static iree_status_t iree_hal_cuda_allocator_trim(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  if (allocator->use_suballocator) {
+    iree_hal_suballocator_trim(&allocator->suballocator);
+  }
+  if (allocator->async_pool) {
+    // Releases reserved memory not backing outstanding allocations. Memory
+    // freed by pending queue-ordered deallocations is released on a later trim.
+    CUDA_RETURN_IF_ERROR(allocator->context->syms,
+                         cuMemPoolTrimTo(allocator->async_pool, 0),
+                         "cuMemPoolTrimTo");
+  }
   return iree_ok_status();
 }
 
@@ -126,10 +282,8 @@ static iree_status_t iree_hal_cuda_allocator_query_memory_heaps(
   iree_hal_cuda_allocator_t* allocator =
       iree_hal_cuda_allocator_cast(base_allocator);
 
-  // TODO(benvanik): check CU_DEVICE_ATTRIBUTE_INTEGRATED and return a unified
-  // set of heaps (likely still a cached and uncached, at minimum).
   iree_host_size_t count = 3;
-  if (allocator->supports_concurrent_managed_access) {
+  if (allocator->supports_concurrent_managed_access && !allocator->integrated) {
     ++count;  // device-local | host-visible
   }
   if (out_count) *out_count = count;
@@ -146,6 +300,45 @@ static iree_status_t iree_hal_cuda_allocator_query_memory_heaps(
 
   int i = 0;
 
+  if (allocator->integrated) {
+    // Device-local memory (dispatch resources):
+    heaps[i++] = (iree_hal_allocator_memory_heap_t){
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        .allowed_usage =
+            IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH,
+        .max_allocation_size = max_allocation_size,
+        .min_alignment = min_alignment,
+    };
+
+    // Write-combined page-locked unified memory (upload/zero-copy inputs):
+    heaps[i++] = (iree_hal_allocator_memory_heap_t){
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
+                IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
+                IREE_HAL_MEMORY_TYPE_HOST_COHERENT,
+        .allowed_usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                         IREE_HAL_BUFFER_USAGE_DISPATCH |
+                         IREE_HAL_BUFFER_USAGE_MAPPING,
+        .max_allocation_size = max_allocation_size,
+        .min_alignment = min_alignment,
+    };
+
+    // Cached page-locked unified memory (download/zero-copy outputs):
+    heaps[i++] = (iree_hal_allocator_memory_heap_t){
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
+                IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
+                IREE_HAL_MEMORY_TYPE_HOST_COHERENT |
+                IREE_HAL_MEMORY_TYPE_HOST_CACHED,
+        .allowed_usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                         IREE_HAL_BUFFER_USAGE_DISPATCH |
+                         IREE_HAL_BUFFER_USAGE_MAPPING,
+        .max_allocation_size = max_allocation_size,
+        .min_alignment = min_alignment,
+    };
+
+    IREE_ASSERT(i == count);
+    return iree_ok_status();
+  }
+
   // Device-local memory (dispatch resources):
   heaps[i++] = (iree_hal_allocator_memory_heap_t){
       .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
@@ -222,12 +415,24 @@ iree_hal_cuda_allocator_query_buffer_compatibility(
     }
   }
 
+  // On integrated devices all host-local memory the device can see is as
+  // fast as device-local memory and we treat it as such.
+  if (allocator->integrated &&
+      iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE)) {
+    params->type |= IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params->type &= ~IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+      params->type |= IREE_HAL_MEMORY_TYPE_HOST_COHERENT;
+    }
+  }
+
   // If concurrent managed access is not supported then make device-local +
   // host-visible allocations fall back to host-local + device-visible
   // page-locked memory. This will be significantly slower for the device to
   // access but the compiler only uses this type for readback staging buffers
   // and it's better to function than function fast.
   if (!allocator->supports_concurrent_managed_access &&
+      !allocator->integrated &&
       iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
                                           IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
     compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_LOW_PERFORMANCE;
@@ -268,6 +473,23 @@ static void iree_hal_cuda_buffer_free(iree_hal_cuda_context_wrapper_t* context,
       CUDA_IGNORE_ERROR(context->syms, cuMemHostUnregister(host_ptr));
       break;
     }
+    case IREE_HAL_CUDA_BUFFER_TYPE_SUBALLOCATED: {
+      // Returned to the suballocator by the buffer release callback.
+      break;
+    }
+    case IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL: {
+      // Freed by the owner once the buffer release callback is issued.
+      break;
+    }
+    case IREE_HAL_CUDA_BUFFER_TYPE_ASYNC: {
+      // The pointer is dropped when the buffer was freed in queue order.
+      // cuMemFree of a pool allocation synchronizes with the free.
+      if (device_ptr) {
+        IREE_TRACE_ZONE_APPEND_TEXT(z0, "cuMemFree");
+        CUDA_IGNORE_ERROR(context->syms, cuMemFree(device_ptr));
+      }
+      break;
+    }
   }
   IREE_TRACE_ZONE_END(z0);
 }
@@ -294,10 +516,15 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
   iree_hal_cuda_buffer_type_t buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_DEVICE;
   void* host_ptr = NULL;
   CUdeviceptr device_ptr = 0;
+  iree_hal_buffer_release_callback_t release_callback =
+      iree_hal_buffer_release_callback_null();
   IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_cuda_buffer_allocate");
   IREE_TRACE_ZONE_APPEND_VALUE(z0, allocation_size);
   if (iree_all_bits_set(compat_params.type,
-                        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
+                        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) &&
+      !(allocator->integrated &&
+        iree_all_bits_set(compat_params.type,
+                          IREE_HAL_MEMORY_TYPE_HOST_VISIBLE))) {
     // Device local case.
     if (iree_all_bits_set(compat_params.type,
                           IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
@@ -308,13 +535,40 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
                                                 CU_MEM_ATTACH_GLOBAL));
       if (iree_status_is_ok(status) &&
           allocator->supports_concurrent_managed_access) {
-        // Prefetch the buffer on the GPU device.
+        // Keep the pages resident on the device and map them into the host
+        // page tables so that host accesses don't fault them back.
         status = CU_RESULT_TO_STATUS(
             allocator->context->syms,
-            cuMemPrefetchAsync(device_ptr, allocation_size, allocator->device,
-                               allocator->stream));
+            cuMemAdvise(device_ptr, allocation_size,
+                        CU_MEM_ADVISE_SET_PREFERRED_LOCATION,
+                        allocator->device));
+        if (iree_status_is_ok(status)) {
+          status = CU_RESULT_TO_STATUS(
+              allocator->context->syms,
+              cuMemAdvise(device_ptr, allocation_size,
+                          CU_MEM_ADVISE_SET_ACCESSED_BY, CU_DEVICE_CPU));
+        }
+        if (iree_status_is_ok(status)) {
+          // Prefetch the buffer on the GPU device.
+          status = CU_RESULT_TO_STATUS(
+              allocator->context->syms,
+              cuMemPrefetchAsync(device_ptr, allocation_size,
+                                 allocator->device, allocator->stream));
+        }
       }
       host_ptr = (void*)device_ptr;
+    } else if (allocator->use_suballocator) {
+      // Device only, suballocated from a shared block.
+      buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_SUBALLOCATED;
+      iree_hal_suballocation_t suballocation;
+      status = iree_hal_suballocator_acquire(&allocator->suballocator,
+                                             allocation_size, &suballocation);
+      if (iree_status_is_ok(status)) {
+        device_ptr = (CUdeviceptr)(uintptr_t)suballocation.block_user_data +
+                     (CUdeviceptr)suballocation.offset;
+        release_callback.fn = iree_hal_cuda_allocator_release_range;
+        release_callback.user_data = suballocation.range;
+      }
     } else {
       // Device only.
       buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_DEVICE;
@@ -322,6 +576,8 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
                                    cuMemAlloc(&device_ptr, allocation_size));
     }
   } else {
+    // Host local case or unified memory on integrated devices where the
+    // page-locked host memory is used by the device in-place.
     buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_HOST;
     unsigned int flags = CU_MEMHOSTALLOC_DEVICEMAP;
     if (!iree_all_bits_set(compat_params.type,
@@ -346,7 +602,7 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
         compat_params.usage, allocation_size,
         /*byte_offset=*/0,
         /*byte_length=*/allocation_size, buffer_type, device_ptr, host_ptr,
-        iree_hal_buffer_release_callback_null(), &buffer);
+        release_callback, &buffer);
   }
 
   // Copy the initial contents into the buffer. This may require staging.
@@ -370,6 +626,9 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
     *out_buffer = buffer;
   } else {
     if (!buffer) {
+      if (release_callback.fn) {
+        release_callback.fn(release_callback.user_data, NULL);
+      }
       iree_hal_cuda_buffer_free(allocator->context, buffer_type, device_ptr,
                                 host_ptr);
     } else {
@@ -407,8 +666,20 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
                             iree_hal_cuda_buffer_host_pointer(base_buffer));
 
   switch (buffer_type) {
+    case IREE_HAL_CUDA_BUFFER_TYPE_ASYNC:
+      // Queue-ordered frees are recorded by iree_hal_cuda_allocator_free_async
+      // and leave the buffer without a device pointer.
+      if (!iree_hal_cuda_buffer_device_pointer(base_buffer)) break;
+      IREE_TRACE_FREE_NAMED(
+          IREE_HAL_CUDA_ALLOCATOR_ID,
+          (void*)iree_hal_cuda_buffer_device_pointer(base_buffer));
+      IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+          &allocator->statistics, iree_hal_buffer_memory_type(base_buffer),
+          iree_hal_buffer_allocation_size(base_buffer)));
+      break;
     case IREE_HAL_CUDA_BUFFER_TYPE_DEVICE:
-    case IREE_HAL_CUDA_BUFFER_TYPE_HOST: {
+    case IREE_HAL_CUDA_BUFFER_TYPE_HOST:
+    case IREE_HAL_CUDA_BUFFER_TYPE_SUBALLOCATED: {
       IREE_TRACE_FREE_NAMED(
           IREE_HAL_CUDA_ALLOCATOR_ID,
           (void*)iree_hal_cuda_buffer_device_pointer(base_buffer));
@@ -425,6 +696,108 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+bool iree_hal_cuda_allocator_supports_async(
+    iree_hal_allocator_t* base_allocator,
+    const iree_hal_buffer_params_t* params) {
+  if (!iree_hal_resource_is(base_allocator, &iree_hal_cuda_allocator_vtable)) {
+    return false;
+  }
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  // Pool memory is device-only; host-visible buffers take the synchronous path.
+  return allocator->async_pool &&
+         iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) &&
+         !iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE);
+}
+
+iree_status_t iree_hal_cuda_allocator_alloc_async(
+    iree_hal_allocator_t* base_allocator, CUstream stream,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  IREE_ASSERT(allocator->async_pool);
+
+  iree_hal_buffer_params_t compat_params = *params;
+  if (!iree_all_bits_set(iree_hal_cuda_allocator_query_buffer_compatibility(
+                             base_allocator, &compat_params, &allocation_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, allocation_size);
+  CUdeviceptr device_ptr = 0;
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      allocator->context->syms,
+      cuMemAllocFromPoolAsync(&device_ptr, allocation_size,
+                              allocator->async_pool, stream),
+      "cuMemAllocFromPoolAsync");
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_buffer_wrap(
+        base_allocator, compat_params.type, compat_params.access,
+        compat_params.usage, allocation_size,
+        /*byte_offset=*/0,
+        /*byte_length=*/allocation_size, IREE_HAL_CUDA_BUFFER_TYPE_ASYNC,
+        device_ptr, /*host_ptr=*/NULL, iree_hal_buffer_release_callback_null(),
+        &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    IREE_TRACE_ALLOC_NAMED(IREE_HAL_CUDA_ALLOCATOR_ID, (void*)device_ptr,
+                           allocation_size);
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, compat_params.type, allocation_size));
+    *out_buffer = buffer;
+  } else if (device_ptr) {
+    CUDA_IGNORE_ERROR(allocator->context->syms,
+                      cuMemFreeAsync(device_ptr, stream));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_cuda_allocator_free_async(
+    iree_hal_allocator_t* base_allocator, CUstream stream,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  IREE_ASSERT_EQ(iree_hal_cuda_buffer_type(buffer),
+                 IREE_HAL_CUDA_BUFFER_TYPE_ASYNC);
+  CUdeviceptr device_ptr = iree_hal_cuda_buffer_device_pointer(buffer);
+  if (!device_ptr) return iree_ok_status();  // already freed
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status =
+      CU_RESULT_TO_STATUS(allocator->context->syms,
+                          cuMemFreeAsync(device_ptr, stream), "cuMemFreeAsync");
+  if (iree_status_is_ok(status)) {
+    iree_hal_cuda_buffer_set_device_pointer(buffer, 0);
+    IREE_TRACE_FREE_NAMED(IREE_HAL_CUDA_ALLOCATOR_ID, (void*)device_ptr);
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+        &allocator->statistics, iree_hal_buffer_memory_type(buffer),
+        iree_hal_buffer_allocation_size(buffer)));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+CUcontext iree_hal_cuda_allocator_context(
+    iree_hal_allocator_t* base_allocator) {
+  if (!base_allocator ||
+      !iree_hal_resource_is(base_allocator, &iree_hal_cuda_allocator_vtable)) {
+    return NULL;
+  }
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  return allocator->context->cu_context;
+}
+
 static iree_status_t iree_hal_cuda_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
@@ -452,7 +825,10 @@ static iree_status_t iree_hal_cuda_allocator_import_buffer(
 
   switch (external_buffer->type) {
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION: {
-      if (iree_all_bits_set(compat_params.type,
+      // Integrated devices access registered host memory in-place so it can
+      // be used as device-local memory without copies.
+      if (!allocator->integrated &&
+          iree_all_bits_set(compat_params.type,
                             IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
         return iree_make_status(
             IREE_STATUS_INVALID_ARGUMENT,
@@ -464,7 +840,8 @@ static iree_status_t iree_hal_cuda_allocator_import_buffer(
       if (compat_params.access == IREE_HAL_MEMORY_ACCESS_READ) {
         register_flags = CU_MEMHOSTREGISTER_READ_ONLY;
       }
-      if (iree_any_bit_set(compat_params.usage,
+      if (allocator->integrated ||
+          iree_any_bit_set(compat_params.usage,
                            IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS |
                                IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ |
                                IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
@@ -483,6 +860,12 @@ static iree_status_t iree_hal_cuda_allocator_import_buffer(
       }
       break;
     }
+    case IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION: {
+      // The pointer must come from this context; CUDA validates it on use.
+      buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL;
+      device_ptr = (CUdeviceptr)external_buffer->handle.device_allocation.ptr;
+      break;
+    }
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_OPAQUE_FD:
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_OPAQUE_WIN32:
       return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
@@ -521,8 +904,45 @@ static iree_status_t iree_hal_cuda_allocator_export_buffer(
     iree_hal_external_buffer_type_t requested_type,
     iree_hal_external_buffer_flags_t requested_flags,
     iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
-  return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                          "exporting to external buffers not supported");
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_cuda_buffer_isa(allocated_buffer)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "buffer was not allocated by a CUDA allocator");
+  }
+  iree_device_size_t byte_offset = iree_hal_buffer_byte_offset(buffer);
+
+  // Note that the returned pointers are unowned.
+  switch (requested_type) {
+    case IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION: {
+      CUdeviceptr device_ptr =
+          iree_hal_cuda_buffer_device_pointer(allocated_buffer);
+      if (!device_ptr) {
+        return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "buffer has no device allocation");
+      }
+      out_external_buffer->handle.device_allocation.ptr =
+          (uint64_t)(device_ptr + byte_offset);
+      break;
+    }
+    case IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION: {
+      uint8_t* host_ptr =
+          (uint8_t*)iree_hal_cuda_buffer_host_pointer(allocated_buffer);
+      if (!host_ptr) {
+        return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "buffer has no host allocation");
+      }
+      out_external_buffer->handle.host_allocation.ptr = host_ptr + byte_offset;
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "external buffer type not supported");
+  }
+  out_external_buffer->type = requested_type;
+  out_external_buffer->flags = requested_flags;
+  out_external_buffer->size = iree_hal_buffer_byte_length(buffer);
+  return iree_ok_status();
 }
 
 static const iree_hal_allocator_vtable_t iree_hal_cuda_allocator_vtable = {
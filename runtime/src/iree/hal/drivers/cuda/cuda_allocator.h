@@ -17,9 +17,40 @@ extern "C" {
 #endif  // __cplusplus
 
 // Create a cuda allocator.
+// Device-only buffers are suballocated from blocks of
+// |suballocator_block_size| bytes unless it is 0. If |async_allocations| is
+// true and the device supports it a memory pool is created for queue-ordered
+// allocations that keeps up to |async_release_threshold| bytes of unused
+// memory reserved.
 iree_status_t iree_hal_cuda_allocator_create(
     iree_hal_device_t* base_device, iree_hal_cuda_context_wrapper_t* context,
-    CUdevice device, CUstream stream, iree_hal_allocator_t** out_allocator);
+    CUdevice device, CUstream stream,
+    iree_device_size_t suballocator_block_size, bool async_allocations,
+    uint64_t async_release_threshold, iree_hal_allocator_t** out_allocator);
+
+// Returns true if |allocator| is a CUDA allocator that can service
+// queue-ordered allocations of buffers with the given |params|.
+bool iree_hal_cuda_allocator_supports_async(
+    iree_hal_allocator_t* allocator, const iree_hal_buffer_params_t* params);
+
+// Allocates a device-local buffer from the allocator memory pool in the order
+// of |stream|. The buffer contents are only valid for work issued on |stream|
+// after this call or work ordered after it with events.
+iree_status_t iree_hal_cuda_allocator_alloc_async(
+    iree_hal_allocator_t* allocator, CUstream stream,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Frees the memory of an IREE_HAL_CUDA_BUFFER_TYPE_ASYNC |buffer| in the order
+// of |stream|. The buffer object remains valid until released but its contents
+// must not be accessed by work ordered after the free.
+iree_status_t iree_hal_cuda_allocator_free_async(
+    iree_hal_allocator_t* allocator, CUstream stream,
+    iree_hal_buffer_t* buffer);
+
+// Returns the CUDA context |allocator| allocates memory in or NULL if
+// |allocator| is not a CUDA allocator.
+CUcontext iree_hal_cuda_allocator_context(iree_hal_allocator_t* allocator);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -22,6 +22,14 @@ typedef enum iree_hal_cuda_buffer_type_e {
   IREE_HAL_CUDA_BUFFER_TYPE_HOST = 1u << 1,
   // cuMemHostRegister + cuMemHostUnregister
   IREE_HAL_CUDA_BUFFER_TYPE_HOST_REGISTERED = 1u << 2,
+  // Range of a cuMemAlloc block owned by the allocator's suballocator; the
+  // range is returned to the suballocator by the buffer release callback.
+  IREE_HAL_CUDA_BUFFER_TYPE_SUBALLOCATED = 1u << 3,
+  // cuMemAllocFromPoolAsync + cuMemFreeAsync (or cuMemFree if the buffer is
+  // released without a queue-ordered deallocation).
+  IREE_HAL_CUDA_BUFFER_TYPE_ASYNC = 1u << 4,
+  // Device allocation owned externally; not freed when the buffer is.
+  IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL = 1u << 5,
 } iree_hal_cuda_buffer_type_t;
 
 // Wraps a CUDA allocation in an iree_hal_buffer_t.
@@ -34,6 +42,9 @@ iree_status_t iree_hal_cuda_buffer_wrap(
     void* host_ptr, iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** out_buffer);
 
+// Returns true if |buffer| is a CUDA buffer.
+bool iree_hal_cuda_buffer_isa(const iree_hal_buffer_t* buffer);
+
 // Returns the underlying CUDA buffer type.
 iree_hal_cuda_buffer_type_t iree_hal_cuda_buffer_type(
     const iree_hal_buffer_t* buffer);
@@ -44,6 +55,12 @@ iree_hal_cuda_buffer_type_t iree_hal_cuda_buffer_type(
 CUdeviceptr iree_hal_cuda_buffer_device_pointer(
     const iree_hal_buffer_t* buffer);
 
+// Replaces the CUDA base pointer of |buffer|. Used to drop the pointer of an
+// IREE_HAL_CUDA_BUFFER_TYPE_ASYNC buffer once it has been freed in queue order
+// so that the allocation is not freed again when the buffer is destroyed.
+void iree_hal_cuda_buffer_set_device_pointer(iree_hal_buffer_t* buffer,
+                                             CUdeviceptr device_ptr);
+
 // Returns the CUDA host pointer for the given |buffer|, if available.
 void* iree_hal_cuda_buffer_host_pointer(const iree_hal_buffer_t* buffer);
 
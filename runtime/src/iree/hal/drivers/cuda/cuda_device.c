@@ -12,10 +12,13 @@
 
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
 #include "iree/hal/drivers/cuda/cuda_allocator.h"
+#include "iree/hal/drivers/cuda/cuda_buffer.h"
 #include "iree/hal/drivers/cuda/cuda_event.h"
+#include "iree/hal/drivers/cuda/cupti_profiler.h"
 #include "iree/hal/drivers/cuda/dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/event_semaphore.h"
 #include "iree/hal/drivers/cuda/graph_command_buffer.h"
@@ -27,6 +30,42 @@
 #include "iree/hal/drivers/cuda/tracing.h"
 #include "iree/hal/utils/buffer_transfer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/resource_set.h"
+#include "iree/hal/utils/semaphore_base.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_cuda_queue_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of queues as queue affinities are 64-bit masks.
+#define IREE_HAL_CUDA_MAX_QUEUE_COUNT 64
+
+// A submission that may still be executing on a queue stream.
+// Resources used by the submission are retained until the completion event has
+// been reached.
+typedef struct iree_hal_cuda_submission_t {
+  struct iree_hal_cuda_submission_t* next;
+  CUevent completion_event;
+  iree_hal_resource_set_t* resource_set;
+} iree_hal_cuda_submission_t;
+
+// A HAL queue backed by its own CUDA stream. Work submitted to different queues
+// may execute concurrently and is only ordered by semaphores, which are
+// lowered to CUDA events recorded on and waited by the queue streams.
+typedef struct iree_hal_cuda_queue_t {
+  CUstream stream;
+  iree_hal_cuda_tracing_context_t* tracing_context;
+
+  // Cache of the direct stream command buffer initialized when in stream mode.
+  iree_hal_command_buffer_t* stream_command_buffer;
+
+  // Guards submission to the stream and the submission list.
+  iree_slim_mutex_t mutex;
+
+  // FIFO of submissions not yet known to have completed in stream order.
+  iree_hal_cuda_submission_t* submission_head IREE_GUARDED_BY(mutex);
+  iree_hal_cuda_submission_t* submission_tail IREE_GUARDED_BY(mutex);
+} iree_hal_cuda_queue_t;
 
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_device_t
@@ -49,15 +88,19 @@ typedef struct iree_hal_cuda_device_t {
 
   CUdevice device;
 
-  // TODO: support multiple streams.
-  CUstream stream;
   iree_hal_cuda_context_wrapper_t context_wrapper;
-  iree_hal_cuda_tracing_context_t* tracing_context;
   iree_hal_allocator_t* device_allocator;
 
-  // Cache of the direct stream command buffer initialized when in stream mode.
-  // TODO: have one cached per stream once there are multiple streams.
-  iree_hal_command_buffer_t* stream_command_buffer;
+  // Queues mapped from HAL queue affinities, each with its own stream.
+  iree_host_size_t queue_count;
+  iree_hal_cuda_queue_t* queues;
+
+  // Devices with peer access enabled in either direction.
+  iree_host_size_t peer_count;
+  CUdevice* peers;
+
+  // Activity profiler active between profiling_begin and profiling_end, if any.
+  iree_hal_cuda_cupti_profiler_t* profiler;
 } iree_hal_cuda_device_t;
 
 static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable;
@@ -73,6 +116,9 @@ void iree_hal_cuda_device_params_initialize(
   memset(out_params, 0, sizeof(*out_params));
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_count = 1;
+  out_params->async_allocations = true;
+  out_params->async_release_threshold = UINT64_MAX;
+  out_params->peer_access = true;
   out_params->command_buffer_mode = IREE_HAL_CUDA_COMMAND_BUFFER_MODE_GRAPH;
   out_params->allow_inline_execution = false;
   out_params->stream_tracing = false;
@@ -88,57 +134,229 @@ static iree_status_t iree_hal_cuda_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "at least one queue is required");
   }
+  if (params->queue_count > IREE_HAL_CUDA_MAX_QUEUE_COUNT) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "at most %d queues are addressable by queue affinities (requested "
+        "%" PRIhsz ")",
+        IREE_HAL_CUDA_MAX_QUEUE_COUNT, params->queue_count);
+  }
   return iree_ok_status();
 }
 
+// Returns the queue to submit work to based on the |queue_affinity|.
+static iree_hal_cuda_queue_t* iree_hal_cuda_device_select_queue(
+    iree_hal_cuda_device_t* device, iree_hal_queue_affinity_t queue_affinity) {
+  // TODO(benvanik): meaningful heuristics for affinity. Today the affinity just
+  // hashes into the available queues so that distinct affinities used by the
+  // compiler for independent work map to distinct streams.
+  return &device->queues[queue_affinity % device->queue_count];
+}
+
+// Releases resources of all submissions on |queue| that have completed.
+// If |wait| is true then blocks until all submissions have completed.
+// Must be called with the queue mutex held.
+static iree_status_t iree_hal_cuda_queue_retire_submissions(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue, bool wait) {
+  iree_hal_cuda_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  iree_status_t status = iree_ok_status();
+  while (queue->submission_head) {
+    iree_hal_cuda_submission_t* submission = queue->submission_head;
+    CUresult result =
+        wait ? syms->cuEventSynchronize(submission->completion_event)
+             : syms->cuEventQuery(submission->completion_event);
+    if (result == CUDA_ERROR_NOT_READY) break;
+    if (result != CUDA_SUCCESS) {
+      status = iree_hal_cuda_result_to_status(syms, result, __FILE__, __LINE__);
+      break;
+    }
+    queue->submission_head = submission->next;
+    if (!queue->submission_head) queue->submission_tail = NULL;
+    CUDA_IGNORE_ERROR(syms, cuEventDestroy(submission->completion_event));
+    iree_hal_resource_set_free(submission->resource_set);
+    iree_allocator_free(device->context_wrapper.host_allocator, submission);
+  }
+  iree_hal_cuda_tracing_context_collect(queue->tracing_context);
+  return status;
+}
+
+// Initializes |queue| with a new stream.
+static iree_status_t iree_hal_cuda_queue_initialize(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue) {
+  iree_hal_cuda_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  iree_slim_mutex_initialize(&queue->mutex);
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      syms, cuStreamCreate(&queue->stream, CU_STREAM_NON_BLOCKING)));
+
+  // Enable tracing for the stream - no-op if disabled.
+  iree_status_t status = iree_ok_status();
+  if (device->params.stream_tracing) {
+    status = iree_hal_cuda_tracing_context_allocate(
+        &device->context_wrapper, device->identifier, queue->stream,
+        &device->block_pool, device->context_wrapper.host_allocator,
+        &queue->tracing_context);
+  }
+
+  if (iree_status_is_ok(status) &&
+      device->params.command_buffer_mode ==
+          IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM) {
+    status = iree_hal_cuda_stream_command_buffer_create(
+        (iree_hal_device_t*)device, &device->context_wrapper,
+        queue->tracing_context,
+        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION |
+            IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, queue->stream,
+        &device->block_pool, &queue->stream_command_buffer);
+  }
+  return status;
+}
+
+// Waits for all work on |queue| to complete and releases its resources.
+static void iree_hal_cuda_queue_deinitialize(iree_hal_cuda_device_t* device,
+                                             iree_hal_cuda_queue_t* queue) {
+  iree_hal_cuda_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  if (queue->stream) {
+    CUDA_IGNORE_ERROR(syms, cuStreamSynchronize(queue->stream));
+  }
+  iree_slim_mutex_lock(&queue->mutex);
+  iree_status_ignore(iree_hal_cuda_queue_retire_submissions(device, queue,
+                                                            /*wait=*/true));
+  iree_slim_mutex_unlock(&queue->mutex);
+  iree_hal_command_buffer_release(queue->stream_command_buffer);
+  iree_hal_cuda_tracing_context_free(queue->tracing_context);
+  if (queue->stream) {
+    CUDA_IGNORE_ERROR(syms, cuStreamDestroy(queue->stream));
+  }
+  iree_slim_mutex_deinitialize(&queue->mutex);
+}
+
+// Enables peer access in both directions between |device| and every other
+// device that supports it and already has an active primary context. Devices
+// created later enable access to this one as they are created. Inactive
+// contexts are not retained to avoid creating contexts on unused devices.
+// Must be called with the device context current.
+static iree_status_t iree_hal_cuda_device_enable_peer_access(
+    iree_hal_cuda_device_t* device) {
+  iree_hal_cuda_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  int device_count = 0;
+  CUDA_RETURN_IF_ERROR(syms, cuDeviceGetCount(&device_count),
+                       "cuDeviceGetCount");
+  if (device_count <= 1) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_allocator_malloc(
+      device->context_wrapper.host_allocator,
+      (device_count - 1) * sizeof(device->peers[0]), (void**)&device->peers);
+  for (int i = 0; i < device_count && iree_status_is_ok(status); ++i) {
+    CUdevice peer = 0;
+    status = CU_RESULT_TO_STATUS(syms, cuDeviceGet(&peer, i), "cuDeviceGet");
+    if (!iree_status_is_ok(status)) break;
+    if (peer == device->device) continue;
+
+    int can_access_peer = 0;
+    int peer_can_access = 0;
+    unsigned int peer_flags = 0;
+    int peer_active = 0;
+    status = CU_RESULT_TO_STATUS(
+        syms, cuDeviceCanAccessPeer(&can_access_peer, device->device, peer),
+        "cuDeviceCanAccessPeer");
+    if (iree_status_is_ok(status)) {
+      status = CU_RESULT_TO_STATUS(
+          syms, cuDeviceCanAccessPeer(&peer_can_access, peer, device->device),
+          "cuDeviceCanAccessPeer");
+    }
+    if (iree_status_is_ok(status)) {
+      status = CU_RESULT_TO_STATUS(
+          syms, cuDevicePrimaryCtxGetState(peer, &peer_flags, &peer_active),
+          "cuDevicePrimaryCtxGetState");
+    }
+    if (!iree_status_is_ok(status)) break;
+    if (!peer_active || (!can_access_peer && !peer_can_access)) continue;
+
+    // The peer context is held by another device; retaining it here only
+    // bumps the reference count.
+    CUcontext peer_context = NULL;
+    status = CU_RESULT_TO_STATUS(
+        syms, cuDevicePrimaryCtxRetain(&peer_context, peer),
+        "cuDevicePrimaryCtxRetain");
+    if (!iree_status_is_ok(status)) break;
+    CUresult result = CUDA_SUCCESS;
+    if (can_access_peer) {
+      result = syms->cuCtxEnablePeerAccess(peer_context, 0);
+    }
+    if (peer_can_access &&
+        (result == CUDA_SUCCESS ||
+         result == CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED)) {
+      result = syms->cuCtxPushCurrent(peer_context);
+      if (result == CUDA_SUCCESS) {
+        result = syms->cuCtxEnablePeerAccess(device->context_wrapper.cu_context,
+                                             0);
+        CUcontext popped_context = NULL;
+        syms->cuCtxPopCurrent(&popped_context);
+      }
+    }
+    syms->cuDevicePrimaryCtxRelease(peer);
+    if (result != CUDA_SUCCESS &&
+        result != CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED) {
+      status = iree_hal_cuda_result_to_status(syms, result, __FILE__, __LINE__);
+      break;
+    }
+    device->peers[device->peer_count++] = peer;
+  }
+
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, device->peer_count);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_cuda_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_cuda_device_params_t* params, CUdevice cu_device,
-    CUstream stream, CUcontext context, iree_hal_cuda_dynamic_symbols_t* syms,
+    CUcontext context, iree_hal_cuda_dynamic_symbols_t* syms,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_cuda_device_t* device = NULL;
-  iree_host_size_t total_size = iree_sizeof_struct(*device) + identifier.size;
+  iree_host_size_t total_size =
+      iree_sizeof_struct(*device) +
+      params->queue_count * sizeof(device->queues[0]) + identifier.size;
   IREE_RETURN_IF_ERROR(
       iree_allocator_malloc(host_allocator, total_size, (void**)&device));
   memset(device, 0, total_size);
   iree_hal_resource_initialize(&iree_hal_cuda_device_vtable, &device->resource);
   device->driver = driver;
   iree_hal_driver_retain(device->driver);
-  iree_string_view_append_to_buffer(
-      identifier, &device->identifier,
-      (char*)device + iree_sizeof_struct(*device));
+  uint8_t* buffer_ptr = (uint8_t*)device + iree_sizeof_struct(*device);
+  device->queues = (iree_hal_cuda_queue_t*)buffer_ptr;
+  buffer_ptr += params->queue_count * sizeof(device->queues[0]);
+  iree_string_view_append_to_buffer(identifier, &device->identifier,
+                                    (char*)buffer_ptr);
   device->params = *params;
   device->device = cu_device;
-  device->stream = stream;
   device->context_wrapper.cu_context = context;
   device->context_wrapper.host_allocator = host_allocator;
   iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                    &device->block_pool);
   device->context_wrapper.syms = syms;
 
-  // Enable tracing for the (currently only) stream - no-op if disabled.
+  // Queues are counted as they are initialized so that a partially
+  // initialized queue is cleaned up when the device is released on failure.
   iree_status_t status = iree_ok_status();
-  if (device->params.stream_tracing) {
-    status = iree_hal_cuda_tracing_context_allocate(
-        &device->context_wrapper, device->identifier, stream,
-        &device->block_pool, host_allocator, &device->tracing_context);
+  for (iree_host_size_t i = 0; i < params->queue_count; ++i) {
+    device->queue_count = i + 1;
+    status = iree_hal_cuda_queue_initialize(device, &device->queues[i]);
+    if (!iree_status_is_ok(status)) break;
   }
 
+  // Allocations are made on the first queue stream.
   if (iree_status_is_ok(status)) {
-    status = iree_hal_cuda_allocator_create((iree_hal_device_t*)device,
-                                            &device->context_wrapper, cu_device,
-                                            stream, &device->device_allocator);
+    status = iree_hal_cuda_allocator_create(
+        (iree_hal_device_t*)device, &device->context_wrapper, cu_device,
+        device->queues[0].stream, params->suballocator_block_size,
+        params->async_allocations, params->async_release_threshold,
+        &device->device_allocator);
   }
 
-  if (iree_status_is_ok(status) &&
-      params->command_buffer_mode == IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM) {
-    status = iree_hal_cuda_stream_command_buffer_create(
-        (iree_hal_device_t*)device, &device->context_wrapper,
-        device->tracing_context,
-        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION |
-            IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
-        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, device->stream,
-        &device->block_pool, &device->stream_command_buffer);
+  if (iree_status_is_ok(status) && params->peer_access) {
+    status = iree_hal_cuda_device_enable_peer_access(device);
   }
 
   if (iree_status_is_ok(status)) {
@@ -163,20 +381,13 @@ iree_status_t iree_hal_cuda_device_create(
       z0,
       CU_RESULT_TO_STATUS(syms, cuDevicePrimaryCtxRetain(&context, device)));
   iree_status_t status = CU_RESULT_TO_STATUS(syms, cuCtxSetCurrent(context));
-  CUstream stream;
-  if (iree_status_is_ok(status)) {
-    status = CU_RESULT_TO_STATUS(
-        syms, cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING));
-  }
   if (iree_status_is_ok(status)) {
+    // NOTE: on failure the partially created device is released and that
+    // releases the primary context.
     status = iree_hal_cuda_device_create_internal(driver, identifier, params,
-                                                  device, stream, context, syms,
+                                                  device, context, syms,
                                                   host_allocator, out_device);
-  }
-  if (!iree_status_is_ok(status)) {
-    if (stream) {
-      syms->cuStreamDestroy(stream);
-    }
+  } else {
     syms->cuDevicePrimaryCtxRelease(device);
   }
   IREE_TRACE_ZONE_END(z0);
@@ -188,18 +399,23 @@ static void iree_hal_cuda_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_command_buffer_release(device->stream_command_buffer);
+  // Wait for all in-flight work and release the resources it retained.
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_deinitialize(device, &device->queues[i]);
+  }
+
+  // Finish any profile that was never ended; all work has completed above.
+  iree_status_ignore(iree_hal_cuda_cupti_profiler_end(device->profiler));
+  device->profiler = NULL;
 
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
 
-  // TODO: support multiple streams.
-  iree_hal_cuda_tracing_context_free(device->tracing_context);
-  CUDA_IGNORE_ERROR(device->context_wrapper.syms,
-                    cuStreamDestroy(device->stream));
-
   iree_arena_block_pool_deinitialize(&device->block_pool);
 
+  // Peer access is disabled implicitly when either context is destroyed.
+  iree_allocator_free(host_allocator, device->peers);
+
   CUDA_IGNORE_ERROR(device->context_wrapper.syms,
                     cuDevicePrimaryCtxRelease(device->device));
 
@@ -239,6 +455,14 @@ static void iree_hal_cuda_replace_device_allocator(
 
 static iree_status_t iree_hal_cuda_device_trim(iree_hal_device_t* base_device) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_t* queue = &device->queues[i];
+    iree_slim_mutex_lock(&queue->mutex);
+    iree_status_t status = iree_hal_cuda_queue_retire_submissions(
+        device, queue, /*wait=*/false);
+    iree_slim_mutex_unlock(&queue->mutex);
+    IREE_RETURN_IF_ERROR(status);
+  }
   iree_arena_block_pool_trim(&device->block_pool);
   return iree_hal_allocator_trim(device->device_allocator);
 }
@@ -246,7 +470,7 @@ static iree_status_t iree_hal_cuda_device_trim(iree_hal_device_t* base_device) {
 static iree_status_t iree_hal_cuda_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
-  // iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
   *out_value = 0;
 
   if (iree_string_view_equal(category,
@@ -258,6 +482,50 @@ static iree_status_t iree_hal_cuda_device_query_i64(
     return iree_ok_status();
   }
 
+  // Peer topology queries keyed by the peer device ordinal, such as
+  // `cuda.p2p.performance_rank :: 1`. Lower performance ranks indicate faster
+  // links (NVLink ranks above PCIe) and can be used to place shards.
+  iree_string_view_t p2p_attribute = category;
+  if (iree_string_view_consume_prefix(&p2p_attribute, IREE_SV("cuda.p2p."))) {
+    int32_t peer_ordinal = 0;
+    if (!iree_string_view_atoi_int32(key, &peer_ordinal)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid peer device ordinal '%.*s'",
+                              (int)key.size, key.data);
+    }
+    iree_hal_cuda_dynamic_symbols_t* syms = device->context_wrapper.syms;
+    CUdevice peer = 0;
+    CUDA_RETURN_IF_ERROR(syms, cuDeviceGet(&peer, peer_ordinal),
+                         "cuDeviceGet");
+    if (iree_string_view_equal(p2p_attribute, IREE_SV("enabled"))) {
+      for (iree_host_size_t i = 0; i < device->peer_count; ++i) {
+        if (device->peers[i] == peer) *out_value = 1;
+      }
+      return iree_ok_status();
+    }
+    CUdevice_P2PAttribute attribute = CU_DEVICE_P2P_ATTRIBUTE_PERFORMANCE_RANK;
+    if (iree_string_view_equal(p2p_attribute, IREE_SV("performance_rank"))) {
+      attribute = CU_DEVICE_P2P_ATTRIBUTE_PERFORMANCE_RANK;
+    } else if (iree_string_view_equal(p2p_attribute,
+                                      IREE_SV("access_supported"))) {
+      attribute = CU_DEVICE_P2P_ATTRIBUTE_ACCESS_SUPPORTED;
+    } else if (iree_string_view_equal(p2p_attribute,
+                                      IREE_SV("native_atomic_supported"))) {
+      attribute = CU_DEVICE_P2P_ATTRIBUTE_NATIVE_ATOMIC_SUPPORTED;
+    } else {
+      return iree_make_status(IREE_STATUS_NOT_FOUND,
+                              "unknown peer attribute '%.*s'",
+                              (int)p2p_attribute.size, p2p_attribute.data);
+    }
+    if (peer == device->device) return iree_ok_status();
+    int value = 0;
+    CUDA_RETURN_IF_ERROR(
+        syms, cuDeviceGetP2PAttribute(&value, attribute, device->device, peer),
+        "cuDeviceGetP2PAttribute");
+    *out_value = value;
+    return iree_ok_status();
+  }
+
   return iree_make_status(
       IREE_STATUS_NOT_FOUND,
       "unknown device configuration key value '%.*s :: %.*s'",
@@ -334,6 +602,14 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  if (binding_capacity > 0) {
+    // Indirect command buffers are recorded in memory and replayed onto the
+    // stream with their bindings resolved upon submission.
+    return iree_hal_deferred_command_buffer_create(
+        base_device, mode, command_categories, binding_capacity,
+        &device->block_pool, iree_hal_device_host_allocator(base_device),
+        out_command_buffer);
+  }
   if (device->params.allow_inline_execution &&
       iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
@@ -341,9 +617,13 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
     // recorded, implying that the command buffer cannot be reused and doesn't
     // need to be persisted. This lets us lower the execution delay as we can
     // directly route commands to a CUDA stream and let it eagerly flush.
+    // The command buffer must be submitted with the same queue affinity so
+    // that its completion is tracked on the stream it executed on.
+    iree_hal_cuda_queue_t* queue =
+        iree_hal_cuda_device_select_queue(device, queue_affinity);
     return iree_hal_cuda_stream_command_buffer_create(
-        base_device, &device->context_wrapper, device->tracing_context, mode,
-        command_categories, binding_capacity, device->stream,
+        base_device, &device->context_wrapper, queue->tracing_context, mode,
+        command_categories, binding_capacity, queue->stream,
         &device->block_pool, out_command_buffer);
   }
   switch (device->params.command_buffer_mode) {
@@ -415,6 +695,154 @@ iree_hal_cuda_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+// Issues |command_buffers| on the |queue| stream.
+// Must be called with the queue mutex held.
+static iree_status_t iree_hal_cuda_queue_issue_command_buffers(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
+  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
+    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
+    if (iree_hal_cuda_stream_command_buffer_isa(command_buffer)) {
+      // Nothing to do for an inline command buffer; all the work has already
+      // been submitted to the stream of the queue selected by its affinity.
+      // We do not have to worry about any waits: if there were waits we
+      // wouldn't have been able to execute inline!
+    } else if (iree_hal_cuda_graph_command_buffer_isa(command_buffer)) {
+      CUgraphExec exec =
+          iree_hal_cuda_graph_command_buffer_handle(command_buffers[i]);
+      CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
+                           cuGraphLaunch(exec, queue->stream),
+                           "cuGraphLaunch");
+    } else {
+      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
+          command_buffers[i], queue->stream_command_buffer,
+          binding_tables ? binding_tables[i]
+                         : iree_hal_buffer_binding_table_empty()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Tracks a submission of |command_buffers| on |queue| by recording an event
+// after it on the stream. The command buffers, any buffers referenced by
+// |binding_tables|, and the semaphores in |signal_semaphore_list| (which have
+// host functions pending on the stream) are retained until the event is
+// reached.
+// Must be called with the queue mutex held.
+static iree_status_t iree_hal_cuda_queue_track_submission(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
+  iree_hal_cuda_dynamic_symbols_t* syms = device->context_wrapper.syms;
+  iree_hal_cuda_submission_t* submission = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      device->context_wrapper.host_allocator, sizeof(*submission),
+      (void**)&submission));
+  memset(submission, 0, sizeof(*submission));
+
+  iree_status_t status = iree_hal_resource_set_allocate(
+      &device->block_pool, &submission->resource_set);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(submission->resource_set,
+                                          command_buffer_count,
+                                          command_buffers);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(submission->resource_set,
+                                          signal_semaphore_list.count,
+                                          signal_semaphore_list.semaphores);
+  }
+  for (iree_host_size_t i = 0;
+       binding_tables && i < command_buffer_count && iree_status_is_ok(status);
+       ++i) {
+    if (!binding_tables[i].count) continue;
+    status = iree_hal_resource_set_insert_strided(
+        submission->resource_set, binding_tables[i].count,
+        &binding_tables[i].bindings[0].buffer,
+        sizeof(binding_tables[i].bindings[0]));
+  }
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(
+        syms, cuEventCreate(&submission->completion_event,
+                            CU_EVENT_DISABLE_TIMING));
+  }
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(
+        syms, cuEventRecord(submission->completion_event, queue->stream));
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (queue->submission_tail) {
+      queue->submission_tail->next = submission;
+    } else {
+      queue->submission_head = submission;
+    }
+    queue->submission_tail = submission;
+  } else {
+    if (submission->completion_event) {
+      CUDA_IGNORE_ERROR(syms, cuEventDestroy(submission->completion_event));
+    }
+    iree_hal_resource_set_free(submission->resource_set);
+    iree_allocator_free(device->context_wrapper.host_allocator, submission);
+  }
+  return status;
+}
+
+// Makes the |queue| stream wait on the events recorded for semaphore signals
+// from other queues. Semaphores from other devices are waited on the host. This
+// may block until the signals are enqueued so it must be called without holding
+// the queue lock that the signaling submissions may need; work enqueued on the
+// stream by other threads in the meantime is only conservatively ordered.
+static iree_status_t iree_hal_cuda_queue_enqueue_waits(
+    iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    uint64_t value = wait_semaphore_list.payload_values[i];
+    if (iree_hal_cuda_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_semaphore_enqueue_wait(
+          semaphore, value, queue->stream));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(semaphore, value,
+                                                   iree_infinite_timeout()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Signals |signal_semaphore_list| once the |queue| stream reaches this point.
+// Semaphores from other devices can only be signaled from the host after the
+// stream drains.
+// Must be called with the queue mutex held.
+static iree_status_t iree_hal_cuda_queue_enqueue_signals(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  bool did_synchronize = false;
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    uint64_t value = signal_semaphore_list.payload_values[i];
+    if (iree_hal_cuda_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_semaphore_enqueue_signal(
+          semaphore, value, queue->stream));
+      continue;
+    }
+    if (!did_synchronize) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuStreamSynchronize");
+      iree_status_t status = CU_RESULT_TO_STATUS(
+          device->context_wrapper.syms, cuStreamSynchronize(queue->stream));
+      IREE_TRACE_ZONE_END(z0);
+      IREE_RETURN_IF_ERROR(status);
+      did_synchronize = true;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_signal(semaphore, value));
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_cuda_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -422,15 +850,60 @@ static iree_status_t iree_hal_cuda_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_allocator_t* allocator = iree_hal_device_allocator(base_device);
+
+  // Allocations the memory pool cannot service (host-visible memory, or a
+  // replaced device allocator) are made synchronously on the host.
   // TODO(benvanik): tracing of the allocations (just for sequencing).
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  if (!iree_hal_cuda_allocator_supports_async(allocator, &params)) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
+                                                      iree_infinite_timeout()));
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        allocator, params, allocation_size, iree_const_byte_span_empty(),
+        out_buffer));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_list_signal(signal_semaphore_list));
+    return iree_ok_status();
+  }
+
+  iree_hal_cuda_queue_t* queue =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)(queue - device->queues));
+
+  iree_status_t status =
+      iree_hal_cuda_queue_enqueue_waits(queue, wait_semaphore_list);
+
+  // The allocation is ordered on the queue stream after the waits so the
+  // memory pool can reuse memory freed by prior work without synchronizing.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_slim_mutex_lock(&queue->mutex);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_retire_submissions(device, queue,
+                                                    /*wait=*/false);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_allocator_alloc_async(
+        allocator, queue->stream, &params, allocation_size, &buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_enqueue_signals(device, queue,
+                                                 signal_semaphore_list);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_track_submission(
+        device, queue, signal_semaphore_list, 0, NULL, NULL);
+  }
+  iree_slim_mutex_unlock(&queue->mutex);
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_queue_dealloca(
@@ -438,11 +911,51 @@ static iree_status_t iree_hal_cuda_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  // TODO(benvanik): tracing of the allocations (just for sequencing).
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+
+  // Only buffers allocated with queue_alloca from the memory pool can be freed
+  // in queue order. Others are released when their last reference is dropped.
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_cuda_buffer_isa(allocated_buffer) ||
+      iree_hal_cuda_buffer_type(allocated_buffer) !=
+          IREE_HAL_CUDA_BUFFER_TYPE_ASYNC) {
+    // TODO(benvanik): tracing of the allocations (just for sequencing).
+    return iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                         wait_semaphore_list,
+                                         signal_semaphore_list);
+  }
+
+  iree_hal_cuda_queue_t* queue =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)(queue - device->queues));
+
+  iree_status_t status =
+      iree_hal_cuda_queue_enqueue_waits(queue, wait_semaphore_list);
+
+  iree_slim_mutex_lock(&queue->mutex);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_retire_submissions(device, queue,
+                                                    /*wait=*/false);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_allocator_free_async(
+        allocated_buffer->device_allocator, queue->stream,
+        allocated_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_enqueue_signals(device, queue,
+                                                 signal_semaphore_list);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_track_submission(
+        device, queue, signal_semaphore_list, 0, NULL, NULL);
+  }
+  iree_slim_mutex_unlock(&queue->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_queue_execute(
@@ -450,41 +963,48 @@ static iree_status_t iree_hal_cuda_device_queue_execute(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_cuda_queue_t* queue =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)(queue - device->queues));
 
-  // TODO(benvanik): trace around the entire submission.
+  iree_status_t status =
+      iree_hal_cuda_queue_enqueue_waits(queue, wait_semaphore_list);
 
-  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
-    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
-    if (iree_hal_cuda_stream_command_buffer_isa(command_buffer)) {
-      // Nothing to do for an inline command buffer; all the work has already
-      // been submitted. When we support semaphores we'll still need to signal
-      // their completion but do not have to worry about any waits: if there
-      // were waits we wouldn't have been able to execute inline!
-    } else if (iree_hal_cuda_graph_command_buffer_isa(command_buffer)) {
-      CUgraphExec exec =
-          iree_hal_cuda_graph_command_buffer_handle(command_buffers[i]);
-      CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
-                           cuGraphLaunch(exec, device->stream),
-                           "cuGraphLaunch");
-    } else {
-      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
-          command_buffers[i], device->stream_command_buffer,
-          iree_hal_buffer_binding_table_empty()));
-    }
+  // Submissions to a queue are issued in order on its stream.
+  iree_slim_mutex_lock(&queue->mutex);
+
+  // Release resources from prior submissions that have completed.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_retire_submissions(device, queue,
+                                                    /*wait=*/false);
   }
 
-  // TODO(thomasraoux): implement semaphores - for now this conservatively
-  // synchronizes after every submit.
-  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuStreamSynchronize");
-  CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
-                       cuStreamSynchronize(device->stream),
-                       "cuStreamSynchronize");
-  iree_hal_cuda_tracing_context_collect(device->tracing_context);
-  IREE_TRACE_ZONE_END(z0);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_issue_command_buffers(
+        device, queue, command_buffer_count, command_buffers, binding_tables);
+  }
 
-  return iree_ok_status();
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_enqueue_signals(device, queue,
+                                                 signal_semaphore_list);
+  }
+
+  // Track the submission after the signals so that its completion implies the
+  // signal host functions have run.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_queue_track_submission(
+        device, queue, signal_semaphore_list, command_buffer_count,
+        command_buffers, binding_tables);
+  }
+
+  iree_slim_mutex_unlock(&queue->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_queue_flush(
@@ -496,22 +1016,183 @@ static iree_status_t iree_hal_cuda_device_queue_flush(
 static iree_status_t iree_hal_cuda_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "semaphore not implemented");
+  bool all_cuda = true;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    all_cuda &= iree_hal_cuda_semaphore_isa(semaphore_list.semaphores[i]);
+  }
+  if (all_cuda && semaphore_list.count > 1) {
+    // CUDA semaphores notify their timepoints when signaled from the host or
+    // by stream host functions so we can wait on all of them at once.
+    return iree_hal_semaphore_multi_wait(
+        wait_mode, semaphore_list, timeout, IREE_HAL_SEMAPHORE_WAIT_SPIN_NS,
+        iree_hal_device_host_allocator(base_device));
+  } else if (wait_mode == IREE_HAL_WAIT_MODE_ANY && semaphore_list.count > 1) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "wait-any on semaphores from multiple devices not implemented");
+  }
+  // Waiting on each semaphore in turn is equivalent to waiting on all of them
+  // as the deadline is absolute.
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+        semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+        iree_make_deadline(deadline_ns)));
+  }
+  return iree_ok_status();
+}
+
+// Resolves |transfer_buffer| at |offset| to a device pointer if it is backed by
+// a CUDA buffer and validates the range. Host buffers have |out_device_ptr| set
+// to 0 and their host pointer returned in |out_host_ptr|.
+static iree_status_t iree_hal_cuda_device_resolve_transfer_buffer(
+    iree_hal_transfer_buffer_t transfer_buffer, iree_device_size_t offset,
+    iree_device_size_t length, CUdeviceptr* out_device_ptr,
+    uint8_t** out_host_ptr) {
+  *out_device_ptr = 0;
+  *out_host_ptr = NULL;
+  if (!transfer_buffer.device_buffer) {
+    if (offset + length > transfer_buffer.host_buffer.data_length) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "transfer range exceeds host buffer length");
+    }
+    *out_host_ptr = transfer_buffer.host_buffer.data + offset;
+    return iree_ok_status();
+  }
+  iree_hal_buffer_t* buffer = transfer_buffer.device_buffer;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_validate_range(buffer, offset, length));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_buffer_validate_usage(iree_hal_buffer_allowed_usage(buffer),
+                                     IREE_HAL_BUFFER_USAGE_TRANSFER));
+  *out_device_ptr = iree_hal_cuda_buffer_device_pointer(
+                        iree_hal_buffer_allocated_buffer(buffer)) +
+                    iree_hal_buffer_byte_offset(buffer) + offset;
+  return iree_ok_status();
+}
+
+// Copies directly between host memory and device buffers with the CUDA async
+// copy APIs instead of recording and submitting a transfer command buffer.
+// Device buffers need not be mappable: device-local results are read back
+// straight into the user memory without a host-visible staging buffer. Pinned
+// (registered or cuMemHostAlloc) host memory is copied by DMA and pageable
+// memory is staged by the CUDA driver in chunks.
+static iree_status_t iree_hal_cuda_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  if (data_length == 0) return iree_ok_status();
+
+  // Buffers from other devices/allocators take the generic path.
+  if ((source.device_buffer &&
+       !iree_hal_cuda_buffer_isa(
+           iree_hal_buffer_allocated_buffer(source.device_buffer))) ||
+      (target.device_buffer &&
+       !iree_hal_cuda_buffer_isa(
+           iree_hal_buffer_allocated_buffer(target.device_buffer)))) {
+    return iree_hal_device_submit_transfer_range_and_wait(
+        base_device, source, source_offset, target, target_offset, data_length,
+        flags, timeout);
+  }
+
+  CUdeviceptr source_device_ptr = 0;
+  uint8_t* source_host_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_device_resolve_transfer_buffer(
+      source, source_offset, data_length, &source_device_ptr,
+      &source_host_ptr));
+  CUdeviceptr target_device_ptr = 0;
+  uint8_t* target_host_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_device_resolve_transfer_buffer(
+      target, target_offset, data_length, &target_device_ptr,
+      &target_host_ptr));
+  if (source_host_ptr && target_host_ptr) {
+    memcpy(target_host_ptr, source_host_ptr, (size_t)data_length);
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, data_length);
+
+  // Transfers are ordered with prior work on the first queue as if submitted
+  // there, matching iree_hal_device_submit_transfer_range_and_wait.
+  iree_hal_cuda_queue_t* queue = &device->queues[0];
+  iree_slim_mutex_lock(&queue->mutex);
+  iree_status_t status = iree_ok_status();
+  if (source_host_ptr) {
+    status = CU_RESULT_TO_STATUS(
+        device->context_wrapper.syms,
+        cuMemcpyHtoDAsync_v2(target_device_ptr, source_host_ptr,
+                             (size_t)data_length, queue->stream),
+        "cuMemcpyHtoDAsync_v2");
+  } else if (target_host_ptr) {
+    status = CU_RESULT_TO_STATUS(
+        device->context_wrapper.syms,
+        cuMemcpyDtoHAsync_v2(target_host_ptr, source_device_ptr,
+                             (size_t)data_length, queue->stream),
+        "cuMemcpyDtoHAsync_v2");
+  } else {
+    status = CU_RESULT_TO_STATUS(
+        device->context_wrapper.syms,
+        cuMemcpyAsync(target_device_ptr, source_device_ptr,
+                      (size_t)data_length, queue->stream),
+        "cuMemcpyAsync");
+  }
+  iree_slim_mutex_unlock(&queue->mutex);
+
+  // The transfer must have completed (and host memory be safe to reuse) when
+  // we return.
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(device->context_wrapper.syms,
+                                 cuStreamSynchronize(queue->stream),
+                                 "cuStreamSynchronize");
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to CUPTI here or use the much simpler cuProfilerStart API.
-  return iree_ok_status();
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  // Queue operations are captured by the tracing integration; only counter
+  // modes use CUPTI.
+  const iree_hal_device_profiling_mode_t counter_modes =
+      IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS |
+      IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS;
+  if (!iree_any_bit_set(options->mode, counter_modes)) return iree_ok_status();
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already begun on this device");
+  }
+  iree_status_t status = iree_hal_cuda_cupti_profiler_begin(
+      &device->context_wrapper, device->device, options,
+      iree_hal_device_host_allocator(base_device), &device->profiler);
+  if (iree_status_is_unavailable(status)) {
+    // Profiling is best-effort and it's ok to not capture anything.
+    iree_status_ignore(status);
+    status = iree_ok_status();
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  if (!device->profiler) return iree_ok_status();
+  // Activity records are only produced once the work has completed.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < device->queue_count && iree_status_is_ok(status); ++i) {
+    status = CU_RESULT_TO_STATUS(
+        device->context_wrapper.syms,
+        cuStreamSynchronize(device->queues[i].stream), "cuStreamSynchronize");
+  }
+  status = iree_status_join(
+      status, iree_hal_cuda_cupti_profiler_end(device->profiler));
+  device->profiler = NULL;
+  return status;
 }
 
 static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable = {
@@ -532,7 +1213,7 @@ static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable = {
     .create_semaphore = iree_hal_cuda_device_create_semaphore,
     .query_semaphore_compatibility =
         iree_hal_cuda_device_query_semaphore_compatibility,
-    .transfer_range = iree_hal_device_submit_transfer_range_and_wait,
+    .transfer_range = iree_hal_cuda_device_transfer_range,
     .queue_alloca = iree_hal_cuda_device_queue_alloca,
     .queue_dealloca = iree_hal_cuda_device_queue_dealloca,
     .queue_execute = iree_hal_cuda_device_queue_execute,
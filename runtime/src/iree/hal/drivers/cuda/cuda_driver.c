@@ -257,9 +257,44 @@ static iree_status_t iree_hal_cuda_driver_dump_device_info(
   iree_hal_cuda_driver_t* driver = iree_hal_cuda_driver_cast(base_driver);
   CUdevice device = (CUdevice)device_id;
   if (!device) return iree_ok_status();
-  // TODO: dump detailed device info.
-  (void)driver;
-  (void)device;
+
+  // Peer topology: whether each other device can be accessed directly and the
+  // relative performance of the link (0 is fastest, as reported by the driver).
+  int device_count = 0;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      &driver->syms, cuDeviceGetCount(&device_count), "cuDeviceGetCount"));
+  for (int i = 0; i < device_count; ++i) {
+    CUdevice peer = 0;
+    IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+        &driver->syms, cuDeviceGet(&peer, i), "cuDeviceGet"));
+    if (peer == device) continue;
+    int can_access = 0;
+    IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+        &driver->syms, cuDeviceCanAccessPeer(&can_access, device, peer),
+        "cuDeviceCanAccessPeer"));
+    int performance_rank = 0;
+    int native_atomics = 0;
+    if (can_access) {
+      IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+          &driver->syms,
+          cuDeviceGetP2PAttribute(&performance_rank,
+                                  CU_DEVICE_P2P_ATTRIBUTE_PERFORMANCE_RANK,
+                                  device, peer),
+          "cuDeviceGetP2PAttribute"));
+      IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+          &driver->syms,
+          cuDeviceGetP2PAttribute(
+              &native_atomics,
+              CU_DEVICE_P2P_ATTRIBUTE_NATIVE_ATOMIC_SUPPORTED, device, peer),
+          "cuDeviceGetP2PAttribute"));
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "- peer %d: access=%s performance_rank=%d native_atomics=%s\n", i,
+        can_access ? "yes" : "no", performance_rank,
+        native_atomics ? "yes" : "no"));
+  }
+
   return iree_ok_status();
 }
 
@@ -0,0 +1,597 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/cuda/cupti_profiler.h"
+
+#if !IREE_HAL_CUDA_CUPTI_ENABLE
+
+iree_status_t iree_hal_cuda_cupti_profiler_begin(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice device,
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_hal_cuda_cupti_profiler_t** out_profiler) {
+  *out_profiler = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "CUPTI support not compiled in; build with "
+                          "IREE_HAL_CUDA_ENABLE_CUPTI");
+}
+
+iree_status_t iree_hal_cuda_cupti_profiler_end(
+    iree_hal_cuda_cupti_profiler_t* profiler) {
+  return iree_ok_status();
+}
+
+#else
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cupti.h"
+#include "iree/base/internal/dynamic_library.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/dynamic_symbols.h"
+#include "iree/hal/drivers/cuda/status_util.h"
+
+static const char* kCUPTILoaderSearchNames[] = {
+#if defined(IREE_PLATFORM_WINDOWS)
+    "cupti.dll",
+#else
+    "libcupti.so",
+#endif  // IREE_PLATFORM_WINDOWS
+};
+
+// Size of each activity buffer handed to CUPTI. CUPTI fills buffers
+// asynchronously and returns them when full or flushed.
+#define IREE_HAL_CUDA_CUPTI_BUFFER_SIZE (1 * 1024 * 1024)
+
+// Activity record types read. Only the fields shared by every version of the
+// records are accessed so that older structs can read records from newer
+// CUPTI libraries.
+typedef CUpti_ActivityKernel4 iree_hal_cuda_cupti_kernel_record_t;
+typedef CUpti_ActivityMemcpy iree_hal_cuda_cupti_memcpy_record_t;
+typedef CUpti_ActivityMemset iree_hal_cuda_cupti_memset_record_t;
+
+#define IREE_HAL_CUDA_CUPTI_SYMBOLS(X)                                        \
+  X(cuptiActivityRegisterCallbacks, CUpti_BuffersCallbackRequestFunc,         \
+    CUpti_BuffersCallbackCompleteFunc)                                        \
+  X(cuptiActivityEnable, CUpti_ActivityKind)                                  \
+  X(cuptiActivityDisable, CUpti_ActivityKind)                                 \
+  X(cuptiActivityFlushAll, uint32_t)                                          \
+  X(cuptiActivityGetNextRecord, uint8_t*, size_t, CUpti_Activity**)           \
+  X(cuptiActivityGetNumDroppedRecords, CUcontext, uint32_t, size_t*)          \
+  X(cuptiGetResultString, CUptiResult, const char**)
+
+typedef struct iree_hal_cuda_cupti_symbols_t {
+  iree_dynamic_library_t* library;
+#define IREE_HAL_CUDA_CUPTI_PFN_DECL(name, ...) \
+  CUptiResult(CUPTIAPI* name)(__VA_ARGS__);
+  IREE_HAL_CUDA_CUPTI_SYMBOLS(IREE_HAL_CUDA_CUPTI_PFN_DECL)
+#undef IREE_HAL_CUDA_CUPTI_PFN_DECL
+} iree_hal_cuda_cupti_symbols_t;
+
+// One row of the report: either the aggregate of all dispatches of an export or
+// a single dispatch.
+typedef struct iree_hal_cuda_cupti_row_t {
+  // Kernel name or [memcpy]/[memset] for transfers. Owned by the export row.
+  const char* name;
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+  // Bytes moved by transfers; 0 for kernels.
+  uint64_t bytes;
+  // Launch shape and resource usage of the most recent dispatch.
+  uint32_t grid[3];
+  uint32_t block[3];
+  uint32_t registers_per_thread;
+  uint32_t shared_memory_size;
+} iree_hal_cuda_cupti_row_t;
+
+typedef struct iree_hal_cuda_cupti_row_list_t {
+  iree_hal_cuda_cupti_row_t* values;
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+} iree_hal_cuda_cupti_row_list_t;
+
+struct iree_hal_cuda_cupti_profiler_t {
+  iree_allocator_t host_allocator;
+  iree_hal_cuda_cupti_symbols_t syms;
+  bool per_dispatch;
+  char* file_path;
+
+  // Device limits used to derive theoretical occupancy.
+  int warp_size;
+  int max_threads_per_sm;
+  int max_blocks_per_sm;
+  int max_registers_per_sm;
+  int max_shared_memory_per_sm;
+
+  // Guards the rows as CUPTI returns buffers from its own thread.
+  iree_slim_mutex_t mutex;
+  // Aggregated rows per export; owns the names.
+  iree_hal_cuda_cupti_row_list_t exports;
+  // Per-dispatch rows when |per_dispatch| is set.
+  iree_hal_cuda_cupti_row_list_t dispatches;
+  // Total records dropped by CUPTI because buffers were not returned in time.
+  size_t dropped_record_count;
+  // First failure while processing records, reported when ending.
+  iree_status_t status;
+};
+
+// CUPTI buffer callbacks have no user data so the active profiler is global.
+// CUPTI activity collection is process-wide anyway.
+static iree_hal_cuda_cupti_profiler_t* iree_hal_cuda_cupti_active_profiler =
+    NULL;
+
+static iree_status_t iree_hal_cuda_cupti_result_to_status(
+    iree_hal_cuda_cupti_symbols_t* syms, CUptiResult result,
+    const char* symbol) {
+  if (IREE_LIKELY(result == CUPTI_SUCCESS)) return iree_ok_status();
+  const char* message = "unknown";
+  if (syms->cuptiGetResultString) {
+    syms->cuptiGetResultString(result, &message);
+  }
+  return iree_make_status(IREE_STATUS_INTERNAL, "%s failed: %s (%d)", symbol,
+                          message, (int)result);
+}
+
+#define CUPTI_RETURN_IF_ERROR(syms, expr)                         \
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_cupti_result_to_status(      \
+      (syms), (syms)->expr, IREE_STRINGIFY(expr)))
+
+static iree_status_t iree_hal_cuda_cupti_symbols_initialize(
+    iree_allocator_t host_allocator, iree_hal_cuda_cupti_symbols_t* out_syms) {
+  memset(out_syms, 0, sizeof(*out_syms));
+  iree_status_t status = iree_dynamic_library_load_from_files(
+      IREE_ARRAYSIZE(kCUPTILoaderSearchNames), kCUPTILoaderSearchNames,
+      IREE_DYNAMIC_LIBRARY_FLAG_NONE, host_allocator, &out_syms->library);
+  if (iree_status_is_not_found(status)) {
+    iree_status_ignore(status);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "CUPTI library not available; ensure installed "
+                            "and on path");
+  }
+#define IREE_HAL_CUDA_CUPTI_PFN_RESOLVE(name, ...)                  \
+  if (iree_status_is_ok(status)) {                                  \
+    status = iree_dynamic_library_lookup_symbol(                    \
+        out_syms->library, #name, (void**)&out_syms->name);         \
+  }
+  IREE_HAL_CUDA_CUPTI_SYMBOLS(IREE_HAL_CUDA_CUPTI_PFN_RESOLVE)
+#undef IREE_HAL_CUDA_CUPTI_PFN_RESOLVE
+  if (!iree_status_is_ok(status)) {
+    iree_dynamic_library_release(out_syms->library);
+    memset(out_syms, 0, sizeof(*out_syms));
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_cuda_cupti_row_list_append(
+    iree_allocator_t host_allocator, iree_hal_cuda_cupti_row_list_t* list,
+    iree_hal_cuda_cupti_row_t** out_row) {
+  if (list->count == list->capacity) {
+    iree_host_size_t new_capacity = iree_max(64, list->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        host_allocator, new_capacity * sizeof(list->values[0]),
+        (void**)&list->values));
+    list->capacity = new_capacity;
+  }
+  *out_row = &list->values[list->count++];
+  memset(*out_row, 0, sizeof(**out_row));
+  return iree_ok_status();
+}
+
+// Returns the export row for |name|, adding it if it has not been seen yet.
+// Must be called with the profiler mutex held.
+static iree_status_t iree_hal_cuda_cupti_profiler_lookup_export(
+    iree_hal_cuda_cupti_profiler_t* profiler, const char* name,
+    iree_hal_cuda_cupti_row_t** out_row) {
+  // Exports are few and dispatches of the same export tend to be adjacent so a
+  // reverse linear scan is sufficient.
+  for (iree_host_size_t i = profiler->exports.count; i > 0; --i) {
+    iree_hal_cuda_cupti_row_t* row = &profiler->exports.values[i - 1];
+    if (strcmp(row->name, name) == 0) {
+      *out_row = row;
+      return iree_ok_status();
+    }
+  }
+  char* name_copy = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_clone(
+      profiler->host_allocator,
+      iree_make_const_byte_span(name, strlen(name) + 1), (void**)&name_copy));
+  iree_status_t status = iree_hal_cuda_cupti_row_list_append(
+      profiler->host_allocator, &profiler->exports, out_row);
+  if (iree_status_is_ok(status)) {
+    (*out_row)->name = name_copy;
+    (*out_row)->min_ns = UINT64_MAX;
+  } else {
+    iree_allocator_free(profiler->host_allocator, name_copy);
+  }
+  return status;
+}
+
+static void iree_hal_cuda_cupti_row_accumulate(
+    iree_hal_cuda_cupti_row_t* row, const iree_hal_cuda_cupti_row_t* sample) {
+  row->count += sample->count;
+  row->total_ns += sample->total_ns;
+  row->min_ns = iree_min(row->min_ns, sample->min_ns);
+  row->max_ns = iree_max(row->max_ns, sample->max_ns);
+  row->bytes += sample->bytes;
+  memcpy(row->grid, sample->grid, sizeof(row->grid));
+  memcpy(row->block, sample->block, sizeof(row->block));
+  row->registers_per_thread = sample->registers_per_thread;
+  row->shared_memory_size = sample->shared_memory_size;
+}
+
+// Records one activity |sample| for export |name|.
+// Must be called with the profiler mutex held.
+static iree_status_t iree_hal_cuda_cupti_profiler_record(
+    iree_hal_cuda_cupti_profiler_t* profiler, const char* name,
+    iree_hal_cuda_cupti_row_t* sample) {
+  iree_hal_cuda_cupti_row_t* export_row = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_cupti_profiler_lookup_export(profiler, name, &export_row));
+  sample->name = export_row->name;
+  iree_hal_cuda_cupti_row_accumulate(export_row, sample);
+  if (profiler->per_dispatch) {
+    iree_hal_cuda_cupti_row_t* dispatch_row = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_cuda_cupti_row_list_append(
+        profiler->host_allocator, &profiler->dispatches, &dispatch_row));
+    *dispatch_row = *sample;
+  }
+  return iree_ok_status();
+}
+
+// Decodes a single CUPTI activity |record| into a row sample.
+// Must be called with the profiler mutex held.
+static iree_status_t iree_hal_cuda_cupti_profiler_process_record(
+    iree_hal_cuda_cupti_profiler_t* profiler, const CUpti_Activity* record) {
+  iree_hal_cuda_cupti_row_t sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.count = 1;
+  switch (record->kind) {
+    case CUPTI_ACTIVITY_KIND_KERNEL:
+    case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+      const iree_hal_cuda_cupti_kernel_record_t* kernel =
+          (const iree_hal_cuda_cupti_kernel_record_t*)record;
+      sample.total_ns = kernel->end - kernel->start;
+      sample.grid[0] = kernel->gridX;
+      sample.grid[1] = kernel->gridY;
+      sample.grid[2] = kernel->gridZ;
+      sample.block[0] = kernel->blockX;
+      sample.block[1] = kernel->blockY;
+      sample.block[2] = kernel->blockZ;
+      sample.registers_per_thread = kernel->registersPerThread;
+      sample.shared_memory_size =
+          kernel->staticSharedMemory + kernel->dynamicSharedMemory;
+      sample.min_ns = sample.max_ns = sample.total_ns;
+      return iree_hal_cuda_cupti_profiler_record(
+          profiler, kernel->name ? kernel->name : "[unknown]", &sample);
+    }
+    case CUPTI_ACTIVITY_KIND_MEMCPY: {
+      const iree_hal_cuda_cupti_memcpy_record_t* memcpy_record =
+          (const iree_hal_cuda_cupti_memcpy_record_t*)record;
+      sample.total_ns = memcpy_record->end - memcpy_record->start;
+      sample.bytes = memcpy_record->bytes;
+      sample.min_ns = sample.max_ns = sample.total_ns;
+      return iree_hal_cuda_cupti_profiler_record(profiler, "[memcpy]",
+                                                 &sample);
+    }
+    case CUPTI_ACTIVITY_KIND_MEMSET: {
+      const iree_hal_cuda_cupti_memset_record_t* memset_record =
+          (const iree_hal_cuda_cupti_memset_record_t*)record;
+      sample.total_ns = memset_record->end - memset_record->start;
+      sample.bytes = memset_record->bytes;
+      sample.min_ns = sample.max_ns = sample.total_ns;
+      return iree_hal_cuda_cupti_profiler_record(profiler, "[memset]",
+                                                 &sample);
+    }
+    default:
+      return iree_ok_status();
+  }
+}
+
+static void CUPTIAPI iree_hal_cuda_cupti_buffer_requested(
+    uint8_t** buffer, size_t* size, size_t* max_record_count) {
+  *buffer = NULL;
+  *size = 0;
+  *max_record_count = 0;  // as many as fit
+  iree_hal_cuda_cupti_profiler_t* profiler =
+      iree_hal_cuda_cupti_active_profiler;
+  if (!profiler) return;
+  // NOTE: CUPTI requires 8 byte alignment which the allocator guarantees.
+  iree_status_t status =
+      iree_allocator_malloc(profiler->host_allocator,
+                            IREE_HAL_CUDA_CUPTI_BUFFER_SIZE, (void**)buffer);
+  if (iree_status_is_ok(status)) {
+    *size = IREE_HAL_CUDA_CUPTI_BUFFER_SIZE;
+  } else {
+    // CUPTI drops records when no buffer is provided; they are counted below.
+    iree_status_ignore(status);
+  }
+}
+
+static void CUPTIAPI iree_hal_cuda_cupti_buffer_completed(
+    CUcontext context, uint32_t stream_id, uint8_t* buffer, size_t size,
+    size_t valid_size) {
+  iree_hal_cuda_cupti_profiler_t* profiler =
+      iree_hal_cuda_cupti_active_profiler;
+  if (!profiler) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&profiler->mutex);
+
+  CUpti_Activity* record = NULL;
+  while (iree_status_is_ok(profiler->status) &&
+         profiler->syms.cuptiActivityGetNextRecord(
+             buffer, valid_size, &record) == CUPTI_SUCCESS) {
+    profiler->status =
+        iree_hal_cuda_cupti_profiler_process_record(profiler, record);
+  }
+  size_t dropped_record_count = 0;
+  profiler->syms.cuptiActivityGetNumDroppedRecords(context, stream_id,
+                                                   &dropped_record_count);
+  profiler->dropped_record_count += dropped_record_count;
+
+  iree_slim_mutex_unlock(&profiler->mutex);
+  iree_allocator_free(profiler->host_allocator, buffer);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static const CUpti_ActivityKind kCUPTIActivityKinds[] = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL,
+    CUPTI_ACTIVITY_KIND_MEMCPY,
+    CUPTI_ACTIVITY_KIND_MEMSET,
+};
+
+static void iree_hal_cuda_cupti_profiler_free(
+    iree_hal_cuda_cupti_profiler_t* profiler) {
+  iree_allocator_t host_allocator = profiler->host_allocator;
+  for (iree_host_size_t i = 0; i < profiler->exports.count; ++i) {
+    iree_allocator_free(host_allocator,
+                        (void*)profiler->exports.values[i].name);
+  }
+  iree_allocator_free(host_allocator, profiler->exports.values);
+  iree_allocator_free(host_allocator, profiler->dispatches.values);
+  iree_status_ignore(profiler->status);
+  iree_slim_mutex_deinitialize(&profiler->mutex);
+  if (profiler->syms.library) {
+    iree_dynamic_library_release(profiler->syms.library);
+  }
+  iree_allocator_free(host_allocator, profiler->file_path);
+  iree_allocator_free(host_allocator, profiler);
+}
+
+static iree_status_t iree_hal_cuda_cupti_profiler_query_limits(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice device,
+    iree_hal_cuda_cupti_profiler_t* profiler) {
+  const struct {
+    CUdevice_attribute attribute;
+    int* value;
+  } queries[] = {
+      {CU_DEVICE_ATTRIBUTE_WARP_SIZE, &profiler->warp_size},
+      {CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR,
+       &profiler->max_threads_per_sm},
+      {CU_DEVICE_ATTRIBUTE_MAX_BLOCKS_PER_MULTIPROCESSOR,
+       &profiler->max_blocks_per_sm},
+      {CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR,
+       &profiler->max_registers_per_sm},
+      {CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR,
+       &profiler->max_shared_memory_per_sm},
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(queries); ++i) {
+    CUDA_RETURN_IF_ERROR(
+        context->syms,
+        cuDeviceGetAttribute(queries[i].value, queries[i].attribute, device),
+        "cuDeviceGetAttribute");
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_cupti_profiler_begin(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice device,
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_hal_cuda_cupti_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  if (iree_hal_cuda_cupti_active_profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "a CUPTI profile is already being captured");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_cuda_cupti_profiler_t* profiler = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*profiler),
+                                (void**)&profiler));
+  memset(profiler, 0, sizeof(*profiler));
+  profiler->host_allocator = host_allocator;
+  profiler->per_dispatch = iree_all_bits_set(
+      options->mode, IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS);
+  iree_slim_mutex_initialize(&profiler->mutex);
+
+  iree_status_t status = iree_ok_status();
+  if (options->file_path && strlen(options->file_path) > 0) {
+    status = iree_allocator_clone(
+        host_allocator,
+        iree_make_const_byte_span(options->file_path,
+                                  strlen(options->file_path) + 1),
+        (void**)&profiler->file_path);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_cupti_profiler_query_limits(context, device,
+                                                       profiler);
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_hal_cuda_cupti_symbols_initialize(host_allocator, &profiler->syms);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_cuda_cupti_active_profiler = profiler;
+    status = iree_hal_cuda_cupti_result_to_status(
+        &profiler->syms,
+        profiler->syms.cuptiActivityRegisterCallbacks(
+            iree_hal_cuda_cupti_buffer_requested,
+            iree_hal_cuda_cupti_buffer_completed),
+        "cuptiActivityRegisterCallbacks");
+  }
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(kCUPTIActivityKinds) && iree_status_is_ok(status);
+       ++i) {
+    status = iree_hal_cuda_cupti_result_to_status(
+        &profiler->syms,
+        profiler->syms.cuptiActivityEnable(kCUPTIActivityKinds[i]),
+        "cuptiActivityEnable");
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_profiler = profiler;
+  } else {
+    if (profiler->syms.library) {
+      for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(kCUPTIActivityKinds);
+           ++i) {
+        profiler->syms.cuptiActivityDisable(kCUPTIActivityKinds[i]);
+      }
+    }
+    iree_hal_cuda_cupti_active_profiler = NULL;
+    iree_hal_cuda_cupti_profiler_free(profiler);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the fraction of the maximum resident warps per SM a kernel launched
+// with |row|'s block size, registers, and shared memory can occupy.
+static double iree_hal_cuda_cupti_profiler_theoretical_occupancy(
+    const iree_hal_cuda_cupti_profiler_t* profiler,
+    const iree_hal_cuda_cupti_row_t* row) {
+  uint64_t threads_per_block =
+      (uint64_t)row->block[0] * row->block[1] * row->block[2];
+  if (!threads_per_block || profiler->warp_size <= 0) return 0.0;
+  uint64_t warp_size = (uint64_t)profiler->warp_size;
+  uint64_t max_warps_per_sm = profiler->max_threads_per_sm / warp_size;
+  uint64_t warps_per_block = (threads_per_block + warp_size - 1) / warp_size;
+  uint64_t blocks = iree_min((uint64_t)profiler->max_blocks_per_sm,
+                             max_warps_per_sm / warps_per_block);
+  if (row->registers_per_thread) {
+    // Registers are allocated per warp in units of 256.
+    uint64_t registers_per_warp =
+        (row->registers_per_thread * warp_size + 255) & ~(uint64_t)255;
+    blocks = iree_min(blocks, profiler->max_registers_per_sm /
+                                  (registers_per_warp * warps_per_block));
+  }
+  if (row->shared_memory_size) {
+    blocks = iree_min(blocks, profiler->max_shared_memory_per_sm /
+                                  row->shared_memory_size);
+  }
+  return max_warps_per_sm
+             ? (double)(blocks * warps_per_block) / (double)max_warps_per_sm
+             : 0.0;
+}
+
+static void iree_hal_cuda_cupti_profiler_write_rows(
+    const iree_hal_cuda_cupti_profiler_t* profiler,
+    const iree_hal_cuda_cupti_row_list_t* rows, FILE* file) {
+  for (iree_host_size_t i = 0; i < rows->count; ++i) {
+    const iree_hal_cuda_cupti_row_t* row = &rows->values[i];
+    double throughput_gbps =
+        row->total_ns ? (double)row->bytes / (double)row->total_ns : 0.0;
+    fprintf(file,
+            "\"%s\",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+            ",%ux%ux%u,%ux%ux%u,%u,%u,%.3f,%" PRIu64 ",%.3f\n",
+            row->name, row->count, row->total_ns,
+            row->count ? row->total_ns / row->count : 0,
+            row->count ? row->min_ns : 0, row->max_ns, row->grid[0],
+            row->grid[1], row->grid[2], row->block[0], row->block[1],
+            row->block[2], row->registers_per_thread, row->shared_memory_size,
+            iree_hal_cuda_cupti_profiler_theoretical_occupancy(profiler, row),
+            row->bytes, throughput_gbps);
+  }
+}
+
+// Orders aggregated export rows by descending total time so the kernels most
+// worth tuning come first.
+static int iree_hal_cuda_cupti_row_compare(const void* lhs_ptr,
+                                           const void* rhs_ptr) {
+  const iree_hal_cuda_cupti_row_t* lhs =
+      (const iree_hal_cuda_cupti_row_t*)lhs_ptr;
+  const iree_hal_cuda_cupti_row_t* rhs =
+      (const iree_hal_cuda_cupti_row_t*)rhs_ptr;
+  if (lhs->total_ns == rhs->total_ns) return 0;
+  return lhs->total_ns > rhs->total_ns ? -1 : 1;
+}
+
+static iree_status_t iree_hal_cuda_cupti_profiler_write_report(
+    iree_hal_cuda_cupti_profiler_t* profiler) {
+  // Per-dispatch rows stay in execution order.
+  if (!profiler->per_dispatch && profiler->exports.count > 0) {
+    qsort(profiler->exports.values, profiler->exports.count,
+          sizeof(profiler->exports.values[0]), iree_hal_cuda_cupti_row_compare);
+  }
+  FILE* file = stdout;
+  if (profiler->file_path) {
+    file = fopen(profiler->file_path, "wb");
+    if (!file) {
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "unable to open profile output file '%s'",
+                              profiler->file_path);
+    }
+  }
+  fprintf(file,
+          "export,count,total_ns,mean_ns,min_ns,max_ns,grid,block,"
+          "registers_per_thread,shared_memory_bytes,theoretical_occupancy,"
+          "bytes,throughput_gbps\n");
+  iree_hal_cuda_cupti_profiler_write_rows(
+      profiler,
+      profiler->per_dispatch ? &profiler->dispatches : &profiler->exports,
+      file);
+  if (profiler->dropped_record_count) {
+    fprintf(file, "# %" PRIhsz " activity records dropped\n",
+            profiler->dropped_record_count);
+  }
+  if (file == stdout) {
+    fflush(file);
+  } else {
+    fclose(file);
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_cupti_profiler_end(
+    iree_hal_cuda_cupti_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Force all buffers, including partially filled ones, to be returned so that
+  // the completion callback processes every record before we stop.
+  iree_status_t status = iree_hal_cuda_cupti_result_to_status(
+      &profiler->syms,
+      profiler->syms.cuptiActivityFlushAll(CUPTI_ACTIVITY_FLAG_FLUSH_FORCED),
+      "cuptiActivityFlushAll");
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(kCUPTIActivityKinds); ++i) {
+    profiler->syms.cuptiActivityDisable(kCUPTIActivityKinds[i]);
+  }
+
+  iree_slim_mutex_lock(&profiler->mutex);
+  iree_hal_cuda_cupti_active_profiler = NULL;
+  status = iree_status_join(status, profiler->status);
+  profiler->status = iree_ok_status();
+  iree_slim_mutex_unlock(&profiler->mutex);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_cupti_profiler_write_report(profiler);
+  }
+
+  iree_hal_cuda_cupti_profiler_free(profiler);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#endif  // IREE_HAL_CUDA_CUPTI_ENABLE
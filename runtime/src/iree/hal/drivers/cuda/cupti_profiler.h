@@ -0,0 +1,59 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_CUDA_CUPTI_PROFILER_H_
+#define IREE_HAL_DRIVERS_CUDA_CUPTI_PROFILER_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Enables the CUPTI activity collector. Requires the CUPTI headers from a CUDA
+// toolkit at build time (IREE_HAL_CUDA_ENABLE_CUPTI in CMake) and libcupti at
+// runtime. When disabled profiler creation returns IREE_STATUS_UNAVAILABLE.
+#if !defined(IREE_HAL_CUDA_CUPTI_ENABLE)
+#define IREE_HAL_CUDA_CUPTI_ENABLE 0
+#endif  // !IREE_HAL_CUDA_CUPTI_ENABLE
+
+// Collects kernel, memcpy, and memset activity records with CUPTI while
+// profiling is active and writes a CSV report keyed by kernel name (the
+// executable export name) when ended.
+//
+// With IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS records are aggregated
+// per export; with IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS one row
+// is written per dispatch. Each row includes the duration, launch shape,
+// register and shared memory usage, the theoretical occupancy derived from
+// them, and for transfers the bytes moved and achieved throughput.
+//
+// CUPTI activity collection is process-wide and only one profiler may be
+// active at a time.
+typedef struct iree_hal_cuda_cupti_profiler_t iree_hal_cuda_cupti_profiler_t;
+
+// Begins collecting activity on |device| as configured by |options|.
+// The report is written to |options->file_path| or stdout if none is given.
+// Returns IREE_STATUS_UNAVAILABLE if CUPTI support is not compiled in or the
+// library cannot be loaded.
+iree_status_t iree_hal_cuda_cupti_profiler_begin(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice device,
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_hal_cuda_cupti_profiler_t** out_profiler);
+
+// Ends collection, flushes all pending records, writes the report, and frees
+// |profiler|. All work must have completed on the device.
+iree_status_t iree_hal_cuda_cupti_profiler_end(
+    iree_hal_cuda_cupti_profiler_t* profiler);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_CUDA_CUPTI_PROFILER_H_
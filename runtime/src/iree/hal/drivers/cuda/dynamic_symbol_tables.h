@@ -8,14 +8,19 @@ CU_PFN_DECL(cuCtxCreate, CUcontext*, unsigned int, CUdevice)
 CU_PFN_DECL(cuCtxDestroy, CUcontext)
 CU_PFN_DECL(cuDevicePrimaryCtxRetain, CUcontext*, CUdevice)
 CU_PFN_DECL(cuDevicePrimaryCtxRelease, CUdevice)
+CU_PFN_DECL(cuDevicePrimaryCtxGetState, CUdevice, unsigned int*, int*)
 CU_PFN_DECL(cuCtxSetCurrent, CUcontext)
 CU_PFN_DECL(cuCtxPushCurrent, CUcontext)
 CU_PFN_DECL(cuCtxPopCurrent, CUcontext*)
+CU_PFN_DECL(cuCtxEnablePeerAccess, CUcontext, unsigned int)
 CU_PFN_DECL(cuDeviceGet, CUdevice*, int)
 CU_PFN_DECL(cuDeviceGetCount, int*)
 CU_PFN_DECL(cuDeviceGetName, char*, int, CUdevice)
 CU_PFN_DECL(cuDeviceGetAttribute, int*, CUdevice_attribute, CUdevice)
 CU_PFN_DECL(cuDeviceGetUuid, CUuuid*, CUdevice)
+CU_PFN_DECL(cuDeviceCanAccessPeer, int*, CUdevice, CUdevice)
+CU_PFN_DECL(cuDeviceGetP2PAttribute, int*, CUdevice_P2PAttribute, CUdevice,
+            CUdevice)
 CU_PFN_DECL(cuEventCreate, CUevent*, unsigned int)
 CU_PFN_DECL(cuEventDestroy, CUevent)
 CU_PFN_DECL(cuEventElapsedTime, float*, CUevent, CUevent)
@@ -30,9 +35,15 @@ CU_PFN_DECL(cuGraphAddMemsetNode, CUgraphNode*, CUgraph, const CUgraphNode*,
             size_t, const CUDA_MEMSET_NODE_PARAMS*, CUcontext)
 CU_PFN_DECL(cuGraphAddKernelNode, CUgraphNode*, CUgraph, const CUgraphNode*,
             size_t, const CUDA_KERNEL_NODE_PARAMS*)
+CU_PFN_DECL(cuGraphAddEmptyNode, CUgraphNode*, CUgraph, const CUgraphNode*,
+            size_t)
+CU_PFN_DECL(cuGraphAddChildGraphNode, CUgraphNode*, CUgraph,
+            const CUgraphNode*, size_t, CUgraph)
 CU_PFN_DECL(cuGraphCreate, CUgraph*, unsigned int)
 CU_PFN_DECL(cuGraphDestroy, CUgraph)
 CU_PFN_DECL(cuGraphExecDestroy, CUgraphExec)
+CU_PFN_DECL(cuGraphExecUpdate, CUgraphExec, CUgraph, CUgraphNode*,
+            CUgraphExecUpdateResult*)
 CU_PFN_DECL(cuGraphGetNodes, CUgraph, CUgraphNode*, size_t*)
 CU_PFN_DECL(cuGraphInstantiate, CUgraphExec*, CUgraph, CUgraphNode*, char*,
             size_t)
@@ -40,6 +51,7 @@ CU_PFN_DECL(cuGraphLaunch, CUgraphExec, CUstream)
 CU_PFN_DECL(cuInit, unsigned int)
 CU_PFN_DECL(cuMemAllocManaged, CUdeviceptr*, size_t, unsigned int)
 CU_PFN_DECL(cuMemPrefetchAsync, CUdeviceptr, size_t, CUdevice, CUstream)
+CU_PFN_DECL(cuMemAdvise, CUdeviceptr, size_t, CUmem_advise, CUdevice)
 CU_PFN_DECL(cuMemAlloc, CUdeviceptr*, size_t)
 CU_PFN_DECL(cuMemFree, CUdeviceptr)
 CU_PFN_DECL(cuMemFreeHost, void*)
@@ -47,6 +59,13 @@ CU_PFN_DECL(cuMemHostAlloc, void**, size_t, unsigned int)
 CU_PFN_DECL(cuMemHostRegister, void*, size_t, unsigned int)
 CU_PFN_DECL(cuMemHostUnregister, void*)
 CU_PFN_DECL(cuMemHostGetDevicePointer, CUdeviceptr*, void*, unsigned int)
+CU_PFN_DECL(cuMemPoolCreate, CUmemoryPool*, const CUmemPoolProps*)
+CU_PFN_DECL(cuMemPoolDestroy, CUmemoryPool)
+CU_PFN_DECL(cuMemPoolSetAttribute, CUmemoryPool, CUmemPool_attribute, void*)
+CU_PFN_DECL(cuMemPoolTrimTo, CUmemoryPool, size_t)
+CU_PFN_DECL(cuMemAllocFromPoolAsync, CUdeviceptr*, size_t, CUmemoryPool,
+            CUstream)
+CU_PFN_DECL(cuMemFreeAsync, CUdeviceptr, CUstream)
 CU_PFN_DECL(cuModuleGetFunction, CUfunction*, CUmodule, const char*)
 CU_PFN_DECL(cuModuleLoadDataEx, CUmodule*, const void*, unsigned int,
             CUjit_option*, void**)
@@ -55,6 +74,9 @@ CU_PFN_DECL(cuStreamCreate, CUstream*, unsigned int)
 CU_PFN_DECL(cuStreamDestroy, CUstream)
 CU_PFN_DECL(cuStreamSynchronize, CUstream)
 CU_PFN_DECL(cuStreamWaitEvent, CUstream, CUevent, unsigned int)
+CU_PFN_DECL(cuStreamBeginCapture, CUstream, CUstreamCaptureMode)
+CU_PFN_DECL(cuStreamEndCapture, CUstream, CUgraph*)
+CU_PFN_DECL(cuLaunchHostFunc, CUstream, CUhostFn, void*)
 CU_PFN_DECL(cuMemsetD32Async, unsigned long long, unsigned int, size_t,
             CUstream)
 CU_PFN_DECL(cuMemsetD16Async, unsigned long long, unsigned short, size_t,
@@ -62,7 +84,10 @@ CU_PFN_DECL(cuMemsetD16Async, unsigned long long, unsigned short, size_t,
 CU_PFN_DECL(cuMemsetD8Async, unsigned long long, unsigned char, size_t,
             CUstream)
 CU_PFN_DECL(cuMemcpyAsync, CUdeviceptr, CUdeviceptr, size_t, CUstream)
+CU_PFN_DECL(cuMemcpyPeerAsync, CUdeviceptr, CUcontext, CUdeviceptr, CUcontext,
+            size_t, CUstream)
 CU_PFN_DECL(cuMemcpyHtoDAsync_v2, CUdeviceptr, const void*, size_t, CUstream)
+CU_PFN_DECL(cuMemcpyDtoHAsync_v2, void*, CUdeviceptr, size_t, CUstream)
 CU_PFN_DECL(cuFuncSetAttribute, CUfunction, CUfunction_attribute, int)
 CU_PFN_DECL(cuLaunchKernel, CUfunction, unsigned int, unsigned int,
             unsigned int, unsigned int, unsigned int, unsigned int,
@@ -9,13 +9,37 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/semaphore_base.h"
 
 typedef struct iree_hal_cuda_semaphore_t {
   iree_hal_semaphore_t base;
   iree_hal_cuda_context_wrapper_t* context;
+
+  // Last value the semaphore is known to have reached. Advanced by host
+  // signals, by queries observing a pending event, and by host functions
+  // enqueued after signals on streams.
   iree_atomic_int64_t value;
+
+  // Status code of the failure the semaphore was failed with, if any.
+  iree_atomic_int32_t failure_code;
+
+  // Posted when the value changes or a new signal is enqueued on a stream.
+  iree_notification_t notification;
+
+  // Guards the pending signal state.
+  iree_slim_mutex_t mutex;
+
+  // Value the semaphore will reach once |pending_event| is reached on the
+  // device. Only valid when greater than the current |value|.
+  uint64_t pending_value IREE_GUARDED_BY(mutex);
+
+  // Event recorded on the stream that will signal |pending_value|. Lazily
+  // created on the first enqueued signal and re-recorded for each subsequent
+  // one; CUDA stream waits capture the state of the event at the time they are
+  // enqueued so re-recording does not affect waits already issued.
+  CUevent pending_event IREE_GUARDED_BY(mutex);
 } iree_hal_cuda_semaphore_t;
 
 static const iree_hal_semaphore_vtable_t iree_hal_cuda_semaphore_vtable;
@@ -42,6 +66,12 @@ iree_status_t iree_hal_cuda_semaphore_create(
     semaphore->context = context;
     iree_atomic_store_int64(&semaphore->value, initial_value,
                             iree_memory_order_release);
+    iree_atomic_store_int32(&semaphore->failure_code, IREE_STATUS_OK,
+                            iree_memory_order_release);
+    iree_notification_initialize(&semaphore->notification);
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->pending_value = 0;
+    semaphore->pending_event = NULL;
     *out_semaphore = &semaphore->base;
   }
 
@@ -56,30 +86,86 @@ static void iree_hal_cuda_semaphore_destroy(
   iree_allocator_t host_allocator = semaphore->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (semaphore->pending_event) {
+    CUDA_IGNORE_ERROR(semaphore->context->syms,
+                      cuEventDestroy(semaphore->pending_event));
+  }
+  iree_slim_mutex_deinitialize(&semaphore->mutex);
+  iree_notification_deinitialize(&semaphore->notification);
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+bool iree_hal_cuda_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(semaphore, &iree_hal_cuda_semaphore_vtable);
+}
+
+static bool iree_hal_cuda_semaphore_is_failed(
+    iree_hal_cuda_semaphore_t* semaphore) {
+  return iree_atomic_load_int32(&semaphore->failure_code,
+                                iree_memory_order_acquire) != IREE_STATUS_OK;
+}
+
+// Advances the current value of |semaphore| to |new_value| unless it has
+// already reached a greater value. Returns the resulting value.
+static uint64_t iree_hal_cuda_semaphore_advance(
+    iree_hal_cuda_semaphore_t* semaphore, uint64_t new_value) {
+  int64_t value =
+      iree_atomic_load_int64(&semaphore->value, iree_memory_order_acquire);
+  while ((uint64_t)value < new_value) {
+    if (iree_atomic_compare_exchange_weak_int64(
+            &semaphore->value, &value, (int64_t)new_value,
+            iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+      return new_value;
+    }
+  }
+  return (uint64_t)value;
+}
+
+// Advances the current value of |semaphore| to the pending value if the
+// pending event has been reached on the device.
+static iree_status_t iree_hal_cuda_semaphore_update(
+    iree_hal_cuda_semaphore_t* semaphore, uint64_t* out_value) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&semaphore->mutex);
+  uint64_t value = (uint64_t)iree_atomic_load_int64(&semaphore->value,
+                                                    iree_memory_order_acquire);
+  if (semaphore->pending_value > value) {
+    CUresult result =
+        semaphore->context->syms->cuEventQuery(semaphore->pending_event);
+    if (result == CUDA_SUCCESS) {
+      value = iree_hal_cuda_semaphore_advance(semaphore,
+                                              semaphore->pending_value);
+    } else if (result != CUDA_ERROR_NOT_READY) {
+      status = iree_hal_cuda_result_to_status(semaphore->context->syms, result,
+                                              __FILE__, __LINE__);
+    }
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  *out_value = value;
+  return status;
+}
+
 static iree_status_t iree_hal_cuda_semaphore_query(
     iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
   iree_hal_cuda_semaphore_t* semaphore =
       iree_hal_cuda_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely.
-  *out_value =
-      iree_atomic_load_int64(&semaphore->value, iree_memory_order_acquire);
-  return iree_ok_status();
+  *out_value = 0;
+  if (iree_hal_cuda_semaphore_is_failed(semaphore)) {
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  }
+  return iree_hal_cuda_semaphore_update(semaphore, out_value);
 }
 
 static iree_status_t iree_hal_cuda_semaphore_signal(
     iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
   iree_hal_cuda_semaphore_t* semaphore =
       iree_hal_cuda_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely. Return OK currently as everything is
-  // synchronized for each submit to allow things to run.
   iree_atomic_store_int64(&semaphore->value, new_value,
                           iree_memory_order_release);
+  iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
   iree_hal_semaphore_poll(&semaphore->base);
   return iree_ok_status();
 }
@@ -88,22 +174,200 @@ static void iree_hal_cuda_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
                                          iree_status_t status) {
   iree_hal_cuda_semaphore_t* semaphore =
       iree_hal_cuda_semaphore_cast(base_semaphore);
-  // TODO: save status and mark timepoint as failed.
-  iree_status_ignore(status);
+  // TODO: retain the full status for queries instead of just the code.
+  int32_t expected = IREE_STATUS_OK;
+  iree_atomic_compare_exchange_strong_int32(
+      &semaphore->failure_code, &expected,
+      (int32_t)iree_status_consume_code(status), iree_memory_order_acq_rel,
+      iree_memory_order_relaxed);
+  iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
   iree_hal_semaphore_poll(&semaphore->base);
 }
 
+// Returns true if |value| has been reached, a signal covering it has been
+// enqueued on a stream, or the semaphore has failed.
+static bool iree_hal_cuda_semaphore_is_signal_known(
+    iree_hal_cuda_semaphore_t* semaphore, uint64_t value) {
+  if (iree_hal_cuda_semaphore_is_failed(semaphore)) return true;
+  if ((uint64_t)iree_atomic_load_int64(&semaphore->value,
+                                       iree_memory_order_acquire) >= value) {
+    return true;
+  }
+  iree_slim_mutex_lock(&semaphore->mutex);
+  const bool is_pending = semaphore->pending_value >= value;
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return is_pending;
+}
+
+typedef struct iree_hal_cuda_semaphore_wait_args_t {
+  iree_hal_cuda_semaphore_t* semaphore;
+  uint64_t value;
+} iree_hal_cuda_semaphore_wait_args_t;
+
+static bool iree_hal_cuda_semaphore_is_signal_known_thunk(void* arg) {
+  iree_hal_cuda_semaphore_wait_args_t* args =
+      (iree_hal_cuda_semaphore_wait_args_t*)arg;
+  return iree_hal_cuda_semaphore_is_signal_known(args->semaphore, args->value);
+}
+
+// Blocks the caller until a signal to |value| is known (either reached or
+// enqueued on a stream) or |deadline_ns| elapses.
+static iree_status_t iree_hal_cuda_semaphore_wait_for_signal(
+    iree_hal_cuda_semaphore_t* semaphore, uint64_t value,
+    iree_time_t deadline_ns) {
+  if (iree_hal_cuda_semaphore_is_signal_known(semaphore, value)) {
+    return iree_ok_status();
+  } else if (deadline_ns == IREE_TIME_INFINITE_PAST) {
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_cuda_semaphore_wait_args_t args = {
+      .semaphore = semaphore,
+      .value = value,
+  };
+  const bool did_signal = iree_notification_await(
+      &semaphore->notification, iree_hal_cuda_semaphore_is_signal_known_thunk,
+      &args, iree_make_deadline(deadline_ns));
+  IREE_TRACE_ZONE_END(z0);
+  return did_signal ? iree_ok_status()
+                    : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
 static iree_status_t iree_hal_cuda_semaphore_wait(
     iree_hal_semaphore_t* base_semaphore, uint64_t value,
     iree_timeout_t timeout) {
   iree_hal_cuda_semaphore_t* semaphore =
       iree_hal_cuda_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely. Return OK currently as everything is
-  // synchronized for each submit to allow things to run.
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  // Wait until the signal is enqueued on a stream (or made on the host).
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_semaphore_wait_for_signal(semaphore, value, deadline_ns));
+
+  // Poll for the device reaching the signal and block on the event if not yet
+  // reached. CUDA events cannot be waited on with a timeout so any timeout that
+  // is not immediate blocks until the device reaches the signal.
+  uint64_t current_value = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_semaphore_query(&semaphore->base, &current_value));
+  if (current_value < value) {
+    if (deadline_ns == IREE_TIME_INFINITE_PAST) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    // The event is owned by the semaphore and never destroyed while the
+    // semaphore is live so it's safe to synchronize on it outside of the lock.
+    // If a later signal re-records it we'll wait for that one instead.
+    iree_slim_mutex_lock(&semaphore->mutex);
+    CUevent pending_event = semaphore->pending_event;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuEventSynchronize");
+    iree_status_t status = CU_RESULT_TO_STATUS(
+        semaphore->context->syms, cuEventSynchronize(pending_event));
+    IREE_TRACE_ZONE_END(z0);
+    IREE_RETURN_IF_ERROR(status);
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_query(&semaphore->base, &current_value));
+  }
+
   iree_hal_semaphore_poll(&semaphore->base);
   return iree_ok_status();
 }
 
+iree_status_t iree_hal_cuda_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value, CUstream stream) {
+  iree_hal_cuda_semaphore_t* semaphore =
+      iree_hal_cuda_semaphore_cast(base_semaphore);
+
+  // CUDA has no wait-before-signal so block until the signal is enqueued.
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_semaphore_wait_for_signal(
+      semaphore, value, IREE_TIME_INFINITE_FUTURE));
+
+  uint64_t current_value = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_semaphore_query(&semaphore->base, &current_value));
+  if (current_value >= value) return iree_ok_status();
+
+  // Wait on the device for the stream the signal was enqueued on.
+  iree_slim_mutex_lock(&semaphore->mutex);
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      semaphore->context->syms,
+      cuStreamWaitEvent(stream, semaphore->pending_event, 0));
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return status;
+}
+
+// A signal made by a host function once a stream reaches it.
+typedef struct iree_hal_cuda_semaphore_host_signal_t {
+  iree_hal_cuda_semaphore_t* semaphore;
+  uint64_t value;
+} iree_hal_cuda_semaphore_host_signal_t;
+
+// Host function enqueued on a stream to signal the semaphore when the stream
+// reaches it. This wakes host waiters and resolves timepoints without anyone
+// needing to poll the pending event.
+//
+// NOTE: CUDA forbids calling into the CUDA API from host functions so this only
+// updates the value and notifies. The semaphore is kept live by the submission
+// that enqueued the signal until the stream has moved past this function.
+static void CUDA_CB iree_hal_cuda_semaphore_host_signal(void* user_data) {
+  iree_hal_cuda_semaphore_host_signal_t* signal =
+      (iree_hal_cuda_semaphore_host_signal_t*)user_data;
+  iree_hal_cuda_semaphore_t* semaphore = signal->semaphore;
+  uint64_t value = iree_hal_cuda_semaphore_advance(semaphore, signal->value);
+  iree_allocator_free(semaphore->context->host_allocator, signal);
+  iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+  iree_hal_semaphore_notify(&semaphore->base, value, IREE_STATUS_OK);
+}
+
+iree_status_t iree_hal_cuda_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value, CUstream stream) {
+  iree_hal_cuda_semaphore_t* semaphore =
+      iree_hal_cuda_semaphore_cast(base_semaphore);
+  iree_hal_cuda_dynamic_symbols_t* syms = semaphore->context->syms;
+
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&semaphore->mutex);
+  // A signal to a lower value than one already pending is covered by it.
+  if (value > semaphore->pending_value) {
+    if (!semaphore->pending_event) {
+      status = CU_RESULT_TO_STATUS(
+          syms, cuEventCreate(&semaphore->pending_event,
+                              CU_EVENT_DISABLE_TIMING));
+    }
+    if (iree_status_is_ok(status)) {
+      status = CU_RESULT_TO_STATUS(
+          syms, cuEventRecord(semaphore->pending_event, stream));
+    }
+    if (iree_status_is_ok(status)) {
+      semaphore->pending_value = value;
+    }
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Signal from the stream once it reaches this point.
+  iree_hal_cuda_semaphore_host_signal_t* signal = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(semaphore->context->host_allocator,
+                                   sizeof(*signal), (void**)&signal);
+  }
+  if (iree_status_is_ok(status)) {
+    signal->semaphore = semaphore;
+    signal->value = value;
+    status = CU_RESULT_TO_STATUS(
+        syms,
+        cuLaunchHostFunc(stream, iree_hal_cuda_semaphore_host_signal, signal));
+    if (!iree_status_is_ok(status)) {
+      iree_allocator_free(semaphore->context->host_allocator, signal);
+    }
+  }
+
+  // Wake any host threads waiting to enqueue device waits on this signal.
+  if (iree_status_is_ok(status)) {
+    iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+  }
+  return status;
+}
+
 static const iree_hal_semaphore_vtable_t iree_hal_cuda_semaphore_vtable = {
     .destroy = iree_hal_cuda_semaphore_destroy,
     .query = iree_hal_cuda_semaphore_query,
@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
 #include "iree/hal/drivers/cuda/status_util.h"
 
 #ifdef __cplusplus
@@ -23,6 +24,24 @@ iree_status_t iree_hal_cuda_semaphore_create(
     iree_hal_cuda_context_wrapper_t* context, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore);
 
+// Returns true if |semaphore| is a CUDA semaphore.
+bool iree_hal_cuda_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Makes work subsequently issued on |stream| wait until the CUDA |semaphore|
+// reaches |value|. If the signal has been enqueued on a stream the wait is
+// performed on the device with the event recorded for that signal. Otherwise
+// this blocks the calling thread until the signal is enqueued or made on the
+// host as CUDA does not support wait-before-signal.
+iree_status_t iree_hal_cuda_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* semaphore, uint64_t value, CUstream stream);
+
+// Enqueues a signal of the CUDA |semaphore| to |value| once all work
+// previously issued on |stream| completes. Host queries and waits observe the
+// new value once the stream reaches the signal and other streams can wait on it
+// with iree_hal_cuda_semaphore_enqueue_wait.
+iree_status_t iree_hal_cuda_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* semaphore, uint64_t value, CUstream stream);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
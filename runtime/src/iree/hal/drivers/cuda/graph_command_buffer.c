@@ -21,13 +21,10 @@
 #include "iree/hal/utils/collective_batch.h"
 #include "iree/hal/utils/resource_set.h"
 
-#define IREE_HAL_CUDA_MAX_BINDING_COUNT 64
-// Kernel arguments contains binding and push constants.
-#define IREE_HAL_CUDA_MAX_KERNEL_ARG 128
-
 // Command buffer implementation that directly maps to cuda graph.
 // This records the commands on the calling thread without additional threading
-// indirection.
+// indirection. Execution barriers become graph edges: nodes recorded between
+// two barriers have no edges between each other and may run concurrently.
 typedef struct iree_hal_cuda_graph_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_hal_cuda_context_wrapper_t* context;
@@ -41,20 +38,34 @@ typedef struct iree_hal_cuda_graph_command_buffer_t {
   // asynchronous operations.
   iree_arena_allocator_t arena;
 
+  // Graph being recorded into between begin and end.
   CUgraph graph;
+  // Executable graph instantiated on the first end and updated in place with
+  // cuGraphExecUpdate when the command buffer is re-recorded.
   CUgraphExec exec;
 
-  // Keep track of the last node added to the command buffer as we are currently
-  // serializing all the nodes (each node depends on the previous one).
-  CUgraphNode last_node;
+  // Node all nodes recorded since the last barrier depend on. NULL until the
+  // first barrier following a recorded node.
+  CUgraphNode barrier_node;
+  // Nodes recorded since the last barrier. They have no edges between each
+  // other and may execute concurrently; the next barrier joins them.
+  CUgraphNode* current_nodes;
+  iree_host_size_t current_node_count;
+  iree_host_size_t current_node_capacity;
 
   // Iteratively constructed batch of collective operations.
   iree_hal_collective_batch_t collective_batch;
 
+  // Stream used only to capture collective batches into child graphs.
+  // Created on the first flush of a collective batch.
+  CUstream capture_stream;
+
   int32_t push_constant[IREE_HAL_CUDA_MAX_PUSH_CONSTANT_COUNT];
 
-  // Keep track of the current set of kernel arguments.
-  void* current_descriptor[];
+  // Packed kernel argument buffer copied into each kernel node; bindings are
+  // written in place when pushed and push constants are copied in on dispatch.
+  // See iree_hal_cuda_pipeline_layout_argument_size.
+  CUdeviceptr arguments[IREE_HAL_CUDA_MAX_KERNEL_ARG];
 } iree_hal_cuda_graph_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -87,11 +98,9 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_cuda_graph_command_buffer_t* command_buffer = NULL;
-  size_t total_size = sizeof(*command_buffer) +
-                      IREE_HAL_CUDA_MAX_KERNEL_ARG * sizeof(void*) +
-                      IREE_HAL_CUDA_MAX_KERNEL_ARG * sizeof(CUdeviceptr);
-  iree_status_t status = iree_allocator_malloc(
-      context->host_allocator, total_size, (void**)&command_buffer);
+  iree_status_t status =
+      iree_allocator_malloc(context->host_allocator, sizeof(*command_buffer),
+                            (void**)&command_buffer);
   if (iree_status_is_ok(status)) {
     iree_hal_command_buffer_initialize(
         device, mode, command_categories, queue_affinity, binding_capacity,
@@ -100,14 +109,11 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
     iree_arena_initialize(block_pool, &command_buffer->arena);
     command_buffer->graph = NULL;
     command_buffer->exec = NULL;
-    command_buffer->last_node = NULL;
-
-    CUdeviceptr* device_ptrs =
-        (CUdeviceptr*)(command_buffer->current_descriptor +
-                       IREE_HAL_CUDA_MAX_KERNEL_ARG);
-    for (size_t i = 0; i < IREE_HAL_CUDA_MAX_KERNEL_ARG; i++) {
-      command_buffer->current_descriptor[i] = &device_ptrs[i];
-    }
+    command_buffer->barrier_node = NULL;
+    command_buffer->current_nodes = NULL;
+    command_buffer->current_node_count = 0;
+    command_buffer->current_node_capacity = 0;
+    command_buffer->capture_stream = NULL;
 
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -146,7 +152,13 @@ static void iree_hal_cuda_graph_command_buffer_destroy(
                       cuGraphExecDestroy(command_buffer->exec));
     command_buffer->exec = NULL;
   }
-  command_buffer->last_node = NULL;
+  if (command_buffer->capture_stream != NULL) {
+    CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                      cuStreamDestroy(command_buffer->capture_stream));
+    command_buffer->capture_stream = NULL;
+  }
+  iree_allocator_free(command_buffer->context->host_allocator,
+                      command_buffer->current_nodes);
 
   iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
   iree_hal_resource_set_free(command_buffer->resource_set);
@@ -180,9 +192,54 @@ static void* iree_hal_cuda_graph_command_buffer_dyn_cast(
   return NULL;
 }
 
+// Adds |node| to the set of nodes recorded since the last barrier.
+static iree_status_t iree_hal_cuda_graph_command_buffer_append_node(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer, CUgraphNode node) {
+  if (command_buffer->current_node_count ==
+      command_buffer->current_node_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(16, command_buffer->current_node_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        command_buffer->context->host_allocator,
+        new_capacity * sizeof(command_buffer->current_nodes[0]),
+        (void**)&command_buffer->current_nodes));
+    command_buffer->current_node_capacity = new_capacity;
+  }
+  command_buffer->current_nodes[command_buffer->current_node_count++] = node;
+  return iree_ok_status();
+}
+
+// Makes all nodes recorded after this point depend on all nodes recorded
+// before it. A single node is depended on directly and multiple nodes are
+// joined with an empty node so that subsequent nodes need only one edge.
+static iree_status_t iree_hal_cuda_graph_command_buffer_insert_barrier(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer) {
+  if (command_buffer->current_node_count == 0) {
+    // Nothing recorded since the last barrier; it still orders what follows.
+    return iree_ok_status();
+  } else if (command_buffer->current_node_count == 1) {
+    command_buffer->barrier_node = command_buffer->current_nodes[0];
+  } else {
+    CUDA_RETURN_IF_ERROR(
+        command_buffer->context->syms,
+        cuGraphAddEmptyNode(&command_buffer->barrier_node,
+                            command_buffer->graph,
+                            command_buffer->current_nodes,
+                            command_buffer->current_node_count),
+        "cuGraphAddEmptyNode");
+  }
+  command_buffer->current_node_count = 0;
+  return iree_ok_status();
+}
+
 // Flushes any pending batched collective operations.
 // Must be called before any other non-collective nodes are added to the graph
 // or a barrier is encountered.
+//
+// NCCL only issues work to streams so the batch is recorded with stream capture
+// into a child graph that is added as a single node. The NCCL kernels then
+// launch with the rest of the graph instead of requiring a stream fallback.
+// https://docs.nvidia.com/deeplearning/nccl/user-guide/docs/usage/cudagraph.html
 static iree_status_t iree_hal_cuda_graph_command_buffer_flush_collectives(
     iree_hal_cuda_graph_command_buffer_t* command_buffer) {
   // NOTE: we could move this out into callers by way of an always-inline shim -
@@ -193,28 +250,57 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_flush_collectives(
     return iree_ok_status();
   }
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_cuda_dynamic_symbols_t* syms = command_buffer->context->syms;
+
+  iree_status_t status = iree_ok_status();
+  if (command_buffer->capture_stream == NULL) {
+    status = CU_RESULT_TO_STATUS(
+        syms,
+        cuStreamCreate(&command_buffer->capture_stream, CU_STREAM_NON_BLOCKING),
+        "cuStreamCreate");
+  }
 
-  // TODO(#9580): use CUDA graph capture so that the NCCL calls end up in the
-  // graph:
-  // https://docs.nvidia.com/deeplearning/nccl/user-guide/docs/usage/cudagraph.html
-  //
-  // Something like:
-  //  syms->cuStreamBeginCapture(nccl_stream);
-  //  iree_hal_cuda_nccl_submit_batch(command_buffer->context,
-  //                                  &command_buffer->collective_batch,
-  //                                  nccl_stream);
-  //  syms->cuStreamEndCapture(nccl_stream, &child_graph);
-  //  syms->cuGraphAddChildGraphNode(..., child_graph);
-  //  syms->cuGraphDestroy(child_graph);  // probably, I think it gets cloned
-  //
-  // Note that we'll want to create a scratch stream that we use to perform the
-  // capture - we could memoize that on the command buffer or on the device
-  // (though that introduces potential threading issues). There may be a special
-  // stream mode for these capture-only streams that is lighter weight than a
-  // normal stream.
-  iree_status_t status = iree_make_status(
-      IREE_STATUS_UNIMPLEMENTED,
-      "CUDA graph capture of collective operations not yet implemented");
+  // Thread-local capture so that CUDA calls made by other threads while we are
+  // capturing are not treated as unsafe captures and failed.
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(
+        syms,
+        cuStreamBeginCapture(command_buffer->capture_stream,
+                             CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+        "cuStreamBeginCapture");
+    if (iree_status_is_ok(status)) {
+      // Tracing zones cannot be recorded on a capturing stream.
+      status = iree_hal_cuda_nccl_submit_batch(
+          command_buffer->context, /*tracing_context=*/NULL,
+          &command_buffer->collective_batch, command_buffer->capture_stream);
+      // Always end the capture so the stream is usable again on failure.
+      CUgraph child_graph = NULL;
+      iree_status_t end_status = CU_RESULT_TO_STATUS(
+          syms,
+          cuStreamEndCapture(command_buffer->capture_stream, &child_graph),
+          "cuStreamEndCapture");
+      status = iree_status_join(status, end_status);
+
+      // The child graph is cloned into the parent graph.
+      CUgraphNode node = NULL;
+      if (iree_status_is_ok(status)) {
+        status = CU_RESULT_TO_STATUS(
+            syms,
+            cuGraphAddChildGraphNode(&node, command_buffer->graph,
+                                     &command_buffer->barrier_node,
+                                     command_buffer->barrier_node ? 1 : 0,
+                                     child_graph),
+            "cuGraphAddChildGraphNode");
+      }
+      if (child_graph != NULL) {
+        CUDA_IGNORE_ERROR(syms, cuGraphDestroy(child_graph));
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_hal_cuda_graph_command_buffer_append_node(command_buffer,
+                                                                node);
+      }
+    }
+  }
 
   iree_hal_collective_batch_reset(&command_buffer->collective_batch);
   IREE_TRACE_ZONE_END(z0);
@@ -226,10 +312,24 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_begin(
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
 
-  // Fail if re-recording.
   if (command_buffer->graph != NULL) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
-                            "command buffer cannot be re-recorded");
+                            "command buffer is already being recorded");
+  }
+
+  // When re-recording drop the resources and staging data of the prior
+  // recording. The executable graph is kept so that it can be updated in place.
+  if (command_buffer->exec != NULL) {
+    iree_hal_resource_set_t* resource_set = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_allocate(
+        command_buffer->arena.block_pool, &resource_set));
+    iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
+    iree_hal_resource_set_free(command_buffer->resource_set);
+    command_buffer->resource_set = resource_set;
+    iree_arena_reset(&command_buffer->arena);
+    iree_hal_collective_batch_initialize(&command_buffer->arena,
+                                         command_buffer->resource_set,
+                                         &command_buffer->collective_batch);
   }
 
   // Create a new empty graph to record into.
@@ -250,24 +350,45 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
   // Reset state used during recording.
-  command_buffer->last_node = NULL;
+  command_buffer->barrier_node = NULL;
+  command_buffer->current_node_count = 0;
 
-  // Compile the graph.
-  CUgraphNode error_node = NULL;
-  iree_status_t status =
-      CU_RESULT_TO_STATUS(command_buffer->context->syms,
-                          cuGraphInstantiate(&command_buffer->exec,
-                                             command_buffer->graph, &error_node,
-                                             /*logBuffer=*/NULL,
-                                             /*bufferSize=*/0));
-  if (iree_status_is_ok(status)) {
-    // No longer need the source graph used for construction.
-    CUDA_IGNORE_ERROR(command_buffer->context->syms,
-                      cuGraphDestroy(command_buffer->graph));
-    command_buffer->graph = NULL;
+  iree_hal_cuda_dynamic_symbols_t* syms = command_buffer->context->syms;
+  iree_status_t status = iree_ok_status();
+  if (command_buffer->exec != NULL) {
+    // Re-recorded: try to update the executable graph in place. This succeeds
+    // when only node parameters (pointers, push constants, workgroup counts)
+    // changed and is much cheaper than instantiating a new graph.
+    //
+    // NOTE: drivers may resolve cuGraphExecUpdate_v2 which takes a
+    // CUgraphExecUpdateResultInfo* in place of the error node pointer.
+    // |update_info| is large enough for either and only the result is used.
+    CUgraphNode update_info[4] = {NULL};
+    CUgraphExecUpdateResult update_result;
+    if (syms->cuGraphExecUpdate(command_buffer->exec, command_buffer->graph,
+                                update_info, &update_result) != CUDA_SUCCESS) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuGraphExecUpdate fallback");
+      CUDA_IGNORE_ERROR(syms, cuGraphExecDestroy(command_buffer->exec));
+      command_buffer->exec = NULL;
+      IREE_TRACE_ZONE_END(z0);
+    }
+  }
+  if (command_buffer->exec == NULL) {
+    // Compile the graph.
+    CUgraphNode error_node = NULL;
+    status = CU_RESULT_TO_STATUS(
+        syms,
+        cuGraphInstantiate(&command_buffer->exec, command_buffer->graph,
+                           &error_node,
+                           /*logBuffer=*/NULL,
+                           /*bufferSize=*/0));
   }
 
-  return iree_ok_status();
+  // No longer need the source graph used for construction.
+  CUDA_IGNORE_ERROR(syms, cuGraphDestroy(command_buffer->graph));
+  command_buffer->graph = NULL;
+
+  return status;
 }
 
 static void iree_hal_cuda_graph_command_buffer_begin_debug_group(
@@ -296,10 +417,7 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_execution_barrier(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
-
-  return iree_ok_status();
+  return iree_hal_cuda_graph_command_buffer_insert_barrier(command_buffer);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_signal_event(
@@ -310,9 +428,8 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_signal_event(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
-
+  // Events are only ordered against the waits recorded in the same graph and
+  // those are lowered to barriers so there is nothing to record.
   return iree_ok_status();
 }
 
@@ -324,9 +441,7 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_reset_event(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
-
+  // See iree_hal_cuda_graph_command_buffer_signal_event.
   return iree_ok_status();
 }
 
@@ -344,10 +459,9 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_wait_events(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_graph_command_buffer_flush_collectives(command_buffer));
 
-  // TODO: Implement barrier with Graph edges. Right now all the nodes are
-  // serialized so this is a no-op.
-
-  return iree_ok_status();
+  // TODO: only join the nodes recorded before the events were signaled. This
+  // conservatively orders the wait against all prior nodes.
+  return iree_hal_cuda_graph_command_buffer_insert_barrier(command_buffer);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_discard_buffer(
@@ -405,17 +519,16 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_fill_buffer(
       .height = 1,
       .value = dword_pattern,
   };
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNode = command_buffer->last_node ? 1 : 0;
+  CUgraphNode node = NULL;
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddMemsetNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNode, &params,
+      cuGraphAddMemsetNode(&node, command_buffer->graph,
+                           &command_buffer->barrier_node,
+                           command_buffer->barrier_node ? 1 : 0, &params,
                            command_buffer->context->cu_context),
       "cuGraphAddMemsetNode");
 
-  return iree_ok_status();
+  return iree_hal_cuda_graph_command_buffer_append_node(command_buffer, node);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_update_buffer(
@@ -454,18 +567,16 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_update_buffer(
       .Depth = 1,
   };
 
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNode = command_buffer->last_node ? 1 : 0;
-
+  CUgraphNode node = NULL;
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddMemcpyNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNode, &params,
+      cuGraphAddMemcpyNode(&node, command_buffer->graph,
+                           &command_buffer->barrier_node,
+                           command_buffer->barrier_node ? 1 : 0, &params,
                            command_buffer->context->cu_context),
       "cuGraphAddMemcpyNode");
 
-  return iree_ok_status();
+  return iree_hal_cuda_graph_command_buffer_append_node(command_buffer, node);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_copy_buffer(
@@ -501,18 +612,16 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_copy_buffer(
       .Depth = 1,
   };
 
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNode = command_buffer->last_node ? 1 : 0;
-
+  CUgraphNode node = NULL;
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddMemcpyNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNode, &params,
+      cuGraphAddMemcpyNode(&node, command_buffer->graph,
+                           &command_buffer->barrier_node,
+                           command_buffer->barrier_node ? 1 : 0, &params,
                            command_buffer->context->cu_context),
       "cuGraphAddMemcpyNode");
 
-  return iree_ok_status();
+  return iree_hal_cuda_graph_command_buffer_append_node(command_buffer, node);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_collective(
@@ -541,21 +650,6 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_push_constants(
   return iree_ok_status();
 }
 
-// Tie together the binding index and its index in |bindings| array.
-typedef struct {
-  uint32_t index;
-  uint32_t binding;
-} iree_hal_cuda_binding_mapping_t;
-
-// Helper to sort the binding based on their binding index.
-static int compare_binding_index(const void* a, const void* b) {
-  const iree_hal_cuda_binding_mapping_t buffer_a =
-      *(const iree_hal_cuda_binding_mapping_t*)a;
-  const iree_hal_cuda_binding_mapping_t buffer_b =
-      *(const iree_hal_cuda_binding_mapping_t*)b;
-  return buffer_a.binding < buffer_b.binding ? -1 : 1;
-}
-
 static iree_status_t iree_hal_cuda_graph_command_buffer_push_descriptor_set(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
@@ -564,37 +658,32 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_push_descriptor_set(
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
 
-  iree_host_size_t base_binding =
-      iree_hal_cuda_base_binding_index(pipeline_layout, set);
-
   // Convention with the compiler side. We map bindings to kernel argument.
   // We compact the bindings to get a dense set of arguments and keep them order
-  // based on the binding index.
-  // Sort the binding based on the binding index and map the array index to the
-  // argument index.
-  iree_hal_cuda_binding_mapping_t binding_used[IREE_HAL_CUDA_MAX_BINDING_COUNT];
-  for (iree_host_size_t i = 0; i < binding_count; i++) {
-    iree_hal_cuda_binding_mapping_t buffer = {i, bindings[i].binding};
-    binding_used[i] = buffer;
-  }
-  // TODO: remove this sort - it's thankfully small (1-8 on average) but we
-  // should be able to avoid it like we do on the CPU side with a bitmap.
-  qsort(binding_used, binding_count, sizeof(iree_hal_cuda_binding_mapping_t),
-        compare_binding_index);
-  IREE_ASSERT_LT(binding_count, IREE_HAL_CUDA_MAX_BINDING_COUNT,
-                 "binding count larger than the max expected");
+  // based on the binding index. The pipeline layout precomputes the position
+  // of each binding ordinal.
+  iree_host_size_t base_binding =
+      iree_hal_cuda_base_binding_index(pipeline_layout, set);
+  const uint8_t* binding_ordinals =
+      iree_hal_cuda_pipeline_layout_binding_ordinals(pipeline_layout, set);
 
   for (iree_host_size_t i = 0; i < binding_count; i++) {
-    const iree_hal_descriptor_set_binding_t* binding =
-        &bindings[binding_used[i].index];
+    const iree_hal_descriptor_set_binding_t* binding = &bindings[i];
+    uint8_t ordinal = binding->binding < IREE_HAL_CUDA_MAX_BINDING_COUNT
+                          ? binding_ordinals[binding->binding]
+                          : IREE_HAL_CUDA_INVALID_BINDING_ORDINAL;
+    if (IREE_UNLIKELY(ordinal == IREE_HAL_CUDA_INVALID_BINDING_ORDINAL)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding %u not declared in set %u layout",
+                              binding->binding, set);
+    }
     CUdeviceptr device_ptr =
         binding->buffer
             ? (iree_hal_cuda_buffer_device_pointer(
                    iree_hal_buffer_allocated_buffer(binding->buffer)) +
                iree_hal_buffer_byte_offset(binding->buffer) + binding->offset)
             : 0;
-    *((CUdeviceptr*)command_buffer->current_descriptor[i + base_binding]) =
-        device_ptr;
+    command_buffer->arguments[base_binding + ordinal] = device_ptr;
     if (binding->buffer) {
       IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
           command_buffer->resource_set, 1, &binding->buffer));
@@ -623,15 +712,22 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_dispatch(
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, 1, &executable));
 
-  // Patch the push constants in the kernel arguments.
+  // Patch the push constants in after the bindings. The argument buffer is
+  // laid out as the kernel parameters are and copied into the node as a
+  // single block.
   iree_host_size_t num_constants =
       iree_hal_cuda_pipeline_layout_num_constants(kernel_params.layout);
-  iree_host_size_t constant_base_index =
-      iree_hal_cuda_push_constant_index(kernel_params.layout);
-  for (iree_host_size_t i = 0; i < num_constants; i++) {
-    *((uint32_t*)command_buffer->current_descriptor[i + constant_base_index]) =
-        command_buffer->push_constant[i];
-  }
+  memcpy((uint8_t*)command_buffer->arguments +
+             iree_hal_cuda_pipeline_layout_push_constant_offset(
+                 kernel_params.layout),
+         command_buffer->push_constant, num_constants * sizeof(int32_t));
+  size_t argument_size =
+      iree_hal_cuda_pipeline_layout_argument_size(kernel_params.layout);
+  void* extra[] = {
+      CU_LAUNCH_PARAM_BUFFER_POINTER, command_buffer->arguments,
+      CU_LAUNCH_PARAM_BUFFER_SIZE,    &argument_size,
+      CU_LAUNCH_PARAM_END,
+  };
 
   CUDA_KERNEL_NODE_PARAMS params = {
       .func = kernel_params.function,
@@ -641,21 +737,20 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_dispatch(
       .gridDimX = workgroup_x,
       .gridDimY = workgroup_y,
       .gridDimZ = workgroup_z,
-      .kernelParams = command_buffer->current_descriptor,
+      .kernelParams = NULL,
+      .extra = extra,
       .sharedMemBytes = kernel_params.shared_memory_size,
   };
 
-  // Serialize all the nodes for now.
-  CUgraphNode dep[] = {command_buffer->last_node};
-  size_t numNodes = command_buffer->last_node ? 1 : 0;
-
+  CUgraphNode node = NULL;
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      cuGraphAddKernelNode(&command_buffer->last_node, command_buffer->graph,
-                           dep, numNodes, &params),
+      cuGraphAddKernelNode(&node, command_buffer->graph,
+                           &command_buffer->barrier_node,
+                           command_buffer->barrier_node ? 1 : 0, &params),
       "cuGraphAddKernelNode");
 
-  return iree_ok_status();
+  return iree_hal_cuda_graph_command_buffer_append_node(command_buffer, node);
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_dispatch_indirect(
@@ -7,9 +7,11 @@
 #include "iree/hal/drivers/cuda/pipeline_layout.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_descriptor_set_layout_t
@@ -19,6 +21,9 @@ typedef struct iree_hal_cuda_descriptor_set_layout_t {
   iree_hal_resource_t resource;
   iree_hal_cuda_context_wrapper_t* context;
   iree_host_size_t binding_count;
+  // Compacted position of each binding ordinal, precomputed so that pushing
+  // descriptor sets doesn't need to sort the bindings.
+  uint8_t binding_ordinals[IREE_HAL_CUDA_MAX_BINDING_COUNT];
 } iree_hal_cuda_descriptor_set_layout_t;
 
 static const iree_hal_descriptor_set_layout_vtable_t
@@ -43,6 +48,28 @@ iree_status_t iree_hal_cuda_descriptor_set_layout_create(
   *out_descriptor_set_layout = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Convention with the compiler side: bindings are compacted into a dense set
+  // of kernel arguments ordered by binding ordinal.
+  uint8_t binding_ordinals[IREE_HAL_CUDA_MAX_BINDING_COUNT];
+  memset(binding_ordinals, IREE_HAL_CUDA_INVALID_BINDING_ORDINAL,
+         sizeof(binding_ordinals));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    if (bindings[i].binding >= IREE_HAL_CUDA_MAX_BINDING_COUNT) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding ordinal %u over the limit of %d",
+                              bindings[i].binding,
+                              IREE_HAL_CUDA_MAX_BINDING_COUNT);
+    }
+    binding_ordinals[bindings[i].binding] = 0;
+  }
+  uint8_t ordinal = 0;
+  for (iree_host_size_t i = 0; i < IREE_HAL_CUDA_MAX_BINDING_COUNT; ++i) {
+    if (binding_ordinals[i] != IREE_HAL_CUDA_INVALID_BINDING_ORDINAL) {
+      binding_ordinals[i] = ordinal++;
+    }
+  }
+
   iree_hal_cuda_descriptor_set_layout_t* descriptor_set_layout = NULL;
   iree_status_t status = iree_allocator_malloc(context->host_allocator,
                                                sizeof(*descriptor_set_layout),
@@ -52,6 +79,8 @@ iree_status_t iree_hal_cuda_descriptor_set_layout_create(
                                  &descriptor_set_layout->resource);
     descriptor_set_layout->context = context;
     descriptor_set_layout->binding_count = binding_count;
+    memcpy(descriptor_set_layout->binding_ordinals, binding_ordinals,
+           sizeof(binding_ordinals));
     *out_descriptor_set_layout =
         (iree_hal_descriptor_set_layout_t*)descriptor_set_layout;
   }
@@ -66,6 +95,13 @@ iree_host_size_t iree_hal_cuda_descriptor_set_layout_binding_count(
   return descriptor_set_layout->binding_count;
 }
 
+const uint8_t* iree_hal_cuda_descriptor_set_layout_binding_ordinals(
+    iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
+  iree_hal_cuda_descriptor_set_layout_t* descriptor_set_layout =
+      iree_hal_cuda_descriptor_set_layout_cast(base_descriptor_set_layout);
+  return descriptor_set_layout->binding_ordinals;
+}
+
 static void iree_hal_cuda_descriptor_set_layout_destroy(
     iree_hal_descriptor_set_layout_t* base_descriptor_set_layout) {
   iree_hal_cuda_descriptor_set_layout_t* descriptor_set_layout =
@@ -93,7 +129,13 @@ typedef struct iree_hal_cuda_pipeline_layout_t {
   iree_hal_cuda_context_wrapper_t* context;
   iree_host_size_t push_constant_base_index;
   iree_host_size_t push_constant_count;
+  // Precomputed kernel argument layout. See
+  // iree_hal_cuda_pipeline_layout_argument_size.
+  iree_host_size_t push_constant_offset;
+  iree_host_size_t argument_size;
   iree_host_size_t set_layout_count;
+  // Base binding index of each set, stored after |set_layouts|.
+  iree_host_size_t* set_base_bindings;
   iree_hal_descriptor_set_layout_t* set_layouts[];
 } iree_hal_cuda_pipeline_layout_t;
 
@@ -133,19 +175,33 @@ iree_status_t iree_hal_cuda_pipeline_layout_create(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   if (push_constant_count > IREE_HAL_CUDA_MAX_PUSH_CONSTANT_COUNT) {
+    IREE_TRACE_ZONE_END(z0);
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "push constant count %zu over the limit of %d",
                             push_constant_count,
                             IREE_HAL_CUDA_MAX_PUSH_CONSTANT_COUNT);
   }
 
-  // Currently the pipeline layout doesn't do anything.
-  // TODO: Handle creating the argument layout at that time hadling both push
-  // constant and buffers.
+  iree_host_size_t binding_count = 0;
+  for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
+    binding_count +=
+        iree_hal_cuda_descriptor_set_layout_binding_count(set_layouts[i]);
+  }
+  if (binding_count + push_constant_count > IREE_HAL_CUDA_MAX_KERNEL_ARG) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "kernel argument count %zu over the limit of %d",
+                            binding_count + push_constant_count,
+                            IREE_HAL_CUDA_MAX_KERNEL_ARG);
+  }
+
+  // The kernel argument layout is computed once here so that dispatches only
+  // need to copy the push constants into the packed argument buffer.
   iree_hal_cuda_pipeline_layout_t* pipeline_layout = NULL;
   iree_host_size_t total_size =
       sizeof(*pipeline_layout) +
-      set_layout_count * sizeof(*pipeline_layout->set_layouts);
+      set_layout_count * sizeof(*pipeline_layout->set_layouts) +
+      set_layout_count * sizeof(*pipeline_layout->set_base_bindings);
   iree_status_t status = iree_allocator_malloc(
       context->host_allocator, total_size, (void**)&pipeline_layout);
   if (iree_status_is_ok(status)) {
@@ -153,15 +209,22 @@ iree_status_t iree_hal_cuda_pipeline_layout_create(
                                  &pipeline_layout->resource);
     pipeline_layout->context = context;
     pipeline_layout->set_layout_count = set_layout_count;
+    pipeline_layout->set_base_bindings =
+        (iree_host_size_t*)(pipeline_layout->set_layouts + set_layout_count);
     iree_host_size_t binding_number = 0;
     for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
       pipeline_layout->set_layouts[i] = set_layouts[i];
       iree_hal_descriptor_set_layout_retain(set_layouts[i]);
+      pipeline_layout->set_base_bindings[i] = binding_number;
       binding_number +=
           iree_hal_cuda_descriptor_set_layout_binding_count(set_layouts[i]);
     }
     pipeline_layout->push_constant_base_index = binding_number;
     pipeline_layout->push_constant_count = push_constant_count;
+    pipeline_layout->push_constant_offset =
+        binding_number * sizeof(CUdeviceptr);
+    pipeline_layout->argument_size = pipeline_layout->push_constant_offset +
+                                     push_constant_count * sizeof(int32_t);
     *out_pipeline_layout = (iree_hal_pipeline_layout_t*)pipeline_layout;
   }
   IREE_TRACE_ZONE_END(z0);
@@ -172,14 +235,15 @@ iree_host_size_t iree_hal_cuda_base_binding_index(
     iree_hal_pipeline_layout_t* base_pipeline_layout, uint32_t set) {
   iree_hal_cuda_pipeline_layout_t* pipeline_layout =
       iree_hal_cuda_pipeline_layout_cast(base_pipeline_layout);
-  iree_host_size_t base_binding = 0;
-  for (iree_host_size_t i = 0; i < set; ++i) {
-    iree_host_size_t binding_count =
-        iree_hal_cuda_descriptor_set_layout_binding_count(
-            pipeline_layout->set_layouts[i]);
-    base_binding += binding_count;
-  }
-  return base_binding;
+  return pipeline_layout->set_base_bindings[set];
+}
+
+const uint8_t* iree_hal_cuda_pipeline_layout_binding_ordinals(
+    iree_hal_pipeline_layout_t* base_pipeline_layout, uint32_t set) {
+  iree_hal_cuda_pipeline_layout_t* pipeline_layout =
+      iree_hal_cuda_pipeline_layout_cast(base_pipeline_layout);
+  return iree_hal_cuda_descriptor_set_layout_binding_ordinals(
+      pipeline_layout->set_layouts[set]);
 }
 
 iree_host_size_t iree_hal_cuda_push_constant_index(
@@ -196,6 +260,20 @@ iree_host_size_t iree_hal_cuda_pipeline_layout_num_constants(
   return pipeline_layout->push_constant_count;
 }
 
+iree_host_size_t iree_hal_cuda_pipeline_layout_argument_size(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_cuda_pipeline_layout_t* pipeline_layout =
+      iree_hal_cuda_pipeline_layout_cast(base_pipeline_layout);
+  return pipeline_layout->argument_size;
+}
+
+iree_host_size_t iree_hal_cuda_pipeline_layout_push_constant_offset(
+    iree_hal_pipeline_layout_t* base_pipeline_layout) {
+  iree_hal_cuda_pipeline_layout_t* pipeline_layout =
+      iree_hal_cuda_pipeline_layout_cast(base_pipeline_layout);
+  return pipeline_layout->push_constant_offset;
+}
+
 static const iree_hal_pipeline_layout_vtable_t
     iree_hal_cuda_pipeline_layout_vtable = {
         .destroy = iree_hal_cuda_pipeline_layout_destroy,
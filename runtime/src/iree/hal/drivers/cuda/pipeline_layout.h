@@ -17,6 +17,15 @@ extern "C" {
 
 #define IREE_HAL_CUDA_MAX_PUSH_CONSTANT_COUNT 64
 
+// Maximum binding ordinal (exclusive) in a descriptor set.
+#define IREE_HAL_CUDA_MAX_BINDING_COUNT 64
+
+// Kernel arguments contains bindings and push constants.
+#define IREE_HAL_CUDA_MAX_KERNEL_ARG 128
+
+// Marks a binding ordinal not declared in a descriptor set layout.
+#define IREE_HAL_CUDA_INVALID_BINDING_ORDINAL 0xFFu
+
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_descriptor_set_layout_t
 //===----------------------------------------------------------------------===//
@@ -32,6 +41,12 @@ iree_status_t iree_hal_cuda_descriptor_set_layout_create(
 iree_host_size_t iree_hal_cuda_descriptor_set_layout_binding_count(
     iree_hal_descriptor_set_layout_t* descriptor_set_layout);
 
+// Returns a table of IREE_HAL_CUDA_MAX_BINDING_COUNT entries mapping binding
+// ordinals to their position in the set when compacted in ordinal order, or
+// IREE_HAL_CUDA_INVALID_BINDING_ORDINAL if not declared in the set.
+const uint8_t* iree_hal_cuda_descriptor_set_layout_binding_ordinals(
+    iree_hal_descriptor_set_layout_t* descriptor_set_layout);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_pipeline_layout_t
 //===----------------------------------------------------------------------===//
@@ -47,6 +62,11 @@ iree_status_t iree_hal_cuda_pipeline_layout_create(
 iree_host_size_t iree_hal_cuda_base_binding_index(
     iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set);
 
+// Return the binding ordinal table of the given set. See
+// iree_hal_cuda_descriptor_set_layout_binding_ordinals.
+const uint8_t* iree_hal_cuda_pipeline_layout_binding_ordinals(
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set);
+
 // Return the base index for push constant data.
 iree_host_size_t iree_hal_cuda_push_constant_index(
     iree_hal_pipeline_layout_t* base_pipeline_layout);
@@ -55,6 +75,18 @@ iree_host_size_t iree_hal_cuda_push_constant_index(
 iree_host_size_t iree_hal_cuda_pipeline_layout_num_constants(
     iree_hal_pipeline_layout_t* base_pipeline_layout);
 
+// Return the size in bytes of the packed kernel argument buffer for the
+// pipeline layout. The buffer holds one CUdeviceptr per binding in binding
+// index order followed by the 32-bit push constants, laid out as the kernel
+// parameters are so it can be passed with CU_LAUNCH_PARAM_BUFFER_POINTER.
+iree_host_size_t iree_hal_cuda_pipeline_layout_argument_size(
+    iree_hal_pipeline_layout_t* base_pipeline_layout);
+
+// Return the byte offset of the push constants in the packed kernel argument
+// buffer.
+iree_host_size_t iree_hal_cuda_pipeline_layout_push_constant_offset(
+    iree_hal_pipeline_layout_t* base_pipeline_layout);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -29,6 +29,27 @@ IREE_FLAG(bool, cuda_tracing, true,
           "enabled. Severely impacts benchmark timings and should only be used "
           "when analyzing dispatch timings.");
 
+IREE_FLAG(int64_t, cuda_suballocator_block_size, 0,
+          "Size in bytes of the cuMemAlloc blocks device-local buffers are "
+          "suballocated from. 0 allocates each buffer with cuMemAlloc.");
+
+IREE_FLAG(bool, cuda_async_allocations, true,
+          "Enables queue-ordered allocations from a per-device CUDA memory "
+          "pool when supported by the device.");
+
+IREE_FLAG(int64_t, cuda_async_release_threshold, -1,
+          "Bytes of unused memory the CUDA memory pool keeps reserved at "
+          "synchronization points. -1 keeps all memory reserved until the "
+          "device is trimmed.");
+
+IREE_FLAG(bool, cuda_peer_access, true,
+          "Enables peer access between CUDA devices that support it so that "
+          "cross-device copies go directly over NVLink/PCIe.");
+
+IREE_FLAG(int32_t, cuda_queue_count, 1,
+          "Number of queues exposed on each CUDA device, each executing on "
+          "its own CUDA stream. Queue affinities are mapped onto the queues.");
+
 IREE_FLAG(int32_t, cuda_default_index, 0, "Index of the default CUDA device.");
 
 static iree_status_t iree_hal_cuda_driver_factory_enumerate(
@@ -99,8 +120,15 @@ static iree_status_t iree_hal_cuda_driver_factory_try_create(
     default_params.command_buffer_mode =
         IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM;
   }
+  default_params.queue_count = (iree_host_size_t)FLAG_cuda_queue_count;
   default_params.allow_inline_execution = FLAG_cuda_allow_inline_execution;
   default_params.stream_tracing = FLAG_cuda_tracing;
+  default_params.suballocator_block_size =
+      (iree_device_size_t)FLAG_cuda_suballocator_block_size;
+  default_params.async_allocations = FLAG_cuda_async_allocations;
+  default_params.async_release_threshold =
+      (uint64_t)FLAG_cuda_async_release_threshold;
+  default_params.peer_access = FLAG_cuda_peer_access;
 
   iree_status_t status =
       iree_hal_cuda_init_nccl_rank_and_count(&default_params);
@@ -7,6 +7,7 @@
 #include "iree/hal/drivers/cuda/stream_command_buffer.h"
 
 #include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/cuda_allocator.h"
 #include "iree/hal/drivers/cuda/cuda_buffer.h"
 #include "iree/hal/drivers/cuda/cuda_event.h"
 #include "iree/hal/drivers/cuda/native_executable.h"
@@ -16,10 +17,6 @@
 #include "iree/hal/utils/collective_batch.h"
 #include "iree/hal/utils/resource_set.h"
 
-#define IREE_HAL_CUDA_MAX_BINDING_COUNT 64
-// Kernel arguments contains binding and push constants.
-#define IREE_HAL_CUDA_MAX_KERNEL_ARG 128
-
 typedef struct {
   iree_hal_command_buffer_t base;
   iree_hal_cuda_context_wrapper_t* context;
@@ -40,9 +37,10 @@ typedef struct {
 
   int32_t push_constant[IREE_HAL_CUDA_MAX_PUSH_CONSTANT_COUNT];
 
-  // Keep track of the current set of kernel arguments.
-  void* current_descriptor[IREE_HAL_CUDA_MAX_KERNEL_ARG];
-  CUdeviceptr* device_ptrs[IREE_HAL_CUDA_MAX_KERNEL_ARG];
+  // Packed kernel argument buffer passed to each launch; bindings are written
+  // in place when pushed and push constants are copied in on dispatch.
+  // See iree_hal_cuda_pipeline_layout_argument_size.
+  CUdeviceptr arguments[IREE_HAL_CUDA_MAX_KERNEL_ARG];
 } iree_hal_cuda_stream_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -89,9 +87,6 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
     command_buffer->tracing_context = tracing_context;
     command_buffer->stream = stream;
     iree_arena_initialize(block_pool, &command_buffer->arena);
-    for (size_t i = 0; i < IREE_HAL_CUDA_MAX_KERNEL_ARG; i++) {
-      command_buffer->current_descriptor[i] = &command_buffer->device_ptrs[i];
-    }
 
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -373,14 +368,35 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_copy_buffer(
   IREE_RETURN_IF_ERROR(
       iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
 
-  CUdeviceptr target_device_buffer = iree_hal_cuda_buffer_device_pointer(
-      iree_hal_buffer_allocated_buffer(target_buffer));
+  iree_hal_buffer_t* target_allocated_buffer =
+      iree_hal_buffer_allocated_buffer(target_buffer);
+  iree_hal_buffer_t* source_allocated_buffer =
+      iree_hal_buffer_allocated_buffer(source_buffer);
+  CUdeviceptr target_device_buffer =
+      iree_hal_cuda_buffer_device_pointer(target_allocated_buffer);
   target_offset += iree_hal_buffer_byte_offset(target_buffer);
-  CUdeviceptr source_device_buffer = iree_hal_cuda_buffer_device_pointer(
-      iree_hal_buffer_allocated_buffer(source_buffer));
+  CUdeviceptr source_device_buffer =
+      iree_hal_cuda_buffer_device_pointer(source_allocated_buffer);
   source_offset += iree_hal_buffer_byte_offset(source_buffer);
   CUdeviceptr dst = target_device_buffer + target_offset;
   CUdeviceptr src = source_device_buffer + source_offset;
+
+  // Buffers allocated on another device are copied directly between the
+  // devices. This uses NVLink/PCIe peer transfers when peer access is enabled
+  // and is staged by the driver otherwise.
+  CUcontext target_context = iree_hal_cuda_allocator_context(
+      target_allocated_buffer->device_allocator);
+  CUcontext source_context = iree_hal_cuda_allocator_context(
+      source_allocated_buffer->device_allocator);
+  if (target_context && source_context && target_context != source_context) {
+    CUDA_RETURN_IF_ERROR(
+        command_buffer->context->syms,
+        cuMemcpyPeerAsync(dst, target_context, src, source_context, length,
+                          command_buffer->stream),
+        "cuMemcpyPeerAsync");
+    return iree_ok_status();
+  }
+
   CUDA_RETURN_IF_ERROR(command_buffer->context->syms,
                        cuMemcpyAsync(dst, src, length, command_buffer->stream),
                        "cuMemcpyAsync");
@@ -416,21 +432,6 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_push_constants(
   return iree_ok_status();
 }
 
-// Tie together the binding index and its index in |bindings| array.
-typedef struct {
-  uint32_t index;
-  uint32_t binding;
-} iree_hal_cuda_binding_mapping_t;
-
-// Helper to sort the binding based on their binding index.
-static int compare_binding_index(const void* a, const void* b) {
-  const iree_hal_cuda_binding_mapping_t buffer_a =
-      *(const iree_hal_cuda_binding_mapping_t*)a;
-  const iree_hal_cuda_binding_mapping_t buffer_b =
-      *(const iree_hal_cuda_binding_mapping_t*)b;
-  return buffer_a.binding < buffer_b.binding ? -1 : 1;
-}
-
 static iree_status_t iree_hal_cuda_stream_command_buffer_push_descriptor_set(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
@@ -439,36 +440,32 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_push_descriptor_set(
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
 
-  iree_host_size_t base_binding =
-      iree_hal_cuda_base_binding_index(pipeline_layout, set);
-
   // Convention with the compiler side. We map bindings to kernel argument.
   // We compact the bindings to get a dense set of arguments and keep them order
-  // based on the binding index.
-  // Sort the binding based on the binding index and map the array index to the
-  // argument index.
-  iree_hal_cuda_binding_mapping_t binding_used[IREE_HAL_CUDA_MAX_BINDING_COUNT];
-  for (iree_host_size_t i = 0; i < binding_count; i++) {
-    iree_hal_cuda_binding_mapping_t buffer = {i, bindings[i].binding};
-    binding_used[i] = buffer;
-  }
-  // TODO: remove this sort - it's thankfully small (1-8 on average) but we
-  // should be able to avoid it like we do on the CPU side with a bitmap.
-  qsort(binding_used, binding_count, sizeof(iree_hal_cuda_binding_mapping_t),
-        compare_binding_index);
-  assert(binding_count < IREE_HAL_CUDA_MAX_BINDING_COUNT &&
-         "binding count larger than the max expected.");
+  // based on the binding index. The pipeline layout precomputes the position
+  // of each binding ordinal.
+  iree_host_size_t base_binding =
+      iree_hal_cuda_base_binding_index(pipeline_layout, set);
+  const uint8_t* binding_ordinals =
+      iree_hal_cuda_pipeline_layout_binding_ordinals(pipeline_layout, set);
 
   for (iree_host_size_t i = 0; i < binding_count; i++) {
-    iree_hal_descriptor_set_binding_t binding = bindings[binding_used[i].index];
+    const iree_hal_descriptor_set_binding_t* binding = &bindings[i];
+    uint8_t ordinal = binding->binding < IREE_HAL_CUDA_MAX_BINDING_COUNT
+                          ? binding_ordinals[binding->binding]
+                          : IREE_HAL_CUDA_INVALID_BINDING_ORDINAL;
+    if (IREE_UNLIKELY(ordinal == IREE_HAL_CUDA_INVALID_BINDING_ORDINAL)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding %u not declared in set %u layout",
+                              binding->binding, set);
+    }
     CUdeviceptr device_ptr =
-        binding.buffer
+        binding->buffer
             ? (iree_hal_cuda_buffer_device_pointer(
-                   iree_hal_buffer_allocated_buffer(binding.buffer)) +
-               iree_hal_buffer_byte_offset(binding.buffer) + binding.offset)
+                   iree_hal_buffer_allocated_buffer(binding->buffer)) +
+               iree_hal_buffer_byte_offset(binding->buffer) + binding->offset)
             : 0;
-    *((CUdeviceptr*)command_buffer->current_descriptor[i + base_binding]) =
-        device_ptr;
+    command_buffer->arguments[base_binding + ordinal] = device_ptr;
   }
 
   return iree_ok_status();
@@ -496,15 +493,22 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_dispatch(
       /*line=*/0, /*func_name=*/NULL, 0, kernel_params.function_name.data,
       kernel_params.function_name.size);
 
-  // Patch the push constants in the kernel arguments.
+  // Patch the push constants in after the bindings. The argument buffer is
+  // laid out as the kernel parameters are and passed as a single block to
+  // avoid the per-parameter indirection of kernelParams.
   iree_host_size_t num_constants =
       iree_hal_cuda_pipeline_layout_num_constants(kernel_params.layout);
-  iree_host_size_t constant_base_index =
-      iree_hal_cuda_push_constant_index(kernel_params.layout);
-  for (iree_host_size_t i = 0; i < num_constants; i++) {
-    *((uint32_t*)command_buffer->current_descriptor[i + constant_base_index]) =
-        command_buffer->push_constant[i];
-  }
+  memcpy((uint8_t*)command_buffer->arguments +
+             iree_hal_cuda_pipeline_layout_push_constant_offset(
+                 kernel_params.layout),
+         command_buffer->push_constant, num_constants * sizeof(int32_t));
+  size_t argument_size =
+      iree_hal_cuda_pipeline_layout_argument_size(kernel_params.layout);
+  void* extra[] = {
+      CU_LAUNCH_PARAM_BUFFER_POINTER, command_buffer->arguments,
+      CU_LAUNCH_PARAM_BUFFER_SIZE,    &argument_size,
+      CU_LAUNCH_PARAM_END,
+  };
 
   CUDA_RETURN_IF_ERROR(
       command_buffer->context->syms,
@@ -512,7 +516,7 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_dispatch(
                      workgroup_z, kernel_params.block_size[0],
                      kernel_params.block_size[1], kernel_params.block_size[2],
                      kernel_params.shared_memory_size, command_buffer->stream,
-                     command_buffer->current_descriptor, NULL),
+                     /*kernelParams=*/NULL, extra),
       "cuLaunchKernel");
 
   IREE_CUDA_TRACE_ZONE_END(command_buffer->tracing_context,
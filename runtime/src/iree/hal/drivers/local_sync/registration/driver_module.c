@@ -10,9 +10,15 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
 #include "iree/hal/drivers/local_sync/sync_driver.h"
 #include "iree/hal/local/loaders/registration/init.h"
 
+IREE_FLAG(int32_t, local_sync_worker_count, 0,
+          "Number of threads executing the workgroups of each dispatch "
+          "alongside the thread issuing it. 0 executes dispatches inline on "
+          "the issuing thread only.");
+
 static iree_status_t iree_hal_local_sync_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -37,6 +43,12 @@ static iree_status_t iree_hal_local_sync_driver_factory_try_create(
 
   iree_hal_sync_device_params_t default_params;
   iree_hal_sync_device_params_initialize(&default_params);
+  if (FLAG_local_sync_worker_count < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--local_sync_worker_count must be >= 0");
+  }
+  default_params.worker_count =
+      (iree_host_size_t)FLAG_local_sync_worker_count;
 
   iree_hal_executable_loader_t* loaders[8] = {NULL};
   iree_host_size_t loader_count = 0;
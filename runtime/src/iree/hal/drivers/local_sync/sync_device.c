@@ -17,6 +17,8 @@
 #include "iree/hal/drivers/local_sync/sync_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/inline_command_buffer.h"
+#include "iree/hal/local/local_dispatch_pool.h"
+#include "iree/hal/local/local_dispatch_profiler.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/hal/utils/buffer_transfer.h"
@@ -38,6 +40,12 @@ typedef struct iree_hal_sync_device_t {
   // synchronization ourselves.
   iree_hal_sync_semaphore_state_t semaphore_state;
 
+  // Optional pool of threads that dispatches are distributed across.
+  iree_hal_local_dispatch_pool_t* dispatch_pool;
+
+  // Dispatch profiler active between profiling_begin and profiling_end, if any.
+  iree_hal_local_dispatch_profiler_t* profiler;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_sync_device_t;
@@ -62,6 +70,13 @@ static iree_status_t iree_hal_sync_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "arena block size too small (< 4096 bytes)");
   }
+  if (params->worker_count > IREE_HAL_LOCAL_DISPATCH_POOL_MAX_WORKER_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "worker count %" PRIhsz
+                            " exceeds the maximum of %d",
+                            params->worker_count,
+                            IREE_HAL_LOCAL_DISPATCH_POOL_MAX_WORKER_COUNT);
+  }
   return iree_ok_status();
 }
 
@@ -107,6 +122,11 @@ iree_status_t iree_hal_sync_device_create(
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
   }
 
+  if (iree_status_is_ok(status) && params->worker_count > 0) {
+    status = iree_hal_local_dispatch_pool_create(
+        params->worker_count, host_allocator, &device->dispatch_pool);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -121,6 +141,8 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_status_ignore(iree_hal_local_dispatch_profiler_end(device->profiler));
+  iree_hal_local_dispatch_pool_free(device->dispatch_pool);
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
@@ -184,7 +206,10 @@ static iree_status_t iree_hal_sync_device_query_i64(
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.dispatch"))) {
     if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
-      *out_value = 1;
+      *out_value = device->dispatch_pool
+                       ? (int64_t)iree_hal_local_dispatch_pool_concurrency(
+                             device->dispatch_pool)
+                       : 1;
       return iree_ok_status();
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.cpu"))) {
@@ -209,13 +234,19 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
-  if (iree_all_bits_set(mode,
+  // Indirect command buffers can't execute inline as their bindings are only
+  // known upon submission.
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  if (binding_capacity == 0 &&
+      iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
-    return iree_hal_inline_command_buffer_create(
+    IREE_RETURN_IF_ERROR(iree_hal_inline_command_buffer_create(
         base_device, mode, command_categories, queue_affinity, binding_capacity,
-        iree_hal_device_host_allocator(base_device), out_command_buffer);
+        iree_hal_device_host_allocator(base_device), out_command_buffer));
+    iree_hal_inline_command_buffer_set_dispatch_pool(*out_command_buffer,
+                                                     device->dispatch_pool);
+    return iree_ok_status();
   } else {
-    iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
     return iree_hal_deferred_command_buffer_create(
         base_device, mode, command_categories, binding_capacity,
         &device->large_block_pool, device->host_allocator, out_command_buffer);
@@ -303,7 +334,8 @@ static iree_status_t iree_hal_sync_device_queue_dealloca(
 
 static iree_status_t iree_hal_sync_device_apply_deferred_command_buffers(
     iree_hal_sync_device_t* device, iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
   // See if there are any deferred command buffers; this saves us work in cases
   // of pure inline execution.
   bool any_deferred = false;
@@ -333,9 +365,12 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffers(
           IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
           /*binding_capacity=*/0, device->host_allocator, storage,
           &inline_command_buffer));
+      iree_hal_inline_command_buffer_set_dispatch_pool(inline_command_buffer,
+                                                       device->dispatch_pool);
       iree_status_t status = iree_hal_deferred_command_buffer_apply(
           command_buffer, inline_command_buffer,
-          iree_hal_buffer_binding_table_empty());
+          binding_tables ? binding_tables[i]
+                         : iree_hal_buffer_binding_table_empty());
       iree_hal_inline_command_buffer_deinitialize(inline_command_buffer);
       IREE_RETURN_IF_ERROR(status);
     }
@@ -349,7 +384,8 @@ static iree_status_t iree_hal_sync_device_queue_execute(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
 
   // TODO(#4680): there is some better error handling here needed; we should
@@ -365,7 +401,7 @@ static iree_status_t iree_hal_sync_device_queue_execute(
   // Run all deferred command buffers - any we could have run inline we already
   // did during recording.
   IREE_RETURN_IF_ERROR(iree_hal_sync_device_apply_deferred_command_buffers(
-      device, command_buffer_count, command_buffers));
+      device, command_buffer_count, command_buffers, binding_tables));
 
   // Signal all semaphores now that batch work has completed.
   IREE_RETURN_IF_ERROR(iree_hal_sync_semaphore_multi_signal(
@@ -389,23 +425,32 @@ static iree_status_t iree_hal_sync_device_wait_semaphores(
 }
 
 static iree_status_t iree_hal_sync_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already active on the device");
+  }
+  // Only dispatch/executable counter modes are implemented using
+  // local_dispatch_profiler; other modes are ignored (and that's ok).
   // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
   // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
   // Capturing things like:
   //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
   //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
   //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  return iree_hal_local_dispatch_profiler_begin(options, device->host_allocator,
+                                                &device->profiler);
 }
 
 static iree_status_t iree_hal_sync_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  // All work executes synchronously so nothing can still be in flight.
+  iree_status_t status = iree_hal_local_dispatch_profiler_end(device->profiler);
+  device->profiler = NULL;
+  return status;
 }
 
 static const iree_hal_device_vtable_t iree_hal_sync_device_vtable = {
@@ -22,6 +22,12 @@ typedef struct iree_hal_sync_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Number of threads that execute the workgroups of each dispatch alongside
+  // the thread issuing it. 0 executes all dispatches on the issuing thread.
+  // Workers only split individual dispatches and are much lighter than the
+  // task system used by the local-task driver.
+  iree_host_size_t worker_count;
 } iree_hal_sync_device_params_t;
 
 // Initializes |out_params| to default values.
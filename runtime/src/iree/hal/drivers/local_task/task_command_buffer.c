@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "iree/base/api.h"
@@ -27,6 +28,23 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// A task recorded into a reusable command buffer.
+// Reusable command buffers keep their recorded task DAG as an immutable
+// template that is never executed directly; each issue instantiates a copy of
+// every recorded task and remaps the links between them.
+typedef struct iree_hal_task_recorded_task_t {
+  // Recorded task storage (the task header is always at offset 0).
+  iree_task_t* task;
+  // Total size of the storage at |task| including any trailing command data.
+  iree_host_size_t size;
+} iree_hal_task_recorded_task_t;
+
+// Linked list node used to accumulate recorded tasks during recording.
+typedef struct iree_hal_task_recorded_task_node_t {
+  struct iree_hal_task_recorded_task_node_t* next;
+  iree_hal_task_recorded_task_t value;
+} iree_hal_task_recorded_task_node_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -60,6 +78,13 @@ typedef struct iree_hal_task_command_buffer_t {
   // An empty list indicates that root_tasks are also the leaves.
   iree_task_list_t leaf_tasks;
 
+  // Template of all tasks recorded when the command buffer is reusable.
+  // Populated from |state.recorded_head| on end and sorted by task address so
+  // that pointers into the template can be remapped to their instances.
+  // Unused for one-shot command buffers which issue their tasks in-place.
+  iree_host_size_t recorded_task_count;
+  iree_hal_task_recorded_task_t* recorded_tasks;
+
   // TODO(benvanik): move this out of the struct and allocate from the arena -
   // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
@@ -94,6 +119,9 @@ typedef struct iree_hal_task_command_buffer_t {
     // Reset only with the command buffer and otherwise will maintain its values
     // during recording to allow for partial push_constants updates.
     uint32_t push_constants[IREE_HAL_LOCAL_MAX_PUSH_CONSTANT_COUNT];
+
+    // All tasks recorded so far in reverse recording order, if reusable.
+    iree_hal_task_recorded_task_node_t* recorded_head;
   } state;
 } iree_hal_task_command_buffer_t;
 
@@ -116,21 +144,15 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
+  // NOTE: command buffers without IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT are
+  // recorded as a template DAG that is instantiated into the submission arena
+  // each time it is issued. This allows the same command buffer to be enqueued
+  // multiple times, including with overlapping execution (`cmdbuf|cmdbuf`), at
+  // the cost of a copy of the tasks per issue instead of rebuilding them.
   if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
+    // NOTE: the device records indirect command buffers as deferred command
+    // buffers and replays them into task command buffers upon submission.
+    // TODO(#10144): natively support binding tables in the template DAG.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                             "indirect command buffers not yet implemented");
   }
@@ -149,6 +171,8 @@ iree_status_t iree_hal_task_command_buffer_create(
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->recorded_task_count = 0;
+    command_buffer->recorded_tasks = NULL;
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -202,6 +226,9 @@ static void* iree_hal_task_command_buffer_dyn_cast(
 static iree_status_t iree_hal_task_command_buffer_flush_tasks(
     iree_hal_task_command_buffer_t* command_buffer);
 
+static iree_status_t iree_hal_task_command_buffer_finalize_template(
+    iree_hal_task_command_buffer_t* command_buffer);
+
 static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
@@ -230,6 +257,12 @@ static iree_status_t iree_hal_task_command_buffer_end(
                         &command_buffer->root_tasks);
   }
 
+  // Flatten the recorded tasks of reusable command buffers into the template.
+  if (command_buffer->state.recorded_head) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_finalize_template(command_buffer));
+  }
+
   return iree_ok_status();
 }
 
@@ -282,6 +315,55 @@ static iree_status_t iree_hal_task_command_buffer_flush_tasks(
   return iree_ok_status();
 }
 
+// Records |task| of |task_size| bytes into the template of reusable command
+// buffers. One-shot command buffers issue their tasks in-place and skip this.
+static iree_status_t iree_hal_task_command_buffer_record_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t task_size) {
+  if (iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    return iree_ok_status();
+  }
+  iree_hal_task_recorded_task_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*node), (void**)&node));
+  node->value.task = task;
+  node->value.size = task_size;
+  node->next = command_buffer->state.recorded_head;
+  command_buffer->state.recorded_head = node;
+  ++command_buffer->recorded_task_count;
+  return iree_ok_status();
+}
+
+static int iree_hal_task_recorded_task_compare(const void* lhs,
+                                               const void* rhs) {
+  uintptr_t lhs_ptr =
+      (uintptr_t)((const iree_hal_task_recorded_task_t*)lhs)->task;
+  uintptr_t rhs_ptr =
+      (uintptr_t)((const iree_hal_task_recorded_task_t*)rhs)->task;
+  return lhs_ptr < rhs_ptr ? -1 : (lhs_ptr > rhs_ptr ? 1 : 0);
+}
+
+// Flattens the recorded task list into the sorted |recorded_tasks| template.
+static iree_status_t iree_hal_task_command_buffer_finalize_template(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  iree_host_size_t count = command_buffer->recorded_task_count;
+  iree_hal_task_recorded_task_t* recorded_tasks = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           count * sizeof(*recorded_tasks),
+                                           (void**)&recorded_tasks));
+  iree_hal_task_recorded_task_node_t* node =
+      command_buffer->state.recorded_head;
+  for (iree_host_size_t i = 0; i < count; ++i, node = node->next) {
+    recorded_tasks[count - i - 1] = node->value;
+  }
+  qsort(recorded_tasks, count, sizeof(*recorded_tasks),
+        iree_hal_task_recorded_task_compare);
+  command_buffer->recorded_tasks = recorded_tasks;
+  command_buffer->state.recorded_head = NULL;
+  return iree_ok_status();
+}
+
 // Emits a global barrier, splitting execution into all prior recorded tasks
 // and all subsequent recorded tasks. This is currently the critical piece that
 // limits our concurrency: changing to fine-grained barriers (via barrier
@@ -304,6 +386,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
                                            sizeof(*barrier), (void**)&barrier));
   iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_task(
+      command_buffer, &barrier->header, sizeof(*barrier)));
 
   // If there were previous tasks then join them to the barrier.
   for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
@@ -334,8 +418,12 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
 
 // Emits a the given execution |task| into the current open synchronization
 // scope (after state.open_barrier and before the next barrier).
+// |task_size| is the total size of the command storage containing |task|.
 static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t task_size) {
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_task(
+      command_buffer, task, task_size));
   if (command_buffer->state.open_barrier == NULL) {
     // If there is no open barrier then we are at the head and going right into
     // the task DAG.
@@ -352,6 +440,121 @@ static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Returns the instance of the template storage containing |ptr| or |ptr| if it
+// does not reference any recorded task (such as pointers to external state).
+static void* iree_hal_task_command_buffer_remap(
+    const iree_hal_task_command_buffer_t* command_buffer,
+    iree_task_t* const* instances, void* ptr) {
+  if (!ptr) return NULL;
+  const uintptr_t value = (uintptr_t)ptr;
+  iree_host_size_t lo = 0;
+  iree_host_size_t hi = command_buffer->recorded_task_count;
+  while (lo < hi) {
+    iree_host_size_t mid = lo + (hi - lo) / 2;
+    const iree_hal_task_recorded_task_t* recorded =
+        &command_buffer->recorded_tasks[mid];
+    const uintptr_t base = (uintptr_t)recorded->task;
+    if (value < base) {
+      hi = mid;
+    } else if (value >= base + recorded->size) {
+      lo = mid + 1;
+    } else {
+      return (uint8_t*)instances[mid] + (value - base);
+    }
+  }
+  return ptr;
+}
+
+// Instantiates the recorded template DAG of a reusable command buffer by
+// copying all tasks into |arena| and remapping the links between them. The
+// template itself is never executed so the recorded dependency counts and
+// dispatch state are all in their initial ready-to-issue values.
+// |out_root_tasks| and |out_leaf_tasks| receive the instanced task lists.
+static iree_status_t iree_hal_task_command_buffer_instantiate(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_arena_allocator_t* arena, iree_task_list_t* out_root_tasks,
+    iree_task_list_t* out_leaf_tasks) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_host_size_t count = command_buffer->recorded_task_count;
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)count);
+
+  // Copy all tasks verbatim first so that all instances exist for remapping.
+  iree_task_t** instances = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(arena, count * sizeof(*instances),
+                              (void**)&instances));
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    const iree_hal_task_recorded_task_t* recorded =
+        &command_buffer->recorded_tasks[i];
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(arena, recorded->size, (void**)&instances[i]));
+    memcpy(instances[i], recorded->task, recorded->size);
+  }
+
+  // Remap all pointers that reference other recorded tasks. Commands use
+  // themselves as their closure user_context and barriers reference an arena
+  // allocated list of dependent tasks that must be cloned as well.
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_task_t* task = instances[i];
+    task->next_task = NULL;
+    task->completion_task = (iree_task_t*)iree_hal_task_command_buffer_remap(
+        command_buffer, instances, task->completion_task);
+    switch (task->type) {
+      case IREE_TASK_TYPE_CALL: {
+        iree_task_call_t* call_task = (iree_task_call_t*)task;
+        call_task->closure.user_context = iree_hal_task_command_buffer_remap(
+            command_buffer, instances, call_task->closure.user_context);
+        break;
+      }
+      case IREE_TASK_TYPE_DISPATCH: {
+        iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+        dispatch_task->closure.user_context =
+            iree_hal_task_command_buffer_remap(
+                command_buffer, instances, dispatch_task->closure.user_context);
+        break;
+      }
+      case IREE_TASK_TYPE_BARRIER: {
+        iree_task_barrier_t* barrier_task = (iree_task_barrier_t*)task;
+        if (barrier_task->dependent_task_count == 0) break;
+        iree_task_t** dependent_tasks = NULL;
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_arena_allocate(arena,
+                                    barrier_task->dependent_task_count *
+                                        sizeof(*dependent_tasks),
+                                    (void**)&dependent_tasks));
+        for (iree_host_size_t j = 0; j < barrier_task->dependent_task_count;
+             ++j) {
+          dependent_tasks[j] = (iree_task_t*)iree_hal_task_command_buffer_remap(
+              command_buffer, instances, barrier_task->dependent_tasks[j]);
+        }
+        barrier_task->dependent_tasks = dependent_tasks;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // Rebuild the root and leaf lists from the instances.
+  iree_task_list_initialize(out_root_tasks);
+  for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
+       task = task->next_task) {
+    iree_task_list_push_back(out_root_tasks,
+                             (iree_task_t*)iree_hal_task_command_buffer_remap(
+                                 command_buffer, instances, task));
+  }
+  iree_task_list_initialize(out_leaf_tasks);
+  for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
+       task = task->next_task) {
+    iree_task_list_push_back(out_leaf_tasks,
+                             (iree_task_t*)iree_hal_task_command_buffer_remap(
+                                 command_buffer, instances, task));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -367,29 +570,41 @@ iree_status_t iree_hal_task_command_buffer_issue(
     return iree_ok_status();
   }
 
-  bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
+  // One-shot command buffers hand their recorded tasks directly to the
+  // submission while reusable ones issue a fresh instance of their template.
+  iree_task_list_t* root_tasks = &command_buffer->root_tasks;
+  iree_task_list_t* leaf_tasks = &command_buffer->leaf_tasks;
+  iree_task_list_t instance_root_tasks;
+  iree_task_list_t instance_leaf_tasks;
+  if (command_buffer->recorded_tasks) {
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_instantiate(
+        command_buffer, arena, &instance_root_tasks, &instance_leaf_tasks));
+    root_tasks = &instance_root_tasks;
+    leaf_tasks = &instance_leaf_tasks;
+  }
+
+  bool has_leaf_tasks = !iree_task_list_is_empty(leaf_tasks);
   if (has_leaf_tasks) {
     // Chain the retire task onto the leaf tasks as their completion indicates
     // that all commands have completed.
-    for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
+    for (iree_task_t* task = leaf_tasks->head; task != NULL;
          task = task->next_task) {
       iree_task_set_completion_task(task, retire_task);
     }
   } else {
     // If we have no leaf tasks it means that this is a single layer DAG and
     // after the root tasks complete the entire command buffer has completed.
-    for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
+    for (iree_task_t* task = root_tasks->head; task != NULL;
          task = task->next_task) {
       iree_task_set_completion_task(task, retire_task);
     }
   }
 
   // Enqueue all root tasks that are ready to run immediately.
-  // After this all of the command buffer tasks are owned by the submission and
-  // we need to ensure the command buffer doesn't try to discard them.
-  iree_task_submission_enqueue_list(pending_submission,
-                                    &command_buffer->root_tasks);
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
+  // After this all of the issued tasks are owned by the submission and we need
+  // to ensure the command buffer doesn't try to discard them.
+  iree_task_submission_enqueue_list(pending_submission, root_tasks);
+  iree_task_list_initialize(leaf_tasks);
 
   return iree_ok_status();
 }
@@ -560,8 +775,8 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, sizeof(*cmd));
 }
 
 //===----------------------------------------------------------------------===//
@@ -616,8 +831,8 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, total_cmd_size);
 }
 
 //===----------------------------------------------------------------------===//
@@ -700,8 +915,8 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   cmd->target_offset = target_offset;
   cmd->length = length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, sizeof(*cmd));
 }
 
 //===----------------------------------------------------------------------===//
@@ -778,6 +993,10 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
                             "set %u out of bounds", set);
   }
 
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_strided(
+      command_buffer->resource_set, binding_count, &bindings[0].buffer,
+      sizeof(bindings[0])));
+
   iree_host_size_t binding_base =
       set * IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT;
   for (iree_host_size_t i = 0; i < binding_count; ++i) {
@@ -788,10 +1007,6 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
     }
     iree_host_size_t binding_ordinal = binding_base + bindings[i].binding;
 
-    // TODO(benvanik): batch insert by getting the resources in their own list.
-    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-        command_buffer->resource_set, 1, &bindings[i].buffer));
-
     // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
     iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     if (bindings[i].buffer) {
@@ -894,8 +1109,10 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  // Executables prepared lazily are loaded on their first dispatch.
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -938,6 +1155,13 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       iree_task_make_dispatch_closure(iree_hal_cmd_dispatch_tile, (void*)cmd),
       workgroup_size, workgroup_count, &cmd->task);
 
+  // Share tile cost tracking across all dispatches of the same entry point so
+  // the task system can size tile reservations based on prior executions.
+  if (local_executable->dispatch_tile_costs) {
+    cmd->task.tile_cost_ns =
+        &local_executable->dispatch_tile_costs[entry_point];
+  }
+
   // Tell the task system how much workgroup local memory is required for the
   // dispatch; each invocation of the entry point will have at least as much
   // scratch memory available during execution.
@@ -981,8 +1205,8 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   }
 
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, total_cmd_size);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
@@ -17,10 +17,14 @@
 #include "iree/hal/drivers/local_task/task_event.h"
 #include "iree/hal/drivers/local_task/task_queue.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
+#include "iree/hal/drivers/local_task/task_transient_pool.h"
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/local_dispatch_profiler.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/task/tuning.h"
 
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
@@ -39,6 +43,12 @@ typedef struct iree_hal_task_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Pool used for queue-ordered transient allocations; NULL if disabled.
+  iree_hal_task_transient_pool_t* transient_pool;
+
+  // Dispatch profiler active between profiling_begin and profiling_end, if any.
+  iree_hal_local_dispatch_profiler_t* profiler;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -54,6 +64,15 @@ static iree_hal_task_device_t* iree_hal_task_device_cast(
 void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
+  out_params->arena_block_flags = IREE_ARENA_BLOCK_POOL_FLAG_NONE;
+  out_params->arena_block_preallocation_count = 0;
+  out_params->high_priority_queues = 0;
+  out_params->low_priority_queues = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_params->queue_weights);
+       ++i) {
+    out_params->queue_weights[i] = IREE_TASK_SCOPE_DEFAULT_WEIGHT;
+  }
+  out_params->transient_block_size = 16 * 1024 * 1024;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -66,6 +85,16 @@ static iree_status_t iree_hal_task_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "must have at least one queue");
   }
+  const iree_host_size_t max_priority_queue_count =
+      sizeof(iree_hal_queue_affinity_t) * 8;
+  if ((params->high_priority_queues || params->low_priority_queues) &&
+      queue_count > max_priority_queue_count) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "queue priorities can only be assigned to devices with at most %" PRIhsz
+        " queues (have %" PRIhsz ")",
+        max_priority_queue_count, queue_count);
+  }
   return iree_ok_status();
 }
 
@@ -111,10 +140,12 @@ iree_status_t iree_hal_task_device_create(
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
 
-    iree_arena_block_pool_initialize(4096, host_allocator,
-                                     &device->small_block_pool);
-    iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
-                                     &device->large_block_pool);
+    iree_arena_block_pool_initialize_with_flags(
+        4096, params->arena_block_flags, host_allocator,
+        &device->small_block_pool);
+    iree_arena_block_pool_initialize_with_flags(
+        params->arena_block_size, params->arena_block_flags, host_allocator,
+        &device->large_block_pool);
 
     device->loader_count = loader_count;
     device->loaders =
@@ -131,9 +162,35 @@ iree_status_t iree_hal_task_device_create(
       iree_hal_task_queue_initialize(device->identifier, queue_executors[i],
                                      &device->small_block_pool,
                                      &device->queues[i]);
+      const iree_hal_queue_affinity_t queue_bit = 1ull << (i % 64);
+      if (params->high_priority_queues & queue_bit) {
+        iree_task_scope_set_priority(&device->queues[i].scope,
+                                     IREE_TASK_PRIORITY_HIGH);
+      } else if (params->low_priority_queues & queue_bit) {
+        iree_task_scope_set_priority(&device->queues[i].scope,
+                                     IREE_TASK_PRIORITY_LOW);
+      }
+      iree_task_scope_set_weight(
+          &device->queues[i].scope,
+          params->queue_weights[i % IREE_ARRAYSIZE(params->queue_weights)]);
     }
   }
 
+  // Allocate (and possibly fault in) the blocks used by the first submissions.
+  if (iree_status_is_ok(status)) {
+    status = iree_arena_block_pool_preallocate(
+        &device->small_block_pool, params->arena_block_preallocation_count);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_arena_block_pool_preallocate(
+        &device->large_block_pool, params->arena_block_preallocation_count);
+  }
+
+  if (iree_status_is_ok(status) && params->transient_block_size > 0) {
+    status = iree_hal_task_transient_pool_create(
+        params->transient_block_size, host_allocator, &device->transient_pool);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -151,9 +208,11 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
+  iree_status_ignore(iree_hal_local_dispatch_profiler_end(device->profiler));
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
+  iree_hal_task_transient_pool_release(device->transient_pool);
   iree_hal_allocator_release(device->device_allocator);
   iree_arena_block_pool_deinitialize(&device->large_block_pool);
   iree_arena_block_pool_deinitialize(&device->small_block_pool);
@@ -197,6 +256,9 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
     iree_hal_task_queue_trim(&device->queues[i]);
   }
   IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
+  if (device->transient_pool) {
+    iree_hal_task_transient_pool_trim(device->transient_pool);
+  }
 
   iree_arena_block_pool_trim(&device->small_block_pool);
   iree_arena_block_pool_trim(&device->large_block_pool);
@@ -204,6 +266,73 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   return iree_ok_status();
 }
 
+// Looks up a single |counter| value from |statistics|.
+static bool iree_hal_task_device_lookup_worker_statistic(
+    const iree_task_worker_statistics_t* statistics, iree_string_view_t counter,
+    int64_t* out_value) {
+  if (iree_string_view_equal(counter, IREE_SV("tasks_executed"))) {
+    *out_value = (int64_t)statistics->tasks_executed;
+  } else if (iree_string_view_equal(counter, IREE_SV("tiles_executed"))) {
+    *out_value = (int64_t)statistics->tiles_executed;
+  } else if (iree_string_view_equal(counter, IREE_SV("steals_succeeded"))) {
+    *out_value = (int64_t)statistics->steals_succeeded;
+  } else if (iree_string_view_equal(counter, IREE_SV("steals_failed"))) {
+    *out_value = (int64_t)statistics->steals_failed;
+  } else if (iree_string_view_equal(counter, IREE_SV("wakeups"))) {
+    *out_value = (int64_t)statistics->wakeups;
+  } else if (iree_string_view_equal(counter, IREE_SV("idle_time_ns"))) {
+    *out_value = statistics->idle_time_ns;
+  } else if (iree_string_view_equal(counter, IREE_SV("busy_time_ns"))) {
+    *out_value = statistics->busy_time_ns;
+  } else if (iree_string_view_equal(counter, IREE_SV("local_memory_size"))) {
+    *out_value = (int64_t)statistics->local_memory_size;
+  } else if (iree_string_view_equal(counter, IREE_SV("local_memory_grows"))) {
+    *out_value = (int64_t)statistics->local_memory_grows;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Queries a task executor statistic by |key|:
+//   `worker_count`: total number of workers.
+//   `poller_waits`: total number of system waits made by the poller.
+//   `<counter>`: a counter (such as `tasks_executed`) summed over all workers.
+//   `worker.<N>.<counter>`: a counter from worker N.
+static bool iree_hal_task_device_lookup_executor_statistic(
+    iree_task_executor_t* executor, iree_string_view_t key,
+    int64_t* out_value) {
+  iree_task_executor_statistics_t statistics;
+  if (iree_string_view_consume_prefix(&key, IREE_SV("worker."))) {
+    iree_string_view_t index_str = iree_string_view_empty();
+    iree_string_view_t counter = iree_string_view_empty();
+    uint32_t worker_index = 0;
+    if (iree_string_view_split(key, '.', &index_str, &counter) == -1 ||
+        !iree_string_view_atoi_uint32(index_str, &worker_index) ||
+        worker_index >= iree_task_executor_worker_count(executor)) {
+      return false;
+    }
+    // NOTE: we only need a single worker but the query API fills a prefix.
+    iree_task_worker_statistics_t
+        worker_statistics[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+    if (worker_index >= IREE_ARRAYSIZE(worker_statistics)) return false;
+    iree_task_executor_query_statistics(executor, worker_index + 1,
+                                        worker_statistics, &statistics);
+    return iree_hal_task_device_lookup_worker_statistic(
+        &worker_statistics[worker_index], counter, out_value);
+  }
+  iree_task_executor_query_statistics(executor, 0, NULL, &statistics);
+  if (iree_string_view_equal(key, IREE_SV("worker_count"))) {
+    *out_value = (int64_t)statistics.worker_count;
+    return true;
+  } else if (iree_string_view_equal(key, IREE_SV("poller_waits"))) {
+    *out_value = (int64_t)statistics.poller_waits;
+    return true;
+  }
+  return iree_hal_task_device_lookup_worker_statistic(&statistics.total, key,
+                                                      out_value);
+}
+
 static iree_status_t iree_hal_task_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
@@ -232,6 +361,29 @@ static iree_status_t iree_hal_task_device_query_i64(
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.cpu"))) {
     return iree_cpu_lookup_data_by_key(key, out_value);
+  } else if (iree_string_view_equal(category, IREE_SV("task.statistics"))) {
+    // NOTE: like hal.dispatch we only report the queue 0 executor.
+    if (iree_hal_task_device_lookup_executor_statistic(
+            device->queues[0].executor, key, out_value)) {
+      return iree_ok_status();
+    }
+  } else if (iree_string_view_equal(category, IREE_SV("task.transient"))) {
+    iree_hal_suballocator_statistics_t statistics;
+    memset(&statistics, 0, sizeof(statistics));
+    if (device->transient_pool) {
+      iree_hal_task_transient_pool_query_statistics(device->transient_pool,
+                                                   &statistics);
+    }
+    if (iree_string_view_equal(key, IREE_SV("reserved_size"))) {
+      *out_value = (int64_t)statistics.reserved_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("allocated_size"))) {
+      *out_value = (int64_t)statistics.allocated_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("peak_allocated_size"))) {
+      *out_value = (int64_t)statistics.peak_allocated_size;
+      return iree_ok_status();
+    }
   }
 
   return iree_make_status(
@@ -267,6 +419,13 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (binding_capacity > 0) {
+    // Indirect command buffers are recorded in memory and replayed into task
+    // command buffers with their bindings resolved upon submission.
+    return iree_hal_deferred_command_buffer_create(
+        base_device, mode, command_categories, binding_capacity,
+        &device->large_block_pool, device->host_allocator, out_command_buffer);
+  }
   iree_host_size_t queue_index = iree_hal_task_device_select_queue(
       device, command_categories, queue_affinity);
   return iree_hal_task_command_buffer_create(
@@ -292,6 +451,71 @@ static iree_status_t iree_hal_task_device_create_event(
                                     out_event);
 }
 
+typedef struct iree_hal_task_device_parallel_for_t {
+  iree_hal_local_parallel_for_fn_t fn;
+  void* user_data;
+} iree_hal_task_device_parallel_for_t;
+
+static iree_status_t iree_hal_task_device_parallel_for_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_task_device_parallel_for_t* parallel_for =
+      (const iree_hal_task_device_parallel_for_t*)user_context;
+  return parallel_for->fn(parallel_for->user_data,
+                          tile_context->workgroup_xyz[0]);
+}
+
+// Fans out |count| calls to |fn| across the workers of the executor in |self|
+// as a single dispatch and blocks the caller until all have completed.
+// Must not be called from a worker of the executor.
+static iree_status_t iree_hal_task_device_parallel_for(
+    void* self, iree_host_size_t count, iree_hal_local_parallel_for_fn_t fn,
+    void* user_data) {
+  iree_task_executor_t* executor = (iree_task_executor_t*)self;
+  if (IREE_UNLIKELY(count > UINT32_MAX)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parallel for count %zu exceeds the maximum "
+                            "dispatch workgroup count",
+                            count);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)count);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("executable_cache"),
+                             &scope);
+
+  iree_hal_task_device_parallel_for_t parallel_for = {fn, user_data};
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)count, 1, 1};
+  iree_task_dispatch_t dispatch_task;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(iree_hal_task_device_parallel_for_tile,
+                                      &parallel_for),
+      workgroup_size, workgroup_count, &dispatch_task);
+
+  iree_task_fence_t* fence = NULL;
+  iree_status_t status =
+      iree_task_executor_acquire_fence(executor, &scope, &fence);
+  if (iree_status_is_ok(status)) {
+    iree_task_set_completion_task(&dispatch_task.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch_task.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    status = iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_task_scope_consume_status(&scope);
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
@@ -305,9 +529,16 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
         iree_task_executor_worker_count(device->queues[i].executor);
   }
 
-  return iree_hal_local_executable_cache_create(
+  // Batched preparation fans out across the workers of the first queue. The
+  // executable cache does not outlive the device and its executors.
+  iree_hal_local_executable_cache_scheduler_t scheduler = {
+      .self = device->queues[0].executor,
+      .parallel_for = iree_hal_task_device_parallel_for,
+  };
+  return iree_hal_local_executable_cache_create_with_scheduler(
       identifier, total_worker_count, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+      scheduler, iree_hal_device_host_allocator(base_device),
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_task_device_create_pipeline_layout(
@@ -351,14 +582,70 @@ static iree_status_t iree_hal_task_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  // Storage is reserved immediately and never requires a host wait: pooled
+  // storage is only reused once the queue deallocation that released it has
+  // retired and any new users must wait on the signal semaphores.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_ok_status();
+  if (device->transient_pool) {
+    iree_hal_buffer_params_t compat_params;
+    iree_device_size_t compat_allocation_size = 0;
+    if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                               device->device_allocator, params,
+                               allocation_size, &compat_params,
+                               &compat_allocation_size),
+                           IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "allocator cannot allocate a buffer with the given parameters");
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_task_transient_pool_allocate_buffer(
+          device->transient_pool, device->device_allocator, &compat_params,
+          compat_allocation_size, &buffer);
+    }
+  } else {
+    status = iree_hal_allocator_allocate_buffer(
+        device->device_allocator, params, allocation_size,
+        iree_const_byte_span_empty(), &buffer);
+  }
+
+  // Order the signal after the waits so that the allocation behaves as if it
+  // were committed on the queue.
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+        device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+    status = iree_hal_task_queue_submit_barrier(
+        &device->queues[queue_index], wait_semaphore_list,
+        signal_semaphore_list,
+        (iree_hal_task_queue_retire_callback_t){NULL, NULL});
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Reclaims the storage of a transient buffer once its queue deallocation has
+// retired. |user_data| is the retained iree_hal_buffer_t.
+static void iree_hal_task_device_dealloca_retire(
+    void* user_data, iree_status_code_t status_code) {
+  iree_hal_buffer_t* buffer = (iree_hal_buffer_t*)user_data;
+  // On failure prior work may still be using the storage so we only release
+  // our reference and let the storage be reclaimed when the buffer dies.
+  if (status_code == IREE_STATUS_OK) {
+    iree_hal_task_transient_buffer_reclaim(buffer);
+  }
+  iree_hal_buffer_release(buffer);
 }
 
 static iree_status_t iree_hal_task_device_queue_dealloca(
@@ -366,10 +653,32 @@ static iree_status_t iree_hal_task_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+
+  // Buffers not allocated from a transient pool are released normally when
+  // their last reference is dropped.
+  if (!iree_hal_task_transient_buffer_isa(buffer)) {
+    return iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                         wait_semaphore_list,
+                                         signal_semaphore_list);
+  }
+
+  // Return the storage to the pool when the waits are satisfied (all prior
+  // users have completed) and before the signals so that work waiting on the
+  // deallocation can immediately reuse it.
+  iree_hal_buffer_retain(buffer);
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  iree_status_t status = iree_hal_task_queue_submit_barrier(
+      &device->queues[queue_index], wait_semaphore_list, signal_semaphore_list,
+      (iree_hal_task_queue_retire_callback_t){
+          .fn = iree_hal_task_device_dealloca_retire,
+          .user_data = buffer,
+      });
+  if (!iree_status_is_ok(status)) {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_task_device_queue_execute(
@@ -377,18 +686,66 @@ static iree_status_t iree_hal_task_device_queue_execute(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   // NOTE: today we are not discriminating queues based on command type.
   iree_host_size_t queue_index = iree_hal_task_device_select_queue(
       device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
-  iree_hal_submission_batch_t batch = {
-      .wait_semaphores = wait_semaphore_list,
-      .signal_semaphores = signal_semaphore_list,
-      .command_buffer_count = command_buffer_count,
-      .command_buffers = command_buffers,
-  };
-  return iree_hal_task_queue_submit(&device->queues[queue_index], 1, &batch);
+  iree_hal_task_queue_t* queue = &device->queues[queue_index];
+
+  // Replay any indirect command buffers into one-shot task command buffers
+  // with their bindings resolved. The submission retains the replayed command
+  // buffers until they have been issued.
+  iree_hal_command_buffer_t** resolved_command_buffers = NULL;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    if (!iree_hal_deferred_command_buffer_isa(command_buffers[i])) continue;
+    if (!resolved_command_buffers) {
+      resolved_command_buffers = (iree_hal_command_buffer_t**)iree_alloca(
+          command_buffer_count * sizeof(resolved_command_buffers[0]));
+      memcpy(resolved_command_buffers, command_buffers,
+             command_buffer_count * sizeof(resolved_command_buffers[0]));
+    }
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    status = iree_hal_task_command_buffer_create(
+        base_device, &queue->scope, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        command_buffers[i]->allowed_categories, queue_affinity,
+        /*binding_capacity=*/0, &device->large_block_pool,
+        device->host_allocator, &command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_deferred_command_buffer_apply(
+          command_buffers[i], command_buffer,
+          binding_tables ? binding_tables[i]
+                         : iree_hal_buffer_binding_table_empty());
+      resolved_command_buffers[i] = command_buffer;
+    }
+    if (!iree_status_is_ok(status)) {
+      iree_hal_command_buffer_release(command_buffer);
+      resolved_command_buffers[i] = NULL;
+      break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_submission_batch_t batch = {
+        .wait_semaphores = wait_semaphore_list,
+        .signal_semaphores = signal_semaphore_list,
+        .command_buffer_count = command_buffer_count,
+        .command_buffers = resolved_command_buffers ? resolved_command_buffers
+                                                    : command_buffers,
+    };
+    status = iree_hal_task_queue_submit(queue, 1, &batch);
+  }
+
+  if (resolved_command_buffers) {
+    for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+      if (resolved_command_buffers[i] != command_buffers[i]) {
+        iree_hal_command_buffer_release(resolved_command_buffers[i]);
+      }
+    }
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_task_device_queue_flush(
@@ -402,29 +759,44 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_multi_wait(
-      wait_mode, semaphore_list, timeout,
-      iree_hal_task_device_shared_event_pool(device),
-      &device->large_block_pool);
+      wait_mode, semaphore_list, timeout, &device->large_block_pool);
 }
 
 static iree_status_t iree_hal_task_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already active on the device");
+  }
+  // Only dispatch/executable counter modes are implemented using
+  // local_dispatch_profiler; other modes are ignored (and that's ok).
   // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
   // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
   // Capturing things like:
   //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
   //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
   //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  return iree_hal_local_dispatch_profiler_begin(options, device->host_allocator,
+                                                &device->profiler);
 }
 
 static iree_status_t iree_hal_task_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (!device->profiler) return iree_ok_status();
+  // Drain the queues so that in-flight dispatches are included in the report.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    status = iree_status_join(
+        status, iree_hal_task_queue_wait_idle(&device->queues[i],
+                                              iree_infinite_timeout()));
+  }
+  status = iree_status_join(
+      status, iree_hal_local_dispatch_profiler_end(device->profiler));
+  device->profiler = NULL;
+  return status;
 }
 
 static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
@@ -8,6 +8,7 @@
 #define IREE_HAL_DRIVERS_LOCAL_TASK_TASK_DEVICE_H_
 
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_loader.h"
 #include "iree/task/executor.h"
@@ -16,6 +17,10 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Maximum number of queues that may have fair share weights specified in
+// iree_hal_task_device_params_t.
+#define IREE_HAL_TASK_DEVICE_MAX_QUEUE_WEIGHTS 64
+
 // Parameters configuring an iree_hal_task_device_t.
 // Must be initialized with iree_hal_task_device_params_initialize prior to use.
 typedef struct iree_hal_task_device_params_t {
@@ -23,6 +28,52 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Flags controlling how blocks in the device block pools are allocated.
+  // Use IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES with an |arena_block_size| that
+  // is a multiple of IREE_ARENA_LARGE_PAGE_SIZE to back command buffers with
+  // large pages and IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT to avoid page faults on
+  // first use.
+  iree_arena_block_pool_flags_t arena_block_flags;
+
+  // Number of blocks allocated in each device block pool when the device is
+  // created. Combined with IREE_ARENA_BLOCK_POOL_FLAG_PREFAULT this moves the
+  // cost of allocating and faulting in the blocks used by the first
+  // submissions to device creation.
+  iree_host_size_t arena_block_preallocation_count;
+
+  // Bitmask of queue ordinals (bit N = queue N) whose work is scheduled with
+  // IREE_TASK_PRIORITY_HIGH. Ready tasks from these queues are issued ahead of
+  // normal priority work when executors are shared across queues. Only the
+  // first 64 queues can be addressed and device creation fails if this or
+  // |low_priority_queues| is set on a device with more queues.
+  //
+  // Priorities are fixed per queue when the device is created. They are not
+  // carried by individual iree_hal_device_queue_execute submissions: route
+  // latency-critical work to a high priority queue instead. Priority only
+  // orders tasks that become ready in the same executor coordination pass.
+  // Tasks already posted to a worker run in arrival order and are not
+  // preempted by higher priority work arriving later.
+  iree_hal_queue_affinity_t high_priority_queues;
+
+  // Bitmask of queue ordinals whose work is scheduled with
+  // IREE_TASK_PRIORITY_LOW (background/batch work). Ignored for any queue also
+  // present in |high_priority_queues|.
+  iree_hal_queue_affinity_t low_priority_queues;
+
+  // Fair share weight of each queue ordinal (entry N = queue N) relative to
+  // other queues of the same priority submitting to the same executor,
+  // including queues of other devices sharing the executor. Ready tasks are
+  // interleaved across queues in proportion to their weights so that a single
+  // busy queue cannot starve the others. Defaults to
+  // IREE_TASK_SCOPE_DEFAULT_WEIGHT and a weight of 0 is treated as 1.
+  uint32_t queue_weights[IREE_HAL_TASK_DEVICE_MAX_QUEUE_WEIGHTS];
+
+  // Size of each host block that queue-ordered (iree_hal_device_queue_alloca)
+  // buffers are suballocated from. Storage released by queue deallocations is
+  // reused as soon as the deallocation retires. 0 disables pooling and
+  // allocates each transient buffer from the device allocator.
+  iree_device_size_t transient_block_size;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
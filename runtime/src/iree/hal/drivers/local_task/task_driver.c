@@ -151,8 +151,29 @@ static iree_status_t iree_hal_task_driver_create_device_by_id(
     iree_host_size_t param_count, const iree_string_pair_t* params,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_task_driver_t* driver = iree_hal_task_driver_cast(base_driver);
+
+  // Devices created from the same driver share its executors; a
+  // `queue_weight=N` parameter sets the fair share of all queues of the device
+  // relative to the queues of other devices.
+  iree_hal_task_device_params_t device_params = driver->default_params;
+  for (iree_host_size_t i = 0; i < param_count; ++i) {
+    if (!iree_string_view_equal(params[i].key, IREE_SV("queue_weight"))) {
+      continue;
+    }
+    uint32_t queue_weight = 0;
+    if (!iree_string_view_atoi_uint32(params[i].value, &queue_weight)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid queue_weight '%.*s'",
+                              (int)params[i].value.size, params[i].value.data);
+    }
+    for (iree_host_size_t j = 0;
+         j < IREE_ARRAYSIZE(device_params.queue_weights); ++j) {
+      device_params.queue_weights[j] = queue_weight;
+    }
+  }
+
   return iree_hal_task_device_create(
-      driver->identifier, &driver->default_params, driver->queue_count,
+      driver->identifier, &device_params, driver->queue_count,
       driver->queue_executors, driver->loader_count, driver->loaders,
       driver->device_allocator, host_allocator, out_device);
 }
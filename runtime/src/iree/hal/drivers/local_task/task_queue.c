@@ -284,6 +284,9 @@ typedef struct iree_hal_task_queue_retire_cmd_t {
   // A list of semaphores to signal upon retiring.
   iree_hal_semaphore_list_t signal_semaphores;
 
+  // Optional callback issued before signaling; cleared once issued.
+  iree_hal_task_queue_retire_callback_t retire_callback;
+
   // Command buffers retained until all have retired.
   // We could release them earlier but that would require tracking individual
   // command buffer task completion.
@@ -308,6 +311,13 @@ static iree_status_t iree_hal_task_queue_retire_cmd(
     cmd->command_buffers[i] = NULL;
   }
 
+  // Notify the submitter before signaling so that anything it releases is
+  // available to work waiting on the semaphores.
+  if (cmd->retire_callback.fn) {
+    cmd->retire_callback.fn(cmd->retire_callback.user_data, IREE_STATUS_OK);
+    cmd->retire_callback.fn = NULL;
+  }
+
   // Signal all semaphores to their new values.
   // Note that if any signal fails then the whole command will fail and all
   // semaphores will be signaled to the failure state.
@@ -339,6 +349,12 @@ static void iree_hal_task_queue_retire_cmd_cleanup(
     cmd->command_buffers[i] = NULL;
   }
 
+  // Notify the submitter if the retire command never ran.
+  if (cmd->retire_callback.fn) {
+    cmd->retire_callback.fn(cmd->retire_callback.user_data, status_code);
+    cmd->retire_callback.fn = NULL;
+  }
+
   // If the command failed then fail all semaphores to ensure future
   // submissions fail as well (including those on other queues).
   if (IREE_UNLIKELY(status_code != IREE_STATUS_OK)) {
@@ -364,6 +380,7 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
     iree_task_scope_t* scope, iree_host_size_t command_buffer_count,
     iree_hal_command_buffer_t* const* command_buffers,
     const iree_hal_semaphore_list_t* signal_semaphores,
+    iree_hal_task_queue_retire_callback_t retire_callback,
     iree_arena_block_pool_t* block_pool,
     iree_hal_task_queue_retire_cmd_t** out_cmd) {
   // Make an arena we'll use for allocating the command itself.
@@ -395,6 +412,8 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
     // Transfer ownership of the arena to command.
     memcpy(&cmd->arena, &arena, sizeof(cmd->arena));
 
+    cmd->retire_callback = retire_callback;
+
     // Retain command buffers.
     cmd->command_buffer_count = command_buffer_count;
     for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
@@ -452,14 +471,16 @@ void iree_hal_task_queue_trim(iree_hal_task_queue_t* queue) {
 }
 
 static iree_status_t iree_hal_task_queue_submit_batch(
-    iree_hal_task_queue_t* queue, const iree_hal_submission_batch_t* batch) {
+    iree_hal_task_queue_t* queue, const iree_hal_submission_batch_t* batch,
+    iree_hal_task_queue_retire_callback_t retire_callback) {
   // Task to retire the submission and free the transient memory allocated for
   // it (including the command itself). We allocate this first so it can get an
   // arena which we will use to allocate all other commands.
   iree_hal_task_queue_retire_cmd_t* retire_cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_queue_retire_cmd_allocate(
       &queue->scope, batch->command_buffer_count, batch->command_buffers,
-      &batch->signal_semaphores, queue->block_pool, &retire_cmd));
+      &batch->signal_semaphores, retire_callback, queue->block_pool,
+      &retire_cmd));
 
   // NOTE: if we fail from here on we must drop the retire_cmd arena.
   iree_status_t status = iree_ok_status();
@@ -525,7 +546,8 @@ static iree_status_t iree_hal_task_queue_submit_batches(
   // build the whole DAG prior to submitting.
   for (iree_host_size_t i = 0; i < batch_count; ++i) {
     const iree_hal_submission_batch_t* batch = &batches[i];
-    IREE_RETURN_IF_ERROR(iree_hal_task_queue_submit_batch(queue, batch));
+    IREE_RETURN_IF_ERROR(iree_hal_task_queue_submit_batch(
+        queue, batch, (iree_hal_task_queue_retire_callback_t){NULL, NULL}));
   }
   return iree_ok_status();
 }
@@ -545,6 +567,29 @@ iree_status_t iree_hal_task_queue_submit(
   return status;
 }
 
+iree_status_t iree_hal_task_queue_submit_barrier(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphores,
+    const iree_hal_semaphore_list_t signal_semaphores,
+    iree_hal_task_queue_retire_callback_t retire_callback) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_hal_submission_batch_t batch = {
+      .wait_semaphores = wait_semaphores,
+      .signal_semaphores = signal_semaphores,
+      .command_buffer_count = 0,
+      .command_buffers = NULL,
+  };
+  iree_status_t status =
+      iree_hal_task_queue_submit_batch(queue, &batch, retire_callback);
+  if (iree_status_is_ok(status)) {
+    iree_task_executor_flush(queue->executor);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -52,6 +52,25 @@ iree_status_t iree_hal_task_queue_submit(
     iree_hal_task_queue_t* queue, iree_host_size_t batch_count,
     const iree_hal_submission_batch_t* batches);
 
+// Callback issued when a queue submission retires.
+typedef struct iree_hal_task_queue_retire_callback_t {
+  // Called after all work in the submission has completed and before any
+  // semaphores are signaled. |status_code| is IREE_STATUS_OK unless the
+  // submission failed.
+  void(IREE_API_PTR* fn)(void* user_data, iree_status_code_t status_code);
+  void* user_data;
+} iree_hal_task_queue_retire_callback_t;
+
+// Submits a barrier that waits on |wait_semaphores|, issues |retire_callback|,
+// and then signals |signal_semaphores|. The callback is issued exactly once
+// (with a failure status code if the waits fail) if this returns OK and never
+// if this returns an error.
+iree_status_t iree_hal_task_queue_submit_barrier(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphores,
+    const iree_hal_semaphore_list_t signal_semaphores,
+    iree_hal_task_queue_retire_callback_t retire_callback);
+
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout);
 
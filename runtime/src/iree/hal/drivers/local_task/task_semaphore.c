@@ -328,7 +328,7 @@ static iree_status_t iree_hal_task_semaphore_wait(
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool) {
+    iree_arena_block_pool_t* block_pool) {
   if (semaphore_list.count == 0) {
     return iree_ok_status();
   } else if (semaphore_list.count == 1) {
@@ -339,66 +339,15 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
-
-  // Avoid heap allocations by using the device block pool for the wait set.
+  // All task semaphores notify their timepoints when signaled so we can wait
+  // on a single notification shared across all of them instead of acquiring a
+  // system wait handle per semaphore. Avoid heap allocations by using the
+  // device block pool for any timepoint storage required.
   iree_arena_allocator_t arena;
   iree_arena_initialize(block_pool, &arena);
-  iree_wait_set_t* wait_set = NULL;
-  iree_status_t status = iree_wait_set_allocate(
-      semaphore_list.count, iree_arena_allocator(&arena), &wait_set);
-
-  // Acquire a wait handle for each semaphore timepoint we are to wait on.
-  // TODO(benvanik): flip this API around so we can batch request events from
-  // the event pool. We should be acquiring all required time points in one
-  // call.
-  iree_host_size_t timepoint_count = 0;
-  iree_hal_task_timepoint_t* timepoints = NULL;
-  iree_host_size_t total_timepoint_size =
-      semaphore_list.count * sizeof(timepoints[0]);
-  status =
-      iree_arena_allocate(&arena, total_timepoint_size, (void**)&timepoints);
-  if (iree_status_is_ok(status)) {
-    memset(timepoints, 0, total_timepoint_size);
-    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
-      iree_hal_task_semaphore_t* semaphore =
-          iree_hal_task_semaphore_cast(semaphore_list.semaphores[i]);
-      iree_slim_mutex_lock(&semaphore->mutex);
-      if (semaphore->current_value >= semaphore_list.payload_values[i]) {
-        // Fast path: already satisfied.
-      } else {
-        // Slow path: get a native wait handle for the timepoint.
-        iree_hal_task_timepoint_t* timepoint = &timepoints[timepoint_count++];
-        status = iree_hal_task_semaphore_acquire_timepoint(
-            semaphore, semaphore_list.payload_values[i], timeout, timepoint);
-        if (iree_status_is_ok(status)) {
-          status = iree_wait_set_insert(wait_set, timepoint->event);
-        }
-      }
-      iree_slim_mutex_unlock(&semaphore->mutex);
-      if (!iree_status_is_ok(status)) break;
-    }
-  }
-
-  // Perform the wait.
-  if (iree_status_is_ok(status)) {
-    if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
-      status = iree_wait_any(wait_set, deadline_ns, /*out_wake_handle=*/NULL);
-    } else {
-      status = iree_wait_all(wait_set, deadline_ns);
-    }
-  }
-
-  // TODO(benvanik): if we flip the API to multi-acquire events from the pool
-  // above then we can multi-release here too.
-  for (iree_host_size_t i = 0; i < timepoint_count; ++i) {
-    iree_hal_semaphore_t* semaphore = timepoints[i].semaphore;
-    if (semaphore) {
-      iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i].base);
-      iree_event_pool_release(event_pool, 1, &timepoints[i].event);
-    }
-  }
-  iree_wait_set_free(wait_set);
+  iree_status_t status = iree_hal_semaphore_multi_wait(
+      wait_mode, semaphore_list, timeout, IREE_HAL_SEMAPHORE_WAIT_SPIN_NS,
+      iree_arena_allocator(&arena));
   iree_arena_deinitialize(&arena);
 
   IREE_TRACE_ZONE_END(z0);
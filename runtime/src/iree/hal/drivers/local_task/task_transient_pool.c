@@ -0,0 +1,244 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_transient_pool.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_task_transient_pool_t
+//===----------------------------------------------------------------------===//
+
+struct iree_hal_task_transient_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_hal_suballocator_t suballocator;
+};
+
+static iree_status_t iree_hal_task_transient_pool_allocate_block(
+    void* self, iree_device_size_t block_size, void** out_user_data) {
+  iree_hal_task_transient_pool_t* pool = (iree_hal_task_transient_pool_t*)self;
+  if (block_size > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "transient block size %" PRIu64
+                            " exceeds the host address space",
+                            (uint64_t)block_size);
+  }
+  return iree_allocator_malloc_aligned(
+      pool->host_allocator, (iree_host_size_t)block_size,
+      (iree_host_size_t)pool->suballocator.params.alignment, 0, out_user_data);
+}
+
+static void iree_hal_task_transient_pool_free_block(
+    void* self, iree_device_size_t block_size, void* user_data) {
+  iree_hal_task_transient_pool_t* pool = (iree_hal_task_transient_pool_t*)self;
+  iree_allocator_free_aligned(pool->host_allocator, user_data);
+}
+
+iree_status_t iree_hal_task_transient_pool_create(
+    iree_device_size_t block_size, iree_allocator_t host_allocator,
+    iree_hal_task_transient_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)block_size);
+
+  iree_hal_task_transient_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+
+  iree_hal_suballocator_params_t params;
+  iree_hal_suballocator_params_initialize(&params);
+  params.block_size = block_size;
+  params.alignment = iree_max(params.alignment, IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+  const iree_hal_suballocator_block_allocator_t block_allocator = {
+      .self = pool,
+      .allocate = iree_hal_task_transient_pool_allocate_block,
+      .free = iree_hal_task_transient_pool_free_block,
+  };
+  iree_status_t status = iree_hal_suballocator_initialize(
+      &params, block_allocator, host_allocator, &pool->suballocator);
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_allocator_free(host_allocator, pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_task_transient_pool_destroy(
+    iree_hal_task_transient_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_suballocator_deinitialize(&pool->suballocator);
+  iree_allocator_free(pool->host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_task_transient_pool_retain(iree_hal_task_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+void iree_hal_task_transient_pool_release(
+    iree_hal_task_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_task_transient_pool_destroy(pool);
+  }
+}
+
+void iree_hal_task_transient_pool_trim(iree_hal_task_transient_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  iree_hal_suballocator_trim(&pool->suballocator);
+}
+
+void iree_hal_task_transient_pool_query_statistics(
+    iree_hal_task_transient_pool_t* pool,
+    iree_hal_suballocator_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(pool);
+  iree_hal_suballocator_query_statistics(&pool->suballocator, out_statistics);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_task_transient_buffer_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_task_transient_buffer_t {
+  iree_hal_buffer_t base;
+  // Pool the storage was suballocated from; retained.
+  iree_hal_task_transient_pool_t* pool;
+  // Storage of the buffer within a pool block.
+  uint8_t* data;
+  // iree_hal_suballocator_range_t* owning |data| or 0 once reclaimed.
+  iree_atomic_intptr_t range;
+} iree_hal_task_transient_buffer_t;
+
+static const iree_hal_buffer_vtable_t iree_hal_task_transient_buffer_vtable;
+
+static iree_hal_task_transient_buffer_t* iree_hal_task_transient_buffer_cast(
+    iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_task_transient_buffer_vtable);
+  return (iree_hal_task_transient_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_task_transient_pool_allocate_buffer(
+    iree_hal_task_transient_pool_t* pool,
+    iree_hal_allocator_t* device_allocator,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_hal_task_transient_buffer_t* buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(pool->host_allocator, sizeof(*buffer),
+                                (void**)&buffer));
+
+  iree_hal_suballocation_t suballocation;
+  iree_status_t status = iree_hal_suballocator_acquire(
+      &pool->suballocator, allocation_size, &suballocation);
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(
+        pool->host_allocator, device_allocator, &buffer->base, allocation_size,
+        0, allocation_size, params->type, params->access, params->usage,
+        &iree_hal_task_transient_buffer_vtable, &buffer->base);
+    buffer->pool = pool;
+    iree_hal_task_transient_pool_retain(pool);
+    buffer->data =
+        (uint8_t*)suballocation.block_user_data + suballocation.offset;
+    iree_atomic_store_intptr(&buffer->range, (intptr_t)suballocation.range,
+                             iree_memory_order_release);
+    *out_buffer = &buffer->base;
+  } else {
+    iree_allocator_free(pool->host_allocator, buffer);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_task_transient_buffer_isa(iree_hal_buffer_t* buffer) {
+  return iree_hal_resource_is(&buffer->resource,
+                              &iree_hal_task_transient_buffer_vtable);
+}
+
+void iree_hal_task_transient_buffer_reclaim(iree_hal_buffer_t* base_buffer) {
+  iree_hal_task_transient_buffer_t* buffer =
+      iree_hal_task_transient_buffer_cast(base_buffer);
+  iree_hal_suballocator_range_t* range =
+      (iree_hal_suballocator_range_t*)iree_atomic_exchange_intptr(
+          &buffer->range, 0, iree_memory_order_acq_rel);
+  if (range) iree_hal_suballocator_release(range);
+}
+
+static void iree_hal_task_transient_buffer_destroy(
+    iree_hal_buffer_t* base_buffer) {
+  iree_hal_task_transient_buffer_t* buffer =
+      iree_hal_task_transient_buffer_cast(base_buffer);
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_task_transient_buffer_reclaim(base_buffer);
+  iree_hal_task_transient_pool_release(buffer->pool);
+  iree_allocator_free(host_allocator, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_task_transient_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_task_transient_buffer_t* buffer =
+      iree_hal_task_transient_buffer_cast(base_buffer);
+  mapping->contents =
+      iree_make_byte_span(buffer->data + local_byte_offset, local_byte_length);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_task_transient_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  // No-op here as we always have the pointer.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_task_transient_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_atomic_thread_fence(iree_memory_order_acquire);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_task_transient_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_atomic_thread_fence(iree_memory_order_release);
+  return iree_ok_status();
+}
+
+static const iree_hal_buffer_vtable_t iree_hal_task_transient_buffer_vtable = {
+    // Storage is owned by the pool and never returned to the device allocator.
+    .recycle = iree_hal_task_transient_buffer_destroy,
+    .destroy = iree_hal_task_transient_buffer_destroy,
+    .map_range = iree_hal_task_transient_buffer_map_range,
+    .unmap_range = iree_hal_task_transient_buffer_unmap_range,
+    .invalidate_range = iree_hal_task_transient_buffer_invalidate_range,
+    .flush_range = iree_hal_task_transient_buffer_flush_range,
+};
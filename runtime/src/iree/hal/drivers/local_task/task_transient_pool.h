@@ -0,0 +1,71 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_LOCAL_TASK_TASK_TRANSIENT_POOL_H_
+#define IREE_HAL_DRIVERS_LOCAL_TASK_TASK_TRANSIENT_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/suballocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_task_transient_pool_t
+//===----------------------------------------------------------------------===//
+
+// A pool of host memory blocks that queue-ordered transient buffers are
+// suballocated from. Storage is returned to the pool either when a buffer is
+// destroyed or when it is explicitly reclaimed after a queue-ordered
+// deallocation retires, whichever comes first.
+//
+// Transient buffers retain the pool so it may outlive the device that created
+// it. Thread-safe.
+typedef struct iree_hal_task_transient_pool_t iree_hal_task_transient_pool_t;
+
+// Creates a transient pool that allocates host blocks of |block_size| bytes.
+iree_status_t iree_hal_task_transient_pool_create(
+    iree_device_size_t block_size, iree_allocator_t host_allocator,
+    iree_hal_task_transient_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_task_transient_pool_retain(iree_hal_task_transient_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+void iree_hal_task_transient_pool_release(iree_hal_task_transient_pool_t* pool);
+
+// Releases all unused blocks in |pool|.
+void iree_hal_task_transient_pool_trim(iree_hal_task_transient_pool_t* pool);
+
+// Queries the current and peak memory usage of |pool|.
+void iree_hal_task_transient_pool_query_statistics(
+    iree_hal_task_transient_pool_t* pool,
+    iree_hal_suballocator_statistics_t* out_statistics);
+
+// Allocates a transient buffer of |allocation_size| bytes from |pool|.
+// |params| must already be compatible with |device_allocator|, which the
+// buffer reports as its allocator but never returns its storage to.
+iree_status_t iree_hal_task_transient_pool_allocate_buffer(
+    iree_hal_task_transient_pool_t* pool,
+    iree_hal_allocator_t* device_allocator,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Returns true if |buffer| was allocated from a transient pool.
+bool iree_hal_task_transient_buffer_isa(iree_hal_buffer_t* buffer);
+
+// Returns the storage of |buffer| to its pool for reuse by subsequent
+// allocations. The buffer object remains valid until released but its
+// contents must no longer be accessed. No-op if already reclaimed.
+void iree_hal_task_transient_buffer_reclaim(iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_LOCAL_TASK_TASK_TRANSIENT_POOL_H_
@@ -173,6 +173,21 @@ typedef struct iree_hal_vulkan_device_options_t {
   // much.
   // NOTE: this is temporary and likely to get removed in the future.
   iree_device_size_t large_heap_block_size;
+
+  // Directory used to persist the VkPipelineCache shared by all executables
+  // created on the device. When set the cache is loaded when the device is
+  // created and saved when it is destroyed so that subsequent runs can skip
+  // driver shader compilation. The directory must already exist and the string
+  // must remain valid for the lifetime of any driver the options are passed to.
+  // Empty disables persistence.
+  iree_string_view_t pipeline_cache_dir;
+
+  // Size of each device-local block that queue-ordered
+  // (iree_hal_device_queue_alloca) buffers are suballocated from. Storage
+  // released by queue deallocations is reused without creating or destroying
+  // Vulkan objects. 0 disables pooling and allocates each buffer from the
+  // device allocator.
+  iree_device_size_t transient_block_size;
 } iree_hal_vulkan_device_options_t;
 
 IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
@@ -139,7 +139,7 @@ iree_status_t BuiltinExecutables::FillBufferUnaligned(
     VkCommandBuffer command_buffer, DescriptorSetArena* descriptor_set_arena,
     iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
     iree_device_size_t length, const void* pattern,
-    iree_host_size_t pattern_length, const void* push_constants_to_restore) {
+    iree_host_size_t pattern_length) {
   IREE_TRACE_SCOPE();
 
   iree_hal_vulkan_builtin_fill_unaligned_constants_t constants;
@@ -187,14 +187,6 @@ iree_status_t BuiltinExecutables::FillBufferUnaligned(
 
   logical_device_->syms()->vkCmdDispatch(command_buffer, 1, 1, 1);
 
-  // Restore push constants.
-  logical_device_->syms()->vkCmdPushConstants(
-      command_buffer,
-      iree_hal_vulkan_native_pipeline_layout_handle(pipeline_layout_),
-      VK_SHADER_STAGE_COMPUTE_BIT, /*offset=*/0,
-      sizeof(iree_hal_vulkan_builtin_fill_unaligned_constants_t),
-      push_constants_to_restore);
-
   return iree_ok_status();
 }
 
@@ -43,14 +43,38 @@ iree_status_t DescriptorSetGroup::Reset() {
 }
 
 DescriptorPoolCache::DescriptorPoolCache(VkDeviceHandle* logical_device)
-    : logical_device_(logical_device) {}
+    : logical_device_(logical_device) {
+  iree_slim_mutex_initialize(&mutex_);
+}
+
+DescriptorPoolCache::~DescriptorPoolCache() {
+  for (const auto& descriptor_pool : free_descriptor_pools_) {
+    syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
+                                   logical_device_->allocator());
+  }
+  free_descriptor_pools_.clear();
+  iree_slim_mutex_deinitialize(&mutex_);
+}
 
 iree_status_t DescriptorPoolCache::AcquireDescriptorPool(
     VkDescriptorType descriptor_type, int max_descriptor_count,
     DescriptorPool* out_descriptor_pool) {
   IREE_TRACE_SCOPE0("DescriptorPoolCache::AcquireDescriptorPool");
 
-  // TODO(benvanik): lookup in cache.
+  // Reuse a pool released by a retired command buffer, if any. Pools are reset
+  // when released and have all of their descriptor sets available.
+  iree_slim_mutex_lock(&mutex_);
+  for (auto it = free_descriptor_pools_.begin();
+       it != free_descriptor_pools_.end(); ++it) {
+    if (it->descriptor_type == descriptor_type &&
+        it->max_descriptor_count == max_descriptor_count) {
+      *out_descriptor_pool = *it;
+      free_descriptor_pools_.erase(it);
+      iree_slim_mutex_unlock(&mutex_);
+      return iree_ok_status();
+    }
+  }
+  iree_slim_mutex_unlock(&mutex_);
 
   VkDescriptorPoolCreateInfo create_info;
   create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -65,6 +89,7 @@ iree_status_t DescriptorPoolCache::AcquireDescriptorPool(
 
   DescriptorPool descriptor_pool;
   descriptor_pool.descriptor_type = descriptor_type;
+  descriptor_pool.max_descriptor_count = max_descriptor_count;
   descriptor_pool.handle = VK_NULL_HANDLE;
 
   VK_RETURN_IF_ERROR(syms().vkCreateDescriptorPool(
@@ -80,20 +105,29 @@ iree_status_t DescriptorPoolCache::ReleaseDescriptorPools(
     const std::vector<DescriptorPool>& descriptor_pools) {
   IREE_TRACE_SCOPE0("DescriptorPoolCache::ReleaseDescriptorPools");
 
+  // Always reset immediately. We could do this on allocation instead however
+  // this leads to better errors when using the validation layers as we'll
+  // throw if there are in-flight command buffers using the sets in the pool.
+  iree_status_t status = iree_ok_status();
   for (const auto& descriptor_pool : descriptor_pools) {
-    // Always reset immediately. We could do this on allocation instead however
-    // this leads to better errors when using the validation layers as we'll
-    // throw if there are in-flight command buffers using the sets in the pool.
-    VK_RETURN_IF_ERROR(syms().vkResetDescriptorPool(*logical_device_,
-                                                    descriptor_pool.handle, 0),
-                       "vkResetDescriptorPool");
-
-    // TODO(benvanik): release to cache.
-    syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
-                                   logical_device_->allocator());
+    if (iree_status_is_ok(status)) {
+      status = VK_RESULT_TO_STATUS(
+          syms().vkResetDescriptorPool(*logical_device_, descriptor_pool.handle,
+                                       0),
+          "vkResetDescriptorPool");
+    }
+    if (iree_status_is_ok(status)) {
+      iree_slim_mutex_lock(&mutex_);
+      free_descriptor_pools_.push_back(descriptor_pool);
+      iree_slim_mutex_unlock(&mutex_);
+    } else {
+      // Pools that failed to reset (and any after them) can't be reused.
+      syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
+                                     logical_device_->allocator());
+    }
   }
 
-  return iree_ok_status();
+  return status;
 }
 
 }  // namespace vulkan
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/vulkan/dynamic_symbols.h"
 #include "iree/hal/drivers/vulkan/handle_util.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
@@ -28,6 +29,8 @@ class DescriptorPoolCache;
 struct DescriptorPool {
   // Type of the descriptor in the set.
   VkDescriptorType descriptor_type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+  // Maximum number of descriptors per set the pool was sized for.
+  int max_descriptor_count = 0;
   // Pool handle.
   VkDescriptorPool handle = VK_NULL_HANDLE;
 };
@@ -66,9 +69,12 @@ class DescriptorSetGroup final {
 // resources. After the descriptors in the pool are no longer used (all
 // command buffers using descriptor sets allocated from the pool have retired)
 // the pool is returned here to be reused in the future.
+//
+// Thread-safe: pools may be acquired and released from any thread.
 class DescriptorPoolCache final {
  public:
   explicit DescriptorPoolCache(VkDeviceHandle* logical_device);
+  ~DescriptorPoolCache();
 
   VkDeviceHandle* logical_device() const { return logical_device_; }
   const DynamicSymbols& syms() const { return *logical_device_->syms(); }
@@ -88,6 +94,14 @@ class DescriptorPoolCache final {
 
  private:
   VkDeviceHandle* logical_device_;
+
+  // Reset pools available for reuse. Pools are only reused for requests with
+  // the same descriptor type and max_descriptor_count as the few buckets used
+  // by DescriptorSetArena keep this list short. Pools are retained until the
+  // cache is destroyed so the list is bounded by the peak number of pools
+  // in-flight at once.
+  iree_slim_mutex_t mutex_;
+  std::vector<DescriptorPool> free_descriptor_pools_;
 };
 
 }  // namespace vulkan
@@ -6,6 +6,7 @@
 
 #include "iree/hal/drivers/vulkan/direct_command_buffer.h"
 
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 
@@ -25,6 +26,11 @@
 
 using namespace iree::hal::vulkan;
 
+// Maximum number of 32-bit push constant words tracked per command buffer.
+// This covers the 256 byte maxPushConstantsSize common on desktop GPUs; pushes
+// beyond it are recorded but not tracked.
+#define IREE_HAL_VULKAN_MAX_PUSH_CONSTANT_COUNT 64
+
 // Command buffer implementation that directly maps to VkCommandBuffer.
 // This records the commands on the calling thread without additional threading
 // indirection.
@@ -32,6 +38,8 @@ typedef struct iree_hal_vulkan_direct_command_buffer_t {
   iree_hal_command_buffer_t base;
   VkDeviceHandle* logical_device;
   iree_hal_vulkan_tracing_context_t* tracing_context;
+  // Optional profiler timing each dispatch; retained.
+  iree_hal_vulkan_timestamp_profiler_t* profiler;
   iree_arena_block_pool_t* block_pool;
 
   VkCommandPoolHandle* command_pool;
@@ -53,14 +61,24 @@ typedef struct iree_hal_vulkan_direct_command_buffer_t {
 
   BuiltinExecutables* builtin_executables;
 
-  // Shadow copy of push constants used during normal operation, for restoring
-  // after builtin_executables uses vkCmdPushConstants. Size must be greater
-  // than or equal to the push constant memory used by builtin_executables.
+  // Shadow copy of push constants recorded with |push_constants_layout|. Used
+  // to elide redundant vkCmdPushConstants calls and for restoring after
+  // builtin_executables uses vkCmdPushConstants. Size must be greater than or
+  // equal to the push constant memory used by builtin_executables.
   // TODO(scotttodd): use [maxPushConstantsSize - 16, maxPushConstantsSize]
   //                  instead of [0, 16] to reduce frequency of updates
-  uint8_t push_constants_storage[IREE_HAL_VULKAN_BUILTIN_PUSH_CONSTANT_COUNT];
+  VkPipelineLayout push_constants_layout;
+  // Bitmask of the 32-bit words in |push_constants_storage| that hold the
+  // values currently recorded in the command buffer push constant state.
+  uint64_t push_constants_valid_words;
+  uint32_t push_constants_storage[IREE_HAL_VULKAN_MAX_PUSH_CONSTANT_COUNT];
 } iree_hal_vulkan_direct_command_buffer_t;
 
+static_assert(sizeof(((iree_hal_vulkan_direct_command_buffer_t*)0)
+                         ->push_constants_storage) >=
+                  IREE_HAL_VULKAN_BUILTIN_PUSH_CONSTANT_COUNT,
+              "push constant shadow must cover the builtin push constants");
+
 namespace {
 extern const iree_hal_command_buffer_vtable_t
     iree_hal_vulkan_direct_command_buffer_vtable;
@@ -74,6 +92,24 @@ iree_hal_vulkan_direct_command_buffer_cast(
   return (iree_hal_vulkan_direct_command_buffer_t*)base_value;
 }
 
+// Returns a bitmask of the 32-bit push constant words in the byte range
+// [offset, offset + length). Both must be 4 byte aligned and within the shadow.
+static uint64_t iree_hal_vulkan_push_constant_word_mask(
+    iree_host_size_t offset, iree_host_size_t length) {
+  const iree_host_size_t word_count = length / sizeof(uint32_t);
+  const uint64_t mask =
+      word_count >= 64 ? UINT64_MAX : ((1ull << word_count) - 1);
+  return mask << (offset / sizeof(uint32_t));
+}
+
+// Forgets all tracked push constant state such that the next push is always
+// recorded. Used when the command buffer state is undefined.
+static void iree_hal_vulkan_direct_command_buffer_invalidate_push_constants(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer) {
+  command_buffer->push_constants_layout = VK_NULL_HANDLE;
+  command_buffer->push_constants_valid_words = 0;
+}
+
 iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
     iree_hal_device_t* device,
     iree::hal::vulkan::VkDeviceHandle* logical_device,
@@ -82,6 +118,7 @@ iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_vulkan_tracing_context_t* tracing_context,
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
     iree::hal::vulkan::DescriptorPoolCache* descriptor_pool_cache,
     iree::hal::vulkan::BuiltinExecutables* builtin_executables,
     iree_arena_block_pool_t* block_pool,
@@ -106,7 +143,12 @@ iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
   allocate_info.pNext = NULL;
   allocate_info.commandPool = *command_pool;
   allocate_info.commandBufferCount = 1;
-  allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  // Nested command buffers are only ever executed from other command buffers
+  // and are recorded as secondary command buffers.
+  allocate_info.level =
+      iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED)
+          ? VK_COMMAND_BUFFER_LEVEL_SECONDARY
+          : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
   VkCommandBuffer handle = VK_NULL_HANDLE;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -122,6 +164,8 @@ iree_status_t iree_hal_vulkan_direct_command_buffer_allocate(
         &iree_hal_vulkan_direct_command_buffer_vtable, &command_buffer->base);
     command_buffer->logical_device = logical_device;
     command_buffer->tracing_context = tracing_context;
+    command_buffer->profiler = profiler;
+    iree_hal_vulkan_timestamp_profiler_retain(profiler);
     command_buffer->block_pool = block_pool;
     command_buffer->command_pool = command_pool;
     command_buffer->handle = handle;
@@ -176,6 +220,7 @@ static void iree_hal_vulkan_direct_command_buffer_destroy(
   command_buffer->descriptor_set_arena.~DescriptorSetArena();
 
   iree_hal_resource_set_free(command_buffer->resource_set);
+  iree_hal_vulkan_timestamp_profiler_release(command_buffer->profiler);
   iree_allocator_free(host_allocator, command_buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -199,11 +244,31 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_begin(
   VkCommandBufferBeginInfo begin_info;
   begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   begin_info.pNext = NULL;
+  // Reusable command buffers may be submitted again while prior submissions
+  // are still in flight.
   begin_info.flags = iree_all_bits_set(command_buffer->base.mode,
                                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)
                          ? VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
-                         : 0;
+                         : VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
   begin_info.pInheritanceInfo = NULL;
+  // Secondary command buffers must declare what they inherit from the primary
+  // executing them. Compute work is recorded outside of render passes so
+  // nothing is.
+  VkCommandBufferInheritanceInfo inheritance_info;
+  if (iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.pNext = NULL;
+    inheritance_info.renderPass = VK_NULL_HANDLE;
+    inheritance_info.subpass = 0;
+    inheritance_info.framebuffer = VK_NULL_HANDLE;
+    inheritance_info.occlusionQueryEnable = VK_FALSE;
+    inheritance_info.queryFlags = 0;
+    inheritance_info.pipelineStatistics = 0;
+    begin_info.pInheritanceInfo = &inheritance_info;
+  }
+  iree_hal_vulkan_direct_command_buffer_invalidate_push_constants(
+      command_buffer);
   VK_RETURN_IF_ERROR(command_buffer->syms->vkBeginCommandBuffer(
                          command_buffer->handle, &begin_info),
                      "vkBeginCommandBuffer");
@@ -549,45 +614,104 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_fill_buffer(
       command_buffer->resource_set, 1, &target_buffer));
 
   // vkCmdFillBuffer requires a 4 byte alignment for the offset, pattern, and
-  // length. We use a polyfill here that fills the unaligned start and end of
-  // fill operations, if needed.
-
-  if (target_offset % 4 != 0 || length % 4 != 0) {
-    // TODO(scotttodd): only restore push constants that have been modified?
-    //                  (this can pass uninitialized memory right now, which
-    //                   *should* be safe but is wasteful)
-    IREE_RETURN_IF_ERROR(
-        command_buffer->builtin_executables->FillBufferUnaligned(
-            command_buffer->handle, &(command_buffer->descriptor_set_arena),
-            target_buffer, target_offset, length, pattern, pattern_length,
-            command_buffer->push_constants_storage));
-
-    // Continue using vkCmdFillBuffer below, but only for the inner aligned
-    // portion of the fill operation.
-    // For example:
-    //   original offset 2, length 8
-    //   aligned  offset 4, length 4
-    // [0x00,0x00,0xAB,0xAB | 0xAB,0xAB,0xAB,0xAB | 0xAB,0xAB,0x00,0x00]
-    //            <-------> <---------------------> <------->
-    //            unaligned     vkCmdFillBuffer     unaligned
-    iree_device_size_t aligned_target_offset =
-        iree_device_align(target_offset, 4);
-    iree_device_size_t target_end = target_offset + length;
-    iree_device_size_t rounded_down_target_end = (target_end / 4) * 4;
-    length -= (aligned_target_offset - target_offset) +
-              (target_end - rounded_down_target_end);
-    target_offset = aligned_target_offset;
+  // length. Note that vkCmdFillBuffer only accepts 4-byte aligned values so we
+  // need to splat out our variable-length pattern.
+  const uint32_t dword_pattern =
+      iree_hal_vulkan_splat_pattern(pattern, pattern_length);
+  const iree_device_size_t fill_start =
+      iree_hal_buffer_byte_offset(target_buffer) + target_offset;
+  const iree_device_size_t fill_end = fill_start + length;
+  if (fill_start % 4 == 0 && length % 4 == 0) {
+    if (length > 0) {
+      command_buffer->syms->vkCmdFillBuffer(command_buffer->handle,
+                                            target_device_buffer, fill_start,
+                                            length, dword_pattern);
+    }
+    return iree_ok_status();
   }
 
-  if (length > 0) {
-    // Note that vkCmdFillBuffer only accepts 4-byte aligned values so we need
-    // to splat out our variable-length pattern.
-    target_offset += iree_hal_buffer_byte_offset(target_buffer);
-    uint32_t dword_pattern =
-        iree_hal_vulkan_splat_pattern(pattern, pattern_length);
-    command_buffer->syms->vkCmdFillBuffer(command_buffer->handle,
-                                          target_device_buffer, target_offset,
-                                          length, dword_pattern);
+  // Fill the aligned interior and then copy the pattern from it into the
+  // unaligned edges. vkCmdCopyBuffer has no alignment requirements so this
+  // works on transfer-only queues and avoids a dispatch. The copy sources are
+  // chosen to have the same alignment as their targets to preserve the phase
+  // of 2 byte patterns.
+  // For example:
+  //   original offset 2, length 8
+  //   aligned  offset 4, length 4
+  // [0x00,0x00,0xAB,0xAB | 0xAB,0xAB,0xAB,0xAB | 0xAB,0xAB,0x00,0x00]
+  //            <-------> <---------------------> <------->
+  //            copy      vkCmdFillBuffer         copy
+  const iree_device_size_t aligned_start = iree_device_align(fill_start, 4);
+  const iree_device_size_t aligned_end = fill_end & ~(iree_device_size_t)3;
+  if (aligned_end >= aligned_start + 4) {
+    command_buffer->syms->vkCmdFillBuffer(
+        command_buffer->handle, target_device_buffer, aligned_start,
+        aligned_end - aligned_start, dword_pattern);
+
+    VkMemoryBarrier barrier;
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.pNext = NULL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    command_buffer->syms->vkCmdPipelineBarrier(
+        command_buffer->handle, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, /*dependencyFlags=*/0, 1, &barrier, 0,
+        NULL, 0, NULL);
+
+    VkBufferCopy regions[2];
+    uint32_t region_count = 0;
+    if (fill_start < aligned_start) {
+      regions[region_count].srcOffset = aligned_start + fill_start % 4;
+      regions[region_count].dstOffset = fill_start;
+      regions[region_count].size = aligned_start - fill_start;
+      ++region_count;
+    }
+    if (aligned_end < fill_end) {
+      regions[region_count].srcOffset = aligned_end - 4;
+      regions[region_count].dstOffset = aligned_end;
+      regions[region_count].size = fill_end - aligned_end;
+      ++region_count;
+    }
+    command_buffer->syms->vkCmdCopyBuffer(
+        command_buffer->handle, target_device_buffer, target_device_buffer,
+        region_count, regions);
+    return iree_ok_status();
+  }
+
+  // Fills that do not cover a whole aligned word have nothing to copy from
+  // and use the builtin fill_unaligned dispatch. Transfer-only command buffers
+  // may be recorded for queues that do not support dispatches.
+  if (!iree_all_bits_set(
+          iree_hal_command_buffer_allowed_categories(base_command_buffer),
+          IREE_HAL_COMMAND_CATEGORY_DISPATCH)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "unaligned fills (offset %" PRIu64 ", length %" PRIu64
+        ") that do not span an aligned 4 byte word require a command buffer "
+        "with IREE_HAL_COMMAND_CATEGORY_DISPATCH",
+        (uint64_t)target_offset, (uint64_t)length);
+  }
+  IREE_RETURN_IF_ERROR(
+      command_buffer->builtin_executables->FillBufferUnaligned(
+          command_buffer->handle, &(command_buffer->descriptor_set_arena),
+          target_buffer, target_offset, length, pattern, pattern_length));
+
+  // Restore only the push constants the builtin clobbered that were
+  // previously recorded; words never pushed have no value to preserve.
+  const uint64_t clobbered_words = iree_hal_vulkan_push_constant_word_mask(
+      0, IREE_HAL_VULKAN_BUILTIN_PUSH_CONSTANT_COUNT);
+  const uint64_t restore_words =
+      command_buffer->push_constants_valid_words & clobbered_words;
+  if (restore_words) {
+    const uint32_t first_word =
+        iree_math_count_trailing_zeros_u64(restore_words);
+    const uint32_t end_word =
+        64 - iree_math_count_leading_zeros_u64(restore_words);
+    command_buffer->syms->vkCmdPushConstants(
+        command_buffer->handle, command_buffer->push_constants_layout,
+        VK_SHADER_STAGE_COMPUTE_BIT, first_word * sizeof(uint32_t),
+        (end_word - first_word) * sizeof(uint32_t),
+        &command_buffer->push_constants_storage[first_word]);
   }
 
   return iree_ok_status();
@@ -670,18 +794,37 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_push_constants(
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
 
-  iree_host_size_t storage_size =
-      IREE_ARRAYSIZE(command_buffer->push_constants_storage);
-  if (offset < storage_size) {
-    memcpy(command_buffer->push_constants_storage + offset, values,
-           std::min(values_length, storage_size) - offset);
+  VkPipelineLayout layout_handle =
+      iree_hal_vulkan_native_pipeline_layout_handle(pipeline_layout);
+  const iree_host_size_t storage_size =
+      sizeof(command_buffer->push_constants_storage);
+  uint8_t* storage = (uint8_t*)command_buffer->push_constants_storage;
+  if (values_length > 0 && offset % sizeof(uint32_t) == 0 &&
+      values_length % sizeof(uint32_t) == 0 &&
+      offset + values_length <= storage_size) {
+    const uint64_t words =
+        iree_hal_vulkan_push_constant_word_mask(offset, values_length);
+    if (layout_handle == command_buffer->push_constants_layout &&
+        iree_all_bits_set(command_buffer->push_constants_valid_words, words) &&
+        memcmp(storage + offset, values, values_length) == 0) {
+      // Already recorded; dispatches reuse the existing push constant state.
+      return iree_ok_status();
+    }
+    if (layout_handle != command_buffer->push_constants_layout) {
+      command_buffer->push_constants_layout = layout_handle;
+      command_buffer->push_constants_valid_words = 0;
+    }
+    memcpy(storage + offset, values, values_length);
+    command_buffer->push_constants_valid_words |= words;
+  } else {
+    // Untracked update; assume nothing about the current state.
+    iree_hal_vulkan_direct_command_buffer_invalidate_push_constants(
+        command_buffer);
   }
 
   command_buffer->syms->vkCmdPushConstants(
-      command_buffer->handle,
-      iree_hal_vulkan_native_pipeline_layout_handle(pipeline_layout),
-      VK_SHADER_STAGE_COMPUTE_BIT, (uint32_t)offset, (uint32_t)values_length,
-      values);
+      command_buffer->handle, layout_handle, VK_SHADER_STAGE_COMPUTE_BIT,
+      (uint32_t)offset, (uint32_t)values_length, values);
 
   return iree_ok_status();
 }
@@ -694,13 +837,9 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_push_descriptor_set(
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
 
-  // TODO(benvanik): batch insert by getting the resources in their own list.
-  for (iree_host_size_t i = 0; i < binding_count; ++i) {
-    if (bindings[i].buffer) {
-      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-          command_buffer->resource_set, 1, &bindings[i].buffer));
-    }
-  }
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_strided(
+      command_buffer->resource_set, binding_count, &bindings[0].buffer,
+      sizeof(bindings[0])));
 
   // Either allocate, update, and bind a descriptor set or use push descriptor
   // sets to use the command buffer pool when supported.
@@ -708,6 +847,32 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_push_descriptor_set(
       command_buffer->handle, pipeline_layout, set, binding_count, bindings);
 }
 
+// Begins timing a dispatch of |entry_point| in |executable| if profiling.
+// |out_dispatch_id| must be passed to the profiler after the dispatch.
+static iree_status_t iree_hal_vulkan_direct_command_buffer_begin_profiling(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t* out_dispatch_id) {
+  *out_dispatch_id = IREE_HAL_VULKAN_TIMESTAMP_PROFILER_INVALID_DISPATCH;
+  if (!command_buffer->profiler) return iree_ok_status();
+  iree_hal_vulkan_source_location_t source_location;
+  iree_hal_vulkan_native_executable_entry_point_source_location(
+      executable, entry_point, &source_location);
+  return iree_hal_vulkan_timestamp_profiler_begin_dispatch(
+      command_buffer->profiler, command_buffer->handle,
+      source_location.func_name, out_dispatch_id);
+}
+
+// Ends timing of a dispatch begun with
+// iree_hal_vulkan_direct_command_buffer_begin_profiling.
+static void iree_hal_vulkan_direct_command_buffer_end_profiling(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer,
+    uint32_t dispatch_id) {
+  if (!command_buffer->profiler) return;
+  iree_hal_vulkan_timestamp_profiler_end_dispatch(
+      command_buffer->profiler, command_buffer->handle, dispatch_id);
+}
+
 static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
@@ -738,8 +903,13 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch(
   command_buffer->syms->vkCmdBindPipeline(
       command_buffer->handle, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_handle);
 
+  uint32_t dispatch_id = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_direct_command_buffer_begin_profiling(
+      command_buffer, executable, entry_point, &dispatch_id));
   command_buffer->syms->vkCmdDispatch(command_buffer->handle, workgroup_x,
                                       workgroup_y, workgroup_z);
+  iree_hal_vulkan_direct_command_buffer_end_profiling(command_buffer,
+                                                      dispatch_id);
 
   IREE_VULKAN_TRACE_ZONE_END(command_buffer->tracing_context,
                              command_buffer->handle);
@@ -780,8 +950,13 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch_indirect(
   VkBuffer workgroups_device_buffer = iree_hal_vulkan_vma_buffer_handle(
       iree_hal_buffer_allocated_buffer(workgroups_buffer));
   workgroups_offset += iree_hal_buffer_byte_offset(workgroups_buffer);
+  uint32_t dispatch_id = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_direct_command_buffer_begin_profiling(
+      command_buffer, executable, entry_point, &dispatch_id));
   command_buffer->syms->vkCmdDispatchIndirect(
       command_buffer->handle, workgroups_device_buffer, workgroups_offset);
+  iree_hal_vulkan_direct_command_buffer_end_profiling(command_buffer,
+                                                      dispatch_id);
 
   IREE_VULKAN_TRACE_ZONE_END(command_buffer->tracing_context,
                              command_buffer->handle);
@@ -809,15 +984,33 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_execute_commands(
                             "indirect command buffers not yet implemented");
   }
 
-  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-      command_buffer->resource_set, 1, &base_commands));
-
   iree_hal_vulkan_direct_command_buffer_t* commands =
       iree_hal_vulkan_direct_command_buffer_cast(base_commands);
+  if (!iree_all_bits_set(commands->base.mode,
+                         IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "only nested command buffers may be executed "
+                            "from other command buffers");
+  }
+  if (commands->command_pool != command_buffer->command_pool) {
+    // Secondary command buffers must be allocated from the same queue family
+    // as the primary executing them.
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "nested command buffer categories are not "
+                            "compatible with the executing command buffer");
+  }
+
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &base_commands));
 
   command_buffer->syms->vkCmdExecuteCommands(command_buffer->handle, 1,
                                              &commands->handle);
 
+  // Command buffer state is undefined after executing secondary command
+  // buffers so the next push constants must be recorded again.
+  iree_hal_vulkan_direct_command_buffer_invalidate_push_constants(
+      command_buffer);
+
   return iree_ok_status();
 }
 
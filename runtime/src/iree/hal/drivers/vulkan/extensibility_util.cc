@@ -210,6 +210,12 @@ iree_hal_vulkan_populate_enabled_device_extensions(
     } else if (strcmp(extension_name,
                       VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME) == 0) {
       extensions.subgroup_size_control = true;
+    } else if (strcmp(extension_name,
+                      VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME) == 0) {
+      extensions.external_memory_host = true;
+    } else if (strcmp(extension_name,
+                      VK_KHR_COOPERATIVE_MATRIX_EXTENSION_NAME) == 0) {
+      extensions.cooperative_matrix = true;
     }
   }
   return extensions;
@@ -232,5 +238,8 @@ iree_hal_vulkan_infer_enabled_device_extensions(
   if (device_syms->vkGetCalibratedTimestampsEXT) {
     extensions.calibrated_timestamps = true;
   }
+  if (device_syms->vkGetMemoryHostPointerPropertiesEXT) {
+    extensions.external_memory_host = true;
+  }
   return extensions;
 }
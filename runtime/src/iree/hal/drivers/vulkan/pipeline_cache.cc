@@ -0,0 +1,225 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/pipeline_cache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "iree/base/internal/file_io.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/vulkan/status_util.h"
+
+using namespace iree::hal::vulkan;
+
+struct iree_hal_vulkan_pipeline_cache_t {
+  VkDeviceHandle* logical_device;
+  VkPipelineCache handle;
+
+  // Identity of the physical device used to validate cache file headers.
+  uint32_t vendor_id;
+  uint32_t device_id;
+  uint8_t uuid[VK_UUID_SIZE];
+
+  // NUL-terminated path of the cache file and the temporary file it is written
+  // to before being renamed into place. Stored in the same allocation.
+  char* file_path;
+  char* temp_file_path;
+};
+
+// Size of VkPipelineCacheHeaderVersionOne. Not all Vulkan headers we build
+// against define the struct so the fields are read by offset instead.
+#define IREE_HAL_VULKAN_PIPELINE_CACHE_HEADER_SIZE (16 + VK_UUID_SIZE)
+
+// Returns true if |data| begins with a VkPipelineCacheHeaderVersionOne that
+// matches the physical device |pipeline_cache| was created for.
+static bool iree_hal_vulkan_pipeline_cache_is_compatible(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache,
+    iree_const_byte_span_t data) {
+  if (data.data_length < IREE_HAL_VULKAN_PIPELINE_CACHE_HEADER_SIZE) {
+    return false;
+  }
+  uint32_t header_size = 0;
+  uint32_t header_version = 0;
+  uint32_t vendor_id = 0;
+  uint32_t device_id = 0;
+  memcpy(&header_size, data.data + 0, sizeof(header_size));
+  memcpy(&header_version, data.data + 4, sizeof(header_version));
+  memcpy(&vendor_id, data.data + 8, sizeof(vendor_id));
+  memcpy(&device_id, data.data + 12, sizeof(device_id));
+  return header_size >= IREE_HAL_VULKAN_PIPELINE_CACHE_HEADER_SIZE &&
+         header_size <= data.data_length &&
+         header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         vendor_id == pipeline_cache->vendor_id &&
+         device_id == pipeline_cache->device_id &&
+         memcmp(data.data + 16, pipeline_cache->uuid, VK_UUID_SIZE) == 0;
+}
+
+iree_status_t iree_hal_vulkan_pipeline_cache_create(
+    VkDeviceHandle* logical_device, VkPhysicalDevice physical_device,
+    iree_string_view_t cache_dir,
+    iree_hal_vulkan_pipeline_cache_t** out_pipeline_cache) {
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(out_pipeline_cache);
+  *out_pipeline_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  VkPhysicalDeviceProperties properties;
+  logical_device->syms()->vkGetPhysicalDeviceProperties(physical_device,
+                                                        &properties);
+
+  // <cache_dir>/iree_vulkan_<vendor>_<device>_<uuid>.bin
+  char file_name[64];
+  int file_name_length =
+      snprintf(file_name, sizeof(file_name), "iree_vulkan_%08x_%08x_",
+               properties.vendorID, properties.deviceID);
+  for (int i = 0; i < VK_UUID_SIZE; ++i) {
+    file_name_length += snprintf(file_name + file_name_length,
+                                 sizeof(file_name) - file_name_length, "%02x",
+                                 properties.pipelineCacheUUID[i]);
+  }
+  file_name_length += snprintf(file_name + file_name_length,
+                               sizeof(file_name) - file_name_length, ".bin");
+  const char temp_suffix[] = ".tmp";
+  iree_host_size_t path_length = cache_dir.size + 1 + file_name_length;
+
+  iree_hal_vulkan_pipeline_cache_t* pipeline_cache = NULL;
+  iree_host_size_t total_size = sizeof(*pipeline_cache) + (path_length + 1) +
+                                (path_length + sizeof(temp_suffix));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(logical_device->host_allocator(), total_size,
+                                (void**)&pipeline_cache));
+  pipeline_cache->logical_device = logical_device;
+  pipeline_cache->handle = VK_NULL_HANDLE;
+  pipeline_cache->vendor_id = properties.vendorID;
+  pipeline_cache->device_id = properties.deviceID;
+  memcpy(pipeline_cache->uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+  pipeline_cache->file_path = (char*)pipeline_cache + sizeof(*pipeline_cache);
+  snprintf(pipeline_cache->file_path, path_length + 1, "%.*s/%s",
+           (int)cache_dir.size, cache_dir.data, file_name);
+  pipeline_cache->temp_file_path =
+      pipeline_cache->file_path + path_length + 1;
+  snprintf(pipeline_cache->temp_file_path, path_length + sizeof(temp_suffix),
+           "%s%s", pipeline_cache->file_path, temp_suffix);
+
+  // Seed the cache with the file contents from a prior run, if any. A missing,
+  // unreadable, or mismatched file just means we start cold.
+  iree_file_contents_t* contents = NULL;
+  iree_status_t read_status = iree_file_read_contents(
+      pipeline_cache->file_path, logical_device->host_allocator(), &contents);
+  iree_const_byte_span_t initial_data = iree_const_byte_span_empty();
+  if (iree_status_is_ok(read_status)) {
+    if (iree_hal_vulkan_pipeline_cache_is_compatible(pipeline_cache,
+                                                     contents->const_buffer)) {
+      initial_data = contents->const_buffer;
+    }
+  } else {
+    iree_status_ignore(read_status);
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)initial_data.data_length);
+
+  VkPipelineCacheCreateInfo create_info;
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.initialDataSize = initial_data.data_length;
+  create_info.pInitialData = initial_data.data;
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      logical_device->syms()->vkCreatePipelineCache(
+          *logical_device, &create_info, logical_device->allocator(),
+          &pipeline_cache->handle),
+      "vkCreatePipelineCache");
+  if (!iree_status_is_ok(status) && initial_data.data_length > 0) {
+    // Drivers may reject data that passed our header check; retry cold.
+    iree_status_ignore(status);
+    create_info.initialDataSize = 0;
+    create_info.pInitialData = NULL;
+    status = VK_RESULT_TO_STATUS(
+        logical_device->syms()->vkCreatePipelineCache(
+            *logical_device, &create_info, logical_device->allocator(),
+            &pipeline_cache->handle),
+        "vkCreatePipelineCache");
+  }
+  iree_file_contents_free(contents);
+
+  if (iree_status_is_ok(status)) {
+    *out_pipeline_cache = pipeline_cache;
+  } else {
+    iree_hal_vulkan_pipeline_cache_destroy(pipeline_cache);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_vulkan_pipeline_cache_destroy(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache) {
+  if (!pipeline_cache) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  VkDeviceHandle* logical_device = pipeline_cache->logical_device;
+  if (pipeline_cache->handle != VK_NULL_HANDLE) {
+    logical_device->syms()->vkDestroyPipelineCache(
+        *logical_device, pipeline_cache->handle, logical_device->allocator());
+  }
+  iree_allocator_free(logical_device->host_allocator(), pipeline_cache);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+VkPipelineCache iree_hal_vulkan_pipeline_cache_handle(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache) {
+  return pipeline_cache ? pipeline_cache->handle : VK_NULL_HANDLE;
+}
+
+iree_status_t iree_hal_vulkan_pipeline_cache_save(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache) {
+  IREE_ASSERT_ARGUMENT(pipeline_cache);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  VkDeviceHandle* logical_device = pipeline_cache->logical_device;
+
+  size_t data_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, VK_RESULT_TO_STATUS(logical_device->syms()->vkGetPipelineCacheData(
+                                  *logical_device, pipeline_cache->handle,
+                                  &data_size, NULL),
+                              "vkGetPipelineCacheData"));
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)data_size);
+
+  uint8_t* data = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(logical_device->host_allocator(), data_size,
+                                (void**)&data));
+
+  // VK_INCOMPLETE is returned if the cache grew between the two calls; the
+  // data returned is still a valid (if partial) cache.
+  VkResult result = logical_device->syms()->vkGetPipelineCacheData(
+      *logical_device, pipeline_cache->handle, &data_size, data);
+  iree_status_t status =
+      result == VK_INCOMPLETE
+          ? iree_ok_status()
+          : VK_RESULT_TO_STATUS(result, "vkGetPipelineCacheData");
+
+  if (iree_status_is_ok(status)) {
+    status = iree_file_write_contents(
+        pipeline_cache->temp_file_path,
+        iree_make_const_byte_span(data, data_size));
+  }
+  if (iree_status_is_ok(status)) {
+#if defined(IREE_PLATFORM_WINDOWS)
+    // rename() does not replace existing files on Windows.
+    remove(pipeline_cache->file_path);
+#endif  // IREE_PLATFORM_WINDOWS
+    if (rename(pipeline_cache->temp_file_path, pipeline_cache->file_path) !=
+        0) {
+      status = iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                                "failed to replace pipeline cache file '%s'",
+                                pipeline_cache->file_path);
+      remove(pipeline_cache->temp_file_path);
+    }
+  }
+
+  iree_allocator_free(logical_device->host_allocator(), data);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
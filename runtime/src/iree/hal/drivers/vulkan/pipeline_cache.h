@@ -0,0 +1,61 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_PIPELINE_CACHE_H_
+#define IREE_HAL_DRIVERS_VULKAN_PIPELINE_CACHE_H_
+
+// clang-format off: must be included before all other headers.
+#include "iree/hal/drivers/vulkan/vulkan_headers.h"
+// clang-format on
+
+#include "iree/base/api.h"
+#include "iree/hal/drivers/vulkan/handle_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A VkPipelineCache shared by all executables created on a device and
+// persisted to a directory so that subsequent processes can skip driver shader
+// compilation.
+//
+// The cache file is named after the physical device vendor/device IDs and its
+// pipelineCacheUUID so multiple devices and driver versions can share the same
+// directory. Cache data loaded from disk is only passed to the driver if its
+// VkPipelineCacheHeaderVersionOne header matches the physical device; stale or
+// corrupt files are ignored and overwritten on the next save.
+//
+// Thread-safe: the VkPipelineCache is internally synchronized by the driver.
+typedef struct iree_hal_vulkan_pipeline_cache_t
+    iree_hal_vulkan_pipeline_cache_t;
+
+// Creates a pipeline cache for |physical_device| that is loaded from and saved
+// to |cache_dir|. Failing to read an existing cache file is not an error and
+// results in an empty cache.
+iree_status_t iree_hal_vulkan_pipeline_cache_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    VkPhysicalDevice physical_device, iree_string_view_t cache_dir,
+    iree_hal_vulkan_pipeline_cache_t** out_pipeline_cache);
+
+// Destroys |pipeline_cache| without saving it.
+void iree_hal_vulkan_pipeline_cache_destroy(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache);
+
+// Returns the VkPipelineCache to pass to pipeline creation.
+VkPipelineCache iree_hal_vulkan_pipeline_cache_handle(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache);
+
+// Writes the current contents of |pipeline_cache| to its cache file.
+// The file is written to a temporary path and renamed over the existing file so
+// that concurrent readers never observe a partially written cache.
+iree_status_t iree_hal_vulkan_pipeline_cache_save(
+    iree_hal_vulkan_pipeline_cache_t* pipeline_cache);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_PIPELINE_CACHE_H_
@@ -38,6 +38,14 @@ IREE_FLAG(
     int64_t, vulkan_large_heap_block_size, 0,
     "Preferred allocator block size for large allocations in bytes. Sets the "
     "minimum bound on memory consumption.");
+IREE_FLAG(
+    string, vulkan_pipeline_cache_dir, "",
+    "Existing directory used to persist compiled pipelines across runs. Empty "
+    "disables pipeline cache persistence.");
+IREE_FLAG(
+    int64_t, vulkan_transient_block_size, -1,
+    "Size in bytes of the device blocks queue-ordered allocations are "
+    "suballocated from. 0 disables pooling; -1 uses the default.");
 
 static iree_status_t iree_hal_vulkan_create_driver_with_flags(
     iree_string_view_t identifier, iree_allocator_t host_allocator,
@@ -80,6 +88,12 @@ static iree_status_t iree_hal_vulkan_create_driver_with_flags(
     driver_options.device_options.large_heap_block_size =
         FLAG_vulkan_large_heap_block_size;
   }
+  driver_options.device_options.pipeline_cache_dir =
+      iree_make_cstring_view(FLAG_vulkan_pipeline_cache_dir);
+  if (FLAG_vulkan_transient_block_size >= 0) {
+    driver_options.device_options.transient_block_size =
+        (iree_device_size_t)FLAG_vulkan_transient_block_size;
+  }
 
   // Load the Vulkan library. This will fail if the library cannot be found or
   // does not have the expected functions.
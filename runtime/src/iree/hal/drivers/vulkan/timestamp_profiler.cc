@@ -0,0 +1,524 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/timestamp_profiler.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/vulkan/status_util.h"
+
+using namespace iree::hal::vulkan;
+
+// Number of timestamp queries in each query pool. Pools are added as needed so
+// this only bounds the granularity of growth.
+#define IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT 4096
+
+// Two timestamps are written per dispatch.
+#define IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT \
+  (IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT / 2)
+
+// One row of the report: either the aggregate of all dispatches of an export or
+// a single dispatch.
+typedef struct iree_hal_vulkan_timestamp_row_t {
+  // Export name. Owned by the export row.
+  const char* name;
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+} iree_hal_vulkan_timestamp_row_t;
+
+typedef struct iree_hal_vulkan_timestamp_row_list_t {
+  iree_hal_vulkan_timestamp_row_t* values;
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+} iree_hal_vulkan_timestamp_row_list_t;
+
+struct iree_hal_vulkan_timestamp_profiler_t {
+  iree_atomic_ref_count_t ref_count;
+  VkDeviceHandle* logical_device;
+  bool per_dispatch;
+  char* file_path;
+
+  // Nanoseconds per timestamp tick and the mask of valid timestamp bits.
+  double timestamp_period;
+  uint64_t timestamp_mask;
+
+  // Guards all fields below as command buffers record from any thread.
+  iree_slim_mutex_t mutex;
+  // Set once the report has been written; new dispatches are not profiled.
+  bool ended;
+  // Query pools holding IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT
+  // queries each. Dispatch N uses queries 2N and 2N+1 across all pools.
+  VkQueryPool* query_pools;
+  iree_host_size_t query_pool_count;
+  iree_host_size_t query_pool_capacity;
+  // Index into |exports| of each dispatch recorded.
+  uint32_t* dispatch_exports;
+  iree_host_size_t dispatch_count;
+  iree_host_size_t dispatch_capacity;
+  // Rows per export; owns the names and accumulates durations when ended.
+  iree_hal_vulkan_timestamp_row_list_t exports;
+};
+
+static iree_status_t iree_hal_vulkan_timestamp_row_list_append(
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_timestamp_row_list_t* list,
+    iree_hal_vulkan_timestamp_row_t** out_row) {
+  if (list->count == list->capacity) {
+    iree_host_size_t new_capacity = iree_max(64, list->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        host_allocator, new_capacity * sizeof(list->values[0]),
+        (void**)&list->values));
+    list->capacity = new_capacity;
+  }
+  *out_row = &list->values[list->count++];
+  memset(*out_row, 0, sizeof(**out_row));
+  (*out_row)->min_ns = UINT64_MAX;
+  return iree_ok_status();
+}
+
+static void iree_hal_vulkan_timestamp_row_accumulate(
+    iree_hal_vulkan_timestamp_row_t* row, uint64_t duration_ns) {
+  ++row->count;
+  row->total_ns += duration_ns;
+  row->min_ns = iree_min(row->min_ns, duration_ns);
+  row->max_ns = iree_max(row->max_ns, duration_ns);
+}
+
+static void iree_hal_vulkan_timestamp_profiler_free(
+    iree_hal_vulkan_timestamp_profiler_t* profiler) {
+  VkDeviceHandle* logical_device = profiler->logical_device;
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < profiler->query_pool_count; ++i) {
+    logical_device->syms()->vkDestroyQueryPool(*logical_device,
+                                               profiler->query_pools[i],
+                                               logical_device->allocator());
+  }
+  iree_allocator_free(host_allocator, profiler->query_pools);
+  iree_allocator_free(host_allocator, profiler->dispatch_exports);
+  for (iree_host_size_t i = 0; i < profiler->exports.count; ++i) {
+    iree_allocator_free(host_allocator,
+                        (void*)profiler->exports.values[i].name);
+  }
+  iree_allocator_free(host_allocator, profiler->exports.values);
+  iree_allocator_free(host_allocator, profiler->file_path);
+  iree_slim_mutex_deinitialize(&profiler->mutex);
+  iree_allocator_free(host_allocator, profiler);
+  logical_device->ReleaseReference();
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_vulkan_timestamp_profiler_create(
+    VkDeviceHandle* logical_device, VkPhysicalDevice physical_device,
+    uint32_t queue_family_index,
+    const iree_hal_device_profiling_options_t* options,
+    iree_hal_vulkan_timestamp_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+
+  uint32_t queue_family_count = 0;
+  logical_device->syms()->vkGetPhysicalDeviceQueueFamilyProperties(
+      physical_device, &queue_family_count, NULL);
+  VkQueueFamilyProperties* queue_family_properties =
+      (VkQueueFamilyProperties*)iree_alloca(queue_family_count *
+                                            sizeof(VkQueueFamilyProperties));
+  logical_device->syms()->vkGetPhysicalDeviceQueueFamilyProperties(
+      physical_device, &queue_family_count, queue_family_properties);
+  uint32_t timestamp_valid_bits =
+      queue_family_index < queue_family_count
+          ? queue_family_properties[queue_family_index].timestampValidBits
+          : 0;
+  if (timestamp_valid_bits == 0) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "queue family %u does not support timestamps",
+                            queue_family_index);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+
+  VkPhysicalDeviceProperties device_properties;
+  logical_device->syms()->vkGetPhysicalDeviceProperties(physical_device,
+                                                        &device_properties);
+
+  iree_hal_vulkan_timestamp_profiler_t* profiler = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*profiler),
+                                (void**)&profiler));
+  memset(profiler, 0, sizeof(*profiler));
+  iree_atomic_ref_count_init(&profiler->ref_count);
+  profiler->logical_device = logical_device;
+  logical_device->AddReference();
+  profiler->per_dispatch =
+      iree_all_bits_set(options->mode,
+                        IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS);
+  profiler->timestamp_period = device_properties.limits.timestampPeriod;
+  profiler->timestamp_mask = timestamp_valid_bits >= 64
+                                 ? UINT64_MAX
+                                 : (1ull << timestamp_valid_bits) - 1;
+  iree_slim_mutex_initialize(&profiler->mutex);
+
+  iree_status_t status = iree_ok_status();
+  if (options->file_path && strlen(options->file_path) > 0) {
+    status = iree_allocator_clone(
+        host_allocator,
+        iree_make_const_byte_span(options->file_path,
+                                  strlen(options->file_path) + 1),
+        (void**)&profiler->file_path);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_profiler = profiler;
+  } else {
+    iree_hal_vulkan_timestamp_profiler_free(profiler);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_vulkan_timestamp_profiler_retain(
+    iree_hal_vulkan_timestamp_profiler_t* profiler) {
+  if (IREE_LIKELY(profiler)) {
+    iree_atomic_ref_count_inc(&profiler->ref_count);
+  }
+}
+
+void iree_hal_vulkan_timestamp_profiler_release(
+    iree_hal_vulkan_timestamp_profiler_t* profiler) {
+  if (IREE_LIKELY(profiler) &&
+      iree_atomic_ref_count_dec(&profiler->ref_count) == 1) {
+    iree_hal_vulkan_timestamp_profiler_free(profiler);
+  }
+}
+
+// Adds a query pool with IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT
+// queries. Must be called with the profiler mutex held.
+static iree_status_t iree_hal_vulkan_timestamp_profiler_grow(
+    iree_hal_vulkan_timestamp_profiler_t* profiler) {
+  VkDeviceHandle* logical_device = profiler->logical_device;
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (profiler->query_pool_count == profiler->query_pool_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(4, profiler->query_pool_capacity * 2);
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_realloc(
+                host_allocator, new_capacity * sizeof(profiler->query_pools[0]),
+                (void**)&profiler->query_pools));
+    profiler->query_pool_capacity = new_capacity;
+  }
+
+  VkQueryPoolCreateInfo create_info;
+  memset(&create_info, 0, sizeof(create_info));
+  create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  create_info.queryCount = IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT;
+  create_info.pipelineStatistics = 0;
+  VkQueryPool query_pool = VK_NULL_HANDLE;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, VK_RESULT_TO_STATUS(logical_device->syms()->vkCreateQueryPool(
+                                  *logical_device, &create_info,
+                                  logical_device->allocator(), &query_pool),
+                              "vkCreateQueryPool"));
+
+  // Reset from the host when possible so that queries of dispatches that never
+  // execute read back as unavailable. Command buffers reset their own queries
+  // before writing them so this is not required for correctness.
+  if (logical_device->enabled_extensions().host_query_reset) {
+    PFN_vkResetQueryPool vkResetQueryPool_fn =
+        logical_device->syms()->vkResetQueryPool
+            ? logical_device->syms()->vkResetQueryPool
+            : logical_device->syms()->vkResetQueryPoolEXT;
+    if (vkResetQueryPool_fn != NULL) {
+      vkResetQueryPool_fn(*logical_device, query_pool, 0,
+                          IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT);
+    }
+  }
+
+  profiler->query_pools[profiler->query_pool_count++] = query_pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Returns the index of the export row for |name|, adding it if it has not been
+// seen yet. Must be called with the profiler mutex held.
+static iree_status_t iree_hal_vulkan_timestamp_profiler_lookup_export(
+    iree_hal_vulkan_timestamp_profiler_t* profiler, iree_string_view_t name,
+    uint32_t* out_export_index) {
+  // Exports are few and dispatches of the same export tend to be adjacent so a
+  // reverse linear scan is sufficient.
+  for (iree_host_size_t i = profiler->exports.count; i > 0; --i) {
+    const iree_hal_vulkan_timestamp_row_t* row =
+        &profiler->exports.values[i - 1];
+    if (iree_string_view_equal(iree_make_cstring_view(row->name), name)) {
+      *out_export_index = (uint32_t)(i - 1);
+      return iree_ok_status();
+    }
+  }
+  iree_allocator_t host_allocator = profiler->logical_device->host_allocator();
+  char* name_copy = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, name.size + 1,
+                                             (void**)&name_copy));
+  memcpy(name_copy, name.data, name.size);
+  name_copy[name.size] = 0;
+  iree_hal_vulkan_timestamp_row_t* row = NULL;
+  iree_status_t status = iree_hal_vulkan_timestamp_row_list_append(
+      host_allocator, &profiler->exports, &row);
+  if (iree_status_is_ok(status)) {
+    row->name = name_copy;
+    *out_export_index = (uint32_t)(profiler->exports.count - 1);
+  } else {
+    iree_allocator_free(host_allocator, name_copy);
+  }
+  return status;
+}
+
+// Returns the query pool and first query index used by |dispatch_id|.
+static VkQueryPool iree_hal_vulkan_timestamp_profiler_dispatch_queries(
+    iree_hal_vulkan_timestamp_profiler_t* profiler, uint32_t dispatch_id,
+    uint32_t* out_query_index) {
+  *out_query_index =
+      (dispatch_id % IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT) *
+      2;
+  return profiler->query_pools
+      [dispatch_id / IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT];
+}
+
+iree_status_t iree_hal_vulkan_timestamp_profiler_begin_dispatch(
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
+    VkCommandBuffer command_buffer, iree_string_view_t name,
+    uint32_t* out_dispatch_id) {
+  *out_dispatch_id = IREE_HAL_VULKAN_TIMESTAMP_PROFILER_INVALID_DISPATCH;
+
+  iree_slim_mutex_lock(&profiler->mutex);
+  if (profiler->ended) {
+    iree_slim_mutex_unlock(&profiler->mutex);
+    return iree_ok_status();
+  }
+  iree_status_t status = iree_ok_status();
+  if (profiler->dispatch_count ==
+      profiler->query_pool_count *
+          IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT) {
+    status = iree_hal_vulkan_timestamp_profiler_grow(profiler);
+  }
+  if (iree_status_is_ok(status) &&
+      profiler->dispatch_count == profiler->dispatch_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT,
+                 profiler->dispatch_capacity * 2);
+    status = iree_allocator_realloc(
+        profiler->logical_device->host_allocator(),
+        new_capacity * sizeof(profiler->dispatch_exports[0]),
+        (void**)&profiler->dispatch_exports);
+    if (iree_status_is_ok(status)) profiler->dispatch_capacity = new_capacity;
+  }
+  uint32_t export_index = 0;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_vulkan_timestamp_profiler_lookup_export(profiler, name,
+                                                              &export_index);
+  }
+  uint32_t dispatch_id = IREE_HAL_VULKAN_TIMESTAMP_PROFILER_INVALID_DISPATCH;
+  VkQueryPool query_pool = VK_NULL_HANDLE;
+  uint32_t query_index = 0;
+  if (iree_status_is_ok(status)) {
+    dispatch_id = (uint32_t)profiler->dispatch_count++;
+    profiler->dispatch_exports[dispatch_id] = export_index;
+    query_pool = iree_hal_vulkan_timestamp_profiler_dispatch_queries(
+        profiler, dispatch_id, &query_index);
+  }
+  iree_slim_mutex_unlock(&profiler->mutex);
+  IREE_RETURN_IF_ERROR(status);
+
+  // Queries must be reset before each use; doing it in the command buffer
+  // keeps reusable command buffers valid across submissions.
+  const auto& syms = profiler->logical_device->syms();
+  syms->vkCmdResetQueryPool(command_buffer, query_pool, query_index, 2);
+  syms->vkCmdWriteTimestamp(command_buffer,
+                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, query_pool,
+                            query_index);
+  *out_dispatch_id = dispatch_id;
+  return iree_ok_status();
+}
+
+void iree_hal_vulkan_timestamp_profiler_end_dispatch(
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
+    VkCommandBuffer command_buffer, uint32_t dispatch_id) {
+  if (dispatch_id == IREE_HAL_VULKAN_TIMESTAMP_PROFILER_INVALID_DISPATCH) {
+    return;
+  }
+  // The pool list may be reallocated by other threads growing it.
+  iree_slim_mutex_lock(&profiler->mutex);
+  uint32_t query_index = 0;
+  VkQueryPool query_pool = iree_hal_vulkan_timestamp_profiler_dispatch_queries(
+      profiler, dispatch_id, &query_index);
+  iree_slim_mutex_unlock(&profiler->mutex);
+  profiler->logical_device->syms()->vkCmdWriteTimestamp(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, query_pool,
+      query_index + 1);
+}
+
+// Reads back the timestamps of all dispatches, accumulating them into the
+// export rows and |dispatch_rows| when reporting per dispatch. Must be called
+// with the profiler mutex held.
+static iree_status_t iree_hal_vulkan_timestamp_profiler_resolve(
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
+    iree_hal_vulkan_timestamp_row_list_t* dispatch_rows,
+    iree_host_size_t* out_missing_count) {
+  *out_missing_count = 0;
+  VkDeviceHandle* logical_device = profiler->logical_device;
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+
+  // Each query result is a (timestamp, availability) pair.
+  uint64_t* results = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator,
+      IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_QUERY_COUNT * 2 *
+          sizeof(uint64_t),
+      (void**)&results));
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t pool_index = 0;
+       pool_index < profiler->query_pool_count && iree_status_is_ok(status);
+       ++pool_index) {
+    iree_host_size_t base_dispatch =
+        pool_index * IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT;
+    iree_host_size_t dispatch_count =
+        iree_min(profiler->dispatch_count - base_dispatch,
+                 (iree_host_size_t)
+                     IREE_HAL_VULKAN_TIMESTAMP_PROFILER_POOL_DISPATCH_COUNT);
+    uint32_t query_count = (uint32_t)dispatch_count * 2;
+    // VK_NOT_READY is returned if any query is unavailable; those are skipped
+    // below using the availability values.
+    VkResult result = logical_device->syms()->vkGetQueryPoolResults(
+        *logical_device, profiler->query_pools[pool_index], 0, query_count,
+        query_count * 2 * sizeof(uint64_t), results, 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+      status = VK_RESULT_TO_STATUS(result, "vkGetQueryPoolResults");
+      break;
+    }
+    for (iree_host_size_t i = 0; i < dispatch_count; ++i) {
+      const uint64_t* begin = &results[i * 4 + 0];
+      const uint64_t* end = &results[i * 4 + 2];
+      if (!begin[1] || !end[1]) {
+        ++*out_missing_count;
+        continue;
+      }
+      uint64_t ticks = (end[0] - begin[0]) & profiler->timestamp_mask;
+      uint64_t duration_ns =
+          (uint64_t)((double)ticks * profiler->timestamp_period);
+      iree_hal_vulkan_timestamp_row_t* export_row =
+          &profiler->exports
+               .values[profiler->dispatch_exports[base_dispatch + i]];
+      iree_hal_vulkan_timestamp_row_accumulate(export_row, duration_ns);
+      if (profiler->per_dispatch) {
+        iree_hal_vulkan_timestamp_row_t* dispatch_row = NULL;
+        status = iree_hal_vulkan_timestamp_row_list_append(
+            host_allocator, dispatch_rows, &dispatch_row);
+        if (!iree_status_is_ok(status)) break;
+        dispatch_row->name = export_row->name;
+        iree_hal_vulkan_timestamp_row_accumulate(dispatch_row, duration_ns);
+      }
+    }
+  }
+
+  iree_allocator_free(host_allocator, results);
+  return status;
+}
+
+// Orders aggregated export rows by descending total time so the exports most
+// worth tuning come first.
+static int iree_hal_vulkan_timestamp_row_compare(const void* lhs_ptr,
+                                                 const void* rhs_ptr) {
+  const iree_hal_vulkan_timestamp_row_t* lhs =
+      (const iree_hal_vulkan_timestamp_row_t*)lhs_ptr;
+  const iree_hal_vulkan_timestamp_row_t* rhs =
+      (const iree_hal_vulkan_timestamp_row_t*)rhs_ptr;
+  if (lhs->total_ns == rhs->total_ns) return 0;
+  return lhs->total_ns > rhs->total_ns ? -1 : 1;
+}
+
+static iree_status_t iree_hal_vulkan_timestamp_profiler_write_report(
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
+    const iree_hal_vulkan_timestamp_row_list_t* rows,
+    iree_host_size_t missing_count) {
+  FILE* file = stdout;
+  if (profiler->file_path) {
+    file = fopen(profiler->file_path, "wb");
+    if (!file) {
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "unable to open profile output file '%s'",
+                              profiler->file_path);
+    }
+  }
+  fprintf(file, "export,count,total_ns,mean_ns,min_ns,max_ns\n");
+  for (iree_host_size_t i = 0; i < rows->count; ++i) {
+    const iree_hal_vulkan_timestamp_row_t* row = &rows->values[i];
+    if (!row->count) continue;
+    fprintf(file,
+            "\"%s\",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+            "\n",
+            row->name, row->count, row->total_ns, row->total_ns / row->count,
+            row->min_ns, row->max_ns);
+  }
+  if (missing_count) {
+    fprintf(file, "# %" PRIhsz " dispatches recorded but not executed\n",
+            missing_count);
+  }
+  if (file == stdout) {
+    fflush(file);
+  } else {
+    fclose(file);
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_vulkan_timestamp_profiler_end(
+    iree_hal_vulkan_timestamp_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&profiler->mutex);
+  profiler->ended = true;
+  iree_hal_vulkan_timestamp_row_list_t dispatch_rows;
+  memset(&dispatch_rows, 0, sizeof(dispatch_rows));
+  iree_host_size_t missing_count = 0;
+  iree_status_t status = iree_hal_vulkan_timestamp_profiler_resolve(
+      profiler, &dispatch_rows, &missing_count);
+  if (iree_status_is_ok(status) && !profiler->per_dispatch &&
+      profiler->exports.count > 0) {
+    // Per-dispatch rows stay in execution order.
+    qsort(profiler->exports.values, profiler->exports.count,
+          sizeof(profiler->exports.values[0]),
+          iree_hal_vulkan_timestamp_row_compare);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_vulkan_timestamp_profiler_write_report(
+        profiler, profiler->per_dispatch ? &dispatch_rows : &profiler->exports,
+        missing_count);
+  }
+  iree_slim_mutex_unlock(&profiler->mutex);
+
+  iree_allocator_free(profiler->logical_device->host_allocator(),
+                      dispatch_rows.values);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
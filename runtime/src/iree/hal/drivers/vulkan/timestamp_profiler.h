@@ -0,0 +1,88 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_TIMESTAMP_PROFILER_H_
+#define IREE_HAL_DRIVERS_VULKAN_TIMESTAMP_PROFILER_H_
+
+// clang-format off: must be included before all other headers.
+#include "iree/hal/drivers/vulkan/vulkan_headers.h"
+// clang-format on
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/vulkan/handle_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Measures the GPU duration of each dispatch with vkCmdWriteTimestamp and
+// writes a CSV report keyed by executable export name when ended. Unlike the
+// Tracy integration in tracing.h this is available in all builds and needs no
+// tracing connection.
+//
+// Command buffers recorded while the profiler is active write a pair of
+// timestamps around each dispatch into query pools owned by the profiler.
+// Results are only read back when the profiler is ended so submissions never
+// stall on them.
+//
+// With IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS durations are
+// aggregated per export; with
+// IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS one row is written per
+// dispatch. Reusable command buffers submitted multiple times only report
+// their most recent execution.
+//
+// Command buffers retain the profiler so that its query pools outlive them.
+// Thread-safe.
+typedef struct iree_hal_vulkan_timestamp_profiler_t
+    iree_hal_vulkan_timestamp_profiler_t;
+
+// Sentinel dispatch ID returned when a dispatch is not being profiled.
+#define IREE_HAL_VULKAN_TIMESTAMP_PROFILER_INVALID_DISPATCH UINT32_MAX
+
+// Creates a profiler for dispatches submitted to queues of
+// |queue_family_index|. The report is written to |options->file_path| or
+// stdout if none is given. Returns IREE_STATUS_UNAVAILABLE if the queue family
+// does not support timestamps.
+iree_status_t iree_hal_vulkan_timestamp_profiler_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    VkPhysicalDevice physical_device, uint32_t queue_family_index,
+    const iree_hal_device_profiling_options_t* options,
+    iree_hal_vulkan_timestamp_profiler_t** out_profiler);
+
+// Retains the given |profiler| for the caller.
+void iree_hal_vulkan_timestamp_profiler_retain(
+    iree_hal_vulkan_timestamp_profiler_t* profiler);
+
+// Releases the given |profiler| from the caller.
+void iree_hal_vulkan_timestamp_profiler_release(
+    iree_hal_vulkan_timestamp_profiler_t* profiler);
+
+// Records a timestamp into |command_buffer| before a dispatch of the export
+// |name| and returns the ID to pass to
+// iree_hal_vulkan_timestamp_profiler_end_dispatch. Returns
+// IREE_HAL_VULKAN_TIMESTAMP_PROFILER_INVALID_DISPATCH if the profiler has
+// ended.
+iree_status_t iree_hal_vulkan_timestamp_profiler_begin_dispatch(
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
+    VkCommandBuffer command_buffer, iree_string_view_t name,
+    uint32_t* out_dispatch_id);
+
+// Records a timestamp into |command_buffer| after the dispatch |dispatch_id|.
+void iree_hal_vulkan_timestamp_profiler_end_dispatch(
+    iree_hal_vulkan_timestamp_profiler_t* profiler,
+    VkCommandBuffer command_buffer, uint32_t dispatch_id);
+
+// Stops profiling new dispatches, reads back all timestamps, and writes the
+// report. All profiled work that was submitted must have completed.
+iree_status_t iree_hal_vulkan_timestamp_profiler_end(
+    iree_hal_vulkan_timestamp_profiler_t* profiler);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_TIMESTAMP_PROFILER_H_
@@ -0,0 +1,548 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/transient_pool.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/detail.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_transient_pool_t
+//===----------------------------------------------------------------------===//
+
+// Usage bits that have no bearing on where a buffer is placed and are ignored
+// when deciding whether the pool can service a request.
+#define IREE_HAL_VULKAN_TRANSIENT_POOL_IGNORED_USAGE \
+  (IREE_HAL_BUFFER_USAGE_SHARING_CONCURRENT |        \
+   IREE_HAL_BUFFER_USAGE_SHARING_IMMUTABLE |         \
+   IREE_HAL_BUFFER_USAGE_MAPPING_OPTIONAL)
+
+// A queue deallocation whose storage is not yet known to be unused.
+typedef struct iree_hal_vulkan_transient_release_t {
+  struct iree_hal_vulkan_transient_release_t* next;
+  // Transient buffer whose storage is being released; retained.
+  iree_hal_buffer_t* buffer;
+  // Semaphores (retained) and the payload values they must reach before the
+  // storage may be reused by unrelated allocations.
+  iree_host_size_t semaphore_count;
+  iree_hal_semaphore_t** semaphores;
+  uint64_t* payload_values;
+} iree_hal_vulkan_transient_release_t;
+
+struct iree_hal_vulkan_transient_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // Allocator blocks are allocated from; retained.
+  iree_hal_allocator_t* device_allocator;
+  // Parameters of every block after coercion by |device_allocator|.
+  iree_hal_buffer_params_t block_params;
+  iree_hal_suballocator_t suballocator;
+
+  // Guards |release_head|.
+  iree_slim_mutex_t mutex;
+  // Pending queue deallocations in no particular order.
+  iree_hal_vulkan_transient_release_t* release_head;
+};
+
+typedef struct iree_hal_vulkan_transient_buffer_t {
+  iree_hal_buffer_t base;
+  // Pool the storage was suballocated from; retained.
+  iree_hal_vulkan_transient_pool_t* pool;
+  // Length of the suballocated storage, which may exceed the buffer length if
+  // the storage was aliased from a larger buffer.
+  iree_device_size_t storage_length;
+  // iree_hal_suballocator_range_t* owning the storage or 0 once reclaimed.
+  iree_atomic_intptr_t range;
+} iree_hal_vulkan_transient_buffer_t;
+
+namespace {
+extern const iree_hal_buffer_vtable_t iree_hal_vulkan_transient_buffer_vtable;
+}  // namespace
+
+static iree_hal_vulkan_transient_buffer_t*
+iree_hal_vulkan_transient_buffer_cast(iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_vulkan_transient_buffer_vtable);
+  return (iree_hal_vulkan_transient_buffer_t*)base_value;
+}
+
+// Returns the storage of |buffer| to the suballocator. No-op if the storage
+// has already been reclaimed or handed off to another buffer.
+static void iree_hal_vulkan_transient_buffer_reclaim(
+    iree_hal_vulkan_transient_buffer_t* buffer) {
+  iree_hal_suballocator_range_t* range =
+      (iree_hal_suballocator_range_t*)iree_atomic_exchange_intptr(
+          &buffer->range, 0, iree_memory_order_acq_rel);
+  if (range) iree_hal_suballocator_release(range);
+}
+
+static iree_status_t iree_hal_vulkan_transient_pool_allocate_block(
+    void* self, iree_device_size_t block_size, void** out_user_data) {
+  iree_hal_vulkan_transient_pool_t* pool =
+      (iree_hal_vulkan_transient_pool_t*)self;
+  iree_hal_buffer_t* block = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      pool->device_allocator, pool->block_params, block_size,
+      iree_const_byte_span_empty(), &block));
+  *out_user_data = block;
+  return iree_ok_status();
+}
+
+static void iree_hal_vulkan_transient_pool_free_block(
+    void* self, iree_device_size_t block_size, void* user_data) {
+  iree_hal_buffer_release((iree_hal_buffer_t*)user_data);
+}
+
+iree_status_t iree_hal_vulkan_transient_pool_create(
+    iree_hal_allocator_t* device_allocator, iree_device_size_t block_size,
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_transient_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)block_size);
+
+  // Blocks are device-local and usable for everything queue-ordered
+  // allocations are generally used for. On unified memory systems the device
+  // allocator will also make them host-visible.
+  iree_hal_buffer_params_t block_params;
+  memset(&block_params, 0, sizeof(block_params));
+  block_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  block_params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+  block_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS |
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ |
+                       IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE;
+  iree_hal_buffer_params_t compat_params;
+  iree_device_size_t compat_block_size = 0;
+  if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                             device_allocator, block_params, block_size,
+                             &compat_params, &compat_block_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "device allocator cannot allocate transient pool "
+                            "blocks");
+  }
+
+  iree_hal_vulkan_transient_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->device_allocator = device_allocator;
+  iree_hal_allocator_retain(device_allocator);
+  pool->block_params = compat_params;
+  iree_slim_mutex_initialize(&pool->mutex);
+  pool->release_head = NULL;
+
+  // The default alignment (256) satisfies the maximum
+  // minStorageBufferOffsetAlignment and minUniformBufferOffsetAlignment
+  // allowed by the Vulkan spec so every range can be bound directly.
+  iree_hal_suballocator_params_t params;
+  iree_hal_suballocator_params_initialize(&params);
+  params.block_size = compat_block_size;
+  iree_hal_suballocator_block_allocator_t block_allocator;
+  block_allocator.self = pool;
+  block_allocator.allocate = iree_hal_vulkan_transient_pool_allocate_block;
+  block_allocator.free = iree_hal_vulkan_transient_pool_free_block;
+  iree_status_t status = iree_hal_suballocator_initialize(
+      &params, block_allocator, host_allocator, &pool->suballocator);
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_slim_mutex_deinitialize(&pool->mutex);
+    iree_hal_allocator_release(pool->device_allocator);
+    iree_allocator_free(host_allocator, pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Frees |release|, releasing its buffer and semaphores. The storage of the
+// buffer is only reclaimed if |reclaim| is true and otherwise returns to the
+// pool when the buffer is destroyed.
+static void iree_hal_vulkan_transient_release_free(
+    iree_hal_vulkan_transient_pool_t* pool,
+    iree_hal_vulkan_transient_release_t* release, bool reclaim) {
+  if (reclaim) {
+    iree_hal_vulkan_transient_buffer_reclaim(
+        iree_hal_vulkan_transient_buffer_cast(release->buffer));
+  }
+  iree_hal_buffer_release(release->buffer);
+  for (iree_host_size_t i = 0; i < release->semaphore_count; ++i) {
+    iree_hal_semaphore_release(release->semaphores[i]);
+  }
+  iree_allocator_free(pool->host_allocator, release);
+}
+
+static void iree_hal_vulkan_transient_pool_destroy(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = pool->host_allocator;
+
+  iree_hal_vulkan_transient_pool_drop_pending(pool);
+  iree_hal_suballocator_deinitialize(&pool->suballocator);
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_hal_allocator_release(pool->device_allocator);
+  iree_allocator_free(host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_vulkan_transient_pool_retain(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+void iree_hal_vulkan_transient_pool_release(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_vulkan_transient_pool_destroy(pool);
+  }
+}
+
+void iree_hal_vulkan_transient_pool_drop_pending(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_vulkan_transient_release_t* release = pool->release_head;
+  pool->release_head = NULL;
+  iree_slim_mutex_unlock(&pool->mutex);
+  while (release) {
+    iree_hal_vulkan_transient_release_t* next = release->next;
+    iree_hal_vulkan_transient_release_free(pool, release, /*reclaim=*/false);
+    release = next;
+  }
+}
+
+// Reclaims the storage of all pending deallocations whose semaphores have
+// reached their payload values. Deallocations with failed semaphores are
+// dropped without reclaiming as prior work may still be using the storage.
+static void iree_hal_vulkan_transient_pool_collect(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  iree_hal_vulkan_transient_release_t* completed_head = NULL;
+  iree_hal_vulkan_transient_release_t* failed_head = NULL;
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_vulkan_transient_release_t** prev_next = &pool->release_head;
+  while (*prev_next) {
+    iree_hal_vulkan_transient_release_t* release = *prev_next;
+    bool is_completed = true;
+    bool is_failed = false;
+    for (iree_host_size_t i = 0; i < release->semaphore_count; ++i) {
+      uint64_t current_value = 0;
+      iree_status_t status =
+          iree_hal_semaphore_query(release->semaphores[i], &current_value);
+      if (!iree_status_is_ok(status)) {
+        iree_status_ignore(status);
+        is_failed = true;
+        break;
+      } else if (current_value < release->payload_values[i]) {
+        is_completed = false;
+        break;
+      }
+    }
+    if (is_failed || is_completed) {
+      *prev_next = release->next;
+      iree_hal_vulkan_transient_release_t** list_head =
+          is_failed ? &failed_head : &completed_head;
+      release->next = *list_head;
+      *list_head = release;
+    } else {
+      prev_next = &release->next;
+    }
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  while (completed_head) {
+    iree_hal_vulkan_transient_release_t* next = completed_head->next;
+    iree_hal_vulkan_transient_release_free(pool, completed_head,
+                                           /*reclaim=*/true);
+    completed_head = next;
+  }
+  while (failed_head) {
+    iree_hal_vulkan_transient_release_t* next = failed_head->next;
+    iree_hal_vulkan_transient_release_free(pool, failed_head,
+                                           /*reclaim=*/false);
+    failed_head = next;
+  }
+}
+
+void iree_hal_vulkan_transient_pool_trim(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_vulkan_transient_pool_collect(pool);
+  iree_hal_suballocator_trim(&pool->suballocator);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_vulkan_transient_pool_query_statistics(
+    iree_hal_vulkan_transient_pool_t* pool,
+    iree_hal_suballocator_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(pool);
+  iree_hal_suballocator_query_statistics(&pool->suballocator, out_statistics);
+}
+
+bool iree_hal_vulkan_transient_pool_supports(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_buffer_params_t* params) {
+  return params->min_alignment <= pool->suballocator.params.alignment &&
+         iree_all_bits_set(pool->block_params.type, params->type) &&
+         iree_all_bits_set(pool->block_params.access, params->access) &&
+         iree_all_bits_set(
+             pool->block_params.usage,
+             params->usage & ~IREE_HAL_VULKAN_TRANSIENT_POOL_IGNORED_USAGE);
+}
+
+// Returns true if every semaphore of |release| is waited on by
+// |wait_semaphore_list| at or beyond the value the release is gated on.
+static bool iree_hal_vulkan_transient_release_is_ordered_before(
+    const iree_hal_vulkan_transient_release_t* release,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < release->semaphore_count; ++i) {
+    bool is_waited = false;
+    for (iree_host_size_t j = 0; j < wait_semaphore_list.count; ++j) {
+      if (wait_semaphore_list.semaphores[j] == release->semaphores[i] &&
+          wait_semaphore_list.payload_values[j] >=
+              release->payload_values[i]) {
+        is_waited = true;
+        break;
+      }
+    }
+    if (!is_waited) return false;
+  }
+  return true;
+}
+
+// Removes and returns the pending release with the smallest storage that can
+// hold |allocation_size| bytes and that is ordered before any user waiting on
+// |wait_semaphore_list|. Storage more than twice the requested size is not
+// aliased to avoid pinning large ranges with small buffers.
+static iree_hal_vulkan_transient_release_t*
+iree_hal_vulkan_transient_pool_take_aliasable_release(
+    iree_hal_vulkan_transient_pool_t* pool, iree_device_size_t allocation_size,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  if (!wait_semaphore_list.count) return NULL;
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_vulkan_transient_release_t** best_prev_next = NULL;
+  iree_device_size_t best_length = 0;
+  for (iree_hal_vulkan_transient_release_t** prev_next = &pool->release_head;
+       *prev_next; prev_next = &(*prev_next)->next) {
+    iree_hal_vulkan_transient_release_t* release = *prev_next;
+    iree_hal_vulkan_transient_buffer_t* buffer =
+        iree_hal_vulkan_transient_buffer_cast(release->buffer);
+    const iree_device_size_t length = buffer->storage_length;
+    if (length < allocation_size || length / 2 > allocation_size ||
+        (best_prev_next && length >= best_length) ||
+        !iree_atomic_load_intptr(&buffer->range, iree_memory_order_acquire) ||
+        !iree_hal_vulkan_transient_release_is_ordered_before(
+            release, wait_semaphore_list)) {
+      continue;
+    }
+    best_prev_next = prev_next;
+    best_length = length;
+  }
+  iree_hal_vulkan_transient_release_t* release = NULL;
+  if (best_prev_next) {
+    release = *best_prev_next;
+    *best_prev_next = release->next;
+    release->next = NULL;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  return release;
+}
+
+iree_status_t iree_hal_vulkan_transient_pool_allocate_buffer(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_hal_vulkan_transient_buffer_t* buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(pool->host_allocator, sizeof(*buffer),
+                                (void**)&buffer));
+
+  // Return completed deallocations to the suballocator before trying to
+  // alias storage that is still in flight or acquiring new storage.
+  iree_hal_vulkan_transient_pool_collect(pool);
+
+  iree_status_t status = iree_ok_status();
+  iree_hal_vulkan_transient_release_t* release =
+      iree_hal_vulkan_transient_pool_take_aliasable_release(
+          pool, allocation_size, wait_semaphore_list);
+  iree_hal_buffer_t* block = NULL;
+  iree_device_size_t byte_offset = 0;
+  intptr_t range = 0;
+  if (release) {
+    // Take over the storage of the released buffer. Its users have all been
+    // ordered before ours so no synchronization is needed.
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "aliased");
+    iree_hal_vulkan_transient_buffer_t* released_buffer =
+        iree_hal_vulkan_transient_buffer_cast(release->buffer);
+    block = released_buffer->base.allocated_buffer;
+    byte_offset = released_buffer->base.byte_offset;
+    buffer->storage_length = released_buffer->storage_length;
+    range = iree_atomic_exchange_intptr(&released_buffer->range, 0,
+                                        iree_memory_order_acq_rel);
+  } else {
+    iree_hal_suballocation_t suballocation;
+    status = iree_hal_suballocator_acquire(&pool->suballocator,
+                                           allocation_size, &suballocation);
+    if (iree_status_is_ok(status)) {
+      block = (iree_hal_buffer_t*)suballocation.block_user_data;
+      byte_offset = suballocation.offset;
+      buffer->storage_length = suballocation.length;
+      range = (intptr_t)suballocation.range;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(
+        pool->host_allocator, pool->device_allocator, block,
+        block->allocation_size, byte_offset, allocation_size, params->type,
+        params->access, params->usage,
+        &iree_hal_vulkan_transient_buffer_vtable, &buffer->base);
+    buffer->pool = pool;
+    iree_hal_vulkan_transient_pool_retain(pool);
+    iree_atomic_store_intptr(&buffer->range, range, iree_memory_order_release);
+    *out_buffer = &buffer->base;
+  } else {
+    iree_allocator_free(pool->host_allocator, buffer);
+  }
+
+  // The storage now belongs to the new buffer (which retains the block).
+  if (release) {
+    iree_hal_vulkan_transient_release_free(pool, release, /*reclaim=*/false);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_vulkan_transient_buffer_t
+//===----------------------------------------------------------------------===//
+
+bool iree_hal_vulkan_transient_buffer_isa(iree_hal_buffer_t* buffer) {
+  return iree_hal_resource_is(&buffer->resource,
+                              &iree_hal_vulkan_transient_buffer_vtable);
+}
+
+iree_status_t iree_hal_vulkan_transient_buffer_deallocate(
+    iree_hal_buffer_t* base_buffer,
+    const iree_hal_semaphore_list_t release_semaphore_list) {
+  iree_hal_vulkan_transient_buffer_t* buffer =
+      iree_hal_vulkan_transient_buffer_cast(base_buffer);
+  iree_hal_vulkan_transient_pool_t* pool = buffer->pool;
+  if (!release_semaphore_list.count) {
+    iree_hal_vulkan_transient_buffer_reclaim(buffer);
+    return iree_ok_status();
+  }
+
+  iree_hal_vulkan_transient_release_t* release = NULL;
+  iree_host_size_t total_size =
+      sizeof(*release) +
+      release_semaphore_list.count * (sizeof(release->semaphores[0]) +
+                                      sizeof(release->payload_values[0]));
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(pool->host_allocator, total_size,
+                                             (void**)&release));
+  release->buffer = base_buffer;
+  iree_hal_buffer_retain(base_buffer);
+  release->semaphore_count = release_semaphore_list.count;
+  release->payload_values = (uint64_t*)((uint8_t*)release + sizeof(*release));
+  release->semaphores =
+      (iree_hal_semaphore_t**)(release->payload_values +
+                               release_semaphore_list.count);
+  for (iree_host_size_t i = 0; i < release_semaphore_list.count; ++i) {
+    release->semaphores[i] = release_semaphore_list.semaphores[i];
+    iree_hal_semaphore_retain(release->semaphores[i]);
+    release->payload_values[i] = release_semaphore_list.payload_values[i];
+  }
+
+  iree_slim_mutex_lock(&pool->mutex);
+  release->next = pool->release_head;
+  pool->release_head = release;
+  iree_slim_mutex_unlock(&pool->mutex);
+  return iree_ok_status();
+}
+
+static void iree_hal_vulkan_transient_buffer_destroy(
+    iree_hal_buffer_t* base_buffer) {
+  iree_hal_vulkan_transient_buffer_t* buffer =
+      iree_hal_vulkan_transient_buffer_cast(base_buffer);
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_vulkan_transient_buffer_reclaim(buffer);
+  iree_hal_buffer_release(base_buffer->allocated_buffer);
+  iree_hal_vulkan_transient_pool_release(buffer->pool);
+  iree_allocator_free(host_allocator, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_vulkan_transient_buffer_map_range(
+    iree_hal_buffer_t* buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  return IREE_HAL_VTABLE_DISPATCH(buffer->allocated_buffer, iree_hal_buffer,
+                                  map_range)(
+      buffer->allocated_buffer, mapping_mode, memory_access, local_byte_offset,
+      local_byte_length, mapping);
+}
+
+static iree_status_t iree_hal_vulkan_transient_buffer_unmap_range(
+    iree_hal_buffer_t* buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  return IREE_HAL_VTABLE_DISPATCH(buffer->allocated_buffer, iree_hal_buffer,
+                                  unmap_range)(
+      buffer->allocated_buffer, local_byte_offset, local_byte_length, mapping);
+}
+
+static iree_status_t iree_hal_vulkan_transient_buffer_invalidate_range(
+    iree_hal_buffer_t* buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  return IREE_HAL_VTABLE_DISPATCH(buffer->allocated_buffer, iree_hal_buffer,
+                                  invalidate_range)(
+      buffer->allocated_buffer, local_byte_offset, local_byte_length);
+}
+
+static iree_status_t iree_hal_vulkan_transient_buffer_flush_range(
+    iree_hal_buffer_t* buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  return IREE_HAL_VTABLE_DISPATCH(buffer->allocated_buffer, iree_hal_buffer,
+                                  flush_range)(
+      buffer->allocated_buffer, local_byte_offset, local_byte_length);
+}
+
+namespace {
+const iree_hal_buffer_vtable_t iree_hal_vulkan_transient_buffer_vtable = {
+    // Storage is owned by the pool and never returned to the device allocator.
+    /*.recycle=*/iree_hal_vulkan_transient_buffer_destroy,
+    /*.destroy=*/iree_hal_vulkan_transient_buffer_destroy,
+    /*.map_range=*/iree_hal_vulkan_transient_buffer_map_range,
+    /*.unmap_range=*/iree_hal_vulkan_transient_buffer_unmap_range,
+    /*.invalidate_range=*/iree_hal_vulkan_transient_buffer_invalidate_range,
+    /*.flush_range=*/iree_hal_vulkan_transient_buffer_flush_range,
+};
+}  // namespace
@@ -0,0 +1,100 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_TRANSIENT_POOL_H_
+#define IREE_HAL_DRIVERS_VULKAN_TRANSIENT_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/suballocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A pool of large device buffers that queue-ordered (queue_alloca) transient
+// buffers are suballocated from. Transient buffers reference a range of a
+// pool block and are interchangeable with VMA buffers: command buffers bind
+// the block VkBuffer at the transient buffer byte offset. Neither VkBuffer nor
+// VkDeviceMemory objects are created or destroyed on the allocation path once
+// the pool has warmed up.
+//
+// Storage released by a queue deallocation becomes reusable when the
+// semaphores signaled by the deallocation reach their payload values. Until
+// then it may only be reused (aliased) by allocations that wait on those same
+// semaphores at or beyond those values as all users of the new buffer are then
+// ordered after all users of the old one. Storage of transient buffers that
+// are released without a queue deallocation is reclaimed when the buffer is
+// destroyed.
+//
+// Transient buffers retain the pool so it may outlive the device that created
+// it. Thread-safe.
+typedef struct iree_hal_vulkan_transient_pool_t
+    iree_hal_vulkan_transient_pool_t;
+
+// Creates a transient pool that allocates blocks of |block_size| bytes from
+// |device_allocator|. Blocks are device-local and usable for dispatch and
+// transfer operations.
+iree_status_t iree_hal_vulkan_transient_pool_create(
+    iree_hal_allocator_t* device_allocator, iree_device_size_t block_size,
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_transient_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_vulkan_transient_pool_retain(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+void iree_hal_vulkan_transient_pool_release(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Drops all pending deallocations without reclaiming their storage and
+// releases their semaphores. Must be called when the device is destroyed as
+// the semaphores reference it; storage is reclaimed when the buffers die.
+void iree_hal_vulkan_transient_pool_drop_pending(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Reclaims storage of completed deallocations and releases all unused blocks.
+void iree_hal_vulkan_transient_pool_trim(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Queries the current and peak memory usage of |pool|.
+void iree_hal_vulkan_transient_pool_query_statistics(
+    iree_hal_vulkan_transient_pool_t* pool,
+    iree_hal_suballocator_statistics_t* out_statistics);
+
+// Returns true if buffers with the given |params| (already made compatible
+// with the device allocator) can be allocated from |pool|.
+bool iree_hal_vulkan_transient_pool_supports(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_buffer_params_t* params);
+
+// Allocates a transient buffer of |allocation_size| bytes from |pool|.
+// The buffer may alias storage of a pending deallocation if all of its
+// semaphores are waited on by |wait_semaphore_list|; the caller must ensure
+// that the buffer is not used until the waits have been satisfied.
+iree_status_t iree_hal_vulkan_transient_pool_allocate_buffer(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_t** out_buffer);
+
+// Returns true if |buffer| was allocated from a transient pool.
+bool iree_hal_vulkan_transient_buffer_isa(iree_hal_buffer_t* buffer);
+
+// Returns the storage of |buffer| to its pool once all semaphores in
+// |release_semaphore_list| have reached their payload values. The storage is
+// returned immediately if the list is empty. The buffer object remains valid
+// until released but its contents must no longer be accessed.
+iree_status_t iree_hal_vulkan_transient_buffer_deallocate(
+    iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t release_semaphore_list);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_TRANSIENT_POOL_H_
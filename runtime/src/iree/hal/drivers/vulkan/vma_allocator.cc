@@ -6,6 +6,7 @@
 
 #include "iree/hal/drivers/vulkan/vma_allocator.h"
 
+#include <cinttypes>
 #include <cstddef>
 #include <cstring>
 
@@ -272,6 +273,29 @@ static iree_status_t iree_hal_vulkan_populate_memory_types(
   return iree_ok_status();
 }
 
+// Returns true if the device shares physical memory with the host and exposes
+// a device-local memory type that is also host-visible. On such systems
+// (mobile GPUs, Apple silicon via MoltenVK, CPU implementations) staging copies
+// only add overhead and device-local buffers can be mapped directly.
+static bool iree_hal_vulkan_is_unified_memory(
+    const VkPhysicalDeviceProperties* device_props,
+    const VkPhysicalDeviceMemoryProperties* memory_props) {
+  if (device_props->deviceType != VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU &&
+      device_props->deviceType != VK_PHYSICAL_DEVICE_TYPE_CPU) {
+    return false;
+  }
+  for (uint32_t i = 0; i < memory_props->memoryTypeCount; ++i) {
+    VkMemoryPropertyFlags flags = memory_props->memoryTypes[i].propertyFlags;
+    if (iree_hal_vulkan_is_heap_device_local(memory_props, i) &&
+        iree_hal_vulkan_is_memory_type_usable(flags) &&
+        iree_all_bits_set(flags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_vulkan_vma_allocator_t
 //===----------------------------------------------------------------------===//
@@ -280,11 +304,25 @@ typedef struct iree_hal_vulkan_vma_allocator_t {
   iree_hal_resource_t resource;
   iree_hal_device_t* device;  // unretained to avoid cycles
   iree_allocator_t host_allocator;
+  VkDeviceHandle* logical_device;
   VmaAllocator vma;
 
+  // Required alignment of host pointers and sizes imported with
+  // VK_EXT_external_memory_host or 0 if the extension is not available.
+  VkDeviceSize min_imported_host_pointer_alignment;
+
+  // True if device-local memory is host-visible and buffers should be mapped
+  // directly instead of staged. See iree_hal_vulkan_is_unified_memory.
+  bool unified_memory;
+
   // Used to quickly look up the memory type index used for a particular usage.
   iree_hal_vulkan_memory_types_t memory_types;
 
+  // Queue families buffers are shared with. Buffers are created with
+  // VK_SHARING_MODE_CONCURRENT when more than one family is in use.
+  uint32_t queue_family_count;
+  uint32_t queue_family_indices[2];
+
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_vulkan_vma_allocator_t;
 
@@ -346,6 +384,8 @@ static void VKAPI_PTR iree_hal_vulkan_vma_free_callback(
 iree_status_t iree_hal_vulkan_vma_allocator_create(
     const iree_hal_vulkan_device_options_t* options, VkInstance instance,
     VkPhysicalDevice physical_device, VkDeviceHandle* logical_device,
+    const iree_hal_vulkan_queue_set_t* compute_queue_set,
+    const iree_hal_vulkan_queue_set_t* transfer_queue_set,
     iree_hal_device_t* device, iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_ASSERT_ARGUMENT(physical_device);
@@ -363,6 +403,15 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
                                &allocator->resource);
   allocator->host_allocator = host_allocator;
   allocator->device = device;
+  allocator->logical_device = logical_device;
+  allocator->queue_family_count = 1;
+  allocator->queue_family_indices[0] = compute_queue_set->queue_family_index;
+  if (transfer_queue_set->queue_indices != 0 &&
+      transfer_queue_set->queue_family_index !=
+          compute_queue_set->queue_family_index) {
+    allocator->queue_family_indices[allocator->queue_family_count++] =
+        transfer_queue_set->queue_family_index;
+  }
 
   const auto& syms = logical_device->syms();
   VmaVulkanFunctions vulkan_fns;
@@ -422,6 +471,24 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
     vmaGetMemoryProperties(allocator->vma, &memory_props);
     status = iree_hal_vulkan_populate_memory_types(device_props, memory_props,
                                                    &allocator->memory_types);
+    allocator->unified_memory =
+        iree_hal_vulkan_is_unified_memory(device_props, memory_props);
+    IREE_TRACE_ZONE_APPEND_VALUE(z0, allocator->unified_memory ? 1 : 0);
+  }
+
+  if (iree_status_is_ok(status) &&
+      logical_device->enabled_extensions().external_memory_host) {
+    VkPhysicalDeviceExternalMemoryHostPropertiesEXT host_props;
+    memset(&host_props, 0, sizeof(host_props));
+    host_props.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 device_props2;
+    memset(&device_props2, 0, sizeof(device_props2));
+    device_props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    device_props2.pNext = &host_props;
+    syms->vkGetPhysicalDeviceProperties2(physical_device, &device_props2);
+    allocator->min_imported_host_pointer_alignment =
+        host_props.minImportedHostPointerAlignment;
   }
 
   if (iree_status_is_ok(status)) {
@@ -582,12 +649,22 @@ iree_hal_vulkan_vma_allocator_query_buffer_compatibility(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_hal_buffer_params_t* IREE_RESTRICT params,
     iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_vulkan_vma_allocator_t* allocator =
+      iree_hal_vulkan_vma_allocator_cast(base_allocator);
+
   // TODO(benvanik): check to ensure the allocator can serve the memory type.
 
   // All buffers can be allocated on the heap.
   iree_hal_buffer_compatibility_t compatibility =
       IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE;
 
+  // Host allocations can be imported with VK_EXT_external_memory_host.
+  // Whether a particular allocation can be imported depends on its alignment
+  // and is only known once imported.
+  if (allocator->min_imported_host_pointer_alignment) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE;
+  }
+
   if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
     compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
   }
@@ -600,6 +677,15 @@ iree_hal_vulkan_vma_allocator_query_buffer_compatibility(
     }
   }
 
+  // On unified memory systems device-local memory is host-visible: allocate
+  // it that way so that initial data, uploads, and readbacks can be performed
+  // with a mapped memcpy instead of a staging buffer and queue submission.
+  if (allocator->unified_memory &&
+      iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
+    params->type |= IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params->usage |= IREE_HAL_BUFFER_USAGE_MAPPING;
+  }
+
   // We are now optimal.
   params->type &= ~IREE_HAL_MEMORY_TYPE_OPTIMAL;
 
@@ -637,9 +723,18 @@ static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
     buffer_create_info.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     buffer_create_info.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
   }
-  buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-  buffer_create_info.queueFamilyIndexCount = 0;
-  buffer_create_info.pQueueFamilyIndices = NULL;
+  if (allocator->queue_family_count > 1) {
+    // Transfers may run on a dedicated transfer queue family while dispatches
+    // run on the compute family; concurrent sharing lets both access the
+    // buffer without explicit ownership transfers.
+    buffer_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    buffer_create_info.queueFamilyIndexCount = allocator->queue_family_count;
+    buffer_create_info.pQueueFamilyIndices = allocator->queue_family_indices;
+  } else {
+    buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    buffer_create_info.queueFamilyIndexCount = 0;
+    buffer_create_info.pQueueFamilyIndices = NULL;
+  }
 
   VmaAllocationCreateInfo allocation_create_info;
   allocation_create_info.flags = flags;
@@ -653,8 +748,14 @@ static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
     if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
       // Device-local, host-visible.
       allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-      allocation_create_info.preferredFlags |=
-          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+      if (allocator->unified_memory) {
+        // Never fall back to host-local memory; it always exists here.
+        allocation_create_info.requiredFlags |=
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+      } else {
+        allocation_create_info.preferredFlags |=
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+      }
     } else {
       // Device-local only.
       allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -681,9 +782,6 @@ static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
     allocation_create_info.requiredFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
   }
 
-  // TODO(benvanik): if on a unified memory system and initial data is present
-  // we could set the mapping bit and ensure a much more efficient upload.
-
   VkBuffer handle = VK_NULL_HANDLE;
   VmaAllocation allocation = VK_NULL_HANDLE;
   VmaAllocationInfo allocation_info;
@@ -704,9 +802,30 @@ static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
     return status;
   }
 
-  // Copy the initial contents into the buffer. This may require staging.
+  // Copy the initial contents into the buffer. If the memory is host-visible
+  // (always the case on unified memory systems) we write it directly and
+  // otherwise we need to stage it through the device.
+  const VkPhysicalDeviceMemoryProperties* memory_props = NULL;
+  vmaGetMemoryProperties(allocator->vma, &memory_props);
+  const bool is_host_visible = iree_all_bits_set(
+      memory_props->memoryTypes[allocation_info.memoryType].propertyFlags,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
   if (iree_status_is_ok(status) &&
-      !iree_const_byte_span_is_empty(initial_data)) {
+      !iree_const_byte_span_is_empty(initial_data) && is_host_visible) {
+    void* mapped_ptr = NULL;
+    status = VK_RESULT_TO_STATUS(
+        vmaMapMemory(allocator->vma, allocation, &mapped_ptr), "vmaMapMemory");
+    if (iree_status_is_ok(status)) {
+      memcpy(mapped_ptr, initial_data.data, initial_data.data_length);
+      // No-op if the memory is host-coherent.
+      status = VK_RESULT_TO_STATUS(
+          vmaFlushAllocation(allocator->vma, allocation, 0,
+                             initial_data.data_length),
+          "vmaFlushAllocation");
+      vmaUnmapMemory(allocator->vma, allocation);
+    }
+  } else if (iree_status_is_ok(status) &&
+             !iree_const_byte_span_is_empty(initial_data)) {
     status = iree_hal_device_transfer_range(
         allocator->device,
         iree_hal_make_host_transfer_buffer_span((void*)initial_data.data,
@@ -755,15 +874,201 @@ static void iree_hal_vulkan_vma_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+// Imports a host allocation with VK_EXT_external_memory_host.
+// The pointer and size must be aligned to minImportedHostPointerAlignment and
+// the driver must expose a host-coherent memory type able to import it.
+static iree_status_t iree_hal_vulkan_vma_allocator_import_host_allocation(
+    iree_hal_vulkan_vma_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params, void* host_ptr,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  VkDeviceHandle* logical_device = allocator->logical_device;
+  const auto& syms = logical_device->syms();
+
+  const VkDeviceSize alignment = allocator->min_imported_host_pointer_alignment;
+  if (!alignment) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "importing host allocations requires VK_EXT_external_memory_host");
+  } else if (((uintptr_t)host_ptr % alignment) != 0 ||
+             (allocation_size % alignment) != 0) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "host allocation %p (%" PRIu64
+        " bytes) is not aligned to the minimum import alignment of %" PRIu64,
+        host_ptr, (uint64_t)allocation_size, (uint64_t)alignment);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  // Query which memory types can import the pointer.
+  VkMemoryHostPointerPropertiesEXT host_pointer_props;
+  memset(&host_pointer_props, 0, sizeof(host_pointer_props));
+  host_pointer_props.sType =
+      VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, VK_RESULT_TO_STATUS(
+              syms->vkGetMemoryHostPointerPropertiesEXT(
+                  *logical_device,
+                  VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+                  host_ptr, &host_pointer_props),
+              "vkGetMemoryHostPointerPropertiesEXT"));
+
+  VkExternalMemoryBufferCreateInfo external_create_info;
+  external_create_info.sType =
+      VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+  external_create_info.pNext = NULL;
+  external_create_info.handleTypes =
+      VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+  VkBufferCreateInfo buffer_create_info;
+  buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  buffer_create_info.pNext = &external_create_info;
+  buffer_create_info.flags = 0;
+  buffer_create_info.size = allocation_size;
+  buffer_create_info.usage =
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  if (iree_all_bits_set(params->usage,
+                        IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE)) {
+    buffer_create_info.usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buffer_create_info.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    buffer_create_info.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+  }
+  if (allocator->queue_family_count > 1) {
+    buffer_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    buffer_create_info.queueFamilyIndexCount = allocator->queue_family_count;
+    buffer_create_info.pQueueFamilyIndices = allocator->queue_family_indices;
+  } else {
+    buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    buffer_create_info.queueFamilyIndexCount = 0;
+    buffer_create_info.pQueueFamilyIndices = NULL;
+  }
+  VkBuffer handle = VK_NULL_HANDLE;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, VK_RESULT_TO_STATUS(
+              syms->vkCreateBuffer(*logical_device, &buffer_create_info,
+                                   logical_device->allocator(), &handle),
+              "vkCreateBuffer"));
+  VkMemoryRequirements requirements;
+  syms->vkGetBufferMemoryRequirements(*logical_device, handle, &requirements);
+
+  // Pick a host-coherent memory type compatible with both the pointer and the
+  // buffer, preferring device-local types (unified memory) when requested.
+  // Imported memory is never flushed or invalidated so coherency is required.
+  const VkPhysicalDeviceMemoryProperties* memory_props = NULL;
+  vmaGetMemoryProperties(allocator->vma, &memory_props);
+  const VkMemoryPropertyFlags required_flags =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  const bool wants_device_local =
+      iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL);
+  const uint32_t memory_type_bits =
+      host_pointer_props.memoryTypeBits & requirements.memoryTypeBits;
+  int memory_type_index = -1;
+  for (uint32_t i = 0; i < memory_props->memoryTypeCount; ++i) {
+    if (!(memory_type_bits & (1u << i))) continue;
+    VkMemoryPropertyFlags flags = memory_props->memoryTypes[i].propertyFlags;
+    if (!iree_all_bits_set(flags, required_flags)) continue;
+    bool is_device_local =
+        iree_all_bits_set(flags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (wants_device_local && !is_device_local) continue;
+    memory_type_index = (int)i;
+    if (is_device_local) break;
+  }
+  iree_status_t status = iree_ok_status();
+  if (memory_type_index == -1) {
+    status = iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "no %shost-coherent memory type can import the host allocation",
+        wants_device_local ? "device-local " : "");
+  }
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  if (iree_status_is_ok(status)) {
+    VkImportMemoryHostPointerInfoEXT import_info;
+    import_info.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+    import_info.pNext = NULL;
+    import_info.handleType =
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    import_info.pHostPointer = host_ptr;
+    VkMemoryAllocateInfo allocate_info;
+    allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocate_info.pNext = &import_info;
+    allocate_info.allocationSize = iree_max(allocation_size, requirements.size);
+    allocate_info.memoryTypeIndex = (uint32_t)memory_type_index;
+    status = VK_RESULT_TO_STATUS(
+        syms->vkAllocateMemory(*logical_device, &allocate_info,
+                               logical_device->allocator(), &memory),
+        "vkAllocateMemory");
+  }
+  if (iree_status_is_ok(status)) {
+    status = VK_RESULT_TO_STATUS(
+        syms->vkBindBufferMemory(*logical_device, handle, memory, 0),
+        "vkBindBufferMemory");
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_memory_type_t memory_type =
+        IREE_HAL_MEMORY_TYPE_HOST_VISIBLE | IREE_HAL_MEMORY_TYPE_HOST_COHERENT |
+        IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    VkMemoryPropertyFlags flags =
+        memory_props->memoryTypes[memory_type_index].propertyFlags;
+    memory_type |= iree_all_bits_set(flags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                       ? IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL
+                       : IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    if (iree_all_bits_set(flags, VK_MEMORY_PROPERTY_HOST_CACHED_BIT)) {
+      memory_type |= IREE_HAL_MEMORY_TYPE_HOST_CACHED;
+    }
+    status = iree_hal_vulkan_vma_buffer_wrap_imported(
+        (iree_hal_allocator_t*)allocator, memory_type, params->access,
+        params->usage | IREE_HAL_BUFFER_USAGE_MAPPING,
+        allocation_size, logical_device, handle, memory, host_ptr,
+        release_callback, out_buffer);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    if (memory != VK_NULL_HANDLE) {
+      syms->vkFreeMemory(*logical_device, memory, logical_device->allocator());
+    }
+    syms->vkDestroyBuffer(*logical_device, handle, logical_device->allocator());
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_vulkan_vma_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
     iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
     iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(#7242): use VK_EXT_external_memory_host to import memory.
-  return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                          "importing from external buffers not supported");
+  iree_hal_vulkan_vma_allocator_t* allocator =
+      iree_hal_vulkan_vma_allocator_cast(base_allocator);
+
+  // Coerce options into those required by the current device.
+  iree_hal_buffer_params_t compat_params = *params;
+  iree_device_size_t allocation_size = external_buffer->size;
+  iree_hal_buffer_compatibility_t compatibility =
+      iree_hal_vulkan_vma_allocator_query_buffer_compatibility(
+          base_allocator, &compat_params, &allocation_size);
+  if (!iree_all_bits_set(compatibility,
+                         IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot import a buffer with the given parameters");
+  }
+
+  switch (external_buffer->type) {
+    case IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION:
+      return iree_hal_vulkan_vma_allocator_import_host_allocation(
+          allocator, &compat_params,
+          external_buffer->handle.host_allocation.ptr, external_buffer->size,
+          release_callback, out_buffer);
+    default:
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "external buffer type %d not supported",
+                              (int)external_buffer->type);
+  }
 }
 
 static iree_status_t iree_hal_vulkan_vma_allocator_export_buffer(
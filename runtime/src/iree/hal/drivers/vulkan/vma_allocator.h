@@ -33,10 +33,16 @@ extern "C" {
 // More information:
 //   https://github.com/GPUOpen-LibrariesAndSDKs/VulkanMemoryAllocator
 //   https://gpuopen-librariesandsdks.github.io/VulkanMemoryAllocator/html/
+//
+// Buffers are shared concurrently between the queue families of
+// |compute_queue_set| and |transfer_queue_set| when they differ so that they
+// can be used from either without queue family ownership transfers.
 iree_status_t iree_hal_vulkan_vma_allocator_create(
     const iree_hal_vulkan_device_options_t* options, VkInstance instance,
     VkPhysicalDevice physical_device,
     iree::hal::vulkan::VkDeviceHandle* logical_device,
+    const iree_hal_vulkan_queue_set_t* compute_queue_set,
+    const iree_hal_vulkan_queue_set_t* transfer_queue_set,
     iree_hal_device_t* device, iree_hal_allocator_t** out_allocator);
 
 #ifdef __cplusplus
@@ -25,6 +25,12 @@ typedef struct iree_hal_vulkan_vma_buffer_t {
   VkBuffer handle;
   VmaAllocation allocation;
   VmaAllocationInfo allocation_info;
+
+  // Set when wrapping imported host memory instead of a VMA allocation.
+  iree::hal::vulkan::VkDeviceHandle* logical_device;
+  VkDeviceMemory imported_memory;
+  void* host_ptr;
+  iree_hal_buffer_release_callback_t release_callback;
 } iree_hal_vulkan_vma_buffer_t;
 
 namespace {
@@ -66,6 +72,10 @@ iree_status_t iree_hal_vulkan_vma_buffer_wrap(
     buffer->handle = handle;
     buffer->allocation = allocation;
     buffer->allocation_info = allocation_info;
+    buffer->logical_device = NULL;
+    buffer->imported_memory = VK_NULL_HANDLE;
+    buffer->host_ptr = NULL;
+    buffer->release_callback = iree_hal_buffer_release_callback_null();
 
     // TODO(benvanik): set debug name instead and use the
     //     VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT flag.
@@ -83,6 +93,49 @@ iree_status_t iree_hal_vulkan_vma_buffer_wrap(
   return iree_ok_status();
 }
 
+iree_status_t iree_hal_vulkan_vma_buffer_wrap_imported(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree::hal::vulkan::VkDeviceHandle* logical_device, VkBuffer handle,
+    VkDeviceMemory memory, void* host_ptr,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(memory);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(allocator);
+  iree_hal_vulkan_vma_buffer_t* buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(
+        host_allocator, allocator, &buffer->base, allocation_size,
+        /*byte_offset=*/0, /*byte_length=*/allocation_size, memory_type,
+        allowed_access, allowed_usage, &iree_hal_vulkan_vma_buffer_vtable,
+        &buffer->base);
+    buffer->vma = VK_NULL_HANDLE;
+    buffer->handle = handle;
+    buffer->allocation = VK_NULL_HANDLE;
+    memset(&buffer->allocation_info, 0, sizeof(buffer->allocation_info));
+    buffer->logical_device = logical_device;
+    buffer->logical_device->AddReference();
+    buffer->imported_memory = memory;
+    buffer->host_ptr = host_ptr;
+    buffer->release_callback = release_callback;
+    *out_buffer = &buffer->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_hal_vulkan_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
@@ -91,10 +144,24 @@ static void iree_hal_vulkan_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
   IREE_TRACE_ZONE_APPEND_VALUE(
       z0, (int64_t)iree_hal_buffer_allocation_size(base_buffer));
 
-  IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_VMA_ALLOCATOR_ID,
-                        (void*)buffer->handle);
-
-  vmaDestroyBuffer(buffer->vma, buffer->handle, buffer->allocation);
+  if (buffer->imported_memory != VK_NULL_HANDLE) {
+    // Imported host memory: the Vulkan objects are ours but the host
+    // allocation is returned to its owner.
+    auto* logical_device = buffer->logical_device;
+    logical_device->syms()->vkDestroyBuffer(*logical_device, buffer->handle,
+                                            logical_device->allocator());
+    logical_device->syms()->vkFreeMemory(
+        *logical_device, buffer->imported_memory, logical_device->allocator());
+    logical_device->ReleaseReference();
+    if (buffer->release_callback.fn) {
+      buffer->release_callback.fn(buffer->release_callback.user_data,
+                                  base_buffer);
+    }
+  } else {
+    IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_VMA_ALLOCATOR_ID,
+                          (void*)buffer->handle);
+    vmaDestroyBuffer(buffer->vma, buffer->handle, buffer->allocation);
+  }
   iree_allocator_free(host_allocator, buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -123,9 +190,14 @@ static iree_status_t iree_hal_vulkan_vma_buffer_map_range(
                                      IREE_HAL_BUFFER_USAGE_MAPPING));
 
   uint8_t* data_ptr = nullptr;
-  VK_RETURN_IF_ERROR(
-      vmaMapMemory(buffer->vma, buffer->allocation, (void**)&data_ptr),
-      "vmaMapMemory");
+  if (buffer->host_ptr) {
+    // Imported host memory is always accessible at its original address.
+    data_ptr = (uint8_t*)buffer->host_ptr;
+  } else {
+    VK_RETURN_IF_ERROR(
+        vmaMapMemory(buffer->vma, buffer->allocation, (void**)&data_ptr),
+        "vmaMapMemory");
+  }
   mapping->contents =
       iree_make_byte_span(data_ptr + local_byte_offset, local_byte_length);
 
@@ -147,6 +219,7 @@ static iree_status_t iree_hal_vulkan_vma_buffer_unmap_range(
     iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
+  if (buffer->host_ptr) return iree_ok_status();
   vmaUnmapMemory(buffer->vma, buffer->allocation);
   return iree_ok_status();
 }
@@ -156,6 +229,7 @@ static iree_status_t iree_hal_vulkan_vma_buffer_invalidate_range(
     iree_device_size_t local_byte_length) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
+  if (buffer->host_ptr) return iree_ok_status();  // always coherent
   VK_RETURN_IF_ERROR(
       vmaInvalidateAllocation(buffer->vma, buffer->allocation,
                               local_byte_offset, local_byte_length),
@@ -168,6 +242,7 @@ static iree_status_t iree_hal_vulkan_vma_buffer_flush_range(
     iree_device_size_t local_byte_length) {
   iree_hal_vulkan_vma_buffer_t* buffer =
       iree_hal_vulkan_vma_buffer_cast(base_buffer);
+  if (buffer->host_ptr) return iree_ok_status();  // always coherent
   VK_RETURN_IF_ERROR(vmaFlushAllocation(buffer->vma, buffer->allocation,
                                         local_byte_offset, local_byte_length),
                      "vmaFlushAllocation");
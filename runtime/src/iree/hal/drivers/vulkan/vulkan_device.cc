@@ -27,8 +27,11 @@
 #include "iree/hal/drivers/vulkan/native_pipeline_layout.h"
 #include "iree/hal/drivers/vulkan/native_semaphore.h"
 #include "iree/hal/drivers/vulkan/nop_executable_cache.h"
+#include "iree/hal/drivers/vulkan/pipeline_cache.h"
 #include "iree/hal/drivers/vulkan/status_util.h"
+#include "iree/hal/drivers/vulkan/timestamp_profiler.h"
 #include "iree/hal/drivers/vulkan/tracing.h"
+#include "iree/hal/drivers/vulkan/transient_pool.h"
 #include "iree/hal/drivers/vulkan/util/arena.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
 #include "iree/hal/drivers/vulkan/vma_allocator.h"
@@ -198,6 +201,13 @@ IREE_API_EXPORT iree_status_t iree_hal_vulkan_query_extensibility_set(
   ADD_EXT(IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
           VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
 
+  // VK_EXT_external_memory_host:
+  // Allows host allocations to be imported as device-visible buffers without
+  // copies. Depends on VK_KHR_external_memory which was promoted to core in
+  // Vulkan 1.1.
+  ADD_EXT(IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
+          VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+
   //===--------------------------------------------------------------------===//
   // Vulkan forward-compatibility shims
   //===--------------------------------------------------------------------===//
@@ -220,6 +230,12 @@ IREE_API_EXPORT iree_status_t iree_hal_vulkan_query_extensibility_set(
   ADD_EXT(IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
           VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME);
 
+  // VK_KHR_cooperative_matrix:
+  // Exposes subgroup-scope matrix multiply-accumulate operations (tensor
+  // cores and the like) that the compiler can target when available.
+  ADD_EXT(IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
+          VK_KHR_COOPERATIVE_MATRIX_EXTENSION_NAME);
+
   //===--------------------------------------------------------------------===//
   // Optional debugging features
   //===--------------------------------------------------------------------===//
@@ -433,7 +449,7 @@ static iree_status_t iree_hal_vulkan_build_queue_sets(
   uint32_t base_queue_index = 0;
   if (queue_family_info.dispatch_index == queue_family_info.transfer_index) {
     // Sharing a family, so transfer queues follow compute queues.
-    base_queue_index = queue_family_info.dispatch_index;
+    base_queue_index = queue_family_info.dispatch_queue_count;
   }
   for (iree_host_size_t i = 0; i < queue_family_info.transfer_queue_count;
        ++i) {
@@ -443,6 +459,178 @@ static iree_status_t iree_hal_vulkan_build_queue_sets(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Device capabilities
+//===----------------------------------------------------------------------===//
+
+// Maximum number of cooperative matrix configurations retained per device.
+// Drivers report a few dozen at most; any beyond this are ignored.
+#define IREE_HAL_VULKAN_MAX_COOPERATIVE_MATRIX_COUNT 64
+
+// A subgroup-scope cooperative matrix configuration supported by the device.
+typedef struct iree_hal_vulkan_cooperative_matrix_t {
+  uint32_t m_size;
+  uint32_t n_size;
+  uint32_t k_size;
+  VkComponentTypeKHR a_type;
+  VkComponentTypeKHR b_type;
+  VkComponentTypeKHR c_type;
+  VkComponentTypeKHR result_type;
+} iree_hal_vulkan_cooperative_matrix_t;
+
+// Compute capabilities of the physical device reported through query_i64 so
+// that executable variants can be selected against the actual hardware
+// instead of the most conservative target environment.
+typedef struct iree_hal_vulkan_device_capabilities_t {
+  // Default subgroup size and the range pipelines may request.
+  uint32_t subgroup_size;
+  uint32_t min_subgroup_size;
+  uint32_t max_subgroup_size;
+  // True if compute pipelines may require a subgroup size within the range.
+  bool subgroup_size_control;
+  // True if cooperative matrix operations are enabled on the device.
+  bool cooperative_matrix;
+  iree_host_size_t cooperative_matrix_count;
+  iree_hal_vulkan_cooperative_matrix_t
+      cooperative_matrices[IREE_HAL_VULKAN_MAX_COOPERATIVE_MATRIX_COUNT];
+} iree_hal_vulkan_device_capabilities_t;
+
+// Queries the capabilities of |physical_device| available with the
+// |device_extensions| enabled on it. Features required by the extensions are
+// assumed to be enabled along with them.
+static void iree_hal_vulkan_query_device_capabilities(
+    DynamicSymbols* syms, VkPhysicalDevice physical_device,
+    const iree_hal_vulkan_device_extensions_t* device_extensions,
+    iree_hal_vulkan_device_capabilities_t* out_capabilities) {
+  memset(out_capabilities, 0, sizeof(*out_capabilities));
+
+  VkPhysicalDeviceSubgroupSizeControlProperties subgroup_control_properties;
+  memset(&subgroup_control_properties, 0, sizeof(subgroup_control_properties));
+  subgroup_control_properties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_PROPERTIES;
+  VkPhysicalDeviceSubgroupProperties subgroup_properties;
+  memset(&subgroup_properties, 0, sizeof(subgroup_properties));
+  subgroup_properties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+  if (device_extensions->subgroup_size_control) {
+    subgroup_properties.pNext = &subgroup_control_properties;
+  }
+  VkPhysicalDeviceProperties2 properties2;
+  memset(&properties2, 0, sizeof(properties2));
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &subgroup_properties;
+  syms->vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+
+  out_capabilities->subgroup_size = subgroup_properties.subgroupSize;
+  out_capabilities->min_subgroup_size = subgroup_properties.subgroupSize;
+  out_capabilities->max_subgroup_size = subgroup_properties.subgroupSize;
+  if (device_extensions->subgroup_size_control &&
+      iree_all_bits_set(subgroup_control_properties.requiredSubgroupSizeStages,
+                        VK_SHADER_STAGE_COMPUTE_BIT)) {
+    out_capabilities->subgroup_size_control = true;
+    out_capabilities->min_subgroup_size =
+        subgroup_control_properties.minSubgroupSize;
+    out_capabilities->max_subgroup_size =
+        subgroup_control_properties.maxSubgroupSize;
+  }
+
+  if (!device_extensions->cooperative_matrix ||
+      !syms->vkGetPhysicalDeviceCooperativeMatrixPropertiesKHR) {
+    return;
+  }
+  out_capabilities->cooperative_matrix = true;
+  uint32_t property_count = 0;
+  if (syms->vkGetPhysicalDeviceCooperativeMatrixPropertiesKHR(
+          physical_device, &property_count, NULL) != VK_SUCCESS) {
+    return;
+  }
+  property_count = iree_min(property_count,
+                            IREE_HAL_VULKAN_MAX_COOPERATIVE_MATRIX_COUNT);
+  VkCooperativeMatrixPropertiesKHR* properties =
+      (VkCooperativeMatrixPropertiesKHR*)iree_alloca(property_count *
+                                                     sizeof(*properties));
+  for (uint32_t i = 0; i < property_count; ++i) {
+    memset(&properties[i], 0, sizeof(properties[i]));
+    properties[i].sType = VK_STRUCTURE_TYPE_COOPERATIVE_MATRIX_PROPERTIES_KHR;
+  }
+  // VK_INCOMPLETE is returned if we truncated the list.
+  VkResult result = syms->vkGetPhysicalDeviceCooperativeMatrixPropertiesKHR(
+      physical_device, &property_count, properties);
+  if (result != VK_SUCCESS && result != VK_INCOMPLETE) return;
+  for (uint32_t i = 0; i < property_count; ++i) {
+    // Only subgroup-scope operations are produced by the compiler.
+    if (properties[i].scope != VK_SCOPE_SUBGROUP_KHR) continue;
+    iree_hal_vulkan_cooperative_matrix_t* matrix =
+        &out_capabilities->cooperative_matrices
+             [out_capabilities->cooperative_matrix_count++];
+    matrix->m_size = properties[i].MSize;
+    matrix->n_size = properties[i].NSize;
+    matrix->k_size = properties[i].KSize;
+    matrix->a_type = properties[i].AType;
+    matrix->b_type = properties[i].BType;
+    matrix->c_type = properties[i].CType;
+    matrix->result_type = properties[i].ResultType;
+  }
+}
+
+// Returns the MLIR-style name of a cooperative matrix component |type|.
+static const char* iree_hal_vulkan_component_type_name(
+    VkComponentTypeKHR type) {
+  switch (type) {
+    case VK_COMPONENT_TYPE_FLOAT16_KHR:
+      return "f16";
+    case VK_COMPONENT_TYPE_FLOAT32_KHR:
+      return "f32";
+    case VK_COMPONENT_TYPE_FLOAT64_KHR:
+      return "f64";
+    case VK_COMPONENT_TYPE_SINT8_KHR:
+      return "i8";
+    case VK_COMPONENT_TYPE_SINT16_KHR:
+      return "i16";
+    case VK_COMPONENT_TYPE_SINT32_KHR:
+      return "i32";
+    case VK_COMPONENT_TYPE_SINT64_KHR:
+      return "i64";
+    case VK_COMPONENT_TYPE_UINT8_KHR:
+      return "ui8";
+    case VK_COMPONENT_TYPE_UINT16_KHR:
+      return "ui16";
+    case VK_COMPONENT_TYPE_UINT32_KHR:
+      return "ui32";
+    case VK_COMPONENT_TYPE_UINT64_KHR:
+      return "ui64";
+    default:
+      return "unknown";
+  }
+}
+
+// Returns true if |capabilities| includes the cooperative matrix configuration
+// named by |key| in the form `MxNxK_A_B_C_Result`, for example
+// `16x16x16_f16_f16_f32_f32`.
+static bool iree_hal_vulkan_device_capabilities_has_cooperative_matrix(
+    const iree_hal_vulkan_device_capabilities_t* capabilities,
+    iree_string_view_t key) {
+  for (iree_host_size_t i = 0; i < capabilities->cooperative_matrix_count;
+       ++i) {
+    const iree_hal_vulkan_cooperative_matrix_t* matrix =
+        &capabilities->cooperative_matrices[i];
+    char name[64];
+    int name_length = snprintf(
+        name, sizeof(name), "%ux%ux%u_%s_%s_%s_%s", matrix->m_size,
+        matrix->n_size, matrix->k_size,
+        iree_hal_vulkan_component_type_name(matrix->a_type),
+        iree_hal_vulkan_component_type_name(matrix->b_type),
+        iree_hal_vulkan_component_type_name(matrix->c_type),
+        iree_hal_vulkan_component_type_name(matrix->result_type));
+    if (name_length > 0 && (size_t)name_length < sizeof(name) &&
+        iree_string_view_equal(key,
+                               iree_make_string_view(name, name_length))) {
+      return true;
+    }
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_vulkan_device_t
 //===----------------------------------------------------------------------===//
@@ -459,6 +647,8 @@ typedef struct iree_hal_vulkan_device_t {
   iree_hal_vulkan_device_flags_t flags;
   // Which optional extensions are active and available on the device.
   iree_hal_vulkan_device_extensions_t device_extensions;
+  // Compute capabilities reported through query_i64.
+  iree_hal_vulkan_device_capabilities_t capabilities;
 
   VkInstance instance;
   VkPhysicalDevice physical_device;
@@ -467,6 +657,9 @@ typedef struct iree_hal_vulkan_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Pool used for queue-ordered transient allocations; NULL if disabled.
+  iree_hal_vulkan_transient_pool_t* transient_pool;
+
   // All queues available on the device; the device owns these.
   iree_host_size_t queue_count;
   CommandQueue** queues;
@@ -482,6 +675,12 @@ typedef struct iree_hal_vulkan_device_t {
   // |queue_count| tracing contexts, if tracing is enabled.
   iree_hal_vulkan_tracing_context_t** queue_tracing_contexts;
 
+  // Queue family of |dispatch_queues|.
+  uint32_t dispatch_queue_family_index;
+  // Dispatch timing profiler active between profiling_begin and
+  // profiling_end, if any.
+  iree_hal_vulkan_timestamp_profiler_t* profiler;
+
   DescriptorPoolCache* descriptor_pool_cache;
 
   VkCommandPoolHandle* dispatch_command_pool;
@@ -493,6 +692,10 @@ typedef struct iree_hal_vulkan_device_t {
 
   BuiltinExecutables* builtin_executables;
 
+  // Pipeline cache shared by all executables and persisted across runs.
+  // NULL if persistence is disabled.
+  iree_hal_vulkan_pipeline_cache_t* pipeline_cache;
+
 #if defined(IREE_HAL_VULKAN_HAVE_RENDERDOC)
   RENDERDOC_API_LATEST* renderdoc_api;
 #endif  // IREE_HAL_VULKAN_HAVE_RENDERDOC
@@ -513,6 +716,8 @@ IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
   memset(out_options, 0, sizeof(*out_options));
   out_options->flags = 0;
   out_options->large_heap_block_size = 64 * 1024 * 1024;
+  out_options->pipeline_cache_dir = iree_string_view_empty();
+  out_options->transient_block_size = 64 * 1024 * 1024;
 }
 
 // Creates a transient command pool for the given queue family.
@@ -569,11 +774,11 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
   // the tracing subsystem for query and cleanup tasks.
   VkQueue maintenance_dispatch_queue = VK_NULL_HANDLE;
 
-  uint64_t compute_queue_count =
-      iree_math_count_ones_u64(compute_queue_set->queue_indices);
   uint64_t transfer_queue_count =
       iree_math_count_ones_u64(transfer_queue_set->queue_indices);
-  for (iree_host_size_t i = 0; i < compute_queue_count; ++i) {
+  // NOTE: queue indices within a family may not start at 0 (transfer queues
+  // sharing a family with compute queues follow them) so all bits are scanned.
+  for (iree_host_size_t i = 0; i < 64; ++i) {
     if (!(compute_queue_set->queue_indices & (1ull << i))) continue;
 
     char queue_name_buffer[32];
@@ -611,7 +816,7 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
       queue->set_tracing_context(device->queue_tracing_contexts[queue_index]);
     }
   }
-  for (iree_host_size_t i = 0; i < transfer_queue_count; ++i) {
+  for (iree_host_size_t i = 0; i < 64; ++i) {
     if (!(transfer_queue_set->queue_indices & (1ull << i))) continue;
 
     char queue_name_buffer[32];
@@ -684,6 +889,10 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
   device->physical_device = physical_device;
   device->logical_device = logical_device;
   device->logical_device->AddReference();
+  device->dispatch_queue_family_index = compute_queue_set->queue_family_index;
+  iree_hal_vulkan_query_device_capabilities(
+      logical_device->syms().get(), physical_device, device_extensions,
+      &device->capabilities);
 
 #if defined(IREE_HAL_VULKAN_HAVE_RENDERDOC)
   device->renderdoc_api = iree_hal_vulkan_query_renderdoc_api(instance);
@@ -710,8 +919,15 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
   // Create the device memory allocator that will service all buffer
   // allocation requests.
   iree_status_t status = iree_hal_vulkan_vma_allocator_create(
-      options, instance, physical_device, logical_device,
-      (iree_hal_device_t*)device, &device->device_allocator);
+      options, instance, physical_device, logical_device, compute_queue_set,
+      transfer_queue_set, (iree_hal_device_t*)device,
+      &device->device_allocator);
+
+  if (iree_status_is_ok(status) && options->transient_block_size > 0) {
+    status = iree_hal_vulkan_transient_pool_create(
+        device->device_allocator, options->transient_block_size,
+        host_allocator, &device->transient_pool);
+  }
 
   // Create command pools for each queue family. If we don't have a transfer
   // queue then we'll ignore that one and just use the dispatch pool.
@@ -744,6 +960,13 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
     status = device->builtin_executables->InitializeExecutables();
   }
 
+  if (iree_status_is_ok(status) &&
+      !iree_string_view_is_empty(options->pipeline_cache_dir)) {
+    status = iree_hal_vulkan_pipeline_cache_create(
+        device->logical_device, physical_device, options->pipeline_cache_dir,
+        &device->pipeline_cache);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -763,6 +986,14 @@ static void iree_hal_vulkan_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_vulkan_tracing_context_free(device->queue_tracing_contexts[i]);
   }
 
+  // Finish any profile that was never ended; all work has completed above.
+  if (device->profiler) {
+    iree_status_ignore(
+        iree_hal_vulkan_timestamp_profiler_end(device->profiler));
+    iree_hal_vulkan_timestamp_profiler_release(device->profiler);
+    device->profiler = NULL;
+  }
+
   // Drop command pools now that we know there are no more outstanding command
   // buffers.
   delete device->dispatch_command_pool;
@@ -773,6 +1004,21 @@ static void iree_hal_vulkan_device_destroy(iree_hal_device_t* base_device) {
   delete device->builtin_executables;
   delete device->descriptor_pool_cache;
 
+  // Persist any pipelines compiled during this run. Failing to write the cache
+  // only costs compilation time on the next run so it is not fatal.
+  if (device->pipeline_cache) {
+    iree_status_ignore(
+        iree_hal_vulkan_pipeline_cache_save(device->pipeline_cache));
+    iree_hal_vulkan_pipeline_cache_destroy(device->pipeline_cache);
+  }
+
+  // Pending queue deallocations hold semaphores that must not outlive the
+  // device. Transient buffers still live keep the pool alive.
+  if (device->transient_pool) {
+    iree_hal_vulkan_transient_pool_drop_pending(device->transient_pool);
+    iree_hal_vulkan_transient_pool_release(device->transient_pool);
+  }
+
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
 
@@ -932,6 +1178,19 @@ iree_status_t iree_hal_vulkan_device_create(
     subgroup_control_features.subgroupSizeControl = VK_TRUE;
   }
 
+  // The cooperativeMatrix feature is required by the extension so it is
+  // always available when the extension is.
+  VkPhysicalDeviceCooperativeMatrixFeaturesKHR cooperative_matrix_features;
+  if (enabled_device_extensions.cooperative_matrix) {
+    memset(&cooperative_matrix_features, 0,
+           sizeof(cooperative_matrix_features));
+    cooperative_matrix_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_COOPERATIVE_MATRIX_FEATURES_KHR;
+    cooperative_matrix_features.pNext = features2.pNext;
+    features2.pNext = &cooperative_matrix_features;
+    cooperative_matrix_features.cooperativeMatrix = VK_TRUE;
+  }
+
   auto logical_device = new VkDeviceHandle(
       instance_syms, enabled_device_extensions,
       /*owns_device=*/true, host_allocator, /*allocator=*/NULL);
@@ -1051,14 +1310,16 @@ static iree_status_t iree_hal_vulkan_device_trim(
     iree_hal_device_t* base_device) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
   iree_arena_block_pool_trim(&device->block_pool);
+  if (device->transient_pool) {
+    iree_hal_vulkan_transient_pool_trim(device->transient_pool);
+  }
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
 static iree_status_t iree_hal_vulkan_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
-  // iree_hal_vulkan_device_t* device =
-  //     iree_hal_vulkan_device_cast(base_device);
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
   *out_value = 0;
 
   if (iree_string_view_equal(category,
@@ -1068,6 +1329,53 @@ static iree_status_t iree_hal_vulkan_device_query_i64(
             ? 1
             : 0;
     return iree_ok_status();
+  } else if (iree_string_view_equal(category, IREE_SV("vulkan.transient"))) {
+    iree_hal_suballocator_statistics_t statistics;
+    memset(&statistics, 0, sizeof(statistics));
+    if (device->transient_pool) {
+      iree_hal_vulkan_transient_pool_query_statistics(device->transient_pool,
+                                                      &statistics);
+    }
+    if (iree_string_view_equal(key, IREE_SV("reserved_size"))) {
+      *out_value = (int64_t)statistics.reserved_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("allocated_size"))) {
+      *out_value = (int64_t)statistics.allocated_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("peak_allocated_size"))) {
+      *out_value = (int64_t)statistics.peak_allocated_size;
+      return iree_ok_status();
+    }
+  } else if (iree_string_view_equal(category, IREE_SV("vulkan.subgroup"))) {
+    const iree_hal_vulkan_device_capabilities_t* capabilities =
+        &device->capabilities;
+    if (iree_string_view_equal(key, IREE_SV("size"))) {
+      *out_value = (int64_t)capabilities->subgroup_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("min_size"))) {
+      *out_value = (int64_t)capabilities->min_subgroup_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("max_size"))) {
+      *out_value = (int64_t)capabilities->max_subgroup_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("size_control"))) {
+      *out_value = capabilities->subgroup_size_control ? 1 : 0;
+      return iree_ok_status();
+    }
+  } else if (iree_string_view_equal(category,
+                                    IREE_SV("vulkan.cooperative_matrix"))) {
+    // `supported` reports whether the extension is enabled; any other key is
+    // a configuration such as `16x16x16_f16_f16_f32_f32` and reports whether
+    // the device supports it.
+    if (iree_string_view_equal(key, IREE_SV("supported"))) {
+      *out_value = device->capabilities.cooperative_matrix ? 1 : 0;
+    } else {
+      *out_value = iree_hal_vulkan_device_capabilities_has_cooperative_matrix(
+                       &device->capabilities, key)
+                       ? 1
+                       : 0;
+    }
+    return iree_ok_status();
   }
 
   return iree_make_status(
@@ -1076,27 +1384,45 @@ static iree_status_t iree_hal_vulkan_device_query_i64(
       (int)category.size, category.data, (int)key.size, key.data);
 }
 
+// Returns the categories command buffers requesting |command_categories| will
+// be recorded with. Transfer-only command buffers are recorded for the
+// dedicated transfer queues (when present) so that uploads and downloads can
+// overlap with dispatches on the compute queues. Everything else is recorded
+// for the compute queues.
+//
+// Tracing timestamp queries are issued through the compute queues so transfer
+// queues are not used when tracing is enabled. Unaligned fills that do not
+// span an aligned word are emulated with dispatches and are not supported in
+// transfer-only command buffers.
+static iree_hal_command_category_t
+iree_hal_vulkan_device_resolve_command_categories(
+    iree_hal_vulkan_device_t* device,
+    iree_hal_command_category_t command_categories) {
+  const bool tracing_enabled = device->queue_tracing_contexts[0] != NULL;
+  if (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER &&
+      device->transfer_command_pool && !tracing_enabled) {
+    return IREE_HAL_COMMAND_CATEGORY_TRANSFER;
+  }
+  return command_categories | IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+}
+
 // Returns the queue to submit work to based on the |queue_affinity|.
+// Affinity bit N maps to queue N (modulo the number of queues) of the kind
+// able to execute |command_categories| so that independent work submitted
+// with distinct affinities runs on distinct hardware queues. Cross-queue
+// ordering is provided by the timeline semaphores waited and signaled by each
+// submission.
 static CommandQueue* iree_hal_vulkan_device_select_queue(
     iree_hal_vulkan_device_t* device,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity) {
-  // TODO(scotttodd): revisit queue selection logic and remove this
-  //   * the unaligned buffer fill polyfill and tracing timestamp queries may
-  //     both insert dispatches into command buffers that at compile time are
-  //     expected to only contain transfer commands
-  //   * we could set a bit at recording time if emulation or tracing is used
-  //     and submit to the right queue based on that
-  command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
-
-  // TODO(benvanik): meaningful heuristics for affinity. We don't generate
-  // anything from the compiler that uses multiple queues and until we do it's
-  // best not to do anything too clever here.
+  iree_host_size_t queue_ordinal =
+      queue_affinity ? iree_math_count_trailing_zeros_u64(queue_affinity) : 0;
   if (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER) {
     return device
-        ->transfer_queues[queue_affinity % device->transfer_queue_count];
+        ->transfer_queues[queue_ordinal % device->transfer_queue_count];
   }
-  return device->dispatch_queues[queue_affinity % device->dispatch_queue_count];
+  return device->dispatch_queues[queue_ordinal % device->dispatch_queue_count];
 }
 
 static iree_status_t iree_hal_vulkan_device_create_channel(
@@ -1113,21 +1439,20 @@ static iree_status_t iree_hal_vulkan_device_create_command_buffer(
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
 
-  // TODO(scotttodd): revisit queue selection logic and remove this
-  //   * the unaligned buffer fill polyfill and tracing timestamp queries may
-  //     both insert dispatches into command buffers that at compile time are
-  //     expected to only contain transfer commands
-  //   * we could set a bit at recording time if emulation or tracing is used
-  //     and submit to the right queue based on that
-  command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
-
   // Select the command pool to used based on the types of commands used.
   // Note that we may not have a dedicated transfer command pool if there are
   // no dedicated transfer queues.
+  if (iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
+    // Nested command buffers must share the pool of the command buffers
+    // executing them; using the dispatch pool lets any dispatch command
+    // buffer execute them.
+    command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+  } else {
+    command_categories = iree_hal_vulkan_device_resolve_command_categories(
+        device, command_categories);
+  }
   VkCommandPoolHandle* command_pool = NULL;
-  if (device->transfer_command_pool &&
-      !iree_all_bits_set(command_categories,
-                         IREE_HAL_COMMAND_CATEGORY_DISPATCH)) {
+  if (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER) {
     command_pool = device->transfer_command_pool;
   } else {
     command_pool = device->dispatch_command_pool;
@@ -1144,7 +1469,7 @@ static iree_status_t iree_hal_vulkan_device_create_command_buffer(
   return iree_hal_vulkan_direct_command_buffer_allocate(
       base_device, device->logical_device, command_pool, mode,
       command_categories, queue_affinity, binding_capacity,
-      queue->tracing_context(), device->descriptor_pool_cache,
+      queue->tracing_context(), device->profiler, device->descriptor_pool_cache,
       device->builtin_executables, &device->block_pool, out_command_buffer);
 }
 
@@ -1171,7 +1496,9 @@ static iree_status_t iree_hal_vulkan_device_create_executable_cache(
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
   return iree_hal_vulkan_nop_executable_cache_create(
-      device->logical_device, identifier, out_executable_cache);
+      device->logical_device,
+      iree_hal_vulkan_pipeline_cache_handle(device->pipeline_cache),
+      identifier, out_executable_cache);
 }
 
 static iree_status_t iree_hal_vulkan_device_create_pipeline_layout(
@@ -1214,14 +1541,56 @@ static iree_status_t iree_hal_vulkan_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  // Storage is reserved immediately and never requires a host wait: pooled
+  // storage is only reused once prior users are known to have completed (or
+  // are ordered before the waits) and any new users must wait on the signal
+  // semaphores. Requests the pool cannot service go to the device allocator.
+  iree_hal_buffer_params_t compat_params;
+  iree_device_size_t compat_allocation_size = 0;
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                             device->device_allocator, params,
+                             allocation_size, &compat_params,
+                             &compat_allocation_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    status = iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    if (device->transient_pool && iree_hal_vulkan_transient_pool_supports(
+                                      device->transient_pool, &compat_params)) {
+      status = iree_hal_vulkan_transient_pool_allocate_buffer(
+          device->transient_pool, &compat_params, compat_allocation_size,
+          wait_semaphore_list, &buffer);
+    } else {
+      status = iree_hal_allocator_allocate_buffer(
+          device->device_allocator, params, allocation_size,
+          iree_const_byte_span_empty(), &buffer);
+    }
+  }
+
+  // Order the signal after the waits so that the allocation behaves as if it
+  // were committed on the queue.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                           wait_semaphore_list,
+                                           signal_semaphore_list);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_vulkan_device_queue_dealloca(
@@ -1229,10 +1598,22 @@ static iree_status_t iree_hal_vulkan_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+
+  // Buffers not allocated from the transient pool are released normally when
+  // their last reference is dropped.
+  if (!iree_hal_vulkan_transient_buffer_isa(buffer)) {
+    return iree_ok_status();
+  }
+
+  // All users of the buffer are ordered before the waits and the signals are
+  // ordered after them: once the signals are reached (or if a new allocation
+  // waits on them) the storage can be reused. Without signals the waits are
+  // the only ordering available.
+  return iree_hal_vulkan_transient_buffer_deallocate(
+      buffer, signal_semaphore_list.count ? signal_semaphore_list
+                                          : wait_semaphore_list);
 }
 
 static iree_status_t iree_hal_vulkan_device_queue_execute(
@@ -1240,11 +1621,33 @@ static iree_status_t iree_hal_vulkan_device_queue_execute(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_host_size_t command_buffer_count,
-    iree_hal_command_buffer_t* const* command_buffers) {
+    iree_hal_command_buffer_t* const* command_buffers,
+    const iree_hal_buffer_binding_table_t* binding_tables) {
+  // NOTE: command buffers with binding tables are not yet supported and fail
+  // creation so any binding tables provided are unused.
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
-  // NOTE: today we are not discriminating queues based on command type.
+
+  // Command buffers are recorded against the command pool of the queue family
+  // they were created for and can only be submitted to queues of that family.
+  // Submissions made only of transfer command buffers go to the transfer
+  // queues and anything else (including barriers) to the compute queues.
+  iree_hal_command_category_t command_categories =
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    iree_hal_command_category_t allowed_categories =
+        iree_hal_command_buffer_allowed_categories(command_buffers[i]);
+    if (i == 0) {
+      command_categories = allowed_categories;
+    } else if ((allowed_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER) !=
+               (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "transfer-only command buffers execute on dedicated transfer queues "
+          "and must be submitted separately from dispatch command buffers");
+    }
+  }
   CommandQueue* queue = iree_hal_vulkan_device_select_queue(
-      device, IREE_HAL_COMMAND_CATEGORY_DISPATCH, queue_affinity);
+      device, command_categories, queue_affinity);
   iree_hal_submission_batch_t batch = {
       /*.wait_semaphores=*/wait_semaphore_list,
       /*.command_buffer_count=*/command_buffer_count,
@@ -1307,6 +1710,26 @@ static iree_status_t iree_hal_vulkan_device_profiling_begin(
 #endif  // IREE_HAL_VULKAN_HAVE_RENDERDOC
   }
 
+  // Dispatch timing uses timestamp queries and needs no external tooling.
+  const iree_hal_device_profiling_mode_t counter_modes =
+      IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS |
+      IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS;
+  if (iree_any_bit_set(options->mode, counter_modes)) {
+    if (device->profiler) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "profiling already begun on this device");
+    }
+    iree_status_t status = iree_hal_vulkan_timestamp_profiler_create(
+        device->logical_device, device->physical_device,
+        device->dispatch_queue_family_index, options, &device->profiler);
+    if (iree_status_is_unavailable(status)) {
+      // Profiling is best-effort and it's ok to not capture anything.
+      iree_status_ignore(status);
+      status = iree_ok_status();
+    }
+    IREE_RETURN_IF_ERROR(status);
+  }
+
   return iree_ok_status();
 }
 
@@ -1331,7 +1754,19 @@ static iree_status_t iree_hal_vulkan_device_profiling_end(
         device->dispatch_queues[0]->handle(), &end_label);
   }
 
-  return iree_ok_status();
+  if (!device->profiler) return iree_ok_status();
+  // Timestamps are only valid once all profiled work has completed.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < device->queue_count && iree_status_is_ok(status); ++i) {
+    status = device->queues[i]->WaitIdle(iree_infinite_timeout());
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_vulkan_timestamp_profiler_end(device->profiler);
+  }
+  iree_hal_vulkan_timestamp_profiler_release(device->profiler);
+  device->profiler = NULL;
+  return status;
 }
 
 namespace {
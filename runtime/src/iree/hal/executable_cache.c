@@ -67,3 +67,39 @@ IREE_API_EXPORT iree_status_t iree_hal_executable_cache_prepare_executable(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+IREE_API_EXPORT iree_status_t iree_hal_executable_cache_prepare_executables(
+    iree_hal_executable_cache_t* executable_cache,
+    iree_host_size_t executable_count,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executables) {
+  IREE_ASSERT_ARGUMENT(executable_cache);
+  IREE_ASSERT_ARGUMENT(!executable_count || executable_params);
+  IREE_ASSERT_ARGUMENT(!executable_count || out_executables);
+  if (executable_count == 0) return iree_ok_status();
+  memset(out_executables, 0, executable_count * sizeof(*out_executables));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)executable_count);
+
+  iree_status_t status = iree_ok_status();
+  if (_VTABLE_DISPATCH(executable_cache, prepare_executables)) {
+    status = _VTABLE_DISPATCH(executable_cache, prepare_executables)(
+        executable_cache, executable_count, executable_params,
+        out_executables);
+  } else {
+    for (iree_host_size_t i = 0; i < executable_count; ++i) {
+      status = iree_hal_executable_cache_prepare_executable(
+          executable_cache, &executable_params[i], &out_executables[i]);
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+
+  if (!iree_status_is_ok(status)) {
+    for (iree_host_size_t i = 0; i < executable_count; ++i) {
+      iree_hal_executable_release(out_executables[i]);
+      out_executables[i] = NULL;
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
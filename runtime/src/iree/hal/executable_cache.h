@@ -68,6 +68,14 @@ enum iree_hal_executable_caching_mode_bits_t {
   // be enabled for real usage as the verification is the best way to catch
   // API misuse.
   IREE_HAL_EXECUTABLE_CACHING_MODE_DISABLE_VERIFICATION = 1u << 6,
+  // Allows the cache to defer loading the executable (relocation, import
+  // resolution, etc) until it is first dispatched. Preparation then only
+  // validates that the executable format is supported and load failures are
+  // reported by the first dispatch instead. Reduces startup time and resident
+  // memory when many executables are never used. Combine with
+  // IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA to avoid retaining a
+  // copy of the executable data until the executable is loaded.
+  IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_LAZY_PREPARATION = 1u << 7,
 };
 typedef uint32_t iree_hal_executable_caching_mode_t;
 
@@ -188,6 +196,20 @@ IREE_API_EXPORT iree_status_t iree_hal_executable_cache_prepare_executable(
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable);
 
+// Prepares |executable_count| executables as if by calling
+// iree_hal_executable_cache_prepare_executable on each of
+// |executable_params|, storing the results in |out_executables|.
+// Implementations may prepare the executables concurrently and callers with
+// many executables to prepare (such as during module initialization) should
+// prefer this over preparing them one at a time.
+//
+// On failure no executables are returned and |out_executables| is cleared.
+IREE_API_EXPORT iree_status_t iree_hal_executable_cache_prepare_executables(
+    iree_hal_executable_cache_t* executable_cache,
+    iree_host_size_t executable_count,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executables);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_executable_cache_t implementation details
 //===----------------------------------------------------------------------===//
@@ -204,6 +226,13 @@ typedef struct iree_hal_executable_cache_vtable_t {
       iree_hal_executable_cache_t* executable_cache,
       const iree_hal_executable_params_t* executable_params,
       iree_hal_executable_t** out_executable);
+
+  // Optional; when NULL executables are prepared one at a time.
+  iree_status_t(IREE_API_PTR* prepare_executables)(
+      iree_hal_executable_cache_t* executable_cache,
+      iree_host_size_t executable_count,
+      const iree_hal_executable_params_t* executable_params,
+      iree_hal_executable_t** out_executables);
 } iree_hal_executable_cache_vtable_t;
 IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_executable_cache_vtable_t);
 
@@ -35,8 +35,24 @@ typedef struct iree_elf_relocation_state_t {
   // Dynamic symbol table (.dynsym) loaded into virtual memory.
   const iree_elf_sym_t* dynsym;   // DT_SYMTAB
   iree_host_size_t dynsym_count;  // DT_SYMENT (bytes) / sizeof(iree_elf_sym_t)
+
+  // Host addresses of undefined (imported) symbols indexed by symbol ordinal.
+  // NULL if the module imports no symbols.
+  const iree_elf_addr_t* import_addrs;
 } iree_elf_relocation_state_t;
 
+// Returns the address of the symbol with |sym_ordinal|. Symbols defined by the
+// module are biased by the load address and undefined symbols are taken from
+// the resolved imports such that relocations bind directly to the host.
+static inline iree_elf_addr_t iree_elf_relocation_state_symbol_addr(
+    const iree_elf_relocation_state_t* state, uint32_t sym_ordinal) {
+  const iree_elf_sym_t* sym = &state->dynsym[sym_ordinal];
+  if (sym->st_shndx == IREE_ELF_SHN_UNDEF && state->import_addrs) {
+    return state->import_addrs[sym_ordinal];
+  }
+  return (iree_elf_addr_t)state->vaddr_bias + sym->st_value;
+}
+
 // Applies architecture-specific relocations.
 iree_status_t iree_elf_arch_apply_relocations(
     iree_elf_relocation_state_t* state);
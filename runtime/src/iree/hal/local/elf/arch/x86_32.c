@@ -55,8 +55,7 @@ static iree_status_t iree_elf_arch_x86_32_apply_rel(
                                 "invalid symbol in relocation: %u",
                                 sym_ordinal);
       }
-      sym_addr = (iree_elf_addr_t)state->vaddr_bias +
-                 state->dynsym[sym_ordinal].st_value;
+      sym_addr = iree_elf_relocation_state_symbol_addr(state, sym_ordinal);
     }
 
     iree_elf_addr_t instr_ptr =
@@ -466,24 +466,69 @@ static iree_status_t iree_elf_module_parse_dynamic_tables(
   return iree_ok_status();
 }
 
-// Verifies that there are no dynamic imports in the module as we don't support
-// them yet.
-static iree_status_t iree_elf_module_verify_no_imports(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+// Resolves the undefined symbols of the module against |import_table|.
+// On success |out_import_addrs| contains the host address of each undefined
+// symbol indexed by symbol ordinal, or NULL if the module imports nothing, and
+// must be freed by the caller after relocations have been applied.
+//
+// Relocations against the resolved addresses bind the call sites (usually PLT
+// slots) in the module directly to the host functions. The functions must use
+// the same calling convention as the ELF and it is the responsibility of the
+// table provider to only provide ABI-compatible symbols or thunks.
+static iree_status_t iree_elf_module_resolve_imports(
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    const iree_elf_import_table_t* import_table,
+    iree_elf_addr_t** out_import_addrs) {
+  *out_import_addrs = NULL;
+
   // NOTE: slot 0 is always the 0 placeholder.
+  bool any_imports = false;
+  for (iree_host_size_t i = 1; i < module->dynsym_count; ++i) {
+    if (module->dynsym[i].st_shndx == IREE_ELF_SHN_UNDEF) {
+      any_imports = true;
+      break;
+    }
+  }
+  if (!any_imports) return iree_ok_status();
+
+  iree_elf_addr_t* import_addrs = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      module->host_allocator, module->dynsym_count * sizeof(*import_addrs),
+      (void**)&import_addrs));
+  memset(import_addrs, 0, module->dynsym_count * sizeof(*import_addrs));
+
+  iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 1; i < module->dynsym_count; ++i) {
     const iree_elf_sym_t* sym = &module->dynsym[i];
-    if (sym->st_shndx == IREE_ELF_SHN_UNDEF) {
-      const char* symname IREE_ATTRIBUTE_UNUSED =
-          sym->st_name ? module->dynstr + sym->st_name : NULL;
-      return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                              "ELF imports one or more symbols (trying "
-                              "'%s'); imports are not supported in the "
-                              "platform-agnostic loader",
-                              symname);
+    if (sym->st_shndx != IREE_ELF_SHN_UNDEF) continue;
+    const char* symname = sym->st_name ? module->dynstr + sym->st_name : NULL;
+    if (!symname || !symname[0]) continue;
+    bool found = false;
+    for (iree_host_size_t j = 0; import_table && j < import_table->import_count;
+         ++j) {
+      if (strcmp(import_table->imports[j].sym_name, symname) == 0) {
+        import_addrs[i] = (iree_elf_addr_t)import_table->imports[j].thunk_ptr;
+        found = true;
+        break;
+      }
+    }
+    // Unresolved weak imports are bound to NULL.
+    if (!found && IREE_ELF_ST_BIND(sym->st_info) != IREE_ELF_STB_WEAK) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "ELF imports symbol '%s' that is not provided "
+                                "by the runtime; only symbols in the loader "
+                                "import table can be imported",
+                                symname);
+      break;
     }
   }
-  return iree_ok_status();
+
+  if (iree_status_is_ok(status)) {
+    *out_import_addrs = import_addrs;
+  } else {
+    iree_allocator_free(module->host_allocator, import_addrs);
+  }
+  return status;
 }
 
 //==============================================================================
@@ -492,7 +537,8 @@ static iree_status_t iree_elf_module_verify_no_imports(
 
 // Applies symbol and address base relocations to the loaded sections.
 static iree_status_t iree_elf_module_apply_relocations(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+    iree_elf_module_load_state_t* load_state,
+    const iree_elf_addr_t* import_addrs, iree_elf_module_t* module) {
   // Redirect to the architecture-specific handler.
   iree_elf_relocation_state_t reloc_state;
   memset(&reloc_state, 0, sizeof(reloc_state));
@@ -501,6 +547,7 @@ static iree_status_t iree_elf_module_apply_relocations(
   reloc_state.dyn_table_count = load_state->dyn_table_count;
   reloc_state.dynsym = module->dynsym;
   reloc_state.dynsym_count = module->dynsym_count;
+  reloc_state.import_addrs = import_addrs;
   return iree_elf_arch_apply_relocations(&reloc_state);
 }
 
@@ -600,16 +647,19 @@ iree_status_t iree_elf_module_initialize_from_memory(
     status = iree_elf_module_parse_dynamic_tables(&load_state, out_module);
   }
 
-  // TODO(benvanik): imports would happen here. For now we just ensure there are
-  // no imports as otherwise things will fail with obscure messages later on.
+  // Resolve any symbols imported by the module from the import table.
+  iree_elf_addr_t* import_addrs = NULL;
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_verify_no_imports(&load_state, out_module);
+    status = iree_elf_module_resolve_imports(&load_state, out_module,
+                                             import_table, &import_addrs);
   }
 
   // Apply relocations to the loaded pages.
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_apply_relocations(&load_state, out_module);
+    status = iree_elf_module_apply_relocations(&load_state, import_addrs,
+                                               out_module);
   }
+  iree_allocator_free(host_allocator, import_addrs);
 
   // Apply final protections to the loaded pages now that relocations have been
   // performed.
@@ -16,6 +16,7 @@
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_dispatch_pool.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 
@@ -28,6 +29,10 @@ typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Optional pool used to execute dispatches across multiple threads.
+  // Unowned and must remain valid for the lifetime of the command buffer.
+  iree_hal_local_dispatch_pool_t* dispatch_pool;
+
   struct {
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -47,6 +52,12 @@ typedef struct iree_hal_inline_command_buffer_t {
     size_t packed_binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
                                   IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
 
+    // Mask of the full bindings currently packed into packed_bindings when
+    // packed_bindings_valid is set. Consecutive dispatches using the same
+    // layout reuse the packed bindings until a binding changes.
+    iree_hal_local_binding_mask_t packed_binding_mask;
+    bool packed_bindings_valid;
+
     // All available push constants updated each time push_constants is called.
     // Reset only with the command buffer and otherwise will maintain its values
     // during recording to allow for partial push_constants updates.
@@ -196,6 +207,14 @@ bool iree_hal_inline_command_buffer_isa(
       command_buffer, &iree_hal_inline_command_buffer_vtable);
 }
 
+void iree_hal_inline_command_buffer_set_dispatch_pool(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_local_dispatch_pool_t* dispatch_pool) {
+  iree_hal_inline_command_buffer_t* command_buffer =
+      iree_hal_inline_command_buffer_cast(base_command_buffer);
+  command_buffer->dispatch_pool = dispatch_pool;
+}
+
 static void* iree_hal_inline_command_buffer_dyn_cast(
     iree_hal_command_buffer_t* command_buffer, const void* vtable) {
   if (vtable == &iree_hal_inline_command_buffer_vtable) {
@@ -432,10 +451,18 @@ static iree_status_t iree_hal_inline_command_buffer_push_descriptor_set(
           IREE_HAL_MEMORY_ACCESS_ANY, bindings[i].offset, bindings[i].length,
           &buffer_mapping));
     }
-    command_buffer->state.full_bindings[binding_ordinal] =
-        buffer_mapping.contents.data;
-    command_buffer->state.full_binding_lengths[binding_ordinal] =
-        buffer_mapping.contents.data_length;
+    // Rebinding the same range (common when the same descriptor set is pushed
+    // for each dispatch) keeps the packed bindings valid.
+    if (command_buffer->state.full_bindings[binding_ordinal] !=
+            buffer_mapping.contents.data ||
+        command_buffer->state.full_binding_lengths[binding_ordinal] !=
+            buffer_mapping.contents.data_length) {
+      command_buffer->state.full_bindings[binding_ordinal] =
+          buffer_mapping.contents.data;
+      command_buffer->state.full_binding_lengths[binding_ordinal] =
+          buffer_mapping.contents.data_length;
+      command_buffer->state.packed_bindings_valid = false;
+    }
   }
 
   return iree_ok_status();
@@ -445,15 +472,19 @@ static iree_status_t iree_hal_inline_command_buffer_push_descriptor_set(
 // iree_hal_command_buffer_dispatch
 //===----------------------------------------------------------------------===//
 
-static iree_status_t iree_hal_inline_command_buffer_dispatch(
-    iree_hal_command_buffer_t* base_command_buffer,
+// Resolves |executable| and populates the dispatch state for a dispatch of
+// |entry_point| with the current push constants and bindings. Returns the
+// executable to issue the dispatch with and the local memory it requires.
+static iree_status_t iree_hal_inline_command_buffer_prepare_dispatch(
+    iree_hal_inline_command_buffer_t* command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
-    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
-  iree_hal_inline_command_buffer_t* command_buffer =
-      iree_hal_inline_command_buffer_cast(base_command_buffer);
-
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z,
+    iree_hal_local_executable_t** out_local_executable,
+    iree_host_size_t* out_local_memory_size) {
+  // Executables prepared lazily are loaded on their first dispatch.
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -469,13 +500,6 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
                 IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
           : 0;
 
-  // Update the ID of the processor we are running on.
-  // We don't know how much time has passed since we last updated as we are
-  // running inline with the user program; if we knew we were going to be
-  // handling a batch of dispatches we could reduce the amount of times we call
-  // this - but that's what the task system is for.
-  iree_hal_inline_command_buffer_update_processor_id(command_buffer);
-
   iree_hal_executable_dispatch_state_v0_t* dispatch_state =
       &command_buffer->state.dispatch_state;
 
@@ -487,14 +511,31 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   dispatch_state->workgroup_count_y = workgroup_y;
   dispatch_state->workgroup_count_z = workgroup_z;
 
-  // Single-threaded.
-  dispatch_state->max_concurrency = 1;
+  // Single-threaded unless workgroups are distributed across a dispatch pool.
+  dispatch_state->max_concurrency =
+      command_buffer->dispatch_pool
+          ? (uint8_t)iree_hal_local_dispatch_pool_concurrency(
+                command_buffer->dispatch_pool)
+          : 1;
 
   // Push constants are pulled directly from the command buffer state, but we
   // only allow the dispatch to read what we know is initialized based on the
   // layout.
   dispatch_state->push_constant_count = local_layout->push_constants;
 
+  // Reuse the packed bindings of the previous dispatch if the bindings it used
+  // are unchanged.
+  iree_hal_local_binding_mask_t used_binding_mask = local_layout->used_bindings;
+  iree_host_size_t used_binding_count =
+      iree_math_count_ones_u64(used_binding_mask);
+  dispatch_state->binding_count = used_binding_count;
+  if (command_buffer->state.packed_bindings_valid &&
+      command_buffer->state.packed_binding_mask == used_binding_mask) {
+    *out_local_executable = local_executable;
+    *out_local_memory_size = local_memory_size;
+    return iree_ok_status();
+  }
+
   // Produce the dense binding list based on the declared bindings used.
   // This allows us to change the descriptor sets and bindings counts supported
   // in the HAL independent of any executable as each executable just gets the
@@ -503,10 +544,7 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   // Note that we are just directly setting the binding data pointers here with
   // no ownership/retaining/etc - it's part of the HAL contract that buffers are
   // kept valid for the duration they may be in use.
-  iree_hal_local_binding_mask_t used_binding_mask = local_layout->used_bindings;
-  iree_host_size_t used_binding_count =
-      iree_math_count_ones_u64(used_binding_mask);
-  dispatch_state->binding_count = used_binding_count;
+  command_buffer->state.packed_bindings_valid = false;
   void** binding_ptrs = (void**)dispatch_state->binding_ptrs;
   size_t* binding_lengths = (size_t*)dispatch_state->binding_lengths;
   iree_host_size_t binding_base = 0;
@@ -523,7 +561,19 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
     binding_lengths[i] =
         command_buffer->state.full_binding_lengths[binding_ordinal];
   }
+  command_buffer->state.packed_binding_mask = local_layout->used_bindings;
+  command_buffer->state.packed_bindings_valid = true;
+
+  *out_local_executable = local_executable;
+  *out_local_memory_size = local_memory_size;
+  return iree_ok_status();
+}
 
+// Ensures |local_memory| has at least |minimum_size| bytes, growing it as
+// needed. The contents are not preserved.
+static iree_status_t iree_hal_inline_command_buffer_reserve_local_memory(
+    iree_hal_inline_command_buffer_t* command_buffer,
+    iree_host_size_t minimum_size, iree_byte_span_t* local_memory) {
   // TODO(benvanik): plumb through an arena or fixed-size reservation to use.
   // For now when deploying to devices where you want something like the
   // inline command buffer you probably don't want 256KB of transient memory
@@ -531,25 +581,114 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   // option. For now we just malloc here to make things work and strongly
   // encourage the kind of user who wants synchronous inline execution to not
   // also want tons of scratch memory.
-  iree_byte_span_t local_memory = iree_make_byte_span(NULL, local_memory_size);
-  if (local_memory_size > 0) {
-    IREE_RETURN_IF_ERROR(iree_allocator_malloc(command_buffer->host_allocator,
-                                               local_memory_size,
-                                               (void**)&local_memory.data));
+  if (minimum_size <= local_memory->data_length) return iree_ok_status();
+  iree_allocator_free(command_buffer->host_allocator, local_memory->data);
+  *local_memory = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(command_buffer->host_allocator,
+                                             minimum_size,
+                                             (void**)&local_memory->data));
+  local_memory->data_length = minimum_size;
+  return iree_ok_status();
+}
+
+// Issues the prepared dispatch of |entry_point| on the calling thread or, if
+// the command buffer has one, across the dispatch pool.
+static iree_status_t iree_hal_inline_command_buffer_issue_dispatch(
+    iree_hal_inline_command_buffer_t* command_buffer,
+    iree_hal_local_executable_t* local_executable, int32_t entry_point,
+    iree_byte_span_t local_memory) {
+  if (command_buffer->dispatch_pool) {
+    return iree_hal_local_dispatch_pool_issue(
+        command_buffer->dispatch_pool, local_executable, entry_point,
+        &command_buffer->state.dispatch_state,
+        command_buffer->state.processor_id, local_memory);
   }
+  return iree_hal_local_executable_issue_dispatch_inline(
+      local_executable, entry_point, &command_buffer->state.dispatch_state,
+      command_buffer->state.processor_id, local_memory);
+}
+
+static iree_status_t iree_hal_inline_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
+  iree_hal_inline_command_buffer_t* command_buffer =
+      iree_hal_inline_command_buffer_cast(base_command_buffer);
+
+  iree_hal_local_executable_t* local_executable = NULL;
+  iree_host_size_t local_memory_size = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_inline_command_buffer_prepare_dispatch(
+      command_buffer, executable, entry_point, workgroup_x, workgroup_y,
+      workgroup_z, &local_executable, &local_memory_size));
+
+  // Update the ID of the processor we are running on.
+  // We don't know how much time has passed since we last updated as we are
+  // running inline with the user program; when handling a batch of dispatches
+  // iree_hal_inline_command_buffer_dispatch_batch only updates it once.
+  iree_hal_inline_command_buffer_update_processor_id(command_buffer);
+
+  iree_byte_span_t local_memory = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_IF_ERROR(iree_hal_inline_command_buffer_reserve_local_memory(
+      command_buffer, local_memory_size, &local_memory));
+  local_memory.data_length = local_memory_size;
 
   // Since we are running on a borrowed thread, we know nothing about the
   // floating point state. Reset it.
   iree_fpu_state_t fpu_state =
       iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
-  iree_status_t status = iree_hal_local_executable_issue_dispatch_inline(
-      local_executable, entry_point, dispatch_state,
-      command_buffer->state.processor_id, local_memory);
+  iree_status_t status = iree_hal_inline_command_buffer_issue_dispatch(
+      command_buffer, local_executable, entry_point, local_memory);
   iree_fpu_state_pop(fpu_state);
 
-  if (local_memory.data) {
-    iree_allocator_free(command_buffer->host_allocator, local_memory.data);
+  iree_allocator_free(command_buffer->host_allocator, local_memory.data);
+  return status;
+}
+
+iree_status_t iree_hal_inline_command_buffer_dispatch_batch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_host_size_t dispatch_count,
+    const iree_hal_inline_command_buffer_dispatch_t* dispatches) {
+  IREE_ASSERT_ARGUMENT(base_command_buffer);
+  IREE_ASSERT_ARGUMENT(!dispatch_count || dispatches);
+  if (!iree_hal_inline_command_buffer_isa(base_command_buffer)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "command buffer is not an inline command buffer");
   }
+  iree_hal_inline_command_buffer_t* command_buffer =
+      iree_hal_inline_command_buffer_cast(base_command_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, dispatch_count);
+
+  // The processor ID, floating point state and local memory are shared by all
+  // dispatches in the batch.
+  iree_hal_inline_command_buffer_update_processor_id(command_buffer);
+  iree_byte_span_t local_memory = iree_make_byte_span(NULL, 0);
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < dispatch_count; ++i) {
+    const iree_hal_inline_command_buffer_dispatch_t* dispatch = &dispatches[i];
+    iree_hal_local_executable_t* local_executable = NULL;
+    iree_host_size_t local_memory_size = 0;
+    status = iree_hal_inline_command_buffer_prepare_dispatch(
+        command_buffer, dispatch->executable, dispatch->entry_point,
+        dispatch->workgroup_count[0], dispatch->workgroup_count[1],
+        dispatch->workgroup_count[2], &local_executable, &local_memory_size);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_inline_command_buffer_reserve_local_memory(
+          command_buffer, local_memory_size, &local_memory);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_inline_command_buffer_issue_dispatch(
+          command_buffer, local_executable, dispatch->entry_point,
+          iree_make_byte_span(local_memory.data, local_memory_size));
+    }
+    if (!iree_status_is_ok(status)) break;
+  }
+  iree_fpu_state_pop(fpu_state);
+  iree_allocator_free(command_buffer->host_allocator, local_memory.data);
+
+  IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/local_dispatch_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +60,32 @@ iree_status_t iree_hal_inline_command_buffer_create(
 bool iree_hal_inline_command_buffer_isa(
     iree_hal_command_buffer_t* command_buffer);
 
+// Sets the |dispatch_pool| used to execute the workgroups of subsequent
+// dispatches across multiple threads. Dispatches still complete before the
+// recording call returns. Passing NULL executes them on the calling thread.
+// The pool is not retained and must outlive the command buffer.
+void iree_hal_inline_command_buffer_set_dispatch_pool(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_local_dispatch_pool_t* dispatch_pool);
+
+// A dispatch issued as part of a batch with
+// iree_hal_inline_command_buffer_dispatch_batch.
+typedef struct iree_hal_inline_command_buffer_dispatch_t {
+  iree_hal_executable_t* executable;
+  int32_t entry_point;
+  uint32_t workgroup_count[3];
+} iree_hal_inline_command_buffer_dispatch_t;
+
+// Executes |dispatches| in order on the calling thread as if each was issued
+// with iree_hal_command_buffer_dispatch. All dispatches use the push constants
+// and descriptor sets currently bound and share the per-dispatch setup (such as
+// processor ID queries, floating point state and local memory allocation) so
+// that issuing many small dispatches has lower overhead. Stops at the first
+// failing dispatch.
+iree_status_t iree_hal_inline_command_buffer_dispatch_batch(
+    iree_hal_command_buffer_t* command_buffer, iree_host_size_t dispatch_count,
+    const iree_hal_inline_command_buffer_dispatch_t* dispatches);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
@@ -16,6 +17,46 @@
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
 
+//===----------------------------------------------------------------------===//
+// Direct runtime imports
+//===----------------------------------------------------------------------===//
+
+// Whether ELF modules may bind undefined symbols directly to runtime functions
+// at relocation time. Calls to these go straight to the host implementation
+// without the import thunk and import table indirection. Requires the host
+// calling convention to match the SysV ABI the ELFs are compiled for.
+#if !defined(IREE_HAL_EMBEDDED_ELF_DIRECT_IMPORTS_ENABLE)
+#if defined(IREE_PLATFORM_WINDOWS) || defined(IREE_ARCH_ARM_32)
+#define IREE_HAL_EMBEDDED_ELF_DIRECT_IMPORTS_ENABLE 0
+#else
+#define IREE_HAL_EMBEDDED_ELF_DIRECT_IMPORTS_ENABLE 1
+#endif  // IREE_PLATFORM_WINDOWS || IREE_ARCH_ARM_32
+#endif  // !IREE_HAL_EMBEDDED_ELF_DIRECT_IMPORTS_ENABLE
+
+#if IREE_HAL_EMBEDDED_ELF_DIRECT_IMPORTS_ENABLE
+
+// Runtime functions the code generator may emit calls to when lowering
+// builtins (such as large llvm.memcpy/llvm.memset) that are not available in
+// the freestanding ELF.
+static const iree_elf_import_t iree_hal_embedded_elf_direct_imports[] = {
+    {"memcpy", (void*)memcpy},
+    {"memmove", (void*)memmove},
+    {"memset", (void*)memset},
+};
+
+static const iree_elf_import_table_t iree_hal_embedded_elf_import_table = {
+    .import_count = IREE_ARRAYSIZE(iree_hal_embedded_elf_direct_imports),
+    .imports = iree_hal_embedded_elf_direct_imports,
+};
+
+#define IREE_HAL_EMBEDDED_ELF_IMPORT_TABLE &iree_hal_embedded_elf_import_table
+
+#else
+
+#define IREE_HAL_EMBEDDED_ELF_IMPORT_TABLE NULL
+
+#endif  // IREE_HAL_EMBEDDED_ELF_DIRECT_IMPORTS_ENABLE
+
 //===----------------------------------------------------------------------===//
 // iree_hal_elf_executable_t
 //===----------------------------------------------------------------------===//
@@ -81,6 +122,7 @@ static iree_status_t iree_hal_elf_executable_query_library(
   executable->identifier = iree_make_cstring_view(header->name);
 
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+  executable->base.export_names = executable->library.v0->exports.names;
 
   return iree_ok_status();
 }
@@ -132,6 +174,69 @@ static iree_status_t iree_hal_elf_executable_resolve_imports(
   return iree_ok_status();
 }
 
+iree_status_t iree_hal_embedded_elf_select_variant(
+    iree_const_byte_span_t executable_data,
+    const iree_hal_processor_v0_t* processor,
+    iree_const_byte_span_t* out_elf_data) {
+  IREE_ASSERT_ARGUMENT(processor);
+  IREE_ASSERT_ARGUMENT(out_elf_data);
+  *out_elf_data = executable_data;
+  if (executable_data.data_length < IREE_HAL_EMBEDDED_ELF_FAT_MAGIC_SIZE ||
+      memcmp(executable_data.data, IREE_HAL_EMBEDDED_ELF_FAT_MAGIC,
+             IREE_HAL_EMBEDDED_ELF_FAT_MAGIC_SIZE) != 0) {
+    return iree_ok_status();  // not fat
+  }
+
+  iree_hal_embedded_elf_fat_header_t header;
+  if (executable_data.data_length < sizeof(header)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "fat embedded ELF header truncated");
+  }
+  memcpy(&header, executable_data.data, sizeof(header));
+  const iree_host_size_t variants_end =
+      sizeof(header) +
+      (iree_host_size_t)header.variant_count *
+          sizeof(iree_hal_embedded_elf_fat_variant_t);
+  if (header.reserved != 0 || variants_end > executable_data.data_length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "fat embedded ELF header invalid");
+  }
+
+  for (uint32_t i = 0; i < header.variant_count; ++i) {
+    iree_hal_embedded_elf_fat_variant_t variant;
+    memcpy(&variant,
+           executable_data.data + sizeof(header) + i * sizeof(variant),
+           sizeof(variant));
+    bool supported = true;
+    for (iree_host_size_t j = 0; j < IREE_HAL_PROCESSOR_DATA_CAPACITY_V0;
+         ++j) {
+      if (!iree_all_bits_set(processor->data[j],
+                             variant.required_processor_data[j])) {
+        supported = false;
+        break;
+      }
+    }
+    if (!supported) continue;
+    if (variant.offset < variants_end ||
+        variant.offset % IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT != 0 ||
+        variant.length == 0 ||
+        variant.offset > executable_data.data_length ||
+        variant.length > executable_data.data_length - variant.offset) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "fat embedded ELF variant %u out of bounds", i);
+    }
+    *out_elf_data =
+        iree_make_const_byte_span(executable_data.data + variant.offset,
+                                  (iree_host_size_t)variant.length);
+    return iree_ok_status();
+  }
+
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "none of the %u fat embedded ELF variants are "
+                          "supported by the processor",
+                          header.variant_count);
+}
+
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
@@ -176,11 +281,18 @@ static iree_status_t iree_hal_elf_executable_create(
       executable->base.environment.constants = target_constants;
     }
   }
+  iree_const_byte_span_t elf_data = iree_const_byte_span_empty();
+  if (iree_status_is_ok(status)) {
+    // Pick the best ELF for the processor if this is a fat embedded ELF.
+    status = iree_hal_embedded_elf_select_variant(
+        executable_params->executable_data,
+        &executable->base.environment.processor, &elf_data);
+  }
   if (iree_status_is_ok(status)) {
     // Attempt to load the ELF module.
     status = iree_elf_module_initialize_from_memory(
-        executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+        elf_data, IREE_HAL_EMBEDDED_ELF_IMPORT_TABLE, host_allocator,
+        &executable->module);
   }
   if (iree_status_is_ok(status)) {
     // Query metadata and get the entry point function pointers.
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_loader.h"
 
 #ifdef __cplusplus
@@ -26,6 +27,58 @@ iree_status_t iree_hal_embedded_elf_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+//===----------------------------------------------------------------------===//
+// Multi-versioned (fat) embedded ELFs
+//===----------------------------------------------------------------------===//
+// Executable data may contain multiple ELF variants of the same executable
+// compiled for different ISA tiers (x86-64-v2/v3/v4, Armv8.2 +dotprod/+i8mm,
+// etc). The loader picks the first variant whose required CPU data bits are
+// all reported by the executable environment and loads only that ELF.
+// Executable data not starting with IREE_HAL_EMBEDDED_ELF_FAT_MAGIC is treated
+// as a single ELF.
+//
+// Layout (little-endian):
+//   iree_hal_embedded_elf_fat_header_t header;
+//   iree_hal_embedded_elf_fat_variant_t variants[header.variant_count];
+//   ... ELF data referenced by the variants ...
+
+// Magic bytes at the start of a fat embedded ELF.
+#define IREE_HAL_EMBEDDED_ELF_FAT_MAGIC "IREEFAT0"
+#define IREE_HAL_EMBEDDED_ELF_FAT_MAGIC_SIZE 8
+
+// Required alignment of each variant ELF within the fat embedded ELF.
+#define IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT 16
+
+typedef struct iree_hal_embedded_elf_fat_header_t {
+  // IREE_HAL_EMBEDDED_ELF_FAT_MAGIC.
+  char magic[IREE_HAL_EMBEDDED_ELF_FAT_MAGIC_SIZE];
+  // Number of variants following the header.
+  uint32_t variant_count;
+  // Must be zero.
+  uint32_t reserved;
+} iree_hal_embedded_elf_fat_header_t;
+
+typedef struct iree_hal_embedded_elf_fat_variant_t {
+  // Processor data bits that must all be set in the environment processor data
+  // for the variant to be selected. See iree/schemas/cpu_data.h.
+  uint64_t required_processor_data[IREE_HAL_PROCESSOR_DATA_CAPACITY_V0];
+  // Byte offset of the variant ELF from the start of the fat embedded ELF.
+  // Must be aligned to IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT.
+  uint64_t offset;
+  // Byte length of the variant ELF.
+  uint64_t length;
+} iree_hal_embedded_elf_fat_variant_t;
+
+// Selects the ELF to load from |executable_data| given the |processor|
+// information of the executable environment. Variants are ordered by
+// preference and the first supported one is returned in |out_elf_data|.
+// Executable data that is not a fat embedded ELF is returned as-is.
+// Fails with NOT_FOUND if no variant is supported by the processor.
+iree_status_t iree_hal_embedded_elf_select_variant(
+    iree_const_byte_span_t executable_data,
+    const iree_hal_processor_v0_t* processor,
+    iree_const_byte_span_t* out_elf_data);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
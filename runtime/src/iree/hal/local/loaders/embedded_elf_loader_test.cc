@@ -0,0 +1,91 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/loaders/embedded_elf_loader.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Builds a fat embedded ELF with one variant per entry in |requirements| whose
+// contents are a single byte holding the variant index.
+static std::vector<uint8_t> MakeFatElf(
+    const std::vector<uint64_t>& requirements) {
+  iree_hal_embedded_elf_fat_header_t header;
+  memcpy(header.magic, IREE_HAL_EMBEDDED_ELF_FAT_MAGIC,
+         IREE_HAL_EMBEDDED_ELF_FAT_MAGIC_SIZE);
+  header.variant_count = (uint32_t)requirements.size();
+  header.reserved = 0;
+  const size_t variant_size = sizeof(iree_hal_embedded_elf_fat_variant_t);
+  const size_t data_offset =
+      iree_host_align(sizeof(header) + requirements.size() * variant_size,
+                      IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT);
+  std::vector<uint8_t> data(
+      data_offset + requirements.size() * IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT);
+  memcpy(data.data(), &header, sizeof(header));
+  for (size_t i = 0; i < requirements.size(); ++i) {
+    iree_hal_embedded_elf_fat_variant_t variant;
+    memset(&variant, 0, sizeof(variant));
+    variant.required_processor_data[0] = requirements[i];
+    variant.offset = data_offset + i * IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT;
+    variant.length = 1;
+    memcpy(data.data() + sizeof(header) + i * sizeof(variant), &variant,
+           sizeof(variant));
+    data[variant.offset] = (uint8_t)i;
+  }
+  return data;
+}
+
+static iree_status_t SelectVariant(const std::vector<uint8_t>& data,
+                                   uint64_t processor_data_0,
+                                   iree_const_byte_span_t* out_elf_data) {
+  iree_hal_processor_v0_t processor;
+  memset(&processor, 0, sizeof(processor));
+  processor.data[0] = processor_data_0;
+  return iree_hal_embedded_elf_select_variant(
+      iree_make_const_byte_span(data.data(), data.size()), &processor,
+      out_elf_data);
+}
+
+TEST(EmbeddedElfLoaderTest, NonFatPassesThrough) {
+  std::vector<uint8_t> data = {0x7F, 'E', 'L', 'F', 0, 0, 0, 0, 0};
+  iree_const_byte_span_t elf_data;
+  IREE_ASSERT_OK(SelectVariant(data, 0, &elf_data));
+  EXPECT_EQ(elf_data.data, data.data());
+  EXPECT_EQ(elf_data.data_length, data.size());
+}
+
+TEST(EmbeddedElfLoaderTest, SelectsFirstSupportedVariant) {
+  std::vector<uint8_t> data = MakeFatElf({0x3, 0x1, 0x0});
+  iree_const_byte_span_t elf_data;
+  IREE_ASSERT_OK(SelectVariant(data, 0x3, &elf_data));
+  EXPECT_EQ(elf_data.data[0], 0);
+  IREE_ASSERT_OK(SelectVariant(data, 0x1, &elf_data));
+  EXPECT_EQ(elf_data.data[0], 1);
+  IREE_ASSERT_OK(SelectVariant(data, 0x2, &elf_data));
+  EXPECT_EQ(elf_data.data[0], 2);
+}
+
+TEST(EmbeddedElfLoaderTest, NoSupportedVariant) {
+  std::vector<uint8_t> data = MakeFatElf({0x1});
+  iree_const_byte_span_t elf_data;
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND,
+                        SelectVariant(data, 0x2, &elf_data));
+}
+
+TEST(EmbeddedElfLoaderTest, RejectsOutOfBoundsVariant) {
+  std::vector<uint8_t> data = MakeFatElf({0x0});
+  data.resize(data.size() - IREE_HAL_EMBEDDED_ELF_FAT_ALIGNMENT);
+  iree_const_byte_span_t elf_data;
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_INVALID_ARGUMENT,
+                        SelectVariant(data, 0x0, &elf_data));
+}
+
+}  // namespace
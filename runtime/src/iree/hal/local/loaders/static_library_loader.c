@@ -37,17 +37,32 @@ typedef struct iree_hal_static_executable_t {
 static const iree_hal_local_executable_vtable_t
     iree_hal_static_executable_vtable;
 
+// A library registered with the loader and the imports resolved for it.
+typedef struct iree_hal_static_library_entry_t {
+  const iree_hal_executable_library_header_t** header;
+  // Import functions and contexts indexed by library import ordinal. Slices of
+  // the import table shared by all libraries registered with the loader.
+  const iree_hal_executable_import_v0_t* import_funcs;
+  const void** import_contexts;
+} iree_hal_static_library_entry_t;
+
+// Statically linked imports need no ABI adaptation and are called directly.
+static int iree_hal_static_library_import_thunk(
+    iree_hal_executable_import_v0_t fn_ptr, void* context, void* params,
+    void* reserved) {
+  return fn_ptr(context, params, reserved);
+}
+
 static iree_status_t iree_hal_static_executable_create(
     const iree_hal_executable_params_t* executable_params,
-    const iree_hal_executable_library_header_t** library_header,
-    const iree_hal_executable_import_provider_t import_provider,
+    const iree_hal_static_library_entry_t* library,
     iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(!executable_params->pipeline_layout_count ||
                        executable_params->pipeline_layouts);
   IREE_ASSERT_ARGUMENT(!executable_params->constant_count ||
                        executable_params->constants);
-  IREE_ASSERT_ARGUMENT(library_header);
+  IREE_ASSERT_ARGUMENT(library);
   IREE_ASSERT_ARGUMENT(out_executable);
   *out_executable = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -65,9 +80,10 @@ static iree_status_t iree_hal_static_executable_create(
         executable_params->pipeline_layout_count,
         executable_params->pipeline_layouts, &executable->layouts[0],
         host_allocator, &executable->base);
-    executable->library.header = library_header;
-    executable->identifier = iree_make_cstring_view((*library_header)->name);
+    executable->library.header = library->header;
+    executable->identifier = iree_make_cstring_view((*library->header)->name);
     executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+    executable->base.export_names = executable->library.v0->exports.names;
 
     // Copy executable constants so we own them.
     if (executable_params->constant_count > 0) {
@@ -82,13 +98,14 @@ static iree_status_t iree_hal_static_executable_create(
     }
   }
 
-  if (iree_status_is_ok(status)) {
-    if (executable->library.v0->imports.count > 0) {
-      status =
-          iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                           "static libraries do not support imports and should "
-                           "directly link against the functions they require");
-    }
+  // Imports were resolved once when the library was registered and the table
+  // is shared with all other executables loaded from it.
+  if (iree_status_is_ok(status) &&
+      executable->library.v0->imports.count > 0) {
+    executable->base.environment.import_thunk =
+        iree_hal_static_library_import_thunk;
+    executable->base.environment.import_funcs = library->import_funcs;
+    executable->base.environment.import_contexts = library->import_contexts;
   }
 
   if (iree_status_is_ok(status)) {
@@ -186,16 +203,120 @@ static const iree_hal_local_executable_vtable_t
 // iree_hal_static_library_loader_t
 //===----------------------------------------------------------------------===//
 
+// Sentinel used to mark empty slots in the library name hash table.
+#define IREE_HAL_STATIC_LIBRARY_SLOT_EMPTY UINT32_MAX
+
 typedef struct iree_hal_static_library_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
+
+  // Open-addressed hash table of library ordinals keyed by library name.
+  // The capacity is a power of two at least twice the library count so that
+  // probe sequences remain short.
+  iree_host_size_t slot_mask;
+  uint32_t* slots;
+
+  // Import table shared by all libraries. Every unique symbol is resolved once
+  // through the import provider and each library references a slice of
+  // |import_funcs|/|import_contexts| indexed by its own import ordinals.
+  iree_host_size_t import_count;
+  iree_hal_executable_import_v0_t* import_funcs;
+  const void** import_contexts;
+
   iree_host_size_t library_count;
-  const iree_hal_executable_library_header_t** const libraries[];
+  iree_hal_static_library_entry_t libraries[];
 } iree_hal_static_library_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
     iree_hal_static_library_loader_vtable;
 
+// FNV-1a; library names are short and this is only used to pick a probe start.
+static uint32_t iree_hal_static_library_hash_name(iree_string_view_t name) {
+  uint32_t hash = 0x811C9DC5u;
+  for (iree_host_size_t i = 0; i < name.size; ++i) {
+    hash = (hash ^ (uint8_t)name.data[i]) * 0x01000193u;
+  }
+  return hash;
+}
+
+// Returns the slot containing the library with |name| or the empty slot where
+// it would be inserted.
+static uint32_t* iree_hal_static_library_loader_find_slot(
+    iree_hal_static_library_loader_t* executable_loader,
+    iree_string_view_t name) {
+  iree_host_size_t slot = iree_hal_static_library_hash_name(name) &
+                          executable_loader->slot_mask;
+  while (executable_loader->slots[slot] !=
+         IREE_HAL_STATIC_LIBRARY_SLOT_EMPTY) {
+    const iree_hal_executable_library_header_t* header =
+        *executable_loader->libraries[executable_loader->slots[slot]].header;
+    if (iree_string_view_equal(name, iree_make_cstring_view(header->name))) {
+      break;
+    }
+    slot = (slot + 1) & executable_loader->slot_mask;
+  }
+  return &executable_loader->slots[slot];
+}
+
+// Resolves the imports of all libraries into the shared import table.
+// Symbols imported by multiple libraries are only resolved once.
+static iree_status_t iree_hal_static_library_loader_resolve_imports(
+    iree_hal_static_library_loader_t* executable_loader) {
+  if (!executable_loader->import_count) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_executable_import_provider_t import_provider =
+      executable_loader->base.import_provider;
+
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t import_offset = 0;
+  for (iree_host_size_t i = 0;
+       i < executable_loader->library_count && iree_status_is_ok(status); ++i) {
+    iree_hal_static_library_entry_t* library = &executable_loader->libraries[i];
+    const iree_hal_executable_library_v0_t* library_v0 =
+        (const iree_hal_executable_library_v0_t*)*library->header;
+    const iree_hal_executable_import_table_v0_t* import_table =
+        &library_v0->imports;
+    iree_hal_executable_import_v0_t* import_funcs =
+        &executable_loader->import_funcs[import_offset];
+    const void** import_contexts =
+        &executable_loader->import_contexts[import_offset];
+    library->import_funcs = import_funcs;
+    library->import_contexts = import_contexts;
+    for (uint32_t j = 0; j < import_table->count && iree_status_is_ok(status);
+         ++j) {
+      // Reuse the resolution from any prior library importing the same symbol.
+      // This is only performed on loader creation and import tables are small
+      // so a scan of the prior libraries is cheaper than building an index.
+      const char* symbol_name = import_table->symbols[j];
+      bool found = false;
+      for (iree_host_size_t k = 0; k < i && !found; ++k) {
+        const iree_hal_executable_import_table_v0_t* prior_table =
+            &((const iree_hal_executable_library_v0_t*)*executable_loader
+                  ->libraries[k]
+                  .header)
+                 ->imports;
+        for (uint32_t l = 0; l < prior_table->count; ++l) {
+          if (strcmp(symbol_name, prior_table->symbols[l]) == 0) {
+            import_funcs[j] = executable_loader->libraries[k].import_funcs[l];
+            import_contexts[j] =
+                executable_loader->libraries[k].import_contexts[l];
+            found = true;
+            break;
+          }
+        }
+      }
+      if (found) continue;
+      status = iree_hal_executable_import_provider_resolve(
+          import_provider, iree_make_cstring_view(symbol_name),
+          (void**)&import_funcs[j], (void**)&import_contexts[j]);
+    }
+    import_offset += import_table->count;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_static_library_loader_create(
     iree_host_size_t library_count,
     const iree_hal_executable_library_query_fn_t* library_query_fns,
@@ -207,53 +328,112 @@ iree_status_t iree_hal_static_library_loader_create(
   *out_executable_loader = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Default environment to enable initialization.
+  iree_hal_executable_environment_v0_t environment;
+  iree_hal_executable_environment_initialize(host_allocator, &environment);
+
+  // Query and verify the libraries provided all match our expected version.
+  // It's rare they won't, however static libraries generated with a newer
+  // version of the IREE compiler that are then linked with an older version
+  // of the runtime are difficult to spot otherwise.
+  //
+  // The headers are queried prior to allocating the loader so that the shared
+  // import table can be sized to hold the imports of all libraries.
+  iree_status_t status = iree_ok_status();
+  const iree_hal_executable_library_header_t*** header_ptrs = NULL;
+  if (library_count > 0) {
+    status = iree_allocator_malloc(host_allocator,
+                                   library_count * sizeof(*header_ptrs),
+                                   (void**)&header_ptrs);
+  }
+  iree_host_size_t import_count = 0;
+  for (iree_host_size_t i = 0; i < library_count && iree_status_is_ok(status);
+       ++i) {
+    const iree_hal_executable_library_header_t** header_ptr =
+        library_query_fns[i](IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
+                             &environment);
+    if (!header_ptr) {
+      status = iree_make_status(
+          IREE_STATUS_UNAVAILABLE,
+          "failed to query library header for runtime version %d",
+          IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+      break;
+    }
+    const iree_hal_executable_library_header_t* header = *header_ptr;
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, header->name);
+    if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
+      status = iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "executable does not support this version of the "
+          "runtime (executable: %d, runtime: %d)",
+          header->version, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+      break;
+    }
+    header_ptrs[i] = header_ptr;
+    import_count +=
+        ((const iree_hal_executable_library_v0_t*)header)->imports.count;
+  }
+
+  iree_host_size_t slot_capacity = 1;
+  while (slot_capacity < library_count * 2) slot_capacity <<= 1;
+
   iree_hal_static_library_loader_t* executable_loader = NULL;
-  iree_host_size_t total_size =
+  iree_host_size_t slots_offset = iree_host_align(
       sizeof(*executable_loader) +
-      sizeof(executable_loader->libraries[0]) * library_count;
-  iree_status_t status = iree_allocator_malloc(host_allocator, total_size,
-                                               (void**)&executable_loader);
+          library_count * sizeof(executable_loader->libraries[0]),
+      iree_max_align_t);
+  iree_host_size_t import_funcs_offset = iree_host_align(
+      slots_offset + slot_capacity * sizeof(executable_loader->slots[0]),
+      iree_max_align_t);
+  iree_host_size_t import_contexts_offset =
+      import_funcs_offset +
+      import_count * sizeof(executable_loader->import_funcs[0]);
+  iree_host_size_t total_size =
+      import_contexts_offset +
+      import_count * sizeof(executable_loader->import_contexts[0]);
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator, total_size,
+                                   (void**)&executable_loader);
+  }
   if (iree_status_is_ok(status)) {
     iree_hal_executable_loader_initialize(
         &iree_hal_static_library_loader_vtable, import_provider,
         &executable_loader->base);
     executable_loader->host_allocator = host_allocator;
+    executable_loader->slot_mask = slot_capacity - 1;
+    executable_loader->slots =
+        (uint32_t*)((uint8_t*)executable_loader + slots_offset);
+    memset(executable_loader->slots, 0xFF,
+           slot_capacity * sizeof(executable_loader->slots[0]));
+    executable_loader->import_count = import_count;
+    executable_loader->import_funcs =
+        (iree_hal_executable_import_v0_t*)((uint8_t*)executable_loader +
+                                           import_funcs_offset);
+    executable_loader->import_contexts =
+        (const void**)((uint8_t*)executable_loader + import_contexts_offset);
     executable_loader->library_count = library_count;
 
-    // Default environment to enable initialization.
-    iree_hal_executable_environment_v0_t environment;
-    iree_hal_executable_environment_initialize(host_allocator, &environment);
-
-    // Query and verify the libraries provided all match our expected version.
-    // It's rare they won't, however static libraries generated with a newer
-    // version of the IREE compiler that are then linked with an older version
-    // of the runtime are difficult to spot otherwise.
+    // Index the libraries by name; duplicates would otherwise be ambiguous.
     for (iree_host_size_t i = 0; i < library_count; ++i) {
-      const iree_hal_executable_library_header_t* const* header_ptr =
-          library_query_fns[i](IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
-                               &environment);
-      if (!header_ptr) {
-        status = iree_make_status(
-            IREE_STATUS_UNAVAILABLE,
-            "failed to query library header for runtime version %d",
-            IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
-        break;
-      }
-      const iree_hal_executable_library_header_t* header = *header_ptr;
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, header->name);
-      if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
-        status = iree_make_status(
-            IREE_STATUS_FAILED_PRECONDITION,
-            "executable does not support this version of the "
-            "runtime (executable: %d, runtime: %d)",
-            header->version, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+      executable_loader->libraries[i].header = header_ptrs[i];
+      iree_string_view_t name = iree_make_cstring_view((*header_ptrs[i])->name);
+      uint32_t* slot =
+          iree_hal_static_library_loader_find_slot(executable_loader, name);
+      if (*slot != IREE_HAL_STATIC_LIBRARY_SLOT_EMPTY) {
+        status = iree_make_status(IREE_STATUS_ALREADY_EXISTS,
+                                  "static library '%.*s' registered twice",
+                                  (int)name.size, name.data);
         break;
       }
-      memcpy((void*)&executable_loader->libraries[i], &header_ptr,
-             sizeof(header_ptr));
+      *slot = (uint32_t)i;
     }
   }
 
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_static_library_loader_resolve_imports(executable_loader);
+  }
+
+  iree_allocator_free(host_allocator, header_ptrs);
   if (iree_status_is_ok(status)) {
     *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
   } else {
@@ -296,25 +476,16 @@ static iree_status_t iree_hal_static_library_loader_try_load(
       (const char*)executable_params->executable_data.data,
       executable_params->executable_data.data_length);
 
-  // Linear scan of the registered libraries; there's usually only one per
-  // module (aka source model) and as such it's a small list and probably not
-  // worth optimizing. We could sort the libraries list by name on loader
-  // creation to perform a binary-search fairly easily, though, at the cost of
-  // the additional code size.
-  for (iree_host_size_t i = 0; i < executable_loader->library_count; ++i) {
-    const iree_hal_executable_library_header_t* header =
-        *executable_loader->libraries[i];
-    if (iree_string_view_equal(library_name,
-                               iree_make_cstring_view(header->name))) {
-      return iree_hal_static_executable_create(
-          executable_params, executable_loader->libraries[i],
-          base_executable_loader->import_provider,
-          executable_loader->host_allocator, out_executable);
-    }
+  uint32_t library_ordinal = *iree_hal_static_library_loader_find_slot(
+      executable_loader, library_name);
+  if (library_ordinal == IREE_HAL_STATIC_LIBRARY_SLOT_EMPTY) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "no static library with the name '%.*s' registered",
+                            (int)library_name.size, library_name.data);
   }
-  return iree_make_status(IREE_STATUS_NOT_FOUND,
-                          "no static library with the name '%.*s' registered",
-                          (int)library_name.size, library_name.data);
+  return iree_hal_static_executable_create(
+      executable_params, &executable_loader->libraries[library_ordinal],
+      executable_loader->host_allocator, out_executable);
 }
 
 static const iree_hal_executable_loader_vtable_t
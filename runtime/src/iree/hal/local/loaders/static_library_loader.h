@@ -28,11 +28,17 @@ extern "C" {
 // The name defined on each library will be used to lookup the executables and
 // must match with the names used during compilation exactly. The
 // iree_hal_executable_params_t used to reference the executables will contain
-// the library name and be used to lookup the library in the list.
+// the library name and be used to lookup the library by hash. Registering two
+// libraries with the same name fails with IREE_STATUS_ALREADY_EXISTS.
+//
+// Imports of all libraries are resolved via |import_provider| when the loader
+// is created and stored in a single table shared by every executable loaded
+// from the libraries; symbols imported by multiple libraries are resolved only
+// once. Failure to resolve a non-weak import fails loader creation.
 //
 // Multiple static library loaders can be registered in cases when several
-// independent sets of libraries are linked in however duplicate names both
-// within and across loaders will result in undefined behavior.
+// independent sets of libraries are linked in however duplicate names across
+// loaders will result in undefined behavior.
 iree_status_t iree_hal_static_library_loader_create(
     iree_host_size_t library_count,
     const iree_hal_executable_library_query_fn_t* library_query_fns,
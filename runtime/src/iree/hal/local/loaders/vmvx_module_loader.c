@@ -351,11 +351,17 @@ static void iree_hal_vmvx_executable_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
-static iree_status_t iree_hal_vmvx_executable_issue_call(
+// Issues the workgroups in the half-open range [workgroup_begin,
+// workgroup_end) of the dispatch grid linearized with x varying fastest.
+//
+// The binding list, buffers, and VM stack are set up once and shared by all of
+// the workgroups in the range so that the per-workgroup cost is only that of
+// the VM call itself.
+static iree_status_t iree_hal_vmvx_executable_issue_workgroup_range(
     iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
-    uint32_t worker_id) {
+    uint32_t workgroup_begin, uint32_t workgroup_end, uint32_t worker_id) {
   iree_hal_vmvx_executable_t* executable =
       (iree_hal_vmvx_executable_t*)base_executable;
 
@@ -381,12 +387,10 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   iree_vmvx_module_state_update_workgroup_state(worker_state->vmvx_module_state,
                                                 workgroup_state->processor_id);
 
-  // On-stack interface local to this invocation.
+  // On-stack interface local to this range of workgroups.
   // Note that we _could_ share this across all invocations in a dispatch, but
   // it's tricky to find a good place when threading is happening and it's
   // intentionally fairly cheap to construct by matching the dispatch_state.
-  // The list would only need to be constructed once and we could avoid the
-  // extraneous retain/releases and mappings.
   iree_vm_type_def_t buffer_type =
       iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
   iree_host_size_t binding_list_size =
@@ -476,27 +480,6 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
     uint32_t workgroup_count_y;
     uint32_t workgroup_count_z;
   } call_args = {
-      .local_memory =
-          {
-              .type = iree_vm_buffer_type_id(),
-              .ptr = &local_memory_buffer,
-              .offsetof_counter = 0,
-          },
-      .constants =
-          {
-              .type = iree_vm_buffer_type_id(),
-              .ptr = &constants_buffer,
-              .offsetof_counter = 0,
-          },
-      .bindings =
-          {
-              .type = iree_vm_list_type_id(),
-              .ptr = binding_list,
-              .offsetof_counter = 0,
-          },
-      .workgroup_id_x = workgroup_state->workgroup_id_x,
-      .workgroup_id_y = workgroup_state->workgroup_id_y,
-      .workgroup_id_z = workgroup_state->workgroup_id_z,
       .workgroup_size_x = dispatch_state->workgroup_size_x,
       .workgroup_size_y = dispatch_state->workgroup_size_y,
       .workgroup_size_z = dispatch_state->workgroup_size_z,
@@ -504,11 +487,12 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
       .workgroup_count_y = dispatch_state->workgroup_count_y,
       .workgroup_count_z = dispatch_state->workgroup_count_z,
   };
-
-  // Call arguments are retained by the caller.
-  iree_vm_list_retain(binding_list);            // for call
-  iree_vm_buffer_retain(&local_memory_buffer);  // for call
-  iree_vm_buffer_retain(&constants_buffer);     // for call
+  call_args.workgroup_id_x = workgroup_begin % call_args.workgroup_count_x;
+  call_args.workgroup_id_y =
+      (workgroup_begin / call_args.workgroup_count_x) %
+      call_args.workgroup_count_y;
+  call_args.workgroup_id_z = workgroup_begin / call_args.workgroup_count_x /
+                             call_args.workgroup_count_y;
 
   // VM stack stored on native stack. We really do abuse the stack too much
   // here but it's 8KB and that should be reasonable given that there isn't too
@@ -527,7 +511,37 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   call.function = entry_fn;
   call.arguments = iree_make_byte_span(&call_args, sizeof(call_args));
   call.results = iree_make_byte_span(NULL, 0);
-  status = entry_fn.module->begin_call(entry_fn.module->self, stack, call);
+  for (uint32_t i = workgroup_begin; i < workgroup_end; ++i) {
+    // Call arguments are retained by the caller and moved into the callee so
+    // they must be reset for each call.
+    call_args.local_memory = (iree_vm_ref_t){
+        .type = iree_vm_buffer_type_id(),
+        .ptr = &local_memory_buffer,
+        .offsetof_counter = 0,
+    };
+    call_args.constants = (iree_vm_ref_t){
+        .type = iree_vm_buffer_type_id(),
+        .ptr = &constants_buffer,
+        .offsetof_counter = 0,
+    };
+    call_args.bindings = (iree_vm_ref_t){
+        .type = iree_vm_list_type_id(),
+        .ptr = binding_list,
+        .offsetof_counter = 0,
+    };
+    iree_vm_list_retain(binding_list);            // for call
+    iree_vm_buffer_retain(&local_memory_buffer);  // for call
+    iree_vm_buffer_retain(&constants_buffer);     // for call
+    status = entry_fn.module->begin_call(entry_fn.module->self, stack, call);
+    if (!iree_status_is_ok(status)) break;
+    if (++call_args.workgroup_id_x == call_args.workgroup_count_x) {
+      call_args.workgroup_id_x = 0;
+      if (++call_args.workgroup_id_y == call_args.workgroup_count_y) {
+        call_args.workgroup_id_y = 0;
+        ++call_args.workgroup_id_z;
+      }
+    }
+  }
 
   // Clean up the stack if needed, such as when the call fails.
   iree_vm_stack_deinitialize(stack);
@@ -542,6 +556,21 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   return status;
 }
 
+static iree_status_t iree_hal_vmvx_executable_issue_call(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  uint32_t workgroup_index =
+      workgroup_state->workgroup_id_x +
+      dispatch_state->workgroup_count_x *
+          (workgroup_state->workgroup_id_y +
+           dispatch_state->workgroup_count_y * workgroup_state->workgroup_id_z);
+  return iree_hal_vmvx_executable_issue_workgroup_range(
+      base_executable, ordinal, dispatch_state, workgroup_state,
+      workgroup_index, workgroup_index + 1, worker_id);
+}
+
 static const iree_hal_local_executable_vtable_t
     iree_hal_vmvx_executable_vtable = {
         .base =
@@ -549,6 +578,7 @@ static const iree_hal_local_executable_vtable_t
                 .destroy = iree_hal_vmvx_executable_destroy,
             },
         .issue_call = iree_hal_vmvx_executable_issue_call,
+        .issue_workgroup_range = iree_hal_vmvx_executable_issue_workgroup_range,
 };
 
 //===----------------------------------------------------------------------===//
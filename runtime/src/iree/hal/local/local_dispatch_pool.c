@@ -0,0 +1,362 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_dispatch_pool.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iree/base/tracing.h"
+
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE || defined(IREE_PLATFORM_GENERIC)
+
+// Threads are not available; creation fails and callers execute inline.
+
+iree_status_t iree_hal_local_dispatch_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "dispatch pools require thread support");
+}
+
+void iree_hal_local_dispatch_pool_free(iree_hal_local_dispatch_pool_t* pool) {}
+
+iree_host_size_t iree_hal_local_dispatch_pool_concurrency(
+    iree_hal_local_dispatch_pool_t* pool) {
+  return 1;
+}
+
+iree_status_t iree_hal_local_dispatch_pool_issue(
+    iree_hal_local_dispatch_pool_t* pool,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    uint32_t processor_id, iree_byte_span_t local_memory) {
+  return iree_hal_local_executable_issue_dispatch_inline(
+      executable, ordinal, dispatch_state, processor_id, local_memory);
+}
+
+#else
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/fpu_state.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+
+// Number of workgroup ranges each participating thread claims per dispatch on
+// average. More ranges balance uneven workgroups better at the cost of more
+// atomic operations on the shared counter.
+#define IREE_HAL_LOCAL_DISPATCH_POOL_RANGES_PER_THREAD 4
+
+typedef struct iree_hal_local_dispatch_pool_worker_t {
+  iree_hal_local_dispatch_pool_t* pool;
+  iree_thread_t* thread;
+  // Worker ID passed to the executable; 0 is reserved for the issuing thread.
+  uint32_t worker_id;
+  // Last dispatch epoch the worker has executed.
+  int32_t epoch;
+  // Local memory owned by the worker and grown as dispatches require.
+  iree_byte_span_t local_memory;
+} iree_hal_local_dispatch_pool_worker_t;
+
+struct iree_hal_local_dispatch_pool_t {
+  iree_allocator_t host_allocator;
+
+  // Held while a dispatch is executing on the pool.
+  iree_slim_mutex_t issue_mutex;
+
+  // Incremented for each dispatch issued to the pool. Workers wait for it to
+  // change and then execute the current dispatch.
+  iree_atomic_int32_t epoch;
+  iree_notification_t epoch_notification;
+  // Set when the pool is being freed and workers must exit.
+  iree_atomic_int32_t exit_requested;
+
+  // The dispatch currently executing. Only valid while |issue_mutex| is held
+  // and published to workers by incrementing |epoch|.
+  struct {
+    iree_hal_local_executable_t* executable;
+    iree_host_size_t ordinal;
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state;
+    iree_host_size_t local_memory_size;
+    uint32_t workgroup_count;
+    uint32_t range_size;
+  } dispatch;
+  // Next unclaimed workgroup of the current dispatch.
+  iree_atomic_int64_t next_workgroup;
+  // Workers that have not yet finished the current dispatch.
+  iree_atomic_int32_t pending_worker_count;
+  iree_notification_t done_notification;
+  // First failure of the current dispatch, if any.
+  iree_atomic_intptr_t status;
+
+  iree_host_size_t worker_count;
+  iree_hal_local_dispatch_pool_worker_t workers[];
+};
+
+static int iree_hal_local_dispatch_pool_worker_main(
+    iree_hal_local_dispatch_pool_worker_t* worker);
+
+iree_status_t iree_hal_local_dispatch_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  if (worker_count == 0 ||
+      worker_count > IREE_HAL_LOCAL_DISPATCH_POOL_MAX_WORKER_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "dispatch pool worker count %" PRIhsz
+                            " out of range [1, %d]",
+                            worker_count,
+                            IREE_HAL_LOCAL_DISPATCH_POOL_MAX_WORKER_COUNT);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)worker_count);
+
+  iree_hal_local_dispatch_pool_t* pool = NULL;
+  iree_host_size_t total_size =
+      sizeof(*pool) + worker_count * sizeof(pool->workers[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&pool));
+  memset(pool, 0, total_size);
+  pool->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&pool->issue_mutex);
+  iree_notification_initialize(&pool->epoch_notification);
+  iree_notification_initialize(&pool->done_notification);
+  pool->worker_count = worker_count;
+
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = iree_make_cstring_view("iree-dispatch");
+  thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+  iree_thread_affinity_set_any(&thread_params.initial_affinity);
+
+  // NOTE: on failure the workers already started are stopped by the free.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < worker_count; ++i) {
+    iree_hal_local_dispatch_pool_worker_t* worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->worker_id = (uint32_t)(i + 1);
+    status = iree_thread_create(
+        (iree_thread_entry_t)iree_hal_local_dispatch_pool_worker_main, worker,
+        thread_params, host_allocator, &worker->thread);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_hal_local_dispatch_pool_free(pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_local_dispatch_pool_free(iree_hal_local_dispatch_pool_t* pool) {
+  if (!pool) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wake all workers and join them; releasing a thread waits for it to exit.
+  iree_atomic_store_int32(&pool->exit_requested, 1, iree_memory_order_release);
+  iree_notification_post(&pool->epoch_notification, IREE_ALL_WAITERS);
+  for (iree_host_size_t i = 0; i < pool->worker_count; ++i) {
+    iree_hal_local_dispatch_pool_worker_t* worker = &pool->workers[i];
+    iree_thread_release(worker->thread);
+    iree_allocator_free(pool->host_allocator, worker->local_memory.data);
+  }
+
+  iree_notification_deinitialize(&pool->done_notification);
+  iree_notification_deinitialize(&pool->epoch_notification);
+  iree_slim_mutex_deinitialize(&pool->issue_mutex);
+  iree_allocator_free(pool->host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_hal_local_dispatch_pool_concurrency(
+    iree_hal_local_dispatch_pool_t* pool) {
+  return pool->worker_count + 1;
+}
+
+// Records |status| as the result of the current dispatch if it is the first
+// failure and stops any further workgroups from being claimed.
+static void iree_hal_local_dispatch_pool_fail(
+    iree_hal_local_dispatch_pool_t* pool, iree_status_t status) {
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_intptr(
+          &pool->status, &expected, (intptr_t)status,
+          iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+    iree_status_ignore(status);
+  }
+  iree_atomic_store_int64(&pool->next_workgroup,
+                          (int64_t)pool->dispatch.workgroup_count,
+                          iree_memory_order_relaxed);
+}
+
+// Claims and executes ranges of the current dispatch until none remain.
+static void iree_hal_local_dispatch_pool_execute(
+    iree_hal_local_dispatch_pool_t* pool, uint32_t worker_id,
+    uint32_t processor_id, iree_byte_span_t local_memory) {
+  const int64_t workgroup_count = (int64_t)pool->dispatch.workgroup_count;
+  const uint32_t range_size = pool->dispatch.range_size;
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t workgroup_state = {
+      .workgroup_id_x = 0,
+      .workgroup_id_y = 0,
+      .workgroup_id_z = 0,
+      .processor_id = processor_id,
+      .local_memory = local_memory.data,
+      .local_memory_size = (size_t)local_memory.data_length,
+  };
+  for (;;) {
+    int64_t workgroup_begin = iree_atomic_fetch_add_int64(
+        &pool->next_workgroup, range_size, iree_memory_order_relaxed);
+    if (workgroup_begin >= workgroup_count) break;
+    int64_t workgroup_end =
+        iree_min(workgroup_begin + (int64_t)range_size, workgroup_count);
+    iree_status_t status = iree_hal_local_executable_issue_workgroup_range(
+        pool->dispatch.executable, pool->dispatch.ordinal,
+        pool->dispatch.dispatch_state, &workgroup_state,
+        (uint32_t)workgroup_begin, (uint32_t)workgroup_end, worker_id);
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+      iree_hal_local_dispatch_pool_fail(pool, status);
+      break;
+    }
+  }
+}
+
+// Ensures the worker local memory has at least |minimum_size| bytes.
+static iree_status_t iree_hal_local_dispatch_pool_worker_reserve_local_memory(
+    iree_hal_local_dispatch_pool_worker_t* worker,
+    iree_host_size_t minimum_size) {
+  if (minimum_size <= worker->local_memory.data_length) {
+    return iree_ok_status();
+  }
+  iree_allocator_t host_allocator = worker->pool->host_allocator;
+  iree_allocator_free(host_allocator, worker->local_memory.data);
+  worker->local_memory = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, minimum_size, (void**)&worker->local_memory.data));
+  worker->local_memory.data_length = minimum_size;
+  return iree_ok_status();
+}
+
+static bool iree_hal_local_dispatch_pool_worker_should_wake(
+    iree_hal_local_dispatch_pool_worker_t* worker) {
+  iree_hal_local_dispatch_pool_t* pool = worker->pool;
+  return iree_atomic_load_int32(&pool->exit_requested,
+                                iree_memory_order_acquire) ||
+         iree_atomic_load_int32(&pool->epoch, iree_memory_order_acquire) !=
+             worker->epoch;
+}
+
+static int iree_hal_local_dispatch_pool_worker_main(
+    iree_hal_local_dispatch_pool_worker_t* worker) {
+  iree_hal_local_dispatch_pool_t* pool = worker->pool;
+
+  // We cannot rely on the global process settings for FPU state.
+  iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+
+  for (;;) {
+    iree_notification_await(
+        &pool->epoch_notification,
+        (iree_condition_fn_t)iree_hal_local_dispatch_pool_worker_should_wake,
+        worker, iree_infinite_timeout());
+    if (iree_atomic_load_int32(&pool->exit_requested,
+                               iree_memory_order_acquire)) {
+      break;
+    }
+    worker->epoch =
+        iree_atomic_load_int32(&pool->epoch, iree_memory_order_acquire);
+
+    iree_status_t status =
+        iree_hal_local_dispatch_pool_worker_reserve_local_memory(
+            worker, pool->dispatch.local_memory_size);
+    if (iree_status_is_ok(status)) {
+      iree_hal_local_dispatch_pool_execute(
+          pool, worker->worker_id, iree_cpu_query_processor_id(),
+          iree_make_byte_span(worker->local_memory.data,
+                              pool->dispatch.local_memory_size));
+    } else {
+      iree_hal_local_dispatch_pool_fail(pool, status);
+    }
+
+    // The last worker to finish releases the issuing thread.
+    if (iree_atomic_fetch_sub_int32(&pool->pending_worker_count, 1,
+                                    iree_memory_order_acq_rel) == 1) {
+      iree_notification_post(&pool->done_notification, IREE_ALL_WAITERS);
+    }
+  }
+
+  return 0;
+}
+
+static bool iree_hal_local_dispatch_pool_is_done(
+    iree_hal_local_dispatch_pool_t* pool) {
+  return iree_atomic_load_int32(&pool->pending_worker_count,
+                                iree_memory_order_acquire) == 0;
+}
+
+iree_status_t iree_hal_local_dispatch_pool_issue(
+    iree_hal_local_dispatch_pool_t* pool,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    uint32_t processor_id, iree_byte_span_t local_memory) {
+  const uint64_t workgroup_count = (uint64_t)dispatch_state->workgroup_count_x *
+                                   dispatch_state->workgroup_count_y *
+                                   dispatch_state->workgroup_count_z;
+
+  // Dispatches that can't be split and those issued while another thread is
+  // using the pool execute on the calling thread.
+  if (workgroup_count <= 1 || workgroup_count > UINT32_MAX ||
+      !iree_slim_mutex_try_lock(&pool->issue_mutex)) {
+    return iree_hal_local_executable_issue_dispatch_inline(
+        executable, ordinal, dispatch_state, processor_id, local_memory);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)workgroup_count);
+
+  const iree_host_size_t concurrency =
+      iree_hal_local_dispatch_pool_concurrency(pool);
+  uint64_t range_count =
+      concurrency * IREE_HAL_LOCAL_DISPATCH_POOL_RANGES_PER_THREAD;
+  pool->dispatch.executable = executable;
+  pool->dispatch.ordinal = ordinal;
+  pool->dispatch.dispatch_state = dispatch_state;
+  pool->dispatch.local_memory_size = local_memory.data_length;
+  pool->dispatch.workgroup_count = (uint32_t)workgroup_count;
+  pool->dispatch.range_size = (uint32_t)iree_max(
+      (uint64_t)1, (workgroup_count + range_count - 1) / range_count);
+  iree_atomic_store_int64(&pool->next_workgroup, 0, iree_memory_order_relaxed);
+  iree_atomic_store_intptr(&pool->status, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&pool->pending_worker_count,
+                          (int32_t)pool->worker_count,
+                          iree_memory_order_relaxed);
+
+  // Publish the dispatch to the workers and join in executing it.
+  iree_atomic_fetch_add_int32(&pool->epoch, 1, iree_memory_order_acq_rel);
+  iree_notification_post(&pool->epoch_notification, IREE_ALL_WAITERS);
+  iree_hal_local_dispatch_pool_execute(pool, /*worker_id=*/0, processor_id,
+                                       local_memory);
+
+  // Wait for all workers to finish; they may still be executing the last
+  // ranges they claimed.
+  iree_notification_await(
+      &pool->done_notification,
+      (iree_condition_fn_t)iree_hal_local_dispatch_pool_is_done, pool,
+      iree_infinite_timeout());
+  iree_status_t status = (iree_status_t)iree_atomic_exchange_intptr(
+      &pool->status, 0, iree_memory_order_acquire);
+
+  iree_slim_mutex_unlock(&pool->issue_mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE || IREE_PLATFORM_GENERIC
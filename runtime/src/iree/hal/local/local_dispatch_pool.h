@@ -0,0 +1,68 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_LOCAL_DISPATCH_POOL_H_
+#define IREE_HAL_LOCAL_LOCAL_DISPATCH_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_executable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of worker threads in a dispatch pool. The thread issuing a
+// dispatch also executes workgroups and the total concurrency must fit in
+// iree_hal_executable_dispatch_state_v0_t::max_concurrency.
+#define IREE_HAL_LOCAL_DISPATCH_POOL_MAX_WORKER_COUNT 63
+
+// A small fixed pool of threads that execute the workgroups of one dispatch at
+// a time alongside the thread issuing it.
+//
+// This is intended for inline execution on deployments where the full task
+// system is too large: there is no task graph, queueing or work stealing.
+// The workgroup grid is split into contiguous ranges that the workers and the
+// issuing thread claim from a shared counter and the issuing thread blocks
+// until all workers have finished the dispatch.
+//
+// Only one dispatch runs on the pool at a time. If another thread issues a
+// dispatch while the pool is busy that dispatch executes entirely on the
+// issuing thread instead of waiting.
+typedef struct iree_hal_local_dispatch_pool_t iree_hal_local_dispatch_pool_t;
+
+// Creates a dispatch pool with |worker_count| threads in addition to the
+// threads issuing dispatches. Returns IREE_STATUS_UNAVAILABLE if threads are
+// not supported in the current configuration.
+iree_status_t iree_hal_local_dispatch_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_pool_t** out_pool);
+
+// Stops and joins all worker threads and frees the |pool|.
+// Must not be called while any dispatch is being issued to the pool.
+void iree_hal_local_dispatch_pool_free(iree_hal_local_dispatch_pool_t* pool);
+
+// Returns the maximum number of threads that may execute workgroups of a
+// single dispatch, including the issuing thread.
+iree_host_size_t iree_hal_local_dispatch_pool_concurrency(
+    iree_hal_local_dispatch_pool_t* pool);
+
+// Executes all workgroups of the dispatch of |ordinal| described by
+// |dispatch_state| and returns once they have completed. The calling thread
+// executes workgroups as worker 0 with the given |processor_id| and
+// |local_memory|; pool workers allocate their own local memory of the same
+// size. Returns the first failure of any workgroup.
+iree_status_t iree_hal_local_dispatch_pool_issue(
+    iree_hal_local_dispatch_pool_t* pool,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    uint32_t processor_id, iree_byte_span_t local_memory);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_LOCAL_DISPATCH_POOL_H_
@@ -0,0 +1,241 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_dispatch_profiler.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
+
+// Set while a profiler is active; timing is process-wide.
+static iree_atomic_int32_t iree_hal_local_dispatch_profiler_active_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+struct iree_hal_local_dispatch_profiler_t {
+  iree_allocator_t host_allocator;
+  // NUL-terminated report file path or NULL to write to stdout.
+  char* file_path;
+};
+
+static void iree_hal_local_dispatch_profiler_free(
+    iree_hal_local_dispatch_profiler_t* profiler) {
+  iree_allocator_t host_allocator = profiler->host_allocator;
+  iree_allocator_free(host_allocator, profiler->file_path);
+  iree_allocator_free(host_allocator, profiler);
+}
+
+iree_status_t iree_hal_local_dispatch_profiler_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  const iree_hal_device_profiling_mode_t counter_modes =
+      IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS |
+      IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS;
+  if (!iree_any_bit_set(options->mode, counter_modes)) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int32_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_int32(
+          &iree_hal_local_dispatch_profiler_active_, &expected, 1,
+          iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "a local dispatch profile is already active");
+  }
+
+  iree_hal_local_dispatch_profiler_t* profiler = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*profiler), (void**)&profiler);
+  if (iree_status_is_ok(status)) {
+    profiler->host_allocator = host_allocator;
+    profiler->file_path = NULL;
+    if (options->file_path && strlen(options->file_path) > 0) {
+      status = iree_allocator_clone(
+          host_allocator,
+          iree_make_const_byte_span(options->file_path,
+                                    strlen(options->file_path) + 1),
+          (void**)&profiler->file_path);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_local_executable_timing_reset();
+    status = iree_hal_local_executable_timing_set_enabled(true);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_profiler = profiler;
+  } else {
+    if (profiler) iree_hal_local_dispatch_profiler_free(profiler);
+    iree_atomic_store_int32(&iree_hal_local_dispatch_profiler_active_, 0,
+                            iree_memory_order_release);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+typedef struct iree_hal_local_dispatch_profiler_row_t {
+  // NUL-terminated export name owned by the row list.
+  char* name;
+  iree_hal_local_executable_export_timing_t timing;
+} iree_hal_local_dispatch_profiler_row_t;
+
+typedef struct iree_hal_local_dispatch_profiler_row_list_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+  iree_hal_local_dispatch_profiler_row_t* values;
+  // Total time across all rows.
+  uint64_t total_ns;
+  // First failure while gathering rows; gathering stops once set.
+  iree_status_t status;
+} iree_hal_local_dispatch_profiler_row_list_t;
+
+static void iree_hal_local_dispatch_profiler_row_list_deinitialize(
+    iree_hal_local_dispatch_profiler_row_list_t* rows) {
+  for (iree_host_size_t i = 0; i < rows->count; ++i) {
+    iree_allocator_free(rows->host_allocator, rows->values[i].name);
+  }
+  iree_allocator_free(rows->host_allocator, rows->values);
+  iree_status_ignore(rows->status);
+}
+
+static iree_status_t iree_hal_local_dispatch_profiler_row_list_append(
+    iree_hal_local_dispatch_profiler_row_list_t* rows, iree_string_view_t name,
+    const iree_hal_local_executable_export_timing_t* timing) {
+  // Exports with the same name in different executables share a row.
+  for (iree_host_size_t i = 0; i < rows->count; ++i) {
+    iree_hal_local_dispatch_profiler_row_t* row = &rows->values[i];
+    if (iree_string_view_equal(iree_make_cstring_view(row->name), name)) {
+      row->timing.dispatch_count += timing->dispatch_count;
+      row->timing.workgroup_count += timing->workgroup_count;
+      row->timing.total_ns += timing->total_ns;
+      return iree_ok_status();
+    }
+  }
+  if (rows->count == rows->capacity) {
+    iree_host_size_t new_capacity = iree_max(16, rows->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        rows->host_allocator, new_capacity * sizeof(rows->values[0]),
+        (void**)&rows->values));
+    rows->capacity = new_capacity;
+  }
+  char* name_copy = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      rows->host_allocator, name.size + 1, (void**)&name_copy));
+  memcpy(name_copy, name.data, name.size);
+  name_copy[name.size] = 0;
+  iree_hal_local_dispatch_profiler_row_t* row = &rows->values[rows->count++];
+  row->name = name_copy;
+  row->timing = *timing;
+  return iree_ok_status();
+}
+
+static void iree_hal_local_dispatch_profiler_gather_export(
+    void* user_data, iree_hal_local_executable_t* executable,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_timing_t* timing) {
+  iree_hal_local_dispatch_profiler_row_list_t* rows =
+      (iree_hal_local_dispatch_profiler_row_list_t*)user_data;
+  if (!iree_status_is_ok(rows->status)) return;
+  if (timing->dispatch_count == 0 && timing->total_ns == 0) return;
+  char fallback_name[64];
+  if (iree_string_view_is_empty(export_name)) {
+    int length = snprintf(fallback_name, sizeof(fallback_name),
+                          "%p:%" PRIhsz, (void*)executable, ordinal);
+    export_name = iree_make_string_view(
+        fallback_name, (iree_host_size_t)iree_max(0, length));
+  }
+  rows->total_ns += timing->total_ns;
+  rows->status =
+      iree_hal_local_dispatch_profiler_row_list_append(rows, export_name,
+                                                       timing);
+}
+
+// Orders rows by descending total time so the exports most worth tuning come
+// first.
+static int iree_hal_local_dispatch_profiler_row_compare(const void* lhs_ptr,
+                                                        const void* rhs_ptr) {
+  const iree_hal_local_dispatch_profiler_row_t* lhs =
+      (const iree_hal_local_dispatch_profiler_row_t*)lhs_ptr;
+  const iree_hal_local_dispatch_profiler_row_t* rhs =
+      (const iree_hal_local_dispatch_profiler_row_t*)rhs_ptr;
+  if (lhs->timing.total_ns == rhs->timing.total_ns) return 0;
+  return lhs->timing.total_ns > rhs->timing.total_ns ? -1 : 1;
+}
+
+static iree_status_t iree_hal_local_dispatch_profiler_write_report(
+    iree_hal_local_dispatch_profiler_t* profiler,
+    const iree_hal_local_dispatch_profiler_row_list_t* rows) {
+  FILE* file = stdout;
+  if (profiler->file_path) {
+    file = fopen(profiler->file_path, "wb");
+    if (!file) {
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "unable to open profile output file '%s'",
+                              profiler->file_path);
+    }
+  }
+  fprintf(file, "export,count,total_ns,mean_ns,workgroups,percent\n");
+  for (iree_host_size_t i = 0; i < rows->count; ++i) {
+    const iree_hal_local_dispatch_profiler_row_t* row = &rows->values[i];
+    const iree_hal_local_executable_export_timing_t* timing = &row->timing;
+    fprintf(file,
+            "\"%s\",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.2f\n",
+            row->name, timing->dispatch_count, timing->total_ns,
+            timing->dispatch_count ? timing->total_ns / timing->dispatch_count
+                                   : 0,
+            timing->workgroup_count,
+            rows->total_ns
+                ? 100.0 * (double)timing->total_ns / (double)rows->total_ns
+                : 0.0);
+  }
+  if (file == stdout) {
+    fflush(file);
+  } else {
+    fclose(file);
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_local_dispatch_profiler_end(
+    iree_hal_local_dispatch_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_IGNORE_ERROR(iree_hal_local_executable_timing_set_enabled(false));
+
+  iree_hal_local_dispatch_profiler_row_list_t rows;
+  memset(&rows, 0, sizeof(rows));
+  rows.host_allocator = profiler->host_allocator;
+  rows.status = iree_ok_status();
+  iree_hal_local_executable_timing_enumerate(
+      iree_hal_local_dispatch_profiler_gather_export, &rows);
+  iree_status_t status = rows.status;
+  rows.status = iree_ok_status();
+  if (iree_status_is_ok(status)) {
+    if (rows.count > 0) {
+      qsort(rows.values, rows.count, sizeof(rows.values[0]),
+            iree_hal_local_dispatch_profiler_row_compare);
+    }
+    status = iree_hal_local_dispatch_profiler_write_report(profiler, &rows);
+  }
+  iree_hal_local_dispatch_profiler_row_list_deinitialize(&rows);
+
+  iree_hal_local_dispatch_profiler_free(profiler);
+  iree_atomic_store_int32(&iree_hal_local_dispatch_profiler_active_, 0,
+                          iree_memory_order_release);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,48 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_LOCAL_DISPATCH_PROFILER_H_
+#define IREE_HAL_LOCAL_LOCAL_DISPATCH_PROFILER_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Measures the time spent in each executable export dispatched on local CPU
+// devices and writes a CSV report sorted by total time when ended. This is the
+// local counterpart of the Vulkan timestamp and CUDA CUPTI profilers and uses
+// the same leading columns so reports can be compared across drivers.
+//
+// Timing uses iree_hal_local_executable_timing_set_enabled and is process-wide:
+// all local executables are measured while any profiler is active and only one
+// may be active at a time. Both the DISPATCH_COUNTERS and EXECUTABLE_COUNTERS
+// profiling modes report one row per export as individual dispatches are not
+// recorded.
+typedef struct iree_hal_local_dispatch_profiler_t
+    iree_hal_local_dispatch_profiler_t;
+
+// Begins measuring dispatches as configured by |options|. The report is
+// written to |options->file_path| or stdout if none is given. Sets
+// |out_profiler| to NULL without failing if |options| does not request a
+// dispatch counter mode.
+iree_status_t iree_hal_local_dispatch_profiler_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_profiler_t** out_profiler);
+
+// Stops measuring, writes the report, and frees |profiler|. All profiled work
+// that was submitted must have completed.
+iree_status_t iree_hal_local_dispatch_profiler_end(
+    iree_hal_local_dispatch_profiler_t* profiler);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_LOCAL_DISPATCH_PROFILER_H_
@@ -6,9 +6,569 @@
 
 #include "iree/hal/local/local_executable.h"
 
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_environment.h"
 
+#if IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+
+//===----------------------------------------------------------------------===//
+// Hardware performance counters
+//===----------------------------------------------------------------------===//
+
+// Number of values stored per export: the call count followed by each counter.
+#define IREE_HAL_LOCAL_EXECUTABLE_COUNTER_STRIDE \
+  (1 + IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT)
+
+typedef struct iree_hal_local_executable_counters_t {
+  // Executable the counters are recorded for.
+  iree_hal_local_executable_t* executable;
+  // Intrusive list of all live counters guarded by the registry mutex.
+  struct iree_hal_local_executable_counters_t* prev;
+  struct iree_hal_local_executable_counters_t* next;
+  iree_host_size_t export_count;
+  // export_count * IREE_HAL_LOCAL_EXECUTABLE_COUNTER_STRIDE values.
+  iree_atomic_int64_t values[];
+} iree_hal_local_executable_counters_t;
+
+static iree_atomic_int32_t iree_hal_local_executable_counters_enabled_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+const char* iree_hal_local_executable_counter_name(
+    iree_hal_local_executable_counter_t counter) {
+  switch (counter) {
+    case IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CYCLES:
+      return "cycles";
+    case IREE_HAL_LOCAL_EXECUTABLE_COUNTER_INSTRUCTIONS:
+      return "instructions";
+    case IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CACHE_REFERENCES:
+      return "cache_references";
+    case IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CACHE_MISSES:
+      return "cache_misses";
+    case IREE_HAL_LOCAL_EXECUTABLE_COUNTER_BRANCH_MISSES:
+      return "branch_misses";
+    default:
+      return "unknown";
+  }
+}
+
+bool iree_hal_local_executable_counters_is_enabled(void) {
+  return iree_atomic_load_int32(&iree_hal_local_executable_counters_enabled_,
+                                iree_memory_order_relaxed) != 0;
+}
+
+#if IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+
+// Registry of all live executables recording counters.
+static iree_once_flag iree_hal_local_executable_counters_once_ =
+    IREE_ONCE_FLAG_INIT;
+static iree_slim_mutex_t iree_hal_local_executable_counters_mutex_;
+static iree_hal_local_executable_counters_t*
+    iree_hal_local_executable_counters_head_ = NULL;
+
+// Key used to close the counter group of a thread when it exits.
+static pthread_key_t iree_hal_local_executable_perf_key_;
+static bool iree_hal_local_executable_perf_key_valid_ = false;
+
+static void iree_hal_local_executable_perf_group_close(void* group_ptr);
+
+static void iree_hal_local_executable_counters_initialize(void) {
+  iree_slim_mutex_initialize(&iree_hal_local_executable_counters_mutex_);
+  iree_hal_local_executable_perf_key_valid_ =
+      pthread_key_create(&iree_hal_local_executable_perf_key_,
+                         iree_hal_local_executable_perf_group_close) == 0;
+}
+
+iree_status_t iree_hal_local_executable_counters_set_enabled(bool enabled) {
+  iree_call_once(&iree_hal_local_executable_counters_once_,
+                 iree_hal_local_executable_counters_initialize);
+  iree_atomic_store_int32(&iree_hal_local_executable_counters_enabled_,
+                          enabled ? 1 : 0, iree_memory_order_relaxed);
+  return iree_ok_status();
+}
+
+// perf_event_open configs of each iree_hal_local_executable_counter_t in order.
+// The first is the group leader.
+static const uint64_t iree_hal_local_executable_perf_configs_
+    [IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,       PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+typedef enum iree_hal_local_executable_perf_group_state_e {
+  IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_UNOPENED = 0,
+  IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_OPEN = 1,
+  IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_FAILED = 2,
+} iree_hal_local_executable_perf_group_state_t;
+
+// Counter group of a single thread counting only that thread.
+typedef struct iree_hal_local_executable_perf_group_t {
+  iree_hal_local_executable_perf_group_state_t state;
+  int fds[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT];
+  // Index of each counter in the values read from the group or -1 if the
+  // counter could not be opened.
+  int read_indices[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT];
+} iree_hal_local_executable_perf_group_t;
+
+static __thread iree_hal_local_executable_perf_group_t
+    iree_hal_local_executable_perf_group_;
+
+static int iree_hal_local_executable_perf_event_open(uint64_t config,
+                                                     int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Excluding the kernel allows counting with the default perf_event_paranoid
+  // setting and keeps syscall overhead out of the results.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                      group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+static void iree_hal_local_executable_perf_group_close(void* group_ptr) {
+  iree_hal_local_executable_perf_group_t* group =
+      (iree_hal_local_executable_perf_group_t*)group_ptr;
+  for (int i = IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT - 1; i >= 0; --i) {
+    if (group->fds[i] >= 0) close(group->fds[i]);
+    group->fds[i] = -1;
+  }
+  group->state = IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_FAILED;
+}
+
+// Returns the counter group of the calling thread, opening it on first use, or
+// NULL if the counters are unavailable.
+static iree_hal_local_executable_perf_group_t*
+iree_hal_local_executable_perf_group_acquire(void) {
+  iree_hal_local_executable_perf_group_t* group =
+      &iree_hal_local_executable_perf_group_;
+  if (IREE_LIKELY(group->state == IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_OPEN)) {
+    return group;
+  } else if (group->state == IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_FAILED) {
+    return NULL;
+  }
+
+  int read_index = 0;
+  for (int i = 0; i < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT; ++i) {
+    group->fds[i] = iree_hal_local_executable_perf_event_open(
+        iree_hal_local_executable_perf_configs_[i],
+        /*group_fd=*/i == 0 ? -1 : group->fds[0]);
+    group->read_indices[i] = group->fds[i] >= 0 ? read_index++ : -1;
+    if (i == 0 && group->fds[0] < 0) {
+      // Without the leader no counters can be read (perf unavailable or not
+      // permitted); don't retry on this thread.
+      for (int j = 1; j < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT; ++j) {
+        group->fds[j] = -1;
+      }
+      group->state = IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_FAILED;
+      return NULL;
+    }
+  }
+  if (iree_hal_local_executable_perf_key_valid_) {
+    pthread_setspecific(iree_hal_local_executable_perf_key_, group);
+  }
+  group->state = IREE_HAL_LOCAL_EXECUTABLE_PERF_GROUP_OPEN;
+  return group;
+}
+
+// Reads the current value of each counter in |group| into |out_values|.
+static bool iree_hal_local_executable_perf_group_read(
+    iree_hal_local_executable_perf_group_t* group,
+    uint64_t out_values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT]) {
+  // PERF_FORMAT_GROUP layout: { u64 nr; u64 values[nr]; }
+  uint64_t buffer[1 + IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT];
+  ssize_t read_size = read(group->fds[0], buffer, sizeof(buffer));
+  if (read_size < (ssize_t)sizeof(buffer[0])) return false;
+  for (int i = 0; i < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT; ++i) {
+    int index = group->read_indices[i];
+    out_values[i] =
+        index >= 0 && (uint64_t)index < buffer[0] ? buffer[1 + index] : 0;
+  }
+  return true;
+}
+
+// Allocates and registers the counters of |executable| if collection is
+// enabled. Failure is not fatal and leaves the executable without counters.
+static void iree_hal_local_executable_counters_register(
+    iree_hal_local_executable_t* executable) {
+  executable->counters = NULL;
+  if (!iree_hal_local_executable_counters_is_enabled()) return;
+  const iree_host_size_t export_count = executable->pipeline_layout_count;
+  if (export_count == 0) return;
+  iree_hal_local_executable_counters_t* counters = NULL;
+  const iree_host_size_t values_size =
+      export_count * IREE_HAL_LOCAL_EXECUTABLE_COUNTER_STRIDE *
+      sizeof(counters->values[0]);
+  iree_status_t status =
+      iree_allocator_malloc(executable->host_allocator,
+                            sizeof(*counters) + values_size, (void**)&counters);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return;
+  }
+  counters->executable = executable;
+  counters->export_count = export_count;
+  memset(counters->values, 0, values_size);
+
+  iree_slim_mutex_lock(&iree_hal_local_executable_counters_mutex_);
+  counters->prev = NULL;
+  counters->next = iree_hal_local_executable_counters_head_;
+  if (counters->next) counters->next->prev = counters;
+  iree_hal_local_executable_counters_head_ = counters;
+  iree_slim_mutex_unlock(&iree_hal_local_executable_counters_mutex_);
+
+  executable->counters = counters;
+}
+
+static void iree_hal_local_executable_counters_unregister(
+    iree_hal_local_executable_t* executable) {
+  iree_hal_local_executable_counters_t* counters = executable->counters;
+  if (!counters) return;
+  iree_slim_mutex_lock(&iree_hal_local_executable_counters_mutex_);
+  if (counters->prev) {
+    counters->prev->next = counters->next;
+  } else {
+    iree_hal_local_executable_counters_head_ = counters->next;
+  }
+  if (counters->next) counters->next->prev = counters->prev;
+  iree_slim_mutex_unlock(&iree_hal_local_executable_counters_mutex_);
+  iree_allocator_free(executable->host_allocator, counters);
+  executable->counters = NULL;
+}
+
+void iree_hal_local_executable_counters_enumerate(
+    iree_hal_local_executable_counters_callback_fn_t callback,
+    void* user_data) {
+  IREE_ASSERT_ARGUMENT(callback);
+  iree_call_once(&iree_hal_local_executable_counters_once_,
+                 iree_hal_local_executable_counters_initialize);
+  iree_slim_mutex_lock(&iree_hal_local_executable_counters_mutex_);
+  for (iree_hal_local_executable_counters_t* counters =
+           iree_hal_local_executable_counters_head_;
+       counters != NULL; counters = counters->next) {
+    iree_hal_local_executable_t* executable = counters->executable;
+    for (iree_host_size_t i = 0; i < counters->export_count; ++i) {
+      iree_hal_local_executable_export_counters_t export_counters;
+      iree_atomic_int64_t* values =
+          &counters->values[i * IREE_HAL_LOCAL_EXECUTABLE_COUNTER_STRIDE];
+      export_counters.call_count = (uint64_t)iree_atomic_load_int64(
+          &values[0], iree_memory_order_relaxed);
+      for (int j = 0; j < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT; ++j) {
+        export_counters.values[j] = (uint64_t)iree_atomic_load_int64(
+            &values[1 + j], iree_memory_order_relaxed);
+      }
+      iree_string_view_t export_name =
+          executable->export_names && executable->export_names[i]
+              ? iree_make_cstring_view(executable->export_names[i])
+              : iree_string_view_empty();
+      callback(user_data, executable, i, export_name, &export_counters);
+    }
+  }
+  iree_slim_mutex_unlock(&iree_hal_local_executable_counters_mutex_);
+}
+
+// Issues the call while sampling the counters of the calling thread before and
+// after and accumulates the difference into the counters of |ordinal|.
+static iree_status_t iree_hal_local_executable_issue_call_counted(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  iree_hal_local_executable_perf_group_t* group =
+      iree_hal_local_executable_perf_group_acquire();
+  uint64_t begin_values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT];
+  if (!group || ordinal >= executable->counters->export_count ||
+      !iree_hal_local_executable_perf_group_read(group, begin_values)) {
+    return vtable->issue_call(executable, ordinal, dispatch_state,
+                              workgroup_state, worker_id);
+  }
+  iree_status_t status = vtable->issue_call(
+      executable, ordinal, dispatch_state, workgroup_state, worker_id);
+  uint64_t end_values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT];
+  if (iree_hal_local_executable_perf_group_read(group, end_values)) {
+    iree_atomic_int64_t* values =
+        &executable->counters
+             ->values[ordinal * IREE_HAL_LOCAL_EXECUTABLE_COUNTER_STRIDE];
+    iree_atomic_fetch_add_int64(&values[0], 1, iree_memory_order_relaxed);
+    for (int i = 0; i < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT; ++i) {
+      iree_atomic_fetch_add_int64(&values[1 + i],
+                                  (int64_t)(end_values[i] - begin_values[i]),
+                                  iree_memory_order_relaxed);
+    }
+  }
+  return status;
+}
+
+#else
+
+iree_status_t iree_hal_local_executable_counters_set_enabled(bool enabled) {
+  if (!enabled) return iree_ok_status();
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "hardware performance counters are not available on "
+                          "this platform");
+}
+
+static void iree_hal_local_executable_counters_register(
+    iree_hal_local_executable_t* executable) {
+  executable->counters = NULL;
+}
+
+static void iree_hal_local_executable_counters_unregister(
+    iree_hal_local_executable_t* executable) {}
+
+void iree_hal_local_executable_counters_enumerate(
+    iree_hal_local_executable_counters_callback_fn_t callback,
+    void* user_data) {}
+
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+
+iree_status_t iree_hal_local_executable_query_export_counters(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_counters_t* out_counters) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_counters);
+  memset(out_counters, 0, sizeof(*out_counters));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_executable_resolve(executable, &executable));
+  iree_hal_local_executable_counters_t* counters = executable->counters;
+  if (!counters) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "executable is not recording counters");
+  } else if (ordinal >= counters->export_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "export ordinal %" PRIhsz
+                            " out of range; executable has %" PRIhsz
+                            " exports",
+                            ordinal, counters->export_count);
+  }
+  iree_atomic_int64_t* values =
+      &counters->values[ordinal * IREE_HAL_LOCAL_EXECUTABLE_COUNTER_STRIDE];
+  out_counters->call_count = (uint64_t)iree_atomic_load_int64(
+      &values[0], iree_memory_order_relaxed);
+  for (int i = 0; i < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT; ++i) {
+    out_counters->values[i] = (uint64_t)iree_atomic_load_int64(
+        &values[1 + i], iree_memory_order_relaxed);
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Dispatch timing
+//===----------------------------------------------------------------------===//
+
+// Values stored per export in order.
+enum {
+  IREE_HAL_LOCAL_EXECUTABLE_TIMING_DISPATCH_COUNT = 0,
+  IREE_HAL_LOCAL_EXECUTABLE_TIMING_WORKGROUP_COUNT,
+  IREE_HAL_LOCAL_EXECUTABLE_TIMING_TOTAL_NS,
+  IREE_HAL_LOCAL_EXECUTABLE_TIMING_STRIDE,
+};
+
+typedef struct iree_hal_local_executable_timing_t {
+  // Executable the timing is recorded for.
+  iree_hal_local_executable_t* executable;
+  // Intrusive list of all live timing guarded by the registry mutex.
+  struct iree_hal_local_executable_timing_t* prev;
+  struct iree_hal_local_executable_timing_t* next;
+  iree_host_size_t export_count;
+  // export_count * IREE_HAL_LOCAL_EXECUTABLE_TIMING_STRIDE values.
+  iree_atomic_int64_t values[];
+} iree_hal_local_executable_timing_t;
+
+static iree_atomic_int32_t iree_hal_local_executable_timing_enabled_ =
+    IREE_ATOMIC_VAR_INIT(0);
+
+bool iree_hal_local_executable_timing_is_enabled(void) {
+  return iree_atomic_load_int32(&iree_hal_local_executable_timing_enabled_,
+                                iree_memory_order_relaxed) != 0;
+}
+
+#if IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+
+// Registry of all live executables tracking timing.
+static iree_once_flag iree_hal_local_executable_timing_once_ =
+    IREE_ONCE_FLAG_INIT;
+static iree_slim_mutex_t iree_hal_local_executable_timing_mutex_;
+static iree_hal_local_executable_timing_t*
+    iree_hal_local_executable_timing_head_ = NULL;
+
+static void iree_hal_local_executable_timing_initialize(void) {
+  iree_slim_mutex_initialize(&iree_hal_local_executable_timing_mutex_);
+}
+
+iree_status_t iree_hal_local_executable_timing_set_enabled(bool enabled) {
+  iree_atomic_store_int32(&iree_hal_local_executable_timing_enabled_,
+                          enabled ? 1 : 0, iree_memory_order_relaxed);
+  return iree_ok_status();
+}
+
+// Allocates and registers the timing of |executable|. Failure is not fatal
+// and leaves the executable untimed.
+static void iree_hal_local_executable_timing_register(
+    iree_hal_local_executable_t* executable) {
+  executable->timing = NULL;
+  const iree_host_size_t export_count = executable->pipeline_layout_count;
+  if (export_count == 0) return;
+  iree_hal_local_executable_timing_t* timing = NULL;
+  const iree_host_size_t values_size = export_count *
+                                       IREE_HAL_LOCAL_EXECUTABLE_TIMING_STRIDE *
+                                       sizeof(timing->values[0]);
+  iree_status_t status =
+      iree_allocator_malloc(executable->host_allocator,
+                            sizeof(*timing) + values_size, (void**)&timing);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return;
+  }
+  timing->executable = executable;
+  timing->export_count = export_count;
+  memset(timing->values, 0, values_size);
+
+  iree_call_once(&iree_hal_local_executable_timing_once_,
+                 iree_hal_local_executable_timing_initialize);
+  iree_slim_mutex_lock(&iree_hal_local_executable_timing_mutex_);
+  timing->prev = NULL;
+  timing->next = iree_hal_local_executable_timing_head_;
+  if (timing->next) timing->next->prev = timing;
+  iree_hal_local_executable_timing_head_ = timing;
+  iree_slim_mutex_unlock(&iree_hal_local_executable_timing_mutex_);
+
+  executable->timing = timing;
+}
+
+static void iree_hal_local_executable_timing_unregister(
+    iree_hal_local_executable_t* executable) {
+  iree_hal_local_executable_timing_t* timing = executable->timing;
+  if (!timing) return;
+  iree_slim_mutex_lock(&iree_hal_local_executable_timing_mutex_);
+  if (timing->prev) {
+    timing->prev->next = timing->next;
+  } else {
+    iree_hal_local_executable_timing_head_ = timing->next;
+  }
+  if (timing->next) timing->next->prev = timing->prev;
+  iree_slim_mutex_unlock(&iree_hal_local_executable_timing_mutex_);
+  iree_allocator_free(executable->host_allocator, timing);
+  executable->timing = NULL;
+}
+
+void iree_hal_local_executable_timing_reset(void) {
+  iree_call_once(&iree_hal_local_executable_timing_once_,
+                 iree_hal_local_executable_timing_initialize);
+  iree_slim_mutex_lock(&iree_hal_local_executable_timing_mutex_);
+  for (iree_hal_local_executable_timing_t* timing =
+           iree_hal_local_executable_timing_head_;
+       timing != NULL; timing = timing->next) {
+    const iree_host_size_t value_count =
+        timing->export_count * IREE_HAL_LOCAL_EXECUTABLE_TIMING_STRIDE;
+    for (iree_host_size_t i = 0; i < value_count; ++i) {
+      iree_atomic_store_int64(&timing->values[i], 0,
+                              iree_memory_order_relaxed);
+    }
+  }
+  iree_slim_mutex_unlock(&iree_hal_local_executable_timing_mutex_);
+}
+
+void iree_hal_local_executable_timing_enumerate(
+    iree_hal_local_executable_timing_callback_fn_t callback, void* user_data) {
+  IREE_ASSERT_ARGUMENT(callback);
+  iree_call_once(&iree_hal_local_executable_timing_once_,
+                 iree_hal_local_executable_timing_initialize);
+  iree_slim_mutex_lock(&iree_hal_local_executable_timing_mutex_);
+  for (iree_hal_local_executable_timing_t* timing =
+           iree_hal_local_executable_timing_head_;
+       timing != NULL; timing = timing->next) {
+    iree_hal_local_executable_t* executable = timing->executable;
+    for (iree_host_size_t i = 0; i < timing->export_count; ++i) {
+      iree_atomic_int64_t* values =
+          &timing->values[i * IREE_HAL_LOCAL_EXECUTABLE_TIMING_STRIDE];
+      iree_hal_local_executable_export_timing_t export_timing = {
+          .dispatch_count = (uint64_t)iree_atomic_load_int64(
+              &values[IREE_HAL_LOCAL_EXECUTABLE_TIMING_DISPATCH_COUNT],
+              iree_memory_order_relaxed),
+          .workgroup_count = (uint64_t)iree_atomic_load_int64(
+              &values[IREE_HAL_LOCAL_EXECUTABLE_TIMING_WORKGROUP_COUNT],
+              iree_memory_order_relaxed),
+          .total_ns = (uint64_t)iree_atomic_load_int64(
+              &values[IREE_HAL_LOCAL_EXECUTABLE_TIMING_TOTAL_NS],
+              iree_memory_order_relaxed),
+      };
+      iree_string_view_t export_name =
+          executable->export_names && executable->export_names[i]
+              ? iree_make_cstring_view(executable->export_names[i])
+              : iree_string_view_empty();
+      callback(user_data, executable, i, export_name, &export_timing);
+    }
+  }
+  iree_slim_mutex_unlock(&iree_hal_local_executable_timing_mutex_);
+}
+
+// Accumulates |workgroup_count| workgroups that took |duration| into the
+// timing of |ordinal|. The dispatch is counted when |includes_first_workgroup|
+// as workgroup 0 is issued exactly once per dispatch.
+static void iree_hal_local_executable_timing_record(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    bool includes_first_workgroup, uint32_t workgroup_count,
+    iree_duration_t duration) {
+  iree_hal_local_executable_timing_t* timing = executable->timing;
+  if (ordinal >= timing->export_count) return;
+  iree_atomic_int64_t* values =
+      &timing->values[ordinal * IREE_HAL_LOCAL_EXECUTABLE_TIMING_STRIDE];
+  if (includes_first_workgroup) {
+    iree_atomic_fetch_add_int64(
+        &values[IREE_HAL_LOCAL_EXECUTABLE_TIMING_DISPATCH_COUNT], 1,
+        iree_memory_order_relaxed);
+  }
+  iree_atomic_fetch_add_int64(
+      &values[IREE_HAL_LOCAL_EXECUTABLE_TIMING_WORKGROUP_COUNT],
+      workgroup_count, iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(
+      &values[IREE_HAL_LOCAL_EXECUTABLE_TIMING_TOTAL_NS], duration,
+      iree_memory_order_relaxed);
+}
+
+#else
+
+iree_status_t iree_hal_local_executable_timing_set_enabled(bool enabled) {
+  if (!enabled) return iree_ok_status();
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "dispatch timing support is not compiled in");
+}
+
+static void iree_hal_local_executable_timing_register(
+    iree_hal_local_executable_t* executable) {
+  executable->timing = NULL;
+}
+
+static void iree_hal_local_executable_timing_unregister(
+    iree_hal_local_executable_t* executable) {}
+
+void iree_hal_local_executable_timing_reset(void) {}
+
+void iree_hal_local_executable_timing_enumerate(
+    iree_hal_local_executable_timing_callback_fn_t callback, void* user_data) {}
+
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_executable_t
+//===----------------------------------------------------------------------===//
+
 void iree_hal_local_executable_initialize(
     const iree_hal_local_executable_vtable_t* vtable,
     iree_host_size_t pipeline_layout_count,
@@ -29,6 +589,34 @@ void iree_hal_local_executable_initialize(
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
 
+  // Cost tracking is optional; if the allocation fails executors will fall
+  // back to their static heuristics.
+  out_base_executable->dispatch_tile_costs = NULL;
+  if (pipeline_layout_count > 0) {
+    iree_status_ignore(iree_allocator_malloc(
+        host_allocator,
+        pipeline_layout_count *
+            sizeof(*out_base_executable->dispatch_tile_costs),
+        (void**)&out_base_executable->dispatch_tile_costs));
+    if (out_base_executable->dispatch_tile_costs) {
+      memset(out_base_executable->dispatch_tile_costs, 0,
+             pipeline_layout_count *
+                 sizeof(*out_base_executable->dispatch_tile_costs));
+    }
+  }
+
+  // Export names are optional and populated by the parent type.
+  out_base_executable->export_names = NULL;
+
+  // Executables that forward to others (such as those prepared lazily) record
+  // no counters of their own.
+  out_base_executable->counters = NULL;
+  out_base_executable->timing = NULL;
+  if (!vtable->resolve) {
+    iree_hal_local_executable_counters_register(out_base_executable);
+    iree_hal_local_executable_timing_register(out_base_executable);
+  }
+
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
                                              &out_base_executable->environment);
@@ -36,10 +624,14 @@ void iree_hal_local_executable_initialize(
 
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable) {
+  iree_hal_local_executable_counters_unregister(base_executable);
+  iree_hal_local_executable_timing_unregister(base_executable);
   for (iree_host_size_t i = 0; i < base_executable->pipeline_layout_count;
        ++i) {
     iree_hal_pipeline_layout_release(base_executable->pipeline_layouts[i]);
   }
+  iree_allocator_free(base_executable->host_allocator,
+                      base_executable->dispatch_tile_costs);
 }
 
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
@@ -47,20 +639,126 @@ iree_hal_local_executable_t* iree_hal_local_executable_cast(
   return (iree_hal_local_executable_t*)base_value;
 }
 
-iree_status_t iree_hal_local_executable_issue_call(
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  if (IREE_LIKELY(!vtable->resolve)) {
+    *out_executable = executable;
+    return iree_ok_status();
+  }
+  return vtable->resolve(executable, out_executable);
+}
+
+// Issues the call with counters sampled around it if enabled.
+static iree_status_t iree_hal_local_executable_issue_call_untimed(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
     uint32_t worker_id) {
-  IREE_ASSERT_ARGUMENT(executable);
-  IREE_ASSERT_ARGUMENT(dispatch_state);
-  IREE_ASSERT_ARGUMENT(workgroup_state);
+#if IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+  if (IREE_UNLIKELY(executable->counters) &&
+      iree_hal_local_executable_counters_is_enabled()) {
+    return iree_hal_local_executable_issue_call_counted(
+        executable, ordinal, dispatch_state, workgroup_state, worker_id);
+  }
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
   return ((const iree_hal_local_executable_vtable_t*)
               executable->resource.vtable)
       ->issue_call(executable, ordinal, dispatch_state, workgroup_state,
                    worker_id);
 }
 
+iree_status_t iree_hal_local_executable_issue_call(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(dispatch_state);
+  IREE_ASSERT_ARGUMENT(workgroup_state);
+#if IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+  if (IREE_UNLIKELY(iree_hal_local_executable_timing_is_enabled()) &&
+      executable->timing) {
+    iree_time_t start_time = iree_time_now();
+    iree_status_t status = iree_hal_local_executable_issue_call_untimed(
+        executable, ordinal, dispatch_state, workgroup_state, worker_id);
+    iree_hal_local_executable_timing_record(
+        executable, ordinal,
+        (workgroup_state->workgroup_id_x | workgroup_state->workgroup_id_y |
+         workgroup_state->workgroup_id_z) == 0,
+        /*workgroup_count=*/1, iree_time_now() - start_time);
+    return status;
+  }
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+  return iree_hal_local_executable_issue_call_untimed(
+      executable, ordinal, dispatch_state, workgroup_state, worker_id);
+}
+
+iree_status_t iree_hal_local_executable_issue_workgroup_range(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t workgroup_begin, uint32_t workgroup_end, uint32_t worker_id) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(dispatch_state);
+  IREE_ASSERT_ARGUMENT(workgroup_state);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  bool use_range = vtable->issue_workgroup_range != NULL;
+#if IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+  // Counters are sampled around each call and need the per-call path.
+  if (IREE_UNLIKELY(executable->counters) &&
+      iree_hal_local_executable_counters_is_enabled()) {
+    use_range = false;
+  }
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+  if (use_range) {
+#if IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+    if (IREE_UNLIKELY(iree_hal_local_executable_timing_is_enabled()) &&
+        executable->timing) {
+      iree_time_t start_time = iree_time_now();
+      iree_status_t status = vtable->issue_workgroup_range(
+          executable, ordinal, dispatch_state, workgroup_state,
+          workgroup_begin, workgroup_end, worker_id);
+      iree_hal_local_executable_timing_record(
+          executable, ordinal, workgroup_begin == 0,
+          workgroup_end - workgroup_begin, iree_time_now() - start_time);
+      return status;
+    }
+#endif  // IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+    return vtable->issue_workgroup_range(executable, ordinal, dispatch_state,
+                                         workgroup_state, workgroup_begin,
+                                         workgroup_end, worker_id);
+  }
+
+  const uint32_t workgroup_count_x = dispatch_state->workgroup_count_x;
+  const uint32_t workgroup_count_y = dispatch_state->workgroup_count_y;
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t
+      local_workgroup_state = *workgroup_state;
+  local_workgroup_state.workgroup_id_x = workgroup_begin % workgroup_count_x;
+  local_workgroup_state.workgroup_id_y =
+      (workgroup_begin / workgroup_count_x) % workgroup_count_y;
+  local_workgroup_state.workgroup_id_z =
+      workgroup_begin / workgroup_count_x / workgroup_count_y;
+  for (uint32_t i = workgroup_begin; i < workgroup_end; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_call(
+        executable, ordinal, dispatch_state, &local_workgroup_state,
+        worker_id));
+    if (++local_workgroup_state.workgroup_id_x == workgroup_count_x) {
+      local_workgroup_state.workgroup_id_x = 0;
+      if (++local_workgroup_state.workgroup_id_y == workgroup_count_y) {
+        local_workgroup_state.workgroup_id_y = 0;
+        ++local_workgroup_state.workgroup_id_z;
+      }
+    }
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -93,18 +791,18 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
       .local_memory = local_memory.data,
       .local_memory_size = (size_t)local_memory.data_length,
   };
-  for (uint32_t z = 0; z < workgroup_count_z; ++z) {
-    workgroup_state.workgroup_id_z = z;
-    for (uint32_t y = 0; y < workgroup_count_y; ++y) {
-      workgroup_state.workgroup_id_y = y;
-      for (uint32_t x = 0; x < workgroup_count_x; ++x) {
-        workgroup_state.workgroup_id_x = x;
-        status = iree_hal_local_executable_issue_call(
-            executable, ordinal, dispatch_state, &workgroup_state,
-            /*worker_id=*/0);
-        if (!iree_status_is_ok(status)) break;
-      }
-    }
+  const uint64_t workgroup_count =
+      (uint64_t)workgroup_count_x * workgroup_count_y * workgroup_count_z;
+  if (IREE_UNLIKELY(workgroup_count > UINT32_MAX)) {
+    status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "dispatch of %" PRIu64
+                              " workgroups exceeds the 32-bit limit",
+                              workgroup_count);
+  } else if (workgroup_count > 0) {
+    status = iree_hal_local_executable_issue_workgroup_range(
+        executable, ordinal, dispatch_state, &workgroup_state,
+        /*workgroup_begin=*/0, /*workgroup_end=*/(uint32_t)workgroup_count,
+        /*worker_id=*/0);
   }
 
   IREE_TRACE_ZONE_END(z0);
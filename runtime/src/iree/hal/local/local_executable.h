@@ -8,6 +8,7 @@
 #define IREE_HAL_LOCAL_LOCAL_EXECUTABLE_H_
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 
@@ -35,6 +36,25 @@ typedef struct iree_hal_local_executable_t {
   // of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Per-entry point average workgroup execution time in nanoseconds as
+  // measured by executors that support it (such as the task system). Has
+  // pipeline_layout_count entries or is NULL if allocation failed. A value of 0
+  // indicates that no samples have been taken.
+  iree_atomic_int32_t* dispatch_tile_costs;
+
+  // Optional table of export names 1:1 with the pipeline layouts used when
+  // reporting per-export statistics. Populated by the parent type.
+  const char* const* export_names;
+
+  // Per-export hardware counters when counter collection was enabled at the
+  // time the executable was initialized; NULL otherwise.
+  // See iree_hal_local_executable_counters_set_enabled.
+  struct iree_hal_local_executable_counters_t* counters;
+
+  // Per-export dispatch timing; NULL if unavailable.
+  // See iree_hal_local_executable_timing_set_enabled.
+  struct iree_hal_local_executable_timing_t* timing;
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -47,6 +67,25 @@ typedef struct iree_hal_local_executable_vtable_t {
       const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
       const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
       uint32_t worker_id);
+
+  // Optional; issues calls for the workgroups in the half-open range
+  // [workgroup_begin, workgroup_end) of the dispatch grid linearized with x
+  // varying fastest. |workgroup_state| provides the processor and local memory
+  // shared by all workgroups and its IDs are ignored. Implementations with
+  // expensive per-call setup can amortize it across the range. When NULL each
+  // workgroup is issued with issue_call.
+  iree_status_t(IREE_API_PTR* issue_workgroup_range)(
+      iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+      const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+      const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+      uint32_t workgroup_begin, uint32_t workgroup_end, uint32_t worker_id);
+
+  // Optional; resolves an executable whose preparation was deferred to the
+  // executable implementing it, preparing it if needed. When NULL the
+  // executable implements itself.
+  iree_status_t(IREE_API_PTR* resolve)(
+      iree_hal_local_executable_t* executable,
+      iree_hal_local_executable_t** out_executable);
 } iree_hal_local_executable_vtable_t;
 
 // Initializes the local executable base type.
@@ -67,12 +106,161 @@ void iree_hal_local_executable_deinitialize(
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
+// Resolves |executable| to the local executable implementing it, preparing it
+// first if its preparation was deferred until first use. The returned
+// executable is owned by |executable| and valid for as long as it is.
+// Dispatch recording must use the resolved executable to access the dispatch
+// attributes and tile costs.
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable);
+
+//===----------------------------------------------------------------------===//
+// Hardware performance counters
+//===----------------------------------------------------------------------===//
+// Optional collection of hardware performance counters around each executable
+// function call, aggregated per export ordinal of each executable. Counting
+// uses perf_event_open and is only available on Linux and Android; each thread
+// issuing calls opens its own counter group on first use and samples it before
+// and after every call. Sampling costs two syscalls per call (a workgroup or
+// tile) so collection should only be enabled when profiling.
+//
+// Not all counters are available on all systems (virtual machines commonly
+// lack cache events); counters that cannot be opened report 0. There is no
+// portable FLOP counter event and raw PMU events are not currently exposed.
+
+#if !defined(IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE)
+#if defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+#define IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE 1
+#else
+#define IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE 0
+#endif  // IREE_PLATFORM_LINUX || IREE_PLATFORM_ANDROID
+#endif  // !IREE_HAL_LOCAL_EXECUTABLE_COUNTERS_ENABLE
+
+typedef enum iree_hal_local_executable_counter_e {
+  // CPU cycles spent in the call.
+  IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CYCLES = 0,
+  // Instructions retired.
+  IREE_HAL_LOCAL_EXECUTABLE_COUNTER_INSTRUCTIONS,
+  // Last-level cache references.
+  IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CACHE_REFERENCES,
+  // Last-level cache misses; a high ratio of misses to instructions indicates
+  // a memory bound export.
+  IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CACHE_MISSES,
+  // Branch mispredictions.
+  IREE_HAL_LOCAL_EXECUTABLE_COUNTER_BRANCH_MISSES,
+  IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT,
+} iree_hal_local_executable_counter_t;
+
+// Returns a short name for |counter| such as `cycles`.
+const char* iree_hal_local_executable_counter_name(
+    iree_hal_local_executable_counter_t counter);
+
+// Aggregate counter values of a single export.
+typedef struct iree_hal_local_executable_export_counters_t {
+  // Total number of calls sampled.
+  uint64_t call_count;
+  // Sum of each counter over all sampled calls.
+  uint64_t values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT];
+} iree_hal_local_executable_export_counters_t;
+
+// Enables or disables counter collection process-wide.
+// Only executables initialized while collection is enabled record counters.
+// Returns UNAVAILABLE if counters are not supported on the platform.
+iree_status_t iree_hal_local_executable_counters_set_enabled(bool enabled);
+
+// Returns true if counter collection is enabled.
+bool iree_hal_local_executable_counters_is_enabled(void);
+
+// Queries the aggregate counters of export |ordinal| of |executable| (after
+// resolving it). Returns NOT_FOUND if the executable is not recording counters.
+iree_status_t iree_hal_local_executable_query_export_counters(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_counters_t* out_counters);
+
+// Callback issued for each export of each live executable recording counters.
+// |export_name| is empty if the executable has no export names.
+typedef void(IREE_API_PTR* iree_hal_local_executable_counters_callback_fn_t)(
+    void* user_data, iree_hal_local_executable_t* executable,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_counters_t* counters);
+
+// Issues |callback| for every export of every live executable recording
+// counters. Executables must not be created or destroyed from the callback.
+void iree_hal_local_executable_counters_enumerate(
+    iree_hal_local_executable_counters_callback_fn_t callback,
+    void* user_data);
+
+//===----------------------------------------------------------------------===//
+// Dispatch timing
+//===----------------------------------------------------------------------===//
+// Portable timing of executable function calls aggregated per export ordinal
+// of each executable. While enabled the host time spent in each call (or range
+// of workgroups issued together) is measured with iree_time_now and the
+// dispatch containing it is counted when its first workgroup is issued.
+// Executables track timing from the time they are initialized so collection
+// can be enabled at any point. When disabled the only cost is a relaxed load
+// per call.
+//
+// Times are summed over all threads executing workgroups of an export: with
+// multiple workers the total is CPU time and exceeds the wall time of the
+// dispatches.
+
+#if !defined(IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE)
+#define IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE 1
+#endif  // !IREE_HAL_LOCAL_EXECUTABLE_TIMING_ENABLE
+
+// Aggregate timing of a single export.
+typedef struct iree_hal_local_executable_export_timing_t {
+  // Total number of dispatches of the export.
+  uint64_t dispatch_count;
+  // Total number of workgroups executed across all dispatches.
+  uint64_t workgroup_count;
+  // Sum of the time spent executing the workgroups in nanoseconds.
+  uint64_t total_ns;
+} iree_hal_local_executable_export_timing_t;
+
+// Enables or disables timing collection process-wide.
+// Returns UNAVAILABLE if timing support is not compiled in.
+iree_status_t iree_hal_local_executable_timing_set_enabled(bool enabled);
+
+// Returns true if timing collection is enabled.
+bool iree_hal_local_executable_timing_is_enabled(void);
+
+// Resets the timing of all live executables to zero.
+void iree_hal_local_executable_timing_reset(void);
+
+// Callback issued for each export of each live executable.
+// |export_name| is empty if the executable has no export names.
+typedef void(IREE_API_PTR* iree_hal_local_executable_timing_callback_fn_t)(
+    void* user_data, iree_hal_local_executable_t* executable,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_timing_t* timing);
+
+// Issues |callback| for every export of every live executable. Executables
+// must not be created or destroyed from the callback.
+void iree_hal_local_executable_timing_enumerate(
+    iree_hal_local_executable_timing_callback_fn_t callback, void* user_data);
+
+//===----------------------------------------------------------------------===//
+// Dispatch
+//===----------------------------------------------------------------------===//
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
     uint32_t worker_id);
 
+// Issues the workgroups in the half-open range [workgroup_begin,
+// workgroup_end) of the dispatch grid linearized with x varying fastest.
+// The workgroup IDs of |workgroup_state| are ignored.
+iree_status_t iree_hal_local_executable_issue_workgroup_range(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t workgroup_begin, uint32_t workgroup_end, uint32_t worker_id);
+
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
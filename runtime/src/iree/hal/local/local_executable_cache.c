@@ -8,14 +8,18 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
 
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
   iree_host_size_t worker_capacity;
+  iree_hal_local_executable_cache_scheduler_t scheduler;
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -34,6 +38,18 @@ iree_status_t iree_hal_local_executable_cache_create(
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
+  return iree_hal_local_executable_cache_create_with_scheduler(
+      identifier, worker_capacity, loader_count, loaders,
+      iree_hal_local_executable_cache_scheduler_inline(), host_allocator,
+      out_executable_cache);
+}
+
+iree_status_t iree_hal_local_executable_cache_create_with_scheduler(
+    iree_string_view_t identifier, iree_host_size_t worker_capacity,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_local_executable_cache_scheduler_t scheduler,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
   IREE_ASSERT_ARGUMENT(out_executable_cache);
   *out_executable_cache = NULL;
@@ -54,6 +70,7 @@ iree_status_t iree_hal_local_executable_cache_create(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
     executable_cache->worker_capacity = worker_capacity;
+    executable_cache->scheduler = scheduler;
 
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
@@ -98,12 +115,10 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
-static iree_status_t iree_hal_local_executable_cache_prepare_executable(
-    iree_hal_executable_cache_t* base_executable_cache,
+static iree_status_t iree_hal_local_executable_cache_load_executable(
+    iree_hal_local_executable_cache_t* executable_cache,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
-  iree_hal_local_executable_cache_t* executable_cache =
-      iree_hal_local_executable_cache_cast(base_executable_cache);
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     if (!iree_hal_executable_loader_query_support(
             executable_cache->loaders[i], executable_params->caching_mode,
@@ -133,6 +148,282 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
       executable_params->executable_format.data);
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_local_lazy_executable_t
+//===----------------------------------------------------------------------===//
+
+// An executable whose loading is deferred until it is first resolved for
+// dispatch. Holds everything required to load it later: the executable cache
+// (and through it the loaders) and the executable parameters, with the format,
+// constants and (unless aliased) data copied into trailing storage.
+typedef struct iree_hal_local_lazy_executable_t {
+  iree_hal_local_executable_t base;
+  iree_hal_local_executable_cache_t* executable_cache;
+
+  // Parameters used to load the executable; all referenced storage is owned by
+  // the lazy executable.
+  iree_hal_executable_params_t params;
+
+  // The loaded executable or NULL if not yet loaded.
+  // Read with acquire ordering without holding the mutex.
+  iree_atomic_intptr_t resolved;
+
+  // Guards loading and |status|.
+  iree_slim_mutex_t mutex;
+  // Sticky failure from loading; returned (cloned) from every resolve.
+  iree_status_t status;
+
+  iree_hal_pipeline_layout_t* pipeline_layouts[];
+} iree_hal_local_lazy_executable_t;
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_lazy_executable_vtable;
+
+static iree_hal_local_lazy_executable_t* iree_hal_local_lazy_executable_cast(
+    iree_hal_local_executable_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_local_lazy_executable_vtable);
+  return (iree_hal_local_lazy_executable_t*)base_value;
+}
+
+static iree_status_t iree_hal_local_lazy_executable_create(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const bool alias_data =
+      iree_all_bits_set(executable_params->caching_mode,
+                        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA);
+  iree_host_size_t pipeline_layouts_size =
+      executable_params->pipeline_layout_count *
+      sizeof(iree_hal_pipeline_layout_t*);
+  iree_host_size_t constants_size =
+      executable_params->constant_count * sizeof(uint32_t);
+  iree_host_size_t data_size =
+      alias_data ? 0 : executable_params->executable_data.data_length;
+  iree_host_size_t total_size =
+      sizeof(iree_hal_local_lazy_executable_t) + pipeline_layouts_size +
+      constants_size + data_size + executable_params->executable_format.size;
+
+  iree_hal_local_lazy_executable_t* executable = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(executable_cache->host_allocator, total_size,
+                                (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &iree_hal_local_lazy_executable_vtable,
+      executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts, &executable->pipeline_layouts[0],
+      executable_cache->host_allocator, &executable->base);
+  executable->executable_cache = executable_cache;
+  iree_hal_executable_cache_retain(
+      (iree_hal_executable_cache_t*)executable_cache);
+  iree_atomic_store_intptr(&executable->resolved, 0,
+                           iree_memory_order_relaxed);
+  iree_slim_mutex_initialize(&executable->mutex);
+  executable->status = iree_ok_status();
+
+  // Copy all parameters into trailing storage. The loaded executable always
+  // aliases the data as it is either owned by the caller (who requested
+  // aliasing) or by us for as long as the loaded executable is live.
+  uint8_t* storage_ptr =
+      (uint8_t*)executable->pipeline_layouts + pipeline_layouts_size;
+  executable->params = *executable_params;
+  executable->params.caching_mode &=
+      ~IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_LAZY_PREPARATION;
+  executable->params.caching_mode |=
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+  executable->params.pipeline_layouts = executable->base.pipeline_layouts;
+  if (constants_size > 0) {
+    memcpy(storage_ptr, executable_params->constants, constants_size);
+    executable->params.constants = (const uint32_t*)storage_ptr;
+    storage_ptr += constants_size;
+  }
+  if (data_size > 0) {
+    memcpy(storage_ptr, executable_params->executable_data.data, data_size);
+    executable->params.executable_data =
+        iree_make_const_byte_span(storage_ptr, data_size);
+    storage_ptr += data_size;
+  }
+  iree_string_view_append_to_buffer(executable_params->executable_format,
+                                    &executable->params.executable_format,
+                                    (char*)storage_ptr);
+
+  *out_executable = (iree_hal_executable_t*)executable;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_local_lazy_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_local_lazy_executable_t* executable =
+      iree_hal_local_lazy_executable_cast((iree_hal_local_executable_t*)
+                                              base_executable);
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_executable_t* resolved = (iree_hal_executable_t*)
+      iree_atomic_load_intptr(&executable->resolved,
+                              iree_memory_order_acquire);
+  iree_hal_executable_release(resolved);
+  iree_status_ignore(executable->status);
+  iree_slim_mutex_deinitialize(&executable->mutex);
+  iree_hal_executable_cache_release(
+      (iree_hal_executable_cache_t*)executable->executable_cache);
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_local_lazy_executable_resolve(
+    iree_hal_local_executable_t* base_executable,
+    iree_hal_local_executable_t** out_executable) {
+  iree_hal_local_lazy_executable_t* executable =
+      iree_hal_local_lazy_executable_cast(base_executable);
+
+  // Fast path for when the executable has already been loaded.
+  iree_hal_local_executable_t* resolved = (iree_hal_local_executable_t*)
+      iree_atomic_load_intptr(&executable->resolved,
+                              iree_memory_order_acquire);
+  if (IREE_LIKELY(resolved)) {
+    *out_executable = resolved;
+    return iree_ok_status();
+  }
+
+  iree_slim_mutex_lock(&executable->mutex);
+  iree_status_t status = iree_ok_status();
+  resolved = (iree_hal_local_executable_t*)iree_atomic_load_intptr(
+      &executable->resolved, iree_memory_order_relaxed);
+  if (!resolved && iree_status_is_ok(executable->status)) {
+    IREE_TRACE_ZONE_BEGIN(z0);
+    iree_hal_executable_t* loaded = NULL;
+    executable->status = iree_hal_local_executable_cache_load_executable(
+        executable->executable_cache, &executable->params, &loaded);
+    if (iree_status_is_ok(executable->status)) {
+      // Loaded executables must themselves be local executables.
+      resolved = iree_hal_local_executable_cast(loaded);
+      iree_atomic_store_intptr(&executable->resolved, (intptr_t)resolved,
+                               iree_memory_order_release);
+    }
+    IREE_TRACE_ZONE_END(z0);
+  }
+  if (!resolved) {
+    status = iree_status_clone(executable->status);
+  }
+  iree_slim_mutex_unlock(&executable->mutex);
+
+  *out_executable = resolved;
+  return status;
+}
+
+static iree_status_t iree_hal_local_lazy_executable_issue_call(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  iree_hal_local_executable_t* resolved = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_lazy_executable_resolve(base_executable, &resolved));
+  return iree_hal_local_executable_issue_call(
+      resolved, ordinal, dispatch_state, workgroup_state, worker_id);
+}
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_lazy_executable_vtable = {
+        .base =
+            {
+                .destroy = iree_hal_local_lazy_executable_destroy,
+            },
+        .issue_call = iree_hal_local_lazy_executable_issue_call,
+        .resolve = iree_hal_local_lazy_executable_resolve,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_local_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  if (iree_all_bits_set(
+          executable_params->caching_mode,
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_LAZY_PREPARATION) &&
+      iree_hal_local_executable_cache_can_prepare_format(
+          base_executable_cache, executable_params->caching_mode,
+          executable_params->executable_format)) {
+    // Only the format is validated now; loading errors surface on the first
+    // dispatch.
+    return iree_hal_local_lazy_executable_create(
+        executable_cache, executable_params, out_executable);
+  }
+  return iree_hal_local_executable_cache_load_executable(
+      executable_cache, executable_params, out_executable);
+}
+
+typedef struct iree_hal_local_executable_cache_batch_t {
+  iree_hal_executable_cache_t* executable_cache;
+  const iree_hal_executable_params_t* executable_params;
+  iree_hal_executable_t** out_executables;
+  // Per-executable preparation status so that concurrent failures do not race.
+  iree_status_t* statuses;
+} iree_hal_local_executable_cache_batch_t;
+
+static iree_status_t iree_hal_local_executable_cache_prepare_batch_item(
+    void* user_data, iree_host_size_t index) {
+  iree_hal_local_executable_cache_batch_t* batch =
+      (iree_hal_local_executable_cache_batch_t*)user_data;
+  batch->statuses[index] = iree_hal_local_executable_cache_prepare_executable(
+      batch->executable_cache, &batch->executable_params[index],
+      &batch->out_executables[index]);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_executable_cache_prepare_executables(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_host_size_t executable_count,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executables) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+
+  // Without a scheduler (or with nothing to fan out) prepare serially.
+  if (!executable_cache->scheduler.parallel_for || executable_count == 1) {
+    for (iree_host_size_t i = 0; i < executable_count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_hal_local_executable_cache_prepare_executable(
+          base_executable_cache, &executable_params[i], &out_executables[i]));
+    }
+    return iree_ok_status();
+  }
+
+  iree_hal_local_executable_cache_batch_t batch = {
+      .executable_cache = base_executable_cache,
+      .executable_params = executable_params,
+      .out_executables = out_executables,
+      .statuses = NULL,
+  };
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      executable_cache->host_allocator,
+      executable_count * sizeof(*batch.statuses), (void**)&batch.statuses));
+
+  iree_status_t status = executable_cache->scheduler.parallel_for(
+      executable_cache->scheduler.self, executable_count,
+      iree_hal_local_executable_cache_prepare_batch_item, &batch);
+
+  // Report the first failure (in executable order) and drop the rest.
+  for (iree_host_size_t i = 0; i < executable_count; ++i) {
+    if (iree_status_is_ok(status)) {
+      status = batch.statuses[i];
+    } else {
+      iree_status_ignore(batch.statuses[i]);
+    }
+  }
+  iree_allocator_free(executable_cache->host_allocator, batch.statuses);
+  return status;
+}
+
 static const iree_hal_executable_cache_vtable_t
     iree_hal_local_executable_cache_vtable = {
         .destroy = iree_hal_local_executable_cache_destroy,
@@ -140,4 +431,6 @@ static const iree_hal_executable_cache_vtable_t
             iree_hal_local_executable_cache_can_prepare_format,
         .prepare_executable =
             iree_hal_local_executable_cache_prepare_executable,
+        .prepare_executables =
+            iree_hal_local_executable_cache_prepare_executables,
 };
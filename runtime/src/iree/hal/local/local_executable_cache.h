@@ -23,12 +23,47 @@ extern "C" {
 // one device is the same JIT'ed executable in another, and in multi-tenant
 // situations we're likely to want that isolation _and_ sharing.
 
+// Function called for each work item of a parallel for.
+typedef iree_status_t(IREE_API_PTR* iree_hal_local_parallel_for_fn_t)(
+    void* user_data, iree_host_size_t index);
+
+// Schedules independent host work used to prepare executables concurrently.
+typedef struct iree_hal_local_executable_cache_scheduler_t {
+  // Opaque scheduler state passed to |parallel_for|.
+  void* self;
+  // Calls |fn| once for each index in [0, count), potentially concurrently
+  // from multiple threads, and returns once all calls have completed.
+  // When NULL all work is performed serially on the calling thread.
+  iree_status_t(IREE_API_PTR* parallel_for)(void* self, iree_host_size_t count,
+                                            iree_hal_local_parallel_for_fn_t fn,
+                                            void* user_data);
+} iree_hal_local_executable_cache_scheduler_t;
+
+// Returns a scheduler that performs all work on the calling thread.
+static inline iree_hal_local_executable_cache_scheduler_t
+iree_hal_local_executable_cache_scheduler_inline(void) {
+  iree_hal_local_executable_cache_scheduler_t scheduler = {NULL, NULL};
+  return scheduler;
+}
+
+// Creates an executable cache that prepares executables on the calling thread.
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
+// Creates an executable cache that uses |scheduler| to load and relocate
+// executables concurrently when they are prepared in batches via
+// iree_hal_executable_cache_prepare_executables. The loaders must be
+// thread-safe.
+iree_status_t iree_hal_local_executable_cache_create_with_scheduler(
+    iree_string_view_t identifier, iree_host_size_t worker_capacity,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_local_executable_cache_scheduler_t scheduler,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_cache_t** out_executable_cache);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
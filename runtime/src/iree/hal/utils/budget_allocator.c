@@ -0,0 +1,402 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/budget_allocator.h"
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_budget_allocator_t
+//===----------------------------------------------------------------------===//
+
+void iree_hal_budget_allocator_params_initialize(
+    iree_hal_budget_allocator_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+}
+
+// Budget state of a heap with per-heap limits.
+typedef struct iree_hal_budget_allocator_heap_t {
+  iree_hal_budget_allocator_heap_params_t params;
+  // Total size, in bytes, of all live allocations made from the heap.
+  iree_device_size_t live_size;
+} iree_hal_budget_allocator_heap_t;
+
+struct iree_hal_budget_allocator_t {
+  iree_hal_resource_t resource;
+
+  // Allocator used for the budget allocator itself.
+  iree_allocator_t host_allocator;
+
+  // Underlying device allocator used to allocate storage.
+  iree_hal_allocator_t* device_allocator;
+
+  // Issued when an allocation would exceed a limit.
+  iree_hal_budget_allocator_pressure_callback_t pressure_callback;
+
+  // Guards the live sizes. Never held during underlying allocator operations
+  // or the pressure callback.
+  iree_slim_mutex_t mutex;
+
+  // Limits on the total live bytes across all heaps.
+  iree_hal_budget_allocator_limits_t total_limits;
+
+  // Total size, in bytes, of all live allocations made through the allocator.
+  iree_device_size_t total_live_size;
+
+  // Number of allocations that crossed a soft limit.
+  IREE_STATISTICS(uint64_t trim_count;)
+  // Number of allocations rejected by a hard limit.
+  IREE_STATISTICS(uint64_t rejection_count;)
+
+  // Heaps with per-heap limits in the order they are matched.
+  iree_host_size_t heap_count;
+  iree_hal_budget_allocator_heap_t heaps[];
+};
+
+static const iree_hal_allocator_vtable_t iree_hal_budget_allocator_vtable;
+
+static iree_hal_budget_allocator_t* iree_hal_budget_allocator_cast(
+    iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_budget_allocator_vtable);
+  return (iree_hal_budget_allocator_t*)base_value;
+}
+
+// Default pressure callback trimming the underlying device allocator.
+static iree_status_t iree_hal_budget_allocator_trim_device_allocator(
+    void* user_data, iree_hal_allocator_t* base_allocator) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  return iree_hal_allocator_trim(allocator->device_allocator);
+}
+
+iree_status_t iree_hal_budget_allocator_create(
+    const iree_hal_budget_allocator_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(!params->heap_count || params->heaps);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_budget_allocator_t* allocator = NULL;
+  iree_host_size_t total_size =
+      iree_sizeof_struct(*allocator) +
+      params->heap_count * sizeof(allocator->heaps[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&allocator));
+  iree_hal_resource_initialize(&iree_hal_budget_allocator_vtable,
+                               &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->device_allocator = device_allocator;
+  iree_hal_allocator_retain(allocator->device_allocator);
+  allocator->pressure_callback = params->pressure_callback;
+  if (!allocator->pressure_callback.fn) {
+    allocator->pressure_callback.fn =
+        iree_hal_budget_allocator_trim_device_allocator;
+    allocator->pressure_callback.user_data = NULL;
+  }
+  iree_slim_mutex_initialize(&allocator->mutex);
+  allocator->total_limits = params->total_limits;
+  allocator->heap_count = params->heap_count;
+  for (iree_host_size_t i = 0; i < params->heap_count; ++i) {
+    allocator->heaps[i].params = params->heaps[i];
+  }
+
+  *out_allocator = (iree_hal_allocator_t*)allocator;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_budget_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_hal_allocator_release(allocator->device_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_budget_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_budget_allocator_t* allocator =
+      (iree_hal_budget_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_budget_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  return iree_hal_allocator_trim(allocator->device_allocator);
+}
+
+static void iree_hal_budget_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->device_allocator,
+                                      out_statistics);
+  IREE_STATISTICS({
+    iree_slim_mutex_lock(&allocator->mutex);
+    out_statistics->budget_trim_count += allocator->trim_count;
+    out_statistics->budget_rejection_count += allocator->rejection_count;
+    iree_slim_mutex_unlock(&allocator->mutex);
+  });
+}
+
+static iree_status_t iree_hal_budget_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_memory_heaps(allocator->device_allocator,
+                                               capacity, heaps, out_count);
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_budget_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_buffer_compatibility(
+      allocator->device_allocator, *params, *allocation_size, params,
+      allocation_size);
+}
+
+// Returns the heap with per-heap limits matching |type| and |allowed_usage| or
+// NULL if only the total limits apply.
+static iree_hal_budget_allocator_heap_t* iree_hal_budget_allocator_find_heap(
+    iree_hal_budget_allocator_t* allocator, iree_hal_memory_type_t type,
+    iree_hal_buffer_usage_t allowed_usage) {
+  for (iree_host_size_t i = 0; i < allocator->heap_count; ++i) {
+    iree_hal_allocator_memory_heap_t heap = allocator->heaps[i].params.heap;
+    if (iree_all_bits_set(heap.type, type) &&
+        iree_all_bits_set(heap.allowed_usage, allowed_usage)) {
+      return &allocator->heaps[i];
+    }
+  }
+  return NULL;
+}
+
+// Returns true if |size| additional bytes exceed |limit| with |live_size|
+// bytes already live. A limit of 0 is unlimited.
+static bool iree_hal_budget_allocator_exceeds(iree_device_size_t live_size,
+                                              iree_device_size_t size,
+                                              iree_device_size_t limit) {
+  return limit && (live_size > limit || size > limit - live_size);
+}
+
+typedef enum iree_hal_budget_allocator_pressure_e {
+  IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_NONE = 0,
+  // At least one soft limit would be exceeded.
+  IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_SOFT,
+  // At least one hard limit would be exceeded.
+  IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_HARD,
+} iree_hal_budget_allocator_pressure_t;
+
+// Returns the pressure an allocation of |size| bytes from |heap| would cause.
+// Must be called with the allocator mutex held.
+static iree_hal_budget_allocator_pressure_t
+iree_hal_budget_allocator_query_pressure(
+    iree_hal_budget_allocator_t* allocator,
+    iree_hal_budget_allocator_heap_t* heap, iree_device_size_t size) {
+  if (iree_hal_budget_allocator_exceeds(allocator->total_live_size, size,
+                                        allocator->total_limits.hard_limit) ||
+      (heap && iree_hal_budget_allocator_exceeds(
+                   heap->live_size, size, heap->params.limits.hard_limit))) {
+    return IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_HARD;
+  }
+  if (iree_hal_budget_allocator_exceeds(allocator->total_live_size, size,
+                                        allocator->total_limits.soft_limit) ||
+      (heap && iree_hal_budget_allocator_exceeds(
+                   heap->live_size, size, heap->params.limits.soft_limit))) {
+    return IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_SOFT;
+  }
+  return IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_NONE;
+}
+
+// Reserves |size| bytes of the budget of |heap| prior to allocating.
+// Allocations that would exceed a limit issue the pressure callback once and
+// are then admitted if only soft limits are still exceeded.
+static iree_status_t iree_hal_budget_allocator_reserve(
+    iree_hal_budget_allocator_t* allocator,
+    iree_hal_budget_allocator_heap_t* heap, iree_device_size_t size) {
+  for (int attempt = 0;; ++attempt) {
+    iree_slim_mutex_lock(&allocator->mutex);
+    iree_hal_budget_allocator_pressure_t pressure =
+        iree_hal_budget_allocator_query_pressure(allocator, heap, size);
+    if (pressure == IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_NONE ||
+        (pressure == IREE_HAL_BUDGET_ALLOCATOR_PRESSURE_SOFT && attempt > 0)) {
+      allocator->total_live_size += size;
+      if (heap) heap->live_size += size;
+      iree_slim_mutex_unlock(&allocator->mutex);
+      return iree_ok_status();
+    } else if (attempt > 0) {
+      IREE_STATISTICS(++allocator->rejection_count);
+      iree_device_size_t total_live_size = allocator->total_live_size;
+      iree_device_size_t heap_live_size = heap ? heap->live_size : 0;
+      iree_slim_mutex_unlock(&allocator->mutex);
+      return iree_make_status(
+          IREE_STATUS_RESOURCE_EXHAUSTED,
+          "allocation of %" PRIdsz
+          " bytes exceeds the hard memory budget limit (%" PRIdsz
+          " bytes live of %" PRIdsz " total, %" PRIdsz " bytes live of %" PRIdsz
+          " in the heap; 0 is unlimited)",
+          size, total_live_size, allocator->total_limits.hard_limit,
+          heap_live_size, heap ? heap->params.limits.hard_limit : 0);
+    }
+    IREE_STATISTICS(++allocator->trim_count);
+    iree_slim_mutex_unlock(&allocator->mutex);
+
+    // Try to release cached memory before checking again.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_budget_allocator_pressure");
+    iree_status_t status =
+        allocator->pressure_callback.fn(allocator->pressure_callback.user_data,
+                                        (iree_hal_allocator_t*)allocator);
+    IREE_TRACE_ZONE_END(z0);
+    IREE_RETURN_IF_ERROR(status);
+  }
+}
+
+// Returns |size| bytes of the budget of |heap|.
+static void iree_hal_budget_allocator_unreserve(
+    iree_hal_budget_allocator_t* allocator,
+    iree_hal_budget_allocator_heap_t* heap, iree_device_size_t size) {
+  iree_slim_mutex_lock(&allocator->mutex);
+  IREE_ASSERT_GE(allocator->total_live_size, size);
+  allocator->total_live_size -= size;
+  if (heap) {
+    IREE_ASSERT_GE(heap->live_size, size);
+    heap->live_size -= size;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
+static iree_status_t iree_hal_budget_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+
+  // Resolve the parameters and size the underlying allocator will use so that
+  // the budget is charged for what is actually allocated.
+  iree_hal_buffer_params_t compat_params;
+  if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                             allocator->device_allocator, *params,
+                             allocation_size, &compat_params, &allocation_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+
+  // Reserve the budget before allocating so that concurrent allocations can't
+  // collectively exceed the limits.
+  iree_hal_budget_allocator_heap_t* heap = iree_hal_budget_allocator_find_heap(
+      allocator, compat_params.type, compat_params.usage);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_budget_allocator_reserve(allocator, heap, allocation_size));
+
+  iree_status_t status = iree_hal_allocator_allocate_buffer(
+      allocator->device_allocator, compat_params, allocation_size,
+      initial_data, out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_budget_allocator_unreserve(allocator, heap, allocation_size);
+    return status;
+  }
+
+  // The buffer may have been given more capabilities or storage than requested
+  // and is charged to the heap it will be returned to upon deallocation.
+  iree_hal_buffer_t* buffer = *out_buffer;
+  iree_hal_budget_allocator_heap_t* actual_heap =
+      iree_hal_budget_allocator_find_heap(
+          allocator, iree_hal_buffer_memory_type(buffer),
+          iree_hal_buffer_allowed_usage(buffer));
+  iree_device_size_t actual_size = iree_hal_buffer_allocation_size(buffer);
+  if (actual_heap != heap || actual_size != allocation_size) {
+    iree_slim_mutex_lock(&allocator->mutex);
+    allocator->total_live_size =
+        allocator->total_live_size - allocation_size + actual_size;
+    if (heap) heap->live_size -= allocation_size;
+    if (actual_heap) actual_heap->live_size += actual_size;
+    iree_slim_mutex_unlock(&allocator->mutex);
+  }
+
+  // Point the buffer back to us for deallocation.
+  buffer->device_allocator = base_allocator;
+
+  return iree_ok_status();
+}
+
+static void iree_hal_budget_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  iree_hal_budget_allocator_heap_t* heap = iree_hal_budget_allocator_find_heap(
+      allocator, iree_hal_buffer_memory_type(buffer),
+      iree_hal_buffer_allowed_usage(buffer));
+  iree_hal_budget_allocator_unreserve(allocator, heap,
+                                      iree_hal_buffer_allocation_size(buffer));
+  iree_hal_allocator_deallocate_buffer(allocator->device_allocator, buffer);
+}
+
+static iree_status_t iree_hal_budget_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  // Imported memory is owned externally and not charged to the budget.
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  return iree_hal_allocator_import_buffer(allocator->device_allocator, *params,
+                                          external_buffer, release_callback,
+                                          out_buffer);
+}
+
+static iree_status_t iree_hal_budget_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  iree_hal_budget_allocator_t* allocator =
+      iree_hal_budget_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->device_allocator, buffer,
+                                          requested_type, requested_flags,
+                                          out_external_buffer);
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_budget_allocator_vtable = {
+    .destroy = iree_hal_budget_allocator_destroy,
+    .host_allocator = iree_hal_budget_allocator_host_allocator,
+    .trim = iree_hal_budget_allocator_trim,
+    .query_statistics = iree_hal_budget_allocator_query_statistics,
+    .query_memory_heaps = iree_hal_budget_allocator_query_memory_heaps,
+    .query_buffer_compatibility =
+        iree_hal_budget_allocator_query_buffer_compatibility,
+    .allocate_buffer = iree_hal_budget_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_budget_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_budget_allocator_import_buffer,
+    .export_buffer = iree_hal_budget_allocator_export_buffer,
+};
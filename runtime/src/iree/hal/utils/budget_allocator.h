@@ -0,0 +1,101 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_BUDGET_ALLOCATOR_H_
+#define IREE_HAL_UTILS_BUDGET_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A HAL buffer allocator that enforces memory budgets on the allocations made
+// from an underlying device allocator.
+//
+// Budgets are expressed as soft and hard limits on the total number of live
+// bytes either across the whole allocator or within a particular heap. When an
+// allocation would cross a soft limit the pressure callback is issued (by
+// default trimming the underlying allocator) before the allocation proceeds.
+// When an allocation would cross a hard limit the pressure callback is issued
+// and if the allocation still does not fit it fails with
+// IREE_STATUS_RESOURCE_EXHAUSTED without ever reaching the underlying
+// allocator. This allows multiple programs sharing a device to each be given a
+// predictable slice of memory instead of racing each other to exhaustion.
+//
+// Only allocations made through this allocator are counted: imported buffers
+// are routed directly to the underlying allocator. When used with caching the
+// budget allocator should be placed below the caching allocator so that pooled
+// free buffers count against the budget and the pressure callback should trim
+// the caching allocator so that they are released under pressure.
+//
+// Thread-safe: the allocator can be shared across multiple user-level devices
+// manipulated from multiple threads.
+typedef struct iree_hal_budget_allocator_t iree_hal_budget_allocator_t;
+
+// Soft and hard limits on live bytes. A limit of 0 is unlimited.
+typedef struct iree_hal_budget_allocator_limits_t {
+  // Live bytes above which the pressure callback is issued before allocating.
+  iree_device_size_t soft_limit;
+  // Live bytes that allocations can never exceed.
+  iree_device_size_t hard_limit;
+} iree_hal_budget_allocator_limits_t;
+
+// Limits applied to the allocations made from a particular heap.
+typedef struct iree_hal_budget_allocator_heap_params_t {
+  // Heap the limits apply to. Allocations are matched to the first heap whose
+  // type and allowed usage bits are a superset of the allocation's.
+  iree_hal_allocator_memory_heap_t heap;
+  iree_hal_budget_allocator_limits_t limits;
+} iree_hal_budget_allocator_heap_params_t;
+
+// Callback issued when an allocation would exceed a limit.
+// Implementations should release cached memory, for example by trimming the
+// allocator that sits above the budget allocator. |allocator| is the budget
+// allocator issuing the callback. The callback is made without any budget
+// allocator locks held and may allocate or deallocate buffers.
+typedef struct iree_hal_budget_allocator_pressure_callback_t {
+  iree_status_t(IREE_API_PTR* fn)(void* user_data,
+                                  iree_hal_allocator_t* allocator);
+  void* user_data;
+} iree_hal_budget_allocator_pressure_callback_t;
+
+// Parameters used to configure an iree_hal_budget_allocator_t.
+typedef struct iree_hal_budget_allocator_params_t {
+  // Limits on the total live bytes across all heaps.
+  iree_hal_budget_allocator_limits_t total_limits;
+
+  // Per-heap limits. Allocations from heaps not listed are only subject to
+  // |total_limits|.
+  iree_host_size_t heap_count;
+  const iree_hal_budget_allocator_heap_params_t* heaps;
+
+  // Issued when an allocation would exceed a limit. If no callback is provided
+  // the underlying device allocator is trimmed.
+  iree_hal_budget_allocator_pressure_callback_t pressure_callback;
+} iree_hal_budget_allocator_params_t;
+
+// Initializes |out_params| to the default (unlimited) values.
+void iree_hal_budget_allocator_params_initialize(
+    iree_hal_budget_allocator_params_t* out_params);
+
+// Creates an allocator that enforces the budgets in |params| on allocations
+// made from |device_allocator|. |params| and the heap list are copied.
+//
+// Buffer import and export and other operations that the budget allocator does
+// not track are directed to the underlying |device_allocator|.
+iree_status_t iree_hal_budget_allocator_create(
+    const iree_hal_budget_allocator_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_BUDGET_ALLOCATOR_H_
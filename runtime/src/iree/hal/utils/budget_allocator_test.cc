@@ -0,0 +1,176 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/budget_allocator.h"
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/caching_allocator.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+class BudgetAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &heap_allocator_));
+    iree_host_size_t heap_count = 0;
+    IREE_ASSERT_OK(iree_hal_allocator_query_memory_heaps(
+        heap_allocator_, 1, &heap_, &heap_count));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(heap_allocator_);
+  }
+
+  void Create(const iree_hal_budget_allocator_params_t& params) {
+    IREE_ASSERT_OK(iree_hal_budget_allocator_create(
+        &params, heap_allocator_, iree_allocator_system(), &allocator_));
+  }
+
+  iree_status_t Allocate(iree_hal_allocator_t* allocator,
+                         iree_device_size_t size,
+                         iree_hal_buffer_t** out_buffer) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = heap_.type;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    return iree_hal_allocator_allocate_buffer(
+        allocator, params, size, iree_const_byte_span_empty(), out_buffer);
+  }
+
+  static iree_status_t CountPressure(void* user_data,
+                                     iree_hal_allocator_t* allocator) {
+    ++*reinterpret_cast<int*>(user_data);
+    return iree_ok_status();
+  }
+
+  static iree_status_t TrimAllocator(void* user_data,
+                                     iree_hal_allocator_t* allocator) {
+    return iree_hal_allocator_trim(
+        *reinterpret_cast<iree_hal_allocator_t**>(user_data));
+  }
+
+  iree_hal_allocator_t* heap_allocator_ = nullptr;
+  iree_hal_allocator_memory_heap_t heap_;
+  iree_hal_allocator_t* allocator_ = nullptr;
+};
+
+// Allocations beyond the hard limit fail without reaching the underlying
+// allocator and succeed again once memory is released.
+TEST_F(BudgetAllocatorTest, HardLimitRejects) {
+  iree_hal_budget_allocator_params_t params;
+  iree_hal_budget_allocator_params_initialize(&params);
+  params.total_limits.hard_limit = 4096;
+  Create(params);
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(allocator_, 4096, &a));
+  iree_hal_buffer_t* b = nullptr;
+  EXPECT_THAT(Status(Allocate(allocator_, 1, &b)),
+              StatusIs(StatusCode::kResourceExhausted));
+  EXPECT_EQ(b, nullptr);
+  iree_hal_buffer_release(a);
+  IREE_ASSERT_OK(Allocate(allocator_, 1, &b));
+  iree_hal_buffer_release(b);
+
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(allocator_, &statistics);
+  EXPECT_EQ(statistics.budget_rejection_count, 1);
+  EXPECT_EQ(statistics.budget_trim_count, 1);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Allocations beyond the soft limit issue the pressure callback but succeed.
+TEST_F(BudgetAllocatorTest, SoftLimitIssuesPressure) {
+  int pressure_count = 0;
+  iree_hal_budget_allocator_params_t params;
+  iree_hal_budget_allocator_params_initialize(&params);
+  params.total_limits.soft_limit = 4096;
+  params.pressure_callback = {CountPressure, &pressure_count};
+  Create(params);
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(allocator_, 4096, &a));
+  EXPECT_EQ(pressure_count, 0);
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(allocator_, 4096, &b));
+  EXPECT_EQ(pressure_count, 1);
+  iree_hal_buffer_release(a);
+  iree_hal_buffer_release(b);
+}
+
+// Per-heap limits apply to allocations from the matching heap.
+TEST_F(BudgetAllocatorTest, HeapLimits) {
+  iree_hal_budget_allocator_heap_params_t heap_params;
+  heap_params.heap = heap_;
+  heap_params.limits.soft_limit = 0;
+  heap_params.limits.hard_limit = 8192;
+  iree_hal_budget_allocator_params_t params;
+  iree_hal_budget_allocator_params_initialize(&params);
+  params.heap_count = 1;
+  params.heaps = &heap_params;
+  Create(params);
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(allocator_, 8192, &a));
+  iree_hal_buffer_t* b = nullptr;
+  EXPECT_THAT(Status(Allocate(allocator_, 1, &b)),
+              StatusIs(StatusCode::kResourceExhausted));
+  iree_hal_buffer_release(a);
+}
+
+// A caching allocator stacked above the budget allocator is trimmed under
+// pressure so that its free buffers don't starve new allocations.
+TEST_F(BudgetAllocatorTest, TrimsCachingAllocator) {
+  // The caching allocator is created after the budget allocator it wraps so
+  // the callback trims whatever allocator is stored here when issued.
+  iree_hal_allocator_t* caching_allocator = nullptr;
+  iree_hal_budget_allocator_params_t params;
+  iree_hal_budget_allocator_params_initialize(&params);
+  params.total_limits.hard_limit = 16 * 1024;
+  params.pressure_callback = {TrimAllocator, &caching_allocator};
+  Create(params);
+  IREE_ASSERT_OK(iree_hal_caching_allocator_create_unbounded(
+      allocator_, iree_allocator_system(), &caching_allocator));
+
+  // Fill the budget and return the buffer to the cache.
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(caching_allocator, 16 * 1024, &a));
+  iree_hal_buffer_release(a);
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(caching_allocator, &statistics);
+  EXPECT_EQ(statistics.host_bytes_pooled + statistics.device_bytes_pooled,
+            16 * 1024);
+#endif  // IREE_STATISTICS_ENABLE
+
+  // A much smaller allocation can't reuse the cached buffer and only fits
+  // once the cache has been trimmed.
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(caching_allocator, 1024, &b));
+#if IREE_STATISTICS_ENABLE
+  iree_hal_allocator_query_statistics(caching_allocator, &statistics);
+  EXPECT_EQ(statistics.host_bytes_pooled + statistics.device_bytes_pooled, 0);
+  EXPECT_EQ(statistics.budget_trim_count, 1);
+  EXPECT_EQ(statistics.budget_rejection_count, 0);
+#endif  // IREE_STATISTICS_ENABLE
+  iree_hal_buffer_release(b);
+
+  iree_hal_allocator_release(caching_allocator);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
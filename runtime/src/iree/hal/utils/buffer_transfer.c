@@ -80,7 +80,8 @@ static iree_status_t iree_hal_device_transfer_and_wait(
     };
     status = iree_hal_device_queue_execute(device, IREE_HAL_QUEUE_AFFINITY_ANY,
                                            wait_semaphores, signal_semaphores,
-                                           1, &command_buffer);
+                                           1, &command_buffer,
+                                           /*binding_tables=*/NULL);
   }
   if (iree_status_is_ok(status)) {
     status = iree_hal_semaphore_wait(fence_semaphore, signal_value, timeout);
@@ -97,6 +98,60 @@ static iree_status_t iree_hal_device_transfer_and_wait(
 // iree_hal_device_transfer_range implementations
 //===----------------------------------------------------------------------===//
 
+// Pipelines a transfer between host memory and a device buffer through a
+// transient transfer engine. Only the staging ring is allocated instead of a
+// staging buffer covering the entire range and the host copies overlap with
+// the device transfers of the prior chunks.
+static iree_status_t iree_hal_device_transfer_range_pipelined(
+    iree_hal_device_t* device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_timeout_t timeout) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)data_length);
+
+  // Absolute timeouts let us share the deadline across all chunks.
+  iree_convert_timeout_to_absolute(&timeout);
+
+  // Don't allocate more staging buffers than there are chunks.
+  iree_hal_transfer_engine_params_t params;
+  iree_hal_transfer_engine_params_initialize(&params);
+  iree_device_size_t chunk_count =
+      (data_length + params.staging_buffer_size - 1) /
+      params.staging_buffer_size;
+  params.staging_buffer_count = (iree_host_size_t)iree_min(
+      (iree_device_size_t)params.staging_buffer_count, chunk_count);
+  iree_hal_transfer_engine_t* engine = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_transfer_engine_allocate(
+              device, &params, iree_hal_device_host_allocator(device),
+              &engine));
+
+  iree_status_t status = iree_ok_status();
+  if (!source.device_buffer) {
+    iree_hal_fence_t* signal_fence = NULL;
+    status = iree_hal_transfer_engine_upload(
+        engine, /*wait_fence=*/NULL,
+        iree_make_const_byte_span(source.host_buffer.data + source_offset,
+                                  (iree_host_size_t)data_length),
+        target.device_buffer, target_offset, timeout, &signal_fence);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_fence_wait(signal_fence, timeout);
+    }
+    iree_hal_fence_release(signal_fence);
+  } else {
+    status = iree_hal_transfer_engine_download(
+        engine, /*wait_fence=*/NULL, source.device_buffer, source_offset,
+        iree_make_byte_span(target.host_buffer.data + target_offset,
+                            (iree_host_size_t)data_length),
+        timeout);
+  }
+
+  iree_hal_transfer_engine_free(engine);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
     iree_hal_device_t* device, iree_hal_transfer_buffer_t source,
     iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
@@ -148,6 +203,16 @@ IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
                                              &transfer_command, timeout);
   }
 
+  // Transfers between host memory and a device buffer that span more than one
+  // staging buffer are pipelined through a ring of staging buffers.
+  if (!source.device_buffer != !target.device_buffer &&
+      data_length != IREE_WHOLE_BUFFER &&
+      data_length > IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_SIZE) {
+    return iree_hal_device_transfer_range_pipelined(
+        device, source, source_offset, target, target_offset, data_length,
+        timeout);
+  }
+
   iree_status_t status = iree_ok_status();
 
   // Allocate the staging buffer for upload to the device.
@@ -293,6 +358,369 @@ IREE_API_EXPORT iree_status_t iree_hal_device_transfer_mappable_range(
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_transfer_engine_t
+//===----------------------------------------------------------------------===//
+
+// A staging buffer in the transfer engine ring.
+typedef struct iree_hal_transfer_staging_slot_t {
+  // Host-local device-visible staging buffer.
+  iree_hal_buffer_t* buffer;
+  // Persistent mapping of the entire staging buffer.
+  iree_hal_buffer_mapping_t mapping;
+  // Command buffer of the last transfer using the slot. Some implementations
+  // require command buffers to remain live until they have completed.
+  iree_hal_command_buffer_t* command_buffer;
+  // Engine semaphore value signaled when the last transfer using the slot has
+  // completed or 0 if the slot has never been used.
+  uint64_t value;
+  // Host memory the slot contents must be copied to once the transfer using
+  // it has completed, if this was a download.
+  uint8_t* download_target;
+  iree_device_size_t download_length;
+} iree_hal_transfer_staging_slot_t;
+
+struct iree_hal_transfer_engine_t {
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* device;
+  iree_hal_transfer_engine_params_t params;
+
+  // Timeline semaphore signaled by each chunk transfer in order.
+  iree_hal_semaphore_t* semaphore;
+  // Last value that has been submitted to be signaled on |semaphore|.
+  uint64_t last_value;
+
+  // Index of the slot that will be used for the next chunk.
+  iree_host_size_t next_slot;
+  iree_hal_transfer_staging_slot_t slots[];
+};
+
+IREE_API_EXPORT void iree_hal_transfer_engine_params_initialize(
+    iree_hal_transfer_engine_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->queue_affinity = IREE_HAL_QUEUE_AFFINITY_ANY;
+  out_params->staging_buffer_size =
+      IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_SIZE;
+  out_params->staging_buffer_count =
+      IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_COUNT;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_transfer_engine_allocate(
+    iree_hal_device_t* device, const iree_hal_transfer_engine_params_t* params,
+    iree_allocator_t host_allocator, iree_hal_transfer_engine_t** out_engine) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_engine);
+  *out_engine = NULL;
+  if (params->staging_buffer_count == 0 || params->staging_buffer_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one non-empty staging buffer required");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_transfer_engine_t* engine = NULL;
+  iree_host_size_t total_size =
+      sizeof(*engine) + params->staging_buffer_count * sizeof(engine->slots[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&engine));
+  memset(engine, 0, total_size);
+  engine->host_allocator = host_allocator;
+  engine->device = device;
+  iree_hal_device_retain(device);
+  engine->params = *params;
+
+  iree_status_t status =
+      iree_hal_semaphore_create(device, 0ull, &engine->semaphore);
+
+  // Allocate and persistently map all staging buffers.
+  const iree_hal_buffer_params_t staging_params = {
+      .type =
+          IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+               IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT |
+               IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_SEQUENTIAL_WRITE,
+  };
+  for (iree_host_size_t i = 0;
+       i < params->staging_buffer_count && iree_status_is_ok(status); ++i) {
+    iree_hal_transfer_staging_slot_t* slot = &engine->slots[i];
+    status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device), staging_params,
+        params->staging_buffer_size, iree_const_byte_span_empty(),
+        &slot->buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_buffer_map_range(
+          slot->buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+          IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, 0,
+          IREE_WHOLE_BUFFER, &slot->mapping);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_engine = engine;
+  } else {
+    iree_hal_transfer_engine_free(engine);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Waits for the transfer using |slot| to complete and copies out any
+// downloaded contents. Upon return the slot is available for reuse.
+static iree_status_t iree_hal_transfer_engine_retire_slot(
+    iree_hal_transfer_engine_t* engine, iree_hal_transfer_staging_slot_t* slot,
+    iree_timeout_t timeout) {
+  if (slot->value) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_wait(engine->semaphore, slot->value, timeout));
+  }
+  iree_hal_command_buffer_release(slot->command_buffer);
+  slot->command_buffer = NULL;
+  if (slot->download_target) {
+    uint8_t* download_target = slot->download_target;
+    slot->download_target = NULL;
+    if (!iree_all_bits_set(iree_hal_buffer_memory_type(slot->buffer),
+                           IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+      IREE_RETURN_IF_ERROR(iree_hal_buffer_mapping_invalidate_range(
+          &slot->mapping, 0, slot->download_length));
+    }
+    memcpy(download_target, slot->mapping.contents.data,
+           (iree_host_size_t)slot->download_length);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_hal_transfer_engine_free(
+    iree_hal_transfer_engine_t* engine) {
+  if (!engine) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wait for all in-flight transfers to complete before releasing the
+  // staging buffers they are using. There's nothing we can do with any errors
+  // here (the device is likely lost) so we drop them.
+  if (engine->semaphore && engine->last_value) {
+    iree_status_ignore(iree_hal_semaphore_wait(
+        engine->semaphore, engine->last_value, iree_infinite_timeout()));
+  }
+  for (iree_host_size_t i = 0; i < engine->params.staging_buffer_count; ++i) {
+    iree_hal_transfer_staging_slot_t* slot = &engine->slots[i];
+    iree_hal_command_buffer_release(slot->command_buffer);
+    if (slot->mapping.contents.data) {
+      iree_status_ignore(iree_hal_buffer_unmap_range(&slot->mapping));
+    }
+    iree_hal_buffer_release(slot->buffer);
+  }
+  iree_hal_semaphore_release(engine->semaphore);
+  iree_hal_device_release(engine->device);
+  iree_allocator_free(engine->host_allocator, engine);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Retires and returns the next slot in the ring.
+static iree_status_t iree_hal_transfer_engine_acquire_slot(
+    iree_hal_transfer_engine_t* engine, iree_timeout_t timeout,
+    iree_hal_transfer_staging_slot_t** out_slot) {
+  iree_hal_transfer_staging_slot_t* slot = &engine->slots[engine->next_slot];
+  IREE_RETURN_IF_ERROR(
+      iree_hal_transfer_engine_retire_slot(engine, slot, timeout));
+  engine->next_slot = (engine->next_slot + 1) %
+                      engine->params.staging_buffer_count;
+  *out_slot = slot;
+  return iree_ok_status();
+}
+
+// Submits |transfer_command| (or a barrier if NULL) after all prior engine
+// submissions and the optional |wait_fence|. The submission is tracked by
+// |slot| if provided.
+static iree_status_t iree_hal_transfer_engine_submit(
+    iree_hal_transfer_engine_t* engine, iree_hal_fence_t* wait_fence,
+    const iree_hal_transfer_command_t* transfer_command,
+    iree_hal_transfer_staging_slot_t* slot) {
+  // Wait on all prior engine submissions so that the semaphore is always
+  // signaled in order even on devices that may execute submissions out of
+  // order.
+  iree_hal_semaphore_list_t fence_list =
+      wait_fence ? iree_hal_fence_semaphore_list(wait_fence)
+                 : iree_hal_semaphore_list_empty();
+  iree_host_size_t wait_capacity = fence_list.count + 1;
+  iree_hal_semaphore_t** wait_semaphores = (iree_hal_semaphore_t**)iree_alloca(
+      wait_capacity * sizeof(iree_hal_semaphore_t*));
+  uint64_t* wait_values =
+      (uint64_t*)iree_alloca(wait_capacity * sizeof(uint64_t));
+  iree_host_size_t wait_count = 0;
+  if (engine->last_value) {
+    wait_semaphores[wait_count] = engine->semaphore;
+    wait_values[wait_count++] = engine->last_value;
+  }
+  for (iree_host_size_t i = 0; i < fence_list.count; ++i) {
+    wait_semaphores[wait_count] = fence_list.semaphores[i];
+    wait_values[wait_count++] = fence_list.payload_values[i];
+  }
+  const iree_hal_semaphore_list_t wait_semaphore_list = {
+      .count = wait_count,
+      .semaphores = wait_semaphores,
+      .payload_values = wait_values,
+  };
+  uint64_t signal_value = engine->last_value + 1;
+  const iree_hal_semaphore_list_t signal_semaphore_list = {
+      .count = 1,
+      .semaphores = &engine->semaphore,
+      .payload_values = &signal_value,
+  };
+
+  if (!transfer_command) {
+    IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
+        engine->device, engine->params.queue_affinity, wait_semaphore_list,
+        signal_semaphore_list));
+    engine->last_value = signal_value;
+    return iree_ok_status();
+  }
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_create_transfer_command_buffer(
+      engine->device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      engine->params.queue_affinity, 1, transfer_command, &command_buffer));
+  iree_status_t status = iree_hal_device_queue_execute(
+      engine->device, engine->params.queue_affinity, wait_semaphore_list,
+      signal_semaphore_list, 1, &command_buffer, /*binding_tables=*/NULL);
+  if (iree_status_is_ok(status)) {
+    engine->last_value = signal_value;
+    slot->value = signal_value;
+    slot->command_buffer = command_buffer;
+  } else {
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_transfer_engine_upload(
+    iree_hal_transfer_engine_t* engine, iree_hal_fence_t* wait_fence,
+    iree_const_byte_span_t source, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_timeout_t timeout,
+    iree_hal_fence_t** out_signal_fence) {
+  IREE_ASSERT_ARGUMENT(engine);
+  IREE_ASSERT_ARGUMENT(target_buffer);
+  IREE_ASSERT_ARGUMENT(out_signal_fence);
+  *out_signal_fence = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)source.data_length);
+
+  // Absolute timeouts let us share the deadline across all chunks.
+  iree_convert_timeout_to_absolute(&timeout);
+
+  iree_status_t status = iree_ok_status();
+  if (source.data_length == 0) {
+    // Nothing to transfer but the caller still expects the signal fence to be
+    // ordered after the wait fence.
+    status = iree_hal_transfer_engine_submit(engine, wait_fence, NULL, NULL);
+  }
+  for (iree_device_size_t offset = 0;
+       offset < source.data_length && iree_status_is_ok(status);) {
+    iree_device_size_t chunk_length = iree_min(
+        source.data_length - offset, engine->params.staging_buffer_size);
+    iree_hal_transfer_staging_slot_t* slot = NULL;
+    status = iree_hal_transfer_engine_acquire_slot(engine, timeout, &slot);
+
+    // Copy the chunk into the staging buffer. This overlaps with the device
+    // transfers of the prior chunks still in flight.
+    if (iree_status_is_ok(status)) {
+      memcpy(slot->mapping.contents.data, source.data + offset,
+             (iree_host_size_t)chunk_length);
+      if (!iree_all_bits_set(iree_hal_buffer_memory_type(slot->buffer),
+                             IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+        status = iree_hal_buffer_mapping_flush_range(&slot->mapping, 0,
+                                                     chunk_length);
+      }
+    }
+
+    if (iree_status_is_ok(status)) {
+      const iree_hal_transfer_command_t transfer_command = {
+          .type = IREE_HAL_TRANSFER_COMMAND_TYPE_COPY,
+          .copy =
+              {
+                  .source_buffer = slot->buffer,
+                  .source_offset = 0,
+                  .target_buffer = target_buffer,
+                  .target_offset = target_offset + offset,
+                  .length = chunk_length,
+              },
+      };
+      status = iree_hal_transfer_engine_submit(
+          engine, offset == 0 ? wait_fence : NULL, &transfer_command, slot);
+    }
+    offset += chunk_length;
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_create_at(engine->semaphore, engine->last_value,
+                                      engine->host_allocator, out_signal_fence);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_transfer_engine_download(
+    iree_hal_transfer_engine_t* engine, iree_hal_fence_t* wait_fence,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_byte_span_t target, iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(engine);
+  IREE_ASSERT_ARGUMENT(source_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)target.data_length);
+
+  // Absolute timeouts let us share the deadline across all chunks.
+  iree_convert_timeout_to_absolute(&timeout);
+
+  // Issue chunk transfers into the ring. Acquiring a slot with a pending
+  // download retires it by copying its contents out to the host such that up
+  // to staging_buffer_count chunks are in flight while we copy.
+  iree_status_t status = iree_ok_status();
+  for (iree_device_size_t offset = 0;
+       offset < target.data_length && iree_status_is_ok(status);) {
+    iree_device_size_t chunk_length = iree_min(
+        target.data_length - offset, engine->params.staging_buffer_size);
+    iree_hal_transfer_staging_slot_t* slot = NULL;
+    status = iree_hal_transfer_engine_acquire_slot(engine, timeout, &slot);
+    if (iree_status_is_ok(status)) {
+      const iree_hal_transfer_command_t transfer_command = {
+          .type = IREE_HAL_TRANSFER_COMMAND_TYPE_COPY,
+          .copy =
+              {
+                  .source_buffer = source_buffer,
+                  .source_offset = source_offset + offset,
+                  .target_buffer = slot->buffer,
+                  .target_offset = 0,
+                  .length = chunk_length,
+              },
+      };
+      status = iree_hal_transfer_engine_submit(
+          engine, offset == 0 ? wait_fence : NULL, &transfer_command, slot);
+    }
+    if (iree_status_is_ok(status)) {
+      slot->download_target = target.data + offset;
+      slot->download_length = chunk_length;
+    }
+    offset += chunk_length;
+  }
+
+  // Retire all remaining downloads in the order they were issued. We always
+  // retire every slot, even on failure, so that no slot is left referencing
+  // the caller's memory.
+  for (iree_host_size_t i = 0; i < engine->params.staging_buffer_count; ++i) {
+    iree_hal_transfer_staging_slot_t* slot =
+        &engine->slots[(engine->next_slot + i) %
+                       engine->params.staging_buffer_count];
+    if (!slot->download_target) continue;
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_transfer_engine_retire_slot(engine, slot, timeout);
+    }
+    slot->download_target = NULL;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_buffer_map_range implementations
 //===----------------------------------------------------------------------===//
@@ -21,7 +21,10 @@ extern "C" {
 // Performs a full transfer operation on a device transfer queue.
 // This creates a transfer command buffer, submits it against the device, and
 // waits for it to complete synchronously. Implementations that can do this
-// cheaper are encouraged to do so.
+// cheaper are encouraged to do so. Transfers between host memory and a device
+// buffer larger than IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_SIZE are
+// pipelined through a transient iree_hal_transfer_engine_t instead of staging
+// the entire range.
 //
 // Precondition: source and target do not overlap.
 IREE_API_EXPORT iree_status_t iree_hal_device_submit_transfer_range_and_wait(
@@ -43,6 +46,81 @@ IREE_API_EXPORT iree_status_t iree_hal_device_transfer_mappable_range(
     iree_device_size_t target_offset, iree_device_size_t data_length,
     iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout);
 
+//===----------------------------------------------------------------------===//
+// iree_hal_transfer_engine_t
+//===----------------------------------------------------------------------===//
+
+// Default size of each staging buffer used by a transfer engine.
+#define IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_SIZE (4 * 1024 * 1024)
+
+// Default number of staging buffers in a transfer engine ring.
+#define IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_COUNT 3
+
+// Parameters used to configure an iree_hal_transfer_engine_t.
+typedef struct iree_hal_transfer_engine_params_t {
+  // Queue affinity used for all transfer submissions.
+  iree_hal_queue_affinity_t queue_affinity;
+  // Size in bytes of each staging buffer. Transfers are split into chunks of
+  // at most this size.
+  iree_device_size_t staging_buffer_size;
+  // Number of staging buffers in the ring. At least 2 are required for the
+  // host copies to overlap with the device transfers.
+  iree_host_size_t staging_buffer_count;
+} iree_hal_transfer_engine_params_t;
+
+// Initializes |out_params| to the default values.
+IREE_API_EXPORT void iree_hal_transfer_engine_params_initialize(
+    iree_hal_transfer_engine_params_t* out_params);
+
+// Pipelines large transfers between host memory and device buffers that are
+// not host mappable through a ring of host-local device-visible staging
+// buffers. Each transfer is split into staging buffer sized chunks such that
+// the host copy of one chunk overlaps with the device transfer of the previous
+// ones instead of staging the entire range and waiting as
+// iree_hal_device_submit_transfer_range_and_wait does.
+//
+// All submissions are made in order against a single timeline semaphore owned
+// by the engine and transfers issued through the same engine execute in the
+// order they were issued.
+//
+// Thread-compatible: engines may be used from any thread but only one at a
+// time. Multiple threads should each have their own engine.
+typedef struct iree_hal_transfer_engine_t iree_hal_transfer_engine_t;
+
+// Allocates a transfer engine for |device| and its ring of staging buffers.
+IREE_API_EXPORT iree_status_t iree_hal_transfer_engine_allocate(
+    iree_hal_device_t* device, const iree_hal_transfer_engine_params_t* params,
+    iree_allocator_t host_allocator, iree_hal_transfer_engine_t** out_engine);
+
+// Waits for all in-flight transfers to complete and frees the |engine|.
+IREE_API_EXPORT void iree_hal_transfer_engine_free(
+    iree_hal_transfer_engine_t* engine);
+
+// Asynchronously uploads |source| host memory to |target_buffer| starting at
+// |target_offset|. The transfer begins after the optional |wait_fence| is
+// reached and |out_signal_fence| is returned and will be signaled when the data
+// is available in |target_buffer|.
+//
+// The source memory is copied into staging buffers before this returns and may
+// be reused immediately. The call will block only if all staging buffers are
+// in use by prior chunks and they do not complete before |timeout| elapses.
+IREE_API_EXPORT iree_status_t iree_hal_transfer_engine_upload(
+    iree_hal_transfer_engine_t* engine, iree_hal_fence_t* wait_fence,
+    iree_const_byte_span_t source, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_timeout_t timeout,
+    iree_hal_fence_t** out_signal_fence);
+
+// Downloads a range of |source_buffer| starting at |source_offset| into the
+// |target| host memory once the optional |wait_fence| is reached.
+//
+// Device transfers are pipelined with the host copies out of the staging
+// buffers but as the final copies must be performed by the host the download
+// has completed when this returns.
+IREE_API_EXPORT iree_status_t iree_hal_transfer_engine_download(
+    iree_hal_transfer_engine_t* engine, iree_hal_fence_t* wait_fence,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_byte_span_t target, iree_timeout_t timeout);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_buffer_map_range implementations
 //===----------------------------------------------------------------------===//
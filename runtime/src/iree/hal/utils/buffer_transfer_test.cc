@@ -0,0 +1,286 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/buffer_transfer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Small staging buffers so that modest transfers are split into many chunks.
+constexpr iree_device_size_t kStagingBufferSize = 64;
+
+class TransferEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_allocator_t* device_allocator = nullptr;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator));
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    iree_status_t status = iree_hal_sync_device_create(
+        iree_make_cstring_view("local-sync"), &params, /*loader_count=*/0,
+        /*loaders=*/nullptr, device_allocator, iree_allocator_system(),
+        &device_);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+  }
+
+  void TearDown() override {
+    iree_hal_transfer_engine_free(engine_);
+    iree_hal_device_release(device_);
+  }
+
+  void CreateEngine(iree_host_size_t staging_buffer_count) {
+    iree_hal_transfer_engine_params_t params;
+    iree_hal_transfer_engine_params_initialize(&params);
+    params.staging_buffer_size = kStagingBufferSize;
+    params.staging_buffer_count = staging_buffer_count;
+    IREE_ASSERT_OK(iree_hal_transfer_engine_allocate(
+        device_, &params, iree_allocator_system(), &engine_));
+  }
+
+  iree_hal_buffer_t* AllocateDeviceBuffer(iree_device_size_t size) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device_), params, size,
+        iree_const_byte_span_empty(), &buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_zero(buffer, 0, IREE_WHOLE_BUFFER));
+    return buffer;
+  }
+
+  // Returns |size| bytes that differ at every position within a chunk and
+  // across chunks so misplaced chunks are detected.
+  static std::vector<uint8_t> MakePattern(iree_device_size_t size,
+                                          uint8_t seed = 0) {
+    std::vector<uint8_t> pattern(size);
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      pattern[i] = (uint8_t)(i * 7 + i / kStagingBufferSize + seed);
+    }
+    return pattern;
+  }
+
+  std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::vector<uint8_t> contents(iree_hal_buffer_byte_length(buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_read(buffer, 0, contents.data(),
+                                           contents.size()));
+    return contents;
+  }
+
+  iree_status_t Upload(iree_hal_fence_t* wait_fence,
+                       const std::vector<uint8_t>& source,
+                       iree_hal_buffer_t* target_buffer,
+                       iree_hal_fence_t** out_signal_fence) {
+    return iree_hal_transfer_engine_upload(
+        engine_, wait_fence,
+        iree_make_const_byte_span(source.data(), source.size()), target_buffer,
+        /*target_offset=*/0, iree_infinite_timeout(), out_signal_fence);
+  }
+
+  iree_status_t Download(iree_hal_fence_t* wait_fence,
+                         iree_hal_buffer_t* source_buffer,
+                         std::vector<uint8_t>* target) {
+    return iree_hal_transfer_engine_download(
+        engine_, wait_fence, source_buffer, /*source_offset=*/0,
+        iree_make_byte_span(target->data(), target->size()),
+        iree_infinite_timeout());
+  }
+
+  iree_hal_device_t* device_ = nullptr;
+  iree_hal_transfer_engine_t* engine_ = nullptr;
+};
+
+TEST_F(TransferEngineTest, InvalidParams) {
+  iree_hal_transfer_engine_params_t params;
+  iree_hal_transfer_engine_params_initialize(&params);
+  params.staging_buffer_count = 0;
+  EXPECT_THAT(Status(iree_hal_transfer_engine_allocate(
+                  device_, &params, iree_allocator_system(), &engine_)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(engine_, nullptr);
+}
+
+// An upload and download spanning several chunks (with a partial last chunk)
+// round-trips through the staging ring.
+TEST_F(TransferEngineTest, MultiChunkRoundTrip) {
+  CreateEngine(/*staging_buffer_count=*/3);
+  const iree_device_size_t size = 3 * kStagingBufferSize - 5;
+  std::vector<uint8_t> source = MakePattern(size);
+  iree_hal_buffer_t* buffer = AllocateDeviceBuffer(size);
+
+  iree_hal_fence_t* upload_fence = nullptr;
+  IREE_ASSERT_OK(Upload(/*wait_fence=*/nullptr, source, buffer, &upload_fence));
+  IREE_ASSERT_OK(iree_hal_fence_wait(upload_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(upload_fence);
+  EXPECT_EQ(ReadBuffer(buffer), source);
+
+  std::vector<uint8_t> target(size, 0);
+  IREE_ASSERT_OK(Download(/*wait_fence=*/nullptr, buffer, &target));
+  EXPECT_EQ(target, source);
+
+  iree_hal_buffer_release(buffer);
+}
+
+// Transfers with more chunks than staging buffers wrap around the ring and
+// reuse each slot only after its prior chunk has completed.
+TEST_F(TransferEngineTest, RingWraparound) {
+  CreateEngine(/*staging_buffer_count=*/2);
+  const iree_device_size_t size = 7 * kStagingBufferSize + 13;
+  std::vector<uint8_t> source = MakePattern(size);
+  iree_hal_buffer_t* buffer = AllocateDeviceBuffer(size);
+
+  iree_hal_fence_t* upload_fence = nullptr;
+  IREE_ASSERT_OK(Upload(/*wait_fence=*/nullptr, source, buffer, &upload_fence));
+  IREE_ASSERT_OK(iree_hal_fence_wait(upload_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(upload_fence);
+  EXPECT_EQ(ReadBuffer(buffer), source);
+
+  std::vector<uint8_t> target(size, 0);
+  IREE_ASSERT_OK(Download(/*wait_fence=*/nullptr, buffer, &target));
+  EXPECT_EQ(target, source);
+
+  // A second round-trip with new contents through the already used ring.
+  std::vector<uint8_t> source2 = MakePattern(size, /*seed=*/3);
+  IREE_ASSERT_OK(
+      Upload(/*wait_fence=*/nullptr, source2, buffer, &upload_fence));
+  iree_hal_fence_release(upload_fence);
+  std::vector<uint8_t> target2(size, 0);
+  IREE_ASSERT_OK(Download(/*wait_fence=*/nullptr, buffer, &target2));
+  EXPECT_EQ(target2, source2);
+
+  iree_hal_buffer_release(buffer);
+}
+
+// Transfers do not begin before their wait fence is reached and a download
+// waiting on an upload's signal fence observes the uploaded data.
+TEST_F(TransferEngineTest, WaitFenceOrdering) {
+  CreateEngine(/*staging_buffer_count=*/2);
+  const iree_device_size_t size = 5 * kStagingBufferSize;
+  std::vector<uint8_t> source = MakePattern(size);
+  iree_hal_buffer_t* buffer = AllocateDeviceBuffer(size);
+
+  iree_hal_semaphore_t* semaphore = nullptr;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_fence_t* wait_fence = nullptr;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &wait_fence));
+
+  // Signal the wait fence from another thread after a delay. The sync device
+  // blocks the submission until then.
+  std::atomic<bool> signaled{false};
+  std::thread signaler([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    signaled = true;
+    IREE_CHECK_OK(iree_hal_semaphore_signal(semaphore, 1ull));
+  });
+
+  iree_hal_fence_t* upload_fence = nullptr;
+  IREE_ASSERT_OK(Upload(wait_fence, source, buffer, &upload_fence));
+  std::vector<uint8_t> target(size, 0);
+  IREE_ASSERT_OK(Download(upload_fence, buffer, &target));
+  EXPECT_TRUE(signaled.load());
+  EXPECT_EQ(target, source);
+  signaler.join();
+
+  iree_hal_fence_release(upload_fence);
+  iree_hal_fence_release(wait_fence);
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_buffer_release(buffer);
+}
+
+// Failures of the wait fence are returned by the transfer, which leaves the
+// target untouched and the engine usable.
+TEST_F(TransferEngineTest, ErrorPropagation) {
+  CreateEngine(/*staging_buffer_count=*/2);
+  const iree_device_size_t size = 3 * kStagingBufferSize;
+  std::vector<uint8_t> source = MakePattern(size);
+  iree_hal_buffer_t* buffer = AllocateDeviceBuffer(size);
+
+  iree_hal_semaphore_t* semaphore = nullptr;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_fence_t* wait_fence = nullptr;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &wait_fence));
+  iree_hal_semaphore_fail(semaphore,
+                          iree_make_status(IREE_STATUS_DATA_LOSS, "lost"));
+
+  iree_hal_fence_t* upload_fence = nullptr;
+  EXPECT_THAT(Status(Upload(wait_fence, source, buffer, &upload_fence)),
+              StatusIs(StatusCode::kAborted));
+  EXPECT_EQ(upload_fence, nullptr);
+  EXPECT_EQ(ReadBuffer(buffer), std::vector<uint8_t>(size, 0));
+
+  std::vector<uint8_t> target(size, 0xCD);
+  EXPECT_THAT(Status(Download(wait_fence, buffer, &target)),
+              StatusIs(StatusCode::kAborted));
+  EXPECT_EQ(target, std::vector<uint8_t>(size, 0xCD));
+
+  // Transfers not waiting on the failed fence still succeed.
+  IREE_ASSERT_OK(Upload(/*wait_fence=*/nullptr, source, buffer, &upload_fence));
+  iree_hal_fence_release(upload_fence);
+  IREE_ASSERT_OK(Download(/*wait_fence=*/nullptr, buffer, &target));
+  EXPECT_EQ(target, source);
+
+  iree_hal_fence_release(wait_fence);
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_buffer_release(buffer);
+}
+
+// Host transfers to and from unmappable buffers larger than a staging buffer
+// are pipelined through a transfer engine by
+// iree_hal_device_submit_transfer_range_and_wait.
+TEST_F(TransferEngineTest, SubmitTransferRangePipelined) {
+  const iree_device_size_t size =
+      IREE_HAL_TRANSFER_ENGINE_DEFAULT_STAGING_BUFFER_SIZE + 4096 + 3;
+  std::vector<uint8_t> source = MakePattern(size);
+  iree_hal_buffer_params_t params = {0};
+  params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  iree_hal_buffer_t* buffer = nullptr;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(device_), params, size,
+      iree_const_byte_span_empty(), &buffer));
+
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_,
+      iree_hal_make_host_transfer_buffer(
+          iree_make_byte_span(source.data(), source.size())),
+      0, iree_hal_make_device_transfer_buffer(buffer), 0, size,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  std::vector<uint8_t> target(size, 0);
+  IREE_ASSERT_OK(iree_hal_device_submit_transfer_range_and_wait(
+      device_, iree_hal_make_device_transfer_buffer(buffer), 0,
+      iree_hal_make_host_transfer_buffer(
+          iree_make_byte_span(target.data(), target.size())),
+      0, size, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  EXPECT_EQ(target, source);
+
+  iree_hal_buffer_release(buffer);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
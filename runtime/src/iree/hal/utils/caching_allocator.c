@@ -6,12 +6,101 @@
 
 #include "iree/hal/utils/caching_allocator.h"
 
+#include "iree/base/internal/math.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 
 // Default capacity of a pool free list when not specified by the user.
 #define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY 64
 
+//===----------------------------------------------------------------------===//
+// Size classes
+//===----------------------------------------------------------------------===//
+// Allocations are rounded up to a size class and the free buffers of a pool are
+// bucketed by class. Each power of two is subdivided into
+// 2^IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS classes so that the
+// rounding wastes at most 1/4 of the allocation while still allowing buffers
+// to be reused by requests of slightly different sizes (common in dynamically
+// shaped programs). Requests are first served from their own class and then
+// from the nearest larger non-empty class within
+// IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MAX_OVERFIT classes.
+//
+// Example classes: 256, 320, 384, 448, 512, 640, 768, 896, 1024, 1280, ...
+
+// Sizes at or below 1 << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS all
+// map to the first size class.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS 8
+
+// log2 of the number of size classes per power of two.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS 2
+
+// Total number of size classes covering the full 64-bit device size range.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT                \
+  (((64 - IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS)          \
+    << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS) +   \
+   1)
+
+// Number of 64-bit words in the non-empty size class bitmap.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_WORD_COUNT \
+  ((IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT + 63) / 64)
+
+// Maximum number of classes above the requested class that will be searched
+// for a free buffer. A value of 4 bounds the waste of a reused buffer to 2x.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MAX_OVERFIT 4
+
+// Returns the smallest size class that can hold |size| bytes.
+static uint32_t iree_hal_caching_allocator_size_class_ceil(
+    iree_device_size_t size) {
+  if (size <= (1ull << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS)) {
+    return 0;
+  }
+  const uint64_t n = (uint64_t)size - 1;
+  const uint32_t msb = 63 - iree_math_count_leading_zeros_u64(n);
+  const uint32_t shift =
+      msb - IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS;
+  const uint32_t mantissa =
+      (uint32_t)(n >> shift) -
+      (1u << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS);
+  return ((msb - IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS)
+          << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS) +
+         mantissa + 1;
+}
+
+// Returns the size in bytes of |size_class|. Saturates for the topmost classes
+// that cannot be represented.
+static iree_device_size_t iree_hal_caching_allocator_size_class_size(
+    uint32_t size_class) {
+  if (size_class == 0) {
+    return 1ull << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS;
+  }
+  const uint32_t i = size_class - 1;
+  const uint32_t msb =
+      (i >> IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS) +
+      IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MIN_BITS;
+  const uint32_t shift =
+      msb - IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS;
+  const uint64_t mantissa =
+      (1ull << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS) +
+      (i & ((1u << IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_SUBDIVISION_BITS) -
+            1)) +
+      1;
+  if (mantissa > (UINT64_MAX >> shift)) return IREE_DEVICE_SIZE_MAX;
+  return (iree_device_size_t)(mantissa << shift);
+}
+
+// Returns the largest size class whose size is <= |size|. Buffers are filed
+// under this class so that any request mapping to the class can use them even
+// if the underlying allocator rounded the allocation up further.
+static uint32_t iree_hal_caching_allocator_size_class_floor(
+    iree_device_size_t size) {
+  uint32_t size_class = iree_hal_caching_allocator_size_class_ceil(size);
+  if (size_class > 0 &&
+      iree_hal_caching_allocator_size_class_size(size_class) > size) {
+    --size_class;
+  }
+  return size_class;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_caching_allocator_pool_t
 //===----------------------------------------------------------------------===//
@@ -31,9 +120,30 @@ void iree_hal_caching_allocator_pool_params_initialize(
       IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY;
 }
 
+// Sentinel entry index used to terminate entry lists.
+#define IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE UINT32_MAX
+
+// A free buffer tracked by a pool.
+// Each entry is linked into both the list of its size class and the pool-wide
+// recency list used to trim the oldest buffers first.
+typedef struct iree_hal_caching_allocator_entry_t {
+  // Retained buffer available for reuse.
+  iree_hal_buffer_t* buffer;
+  // Size class the entry is filed under.
+  uint32_t size_class;
+  // Neighbors in the size class list (head is the most recent).
+  // Unused entries are chained through |class_next| in the pool unused list.
+  uint32_t class_prev;
+  uint32_t class_next;
+  // Neighbors in the pool recency list.
+  uint32_t lru_prev;
+  uint32_t lru_next;
+} iree_hal_caching_allocator_entry_t;
+
 // Pool of arbitrarily-sized device allocations for a particular heap.
-// This maintains a free list of blocks available for use but does not track
-// outstanding allocations.
+// This maintains free lists of blocks available for use bucketed by size class
+// but does not track outstanding allocations. Acquiring and releasing buffers
+// is O(1) in the number of free buffers.
 //
 // Thread-safe. Pools can service requests from multiple threads concurrently by
 // way of a pool-specific mutex. The mutex will not be held during underlying
@@ -64,13 +174,23 @@ typedef iree_alignas(
   // Total size, in bytes, of all free buffers currently in this pool.
   iree_device_size_t free_allocated_size;
 
-  // Flat MRU list of available buffers with max_free_allocation_count slots.
-  // Sorted by ascending recency (the higher the index the more recent).
-  // If we really cared about optimizing the interior removal then we'd want
-  // a linked/skip list or some bucketing but that's really for the higher
-  // level allocators to do.
+  // Bitmap of size classes with at least one free buffer.
+  uint64_t class_mask[IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_WORD_COUNT];
+
+  // Most recently released entry of each size class.
+  uint32_t class_heads[IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT];
+
+  // Most and least recently released entries across all size classes.
+  uint32_t lru_head;
+  uint32_t lru_tail;
+
+  // Singly-linked list of unused entries.
+  uint32_t unused_head;
+
+  // Entry storage with max_free_allocation_count slots of which free_count are
+  // currently holding buffers.
   iree_host_size_t free_count;
-  iree_hal_buffer_t* free_buffers[];
+  iree_hal_caching_allocator_entry_t entries[];
 } iree_hal_caching_allocator_pool_t;
 
 static void iree_hal_caching_allocator_pool_trim(
@@ -89,8 +209,24 @@ static void iree_hal_caching_allocator_pool_initialize(
   iree_slim_mutex_initialize(&out_pool->mutex);
   out_pool->total_allocated_size = 0;
   out_pool->free_allocated_size = 0;
+  memset(out_pool->class_mask, 0, sizeof(out_pool->class_mask));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_pool->class_heads);
+       ++i) {
+    out_pool->class_heads[i] = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  }
+  out_pool->lru_head = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  out_pool->lru_tail = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
   out_pool->free_count = 0;
 
+  // Chain all entries into the unused list.
+  out_pool->unused_head = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  for (iree_host_size_t i = params.max_free_allocation_count; i > 0; --i) {
+    iree_hal_caching_allocator_entry_t* entry = &out_pool->entries[i - 1];
+    memset(entry, 0, sizeof(*entry));
+    entry->class_next = out_pool->unused_head;
+    out_pool->unused_head = (uint32_t)(i - 1);
+  }
+
   IREE_TRACE_SET_PLOT_TYPE(IREE_HAL_CACHING_ALLOCATOR_ID,
                            IREE_TRACING_PLOT_TYPE_MEMORY, /*step=*/true,
                            /*fill=*/true, /*color=*/0);
@@ -120,7 +256,7 @@ static void iree_hal_caching_allocator_pool_deinitialize(
   IREE_TRACE_ZONE_END(z0);
 }
 
-// Pushes |buffer| on to the pool free list as the most recently used.
+// Pushes |buffer| on to the pool free lists as the most recently used.
 // The buffer will be retained in the list.
 //
 // Must be called with the pool mutex held.
@@ -131,10 +267,33 @@ static void iree_hal_caching_allocator_pool_push_buffer(
   iree_hal_buffer_retain(buffer);
 
   IREE_ASSERT_LT(pool->free_count, pool->params.max_free_allocation_count);
-
-  // Add to the end of the list (the most recent).
-  iree_host_size_t i = pool->free_count++;
-  pool->free_buffers[i] = buffer;
+  const uint32_t index = pool->unused_head;
+  iree_hal_caching_allocator_entry_t* entry = &pool->entries[index];
+  pool->unused_head = entry->class_next;
+  ++pool->free_count;
+
+  entry->buffer = buffer;
+  entry->size_class = iree_hal_caching_allocator_size_class_floor(
+      iree_hal_buffer_allocation_size(buffer));
+
+  // Add to the head of the size class list (the most recent).
+  entry->class_prev = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  entry->class_next = pool->class_heads[entry->size_class];
+  if (entry->class_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->class_next].class_prev = index;
+  }
+  pool->class_heads[entry->size_class] = index;
+  pool->class_mask[entry->size_class / 64] |= 1ull << (entry->size_class % 64);
+
+  // Add to the head of the recency list.
+  entry->lru_prev = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  entry->lru_next = pool->lru_head;
+  if (entry->lru_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->lru_next].lru_prev = index;
+  } else {
+    pool->lru_tail = index;
+  }
+  pool->lru_head = index;
 
   // Track that we're now retaining unused memory.
   pool->free_allocated_size += buffer->allocation_size;
@@ -142,45 +301,112 @@ static void iree_hal_caching_allocator_pool_push_buffer(
                             pool->free_allocated_size);
 }
 
-// Takes the buffer in the |pool| free list at index |i| and returns ownership.
-// If the list is large this is bad but in most cases it's just a few dozen
-// elements.
+// Takes the buffer in the |pool| entry at |index| and returns ownership.
 //
 // Must be called with the pool mutex held.
 static iree_hal_buffer_t* iree_hal_caching_allocator_pool_take_buffer_at(
-    iree_hal_caching_allocator_pool_t* pool, iree_host_size_t i) {
-  iree_hal_buffer_t* buffer = pool->free_buffers[i];
-  if (i < pool->free_count - 1) {
-    // Shift the list down to keep it dense and in ascending recency order.
-    memmove(&pool->free_buffers[i], &pool->free_buffers[i + 1],
-            (pool->free_count - i - 1) * sizeof(pool->free_buffers[0]));
+    iree_hal_caching_allocator_pool_t* pool, uint32_t index) {
+  iree_hal_caching_allocator_entry_t* entry = &pool->entries[index];
+  iree_hal_buffer_t* buffer = entry->buffer;
+
+  // Unlink from the size class list.
+  if (entry->class_prev != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->class_prev].class_next = entry->class_next;
+  } else {
+    pool->class_heads[entry->size_class] = entry->class_next;
+  }
+  if (entry->class_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->class_next].class_prev = entry->class_prev;
+  }
+  if (pool->class_heads[entry->size_class] ==
+      IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->class_mask[entry->size_class / 64] &=
+        ~(1ull << (entry->size_class % 64));
+  }
+
+  // Unlink from the recency list.
+  if (entry->lru_prev != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->lru_prev].lru_next = entry->lru_next;
+  } else {
+    pool->lru_head = entry->lru_next;
+  }
+  if (entry->lru_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->lru_next].lru_prev = entry->lru_prev;
+  } else {
+    pool->lru_tail = entry->lru_prev;
   }
+
+  // Return the entry to the unused list.
+  entry->buffer = NULL;
+  entry->class_next = pool->unused_head;
+  pool->unused_head = index;
   --pool->free_count;
+
   pool->free_allocated_size -= buffer->allocation_size;
   IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
                             pool->free_allocated_size);
   return buffer;
 }
 
-// Scans the |pool| free list for a buffer matching the given requirements and
-// returns ownership.
+// Returns the first non-empty size class in the range
+// [|min_class|, |max_class|] or IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT if
+// all are empty.
+//
+// Must be called with the pool mutex held.
+static uint32_t iree_hal_caching_allocator_pool_find_class(
+    iree_hal_caching_allocator_pool_t* pool, uint32_t min_class,
+    uint32_t max_class) {
+  uint32_t word = min_class / 64;
+  uint64_t bits = pool->class_mask[word] & (~0ull << (min_class % 64));
+  while (!bits) {
+    if (++word >= IREE_ARRAYSIZE(pool->class_mask)) {
+      return IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT;
+    }
+    if (word * 64 > max_class) {
+      return IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT;
+    }
+    bits = pool->class_mask[word];
+  }
+  const uint32_t size_class =
+      word * 64 + (uint32_t)iree_math_count_trailing_zeros_u64(bits);
+  return size_class <= max_class ? size_class
+                                 : IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT;
+}
+
+// Finds a buffer in the |pool| free lists matching the given requirements and
+// returns ownership. Buffers from |size_class| are preferred, followed by the
+// nearest larger classes.
 //
 // Must be called with the pool mutex held.
 static iree_hal_buffer_t* iree_hal_caching_allocator_pool_find_and_take_buffer(
     iree_hal_caching_allocator_pool_t* pool,
-    const iree_hal_buffer_params_t* params,
-    iree_device_size_t allocation_size) {
-  // Walk backwards so that we check the most recently released buffers first.
-  for (int i = (int)pool->free_count - 1; i >= 0; --i) {
+    const iree_hal_buffer_params_t* params, uint32_t size_class) {
+  const uint32_t max_class =
+      iree_min(size_class + IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MAX_OVERFIT,
+               IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT - 1);
+  for (uint32_t candidate_class =
+           iree_hal_caching_allocator_pool_find_class(pool, size_class,
+                                                      max_class);
+       candidate_class <= max_class;
+       candidate_class = iree_hal_caching_allocator_pool_find_class(
+           pool, candidate_class + 1, max_class)) {
+    // Walk the class list from the most recently released buffer.
+    // Pools are per-heap and programs tend to use consistent memory types and
+    // usage so the first buffer almost always matches.
+    //
     // NOTE: we are not currently checking alignment as we don't really have it.
     // We assume programs will use consistent alignments for a particular heap
     // (as the heap has a min alignment).
-    iree_hal_buffer_t* buffer = pool->free_buffers[i];
-    if (iree_all_bits_set(iree_hal_buffer_memory_type(buffer), params->type) &&
-        iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
-                          params->usage) &&
-        iree_hal_buffer_allocation_size(buffer) == allocation_size) {
-      return iree_hal_caching_allocator_pool_take_buffer_at(pool, i);
+    for (uint32_t index = pool->class_heads[candidate_class];
+         index != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+         index = pool->entries[index].class_next) {
+      iree_hal_buffer_t* buffer = pool->entries[index].buffer;
+      if (iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                            params->type) &&
+          iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                            params->usage)) {
+        return iree_hal_caching_allocator_pool_take_buffer_at(pool, index);
+      }
     }
   }
   return NULL;  // nothing found
@@ -200,8 +426,7 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
   while (pool->free_count > 0 && pool->total_allocated_size > target_size) {
     // Take the oldest buffer in the list.
     iree_hal_buffer_t* dead_buffer =
-        iree_hal_caching_allocator_pool_take_buffer_at(pool,
-                                                       pool->free_count - 1);
+        iree_hal_caching_allocator_pool_take_buffer_at(pool, pool->lru_tail);
 
     // NOTE: we've removed the buffer but have not subtracted the size from
     // the total yet - we want to do that only after releasing the buffer.
@@ -233,8 +458,10 @@ static void iree_hal_caching_allocator_pool_trim(
   iree_hal_caching_allocator_pool_trim_to_size(pool, 0);
 }
 
-// Acquires a buffer of |allocation_size| from the |pool|.
-// The buffer will have a memory type and usage compatible with the given types.
+// Acquires a buffer of at least |allocation_size| from the |pool|.
+// The buffer will have a memory type and usage compatible with the given types
+// and a byte length of exactly |allocation_size| though the underlying
+// allocation may be larger.
 // Fails if the pool is empty and the underlying device fails the allocation.
 //
 // Thread-safe; multiple threads may concurrently access the |pool|.
@@ -245,54 +472,65 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
 
-  // Scan the free list to find an appropriate block.
+  // Round up to the size class so that the buffer can be reused by any other
+  // request in the same class.
+  const uint32_t size_class =
+      iree_hal_caching_allocator_size_class_ceil(allocation_size);
+  const iree_device_size_t class_size =
+      iree_hal_caching_allocator_size_class_size(size_class);
+
+  // Check the free lists for an appropriate block.
   // If found we pop it off the list and return it without needing to allocate.
   iree_slim_mutex_lock(&pool->mutex);
-  iree_hal_buffer_t* existing_buffer =
+  iree_hal_buffer_t* buffer =
       iree_hal_caching_allocator_pool_find_and_take_buffer(pool, params,
-                                                           allocation_size);
-  if (!existing_buffer) {
+                                                           size_class);
+  if (!buffer) {
     // We'll need to allocate so we add the size such that it'll be accounted
     // for by other threads allocating at the same time.
-    pool->total_allocated_size += allocation_size;
+    pool->total_allocated_size += class_size;
   }
   iree_slim_mutex_unlock(&pool->mutex);
-  if (existing_buffer) {
-    // Found a buffer - return it.
-    *out_buffer = existing_buffer;
-    IREE_TRACE_ZONE_END(z0);
-    return iree_ok_status();
-  }
-
-  // Trim first before allocating so that we don't go over peak.
-  iree_hal_caching_allocator_pool_trim_to_size(
-      pool, pool->params.max_allocation_capacity);
-
-  // No existing buffer was found that could be used and we'll need to allocate
-  // one. Note that we do this without holding the lock as the underlying
-  // device allocator can be very slow. It's possible for buffers to be released
-  // to the pool by another thread while we're allocating here but that's OK.
-  iree_hal_buffer_t* buffer = NULL;
-  iree_status_t status = iree_hal_allocator_allocate_buffer(
-      pool->device_allocator, *params, allocation_size, initial_data, &buffer);
-
-  // If initial data was provided then write it into the buffer.
-  // We can only do this if the buffer supports mapping and expect unmappable
-  // buffers to have been filtered out earlier up.
-  if (iree_status_is_ok(status) &&
-      !iree_const_byte_span_is_empty(initial_data)) {
+
+  iree_status_t status = iree_ok_status();
+  if (!buffer) {
+    // Trim first before allocating so that we don't go over peak.
+    iree_hal_caching_allocator_pool_trim_to_size(
+        pool, pool->params.max_allocation_capacity);
+
+    // No existing buffer was found that could be used and we'll need to
+    // allocate one. Note that we do this without holding the lock as the
+    // underlying device allocator can be very slow. It's possible for buffers
+    // to be released to the pool by another thread while we're allocating here
+    // but that's OK.
+    status = iree_hal_allocator_allocate_buffer(pool->device_allocator, *params,
+                                                class_size, initial_data,
+                                                &buffer);
+
+    // Account for any additional rounding the underlying allocator performed.
+    iree_slim_mutex_lock(&pool->mutex);
+    pool->total_allocated_size -= class_size;
+    if (iree_status_is_ok(status)) {
+      pool->total_allocated_size += iree_hal_buffer_allocation_size(buffer);
+    }
+    iree_slim_mutex_unlock(&pool->mutex);
+  } else if (!iree_const_byte_span_is_empty(initial_data)) {
+    // Reused buffers need the initial data written into them.
     status = iree_hal_buffer_map_write(buffer, 0, initial_data.data,
                                        initial_data.data_length);
   }
 
-  // If the allocation failed then remove the size from the total.
   if (iree_status_is_ok(status)) {
+    // Expose only the requested length; the remainder of the size class is
+    // retained for when the buffer is reused by a larger request.
+    buffer->byte_length = allocation_size;
     *out_buffer = buffer;
-  } else {
-    if (buffer) iree_hal_buffer_release(buffer);
+  } else if (buffer) {
+    // Drop the buffer and remove its size from the total.
     iree_slim_mutex_lock(&pool->mutex);
-    pool->total_allocated_size -= allocation_size;
+    pool->total_allocated_size -= iree_hal_buffer_allocation_size(buffer);
     iree_slim_mutex_unlock(&pool->mutex);
+    iree_hal_allocator_deallocate_buffer(pool->device_allocator, buffer);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -308,12 +546,15 @@ static void iree_hal_caching_allocator_pool_release(
   IREE_TRACE_ZONE_APPEND_VALUE(
       z0, (int64_t)iree_hal_buffer_allocation_size(buffer));
 
+  // Restore the full length of the allocation; it'll be trimmed again on reuse.
+  const iree_device_size_t allocation_size =
+      iree_hal_buffer_allocation_size(buffer);
+  buffer->byte_length = allocation_size;
+
   // Try to add the buffer to the pool. If the pool is at capacity we'll just
   // release it back to the allocator.
   iree_slim_mutex_lock(&pool->mutex);
 
-  const iree_device_size_t allocation_size =
-      iree_hal_buffer_allocation_size(buffer);
   const bool under_capacity = pool->total_allocated_size - allocation_size <=
                               pool->params.max_allocation_capacity;
   const bool under_count =
@@ -414,9 +655,18 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
       iree_sizeof_struct(*allocator) + pool_list_size, iree_max_align_t);
   iree_host_size_t pool_offset = total_size;
   for (iree_host_size_t i = 0; i < pool_count; ++i) {
+    if (pool_params[i].max_free_allocation_count >=
+        IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "pool %" PRIhsz " free allocation count %" PRIhsz
+          " exceeds the maximum supported",
+          i, pool_params[i].max_free_allocation_count);
+    }
     iree_hal_caching_allocator_pool_t* pool = NULL;
     total_size += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
+        sizeof(*pool) + sizeof(pool->entries[0]) *
                             pool_params[i].max_free_allocation_count,
         iree_max_align_t);
   }
@@ -438,7 +688,7 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
     iree_hal_caching_allocator_pool_t* pool =
         (iree_hal_caching_allocator_pool_t*)pool_ptr;
     pool_ptr += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
+        sizeof(*pool) + sizeof(pool->entries[0]) *
                             pool_params[i].max_free_allocation_count,
         iree_max_align_t);
     allocator->pools[i] = pool;
@@ -494,6 +744,21 @@ static void iree_hal_caching_allocator_query_statistics(
       iree_hal_caching_allocator_cast(base_allocator);
   iree_hal_allocator_query_statistics(allocator->device_allocator,
                                       out_statistics);
+  IREE_STATISTICS({
+    // Free buffers in our pools are still live in the underlying allocator.
+    for (iree_host_size_t i = 0; i < allocator->pool_count; ++i) {
+      iree_hal_caching_allocator_pool_t* pool = allocator->pools[i];
+      iree_slim_mutex_lock(&pool->mutex);
+      iree_device_size_t free_allocated_size = pool->free_allocated_size;
+      iree_slim_mutex_unlock(&pool->mutex);
+      if (iree_all_bits_set(pool->params.heap.type,
+                            IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
+        out_statistics->host_bytes_pooled += free_allocated_size;
+      } else {
+        out_statistics->device_bytes_pooled += free_allocated_size;
+      }
+    }
+  });
 }
 
 static iree_status_t iree_hal_caching_allocator_query_memory_heaps(
@@ -593,6 +858,15 @@ static iree_status_t iree_hal_caching_allocator_allocate_buffer(
   iree_hal_caching_allocator_pool_t* pool =
       iree_hal_caching_allocator_find_pool(allocator, compat_params.type,
                                            compat_params.usage);
+
+  // Allocations larger than the pool allows (after rounding up to their size
+  // class) are not cached.
+  if (pool && iree_hal_caching_allocator_size_class_size(
+                  iree_hal_caching_allocator_size_class_ceil(
+                      allocation_size)) > pool->params.max_allocation_size) {
+    pool = NULL;
+  }
+
   if (!pool) {
     // Fallback to the underlying allocator.
     return iree_hal_allocator_allocate_buffer(allocator->device_allocator,
@@ -23,6 +23,14 @@ extern "C" {
 // device-local and host-visible buffers on devices with discrete memory.
 // Pools are scanned in-order to allow for prioritization.
 //
+// Within a pool allocations are rounded up to one of four size classes per
+// power of two (wasting at most 25%) and free buffers are bucketed by class.
+// Requests are served in constant time from their own class or the nearest
+// larger non-empty class (within 2x of the request) so that dynamically shaped
+// programs producing many slightly different sizes still hit the cache.
+// Buffers returned have the exact requested byte length even when the
+// underlying allocation is larger.
+//
 // Thread-safe: the allocator can be shared across multiple user-level devices
 // manipulated from multiple threads.
 typedef struct iree_hal_caching_allocator_t iree_hal_caching_allocator_t;
@@ -47,8 +55,8 @@ typedef struct iree_hal_caching_allocator_pool_params_t {
   iree_device_size_t max_allocation_capacity;
 
   // Maximum number of free allocations that will be tracked.
-  // This is used to allocate storage for the free list and should be reasonably
-  // bounded (~64-1024).
+  // This is used to allocate storage for the free lists. Lookups do not scale
+  // with the count but each free allocation retains device memory.
   iree_host_size_t max_free_allocation_count;
 } iree_hal_caching_allocator_pool_params_t;
 
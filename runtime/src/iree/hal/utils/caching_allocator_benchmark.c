@@ -0,0 +1,169 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/prng.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/caching_allocator.h"
+#include "iree/testing/benchmark.h"
+
+// Creates a caching allocator with a single pool wrapping a heap allocator.
+// The pool tracks up to |max_free_allocation_count| free buffers.
+static void iree_hal_caching_allocator_benchmark_create(
+    iree_host_size_t max_free_allocation_count, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_heap_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_CHECK_OK(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("heap"), host_allocator, host_allocator,
+      out_heap_allocator));
+  iree_hal_allocator_memory_heap_t heaps[8];
+  iree_host_size_t heap_count = 0;
+  IREE_CHECK_OK(iree_hal_allocator_query_memory_heaps(
+      *out_heap_allocator, IREE_ARRAYSIZE(heaps), heaps, &heap_count));
+  iree_hal_caching_allocator_pool_params_t pool_params;
+  iree_hal_caching_allocator_pool_params_initialize(heaps[0], &pool_params);
+  pool_params.max_free_allocation_count = max_free_allocation_count;
+  IREE_CHECK_OK(iree_hal_caching_allocator_create_with_pools(
+      1, &pool_params, *out_heap_allocator, host_allocator, out_allocator));
+}
+
+static iree_hal_buffer_params_t iree_hal_caching_allocator_benchmark_params(
+    void) {
+  iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+  };
+  return params;
+}
+
+// Tests the steady-state cost of allocating and releasing a buffer of the same
+// size. After the first iteration every allocation is a cache hit.
+static iree_status_t iree_hal_caching_allocator_benchmark_reuse(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_hal_allocator_t* heap_allocator = NULL;
+  iree_hal_allocator_t* allocator = NULL;
+  iree_hal_caching_allocator_benchmark_create(64, host_allocator,
+                                              &heap_allocator, &allocator);
+  const iree_hal_buffer_params_t params =
+      iree_hal_caching_allocator_benchmark_params();
+
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator, params, 4096, iree_const_byte_span_empty(), &buffer));
+    iree_hal_buffer_release(buffer);
+  }
+
+  iree_hal_allocator_release(allocator);
+  iree_hal_allocator_release(heap_allocator);
+  return iree_ok_status();
+}
+
+// Tests a dynamic-shape-like workload where a working set of buffers with
+// randomized sizes is continuously released and reallocated. The pool keeps
+// up to as many free buffers as there are live buffers.
+//
+// user_data is the number of buffers in the working set.
+static iree_status_t iree_hal_caching_allocator_benchmark_randomized_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_hal_allocator_t* heap_allocator = NULL;
+  iree_hal_allocator_t* allocator = NULL;
+  iree_hal_caching_allocator_benchmark_create(count, host_allocator,
+                                              &heap_allocator, &allocator);
+  const iree_hal_buffer_params_t params =
+      iree_hal_caching_allocator_benchmark_params();
+
+  // The PRNG we use to select the buffers and sizes.
+  iree_prng_xoroshiro128_state_t prng = {0};
+  iree_prng_xoroshiro128_initialize(123ull, &prng);
+
+  // Populate the working set; sizes range from 1KB to 65KB.
+  iree_hal_buffer_t** buffers = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(
+      host_allocator, sizeof(iree_hal_buffer_t*) * count, (void**)&buffers));
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_device_size_t size =
+        1024 + iree_prng_xoroshiro128plus_next_uint32(&prng) % (64 * 1024);
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator, params, size, iree_const_byte_span_empty(), &buffers[i]));
+  }
+
+  // Release and reallocate random buffers. To hide some of the overhead we do
+  // multiple reallocations in each loop.
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/256)) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t buffer_idx =
+          iree_prng_xoroshiro128plus_next_uint32(&prng) % count;
+      iree_hal_buffer_release(buffers[buffer_idx]);
+      iree_device_size_t size =
+          1024 + iree_prng_xoroshiro128plus_next_uint32(&prng) % (64 * 1024);
+      IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+          allocator, params, size, iree_const_byte_span_empty(),
+          &buffers[buffer_idx]));
+    }
+  }
+
+  // Cleanup.
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_hal_buffer_release(buffers[i]);
+  }
+  iree_allocator_free(host_allocator, buffers);
+  iree_hal_allocator_release(allocator);
+  iree_hal_allocator_release(heap_allocator);
+
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_hal_caching_allocator_benchmark_reuse
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_caching_allocator_benchmark_reuse,
+    };
+    iree_benchmark_register(iree_make_cstring_view("reuse"), &benchmark_def);
+  }
+
+  // iree_hal_caching_allocator_benchmark_randomized_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_caching_allocator_benchmark_randomized_n,
+    };
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("randomized_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("randomized_256"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)4096u;
+    iree_benchmark_register(iree_make_cstring_view("randomized_4096"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
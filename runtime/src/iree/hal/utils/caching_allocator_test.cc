@@ -0,0 +1,217 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class CachingAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &heap_allocator_));
+    iree_host_size_t heap_count = 0;
+    IREE_ASSERT_OK(iree_hal_allocator_query_memory_heaps(
+        heap_allocator_, 1, &heap_, &heap_count));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(heap_allocator_);
+  }
+
+  iree_hal_caching_allocator_pool_params_t DefaultPoolParams() {
+    iree_hal_caching_allocator_pool_params_t params;
+    iree_hal_caching_allocator_pool_params_initialize(heap_, &params);
+    return params;
+  }
+
+  void Create(const iree_hal_caching_allocator_pool_params_t& params) {
+    IREE_ASSERT_OK(iree_hal_caching_allocator_create_with_pools(
+        1, &params, heap_allocator_, iree_allocator_system(), &allocator_));
+  }
+
+  iree_status_t Allocate(iree_device_size_t size,
+                         iree_hal_buffer_t** out_buffer) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = heap_.type;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    return iree_hal_allocator_allocate_buffer(
+        allocator_, params, size, iree_const_byte_span_empty(), out_buffer);
+  }
+
+  iree_device_size_t QueryPooledBytes() {
+    iree_hal_allocator_statistics_t statistics;
+    iree_hal_allocator_query_statistics(allocator_, &statistics);
+    return statistics.host_bytes_pooled + statistics.device_bytes_pooled;
+  }
+
+  iree_hal_allocator_t* heap_allocator_ = nullptr;
+  iree_hal_allocator_memory_heap_t heap_;
+  iree_hal_allocator_t* allocator_ = nullptr;
+};
+
+// Allocations are rounded up to their size class while the buffer exposes
+// exactly the requested length.
+TEST_F(CachingAllocatorTest, SizeClassRounding) {
+  Create(DefaultPoolParams());
+
+  struct {
+    iree_device_size_t request;
+    iree_device_size_t class_size;
+  } cases[] = {
+      {1, 256},   {256, 256}, {257, 320},   {320, 320},
+      {321, 384}, {513, 640}, {1025, 1280}, {4097, 5120},
+  };
+  for (const auto& c : cases) {
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_ASSERT_OK(Allocate(c.request, &buffer));
+    EXPECT_EQ(iree_hal_buffer_byte_length(buffer), c.request);
+    EXPECT_EQ(iree_hal_buffer_allocation_size(buffer), c.class_size);
+    iree_hal_buffer_release(buffer);
+  }
+}
+
+// A released buffer is reused by any request in its size class and is trimmed
+// to the length of the new request.
+TEST_F(CachingAllocatorTest, ReuseSameClass) {
+  Create(DefaultPoolParams());
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(300, &a));
+  iree_hal_buffer_t* a_ptr = a;
+  iree_hal_buffer_release(a);
+
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(257, &b));
+  EXPECT_EQ(b, a_ptr);
+  EXPECT_EQ(iree_hal_buffer_byte_length(b), 257);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(b), 320);
+  iree_hal_buffer_release(b);
+}
+
+// Requests with an empty size class are served from the nearest larger
+// non-empty class but not from classes more than 2x larger.
+TEST_F(CachingAllocatorTest, ReuseNextLargerClass) {
+  Create(DefaultPoolParams());
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(384, &a));
+  iree_hal_buffer_t* a_ptr = a;
+  iree_hal_buffer_release(a);
+
+  // 300 bytes maps to the empty 320 class and is served by the 384 buffer.
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(300, &b));
+  EXPECT_EQ(b, a_ptr);
+  EXPECT_EQ(iree_hal_buffer_byte_length(b), 300);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(b), 384);
+  iree_hal_buffer_release(b);
+
+  // The 1280 class is more than 4 classes above the 512 class so a 512 byte
+  // request can't reuse it.
+  iree_hal_buffer_t* c = nullptr;
+  IREE_ASSERT_OK(Allocate(1280, &c));
+  iree_hal_buffer_t* c_ptr = c;
+  iree_hal_buffer_release(c);
+  iree_hal_buffer_t* d = nullptr;
+  IREE_ASSERT_OK(Allocate(512, &d));
+  EXPECT_NE(d, c_ptr);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(d), 512);
+  iree_hal_buffer_release(d);
+}
+
+// Buffers released back to the pool regain their full allocation length so
+// that a later larger request in the same class can use all of it.
+TEST_F(CachingAllocatorTest, ReleaseRestoresLength) {
+  Create(DefaultPoolParams());
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(257, &a));
+  EXPECT_EQ(iree_hal_buffer_byte_length(a), 257);
+  iree_hal_buffer_t* a_ptr = a;
+  iree_hal_buffer_release(a);
+
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(320, &b));
+  EXPECT_EQ(b, a_ptr);
+  EXPECT_EQ(iree_hal_buffer_byte_length(b), 320);
+  uint8_t data[320];
+  memset(data, 0xCD, sizeof(data));
+  IREE_EXPECT_OK(iree_hal_buffer_map_write(b, 0, data, sizeof(data)));
+  iree_hal_buffer_release(b);
+}
+
+// When the pool capacity is exceeded the least recently released buffers are
+// trimmed first.
+TEST_F(CachingAllocatorTest, TrimOldestFirst) {
+  iree_hal_caching_allocator_pool_params_t params = DefaultPoolParams();
+  params.max_allocation_capacity = 5 * 1024;
+  Create(params);
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(1024, &a));
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(1024, &b));
+  iree_hal_buffer_t* b_ptr = b;
+  iree_hal_buffer_release(a);
+  iree_hal_buffer_release(b);
+#if IREE_STATISTICS_ENABLE
+  EXPECT_EQ(QueryPooledBytes(), 2 * 1024);
+#endif  // IREE_STATISTICS_ENABLE
+
+  // A 4096 byte allocation can't reuse either buffer and would take the pool
+  // to 6KB, so only the older buffer (a) is trimmed.
+  iree_hal_buffer_t* c = nullptr;
+  IREE_ASSERT_OK(Allocate(4096, &c));
+#if IREE_STATISTICS_ENABLE
+  EXPECT_EQ(QueryPooledBytes(), 1024);
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_hal_buffer_t* d = nullptr;
+  IREE_ASSERT_OK(Allocate(1024, &d));
+  EXPECT_EQ(d, b_ptr);
+  iree_hal_buffer_release(d);
+  iree_hal_buffer_release(c);
+}
+
+// Requests whose size class is larger than max_allocation_size bypass the pool
+// and are neither rounded up nor retained on release.
+TEST_F(CachingAllocatorTest, MaxAllocationSizeBypassesPool) {
+  iree_hal_caching_allocator_pool_params_t params = DefaultPoolParams();
+  params.max_allocation_size = 1024;
+  Create(params);
+
+  iree_hal_buffer_t* a = nullptr;
+  IREE_ASSERT_OK(Allocate(1000, &a));
+  EXPECT_EQ(iree_hal_buffer_allocation_size(a), 1024);
+  iree_hal_buffer_release(a);
+#if IREE_STATISTICS_ENABLE
+  EXPECT_EQ(QueryPooledBytes(), 1024);
+#endif  // IREE_STATISTICS_ENABLE
+
+  // 1025 bytes rounds up to the 1280 class which exceeds the limit.
+  iree_hal_buffer_t* b = nullptr;
+  IREE_ASSERT_OK(Allocate(1025, &b));
+  EXPECT_EQ(iree_hal_buffer_byte_length(b), 1025);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(b), 1025);
+  iree_hal_buffer_release(b);
+#if IREE_STATISTICS_ENABLE
+  EXPECT_EQ(QueryPooledBytes(), 1024);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -19,6 +19,7 @@ IREE_API_EXPORT void iree_hal_collective_batch_initialize(
     iree_hal_collective_batch_t* out_batch) {
   out_batch->arena = arena;
   out_batch->resource_set = resource_set;
+  out_batch->fusion_bucket_size = IREE_HAL_COLLECTIVE_BATCH_FUSION_BUCKET_SIZE;
   out_batch->capacity = 0;
   out_batch->count = 0;
   out_batch->entries = NULL;
@@ -45,6 +46,11 @@ IREE_API_EXPORT void iree_hal_collective_batch_reset(
   batch->count = 0;
 }
 
+IREE_API_EXPORT void iree_hal_collective_batch_set_fusion_bucket_size(
+    iree_hal_collective_batch_t* batch, iree_device_size_t bucket_size) {
+  batch->fusion_bucket_size = bucket_size;
+}
+
 // Grows the storage of the |batch| by 2x by slicing off new memory from the
 // arena and copying over the existing contents.
 static iree_status_t iree_hal_collective_batch_grow(
@@ -75,11 +81,98 @@ static iree_status_t iree_hal_collective_batch_grow(
   return iree_ok_status();
 }
 
+// Returns the size in bytes of a single element of |element_type|.
+static iree_device_size_t iree_hal_collective_element_byte_size(
+    iree_hal_collective_element_type_t element_type) {
+  switch (element_type) {
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_8:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_8:
+      return 1;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_16:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_16:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_16:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_BFLOAT_16:
+      return 2;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_32:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_32:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32:
+      return 4;
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_64:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_64:
+    case IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Returns true if |binding| begins immediately after the |byte_length| bytes
+// referenced by |prior_binding| in the same buffer.
+static bool iree_hal_collective_binding_follows(
+    const iree_hal_buffer_binding_t* prior_binding,
+    iree_device_size_t byte_length, const iree_hal_buffer_binding_t* binding) {
+  return binding->buffer && binding->buffer == prior_binding->buffer &&
+         binding->offset == prior_binding->offset + byte_length;
+}
+
+// Extends |binding| by |byte_length| bytes if it has an explicit length.
+static void iree_hal_collective_binding_extend(
+    iree_hal_buffer_binding_t* binding, iree_device_size_t byte_length) {
+  if (binding->length != IREE_WHOLE_BUFFER) binding->length += byte_length;
+}
+
+// Attempts to fuse an allreduce of |element_count| elements into a prior
+// compatible entry in |batch|. Returns true if the operation was fused and no
+// new entry is required.
+static bool iree_hal_collective_batch_try_fuse(
+    iree_hal_collective_batch_t* batch, iree_hal_channel_t* channel,
+    iree_hal_collective_op_t op, iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  if (batch->fusion_bucket_size == 0 ||
+      op.kind != IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE) {
+    return false;
+  }
+  const iree_device_size_t element_size =
+      iree_hal_collective_element_byte_size(op.element_type);
+  if (element_size == 0) return false;
+  const iree_device_size_t byte_length = element_count * element_size;
+
+  // Scan from the most recent entry as allreduces over contiguous ranges are
+  // usually recorded back to back.
+  for (iree_host_size_t i = batch->count; i > 0; --i) {
+    iree_hal_collective_batch_entry_t* entry = &batch->entries[i - 1];
+    if (entry->channel != channel || entry->op.packed != op.packed) continue;
+    const iree_device_size_t entry_byte_length =
+        entry->element_count * element_size;
+    if (entry_byte_length + byte_length > batch->fusion_bucket_size) continue;
+    if (!iree_hal_collective_binding_follows(&entry->send_binding,
+                                             entry_byte_length,
+                                             &send_binding) ||
+        !iree_hal_collective_binding_follows(&entry->recv_binding,
+                                             entry_byte_length,
+                                             &recv_binding)) {
+      continue;
+    }
+    iree_hal_collective_binding_extend(&entry->send_binding, byte_length);
+    iree_hal_collective_binding_extend(&entry->recv_binding, byte_length);
+    entry->element_count += element_count;
+    return true;
+  }
+  return false;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_collective_batch_append(
     iree_hal_collective_batch_t* batch, iree_hal_channel_t* channel,
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  // Fuse into a prior entry if possible. The channel and buffers are shared
+  // with that entry and have already been retained.
+  if (iree_hal_collective_batch_try_fuse(batch, channel, op, send_binding,
+                                         recv_binding, element_count)) {
+    return iree_ok_status();
+  }
+
   // Grow the entry storage if required.
   if (batch->count + 1 > batch->capacity) {
     IREE_RETURN_IF_ERROR(iree_hal_collective_batch_grow(batch));
@@ -52,6 +52,11 @@ typedef struct {
   // Resource set that submitted channels and buffers will be retained in.
   iree_hal_resource_set_t* resource_set;
 
+  // Maximum size in bytes of an allreduce fused from multiple appended
+  // allreduces. Defaults to IREE_HAL_COLLECTIVE_BATCH_FUSION_BUCKET_SIZE and
+  // may be changed with iree_hal_collective_batch_set_fusion_bucket_size.
+  iree_device_size_t fusion_bucket_size;
+
   // Growable list of accumulated operations (starts empty).
   // We could use a linked list into arena storage but we don't need to persist
   // the contents beyond a single flush. Instead we slice out some storage as
@@ -83,8 +88,20 @@ IREE_API_EXPORT bool iree_hal_collective_batch_is_empty(
 IREE_API_EXPORT void iree_hal_collective_batch_reset(
     iree_hal_collective_batch_t* batch);
 
+// Sets the maximum size in bytes of allreduces fused within the batch.
+// A |bucket_size| of 0 disables fusion and each appended operation is submitted
+// as its own channel call.
+IREE_API_EXPORT void iree_hal_collective_batch_set_fusion_bucket_size(
+    iree_hal_collective_batch_t* batch, iree_device_size_t bucket_size);
+
 // Appends a collective operation to the batch.
 // Referenced resources will be retained.
+//
+// Allreduces are fused into a prior allreduce in the batch when both use the
+// same channel and operation and the new send and recv ranges immediately
+// follow those of the prior entry in the same buffers. Operations within a
+// batch are issued as a group and must not depend on each other so fusion
+// preserves their results while reducing the number of channel calls.
 IREE_API_EXPORT iree_status_t iree_hal_collective_batch_append(
     iree_hal_collective_batch_t* batch, iree_hal_channel_t* channel,
     iree_hal_collective_op_t op, uint32_t param,
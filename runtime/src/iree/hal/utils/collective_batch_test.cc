@@ -0,0 +1,177 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/collective_batch.h"
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/resource_set.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// A resource that stands in for channels and buffers. The batch only retains
+// them and compares their pointers.
+typedef struct iree_hal_test_resource_t {
+  iree_hal_resource_t resource;
+} iree_hal_test_resource_t;
+
+typedef struct iree_hal_test_resource_vtable_t {
+  void(IREE_API_PTR* destroy)(iree_hal_test_resource_t* resource);
+} iree_hal_test_resource_vtable_t;
+IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_test_resource_vtable_t);
+
+static void iree_hal_test_resource_destroy(iree_hal_test_resource_t* resource) {
+  delete resource;
+}
+
+static const iree_hal_test_resource_vtable_t iree_hal_test_resource_vtable = {
+    /*.destroy=*/iree_hal_test_resource_destroy,
+};
+
+class CollectiveBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_arena_block_pool_initialize(4096, iree_allocator_system(),
+                                     &block_pool_);
+    iree_arena_initialize(&block_pool_, &arena_);
+    IREE_ASSERT_OK(
+        iree_hal_resource_set_allocate(&block_pool_, &resource_set_));
+    iree_hal_collective_batch_initialize(&arena_, resource_set_, &batch_);
+    channel_a_ = (iree_hal_channel_t*)CreateResource();
+    channel_b_ = (iree_hal_channel_t*)CreateResource();
+    send_buffer_ = (iree_hal_buffer_t*)CreateResource();
+    recv_buffer_ = (iree_hal_buffer_t*)CreateResource();
+  }
+
+  void TearDown() override {
+    iree_hal_collective_batch_deinitialize(&batch_);
+    iree_hal_resource_set_free(resource_set_);
+    iree_arena_deinitialize(&arena_);
+    iree_hal_resource_release(channel_a_);
+    iree_hal_resource_release(channel_b_);
+    iree_hal_resource_release(send_buffer_);
+    iree_hal_resource_release(recv_buffer_);
+    iree_arena_block_pool_deinitialize(&block_pool_);
+  }
+
+  static iree_hal_resource_t* CreateResource() {
+    iree_hal_test_resource_t* resource = new iree_hal_test_resource_t();
+    iree_hal_resource_initialize(&iree_hal_test_resource_vtable,
+                                 &resource->resource);
+    return &resource->resource;
+  }
+
+  static iree_hal_collective_op_t Op(
+      iree_hal_collective_kind_t kind,
+      iree_hal_collective_element_type_t element_type =
+          IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32) {
+    iree_hal_collective_op_t op;
+    op.packed = 0;
+    op.kind = kind;
+    op.reduction = IREE_HAL_COLLECTIVE_REDUCTION_SUM;
+    op.element_type = element_type;
+    return op;
+  }
+
+  // Appends an op over f32 elements at the given byte offsets.
+  void Append(iree_hal_channel_t* channel, iree_hal_collective_op_t op,
+              iree_device_size_t send_offset, iree_device_size_t recv_offset,
+              iree_device_size_t element_count) {
+    iree_hal_buffer_binding_t send_binding = {send_buffer_, send_offset,
+                                              element_count * 4};
+    iree_hal_buffer_binding_t recv_binding = {recv_buffer_, recv_offset,
+                                              element_count * 4};
+    IREE_ASSERT_OK(iree_hal_collective_batch_append(
+        &batch_, channel, op, /*param=*/0, send_binding, recv_binding,
+        element_count));
+  }
+
+  iree_arena_block_pool_t block_pool_;
+  iree_arena_allocator_t arena_;
+  iree_hal_resource_set_t* resource_set_ = NULL;
+  iree_hal_collective_batch_t batch_;
+  iree_hal_channel_t* channel_a_ = NULL;
+  iree_hal_channel_t* channel_b_ = NULL;
+  iree_hal_buffer_t* send_buffer_ = NULL;
+  iree_hal_buffer_t* recv_buffer_ = NULL;
+};
+
+// Tests that contiguous allreduces on the same channel fuse into one entry.
+TEST_F(CollectiveBatchTest, FuseContiguousAllReduces) {
+  auto op = Op(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE);
+  Append(channel_a_, op, 0, 1024, 16);
+  Append(channel_a_, op, 64, 1088, 8);
+  Append(channel_a_, op, 96, 1120, 8);
+  ASSERT_EQ(batch_.count, 1);
+  EXPECT_EQ(batch_.entries[0].element_count, 32);
+  EXPECT_EQ(batch_.entries[0].send_binding.offset, 0);
+  EXPECT_EQ(batch_.entries[0].send_binding.length, 128);
+  EXPECT_EQ(batch_.entries[0].recv_binding.offset, 1024);
+  EXPECT_EQ(batch_.entries[0].recv_binding.length, 128);
+}
+
+// Tests that allreduces on other channels are fused into their own entries.
+TEST_F(CollectiveBatchTest, FusePerChannel) {
+  auto op = Op(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE);
+  Append(channel_a_, op, 0, 1024, 16);
+  Append(channel_b_, op, 512, 2048, 16);
+  Append(channel_a_, op, 64, 1088, 16);
+  Append(channel_b_, op, 576, 2112, 16);
+  ASSERT_EQ(batch_.count, 2);
+  EXPECT_EQ(batch_.entries[0].channel, channel_a_);
+  EXPECT_EQ(batch_.entries[0].element_count, 32);
+  EXPECT_EQ(batch_.entries[1].channel, channel_b_);
+  EXPECT_EQ(batch_.entries[1].element_count, 32);
+}
+
+// Tests that incompatible or discontiguous operations are not fused.
+TEST_F(CollectiveBatchTest, NoFuseIncompatible) {
+  auto op = Op(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE);
+  Append(channel_a_, op, 0, 1024, 16);
+  // Gap in the send range.
+  Append(channel_a_, op, 128, 1088, 16);
+  // Different element type.
+  Append(channel_a_,
+         Op(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+            IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_32),
+         192, 1152, 16);
+  // Not an allreduce.
+  auto gather_op = Op(IREE_HAL_COLLECTIVE_KIND_ALL_GATHER);
+  Append(channel_a_, gather_op, 256, 4096, 16);
+  Append(channel_a_, gather_op, 320, 4160, 16);
+  EXPECT_EQ(batch_.count, 5);
+}
+
+// Tests that fused allreduces do not grow beyond the bucket size.
+TEST_F(CollectiveBatchTest, FusionBucketSize) {
+  iree_hal_collective_batch_set_fusion_bucket_size(&batch_, 128);
+  auto op = Op(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE);
+  for (int i = 0; i < 4; ++i) {
+    Append(channel_a_, op, i * 64, 1024 + i * 64, 16);
+  }
+  ASSERT_EQ(batch_.count, 2);
+  EXPECT_EQ(batch_.entries[0].element_count, 32);
+  EXPECT_EQ(batch_.entries[1].element_count, 32);
+  EXPECT_EQ(batch_.entries[1].send_binding.offset, 128);
+}
+
+// Tests that a bucket size of 0 disables fusion.
+TEST_F(CollectiveBatchTest, FusionDisabled) {
+  iree_hal_collective_batch_set_fusion_bucket_size(&batch_, 0);
+  auto op = Op(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE);
+  Append(channel_a_, op, 0, 1024, 16);
+  Append(channel_a_, op, 64, 1088, 16);
+  EXPECT_EQ(batch_.count, 2);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
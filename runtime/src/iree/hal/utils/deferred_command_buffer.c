@@ -41,6 +41,9 @@ typedef enum iree_hal_command_type_e {
 // prevents using this as a way to debug or benchmark command buffers. The
 // intent is that each command captures the exact information passed during the
 // call such that the target command buffer cannot tell they were deferred.
+// The only exception is the target-independent optimization pass run when
+// recording ends (see iree_hal_cmd_list_optimize) which can be disabled with
+// IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE=0.
 //
 // As each command is variable sized we store pointers to the following command
 // to allow us to walk the list during replay. Storing just a size would be
@@ -237,9 +240,19 @@ static iree_status_t iree_hal_deferred_command_buffer_begin(
   return iree_ok_status();
 }
 
+#if IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+static iree_status_t iree_hal_cmd_list_optimize(iree_hal_cmd_list_t* cmd_list);
+#endif  // IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+
 static iree_status_t iree_hal_deferred_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
+#if IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      iree_hal_deferred_command_buffer_cast(base_command_buffer);
+  return iree_hal_cmd_list_optimize(&command_buffer->cmd_list);
+#else
   return iree_ok_status();
+#endif  // IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
 }
 
 //===----------------------------------------------------------------------===//
@@ -723,24 +736,51 @@ static iree_status_t iree_hal_deferred_command_buffer_push_descriptor_set(
   cmd->pipeline_layout = pipeline_layout;
   cmd->set = set;
   cmd->binding_count = binding_count;
-  for (iree_host_size_t i = 0; i < binding_count; ++i) {
-    iree_hal_descriptor_set_binding_t binding = bindings[i];
-    cmd->bindings[i] = binding;
-    if (binding.buffer) {
-      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-          command_buffer->resource_set, 1, &binding.buffer));
-    }
-  }
-  return iree_ok_status();
+  memcpy(cmd->bindings, bindings, sizeof(cmd->bindings[0]) * binding_count);
+  return iree_hal_resource_set_insert_strided(
+      command_buffer->resource_set, binding_count, &bindings[0].buffer,
+      sizeof(bindings[0]));
 }
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_push_descriptor_set(
     iree_hal_command_buffer_t* target_command_buffer,
     iree_hal_buffer_binding_table_t binding_table,
     const iree_hal_cmd_push_descriptor_set_t* cmd) {
+  // Resolve any indirect bindings against the binding table. The recorded
+  // offsets are relative to the table bindings.
+  iree_hal_descriptor_set_binding_t* bindings =
+      (iree_hal_descriptor_set_binding_t*)cmd->bindings;
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    if (cmd->bindings[i].buffer) continue;
+    if (bindings == cmd->bindings) {
+      bindings = (iree_hal_descriptor_set_binding_t*)iree_alloca(
+          sizeof(bindings[0]) * cmd->binding_count);
+      memcpy(bindings, cmd->bindings, sizeof(bindings[0]) * cmd->binding_count);
+    }
+    iree_hal_descriptor_set_binding_t* binding = &bindings[i];
+    if (binding->buffer_slot >= binding_table.count) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "bindings[%" PRIhsz
+                              "] references binding table slot %u but only "
+                              "%" PRIhsz " bindings were provided",
+                              i, binding->buffer_slot, binding_table.count);
+    }
+    const iree_hal_buffer_binding_t* table_binding =
+        &binding_table.bindings[binding->buffer_slot];
+    if (!table_binding->buffer) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "binding table slot %u has no buffer",
+                              binding->buffer_slot);
+    }
+    binding->buffer = table_binding->buffer;
+    binding->offset += table_binding->offset;
+    if (binding->length == IREE_WHOLE_BUFFER) {
+      binding->length = table_binding->length;
+    }
+  }
   return iree_hal_command_buffer_push_descriptor_set(
       target_command_buffer, cmd->pipeline_layout, cmd->set, cmd->binding_count,
-      cmd->bindings);
+      bindings);
 }
 
 //===----------------------------------------------------------------------===//
@@ -877,6 +917,175 @@ static iree_status_t iree_hal_deferred_command_buffer_apply_execute_commands(
       target_command_buffer, cmd->commands, child_binding_table);
 }
 
+//===----------------------------------------------------------------------===//
+// Command list optimization
+//===----------------------------------------------------------------------===//
+
+#if IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+
+// Commands not separated by a barrier have no ordering guarantees between them
+// and any dependency must be expressed with an execution barrier. This lets us
+// merge adjacent commands of the same type without analyzing whether they
+// alias: if the original commands were well-formed then they were already
+// independent and the merged command performs exactly the same work.
+//
+// NOTE: we don't reorder commands across barriers as that would require
+// knowing which buffers alias (subspans, binding table slots, etc) and within a
+// barrier scope targets are already free to execute commands concurrently.
+
+// Merges |next| into |cmd| if both barriers are plain execution barriers.
+// Back-to-back barriers with no commands between them are equivalent to a
+// single barrier with the union of their stages.
+static bool iree_hal_cmd_merge_execution_barriers(
+    iree_hal_cmd_execution_barrier_t* cmd,
+    const iree_hal_cmd_execution_barrier_t* next) {
+  if (cmd->flags != next->flags) return false;
+  if (cmd->memory_barrier_count || cmd->buffer_barrier_count ||
+      next->memory_barrier_count || next->buffer_barrier_count) {
+    return false;
+  }
+  cmd->source_stage_mask |= next->source_stage_mask;
+  cmd->target_stage_mask |= next->target_stage_mask;
+  return true;
+}
+
+// Merges |next| into |cmd| if it continues the fill with the same pattern.
+static bool iree_hal_cmd_merge_fill_buffers(
+    iree_hal_cmd_fill_buffer_t* cmd, const iree_hal_cmd_fill_buffer_t* next) {
+  if (cmd->target_buffer != next->target_buffer ||
+      cmd->length == IREE_WHOLE_BUFFER || next->length == IREE_WHOLE_BUFFER ||
+      cmd->target_offset + cmd->length != next->target_offset ||
+      cmd->pattern_length != next->pattern_length ||
+      memcmp(&cmd->pattern, &next->pattern, cmd->pattern_length) != 0) {
+    return false;
+  }
+  cmd->length += next->length;
+  return true;
+}
+
+// Merges |next| into |cmd| if it continues the copy in both buffers.
+static bool iree_hal_cmd_merge_copy_buffers(
+    iree_hal_cmd_copy_buffer_t* cmd, const iree_hal_cmd_copy_buffer_t* next) {
+  if (cmd->source_buffer != next->source_buffer ||
+      cmd->target_buffer != next->target_buffer ||
+      cmd->length == IREE_WHOLE_BUFFER || next->length == IREE_WHOLE_BUFFER ||
+      cmd->source_offset + cmd->length != next->source_offset ||
+      cmd->target_offset + cmd->length != next->target_offset) {
+    return false;
+  }
+  cmd->length += next->length;
+  return true;
+}
+
+// Merges |next| into |cmd| if the two update overlapping or adjacent ranges of
+// the same pipeline layout. Later values take precedence. If the merged range
+// does not fit in |cmd| a new command is allocated and returned in
+// |out_merged_cmd|. Returns NULL in |out_merged_cmd| if the commands could not
+// be merged.
+static iree_status_t iree_hal_cmd_merge_push_constants(
+    iree_hal_cmd_list_t* cmd_list, iree_hal_cmd_push_constants_t* cmd,
+    const iree_hal_cmd_push_constants_t* next,
+    iree_hal_cmd_push_constants_t** out_merged_cmd) {
+  *out_merged_cmd = NULL;
+  if (cmd->pipeline_layout != next->pipeline_layout) return iree_ok_status();
+  const iree_host_size_t cmd_end = cmd->offset + cmd->values_length;
+  const iree_host_size_t next_end = next->offset + next->values_length;
+  if (next->offset > cmd_end || cmd->offset > next_end) {
+    return iree_ok_status();  // disjoint
+  }
+
+  iree_hal_cmd_push_constants_t* merged_cmd = cmd;
+  const iree_host_size_t offset = iree_min(cmd->offset, next->offset);
+  const iree_host_size_t values_length = iree_max(cmd_end, next_end) - offset;
+  if (offset != cmd->offset || values_length != cmd->values_length) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &cmd_list->arena,
+        sizeof(*merged_cmd) + sizeof(merged_cmd->values[0]) * values_length,
+        (void**)&merged_cmd));
+    merged_cmd->header = cmd->header;
+    merged_cmd->pipeline_layout = cmd->pipeline_layout;
+    merged_cmd->offset = offset;
+    merged_cmd->values_length = values_length;
+    memcpy(merged_cmd->values + (cmd->offset - offset), cmd->values,
+           cmd->values_length);
+  }
+  memcpy(merged_cmd->values + (next->offset - offset), next->values,
+         next->values_length);
+  *out_merged_cmd = merged_cmd;
+  return iree_ok_status();
+}
+
+// Tries to merge |next| into |cmd| and returns the merged command in
+// |out_merged_cmd| or NULL if the commands could not be merged. The merged
+// command may be a newly allocated command that replaces |cmd|.
+static iree_status_t iree_hal_cmd_merge(
+    iree_hal_cmd_list_t* cmd_list, iree_hal_cmd_header_t* cmd,
+    const iree_hal_cmd_header_t* next, iree_hal_cmd_header_t** out_merged_cmd) {
+  *out_merged_cmd = NULL;
+  if (cmd->type != next->type) return iree_ok_status();
+  bool merged = false;
+  switch (cmd->type) {
+    case IREE_HAL_CMD_EXECUTION_BARRIER:
+      merged = iree_hal_cmd_merge_execution_barriers(
+          (iree_hal_cmd_execution_barrier_t*)cmd,
+          (const iree_hal_cmd_execution_barrier_t*)next);
+      break;
+    case IREE_HAL_CMD_FILL_BUFFER:
+      merged = iree_hal_cmd_merge_fill_buffers(
+          (iree_hal_cmd_fill_buffer_t*)cmd,
+          (const iree_hal_cmd_fill_buffer_t*)next);
+      break;
+    case IREE_HAL_CMD_COPY_BUFFER:
+      merged = iree_hal_cmd_merge_copy_buffers(
+          (iree_hal_cmd_copy_buffer_t*)cmd,
+          (const iree_hal_cmd_copy_buffer_t*)next);
+      break;
+    case IREE_HAL_CMD_PUSH_CONSTANTS:
+      return iree_hal_cmd_merge_push_constants(
+          cmd_list, (iree_hal_cmd_push_constants_t*)cmd,
+          (const iree_hal_cmd_push_constants_t*)next,
+          (iree_hal_cmd_push_constants_t**)out_merged_cmd);
+    default:
+      break;
+  }
+  if (merged) *out_merged_cmd = cmd;
+  return iree_ok_status();
+}
+
+// Runs a peephole optimization pass over the full command list, merging runs
+// of adjacent commands in place. Any storage for commands dropped from the
+// list remains in the arena until the list is reset.
+static iree_status_t iree_hal_cmd_list_optimize(iree_hal_cmd_list_t* cmd_list) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_cmd_header_t* prev = NULL;
+  iree_hal_cmd_header_t* cmd = cmd_list->head;
+  while (cmd && cmd->next) {
+    iree_hal_cmd_header_t* next = cmd->next;
+    iree_hal_cmd_header_t* merged_cmd = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_cmd_merge(cmd_list, cmd, next, &merged_cmd));
+    if (!merged_cmd) {
+      prev = cmd;
+      cmd = next;
+      continue;
+    }
+    // Splice the merged command in place of |cmd| and |next| and try to merge
+    // the command that follows into it.
+    merged_cmd->next = next->next;
+    if (prev) {
+      prev->next = merged_cmd;
+    } else {
+      cmd_list->head = merged_cmd;
+    }
+    if (cmd_list->tail == next) cmd_list->tail = merged_cmd;
+    cmd = merged_cmd;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+#endif  // IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+
 //===----------------------------------------------------------------------===//
 // Dynamic replay dispatch
 //===----------------------------------------------------------------------===//
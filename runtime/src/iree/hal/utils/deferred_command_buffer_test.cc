@@ -0,0 +1,272 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/deferred_command_buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::ElementsAre;
+
+// A resource that stands in for buffers and pipeline layouts. Commands are
+// recorded unvalidated and the deferred command buffer only retains them.
+typedef struct iree_hal_test_resource_t {
+  iree_hal_resource_t resource;
+} iree_hal_test_resource_t;
+
+typedef struct iree_hal_test_resource_vtable_t {
+  void(IREE_API_PTR* destroy)(iree_hal_test_resource_t* resource);
+} iree_hal_test_resource_vtable_t;
+IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_test_resource_vtable_t);
+
+static void iree_hal_test_resource_destroy(iree_hal_test_resource_t* resource) {
+  delete resource;
+}
+
+static const iree_hal_test_resource_vtable_t iree_hal_test_resource_vtable = {
+    /*.destroy=*/iree_hal_test_resource_destroy,
+};
+
+// A command buffer that logs each command replayed into it.
+typedef struct iree_hal_logging_command_buffer_t {
+  iree_hal_command_buffer_t base;
+  std::vector<std::string>* log;
+} iree_hal_logging_command_buffer_t;
+
+static std::vector<std::string>* Log(iree_hal_command_buffer_t* base) {
+  return ((iree_hal_logging_command_buffer_t*)base)->log;
+}
+
+static void LoggingDestroy(iree_hal_command_buffer_t* base) {
+  delete (iree_hal_logging_command_buffer_t*)base;
+}
+
+static iree_status_t LoggingBegin(iree_hal_command_buffer_t* base) {
+  return iree_ok_status();
+}
+
+static iree_status_t LoggingEnd(iree_hal_command_buffer_t* base) {
+  return iree_ok_status();
+}
+
+static iree_status_t LoggingExecutionBarrier(
+    iree_hal_command_buffer_t* base,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  Log(base)->push_back("barrier " + std::to_string(source_stage_mask) + " " +
+                       std::to_string(target_stage_mask));
+  return iree_ok_status();
+}
+
+static iree_status_t LoggingFillBuffer(iree_hal_command_buffer_t* base,
+                                       iree_hal_buffer_t* target_buffer,
+                                       iree_device_size_t target_offset,
+                                       iree_device_size_t length,
+                                       const void* pattern,
+                                       iree_host_size_t pattern_length) {
+  uint64_t pattern_value = 0;
+  memcpy(&pattern_value, pattern, pattern_length);
+  Log(base)->push_back("fill " + std::to_string(target_offset) + " " +
+                       std::to_string(length) + " " +
+                       std::to_string(pattern_value));
+  return iree_ok_status();
+}
+
+static iree_status_t LoggingCopyBuffer(iree_hal_command_buffer_t* base,
+                                       iree_hal_buffer_t* source_buffer,
+                                       iree_device_size_t source_offset,
+                                       iree_hal_buffer_t* target_buffer,
+                                       iree_device_size_t target_offset,
+                                       iree_device_size_t length) {
+  Log(base)->push_back("copy " + std::to_string(source_offset) + " " +
+                       std::to_string(target_offset) + " " +
+                       std::to_string(length));
+  return iree_ok_status();
+}
+
+static iree_status_t LoggingPushConstants(
+    iree_hal_command_buffer_t* base,
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t offset,
+    const void* values, iree_host_size_t values_length) {
+  std::string entry = "constants " + std::to_string(offset) + ":";
+  for (iree_host_size_t i = 0; i < values_length; ++i) {
+    entry += " " + std::to_string(((const uint8_t*)values)[i]);
+  }
+  Log(base)->push_back(entry);
+  return iree_ok_status();
+}
+
+static const iree_hal_command_buffer_vtable_t* LoggingVtable() {
+  static iree_hal_command_buffer_vtable_t vtable = [] {
+    iree_hal_command_buffer_vtable_t vtable;
+    memset(&vtable, 0, sizeof(vtable));
+    vtable.destroy = LoggingDestroy;
+    vtable.begin = LoggingBegin;
+    vtable.end = LoggingEnd;
+    vtable.execution_barrier = LoggingExecutionBarrier;
+    vtable.fill_buffer = LoggingFillBuffer;
+    vtable.copy_buffer = LoggingCopyBuffer;
+    vtable.push_constants = LoggingPushConstants;
+    return vtable;
+  }();
+  return &vtable;
+}
+
+class DeferredCommandBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_arena_block_pool_initialize(4096, iree_allocator_system(),
+                                     &block_pool_);
+    IREE_ASSERT_OK(iree_hal_deferred_command_buffer_create(
+        /*device=*/NULL, IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, &block_pool_,
+        iree_allocator_system(), &command_buffer_));
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer_));
+    buffer_a_ = (iree_hal_buffer_t*)CreateResource();
+    buffer_b_ = (iree_hal_buffer_t*)CreateResource();
+    pipeline_layout_ = (iree_hal_pipeline_layout_t*)CreateResource();
+  }
+
+  void TearDown() override {
+    iree_hal_command_buffer_release(command_buffer_);
+    iree_hal_resource_release(buffer_a_);
+    iree_hal_resource_release(buffer_b_);
+    iree_hal_resource_release(pipeline_layout_);
+    iree_arena_block_pool_deinitialize(&block_pool_);
+  }
+
+  static iree_hal_resource_t* CreateResource() {
+    iree_hal_test_resource_t* resource = new iree_hal_test_resource_t();
+    iree_hal_resource_initialize(&iree_hal_test_resource_vtable,
+                                 &resource->resource);
+    return &resource->resource;
+  }
+
+  // Ends recording and replays the command buffer returning the log.
+  std::vector<std::string> Replay() {
+    IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer_));
+    std::vector<std::string> log;
+    iree_hal_logging_command_buffer_t* target =
+        new iree_hal_logging_command_buffer_t();
+    iree_hal_command_buffer_initialize(
+        /*device=*/NULL, IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, LoggingVtable(), &target->base);
+    target->log = &log;
+    IREE_CHECK_OK(iree_hal_deferred_command_buffer_apply(
+        command_buffer_, &target->base, iree_hal_buffer_binding_table_empty()));
+    iree_hal_command_buffer_release(&target->base);
+    return log;
+  }
+
+  void Barrier(iree_hal_execution_stage_t source_stage_mask,
+               iree_hal_execution_stage_t target_stage_mask) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer_, source_stage_mask, target_stage_mask,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  }
+
+  void Fill(iree_hal_buffer_t* buffer, iree_device_size_t offset,
+            iree_device_size_t length, uint8_t pattern) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer_, buffer, offset, length, &pattern, sizeof(pattern)));
+  }
+
+  void Copy(iree_device_size_t source_offset, iree_device_size_t target_offset,
+            iree_device_size_t length) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+        command_buffer_, buffer_a_, source_offset, buffer_b_, target_offset,
+        length));
+  }
+
+  void PushConstants(iree_host_size_t offset, std::vector<uint8_t> values) {
+    IREE_ASSERT_OK(iree_hal_command_buffer_push_constants(
+        command_buffer_, pipeline_layout_, offset, values.data(),
+        values.size()));
+  }
+
+  iree_arena_block_pool_t block_pool_;
+  iree_hal_command_buffer_t* command_buffer_ = NULL;
+  iree_hal_buffer_t* buffer_a_ = NULL;
+  iree_hal_buffer_t* buffer_b_ = NULL;
+  iree_hal_pipeline_layout_t* pipeline_layout_ = NULL;
+};
+
+#if IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+
+// Contiguous fills of the same pattern merge into one.
+TEST_F(DeferredCommandBufferTest, MergesAdjacentFills) {
+  Fill(buffer_a_, 0, 16, 7);
+  Fill(buffer_a_, 16, 16, 7);
+  Fill(buffer_a_, 32, 8, 7);
+  Fill(buffer_a_, 48, 8, 7);  // gap
+  Fill(buffer_a_, 56, 8, 9);  // different pattern
+  Fill(buffer_b_, 64, 8, 9);  // different buffer
+  EXPECT_THAT(Replay(), ElementsAre("fill 0 40 7", "fill 48 8 7",
+                                    "fill 56 8 9", "fill 64 8 9"));
+}
+
+// Copies contiguous in both the source and target merge into one.
+TEST_F(DeferredCommandBufferTest, MergesAdjacentCopies) {
+  Copy(0, 100, 10);
+  Copy(10, 110, 10);
+  Copy(20, 200, 10);  // target not contiguous
+  EXPECT_THAT(Replay(), ElementsAre("copy 0 100 20", "copy 20 200 10"));
+}
+
+// Back-to-back barriers merge while barriers between commands are preserved
+// and prevent merging the commands they separate.
+TEST_F(DeferredCommandBufferTest, MergesRedundantBarriers) {
+  Fill(buffer_a_, 0, 16, 7);
+  Barrier(IREE_HAL_EXECUTION_STAGE_TRANSFER, IREE_HAL_EXECUTION_STAGE_DISPATCH);
+  Barrier(IREE_HAL_EXECUTION_STAGE_DISPATCH, IREE_HAL_EXECUTION_STAGE_TRANSFER);
+  Fill(buffer_a_, 16, 16, 7);
+  EXPECT_THAT(Replay(), ElementsAre("fill 0 16 7", "barrier 12 12",
+                                    "fill 16 16 7"));
+}
+
+// Overlapping and adjacent push constant updates coalesce with later values
+// taking precedence.
+TEST_F(DeferredCommandBufferTest, CoalescesPushConstants) {
+  PushConstants(4, {1, 2, 3, 4});
+  PushConstants(8, {5, 6});
+  PushConstants(2, {7, 8, 9});
+  PushConstants(16, {10});  // disjoint
+  EXPECT_THAT(Replay(), ElementsAre("constants 2: 7 8 9 2 3 4 5 6",
+                                    "constants 16: 10"));
+}
+
+#else
+
+// Commands are replayed verbatim when the optimization pass is disabled.
+TEST_F(DeferredCommandBufferTest, ReplaysVerbatim) {
+  Fill(buffer_a_, 0, 16, 7);
+  Fill(buffer_a_, 16, 16, 7);
+  EXPECT_THAT(Replay(), ElementsAre("fill 0 16 7", "fill 16 16 7"));
+}
+
+#endif  // IREE_HAL_DEFERRED_COMMAND_BUFFER_OPTIMIZATION_ENABLE
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,626 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/recording_allocator.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_recording_allocator_t
+//===----------------------------------------------------------------------===//
+
+void iree_hal_recording_allocator_params_initialize(
+    iree_hal_recording_allocator_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+}
+
+typedef enum iree_hal_recording_allocator_event_type_e {
+  IREE_HAL_RECORDING_ALLOCATOR_EVENT_ALLOCATE = 0,
+  IREE_HAL_RECORDING_ALLOCATOR_EVENT_FREE,
+} iree_hal_recording_allocator_event_type_t;
+
+// A single allocation or free in the timeline.
+typedef struct iree_hal_recording_allocator_event_t {
+  // Time of the event relative to the creation of the allocator.
+  iree_duration_t time_ns;
+  iree_hal_recording_allocator_event_type_t type;
+  // Label that was current when the buffer was allocated.
+  uint32_t label_ordinal;
+  iree_hal_memory_type_t memory_type;
+  iree_hal_buffer_usage_t usage;
+  // Size requested by the caller. Only set on allocations.
+  iree_device_size_t requested_size;
+  // Size of the allocation made by the underlying allocator.
+  iree_device_size_t allocation_size;
+} iree_hal_recording_allocator_event_t;
+
+// A buffer that has been allocated and not yet deallocated.
+typedef struct iree_hal_recording_allocator_live_t {
+  iree_hal_buffer_t* buffer;
+  uint32_t label_ordinal;
+} iree_hal_recording_allocator_live_t;
+
+struct iree_hal_recording_allocator_t {
+  iree_hal_resource_t resource;
+
+  // Allocator used for the recording allocator itself and its events.
+  iree_allocator_t host_allocator;
+
+  // Underlying device allocator used to allocate storage.
+  iree_hal_allocator_t* device_allocator;
+
+  // Issued when the allocator is destroyed.
+  iree_hal_recording_allocator_complete_callback_t complete_callback;
+
+  // Time the allocator was created that event times are relative to.
+  iree_time_t base_time_ns;
+
+  // Guards the labels, events, and live buffers. Never held during underlying
+  // allocator operations.
+  iree_slim_mutex_t mutex;
+
+  // Label attributed to new allocations.
+  uint32_t current_label_ordinal;
+
+  // Unique labels in the order they were first set. Label storage is owned.
+  iree_host_size_t label_count;
+  iree_host_size_t label_capacity;
+  iree_string_view_t* labels;
+
+  // All events in the order they were recorded. Capacity is always reserved
+  // for the free event of every live buffer so that deallocation can't fail.
+  iree_host_size_t event_count;
+  iree_host_size_t event_capacity;
+  iree_hal_recording_allocator_event_t* events;
+
+  // Buffers that have been allocated and not yet deallocated.
+  iree_host_size_t live_count;
+  iree_host_size_t live_capacity;
+  iree_hal_recording_allocator_live_t* live;
+};
+
+static const iree_hal_allocator_vtable_t iree_hal_recording_allocator_vtable;
+
+static iree_hal_recording_allocator_t* iree_hal_recording_allocator_cast(
+    iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_recording_allocator_vtable);
+  return (iree_hal_recording_allocator_t*)base_value;
+}
+
+// Grows |*inout_storage| of |element_size| elements to hold at least
+// |minimum_capacity| elements.
+static iree_status_t iree_hal_recording_allocator_reserve(
+    iree_allocator_t host_allocator, iree_host_size_t element_size,
+    iree_host_size_t minimum_capacity, iree_host_size_t* inout_capacity,
+    void** inout_storage) {
+  if (minimum_capacity <= *inout_capacity) return iree_ok_status();
+  iree_host_size_t new_capacity = iree_max(16, *inout_capacity * 2);
+  new_capacity = iree_max(new_capacity, minimum_capacity);
+  IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+      host_allocator, new_capacity * element_size, inout_storage));
+  *inout_capacity = new_capacity;
+  return iree_ok_status();
+}
+
+// Sets the current label to |label|, interning it if it has not been seen.
+// Must be called with the mutex held.
+static iree_status_t iree_hal_recording_allocator_set_label_locked(
+    iree_hal_recording_allocator_t* allocator, iree_string_view_t label) {
+  if (iree_string_view_is_empty(label)) label = IREE_SV("unlabeled");
+  for (iree_host_size_t i = 0; i < allocator->label_count; ++i) {
+    if (iree_string_view_equal(allocator->labels[i], label)) {
+      allocator->current_label_ordinal = (uint32_t)i;
+      return iree_ok_status();
+    }
+  }
+  IREE_RETURN_IF_ERROR(iree_hal_recording_allocator_reserve(
+      allocator->host_allocator, sizeof(allocator->labels[0]),
+      allocator->label_count + 1, &allocator->label_capacity,
+      (void**)&allocator->labels));
+  char* label_data = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_clone(
+      allocator->host_allocator, iree_make_const_byte_span(label.data,
+                                                           label.size),
+      (void**)&label_data));
+  allocator->labels[allocator->label_count] =
+      iree_make_string_view(label_data, label.size);
+  allocator->current_label_ordinal = (uint32_t)allocator->label_count++;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_recording_allocator_create(
+    const iree_hal_recording_allocator_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_recording_allocator_t* allocator = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*allocator),
+                                (void**)&allocator));
+  iree_hal_resource_initialize(&iree_hal_recording_allocator_vtable,
+                               &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->device_allocator = device_allocator;
+  iree_hal_allocator_retain(allocator->device_allocator);
+  allocator->base_time_ns = iree_time_now();
+  iree_slim_mutex_initialize(&allocator->mutex);
+
+  iree_status_t status = iree_hal_recording_allocator_set_label_locked(
+      allocator, params->initial_label);
+
+  if (iree_status_is_ok(status)) {
+    allocator->complete_callback = params->complete_callback;
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  } else {
+    iree_hal_allocator_release((iree_hal_allocator_t*)allocator);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_recording_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (allocator->complete_callback.fn) {
+    allocator->complete_callback.fn(allocator->complete_callback.user_data,
+                                    base_allocator);
+  }
+
+  for (iree_host_size_t i = 0; i < allocator->label_count; ++i) {
+    iree_allocator_free(host_allocator, (void*)allocator->labels[i].data);
+  }
+  iree_allocator_free(host_allocator, allocator->labels);
+  iree_allocator_free(host_allocator, allocator->events);
+  iree_allocator_free(host_allocator, allocator->live);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_hal_allocator_release(allocator->device_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_recording_allocator_set_label(
+    iree_hal_allocator_t* base_allocator, iree_string_view_t label) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_status_t status =
+      iree_hal_recording_allocator_set_label_locked(allocator, label);
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return status;
+}
+
+static iree_allocator_t iree_hal_recording_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_recording_allocator_t* allocator =
+      (iree_hal_recording_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_recording_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  return iree_hal_allocator_trim(allocator->device_allocator);
+}
+
+static void iree_hal_recording_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->device_allocator,
+                                      out_statistics);
+}
+
+static iree_status_t iree_hal_recording_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_memory_heaps(allocator->device_allocator,
+                                               capacity, heaps, out_count);
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_recording_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_buffer_compatibility(
+      allocator->device_allocator, *params, *allocation_size, params,
+      allocation_size);
+}
+
+static iree_status_t iree_hal_recording_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      allocator->device_allocator, *params, allocation_size, initial_data,
+      out_buffer));
+  iree_hal_buffer_t* buffer = *out_buffer;
+
+  // Point the buffer back to us for deallocation.
+  buffer->device_allocator = base_allocator;
+
+  iree_time_t time_ns = iree_time_now();
+  iree_slim_mutex_lock(&allocator->mutex);
+  // Reserve both the allocation event and the free event that will follow.
+  iree_status_t status = iree_hal_recording_allocator_reserve(
+      allocator->host_allocator, sizeof(allocator->events[0]),
+      allocator->event_count + allocator->live_count + 2,
+      &allocator->event_capacity, (void**)&allocator->events);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_recording_allocator_reserve(
+        allocator->host_allocator, sizeof(allocator->live[0]),
+        allocator->live_count + 1, &allocator->live_capacity,
+        (void**)&allocator->live);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_recording_allocator_event_t* event =
+        &allocator->events[allocator->event_count++];
+    event->time_ns = time_ns - allocator->base_time_ns;
+    event->type = IREE_HAL_RECORDING_ALLOCATOR_EVENT_ALLOCATE;
+    event->label_ordinal = allocator->current_label_ordinal;
+    event->memory_type = iree_hal_buffer_memory_type(buffer);
+    event->usage = iree_hal_buffer_allowed_usage(buffer);
+    event->requested_size = allocation_size;
+    event->allocation_size = iree_hal_buffer_allocation_size(buffer);
+    iree_hal_recording_allocator_live_t* live =
+        &allocator->live[allocator->live_count++];
+    live->buffer = buffer;
+    live->label_ordinal = allocator->current_label_ordinal;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  if (!iree_status_is_ok(status)) {
+    // The buffer is not live and deallocation will not record a free.
+    iree_hal_buffer_release(buffer);
+    *out_buffer = NULL;
+  }
+  return status;
+}
+
+static void iree_hal_recording_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+
+  iree_time_t time_ns = iree_time_now();
+  iree_slim_mutex_lock(&allocator->mutex);
+  // Buffers are most commonly freed in the reverse order they were allocated
+  // so the search starts with the most recent allocation.
+  for (iree_host_size_t i = allocator->live_count; i > 0; --i) {
+    iree_hal_recording_allocator_live_t* live = &allocator->live[i - 1];
+    if (live->buffer != buffer) continue;
+    iree_hal_recording_allocator_event_t* event =
+        &allocator->events[allocator->event_count++];
+    event->time_ns = time_ns - allocator->base_time_ns;
+    event->type = IREE_HAL_RECORDING_ALLOCATOR_EVENT_FREE;
+    event->label_ordinal = live->label_ordinal;
+    event->memory_type = iree_hal_buffer_memory_type(buffer);
+    event->usage = iree_hal_buffer_allowed_usage(buffer);
+    event->requested_size = 0;
+    event->allocation_size = iree_hal_buffer_allocation_size(buffer);
+    *live = allocator->live[--allocator->live_count];
+    break;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  iree_hal_allocator_deallocate_buffer(allocator->device_allocator, buffer);
+}
+
+static iree_status_t iree_hal_recording_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  // Imported memory is owned externally and not recorded.
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  return iree_hal_allocator_import_buffer(allocator->device_allocator, *params,
+                                          external_buffer, release_callback,
+                                          out_buffer);
+}
+
+static iree_status_t iree_hal_recording_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->device_allocator, buffer,
+                                          requested_type, requested_flags,
+                                          out_external_buffer);
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_recording_allocator_vtable = {
+    .destroy = iree_hal_recording_allocator_destroy,
+    .host_allocator = iree_hal_recording_allocator_host_allocator,
+    .trim = iree_hal_recording_allocator_trim,
+    .query_statistics = iree_hal_recording_allocator_query_statistics,
+    .query_memory_heaps = iree_hal_recording_allocator_query_memory_heaps,
+    .query_buffer_compatibility =
+        iree_hal_recording_allocator_query_buffer_compatibility,
+    .allocate_buffer = iree_hal_recording_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_recording_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_recording_allocator_import_buffer,
+    .export_buffer = iree_hal_recording_allocator_export_buffer,
+};
+
+//===----------------------------------------------------------------------===//
+// Reporting
+//===----------------------------------------------------------------------===//
+
+// Live bytes attributed to a label or heap at the peak.
+typedef struct iree_hal_recording_allocator_row_t {
+  // Label ordinal or heap memory type and usage the row is keyed on.
+  uint32_t label_ordinal;
+  iree_hal_memory_type_t memory_type;
+  iree_hal_buffer_usage_t usage;
+  iree_device_size_t live_size;
+  iree_host_size_t live_count;
+} iree_hal_recording_allocator_row_t;
+
+// Sorts rows by descending live size.
+static int iree_hal_recording_allocator_row_compare(const void* lhs_ptr,
+                                                    const void* rhs_ptr) {
+  const iree_hal_recording_allocator_row_t* lhs =
+      (const iree_hal_recording_allocator_row_t*)lhs_ptr;
+  const iree_hal_recording_allocator_row_t* rhs =
+      (const iree_hal_recording_allocator_row_t*)rhs_ptr;
+  if (lhs->live_size != rhs->live_size) {
+    return lhs->live_size > rhs->live_size ? -1 : 1;
+  }
+  return 0;
+}
+
+// Adds the |event| to the |row| it is attributed to.
+static void iree_hal_recording_allocator_row_apply(
+    iree_hal_recording_allocator_row_t* row,
+    const iree_hal_recording_allocator_event_t* event) {
+  if (event->type == IREE_HAL_RECORDING_ALLOCATOR_EVENT_ALLOCATE) {
+    row->live_size += event->allocation_size;
+    ++row->live_count;
+  } else {
+    row->live_size -= event->allocation_size;
+    --row->live_count;
+  }
+}
+
+static iree_status_t iree_hal_recording_allocator_format_rows(
+    iree_host_size_t row_count, iree_hal_recording_allocator_row_t* rows,
+    iree_device_size_t peak_size, bool by_label,
+    const iree_string_view_t* labels, iree_string_builder_t* builder) {
+  qsort(rows, row_count, sizeof(rows[0]),
+        iree_hal_recording_allocator_row_compare);
+  for (iree_host_size_t i = 0; i < row_count; ++i) {
+    const iree_hal_recording_allocator_row_t* row = &rows[i];
+    if (!row->live_count) continue;
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "  %12" PRIu64 " bytes (%5.1f%%) %8" PRIhsz " allocations  ",
+        (uint64_t)row->live_size,
+        peak_size ? 100.0 * (double)row->live_size / (double)peak_size : 0.0,
+        row->live_count));
+    if (by_label) {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_string(
+          builder, labels[row->label_ordinal]));
+    } else {
+      iree_bitfield_string_temp_t temp0, temp1;
+      iree_string_view_t memory_type_str =
+          iree_hal_memory_type_format(row->memory_type, &temp0);
+      iree_string_view_t usage_str =
+          iree_hal_buffer_usage_format(row->usage, &temp1);
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          builder, "%.*s;%.*s", (int)memory_type_str.size,
+          memory_type_str.data, (int)usage_str.size, usage_str.data));
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "\n"));
+  }
+  return iree_ok_status();
+}
+
+// Formats the report from the events recorded by |allocator|.
+// Must be called with the mutex held.
+static iree_status_t iree_hal_recording_allocator_format_report_locked(
+    iree_hal_recording_allocator_t* allocator, iree_string_builder_t* builder) {
+  // Find the first event at which the live bytes peaked.
+  uint64_t allocation_count = 0;
+  uint64_t free_count = 0;
+  uint64_t requested_size = 0;
+  uint64_t allocated_size = 0;
+  iree_device_size_t largest_size = 0;
+  iree_device_size_t live_size = 0;
+  iree_host_size_t live_count = 0;
+  iree_device_size_t peak_size = 0;
+  iree_host_size_t peak_count = 0;
+  iree_host_size_t peak_event_count = 0;
+  for (iree_host_size_t i = 0; i < allocator->event_count; ++i) {
+    const iree_hal_recording_allocator_event_t* event = &allocator->events[i];
+    if (event->type == IREE_HAL_RECORDING_ALLOCATOR_EVENT_ALLOCATE) {
+      ++allocation_count;
+      requested_size += event->requested_size;
+      allocated_size += event->allocation_size;
+      largest_size = iree_max(largest_size, event->allocation_size);
+      live_size += event->allocation_size;
+      ++live_count;
+      if (live_size > peak_size) {
+        peak_size = live_size;
+        peak_count = live_count;
+        peak_event_count = i + 1;
+      }
+    } else {
+      ++free_count;
+      live_size -= event->allocation_size;
+      --live_count;
+    }
+  }
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "[[ iree_hal_recording_allocator_t memory timeline ]]\n"
+      "  ALLOCATIONS: %12" PRIu64 " allocations / %12" PRIu64
+      " frees / %12" PRIhsz " live\n"
+      "    REQUESTED: %12" PRIu64 " bytes\n"
+      "    ALLOCATED: %12" PRIu64 " bytes (%" PRIu64 " bytes padding)\n"
+      "      LARGEST: %12" PRIu64 " bytes\n",
+      allocation_count, free_count, live_count, requested_size,
+      allocated_size,
+      allocated_size > requested_size ? allocated_size - requested_size : 0,
+      (uint64_t)largest_size));
+  if (!peak_event_count) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "         PEAK: %12" PRIu64 " bytes in %" PRIhsz
+      " allocations at %.3fms\n",
+      (uint64_t)peak_size, peak_count,
+      allocator->events[peak_event_count - 1].time_ns / 1000000.0));
+
+  // Replay the events up to the peak to attribute the live bytes. Heaps are
+  // keyed on the memory type and usage of each buffer.
+  iree_hal_recording_allocator_row_t* label_rows = NULL;
+  iree_hal_recording_allocator_row_t* heap_rows = NULL;
+  iree_host_size_t heap_row_count = 0;
+  iree_status_t status = iree_allocator_malloc(
+      allocator->host_allocator,
+      allocator->label_count * sizeof(label_rows[0]), (void**)&label_rows);
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(allocator->host_allocator,
+                                   peak_event_count * sizeof(heap_rows[0]),
+                                   (void**)&heap_rows);
+  }
+  if (iree_status_is_ok(status)) {
+    memset(label_rows, 0, allocator->label_count * sizeof(label_rows[0]));
+    for (iree_host_size_t i = 0; i < allocator->label_count; ++i) {
+      label_rows[i].label_ordinal = (uint32_t)i;
+    }
+    for (iree_host_size_t i = 0; i < peak_event_count; ++i) {
+      const iree_hal_recording_allocator_event_t* event =
+          &allocator->events[i];
+      iree_hal_recording_allocator_row_apply(&label_rows[event->label_ordinal],
+                                             event);
+      iree_hal_recording_allocator_row_t* heap_row = NULL;
+      for (iree_host_size_t j = 0; j < heap_row_count; ++j) {
+        if (heap_rows[j].memory_type == event->memory_type &&
+            heap_rows[j].usage == event->usage) {
+          heap_row = &heap_rows[j];
+          break;
+        }
+      }
+      if (!heap_row) {
+        heap_row = &heap_rows[heap_row_count++];
+        memset(heap_row, 0, sizeof(*heap_row));
+        heap_row->memory_type = event->memory_type;
+        heap_row->usage = event->usage;
+      }
+      iree_hal_recording_allocator_row_apply(heap_row, event);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(
+        builder, "live at peak by label:\n");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_recording_allocator_format_rows(
+        allocator->label_count, label_rows, peak_size, /*by_label=*/true,
+        allocator->labels, builder);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(
+        builder, "live at peak by heap:\n");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_recording_allocator_format_rows(
+        heap_row_count, heap_rows, peak_size, /*by_label=*/false,
+        allocator->labels, builder);
+  }
+
+  iree_allocator_free(allocator->host_allocator, heap_rows);
+  iree_allocator_free(allocator->host_allocator, label_rows);
+  return status;
+}
+
+iree_status_t iree_hal_recording_allocator_format_report(
+    iree_hal_allocator_t* base_allocator, iree_string_builder_t* builder) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_status_t status =
+      iree_hal_recording_allocator_format_report_locked(allocator, builder);
+  iree_slim_mutex_unlock(&allocator->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_recording_allocator_format_timeline(
+    iree_hal_allocator_t* base_allocator, iree_string_builder_t* builder) {
+  iree_hal_recording_allocator_t* allocator =
+      iree_hal_recording_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_status_t status = iree_string_builder_append_cstring(
+      builder,
+      "time_ns,event,label,memory_type,usage,requested_size,allocation_size,"
+      "live_size\n");
+  iree_device_size_t live_size = 0;
+  for (iree_host_size_t i = 0;
+       i < allocator->event_count && iree_status_is_ok(status); ++i) {
+    const iree_hal_recording_allocator_event_t* event = &allocator->events[i];
+    const bool is_allocate =
+        event->type == IREE_HAL_RECORDING_ALLOCATOR_EVENT_ALLOCATE;
+    if (is_allocate) {
+      live_size += event->allocation_size;
+    } else {
+      live_size -= event->allocation_size;
+    }
+    iree_string_view_t label = allocator->labels[event->label_ordinal];
+    iree_bitfield_string_temp_t temp0, temp1;
+    iree_string_view_t memory_type_str =
+        iree_hal_memory_type_format(event->memory_type, &temp0);
+    iree_string_view_t usage_str =
+        iree_hal_buffer_usage_format(event->usage, &temp1);
+    status = iree_string_builder_append_format(
+        builder,
+        "%" PRId64 ",%s,\"%.*s\",%.*s,%.*s,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+        "\n",
+        (int64_t)event->time_ns, is_allocate ? "alloc" : "free",
+        (int)label.size, label.data, (int)memory_type_str.size,
+        memory_type_str.data, (int)usage_str.size, usage_str.data,
+        (uint64_t)event->requested_size, (uint64_t)event->allocation_size,
+        (uint64_t)live_size);
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
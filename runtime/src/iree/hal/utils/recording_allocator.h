@@ -0,0 +1,98 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_RECORDING_ALLOCATOR_H_
+#define IREE_HAL_UTILS_RECORDING_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/base/string_builder.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A HAL buffer allocator that records a timeline of the allocations and frees
+// made from an underlying device allocator.
+//
+// Each event captures the time relative to allocator creation, the requested
+// and actual allocation sizes, the memory type and allowed usage of the buffer
+// and the label that was current when the buffer was allocated. Labels are set
+// by the hosting application (for example "load" while modules are being
+// loaded and the function name while it is being invoked) and are used to
+// attribute the live bytes at the peak. The HAL has no knowledge of which
+// program values a buffer backs so finer attribution must come from labels.
+//
+// Reports are produced from the recorded events and include the peak live
+// bytes, when the peak occurred, how many allocations were live at the peak,
+// and the live bytes at the peak broken down by label and by heap. The
+// difference between the requested and allocated bytes is reported as the
+// padding overhead of the underlying allocator. The raw timeline can also be
+// formatted as CSV for plotting.
+//
+// Only allocations made through this allocator are recorded: imported buffers
+// are routed directly to the underlying allocator. When used with caching the
+// recording allocator should be placed above the caching allocator to record
+// what the program requests and below it to record what the device provides.
+//
+// Thread-safe: the allocator can be shared across multiple user-level devices
+// manipulated from multiple threads. Events are retained until the allocator
+// is destroyed and memory use grows with the number of allocations made.
+typedef struct iree_hal_recording_allocator_t iree_hal_recording_allocator_t;
+
+// Callback issued when the allocator is being destroyed. All buffers made from
+// the allocator have been deallocated and the complete timeline can be
+// formatted from |allocator| during the callback.
+typedef struct iree_hal_recording_allocator_complete_callback_t {
+  void(IREE_API_PTR* fn)(void* user_data, iree_hal_allocator_t* allocator);
+  void* user_data;
+} iree_hal_recording_allocator_complete_callback_t;
+
+// Parameters used to configure an iree_hal_recording_allocator_t.
+typedef struct iree_hal_recording_allocator_params_t {
+  // Label attributed to allocations until a new label is set with
+  // iree_hal_recording_allocator_set_label. Defaults to "unlabeled" if empty.
+  iree_string_view_t initial_label;
+
+  // Optional callback issued when the allocator is destroyed.
+  iree_hal_recording_allocator_complete_callback_t complete_callback;
+} iree_hal_recording_allocator_params_t;
+
+// Initializes |out_params| to the default values.
+void iree_hal_recording_allocator_params_initialize(
+    iree_hal_recording_allocator_params_t* out_params);
+
+// Creates an allocator that records the allocations made from
+// |device_allocator|. |params| and the label are copied.
+//
+// Buffer import and export and other operations that the recording allocator
+// does not track are directed to the underlying |device_allocator|.
+iree_status_t iree_hal_recording_allocator_create(
+    const iree_hal_recording_allocator_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator);
+
+// Sets the |label| attributed to subsequent allocations made from |allocator|.
+// The label is copied.
+iree_status_t iree_hal_recording_allocator_set_label(
+    iree_hal_allocator_t* allocator, iree_string_view_t label);
+
+// Appends a human-readable report of the peak memory use recorded so far by
+// |allocator| to |builder|.
+iree_status_t iree_hal_recording_allocator_format_report(
+    iree_hal_allocator_t* allocator, iree_string_builder_t* builder);
+
+// Appends the events recorded so far by |allocator| to |builder| as CSV with
+// one row per allocation or free in the order they were made.
+iree_status_t iree_hal_recording_allocator_format_timeline(
+    iree_hal_allocator_t* allocator, iree_string_builder_t* builder);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_RECORDING_ALLOCATOR_H_
@@ -0,0 +1,122 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/recording_allocator.h"
+
+#include <algorithm>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::MatchesRegex;
+
+class RecordingAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &heap_allocator_));
+    iree_hal_recording_allocator_params_t params;
+    iree_hal_recording_allocator_params_initialize(&params);
+    params.initial_label = IREE_SV("load");
+    params.complete_callback.fn = OnComplete;
+    params.complete_callback.user_data = &completed_report_;
+    IREE_ASSERT_OK(iree_hal_recording_allocator_create(
+        &params, heap_allocator_, iree_allocator_system(), &allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(heap_allocator_);
+  }
+
+  iree_hal_buffer_t* Allocate(iree_device_size_t size) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator_, params, size, iree_const_byte_span_empty(), &buffer));
+    return buffer;
+  }
+
+  static std::string Format(
+      iree_status_t (*format)(iree_hal_allocator_t*, iree_string_builder_t*),
+      iree_hal_allocator_t* allocator) {
+    iree_string_builder_t builder;
+    iree_string_builder_initialize(iree_allocator_system(), &builder);
+    IREE_CHECK_OK(format(allocator, &builder));
+    std::string result(iree_string_builder_buffer(&builder),
+                       iree_string_builder_size(&builder));
+    iree_string_builder_deinitialize(&builder);
+    return result;
+  }
+
+  static void OnComplete(void* user_data, iree_hal_allocator_t* allocator) {
+    *reinterpret_cast<std::string*>(user_data) =
+        Format(iree_hal_recording_allocator_format_report, allocator);
+  }
+
+  iree_hal_allocator_t* heap_allocator_ = nullptr;
+  iree_hal_allocator_t* allocator_ = nullptr;
+  std::string completed_report_;
+};
+
+// The peak is attributed to the labels that were current when each buffer
+// live at the peak was allocated.
+TEST_F(RecordingAllocatorTest, AttributesPeakToLabels) {
+  iree_hal_buffer_t* weights = Allocate(3000);
+  IREE_ASSERT_OK(
+      iree_hal_recording_allocator_set_label(allocator_, IREE_SV("main")));
+  iree_hal_buffer_t* transient = Allocate(1000);
+  iree_hal_buffer_release(transient);
+  iree_hal_buffer_t* result = Allocate(500);
+
+  std::string report =
+      Format(iree_hal_recording_allocator_format_report, allocator_);
+  EXPECT_THAT(report, HasSubstr("3 allocations"));
+  EXPECT_THAT(report, MatchesRegex("(.|\n)*PEAK: +4000 bytes in 2 (.|\n)*"));
+  EXPECT_THAT(report, MatchesRegex("(.|\n)*by label:\n +3000 bytes .* load\n"
+                                   " +1000 bytes .* main\n(.|\n)*"));
+
+  iree_hal_buffer_release(result);
+  iree_hal_buffer_release(weights);
+}
+
+// Each allocation and free is a row in the timeline with the running total.
+TEST_F(RecordingAllocatorTest, FormatsTimeline) {
+  iree_hal_buffer_t* a = Allocate(100);
+  iree_hal_buffer_t* b = Allocate(200);
+  iree_hal_buffer_release(a);
+  iree_hal_buffer_release(b);
+
+  std::string timeline =
+      Format(iree_hal_recording_allocator_format_timeline, allocator_);
+  EXPECT_EQ(std::count(timeline.begin(), timeline.end(), '\n'), 5);
+  EXPECT_THAT(timeline, HasSubstr(",alloc,\"load\","));
+  EXPECT_THAT(timeline, MatchesRegex("(.|\n)*,free,.*,0\n"));
+}
+
+// The completion callback sees all frees made before destruction.
+TEST_F(RecordingAllocatorTest, ReportsOnDestroy) {
+  iree_hal_buffer_t* buffer = Allocate(100);
+  iree_hal_buffer_release(buffer);
+  iree_hal_allocator_release(allocator_);
+  allocator_ = nullptr;
+  EXPECT_THAT(completed_report_, HasSubstr("0 live"));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -219,15 +219,18 @@ static iree_status_t iree_hal_resource_set_insert_retain(
 //   https://github.com/simd-everywhere/simde/blob/master/simde/arm/neon/ceq.h#L591
 static iree_status_t iree_hal_resource_set_insert_1(
     iree_hal_resource_set_t* set, iree_hal_resource_t* resource) {
-  // Scan and hope for a hit.
+  // Scan and hope for a hit. Pinned resources at the head of the MRU are
+  // always hits and never reordered.
+  const iree_host_size_t pinned_count = set->pinned_count;
   for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(set->mru); ++i) {
     if (set->mru[i] != resource) continue;
     // Hit - keep the list sorted by most->least recently used.
-    // We shift the MRU down to make room at index 0 and store the
+    // We shift the MRU down to make room at the head and store the
     // resource there.
-    if (i > 0) {
-      memmove(&set->mru[1], &set->mru[0], sizeof(set->mru[0]) * i);
-      set->mru[0] = resource;
+    if (i > pinned_count) {
+      memmove(&set->mru[pinned_count + 1], &set->mru[pinned_count],
+              sizeof(set->mru[0]) * (i - pinned_count));
+      set->mru[pinned_count] = resource;
     }
     return iree_ok_status();
   }
@@ -238,9 +241,9 @@ static iree_status_t iree_hal_resource_set_insert_1(
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, resource));
 
   // Shift the MRU down and insert the new item at the head.
-  memmove(&set->mru[1], &set->mru[0],
-          sizeof(set->mru[0]) * (IREE_ARRAYSIZE(set->mru) - 1));
-  set->mru[0] = resource;
+  memmove(&set->mru[pinned_count + 1], &set->mru[pinned_count],
+          sizeof(set->mru[0]) * (IREE_ARRAYSIZE(set->mru) - pinned_count - 1));
+  set->mru[pinned_count] = resource;
 
   return iree_ok_status();
 }
@@ -248,16 +251,56 @@ static iree_status_t iree_hal_resource_set_insert_1(
 IREE_API_EXPORT iree_status_t
 iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                              iree_host_size_t count, const void* resources) {
-  // For now we process one at a time. We should have a stride that lets us
-  // amortize the cost of doing the MRU update and insertion allocation by
-  // say slicing off 4/8/16/32 resources at a time etc. Today each miss that
-  // requires a full insertion goes down the whole path of checking chunk
-  // capacity and such.
+  return iree_hal_resource_set_insert_strided(set, count, resources,
+                                              sizeof(iree_hal_resource_t*));
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_strided(
+    iree_hal_resource_set_t* set, iree_host_size_t count,
+    const void* first_resource, iree_host_size_t stride) {
+  // For now we process one at a time. We should slice off 4/8/16/32 resources
+  // at a time to amortize the cost of doing the MRU update and insertion
+  // allocation. Today each miss that requires a full insertion goes down the
+  // whole path of checking chunk capacity and such.
+  const uint8_t* resource_ptr = (const uint8_t*)first_resource;
+  for (iree_host_size_t i = 0; i < count; ++i, resource_ptr += stride) {
+    iree_hal_resource_t* resource = *(iree_hal_resource_t* const*)resource_ptr;
+    if (!resource) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_1(set, resource));
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_resource_set_pin(iree_hal_resource_set_t* set, iree_host_size_t count,
+                          const void* resources) {
   iree_hal_resource_t* const* typed_resources =
       (iree_hal_resource_t* const*)resources;
   for (iree_host_size_t i = 0; i < count; ++i) {
-    IREE_RETURN_IF_ERROR(
-        iree_hal_resource_set_insert_1(set, typed_resources[i]));
+    iree_hal_resource_t* resource = typed_resources[i];
+    if (!resource) continue;
+
+    // Find the resource in the MRU in case it has already been inserted. If
+    // already retained by the set it doesn't hurt to pin it as well.
+    iree_host_size_t mru_index = 0;
+    for (; mru_index < IREE_ARRAYSIZE(set->mru); ++mru_index) {
+      if (set->mru[mru_index] == resource) break;
+    }
+    if (mru_index < set->pinned_count) continue;  // already pinned
+
+    if (set->pinned_count >= IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT) {
+      // Out of pinning space; fall back to retaining it.
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_1(set, resource));
+      continue;
+    }
+
+    // Shift the MRU down (dropping either the existing entry or the tail) and
+    // append the resource to the pinned prefix.
+    iree_host_size_t shift_end =
+        iree_min(mru_index, IREE_ARRAYSIZE(set->mru) - 1);
+    memmove(&set->mru[set->pinned_count + 1], &set->mru[set->pinned_count],
+            sizeof(set->mru[0]) * (shift_end - set->pinned_count));
+    set->mru[set->pinned_count++] = resource;
   }
   return iree_ok_status();
 }
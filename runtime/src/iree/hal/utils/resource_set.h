@@ -66,6 +66,12 @@ typedef struct iree_hal_resource_set_chunk_t {
 #define IREE_HAL_RESOURCE_SET_MRU_SIZE \
   (iree_hardware_constructive_interference_size / sizeof(uintptr_t))
 
+// Maximum number of resources that can be pinned in a set.
+// Pinned resources occupy the head of the MRU and we always want to leave some
+// room for the MRU to deduplicate everything else.
+#define IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT \
+  (IREE_HAL_RESOURCE_SET_MRU_SIZE / 2)
+
 // "Efficient" append-only set for retaining a set of resources.
 // This is a non-deterministic data structure that tries to reduce the amount of
 // overhead involved in tracking a reasonably-sized set of resources (~dozens to
@@ -104,8 +110,14 @@ typedef struct iree_hal_resource_set_t {
   //
   // TODO(benvanik): ensure alignment on the set - should be at
   // iree_hardware_constructive_interference_size.
+  //
+  // The first |pinned_count| entries are pinned resources that are never
+  // evicted or reordered and the remainder is the MRU proper.
   iree_hal_resource_t* mru[IREE_HAL_RESOURCE_SET_MRU_SIZE];
 
+  // Number of pinned resources at the head of |mru|.
+  iree_host_size_t pinned_count;
+
   // Block pool used for allocating additional set storage slabs.
   iree_arena_block_pool_t* block_pool;
 
@@ -133,6 +145,31 @@ IREE_API_EXPORT iree_status_t
 iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                              iree_host_size_t count, const void* resources);
 
+// Inserts |count| resources whose pointers are stored |stride| bytes apart
+// starting at |first_resource|. NULL resources are ignored.
+// This allows resources embedded in other structures such as descriptor set
+// bindings to be inserted in a single call without first gathering them.
+//
+// Example:
+//   iree_hal_resource_set_insert_strided(set, binding_count,
+//                                        &bindings[0].buffer,
+//                                        sizeof(bindings[0]));
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_strided(
+    iree_hal_resource_set_t* set, iree_host_size_t count,
+    const void* first_resource, iree_host_size_t stride);
+
+// Pins zero or more resources in the set such that subsequent insertions of
+// them are always elided without being retained or released.
+// Up to IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT resources can be pinned and any
+// beyond that are inserted normally.
+//
+// **WARNING**: pinned resources are not retained by the set. The caller must
+// ensure they remain live for at least the lifetime of the set, such as when
+// the owner of the set (like a command buffer) already retains them.
+IREE_API_EXPORT iree_status_t
+iree_hal_resource_set_pin(iree_hal_resource_set_t* set, iree_host_size_t count,
+                          const void* resources);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
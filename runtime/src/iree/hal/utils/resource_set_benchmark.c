@@ -203,6 +203,128 @@ static iree_status_t iree_hal_resource_set_benchmark_randomized_n(
   return iree_ok_status();
 }
 
+// Tests strided insertion of resources embedded in binding structures as
+// command buffers do when pushing descriptor sets. Every 4th binding is NULL
+// (as with indirect bindings) and the rest cycle through a small pool.
+//
+// user_data is a count of bindings to insert each iteration.
+static iree_status_t iree_hal_resource_set_benchmark_insert_strided_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  // Initialize the block pool we'll be serving from.
+  // Sized like we usually do it in the runtime for ~512-1024 elements.
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, host_allocator, &block_pool);
+
+  iree_hal_resource_set_t* set = NULL;
+  IREE_CHECK_OK(iree_hal_resource_set_allocate(&block_pool, &set));
+
+  // Resources referenced by the bindings.
+  iree_hal_resource_t* resources[6] = {NULL};
+  for (uint32_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_CHECK_OK(iree_hal_test_resource_create(host_allocator, &resources[i]));
+  }
+
+  // Bindings laid out like iree_hal_descriptor_set_binding_t.
+  typedef struct {
+    uint32_t binding;
+    uint32_t buffer_slot;
+    iree_hal_resource_t* buffer;
+    uint64_t offset;
+    uint64_t length;
+  } binding_t;
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  binding_t* bindings = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator, sizeof(*bindings) * count,
+                                      (void**)&bindings));
+  for (uint32_t i = 0; i < count; ++i) {
+    bindings[i].binding = i;
+    bindings[i].buffer_slot = 0;
+    bindings[i].buffer =
+        (i % 4) == 3 ? NULL : resources[i % IREE_ARRAYSIZE(resources)];
+    bindings[i].offset = 0;
+    bindings[i].length = 0;
+  }
+
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    IREE_CHECK_OK(iree_hal_resource_set_insert_strided(
+        set, count, &bindings[0].buffer, sizeof(bindings[0])));
+  }
+
+  // Cleanup.
+  iree_hal_resource_set_free(set);
+  for (uint32_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  iree_allocator_free(host_allocator, bindings);
+  iree_arena_block_pool_deinitialize(&block_pool);
+
+  return iree_ok_status();
+}
+
+// Tests randomized insertion when some of the resources in the pool are
+// pinned for the lifetime of the set. Compare against randomized_n to see how
+// much retain/release traffic is avoided once the MRU starts to miss.
+//
+// user_data is a count of unique element pool to insert N times. The first
+// IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT elements are pinned.
+static iree_status_t iree_hal_resource_set_benchmark_pinned_randomized_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  // Initialize the block pool we'll be serving from.
+  // Sized like we usually do it in the runtime for ~512-1024 elements.
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, host_allocator, &block_pool);
+
+  // Allocate the resources we'll be using - we keep them live so that we are
+  // measuring just the retain/release and set times instead of the timing of
+  // resource creation/deletion.
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_hal_resource_t** resources = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                      sizeof(iree_hal_resource_t*) * count,
+                                      (void**)&resources));
+  for (uint32_t i = 0; i < count; ++i) {
+    IREE_CHECK_OK(iree_hal_test_resource_create(host_allocator, &resources[i]));
+  }
+
+  // Pin the head of the pool; these outlive the set.
+  iree_hal_resource_set_t* set = NULL;
+  IREE_CHECK_OK(iree_hal_resource_set_allocate(&block_pool, &set));
+  IREE_CHECK_OK(iree_hal_resource_set_pin(
+      set, iree_min(count, IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT),
+      resources));
+
+  // The PRNG we use to select the elements.
+  iree_prng_xoroshiro128_state_t prng = {0};
+  iree_prng_xoroshiro128_initialize(123ull, &prng);
+
+  // Insert N random resources into the set. To hide some of the overhead we do
+  // multiple insertions in each loop.
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/256)) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t resource_idx =
+          iree_prng_xoroshiro128plus_next_uint32(&prng) % count;
+      iree_hal_resource_t* resource = resources[resource_idx];
+      IREE_CHECK_OK(iree_hal_resource_set_insert(set, 1, &resource));
+    }
+  }
+
+  // Cleanup.
+  iree_hal_resource_set_free(set);
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  iree_allocator_free(host_allocator, resources);
+  iree_arena_block_pool_deinitialize(&block_pool);
+
+  return iree_ok_status();
+}
+
 int main(int argc, char** argv) {
   iree_benchmark_initialize(&argc, argv);
 
@@ -282,6 +404,48 @@ int main(int argc, char** argv) {
                             &benchmark_def);
   }
 
+  // iree_hal_resource_set_benchmark_insert_strided_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_resource_set_benchmark_insert_strided_n,
+    };
+    benchmark_def.user_data = (void*)4u;
+    iree_benchmark_register(iree_make_cstring_view("insert_strided_4"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("insert_strided_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("insert_strided_64"),
+                            &benchmark_def);
+  }
+
+  // iree_hal_resource_set_benchmark_pinned_randomized_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_resource_set_benchmark_pinned_randomized_n,
+    };
+    benchmark_def.user_data = (void*)8u;
+    iree_benchmark_register(iree_make_cstring_view("pinned_randomized_8"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)32u;
+    iree_benchmark_register(iree_make_cstring_view("pinned_randomized_32"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("pinned_randomized_256"),
+                            &benchmark_def);
+  }
+
   iree_benchmark_run_specified();
   return 0;
 }
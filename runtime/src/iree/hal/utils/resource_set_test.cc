@@ -252,6 +252,116 @@ TEST_F(ResourceSetTest, RedundantInsertion) {
   EXPECT_EQ(live_bitmap, 0u);
 }
 
+// Tests inserting resources embedded in other structures with NULLs skipped.
+TEST_F(ResourceSetTest, InsertStrided) {
+  auto resource_set = make_resource_set(&block_pool);
+
+  struct binding_t {
+    uint32_t ordinal;
+    iree_hal_resource_t* resource;
+  } bindings[4] = {{0}};
+  uint32_t live_bitmap = 0u;
+  IREE_ASSERT_OK(iree_hal_test_resource_create(0, &live_bitmap, host_allocator,
+                                               &bindings[0].resource));
+  IREE_ASSERT_OK(iree_hal_test_resource_create(1, &live_bitmap, host_allocator,
+                                               &bindings[2].resource));
+  bindings[3].resource = bindings[0].resource;
+  EXPECT_EQ(live_bitmap, 0x3u);
+
+  IREE_ASSERT_OK(iree_hal_resource_set_insert_strided(
+      resource_set.get(), IREE_ARRAYSIZE(bindings), &bindings[0].resource,
+      sizeof(bindings[0])));
+  // The redundant insertion of bindings[3] moves it back to the MRU head.
+  EXPECT_EQ(resource_set->mru[0], bindings[0].resource);
+  EXPECT_EQ(resource_set->mru[1], bindings[2].resource);
+  EXPECT_EQ(resource_set->mru[2], nullptr);
+  iree_hal_resource_release(bindings[0].resource);
+  iree_hal_resource_release(bindings[2].resource);
+  EXPECT_EQ(live_bitmap, 0x3u);
+
+  // Ensure the set releases the resources.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+}
+
+// Tests that pinned resources stay at the head of the MRU and are not retained.
+TEST_F(ResourceSetTest, Pin) {
+  auto resource_set = make_resource_set(&block_pool);
+
+  iree_hal_resource_t* resources[32] = {NULL};
+  uint32_t live_bitmap = 0u;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(
+        i, &live_bitmap, host_allocator, &resources[i]));
+  }
+
+  // Pin 0 and then insert everything, MRU should contain:
+  //   0 | 31 30 29 ...
+  IREE_ASSERT_OK(iree_hal_resource_set_pin(resource_set.get(), 1, resources));
+  IREE_ASSERT_OK(iree_hal_resource_set_insert(
+      resource_set.get(), IREE_ARRAYSIZE(resources), resources));
+  EXPECT_EQ(resource_set->pinned_count, 1);
+  EXPECT_EQ(resource_set->mru[0], resources[0]);
+  EXPECT_EQ(resource_set->mru[1], resources[31]);
+  EXPECT_EQ(resource_set->mru[2], resources[30]);
+
+  // Hitting a non-pinned resource moves it behind the pinned ones:
+  //   0 | 30 31 29 ...
+  IREE_ASSERT_OK(
+      iree_hal_resource_set_insert(resource_set.get(), 1, &resources[30]));
+  EXPECT_EQ(resource_set->mru[0], resources[0]);
+  EXPECT_EQ(resource_set->mru[1], resources[30]);
+  EXPECT_EQ(resource_set->mru[2], resources[31]);
+
+  // Pinning an MRU entry removes it from the MRU proper:
+  //   0 31 | 30 29 ...
+  IREE_ASSERT_OK(
+      iree_hal_resource_set_pin(resource_set.get(), 1, &resources[31]));
+  EXPECT_EQ(resource_set->pinned_count, 2);
+  EXPECT_EQ(resource_set->mru[0], resources[0]);
+  EXPECT_EQ(resource_set->mru[1], resources[31]);
+  EXPECT_EQ(resource_set->mru[2], resources[30]);
+  EXPECT_EQ(resource_set->mru[3], resources[29]);
+
+  // The pinned resource 0 was never retained by the set and is destroyed when
+  // we drop our reference. Everything else (including 31, which was inserted
+  // before it was pinned) remains live.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  EXPECT_EQ(live_bitmap, 0xFFFFFFFEu);
+
+  // Ensure the set releases the resources.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+}
+
+// Tests that pinning more than the maximum falls back to retaining.
+TEST_F(ResourceSetTest, PinOverflow) {
+  auto resource_set = make_resource_set(&block_pool);
+
+  iree_hal_resource_t* resources[IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT + 1] = {
+      NULL};
+  uint32_t live_bitmap = 0u;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(
+        i, &live_bitmap, host_allocator, &resources[i]));
+  }
+
+  // All but the last resource are pinned and the last is retained.
+  IREE_ASSERT_OK(iree_hal_resource_set_pin(
+      resource_set.get(), IREE_ARRAYSIZE(resources), resources));
+  EXPECT_EQ(resource_set->pinned_count, IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  EXPECT_EQ(live_bitmap, 1u << IREE_HAL_RESOURCE_SET_MAX_PINNED_COUNT);
+
+  // Ensure the set releases the retained resource.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -305,3 +305,160 @@ IREE_API_EXPORT void iree_hal_semaphore_poll(iree_hal_semaphore_t* semaphore) {
 
   IREE_TRACE_ZONE_END(z0);
 }
+
+//===----------------------------------------------------------------------===//
+// iree_hal_semaphore_multi_wait
+//===----------------------------------------------------------------------===//
+
+// Number of timepoints stored on the stack before spilling to the heap.
+#define IREE_HAL_SEMAPHORE_MULTI_WAIT_INLINE_CAPACITY 8
+
+// State shared by all timepoints of a multi-wait.
+typedef struct iree_hal_semaphore_multi_wait_state_t {
+  // Posted by timepoint callbacks when the wait may have resolved.
+  iree_notification_t notification;
+  // Number of timepoints that must be reached for the wait to resolve.
+  iree_atomic_int32_t pending_count;
+  // First failure status code reported by a timepoint callback, if any.
+  iree_atomic_int32_t status_code;
+} iree_hal_semaphore_multi_wait_state_t;
+
+static iree_status_t iree_hal_semaphore_multi_wait_callback(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  iree_hal_semaphore_multi_wait_state_t* state =
+      (iree_hal_semaphore_multi_wait_state_t*)user_data;
+  if (status_code == IREE_STATUS_OK) {
+    // Only wake the waiter once the last pending timepoint has been reached.
+    if (iree_atomic_fetch_sub_int32(&state->pending_count, 1,
+                                    iree_memory_order_acq_rel) > 1) {
+      return iree_ok_status();
+    }
+  } else {
+    int32_t expected = IREE_STATUS_OK;
+    iree_atomic_compare_exchange_strong_int32(
+        &state->status_code, &expected, (int32_t)status_code,
+        iree_memory_order_acq_rel, iree_memory_order_relaxed);
+  }
+  iree_notification_post(&state->notification, IREE_ALL_WAITERS);
+  return iree_ok_status();
+}
+
+static bool iree_hal_semaphore_multi_wait_is_resolved(
+    iree_hal_semaphore_multi_wait_state_t* state) {
+  return iree_atomic_load_int32(&state->pending_count,
+                                iree_memory_order_acquire) <= 0 ||
+         iree_atomic_load_int32(&state->status_code,
+                                iree_memory_order_acquire) != IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_multi_wait(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
+    iree_duration_t spin_ns, iree_allocator_t host_allocator) {
+  if (semaphore_list.count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)semaphore_list.count);
+
+  // Fast path: poll all semaphores without acquiring any timepoints. When
+  // fanning in many fences most have usually been reached by the time the wait
+  // is made.
+  iree_host_size_t unsatisfied_count = 0;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    uint64_t current_value = 0;
+    iree_status_t query_status =
+        iree_hal_semaphore_query(semaphore_list.semaphores[i], &current_value);
+    if (!iree_status_is_ok(query_status)) {
+      iree_status_ignore(query_status);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_status_from_code(IREE_STATUS_ABORTED);
+    }
+    if (current_value < semaphore_list.payload_values[i]) {
+      ++unsatisfied_count;
+    } else if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+  }
+  if (unsatisfied_count == 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  } else if (iree_timeout_is_immediate(timeout)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  // Timepoints are acquired on all semaphores (even those that were satisfied
+  // above) so that the pending count is known before any callback is made.
+  iree_hal_semaphore_timepoint_t
+      inline_timepoints[IREE_HAL_SEMAPHORE_MULTI_WAIT_INLINE_CAPACITY];
+  iree_hal_semaphore_timepoint_t* timepoints = inline_timepoints;
+  if (semaphore_list.count > IREE_ARRAYSIZE(inline_timepoints)) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(host_allocator,
+                                  semaphore_list.count * sizeof(timepoints[0]),
+                                  (void**)&timepoints));
+  }
+
+  iree_hal_semaphore_multi_wait_state_t state;
+  iree_notification_initialize(&state.notification);
+  iree_atomic_store_int32(&state.pending_count,
+                          wait_mode == IREE_HAL_WAIT_MODE_ANY
+                              ? 1
+                              : (int32_t)semaphore_list.count,
+                          iree_memory_order_release);
+  iree_atomic_store_int32(&state.status_code, IREE_STATUS_OK,
+                          iree_memory_order_release);
+  const iree_hal_semaphore_callback_t callback = {
+      .fn = iree_hal_semaphore_multi_wait_callback,
+      .user_data = &state,
+  };
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_semaphore_acquire_timepoint(
+        semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+        timeout, callback, &timepoints[i]);
+    // Flush timepoints in case the semaphore was signaled after it was queried
+    // above but before the timepoint was acquired.
+    iree_hal_semaphore_poll(semaphore_list.semaphores[i]);
+  }
+
+  // Spin and then block until all (or any) timepoints resolve.
+  bool is_resolved = iree_hal_semaphore_multi_wait_is_resolved(&state);
+  while (!is_resolved) {
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&state.notification);
+    if (iree_hal_semaphore_multi_wait_is_resolved(&state)) {
+      iree_notification_cancel_wait(&state.notification);
+      is_resolved = true;
+      break;
+    }
+    const bool did_notify = iree_notification_commit_wait(
+        &state.notification, wait_token, spin_ns, deadline_ns);
+    is_resolved = iree_hal_semaphore_multi_wait_is_resolved(&state);
+    if (!did_notify) break;
+  }
+
+  // Cancel all outstanding timepoints. Cancellation synchronizes with any
+  // callback that may be running on another thread so after this the state is
+  // no longer referenced.
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_semaphore_cancel_timepoint(semaphore_list.semaphores[i],
+                                        &timepoints[i]);
+  }
+  iree_notification_deinitialize(&state.notification);
+  if (timepoints != inline_timepoints) {
+    iree_allocator_free(host_allocator, timepoints);
+  }
+
+  iree_status_code_t status_code = (iree_status_code_t)iree_atomic_load_int32(
+      &state.status_code, iree_memory_order_acquire);
+  iree_status_t status = iree_ok_status();
+  if (status_code == IREE_STATUS_DEADLINE_EXCEEDED || !is_resolved) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  } else if (status_code != IREE_STATUS_OK) {
+    status = iree_status_from_code(IREE_STATUS_ABORTED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -173,6 +173,31 @@ IREE_API_EXPORT void iree_hal_semaphore_notify(
 // Must not be called from a timepoint callback.
 IREE_API_EXPORT void iree_hal_semaphore_poll(iree_hal_semaphore_t* semaphore);
 
+// Waits until any or all of the semaphores in |semaphore_list| reach their
+// payload values (or one fails) using timepoints that share a single
+// notification. Unlike waiting on each semaphore in turn or acquiring one
+// system wait handle per semaphore this uses one wake regardless of the number
+// of semaphores.
+//
+// Semaphores are polled first so that waits on already satisfied semaphores
+// return without acquiring any timepoints. The wait spins for up to |spin_ns|
+// before blocking to avoid the cost of sleeping for waits that are expected to
+// be short. Storage for timepoints beyond a small inline count is allocated
+// from |host_allocator| for the duration of the call.
+//
+// Requires all semaphores to be implemented with this base type and to call
+// iree_hal_semaphore_notify on every signal or failure.
+//
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
+// |timeout| elapses and IREE_STATUS_ABORTED if a semaphore failed; callers can
+// query the semaphores to get the full failure status.
+//
+// Must not be called from a timepoint callback.
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_multi_wait(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
+    iree_duration_t spin_ns, iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -374,6 +374,123 @@ TEST_F(TrackingSemaphoreTest, CancelResolvedTimepoint) {
   iree_hal_semaphore_release(*semaphore);
 }
 
+struct MultiWaitTest : public ::testing::Test {
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  void SetUp() override {
+    for (int i = 0; i < kSemaphoreCount; ++i) {
+      semaphores[i] = TestSemaphore::Create(0ull, host_allocator);
+      raw_semaphores[i] = *semaphores[i];
+      payload_values[i] = 1ull;
+    }
+  }
+
+  void TearDown() override {
+    for (int i = 0; i < kSemaphoreCount; ++i) {
+      iree_hal_semaphore_release(*semaphores[i]);
+    }
+  }
+
+  // Returns a list of |count| semaphores starting at |first|.
+  iree_hal_semaphore_list_t List(int count, int first = 0) {
+    iree_hal_semaphore_list_t list;
+    list.count = count;
+    list.semaphores = &raw_semaphores[first];
+    list.payload_values = &payload_values[first];
+    return list;
+  }
+
+  iree_status_t Wait(iree_hal_wait_mode_t wait_mode, int count,
+                     iree_timeout_t timeout, int first = 0) {
+    return iree_hal_semaphore_multi_wait(wait_mode, List(count, first),
+                                         timeout, /*spin_ns=*/0,
+                                         host_allocator);
+  }
+
+  // More than the inline timepoint capacity to exercise heap storage.
+  static constexpr int kSemaphoreCount = 24;
+  TestSemaphore* semaphores[kSemaphoreCount];
+  iree_hal_semaphore_t* raw_semaphores[kSemaphoreCount];
+  uint64_t payload_values[kSemaphoreCount];
+};
+
+// Tests that waits on already satisfied semaphores return immediately.
+TEST_F(MultiWaitTest, AlreadySatisfied) {
+  for (int i = 0; i < kSemaphoreCount; ++i) {
+    IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphores[i], 1ull));
+  }
+  IREE_EXPECT_OK(Wait(IREE_HAL_WAIT_MODE_ALL, kSemaphoreCount,
+                      iree_immediate_timeout()));
+  IREE_EXPECT_OK(Wait(IREE_HAL_WAIT_MODE_ANY, kSemaphoreCount,
+                      iree_immediate_timeout()));
+}
+
+// Tests that unsatisfied waits time out.
+TEST_F(MultiWaitTest, Timeout) {
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphores[0], 1ull));
+  EXPECT_THAT(Status(Wait(IREE_HAL_WAIT_MODE_ALL, 2, iree_immediate_timeout())),
+              StatusIs(StatusCode::kDeadlineExceeded));
+  EXPECT_THAT(
+      Status(Wait(IREE_HAL_WAIT_MODE_ALL, 2, iree_make_timeout_ms(10))),
+      StatusIs(StatusCode::kDeadlineExceeded));
+  EXPECT_THAT(Status(Wait(IREE_HAL_WAIT_MODE_ANY, kSemaphoreCount - 1,
+                          iree_make_timeout_ms(1), /*first=*/1)),
+              StatusIs(StatusCode::kDeadlineExceeded));
+}
+
+// Tests that wait-any resolves when just one semaphore is signaled.
+TEST_F(MultiWaitTest, WaitAny) {
+  std::thread thread([&]() {
+    IREE_ASSERT_OK(
+        iree_hal_semaphore_signal(*semaphores[kSemaphoreCount - 1], 1ull));
+  });
+  IREE_EXPECT_OK(Wait(IREE_HAL_WAIT_MODE_ANY, kSemaphoreCount,
+                      iree_infinite_timeout()));
+  thread.join();
+}
+
+// Tests that wait-all resolves only once all semaphores are signaled.
+TEST_F(MultiWaitTest, WaitAll) {
+  std::thread thread([&]() {
+    for (int i = kSemaphoreCount - 1; i >= 0; --i) {
+      IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphores[i], 1ull));
+    }
+  });
+  IREE_EXPECT_OK(Wait(IREE_HAL_WAIT_MODE_ALL, kSemaphoreCount,
+                      iree_infinite_timeout()));
+  for (int i = 0; i < kSemaphoreCount; ++i) {
+    uint64_t value = 0;
+    IREE_ASSERT_OK(iree_hal_semaphore_query(*semaphores[i], &value));
+    EXPECT_EQ(value, 1ull);
+  }
+  thread.join();
+}
+
+// Tests that spinning waits resolve the same as blocking ones.
+TEST_F(MultiWaitTest, WaitAllSpin) {
+  std::thread thread([&]() {
+    for (int i = 0; i < kSemaphoreCount; ++i) {
+      IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphores[i], 1ull));
+    }
+  });
+  IREE_EXPECT_OK(iree_hal_semaphore_multi_wait(
+      IREE_HAL_WAIT_MODE_ALL, List(kSemaphoreCount), iree_infinite_timeout(),
+      /*spin_ns=*/1000 * 1000, host_allocator));
+  thread.join();
+}
+
+// Tests that a failure of any semaphore aborts the wait.
+TEST_F(MultiWaitTest, Failure) {
+  std::thread thread([&]() {
+    iree_hal_semaphore_fail(*semaphores[3],
+                            iree_make_status(IREE_STATUS_DATA_LOSS, "whoops"));
+  });
+  EXPECT_THAT(Status(Wait(IREE_HAL_WAIT_MODE_ALL, kSemaphoreCount,
+                          iree_infinite_timeout())),
+              StatusIs(StatusCode::kAborted));
+  thread.join();
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
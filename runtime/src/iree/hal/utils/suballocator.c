@@ -0,0 +1,502 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/suballocator.h"
+
+#include "iree/base/internal/math.h"
+#include "iree/base/tracing.h"
+
+// Default size of each backing block.
+#define IREE_HAL_SUBALLOCATOR_DEFAULT_BLOCK_SIZE (64 * 1024 * 1024)
+
+// Default alignment of each range.
+#define IREE_HAL_SUBALLOCATOR_DEFAULT_ALIGNMENT 256
+
+struct iree_hal_suballocator_block_t {
+  // Owning suballocator.
+  iree_hal_suballocator_t* suballocator;
+  // Neighbors in the suballocator block list.
+  iree_hal_suballocator_block_t* prev;
+  iree_hal_suballocator_block_t* next;
+  // User data returned by the block allocator.
+  void* user_data;
+  // Total size of the block in bytes.
+  iree_device_size_t size;
+  // Number of allocated ranges within the block.
+  iree_host_size_t live_count;
+  // Range at offset 0. Coalescing always retains the lower range so this node
+  // lives as long as the block and spans the whole block when it is unused.
+  iree_hal_suballocator_range_t* head_range;
+};
+
+struct iree_hal_suballocator_range_t {
+  // Block the range is within.
+  iree_hal_suballocator_block_t* block;
+  // Byte offset and length of the range within the block.
+  iree_device_size_t offset;
+  iree_device_size_t length;
+  // Physically adjacent ranges within the block in address order.
+  iree_hal_suballocator_range_t* phys_prev;
+  iree_hal_suballocator_range_t* phys_next;
+  // Neighbors in the free list of the range size class when free or the
+  // unused node list when not in use.
+  iree_hal_suballocator_range_t* free_prev;
+  iree_hal_suballocator_range_t* free_next;
+  // True if the range is available for allocation.
+  bool is_free;
+};
+
+void iree_hal_suballocator_params_initialize(
+    iree_hal_suballocator_params_t* out_params) {
+  IREE_ASSERT_ARGUMENT(out_params);
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->block_size = IREE_HAL_SUBALLOCATOR_DEFAULT_BLOCK_SIZE;
+  out_params->alignment = IREE_HAL_SUBALLOCATOR_DEFAULT_ALIGNMENT;
+  out_params->max_free_block_count = 1;
+}
+
+iree_status_t iree_hal_suballocator_initialize(
+    const iree_hal_suballocator_params_t* params,
+    iree_hal_suballocator_block_allocator_t block_allocator,
+    iree_allocator_t host_allocator,
+    iree_hal_suballocator_t* out_suballocator) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_suballocator);
+  if (params->alignment == 0 ||
+      (params->alignment & (params->alignment - 1)) != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "alignment must be a power of two");
+  }
+  if (params->block_size < params->alignment) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "block size must be at least the alignment");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  memset(out_suballocator, 0, sizeof(*out_suballocator));
+  out_suballocator->params = *params;
+  out_suballocator->params.block_size =
+      iree_device_align(params->block_size, params->alignment);
+  out_suballocator->block_allocator = block_allocator;
+  out_suballocator->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&out_suballocator->mutex);
+  out_suballocator->alignment_log2 =
+      iree_math_count_trailing_zeros_u64(params->alignment);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_hal_suballocator_deinitialize(iree_hal_suballocator_t* suballocator) {
+  IREE_ASSERT_ARGUMENT(suballocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_suballocator_trim(suballocator);
+  IREE_ASSERT_EQ(suballocator->block_head, NULL,
+                 "all ranges must be released prior to deinitialization");
+  IREE_ASSERT_EQ(suballocator->allocated_size, 0,
+                 "all ranges must be released prior to deinitialization");
+
+  iree_hal_suballocator_range_t* range = suballocator->unused_range_head;
+  while (range) {
+    iree_hal_suballocator_range_t* next_range = range->free_next;
+    iree_allocator_free(suballocator->host_allocator, range);
+    range = next_range;
+  }
+  suballocator->unused_range_head = NULL;
+
+  iree_slim_mutex_deinitialize(&suballocator->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// Size class mapping
+//===----------------------------------------------------------------------===//
+
+// Maps a size in |units| of the alignment to its first and second level class.
+static void iree_hal_suballocator_map(uint64_t units, uint32_t* out_fl,
+                                      uint32_t* out_sl) {
+  if (units < IREE_HAL_SUBALLOCATOR_SL_COUNT) {
+    *out_fl = 0;
+    *out_sl = (uint32_t)units;
+  } else {
+    const uint32_t msb = 63 - iree_math_count_leading_zeros_u64(units);
+    *out_fl = msb - IREE_HAL_SUBALLOCATOR_SL_BITS + 1;
+    *out_sl = (uint32_t)(units >> (msb - IREE_HAL_SUBALLOCATOR_SL_BITS)) -
+              IREE_HAL_SUBALLOCATOR_SL_COUNT;
+  }
+}
+
+// Maps a requested size in |units| to the first class whose ranges are all
+// guaranteed to be large enough to hold it.
+static void iree_hal_suballocator_map_search(uint64_t units, uint32_t* out_fl,
+                                             uint32_t* out_sl) {
+  if (units >= IREE_HAL_SUBALLOCATOR_SL_COUNT) {
+    const uint32_t msb = 63 - iree_math_count_leading_zeros_u64(units);
+    units += (1ull << (msb - IREE_HAL_SUBALLOCATOR_SL_BITS)) - 1;
+  }
+  iree_hal_suballocator_map(units, out_fl, out_sl);
+}
+
+//===----------------------------------------------------------------------===//
+// Range management
+//===----------------------------------------------------------------------===//
+
+// Returns a range node from the unused list or allocates a new one.
+//
+// Must be called with the suballocator mutex held.
+static iree_status_t iree_hal_suballocator_allocate_range(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_range_t** out_range) {
+  iree_hal_suballocator_range_t* range = suballocator->unused_range_head;
+  if (range) {
+    suballocator->unused_range_head = range->free_next;
+  } else {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        suballocator->host_allocator, sizeof(*range), (void**)&range));
+  }
+  memset(range, 0, sizeof(*range));
+  *out_range = range;
+  return iree_ok_status();
+}
+
+// Returns |range| to the unused list.
+//
+// Must be called with the suballocator mutex held.
+static void iree_hal_suballocator_recycle_range(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_range_t* range) {
+  range->block = NULL;
+  range->free_next = suballocator->unused_range_head;
+  suballocator->unused_range_head = range;
+}
+
+// Inserts a free |range| into the free list of its size class.
+//
+// Must be called with the suballocator mutex held.
+static void iree_hal_suballocator_insert_free(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_range_t* range) {
+  uint32_t fl = 0, sl = 0;
+  iree_hal_suballocator_map(range->length >> suballocator->alignment_log2, &fl,
+                            &sl);
+  range->is_free = true;
+  range->free_prev = NULL;
+  range->free_next = suballocator->free_heads[fl][sl];
+  if (range->free_next) range->free_next->free_prev = range;
+  suballocator->free_heads[fl][sl] = range;
+  suballocator->fl_bitmap |= 1ull << fl;
+  suballocator->sl_bitmaps[fl] |= 1u << sl;
+}
+
+// Removes a free |range| from the free list of its size class.
+//
+// Must be called with the suballocator mutex held.
+static void iree_hal_suballocator_remove_free(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_range_t* range) {
+  uint32_t fl = 0, sl = 0;
+  iree_hal_suballocator_map(range->length >> suballocator->alignment_log2, &fl,
+                            &sl);
+  if (range->free_prev) {
+    range->free_prev->free_next = range->free_next;
+  } else {
+    suballocator->free_heads[fl][sl] = range->free_next;
+    if (!range->free_next) {
+      suballocator->sl_bitmaps[fl] &= ~(1u << sl);
+      if (!suballocator->sl_bitmaps[fl]) {
+        suballocator->fl_bitmap &= ~(1ull << fl);
+      }
+    }
+  }
+  if (range->free_next) range->free_next->free_prev = range->free_prev;
+  range->free_prev = NULL;
+  range->free_next = NULL;
+  range->is_free = false;
+}
+
+// Finds and removes a free range of at least |length| bytes.
+// Returns NULL if no free range is large enough.
+//
+// Must be called with the suballocator mutex held.
+static iree_hal_suballocator_range_t* iree_hal_suballocator_find_free(
+    iree_hal_suballocator_t* suballocator, iree_device_size_t length) {
+  uint32_t fl = 0, sl = 0;
+  iree_hal_suballocator_map_search(length >> suballocator->alignment_log2, &fl,
+                                   &sl);
+  if (fl >= IREE_HAL_SUBALLOCATOR_FL_COUNT) return NULL;
+
+  // Search the second-level classes at or above |sl| and then the next
+  // non-empty first-level class.
+  uint32_t sl_bitmap = suballocator->sl_bitmaps[fl] & (~0u << sl);
+  if (!sl_bitmap) {
+    if (fl + 1 >= IREE_HAL_SUBALLOCATOR_FL_COUNT) return NULL;
+    const uint64_t fl_bitmap = suballocator->fl_bitmap & (~0ull << (fl + 1));
+    if (!fl_bitmap) return NULL;
+    fl = iree_math_count_trailing_zeros_u64(fl_bitmap);
+    sl_bitmap = suballocator->sl_bitmaps[fl];
+  }
+  sl = iree_math_count_trailing_zeros_u32(sl_bitmap);
+
+  iree_hal_suballocator_range_t* range = suballocator->free_heads[fl][sl];
+  iree_hal_suballocator_remove_free(suballocator, range);
+  return range;
+}
+
+// Marks the free |range| as allocated with |length| bytes and returns the
+// remainder (if any) to the free lists.
+//
+// Must be called with the suballocator mutex held.
+static iree_status_t iree_hal_suballocator_take_range(
+    iree_hal_suballocator_t* suballocator, iree_hal_suballocator_range_t* range,
+    iree_device_size_t length) {
+  if (range->length > length) {
+    iree_hal_suballocator_range_t* remainder = NULL;
+    iree_status_t status =
+        iree_hal_suballocator_allocate_range(suballocator, &remainder);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_suballocator_insert_free(suballocator, range);
+      return status;
+    }
+    remainder->block = range->block;
+    remainder->offset = range->offset + length;
+    remainder->length = range->length - length;
+    remainder->phys_prev = range;
+    remainder->phys_next = range->phys_next;
+    if (remainder->phys_next) remainder->phys_next->phys_prev = remainder;
+    range->phys_next = remainder;
+    range->length = length;
+    iree_hal_suballocator_insert_free(suballocator, remainder);
+  }
+  range->is_free = false;
+  if (range->block->live_count++ == 0) {
+    // Block was unused and is now live.
+    --suballocator->free_block_count;
+  }
+  suballocator->allocated_size += range->length;
+  suballocator->peak_allocated_size = iree_max(
+      suballocator->peak_allocated_size, suballocator->allocated_size);
+  return iree_ok_status();
+}
+
+// Unlinks |block| (which must be unused) from the suballocator and returns its
+// sole range node to the unused list. The caller must free the block.
+//
+// Must be called with the suballocator mutex held.
+static void iree_hal_suballocator_unlink_block(
+    iree_hal_suballocator_t* suballocator, iree_hal_suballocator_block_t* block,
+    iree_hal_suballocator_range_t* range) {
+  if (range->is_free) iree_hal_suballocator_remove_free(suballocator, range);
+  iree_hal_suballocator_recycle_range(suballocator, range);
+  if (block->prev) {
+    block->prev->next = block->next;
+  } else {
+    suballocator->block_head = block->next;
+  }
+  if (block->next) block->next->prev = block->prev;
+  suballocator->reserved_size -= block->size;
+}
+
+// Frees an unlinked |block| with the block allocator.
+// Must be called without the suballocator mutex held.
+static void iree_hal_suballocator_free_block(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_block_t* block) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)block->size);
+  suballocator->block_allocator.free(suballocator->block_allocator.self,
+                                     block->size, block->user_data);
+  iree_allocator_free(suballocator->host_allocator, block);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// Public API
+//===----------------------------------------------------------------------===//
+
+void iree_hal_suballocator_trim(iree_hal_suballocator_t* suballocator) {
+  IREE_ASSERT_ARGUMENT(suballocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Unlink all unused blocks while holding the lock and then free them.
+  iree_hal_suballocator_block_t* dead_head = NULL;
+  iree_slim_mutex_lock(&suballocator->mutex);
+  iree_hal_suballocator_block_t* block = suballocator->block_head;
+  while (block) {
+    iree_hal_suballocator_block_t* next_block = block->next;
+    if (block->live_count == 0) {
+      iree_hal_suballocator_unlink_block(suballocator, block,
+                                         block->head_range);
+      --suballocator->free_block_count;
+      block->next = dead_head;
+      dead_head = block;
+    }
+    block = next_block;
+  }
+  iree_slim_mutex_unlock(&suballocator->mutex);
+
+  while (dead_head) {
+    iree_hal_suballocator_block_t* next_block = dead_head->next;
+    iree_hal_suballocator_free_block(suballocator, dead_head);
+    dead_head = next_block;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_suballocator_query_statistics(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(suballocator);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_slim_mutex_lock(&suballocator->mutex);
+  out_statistics->reserved_size = suballocator->reserved_size;
+  out_statistics->allocated_size = suballocator->allocated_size;
+  out_statistics->peak_allocated_size = suballocator->peak_allocated_size;
+  iree_slim_mutex_unlock(&suballocator->mutex);
+}
+
+iree_status_t iree_hal_suballocator_acquire(
+    iree_hal_suballocator_t* suballocator, iree_device_size_t length,
+    iree_hal_suballocation_t* out_allocation) {
+  IREE_ASSERT_ARGUMENT(suballocator);
+  IREE_ASSERT_ARGUMENT(out_allocation);
+  memset(out_allocation, 0, sizeof(*out_allocation));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)length);
+
+  const iree_device_size_t alignment = suballocator->params.alignment;
+  if (length > IREE_DEVICE_SIZE_MAX - alignment) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "allocation length overflow");
+  }
+  length = iree_max(alignment, iree_device_align(length, alignment));
+
+  // Fast path: carve the range out of an existing block.
+  iree_slim_mutex_lock(&suballocator->mutex);
+  iree_hal_suballocator_range_t* range =
+      iree_hal_suballocator_find_free(suballocator, length);
+  iree_status_t status = iree_ok_status();
+  if (range) {
+    status = iree_hal_suballocator_take_range(suballocator, range, length);
+  }
+  iree_slim_mutex_unlock(&suballocator->mutex);
+
+  if (!range) {
+    // Slow path: allocate a new block without holding the lock as the block
+    // allocator can be very slow. Requests larger than the block size get a
+    // dedicated block.
+    iree_hal_suballocator_block_t* block = NULL;
+    const iree_device_size_t block_size =
+        iree_max(suballocator->params.block_size, length);
+    status = iree_allocator_malloc(suballocator->host_allocator,
+                                   sizeof(*block), (void**)&block);
+    if (iree_status_is_ok(status)) {
+      memset(block, 0, sizeof(*block));
+      block->suballocator = suballocator;
+      block->size = block_size;
+      IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_hal_suballocator_allocate_block");
+      IREE_TRACE_ZONE_APPEND_VALUE(z1, (int64_t)block_size);
+      status = suballocator->block_allocator.allocate(
+          suballocator->block_allocator.self, block_size, &block->user_data);
+      IREE_TRACE_ZONE_END(z1);
+      if (!iree_status_is_ok(status)) {
+        iree_allocator_free(suballocator->host_allocator, block);
+        block = NULL;
+      }
+    }
+
+    if (iree_status_is_ok(status)) {
+      iree_slim_mutex_lock(&suballocator->mutex);
+      status = iree_hal_suballocator_allocate_range(suballocator, &range);
+      if (iree_status_is_ok(status)) {
+        block->next = suballocator->block_head;
+        if (block->next) block->next->prev = block;
+        suballocator->block_head = block;
+        suballocator->reserved_size += block_size;
+        ++suballocator->free_block_count;
+        block->head_range = range;
+        range->block = block;
+        range->offset = 0;
+        range->length = block_size;
+        status = iree_hal_suballocator_take_range(suballocator, range, length);
+        if (!iree_status_is_ok(status)) {
+          // The range was returned to the free list; drop the block.
+          iree_hal_suballocator_unlink_block(suballocator, block, range);
+          --suballocator->free_block_count;
+          range = NULL;
+        }
+      }
+      iree_slim_mutex_unlock(&suballocator->mutex);
+      if (!iree_status_is_ok(status)) {
+        iree_hal_suballocator_free_block(suballocator, block);
+      }
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    out_allocation->block_user_data = range->block->user_data;
+    out_allocation->offset = range->offset;
+    out_allocation->length = range->length;
+    out_allocation->range = range;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_suballocator_release(iree_hal_suballocator_range_t* range) {
+  if (!range) return;
+  iree_hal_suballocator_block_t* block = range->block;
+  iree_hal_suballocator_t* suballocator = block->suballocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)range->length);
+
+  iree_slim_mutex_lock(&suballocator->mutex);
+  IREE_ASSERT(!range->is_free, "range released multiple times");
+  suballocator->allocated_size -= range->length;
+
+  // Coalesce with the physically adjacent free ranges.
+  iree_hal_suballocator_range_t* prev_range = range->phys_prev;
+  if (prev_range && prev_range->is_free) {
+    iree_hal_suballocator_remove_free(suballocator, prev_range);
+    prev_range->length += range->length;
+    prev_range->phys_next = range->phys_next;
+    if (prev_range->phys_next) prev_range->phys_next->phys_prev = prev_range;
+    iree_hal_suballocator_recycle_range(suballocator, range);
+    range = prev_range;
+  }
+  iree_hal_suballocator_range_t* next_range = range->phys_next;
+  if (next_range && next_range->is_free) {
+    iree_hal_suballocator_remove_free(suballocator, next_range);
+    range->length += next_range->length;
+    range->phys_next = next_range->phys_next;
+    if (range->phys_next) range->phys_next->phys_prev = range;
+    iree_hal_suballocator_recycle_range(suballocator, next_range);
+  }
+
+  // Release the block if it is now unused and we don't want to keep it.
+  bool free_block = false;
+  if (--block->live_count == 0) {
+    if (block->size > suballocator->params.block_size ||
+        suballocator->free_block_count >=
+            suballocator->params.max_free_block_count) {
+      iree_hal_suballocator_unlink_block(suballocator, block, range);
+      free_block = true;
+    } else {
+      ++suballocator->free_block_count;
+      iree_hal_suballocator_insert_free(suballocator, range);
+    }
+  } else {
+    iree_hal_suballocator_insert_free(suballocator, range);
+  }
+  iree_slim_mutex_unlock(&suballocator->mutex);
+
+  if (free_block) iree_hal_suballocator_free_block(suballocator, block);
+
+  IREE_TRACE_ZONE_END(z0);
+}
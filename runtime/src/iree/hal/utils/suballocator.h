@@ -0,0 +1,173 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_SUBALLOCATOR_H_
+#define IREE_HAL_UTILS_SUBALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_suballocator_t
+//===----------------------------------------------------------------------===//
+
+// log2 of the number of second-level size classes per power of two.
+#define IREE_HAL_SUBALLOCATOR_SL_BITS 4
+#define IREE_HAL_SUBALLOCATOR_SL_COUNT (1u << IREE_HAL_SUBALLOCATOR_SL_BITS)
+// Number of first-level (power of two) size classes.
+#define IREE_HAL_SUBALLOCATOR_FL_COUNT 64
+
+// A large backing allocation from which ranges are suballocated.
+typedef struct iree_hal_suballocator_block_t iree_hal_suballocator_block_t;
+
+// A range within a block, either allocated or free.
+typedef struct iree_hal_suballocator_range_t iree_hal_suballocator_range_t;
+
+// Callbacks used to acquire and release backing blocks.
+// Blocks are opaque to the suballocator and identified by a user pointer that
+// is returned with each suballocation (a device pointer, a native handle, a
+// HAL buffer, etc).
+typedef struct iree_hal_suballocator_block_allocator_t {
+  void* self;
+  // Allocates a block of |block_size| bytes and returns its |out_user_data|.
+  iree_status_t(IREE_API_PTR* allocate)(void* self,
+                                        iree_device_size_t block_size,
+                                        void** out_user_data);
+  // Frees a block previously allocated with |allocate|.
+  void(IREE_API_PTR* free)(void* self, iree_device_size_t block_size,
+                           void* user_data);
+} iree_hal_suballocator_block_allocator_t;
+
+// Parameters used to configure an iree_hal_suballocator_t.
+typedef struct iree_hal_suballocator_params_t {
+  // Size of each block allocated from the block allocator in bytes.
+  // Requests larger than the block size are given a dedicated block that is
+  // released as soon as the range is released.
+  iree_device_size_t block_size;
+
+  // Alignment of every range offset and length in bytes. Must be a power of
+  // two. Larger alignments reduce bookkeeping but increase waste.
+  iree_device_size_t alignment;
+
+  // Maximum number of completely unused blocks that will be retained for
+  // reuse. Additional blocks are released as soon as they become unused.
+  iree_host_size_t max_free_block_count;
+} iree_hal_suballocator_params_t;
+
+// Initializes |out_params| to the default values.
+void iree_hal_suballocator_params_initialize(
+    iree_hal_suballocator_params_t* out_params);
+
+// A range suballocated from a block.
+typedef struct iree_hal_suballocation_t {
+  // User data of the block the range was allocated from.
+  void* block_user_data;
+  // Offset of the range within the block in bytes.
+  iree_device_size_t offset;
+  // Length of the range in bytes. May be larger than requested due to
+  // alignment.
+  iree_device_size_t length;
+  // Handle used to release the range.
+  iree_hal_suballocator_range_t* range;
+} iree_hal_suballocation_t;
+
+// A two-level segregated fit (TLSF) suballocator carving ranges out of large
+// backing blocks. Acquiring and releasing ranges is O(1) with immediate
+// coalescing of neighboring free ranges. Only block acquisition (when no free
+// range fits) calls into the block allocator.
+//
+// Intended for HAL implementations whose native allocation routines are slow
+// (cuMemAlloc, etc) and that don't otherwise have a pooling mechanism. The
+// implementation wraps each range in its native buffer type (for example by
+// offsetting a device pointer) so that buffers remain compatible with the rest
+// of the driver.
+//
+// Thread-safe: ranges may be acquired and released from any thread.
+typedef struct iree_hal_suballocator_t {
+  iree_hal_suballocator_params_t params;
+  iree_hal_suballocator_block_allocator_t block_allocator;
+  iree_allocator_t host_allocator;
+
+  // Guards all allocator state. Never held while calling the block allocator.
+  iree_slim_mutex_t mutex;
+
+  // log2(params.alignment).
+  uint32_t alignment_log2;
+
+  // All live blocks.
+  iree_hal_suballocator_block_t* block_head;
+  // Number of blocks with no allocated ranges.
+  iree_host_size_t free_block_count;
+
+  // Range nodes available for reuse.
+  iree_hal_suballocator_range_t* unused_range_head;
+
+  // Bitmap of first-level classes with at least one free range.
+  uint64_t fl_bitmap;
+  // Bitmaps of second-level classes with at least one free range.
+  uint32_t sl_bitmaps[IREE_HAL_SUBALLOCATOR_FL_COUNT];
+  // Free range lists per size class.
+  iree_hal_suballocator_range_t* free_heads[IREE_HAL_SUBALLOCATOR_FL_COUNT]
+                                           [IREE_HAL_SUBALLOCATOR_SL_COUNT];
+
+  // Total size of all blocks in bytes.
+  iree_device_size_t reserved_size;
+  // Total size of all allocated ranges in bytes.
+  iree_device_size_t allocated_size;
+  // High-water mark of |allocated_size|.
+  iree_device_size_t peak_allocated_size;
+} iree_hal_suballocator_t;
+
+// Initializes |out_suballocator| to allocate blocks with |block_allocator|.
+// Range bookkeeping is allocated from |host_allocator|.
+iree_status_t iree_hal_suballocator_initialize(
+    const iree_hal_suballocator_params_t* params,
+    iree_hal_suballocator_block_allocator_t block_allocator,
+    iree_allocator_t host_allocator, iree_hal_suballocator_t* out_suballocator);
+
+// Deinitializes |suballocator| and releases all blocks.
+// All ranges must have been released.
+void iree_hal_suballocator_deinitialize(iree_hal_suballocator_t* suballocator);
+
+// Releases all unused blocks back to the block allocator.
+void iree_hal_suballocator_trim(iree_hal_suballocator_t* suballocator);
+
+// Memory usage of an iree_hal_suballocator_t.
+typedef struct iree_hal_suballocator_statistics_t {
+  // Total size of all blocks in bytes.
+  iree_device_size_t reserved_size;
+  // Total size of all allocated ranges in bytes.
+  iree_device_size_t allocated_size;
+  // High-water mark of |allocated_size| over the suballocator lifetime.
+  iree_device_size_t peak_allocated_size;
+} iree_hal_suballocator_statistics_t;
+
+// Queries the current memory usage of |suballocator|.
+void iree_hal_suballocator_query_statistics(
+    iree_hal_suballocator_t* suballocator,
+    iree_hal_suballocator_statistics_t* out_statistics);
+
+// Acquires a range of at least |length| bytes from |suballocator|.
+// A new block is allocated if no free range is large enough.
+iree_status_t iree_hal_suballocator_acquire(
+    iree_hal_suballocator_t* suballocator, iree_device_size_t length,
+    iree_hal_suballocation_t* out_allocation);
+
+// Releases a |range| previously acquired from its suballocator.
+// Ranges reference their owning suballocator so that they can be released from
+// buffer release callbacks that only carry a single user pointer.
+void iree_hal_suballocator_release(iree_hal_suballocator_range_t* range);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_SUBALLOCATOR_H_
@@ -0,0 +1,205 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/suballocator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Block allocator that tracks the number of live blocks and hands out
+// distinct fake block identifiers.
+struct TestBlockAllocator {
+  int live_count = 0;
+  int total_count = 0;
+  uintptr_t next_id = 1;
+
+  static iree_status_t Allocate(void* self, iree_device_size_t block_size,
+                                void** out_user_data) {
+    auto* allocator = reinterpret_cast<TestBlockAllocator*>(self);
+    ++allocator->live_count;
+    ++allocator->total_count;
+    *out_user_data = reinterpret_cast<void*>(allocator->next_id++);
+    return iree_ok_status();
+  }
+
+  static void Free(void* self, iree_device_size_t block_size,
+                   void* user_data) {
+    auto* allocator = reinterpret_cast<TestBlockAllocator*>(self);
+    --allocator->live_count;
+  }
+
+  iree_hal_suballocator_block_allocator_t Get() {
+    return {this, Allocate, Free};
+  }
+};
+
+class SuballocatorTest : public ::testing::Test {
+ protected:
+  void Initialize(iree_device_size_t block_size,
+                  iree_host_size_t max_free_block_count) {
+    iree_hal_suballocator_params_t params;
+    iree_hal_suballocator_params_initialize(&params);
+    params.block_size = block_size;
+    params.alignment = 256;
+    params.max_free_block_count = max_free_block_count;
+    IREE_ASSERT_OK(iree_hal_suballocator_initialize(
+        &params, block_allocator_.Get(), iree_allocator_system(),
+        &suballocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_suballocator_deinitialize(&suballocator_);
+    EXPECT_EQ(block_allocator_.live_count, 0);
+  }
+
+  TestBlockAllocator block_allocator_;
+  iree_hal_suballocator_t suballocator_;
+};
+
+TEST_F(SuballocatorTest, InvalidParams) {
+  iree_hal_suballocator_params_t params;
+  iree_hal_suballocator_params_initialize(&params);
+  params.alignment = 3;
+  iree_hal_suballocator_t suballocator;
+  EXPECT_THAT(Status(iree_hal_suballocator_initialize(
+                  &params, block_allocator_.Get(), iree_allocator_system(),
+                  &suballocator)),
+              StatusIs(StatusCode::kInvalidArgument));
+  Initialize(4096, 1);
+}
+
+// Ranges are aligned and carved out of a single shared block.
+TEST_F(SuballocatorTest, SharesBlocks) {
+  Initialize(64 * 1024, 1);
+  iree_hal_suballocation_t a, b;
+  IREE_ASSERT_OK(iree_hal_suballocator_acquire(&suballocator_, 100, &a));
+  IREE_ASSERT_OK(iree_hal_suballocator_acquire(&suballocator_, 1000, &b));
+  EXPECT_EQ(block_allocator_.total_count, 1);
+  EXPECT_EQ(a.block_user_data, b.block_user_data);
+  EXPECT_EQ(a.length, 256);
+  EXPECT_EQ(b.length, 1024);
+  EXPECT_EQ(a.offset % 256, 0);
+  EXPECT_EQ(b.offset % 256, 0);
+  EXPECT_TRUE(a.offset + a.length <= b.offset ||
+              b.offset + b.length <= a.offset);
+  EXPECT_EQ(suballocator_.allocated_size, 256 + 1024);
+  iree_hal_suballocator_release(a.range);
+  iree_hal_suballocator_release(b.range);
+  iree_hal_suballocator_statistics_t statistics;
+  iree_hal_suballocator_query_statistics(&suballocator_, &statistics);
+  EXPECT_EQ(statistics.reserved_size, 64 * 1024);
+  EXPECT_EQ(statistics.allocated_size, 0);
+  EXPECT_EQ(statistics.peak_allocated_size, 256 + 1024);
+  // The block is retained for reuse.
+  EXPECT_EQ(block_allocator_.live_count, 1);
+}
+
+// Released neighbors are coalesced so the whole block can be reused.
+TEST_F(SuballocatorTest, Coalesces) {
+  Initialize(4096, 1);
+  std::vector<iree_hal_suballocation_t> allocations(16);
+  for (auto& allocation : allocations) {
+    IREE_ASSERT_OK(
+        iree_hal_suballocator_acquire(&suballocator_, 256, &allocation));
+  }
+  EXPECT_EQ(block_allocator_.total_count, 1);
+  // Release in an interleaved order to exercise both merge directions.
+  for (size_t i = 0; i < allocations.size(); i += 2) {
+    iree_hal_suballocator_release(allocations[i].range);
+  }
+  for (size_t i = 1; i < allocations.size(); i += 2) {
+    iree_hal_suballocator_release(allocations[i].range);
+  }
+  iree_hal_suballocation_t whole;
+  IREE_ASSERT_OK(iree_hal_suballocator_acquire(&suballocator_, 4096, &whole));
+  EXPECT_EQ(block_allocator_.total_count, 1);
+  EXPECT_EQ(whole.offset, 0);
+  iree_hal_suballocator_release(whole.range);
+}
+
+// Requests larger than the block size get dedicated blocks that are released
+// immediately.
+TEST_F(SuballocatorTest, DedicatedBlocks) {
+  Initialize(4096, 1);
+  iree_hal_suballocation_t allocation;
+  IREE_ASSERT_OK(
+      iree_hal_suballocator_acquire(&suballocator_, 10000, &allocation));
+  EXPECT_EQ(allocation.offset, 0);
+  EXPECT_EQ(allocation.length, 10240);
+  EXPECT_EQ(block_allocator_.live_count, 1);
+  iree_hal_suballocator_release(allocation.range);
+  EXPECT_EQ(block_allocator_.live_count, 0);
+}
+
+// Only max_free_block_count unused blocks are retained and trimming releases
+// them all.
+TEST_F(SuballocatorTest, RetainsAndTrimsBlocks) {
+  Initialize(4096, 1);
+  iree_hal_suballocation_t a, b, c;
+  IREE_ASSERT_OK(iree_hal_suballocator_acquire(&suballocator_, 4096, &a));
+  IREE_ASSERT_OK(iree_hal_suballocator_acquire(&suballocator_, 4096, &b));
+  IREE_ASSERT_OK(iree_hal_suballocator_acquire(&suballocator_, 4096, &c));
+  EXPECT_EQ(block_allocator_.live_count, 3);
+  iree_hal_suballocator_release(a.range);
+  iree_hal_suballocator_release(b.range);
+  EXPECT_EQ(block_allocator_.live_count, 2);
+  iree_hal_suballocator_trim(&suballocator_);
+  EXPECT_EQ(block_allocator_.live_count, 1);
+  iree_hal_suballocator_release(c.range);
+  iree_hal_suballocator_trim(&suballocator_);
+  EXPECT_EQ(block_allocator_.live_count, 0);
+}
+
+// Randomized allocations never overlap within a block.
+TEST_F(SuballocatorTest, Randomized) {
+  Initialize(1024 * 1024, 2);
+  std::vector<iree_hal_suballocation_t> live;
+  uint32_t seed = 123;
+  for (int i = 0; i < 4000; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    if (!live.empty() && (seed >> 28) < 7) {
+      size_t index = (seed >> 8) % live.size();
+      iree_hal_suballocator_release(live[index].range);
+      live.erase(live.begin() + index);
+    } else {
+      iree_hal_suballocation_t allocation;
+      IREE_ASSERT_OK(iree_hal_suballocator_acquire(
+          &suballocator_, 1 + (seed >> 12) % (64 * 1024), &allocation));
+      live.push_back(allocation);
+    }
+  }
+  std::sort(live.begin(), live.end(),
+            [](const iree_hal_suballocation_t& lhs,
+               const iree_hal_suballocation_t& rhs) {
+              return lhs.block_user_data != rhs.block_user_data
+                         ? lhs.block_user_data < rhs.block_user_data
+                         : lhs.offset < rhs.offset;
+            });
+  for (size_t i = 1; i < live.size(); ++i) {
+    if (live[i].block_user_data != live[i - 1].block_user_data) continue;
+    EXPECT_LE(live[i - 1].offset + live[i - 1].length, live[i].offset);
+  }
+  for (auto& allocation : live) {
+    iree_hal_suballocator_release(allocation.range);
+  }
+  EXPECT_EQ(suballocator_.allocated_size, 0);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -9,12 +9,24 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/local_dispatch_pool.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/vm/api.h"
 
 #define IREE_HAL_LOADER_MODULE_VERSION_0_0 0x00000000u
 #define IREE_HAL_LOADER_MODULE_VERSION_LATEST IREE_HAL_LOADER_MODULE_VERSION_0_0
 
+// Validates each dispatch binding against the bounds and access of the buffer
+// it references. Release builds trust the compiler-generated binding ranges
+// and pass buffer contents straight through to the executable.
+#if !defined(IREE_HAL_LOADER_MODULE_VALIDATE_BINDINGS)
+#if defined(NDEBUG)
+#define IREE_HAL_LOADER_MODULE_VALIDATE_BINDINGS 0
+#else
+#define IREE_HAL_LOADER_MODULE_VALIDATE_BINDINGS 1
+#endif  // NDEBUG
+#endif  // !IREE_HAL_LOADER_MODULE_VALIDATE_BINDINGS
+
 //===----------------------------------------------------------------------===//
 // Module type definitions
 //===----------------------------------------------------------------------===//
@@ -22,6 +34,9 @@
 typedef struct iree_hal_loader_module_t {
   iree_allocator_t host_allocator;
   iree_hal_loader_module_flags_t flags;
+  // Optional pool executing the workgroups of each dispatch across threads.
+  // Shared by all contexts using the module.
+  iree_hal_local_dispatch_pool_t* dispatch_pool;
   // TODO(benvanik): types.
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
@@ -41,6 +56,9 @@ static void IREE_API_PTR iree_hal_loader_module_destroy(void* base_module) {
   for (iree_host_size_t i = 0; i < module->loader_count; ++i) {
     iree_hal_executable_loader_release(module->loaders[i]);
   }
+  if (module->dispatch_pool) {
+    iree_hal_local_dispatch_pool_free(module->dispatch_pool);
+  }
 }
 
 static iree_status_t IREE_API_PTR
@@ -155,8 +173,13 @@ static iree_status_t iree_hal_loader_module_try_load(
     // The loader _may_ handle the executable; if the specific executable is not
     // supported then the try will fail with IREE_STATUS_CANCELLED and we should
     // continue trying other loaders.
+    iree_host_size_t worker_capacity =
+        loader_module->dispatch_pool
+            ? iree_hal_local_dispatch_pool_concurrency(
+                  loader_module->dispatch_pool)
+            : 1;
     iree_status_t status = iree_hal_executable_loader_try_load(
-        loader, executable_params, /*worker_capacity=*/1, out_executable);
+        loader, executable_params, worker_capacity, out_executable);
     if (iree_status_is_ok(status)) {
       // Executable was successfully loaded.
       return status;
@@ -242,10 +265,7 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
     iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
     iree_hal_loader_module_state_t* IREE_RESTRICT state,
     const iree_hal_loader_dispatch_args_t* IREE_RESTRICT args) {
-  iree_hal_executable_t* executable = NULL;
-  IREE_RETURN_IF_ERROR(
-      iree_hal_executable_check_deref(args->executable, &executable));
-
+  iree_hal_loader_module_t* loader_module = IREE_HAL_LOADER_MODULE_CAST(module);
   if (args->binding_count > 32) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many bindings");
@@ -254,6 +274,11 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
       (void**)iree_alloca(args->binding_count * sizeof(void*));
   size_t* binding_lengths =
       (size_t*)iree_alloca(args->binding_count * sizeof(size_t));
+
+#if IREE_HAL_LOADER_MODULE_VALIDATE_BINDINGS
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_executable_check_deref(args->executable, &executable));
   for (iree_host_size_t i = 0; i < args->binding_count; ++i) {
     iree_vm_buffer_t* buffer = NULL;
     IREE_RETURN_IF_ERROR(
@@ -269,6 +294,17 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
     binding_ptrs[i] = (void*)span.data;
     binding_lengths[i] = span.data_length;
   }
+#else
+  // Host buffers are passed straight through as pointers into their storage.
+  iree_hal_executable_t* executable =
+      (iree_hal_executable_t*)args->executable.ptr;
+  for (iree_host_size_t i = 0; i < args->binding_count; ++i) {
+    iree_vm_buffer_t* buffer = (iree_vm_buffer_t*)args->bindings[i].r0.ptr;
+    binding_ptrs[i] =
+        buffer->data.data + iree_hal_cast_host_size(args->bindings[i].i1);
+    binding_lengths[i] = iree_hal_cast_host_size(args->bindings[i].i2);
+  }
+#endif  // IREE_HAL_LOADER_MODULE_VALIDATE_BINDINGS
 
   const iree_hal_executable_dispatch_state_v0_t dispatch_state = {
       .workgroup_size_x = 1,
@@ -278,7 +314,11 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
       .workgroup_count_x = args->workgroup_x,
       .workgroup_count_y = args->workgroup_y,
       .workgroup_count_z = args->workgroup_z,
-      .max_concurrency = 1,
+      .max_concurrency =
+          loader_module->dispatch_pool
+              ? (uint8_t)iree_hal_local_dispatch_pool_concurrency(
+                    loader_module->dispatch_pool)
+              : 1,
       .binding_count = args->binding_count,
       .push_constants = args->push_constants,
       .binding_ptrs = binding_ptrs,
@@ -289,6 +329,11 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
   uint32_t processor_id = 0;
   iree_byte_span_t local_memory = iree_byte_span_empty();
 
+  if (loader_module->dispatch_pool) {
+    return iree_hal_local_dispatch_pool_issue(
+        loader_module->dispatch_pool, (iree_hal_local_executable_t*)executable,
+        args->entry_point, &dispatch_state, processor_id, local_memory);
+  }
   return iree_hal_local_executable_issue_dispatch_inline(
       (iree_hal_local_executable_t*)executable, args->entry_point,
       &dispatch_state, processor_id, local_memory);
@@ -389,11 +434,30 @@ static const iree_vm_native_module_descriptor_t
         .functions = iree_hal_loader_module_funcs_,
 };
 
+IREE_API_EXPORT void iree_hal_loader_module_params_initialize(
+    iree_hal_loader_module_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->worker_count = 0;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  iree_hal_loader_module_params_t params;
+  iree_hal_loader_module_params_initialize(&params);
+  return iree_hal_loader_module_create_with_params(
+      instance, flags, &params, loader_count, loaders, host_allocator,
+      out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_loader_module_create_with_params(
+    iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
+    const iree_hal_loader_module_params_t* params,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
   IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(params);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
 
@@ -431,6 +495,15 @@ IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_hal_executable_loader_retain(loaders[i]);
   }
 
-  *out_module = base_module;
-  return iree_ok_status();
+  if (params->worker_count > 0) {
+    status = iree_hal_local_dispatch_pool_create(
+        params->worker_count, host_allocator, &module->dispatch_pool);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_module = base_module;
+  } else {
+    iree_vm_module_release(base_module);
+  }
+  return status;
 }
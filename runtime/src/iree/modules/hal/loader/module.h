@@ -24,12 +24,32 @@ enum iree_hal_loader_module_flag_bits_t {
 };
 typedef uint32_t iree_hal_loader_module_flags_t;
 
+// Parameters configuring an iree_hal_loader_module_t.
+typedef struct iree_hal_loader_module_params_t {
+  // Number of threads in addition to the thread calling into the module that
+  // execute the workgroups of each dispatch. 0 executes all workgroups on the
+  // calling thread. See iree_hal_local_dispatch_pool_t for details.
+  iree_host_size_t worker_count;
+} iree_hal_loader_module_params_t;
+
+// Initializes |out_params| to default values.
+IREE_API_EXPORT void iree_hal_loader_module_params_initialize(
+    iree_hal_loader_module_params_t* out_params);
+
 // Creates the dynamic HAL executable loader module for local execution.
 IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module);
 
+// Creates the dynamic HAL executable loader module for local execution with
+// the given |params|.
+IREE_API_EXPORT iree_status_t iree_hal_loader_module_create_with_params(
+    iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
+    const iree_hal_loader_module_params_t* params,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
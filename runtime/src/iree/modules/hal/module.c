@@ -69,6 +69,9 @@ typedef struct iree_hal_module_state_t {
   // executables like ones for training vs inference in the same model, or just
   // always use this.
   iree_hal_executable_cache_t* executable_cache;
+
+  // Statistics accumulated by the module for startup profiling.
+  iree_hal_module_statistics_t statistics;
 } iree_hal_module_state_t;
 
 static void IREE_API_PTR iree_hal_module_destroy(void* base_module) {
@@ -213,12 +216,16 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate_initialized,  //
       .usage = buffer_usage,
   };
   iree_hal_buffer_t* buffer = NULL;
+  iree_time_t start_time = iree_time_now();
   IREE_RETURN_IF_ERROR(
       iree_hal_allocator_allocate_buffer(
           allocator, params, length,
           iree_make_const_byte_span(source->data.data + offset, length),
           &buffer),
       "failed to allocate buffer of length %" PRIdsz, length);
+  state->statistics.constant_upload_duration += iree_time_now() - start_time;
+  ++state->statistics.constant_upload_count;
+  state->statistics.constant_upload_bytes += length;
 
   rets->r0 = iree_hal_buffer_move_ref(buffer);
   return iree_ok_status();
@@ -302,6 +309,8 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_map_byte_buffer,  //
     // Mapping succeeded - retain the source buffer that'll be released by
     // iree_hal_module_map_data_ctl when the mapping is no longer used.
     iree_vm_buffer_retain(source);
+    ++state->statistics.constant_map_count;
+    state->statistics.constant_map_bytes += length;
     rets->r0 = iree_hal_buffer_move_ref(buffer);
     return iree_ok_status();
   }
@@ -992,7 +1001,7 @@ IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_execute,  //
   return iree_hal_device_queue_execute(
       device, queue_affinity, iree_hal_fence_semaphore_list(wait_fence),
       iree_hal_fence_semaphore_list(signal_fence), command_buffer_count,
-      command_buffers);
+      command_buffers, /*binding_tables=*/NULL);
 }
 
 IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_flush,  //
@@ -1057,6 +1066,11 @@ IREE_VM_ABI_EXPORT(iree_hal_module_executable_create,  //
         executable_data->access == IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE
             ? IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA
             : 0;
+    if (iree_all_bits_set(state->flags,
+                          IREE_HAL_MODULE_FLAG_LAZY_EXECUTABLES)) {
+      executable_params.caching_mode |=
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_LAZY_PREPARATION;
+    }
     executable_params.executable_format = executable_format_str;
     executable_params.executable_data = iree_make_const_byte_span(
         executable_data->data.data, executable_data->data.data_length);
@@ -1064,8 +1078,22 @@ IREE_VM_ABI_EXPORT(iree_hal_module_executable_create,  //
     executable_params.pipeline_layouts = pipeline_layouts;
     executable_params.constant_count = constant_count;
     executable_params.constants = constants;
+    iree_time_t start_time = iree_time_now();
     status = iree_hal_executable_cache_prepare_executable(
         state->executable_cache, &executable_params, &executable);
+    iree_duration_t duration = iree_time_now() - start_time;
+    if (iree_status_is_ok(status)) {
+      iree_hal_module_statistics_t* statistics = &state->statistics;
+      if (!statistics->executable_count ||
+          duration < statistics->executable_prepare_min_duration) {
+        statistics->executable_prepare_min_duration = duration;
+      }
+      if (duration > statistics->executable_prepare_max_duration) {
+        statistics->executable_prepare_max_duration = duration;
+      }
+      statistics->executable_prepare_duration += duration;
+      ++statistics->executable_count;
+    }
   }
 
   iree_allocator_free(state->host_allocator, pipeline_layouts);
@@ -1477,3 +1505,12 @@ IREE_API_EXPORT iree_hal_device_t* iree_hal_module_state_device(
   iree_hal_module_state_t* state = (iree_hal_module_state_t*)module_state;
   return state->shared_device;
 }
+
+IREE_API_EXPORT void iree_hal_module_state_statistics(
+    iree_vm_module_state_t* module_state,
+    iree_hal_module_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(module_state);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_hal_module_state_t* state = (iree_hal_module_state_t*)module_state;
+  *out_statistics = state->statistics;
+}
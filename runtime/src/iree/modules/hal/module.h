@@ -23,6 +23,10 @@ enum iree_hal_module_flag_bits_t {
 
   // Forces HAL methods to block instead of yielding as a coroutine.
   IREE_HAL_MODULE_FLAG_SYNCHRONOUS = 1u << 0,
+
+  // Defers loading executables until their first dispatch on devices that
+  // support it. Executables that are never dispatched are never loaded.
+  IREE_HAL_MODULE_FLAG_LAZY_EXECUTABLES = 1u << 1,
 };
 typedef uint32_t iree_hal_module_flags_t;
 
@@ -39,6 +43,35 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
 IREE_API_EXPORT iree_hal_device_t* iree_hal_module_state_device(
     iree_vm_module_state_t* module_state);
 
+// Host-side costs of the HAL operations dominating context initialization.
+// Durations are measured around the host calls and do not include device work
+// that completes asynchronously.
+typedef struct iree_hal_module_statistics_t {
+  // Number of executables prepared through the executable cache.
+  iree_host_size_t executable_count;
+  // Total, shortest and longest time spent preparing a single executable.
+  iree_duration_t executable_prepare_duration;
+  iree_duration_t executable_prepare_min_duration;
+  iree_duration_t executable_prepare_max_duration;
+
+  // Number and total size of buffers allocated and initialized with module
+  // data (constants that could not be mapped).
+  iree_host_size_t constant_upload_count;
+  iree_device_size_t constant_upload_bytes;
+  // Total time spent allocating and initializing constant buffers.
+  iree_duration_t constant_upload_duration;
+
+  // Number and total size of module data ranges mapped in-place as buffers.
+  iree_host_size_t constant_map_count;
+  iree_device_size_t constant_map_bytes;
+} iree_hal_module_statistics_t;
+
+// Returns the statistics accumulated by the HAL module |module_state| since it
+// was created.
+IREE_API_EXPORT void iree_hal_module_state_statistics(
+    iree_vm_module_state_t* module_state,
+    iree_hal_module_statistics_t* out_statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,656 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/session.h"
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->max_batch_size = 8;
+  out_options->max_batch_delay = 1000000;  // 1ms
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// A request waiting to be batched.
+typedef struct iree_runtime_batcher_request_t {
+  // Next request in the pending queue or in the batch being executed.
+  struct iree_runtime_batcher_request_t* next;
+  iree_vm_list_t* inputs;
+  // Number of rows along dimension 0 the request contributes to a batch.
+  iree_hal_dim_t row_count;
+  // Time the request was enqueued used to bound the batching delay.
+  iree_time_t enqueue_time_ns;
+  iree_runtime_batcher_callback_fn_t callback;
+  void* user_data;
+} iree_runtime_batcher_request_t;
+
+struct iree_runtime_batcher_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_runtime_session_t* session;
+  iree_vm_function_t function;
+  iree_runtime_batcher_options_t options;
+  iree_thread_t* thread;
+
+  // Posted when requests are enqueued or the batcher is being destroyed.
+  iree_notification_t notification;
+
+  iree_slim_mutex_t mutex;
+  // FIFO of requests waiting to be batched.
+  iree_runtime_batcher_request_t* pending_head IREE_GUARDED_BY(mutex);
+  iree_runtime_batcher_request_t* pending_tail IREE_GUARDED_BY(mutex);
+  iree_host_size_t pending_count IREE_GUARDED_BY(mutex);
+  // True once the batcher is being destroyed. The thread exits after all
+  // pending requests have completed.
+  bool exit_requested IREE_GUARDED_BY(mutex);
+};
+
+static void iree_runtime_batcher_request_free(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* request) {
+  iree_vm_list_release(request->inputs);
+  iree_allocator_free(batcher->host_allocator, request);
+}
+
+// Returns the number of rows |inputs| contributes to a batch: the outer
+// dimension shared by all of its buffer views.
+static iree_status_t iree_runtime_batcher_count_rows(
+    iree_vm_list_t* inputs, iree_hal_dim_t* out_row_count) {
+  *out_row_count = 0;
+  for (iree_host_size_t i = 0; i < iree_vm_list_size(inputs); ++i) {
+    iree_hal_buffer_view_t* buffer_view =
+        iree_vm_list_get_buffer_view_assign(inputs, i);
+    if (!buffer_view) continue;
+    if (iree_hal_buffer_view_shape_rank(buffer_view) == 0 ||
+        iree_hal_buffer_view_shape_dim(buffer_view, 0) == 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "input %" PRIhsz
+                              " has no outer dimension to batch along",
+                              i);
+    }
+    iree_hal_dim_t row_count = iree_hal_buffer_view_shape_dim(buffer_view, 0);
+    if (*out_row_count && row_count != *out_row_count) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "input %" PRIhsz " has %" PRIdim
+          " rows but prior inputs of the request have %" PRIdim,
+          i, row_count, *out_row_count);
+    }
+    *out_row_count = row_count;
+  }
+  if (!*out_row_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "requests must have at least one buffer view "
+                            "input to batch along");
+  }
+  return iree_ok_status();
+}
+
+// Returns true if |request| can be batched with |head|.
+static bool iree_runtime_batcher_is_compatible(
+    const iree_runtime_batcher_request_t* head,
+    const iree_runtime_batcher_request_t* request) {
+  iree_host_size_t input_count = iree_vm_list_size(head->inputs);
+  if (iree_vm_list_size(request->inputs) != input_count) return false;
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* head_view =
+        iree_vm_list_get_buffer_view_assign(head->inputs, i);
+    iree_hal_buffer_view_t* view =
+        iree_vm_list_get_buffer_view_assign(request->inputs, i);
+    if (!head_view != !view) return false;
+    if (!head_view) continue;
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(head_view);
+    if (iree_hal_buffer_view_shape_rank(view) != rank ||
+        iree_hal_buffer_view_element_type(view) !=
+            iree_hal_buffer_view_element_type(head_view) ||
+        iree_hal_buffer_view_encoding_type(view) !=
+            iree_hal_buffer_view_encoding_type(head_view)) {
+      return false;
+    }
+    for (iree_host_size_t j = 1; j < rank; ++j) {
+      if (iree_hal_buffer_view_shape_dim(view, j) !=
+          iree_hal_buffer_view_shape_dim(head_view, j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Removes the oldest pending request and up to max_batch_size - 1 compatible
+// requests from the queue. Incompatible requests keep their order and are
+// batched later.
+static iree_runtime_batcher_request_t* iree_runtime_batcher_pop_batch(
+    iree_runtime_batcher_t* batcher, iree_host_size_t* out_count) {
+  iree_slim_mutex_lock(&batcher->mutex);
+  iree_runtime_batcher_request_t* head = batcher->pending_head;
+  iree_runtime_batcher_request_t* batch_tail = head;
+  iree_host_size_t count = 1;
+  iree_runtime_batcher_request_t* kept_head = NULL;
+  iree_runtime_batcher_request_t* kept_tail = NULL;
+  iree_runtime_batcher_request_t* request = head->next;
+  while (request) {
+    iree_runtime_batcher_request_t* next = request->next;
+    request->next = NULL;
+    if (count < batcher->options.max_batch_size &&
+        iree_runtime_batcher_is_compatible(head, request)) {
+      batch_tail->next = request;
+      batch_tail = request;
+      ++count;
+    } else if (kept_tail) {
+      kept_tail->next = request;
+      kept_tail = request;
+    } else {
+      kept_head = kept_tail = request;
+    }
+    request = next;
+  }
+  batch_tail->next = NULL;
+  batcher->pending_head = kept_head;
+  batcher->pending_tail = kept_tail;
+  batcher->pending_count -= count;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  *out_count = count;
+  return head;
+}
+
+// Fails all requests in |batch| with |status| and frees them.
+static void iree_runtime_batcher_fail_batch(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_status_t status) {
+  while (batch) {
+    iree_runtime_batcher_request_t* next = batch->next;
+    batch->callback(batch->user_data, iree_status_clone(status), NULL);
+    iree_runtime_batcher_request_free(batcher, batch);
+    batch = next;
+  }
+  iree_status_ignore(status);
+}
+
+// Concatenates the inputs of all requests in |batch| into |batched_inputs|.
+// Buffer views are gathered into newly allocated buffers with one transfer
+// command buffer and all other values are taken from the first request.
+static iree_status_t iree_runtime_batcher_gather_inputs(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_host_size_t batch_count, iree_hal_dim_t total_row_count,
+    iree_vm_list_t* batched_inputs) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_device_t* device = iree_runtime_session_device(batcher->session);
+  iree_hal_allocator_t* device_allocator =
+      iree_runtime_session_device_allocator(batcher->session);
+
+  iree_host_size_t input_count = iree_vm_list_size(batch->inputs);
+  iree_host_size_t transfer_capacity = 0;
+  iree_host_size_t max_rank = 0;
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* view =
+        iree_vm_list_get_buffer_view_assign(batch->inputs, i);
+    if (view) {
+      transfer_capacity += batch_count;
+      max_rank = iree_max(max_rank, iree_hal_buffer_view_shape_rank(view));
+    }
+  }
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(max_rank * sizeof(iree_hal_dim_t));
+  iree_hal_transfer_command_t* transfers = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(batcher->host_allocator,
+                                transfer_capacity * sizeof(*transfers),
+                                (void**)&transfers));
+  iree_host_size_t transfer_count = 0;
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < input_count && iree_status_is_ok(status);
+       ++i) {
+    iree_hal_buffer_view_t* head_view =
+        iree_vm_list_get_buffer_view_assign(batch->inputs, i);
+    if (!head_view) {
+      iree_vm_variant_t value = iree_vm_variant_empty();
+      status = iree_vm_list_get_variant(batch->inputs, i, &value);
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_list_push_variant(batched_inputs, &value);
+      }
+      continue;
+    }
+
+    iree_device_size_t byte_length =
+        iree_hal_buffer_view_byte_length(head_view);
+    if (byte_length % batch->row_count != 0) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "input %" PRIhsz " is not dense", i);
+      break;
+    }
+    iree_device_size_t row_length = byte_length / batch->row_count;
+
+    // Allocate the batched buffer like the buffer of the first request.
+    iree_hal_buffer_t* head_buffer = iree_hal_buffer_view_buffer(head_view);
+    iree_hal_buffer_params_t params = {
+        .type = iree_hal_buffer_memory_type(head_buffer),
+        .usage = iree_hal_buffer_allowed_usage(head_buffer) |
+                 IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET,
+    };
+    iree_hal_buffer_t* buffer = NULL;
+    status = iree_hal_allocator_allocate_buffer(
+        device_allocator, params, row_length * total_row_count,
+        iree_const_byte_span_empty(), &buffer);
+
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(head_view);
+    memcpy(shape, iree_hal_buffer_view_shape_dims(head_view),
+           rank * sizeof(iree_hal_dim_t));
+    shape[0] = total_row_count;
+    iree_hal_buffer_view_t* batched_view = NULL;
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_buffer_view_create(
+          buffer, rank, shape, iree_hal_buffer_view_element_type(head_view),
+          iree_hal_buffer_view_encoding_type(head_view),
+          batcher->host_allocator, &batched_view);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_vm_ref_t batched_view_ref =
+          iree_hal_buffer_view_move_ref(batched_view);
+      status = iree_vm_list_push_ref_move(batched_inputs, &batched_view_ref);
+      iree_vm_ref_release(&batched_view_ref);
+    }
+
+    // Copy the rows of each request into place. The batched buffer is kept
+    // live by its buffer view in |batched_inputs|.
+    iree_device_size_t target_offset = 0;
+    for (iree_runtime_batcher_request_t* request = batch;
+         request && iree_status_is_ok(status); request = request->next) {
+      iree_hal_buffer_view_t* view =
+          iree_vm_list_get_buffer_view_assign(request->inputs, i);
+      iree_device_size_t length = row_length * request->row_count;
+      iree_hal_transfer_command_t* transfer = &transfers[transfer_count++];
+      transfer->type = IREE_HAL_TRANSFER_COMMAND_TYPE_COPY;
+      transfer->copy.source_buffer = iree_hal_buffer_view_buffer(view);
+      transfer->copy.source_offset = 0;
+      transfer->copy.target_buffer = buffer;
+      transfer->copy.target_offset = target_offset;
+      transfer->copy.length = length;
+      target_offset += length;
+    }
+    iree_hal_buffer_release(buffer);
+  }
+
+  // Perform all copies and wait for them to complete as the call that follows
+  // is synchronous.
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  if (iree_status_is_ok(status) && transfer_count > 0) {
+    status = iree_hal_create_transfer_command_buffer(
+        device,
+        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+            IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+        IREE_HAL_QUEUE_AFFINITY_ANY, transfer_count, transfers,
+        &command_buffer);
+  }
+  iree_hal_semaphore_t* semaphore = NULL;
+  if (iree_status_is_ok(status) && command_buffer) {
+    status = iree_hal_semaphore_create(device, 0ull, &semaphore);
+  }
+  uint64_t signal_value = 1ull;
+  if (iree_status_is_ok(status) && command_buffer) {
+    iree_hal_semaphore_list_t signal_semaphores = {
+        .count = 1,
+        .semaphores = &semaphore,
+        .payload_values = &signal_value,
+    };
+    status = iree_hal_device_queue_execute(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, 1, &command_buffer, /*binding_tables=*/NULL);
+  }
+  if (iree_status_is_ok(status) && command_buffer) {
+    status = iree_hal_semaphore_wait(semaphore, signal_value,
+                                     iree_infinite_timeout());
+  }
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_command_buffer_release(command_buffer);
+
+  iree_allocator_free(batcher->host_allocator, transfers);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Produces the outputs of |request| from the |batched_outputs| of its batch.
+// Batched buffer views are split into views of the rows starting at
+// |row_offset| and all other values are shared.
+//
+// The function signature does not say which results are batched so buffer
+// views are treated as batched when their outer dimension equals
+// |total_row_count|. This is part of the documented calling convention in
+// batcher.h: a shared result that coincidentally has that outer dimension is
+// split as well.
+static iree_status_t iree_runtime_batcher_scatter_outputs(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* batched_outputs,
+    iree_hal_dim_t total_row_count, iree_hal_dim_t row_offset,
+    iree_runtime_batcher_request_t* request, iree_vm_list_t** out_outputs) {
+  iree_host_size_t output_count = iree_vm_list_size(batched_outputs);
+  iree_vm_list_t* outputs = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(
+      /*element_type=*/NULL, output_count, batcher->host_allocator, &outputs));
+
+  // Scratch shape storage shared by all outputs.
+  iree_host_size_t max_rank = 0;
+  for (iree_host_size_t i = 0; i < output_count; ++i) {
+    iree_hal_buffer_view_t* batched_view =
+        iree_vm_list_get_buffer_view_assign(batched_outputs, i);
+    if (batched_view) {
+      max_rank =
+          iree_max(max_rank, iree_hal_buffer_view_shape_rank(batched_view));
+    }
+  }
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(max_rank * sizeof(iree_hal_dim_t));
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < output_count && iree_status_is_ok(status);
+       ++i) {
+    iree_hal_buffer_view_t* batched_view =
+        iree_vm_list_get_buffer_view_assign(batched_outputs, i);
+    if (!batched_view || iree_hal_buffer_view_shape_rank(batched_view) == 0 ||
+        iree_hal_buffer_view_shape_dim(batched_view, 0) != total_row_count) {
+      iree_vm_variant_t value = iree_vm_variant_empty();
+      status = iree_vm_list_get_variant(batched_outputs, i, &value);
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_list_push_variant(outputs, &value);
+      }
+      continue;
+    }
+
+    iree_device_size_t row_length =
+        iree_hal_buffer_view_byte_length(batched_view) / total_row_count;
+    iree_hal_buffer_t* buffer = NULL;
+    status = iree_hal_buffer_subspan(iree_hal_buffer_view_buffer(batched_view),
+                                     row_length * row_offset,
+                                     row_length * request->row_count, &buffer);
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(batched_view);
+    memcpy(shape, iree_hal_buffer_view_shape_dims(batched_view),
+           rank * sizeof(iree_hal_dim_t));
+    shape[0] = request->row_count;
+    iree_hal_buffer_view_t* view = NULL;
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_buffer_view_create(
+          buffer, rank, shape, iree_hal_buffer_view_element_type(batched_view),
+          iree_hal_buffer_view_encoding_type(batched_view),
+          batcher->host_allocator, &view);
+    }
+    iree_hal_buffer_release(buffer);
+    if (iree_status_is_ok(status)) {
+      iree_vm_ref_t view_ref = iree_hal_buffer_view_move_ref(view);
+      status = iree_vm_list_push_ref_move(outputs, &view_ref);
+      iree_vm_ref_release(&view_ref);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_outputs = outputs;
+  } else {
+    iree_vm_list_release(outputs);
+  }
+  return status;
+}
+
+// Calls the function with the inputs of |batch_count| requests in |batch| and
+// completes each request.
+static void iree_runtime_batcher_execute_batch(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_host_size_t batch_count) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)batch_count);
+
+  iree_hal_dim_t total_row_count = 0;
+  for (iree_runtime_batcher_request_t* request = batch; request;
+       request = request->next) {
+    total_row_count += request->row_count;
+  }
+
+  // A lone request is called with its own inputs.
+  iree_vm_list_t* batched_inputs = NULL;
+  iree_status_t status = iree_ok_status();
+  if (batch_count == 1) {
+    batched_inputs = batch->inputs;
+    iree_vm_list_retain(batched_inputs);
+  } else {
+    status = iree_vm_list_create(
+        /*element_type=*/NULL, iree_vm_list_size(batch->inputs),
+        batcher->host_allocator, &batched_inputs);
+    if (iree_status_is_ok(status)) {
+      status = iree_runtime_batcher_gather_inputs(
+          batcher, batch, batch_count, total_row_count, batched_inputs);
+    }
+  }
+
+  iree_vm_list_t* batched_outputs = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(/*element_type=*/NULL, /*initial_capacity=*/0,
+                                 batcher->host_allocator, &batched_outputs);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_session_call(batcher->session, &batcher->function,
+                                       batched_inputs, batched_outputs);
+  }
+  iree_vm_list_release(batched_inputs);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_list_release(batched_outputs);
+    iree_runtime_batcher_fail_batch(batcher, batch, status);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+
+  if (batch_count == 1) {
+    batch->callback(batch->user_data, iree_ok_status(), batched_outputs);
+    iree_runtime_batcher_request_free(batcher, batch);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+
+  iree_hal_dim_t row_offset = 0;
+  while (batch) {
+    iree_runtime_batcher_request_t* next = batch->next;
+    iree_vm_list_t* outputs = NULL;
+    status = iree_runtime_batcher_scatter_outputs(
+        batcher, batched_outputs, total_row_count, row_offset, batch, &outputs);
+    row_offset += batch->row_count;
+    batch->callback(batch->user_data, status, outputs);
+    iree_runtime_batcher_request_free(batcher, batch);
+    batch = next;
+  }
+  iree_vm_list_release(batched_outputs);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_runtime_batcher_has_work(iree_runtime_batcher_t* batcher) {
+  iree_slim_mutex_lock(&batcher->mutex);
+  bool has_work = batcher->pending_head || batcher->exit_requested;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  return has_work;
+}
+
+static bool iree_runtime_batcher_is_batch_full(
+    iree_runtime_batcher_t* batcher) {
+  iree_slim_mutex_lock(&batcher->mutex);
+  bool is_full = batcher->pending_count >= batcher->options.max_batch_size ||
+                 batcher->exit_requested;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  return is_full;
+}
+
+static int iree_runtime_batcher_main(void* entry_arg) {
+  iree_runtime_batcher_t* batcher = (iree_runtime_batcher_t*)entry_arg;
+  for (;;) {
+    iree_notification_await(&batcher->notification,
+                            (iree_condition_fn_t)iree_runtime_batcher_has_work,
+                            batcher, iree_infinite_timeout());
+    iree_slim_mutex_lock(&batcher->mutex);
+    // Only this thread removes requests so |head| remains valid once unlocked.
+    iree_runtime_batcher_request_t* head = batcher->pending_head;
+    bool exit_requested = batcher->exit_requested;
+    iree_slim_mutex_unlock(&batcher->mutex);
+    if (!head) {
+      if (exit_requested) break;
+      continue;
+    }
+
+    // Wait for the batch to fill up until the oldest request has waited for
+    // the maximum delay. Pending requests are flushed immediately on exit.
+    if (!exit_requested) {
+      iree_timeout_t timeout =
+          batcher->options.max_batch_delay == IREE_DURATION_INFINITE
+              ? iree_infinite_timeout()
+              : iree_make_deadline(head->enqueue_time_ns +
+                                   batcher->options.max_batch_delay);
+      iree_notification_await(
+          &batcher->notification,
+          (iree_condition_fn_t)iree_runtime_batcher_is_batch_full, batcher,
+          timeout);
+    }
+
+    iree_host_size_t batch_count = 0;
+    iree_runtime_batcher_request_t* batch =
+        iree_runtime_batcher_pop_batch(batcher, &batch_count);
+    iree_runtime_batcher_execute_batch(batcher, batch, batch_count);
+  }
+  return 0;
+}
+
+static void iree_runtime_batcher_destroy(iree_runtime_batcher_t* batcher) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (batcher->thread) {
+    iree_slim_mutex_lock(&batcher->mutex);
+    batcher->exit_requested = true;
+    iree_slim_mutex_unlock(&batcher->mutex);
+    iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+    // Joins the thread once it has completed all pending requests.
+    iree_thread_release(batcher->thread);
+  }
+
+  iree_notification_deinitialize(&batcher->notification);
+  iree_slim_mutex_deinitialize(&batcher->mutex);
+  iree_runtime_session_release(batcher->session);
+  iree_allocator_free(batcher->host_allocator, batcher);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_runtime_batcher_t** out_batcher) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_batcher);
+  *out_batcher = NULL;
+  if (options->max_batch_size == 0 || options->max_batch_delay < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid batcher options: max_batch_size=%" PRIhsz
+                            " max_batch_delay=%" PRId64,
+                            options->max_batch_size,
+                            (int64_t)options->max_batch_delay);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_t host_allocator =
+      iree_runtime_session_host_allocator(session);
+  iree_runtime_batcher_t* batcher = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*batcher),
+                                (void**)&batcher));
+  memset(batcher, 0, sizeof(*batcher));
+  iree_atomic_ref_count_init(&batcher->ref_count);
+  batcher->host_allocator = host_allocator;
+  batcher->session = session;
+  iree_runtime_session_retain(session);
+  batcher->function = function;
+  batcher->options = *options;
+  iree_notification_initialize(&batcher->notification);
+  iree_slim_mutex_initialize(&batcher->mutex);
+
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = iree_make_cstring_view("iree-runtime-batcher");
+  iree_status_t status =
+      iree_thread_create(iree_runtime_batcher_main, batcher, thread_params,
+                         host_allocator, &batcher->thread);
+
+  if (iree_status_is_ok(status)) {
+    *out_batcher = batcher;
+  } else {
+    iree_runtime_batcher_destroy(batcher);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher) {
+    iree_atomic_ref_count_inc(&batcher->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher && iree_atomic_ref_count_dec(&batcher->ref_count) == 1) {
+    iree_runtime_batcher_destroy(batcher);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_enqueue(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_runtime_batcher_callback_fn_t callback, void* user_data) {
+  IREE_ASSERT_ARGUMENT(batcher);
+  IREE_ASSERT_ARGUMENT(inputs);
+  IREE_ASSERT_ARGUMENT(callback);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_dim_t row_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_runtime_batcher_count_rows(inputs, &row_count));
+
+  iree_runtime_batcher_request_t* request = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(batcher->host_allocator, sizeof(*request),
+                                (void**)&request));
+  request->next = NULL;
+  request->inputs = inputs;
+  iree_vm_list_retain(inputs);
+  request->row_count = row_count;
+  request->enqueue_time_ns = iree_time_now();
+  request->callback = callback;
+  request->user_data = user_data;
+
+  iree_slim_mutex_lock(&batcher->mutex);
+  if (batcher->pending_tail) {
+    batcher->pending_tail->next = request;
+  } else {
+    batcher->pending_head = request;
+  }
+  batcher->pending_tail = request;
+  ++batcher->pending_count;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
@@ -0,0 +1,111 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_BATCHER_H_
+#define IREE_RUNTIME_BATCHER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_runtime_session_t iree_runtime_session_t;
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// Callback issued when a batched request completes.
+// |status| is either the failure of the batch the request was part of or OK.
+// If successful |outputs| contains the results of the request. Both |status|
+// and |outputs| (if not NULL) are owned by the callee and must be released.
+//
+// Called from the batcher thread and must not block: any blocking work delays
+// the formation of the next batch.
+typedef void(IREE_API_PTR* iree_runtime_batcher_callback_fn_t)(
+    void* user_data, iree_status_t status, iree_vm_list_t* outputs);
+
+// Options controlling batch formation.
+typedef struct iree_runtime_batcher_options_t {
+  // Maximum number of requests combined into a single invocation.
+  iree_host_size_t max_batch_size;
+  // Maximum time the oldest pending request waits for others to arrive before
+  // the batch is invoked with the requests available.
+  iree_duration_t max_batch_delay;
+} iree_runtime_batcher_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options);
+
+// Combines requests to a batch-size-polymorphic function into batched calls.
+//
+// Requests are collected on a batcher thread until either max_batch_size
+// requests are pending or the oldest has waited max_batch_delay. The buffer
+// view inputs of the requests are then concatenated along their outermost
+// dimension with device-side copies, the function is called once with the
+// batched inputs, and each request receives views of its rows of the batched
+// buffer view outputs.
+//
+// The function must follow these conventions:
+// * All buffer view arguments and results are batched along dimension 0 and
+//   must be dense. Within a request all buffer view inputs have the same
+//   (non-zero) outer dimension, which is the number of rows the request
+//   contributes to the batch.
+// * Arguments that are not buffer views (such as scalars) are taken from the
+//   first request in the batch. Requests only share a batch if their inputs
+//   have the same types and buffer views have identical element types,
+//   encodings and inner dimensions.
+// * Results that are not buffer views or whose outer dimension does not match
+//   the total number of rows in the batch are shared by all requests in the
+//   batch. Results are classified only by their shape: a shared buffer view
+//   whose outer dimension happens to equal the batch row count is split like
+//   a batched one, so functions must not return shared buffer views whose
+//   outer dimension can take that value. A request that ends up alone in a
+//   batch receives the results of the call unmodified.
+//
+// Output buffer views of a request reference the batched buffer and keep it
+// live until all requests of the batch release their outputs.
+//
+// Thread-safe: requests may be enqueued from any thread.
+typedef struct iree_runtime_batcher_t iree_runtime_batcher_t;
+
+// Creates a batcher for calls to |function| within |session| and launches its
+// thread.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_runtime_batcher_t** out_batcher);
+
+// Retains the given |batcher| for the caller.
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher);
+
+// Releases the given |batcher| from the caller.
+// When the last reference is released all pending requests are completed and
+// the batcher thread is joined before returning.
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher);
+
+// Enqueues a request with the given |inputs| for inclusion in a batch.
+// The call returns immediately and |callback| is issued with |user_data| from
+// the batcher thread once the batch containing the request completes.
+//
+// |inputs| is retained until the request completes. The callback is only
+// issued if this returns OK.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_enqueue(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_runtime_batcher_callback_fn_t callback, void* user_data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_BATCHER_H_
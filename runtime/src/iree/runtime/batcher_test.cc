@@ -0,0 +1,361 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/instance.h"
+#include "iree/runtime/session.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_cc.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+//===----------------------------------------------------------------------===//
+// echo module
+//===----------------------------------------------------------------------===//
+
+// Batch-size-polymorphic function used as the batcher target:
+//   echo.echo(%input: !hal.buffer_view) -> (!hal.buffer_view, i32)
+// Returns its input unchanged along with the number of rows it was called
+// with. The buffer view result is split across the requests of a batch while
+// the row count is shared by all of them.
+class EchoModuleState final {
+ public:
+  StatusOr<std::tuple<vm::ref<iree_hal_buffer_view_t>, int32_t>> Echo(
+      vm::ref<iree_hal_buffer_view_t> input) {
+    int32_t row_count = (int32_t)iree_hal_buffer_view_shape_dim(input.get(), 0);
+    return std::make_tuple(std::move(input), row_count);
+  }
+};
+
+static const vm::NativeFunction<EchoModuleState> kEchoModuleFunctions[] = {
+    vm::MakeNativeFunction("echo", &EchoModuleState::Echo),
+};
+
+class EchoModule final : public vm::NativeModule<EchoModuleState> {
+ public:
+  using vm::NativeModule<EchoModuleState>::NativeModule;
+
+  StatusOr<std::unique_ptr<EchoModuleState>> CreateState(
+      iree_allocator_t allocator) override {
+    return std::make_unique<EchoModuleState>();
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// Request tracking
+//===----------------------------------------------------------------------===//
+
+// Results of a single request as reported to its callback.
+struct Request {
+  // Index of the request in enqueue order.
+  int index = 0;
+  // Rows the request contributed to its batch.
+  int32_t row_count = 0;
+  // Inputs enqueued for the request.
+  vm::ref<iree_vm_list_t> inputs;
+  // Outputs returned to the callback.
+  vm::ref<iree_vm_list_t> outputs;
+  iree_status_code_t status_code = IREE_STATUS_OK;
+};
+
+// Collects request completions in the order the batcher issues them.
+struct Completions {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<Request*> order;
+
+  void WaitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return order.size() >= count; });
+  }
+};
+
+struct CallbackState {
+  Completions* completions;
+  Request* request;
+};
+
+static void OnRequestComplete(void* user_data, iree_status_t status,
+                              iree_vm_list_t* outputs) {
+  auto* state = reinterpret_cast<CallbackState*>(user_data);
+  state->request->status_code = iree_status_consume_code(status);
+  state->request->outputs = vm::assign_ref(outputs);
+  {
+    std::lock_guard<std::mutex> lock(state->completions->mutex);
+    state->completions->order.push_back(state->request);
+  }
+  state->completions->cv.notify_all();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+class BatcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    iree_runtime_instance_options_use_all_available_drivers(&instance_options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(
+        &instance_options, iree_allocator_system(), &instance_));
+    iree_status_t status = iree_runtime_instance_try_create_default_device(
+        instance_, iree_make_cstring_view("local-sync"), &device_);
+    if (iree_status_is_not_found(status)) {
+      fprintf(stderr, "Skipping test as 'local-sync' driver was not found:\n");
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      GTEST_SKIP();
+    }
+    IREE_ASSERT_OK(status);
+
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    IREE_ASSERT_OK(iree_runtime_session_create_with_device(
+        instance_, &session_options, device_, iree_allocator_system(),
+        &session_));
+
+    auto module = std::make_unique<EchoModule>(
+        "echo", /*version=*/0, iree_runtime_instance_vm_instance(instance_),
+        iree_allocator_system(),
+        iree::span<const vm::NativeFunction<EchoModuleState>>(
+            kEchoModuleFunctions));
+    iree_vm_module_t* echo_module = module.release()->interface();
+    IREE_ASSERT_OK(iree_runtime_session_append_module(session_, echo_module));
+    iree_vm_module_release(echo_module);
+    IREE_ASSERT_OK(iree_runtime_session_lookup_function(
+        session_, iree_make_cstring_view("echo.echo"), &function_));
+  }
+
+  void TearDown() override {
+    iree_runtime_session_release(session_);
+    iree_hal_device_release(device_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  iree_runtime_batcher_t* CreateBatcher(iree_host_size_t max_batch_size,
+                                        iree_duration_t max_batch_delay) {
+    iree_runtime_batcher_options_t options;
+    iree_runtime_batcher_options_initialize(&options);
+    options.max_batch_size = max_batch_size;
+    options.max_batch_delay = max_batch_delay;
+    iree_runtime_batcher_t* batcher = nullptr;
+    IREE_CHECK_OK(
+        iree_runtime_batcher_create(session_, function_, &options, &batcher));
+    return batcher;
+  }
+
+  // Enqueues a request with a [row_count, inner_dim] i32 input where each
+  // element holds |index| * 1000 + its linear offset so that rows returned to
+  // the wrong request are detected.
+  void Enqueue(iree_runtime_batcher_t* batcher, int index, int32_t row_count,
+               iree_hal_dim_t inner_dim) {
+    auto request = std::make_unique<Request>();
+    request->index = index;
+    request->row_count = row_count;
+    std::vector<int32_t> contents(row_count * inner_dim);
+    for (size_t i = 0; i < contents.size(); ++i) {
+      contents[i] = index * 1000 + (int32_t)i;
+    }
+    iree_hal_dim_t shape[2] = {(iree_hal_dim_t)row_count, inner_dim};
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                   IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_view_t* buffer_view = nullptr;
+    IREE_ASSERT_OK(iree_hal_buffer_view_allocate_buffer(
+        iree_hal_device_allocator(device_), 2, shape,
+        IREE_HAL_ELEMENT_TYPE_INT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+        params,
+        iree_make_const_byte_span(contents.data(),
+                                  contents.size() * sizeof(int32_t)),
+        &buffer_view));
+    IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                       iree_allocator_system(),
+                                       &request->inputs));
+    iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
+    IREE_ASSERT_OK(
+        iree_vm_list_push_ref_move(request->inputs.get(), &buffer_view_ref));
+
+    callback_states_.push_back(std::make_unique<CallbackState>(
+        CallbackState{&completions_, request.get()}));
+    IREE_ASSERT_OK(iree_runtime_batcher_enqueue(
+        batcher, request->inputs.get(), OnRequestComplete,
+        callback_states_.back().get()));
+    requests_.push_back(std::move(request));
+  }
+
+  // Verifies that |request| received exactly its own rows and returns the
+  // total number of rows in the batch it was part of.
+  int32_t CheckRequestOutputs(const Request& request) {
+    EXPECT_EQ(request.status_code, IREE_STATUS_OK);
+    if (!request.outputs) {
+      ADD_FAILURE() << "request " << request.index << " has no outputs";
+      return 0;
+    }
+    EXPECT_EQ(iree_vm_list_size(request.outputs.get()), 2);
+    iree_hal_buffer_view_t* output =
+        iree_vm_list_get_buffer_view_assign(request.outputs.get(), 0);
+    iree_hal_buffer_view_t* input =
+        iree_vm_list_get_buffer_view_assign(request.inputs.get(), 0);
+    if (!output) {
+      ADD_FAILURE() << "request " << request.index << " has no buffer view";
+      return 0;
+    }
+    EXPECT_EQ(iree_hal_buffer_view_shape_dim(output, 0),
+              (iree_hal_dim_t)request.row_count);
+    EXPECT_EQ(iree_hal_buffer_view_shape_dim(output, 1),
+              iree_hal_buffer_view_shape_dim(input, 1));
+
+    iree_device_size_t byte_length = iree_hal_buffer_view_byte_length(input);
+    EXPECT_EQ(iree_hal_buffer_view_byte_length(output), byte_length);
+    std::vector<int32_t> expected(byte_length / sizeof(int32_t));
+    std::vector<int32_t> actual(byte_length / sizeof(int32_t));
+    IREE_EXPECT_OK(iree_hal_device_transfer_d2h(
+        device_, iree_hal_buffer_view_buffer(input), 0, expected.data(),
+        byte_length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+    IREE_EXPECT_OK(iree_hal_device_transfer_d2h(
+        device_, iree_hal_buffer_view_buffer(output), 0, actual.data(),
+        byte_length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+    EXPECT_EQ(actual, expected) << "request " << request.index;
+
+    iree_vm_value_t batch_row_count = iree_vm_value_make_i32(0);
+    IREE_EXPECT_OK(
+        iree_vm_list_get_value(request.outputs.get(), 1, &batch_row_count));
+    return batch_row_count.i32;
+  }
+
+  // Returns the request indices in completion order.
+  std::vector<int> CompletionOrder() {
+    std::lock_guard<std::mutex> lock(completions_.mutex);
+    std::vector<int> order;
+    for (Request* request : completions_.order) order.push_back(request->index);
+    return order;
+  }
+
+  iree_runtime_instance_t* instance_ = nullptr;
+  iree_hal_device_t* device_ = nullptr;
+  iree_runtime_session_t* session_ = nullptr;
+  iree_vm_function_t function_;
+
+  Completions completions_;
+  std::vector<std::unique_ptr<Request>> requests_;
+  std::vector<std::unique_ptr<CallbackState>> callback_states_;
+};
+
+TEST_F(BatcherTest, InvalidOptions) {
+  iree_runtime_batcher_options_t options;
+  iree_runtime_batcher_options_initialize(&options);
+  options.max_batch_size = 0;
+  iree_runtime_batcher_t* batcher = nullptr;
+  EXPECT_THAT(Status(iree_runtime_batcher_create(session_, function_, &options,
+                                                 &batcher)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(batcher, nullptr);
+}
+
+// Requests without a buffer view to batch along are rejected on enqueue.
+TEST_F(BatcherTest, EnqueueWithoutBufferView) {
+  iree_runtime_batcher_t* batcher =
+      CreateBatcher(/*max_batch_size=*/4, IREE_DURATION_INFINITE);
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_value_t value = iree_vm_value_make_i32(1);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs.get(), &value));
+  EXPECT_THAT(Status(iree_runtime_batcher_enqueue(
+                  batcher, inputs.get(), OnRequestComplete, nullptr)),
+              StatusIs(StatusCode::kInvalidArgument));
+  iree_runtime_batcher_release(batcher);
+}
+
+// A batch is formed as soon as max_batch_size requests are pending and the
+// remaining requests are flushed when the batcher is released. Each request
+// receives its own rows of the batched result even when requests contribute
+// different numbers of rows.
+TEST_F(BatcherTest, MaxBatchSize) {
+  iree_runtime_batcher_t* batcher =
+      CreateBatcher(/*max_batch_size=*/4, IREE_DURATION_INFINITE);
+  for (int i = 0; i < 6; ++i) {
+    Enqueue(batcher, i, /*row_count=*/i + 1, /*inner_dim=*/3);
+  }
+  // With an infinite delay only a full batch can complete before release.
+  completions_.WaitFor(4);
+  EXPECT_EQ(CompletionOrder(), (std::vector<int>{0, 1, 2, 3}));
+  iree_runtime_batcher_release(batcher);
+
+  ASSERT_EQ(CompletionOrder(), (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(CheckRequestOutputs(*requests_[i]), 1 + 2 + 3 + 4);
+  }
+  for (int i = 4; i < 6; ++i) {
+    EXPECT_EQ(CheckRequestOutputs(*requests_[i]), 5 + 6);
+  }
+}
+
+// A batch that never fills up is invoked once its oldest request has waited
+// max_batch_delay without needing the batcher to be released.
+TEST_F(BatcherTest, MaxBatchDelay) {
+  iree_runtime_batcher_t* batcher =
+      CreateBatcher(/*max_batch_size=*/8, /*max_batch_delay=*/1000000);  // 1ms
+  for (int i = 0; i < 3; ++i) {
+    Enqueue(batcher, i, /*row_count=*/1, /*inner_dim=*/2);
+  }
+  completions_.WaitFor(3);
+  EXPECT_EQ(CompletionOrder(), (std::vector<int>{0, 1, 2}));
+  for (const auto& request : requests_) {
+    // Requests arriving after the delay expired form their own batch so the
+    // batch may contain 1 to 3 rows.
+    int32_t batch_row_count = CheckRequestOutputs(*request);
+    EXPECT_GE(batch_row_count, 1);
+    EXPECT_LE(batch_row_count, 3);
+  }
+  iree_runtime_batcher_release(batcher);
+}
+
+// Requests that cannot share a batch with the oldest request keep their
+// relative order and are batched together afterwards.
+TEST_F(BatcherTest, IncompatibleRequestsKeepOrder) {
+  // The batch never fills up so all requests are flushed on release.
+  iree_runtime_batcher_t* batcher =
+      CreateBatcher(/*max_batch_size=*/8, IREE_DURATION_INFINITE);
+  // Requests alternate between two inner dimensions: 0, 2 and 4 are
+  // compatible with each other as are 1 and 3.
+  for (int i = 0; i < 5; ++i) {
+    Enqueue(batcher, i, /*row_count=*/i + 1, /*inner_dim=*/(i % 2) ? 3 : 2);
+  }
+  iree_runtime_batcher_release(batcher);
+
+  EXPECT_EQ(CompletionOrder(), (std::vector<int>{0, 2, 4, 1, 3}));
+  for (int i : {0, 2, 4}) {
+    EXPECT_EQ(CheckRequestOutputs(*requests_[i]), 1 + 3 + 5);
+  }
+  for (int i : {1, 3}) {
+    EXPECT_EQ(CheckRequestOutputs(*requests_[i]), 2 + 4);
+  }
+}
+
+}  // namespace
+}  // namespace iree
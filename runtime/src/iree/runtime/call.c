@@ -10,6 +10,8 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
 #include "iree/modules/hal/module.h"
 #include "iree/runtime/session.h"
 
@@ -122,3 +124,268 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_outputs_pop_front_buffer_view(
   IREE_RETURN_IF_ERROR(iree_vm_list_pop_front_ref_move(call->outputs, &value));
   return iree_hal_buffer_view_check_deref(value, out_buffer_view);
 }
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_allocate_output_storage(
+    const iree_runtime_call_t* call, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_storage) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(out_storage);
+  *out_storage = NULL;
+  iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
+              IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
+  };
+  return iree_hal_allocator_allocate_buffer(
+      iree_runtime_session_device_allocator(call->session), params,
+      allocation_size, iree_const_byte_span_empty(), out_storage);
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_output_storage(
+    iree_runtime_call_t* call, iree_hal_buffer_t* storage) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(storage);
+  iree_vm_ref_t value = {0};
+  IREE_RETURN_IF_ERROR(
+      iree_vm_ref_wrap_assign(storage, iree_hal_buffer_type_id(), &value));
+  return iree_vm_list_push_ref_retain(call->inputs, &value);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_call_ring_t
+//===----------------------------------------------------------------------===//
+
+struct iree_runtime_call_ring_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* device;
+
+  // Timeline advanced by one as each request completes. Request N (1-based)
+  // waits for value N-1 and signals value N.
+  iree_hal_semaphore_t* semaphore;
+  // Total number of requests submitted.
+  uint64_t submit_count;
+  // Whether the slot of the next request has been acquired.
+  bool acquired;
+
+  iree_host_size_t slot_count;
+  iree_runtime_call_t slots[];
+};
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    iree_host_size_t slot_count, iree_runtime_call_ring_t** out_ring) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(out_ring);
+  *out_ring = NULL;
+  if (slot_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "call rings require at least one slot");
+  }
+  iree_string_view_t model = iree_vm_function_lookup_attr_by_name(
+      &function, IREE_SV("iree.abi.model"));
+  if (!iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+    iree_string_view_t name = iree_vm_function_name(&function);
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "function '%.*s' does not use the coarse-fences ABI and cannot be "
+        "pipelined",
+        (int)name.size, name.data);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)slot_count);
+
+  iree_allocator_t host_allocator =
+      iree_runtime_session_host_allocator(session);
+  iree_runtime_call_ring_t* ring = NULL;
+  iree_host_size_t total_size =
+      sizeof(*ring) + slot_count * sizeof(ring->slots[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&ring));
+  memset(ring, 0, total_size);
+  iree_atomic_ref_count_init(&ring->ref_count);
+  ring->host_allocator = host_allocator;
+  ring->device = iree_runtime_session_device(session);
+  iree_hal_device_retain(ring->device);
+  ring->slot_count = slot_count;
+
+  iree_status_t status =
+      iree_hal_semaphore_create(ring->device, 0ull, &ring->semaphore);
+  for (iree_host_size_t i = 0; i < slot_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_runtime_call_initialize(session, function, &ring->slots[i]);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_ring = ring;
+  } else {
+    iree_runtime_call_ring_release(ring);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_runtime_call_ring_destroy(iree_runtime_call_ring_t* ring) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // In-flight requests may still reference the slot lists and fences.
+  if (ring->semaphore) {
+    iree_status_ignore(
+        iree_runtime_call_ring_wait_idle(ring, iree_infinite_timeout()));
+  }
+  for (iree_host_size_t i = 0; i < ring->slot_count; ++i) {
+    if (ring->slots[i].session) iree_runtime_call_deinitialize(&ring->slots[i]);
+  }
+  iree_hal_semaphore_release(ring->semaphore);
+  iree_hal_device_release(ring->device);
+  iree_allocator_free(ring->host_allocator, ring);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_runtime_call_ring_retain(
+    iree_runtime_call_ring_t* ring) {
+  if (ring) iree_atomic_ref_count_inc(&ring->ref_count);
+}
+
+IREE_API_EXPORT void iree_runtime_call_ring_release(
+    iree_runtime_call_ring_t* ring) {
+  if (ring && iree_atomic_ref_count_dec(&ring->ref_count) == 1) {
+    iree_runtime_call_ring_destroy(ring);
+  }
+}
+
+// Returns the slot used by the request following all submitted ones.
+static iree_runtime_call_t* iree_runtime_call_ring_next_slot(
+    iree_runtime_call_ring_t* ring) {
+  return &ring->slots[ring->submit_count % ring->slot_count];
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_acquire(
+    iree_runtime_call_ring_t* ring, iree_timeout_t timeout,
+    iree_runtime_call_t** out_call) {
+  IREE_ASSERT_ARGUMENT(ring);
+  IREE_ASSERT_ARGUMENT(out_call);
+  *out_call = NULL;
+  iree_runtime_call_t* call = iree_runtime_call_ring_next_slot(ring);
+  if (ring->acquired) {
+    *out_call = call;
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Fail early if a prior request failed.
+  uint64_t current_value = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_semaphore_query(ring->semaphore, &current_value));
+
+  // Wait for the request last submitted through the slot to complete so that
+  // its lists are no longer in use. This is a no-op until the ring wraps.
+  if (ring->submit_count >= ring->slot_count) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_semaphore_wait(ring->semaphore,
+                                    ring->submit_count - ring->slot_count + 1,
+                                    timeout));
+  }
+
+  iree_runtime_call_reset(call);
+  ring->acquired = true;
+  *out_call = call;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Appends the fences of the next request to the inputs of |call|. The signal
+// fence is returned in |out_signal_fence|.
+static iree_status_t iree_runtime_call_ring_append_fences(
+    iree_runtime_call_ring_t* ring, iree_runtime_call_t* call,
+    iree_hal_fence_t* user_wait_fence, iree_hal_fence_t** out_signal_fence) {
+  // Order after the prior request (if any) and the user fence (if any).
+  iree_host_size_t wait_capacity = 1;
+  if (user_wait_fence) {
+    wait_capacity += iree_hal_fence_timepoint_count(user_wait_fence);
+  }
+  iree_hal_fence_t* wait_fence = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_fence_create(
+      wait_capacity, ring->host_allocator, &wait_fence));
+  iree_status_t status = iree_ok_status();
+  if (ring->submit_count > 0) {
+    status =
+        iree_hal_fence_insert(wait_fence, ring->semaphore, ring->submit_count);
+  }
+  if (iree_status_is_ok(status) && user_wait_fence) {
+    status = iree_hal_fence_extend(wait_fence, user_wait_fence);
+  }
+
+  iree_hal_fence_t* signal_fence = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_create_at(ring->semaphore, ring->submit_count + 1,
+                                      ring->host_allocator, &signal_fence);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t wait_fence_ref = iree_hal_fence_move_ref(wait_fence);
+    status = iree_vm_list_push_ref_move(call->inputs, &wait_fence_ref);
+    wait_fence = NULL;
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(call->inputs, &signal_fence_ref);
+    iree_vm_ref_release(&signal_fence_ref);
+  }
+
+  iree_hal_fence_release(wait_fence);
+  if (iree_status_is_ok(status)) {
+    *out_signal_fence = signal_fence;
+  } else {
+    iree_hal_fence_release(signal_fence);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_submit(
+    iree_runtime_call_ring_t* ring, iree_hal_fence_t* wait_fence,
+    iree_hal_fence_t** out_signal_fence) {
+  IREE_ASSERT_ARGUMENT(ring);
+  IREE_ASSERT_ARGUMENT(out_signal_fence);
+  *out_signal_fence = NULL;
+  if (!ring->acquired) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "no call acquired for submission");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)ring->submit_count);
+
+  iree_runtime_call_t* call = iree_runtime_call_ring_next_slot(ring);
+  iree_hal_fence_t* signal_fence = NULL;
+  iree_status_t status = iree_runtime_call_ring_append_fences(
+      ring, call, wait_fence, &signal_fence);
+  if (iree_status_is_ok(status)) {
+    // Returns once the work has been queued on the device.
+    status = iree_runtime_call_invoke(call, IREE_RUNTIME_CALL_FLAG_RESERVED);
+  }
+  ring->acquired = false;
+
+  if (iree_status_is_ok(status)) {
+    ++ring->submit_count;
+    *out_signal_fence = signal_fence;
+  } else {
+    // The request will never signal and all requests ordered after it would
+    // deadlock; fail the ring instead.
+    iree_hal_semaphore_fail(ring->semaphore, iree_status_clone(status));
+    iree_hal_fence_release(signal_fence);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_wait_idle(
+    iree_runtime_call_ring_t* ring, iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(ring);
+  if (ring->submit_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status =
+      iree_hal_semaphore_wait(ring->semaphore, ring->submit_count, timeout);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
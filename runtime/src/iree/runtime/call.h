@@ -111,6 +111,95 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer_view(
 IREE_API_EXPORT iree_status_t iree_runtime_call_outputs_pop_front_buffer_view(
     iree_runtime_call_t* call, iree_hal_buffer_view_t** out_buffer_view);
 
+// Allocates |allocation_size| bytes from the session device allocator for use
+// as output storage with iree_runtime_call_inputs_push_back_output_storage.
+// The storage is host-mappable so that results can be read without a copy.
+//
+// Applications serving steady-state traffic should allocate storage once and
+// bind it to each call instead of having the module allocate every result.
+IREE_API_EXPORT iree_status_t iree_runtime_call_allocate_output_storage(
+    const iree_runtime_call_t* call, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_storage);
+
+// Pushes |storage| to the call inputs list as the backing storage of a result.
+// The function argument must be a `!hal.buffer` annotated with the ordinal of
+// the result it stores:
+//   func.func @fn(%input: tensor<4xf32>,
+//                 %storage: !hal.buffer {iree.abi.output = 0 : index})
+//       -> tensor<4xf32>
+// The result is written in place and the buffer view returned for it
+// references |storage| instead of a buffer allocated by the module. Any HAL
+// buffer of sufficient size may be used including ones allocated with
+// iree_runtime_call_allocate_output_storage or imported from application
+// memory with iree_hal_allocator_import_buffer.
+//
+// The storage is retained by the inputs list until the call is reset.
+IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_output_storage(
+    iree_runtime_call_t* call, iree_hal_buffer_t* storage);
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_call_ring_t
+//===----------------------------------------------------------------------===//
+
+// A ring of reusable calls for pipelining invocations of one asynchronous
+// function.
+//
+// The function must use the coarse-fences ABI (`iree.abi.model` of
+// `coarse-fences`): the (wait, signal) fence pair is appended to the inputs on
+// submission and the invocation returns as soon as the device work has been
+// queued. This allows the host to prepare and submit the next request while
+// the device is still executing prior ones.
+//
+// Each slot owns an iree_runtime_call_t whose input and output lists are
+// allocated once when the ring is created and reused for every request
+// submitted through that slot. Requests are executed in submission order:
+// each one waits for the one before it on the device queue. A slot is only
+// handed out again once the request previously submitted through it has
+// completed and callers must consume its outputs before then.
+//
+// If an invocation fails the ring enters a failed state. Completion fences of
+// all in-flight and future requests fail with that status.
+//
+// Thread-compatible; callers must synchronize acquisition and submission.
+typedef struct iree_runtime_call_ring_t iree_runtime_call_ring_t;
+
+// Creates a ring of |slot_count| calls to |function| within |session|.
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    iree_host_size_t slot_count, iree_runtime_call_ring_t** out_ring);
+
+// Retains the given |ring| for the caller.
+IREE_API_EXPORT void iree_runtime_call_ring_retain(
+    iree_runtime_call_ring_t* ring);
+
+// Releases the given |ring| from the caller.
+// When the last reference is released all in-flight requests are waited on.
+IREE_API_EXPORT void iree_runtime_call_ring_release(
+    iree_runtime_call_ring_t* ring);
+
+// Acquires the next slot in the ring and returns its call with empty input and
+// output lists in |out_call|. Blocks until the request previously submitted
+// through the slot completes or |timeout| elapses. The call must be populated
+// with the function arguments, excluding the fences, and then submitted with
+// iree_runtime_call_ring_submit before the next slot can be acquired.
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_acquire(
+    iree_runtime_call_ring_t* ring, iree_timeout_t timeout,
+    iree_runtime_call_t** out_call);
+
+// Submits the call acquired with iree_runtime_call_ring_acquire.
+// The request waits for all prior requests in the ring and for the optional
+// |wait_fence| before executing on the device. Returns a fence in
+// |out_signal_fence| that is signaled when the request has completed and its
+// outputs are available; the caller must release it.
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_submit(
+    iree_runtime_call_ring_t* ring, iree_hal_fence_t* wait_fence,
+    iree_hal_fence_t** out_signal_fence);
+
+// Blocks until all submitted requests have completed or |timeout| elapses.
+// Returns the failure of the ring if any request failed.
+IREE_API_EXPORT iree_status_t iree_runtime_call_ring_wait_idle(
+    iree_runtime_call_ring_t* ring, iree_timeout_t timeout);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -10,12 +10,21 @@
 #include <string.h>
 
 #include "iree/base/internal/atomics.h"
+#include "iree/base/internal/slab_allocator.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/init.h"
 #include "iree/modules/hal/module.h"
 #include "iree/vm/api.h"
 
+// Substitutes the slab allocator for the system allocator when an instance is
+// created with iree_allocator_system(). Small host allocations made on hot
+// paths (VM lists, invocation frames, ref wrappers) are then served from
+// thread-local free lists instead of going to malloc.
+#if !defined(IREE_RUNTIME_USE_SLAB_ALLOCATOR)
+#define IREE_RUNTIME_USE_SLAB_ALLOCATOR 1
+#endif  // !IREE_RUNTIME_USE_SLAB_ALLOCATOR
+
 //===----------------------------------------------------------------------===//
 // iree_runtime_instance_options_t
 //===----------------------------------------------------------------------===//
@@ -64,6 +73,12 @@ IREE_API_EXPORT iree_status_t iree_runtime_instance_create(
   *out_instance = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+#if IREE_RUNTIME_USE_SLAB_ALLOCATOR
+  if (host_allocator.ctl == iree_allocator_system_ctl) {
+    host_allocator = iree_allocator_slab();
+  }
+#endif  // IREE_RUNTIME_USE_SLAB_ALLOCATOR
+
   // Allocate the instance state.
   iree_runtime_instance_t* instance = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -82,7 +82,12 @@ IREE_API_EXPORT void iree_runtime_instance_options_use_all_available_drivers(
 // managed correctly.
 //
 // |host_allocator| will be used to allocate the instance and any associated
-// resources. |out_instance| must be released by the caller.
+// resources. If it is iree_allocator_system() the instance will instead use
+// iree_allocator_slab() to serve small allocations from thread-local caches;
+// define IREE_RUNTIME_USE_SLAB_ALLOCATOR=0 to disable this. Callers should
+// allocate using iree_runtime_instance_host_allocator and not assume the
+// allocator they passed is the one in use. |out_instance| must be released by
+// the caller.
 IREE_API_EXPORT iree_status_t iree_runtime_instance_create(
     const iree_runtime_instance_options_t* options,
     iree_allocator_t host_allocator, iree_runtime_instance_t** out_instance);
@@ -0,0 +1,393 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/scheduler.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/base/loop_sync.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_scheduler_options_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_runtime_scheduler_options_initialize(
+    iree_runtime_scheduler_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->worker_count = 1;
+  out_options->max_in_flight_per_worker = 128;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_scheduler_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_runtime_scheduler_worker_t iree_runtime_scheduler_worker_t;
+
+// A scheduled invocation.
+// Queued on a worker until it has capacity to begin the invocation and then
+// live until the invocation completes.
+typedef struct iree_runtime_scheduler_invocation_t {
+  // Next invocation in the worker pending queue.
+  struct iree_runtime_scheduler_invocation_t* next;
+  // Worker the invocation was begun on.
+  iree_runtime_scheduler_worker_t* worker;
+  iree_vm_context_t* context;
+  iree_vm_function_t function;
+  iree_vm_invocation_flags_t flags;
+  iree_vm_list_t* inputs;
+  iree_vm_list_t* outputs;
+  iree_runtime_scheduler_callback_fn_t callback;
+  void* user_data;
+  // Async invocation state holding the suspended VM stack.
+  iree_vm_async_invoke_state_t state;
+} iree_runtime_scheduler_invocation_t;
+
+struct iree_runtime_scheduler_worker_t {
+  iree_runtime_scheduler_t* scheduler;
+  iree_thread_t* thread;
+
+  // Loop the worker runs invocations on. Only accessed from the worker thread.
+  iree_loop_sync_t* loop_sync;
+  iree_loop_sync_scope_t scope;
+  // Total number of invocations begun on the loop that have not completed.
+  iree_host_size_t in_flight_count;
+
+  // Set when invocations are queued or the worker has been asked to exit.
+  // The worker loop waits on this alongside the waits of its invocations.
+  iree_event_t wake_event;
+
+  iree_slim_mutex_t mutex;
+  // FIFO of invocations waiting to begin.
+  iree_runtime_scheduler_invocation_t* pending_head IREE_GUARDED_BY(mutex);
+  iree_runtime_scheduler_invocation_t* pending_tail IREE_GUARDED_BY(mutex);
+  // True once the scheduler is being destroyed. The worker exits after all
+  // pending and in-flight invocations have completed.
+  bool exit_requested IREE_GUARDED_BY(mutex);
+};
+
+struct iree_runtime_scheduler_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_host_size_t max_in_flight_per_worker;
+  // Round-robin counter used to distribute invocations across workers.
+  iree_atomic_int32_t next_worker;
+  iree_host_size_t worker_count;
+  iree_runtime_scheduler_worker_t workers[];
+};
+
+static void iree_runtime_scheduler_invocation_free(
+    iree_runtime_scheduler_t* scheduler,
+    iree_runtime_scheduler_invocation_t* invocation) {
+  iree_vm_list_release(invocation->outputs);
+  iree_vm_list_release(invocation->inputs);
+  iree_vm_context_release(invocation->context);
+  iree_allocator_free(scheduler->host_allocator, invocation);
+}
+
+// Pops the next pending invocation from |worker|, if any.
+static iree_runtime_scheduler_invocation_t*
+iree_runtime_scheduler_worker_pop_pending(
+    iree_runtime_scheduler_worker_t* worker) {
+  iree_slim_mutex_lock(&worker->mutex);
+  iree_runtime_scheduler_invocation_t* invocation = worker->pending_head;
+  if (invocation) {
+    worker->pending_head = invocation->next;
+    if (!worker->pending_head) worker->pending_tail = NULL;
+    invocation->next = NULL;
+  }
+  iree_slim_mutex_unlock(&worker->mutex);
+  return invocation;
+}
+
+static void iree_runtime_scheduler_worker_begin_pending(
+    iree_runtime_scheduler_worker_t* worker, iree_loop_t loop);
+
+static iree_status_t iree_runtime_scheduler_invocation_complete(
+    void* user_data, iree_loop_t loop, iree_status_t status,
+    iree_vm_list_t* outputs) {
+  iree_runtime_scheduler_invocation_t* invocation =
+      (iree_runtime_scheduler_invocation_t*)user_data;
+  iree_runtime_scheduler_worker_t* worker = invocation->worker;
+  --worker->in_flight_count;
+
+  // Ownership of |status| and |outputs| transfers to the callback.
+  invocation->callback(invocation->user_data, status, outputs);
+  iree_runtime_scheduler_invocation_free(worker->scheduler, invocation);
+
+  // Capacity is now available to begin any queued invocations.
+  iree_runtime_scheduler_worker_begin_pending(worker, loop);
+  return iree_ok_status();
+}
+
+// Begins pending invocations on the |worker| loop until it reaches its
+// in-flight limit or the queue is empty.
+static void iree_runtime_scheduler_worker_begin_pending(
+    iree_runtime_scheduler_worker_t* worker, iree_loop_t loop) {
+  iree_runtime_scheduler_t* scheduler = worker->scheduler;
+  while (worker->in_flight_count < scheduler->max_in_flight_per_worker) {
+    iree_runtime_scheduler_invocation_t* invocation =
+        iree_runtime_scheduler_worker_pop_pending(worker);
+    if (!invocation) break;
+    invocation->worker = worker;
+    ++worker->in_flight_count;
+    iree_status_t status = iree_vm_async_invoke(
+        loop, &invocation->state, invocation->context, invocation->function,
+        invocation->flags, /*policy=*/NULL, invocation->inputs,
+        invocation->outputs, scheduler->host_allocator,
+        iree_runtime_scheduler_invocation_complete, invocation);
+    if (!iree_status_is_ok(status)) {
+      // The invocation failed to enqueue and its callback will never be issued
+      // by the loop so we complete it here.
+      --worker->in_flight_count;
+      invocation->callback(invocation->user_data, status, NULL);
+      iree_runtime_scheduler_invocation_free(scheduler, invocation);
+    }
+  }
+}
+
+static iree_status_t iree_runtime_scheduler_worker_wake(
+    void* user_data, iree_loop_t loop, iree_status_t loop_status) {
+  iree_runtime_scheduler_worker_t* worker =
+      (iree_runtime_scheduler_worker_t*)user_data;
+  if (!iree_status_is_ok(loop_status)) {
+    // The loop is aborting the wait; the worker main loop will re-arm it.
+    iree_status_ignore(loop_status);
+    return iree_ok_status();
+  }
+
+  // Reset prior to draining so that invocations queued while draining set the
+  // event again and are picked up by the next wake.
+  iree_event_reset(&worker->wake_event);
+  iree_runtime_scheduler_worker_begin_pending(worker, loop);
+
+  iree_slim_mutex_lock(&worker->mutex);
+  bool exit_requested = worker->exit_requested;
+  iree_slim_mutex_unlock(&worker->mutex);
+  if (exit_requested) {
+    // Not re-arming the wake lets the loop go idle once all in-flight
+    // invocations (which will begin any remaining pending ones) complete.
+    return iree_ok_status();
+  }
+  return iree_loop_wait_one(loop, iree_event_await(&worker->wake_event),
+                            iree_infinite_timeout(),
+                            iree_runtime_scheduler_worker_wake, worker);
+}
+
+static int iree_runtime_scheduler_worker_main(void* entry_arg) {
+  iree_runtime_scheduler_worker_t* worker =
+      (iree_runtime_scheduler_worker_t*)entry_arg;
+  iree_loop_t loop = iree_loop_sync_scope(&worker->scope);
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&worker->mutex);
+    bool is_done = worker->exit_requested && !worker->pending_head;
+    iree_slim_mutex_unlock(&worker->mutex);
+    if (is_done && !worker->in_flight_count) break;
+
+    // The loop only goes idle when the wake wait has not been re-armed: either
+    // the worker is exiting or the loop aborted its operations.
+    status = iree_loop_wait_one(loop, iree_event_await(&worker->wake_event),
+                                iree_infinite_timeout(),
+                                iree_runtime_scheduler_worker_wake, worker);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_loop_sync_wait_idle(worker->loop_sync, iree_infinite_timeout());
+    }
+  }
+
+  // Fail anything that could not be scheduled due to a loop failure.
+  iree_runtime_scheduler_invocation_t* invocation = NULL;
+  while ((invocation = iree_runtime_scheduler_worker_pop_pending(worker))) {
+    invocation->callback(invocation->user_data, iree_status_clone(status),
+                         NULL);
+    iree_runtime_scheduler_invocation_free(worker->scheduler, invocation);
+  }
+  iree_status_ignore(status);
+  return 0;
+}
+
+static void iree_runtime_scheduler_worker_deinitialize(
+    iree_runtime_scheduler_worker_t* worker) {
+  if (worker->thread) {
+    iree_slim_mutex_lock(&worker->mutex);
+    worker->exit_requested = true;
+    iree_slim_mutex_unlock(&worker->mutex);
+    iree_event_set(&worker->wake_event);
+    // Joins the thread.
+    iree_thread_release(worker->thread);
+    worker->thread = NULL;
+  }
+  if (worker->loop_sync) {
+    iree_loop_sync_scope_deinitialize(&worker->scope);
+    iree_loop_sync_free(worker->loop_sync);
+    worker->loop_sync = NULL;
+  }
+  iree_event_deinitialize(&worker->wake_event);
+  iree_slim_mutex_deinitialize(&worker->mutex);
+}
+
+static iree_status_t iree_runtime_scheduler_worker_initialize(
+    iree_runtime_scheduler_t* scheduler,
+    iree_runtime_scheduler_worker_t* out_worker) {
+  out_worker->scheduler = scheduler;
+  iree_slim_mutex_initialize(&out_worker->mutex);
+  IREE_RETURN_IF_ERROR(
+      iree_event_initialize(/*initial_state=*/false, &out_worker->wake_event));
+
+  // Each in-flight invocation has at most one pending run or wait operation
+  // and the wake wait takes one more.
+  iree_loop_sync_options_t loop_options;
+  loop_options.max_queue_depth = scheduler->max_in_flight_per_worker + 1;
+  loop_options.max_wait_count = scheduler->max_in_flight_per_worker + 1;
+  IREE_RETURN_IF_ERROR(iree_loop_sync_allocate(
+      loop_options, scheduler->host_allocator, &out_worker->loop_sync));
+  iree_loop_sync_scope_initialize(out_worker->loop_sync, /*error_fn=*/NULL,
+                                  /*error_user_data=*/NULL, &out_worker->scope);
+
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = iree_make_cstring_view("iree-runtime-scheduler");
+  return iree_thread_create(iree_runtime_scheduler_worker_main, out_worker,
+                            thread_params, scheduler->host_allocator,
+                            &out_worker->thread);
+}
+
+static void iree_runtime_scheduler_destroy(
+    iree_runtime_scheduler_t* scheduler) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < scheduler->worker_count; ++i) {
+    iree_runtime_scheduler_worker_deinitialize(&scheduler->workers[i]);
+  }
+  iree_allocator_free(scheduler->host_allocator, scheduler);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_scheduler_create(
+    const iree_runtime_scheduler_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_scheduler_t** out_scheduler) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_scheduler);
+  *out_scheduler = NULL;
+  if (options->worker_count == 0 || options->max_in_flight_per_worker == 0 ||
+      options->max_in_flight_per_worker >= UINT16_MAX) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "invalid scheduler options: worker_count=%zu "
+        "max_in_flight_per_worker=%zu",
+        options->worker_count, options->max_in_flight_per_worker);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_scheduler_t* scheduler = NULL;
+  iree_host_size_t total_size =
+      sizeof(*scheduler) +
+      options->worker_count * sizeof(scheduler->workers[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&scheduler));
+  memset(scheduler, 0, total_size);
+  iree_atomic_ref_count_init(&scheduler->ref_count);
+  scheduler->host_allocator = host_allocator;
+  scheduler->max_in_flight_per_worker = options->max_in_flight_per_worker;
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < options->worker_count; ++i) {
+    // Counted first so that partially initialized workers are cleaned up.
+    ++scheduler->worker_count;
+    status = iree_runtime_scheduler_worker_initialize(scheduler,
+                                                      &scheduler->workers[i]);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_scheduler = scheduler;
+  } else {
+    iree_runtime_scheduler_destroy(scheduler);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_runtime_scheduler_retain(
+    iree_runtime_scheduler_t* scheduler) {
+  if (scheduler) {
+    iree_atomic_ref_count_inc(&scheduler->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_runtime_scheduler_release(
+    iree_runtime_scheduler_t* scheduler) {
+  if (scheduler && iree_atomic_ref_count_dec(&scheduler->ref_count) == 1) {
+    iree_runtime_scheduler_destroy(scheduler);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_scheduler_invoke(
+    iree_runtime_scheduler_t* scheduler, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_runtime_scheduler_callback_fn_t callback, void* user_data) {
+  IREE_ASSERT_ARGUMENT(scheduler);
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(callback);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_scheduler_invocation_t* invocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(scheduler->host_allocator, sizeof(*invocation),
+                                (void**)&invocation));
+  invocation->next = NULL;
+  invocation->worker = NULL;
+  invocation->context = context;
+  iree_vm_context_retain(context);
+  invocation->function = function;
+  invocation->flags = flags;
+  invocation->inputs = inputs;
+  iree_vm_list_retain(inputs);
+  invocation->outputs = outputs;
+  iree_vm_list_retain(outputs);
+  invocation->callback = callback;
+  invocation->user_data = user_data;
+
+  // Results need storage even if the caller is not providing any.
+  iree_status_t status = iree_ok_status();
+  if (!invocation->outputs) {
+    status = iree_vm_list_create(/*element_type=*/NULL, /*initial_capacity=*/0,
+                                 scheduler->host_allocator,
+                                 &invocation->outputs);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_runtime_scheduler_invocation_free(scheduler, invocation);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  iree_host_size_t worker_index =
+      (iree_host_size_t)(uint32_t)iree_atomic_fetch_add_int32(
+          &scheduler->next_worker, 1, iree_memory_order_relaxed) %
+      scheduler->worker_count;
+  iree_runtime_scheduler_worker_t* worker = &scheduler->workers[worker_index];
+  iree_slim_mutex_lock(&worker->mutex);
+  if (worker->pending_tail) {
+    worker->pending_tail->next = invocation;
+  } else {
+    worker->pending_head = invocation;
+  }
+  worker->pending_tail = invocation;
+  iree_slim_mutex_unlock(&worker->mutex);
+  iree_event_set(&worker->wake_event);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
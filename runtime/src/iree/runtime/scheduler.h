@@ -0,0 +1,96 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_SCHEDULER_H_
+#define IREE_RUNTIME_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_scheduler_t
+//===----------------------------------------------------------------------===//
+
+// Callback issued when a scheduled invocation completes.
+// |status| is either the failure of the scheduling process or the result of
+// the invocation itself. If successful |outputs| contains the results. Both
+// |status| and |outputs| (if not NULL) are owned by the callee and must be
+// released.
+//
+// Called from a scheduler worker thread and must not block: any blocking work
+// stalls all other invocations multiplexed onto the same worker.
+typedef void(IREE_API_PTR* iree_runtime_scheduler_callback_fn_t)(
+    void* user_data, iree_status_t status, iree_vm_list_t* outputs);
+
+// Options controlling scheduler behavior.
+typedef struct iree_runtime_scheduler_options_t {
+  // Number of worker threads invocations are multiplexed onto.
+  iree_host_size_t worker_count;
+  // Maximum number of invocations in-flight on each worker at a time.
+  // Invocations scheduled beyond this are queued and begun as others complete.
+  iree_host_size_t max_in_flight_per_worker;
+} iree_runtime_scheduler_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_runtime_scheduler_options_initialize(
+    iree_runtime_scheduler_options_t* out_options);
+
+// Schedules VM invocations as coroutines onto a small pool of worker threads.
+//
+// Each worker runs an iree_loop_sync_t and begins scheduled invocations with
+// iree_vm_async_invoke. An invocation that waits (such as on a HAL fence via
+// hal.fence.await) is suspended on the worker loop and resumed once the wait
+// resolves while the worker makes progress on other invocations. This allows
+// many requests to be in-flight without dedicating one OS thread to each.
+//
+// Invocations into the same context may overlap when suspended and the context
+// must be created with IREE_VM_CONTEXT_FLAG_CONCURRENT unless the caller
+// ensures that only one invocation per context is scheduled at a time.
+//
+// Thread-safe: invocations may be scheduled from any thread.
+typedef struct iree_runtime_scheduler_t iree_runtime_scheduler_t;
+
+// Creates a scheduler and launches its worker threads.
+// |host_allocator| is used for the scheduler and all invocation state.
+IREE_API_EXPORT iree_status_t iree_runtime_scheduler_create(
+    const iree_runtime_scheduler_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_scheduler_t** out_scheduler);
+
+// Retains the given |scheduler| for the caller.
+IREE_API_EXPORT void iree_runtime_scheduler_retain(
+    iree_runtime_scheduler_t* scheduler);
+
+// Releases the given |scheduler| from the caller.
+// When the last reference is released all scheduled invocations are run to
+// completion and the worker threads are joined before returning.
+IREE_API_EXPORT void iree_runtime_scheduler_release(
+    iree_runtime_scheduler_t* scheduler);
+
+// Schedules an invocation of |function| in |context| with the given |inputs|.
+// The call returns immediately and |callback| is issued with |user_data| from a
+// worker thread once the invocation completes. |outputs| is optional storage
+// for the results; if omitted a new list will be allocated for functions with
+// results.
+//
+// |context|, |inputs|, and |outputs| are retained until the invocation
+// completes. The callback is only issued if this returns OK.
+IREE_API_EXPORT iree_status_t iree_runtime_scheduler_invoke(
+    iree_runtime_scheduler_t* scheduler, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_runtime_scheduler_callback_fn_t callback, void* user_data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_SCHEDULER_H_
@@ -0,0 +1,226 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/scheduler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_test.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Tracks the completion of a set of invocations of module_a.add_1.
+struct Completions {
+  std::mutex mutex;
+  std::condition_variable cv;
+  int completed_count = 0;
+  int failed_count = 0;
+  // Sum of all results returned so that callers can verify each invocation
+  // produced its own result.
+  int64_t result_sum = 0;
+
+  void WaitFor(int count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return completed_count >= count; });
+  }
+};
+
+static void OnInvocationComplete(void* user_data, iree_status_t status,
+                                 iree_vm_list_t* outputs) {
+  auto* completions = reinterpret_cast<Completions*>(user_data);
+  iree_vm_value_t result = iree_vm_value_make_i32(0);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_get_value(outputs, 0, &result);
+  }
+  bool succeeded = iree_status_is_ok(status);
+  iree_status_ignore(status);
+  iree_vm_list_release(outputs);
+  {
+    std::lock_guard<std::mutex> lock(completions->mutex);
+    ++completions->completed_count;
+    if (succeeded) {
+      completions->result_sum += result.i32;
+    } else {
+      ++completions->failed_count;
+    }
+  }
+  completions->cv.notify_all();
+}
+
+class SchedulerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+    iree_vm_module_t* module_a = nullptr;
+    IREE_CHECK_OK(
+        module_a_create(instance_, iree_allocator_system(), &module_a));
+    // Invocations from multiple workers may overlap on the same context.
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_CONCURRENT, 1, &module_a,
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(module_a);
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view("module_a.add_1"), &function_));
+  }
+
+  virtual void TearDown() {
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_runtime_scheduler_t* CreateScheduler(
+      iree_host_size_t worker_count,
+      iree_host_size_t max_in_flight_per_worker) {
+    iree_runtime_scheduler_options_t options;
+    iree_runtime_scheduler_options_initialize(&options);
+    options.worker_count = worker_count;
+    options.max_in_flight_per_worker = max_in_flight_per_worker;
+    iree_runtime_scheduler_t* scheduler = nullptr;
+    IREE_CHECK_OK(iree_runtime_scheduler_create(
+        &options, iree_allocator_system(), &scheduler));
+    return scheduler;
+  }
+
+  // Invokes module_a.add_1(|arg0|) on |scheduler| and reports the result to
+  // |completions| when it finishes.
+  iree_status_t Invoke(iree_runtime_scheduler_t* scheduler, int32_t arg0,
+                       Completions* completions) {
+    vm::ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &inputs));
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32(arg0);
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_value(inputs.get(), &arg0_value));
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &outputs));
+    return iree_runtime_scheduler_invoke(
+        scheduler, context_, function_, IREE_VM_INVOCATION_FLAG_NONE,
+        inputs.get(), outputs.get(), OnInvocationComplete, completions);
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_function_t function_;
+};
+
+TEST_F(SchedulerTest, InvalidOptions) {
+  iree_runtime_scheduler_options_t options;
+  iree_runtime_scheduler_options_initialize(&options);
+  options.worker_count = 0;
+  iree_runtime_scheduler_t* scheduler = nullptr;
+  EXPECT_THAT(Status(iree_runtime_scheduler_create(
+                  &options, iree_allocator_system(), &scheduler)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(scheduler, nullptr);
+}
+
+// Invocations complete with their own results and without the scheduler
+// needing to be torn down.
+TEST_F(SchedulerTest, Completion) {
+  iree_runtime_scheduler_t* scheduler =
+      CreateScheduler(/*worker_count=*/1, /*max_in_flight_per_worker=*/4);
+  Completions completions;
+  constexpr int kInvocationCount = 16;
+  int64_t expected_sum = 0;
+  for (int i = 0; i < kInvocationCount; ++i) {
+    IREE_ASSERT_OK(Invoke(scheduler, i, &completions));
+    expected_sum += i + 1;
+  }
+  completions.WaitFor(kInvocationCount);
+  EXPECT_EQ(completions.failed_count, 0);
+  EXPECT_EQ(completions.result_sum, expected_sum);
+  iree_runtime_scheduler_release(scheduler);
+}
+
+// Invocations may be made without an output list; the scheduler provides
+// storage for the results.
+TEST_F(SchedulerTest, NoOutputList) {
+  iree_runtime_scheduler_t* scheduler =
+      CreateScheduler(/*worker_count=*/1, /*max_in_flight_per_worker=*/1);
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_value_t arg0_value = iree_vm_value_make_i32(41);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs.get(), &arg0_value));
+  Completions completions;
+  IREE_ASSERT_OK(iree_runtime_scheduler_invoke(
+      scheduler, context_, function_, IREE_VM_INVOCATION_FLAG_NONE,
+      inputs.get(), /*outputs=*/nullptr, OnInvocationComplete, &completions));
+  completions.WaitFor(1);
+  EXPECT_EQ(completions.failed_count, 0);
+  EXPECT_EQ(completions.result_sum, 42);
+  iree_runtime_scheduler_release(scheduler);
+}
+
+// Multiple threads submitting to multiple workers at the same time must see
+// every invocation complete exactly once.
+TEST_F(SchedulerTest, ConcurrentSubmissions) {
+  iree_runtime_scheduler_t* scheduler =
+      CreateScheduler(/*worker_count=*/4, /*max_in_flight_per_worker=*/2);
+  Completions completions;
+  constexpr int kThreadCount = 4;
+  constexpr int kInvocationsPerThread = 64;
+  std::atomic<int> submit_failures{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kInvocationsPerThread; ++i) {
+        iree_status_t status =
+            Invoke(scheduler, t * kInvocationsPerThread + i, &completions);
+        if (!iree_status_is_ok(status)) {
+          iree_status_ignore(status);
+          ++submit_failures;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  ASSERT_EQ(submit_failures.load(), 0);
+
+  constexpr int kInvocationCount = kThreadCount * kInvocationsPerThread;
+  completions.WaitFor(kInvocationCount);
+  iree_runtime_scheduler_release(scheduler);
+
+  // add_1 over [0, n) sums to n * (n + 1) / 2.
+  EXPECT_EQ(completions.completed_count, kInvocationCount);
+  EXPECT_EQ(completions.failed_count, 0);
+  EXPECT_EQ(completions.result_sum,
+            (int64_t)kInvocationCount * (kInvocationCount + 1) / 2);
+}
+
+// Releasing the scheduler while invocations are still queued behind the
+// in-flight limit runs them all to completion before the workers are joined.
+TEST_F(SchedulerTest, ShutdownWithPendingWork) {
+  iree_runtime_scheduler_t* scheduler =
+      CreateScheduler(/*worker_count=*/2, /*max_in_flight_per_worker=*/1);
+  Completions completions;
+  constexpr int kInvocationCount = 128;
+  for (int i = 0; i < kInvocationCount; ++i) {
+    IREE_ASSERT_OK(Invoke(scheduler, i, &completions));
+  }
+  iree_runtime_scheduler_release(scheduler);
+
+  // No waiting: the release must not return until all callbacks have fired.
+  std::lock_guard<std::mutex> lock(completions.mutex);
+  EXPECT_EQ(completions.completed_count, kInvocationCount);
+  EXPECT_EQ(completions.failed_count, 0);
+  EXPECT_EQ(completions.result_sum,
+            (int64_t)kInvocationCount * (kInvocationCount + 1) / 2);
+}
+
+}  // namespace
+}  // namespace iree
@@ -61,6 +61,9 @@ struct iree_runtime_session_t {
   // lookup. An application directly using the API may never need this, or could
   // perform VM calls into HAL module exports to gain more portability.
   iree_vm_module_state_t* hal_module_state;
+
+  // The HAL module registered in the context; owned by the context.
+  iree_vm_module_t* hal_module;
 };
 
 IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
@@ -103,6 +106,7 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
         session->context, /*module_count=*/1, /*modules=*/&hal_module);
   }
   if (iree_status_is_ok(status)) {
+    session->hal_module = hal_module;
     status = iree_vm_context_resolve_module_state(session->context, hal_module,
                                                   &session->hal_module_state);
   }
@@ -117,6 +121,41 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_session_fork(
+    iree_runtime_session_t* parent_session, iree_allocator_t host_allocator,
+    iree_runtime_session_t** out_session) {
+  IREE_ASSERT_ARGUMENT(parent_session);
+  IREE_ASSERT_ARGUMENT(out_session);
+  *out_session = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_session_t* session = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*session),
+                                (void**)&session));
+  session->host_allocator = host_allocator;
+  iree_atomic_ref_count_init(&session->ref_count);
+
+  session->instance = parent_session->instance;
+  iree_runtime_instance_retain(session->instance);
+
+  iree_status_t status = iree_vm_context_fork(
+      parent_session->context, host_allocator, &session->context);
+  if (iree_status_is_ok(status)) {
+    session->hal_module = parent_session->hal_module;
+    status = iree_vm_context_resolve_module_state(
+        session->context, session->hal_module, &session->hal_module_state);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_session = session;
+  } else {
+    iree_runtime_session_release(session);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_runtime_session_destroy(iree_runtime_session_t* session) {
   IREE_ASSERT_ARGUMENT(session);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -228,13 +267,13 @@ iree_runtime_session_append_bytecode_module_from_file(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, file_path);
 
-  // TODO(#3909): actually map the memory here. For now we just load the
-  // contents.
+  // Map the file so that the module rodata is paged in lazily and shared
+  // across all processes loading the same file.
   iree_file_contents_t* flatbuffer_contents = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_file_read_contents(file_path,
-                                  iree_runtime_session_host_allocator(session),
-                                  &flatbuffer_contents));
+      z0, iree_file_map_contents(file_path, IREE_FILE_MAP_FLAG_NONE,
+                                 iree_runtime_session_host_allocator(session),
+                                 &flatbuffer_contents));
 
   iree_status_t status =
       iree_runtime_session_append_bytecode_module_from_memory(
@@ -88,6 +88,19 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
     const iree_runtime_session_options_t* options, iree_hal_device_t* device,
     iree_allocator_t host_allocator, iree_runtime_session_t** out_session);
 
+// Creates a new session with the same device and modules as |parent_session|
+// by forking its VM context with iree_vm_context_fork. Module initializers are
+// not rerun and device-resident constants uploaded by the parent are shared
+// by reference instead of being uploaded again, making forks an inexpensive
+// way to serve many concurrent requests with one copy of the model weights.
+//
+// The parent must not be executing while it is forked. Forked sessions cannot
+// have additional modules appended.
+// |out_session| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_fork(
+    iree_runtime_session_t* parent_session, iree_allocator_t host_allocator,
+    iree_runtime_session_t** out_session);
+
 // Retains the given |session| for the caller.
 IREE_API_EXPORT void iree_runtime_session_retain(
     iree_runtime_session_t* session);
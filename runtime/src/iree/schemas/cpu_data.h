@@ -73,6 +73,96 @@ enum iree_cpu_data_field_0_e {
   // Canonical key: "i8mm"
   IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM = 1ull << 1,
 
+  // Indicates support for the Scalable Vector Extension.
+  //
+  // The vector length is reported in
+  // IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES.
+  //
+  // Source: ID_AA64PFR0_EL1.SVE [35:32] == 0b0001 / HWCAP_SVE
+  // Canonical key: "sve"
+  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE = 1ull << 2,
+
+  // Indicates support for the Scalable Vector Extension version 2.
+  // Only set when IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE is set.
+  //
+  // Source: ID_AA64ZFR0_EL1.SVEver [3:0] >= 0b0001 / HWCAP2_SVE2
+  // Canonical key: "sve2"
+  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE2 = 1ull << 3,
+
+  // Indicates support for the Scalable Matrix Extension.
+  //
+  // SMSTART, SMSTOP and the FMOPA and SMOPA outer product instructions
+  // accumulating into 32-bit ZA tiles are implemented. The streaming vector
+  // length is reported in IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES.
+  //
+  // Source: ID_AA64PFR1_EL1.SME [27:24] >= 0b0001 / HWCAP2_SME
+  // Canonical key: "sme"
+  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME = 1ull << 4,
+
+  //===--------------------------------------------------------------------===//
+  // IREE_ARCH_X86_64 / x86-64
+  //===--------------------------------------------------------------------===//
+
+  // Indicates support for AVX2 and FMA3 instructions with OS support for
+  // saving the YMM register state.
+  //
+  // Source: CPUID.(EAX=07H,ECX=0):EBX.AVX2[bit 5], CPUID.01H:ECX.FMA[bit 12],
+  //         XCR0[2:1] == 0b11
+  // Canonical key: "avx2_fma"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA = 1ull << 0,
+
+  // Indicates support for the AVX-512 F, BW, DQ, VL and CD instructions (the
+  // set common to all AVX-512 server and client cores) with OS support for
+  // saving the ZMM and opmask register state.
+  //
+  // Source: CPUID.(EAX=07H,ECX=0):EBX bits 16, 17, 28, 30 and 31,
+  //         XCR0[7:5] == 0b111
+  // Canonical key: "avx512_base"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE = 1ull << 1,
+
+  // Indicates support for AVX-512 Vector Neural Network Instructions.
+  //
+  // VPDPBUSD, VPDPBUSDS, VPDPWSSD and VPDPWSSDS instructions are implemented.
+  // Only set when IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE is set.
+  //
+  // Source: CPUID.(EAX=07H,ECX=0):ECX.AVX512_VNNI[bit 11]
+  // Canonical key: "avx512vnni"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI = 1ull << 2,
+
+  // Indicates support for AVX-512 BFLOAT16 instructions.
+  //
+  // VCVTNE2PS2BF16, VCVTNEPS2BF16 and VDPBF16PS instructions are implemented.
+  // Only set when IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE is set.
+  //
+  // Source: CPUID.(EAX=07H,ECX=1):EAX.AVX512_BF16[bit 5]
+  // Canonical key: "avx512bf16"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16 = 1ull << 3,
+
+};
+
+// Bitmasks and values for processor data field 1.
+enum iree_cpu_data_field_1_e {
+
+  //===--------------------------------------------------------------------===//
+  // IREE_ARCH_ARM_64 / aarch64
+  //===--------------------------------------------------------------------===//
+
+  // SVE vector length in bytes available to the process (a multiple of 16) or
+  // 0 if IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SVE is not set.
+  //
+  // Source: ZCR_EL1.LEN / prctl(PR_SVE_GET_VL)
+  // Canonical key: "sve_vector_bytes"
+  IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES_SHIFT = 0,
+  IREE_CPU_DATA_FIELD_1_AARCH64_SVE_VECTOR_BYTES_MASK = 0xFFFFull << 0,
+
+  // Streaming SVE vector length in bytes used in SME streaming mode (a power
+  // of two) or 0 if IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_SME is not set.
+  //
+  // Source: SMCR_EL1.LEN / prctl(PR_SME_GET_VL)
+  // Canonical key: "sme_vector_bytes"
+  IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES_SHIFT = 16,
+  IREE_CPU_DATA_FIELD_1_AARCH64_SME_VECTOR_BYTES_MASK = 0xFFFFull << 16,
+
 };
 
 #endif  // IREE_SCHEMAS_CPU_DATA_H_
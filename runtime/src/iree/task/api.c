@@ -38,12 +38,17 @@ IREE_FLAG(
 // TODO(benvanik): enable this when we use it - though hopefully we don't!
 IREE_FLAG(
     int32_t, task_worker_local_memory, 0,  // 64 * 1024,
-    "Specifies the bytes of per-worker local memory allocated for use by\n"
-    "dispatched tiles. Tiles may use less than this but will fail to dispatch\n"
-    "if they require more. Conceptually it is like a stack reservation and\n"
-    "should be treated the same way: the source programs must be built to\n"
-    "only use a specific maximum amount of local memory and the runtime must\n"
-    "be configured to make at least that amount of local memory available.");
+    "Specifies the bytes of per-worker local memory reserved for use by\n"
+    "dispatched tiles. Conceptually it is like a stack reservation: workers\n"
+    "grow their local memory on demand (up to\n"
+    "--task_worker_local_memory_limit) when tiles require more but reserving\n"
+    "the amount the source programs are built to use avoids the growth.");
+
+IREE_FLAG(
+    int32_t, task_worker_local_memory_limit, -1,
+    "Maximum bytes of local memory each worker may grow to on demand when\n"
+    "dispatched tiles require more than --task_worker_local_memory. -1 uses\n"
+    "the default limit and 0 disables growth.");
 
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
@@ -55,6 +60,10 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
       (iree_host_size_t)FLAG_task_worker_local_memory;
+  if (FLAG_task_worker_local_memory_limit >= 0) {
+    out_options->worker_local_memory_limit =
+        (iree_host_size_t)FLAG_task_worker_local_memory_limit;
+  }
   return iree_ok_status();
 }
 
@@ -216,6 +225,11 @@ static iree_status_t iree_task_flags_dump_task_topologies(
       const iree_task_topology_group_t* group = &topology.groups[j];
       fprintf(stdout, "# group[%d]: '%s'\n", group->group_index, group->name);
       fprintf(stdout, "#      processor: %u\n", group->processor_index);
+      fprintf(stdout, "#      numa node: %u\n", group->node_id);
+      fprintf(stdout, "#     core class: %s\n",
+              group->core_class == IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY
+                  ? "efficiency"
+                  : "performance");
       fprintf(stdout, "#       affinity: ");
       if (group->ideal_thread_affinity.specified) {
         fprintf(stdout, "group=%u, id=%u, smt=%u",
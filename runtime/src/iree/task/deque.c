@@ -0,0 +1,149 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/deque.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define IREE_TASK_DEQUE_SLOT_MASK (IREE_TASK_DEQUE_CAPACITY - 1)
+
+void iree_task_deque_initialize(iree_task_deque_t* out_deque) {
+  memset(out_deque, 0, sizeof(*out_deque));
+  iree_atomic_store_int64(&out_deque->top, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_deque->bottom, 0, iree_memory_order_relaxed);
+}
+
+void iree_task_deque_deinitialize(iree_task_deque_t* deque) {
+  // Nothing to do; tasks are not owned by the deque.
+}
+
+iree_host_size_t iree_task_deque_size(iree_task_deque_t* deque) {
+  int64_t bottom =
+      iree_atomic_load_int64(&deque->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&deque->top, iree_memory_order_relaxed);
+  return bottom > top ? (iree_host_size_t)(bottom - top) : 0;
+}
+
+bool iree_task_deque_is_empty(iree_task_deque_t* deque) {
+  return iree_task_deque_size(deque) == 0;
+}
+
+bool iree_task_deque_push(iree_task_deque_t* deque, iree_task_t* task) {
+  int64_t bottom =
+      iree_atomic_load_int64(&deque->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&deque->top, iree_memory_order_acquire);
+  if (bottom - top >= IREE_TASK_DEQUE_CAPACITY) {
+    return false;  // full
+  }
+  iree_atomic_store_intptr(&deque->slots[bottom & IREE_TASK_DEQUE_SLOT_MASK],
+                           (intptr_t)task, iree_memory_order_relaxed);
+  // Ensure the slot is visible to thieves before they observe the new bottom.
+  iree_atomic_thread_fence(iree_memory_order_release);
+  iree_atomic_store_int64(&deque->bottom, bottom + 1,
+                          iree_memory_order_relaxed);
+  return true;
+}
+
+void iree_task_deque_push_list(iree_task_deque_t* deque,
+                               iree_task_list_t* list) {
+  int64_t bottom =
+      iree_atomic_load_int64(&deque->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&deque->top, iree_memory_order_acquire);
+  // Thieves may only grow the available space so using the |top| observed here
+  // is conservative.
+  int64_t available = IREE_TASK_DEQUE_CAPACITY - (bottom - top);
+  int64_t new_bottom = bottom;
+  while (available-- > 0) {
+    iree_task_t* task = iree_task_list_pop_front(list);
+    if (!task) break;
+    iree_atomic_store_intptr(
+        &deque->slots[new_bottom & IREE_TASK_DEQUE_SLOT_MASK], (intptr_t)task,
+        iree_memory_order_relaxed);
+    ++new_bottom;
+  }
+  if (new_bottom == bottom) return;
+  // Publish all of the tasks at once.
+  iree_atomic_thread_fence(iree_memory_order_release);
+  iree_atomic_store_int64(&deque->bottom, new_bottom,
+                          iree_memory_order_relaxed);
+}
+
+iree_task_t* iree_task_deque_pop(iree_task_deque_t* deque) {
+  int64_t bottom =
+      iree_atomic_load_int64(&deque->bottom, iree_memory_order_relaxed) - 1;
+  iree_atomic_store_int64(&deque->bottom, bottom, iree_memory_order_relaxed);
+  // The store to bottom must be ordered before the load of top so that a
+  // concurrent thief either sees the reservation or we see its steal.
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t top = iree_atomic_load_int64(&deque->top, iree_memory_order_relaxed);
+  if (top > bottom) {
+    // Empty; restore bottom.
+    iree_atomic_store_int64(&deque->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+    return NULL;
+  }
+  iree_task_t* task = (iree_task_t*)iree_atomic_load_intptr(
+      &deque->slots[bottom & IREE_TASK_DEQUE_SLOT_MASK],
+      iree_memory_order_relaxed);
+  if (top == bottom) {
+    // Last task remaining; race thieves for it.
+    if (!iree_atomic_compare_exchange_strong_int64(
+            &deque->top, &top, top + 1, iree_memory_order_seq_cst,
+            iree_memory_order_relaxed)) {
+      task = NULL;  // lost the race
+    }
+    iree_atomic_store_int64(&deque->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+  }
+  return task;
+}
+
+iree_task_t* iree_task_deque_steal(iree_task_deque_t* deque) {
+  int64_t top = iree_atomic_load_int64(&deque->top, iree_memory_order_acquire);
+  // The load of top must be ordered before the load of bottom; pairs with the
+  // fence in pop.
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t bottom =
+      iree_atomic_load_int64(&deque->bottom, iree_memory_order_acquire);
+  if (top >= bottom) return NULL;  // empty
+  iree_task_t* task = (iree_task_t*)iree_atomic_load_intptr(
+      &deque->slots[top & IREE_TASK_DEQUE_SLOT_MASK],
+      iree_memory_order_relaxed);
+  if (!iree_atomic_compare_exchange_strong_int64(
+          &deque->top, &top, top + 1, iree_memory_order_seq_cst,
+          iree_memory_order_relaxed)) {
+    return NULL;  // lost the race with the owner or another thief
+  }
+  return task;
+}
+
+iree_task_t* iree_task_deque_try_steal_half(iree_task_deque_t* source_deque,
+                                            iree_task_deque_t* target_deque,
+                                            iree_host_size_t max_tasks) {
+  // NOTE: we don't claim the whole range with a single CAS on top: the owner
+  // pops from the bottom without a CAS whenever it sees more than one task and
+  // a range claim could overlap tasks it has already taken.
+  iree_host_size_t steal_count = (iree_task_deque_size(source_deque) + 1) / 2;
+  steal_count = iree_min(steal_count, max_tasks);
+  // Only steal as many as we can hold (+1 for the task we return). We are the
+  // owner of the target so its size can only shrink while we are stealing.
+  steal_count = iree_min(steal_count, IREE_TASK_DEQUE_CAPACITY -
+                                          iree_task_deque_size(target_deque) +
+                                          1);
+  if (steal_count == 0) return NULL;
+
+  iree_task_t* first_task = iree_task_deque_steal(source_deque);
+  if (!first_task) return NULL;
+  for (iree_host_size_t i = 1; i < steal_count; ++i) {
+    iree_task_t* task = iree_task_deque_steal(source_deque);
+    if (!task) break;
+    bool did_push = iree_task_deque_push(target_deque, task);
+    IREE_ASSERT(did_push, "target deque capacity checked above");
+    (void)did_push;
+  }
+  return first_task;
+}
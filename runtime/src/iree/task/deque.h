@@ -0,0 +1,117 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TASK_DEQUE_H_
+#define IREE_TASK_DEQUE_H_
+
+#include <stdbool.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/task/list.h"
+#include "iree/task/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Capacity of an iree_task_deque_t in tasks. Must be a power of two.
+#define IREE_TASK_DEQUE_CAPACITY (256)
+
+// A bounded lock-free work-stealing deque of tasks.
+//
+// This is the Chase-Lev deque as described in:
+//   Dynamic Circular Work-Stealing Deque (Chase and Lev, SPAA 2005)
+//   Correct and Efficient Work-Stealing for Weak Memory Models
+//   (Lê, Pop, Cohen, and Zappa Nardelli, PPoPP 2013)
+//
+// A single owner thread pushes and pops from the bottom of the deque in LIFO
+// order while any number of thief threads steal from the top in FIFO order.
+// The owner only needs plain loads/stores and fences on its fast path and only
+// performs a CAS when contending with thieves for the last task. Thieves
+// perform one CAS per stolen task.
+//
+// Unlike iree_task_queue_t the deque does not use the intrusive task list
+// pointers and has a fixed capacity of IREE_TASK_DEQUE_CAPACITY tasks: the
+// owner must handle pushes failing when full (usually by executing the task or
+// holding it in an overflow list).
+//
+// NOTE: workers still use iree_task_queue_t for their local queues; this is not
+// yet used by the executor.
+//
+// Thread-safe as described above; only the owner may push/pop.
+typedef struct iree_task_deque_t {
+  // Index of the next task to steal. Only ever incremented.
+  // LAYOUT: separated from bottom to avoid thieves invalidating the owner.
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_atomic_int64_t top;
+  // Index one past the most recently pushed task. Only written by the owner.
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_atomic_int64_t bottom;
+  // Ring buffer of task pointers indexed by (index & (capacity - 1)).
+  iree_atomic_intptr_t slots[IREE_TASK_DEQUE_CAPACITY];
+} iree_task_deque_t;
+
+static_assert((IREE_TASK_DEQUE_CAPACITY & (IREE_TASK_DEQUE_CAPACITY - 1)) == 0,
+              "deque capacity must be a power of two");
+
+// Initializes an empty deque.
+void iree_task_deque_initialize(iree_task_deque_t* out_deque);
+
+// Deinitializes the deque. Any tasks remaining are ignored and must be
+// flushed by the caller prior to deinitialization if they need cleanup.
+void iree_task_deque_deinitialize(iree_task_deque_t* deque);
+
+// Returns the approximate number of tasks in the deque.
+// May be called from any thread but the value may be stale immediately.
+iree_host_size_t iree_task_deque_size(iree_task_deque_t* deque);
+
+// Returns true if the deque is likely empty.
+// May be called from any thread but the value may be stale immediately.
+bool iree_task_deque_is_empty(iree_task_deque_t* deque);
+
+// Pushes |task| onto the bottom of the deque.
+// Returns false if the deque is at capacity and the task was not pushed.
+//
+// Must only be called by the owner thread.
+bool iree_task_deque_push(iree_task_deque_t* deque, iree_task_t* task);
+
+// Pushes tasks from the front of |list| until the deque is at capacity.
+// Tasks that could not be pushed remain in |list|.
+//
+// Must only be called by the owner thread.
+void iree_task_deque_push_list(iree_task_deque_t* deque,
+                               iree_task_list_t* list);
+
+// Pops the most recently pushed task from the bottom of the deque.
+// Returns NULL if the deque is empty.
+//
+// Must only be called by the owner thread.
+iree_task_t* iree_task_deque_pop(iree_task_deque_t* deque);
+
+// Steals the least recently pushed task from the top of the deque.
+// Returns NULL if the deque is empty or the steal lost a race with another
+// thread (in which case the caller may want to try again or elsewhere).
+//
+// May be called from any thread.
+iree_task_t* iree_task_deque_steal(iree_task_deque_t* deque);
+
+// Steals up to half of the tasks in |source_deque| (bounded by |max_tasks|).
+// The first stolen task is returned and the remaining are pushed onto
+// |target_deque|, which must be owned by the calling thread. The source deque
+// is observed once up front and tasks are then stolen individually such that
+// concurrent owner pops are never raced with a multi-task claim.
+//
+// May be called from any thread that owns |target_deque|.
+iree_task_t* iree_task_deque_try_steal_half(iree_task_deque_t* source_deque,
+                                            iree_task_deque_t* target_deque,
+                                            iree_host_size_t max_tasks);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TASK_DEQUE_H_
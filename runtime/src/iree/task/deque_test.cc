@@ -0,0 +1,190 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/deque.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+TEST(DequeTest, Lifetime) {
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+  iree_task_deque_deinitialize(&deque);
+}
+
+TEST(DequeTest, Empty) {
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+  EXPECT_TRUE(iree_task_deque_is_empty(&deque));
+  EXPECT_EQ(0, iree_task_deque_size(&deque));
+  EXPECT_FALSE(iree_task_deque_pop(&deque));
+  EXPECT_FALSE(iree_task_deque_steal(&deque));
+  EXPECT_TRUE(iree_task_deque_is_empty(&deque));
+  iree_task_deque_deinitialize(&deque);
+}
+
+TEST(DequeTest, PushPopLIFO) {
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+
+  iree_task_t task_a = {0};
+  iree_task_t task_b = {0};
+  EXPECT_TRUE(iree_task_deque_push(&deque, &task_a));
+  EXPECT_TRUE(iree_task_deque_push(&deque, &task_b));
+  EXPECT_EQ(2, iree_task_deque_size(&deque));
+
+  EXPECT_EQ(&task_b, iree_task_deque_pop(&deque));
+  EXPECT_EQ(&task_a, iree_task_deque_pop(&deque));
+  EXPECT_FALSE(iree_task_deque_pop(&deque));
+  EXPECT_TRUE(iree_task_deque_is_empty(&deque));
+
+  iree_task_deque_deinitialize(&deque);
+}
+
+TEST(DequeTest, StealFIFO) {
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+
+  iree_task_t task_a = {0};
+  iree_task_t task_b = {0};
+  iree_task_t task_c = {0};
+  EXPECT_TRUE(iree_task_deque_push(&deque, &task_a));
+  EXPECT_TRUE(iree_task_deque_push(&deque, &task_b));
+  EXPECT_TRUE(iree_task_deque_push(&deque, &task_c));
+
+  EXPECT_EQ(&task_a, iree_task_deque_steal(&deque));
+  EXPECT_EQ(&task_c, iree_task_deque_pop(&deque));
+  EXPECT_EQ(&task_b, iree_task_deque_steal(&deque));
+  EXPECT_FALSE(iree_task_deque_steal(&deque));
+  EXPECT_FALSE(iree_task_deque_pop(&deque));
+
+  iree_task_deque_deinitialize(&deque);
+}
+
+TEST(DequeTest, Capacity) {
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+
+  std::vector<iree_task_t> tasks(IREE_TASK_DEQUE_CAPACITY + 1);
+  for (int i = 0; i < IREE_TASK_DEQUE_CAPACITY; ++i) {
+    EXPECT_TRUE(iree_task_deque_push(&deque, &tasks[i]));
+  }
+  EXPECT_FALSE(iree_task_deque_push(&deque, &tasks.back()));
+  EXPECT_EQ(IREE_TASK_DEQUE_CAPACITY, iree_task_deque_size(&deque));
+
+  // Stealing frees up space at the top that can be reused by the owner as the
+  // ring wraps around.
+  EXPECT_EQ(&tasks[0], iree_task_deque_steal(&deque));
+  EXPECT_TRUE(iree_task_deque_push(&deque, &tasks.back()));
+  EXPECT_EQ(&tasks.back(), iree_task_deque_pop(&deque));
+
+  iree_task_deque_deinitialize(&deque);
+}
+
+TEST(DequeTest, PushList) {
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  iree_task_t task_a = {0};
+  iree_task_t task_b = {0};
+  iree_task_list_push_back(&list, &task_a);
+  iree_task_list_push_back(&list, &task_b);
+
+  iree_task_deque_push_list(&deque, &list);
+  EXPECT_TRUE(iree_task_list_is_empty(&list));
+  EXPECT_EQ(2, iree_task_deque_size(&deque));
+  EXPECT_EQ(&task_a, iree_task_deque_steal(&deque));
+  EXPECT_EQ(&task_b, iree_task_deque_steal(&deque));
+
+  iree_task_deque_deinitialize(&deque);
+}
+
+TEST(DequeTest, StealHalf) {
+  iree_task_deque_t source;
+  iree_task_deque_initialize(&source);
+  iree_task_deque_t target;
+  iree_task_deque_initialize(&target);
+
+  iree_task_t tasks[5] = {{0}};
+  for (auto& task : tasks) {
+    EXPECT_TRUE(iree_task_deque_push(&source, &task));
+  }
+
+  // Half of 5 rounded up is 3: the first is returned and 2 go to the target.
+  EXPECT_EQ(&tasks[0],
+            iree_task_deque_try_steal_half(&source, &target, /*max_tasks=*/64));
+  EXPECT_EQ(2, iree_task_deque_size(&source));
+  EXPECT_EQ(2, iree_task_deque_size(&target));
+  EXPECT_EQ(&tasks[2], iree_task_deque_pop(&target));
+  EXPECT_EQ(&tasks[1], iree_task_deque_pop(&target));
+
+  // Bounded by max_tasks.
+  EXPECT_EQ(&tasks[3],
+            iree_task_deque_try_steal_half(&source, &target, /*max_tasks=*/1));
+  EXPECT_TRUE(iree_task_deque_is_empty(&target));
+  EXPECT_EQ(1, iree_task_deque_size(&source));
+
+  iree_task_deque_deinitialize(&target);
+  iree_task_deque_deinitialize(&source);
+}
+
+// Races the owner popping against multiple thieves and ensures every task is
+// received exactly once.
+TEST(DequeTest, ConcurrentStealing) {
+  static constexpr int kTaskCount = 100000;
+  static constexpr int kThiefCount = 4;
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::vector<std::atomic<int>> seen(kTaskCount);
+  for (auto& value : seen) value.store(0);
+
+  iree_task_deque_t deque;
+  iree_task_deque_initialize(&deque);
+
+  std::atomic<bool> done{false};
+  std::atomic<int> received_count{0};
+  auto receive = [&](iree_task_t* task) {
+    seen[task - tasks.data()].fetch_add(1);
+    received_count.fetch_add(1);
+  };
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      while (!done.load()) {
+        if (iree_task_t* task = iree_task_deque_steal(&deque)) receive(task);
+      }
+    });
+  }
+
+  for (int i = 0; i < kTaskCount; ++i) {
+    while (!iree_task_deque_push(&deque, &tasks[i])) {
+      if (iree_task_t* task = iree_task_deque_pop(&deque)) receive(task);
+    }
+    if (i % 3 == 0) {
+      if (iree_task_t* task = iree_task_deque_pop(&deque)) receive(task);
+    }
+  }
+  while (received_count.load() < kTaskCount) {
+    if (iree_task_t* task = iree_task_deque_pop(&deque)) receive(task);
+  }
+  done.store(true);
+  for (auto& thief : thieves) thief.join();
+
+  for (int i = 0; i < kTaskCount; ++i) {
+    EXPECT_EQ(1, seen[i].load()) << "task " << i;
+  }
+
+  iree_task_deque_deinitialize(&deque);
+}
+
+}  // namespace
@@ -10,7 +10,9 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/wait_handle.h"
 #include "iree/base/tracing.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor_impl.h"
@@ -27,6 +29,8 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor);
 void iree_task_executor_options_initialize(
     iree_task_executor_options_t* out_options) {
   memset(out_options, 0, sizeof(*out_options));
+  out_options->worker_local_memory_limit =
+      IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT;
 }
 
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
@@ -73,11 +77,20 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_allocator_malloc(allocator, executor_size, (void**)&executor));
-  memset(executor, 0, executor_size);
+  // NOTE: we only zero the executor and worker list here; each worker zeros
+  // its own local memory from its thread so that pages are first-touched on
+  // the NUMA node the worker is pinned to.
+  memset(executor, 0, executor_base_size + worker_list_size);
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  executor->worker_local_memory_limit = iree_max(
+      options.worker_local_memory_size, options.worker_local_memory_limit);
+  iree_atomic_store_int32(&executor->spinning_worker_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int32(&executor->desired_spinning_worker_count,
+                          (int32_t)worker_count, iree_memory_order_relaxed);
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
@@ -113,14 +126,35 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
         worker_count * IREE_TASK_EXECUTOR_INITIAL_SHARD_RESERVATION_PER_WORKER,
         &executor->transient_task_pool);
   }
+  if (iree_status_is_ok(status)) {
+    iree_task_pool_magazine_initialize(&executor->transient_task_pool,
+                                       &executor->transient_task_magazine);
+  }
 
   // Wait handling polling and waiting use a dedicated thread to ensure that
   // blocking syscalls stay off the workers.
   if (iree_status_is_ok(status)) {
-    // For now we allow the poller to run anywhere - we should allow callers to
-    // specify it via the topology (or something).
+    // By default we allow the poller to run anywhere. On hybrid systems we
+    // instead keep it on an efficiency core: it spends nearly all of its time
+    // in the kernel and waking it doesn't need a fast core. We pick the last
+    // efficiency group as it is the least likely to be given dispatch work.
     iree_thread_affinity_t poller_thread_affinity;
     iree_thread_affinity_set_any(&poller_thread_affinity);
+    iree_task_topology_group_mask_t efficiency_group_mask =
+        iree_task_topology_calculate_core_class_mask(
+            topology, IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY);
+    iree_task_topology_group_mask_t performance_group_mask =
+        iree_task_topology_calculate_core_class_mask(
+            topology, IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE);
+    if (efficiency_group_mask && performance_group_mask) {
+      iree_host_size_t poller_group_index =
+          IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT - 1 -
+          iree_math_count_leading_zeros_u64(efficiency_group_mask);
+      poller_thread_affinity =
+          iree_task_topology_get_group(topology, poller_group_index)
+              ->ideal_thread_affinity;
+      executor->worker_efficiency_mask = efficiency_group_mask;
+    }
     status = iree_task_poller_initialize(executor, poller_thread_affinity,
                                          &executor->poller);
   }
@@ -144,8 +178,7 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
 
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
-          executor, i, iree_task_topology_get_group(topology, i),
-          options.worker_stack_size,
+          executor, i, topology, options.worker_stack_size,
           iree_make_byte_span(worker_local_memory,
                               options.worker_local_memory_size),
           &seed_prng, worker);
@@ -210,6 +243,7 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
   iree_event_pool_free(executor->event_pool);
   iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
+  iree_task_pool_magazine_deinitialize(&executor->transient_task_magazine);
   iree_task_pool_deinitialize(&executor->transient_task_pool);
   iree_allocator_free(executor->allocator, executor);
 
@@ -242,6 +276,36 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_capacity,
+    iree_task_worker_statistics_t* out_worker_statistics,
+    iree_task_executor_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(!worker_capacity || out_worker_statistics);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  out_statistics->worker_count = executor->worker_count;
+  out_statistics->poller_waits = (uint64_t)iree_atomic_load_int64(
+      &executor->poller.wait_count, iree_memory_order_relaxed);
+
+  iree_task_worker_statistics_t* total = &out_statistics->total;
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    iree_task_worker_statistics_t worker_statistics;
+    iree_task_worker_query_statistics(&executor->workers[i],
+                                      &worker_statistics);
+    if (i < worker_capacity) out_worker_statistics[i] = worker_statistics;
+    total->tasks_executed += worker_statistics.tasks_executed;
+    total->tiles_executed += worker_statistics.tiles_executed;
+    total->steals_succeeded += worker_statistics.steals_succeeded;
+    total->steals_failed += worker_statistics.steals_failed;
+    total->wakeups += worker_statistics.wakeups;
+    total->idle_time_ns += worker_statistics.idle_time_ns;
+    total->busy_time_ns += worker_statistics.busy_time_ns;
+    total->local_memory_size += worker_statistics.local_memory_size;
+    total->local_memory_grows += worker_statistics.local_memory_grows;
+  }
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -275,6 +339,139 @@ static void iree_task_executor_relay_to_worker(
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
+// Fixed-point scale applied to task costs before dividing by scope weights so
+// that large weights still advance virtual time.
+#define IREE_TASK_EXECUTOR_FAIR_COST_SCALE (1 << 16)
+
+// Returns the weighted fair queueing cost of scheduling |task|.
+static int64_t iree_task_executor_fair_task_cost(iree_task_t* task) {
+  if (task->type != IREE_TASK_TYPE_DISPATCH ||
+      (task->flags & (IREE_TASK_FLAG_DISPATCH_RETIRE |
+                      IREE_TASK_FLAG_DISPATCH_INDIRECT))) {
+    return 1;
+  }
+  const uint32_t* workgroup_count =
+      ((iree_task_dispatch_t*)task)->workgroup_count.value;
+  uint64_t tile_count = (uint64_t)workgroup_count[0] * workgroup_count[1] *
+                        workgroup_count[2];
+  return (int64_t)iree_max(
+      1, iree_min(tile_count, IREE_TASK_EXECUTOR_MAX_FAIR_TASK_COST));
+}
+
+// Reorders the tasks in |band_list| (all of the same priority) by weighted fair
+// queueing across their scopes: each scope accrues virtual time proportional
+// to the cost of its scheduled tasks divided by its weight and the scope with
+// the least virtual time has its next task scheduled. The relative order of
+// tasks within each scope is preserved.
+//
+// Only called during coordination and expects the coordinator lock to be held.
+static void iree_task_executor_fair_order_list(iree_task_executor_t* executor,
+                                               iree_task_list_t* band_list) {
+  if (iree_task_list_is_empty(band_list)) return;
+
+  // Partition tasks by scope. Most passes only have a single scope ready in
+  // which case there is nothing to interleave. Tasks without scopes are
+  // discarded during scheduling and need no ordering.
+  iree_task_scope_t* scopes[IREE_TASK_EXECUTOR_MAX_FAIR_SCOPES_PER_PASS];
+  iree_task_list_t scope_lists[IREE_TASK_EXECUTOR_MAX_FAIR_SCOPES_PER_PASS];
+  iree_host_size_t scope_count = 0;
+  iree_task_list_t overflow_list;
+  iree_task_list_initialize(&overflow_list);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(band_list))) {
+    if (!task->scope) {
+      iree_task_list_push_back(&overflow_list, task);
+      continue;
+    }
+    iree_host_size_t i = 0;
+    for (; i < scope_count; ++i) {
+      if (scopes[i] == task->scope) break;
+    }
+    if (i == scope_count) {
+      if (scope_count == IREE_ARRAYSIZE(scopes)) {
+        iree_task_list_push_back(&overflow_list, task);
+        continue;
+      }
+      scopes[i] = task->scope;
+      iree_task_list_initialize(&scope_lists[i]);
+      ++scope_count;
+    }
+    iree_task_list_push_back(&scope_lists[i], task);
+  }
+  if (scope_count <= 1) {
+    if (scope_count == 1) iree_task_list_append(band_list, &scope_lists[0]);
+    iree_task_list_append(band_list, &overflow_list);
+    return;
+  }
+
+  // Scopes that were idle resume at the current virtual time.
+  for (iree_host_size_t i = 0; i < scope_count; ++i) {
+    if (scopes[i]->fair_virtual_time < executor->fair_virtual_time) {
+      scopes[i]->fair_virtual_time = executor->fair_virtual_time;
+    }
+  }
+
+  // Repeatedly schedule from the scope with the least virtual time.
+  while (scope_count > 0) {
+    iree_host_size_t next_index = 0;
+    for (iree_host_size_t i = 1; i < scope_count; ++i) {
+      if (scopes[i]->fair_virtual_time <
+          scopes[next_index]->fair_virtual_time) {
+        next_index = i;
+      }
+    }
+    iree_task_scope_t* scope = scopes[next_index];
+    task = iree_task_list_pop_front(&scope_lists[next_index]);
+    iree_task_list_push_back(band_list, task);
+    executor->fair_virtual_time = scope->fair_virtual_time;
+    scope->fair_virtual_time += iree_task_executor_fair_task_cost(task) *
+                                IREE_TASK_EXECUTOR_FAIR_COST_SCALE /
+                                iree_task_scope_weight(scope);
+    if (iree_task_list_is_empty(&scope_lists[next_index])) {
+      // Swap-remove the drained scope.
+      --scope_count;
+      scopes[next_index] = scopes[scope_count];
+      scope_lists[next_index] = scope_lists[scope_count];
+    }
+  }
+  iree_task_list_append(band_list, &overflow_list);
+}
+
+// Reorders the |ready_list| such that tasks from higher priority scopes come
+// before those of lower priority. Tasks of the same priority from different
+// scopes are interleaved by weighted fair queueing and the relative order of
+// tasks within the same scope is preserved.
+//
+// Only called during coordination and expects the coordinator lock to be held.
+static void iree_task_executor_prioritize_ready_list(
+    iree_task_executor_t* executor, iree_task_list_t* ready_list) {
+  if (iree_task_list_is_empty(ready_list)) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Sampled once per pass; deadlines are coarse enough that this is fine.
+  const iree_time_t now_ns = iree_time_now();
+
+  iree_task_list_t priority_lists[IREE_TASK_PRIORITY_COUNT];
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(priority_lists); ++i) {
+    iree_task_list_initialize(&priority_lists[i]);
+  }
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(ready_list))) {
+    iree_task_priority_t priority =
+        task->scope ? iree_task_scope_effective_priority(task->scope, now_ns)
+                    : IREE_TASK_PRIORITY_NORMAL;
+    iree_task_list_push_back(
+        &priority_lists[iree_min(priority, IREE_TASK_PRIORITY_COUNT - 1)],
+        task);
+  }
+  for (iree_host_size_t i = IREE_ARRAYSIZE(priority_lists); i > 0; --i) {
+    iree_task_executor_fair_order_list(executor, &priority_lists[i - 1]);
+    iree_task_list_append(ready_list, &priority_lists[i - 1]);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 // Schedules all ready tasks in the |pending_submission| list.
 // Task may enqueue zero or more new tasks (or newly-ready/waiting tasks) to
 // |pending_submission| or queue work for posting to workers via the
@@ -290,6 +487,12 @@ void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Schedule higher priority tasks first so that their work (and the shards of
+  // any dispatches) are posted to workers ahead of lower priority work.
+  iree_task_executor_prioritize_ready_list(executor,
+                                           &pending_submission->ready_list);
+
   iree_task_t* task = NULL;
   while ((task = iree_task_list_pop_front(&pending_submission->ready_list))) {
     // If the scope has been marked as failing then we abort the task.
@@ -347,8 +550,17 @@ void iree_task_executor_schedule_ready_tasks(
                                     pending_submission);
         } else {
           iree_task_dispatch_issue((iree_task_dispatch_t*)task,
-                                   &executor->transient_task_pool,
+                                   &executor->transient_task_magazine,
                                    pending_submission, post_batch);
+          // Only allow as many workers to spin as the dispatch has tiles for;
+          // any more would just be burning cycles waiting for work that will
+          // never come.
+          // The count is accessed with 'relaxed' order because it is a hint.
+          iree_atomic_store_int32(
+              &executor->desired_spinning_worker_count,
+              (int32_t)iree_min(((iree_task_dispatch_t*)task)->tile_count,
+                                executor->worker_count),
+              iree_memory_order_relaxed);
         }
         break;
       }
@@ -357,8 +569,126 @@ void iree_task_executor_schedule_ready_tasks(
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Result of probing a wait task with iree_task_executor_probe_wait.
+typedef enum iree_task_executor_probe_result_e {
+  // Wait has resolved and can be retired without the poller.
+  IREE_TASK_EXECUTOR_PROBE_RESOLVED = 0,
+  // Wait has not resolved but can be cheaply queried again.
+  IREE_TASK_EXECUTOR_PROBE_PENDING,
+  // Wait must be handled by the poller.
+  IREE_TASK_EXECUTOR_PROBE_POLLER,
+} iree_task_executor_probe_result_t;
+
+// Queries whether |task| has resolved.
+// Waits with cancellation flags (including wait-any), pending delays, expired
+// deadlines, or failures are left to the poller which implements the full
+// retirement semantics for them. System wait handles require a syscall to query
+// and are only queried once before being handed to the poller while
+// process-local wait sources may be re-queried cheaply.
+static iree_task_executor_probe_result_t iree_task_executor_probe_wait(
+    iree_task_wait_t* task, iree_time_t now_ns) {
+  if (task->cancellation_flag != NULL) {
+    return IREE_TASK_EXECUTOR_PROBE_POLLER;
+  } else if (iree_wait_source_is_immediate(task->wait_source)) {
+    return IREE_TASK_EXECUTOR_PROBE_RESOLVED;
+  } else if (iree_wait_source_is_delay(task->wait_source)) {
+    iree_time_t delay_deadline_ns = (iree_time_t)task->wait_source.data;
+    return delay_deadline_ns <= now_ns + IREE_TASK_EXECUTOR_DELAY_SLOP_NS
+               ? IREE_TASK_EXECUTOR_PROBE_RESOLVED
+               : IREE_TASK_EXECUTOR_PROBE_POLLER;
+  } else if (task->deadline_ns <= now_ns) {
+    return IREE_TASK_EXECUTOR_PROBE_POLLER;
+  }
+  const bool is_system_handle =
+      iree_wait_handle_from_source(&task->wait_source) != NULL;
+  iree_status_code_t wait_status_code = IREE_STATUS_DEFERRED;
+  iree_status_t status =
+      iree_wait_source_query(task->wait_source, &wait_status_code);
+  if (!iree_status_is_ok(status)) {
+    // The poller will query again and propagate the failure to the scope.
+    iree_status_ignore(status);
+    return IREE_TASK_EXECUTOR_PROBE_POLLER;
+  }
+  switch (wait_status_code) {
+    case IREE_STATUS_OK:
+      return IREE_TASK_EXECUTOR_PROBE_RESOLVED;
+    case IREE_STATUS_DEFERRED:
+      return is_system_handle ? IREE_TASK_EXECUTOR_PROBE_POLLER
+                              : IREE_TASK_EXECUTOR_PROBE_PENDING;
+    default:
+      return IREE_TASK_EXECUTOR_PROBE_POLLER;
+  }
+}
+
+// Routes the wait tasks in |waiting_list| either to |ready_list| if they
+// resolve inline or to the poller. Waits that can be cheaply queried are
+// re-queried for up to |spin_ns| before falling back to the poller so that
+// waits that resolve quickly avoid the poller thread round-trip entirely.
+// Resolved waits are marked with IREE_TASK_FLAG_WAIT_COMPLETED and retired the
+// next time they are scheduled. |waiting_list| will be empty upon return.
+//
+// Returns true if any waits were resolved and added to |ready_list|.
+static bool iree_task_executor_route_waits(iree_task_executor_t* executor,
+                                           iree_task_list_t* waiting_list,
+                                           iree_duration_t spin_ns,
+                                           iree_task_list_t* ready_list) {
+  if (iree_task_list_is_empty(waiting_list)) return false;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_list_t poller_list;
+  iree_task_list_initialize(&poller_list);
+  bool any_resolved = false;
+  iree_time_t now_ns = iree_time_now();
+  const iree_time_t spin_deadline_ns = now_ns + spin_ns;
+  do {
+    iree_task_t* prev_task = NULL;
+    iree_task_t* task = iree_task_list_front(waiting_list);
+    while (task != NULL) {
+      iree_task_t* next_task = task->next_task;
+      switch (iree_task_executor_probe_wait((iree_task_wait_t*)task, now_ns)) {
+        case IREE_TASK_EXECUTOR_PROBE_RESOLVED:
+          iree_task_list_erase(waiting_list, prev_task, task);
+          task->flags |= IREE_TASK_FLAG_WAIT_COMPLETED;
+          iree_task_list_push_front(ready_list, task);
+          any_resolved = true;
+          break;
+        case IREE_TASK_EXECUTOR_PROBE_POLLER:
+          iree_task_list_erase(waiting_list, prev_task, task);
+          iree_task_list_push_back(&poller_list, task);
+          break;
+        default:
+          prev_task = task;
+          break;
+      }
+      task = next_task;
+    }
+
+    // Hand off the waits we can't handle as early as possible so that the
+    // poller can begin waiting on them while we spin on the rest.
+    if (!iree_task_list_is_empty(&poller_list)) {
+      iree_task_poller_enqueue(&executor->poller, &poller_list);
+    }
+    if (iree_task_list_is_empty(waiting_list) || spin_ns <= 0) break;
+    now_ns = iree_time_now();
+  } while (now_ns < spin_deadline_ns);
+
+  // Any waits still pending after spinning go to the poller.
+  iree_task_poller_enqueue(&executor->poller, waiting_list);
+
+  IREE_TRACE_ZONE_END(z0);
+  return any_resolved;
+}
+
 void iree_task_executor_merge_submission(iree_task_executor_t* executor,
                                          iree_task_submission_t* submission) {
+  // Retire any waits that have already resolved along with the ready tasks
+  // and enqueue the remaining waiting tasks with the poller immediately: this
+  // may issue a syscall to kick the poller. If we see bad context switches here
+  // then we should split this into an enqueue/flush pair.
+  // We don't spin here as the caller may be a user thread submitting work.
+  iree_task_executor_route_waits(executor, &submission->waiting_list,
+                                 IREE_DURATION_ZERO, &submission->ready_list);
+
   // Concatenate all of the incoming tasks into the submission list.
   // Note that the submission stores tasks in LIFO order such that when they are
   // put into the LIFO atomic slist they match the order across all concats
@@ -367,11 +697,6 @@ void iree_task_executor_merge_submission(iree_task_executor_t* executor,
                                 submission->ready_list.head,
                                 submission->ready_list.tail);
 
-  // Enqueue waiting tasks with the poller immediately: this may issue a
-  // syscall to kick the poller. If we see bad context switches here then we
-  // should split this into an enqueue/flush pair.
-  iree_task_poller_enqueue(&executor->poller, &submission->waiting_list);
-
   // NOTE: after concatenating the intrusive next_task pointers may immediately
   // be modified by other threads. We can no longer assume anything about the
   // submission lists and can only discard them.
@@ -381,6 +706,8 @@ void iree_task_executor_merge_submission(iree_task_executor_t* executor,
 void iree_task_executor_submit(iree_task_executor_t* executor,
                                iree_task_submission_t* submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_FLIGHT_RECORD_INSTANT(IREE_FLIGHT_RECORDER_CATEGORY_SUBMISSION,
+                             "executor_submit", 0);
 
   // Concatenate the submitted tasks onto our primary LIFO incoming lists.
   iree_task_executor_merge_submission(executor, submission);
@@ -463,21 +790,55 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     iree_task_executor_schedule_ready_tasks(executor, &pending_submission,
                                             post_batch);
 
-    // Route waiting tasks to the poller.
-    iree_task_poller_enqueue(&executor->poller,
-                             &pending_submission.waiting_list);
-
     iree_slim_mutex_unlock(&executor->coordinator_mutex);
     IREE_TRACE_ZONE_END(z1);
 
     // Post all new work to workers; they may wake and begin executing
     // immediately. Returns whether this worker has new tasks for it to work on.
     schedule_dirty = iree_task_post_batch_submit(post_batch);
+
+    // Route waiting tasks to the poller. Waits that are likely to resolve soon
+    // are spun on here (outside of the coordinator lock and after posting all
+    // other work) so that short waits don't incur a round-trip through the
+    // poller thread. Any resolved are scheduled on the next loop.
+    iree_task_list_t resolved_list;
+    iree_task_list_initialize(&resolved_list);
+    if (iree_task_executor_route_waits(executor,
+                                       &pending_submission.waiting_list,
+                                       IREE_TASK_EXECUTOR_INLINE_WAIT_SPIN_NS,
+                                       &resolved_list)) {
+      iree_atomic_task_slist_concat(&executor->incoming_ready_slist,
+                                    resolved_list.head, resolved_list.tail);
+      schedule_dirty = true;
+    }
   } while (schedule_dirty);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+iree_duration_t iree_task_executor_begin_spin(iree_task_executor_t* executor) {
+  if (executor->worker_spin_ns == IREE_DURATION_ZERO) return IREE_DURATION_ZERO;
+  const int32_t desired_count =
+      iree_atomic_load_int32(&executor->desired_spinning_worker_count,
+                             iree_memory_order_relaxed);
+  const int32_t prior_count = iree_atomic_fetch_add_int32(
+      &executor->spinning_worker_count, 1, iree_memory_order_relaxed);
+  if (prior_count >= desired_count) {
+    // Enough workers are already spinning; park immediately.
+    iree_atomic_fetch_sub_int32(&executor->spinning_worker_count, 1,
+                                iree_memory_order_relaxed);
+    return IREE_DURATION_ZERO;
+  }
+  return executor->worker_spin_ns;
+}
+
+void iree_task_executor_end_spin(iree_task_executor_t* executor,
+                                 iree_duration_t spin_ns) {
+  if (spin_ns == IREE_DURATION_ZERO) return;
+  iree_atomic_fetch_sub_int32(&executor->spinning_worker_count, 1,
+                              iree_memory_order_relaxed);
+}
+
 static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
     uint32_t max_theft_attempts, int rotation_offset,
@@ -546,7 +907,8 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t node_sharing_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -578,13 +940,31 @@ iree_task_t* iree_task_executor_try_steal_task(
       rotation_offset, local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
-  } else {
-    task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
-    if (task) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
-    }
+    IREE_TRACE_ZONE_END(z0);
+    return task;
+  }
+  victim_mask &= ~constructive_sharing_mask;
+
+  // Try next with the workers on the same NUMA node. Though we may not share
+  // any caches the memory the tasks touch was likely allocated on the node and
+  // accessing it will not have to cross the interconnect.
+  task = iree_task_executor_try_steal_task_from_affinity_set(
+      executor, victim_mask & node_sharing_mask, max_theft_attempts,
+      rotation_offset, local_task_queue);
+  if (task) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "node-local");
+    IREE_TRACE_ZONE_END(z0);
+    return task;
+  }
+  victim_mask &= ~node_sharing_mask;
+
+  // Finally fall back to any worker; this will cross NUMA nodes on multi-node
+  // systems and is a last resort.
+  task = iree_task_executor_try_steal_task_from_affinity_set(
+      executor, victim_mask, max_theft_attempts, rotation_offset,
+      local_task_queue);
+  if (task) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -286,6 +286,10 @@ typedef struct iree_task_executor_options_t {
   // spinning is often extremely harmful to system health. Only set to non-zero
   // values when latency is the #1 priority (over thermals, system-wide
   // scheduling, and the environment).
+  //
+  // When non-zero only as many workers as the most recently issued dispatch
+  // has tiles for will spin; all others will park immediately. This prevents
+  // narrow dispatches from keeping the entire worker pool hot.
   iree_duration_t worker_spin_ns;
 
   // Minimum size in bytes of each worker thread stack.
@@ -302,6 +306,14 @@ typedef struct iree_task_executor_options_t {
   // for their invocations and no more. May be 0 if no worker local memory is
   // required.
   iree_host_size_t worker_local_memory_size;
+
+  // Maximum bytes of local memory each worker may use. When a dispatch requires
+  // more local memory than a worker has the worker grows its local memory on
+  // demand up to this limit. Grown memory is allocated from the worker thread
+  // so that it is placed on the NUMA node local to the worker and is backed by
+  // large pages when large enough. Set to worker_local_memory_size (or 0) to
+  // disable growth.
+  iree_host_size_t worker_local_memory_limit;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -335,6 +347,54 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Counters describing the activity of a single worker since executor creation.
+// Counters are updated exclusively by the worker thread and may be queried
+// while the worker is running; queries may observe slightly stale values.
+typedef struct iree_task_worker_statistics_t {
+  // Total number of tasks executed by the worker (including stolen tasks).
+  uint64_t tasks_executed;
+  // Total number of dispatch tiles (workgroups) executed by the worker.
+  uint64_t tiles_executed;
+  // Number of times the worker ran out of work and stole from another worker.
+  uint64_t steals_succeeded;
+  // Number of times the worker ran out of work and found nothing to steal.
+  uint64_t steals_failed;
+  // Number of times the worker woke from an idle wait (spin or kernel).
+  uint64_t wakeups;
+  // Total time the worker spent waiting for work to arrive.
+  iree_duration_t idle_time_ns;
+  // Total time the worker spent outside of idle waits (processing tasks,
+  // coordinating, and searching for work).
+  iree_duration_t busy_time_ns;
+  // Current bytes of local memory available to the worker.
+  uint64_t local_memory_size;
+  // Number of times the worker grew its local memory.
+  uint64_t local_memory_grows;
+} iree_task_worker_statistics_t;
+
+// Executor-wide statistics aggregated across all workers.
+typedef struct iree_task_executor_statistics_t {
+  // Total number of workers in the executor. May be larger than the capacity
+  // passed to iree_task_executor_query_statistics.
+  iree_host_size_t worker_count;
+  // Number of system waits performed by the executor wait poller thread.
+  uint64_t poller_waits;
+  // Sum of the statistics of all workers.
+  iree_task_worker_statistics_t total;
+} iree_task_executor_statistics_t;
+
+// Queries the statistics of |executor| and its workers.
+// Up to |worker_capacity| entries of |out_worker_statistics| are populated with
+// per-worker statistics in worker order; |out_worker_statistics| may be NULL if
+// |worker_capacity| is 0 and only the aggregate |out_statistics| are required.
+//
+// Statistics are gathered without synchronizing with the workers and may
+// experience tearing if queried while work is in-flight.
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_capacity,
+    iree_task_worker_statistics_t* out_worker_statistics,
+    iree_task_executor_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -38,6 +38,21 @@ struct iree_task_executor_t {
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
+  // Maximum bytes of local memory each worker may grow to.
+  iree_host_size_t worker_local_memory_limit;
+
+  // Number of workers currently spinning while waiting for more work.
+  // Workers that go idle when this is at or above the desired spin count will
+  // park immediately in the kernel without spinning.
+  iree_atomic_int32_t spinning_worker_count;
+
+  // Number of workers that should be allowed to spin when going idle.
+  // Updated when dispatches are issued based on their tile count such that
+  // only as many workers as the work will likely be able to use stay hot.
+  //
+  // This is just a hint, accessed with memory_order_relaxed.
+  iree_atomic_int32_t desired_spinning_worker_count;
+
   // State used by the work-stealing operations performed by donated threads.
   // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
   // much care about the precise selection of workers enough to mind any tears
@@ -56,6 +71,16 @@ struct iree_task_executor_t {
   // Increasing the size larger than these will waste memory.
   iree_task_pool_t transient_task_pool;
 
+  // Cache of transient tasks used to allocate dispatch shards during
+  // coordination. Guarded by |coordinator_mutex|.
+  iree_task_pool_magazine_t transient_task_magazine;
+
+  // Virtual time of the last scheduled task used for weighted fair queueing
+  // across scopes. Scopes that have been idle are advanced to this time when
+  // they next have work ready so that they cannot bank their idle time and
+  // monopolize the executor. Guarded by |coordinator_mutex|.
+  int64_t fair_virtual_time;
+
   // A list of incoming tasks that are ready to execute immediately.
   // The list is LIFO and we require that task lists are reversed by the
   // submitter so we can use iree_atomic_slist_concat to quickly prepend the
@@ -112,6 +137,11 @@ struct iree_task_executor_t {
   // comment on worker_live_mask.
   iree_atomic_task_affinity_set_t worker_idle_mask;
 
+  // A bitset indicating which workers run on efficiency cores in hybrid
+  // topologies. Dispatch shards are preferentially placed on the other
+  // (performance) workers. 0 if all workers are of the same class.
+  iree_task_affinity_set_t worker_efficiency_mask;
+
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
   // configurations.
@@ -150,13 +180,28 @@ void iree_task_executor_schedule_ready_tasks(
 void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    iree_task_worker_t* current_worker);
 
+// Returns the spin duration a worker going idle should use. If the worker is
+// allowed to spin it will be counted against the spinning worker count and
+// must call iree_task_executor_end_spin after its wait completes.
+iree_duration_t iree_task_executor_begin_spin(iree_task_executor_t* executor);
+
+// Releases the spin reservation acquired by iree_task_executor_begin_spin.
+// |spin_ns| must be the value returned from the begin call.
+void iree_task_executor_end_spin(iree_task_executor_t* executor,
+                                 iree_duration_t spin_ns);
+
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
+//
+// Victims are tried in order of locality: first those in the
+// |constructive_sharing_mask| (sharing some cache level), then those in the
+// |node_sharing_mask| (same NUMA node), and only then any remaining workers.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t node_sharing_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
 #ifdef __cplusplus
@@ -6,6 +6,7 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
 #include <cstddef>
 
 #include "iree/testing/gtest.h"
@@ -133,4 +134,206 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that worker statistics account for the work executed.
+TEST(ExecutorTest, QueryStatistics) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static const int kCallCount = 100;
+  for (int i = 0; i < kCallCount; ++i) {
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  // Aggregate-only query.
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, 0, NULL, &statistics);
+  EXPECT_EQ(statistics.worker_count, 4);
+  EXPECT_GE(statistics.total.tasks_executed, (uint64_t)kCallCount);
+  EXPECT_EQ(statistics.total.tiles_executed, 0);
+
+  // Per-worker query; the workers must sum to at least what was executed when
+  // the aggregate was captured.
+  iree_task_worker_statistics_t worker_statistics[4];
+  iree_task_executor_query_statistics(executor,
+                                      IREE_ARRAYSIZE(worker_statistics),
+                                      worker_statistics, &statistics);
+  uint64_t tasks_executed = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(worker_statistics); ++i) {
+    tasks_executed += worker_statistics[i].tasks_executed;
+    EXPECT_GE(worker_statistics[i].busy_time_ns, 0);
+    EXPECT_GE(worker_statistics[i].idle_time_ns, 0);
+  }
+  EXPECT_EQ(tasks_executed, statistics.total.tasks_executed);
+  EXPECT_GE(tasks_executed, (uint64_t)kCallCount);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that ready tasks from scopes of the same priority are interleaved in
+// proportion to their weights instead of in submission order.
+TEST(ExecutorTest, WeightedFairQueueing) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  // A single worker executes tasks in the order they were scheduled.
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope_a;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope_a);
+  iree_task_scope_set_weight(&scope_a, 3);
+  iree_task_scope_t scope_b;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_b"), &scope_b);
+
+  static constexpr int kCallCountA = 12;
+  static constexpr int kCallCountB = 4;
+  static std::atomic<int> execution_index = {0};
+  static iree_task_scope_t* execution_order[kCallCountA + kCallCountB];
+  execution_index = 0;
+  auto record_scope = [](void* user_context, iree_task_t* task,
+                         iree_task_submission_t* pending_submission) {
+    execution_order[execution_index++] = task->scope;
+    return iree_ok_status();
+  };
+
+  // All of scope_a's tasks are submitted ahead of scope_b's.
+  iree_task_fence_t* fence_a = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &scope_a, &fence_a));
+  iree_task_fence_t* fence_b = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &scope_b, &fence_b));
+  iree_task_call_t calls[kCallCountA + kCallCountB];
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (int i = 0; i < kCallCountA + kCallCountB; ++i) {
+    bool is_a = i < kCallCountA;
+    iree_task_call_initialize(is_a ? &scope_a : &scope_b,
+                              iree_task_make_call_closure(record_scope, NULL),
+                              &calls[i]);
+    iree_task_set_completion_task(&calls[i].header,
+                                  is_a ? &fence_a->header : &fence_b->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&scope_a, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&scope_b, IREE_TIME_INFINITE_FUTURE));
+
+  // scope_b gets one task scheduled for every three of scope_a's.
+  ASSERT_EQ(execution_index, kCallCountA + kCallCountB);
+  int scope_b_count = 0;
+  for (int i = 0; i < 8; ++i) {
+    if (execution_order[i] == &scope_b) ++scope_b_count;
+  }
+  EXPECT_EQ(scope_b_count, 2);
+
+  iree_task_scope_deinitialize(&scope_b);
+  iree_task_scope_deinitialize(&scope_a);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that ready tasks from a high priority scope are scheduled ahead of a
+// low priority batch that was queued before them.
+TEST(ExecutorTest, PriorityOrdering) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  // A single worker executes tasks in the order they were scheduled.
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope_low;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_low"), &scope_low);
+  iree_task_scope_set_priority(&scope_low, IREE_TASK_PRIORITY_LOW);
+  iree_task_scope_t scope_high;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_high"),
+                             &scope_high);
+  iree_task_scope_set_priority(&scope_high, IREE_TASK_PRIORITY_HIGH);
+
+  static constexpr int kCallCountLow = 8;
+  static constexpr int kCallCountHigh = 4;
+  static std::atomic<int> execution_index = {0};
+  static iree_task_scope_t* execution_order[kCallCountLow + kCallCountHigh];
+  execution_index = 0;
+  auto record_scope = [](void* user_context, iree_task_t* task,
+                         iree_task_submission_t* pending_submission) {
+    execution_order[execution_index++] = task->scope;
+    return iree_ok_status();
+  };
+
+  // The whole low priority batch is queued ahead of the high priority tasks.
+  iree_task_fence_t* fence_low = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &scope_low, &fence_low));
+  iree_task_fence_t* fence_high = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &scope_high, &fence_high));
+  iree_task_call_t calls[kCallCountLow + kCallCountHigh];
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (int i = 0; i < kCallCountLow + kCallCountHigh; ++i) {
+    bool is_low = i < kCallCountLow;
+    iree_task_call_initialize(is_low ? &scope_low : &scope_high,
+                              iree_task_make_call_closure(record_scope, NULL),
+                              &calls[i]);
+    iree_task_set_completion_task(
+        &calls[i].header, is_low ? &fence_low->header : &fence_high->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&scope_low, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&scope_high, IREE_TIME_INFINITE_FUTURE));
+
+  // All of the high priority tasks run before any of the low priority ones.
+  ASSERT_EQ(execution_index, kCallCountLow + kCallCountHigh);
+  for (int i = 0; i < kCallCountHigh; ++i) {
+    EXPECT_EQ(execution_order[i], &scope_high);
+  }
+  for (int i = kCallCountHigh; i < kCallCountLow + kCallCountHigh; ++i) {
+    EXPECT_EQ(execution_order[i], &scope_low);
+  }
+
+  iree_task_scope_deinitialize(&scope_high);
+  iree_task_scope_deinitialize(&scope_low);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
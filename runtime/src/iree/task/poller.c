@@ -26,6 +26,8 @@ iree_status_t iree_task_poller_initialize(
   iree_notification_initialize(&out_poller->state_notification);
   iree_atomic_task_slist_initialize(&out_poller->mailbox_slist);
   iree_task_list_initialize(&out_poller->wait_list);
+  iree_atomic_store_int64(&out_poller->wait_count, 0,
+                          iree_memory_order_relaxed);
 
   iree_task_poller_state_t initial_state = IREE_TASK_POLLER_STATE_RUNNING;
   // TODO(benvanik): support initially suspended wait threads. This can reduce
@@ -439,6 +441,11 @@ static void iree_task_poller_commit_wait(iree_task_poller_t* poller,
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Enter the system wait API.
+  iree_atomic_store_int64(
+      &poller->wait_count,
+      iree_atomic_load_int64(&poller->wait_count, iree_memory_order_relaxed) +
+          1,
+      iree_memory_order_relaxed);
   iree_wait_handle_t wake_handle = iree_wait_handle_immediate();
   iree_status_t status =
       iree_wait_any(poller->wait_set, deadline_ns, &wake_handle);
@@ -102,6 +102,10 @@ typedef struct {
   // This may only contain a subset of the wait_list in cases where some of
   // the wait tasks do not have full system handles.
   iree_wait_set_t* wait_set;
+
+  // Total number of system waits performed by the wait thread.
+  // Only written by the wait thread and read when querying statistics.
+  iree_atomic_int64_t wait_count;
 } iree_task_poller_t;
 
 // Initializes |out_poller| with a new poller.
@@ -10,6 +10,7 @@
 
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
+#include "iree/task/tuning.h"
 
 // Minimum byte size of a block in bytes, including the tasks as well as the
 // allocation header. This is here to allow us to reduce the number of times
@@ -130,6 +131,7 @@ iree_status_t iree_task_pool_initialize(iree_allocator_t allocator,
   out_pool->task_size = task_size;
   iree_atomic_task_allocation_slist_initialize(&out_pool->allocations_slist);
   iree_atomic_task_slist_initialize(&out_pool->available_slist);
+  iree_atomic_task_magazine_slist_initialize(&out_pool->magazine_slist);
   iree_status_t status =
       iree_task_pool_grow(out_pool, initial_capacity, /*out_task=*/NULL);
 
@@ -153,6 +155,7 @@ void iree_task_pool_deinitialize(iree_task_pool_t* pool) {
   }
   iree_atomic_task_allocation_slist_deinitialize(&pool->allocations_slist);
   iree_atomic_task_slist_deinitialize(&pool->available_slist);
+  iree_atomic_task_magazine_slist_deinitialize(&pool->magazine_slist);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -168,6 +171,9 @@ void iree_task_pool_trim(iree_task_pool_t* pool) {
   iree_atomic_task_slist_flush(&pool->available_slist,
                                IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
                                &task_head, /*tail=*/NULL);
+  iree_atomic_task_magazine_slist_flush(
+      &pool->magazine_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+      &task_head, /*tail=*/NULL);
 
   iree_task_allocation_header_t* allocation_head = NULL;
   if (iree_atomic_task_allocation_slist_flush(
@@ -196,6 +202,20 @@ iree_status_t iree_task_pool_acquire(iree_task_pool_t* pool,
     return iree_ok_status();
   }
 
+  // Fall back to breaking up a full magazine returned to the depot by workers.
+  // We keep the head and make the remainder available to other acquirers.
+  task = iree_atomic_task_magazine_slist_pop(&pool->magazine_slist);
+  if (task) {
+    iree_task_t* tail = task;
+    while (tail->next_task) tail = tail->next_task;
+    if (tail != task) {
+      iree_atomic_task_slist_concat(&pool->available_slist, task->next_task,
+                                    tail);
+    }
+    *out_task = task;
+    return iree_ok_status();
+  }
+
   // No tasks were available when we tried; force growth now.
   // Note that due to races it's possible that there are now tasks that have
   // been released back into the pool, but the fact that we failed once means
@@ -240,6 +260,8 @@ iree_status_t iree_task_pool_acquire_many(iree_task_pool_t* pool,
       // Instead of having the slist flush walk the list and give us a tail we
       // do that here: we need to walk the list anyway to partition it.
       iree_task_t* p = acquired_tasks.head;
+      acquired_tasks.tail = p;
+      --count;
       while (count > 0) {
         p = iree_atomic_task_slist_get_next(p);
         if (!p) break;
@@ -249,7 +271,7 @@ iree_status_t iree_task_pool_acquire_many(iree_task_pool_t* pool,
 
       // If we got everything we need then we have to put all of the flushed
       // tasks we didn't use into the leftover list.
-      if (count == 0) {
+      if (count == 0 && iree_atomic_task_slist_get_next(acquired_tasks.tail)) {
         iree_task_list_t acquire_leftovers;
         iree_task_list_initialize(&acquire_leftovers);
         acquire_leftovers.head =
@@ -296,3 +318,72 @@ void iree_task_pool_release(iree_task_pool_t* pool, iree_task_t* task) {
   IREE_ASSERT_EQ(task->pool, pool);
   iree_atomic_task_slist_push(&pool->available_slist, task);
 }
+
+//==============================================================================
+// iree_task_pool_magazine_t
+//==============================================================================
+
+void iree_task_pool_magazine_initialize(
+    iree_task_pool_t* pool, iree_task_pool_magazine_t* out_magazine) {
+  out_magazine->pool = pool;
+  out_magazine->count = 0;
+  iree_task_list_initialize(&out_magazine->tasks);
+}
+
+void iree_task_pool_magazine_deinitialize(iree_task_pool_magazine_t* magazine) {
+  iree_task_pool_magazine_flush(magazine);
+  magazine->pool = NULL;
+}
+
+void iree_task_pool_magazine_flush(iree_task_pool_magazine_t* magazine) {
+  if (!magazine->count) return;
+  iree_atomic_task_slist_concat(&magazine->pool->available_slist,
+                                magazine->tasks.head, magazine->tasks.tail);
+  iree_task_list_initialize(&magazine->tasks);
+  magazine->count = 0;
+}
+
+iree_status_t iree_task_pool_magazine_acquire(
+    iree_task_pool_magazine_t* magazine, iree_task_t** out_task) {
+  if (IREE_UNLIKELY(!magazine->count)) {
+    // Refill with a full magazine from the depot if one is available. Full
+    // magazines always have exactly half the magazine capacity.
+    iree_task_t* head =
+        iree_atomic_task_magazine_slist_pop(&magazine->pool->magazine_slist);
+    if (head) {
+      iree_task_t* tail = head;
+      while (tail->next_task) tail = tail->next_task;
+      magazine->tasks.head = head;
+      magazine->tasks.tail = tail;
+      magazine->count = IREE_TASK_POOL_MAGAZINE_CAPACITY / 2;
+    } else {
+      // No full magazines are available (such as on startup or when other
+      // threads return tasks directly to the pool) so go to the pool.
+      return iree_task_pool_acquire(magazine->pool, out_task);
+    }
+  }
+  *out_task = iree_task_list_pop_front(&magazine->tasks);
+  --magazine->count;
+  return iree_ok_status();
+}
+
+void iree_task_pool_magazine_release(iree_task_pool_magazine_t* magazine,
+                                     iree_task_t* task) {
+  IREE_ASSERT_EQ(task->pool, magazine->pool);
+  iree_task_list_push_front(&magazine->tasks, task);
+  if (++magazine->count < IREE_TASK_POOL_MAGAZINE_CAPACITY) return;
+
+  // Magazine is full: split off the most recently released half (which is most
+  // likely to still be warm in cache) to keep and move the rest to the depot
+  // as a full magazine for another thread to acquire.
+  iree_task_t* keep_tail = magazine->tasks.head;
+  for (iree_host_size_t i = 1; i < IREE_TASK_POOL_MAGAZINE_CAPACITY / 2; ++i) {
+    keep_tail = keep_tail->next_task;
+  }
+  iree_task_t* full_head = keep_tail->next_task;
+  keep_tail->next_task = NULL;
+  magazine->tasks.tail = keep_tail;
+  magazine->count = IREE_TASK_POOL_MAGAZINE_CAPACITY / 2;
+  iree_atomic_task_magazine_slist_push(&magazine->pool->magazine_slist,
+                                       full_head);
+}
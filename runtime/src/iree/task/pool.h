@@ -27,6 +27,13 @@ typedef struct iree_task_allocation_header_t {
   iree_atomic_slist_intrusive_ptr_t* next;
 } iree_task_allocation_header_t;
 
+// An atomic approximately LIFO singly-linked list of full magazines.
+// Each entry is the head task of a list of IREE_TASK_POOL_MAGAZINE_CAPACITY/2
+// tasks linked by their next_task pointers. As tasks in the pool have undefined
+// contents the otherwise unused completion_task pointer links the magazines.
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_task_magazine, iree_task_t,
+                                offsetof(iree_task_t, completion_task));
+
 // An atomic approximately LIFO singly-linked list.
 IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_task_allocation,
                                 iree_task_allocation_header_t,
@@ -68,6 +75,10 @@ typedef struct iree_task_pool_t {
   // approaches (such as small chunked linear lists) that better exploit spatial
   // locality, if needed.
   iree_atomic_task_slist_t available_slist;
+
+  // Depot of full magazines of free tasks exchanged by
+  // iree_task_pool_magazine_t in a single operation instead of per task.
+  iree_atomic_task_magazine_slist_t magazine_slist;
 } iree_task_pool_t;
 
 // Initializes a task pool and optionally performs an initial task allocation.
@@ -108,6 +119,53 @@ iree_status_t iree_task_pool_acquire_many(iree_task_pool_t* pool,
 // Callers must ensure the task is no longer in use.
 void iree_task_pool_release(iree_task_pool_t* pool, iree_task_t* task);
 
+//==============================================================================
+// iree_task_pool_magazine_t
+//==============================================================================
+
+// A thread-local cache of tasks acquired from or released to a shared pool.
+// Acquisitions and releases are batched by exchanging full magazines of
+// IREE_TASK_POOL_MAGAZINE_CAPACITY/2 tasks with the pool depot such that the
+// shared pool is only touched once per batch instead of once per task. Tasks
+// released to a magazine may have been acquired from the pool by any thread
+// and tasks acquired from a magazine may be released by any thread directly
+// to the pool or another magazine of the same pool.
+//
+// Magazines are not thread-safe and must only be used by a single thread at a
+// time (such as a worker or a thread holding a lock). All cached tasks are
+// returned to the pool when the magazine is flushed or deinitialized.
+typedef struct iree_task_pool_magazine_t {
+  // Pool the magazine acquires tasks from and releases tasks to.
+  iree_task_pool_t* pool;
+  // Number of tasks in |tasks|.
+  iree_host_size_t count;
+  // Cached tasks used as a stack (LIFO) so that recently released tasks that
+  // may still be warm in cache are the first reused.
+  iree_task_list_t tasks;
+} iree_task_pool_magazine_t;
+
+// Initializes an empty magazine for |pool|.
+void iree_task_pool_magazine_initialize(
+    iree_task_pool_t* pool, iree_task_pool_magazine_t* out_magazine);
+
+// Flushes all cached tasks back to the pool and deinitializes the magazine.
+void iree_task_pool_magazine_deinitialize(iree_task_pool_magazine_t* magazine);
+
+// Returns all cached tasks to the pool with a single atomic operation.
+void iree_task_pool_magazine_flush(iree_task_pool_magazine_t* magazine);
+
+// Acquires a task from the magazine, refilling it with a full magazine from the
+// pool depot if it is empty. The returned task will have undefined contents and
+// must be initialized by the caller.
+iree_status_t iree_task_pool_magazine_acquire(
+    iree_task_pool_magazine_t* magazine, iree_task_t** out_task);
+
+// Releases a task acquired from the magazine pool to the magazine, moving a
+// full magazine to the pool depot if it is full.
+// Callers must ensure the task is no longer in use.
+void iree_task_pool_magazine_release(iree_task_pool_magazine_t* magazine,
+                                     iree_task_t* task);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,131 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures iree_task_pool_t acquire/release throughput with all threads going
+// directly to the shared pool against threads batching through per-thread
+// iree_task_pool_magazine_t caches.
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/pool.h"
+
+namespace {
+
+typedef struct iree_test_task_t {
+  iree_task_t base;
+  uint8_t payload[64];
+} iree_test_task_t;
+
+// Number of tasks each thread holds at once per iteration; roughly the number
+// of shards a worker may retire between coordination runs.
+constexpr int kTasksPerIteration = 8;
+
+// Returns a pool shared by all threads of all benchmarks.
+// NOTE: the pool is intentionally never deinitialized: threads return tasks
+// after leaving the benchmark loop and there is no barrier after which it would
+// be safe to tear it down.
+static iree_task_pool_t* GetSharedPool() {
+  static iree_task_pool_t* pool = [] {
+    iree_task_pool_t* pool = new iree_task_pool_t();
+    IREE_CHECK_OK(iree_task_pool_initialize(iree_allocator_system(),
+                                            sizeof(iree_test_task_t),
+                                            /*initial_capacity=*/1024, pool));
+    return pool;
+  }();
+  return pool;
+}
+
+void BM_SharedAcquireRelease(benchmark::State& state) {
+  iree_task_pool_t* shared_pool = GetSharedPool();
+  iree_task_t* tasks[kTasksPerIteration];
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      IREE_CHECK_OK(iree_task_pool_acquire(shared_pool, &tasks[i]));
+    }
+    benchmark::DoNotOptimize(tasks);
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      iree_task_pool_release(shared_pool, tasks[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+BENCHMARK(BM_SharedAcquireRelease)->UseRealTime()->ThreadRange(1, 64);
+
+void BM_MagazineAcquireRelease(benchmark::State& state) {
+  iree_task_pool_t* shared_pool = GetSharedPool();
+  iree_task_pool_magazine_t magazine;
+  iree_task_pool_magazine_initialize(shared_pool, &magazine);
+  iree_task_t* tasks[kTasksPerIteration];
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      IREE_CHECK_OK(iree_task_pool_magazine_acquire(&magazine, &tasks[i]));
+    }
+    benchmark::DoNotOptimize(tasks);
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      iree_task_pool_magazine_release(&magazine, tasks[i]);
+    }
+  }
+  iree_task_pool_magazine_deinitialize(&magazine);
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+BENCHMARK(BM_MagazineAcquireRelease)->UseRealTime()->ThreadRange(1, 64);
+
+// Models dispatch shards acquired on one thread and retired on another: each
+// thread acquires tasks and hands them to the next thread through its inbox
+// and releases all tasks it finds in its own inbox.
+constexpr int kMaxThreads = 64;
+static iree_atomic_task_slist_t inbox_slists[kMaxThreads];
+
+template <bool kUseMagazines>
+void BM_CrossThreadRelease(benchmark::State& state) {
+  iree_task_pool_t* shared_pool = GetSharedPool();
+  const int thread_index = state.thread_index();
+  iree_atomic_task_slist_t* inbox = &inbox_slists[thread_index];
+  iree_atomic_task_slist_t* next_inbox =
+      &inbox_slists[(thread_index + 1) % state.threads()];
+  iree_atomic_task_slist_initialize(inbox);
+  iree_task_pool_magazine_t magazine;
+  iree_task_pool_magazine_initialize(shared_pool, &magazine);
+  for (auto _ : state) {
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      iree_task_t* task = NULL;
+      if (kUseMagazines) {
+        IREE_CHECK_OK(iree_task_pool_magazine_acquire(&magazine, &task));
+      } else {
+        IREE_CHECK_OK(iree_task_pool_acquire(shared_pool, &task));
+      }
+      iree_atomic_task_slist_push(next_inbox, task);
+    }
+    iree_task_t* task = NULL;
+    while ((task = iree_atomic_task_slist_pop(inbox))) {
+      if (kUseMagazines) {
+        iree_task_pool_magazine_release(&magazine, task);
+      } else {
+        iree_task_pool_release(shared_pool, task);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+
+  // NOTE: all threads have exited the benchmark loop (it ends with a barrier)
+  // and no longer push to the inbox.
+  iree_task_t* task = NULL;
+  while ((task = iree_atomic_task_slist_pop(inbox))) {
+    iree_task_pool_release(shared_pool, task);
+  }
+  iree_atomic_task_slist_deinitialize(inbox);
+  iree_task_pool_magazine_deinitialize(&magazine);
+}
+BENCHMARK_TEMPLATE(BM_CrossThreadRelease, false)
+    ->UseRealTime()
+    ->ThreadRange(2, kMaxThreads);
+BENCHMARK_TEMPLATE(BM_CrossThreadRelease, true)
+    ->UseRealTime()
+    ->ThreadRange(2, kMaxThreads);
+
+}  // namespace
@@ -8,6 +8,8 @@
 
 #include <cstdint>
 
+#include "iree/task/list.h"
+#include "iree/task/tuning.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -89,4 +91,58 @@ TEST(PoolTest, Trim) {
   iree_task_pool_deinitialize(&pool);
 }
 
+TEST(PoolTest, AcquireMany) {
+  iree_task_pool_t pool;
+  IREE_ASSERT_OK(iree_task_pool_initialize(iree_allocator_system(),
+                                           sizeof(iree_test_task_t), 2, &pool));
+
+  // Acquire exactly the requested number of tasks both when the pool has fewer
+  // available (forcing growth) and when it has more (leaving leftovers).
+  for (iree_host_size_t count : {1, 3, 8, 1}) {
+    iree_task_list_t list;
+    IREE_ASSERT_OK(iree_task_pool_acquire_many(&pool, count, &list));
+    EXPECT_EQ(count, iree_task_list_calculate_size(&list));
+    while (!iree_task_list_is_empty(&list)) {
+      iree_task_pool_release(&pool, iree_task_list_pop_front(&list));
+    }
+  }
+
+  iree_task_pool_deinitialize(&pool);
+}
+
+TEST(PoolTest, MagazineAcquireRelease) {
+  iree_task_pool_t pool;
+  IREE_ASSERT_OK(iree_task_pool_initialize(iree_allocator_system(),
+                                           sizeof(iree_test_task_t), 2, &pool));
+  iree_task_pool_magazine_t magazine;
+  iree_task_pool_magazine_initialize(&pool, &magazine);
+
+  // Acquire enough tasks to require multiple refills of the magazine.
+  iree_test_task_t* tasks[IREE_TASK_POOL_MAGAZINE_CAPACITY * 2];
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(tasks); ++i) {
+    IREE_ASSERT_OK(
+        iree_task_pool_magazine_acquire(&magazine, (iree_task_t**)&tasks[i]));
+    ASSERT_TRUE(tasks[i] != NULL);
+    EXPECT_EQ(&pool, tasks[i]->base.pool);
+    for (iree_host_size_t j = 0; j < i; ++j) EXPECT_NE(tasks[i], tasks[j]);
+  }
+
+  // Release half through the magazine (overflowing it to the pool) and half
+  // directly to the pool as if acquired and released on different threads.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(tasks); ++i) {
+    if (i % 2) {
+      iree_task_pool_magazine_release(&magazine, (iree_task_t*)tasks[i]);
+    } else {
+      iree_task_pool_release(&pool, (iree_task_t*)tasks[i]);
+    }
+  }
+  EXPECT_LT(magazine.count, IREE_TASK_POOL_MAGAZINE_CAPACITY);
+
+  // Flushing returns everything to the pool so trimming is safe.
+  iree_task_pool_magazine_deinitialize(&magazine);
+  iree_task_pool_trim(&pool);
+
+  iree_task_pool_deinitialize(&pool);
+}
+
 }  // namespace
@@ -50,6 +50,11 @@ static iree_host_size_t iree_task_post_batch_select_random_worker(
   return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
 }
 
+iree_task_affinity_set_t iree_task_post_batch_efficiency_worker_mask(
+    const iree_task_post_batch_t* post_batch) {
+  return post_batch->executor->worker_efficiency_mask;
+}
+
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
   if (post_batch->current_worker) {
@@ -51,6 +51,11 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
+// Returns a bitmask of workers running on efficiency cores in hybrid
+// topologies or 0 if all workers are of the same core class.
+iree_task_affinity_set_t iree_task_post_batch_efficiency_worker_mask(
+    const iree_task_post_batch_t* post_batch);
+
 // Selects a random worker from the given affinity set.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
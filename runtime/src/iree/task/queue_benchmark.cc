@@ -0,0 +1,174 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Compares the mutex-guarded iree_task_queue_t against the lock-free Chase-Lev
+// iree_task_deque_t for both the uncontended owner fast path and contended
+// work stealing.
+
+#include <cstddef>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/task/deque.h"
+#include "iree/task/list.h"
+#include "iree/task/queue.h"
+
+namespace {
+
+//==============================================================================
+// Queue adapters
+//==============================================================================
+
+template <typename QueueType>
+struct QueueTraits;
+
+template <>
+struct QueueTraits<iree_task_queue_t> {
+  static void Initialize(iree_task_queue_t* queue) {
+    iree_task_queue_initialize(queue);
+  }
+  static void Deinitialize(iree_task_queue_t* queue) {
+    iree_task_list_discard(&queue->list);
+    iree_task_queue_deinitialize(queue);
+  }
+  static bool Push(iree_task_queue_t* queue, iree_task_t* task) {
+    iree_task_queue_push_front(queue, task);
+    return true;
+  }
+  static iree_task_t* Pop(iree_task_queue_t* queue) {
+    return iree_task_queue_pop_front(queue);
+  }
+  static iree_task_t* Steal(iree_task_queue_t* source,
+                            iree_task_queue_t* target) {
+    return iree_task_queue_try_steal(source, target, /*max_tasks=*/64);
+  }
+};
+
+template <>
+struct QueueTraits<iree_task_deque_t> {
+  static void Initialize(iree_task_deque_t* deque) {
+    iree_task_deque_initialize(deque);
+  }
+  static void Deinitialize(iree_task_deque_t* deque) {
+    iree_task_deque_deinitialize(deque);
+  }
+  static bool Push(iree_task_deque_t* deque, iree_task_t* task) {
+    return iree_task_deque_push(deque, task);
+  }
+  static iree_task_t* Pop(iree_task_deque_t* deque) {
+    return iree_task_deque_pop(deque);
+  }
+  static iree_task_t* Steal(iree_task_deque_t* source,
+                            iree_task_deque_t* target) {
+    return iree_task_deque_try_steal_half(source, target, /*max_tasks=*/64);
+  }
+};
+
+//==============================================================================
+// Uncontended owner push/pop
+//==============================================================================
+
+template <typename QueueType>
+void BM_OwnerPushPop(benchmark::State& state) {
+  using Traits = QueueTraits<QueueType>;
+  const int batch_size = static_cast<int>(state.range(0));
+  std::vector<iree_task_t> tasks(batch_size);
+  auto* queue = new QueueType();
+  Traits::Initialize(queue);
+  for (auto _ : state) {
+    for (int i = 0; i < batch_size; ++i) {
+      Traits::Push(queue, &tasks[i]);
+    }
+    for (int i = 0; i < batch_size; ++i) {
+      benchmark::DoNotOptimize(Traits::Pop(queue));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+  Traits::Deinitialize(queue);
+  delete queue;
+}
+BENCHMARK_TEMPLATE(BM_OwnerPushPop, iree_task_queue_t)->Arg(1)->Arg(64);
+BENCHMARK_TEMPLATE(BM_OwnerPushPop, iree_task_deque_t)->Arg(1)->Arg(64);
+
+//==============================================================================
+// Contended stealing
+//==============================================================================
+
+// Thread 0 acts as the owner pushing and popping tasks while all other threads
+// continuously try to steal from it. Stolen tasks are returned to the owner
+// through an atomic slist so that task storage is never reused while another
+// thread still holds it.
+template <typename QueueType>
+struct ContendedState {
+  QueueType victim;
+  iree_atomic_task_slist_t free_slist;
+  std::vector<iree_task_t> tasks;
+};
+
+template <typename QueueType>
+void BM_ContendedSteal(benchmark::State& state) {
+  using Traits = QueueTraits<QueueType>;
+  static ContendedState<QueueType>* shared = nullptr;
+  if (state.thread_index() == 0) {
+    shared = new ContendedState<QueueType>();
+    Traits::Initialize(&shared->victim);
+    iree_atomic_task_slist_initialize(&shared->free_slist);
+    shared->tasks.resize(1024);
+    for (auto& task : shared->tasks) {
+      iree_atomic_task_slist_push(&shared->free_slist, &task);
+    }
+  }
+
+  QueueType* local = new QueueType();
+  Traits::Initialize(local);
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      // Owner: push two tasks and pop one, recycling what we get back.
+      for (int i = 0; i < 2; ++i) {
+        iree_task_t* task = iree_atomic_task_slist_pop(&shared->free_slist);
+        if (!task) task = Traits::Pop(&shared->victim);
+        if (task && !Traits::Push(&shared->victim, task)) {
+          iree_atomic_task_slist_push(&shared->free_slist, task);
+        }
+      }
+      if (iree_task_t* task = Traits::Pop(&shared->victim)) {
+        iree_atomic_task_slist_push(&shared->free_slist, task);
+      }
+    } else {
+      // Thief: steal a batch and drain it back to the owner.
+      iree_task_t* task = Traits::Steal(&shared->victim, local);
+      while (task) {
+        iree_atomic_task_slist_push(&shared->free_slist, task);
+        task = Traits::Pop(local);
+      }
+    }
+  }
+  Traits::Deinitialize(local);
+  delete local;
+
+  if (state.thread_index() == 0) {
+    // NOTE: all threads have exited the benchmark loop (it ends with a
+    // barrier) and no longer touch the shared state.
+    while (Traits::Pop(&shared->victim)) {
+    }
+    iree_task_t* free_head = NULL;
+    iree_atomic_task_slist_flush(&shared->free_slist,
+                                 IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+                                 &free_head, NULL);
+    iree_atomic_task_slist_deinitialize(&shared->free_slist);
+    Traits::Deinitialize(&shared->victim);
+    delete shared;
+    shared = nullptr;
+  }
+}
+BENCHMARK_TEMPLATE(BM_ContendedSteal, iree_task_queue_t)
+    ->UseRealTime()
+    ->ThreadRange(2, 32);
+BENCHMARK_TEMPLATE(BM_ContendedSteal, iree_task_deque_t)
+    ->UseRealTime()
+    ->ThreadRange(2, 32);
+
+}  // namespace
@@ -18,6 +18,12 @@ void iree_task_scope_initialize(iree_string_view_t name,
 
   memset(out_scope, 0, sizeof(*out_scope));
   iree_atomic_ref_count_init_value(&out_scope->pending_submissions, 0);
+  iree_atomic_store_int32(&out_scope->priority, IREE_TASK_PRIORITY_NORMAL,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_scope->deadline_ns, IREE_TIME_INFINITE_FUTURE,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int32(&out_scope->weight, IREE_TASK_SCOPE_DEFAULT_WEIGHT,
+                          iree_memory_order_relaxed);
 
   iree_host_size_t name_length =
       iree_min(name.size, IREE_ARRAYSIZE(out_scope->name) - 1);
@@ -63,6 +69,38 @@ iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope) {
   return iree_make_cstring_view(scope->name);
 }
 
+void iree_task_scope_set_priority(iree_task_scope_t* scope,
+                                  iree_task_priority_t priority) {
+  iree_atomic_store_int32(&scope->priority, priority,
+                          iree_memory_order_relaxed);
+}
+
+void iree_task_scope_set_deadline(iree_task_scope_t* scope,
+                                  iree_time_t deadline_ns) {
+  iree_atomic_store_int64(&scope->deadline_ns, deadline_ns,
+                          iree_memory_order_relaxed);
+}
+
+void iree_task_scope_set_weight(iree_task_scope_t* scope, uint32_t weight) {
+  iree_atomic_store_int32(&scope->weight,
+                          (int32_t)iree_min(iree_max(weight, 1u), INT32_MAX),
+                          iree_memory_order_relaxed);
+}
+
+uint32_t iree_task_scope_weight(iree_task_scope_t* scope) {
+  return (uint32_t)iree_atomic_load_int32(&scope->weight,
+                                          iree_memory_order_relaxed);
+}
+
+iree_task_priority_t iree_task_scope_effective_priority(
+    iree_task_scope_t* scope, iree_time_t now_ns) {
+  iree_time_t deadline_ns =
+      iree_atomic_load_int64(&scope->deadline_ns, iree_memory_order_relaxed);
+  if (now_ns >= deadline_ns) return IREE_TASK_PRIORITY_HIGH;
+  return (iree_task_priority_t)iree_atomic_load_int32(
+      &scope->priority, iree_memory_order_relaxed);
+}
+
 iree_task_dispatch_statistics_t iree_task_scope_consume_statistics(
     iree_task_scope_t* scope) {
   iree_task_dispatch_statistics_t result = scope->dispatch_statistics;
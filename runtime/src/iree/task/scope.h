@@ -20,6 +20,25 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Scheduling priority of tasks within a scope.
+// Ready tasks from higher priority scopes are scheduled on workers before any
+// from lower priority scopes within the same coordination pass.
+enum iree_task_priority_e {
+  // Batch work that should yield to everything else.
+  IREE_TASK_PRIORITY_LOW = 0u,
+  // Default priority of all scopes.
+  IREE_TASK_PRIORITY_NORMAL = 1u,
+  // Latency-critical work that should be executed before all other work.
+  IREE_TASK_PRIORITY_HIGH = 2u,
+};
+typedef uint8_t iree_task_priority_t;
+
+// Total number of iree_task_priority_t values.
+#define IREE_TASK_PRIORITY_COUNT 3
+
+// Default fair share weight of all scopes.
+#define IREE_TASK_SCOPE_DEFAULT_WEIGHT 1
+
 // iree_task_scope_t is an atomic reference-counting helper posting a
 // notification when the reference count is decremended to 0.
 //
@@ -49,13 +68,37 @@ typedef struct iree_task_scope_t {
   // Name used for logging and tracing.
   char name[16];
 
+  // Scheduling priority of tasks within the scope.
+  // Accessed with relaxed ordering as it is only a scheduling hint.
+  iree_atomic_int32_t priority;
+
+  // Optional deadline by which the work in the scope should complete or
+  // IREE_TIME_INFINITE_FUTURE if there is none. Once the deadline has been
+  // reached any ready tasks in the scope are scheduled as if they were
+  // IREE_TASK_PRIORITY_HIGH so that expired work is not starved.
+  // Accessed with relaxed ordering as it is only a scheduling hint.
+  iree_atomic_int64_t deadline_ns;
+
+  // Relative share of the executor given to ready tasks in the scope when
+  // competing with other scopes of the same priority. A scope with weight 2
+  // has twice as many of its tasks scheduled as a scope with weight 1 when
+  // both have work ready.
+  // Accessed with relaxed ordering as it is only a scheduling hint.
+  iree_atomic_int32_t weight;
+
+  // Virtual time of the scope used for weighted fair queueing; advanced by
+  // the cost of each task scheduled divided by the scope weight.
+  // Owned by the executor coordinator and only accessed with its lock held.
+  // Scopes must only ever be submitted to a single executor.
+  int64_t fair_virtual_time;
+
   // Base color used for tasks in this scope.
   // The color will be modulated based on task type.
   IREE_TRACE(uint32_t task_trace_color;)
 
   // A permanent status code set when a task within the scope fails. All pending
-  // tasks will be aborted, though any in-flight tasks may continue executing
-  // to completion.
+  // tasks will be aborted and in-flight dispatches stop at the next tile
+  // boundary, though any executing tiles or calls will run to completion.
   iree_atomic_intptr_t permanent_status;
 
   // Dispatch statistics aggregated from all dispatches in this scope. Updated
@@ -89,6 +132,30 @@ void iree_task_scope_deinitialize(iree_task_scope_t* scope);
 // string.
 iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope);
 
+// Sets the scheduling |priority| of all tasks within the scope.
+// Takes effect for any task scheduled after the call.
+void iree_task_scope_set_priority(iree_task_scope_t* scope,
+                                  iree_task_priority_t priority);
+
+// Sets a |deadline_ns| after which ready tasks within the scope will be
+// scheduled with IREE_TASK_PRIORITY_HIGH. Pass IREE_TIME_INFINITE_FUTURE to
+// clear the deadline.
+void iree_task_scope_set_deadline(iree_task_scope_t* scope,
+                                  iree_time_t deadline_ns);
+
+// Sets the fair share |weight| of the scope relative to other scopes of the
+// same priority. Weights of 0 are treated as 1.
+// Takes effect for any task scheduled after the call.
+void iree_task_scope_set_weight(iree_task_scope_t* scope, uint32_t weight);
+
+// Returns the fair share weight of the scope. Always >= 1.
+uint32_t iree_task_scope_weight(iree_task_scope_t* scope);
+
+// Returns the effective scheduling priority of tasks in the scope at |now_ns|.
+// |now_ns| may be IREE_TIME_INFINITE_PAST to ignore deadlines.
+iree_task_priority_t iree_task_scope_effective_priority(
+    iree_task_scope_t* scope, iree_time_t now_ns);
+
 // Returns and resets the statistics for the scope.
 // Statistics may experience tearing (non-atomic update across fields) if this
 // is performed while tasks are in-flight.
@@ -105,11 +172,12 @@ bool iree_task_scope_has_failed(iree_task_scope_t* scope);
 iree_status_t iree_task_scope_consume_status(iree_task_scope_t* scope);
 
 // Marks the scope as having been aborted by the user with IREE_STATUS_ABORTED.
-// All pending tasks will be dropped though in-flight tasks may complete
-// execution. Callers must use iree_task_scope_wait_idle to ensure the scope
-// state synchronizes prior to deinitializing. If the scope has already been
-// aborted or failed with a permanent error then the operation is ignored and
-// the previous error status is preserved.
+// All pending tasks will be dropped and in-flight dispatches will skip any
+// tiles that have not yet started executing. Tiles and calls that are already
+// executing will complete. Callers must use iree_task_scope_wait_idle to ensure
+// the scope state synchronizes prior to deinitializing. If the scope has
+// already been aborted or failed with a permanent error then the operation is
+// ignored and the previous error status is preserved.
 void iree_task_scope_abort(iree_task_scope_t* scope);
 
 // Marks the scope as having encountered an error while processing a task.
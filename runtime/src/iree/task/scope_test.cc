@@ -33,6 +33,48 @@ TEST(ScopeTest, LongNameTruncation) {
   iree_task_scope_deinitialize(&scope);
 }
 
+TEST(ScopeTest, PriorityDefault) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
+  EXPECT_EQ(IREE_TASK_PRIORITY_NORMAL,
+            iree_task_scope_effective_priority(&scope, iree_time_now()));
+  iree_task_scope_set_priority(&scope, IREE_TASK_PRIORITY_LOW);
+  EXPECT_EQ(IREE_TASK_PRIORITY_LOW,
+            iree_task_scope_effective_priority(&scope, iree_time_now()));
+  iree_task_scope_deinitialize(&scope);
+}
+
+// Scopes with an expired deadline are boosted to the highest priority.
+TEST(ScopeTest, PriorityDeadlineBoost) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
+  iree_task_scope_set_priority(&scope, IREE_TASK_PRIORITY_LOW);
+  iree_task_scope_set_deadline(&scope, 1000);
+  EXPECT_EQ(IREE_TASK_PRIORITY_LOW,
+            iree_task_scope_effective_priority(&scope, 999));
+  EXPECT_EQ(IREE_TASK_PRIORITY_HIGH,
+            iree_task_scope_effective_priority(&scope, 1000));
+  EXPECT_EQ(IREE_TASK_PRIORITY_LOW, iree_task_scope_effective_priority(
+                                        &scope, IREE_TIME_INFINITE_PAST));
+  iree_task_scope_set_deadline(&scope, IREE_TIME_INFINITE_FUTURE);
+  EXPECT_EQ(IREE_TASK_PRIORITY_LOW,
+            iree_task_scope_effective_priority(&scope, iree_time_now()));
+  iree_task_scope_deinitialize(&scope);
+}
+
+TEST(ScopeTest, Weight) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
+  EXPECT_EQ((uint32_t)IREE_TASK_SCOPE_DEFAULT_WEIGHT,
+            iree_task_scope_weight(&scope));
+  iree_task_scope_set_weight(&scope, 4);
+  EXPECT_EQ(4u, iree_task_scope_weight(&scope));
+  // Scopes always get some share of the executor.
+  iree_task_scope_set_weight(&scope, 0);
+  EXPECT_EQ(1u, iree_task_scope_weight(&scope));
+  iree_task_scope_deinitialize(&scope);
+}
+
 TEST(ScopeTest, AbortEmpty) {
   iree_task_scope_t scope;
   iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/tracing.h"
 #include "iree/task/list.h"
 #include "iree/task/pool.h"
@@ -531,6 +532,7 @@ static void iree_task_dispatch_initialize_base(
   memcpy(out_task->workgroup_size, workgroup_size,
          sizeof(out_task->workgroup_size));
   out_task->local_memory_size = 0;
+  out_task->tile_cost_ns = NULL;
   iree_atomic_store_intptr(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
 
@@ -560,8 +562,24 @@ void iree_task_dispatch_initialize_indirect(
   out_task->workgroup_count.ptr = workgroup_count_ptr;
 }
 
+uint32_t iree_task_dispatch_calculate_adaptive_tiles_per_reservation(
+    uint32_t tile_count, iree_host_size_t worker_count, int32_t tile_cost_ns) {
+  // Reserve enough tiles to fill the target duration given the cost of each.
+  uint32_t tiles_per_reservation =
+      (uint32_t)iree_max(1, IREE_TASK_DISPATCH_TARGET_RESERVATION_NS /
+                                iree_max(1, tile_cost_ns));
+  tiles_per_reservation =
+      iree_min(tiles_per_reservation,
+               IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION);
+  // Don't reserve so many tiles that some workers are left without any; we'd
+  // rather pay more reservation overhead than leave cores idle.
+  const uint32_t tiles_per_worker =
+      (uint32_t)iree_max(1, tile_count / iree_max(1, worker_count));
+  return iree_min(tiles_per_reservation, tiles_per_worker);
+}
+
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
-                              iree_task_pool_t* shard_task_pool,
+                              iree_task_pool_magazine_t* shard_task_magazine,
                               iree_task_submission_t* pending_submission,
                               iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -612,8 +630,18 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
   // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (dispatch_task->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
+  const int32_t tile_cost_ns =
+      dispatch_task->tile_cost_ns
+          ? iree_atomic_load_int32(dispatch_task->tile_cost_ns,
+                                   iree_memory_order_relaxed)
+          : 0;
+  if (IREE_TASK_DISPATCH_TARGET_RESERVATION_NS > 0 && tile_cost_ns > 0) {
+    dispatch_task->tiles_per_reservation =
+        iree_task_dispatch_calculate_adaptive_tiles_per_reservation(
+            dispatch_task->tile_count, worker_count, tile_cost_ns);
+  } else if (dispatch_task->tile_count <
+             worker_count *
+                 IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
     // Grid is small - allow it to be eagerly sliced up.
     dispatch_task->tiles_per_reservation = 1;
   } else {
@@ -621,20 +649,49 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
         IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
   }
 
-  // Randomize starting worker.
-  iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
-      post_batch, dispatch_task->header.affinity_set);
-  iree_host_size_t worker_index = worker_offset;
-
-  for (iree_host_size_t i = 0; i < shard_count; ++i) {
-    // Allocate and initialize the shard.
-    iree_task_dispatch_shard_t* shard_task =
-        iree_task_dispatch_shard_allocate(dispatch_task, shard_task_pool);
-
-    // Enqueue on the worker selected for the task.
-    iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
-                                 &shard_task->header);
-    ++worker_index;
+  // On hybrid topologies small dispatches are placed exclusively on the
+  // performance workers when there are enough of them to take all shards
+  // (efficiency workers may still steal them if otherwise idle). Larger
+  // dispatches use all workers and rely on the efficiency workers reserving
+  // fewer tiles at a time to avoid them becoming stragglers.
+  const iree_task_affinity_set_t efficiency_worker_mask =
+      iree_task_post_batch_efficiency_worker_mask(post_batch);
+  iree_task_affinity_set_t performance_worker_mask =
+      dispatch_task->header.affinity_set & ~efficiency_worker_mask;
+  if (worker_count < 8 * sizeof(iree_task_affinity_set_t)) {
+    performance_worker_mask &= (1ull << worker_count) - 1;
+  }
+  if (efficiency_worker_mask &&
+      shard_count <=
+          iree_task_affinity_set_count_ones(performance_worker_mask)) {
+    for (iree_host_size_t i = 0; i < shard_count; ++i) {
+      // Allocate and initialize the shard.
+      iree_task_dispatch_shard_t* shard_task =
+          iree_task_dispatch_shard_allocate(dispatch_task, shard_task_magazine);
+
+      // Enqueue on a performance worker that hasn't yet received a shard.
+      iree_host_size_t worker_index = iree_task_post_batch_select_worker(
+          post_batch, performance_worker_mask);
+      performance_worker_mask &= ~iree_task_affinity_for_worker(worker_index);
+      iree_task_post_batch_enqueue(post_batch, worker_index,
+                                   &shard_task->header);
+    }
+  } else {
+    // Randomize starting worker.
+    iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
+        post_batch, dispatch_task->header.affinity_set);
+    iree_host_size_t worker_index = worker_offset;
+
+    for (iree_host_size_t i = 0; i < shard_count; ++i) {
+      // Allocate and initialize the shard.
+      iree_task_dispatch_shard_t* shard_task =
+          iree_task_dispatch_shard_allocate(dispatch_task, shard_task_magazine);
+
+      // Enqueue on the worker selected for the task.
+      iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
+                                   &shard_task->header);
+      ++worker_index;
+    }
   }
 
   // NOTE: the dispatch is not retired until all shards complete. Upon the last
@@ -697,22 +754,79 @@ void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
 }
 
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
-    iree_task_dispatch_t* dispatch_task, iree_task_pool_t* shard_task_pool) {
+    iree_task_dispatch_t* dispatch_task,
+    iree_task_pool_magazine_t* shard_task_magazine) {
   iree_task_dispatch_shard_t* shard_task = NULL;
-  iree_status_t status =
-      iree_task_pool_acquire(shard_task_pool, (iree_task_t**)&shard_task);
+  iree_status_t status = iree_task_pool_magazine_acquire(
+      shard_task_magazine, (iree_task_t**)&shard_task);
   if (!iree_status_is_ok(status)) {
     iree_status_ignore(status);
     return NULL;
   }
   iree_task_dispatch_shard_initialize(dispatch_task, shard_task);
-  shard_task->header.pool = shard_task_pool;
+  shard_task->header.pool = shard_task_magazine->pool;
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+// Retires |task| and caches it in |shard_task_magazine|, if provided, instead
+// of returning it to the shared pool it was allocated from.
+static void iree_task_dispatch_shard_retire(
+    iree_task_dispatch_shard_t* task,
+    iree_task_pool_magazine_t* shard_task_magazine,
+    iree_task_submission_t* pending_submission) {
+  iree_task_pool_t* pool = task->header.pool;
+  if (!shard_task_magazine || shard_task_magazine->pool != pool) {
+    iree_task_retire(&task->header, pending_submission, iree_ok_status());
+    return;
+  }
+  // Detach the shard from the pool so retiring doesn't release it there.
+  // Shards have no cleanup function and the storage remains ours until it is
+  // released to the magazine.
+  task->header.pool = NULL;
+  iree_task_retire(&task->header, pending_submission, iree_ok_status());
+  task->header.pool = pool;
+  iree_task_pool_magazine_release(shard_task_magazine, &task->header);
+}
+
+// Folds a sample of |sample_tile_count| tiles taking |sample_duration_ns| into
+// the persistent tile cost of |dispatch_task| as an exponential moving average.
+// Races with other shards are benign: the value is only a hint.
+static void iree_task_dispatch_update_tile_cost(
+    iree_task_dispatch_t* dispatch_task, uint32_t sample_tile_count,
+    iree_duration_t sample_duration_ns) {
+  if (sample_tile_count == 0) return;
+  int64_t sample_ns =
+      iree_max(1, sample_duration_ns / (int64_t)sample_tile_count);
+  sample_ns = iree_min(sample_ns, INT32_MAX);
+  int32_t old_cost_ns = iree_atomic_load_int32(dispatch_task->tile_cost_ns,
+                                               iree_memory_order_relaxed);
+  int32_t new_cost_ns =
+      old_cost_ns ? old_cost_ns + (int32_t)((sample_ns - old_cost_ns) / 8)
+                  : (int32_t)sample_ns;
+  iree_atomic_store_int32(dispatch_task->tile_cost_ns,
+                          iree_max(1, new_cost_ns), iree_memory_order_relaxed);
+}
+
+// Returns true if the dispatch or its scope has failed (including being
+// aborted by the user) and any remaining tiles should be skipped. Checked
+// between every tile so that long-running dispatches stop burning cycles soon
+// after cancellation instead of running to completion. The failure itself is
+// reported when the dispatch retires.
+static inline bool iree_task_dispatch_should_abort(
+    iree_task_dispatch_t* dispatch_task) {
+  // relaxed order because we only need to eventually observe the failure; the
+  // status itself is consumed with proper ordering during retirement.
+  return iree_atomic_load_intptr(&dispatch_task->status,
+                                 iree_memory_order_relaxed) != 0 ||
+         iree_atomic_load_intptr(&dispatch_task->header.scope->permanent_status,
+                                 iree_memory_order_relaxed) != 0;
+}
+
+uint32_t iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
-    uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    uint32_t worker_id, iree_task_topology_core_class_t core_class,
+    iree_byte_span_t worker_local_memory,
+    iree_task_pool_magazine_t* shard_task_magazine,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -720,6 +834,8 @@ void iree_task_dispatch_shard_execute(
   IREE_TRACE_ZONE_APPEND_VALUE(z0, dispatch_task->dispatch_id);
   IREE_TRACE_ZONE_SET_COLOR(
       z0, iree_math_ptr_to_xrgb(dispatch_task->closure.user_context));
+  IREE_FLIGHT_RECORD_BEGIN(IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH,
+                           "dispatch_shard", (uintptr_t)dispatch_task);
 
   // Map only the requested amount of worker local memory into the tile context.
   // This ensures that how much memory is used by some executions does not
@@ -733,9 +849,12 @@ void iree_task_dispatch_shard_execute(
                          "%zub is available per-worker",
                          dispatch_task->local_memory_size,
                          worker_local_memory.data_length));
-    iree_task_retire(&task->header, pending_submission, iree_ok_status());
+    IREE_FLIGHT_RECORD_END(IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH,
+                           "dispatch_shard");
+    iree_task_dispatch_shard_retire(task, shard_task_magazine,
+                                    pending_submission);
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return 0;
   }
   iree_byte_span_t local_memory = iree_make_byte_span(
       worker_local_memory.data, dispatch_task->local_memory_size);
@@ -763,17 +882,33 @@ void iree_task_dispatch_shard_execute(
 
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
-  const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  if (core_class == IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY) {
+    tiles_per_reservation = iree_max(
+        1, tiles_per_reservation /
+               IREE_TASK_DISPATCH_EFFICIENCY_CORE_RESERVATION_DIVISOR);
+  }
+  uint32_t tiles_executed = 0;
   // relaxed order because we only care about atomic increments, not about
   // ordering of tile_index accesses w.r.t. other memory accesses.
   uint32_t tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
                                                    tiles_per_reservation,
                                                    iree_memory_order_relaxed);
+  // Only sample the first reservation of each shard; it's enough to track the
+  // cost over time and keeps the time queries off the hot path.
+  iree_time_t sample_start_ns =
+      dispatch_task->tile_cost_ns ? iree_time_now() : 0;
   while (tile_base < tile_count) {
     const uint32_t tile_range =
         iree_min(tile_base + tiles_per_reservation, tile_count);
     for (uint32_t tile_index = tile_base; tile_index < tile_range;
          ++tile_index) {
+      // Turn all remaining tiles into no-ops if the dispatch was cancelled.
+      // Other shards will observe the same and bail at their next tile.
+      if (IREE_UNLIKELY(iree_task_dispatch_should_abort(dispatch_task))) {
+        goto abort_shard;  // out of the while-for nest
+      }
+
       // TODO(benvanik): faster math here, especially knowing we pull off N
       // sequential indices per reservation.
       uint32_t tile_i = tile_index;
@@ -801,13 +936,13 @@ void iree_task_dispatch_shard_execute(
                                     &tile_context, pending_submission);
 
       IREE_TRACE_ZONE_END(z_tile);
+      ++tiles_executed;
 
       // If any tile fails we bail early from the loop. This doesn't match
       // what an accelerator would do but saves some unneeded work.
       // Note that other shards may have completed execution, be executing
-      // concurrently with this one, or still be pending - this does not
-      // have any influence on them and they may continue to execute even
-      // after we bail from here.
+      // concurrently with this one, or still be pending - they will observe
+      // the failure on the dispatch and bail before their next tile.
       if (!iree_status_is_ok(status)) {
         // Propagate failures to the dispatch task.
         iree_task_try_set_status(&dispatch_task->status, status);
@@ -815,6 +950,13 @@ void iree_task_dispatch_shard_execute(
       }
     }
 
+    if (sample_start_ns) {
+      iree_task_dispatch_update_tile_cost(
+          dispatch_task, tile_range - tile_base,
+          iree_time_now() - sample_start_ns);
+      sample_start_ns = 0;
+    }
+
     // Try to grab the next slice of tiles.
     tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
                                             tiles_per_reservation,
@@ -828,8 +970,13 @@ abort_shard:
   iree_task_dispatch_statistics_merge(&shard_statistics,
                                       &dispatch_task->statistics);
 
+  IREE_FLIGHT_RECORD_END(IREE_FLIGHT_RECORDER_CATEGORY_DISPATCH,
+                         "dispatch_shard");
+
   // NOTE: even if an error was hit we retire OK - the error has already been
   // propagated to the dispatch and it'll clean up after all shards are joined.
-  iree_task_retire(&task->header, pending_submission, iree_ok_status());
+  iree_task_dispatch_shard_retire(task, shard_task_magazine,
+                                  pending_submission);
   IREE_TRACE_ZONE_END(z0);
+  return tiles_executed;
 }
@@ -628,6 +628,14 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // dispatch closure.
   uint32_t local_memory_size;
 
+  // Optional persistent storage tracking the average execution time of a
+  // single tile in nanoseconds across executions of the same work (such as an
+  // executable export). When provided shards will sample tile execution times
+  // and update the value, and future issues of dispatches sharing the storage
+  // use it to size tile reservations. The storage must remain live until the
+  // dispatch has completed. A value of 0 indicates no samples are available.
+  iree_atomic_int32_t* tile_cost_ns;
+
   // Resulting status from the dispatch available once all workgroups have
   // completed (or would have completed). If multiple shards processing the
   // workgroups hit an error the first will be taken and the result ignored. A
@@ -643,7 +651,10 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
 
   // Maximum number of tiles to fetch per tile reservation from the grid.
   // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION and a
-  // reasonable number chosen based on the tile and shard counts.
+  // reasonable number chosen based on the tile and shard counts or, when
+  // tile_cost_ns is available, by
+  // IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION based on the
+  // measured cost of each tile.
   uint32_t tiles_per_reservation;
 
   // The tail tile index; the next reservation will start from here.
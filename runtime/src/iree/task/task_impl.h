@@ -12,6 +12,7 @@
 #include "iree/task/post_batch.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
+#include "iree/task/topology.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -80,15 +81,21 @@ void iree_task_wait_retire(iree_task_wait_t* task,
 // IREE_TASK_TYPE_DISPATCH
 //==============================================================================
 
+// Returns the number of tiles each shard should reserve at a time for a
+// dispatch of |tile_count| tiles across |worker_count| workers when each tile
+// is known to take approximately |tile_cost_ns| to execute.
+uint32_t iree_task_dispatch_calculate_adaptive_tiles_per_reservation(
+    uint32_t tile_count, iree_host_size_t worker_count, int32_t tile_cost_ns);
+
 // Schedules a dispatch by forking out to zero or more shards that will be
 // executed on workers. The shards are allocated from an executor-owned pool
 // and are generally not user-visible - they'll just see their dispatch begin
 // execution prior to the shards and end execution after the last shard
-// finishes.
+// finishes. |shard_task_magazine| caches shard tasks from the pool.
 //
 // Only called during coordination and expects the coordinator lock to be held.
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
-                              iree_task_pool_t* shard_task_pool,
+                              iree_task_pool_magazine_t* shard_task_magazine,
                               iree_task_submission_t* pending_submission,
                               iree_task_post_batch_t* post_batch);
 
@@ -102,10 +109,12 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
 // IREE_TASK_TYPE_DISPATCH_SHARD
 //==============================================================================
 
-// Allocates a dispatch shard task from the shared executor task pool.
-// The shard will be released back to the pool when it has completed execution.
+// Allocates a dispatch shard task from the shared executor task pool by way of
+// |shard_task_magazine|. The shard will be released back to the pool (or the
+// magazine of the worker executing it) when it has completed execution.
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
-    iree_task_dispatch_t* dispatch_task, iree_task_pool_t* shard_task_pool);
+    iree_task_dispatch_t* dispatch_task,
+    iree_task_pool_magazine_t* shard_task_magazine);
 
 // Executes and retires a dispatch shard task.
 // May block the caller for an indeterminate amount of time and should only be
@@ -115,16 +124,34 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 // executing on. It may be out of date or 0 if the processor could not be
 // queried.
 //
+// |core_class| is the class of core the executing worker is pinned to and is
+// used to reserve fewer tiles at a time on efficiency cores.
+//
 // |worker_local_memory| is a block of memory exclusively available to the shard
 // during execution. Contents are undefined both before and after execution.
 //
+// |shard_task_magazine| is an optional magazine owned by the executing worker
+// that the shard task is cached in upon retirement instead of being returned
+// directly to the shared pool it was allocated from.
+//
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+//
+// Returns the number of tiles executed by the shard.
+uint32_t iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
-    uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    uint32_t worker_id, iree_task_topology_core_class_t core_class,
+    iree_byte_span_t worker_local_memory,
+    iree_task_pool_magazine_t* shard_task_magazine,
     iree_task_submission_t* pending_submission);
 
+// Returns the bytes of worker local memory required to execute |task|.
+static inline iree_host_size_t iree_task_dispatch_shard_local_memory_size(
+    iree_task_dispatch_shard_t* task) {
+  return ((iree_task_dispatch_t*)task->header.completion_task)
+      ->local_memory_size;
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
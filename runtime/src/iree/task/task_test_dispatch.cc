@@ -12,6 +12,7 @@
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 #include "iree/task/testing/task_test.h"
+#include "iree/task/tuning.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -113,6 +114,88 @@ TEST_F(TaskDispatchTest, Issue345) {
   DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
 }
 
+TEST_F(TaskDispatchTest, TileCostTracking) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {64, 4, 1};
+  iree_atomic_int32_t tile_cost_ns = IREE_ATOMIC_VAR_INIT(0);
+
+  // Issue the dispatch a few times sharing the same cost storage; the first
+  // run uses the static heuristics and the following runs the measured cost.
+  for (int i = 0; i < 3; ++i) {
+    GridCoverage coverage(kWorkgroupCount);
+    iree_task_dispatch_t task;
+    iree_task_dispatch_initialize(
+        &scope_,
+        iree_task_make_dispatch_closure(GridCoverage::Tile, (void*)&coverage),
+        kWorkgroupSize, kWorkgroupCount, &task);
+    task.tile_cost_ns = &tile_cost_ns;
+    IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+    EXPECT_TRUE(coverage.Verify());
+    EXPECT_GT(iree_atomic_load_int32(&tile_cost_ns, iree_memory_order_relaxed),
+              0);
+  }
+}
+
+// Tests that workers grow their local memory when a dispatch requires more
+// than was reserved.
+TEST_F(TaskDispatchTest, LocalMemoryGrowsOnDemand) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {16, 1, 1};
+  const uint32_t kLocalMemorySize = 3 * 1024 * 1024;
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    IREE_TRACE_SCOPE();
+    if (tile_context->local_memory.data_length != kLocalMemorySize) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "unexpected local memory size");
+    }
+    // Touch both ends of the local memory.
+    tile_context->local_memory.data[0] = 1;
+    tile_context->local_memory.data[kLocalMemorySize - 1] = 1;
+    return iree_ok_status();
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, NULL),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  task.local_memory_size = kLocalMemorySize;
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor_, 0, NULL, &statistics);
+  EXPECT_GE(statistics.total.local_memory_grows, 1u);
+  EXPECT_GE(statistics.total.local_memory_size, kLocalMemorySize);
+}
+
+// Tests that dispatches requiring more local memory than workers may grow to
+// fail.
+TEST_F(TaskDispatchTest, LocalMemoryLimitExceeded) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {4, 1, 1};
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    return iree_ok_status();
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, NULL),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  task.local_memory_size = IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT + 1;
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope_)),
+              StatusIs(StatusCode::kResourceExhausted));
+}
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   IREE_TRACE_SCOPE();
 
@@ -214,4 +297,39 @@ TEST_F(TaskDispatchTest, IssueFailureChained) {
               StatusIs(StatusCode::kDataLoss));
 }
 
+TEST_F(TaskDispatchTest, AbortSkipsRemainingTiles) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {1024, 1, 1};
+
+  // The first tile to execute aborts the scope as if the user had cancelled
+  // the work; all shards should stop soon after without running every tile.
+  struct AbortState {
+    iree_task_scope_t* scope;
+    iree_atomic_int32_t tiles_executed;
+  } state = {&scope_, IREE_ATOMIC_VAR_INIT(0)};
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    AbortState* state = (AbortState*)user_context;
+    if (iree_atomic_fetch_add_int32(&state->tiles_executed, 1,
+                                    iree_memory_order_relaxed) == 0) {
+      iree_task_scope_abort(state->scope);
+    }
+    return iree_ok_status();
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, &state),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_LT(
+      iree_atomic_load_int32(&state.tiles_executed, iree_memory_order_relaxed),
+      (int32_t)kWorkgroupCount[0]);
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope_)),
+              StatusIs(StatusCode::kAborted));
+}
+
 }  // namespace
@@ -76,6 +76,43 @@ TEST_F(TaskWaitTest, IssueUnsignaled) {
   iree_event_deinitialize(&event);
 }
 
+// A process-local wait source that resolves once |flag| is set.
+// It cannot be exported and as such can only be resolved by queries.
+static iree_status_t LocalFlagWaitSourceCtl(iree_wait_source_t wait_source,
+                                            iree_wait_source_command_t command,
+                                            const void* params,
+                                            void** inout_ptr) {
+  auto* flag = reinterpret_cast<std::atomic<bool>*>(wait_source.self);
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY:
+      *reinterpret_cast<iree_status_code_t*>(inout_ptr) =
+          flag->load() ? IREE_STATUS_OK : IREE_STATUS_DEFERRED;
+      return iree_ok_status();
+    default:
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "local flag wait sources cannot be exported");
+  }
+}
+
+// Issues a wait task on a process-local wait source that has already resolved.
+// The first query resolves the wait and it must never need to be exported.
+TEST_F(TaskWaitTest, IssueLocalSignaled) {
+  IREE_TRACE_SCOPE();
+
+  std::atomic<bool> flag = {true};
+  iree_wait_source_t wait_source;
+  wait_source.self = &flag;
+  wait_source.data = 0;
+  wait_source.ctl = LocalFlagWaitSourceCtl;
+
+  iree_task_wait_t task;
+  iree_task_wait_initialize(&scope_, wait_source, IREE_TIME_INFINITE_FUTURE,
+                            &task);
+
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+}
+
 // Issues a wait task on a handle that will never be signaled.
 // We set the deadline in the near future and ensure that the poller correctly
 // fails the wait with a DEADLINE_EXCEEDED.
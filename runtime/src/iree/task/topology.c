@@ -65,6 +65,29 @@ const iree_task_topology_group_t* iree_task_topology_get_group(
   return &topology->groups[group_index];
 }
 
+iree_task_topology_group_mask_t iree_task_topology_calculate_node_sharing_mask(
+    const iree_task_topology_t* topology, iree_host_size_t group_index) {
+  if (group_index >= topology->group_count) return 0;
+  const iree_task_topology_node_id_t node_id =
+      topology->groups[group_index].node_id;
+  iree_task_topology_group_mask_t mask = 0;
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    if (i == group_index) continue;
+    if (topology->groups[i].node_id == node_id) mask |= 1ull << i;
+  }
+  return mask;
+}
+
+iree_task_topology_group_mask_t iree_task_topology_calculate_core_class_mask(
+    const iree_task_topology_t* topology,
+    iree_task_topology_core_class_t core_class) {
+  iree_task_topology_group_mask_t mask = 0;
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    if (topology->groups[i].core_class == core_class) mask |= 1ull << i;
+  }
+  return mask;
+}
+
 iree_status_t iree_task_topology_push_group(
     iree_task_topology_t* topology, const iree_task_topology_group_t* group) {
   if (topology->group_count + 1 > IREE_ARRAYSIZE(topology->groups)) {
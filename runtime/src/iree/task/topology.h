@@ -49,6 +49,16 @@ typedef uint64_t iree_task_topology_group_mask_t;
 #define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
   (sizeof(iree_task_topology_group_mask_t) * 8)
 
+// Class of the processor core a group is assigned to.
+// Hybrid architectures (such as Intel P-core/E-core or Arm big.LITTLE) mix
+// cores that have substantially different performance characteristics.
+typedef enum iree_task_topology_core_class_e {
+  // High-performance core or any core on systems with a single core class.
+  IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE = 0,
+  // Lower-performance power-efficient core (E-core/LITTLE).
+  IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY = 1,
+} iree_task_topology_core_class_t;
+
 // Information about a particular group within the topology.
 // Groups may be of varying levels of granularity even within the same topology
 // based on how the topology is defined.
@@ -63,6 +73,16 @@ typedef struct iree_task_topology_group_t {
   // Processor index in the cpuinfo set.
   uint32_t processor_index;
 
+  // NUMA node the processor of this group belongs to. Workers prefer to steal
+  // from other workers on the same node before crossing to remote nodes and
+  // memory they first touch will (on most platforms) be placed on this node.
+  iree_task_topology_node_id_t node_id;
+
+  // Class of the core the group is assigned to. Executors prefer placing
+  // dispatch work on performance cores and latency-insensitive bookkeeping
+  // (such as the wait poller) on efficiency cores.
+  iree_task_topology_core_class_t core_class;
+
   // Ideal thread affinity for threads within this group.
   // All threads within the group share the same affinity and this is what
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
@@ -134,6 +154,16 @@ iree_host_size_t iree_task_topology_group_count(
 const iree_task_topology_group_t* iree_task_topology_get_group(
     const iree_task_topology_t* topology, iree_host_size_t group_index);
 
+// Returns a bitmask of all other groups in |topology| that are assigned to the
+// same NUMA node as the group at |group_index|. The group itself is excluded.
+iree_task_topology_group_mask_t iree_task_topology_calculate_node_sharing_mask(
+    const iree_task_topology_t* topology, iree_host_size_t group_index);
+
+// Returns a bitmask of all groups in |topology| with the given |core_class|.
+iree_task_topology_group_mask_t iree_task_topology_calculate_core_class_mask(
+    const iree_task_topology_t* topology,
+    iree_task_topology_core_class_t core_class);
+
 // Pushes a new group onto the topology set.
 // The provided group data will be copied into the topology structure.
 iree_status_t iree_task_topology_push_group(
@@ -155,6 +185,9 @@ void iree_task_topology_initialize_from_group_count(
 // Initializes a topology with one group for each physical core with the given
 // NUMA node ID (usually package or cluster). Up to |max_core_count| physical
 // cores will be selected from the node.
+//
+// On hybrid architectures performance cores are selected before any efficiency
+// cores and placed first in the topology.
 void iree_task_topology_initialize_from_physical_cores(
     iree_task_topology_node_id_t node_id, iree_host_size_t max_core_count,
     iree_task_topology_t* out_topology);
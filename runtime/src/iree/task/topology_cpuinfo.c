@@ -162,11 +162,47 @@ static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
   return mask;
 }
 
+// Returns the core with the highest maximum frequency in the system or NULL if
+// frequencies are not reported on the platform.
+static const struct cpuinfo_core* iree_task_topology_find_fastest_core(void) {
+  const struct cpuinfo_core* fastest_core = NULL;
+  for (uint32_t i = 0; i < cpuinfo_get_cores_count(); ++i) {
+    const struct cpuinfo_core* core = cpuinfo_get_core(i);
+    if (!fastest_core || core->frequency > fastest_core->frequency) {
+      fastest_core = core;
+    }
+  }
+  return fastest_core && fastest_core->frequency ? fastest_core : NULL;
+}
+
+// Classifies |core| relative to the |fastest_core| in the system.
+//
+// cpuinfo doesn't report core classes directly so we infer them: cores of a
+// different microarchitecture than the fastest core that are also slower are
+// efficiency cores (Alder Lake Gracemont, Cortex-A55, etc). Cores sharing the
+// microarchitecture are only considered efficiency cores if they are
+// substantially slower so that the "favored" cores some parts boost higher
+// than their siblings don't cause the rest to be misclassified.
+static iree_task_topology_core_class_t iree_task_topology_classify_core(
+    const struct cpuinfo_core* core, const struct cpuinfo_core* fastest_core) {
+  if (!fastest_core || !core->frequency ||
+      core->frequency >= fastest_core->frequency) {
+    return IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE;
+  } else if (core->uarch != fastest_core->uarch) {
+    return IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY;
+  } else if (core->frequency * 5 < fastest_core->frequency * 4) {
+    return IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY;
+  }
+  return IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE;
+}
+
 // Populates |our_group| with the information from |core|.
 static void iree_task_topology_group_initialize_from_core(
     uint32_t group_index, const struct cpuinfo_core* core,
+    iree_task_topology_core_class_t core_class,
     iree_task_topology_group_t* out_group) {
   iree_task_topology_group_initialize(group_index, out_group);
+  out_group->core_class = core_class;
 
   // Guess: always pick the first processor in a core.
   // When pinning to threads we'll take into account whether the core is SMT
@@ -176,6 +212,7 @@ static void iree_task_topology_group_initialize_from_core(
 
   const struct cpuinfo_processor* processor =
       cpuinfo_get_processor(processor_i);
+  out_group->node_id = core->cluster->cluster_id;
   iree_task_topology_set_affinity_from_processor(
       processor, &out_group->ideal_thread_affinity);
 }
@@ -260,17 +297,34 @@ static void iree_task_topology_initialize_from_physical_cores_with_filter(
   // for now we just do a straight-line through (cores 0-N) when instead we may
   // want to take advantage of L3 cache info (half of groups on one L3 cache,
   // half of groups on another, etc).
+  //
+  // On hybrid systems we make one pass per core class so that performance
+  // cores are always selected first (if we are limited by |max_core_count|)
+  // and occupy the lowest group indices.
+  const struct cpuinfo_core* fastest_core =
+      iree_task_topology_find_fastest_core();
+  const iree_task_topology_core_class_t core_classes[] = {
+      IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE,
+      IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY,
+  };
   out_topology->group_count = core_count;
-  for (uint32_t core_i = 0, group_i = 0; group_i < out_topology->group_count;
-       ++core_i) {
-    // Rotate the core ID so that we avoid setting the affinity to the calling
-    // thread which we assume is something the user has plans for and doesn't
-    // want to have our workers stealing their time.
-    const struct cpuinfo_core* core =
-        cpuinfo_get_core(iree_task_topology_rotate_from_base_core(core_i));
-    if (filter_fn(core, filter_fn_data)) {
+  uint32_t group_i = 0;
+  for (iree_host_size_t class_i = 0; class_i < IREE_ARRAYSIZE(core_classes);
+       ++class_i) {
+    for (uint32_t core_i = 0; core_i < cpuinfo_get_cores_count() &&
+                              group_i < out_topology->group_count;
+         ++core_i) {
+      // Rotate the core ID so that we avoid setting the affinity to the calling
+      // thread which we assume is something the user has plans for and doesn't
+      // want to have our workers stealing their time.
+      const struct cpuinfo_core* core =
+          cpuinfo_get_core(iree_task_topology_rotate_from_base_core(core_i));
+      if (!filter_fn(core, filter_fn_data)) continue;
+      iree_task_topology_core_class_t core_class =
+          iree_task_topology_classify_core(core, fastest_core);
+      if (core_class != core_classes[class_i]) continue;
       iree_task_topology_group_initialize_from_core(
-          group_i, core, &out_topology->groups[group_i]);
+          group_i, core, core_class, &out_topology->groups[group_i]);
       ++group_i;
     }
   }
@@ -117,6 +117,58 @@ TEST(TopologyTest, FromGroupCount) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, NodeSharingMask) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // Groups 0-3 on node 0 and groups 4-7 on node 1.
+  for (iree_host_size_t i = 0; i < 8; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    EXPECT_EQ(0, group.node_id);
+    group.node_id = i < 4 ? 0 : 1;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  EXPECT_EQ(0b00001110u,
+            iree_task_topology_calculate_node_sharing_mask(&topology, 0));
+  EXPECT_EQ(0b00001011u,
+            iree_task_topology_calculate_node_sharing_mask(&topology, 2));
+  EXPECT_EQ(0b11100000u,
+            iree_task_topology_calculate_node_sharing_mask(&topology, 4));
+  EXPECT_EQ(0b01110000u,
+            iree_task_topology_calculate_node_sharing_mask(&topology, 7));
+
+  // Out of range groups have no sharing.
+  EXPECT_EQ(0u, iree_task_topology_calculate_node_sharing_mask(&topology, 8));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
+TEST(TopologyTest, CoreClassMask) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // Groups 0-1 on performance cores and groups 2-5 on efficiency cores.
+  for (iree_host_size_t i = 0; i < 6; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    EXPECT_EQ(IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE, group.core_class);
+    group.core_class = i < 2 ? IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE
+                             : IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  EXPECT_EQ(0b000011u,
+            iree_task_topology_calculate_core_class_mask(
+                &topology, IREE_TASK_TOPOLOGY_CORE_CLASS_PERFORMANCE));
+  EXPECT_EQ(0b111100u,
+            iree_task_topology_calculate_core_class_mask(
+                &topology, IREE_TASK_TOPOLOGY_CORE_CLASS_EFFICIENCY));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 // Verifies only that the |topology| is usable.
 // If we actually checked the contents here then we'd just be validating that
 // cpuinfo was working and the tests would become machine-dependent.
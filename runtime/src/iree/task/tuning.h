@@ -23,7 +23,9 @@ extern "C" {
 // at the cost of a higher minimum memory consumption.
 #define IREE_TASK_EXECUTOR_INITIAL_SHARD_RESERVATION_PER_WORKER (4)
 
-// Maximum number of events retained by the executor event pool.
+// Number of events preallocated by the executor event pool. The pool grows on
+// demand and retains all released events so this only avoids creating events
+// during warmup.
 #define IREE_TASK_EXECUTOR_EVENT_POOL_CAPACITY 64
 
 // Maximum number of simultaneous waits an executor may perform as part of a
@@ -53,6 +55,15 @@ extern "C" {
 // 1ms may result in 10-15ms.
 #define IREE_TASK_EXECUTOR_DELAY_SLOP_NS (1 /*ms*/ * 1000000)
 
+// Maximum amount of time the coordinator will spin re-querying wait tasks that
+// can be resolved without a syscall (process-local wait sources) before handing
+// them off to the poller thread. Waits that resolve within this window avoid
+// the thread hops through the poller. Waits on system wait handles are queried
+// once and delays are handed off immediately if not yet reached.
+// Setting this to 0 disables spinning but waits that have already resolved are
+// still retired without involving the poller.
+#define IREE_TASK_EXECUTOR_INLINE_WAIT_SPIN_NS (10 /*us*/ * 1000)
+
 // Allows for dividing the total number of attempts that a worker will make to
 // steal tasks from other workers. By default all other workers will be
 // attempted while setting this to 2, for example, will try for only half of
@@ -80,6 +91,13 @@ extern "C" {
 #define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
   IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
+// Maximum number of tasks cached in each iree_task_pool_magazine_t.
+// Tasks are exchanged with the shared pool in full magazines of half of this
+// many tasks: magazines that run dry acquire one and magazines that fill up
+// release one. Larger values reduce contention on the shared pool at the cost
+// of more tasks potentially sitting idle in per-worker caches. Must be even.
+#define IREE_TASK_POOL_MAGAZINE_CAPACITY (32)
+
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
 // maximum parallelism then this may be ignored.
@@ -94,6 +112,41 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Target duration in nanoseconds of each shard tile reservation when the cost
+// of tiles in a dispatch is known from prior executions. Cheap tiles will be
+// reserved in larger batches (up to
+// IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION) to amortize the
+// reservation overhead while expensive tiles will be reserved one at a time to
+// reduce tail imbalance.
+// Setting this to 0 disables adaptive reservation sizing.
+#define IREE_TASK_DISPATCH_TARGET_RESERVATION_NS (50 /*us*/ * 1000)
+
+// Maximum number of tiles that will be batched into a single reservation when
+// adaptive reservation sizing is used.
+#define IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION (64)
+
+// Divisor applied to the tiles reserved at a time by shards executing on
+// efficiency cores in hybrid topologies. Slower cores holding large
+// reservations near the end of a dispatch become stragglers that the faster
+// cores cannot steal from; smaller reservations let the performance cores
+// pick up the remaining tiles instead.
+#define IREE_TASK_DISPATCH_EFFICIENCY_CORE_RESERVATION_DIVISOR (4)
+
+// Maximum number of distinct scopes per priority level that are interleaved by
+// weighted fair queueing in a single coordination pass. Ready tasks from any
+// additional scopes are scheduled in FIFO order after the interleaved tasks.
+#define IREE_TASK_EXECUTOR_MAX_FAIR_SCOPES_PER_PASS (16)
+
+// Maximum cost charged to a scope for a single task when weighted fair
+// queueing. Dispatches cost one unit per workgroup up to this limit and all
+// other tasks cost one unit.
+#define IREE_TASK_EXECUTOR_MAX_FAIR_TASK_COST (1024)
+
+// Default maximum size in bytes each worker may grow its local memory to when
+// dispatches require more than the reserved worker_local_memory_size.
+// See iree_task_executor_options_t::worker_local_memory_limit.
+#define IREE_TASK_WORKER_DEFAULT_LOCAL_MEMORY_LIMIT (64 * 1024 * 1024)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "iree/base/internal/arena.h"
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
@@ -24,24 +25,37 @@ static int iree_task_worker_main(iree_task_worker_t* worker);
 
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
-    const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
+    const iree_task_topology_t* topology, iree_host_size_t stack_size,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  const iree_task_topology_group_t* topology_group =
+      iree_task_topology_get_group(topology, worker_index);
+
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
   out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  out_worker->node_sharing_mask =
+      iree_task_topology_calculate_node_sharing_mask(topology, worker_index);
+  out_worker->core_class = topology_group->core_class;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
   out_worker->local_memory = local_memory;
+  out_worker->local_memory_grown = false;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+  memset(&out_worker->counters, 0, sizeof(out_worker->counters));
+  iree_atomic_store_int64(&out_worker->counters.local_memory_size,
+                          (int64_t)local_memory.data_length,
+                          iree_memory_order_relaxed);
+  iree_task_pool_magazine_initialize(&executor->transient_task_pool,
+                                     &out_worker->shard_task_magazine);
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
@@ -133,11 +147,22 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
   iree_task_list_discard(&worker->local_task_queue.list);
 
+  // Return all cached shard tasks to the executor pool.
+  iree_task_pool_magazine_deinitialize(&worker->shard_task_magazine);
+
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
   iree_task_queue_deinitialize(&worker->local_task_queue);
 
+  if (worker->local_memory_grown) {
+    iree_arena_free_pages(IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES,
+                          worker->local_memory.data_length,
+                          worker->local_memory.data);
+    worker->local_memory = iree_make_byte_span(NULL, 0);
+    worker->local_memory_grown = false;
+  }
+
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -149,6 +174,38 @@ void iree_task_worker_post_tasks(iree_task_worker_t* worker,
   memset(list, 0, sizeof(*list));
 }
 
+// Adds |delta| to a worker statistics |counter|.
+// Only the worker thread updates its counters so we avoid the cost of an atomic
+// read-modify-write and just need the store to be untorn for readers.
+static inline void iree_task_worker_counter_add(iree_atomic_int64_t* counter,
+                                                int64_t delta) {
+  int64_t value = iree_atomic_load_int64(counter, iree_memory_order_relaxed);
+  iree_atomic_store_int64(counter, value + delta, iree_memory_order_relaxed);
+}
+
+void iree_task_worker_query_statistics(
+    iree_task_worker_t* worker, iree_task_worker_statistics_t* out_statistics) {
+  iree_task_worker_counters_t* counters = &worker->counters;
+  out_statistics->tasks_executed = (uint64_t)iree_atomic_load_int64(
+      &counters->tasks_executed, iree_memory_order_relaxed);
+  out_statistics->tiles_executed = (uint64_t)iree_atomic_load_int64(
+      &counters->tiles_executed, iree_memory_order_relaxed);
+  out_statistics->steals_succeeded = (uint64_t)iree_atomic_load_int64(
+      &counters->steals_succeeded, iree_memory_order_relaxed);
+  out_statistics->steals_failed = (uint64_t)iree_atomic_load_int64(
+      &counters->steals_failed, iree_memory_order_relaxed);
+  out_statistics->wakeups = (uint64_t)iree_atomic_load_int64(
+      &counters->wakeups, iree_memory_order_relaxed);
+  out_statistics->idle_time_ns = iree_atomic_load_int64(
+      &counters->idle_time_ns, iree_memory_order_relaxed);
+  out_statistics->busy_time_ns = iree_atomic_load_int64(
+      &counters->busy_time_ns, iree_memory_order_relaxed);
+  out_statistics->local_memory_size = (uint64_t)iree_atomic_load_int64(
+      &counters->local_memory_size, iree_memory_order_relaxed);
+  out_statistics->local_memory_grows = (uint64_t)iree_atomic_load_int64(
+      &counters->local_memory_grows, iree_memory_order_relaxed);
+}
+
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks) {
@@ -165,6 +222,51 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
   return NULL;
 }
 
+// Grows the local memory of |worker| to at least |minimum_size| bytes if
+// allowed by the executor limit. Must be called from the worker thread so that
+// the memory is first touched (and placed) on the NUMA node of the worker.
+// The previous contents are discarded. On failure the local memory is left
+// unchanged and dispatches requiring more will fail.
+static void iree_task_worker_grow_local_memory(iree_task_worker_t* worker,
+                                               iree_host_size_t minimum_size) {
+  const iree_host_size_t limit = worker->executor->worker_local_memory_limit;
+  if (minimum_size > limit) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)minimum_size);
+
+  // Grow geometrically to avoid repeatedly reallocating as dispatches with
+  // increasing requirements arrive. Sizes large enough to benefit from large
+  // pages are rounded up to them to keep the TLB footprint small.
+  iree_host_size_t new_size =
+      iree_max(minimum_size, worker->local_memory.data_length * 2);
+  if (new_size >= IREE_ARENA_LARGE_PAGE_SIZE / 2) {
+    new_size = iree_host_align(new_size, IREE_ARENA_LARGE_PAGE_SIZE);
+  } else {
+    new_size = iree_host_align(new_size,
+                               iree_hardware_destructive_interference_size);
+  }
+  new_size = iree_max(minimum_size, iree_min(new_size, limit));
+
+  void* new_base = NULL;
+  iree_status_t status = iree_arena_allocate_pages(
+      IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES, new_size, &new_base);
+  if (iree_status_is_ok(status)) {
+    if (worker->local_memory_grown) {
+      iree_arena_free_pages(IREE_ARENA_BLOCK_POOL_FLAG_LARGE_PAGES,
+                            worker->local_memory.data_length,
+                            worker->local_memory.data);
+    }
+    worker->local_memory = iree_make_byte_span(new_base, new_size);
+    worker->local_memory_grown = true;
+    iree_atomic_store_int64(&worker->counters.local_memory_size,
+                            (int64_t)new_size, iree_memory_order_relaxed);
+    iree_task_worker_counter_add(&worker->counters.local_memory_grows, 1);
+  }
+  iree_status_ignore(status);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 // Executes a task on a worker.
 // Only task types that are scheduled to workers are handled; all others must be
 // handled by the coordinator during scheduling.
@@ -185,9 +287,18 @@ static void iree_task_worker_execute(
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
+      iree_host_size_t local_memory_size =
+          iree_task_dispatch_shard_local_memory_size(
+              (iree_task_dispatch_shard_t*)task);
+      if (IREE_UNLIKELY(local_memory_size > worker->local_memory.data_length)) {
+        iree_task_worker_grow_local_memory(worker, local_memory_size);
+      }
+      uint32_t tiles_executed = iree_task_dispatch_shard_execute(
           (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+          worker->worker_index, worker->core_class, worker->local_memory,
+          &worker->shard_task_magazine, pending_submission);
+      iree_task_worker_counter_add(&worker->counters.tiles_executed,
+                                   tiles_executed);
       break;
     }
     default:
@@ -197,6 +308,8 @@ static void iree_task_worker_execute(
 
   // NOTE: task is invalidated above and must not be used!
   task = NULL;
+
+  iree_task_worker_counter_add(&worker->counters.tasks_executed, 1);
 }
 
 // Pumps the worker thread once, processing a single task.
@@ -233,8 +346,11 @@ static bool iree_task_worker_pump_once(
   if (!task) {
     task = iree_task_executor_try_steal_task(
         worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->node_sharing_mask, worker->max_theft_attempts,
+        &worker->theft_prng, &worker->local_task_queue);
+    iree_task_worker_counter_add(task ? &worker->counters.steals_succeeded
+                                      : &worker->counters.steals_failed,
+                                 1);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -266,6 +382,9 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   // be able to process it with the proper processor ID immediately.
   iree_task_worker_update_processor_id(worker);
 
+  // Start of the current busy period used to track busy vs idle time.
+  iree_time_t busy_start_ns = iree_time_now();
+
   // Pump the thread loop to process more tasks.
   while (true) {
     // If we fail to find any work to do we'll wait at the end of this loop.
@@ -285,6 +404,8 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
         IREE_TASK_WORKER_STATE_EXITING) {
       // Thread exit requested - cancel pumping.
       iree_notification_cancel_wait(&worker->wake_notification);
+      iree_task_worker_counter_add(&worker->counters.busy_time_ns,
+                                   iree_time_now() - busy_start_ns);
       // TODO(benvanik): complete tasks before exiting?
       break;
     }
@@ -333,12 +454,23 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     } else {
       // Spin/wait in the kernel. We don't care if the condition fails as we're
       // just using it as a pulse.
+      //
+      // Only some workers are allowed to spin based on how much work is
+      // expected to arrive; the rest park immediately in the kernel.
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      iree_time_t idle_start_ns = iree_time_now();
+      iree_task_worker_counter_add(&worker->counters.busy_time_ns,
+                                   idle_start_ns - busy_start_ns);
+      iree_duration_t spin_ns = iree_task_executor_begin_spin(worker->executor);
+      iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                    spin_ns,
+                                    /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      iree_task_executor_end_spin(worker->executor, spin_ns);
+      busy_start_ns = iree_time_now();
+      iree_task_worker_counter_add(&worker->counters.idle_time_ns,
+                                   busy_start_ns - idle_start_ns);
+      iree_task_worker_counter_add(&worker->counters.wakeups, 1);
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -364,6 +496,15 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Initialize the worker-local memory from the worker thread now that it is
+  // pinned. Most platforms use a first-touch policy for placing pages on NUMA
+  // nodes and by not touching this memory from the thread creating the
+  // executor we ensure the scratch memory used by each worker ends up on the
+  // node local to it.
+  if (worker->local_memory.data_length > 0) {
+    memset(worker->local_memory.data, 0, worker->local_memory.data_length);
+  }
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/prng.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/threading.h"
@@ -18,6 +19,7 @@
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor.h"
 #include "iree/task/list.h"
+#include "iree/task/pool.h"
 #include "iree/task/queue.h"
 #include "iree/task/task.h"
 #include "iree/task/topology.h"
@@ -48,6 +50,21 @@ typedef enum iree_task_worker_state_e {
   IREE_TASK_WORKER_STATE_ZOMBIE = 2,
 } iree_task_worker_state_t;
 
+// Statistics counters maintained by a worker.
+// Only ever written by the worker thread and read from other threads when
+// querying statistics; see iree_task_worker_statistics_t for details.
+typedef struct iree_task_worker_counters_t {
+  iree_atomic_int64_t tasks_executed;
+  iree_atomic_int64_t tiles_executed;
+  iree_atomic_int64_t steals_succeeded;
+  iree_atomic_int64_t steals_failed;
+  iree_atomic_int64_t wakeups;
+  iree_atomic_int64_t idle_time_ns;
+  iree_atomic_int64_t busy_time_ns;
+  iree_atomic_int64_t local_memory_size;
+  iree_atomic_int64_t local_memory_grows;
+} iree_task_worker_counters_t;
+
 // A worker within the executor pool.
 //
 // NOTE: fields in here are touched from multiple threads with lock-free
@@ -99,6 +116,14 @@ typedef struct iree_task_worker_t {
   // all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask of other workers assigned to the same NUMA node as this worker.
+  // Thefts are attempted from these workers before any on remote nodes so that
+  // the stolen work is more likely to touch memory local to the node.
+  iree_task_affinity_set_t node_sharing_mask;
+
+  // Class of the core the worker is pinned to.
+  iree_task_topology_core_class_t core_class;
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
@@ -121,6 +146,14 @@ typedef struct iree_task_worker_t {
   // An opaque tag used to reduce the cost of processor ID queries.
   iree_cpu_processor_tag_t processor_tag;
 
+  // Statistics counters updated by the worker thread as it runs.
+  iree_task_worker_counters_t counters;
+
+  // Cache of dispatch shard tasks retired by this worker. Batches the returns
+  // to the executor transient task pool so that workers retiring many small
+  // shards don't all contend on the shared pool.
+  iree_task_pool_magazine_t shard_task_magazine;
+
   // Destructive interference padding between the mailbox and local task queue
   // to ensure that the worker - who is pounding on local_task_queue - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
@@ -135,8 +168,12 @@ typedef struct iree_task_worker_t {
 
   // Pointer to local memory available for use exclusively by the worker.
   // The base address should be aligned to avoid false sharing with other
-  // workers.
+  // workers. Initially the reservation made by the executor and replaced with
+  // memory allocated by the worker when grown.
   iree_byte_span_t local_memory;
+  // True if local_memory was allocated by the worker when growing and must be
+  // freed with iree_arena_free_pages.
+  bool local_memory_grown;
 
   // Worker-local FIFO queue containing the tasks that will be processed by the
   // worker. This queue supports work-stealing by other workers if they run out
@@ -157,9 +194,11 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// The worker is configured from the group at |worker_index| in |topology|.
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
-    const iree_task_topology_group_t* topology_group,
+    const iree_task_topology_t* topology,
     iree_host_size_t stack_size, iree_byte_span_t local_memory,
     iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
 
@@ -184,6 +223,12 @@ void iree_task_worker_await_exit(iree_task_worker_t* worker);
 //  - deinitialize all workers
 void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 
+// Populates |out_statistics| with the current statistics of |worker|.
+//
+// May be called from any thread.
+void iree_task_worker_query_statistics(
+    iree_task_worker_t* worker, iree_task_worker_statistics_t* out_statistics);
+
 // Posts a FIFO list of tasks to the worker mailbox. The target worker takes
 // ownership of the tasks and will be woken if it is currently idle.
 //
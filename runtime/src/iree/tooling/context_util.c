@@ -18,6 +18,7 @@
 #include "iree/modules/hal/loader/module.h"
 #include "iree/modules/hal/module.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/startup_profile.h"
 #include "iree/vm/bytecode_module.h"
 
 #if defined(IREE_HAVE_VMVX_MODULE)
@@ -44,9 +45,10 @@ iree_status_t iree_tooling_load_module_from_flags(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_module);
 
-  // Fetch the file contents into memory.
-  // We could map the memory here if we wanted to and were coming from a file
-  // on disk.
+  // Fetch the file contents into memory. Files on disk are mapped so that the
+  // module rodata is paged in lazily and shared across processes.
+  iree_tooling_startup_profile_t* profile = iree_tooling_startup_profile();
+  iree_time_t read_start_time = iree_time_now();
   iree_file_contents_t* file_contents = NULL;
   if (strcmp(FLAG_module, "-") == 0) {
     // Reading from stdin. We print it out here because people often get
@@ -56,10 +58,13 @@ iree_status_t iree_tooling_load_module_from_flags(
         z0, iree_stdin_read_contents(host_allocator, &file_contents));
   } else {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0,
-        iree_file_read_contents(FLAG_module, host_allocator, &file_contents));
+        z0, iree_file_map_contents(FLAG_module, IREE_FILE_MAP_FLAG_NONE,
+                                   host_allocator, &file_contents));
   }
 
+  iree_time_t create_start_time = iree_time_now();
+  profile->module_read_duration = create_start_time - read_start_time;
+
   // Try to load the module as bytecode (all we have today that we can use).
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
@@ -67,6 +72,7 @@ iree_status_t iree_tooling_load_module_from_flags(
   iree_status_t status = iree_vm_bytecode_module_create(
       instance, file_contents->const_buffer,
       iree_file_contents_deallocator(file_contents), host_allocator, &module);
+  profile->module_create_duration = iree_time_now() - create_start_time;
 
   if (iree_status_is_ok(status)) {
     *out_module = module;
@@ -81,6 +87,9 @@ iree_status_t iree_tooling_load_module_from_flags(
 // HAL execution model management
 //===----------------------------------------------------------------------===//
 
+IREE_FLAG(bool, hal_lazy_executables, false,
+          "Defers loading HAL executables until they are first dispatched.");
+
 static iree_status_t iree_tooling_load_hal_async_module(
     iree_vm_instance_t* instance, iree_string_view_t default_device_uri,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module,
@@ -120,6 +129,9 @@ static iree_status_t iree_tooling_load_hal_async_module(
 
   // Create HAL module wrapping the device created above.
   iree_hal_module_flags_t flags = IREE_HAL_MODULE_FLAG_NONE;
+  if (FLAG_hal_lazy_executables) {
+    flags |= IREE_HAL_MODULE_FLAG_LAZY_EXECUTABLES;
+  }
   iree_vm_module_t* module = NULL;
   iree_status_t status =
       iree_hal_module_create(instance, device, flags, host_allocator, &module);
@@ -193,12 +205,21 @@ static iree_status_t iree_tooling_load_hal_inline_module(
   return status;
 }
 
+IREE_FLAG(int32_t, hal_loader_worker_count, 0,
+          "Number of threads in addition to the calling thread that execute "
+          "the workgroups of each dispatch made through the HAL loader "
+          "module. 0 executes all workgroups on the calling thread.");
+
 static iree_status_t iree_tooling_load_hal_loader_module(
     iree_vm_instance_t* instance, iree_allocator_t host_allocator,
     iree_vm_module_t** out_module) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
+  if (FLAG_hal_loader_worker_count < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--hal_loader_worker_count must be >= 0");
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Register required types before creating the module.
@@ -217,8 +238,12 @@ static iree_status_t iree_tooling_load_hal_loader_module(
   iree_vm_module_t* module = NULL;
   if (iree_status_is_ok(status)) {
     iree_hal_loader_module_flags_t flags = IREE_HAL_LOADER_MODULE_FLAG_NONE;
-    status = iree_hal_loader_module_create(instance, flags, loader_count,
-                                           loaders, host_allocator, &module);
+    iree_hal_loader_module_params_t params;
+    iree_hal_loader_module_params_initialize(&params);
+    params.worker_count = (iree_host_size_t)FLAG_hal_loader_worker_count;
+    status = iree_hal_loader_module_create_with_params(
+        instance, flags, &params, loader_count, loaders, host_allocator,
+        &module);
   }
 
   // Always release loaders; loader module has retained them.
@@ -454,6 +479,8 @@ iree_status_t iree_tooling_create_context_from_flags(
 
   // Resolve all module dependencies into an ordered list.
   // All modules are retained in the list.
+  iree_tooling_startup_profile_t* profile = iree_tooling_startup_profile();
+  iree_time_t resolve_start_time = iree_time_now();
   iree_tooling_module_list_t resolved_list;
   iree_tooling_module_list_initialize(&resolved_list);
   iree_hal_device_t* device = NULL;
@@ -472,10 +499,27 @@ iree_status_t iree_tooling_create_context_from_flags(
 
   // Create the context with the full list of resolved modules.
   // The context retains the modules and we can release them afterward.
+  iree_time_t context_start_time = iree_time_now();
+  profile->system_module_create_duration =
+      context_start_time - resolve_start_time;
   iree_vm_context_t* context = NULL;
   iree_status_t status = iree_vm_context_create_with_modules(
       instance, flags, resolved_list.count, resolved_list.values,
       host_allocator, &context);
+  profile->context_create_duration = iree_time_now() - context_start_time;
+
+  // Capture what the HAL module spent initializing the context.
+  if (iree_status_is_ok(status)) {
+    iree_vm_module_t* hal_module = NULL;
+    for (iree_host_size_t i = 0; i < resolved_list.count; ++i) {
+      if (iree_string_view_equal(iree_vm_module_name(resolved_list.values[i]),
+                                 IREE_SV("hal"))) {
+        hal_module = resolved_list.values[i];
+        break;
+      }
+    }
+    status = iree_tooling_startup_profile_record_context(context, hal_module);
+  }
   iree_tooling_module_list_reset(&resolved_list);
 
   // If no device allocator was created we'll create a default one just so that
@@ -6,11 +6,17 @@
 
 #include "iree/tooling/device_util.h"
 
+#include <inttypes.h>
+#include <stdio.h>
+
 #include "iree/base/internal/call_once.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/init.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/utils/budget_allocator.h"
 #include "iree/hal/utils/caching_allocator.h"
+#include "iree/hal/utils/recording_allocator.h"
 
 //===----------------------------------------------------------------------===//
 // Shared driver registry
@@ -491,6 +497,250 @@ static iree_status_t iree_hal_configure_caching_allocator(
       iree_hal_allocator_host_allocator(base_allocator), out_wrapped_allocator);
 }
 
+// Parses a |limits_str| of the form `soft_limit;hard_limit` into |out_limits|.
+// Either limit may be omitted or `*` to leave it unlimited.
+static iree_status_t iree_hal_parse_budget_limits(
+    iree_string_view_t limits_str,
+    iree_hal_budget_allocator_limits_t* out_limits) {
+  iree_string_view_t soft_limit_str = iree_string_view_empty();
+  iree_string_view_t hard_limit_str = iree_string_view_empty();
+  iree_string_view_split(limits_str, ';', &soft_limit_str, &hard_limit_str);
+  soft_limit_str = iree_string_view_trim(soft_limit_str);
+  if (!iree_string_view_is_empty(soft_limit_str) &&
+      !iree_string_view_equal(soft_limit_str, IREE_SV("*"))) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_parse_device_size(soft_limit_str, &out_limits->soft_limit),
+        "parsing soft_limit");
+  }
+  hard_limit_str = iree_string_view_trim(hard_limit_str);
+  if (!iree_string_view_is_empty(hard_limit_str) &&
+      !iree_string_view_equal(hard_limit_str, IREE_SV("*"))) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_parse_device_size(hard_limit_str, &out_limits->hard_limit),
+        "parsing hard_limit");
+  }
+  return iree_ok_status();
+}
+
+// Pressure callback trimming the allocator the device currently uses so that
+// any caching allocators wrapping the budget allocator release their memory.
+static iree_status_t iree_hal_trim_device_allocator(
+    void* user_data, iree_hal_allocator_t* allocator) {
+  iree_hal_device_t* device = (iree_hal_device_t*)user_data;
+  return iree_hal_allocator_trim(iree_hal_device_allocator(device));
+}
+
+// Configures a new budget allocator with the given key-value |config_pairs|.
+// Each pair specifies the soft and hard limits either of all allocations when
+// the key is `total` or of the heap selected by iree_hal_select_heap.
+// Allocations crossing a soft limit trim the device allocator and allocations
+// that would cross a hard limit fail with RESOURCE_EXHAUSTED. Place the budget
+// allocator before any caching allocator so that pooled memory is counted.
+//
+// Expected form:
+//   total=soft_limit;hard_limit
+//   heap_key=soft_limit;hard_limit
+// Example:
+//   --device_allocator=budget:total=3gib;4gib,host_local=*;1gib
+//   --device_allocator=caching
+static iree_status_t iree_hal_configure_budget_allocator(
+    iree_string_view_t config_pairs, iree_hal_device_t* device,
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_allocator_t** out_wrapped_allocator) {
+  iree_hal_budget_allocator_params_t params;
+  iree_hal_budget_allocator_params_initialize(&params);
+  params.pressure_callback.fn = iree_hal_trim_device_allocator;
+  params.pressure_callback.user_data = device;
+
+  // Query all heaps from the base allocator to match the user-provided heap
+  // keys against.
+  iree_host_size_t heap_count = 0;
+  iree_hal_allocator_memory_heap_t heaps[16];
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_query_memory_heaps(
+      base_allocator, IREE_ARRAYSIZE(heaps), heaps, &heap_count));
+
+  iree_hal_budget_allocator_heap_params_t heap_params_storage[16];
+  while (!iree_string_view_is_empty(config_pairs)) {
+    // Pop the key=value config pair from the list.
+    iree_string_view_t config_pair = iree_string_view_empty();
+    iree_string_view_split(config_pairs, ',', &config_pair, &config_pairs);
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t limits_str = iree_string_view_empty();
+    iree_string_view_split(config_pair, '=', &key, &limits_str);
+    key = iree_string_view_trim(key);
+    if (iree_string_view_is_empty(key)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "total or heap key must be specified in budgets");
+    }
+
+    if (iree_string_view_equal(key, IREE_SV("total"))) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_parse_budget_limits(limits_str, &params.total_limits));
+      continue;
+    }
+
+    if (params.heap_count + 1 > IREE_ARRAYSIZE(heap_params_storage)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "too many heap budgets specified");
+    }
+    const iree_hal_allocator_memory_heap_t* heap = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_select_heap(key, heap_count, heaps, &heap));
+    iree_hal_budget_allocator_heap_params_t* heap_params =
+        &heap_params_storage[params.heap_count++];
+    memset(heap_params, 0, sizeof(*heap_params));
+    heap_params->heap = *heap;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_parse_budget_limits(limits_str, &heap_params->limits));
+  }
+  params.heaps = heap_params_storage;
+
+  return iree_hal_budget_allocator_create(
+      &params, base_allocator,
+      iree_hal_allocator_host_allocator(base_allocator), out_wrapped_allocator);
+}
+
+// Recording allocator configured with --device_allocator=recording, if any.
+// Tools create a single device from flags so there is at most one. The
+// allocator is not retained and is cleared when it is destroyed.
+static struct {
+  iree_hal_allocator_t* allocator;
+  char report_path[1024];
+  char timeline_path[1024];
+} iree_hal_recording_allocator_state;
+
+// Formats the recorded allocations of |allocator| with |format_fn| and writes
+// them to the file at |path| or stdout if the path is `-`.
+static iree_status_t iree_hal_write_recording_file(
+    const char* path, iree_hal_allocator_t* allocator,
+    iree_status_t (*format_fn)(iree_hal_allocator_t*, iree_string_builder_t*)) {
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_hal_allocator_host_allocator(allocator),
+                                 &builder);
+  iree_status_t status = format_fn(allocator, &builder);
+  if (iree_status_is_ok(status)) {
+    const bool use_stdout = strcmp(path, "-") == 0;
+    FILE* file = use_stdout ? stdout : fopen(path, "wb");
+    if (!file) {
+      status = iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                                "failed to open allocation recording file '%s'",
+                                path);
+    } else {
+      fprintf(file, "%.*s", (int)iree_string_builder_size(&builder),
+              iree_string_builder_buffer(&builder));
+      if (use_stdout) {
+        fflush(file);
+      } else if (fclose(file) != 0) {
+        status = iree_make_status(
+            IREE_STATUS_DATA_LOSS,
+            "failed to write allocation recording file '%s'", path);
+      }
+    }
+  }
+  iree_string_builder_deinitialize(&builder);
+  return status;
+}
+
+// Writes the report and timeline once the device releases the recording
+// allocator and all allocations have been freed.
+static void iree_hal_write_recording_allocator_files(
+    void* user_data, iree_hal_allocator_t* allocator) {
+  iree_status_t status = iree_hal_write_recording_file(
+      iree_hal_recording_allocator_state.report_path, allocator,
+      iree_hal_recording_allocator_format_report);
+  if (iree_status_is_ok(status) &&
+      iree_hal_recording_allocator_state.timeline_path[0]) {
+    status = iree_hal_write_recording_file(
+        iree_hal_recording_allocator_state.timeline_path, allocator,
+        iree_hal_recording_allocator_format_timeline);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
+  }
+  iree_hal_recording_allocator_state.allocator = NULL;
+}
+
+// Copies |value| into the NUL-terminated |buffer| of |capacity| characters.
+static iree_status_t iree_hal_copy_recording_path(iree_string_view_t value,
+                                                  iree_host_size_t capacity,
+                                                  char* buffer) {
+  if (iree_string_view_is_empty(value) || value.size >= capacity) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid recording file path '%.*s'",
+                            (int)value.size, value.data);
+  }
+  memcpy(buffer, value.data, value.size);
+  buffer[value.size] = 0;
+  return iree_ok_status();
+}
+
+// Configures a new recording allocator with the given key-value
+// |config_pairs|. Every allocation and free made through the allocator is
+// recorded and when the device is released a report of the peak live bytes
+// attributed to the labels set with iree_hal_set_recording_allocation_label is
+// written to the `report` file (default stdout). The full timeline of events
+// is written as CSV to the `timeline` file if specified. Place the recording
+// allocator after any caching allocator to record what the program requests
+// and before it to record what the device provides.
+//
+// Expected form:
+//   report=path
+//   timeline=path
+// Example:
+//   --device_allocator=caching
+//   --device_allocator=recording:report=peak.txt,timeline=timeline.csv
+static iree_status_t iree_hal_configure_recording_allocator(
+    iree_string_view_t config_pairs, iree_hal_device_t* device,
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_allocator_t** out_wrapped_allocator) {
+  if (iree_hal_recording_allocator_state.allocator) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "only one recording allocator may be configured");
+  }
+  strcpy(iree_hal_recording_allocator_state.report_path, "-");
+  iree_hal_recording_allocator_state.timeline_path[0] = 0;
+  while (!iree_string_view_is_empty(config_pairs)) {
+    iree_string_view_t config_pair = iree_string_view_empty();
+    iree_string_view_split(config_pairs, ',', &config_pair, &config_pairs);
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t value = iree_string_view_empty();
+    iree_string_view_split(config_pair, '=', &key, &value);
+    key = iree_string_view_trim(key);
+    value = iree_string_view_trim(value);
+    if (iree_string_view_equal(key, IREE_SV("report"))) {
+      IREE_RETURN_IF_ERROR(iree_hal_copy_recording_path(
+          value, sizeof(iree_hal_recording_allocator_state.report_path),
+          iree_hal_recording_allocator_state.report_path));
+    } else if (iree_string_view_equal(key, IREE_SV("timeline"))) {
+      IREE_RETURN_IF_ERROR(iree_hal_copy_recording_path(
+          value, sizeof(iree_hal_recording_allocator_state.timeline_path),
+          iree_hal_recording_allocator_state.timeline_path));
+    } else {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unrecognized recording parameter '%.*s'",
+                              (int)key.size, key.data);
+    }
+  }
+
+  iree_hal_recording_allocator_params_t params;
+  iree_hal_recording_allocator_params_initialize(&params);
+  params.initial_label = IREE_SV("load");
+  params.complete_callback.fn = iree_hal_write_recording_allocator_files;
+  IREE_RETURN_IF_ERROR(iree_hal_recording_allocator_create(
+      &params, base_allocator,
+      iree_hal_allocator_host_allocator(base_allocator),
+      out_wrapped_allocator));
+  iree_hal_recording_allocator_state.allocator = *out_wrapped_allocator;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_set_recording_allocation_label(
+    iree_string_view_t label) {
+  if (!iree_hal_recording_allocator_state.allocator) return iree_ok_status();
+  return iree_hal_recording_allocator_set_label(
+      iree_hal_recording_allocator_state.allocator, label);
+}
+
 // Parses a single flag and wraps |base_allocator|.
 // Flag values are specifications and may include configuration values.
 // Examples:
@@ -508,6 +758,12 @@ static iree_status_t iree_hal_configure_allocator_from_spec(
   if (iree_string_view_equal(allocator_name, IREE_SV("caching"))) {
     status = iree_hal_configure_caching_allocator(
         config_pairs, device, base_allocator, out_wrapped_allocator);
+  } else if (iree_string_view_equal(allocator_name, IREE_SV("budget"))) {
+    status = iree_hal_configure_budget_allocator(
+        config_pairs, device, base_allocator, out_wrapped_allocator);
+  } else if (iree_string_view_equal(allocator_name, IREE_SV("recording"))) {
+    status = iree_hal_configure_recording_allocator(
+        config_pairs, device, base_allocator, out_wrapped_allocator);
   } else {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "unrecognized allocator '%.*s'",
@@ -667,3 +923,127 @@ iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device) {
   if (strlen(FLAG_device_profiling_mode) == 0) return iree_ok_status();
   return iree_hal_device_profiling_end(device);
 }
+
+//===----------------------------------------------------------------------===//
+// Task executor statistics
+//===----------------------------------------------------------------------===//
+
+// Queries a task.statistics |key| from |device|, returning 0 if not reported.
+static int64_t iree_hal_device_query_task_statistic(iree_hal_device_t* device,
+                                                    const char* key) {
+  int64_t value = 0;
+  iree_status_t status = iree_hal_device_query_i64(
+      device, IREE_SV("task.statistics"), iree_make_cstring_view(key), &value);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return 0;
+  }
+  return value;
+}
+
+iree_status_t iree_hal_device_task_statistics_fprint(
+    FILE* file, iree_hal_device_t* device) {
+  if (!device) return iree_ok_status();
+  int64_t worker_count = 0;
+  iree_status_t status =
+      iree_hal_device_query_i64(device, IREE_SV("task.statistics"),
+                                IREE_SV("worker_count"), &worker_count);
+  if (!iree_status_is_ok(status)) {
+    // Not a task-based device; nothing to report.
+    iree_status_ignore(status);
+    return iree_ok_status();
+  }
+
+  static const char* const kCounterNames[] = {
+      "tasks_executed",    "tiles_executed",     "steals_succeeded",
+      "steals_failed",     "wakeups",            "idle_time_ns",
+      "busy_time_ns",      "local_memory_size",  "local_memory_grows",
+  };
+
+  fprintf(file, "[[ iree_task_executor_t statistics ]]\n");
+  fprintf(file, "POLLER WAITS: %" PRIi64 "\n",
+          iree_hal_device_query_task_statistic(device, "poller_waits"));
+  fprintf(file, "%-8s", "WORKER");
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(kCounterNames); ++i) {
+    fprintf(file, " %16s", kCounterNames[i]);
+  }
+  fprintf(file, "\n");
+  char key[64];
+  for (int64_t worker = 0; worker < worker_count; ++worker) {
+    fprintf(file, "%-8" PRIi64, worker);
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(kCounterNames); ++i) {
+      snprintf(key, sizeof(key), "worker.%" PRIi64 ".%s", worker,
+               kCounterNames[i]);
+      fprintf(file, " %16" PRIi64,
+              iree_hal_device_query_task_statistic(device, key));
+    }
+    fprintf(file, "\n");
+  }
+  fprintf(file, "%-8s", "TOTAL");
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(kCounterNames); ++i) {
+    fprintf(file, " %16" PRIi64,
+            iree_hal_device_query_task_statistic(device, kCounterNames[i]));
+  }
+  fprintf(file, "\n");
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Local executable counters
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(bool, hal_executable_counters, false,
+          "Collects hardware performance counters per executable export on "
+          "local CPU devices (Linux only). Adds two syscalls per workgroup and "
+          "should only be used when profiling.");
+
+iree_status_t iree_hal_begin_executable_counters_from_flags(void) {
+  if (!FLAG_hal_executable_counters) return iree_ok_status();
+  return iree_hal_local_executable_counters_set_enabled(true);
+}
+
+static void iree_hal_executable_counters_fprint_export(
+    void* user_data, iree_hal_local_executable_t* executable,
+    iree_host_size_t ordinal, iree_string_view_t export_name,
+    const iree_hal_local_executable_export_counters_t* counters) {
+  FILE* file = (FILE*)user_data;
+  if (counters->call_count == 0) return;  // never dispatched
+  if (iree_string_view_is_empty(export_name)) {
+    fprintf(file, "%p:%-23" PRIhsz, (void*)executable, ordinal);
+  } else {
+    fprintf(file, "%-40.*s", (int)export_name.size, export_name.data);
+  }
+  fprintf(file, " %12" PRIu64, counters->call_count);
+  for (iree_host_size_t i = 0; i < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT;
+       ++i) {
+    fprintf(file, " %16" PRIu64, counters->values[i]);
+  }
+  // Derived metrics to spot memory bound exports at a glance.
+  uint64_t cycles = counters->values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CYCLES];
+  uint64_t instructions =
+      counters->values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_INSTRUCTIONS];
+  uint64_t cache_misses =
+      counters->values[IREE_HAL_LOCAL_EXECUTABLE_COUNTER_CACHE_MISSES];
+  fprintf(file, " %8.2f %12.2f\n",
+          cycles ? (double)instructions / (double)cycles : 0.0,
+          instructions ? 1000.0 * (double)cache_misses / (double)instructions
+                       : 0.0);
+}
+
+iree_status_t iree_hal_executable_counters_fprint(FILE* file) {
+  if (!iree_hal_local_executable_counters_is_enabled()) {
+    return iree_ok_status();
+  }
+  fprintf(file, "[[ iree_hal_local_executable_t counters ]]\n");
+  fprintf(file, "%-40s %12s", "EXPORT", "calls");
+  for (iree_host_size_t i = 0; i < IREE_HAL_LOCAL_EXECUTABLE_COUNTER_COUNT;
+       ++i) {
+    fprintf(file, " %16s",
+            iree_hal_local_executable_counter_name(
+                (iree_hal_local_executable_counter_t)i));
+  }
+  fprintf(file, " %8s %12s\n", "ipc", "misses/kinst");
+  iree_hal_local_executable_counters_enumerate(
+      iree_hal_executable_counters_fprint_export, file);
+  return iree_ok_status();
+}
@@ -7,6 +7,8 @@
 #ifndef IREE_TOOLING_DEVICE_UTIL_H_
 #define IREE_TOOLING_DEVICE_UTIL_H_
 
+#include <stdio.h>
+
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 
@@ -42,6 +44,25 @@ iree_status_t iree_hal_begin_profiling_from_flags(iree_hal_device_t* device);
 // command line flags. No-op if profiling is not enabled.
 iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device);
 
+// Sets the |label| attributed to subsequent device allocations in the report
+// written when recording is enabled with --device_allocator=recording.
+// No-op if no recording allocator was configured.
+iree_status_t iree_hal_set_recording_allocation_label(iree_string_view_t label);
+
+// Prints the task executor statistics reported by |device| (if any) to |file|.
+// Devices that are not backed by a task executor are ignored.
+iree_status_t iree_hal_device_task_statistics_fprint(FILE* file,
+                                                     iree_hal_device_t* device);
+
+// Enables per-export hardware counter collection on local CPU devices if
+// requested by the --hal_executable_counters flag. Must be called before
+// executables are loaded.
+iree_status_t iree_hal_begin_executable_counters_from_flags(void);
+
+// Prints the per-export hardware counters of all live local executables to
+// |file|. No-op if counter collection is not enabled.
+iree_status_t iree_hal_executable_counters_fprint(FILE* file);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
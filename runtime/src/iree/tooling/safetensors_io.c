@@ -0,0 +1,721 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/safetensors_io.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// Header parsing
+//===----------------------------------------------------------------------===//
+
+// File format spec:
+// https://github.com/huggingface/safetensors#format
+//
+// 8b: little-endian uint64 length of the header
+// [header length]b utf8 JSON object, optionally padded with spaces:
+//   {
+//     "__metadata__": {"key": "value", ...},
+//     "name": {"dtype": "F32", "shape": [2, 3], "data_offsets": [0, 24]},
+//     ...
+//   }
+// [remaining]b tensor data with offsets relative to the end of the header
+//
+// Only as much JSON as the header requires is handled here: strings are not
+// unescaped and numbers other than non-negative integers are only skipped.
+
+static void iree_safetensors_skip_whitespace(iree_string_view_t* json) {
+  iree_host_size_t i = 0;
+  while (i < json->size && (json->data[i] == ' ' || json->data[i] == '\t' ||
+                            json->data[i] == '\n' || json->data[i] == '\r')) {
+    ++i;
+  }
+  *json = iree_string_view_remove_prefix(*json, i);
+}
+
+// Consumes |c| if it is the next non-whitespace character in |json|.
+static bool iree_safetensors_consume_char(iree_string_view_t* json, char c) {
+  iree_safetensors_skip_whitespace(json);
+  if (json->size == 0 || json->data[0] != c) return false;
+  *json = iree_string_view_remove_prefix(*json, 1);
+  return true;
+}
+
+static iree_status_t iree_safetensors_expect_char(iree_string_view_t* json,
+                                                  char c) {
+  if (!iree_safetensors_consume_char(json, c)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "malformed safetensors header; expected '%c'", c);
+  }
+  return iree_ok_status();
+}
+
+// Consumes a JSON string and returns its contents without the quotes.
+static iree_status_t iree_safetensors_consume_string(
+    iree_string_view_t* json, iree_string_view_t* out_value) {
+  IREE_RETURN_IF_ERROR(iree_safetensors_expect_char(json, '"'));
+  iree_host_size_t i = 0;
+  while (i < json->size && json->data[i] != '"') {
+    i += json->data[i] == '\\' ? 2 : 1;
+  }
+  if (i >= json->size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "malformed safetensors header; unterminated "
+                            "string");
+  }
+  *out_value = iree_make_string_view(json->data, i);
+  *json = iree_string_view_remove_prefix(*json, i + 1);
+  return iree_ok_status();
+}
+
+// Consumes a non-negative JSON integer.
+static iree_status_t iree_safetensors_consume_uint64(iree_string_view_t* json,
+                                                     uint64_t* out_value) {
+  iree_safetensors_skip_whitespace(json);
+  uint64_t value = 0;
+  iree_host_size_t i = 0;
+  for (; i < json->size && json->data[i] >= '0' && json->data[i] <= '9'; ++i) {
+    uint64_t digit = (uint64_t)(json->data[i] - '0');
+    if (value > (UINT64_MAX - digit) / 10) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "safetensors header integer overflows");
+    }
+    value = value * 10 + digit;
+  }
+  if (i == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "malformed safetensors header; expected a "
+                            "non-negative integer");
+  }
+  *out_value = value;
+  *json = iree_string_view_remove_prefix(*json, i);
+  return iree_ok_status();
+}
+
+// Consumes a JSON array of up to |capacity| non-negative integers.
+static iree_status_t iree_safetensors_consume_uint64_array(
+    iree_string_view_t* json, iree_host_size_t capacity,
+    iree_host_size_t* out_count, uint64_t* out_values) {
+  *out_count = 0;
+  IREE_RETURN_IF_ERROR(iree_safetensors_expect_char(json, '['));
+  if (iree_safetensors_consume_char(json, ']')) return iree_ok_status();
+  do {
+    if (*out_count >= capacity) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "safetensors header array has more than %" PRIhsz
+                              " elements",
+                              capacity);
+    }
+    IREE_RETURN_IF_ERROR(
+        iree_safetensors_consume_uint64(json, &out_values[(*out_count)++]));
+  } while (iree_safetensors_consume_char(json, ','));
+  return iree_safetensors_expect_char(json, ']');
+}
+
+// Skips over a JSON value of any type.
+static iree_status_t iree_safetensors_skip_value(iree_string_view_t* json) {
+  iree_safetensors_skip_whitespace(json);
+  if (json->size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "malformed safetensors header; expected a value");
+  }
+  char c = json->data[0];
+  if (c == '"') {
+    iree_string_view_t value = iree_string_view_empty();
+    return iree_safetensors_consume_string(json, &value);
+  } else if (c == '{' || c == '[') {
+    iree_host_size_t depth = 0;
+    for (iree_host_size_t i = 0; i < json->size; ++i) {
+      c = json->data[i];
+      if (c == '"') {
+        // Skip strings so that brackets within them are not counted.
+        for (++i; i < json->size && json->data[i] != '"'; ++i) {
+          if (json->data[i] == '\\') ++i;
+        }
+      } else if (c == '{' || c == '[') {
+        ++depth;
+      } else if (c == '}' || c == ']') {
+        if (--depth == 0) {
+          *json = iree_string_view_remove_prefix(*json, i + 1);
+          return iree_ok_status();
+        }
+      }
+    }
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "malformed safetensors header; unterminated "
+                            "object or array");
+  }
+  // Numbers, true, false, and null run until the next delimiter.
+  iree_host_size_t i = 0;
+  while (i < json->size && json->data[i] != ',' && json->data[i] != '}' &&
+         json->data[i] != ']' && json->data[i] != ' ' &&
+         json->data[i] != '\n') {
+    ++i;
+  }
+  *json = iree_string_view_remove_prefix(*json, i);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_safetensors_parse_dtype(
+    iree_string_view_t dtype, iree_hal_element_type_t* out_element_type) {
+  static const struct {
+    const char* name;
+    iree_hal_element_type_t element_type;
+  } kDtypes[] = {
+      {"BOOL", IREE_HAL_ELEMENT_TYPE_BOOL_8},
+      {"U8", IREE_HAL_ELEMENT_TYPE_UINT_8},
+      {"I8", IREE_HAL_ELEMENT_TYPE_SINT_8},
+      {"U16", IREE_HAL_ELEMENT_TYPE_UINT_16},
+      {"I16", IREE_HAL_ELEMENT_TYPE_SINT_16},
+      {"F16", IREE_HAL_ELEMENT_TYPE_FLOAT_16},
+      {"BF16", IREE_HAL_ELEMENT_TYPE_BFLOAT_16},
+      {"U32", IREE_HAL_ELEMENT_TYPE_UINT_32},
+      {"I32", IREE_HAL_ELEMENT_TYPE_SINT_32},
+      {"F32", IREE_HAL_ELEMENT_TYPE_FLOAT_32},
+      {"U64", IREE_HAL_ELEMENT_TYPE_UINT_64},
+      {"I64", IREE_HAL_ELEMENT_TYPE_SINT_64},
+      {"F64", IREE_HAL_ELEMENT_TYPE_FLOAT_64},
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(kDtypes); ++i) {
+    if (iree_string_view_equal(dtype,
+                               iree_make_cstring_view(kDtypes[i].name))) {
+      *out_element_type = kDtypes[i].element_type;
+      return iree_ok_status();
+    }
+  }
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "unsupported safetensors dtype '%.*s'",
+                          (int)dtype.size, dtype.data);
+}
+
+// Parses the `{"dtype": ..., "shape": ..., "data_offsets": ...}` object of
+// a tensor with contents in |data|.
+static iree_status_t iree_safetensors_parse_tensor(
+    iree_string_view_t* json, iree_const_byte_span_t data,
+    iree_safetensors_tensor_t* tensor) {
+  bool has_dtype = false;
+  bool has_shape = false;
+  iree_host_size_t offset_count = 0;
+  uint64_t offsets[2] = {0, 0};
+  IREE_RETURN_IF_ERROR(iree_safetensors_expect_char(json, '{'));
+  if (!iree_safetensors_consume_char(json, '}')) {
+    do {
+      iree_string_view_t key = iree_string_view_empty();
+      IREE_RETURN_IF_ERROR(iree_safetensors_consume_string(json, &key));
+      IREE_RETURN_IF_ERROR(iree_safetensors_expect_char(json, ':'));
+      if (iree_string_view_equal(key, IREE_SV("dtype"))) {
+        iree_string_view_t dtype = iree_string_view_empty();
+        IREE_RETURN_IF_ERROR(iree_safetensors_consume_string(json, &dtype));
+        IREE_RETURN_IF_ERROR(
+            iree_safetensors_parse_dtype(dtype, &tensor->element_type));
+        has_dtype = true;
+      } else if (iree_string_view_equal(key, IREE_SV("shape"))) {
+        uint64_t shape[IREE_SAFETENSORS_MAX_RANK];
+        IREE_RETURN_IF_ERROR(iree_safetensors_consume_uint64_array(
+            json, IREE_ARRAYSIZE(shape), &tensor->shape_rank, shape));
+        for (iree_host_size_t i = 0; i < tensor->shape_rank; ++i) {
+          tensor->shape[i] = (iree_hal_dim_t)shape[i];
+        }
+        has_shape = true;
+      } else if (iree_string_view_equal(key, IREE_SV("data_offsets"))) {
+        IREE_RETURN_IF_ERROR(iree_safetensors_consume_uint64_array(
+            json, IREE_ARRAYSIZE(offsets), &offset_count, offsets));
+      } else {
+        IREE_RETURN_IF_ERROR(iree_safetensors_skip_value(json));
+      }
+    } while (iree_safetensors_consume_char(json, ','));
+    IREE_RETURN_IF_ERROR(iree_safetensors_expect_char(json, '}'));
+  }
+  if (!has_dtype || !has_shape || offset_count != 2) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "safetensors tensor '%.*s' is missing dtype, "
+                            "shape, or data_offsets",
+                            (int)tensor->name.size, tensor->name.data);
+  }
+
+  // Verify the contents are within the data section and match the shape.
+  if (offsets[0] > offsets[1] || offsets[1] > data.data_length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "safetensors tensor '%.*s' data offsets [%" PRIu64
+                            ", %" PRIu64 ") out of range of %" PRIhsz
+                            " data bytes",
+                            (int)tensor->name.size, tensor->name.data,
+                            offsets[0], offsets[1], data.data_length);
+  }
+  uint64_t expected_length =
+      iree_hal_element_dense_byte_count(tensor->element_type);
+  for (iree_host_size_t i = 0; i < tensor->shape_rank; ++i) {
+    expected_length *= tensor->shape[i];
+  }
+  if (offsets[1] - offsets[0] != expected_length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "safetensors tensor '%.*s' has %" PRIu64
+                            " bytes of data but its shape requires %" PRIu64,
+                            (int)tensor->name.size, tensor->name.data,
+                            offsets[1] - offsets[0], expected_length);
+  }
+  tensor->contents = iree_make_const_byte_span(
+      data.data + offsets[0], (iree_host_size_t)(offsets[1] - offsets[0]));
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_safetensors_enumerate_tensors(
+    iree_const_byte_span_t contents,
+    iree_safetensors_tensor_callback_fn_t callback, void* user_data) {
+  IREE_ASSERT_ARGUMENT(callback);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  uint64_t header_length = 0;
+  if (contents.data_length < sizeof(header_length)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "safetensors file too small for a header");
+  }
+  for (iree_host_size_t i = 0; i < sizeof(header_length); ++i) {
+    header_length |= (uint64_t)contents.data[i] << (i * 8);
+  }
+  if (header_length > contents.data_length - sizeof(header_length)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "safetensors header length %" PRIu64
+                            " exceeds the file size",
+                            header_length);
+  }
+  iree_string_view_t json = iree_make_string_view(
+      (const char*)contents.data + sizeof(header_length),
+      (iree_host_size_t)header_length);
+  iree_host_size_t data_offset =
+      sizeof(header_length) + (iree_host_size_t)header_length;
+  iree_const_byte_span_t data = iree_make_const_byte_span(
+      contents.data + data_offset, contents.data_length - data_offset);
+
+  iree_status_t status = iree_safetensors_expect_char(&json, '{');
+  if (iree_status_is_ok(status) && !iree_safetensors_consume_char(&json, '}')) {
+    do {
+      iree_safetensors_tensor_t tensor;
+      memset(&tensor, 0, sizeof(tensor));
+      status = iree_safetensors_consume_string(&json, &tensor.name);
+      if (iree_status_is_ok(status)) {
+        status = iree_safetensors_expect_char(&json, ':');
+      }
+      if (!iree_status_is_ok(status)) break;
+      if (iree_string_view_equal(tensor.name, IREE_SV("__metadata__"))) {
+        status = iree_safetensors_skip_value(&json);
+      } else {
+        status = iree_safetensors_parse_tensor(&json, data, &tensor);
+        if (iree_status_is_ok(status)) {
+          status = callback(user_data, &tensor);
+        }
+      }
+      if (!iree_status_is_ok(status)) break;
+    } while (iree_safetensors_consume_char(&json, ','));
+    if (iree_status_is_ok(status)) {
+      status = iree_safetensors_expect_char(&json, '}');
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Loading
+//===----------------------------------------------------------------------===//
+
+// Reference-counted file mapping shared by all buffers imported from it.
+typedef struct iree_safetensors_mapping_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_file_contents_t* contents;
+} iree_safetensors_mapping_t;
+
+static void iree_safetensors_mapping_release(
+    iree_safetensors_mapping_t* mapping) {
+  if (iree_atomic_ref_count_dec(&mapping->ref_count) == 1) {
+    iree_file_contents_free(mapping->contents);
+    iree_allocator_free(mapping->host_allocator, mapping);
+  }
+}
+
+static void iree_safetensors_mapping_buffer_release(void* user_data,
+                                                    iree_hal_buffer_t* buffer) {
+  iree_safetensors_mapping_release((iree_safetensors_mapping_t*)user_data);
+}
+
+// Maps the file at |path| into host memory with a single reference.
+static iree_status_t iree_safetensors_mapping_create(
+    const char* path, iree_allocator_t host_allocator,
+    iree_safetensors_mapping_t** out_mapping) {
+  *out_mapping = NULL;
+  iree_safetensors_mapping_t* mapping = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, sizeof(*mapping),
+                                             (void**)&mapping));
+  iree_atomic_ref_count_init(&mapping->ref_count);
+  mapping->host_allocator = host_allocator;
+  mapping->contents = NULL;
+  iree_status_t status =
+      iree_file_map_contents(path, IREE_FILE_MAP_FLAG_PREFETCH, host_allocator,
+                             &mapping->contents);
+  if (iree_status_is_ok(status)) {
+    *out_mapping = mapping;
+  } else {
+    iree_allocator_free(host_allocator, mapping);
+  }
+  return status;
+}
+
+typedef struct iree_safetensors_load_state_t {
+  iree_safetensors_mapping_t* mapping;
+  iree_hal_buffer_params_t buffer_params;
+  iree_hal_allocator_t* device_allocator;
+  iree_allocator_t host_allocator;
+  iree_safetensors_buffer_view_callback_fn_t callback;
+  void* user_data;
+} iree_safetensors_load_state_t;
+
+// Imports the |tensor| contents from |mapping| without copying.
+static iree_status_t iree_safetensors_import_buffer(
+    iree_safetensors_mapping_t* mapping, iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_params_t params, const iree_safetensors_tensor_t* tensor,
+    iree_hal_buffer_t** out_buffer) {
+  // Not all devices can use unaligned host memory; copy those instead.
+  iree_host_size_t element_size =
+      iree_hal_element_dense_byte_count(tensor->element_type);
+  if (tensor->contents.data_length == 0 ||
+      (element_size > 0 &&
+       ((uintptr_t)tensor->contents.data % element_size) != 0)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "tensor contents cannot be imported");
+  }
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = tensor->contents.data_length,
+      .handle.host_allocation.ptr = (void*)tensor->contents.data,
+  };
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_safetensors_mapping_buffer_release,
+      .user_data = mapping,
+  };
+  // The mapping is read-only so imported buffers must be as well.
+  params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      device_allocator, params, &external_buffer, release_callback, out_buffer);
+  if (iree_status_is_ok(status)) {
+    // Released by the buffer via the release callback.
+    iree_atomic_ref_count_inc(&mapping->ref_count);
+  }
+  return status;
+}
+
+static iree_status_t iree_safetensors_load_tensor(
+    void* user_data, const iree_safetensors_tensor_t* tensor) {
+  iree_safetensors_load_state_t* state =
+      (iree_safetensors_load_state_t*)user_data;
+
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status =
+      iree_safetensors_import_buffer(state->mapping, state->device_allocator,
+                                     state->buffer_params, tensor, &buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_view_create(
+        buffer, tensor->shape_rank, tensor->shape, tensor->element_type,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, state->host_allocator,
+        &buffer_view);
+    iree_hal_buffer_release(buffer);
+  } else {
+    // Fall back to allocating device memory and copying from the mapping.
+    iree_status_ignore(status);
+    status = iree_hal_buffer_view_allocate_buffer(
+        state->device_allocator, tensor->shape_rank, tensor->shape,
+        tensor->element_type, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+        state->buffer_params, tensor->contents, &buffer_view);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = state->callback(state->user_data, tensor->name, buffer_view);
+  }
+  iree_hal_buffer_view_release(buffer_view);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_safetensors_load_file(
+    const char* path, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_safetensors_buffer_view_callback_fn_t callback, void* user_data) {
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(callback);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_safetensors_mapping_t* mapping = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_safetensors_mapping_create(path, host_allocator, &mapping));
+
+  iree_safetensors_load_state_t state = {
+      .mapping = mapping,
+      .buffer_params = buffer_params,
+      .device_allocator = device_allocator,
+      .host_allocator = host_allocator,
+      .callback = callback,
+      .user_data = user_data,
+  };
+  iree_status_t status = iree_safetensors_enumerate_tensors(
+      mapping->contents->const_buffer, iree_safetensors_load_tensor, &state);
+  if (!iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(status, "loading safetensors file '%s'",
+                                    path);
+  }
+
+  // Imported buffers keep the mapping alive until they are released.
+  iree_safetensors_mapping_release(mapping);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Streaming upload
+//===----------------------------------------------------------------------===//
+
+// Maximum number of transfers submitted in a single command buffer.
+#define IREE_SAFETENSORS_UPLOAD_BATCH_CAPACITY 64
+
+typedef struct iree_safetensors_upload_state_t {
+  iree_safetensors_load_state_t load;
+  iree_hal_device_t* device;
+  iree_host_size_t name_count;
+  const iree_string_view_t* names;
+  iree_device_size_t batch_size;
+  // Timeline of the submitted batches; each waits on the value signaled by
+  // the previous one.
+  iree_hal_semaphore_t* semaphore;
+  uint64_t semaphore_value;
+  // Transfers pending submission. The staging buffers are retained until
+  // submitted and then by the command buffer until the copies complete.
+  iree_host_size_t transfer_count;
+  iree_device_size_t transfer_bytes;
+  iree_hal_transfer_command_t transfers[IREE_SAFETENSORS_UPLOAD_BATCH_CAPACITY];
+  iree_hal_buffer_t* staging_buffers[IREE_SAFETENSORS_UPLOAD_BATCH_CAPACITY];
+} iree_safetensors_upload_state_t;
+
+static bool iree_safetensors_upload_is_selected(
+    const iree_safetensors_upload_state_t* state, iree_string_view_t name) {
+  if (!state->name_count) return true;
+  for (iree_host_size_t i = 0; i < state->name_count; ++i) {
+    if (iree_string_view_equal(state->names[i], name)) return true;
+  }
+  return false;
+}
+
+// Submits the pending transfers to the device queue without waiting.
+static iree_status_t iree_safetensors_upload_flush(
+    iree_safetensors_upload_state_t* state) {
+  if (!state->transfer_count) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, state->transfer_bytes);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  iree_status_t status = iree_hal_create_transfer_command_buffer(
+      state->device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_QUEUE_AFFINITY_ANY, state->transfer_count, state->transfers,
+      &command_buffer);
+  if (iree_status_is_ok(status)) {
+    uint64_t wait_value = state->semaphore_value;
+    uint64_t signal_value = state->semaphore_value + 1;
+    iree_hal_semaphore_list_t wait_semaphores = {
+        .count = 1,
+        .semaphores = &state->semaphore,
+        .payload_values = &wait_value,
+    };
+    iree_hal_semaphore_list_t signal_semaphores = {
+        .count = 1,
+        .semaphores = &state->semaphore,
+        .payload_values = &signal_value,
+    };
+    status = iree_hal_device_queue_execute(
+        state->device, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphores,
+        signal_semaphores, 1, &command_buffer, /*binding_tables=*/NULL);
+  }
+  if (iree_status_is_ok(status)) ++state->semaphore_value;
+  iree_hal_command_buffer_release(command_buffer);
+
+  for (iree_host_size_t i = 0; i < state->transfer_count; ++i) {
+    iree_hal_buffer_release(state->staging_buffers[i]);
+  }
+  state->transfer_count = 0;
+  state->transfer_bytes = 0;
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Allocates a buffer for |tensor| and enqueues the copy of its contents from
+// the mapping. The contents are copied synchronously if the mapping cannot be
+// used as a transfer source.
+static iree_status_t iree_safetensors_upload_buffer(
+    iree_safetensors_upload_state_t* state,
+    const iree_safetensors_tensor_t* tensor, iree_hal_buffer_t** out_buffer) {
+  iree_hal_buffer_params_t staging_params = {
+      .type =
+          IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER_SOURCE,
+  };
+  iree_hal_buffer_t* staging_buffer = NULL;
+  iree_status_t status = iree_safetensors_import_buffer(
+      state->load.mapping, state->load.device_allocator, staging_params,
+      tensor, &staging_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return iree_hal_allocator_allocate_buffer(
+        state->load.device_allocator, state->load.buffer_params,
+        tensor->contents.data_length, tensor->contents, out_buffer);
+  }
+
+  iree_hal_buffer_params_t params = state->load.buffer_params;
+  params.usage |= IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET;
+  iree_hal_buffer_t* buffer = NULL;
+  status = iree_hal_allocator_allocate_buffer(
+      state->load.device_allocator, params, tensor->contents.data_length,
+      iree_const_byte_span_empty(), &buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_buffer_release(staging_buffer);
+    return status;
+  }
+
+  iree_hal_transfer_command_t* transfer =
+      &state->transfers[state->transfer_count];
+  memset(transfer, 0, sizeof(*transfer));
+  transfer->type = IREE_HAL_TRANSFER_COMMAND_TYPE_COPY;
+  transfer->copy.source_buffer = staging_buffer;
+  transfer->copy.source_offset = 0;
+  transfer->copy.target_buffer = buffer;
+  transfer->copy.target_offset = 0;
+  transfer->copy.length = tensor->contents.data_length;
+  state->staging_buffers[state->transfer_count] = staging_buffer;
+  ++state->transfer_count;
+  state->transfer_bytes += tensor->contents.data_length;
+
+  if (state->transfer_count == IREE_SAFETENSORS_UPLOAD_BATCH_CAPACITY ||
+      state->transfer_bytes >= state->batch_size) {
+    status = iree_safetensors_upload_flush(state);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
+}
+
+static iree_status_t iree_safetensors_upload_tensor(
+    void* user_data, const iree_safetensors_tensor_t* tensor) {
+  iree_safetensors_upload_state_t* state =
+      (iree_safetensors_upload_state_t*)user_data;
+  if (!iree_safetensors_upload_is_selected(state, tensor->name)) {
+    return iree_ok_status();
+  }
+
+  // Devices that can use host memory directly import the mapping as with
+  // iree_safetensors_load_file and need no transfers.
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_safetensors_import_buffer(
+      state->load.mapping, state->load.device_allocator,
+      state->load.buffer_params, tensor, &buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    status = iree_safetensors_upload_buffer(state, tensor, &buffer);
+  }
+
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_view_create(
+        buffer, tensor->shape_rank, tensor->shape, tensor->element_type,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, state->load.host_allocator,
+        &buffer_view);
+  }
+  iree_hal_buffer_release(buffer);
+  if (iree_status_is_ok(status)) {
+    status = state->load.callback(state->load.user_data, tensor->name,
+                                  buffer_view);
+  }
+  iree_hal_buffer_view_release(buffer_view);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_safetensors_upload_file(
+    const char* path, iree_host_size_t name_count,
+    const iree_string_view_t* names, iree_hal_buffer_params_t buffer_params,
+    iree_device_size_t batch_size, iree_hal_device_t* device,
+    iree_allocator_t host_allocator,
+    iree_safetensors_buffer_view_callback_fn_t callback, void* user_data,
+    iree_hal_fence_t** out_ready_fence) {
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(!name_count || names);
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(callback);
+  IREE_ASSERT_ARGUMENT(out_ready_fence);
+  *out_ready_fence = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_safetensors_upload_state_t* state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, sizeof(*state), (void**)&state));
+  memset(state, 0, sizeof(*state));
+  state->load.buffer_params = buffer_params;
+  state->load.device_allocator = iree_hal_device_allocator(device);
+  state->load.host_allocator = host_allocator;
+  state->load.callback = callback;
+  state->load.user_data = user_data;
+  state->device = device;
+  state->name_count = name_count;
+  state->names = names;
+  state->batch_size = batch_size;
+
+  iree_status_t status = iree_safetensors_mapping_create(path, host_allocator,
+                                                         &state->load.mapping);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_create(device, 0ull, &state->semaphore);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_safetensors_enumerate_tensors(
+        state->load.mapping->contents->const_buffer,
+        iree_safetensors_upload_tensor, state);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_safetensors_upload_flush(state);
+  } else {
+    // Drop the transfers that were never submitted.
+    for (iree_host_size_t i = 0; i < state->transfer_count; ++i) {
+      iree_hal_buffer_release(state->staging_buffers[i]);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_create_at(state->semaphore, state->semaphore_value,
+                                      host_allocator, out_ready_fence);
+  } else if (state->semaphore) {
+    // Don't return while submitted transfers may still be writing to buffers
+    // the caller will release.
+    iree_status_ignore(iree_hal_semaphore_wait(
+        state->semaphore, state->semaphore_value, iree_infinite_timeout()));
+    status = iree_status_annotate_f(status, "uploading safetensors file '%s'",
+                                    path);
+  }
+
+  iree_hal_semaphore_release(state->semaphore);
+  // Imported buffers keep the mapping alive until they are released.
+  if (state->load.mapping) {
+    iree_safetensors_mapping_release(state->load.mapping);
+  }
+  iree_allocator_free(host_allocator, state);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
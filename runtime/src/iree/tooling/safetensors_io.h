@@ -0,0 +1,109 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===----------------------------------------------------------------------===//
+// safetensors IO
+//===----------------------------------------------------------------------===//
+//
+// Loads tensors from files in the safetensors format:
+// https://github.com/huggingface/safetensors
+//
+// Unlike .npy files the tensor metadata is stored up front in a single header
+// and the tensor contents are stored uncompressed in a single data section.
+// This allows the file to be mapped into host memory and each tensor to be
+// imported into the HAL without reading or copying the contents when the
+// device allocator can use host memory directly. On devices with discrete
+// memory the contents are copied from the mapping to the device and only the
+// pages of the file that are touched are read.
+
+#ifndef IREE_TOOLING_SAFETENSORS_IO_H_
+#define IREE_TOOLING_SAFETENSORS_IO_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum tensor rank supported when parsing headers.
+#define IREE_SAFETENSORS_MAX_RANK 16
+
+// A tensor described by a safetensors header.
+typedef struct iree_safetensors_tensor_t {
+  // Tensor name as it appears in the header (without JSON unescaping).
+  iree_string_view_t name;
+  iree_hal_element_type_t element_type;
+  iree_host_size_t shape_rank;
+  iree_hal_dim_t shape[IREE_SAFETENSORS_MAX_RANK];
+  // Tensor contents within the file contents that were parsed.
+  iree_const_byte_span_t contents;
+} iree_safetensors_tensor_t;
+
+// Callback issued for each tensor in a safetensors file.
+typedef iree_status_t(IREE_API_PTR* iree_safetensors_tensor_callback_fn_t)(
+    void* user_data, const iree_safetensors_tensor_t* tensor);
+
+// Parses the header of the safetensors file |contents| and issues |callback|
+// for each tensor in the order they are listed in the header. Files written by
+// the reference implementation list tensors in the order of their data.
+// The `__metadata__` entry is ignored.
+IREE_API_EXPORT iree_status_t iree_safetensors_enumerate_tensors(
+    iree_const_byte_span_t contents,
+    iree_safetensors_tensor_callback_fn_t callback, void* user_data);
+
+// Callback issued with the buffer view loaded for each tensor. The callback
+// must retain |buffer_view| if it needs it beyond the call.
+typedef iree_status_t(IREE_API_PTR* iree_safetensors_buffer_view_callback_fn_t)(
+    void* user_data, iree_string_view_t name,
+    iree_hal_buffer_view_t* buffer_view);
+
+// Maps the safetensors file at |path| into host memory and issues |callback|
+// with a buffer view for each tensor in the order listed in the header.
+//
+// Each tensor is imported from the mapping using |buffer_params| with
+// read-only access so that no copy is made when the |device_allocator|
+// supports importing host allocations (iree_hal_allocator_import_buffer).
+// Otherwise the tensor is allocated with |buffer_params| and the contents are
+// copied from the mapping. The mapping remains valid until all imported
+// buffers are released.
+IREE_API_EXPORT iree_status_t iree_safetensors_load_file(
+    const char* path, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_safetensors_buffer_view_callback_fn_t callback, void* user_data);
+
+// Maps the safetensors file at |path| into host memory and streams the tensors
+// named in |names| (or all tensors if |name_count| is 0) into buffers usable
+// by |device|, issuing |callback| with a buffer view for each in the order
+// listed in the header.
+//
+// Tensors are imported from the mapping without copies as with
+// iree_safetensors_load_file when the device can use host memory directly.
+// Otherwise the mapping is imported as a staging buffer and copied into a new
+// buffer allocated with |buffer_params| by transfers submitted to the device
+// queue in batches of up to |batch_size| bytes. Batches execute while the
+// following tensors are prepared and only the pages of the file being copied
+// are read, so loading is bound by the transfer bandwidth. The few tensors that
+// cannot be imported as staging buffers (such as unaligned ones) are copied
+// synchronously.
+//
+// |out_ready_fence| receives a fence signaled once all transfers complete: the
+// contents of the buffer views passed to |callback| must not be used before
+// then, for example by waiting on it or passing it as the wait fence of the
+// invocation consuming them.
+IREE_API_EXPORT iree_status_t iree_safetensors_upload_file(
+    const char* path, iree_host_size_t name_count,
+    const iree_string_view_t* names, iree_hal_buffer_params_t buffer_params,
+    iree_device_size_t batch_size, iree_hal_device_t* device,
+    iree_allocator_t host_allocator,
+    iree_safetensors_buffer_view_callback_fn_t callback, void* user_data,
+    iree_hal_fence_t** out_ready_fence);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_SAFETENSORS_IO_H_
@@ -0,0 +1,268 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/safetensors_io.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/tooling/device_util.h"
+
+namespace iree {
+namespace {
+
+using iree::testing::status::IsOk;
+using iree::testing::status::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+// Returns safetensors file contents with the given JSON |header| and |data|.
+static std::vector<uint8_t> MakeFile(std::string header,
+                                     const std::vector<uint8_t>& data) {
+  // The reference implementation pads the header to 8 bytes.
+  while (header.size() % 8) header.push_back(' ');
+  std::vector<uint8_t> contents(8);
+  uint64_t header_length = header.size();
+  for (int i = 0; i < 8; ++i) {
+    contents[i] = (uint8_t)(header_length >> (i * 8));
+  }
+  contents.insert(contents.end(), header.begin(), header.end());
+  contents.insert(contents.end(), data.begin(), data.end());
+  return contents;
+}
+
+static std::vector<uint8_t> MakeTwoTensorFile() {
+  std::vector<uint8_t> data(16 + 4);
+  float f32_values[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+  memcpy(data.data(), f32_values, sizeof(f32_values));
+  int8_t i8_values[4] = {-1, 0, 1, 2};
+  memcpy(data.data() + 16, i8_values, sizeof(i8_values));
+  return MakeFile(
+      "{\"__metadata__\":{\"format\":\"pt\",\"note\":\"{[\\\"]}\"},"
+      "\"weight\":{\"dtype\":\"F32\",\"shape\":[2,2],\"data_offsets\":[0,16]},"
+      "\"bias\":{\"dtype\":\"I8\",\"shape\":[4],\"data_offsets\":[16,20]}}",
+      data);
+}
+
+struct EnumeratedTensor {
+  std::string name;
+  iree_hal_element_type_t element_type;
+  std::vector<iree_hal_dim_t> shape;
+  iree_const_byte_span_t contents;
+};
+
+static iree_status_t AppendTensor(void* user_data,
+                                  const iree_safetensors_tensor_t* tensor) {
+  auto* tensors = (std::vector<EnumeratedTensor>*)user_data;
+  tensors->push_back({
+      std::string(tensor->name.data, tensor->name.size),
+      tensor->element_type,
+      std::vector<iree_hal_dim_t>(tensor->shape,
+                                  tensor->shape + tensor->shape_rank),
+      tensor->contents,
+  });
+  return iree_ok_status();
+}
+
+TEST(SafetensorsIOTest, EnumerateTensors) {
+  std::vector<uint8_t> file = MakeTwoTensorFile();
+  std::vector<EnumeratedTensor> tensors;
+  IREE_ASSERT_OK(iree_safetensors_enumerate_tensors(
+      iree_make_const_byte_span(file.data(), file.size()), AppendTensor,
+      &tensors));
+  ASSERT_EQ(tensors.size(), 2);
+  EXPECT_EQ(tensors[0].name, "weight");
+  EXPECT_EQ(tensors[0].element_type, IREE_HAL_ELEMENT_TYPE_FLOAT_32);
+  EXPECT_THAT(tensors[0].shape, ElementsAre(2, 2));
+  EXPECT_EQ(tensors[0].contents.data, file.data() + file.size() - 20);
+  EXPECT_EQ(tensors[0].contents.data_length, 16);
+  EXPECT_EQ(tensors[1].name, "bias");
+  EXPECT_EQ(tensors[1].element_type, IREE_HAL_ELEMENT_TYPE_SINT_8);
+  EXPECT_THAT(tensors[1].shape, ElementsAre(4));
+  EXPECT_EQ(tensors[1].contents.data, file.data() + file.size() - 4);
+  EXPECT_EQ(tensors[1].contents.data_length, 4);
+}
+
+TEST(SafetensorsIOTest, EnumerateEmpty) {
+  std::vector<uint8_t> file = MakeFile("{}", {});
+  std::vector<EnumeratedTensor> tensors;
+  IREE_ASSERT_OK(iree_safetensors_enumerate_tensors(
+      iree_make_const_byte_span(file.data(), file.size()), AppendTensor,
+      &tensors));
+  EXPECT_TRUE(tensors.empty());
+}
+
+TEST(SafetensorsIOTest, RejectsOutOfRangeOffsets) {
+  std::vector<uint8_t> file = MakeFile(
+      "{\"a\":{\"dtype\":\"F32\",\"shape\":[2],\"data_offsets\":[0,8]}}",
+      std::vector<uint8_t>(4));
+  std::vector<EnumeratedTensor> tensors;
+  EXPECT_THAT(Status(iree_safetensors_enumerate_tensors(
+                  iree_make_const_byte_span(file.data(), file.size()),
+                  AppendTensor, &tensors)),
+              StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST(SafetensorsIOTest, RejectsShapeMismatch) {
+  std::vector<uint8_t> file = MakeFile(
+      "{\"a\":{\"dtype\":\"F32\",\"shape\":[3],\"data_offsets\":[0,8]}}",
+      std::vector<uint8_t>(8));
+  std::vector<EnumeratedTensor> tensors;
+  EXPECT_THAT(Status(iree_safetensors_enumerate_tensors(
+                  iree_make_const_byte_span(file.data(), file.size()),
+                  AppendTensor, &tensors)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST(SafetensorsIOTest, RejectsTruncatedHeader) {
+  std::vector<uint8_t> file = MakeFile("{\"a\":{}}", {});
+  file.resize(file.size() - 2);
+  std::vector<EnumeratedTensor> tensors;
+  EXPECT_THAT(Status(iree_safetensors_enumerate_tensors(
+                  iree_make_const_byte_span(file.data(), file.size()),
+                  AppendTensor, &tensors)),
+              StatusIs(StatusCode::kOutOfRange));
+}
+
+class SafetensorsIOLoadTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    iree_status_t status = iree_hal_create_device(
+        iree_hal_available_driver_registry(), IREE_SV("local-sync"),
+        iree_allocator_system(), &device_);
+    if (iree_status_is_not_found(status)) {
+      fprintf(stderr, "Skipping test as 'local-sync' driver was not found:\n");
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      GTEST_SKIP();
+    }
+    device_allocator_ = iree_hal_device_allocator(device_);
+  }
+
+  virtual void TearDown() { iree_hal_device_release(device_); }
+
+  static std::string GetTempFilename(const char* suffix) {
+    static int unique_id = 0;
+    char* test_tmpdir = getenv("TEST_TMPDIR");
+    if (!test_tmpdir) {
+      test_tmpdir = getenv("TMPDIR");
+    }
+    if (!test_tmpdir) {
+      test_tmpdir = getenv("TEMP");
+    }
+    if (!test_tmpdir) {
+      std::cerr << "TEST_TMPDIR/TMPDIR/TEMP not defined\n";
+      exit(1);
+    }
+    return test_tmpdir + std::string("/iree_test_") +
+           std::to_string(unique_id++) + '_' + suffix;
+  }
+
+  iree_hal_device_t* device_ = nullptr;
+  iree_hal_allocator_t* device_allocator_ = nullptr;
+};
+
+static iree_status_t AppendBufferView(void* user_data, iree_string_view_t name,
+                                      iree_hal_buffer_view_t* buffer_view) {
+  auto* buffer_views = (std::vector<iree_hal_buffer_view_t*>*)user_data;
+  iree_hal_buffer_view_retain(buffer_view);
+  buffer_views->push_back(buffer_view);
+  return iree_ok_status();
+}
+
+TEST_F(SafetensorsIOLoadTest, LoadFile) {
+  std::vector<uint8_t> file = MakeTwoTensorFile();
+  std::string path = GetTempFilename("two.safetensors");
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(), iree_make_const_byte_span(file.data(), file.size())));
+
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  std::vector<iree_hal_buffer_view_t*> buffer_views;
+  IREE_ASSERT_OK(iree_safetensors_load_file(
+      path.c_str(), buffer_params, device_allocator_, iree_allocator_system(),
+      AppendBufferView, &buffer_views));
+  ASSERT_EQ(buffer_views.size(), 2);
+
+  EXPECT_EQ(iree_hal_buffer_view_element_type(buffer_views[0]),
+            IREE_HAL_ELEMENT_TYPE_FLOAT_32);
+  EXPECT_EQ(iree_hal_buffer_view_shape_rank(buffer_views[0]), 2);
+  float f32_values[4] = {0};
+  IREE_ASSERT_OK(
+      iree_hal_buffer_map_read(iree_hal_buffer_view_buffer(buffer_views[0]), 0,
+                               f32_values, sizeof(f32_values)));
+  EXPECT_THAT(f32_values, ElementsAreArray({1.0f, 2.0f, 3.0f, 4.0f}));
+
+  EXPECT_EQ(iree_hal_buffer_view_element_type(buffer_views[1]),
+            IREE_HAL_ELEMENT_TYPE_SINT_8);
+  int8_t i8_values[4] = {0};
+  IREE_ASSERT_OK(
+      iree_hal_buffer_map_read(iree_hal_buffer_view_buffer(buffer_views[1]), 0,
+                               i8_values, sizeof(i8_values)));
+  EXPECT_THAT(i8_values, ElementsAreArray({-1, 0, 1, 2}));
+
+  // The buffers must remain valid after the load returns.
+  for (auto* buffer_view : buffer_views) {
+    iree_hal_buffer_view_release(buffer_view);
+  }
+}
+
+struct NamedBufferViews {
+  std::vector<std::string> names;
+  std::vector<iree_hal_buffer_view_t*> buffer_views;
+};
+
+static iree_status_t AppendNamedBufferView(
+    void* user_data, iree_string_view_t name,
+    iree_hal_buffer_view_t* buffer_view) {
+  auto* named = (NamedBufferViews*)user_data;
+  named->names.push_back(std::string(name.data, name.size));
+  iree_hal_buffer_view_retain(buffer_view);
+  named->buffer_views.push_back(buffer_view);
+  return iree_ok_status();
+}
+
+TEST_F(SafetensorsIOLoadTest, UploadFile) {
+  std::vector<uint8_t> file = MakeTwoTensorFile();
+  std::string path = GetTempFilename("upload.safetensors");
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(), iree_make_const_byte_span(file.data(), file.size())));
+
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  iree_string_view_t names[] = {IREE_SV("bias"), IREE_SV("missing")};
+  NamedBufferViews named;
+  iree_hal_fence_t* ready_fence = nullptr;
+  IREE_ASSERT_OK(iree_safetensors_upload_file(
+      path.c_str(), IREE_ARRAYSIZE(names), names, buffer_params,
+      /*batch_size=*/1, device_, iree_allocator_system(),
+      AppendNamedBufferView, &named, &ready_fence));
+  IREE_ASSERT_OK(iree_hal_fence_wait(ready_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(ready_fence);
+
+  // Only the selected tensors are uploaded.
+  ASSERT_THAT(named.names, ElementsAre("bias"));
+  EXPECT_EQ(iree_hal_buffer_view_element_type(named.buffer_views[0]),
+            IREE_HAL_ELEMENT_TYPE_SINT_8);
+  int8_t i8_values[4] = {0};
+  IREE_ASSERT_OK(iree_hal_buffer_map_read(
+      iree_hal_buffer_view_buffer(named.buffer_views[0]), 0, i8_values,
+      sizeof(i8_values)));
+  EXPECT_THAT(i8_values, ElementsAreArray({-1, 0, 1, 2}));
+
+  for (auto* buffer_view : named.buffer_views) {
+    iree_hal_buffer_view_release(buffer_view);
+  }
+}
+
+}  // namespace
+}  // namespace iree
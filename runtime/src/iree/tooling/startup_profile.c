@@ -0,0 +1,199 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/startup_profile.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/flags.h"
+#include "iree/base/tracing.h"
+#include "iree/tooling/vm_util.h"
+
+IREE_FLAG(string, startup_profile, "",
+          "Writes a JSON breakdown of module load, context creation and first "
+          "versus steady-state invocation times to the given file (`-` for "
+          "stdout).");
+
+IREE_FLAG(int32_t, startup_profile_steady_iterations, 10,
+          "Number of invocations after the first used to measure steady-state "
+          "invocation time when --startup_profile= is specified.");
+
+static iree_tooling_startup_profile_t iree_tooling_startup_profile_storage;
+
+iree_tooling_startup_profile_t* iree_tooling_startup_profile(void) {
+  return &iree_tooling_startup_profile_storage;
+}
+
+bool iree_tooling_startup_profile_requested(void) {
+  return strlen(FLAG_startup_profile) > 0;
+}
+
+iree_host_size_t iree_tooling_startup_profile_steady_iteration_count(void) {
+  return FLAG_startup_profile_steady_iterations > 0
+             ? (iree_host_size_t)FLAG_startup_profile_steady_iterations
+             : 0;
+}
+
+iree_status_t iree_tooling_startup_profile_record_context(
+    iree_vm_context_t* context, iree_vm_module_t* hal_module) {
+  IREE_ASSERT_ARGUMENT(context);
+  if (!hal_module) return iree_ok_status();
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_context_resolve_module_state(
+      context, hal_module, &module_state));
+  iree_tooling_startup_profile_t* profile = iree_tooling_startup_profile();
+  iree_hal_module_state_statistics(module_state, &profile->hal_statistics);
+  profile->has_hal_statistics = true;
+  return iree_ok_status();
+}
+
+static void iree_tooling_startup_profile_record_call(
+    iree_tooling_startup_profile_t* profile, iree_duration_t duration) {
+  if (!profile->has_first_call) {
+    profile->first_call_duration = duration;
+    profile->has_first_call = true;
+    return;
+  }
+  if (!profile->steady_call_count ||
+      duration < profile->steady_call_min_duration) {
+    profile->steady_call_min_duration = duration;
+  }
+  if (duration > profile->steady_call_max_duration) {
+    profile->steady_call_max_duration = duration;
+  }
+  profile->steady_call_duration += duration;
+  ++profile->steady_call_count;
+}
+
+iree_status_t iree_tooling_startup_profile_invoke(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_hal_device_t* device, iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(outputs);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Clone the inputs so that the fences appended for this invocation do not
+  // leak into subsequent ones.
+  iree_vm_list_t* call_inputs = NULL;
+  if (inputs) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_list_clone(inputs, host_allocator, &call_inputs));
+  } else {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_list_create(/*element_type=*/NULL, 2, host_allocator,
+                                &call_inputs));
+  }
+
+  iree_time_t start_time = iree_time_now();
+  iree_hal_fence_t* finish_fence = NULL;
+  iree_status_t status = iree_tooling_append_async_fence_inputs(
+      call_inputs, &function, device, /*wait_fence=*/NULL, &finish_fence);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                            /*policy=*/NULL, call_inputs, outputs,
+                            host_allocator);
+  }
+  if (iree_status_is_ok(status) && finish_fence) {
+    status = iree_hal_fence_wait(finish_fence, iree_infinite_timeout());
+  }
+  if (iree_status_is_ok(status)) {
+    iree_tooling_startup_profile_record_call(iree_tooling_startup_profile(),
+                                             iree_time_now() - start_time);
+  }
+
+  iree_hal_fence_release(finish_fence);
+  iree_vm_list_release(call_inputs);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_tooling_startup_profile_fprint_json(
+    FILE* file, const iree_tooling_startup_profile_t* profile,
+    iree_string_view_t tool_name, iree_string_view_t function_name) {
+  IREE_ASSERT_ARGUMENT(file);
+  IREE_ASSERT_ARGUMENT(profile);
+  fprintf(file, "{\n");
+  fprintf(file, "  \"tool\": \"%.*s\",\n", (int)tool_name.size,
+          tool_name.data);
+  fprintf(file, "  \"function\": \"%.*s\",\n", (int)function_name.size,
+          function_name.data);
+  fprintf(file, "  \"module_read_ns\": %" PRId64 ",\n",
+          profile->module_read_duration);
+  fprintf(file, "  \"module_create_ns\": %" PRId64 ",\n",
+          profile->module_create_duration);
+  fprintf(file, "  \"system_module_create_ns\": %" PRId64 ",\n",
+          profile->system_module_create_duration);
+  fprintf(file, "  \"context_create_ns\": %" PRId64 ",\n",
+          profile->context_create_duration);
+  if (profile->has_hal_statistics) {
+    const iree_hal_module_statistics_t* hal = &profile->hal_statistics;
+    fprintf(file, "  \"hal\": {\n");
+    fprintf(file, "    \"executable_count\": %" PRIhsz ",\n",
+            hal->executable_count);
+    fprintf(file, "    \"executable_prepare_ns\": %" PRId64 ",\n",
+            hal->executable_prepare_duration);
+    fprintf(file, "    \"executable_prepare_min_ns\": %" PRId64 ",\n",
+            hal->executable_prepare_min_duration);
+    fprintf(file, "    \"executable_prepare_max_ns\": %" PRId64 ",\n",
+            hal->executable_prepare_max_duration);
+    fprintf(file, "    \"constant_upload_count\": %" PRIhsz ",\n",
+            hal->constant_upload_count);
+    fprintf(file, "    \"constant_upload_bytes\": %" PRIu64 ",\n",
+            (uint64_t)hal->constant_upload_bytes);
+    fprintf(file, "    \"constant_upload_ns\": %" PRId64 ",\n",
+            hal->constant_upload_duration);
+    fprintf(file, "    \"constant_map_count\": %" PRIhsz ",\n",
+            hal->constant_map_count);
+    fprintf(file, "    \"constant_map_bytes\": %" PRIu64 "\n",
+            (uint64_t)hal->constant_map_bytes);
+    fprintf(file, "  },\n");
+  }
+  iree_duration_t steady_call_mean_duration =
+      profile->steady_call_count
+          ? profile->steady_call_duration /
+                (iree_duration_t)profile->steady_call_count
+          : 0;
+  fprintf(file, "  \"first_call_ns\": %" PRId64 ",\n",
+          profile->first_call_duration);
+  fprintf(file, "  \"steady_call_count\": %" PRIhsz ",\n",
+          profile->steady_call_count);
+  fprintf(file, "  \"steady_call_mean_ns\": %" PRId64 ",\n",
+          steady_call_mean_duration);
+  fprintf(file, "  \"steady_call_min_ns\": %" PRId64 ",\n",
+          profile->steady_call_min_duration);
+  fprintf(file, "  \"steady_call_max_ns\": %" PRId64 "\n",
+          profile->steady_call_max_duration);
+  fprintf(file, "}\n");
+  return iree_ok_status();
+}
+
+iree_status_t iree_tooling_startup_profile_write_from_flags(
+    iree_string_view_t tool_name, iree_string_view_t function_name) {
+  if (!iree_tooling_startup_profile_requested()) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const bool use_stdout = strcmp(FLAG_startup_profile, "-") == 0;
+  FILE* file = use_stdout ? stdout : fopen(FLAG_startup_profile, "wb");
+  if (!file) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "failed to open startup profile file '%s'",
+                            FLAG_startup_profile);
+  }
+  iree_status_t status = iree_tooling_startup_profile_fprint_json(
+      file, iree_tooling_startup_profile(), tool_name, function_name);
+  if (use_stdout) {
+    fflush(file);
+  } else if (fclose(file) != 0 && iree_status_is_ok(status)) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "failed to write startup profile file '%s'",
+                              FLAG_startup_profile);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,95 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TOOLING_STARTUP_PROFILE_H_
+#define IREE_TOOLING_STARTUP_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/module.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Wall-clock cost of each phase of bringing up a module and running it for
+// the first time. Phases that were not run have a zero duration.
+typedef struct iree_tooling_startup_profile_t {
+  // Reading or mapping the module file into memory.
+  iree_duration_t module_read_duration;
+  // Creating the VM module from the file contents (iree_vm_module_create).
+  iree_duration_t module_create_duration;
+  // Creating the devices and system modules (HAL/etc) the user modules use.
+  iree_duration_t system_module_create_duration;
+  // Creating the context: allocating module state and running initializers.
+  // Includes executable preparation and constant upload reported in
+  // |hal_statistics| unless executables are loaded lazily.
+  iree_duration_t context_create_duration;
+
+  // Set if the context used the HAL module and |hal_statistics| is valid.
+  bool has_hal_statistics;
+  // HAL module statistics captured after context creation.
+  iree_hal_module_statistics_t hal_statistics;
+
+  // Duration of the first invocation through completion of all device work.
+  iree_duration_t first_call_duration;
+  // Number of invocations after the first and their total, shortest and
+  // longest durations.
+  iree_host_size_t steady_call_count;
+  iree_duration_t steady_call_duration;
+  iree_duration_t steady_call_min_duration;
+  iree_duration_t steady_call_max_duration;
+  // Set once the first invocation has been recorded.
+  bool has_first_call;
+} iree_tooling_startup_profile_t;
+
+// Returns the process-wide startup profile that the tooling utilities record
+// into as they load modules and create contexts.
+iree_tooling_startup_profile_t* iree_tooling_startup_profile(void);
+
+// Returns true if a startup profile was requested with --startup_profile=.
+bool iree_tooling_startup_profile_requested(void);
+
+// Returns the number of steady-state invocations to measure after the first
+// as specified by --startup_profile_steady_iterations=.
+iree_host_size_t iree_tooling_startup_profile_steady_iteration_count(void);
+
+// Records the HAL module statistics of |context| in the process-wide profile
+// if |hal_module| is non-NULL.
+iree_status_t iree_tooling_startup_profile_record_context(
+    iree_vm_context_t* context, iree_vm_module_t* hal_module);
+
+// Invokes |function| once and records the time until it has completed as the
+// first or a steady-state invocation in the process-wide profile.
+//
+// |inputs| must not contain fences: if the function uses the coarse-fences
+// ABI a fresh signal fence is appended to a clone of |inputs| for the call and
+// waited on before returning. Results are appended to |outputs|.
+iree_status_t iree_tooling_startup_profile_invoke(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_hal_device_t* device, iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator);
+
+// Writes |profile| as a JSON object to |file|. |tool_name| and
+// |function_name| identify the measured invocation in the output.
+iree_status_t iree_tooling_startup_profile_fprint_json(
+    FILE* file, const iree_tooling_startup_profile_t* profile,
+    iree_string_view_t tool_name, iree_string_view_t function_name);
+
+// Writes the process-wide profile as JSON to the file specified by
+// --startup_profile= (`-` for stdout). No-op if no profile was requested.
+iree_status_t iree_tooling_startup_profile_write_from_flags(
+    iree_string_view_t tool_name, iree_string_view_t function_name);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_STARTUP_PROFILE_H_
@@ -16,6 +16,7 @@
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
 #include "iree/tooling/numpy_io.h"
+#include "iree/tooling/safetensors_io.h"
 
 static iree_status_t iree_allocate_and_copy_cstring_from_view(
     iree_allocator_t allocator, iree_string_view_t view, char** cstring) {
@@ -65,6 +66,34 @@ static iree_status_t iree_tooling_load_ndarrays_from_file(
   return status;
 }
 
+static iree_status_t iree_tooling_push_safetensors_buffer_view(
+    void* user_data, iree_string_view_t name,
+    iree_hal_buffer_view_t* buffer_view) {
+  iree_vm_list_t* list = (iree_vm_list_t*)user_data;
+  iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_retain_ref(buffer_view);
+  return iree_vm_list_push_ref_move(list, &buffer_view_ref);
+}
+
+// Appends each tensor of the safetensors file at |file_path| to |list|.
+// The file is mapped and the tensors are imported without copying if the
+// |device_allocator| supports it.
+static iree_status_t iree_tooling_load_safetensors_from_file(
+    iree_string_view_t file_path, iree_hal_allocator_t* device_allocator,
+    iree_vm_list_t* list) {
+  char* file_path_cstring = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocate_and_copy_cstring_from_view(
+      iree_allocator_system(), file_path, &file_path_cstring));
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  iree_status_t status = iree_safetensors_load_file(
+      file_path_cstring, buffer_params, device_allocator,
+      iree_allocator_system(), iree_tooling_push_safetensors_buffer_view, list);
+  iree_allocator_free(iree_allocator_system(), file_path_cstring);
+  return status;
+}
+
 struct iree_create_buffer_from_file_generator_user_data_t {
   FILE* file;
 };
@@ -164,8 +193,13 @@ iree_status_t iree_tooling_parse_to_variant_list(
     if (!iree_status_is_ok(status)) break;
     iree_string_view_t input_view = iree_string_view_trim(input_strings[i]);
     if (iree_string_view_consume_prefix(&input_view, IREE_SV("@"))) {
-      status = iree_tooling_load_ndarrays_from_file(input_view,
-                                                    device_allocator, list);
+      if (iree_string_view_ends_with(input_view, IREE_SV(".safetensors"))) {
+        status = iree_tooling_load_safetensors_from_file(
+            input_view, device_allocator, list);
+      } else {
+        status = iree_tooling_load_ndarrays_from_file(input_view,
+                                                      device_allocator, list);
+      }
       continue;
     } else if (iree_string_view_equal(input_view, IREE_SV("(null)")) ||
                iree_string_view_equal(input_view, IREE_SV("(ignored)"))) {
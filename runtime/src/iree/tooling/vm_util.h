@@ -24,6 +24,9 @@ extern "C" {
 // Buffers should be in the IREE standard shaped buffer format:
 //   [shape]xtype=[value]
 // described in iree/hal/api.h
+// Files can be referenced with `@file.npy` (all arrays in the file) or
+// `@file.safetensors` (all tensors in the file in header order). safetensors
+// files are mapped and tensors imported without copying where supported.
 // Uses |device_allocator| to allocate the buffers.
 // The returned variant list must be freed by the caller.
 iree_status_t iree_tooling_parse_to_variant_list(
@@ -290,6 +290,35 @@ static iree_status_t iree_vm_bytecode_disasm_emit_remap_list(
     break;                                                             \
   }
 
+// Fused compare-and-branch superinstructions are printed as the vm.cond_br of
+// the comparison they were encoded from.
+#define DISASM_OP_CORE_COND_BRANCH_CMP_I32(op_name, op_mnemonic)              \
+  DISASM_OP(CORE, op_name) {                                                  \
+    uint16_t lhs_reg = VM_ParseOperandRegI32("lhs");                          \
+    uint16_t rhs_reg = VM_ParseOperandRegI32("rhs");                          \
+    int32_t true_block_pc = VM_ParseBranchTarget("true_dest");                \
+    const iree_vm_register_remap_list_t* true_remap_list =                    \
+        VM_ParseBranchOperands("true_operands");                              \
+    int32_t false_block_pc = VM_ParseBranchTarget("false_dest");              \
+    const iree_vm_register_remap_list_t* false_remap_list =                   \
+        VM_ParseBranchOperands("false_operands");                             \
+    IREE_RETURN_IF_ERROR(                                                     \
+        iree_string_builder_append_format(b, "vm.cond_br %s(", op_mnemonic)); \
+    EMIT_I32_REG_NAME(lhs_reg);                                               \
+    EMIT_OPTIONAL_VALUE_I32(regs->i32[lhs_reg]);                              \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));        \
+    EMIT_I32_REG_NAME(rhs_reg);                                               \
+    EMIT_OPTIONAL_VALUE_I32(regs->i32[rhs_reg]);                              \
+    IREE_RETURN_IF_ERROR(                                                     \
+        iree_string_builder_append_format(b, "), ^%08X(", true_block_pc));    \
+    EMIT_REMAP_LIST(true_remap_list);                                         \
+    IREE_RETURN_IF_ERROR(                                                     \
+        iree_string_builder_append_format(b, "), ^%08X(", false_block_pc));   \
+    EMIT_REMAP_LIST(false_remap_list);                                        \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));         \
+    break;                                                                    \
+  }
+
 #define DISASM_OP_CORE_TERNARY_I32(op_name, op_mnemonic)               \
   DISASM_OP(CORE, op_name) {                                           \
     uint16_t a_reg = VM_ParseOperandRegI32("a");                       \
@@ -1548,6 +1577,11 @@ iree_status_t iree_vm_bytecode_disasm_op(
       break;
     }
 
+    DISASM_OP_CORE_COND_BRANCH_CMP_I32(CondBranchEQI32, "vm.cmp.eq.i32");
+    DISASM_OP_CORE_COND_BRANCH_CMP_I32(CondBranchNEI32, "vm.cmp.ne.i32");
+    DISASM_OP_CORE_COND_BRANCH_CMP_I32(CondBranchLTI32S, "vm.cmp.lt.i32.s");
+    DISASM_OP_CORE_COND_BRANCH_CMP_I32(CondBranchLTI32U, "vm.cmp.lt.i32.u");
+
     DISASM_OP(CORE, Call) {
       int32_t function_ordinal = VM_ParseFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
@@ -61,6 +61,41 @@ static void iree_vm_bytecode_dispatch_discard_registers(
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Baseline JIT tier-up
+//===----------------------------------------------------------------------===//
+
+#if IREE_VM_BYTECODE_JIT_ENABLE
+
+// Runs the native code compiled for the loop header at |pc|, if any, after a
+// backward branch to it. Returns the pc at which to continue interpreting.
+static iree_vm_source_offset_t iree_vm_bytecode_dispatch_backedge(
+    iree_vm_bytecode_module_t* module, iree_vm_stack_frame_t* current_frame,
+    const iree_vm_registers_t regs, iree_vm_source_offset_t pc) {
+  uint32_t function_ordinal = current_frame->function.ordinal;
+  const iree_vm_FunctionDescriptor_t* function_descriptor =
+      &module->function_descriptor_table[function_ordinal];
+  iree_const_byte_span_t function_bytecode = iree_make_const_byte_span(
+      module->bytecode_data.data + function_descriptor->bytecode_offset,
+      function_descriptor->bytecode_length);
+  iree_vm_bytecode_jit_entry_fn_t entry =
+      iree_vm_bytecode_jit_lookup(module->jit, function_ordinal,
+                                  function_bytecode, (uint32_t)pc,
+                                  regs.i32_mask);
+  return entry ? entry(regs.i32) : pc;
+}
+
+// Tiers up after a branch from the op at |branch_pc| when it went backward.
+// Execution tracing disassembles each op so it must stay interpreted.
+#define IREE_VM_BYTECODE_DISPATCH_BACKEDGE(branch_pc)                         \
+  if (pc <= (branch_pc) && !IREE_IS_DISPATCH_TRACING_ENABLED()) {             \
+    pc = iree_vm_bytecode_dispatch_backedge(module, current_frame, regs, pc); \
+  }
+
+#else
+#define IREE_VM_BYTECODE_DISPATCH_BACKEDGE(branch_pc) (void)(branch_pc)
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+
 //===----------------------------------------------------------------------===//
 // Stack management
 //===----------------------------------------------------------------------===//
@@ -476,16 +511,38 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
   }
 }
 
+// Calls the native function |function_ptr| an import is bound to.
+// Matches the default native module begin_call behavior: a native frame is
+// entered for the duration of the call so backtraces and yields behave the
+// same, and on deferral the frame stays on the stack for the module to resume.
+static iree_status_t iree_vm_bytecode_issue_native_import_call(
+    iree_vm_stack_t* stack, const iree_vm_native_function_ptr_t* function_ptr,
+    const iree_vm_function_call_t* call) {
+  iree_vm_stack_frame_t* callee_frame = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
+      stack, &call->function, IREE_VM_STACK_FRAME_NATIVE, /*frame_size=*/0,
+      /*frame_cleanup_fn=*/NULL, &callee_frame));
+  IREE_RETURN_IF_ERROR(function_ptr->shim(
+      stack, IREE_VM_NATIVE_FUNCTION_CALL_BEGIN, call->arguments, call->results,
+      function_ptr->target, call->function.module->self,
+      callee_frame->module_state));
+  return iree_vm_stack_function_leave(stack);
+}
+
 // Issues a populated import call and marshals the results into |dst_reg_list|.
 static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+    iree_vm_stack_t* stack, const iree_vm_bytecode_import_t* import,
+    const iree_vm_function_call_t call,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
     iree_vm_stack_frame_t** out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
-  // Call external function.
+  // Call external function, directly if bound to a native function.
   iree_status_t call_status =
-      call.function.module->begin_call(call.function.module->self, stack, call);
+      import->native_function
+          ? iree_vm_bytecode_issue_native_import_call(
+                stack, import->native_function, &call)
+          : call.function.module->begin_call(call.function.module->self, stack,
+                                             call);
   if (iree_status_is_deferred(call_status)) {
     if (!iree_byte_span_is_empty(call.results)) {
       iree_status_ignore(call_status);
@@ -507,6 +564,7 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
       iree_vm_bytecode_get_register_storage(*out_caller_frame);
 
   // Marshal outputs from the ABI results buffer to registers.
+  iree_string_view_t cconv_results = import->results;
   iree_vm_registers_t caller_registers = *out_caller_registers;
   uint8_t* IREE_RESTRICT p = call.results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
@@ -603,8 +661,8 @@ static iree_status_t iree_vm_bytecode_call_import(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, import, call, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -644,8 +702,8 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, import, call, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -941,9 +999,11 @@ static iree_status_t iree_vm_bytecode_dispatch(
       }
       bool result_is_move;
       iree_vm_ref_t* result = VM_DecResultRegRef("value", &result_is_move);
-      IREE_RETURN_IF_ERROR(iree_vm_ref_wrap_retain(
-          &module_state->rodata_ref_table[rodata_ordinal],
-          iree_vm_buffer_type_id(), result));
+      iree_vm_buffer_t* buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_resolve_rodata(
+          module, module_state, rodata_ordinal, &buffer));
+      IREE_RETURN_IF_ERROR(
+          iree_vm_ref_wrap_retain(buffer, iree_vm_buffer_type_id(), result));
     });
 
     //===------------------------------------------------------------------===//
@@ -1665,14 +1725,17 @@ static iree_status_t iree_vm_bytecode_dispatch(
     //===------------------------------------------------------------------===//
 
     DISPATCH_OP(CORE, Branch, {
+      iree_vm_source_offset_t branch_pc = pc - 1;
       int32_t block_pc = VM_DecBranchTarget("dest");
       const iree_vm_register_remap_list_t* remap_list =
           VM_DecBranchOperands("operands");
       pc = block_pc;
       iree_vm_bytecode_dispatch_remap_branch_registers(regs, remap_list);
+      IREE_VM_BYTECODE_DISPATCH_BACKEDGE(branch_pc);
     });
 
     DISPATCH_OP(CORE, CondBranch, {
+      iree_vm_source_offset_t branch_pc = pc - 1;
       int32_t condition = VM_DecOperandRegI32("condition");
       int32_t true_block_pc = VM_DecBranchTarget("true_dest");
       const iree_vm_register_remap_list_t* true_remap_list =
@@ -1688,7 +1751,37 @@ static iree_status_t iree_vm_bytecode_dispatch(
         iree_vm_bytecode_dispatch_remap_branch_registers(regs,
                                                          false_remap_list);
       }
-    });
+      IREE_VM_BYTECODE_DISPATCH_BACKEDGE(branch_pc);
+    });
+
+    // Superinstructions fusing an i32 comparison into the vm.cond_br that is
+    // its only use. The comparison result is never materialized.
+#define DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(op_name, op_func)                 \
+  DISPATCH_OP(CORE, op_name, {                                                 \
+    iree_vm_source_offset_t branch_pc = pc - 1;                                \
+    int32_t lhs = VM_DecOperandRegI32("lhs");                                  \
+    int32_t rhs = VM_DecOperandRegI32("rhs");                                  \
+    int32_t true_block_pc = VM_DecBranchTarget("true_dest");                   \
+    const iree_vm_register_remap_list_t* true_remap_list =                     \
+        VM_DecBranchOperands("true_operands");                                 \
+    int32_t false_block_pc = VM_DecBranchTarget("false_dest");                 \
+    const iree_vm_register_remap_list_t* false_remap_list =                    \
+        VM_DecBranchOperands("false_operands");                                \
+    if (op_func(lhs, rhs)) {                                                   \
+      pc = true_block_pc;                                                      \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list); \
+    } else {                                                                   \
+      pc = false_block_pc;                                                     \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,                   \
+                                                       false_remap_list);      \
+    }                                                                          \
+    IREE_VM_BYTECODE_DISPATCH_BACKEDGE(branch_pc);                             \
+  });
+
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchEQI32, vm_cmp_eq_i32);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchNEI32, vm_cmp_ne_i32);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchLTI32S, vm_cmp_lt_i32s);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchLTI32U, vm_cmp_lt_i32u);
 
     DISPATCH_OP(CORE, Call, {
       int32_t function_ordinal = VM_DecFuncAttr("callee");
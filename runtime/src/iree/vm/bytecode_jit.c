@@ -0,0 +1,711 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode_jit.h"
+
+#include <string.h>
+
+#include "iree/base/alignment.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
+#include "iree/vm/generated/bytecode_op_table.h"
+
+#if defined(IREE_ARCH_X86_64) &&                                       \
+    (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+     defined(IREE_PLATFORM_LINUX))
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define IREE_VM_BYTECODE_JIT_HAVE_X86_64 1
+#endif  // IREE_ARCH_X86_64 && IREE_PLATFORM_*
+
+#if !defined(IREE_VM_BYTECODE_JIT_HOT_BACKEDGE_COUNT)
+// Number of backward branches taken in a function before it is compiled.
+#define IREE_VM_BYTECODE_JIT_HOT_BACKEDGE_COUNT 1000
+#endif  // !IREE_VM_BYTECODE_JIT_HOT_BACKEDGE_COUNT
+
+// Maximum number of blocks compiled into a region. Branches to further blocks
+// exit to the interpreter.
+#define IREE_VM_BYTECODE_JIT_MAX_BLOCKS 64
+
+// Native code size after which blocks stop being translated and exit to the
+// interpreter instead.
+#define IREE_VM_BYTECODE_JIT_MAX_CODE_SIZE (16 * 1024)
+
+// Maximum number of register pairs in a branch operand remap list. Longer
+// lists are left to the interpreter so that a single op has bounded code size.
+#define IREE_VM_BYTECODE_JIT_MAX_REMAP_SIZE 32
+
+// Upper bound on the native code of a single op; see
+// IREE_VM_BYTECODE_JIT_MAX_REMAP_SIZE.
+#define IREE_VM_BYTECODE_JIT_MAX_OP_CODE_SIZE 1024
+
+// Matches IREE_REF_REGISTER_TYPE_BIT in bytecode_module_impl.h.
+#define IREE_VM_BYTECODE_JIT_REF_REGISTER_TYPE_BIT 0x8000
+
+//===----------------------------------------------------------------------===//
+// Bytecode reading
+//===----------------------------------------------------------------------===//
+
+// Reads the function bytecode with bounds checking. Reads past the end of the
+// function set |ok| to false and return zeros; callers check |ok| once the op
+// has been decoded.
+typedef struct iree_vm_bytecode_jit_reader_t {
+  const uint8_t* data;
+  uint32_t length;
+  uint32_t pc;
+  bool ok;
+} iree_vm_bytecode_jit_reader_t;
+
+static bool iree_vm_bytecode_jit_reader_has(iree_vm_bytecode_jit_reader_t* r,
+                                            uint32_t size) {
+  if (!r->ok || size > r->length || r->pc > r->length - size) r->ok = false;
+  return r->ok;
+}
+
+static uint8_t iree_vm_bytecode_jit_read_u8(iree_vm_bytecode_jit_reader_t* r) {
+  if (!iree_vm_bytecode_jit_reader_has(r, 1)) return 0;
+  return r->data[r->pc++];
+}
+
+static uint16_t iree_vm_bytecode_jit_read_u16(
+    iree_vm_bytecode_jit_reader_t* r) {
+  if (!iree_vm_bytecode_jit_reader_has(r, 2)) return 0;
+  uint16_t value =
+      iree_unaligned_load_le_u16((const uint16_t*)&r->data[r->pc]);
+  r->pc += 2;
+  return value;
+}
+
+static uint32_t iree_vm_bytecode_jit_read_u32(
+    iree_vm_bytecode_jit_reader_t* r) {
+  if (!iree_vm_bytecode_jit_reader_has(r, 4)) return 0;
+  uint32_t value =
+      iree_unaligned_load_le_u32((const uint32_t*)&r->data[r->pc]);
+  r->pc += 4;
+  return value;
+}
+
+// Decoded branch operand remap list (VM_DecBranchOperands).
+typedef struct iree_vm_bytecode_jit_remap_list_t {
+  uint16_t size;
+  // Offset of the first src/dst pair in the bytecode.
+  uint32_t pairs_pc;
+} iree_vm_bytecode_jit_remap_list_t;
+
+static iree_vm_bytecode_jit_remap_list_t iree_vm_bytecode_jit_read_remap_list(
+    iree_vm_bytecode_jit_reader_t* r) {
+  iree_vm_bytecode_jit_remap_list_t list = {0, 0};
+  r->pc = (r->pc + 1) & ~1u;
+  list.size = iree_vm_bytecode_jit_read_u16(r);
+  list.pairs_pc = r->pc;
+  if (iree_vm_bytecode_jit_reader_has(r, list.size * 4u)) {
+    r->pc += list.size * 4u;
+  }
+  return list;
+}
+
+// Returns true if |list| only moves i32 registers and is short enough to
+// translate.
+static bool iree_vm_bytecode_jit_remap_list_is_supported(
+    const iree_vm_bytecode_jit_reader_t* r,
+    iree_vm_bytecode_jit_remap_list_t list) {
+  if (list.size > IREE_VM_BYTECODE_JIT_MAX_REMAP_SIZE) return false;
+  for (uint16_t i = 0; i < list.size; ++i) {
+    uint16_t src_reg = iree_unaligned_load_le_u16(
+        (const uint16_t*)&r->data[list.pairs_pc + i * 4]);
+    if (src_reg & IREE_VM_BYTECODE_JIT_REF_REGISTER_TYPE_BIT) return false;
+  }
+  return true;
+}
+
+#if defined(IREE_VM_BYTECODE_JIT_HAVE_X86_64)
+
+//===----------------------------------------------------------------------===//
+// x86-64 code generation
+//===----------------------------------------------------------------------===//
+// The generated code follows the System V calling convention: the register
+// bank pointer arrives in rdi and the resume pc is returned in eax. Only the
+// caller-saved eax/ecx/edx are used and nothing is spilled so no prologue is
+// needed. Every register bank access is [rdi + disp32] with the register
+// ordinal already masked at compile time.
+
+enum {
+  IREE_VM_BYTECODE_JIT_X86_EAX = 0,
+  IREE_VM_BYTECODE_JIT_X86_ECX = 1,
+  IREE_VM_BYTECODE_JIT_X86_EDX = 2,
+};
+
+// Condition codes for SETcc/Jcc, low nibble of the second opcode byte.
+enum {
+  IREE_VM_BYTECODE_JIT_X86_CC_B = 0x2,
+  IREE_VM_BYTECODE_JIT_X86_CC_E = 0x4,
+  IREE_VM_BYTECODE_JIT_X86_CC_NE = 0x5,
+  IREE_VM_BYTECODE_JIT_X86_CC_L = 0xC,
+};
+
+typedef struct iree_vm_bytecode_jit_block_t {
+  // Function-relative pc of the first op in the block.
+  uint32_t pc;
+  // Offset of the block's code or UINT32_MAX if it has not been translated.
+  uint32_t code_offset;
+} iree_vm_bytecode_jit_block_t;
+
+// A rel32 jump operand to patch with the offset of a block's code.
+typedef struct iree_vm_bytecode_jit_fixup_t {
+  uint32_t code_offset;
+  uint32_t block_index;
+} iree_vm_bytecode_jit_fixup_t;
+
+typedef struct iree_vm_bytecode_jit_compiler_t {
+  iree_vm_bytecode_jit_reader_t reader;
+  uint16_t i32_mask;
+
+  // Blocks in the order they are discovered; the entry block is first.
+  iree_host_size_t block_count;
+  iree_vm_bytecode_jit_block_t blocks[IREE_VM_BYTECODE_JIT_MAX_BLOCKS];
+
+  // Jumps to patch once all blocks have been translated. Branches past this
+  // many exit to the interpreter.
+  iree_host_size_t fixup_count;
+  iree_vm_bytecode_jit_fixup_t fixups[IREE_VM_BYTECODE_JIT_MAX_BLOCKS * 4];
+
+  iree_host_size_t code_size;
+  // Room for one op past the size limit and an exit for each block after it.
+  uint8_t code[IREE_VM_BYTECODE_JIT_MAX_CODE_SIZE +
+               IREE_VM_BYTECODE_JIT_MAX_OP_CODE_SIZE +
+               IREE_VM_BYTECODE_JIT_MAX_BLOCKS * 8];
+} iree_vm_bytecode_jit_compiler_t;
+
+static void iree_vm_bytecode_jit_emit_u8(iree_vm_bytecode_jit_compiler_t* c,
+                                         uint8_t value) {
+  c->code[c->code_size++] = value;
+}
+
+static void iree_vm_bytecode_jit_emit_u32(iree_vm_bytecode_jit_compiler_t* c,
+                                          uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    iree_vm_bytecode_jit_emit_u8(c, (uint8_t)(value >> (8 * i)));
+  }
+}
+
+static void iree_vm_bytecode_jit_patch_u32(iree_vm_bytecode_jit_compiler_t* c,
+                                           iree_host_size_t code_offset,
+                                           uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    c->code[code_offset + i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+// Emits a ModRM byte addressing [rdi + disp32] of the i32 register |reg| with
+// |gpr| in the reg field, followed by the displacement.
+static void iree_vm_bytecode_jit_emit_reg_operand(
+    iree_vm_bytecode_jit_compiler_t* c, int gpr, uint16_t reg) {
+  iree_vm_bytecode_jit_emit_u8(c, (uint8_t)(0x80 | (gpr << 3) | 7));
+  iree_vm_bytecode_jit_emit_u32(c, (uint32_t)(reg & c->i32_mask) * 4);
+}
+
+// mov gpr, dword [rdi + reg * 4]
+static void iree_vm_bytecode_jit_emit_load(iree_vm_bytecode_jit_compiler_t* c,
+                                           int gpr, uint16_t reg) {
+  iree_vm_bytecode_jit_emit_u8(c, 0x8B);
+  iree_vm_bytecode_jit_emit_reg_operand(c, gpr, reg);
+}
+
+// mov dword [rdi + reg * 4], gpr
+static void iree_vm_bytecode_jit_emit_store(iree_vm_bytecode_jit_compiler_t* c,
+                                            int gpr, uint16_t reg) {
+  iree_vm_bytecode_jit_emit_u8(c, 0x89);
+  iree_vm_bytecode_jit_emit_reg_operand(c, gpr, reg);
+}
+
+// mov dword [rdi + reg * 4], imm32
+static void iree_vm_bytecode_jit_emit_store_imm(
+    iree_vm_bytecode_jit_compiler_t* c, uint16_t reg, uint32_t value) {
+  iree_vm_bytecode_jit_emit_u8(c, 0xC7);
+  iree_vm_bytecode_jit_emit_reg_operand(c, 0, reg);
+  iree_vm_bytecode_jit_emit_u32(c, value);
+}
+
+// Emits a register-to-register op |opcode| with ModRM rm=|rm_gpr|,
+// reg=|reg_gpr|.
+static void iree_vm_bytecode_jit_emit_rr(iree_vm_bytecode_jit_compiler_t* c,
+                                         uint8_t opcode, int rm_gpr,
+                                         int reg_gpr) {
+  iree_vm_bytecode_jit_emit_u8(c, opcode);
+  iree_vm_bytecode_jit_emit_u8(c, (uint8_t)(0xC0 | (reg_gpr << 3) | rm_gpr));
+}
+
+// setcc al; movzx eax, al
+static void iree_vm_bytecode_jit_emit_setcc(iree_vm_bytecode_jit_compiler_t* c,
+                                            uint8_t cc) {
+  iree_vm_bytecode_jit_emit_u8(c, 0x0F);
+  iree_vm_bytecode_jit_emit_u8(c, (uint8_t)(0x90 | cc));
+  iree_vm_bytecode_jit_emit_u8(c, 0xC0);
+  iree_vm_bytecode_jit_emit_u8(c, 0x0F);
+  iree_vm_bytecode_jit_emit_u8(c, 0xB6);
+  iree_vm_bytecode_jit_emit_u8(c, 0xC0);
+}
+
+// Returns to the interpreter with |pc| as the resume pc.
+static void iree_vm_bytecode_jit_emit_exit(iree_vm_bytecode_jit_compiler_t* c,
+                                           uint32_t pc) {
+  iree_vm_bytecode_jit_emit_u8(c, 0xB8);  // mov eax, imm32
+  iree_vm_bytecode_jit_emit_u32(c, pc);
+  iree_vm_bytecode_jit_emit_u8(c, 0xC3);  // ret
+}
+
+// Emits the i32 register moves of a branch operand remap list in order, as
+// done by iree_vm_bytecode_dispatch_remap_branch_registers.
+static void iree_vm_bytecode_jit_emit_remap(
+    iree_vm_bytecode_jit_compiler_t* c,
+    iree_vm_bytecode_jit_remap_list_t list) {
+  for (uint16_t i = 0; i < list.size; ++i) {
+    const uint16_t* pair =
+        (const uint16_t*)&c->reader.data[list.pairs_pc + i * 4];
+    uint16_t src_reg = iree_unaligned_load_le_u16(&pair[0]);
+    uint16_t dst_reg = iree_unaligned_load_le_u16(&pair[1]);
+    iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_EAX, src_reg);
+    iree_vm_bytecode_jit_emit_store(c, IREE_VM_BYTECODE_JIT_X86_EAX, dst_reg);
+  }
+}
+
+// Emits a jump to the block at |pc|, queuing it for translation. Exits to the
+// interpreter instead if the region is full.
+static void iree_vm_bytecode_jit_emit_jump(iree_vm_bytecode_jit_compiler_t* c,
+                                           uint32_t pc) {
+  iree_host_size_t block_index = 0;
+  for (; block_index < c->block_count; ++block_index) {
+    if (c->blocks[block_index].pc == pc) break;
+  }
+  if (block_index == c->block_count) {
+    if (c->block_count == IREE_ARRAYSIZE(c->blocks)) {
+      iree_vm_bytecode_jit_emit_exit(c, pc);
+      return;
+    }
+    c->blocks[c->block_count].pc = pc;
+    c->blocks[c->block_count].code_offset = UINT32_MAX;
+    ++c->block_count;
+  }
+  if (c->fixup_count == IREE_ARRAYSIZE(c->fixups)) {
+    iree_vm_bytecode_jit_emit_exit(c, pc);
+    return;
+  }
+  iree_vm_bytecode_jit_emit_u8(c, 0xE9);  // jmp rel32
+  c->fixups[c->fixup_count].code_offset = (uint32_t)c->code_size;
+  c->fixups[c->fixup_count].block_index = (uint32_t)block_index;
+  ++c->fixup_count;
+  iree_vm_bytecode_jit_emit_u32(c, 0);
+}
+
+// Translates ops starting at the current reader pc until the block ends with a
+// branch or an op that must be left to the interpreter. Returns the number of
+// ops translated.
+static iree_host_size_t iree_vm_bytecode_jit_translate_block(
+    iree_vm_bytecode_jit_compiler_t* c) {
+  iree_vm_bytecode_jit_reader_t* r = &c->reader;
+  iree_host_size_t op_count = 0;
+  while (true) {
+    uint32_t op_pc = r->pc;
+    if (c->code_size > IREE_VM_BYTECODE_JIT_MAX_CODE_SIZE) {
+      iree_vm_bytecode_jit_emit_exit(c, op_pc);
+      return op_count;
+    }
+    uint8_t opcode = iree_vm_bytecode_jit_read_u8(r);
+    switch (opcode) {
+      case IREE_VM_OP_CORE_ConstI32Zero:
+      case IREE_VM_OP_CORE_ConstI32: {
+        uint32_t value = opcode == IREE_VM_OP_CORE_ConstI32
+                             ? iree_vm_bytecode_jit_read_u32(r)
+                             : 0;
+        uint16_t result = iree_vm_bytecode_jit_read_u16(r);
+        if (!r->ok) break;
+        iree_vm_bytecode_jit_emit_store_imm(c, result, value);
+        ++op_count;
+        continue;
+      }
+      case IREE_VM_OP_CORE_AddI32:
+      case IREE_VM_OP_CORE_SubI32:
+      case IREE_VM_OP_CORE_MulI32:
+      case IREE_VM_OP_CORE_AndI32:
+      case IREE_VM_OP_CORE_OrI32:
+      case IREE_VM_OP_CORE_XorI32:
+      case IREE_VM_OP_CORE_ShlI32:
+      case IREE_VM_OP_CORE_ShrI32S:
+      case IREE_VM_OP_CORE_ShrI32U:
+      case IREE_VM_OP_CORE_CmpEQI32:
+      case IREE_VM_OP_CORE_CmpNEI32:
+      case IREE_VM_OP_CORE_CmpLTI32S:
+      case IREE_VM_OP_CORE_CmpLTI32U: {
+        uint16_t lhs = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t rhs = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t result = iree_vm_bytecode_jit_read_u16(r);
+        if (!r->ok) break;
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_EAX, lhs);
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_ECX, rhs);
+        switch (opcode) {
+          case IREE_VM_OP_CORE_AddI32:  // add eax, ecx
+          case IREE_VM_OP_CORE_SubI32:  // sub eax, ecx
+          case IREE_VM_OP_CORE_AndI32:  // and eax, ecx
+          case IREE_VM_OP_CORE_OrI32:   // or eax, ecx
+          case IREE_VM_OP_CORE_XorI32: {  // xor eax, ecx
+            uint8_t x86_opcode = opcode == IREE_VM_OP_CORE_AddI32   ? 0x01
+                                 : opcode == IREE_VM_OP_CORE_SubI32 ? 0x29
+                                 : opcode == IREE_VM_OP_CORE_AndI32 ? 0x21
+                                 : opcode == IREE_VM_OP_CORE_OrI32  ? 0x09
+                                                                    : 0x31;
+            iree_vm_bytecode_jit_emit_rr(c, x86_opcode,
+                                         IREE_VM_BYTECODE_JIT_X86_EAX,
+                                         IREE_VM_BYTECODE_JIT_X86_ECX);
+            break;
+          }
+          case IREE_VM_OP_CORE_MulI32:  // imul eax, ecx
+            iree_vm_bytecode_jit_emit_u8(c, 0x0F);
+            iree_vm_bytecode_jit_emit_rr(c, 0xAF, IREE_VM_BYTECODE_JIT_X86_ECX,
+                                         IREE_VM_BYTECODE_JIT_X86_EAX);
+            break;
+          case IREE_VM_OP_CORE_ShlI32:   // shl eax, cl
+          case IREE_VM_OP_CORE_ShrI32S:  // sar eax, cl
+          case IREE_VM_OP_CORE_ShrI32U:  // shr eax, cl
+            // The hardware masks the amount to 5 bits as vm_shl_i32/etc do.
+            iree_vm_bytecode_jit_emit_rr(c, 0xD3, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                         opcode == IREE_VM_OP_CORE_ShlI32 ? 4
+                                         : opcode == IREE_VM_OP_CORE_ShrI32S
+                                             ? 7
+                                             : 5);
+            break;
+          default: {  // cmp eax, ecx; setcc
+            uint8_t cc = opcode == IREE_VM_OP_CORE_CmpEQI32
+                             ? IREE_VM_BYTECODE_JIT_X86_CC_E
+                         : opcode == IREE_VM_OP_CORE_CmpNEI32
+                             ? IREE_VM_BYTECODE_JIT_X86_CC_NE
+                         : opcode == IREE_VM_OP_CORE_CmpLTI32S
+                             ? IREE_VM_BYTECODE_JIT_X86_CC_L
+                             : IREE_VM_BYTECODE_JIT_X86_CC_B;
+            iree_vm_bytecode_jit_emit_rr(c, 0x39, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                         IREE_VM_BYTECODE_JIT_X86_ECX);
+            iree_vm_bytecode_jit_emit_setcc(c, cc);
+            break;
+          }
+        }
+        iree_vm_bytecode_jit_emit_store(c, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                        result);
+        ++op_count;
+        continue;
+      }
+      case IREE_VM_OP_CORE_NotI32:
+      case IREE_VM_OP_CORE_CmpNZI32: {
+        uint16_t operand = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t result = iree_vm_bytecode_jit_read_u16(r);
+        if (!r->ok) break;
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                       operand);
+        if (opcode == IREE_VM_OP_CORE_NotI32) {
+          // not eax
+          iree_vm_bytecode_jit_emit_rr(c, 0xF7, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                       2);
+        } else {
+          // test eax, eax; setne
+          iree_vm_bytecode_jit_emit_rr(c, 0x85, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                       IREE_VM_BYTECODE_JIT_X86_EAX);
+          iree_vm_bytecode_jit_emit_setcc(c, IREE_VM_BYTECODE_JIT_X86_CC_NE);
+        }
+        iree_vm_bytecode_jit_emit_store(c, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                        result);
+        ++op_count;
+        continue;
+      }
+      case IREE_VM_OP_CORE_SelectI32: {
+        uint16_t condition = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t true_value = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t false_value = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t result = iree_vm_bytecode_jit_read_u16(r);
+        if (!r->ok) break;
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                       condition);
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_ECX,
+                                       true_value);
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_EDX,
+                                       false_value);
+        // test eax, eax; cmovz ecx, edx
+        iree_vm_bytecode_jit_emit_rr(c, 0x85, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                     IREE_VM_BYTECODE_JIT_X86_EAX);
+        iree_vm_bytecode_jit_emit_u8(c, 0x0F);
+        iree_vm_bytecode_jit_emit_rr(c, 0x44, IREE_VM_BYTECODE_JIT_X86_EDX,
+                                     IREE_VM_BYTECODE_JIT_X86_ECX);
+        iree_vm_bytecode_jit_emit_store(c, IREE_VM_BYTECODE_JIT_X86_ECX,
+                                        result);
+        ++op_count;
+        continue;
+      }
+      case IREE_VM_OP_CORE_Branch: {
+        uint32_t dest_pc = iree_vm_bytecode_jit_read_u32(r);
+        iree_vm_bytecode_jit_remap_list_t remap_list =
+            iree_vm_bytecode_jit_read_remap_list(r);
+        if (!r->ok ||
+            !iree_vm_bytecode_jit_remap_list_is_supported(r, remap_list)) {
+          break;
+        }
+        iree_vm_bytecode_jit_emit_remap(c, remap_list);
+        iree_vm_bytecode_jit_emit_jump(c, dest_pc);
+        return op_count + 1;
+      }
+      case IREE_VM_OP_CORE_CondBranch:
+      case IREE_VM_OP_CORE_CondBranchEQI32:
+      case IREE_VM_OP_CORE_CondBranchNEI32:
+      case IREE_VM_OP_CORE_CondBranchLTI32S:
+      case IREE_VM_OP_CORE_CondBranchLTI32U: {
+        // vm.cond_br tests a condition register while the fused
+        // compare-and-branch ops compare two operands.
+        bool is_fused = opcode != IREE_VM_OP_CORE_CondBranch;
+        uint16_t lhs = iree_vm_bytecode_jit_read_u16(r);
+        uint16_t rhs = is_fused ? iree_vm_bytecode_jit_read_u16(r) : 0;
+        uint32_t true_pc = iree_vm_bytecode_jit_read_u32(r);
+        iree_vm_bytecode_jit_remap_list_t true_remap_list =
+            iree_vm_bytecode_jit_read_remap_list(r);
+        uint32_t false_pc = iree_vm_bytecode_jit_read_u32(r);
+        iree_vm_bytecode_jit_remap_list_t false_remap_list =
+            iree_vm_bytecode_jit_read_remap_list(r);
+        if (!r->ok ||
+            !iree_vm_bytecode_jit_remap_list_is_supported(r,
+                                                          true_remap_list) ||
+            !iree_vm_bytecode_jit_remap_list_is_supported(r,
+                                                          false_remap_list)) {
+          break;
+        }
+        iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_EAX, lhs);
+        uint8_t false_cc = IREE_VM_BYTECODE_JIT_X86_CC_E;
+        if (is_fused) {
+          // cmp eax, ecx; jump to the false path on the inverted condition
+          // (inverting an x86 condition code flips its low bit).
+          iree_vm_bytecode_jit_emit_load(c, IREE_VM_BYTECODE_JIT_X86_ECX, rhs);
+          iree_vm_bytecode_jit_emit_rr(c, 0x39, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                       IREE_VM_BYTECODE_JIT_X86_ECX);
+          uint8_t cc = opcode == IREE_VM_OP_CORE_CondBranchEQI32
+                           ? IREE_VM_BYTECODE_JIT_X86_CC_E
+                       : opcode == IREE_VM_OP_CORE_CondBranchNEI32
+                           ? IREE_VM_BYTECODE_JIT_X86_CC_NE
+                       : opcode == IREE_VM_OP_CORE_CondBranchLTI32S
+                           ? IREE_VM_BYTECODE_JIT_X86_CC_L
+                           : IREE_VM_BYTECODE_JIT_X86_CC_B;
+          false_cc = cc ^ 1;
+        } else {
+          // test eax, eax; jz false_path
+          iree_vm_bytecode_jit_emit_rr(c, 0x85, IREE_VM_BYTECODE_JIT_X86_EAX,
+                                       IREE_VM_BYTECODE_JIT_X86_EAX);
+        }
+        iree_vm_bytecode_jit_emit_u8(c, 0x0F);  // jcc rel32
+        iree_vm_bytecode_jit_emit_u8(c, 0x80 | false_cc);
+        iree_host_size_t false_path_fixup = c->code_size;
+        iree_vm_bytecode_jit_emit_u32(c, 0);
+        iree_vm_bytecode_jit_emit_remap(c, true_remap_list);
+        iree_vm_bytecode_jit_emit_jump(c, true_pc);
+        iree_vm_bytecode_jit_patch_u32(
+            c, false_path_fixup,
+            (uint32_t)(c->code_size - (false_path_fixup + 4)));
+        iree_vm_bytecode_jit_emit_remap(c, false_remap_list);
+        iree_vm_bytecode_jit_emit_jump(c, false_pc);
+        return op_count + 1;
+      }
+      default:
+        break;
+    }
+    // Unhandled or truncated op: the interpreter executes it.
+    iree_vm_bytecode_jit_emit_exit(c, op_pc);
+    return op_count;
+  }
+}
+
+static iree_status_t iree_vm_bytecode_jit_compile(
+    iree_vm_bytecode_jit_compiler_t* c, uint32_t entry_pc) {
+  c->blocks[0].pc = entry_pc;
+  c->blocks[0].code_offset = UINT32_MAX;
+  c->block_count = 1;
+  for (iree_host_size_t i = 0; i < c->block_count; ++i) {
+    c->blocks[i].code_offset = (uint32_t)c->code_size;
+    c->reader.pc = c->blocks[i].pc;
+    c->reader.ok = true;
+    iree_host_size_t op_count = iree_vm_bytecode_jit_translate_block(c);
+    if (i == 0 && op_count == 0) {
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "op at pc %u not handled by the JIT", entry_pc);
+    }
+  }
+  for (iree_host_size_t i = 0; i < c->fixup_count; ++i) {
+    const iree_vm_bytecode_jit_fixup_t* fixup = &c->fixups[i];
+    uint32_t target = c->blocks[fixup->block_index].code_offset;
+    iree_vm_bytecode_jit_patch_u32(c, fixup->code_offset,
+                                   target - (fixup->code_offset + 4));
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_jit_map_code(
+    const uint8_t* code, iree_host_size_t code_size,
+    iree_vm_bytecode_jit_region_t* region) {
+  iree_host_size_t page_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  iree_host_size_t pages_size = iree_host_align(code_size, page_size);
+  void* pages = mmap(NULL, pages_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "mmap of %" PRIhsz " byte JIT region failed",
+                            pages_size);
+  }
+  memcpy(pages, code, code_size);
+  // Pages are never writable and executable at the same time.
+  if (mprotect(pages, pages_size, PROT_READ | PROT_EXEC) != 0) {
+    int error = errno;
+    munmap(pages, pages_size);
+    return iree_make_status(iree_status_code_from_errno(error),
+                            "mprotect of JIT region failed");
+  }
+  region->code_pages = pages;
+  region->code_pages_size = pages_size;
+  region->entry = (iree_vm_bytecode_jit_entry_fn_t)pages;
+  return iree_ok_status();
+}
+
+#endif  // IREE_VM_BYTECODE_JIT_HAVE_X86_64
+
+//===----------------------------------------------------------------------===//
+// Regions
+//===----------------------------------------------------------------------===//
+
+bool iree_vm_bytecode_jit_is_supported(void) {
+#if defined(IREE_VM_BYTECODE_JIT_HAVE_X86_64)
+  return true;
+#else
+  return false;
+#endif  // IREE_VM_BYTECODE_JIT_HAVE_X86_64
+}
+
+iree_status_t iree_vm_bytecode_jit_compile_region(
+    iree_const_byte_span_t function_bytecode, uint32_t entry_pc,
+    uint16_t i32_mask, iree_allocator_t host_allocator,
+    iree_vm_bytecode_jit_region_t* out_region) {
+  IREE_ASSERT_ARGUMENT(out_region);
+  memset(out_region, 0, sizeof(*out_region));
+#if defined(IREE_VM_BYTECODE_JIT_HAVE_X86_64)
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_bytecode_jit_compiler_t* compiler = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*compiler),
+                                (void**)&compiler));
+  compiler->reader.data = function_bytecode.data;
+  compiler->reader.length = (uint32_t)function_bytecode.data_length;
+  compiler->i32_mask = i32_mask;
+  compiler->block_count = 0;
+  compiler->fixup_count = 0;
+  compiler->code_size = 0;
+  iree_status_t status = iree_vm_bytecode_jit_compile(compiler, entry_pc);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_bytecode_jit_map_code(compiler->code,
+                                           compiler->code_size, out_region);
+  }
+  if (iree_status_is_ok(status)) {
+    out_region->entry_pc = entry_pc;
+  }
+  iree_allocator_free(host_allocator, compiler);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "bytecode JIT not supported on this host");
+#endif  // IREE_VM_BYTECODE_JIT_HAVE_X86_64
+}
+
+void iree_vm_bytecode_jit_region_deinitialize(
+    iree_vm_bytecode_jit_region_t* region) {
+#if defined(IREE_VM_BYTECODE_JIT_HAVE_X86_64)
+  if (region->code_pages) munmap(region->code_pages, region->code_pages_size);
+#endif  // IREE_VM_BYTECODE_JIT_HAVE_X86_64
+  memset(region, 0, sizeof(*region));
+}
+
+//===----------------------------------------------------------------------===//
+// iree_vm_bytecode_jit_t
+//===----------------------------------------------------------------------===//
+
+// Published in iree_vm_bytecode_jit_function_t::entry when compilation failed
+// so that the function stays interpreted without retrying.
+#define IREE_VM_BYTECODE_JIT_ENTRY_FAILED ((intptr_t)1)
+
+typedef struct iree_vm_bytecode_jit_function_t {
+  // Backward branches taken so far. Exactly one thread observes the count
+  // reaching IREE_VM_BYTECODE_JIT_HOT_BACKEDGE_COUNT and compiles the region.
+  iree_atomic_int32_t backedge_count;
+  // The region entry once compiled, published with release ordering after
+  // |region| is populated.
+  iree_atomic_intptr_t entry;
+  iree_vm_bytecode_jit_region_t region;
+} iree_vm_bytecode_jit_function_t;
+
+struct iree_vm_bytecode_jit_t {
+  iree_allocator_t allocator;
+  iree_host_size_t function_count;
+  iree_vm_bytecode_jit_function_t functions[];
+};
+
+iree_status_t iree_vm_bytecode_jit_create(iree_host_size_t function_count,
+                                          iree_allocator_t allocator,
+                                          iree_vm_bytecode_jit_t** out_jit) {
+  IREE_ASSERT_ARGUMENT(out_jit);
+  *out_jit = NULL;
+  iree_host_size_t total_size =
+      sizeof(iree_vm_bytecode_jit_t) +
+      function_count * sizeof(iree_vm_bytecode_jit_function_t);
+  iree_vm_bytecode_jit_t* jit = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, total_size, (void**)&jit));
+  memset(jit, 0, total_size);
+  jit->allocator = allocator;
+  jit->function_count = function_count;
+  *out_jit = jit;
+  return iree_ok_status();
+}
+
+void iree_vm_bytecode_jit_destroy(iree_vm_bytecode_jit_t* jit) {
+  if (!jit) return;
+  for (iree_host_size_t i = 0; i < jit->function_count; ++i) {
+    iree_vm_bytecode_jit_region_deinitialize(&jit->functions[i].region);
+  }
+  iree_allocator_free(jit->allocator, jit);
+}
+
+iree_vm_bytecode_jit_entry_fn_t iree_vm_bytecode_jit_lookup(
+    iree_vm_bytecode_jit_t* jit, uint32_t function_ordinal,
+    iree_const_byte_span_t function_bytecode, uint32_t target_pc,
+    uint16_t i32_mask) {
+  if (function_ordinal >= jit->function_count) return NULL;
+  iree_vm_bytecode_jit_function_t* function =
+      &jit->functions[function_ordinal];
+  intptr_t entry =
+      iree_atomic_load_intptr(&function->entry, iree_memory_order_acquire);
+  if (entry == IREE_VM_BYTECODE_JIT_ENTRY_FAILED) return NULL;
+  if (entry) {
+    return function->region.entry_pc == target_pc
+               ? (iree_vm_bytecode_jit_entry_fn_t)entry
+               : NULL;
+  }
+  int32_t count = iree_atomic_fetch_add_int32(&function->backedge_count, 1,
+                                              iree_memory_order_relaxed);
+  if (count + 1 != IREE_VM_BYTECODE_JIT_HOT_BACKEDGE_COUNT) return NULL;
+
+  iree_status_t status = iree_vm_bytecode_jit_compile_region(
+      function_bytecode, target_pc, i32_mask, jit->allocator,
+      &function->region);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_atomic_store_intptr(&function->entry,
+                             IREE_VM_BYTECODE_JIT_ENTRY_FAILED,
+                             iree_memory_order_release);
+    return NULL;
+  }
+  iree_atomic_store_intptr(&function->entry, (intptr_t)function->region.entry,
+                           iree_memory_order_release);
+  return function->region.entry;
+}
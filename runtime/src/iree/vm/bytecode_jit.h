@@ -0,0 +1,102 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Baseline JIT for bytecode function regions.
+//
+// The interpreter counts the backward branches taken in each function and once
+// a function is hot the loop header being branched to is compiled to native
+// code. Compiled code operates directly on the interpreter's i32 register bank
+// (the same storage and register masking used by VM_DecOperandRegI32/etc) so
+// entering and leaving it requires no marshaling: the interpreter calls the
+// region entry with the frame registers and resumes dispatch at the returned
+// pc. Any op the JIT does not handle ends the native code at that op and
+// returns its pc so that the interpreter executes it.
+//
+// Only a small subset of the core ops are handled today: i32 constants,
+// arithmetic, bitwise ops, shifts, comparisons, selects, and branches
+// (including the fused compare-and-branch ops) whose operand remapping only
+// touches i32 registers. That subset is what loop
+// induction and bounds checks lower to, which is where the interpreter spends
+// most of its time in dispatch overhead.
+
+#ifndef IREE_VM_BYTECODE_JIT_H_
+#define IREE_VM_BYTECODE_JIT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Native code compiled from a bytecode region.
+// |i32| is the i32 register bank of the frame executing the function. Returns
+// the function-relative pc at which the interpreter must resume.
+typedef uint32_t (*iree_vm_bytecode_jit_entry_fn_t)(int32_t* IREE_RESTRICT i32);
+
+// A region of a function compiled to native code.
+typedef struct iree_vm_bytecode_jit_region_t {
+  // Entry point of the code, entered with the register bank at |entry_pc|.
+  iree_vm_bytecode_jit_entry_fn_t entry;
+  // Function-relative pc of the block the region is entered at.
+  uint32_t entry_pc;
+  // Executable pages holding the code.
+  void* code_pages;
+  iree_host_size_t code_pages_size;
+} iree_vm_bytecode_jit_region_t;
+
+// Returns true if the JIT can generate code for the host.
+bool iree_vm_bytecode_jit_is_supported(void);
+
+// Compiles the region of |function_bytecode| reachable from the block at
+// |entry_pc| through handled ops. |i32_mask| is the register mask of frames
+// executing the function (see iree_vm_registers_t). |host_allocator| is used
+// for scratch memory during compilation. Returns IREE_STATUS_UNAVAILABLE if
+// the host is unsupported and IREE_STATUS_UNIMPLEMENTED if the block at
+// |entry_pc| begins with an op the JIT does not handle. The region must be
+// released with iree_vm_bytecode_jit_region_deinitialize.
+iree_status_t iree_vm_bytecode_jit_compile_region(
+    iree_const_byte_span_t function_bytecode, uint32_t entry_pc,
+    uint16_t i32_mask, iree_allocator_t host_allocator,
+    iree_vm_bytecode_jit_region_t* out_region);
+
+// Releases the executable pages of |region|.
+void iree_vm_bytecode_jit_region_deinitialize(
+    iree_vm_bytecode_jit_region_t* region);
+
+//===----------------------------------------------------------------------===//
+// iree_vm_bytecode_jit_t
+//===----------------------------------------------------------------------===//
+
+// Per-module hotness counters and compiled regions.
+// Thread-safe: modules are shared by all contexts using them.
+typedef struct iree_vm_bytecode_jit_t iree_vm_bytecode_jit_t;
+
+// Creates the JIT state for a module with |function_count| internal functions.
+iree_status_t iree_vm_bytecode_jit_create(iree_host_size_t function_count,
+                                          iree_allocator_t allocator,
+                                          iree_vm_bytecode_jit_t** out_jit);
+
+// Destroys |jit| and all its compiled regions.
+void iree_vm_bytecode_jit_destroy(iree_vm_bytecode_jit_t* jit);
+
+// Records a backward branch to |target_pc| in the internal function
+// |function_ordinal| and returns the native code to enter at |target_pc|, if
+// any. The function is compiled from |function_bytecode| once it is hot. Each
+// function has a single compiled region entered at the first hot loop header;
+// branches to other loop headers keep interpreting.
+iree_vm_bytecode_jit_entry_fn_t iree_vm_bytecode_jit_lookup(
+    iree_vm_bytecode_jit_t* jit, uint32_t function_ordinal,
+    iree_const_byte_span_t function_bytecode, uint32_t target_pc,
+    uint16_t i32_mask);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_BYTECODE_JIT_H_
@@ -0,0 +1,345 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode_jit.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/generated/bytecode_op_table.h"
+#include "iree/vm/ref.h"
+// ops.h depends on ref.h.
+#include "iree/vm/ops.h"
+
+namespace {
+
+// Assembles function bytecode in the encoding decoded by the VM_Dec* macros.
+class BytecodeBuilder {
+ public:
+  uint32_t pc() const { return static_cast<uint32_t>(data_.size()); }
+
+  BytecodeBuilder& Op(uint8_t opcode) { return U8(opcode); }
+  BytecodeBuilder& U8(uint8_t value) {
+    data_.push_back(value);
+    return *this;
+  }
+  BytecodeBuilder& Reg(uint16_t reg) {
+    U8(reg & 0xFF);
+    return U8(reg >> 8);
+  }
+  BytecodeBuilder& I32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) U8((value >> (8 * i)) & 0xFF);
+    return *this;
+  }
+  BytecodeBuilder& Remap(
+      const std::vector<std::pair<uint16_t, uint16_t>>& pairs) {
+    if (data_.size() % 2) U8(0);
+    Reg(static_cast<uint16_t>(pairs.size()));
+    for (const auto& pair : pairs) Reg(pair.first).Reg(pair.second);
+    return *this;
+  }
+
+  // Emits a placeholder branch target to be set with Patch.
+  uint32_t Target() {
+    uint32_t offset = pc();
+    I32(0);
+    return offset;
+  }
+  void Patch(uint32_t offset, uint32_t target_pc) {
+    for (int i = 0; i < 4; ++i) data_[offset + i] = (target_pc >> (8 * i));
+  }
+
+  BytecodeBuilder& Binary(uint8_t opcode, uint16_t lhs, uint16_t rhs,
+                          uint16_t result) {
+    return Op(opcode).Reg(lhs).Reg(rhs).Reg(result);
+  }
+
+  iree_const_byte_span_t span() const {
+    return iree_make_const_byte_span(data_.data(), data_.size());
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+class VMBytecodeJitTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!iree_vm_bytecode_jit_is_supported()) {
+      GTEST_SKIP() << "bytecode JIT not supported on this host";
+    }
+  }
+  void TearDown() override {
+    iree_vm_bytecode_jit_region_deinitialize(&region_);
+  }
+
+  void Compile(const BytecodeBuilder& builder, uint32_t entry_pc,
+               uint16_t i32_mask = 15) {
+    IREE_ASSERT_OK(iree_vm_bytecode_jit_compile_region(
+        builder.span(), entry_pc, i32_mask, iree_allocator_system(),
+        &region_));
+    ASSERT_EQ(region_.entry_pc, entry_pc);
+  }
+
+  iree_vm_bytecode_jit_region_t region_ = {};
+};
+
+TEST_F(VMBytecodeJitTest, BinaryOps) {
+  struct {
+    uint8_t opcode;
+    int32_t (*reference)(int32_t, int32_t);
+  } ops[] = {
+      {IREE_VM_OP_CORE_AddI32, vm_add_i32},
+      {IREE_VM_OP_CORE_SubI32, vm_sub_i32},
+      {IREE_VM_OP_CORE_MulI32, vm_mul_i32},
+      {IREE_VM_OP_CORE_AndI32, vm_and_i32},
+      {IREE_VM_OP_CORE_OrI32, vm_or_i32},
+      {IREE_VM_OP_CORE_XorI32, vm_xor_i32},
+      {IREE_VM_OP_CORE_ShlI32, vm_shl_i32},
+      {IREE_VM_OP_CORE_ShrI32S, vm_shr_i32s},
+      {IREE_VM_OP_CORE_ShrI32U, vm_shr_i32u},
+      {IREE_VM_OP_CORE_CmpEQI32, vm_cmp_eq_i32},
+      {IREE_VM_OP_CORE_CmpNEI32, vm_cmp_ne_i32},
+      {IREE_VM_OP_CORE_CmpLTI32S, vm_cmp_lt_i32s},
+      {IREE_VM_OP_CORE_CmpLTI32U, vm_cmp_lt_i32u},
+  };
+  const int32_t values[] = {0, 1, -1, 7, 31, 33, -100, INT32_MAX, INT32_MIN};
+  for (const auto& op : ops) {
+    BytecodeBuilder builder;
+    builder.Binary(op.opcode, 1, 2, 3);
+    uint32_t exit_pc = builder.pc();
+    builder.Op(IREE_VM_OP_CORE_Return);
+    iree_vm_bytecode_jit_region_deinitialize(&region_);
+    Compile(builder, 0);
+    for (int32_t lhs : values) {
+      for (int32_t rhs : values) {
+        int32_t regs[16] = {0};
+        regs[1] = lhs;
+        regs[2] = rhs;
+        EXPECT_EQ(region_.entry(regs), exit_pc);
+        EXPECT_EQ(regs[3], op.reference(lhs, rhs))
+            << "opcode=" << int(op.opcode) << " lhs=" << lhs
+            << " rhs=" << rhs;
+        EXPECT_EQ(regs[1], lhs);
+        EXPECT_EQ(regs[2], rhs);
+      }
+    }
+  }
+}
+
+TEST_F(VMBytecodeJitTest, UnaryOpsAndConstants) {
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_NotI32).Reg(0).Reg(4);
+  builder.Op(IREE_VM_OP_CORE_CmpNZI32).Reg(0).Reg(5);
+  builder.Op(IREE_VM_OP_CORE_CmpNZI32).Reg(1).Reg(6);
+  builder.Op(IREE_VM_OP_CORE_ConstI32).I32(0xDEADBEEFu).Reg(7);
+  builder.Op(IREE_VM_OP_CORE_ConstI32Zero).Reg(8);
+  builder.Op(IREE_VM_OP_CORE_SelectI32).Reg(0).Reg(2).Reg(3).Reg(9);
+  builder.Op(IREE_VM_OP_CORE_SelectI32).Reg(1).Reg(2).Reg(3).Reg(10);
+  uint32_t exit_pc = builder.pc();
+  builder.Op(IREE_VM_OP_CORE_Return);
+  Compile(builder, 0);
+  int32_t regs[16] = {0};
+  regs[0] = 0x1234;
+  regs[1] = 0;
+  regs[2] = 20;
+  regs[3] = 30;
+  regs[8] = 99;
+  EXPECT_EQ(region_.entry(regs), exit_pc);
+  EXPECT_EQ(regs[4], vm_not_i32(0x1234));
+  EXPECT_EQ(regs[5], 1);
+  EXPECT_EQ(regs[6], 0);
+  EXPECT_EQ(regs[7], static_cast<int32_t>(0xDEADBEEFu));
+  EXPECT_EQ(regs[8], 0);
+  EXPECT_EQ(regs[9], 20);
+  EXPECT_EQ(regs[10], 30);
+}
+
+// Register ordinals are masked like in the interpreter.
+TEST_F(VMBytecodeJitTest, RegisterMasking) {
+  BytecodeBuilder builder;
+  builder.Binary(IREE_VM_OP_CORE_AddI32, 1 + 8, 2 + 16, 3 + 0x8000);
+  uint32_t exit_pc = builder.pc();
+  builder.Op(IREE_VM_OP_CORE_Return);
+  Compile(builder, 0, /*i32_mask=*/7);
+  int32_t regs[8] = {0, 5, 6, 0, 0, 0, 0, 0};
+  EXPECT_EQ(region_.entry(regs), exit_pc);
+  EXPECT_EQ(regs[3], 11);
+}
+
+// A counted loop whose header is the region entry:
+//   ^entry: %sum = 0; %i = 0; br ^header
+//   ^header: %c = cmp.lt.i32.s %i, %n; cond_br %c, ^body, ^exit
+//   ^body: %sum' = add %sum, %i; %i' = add %i, %one; br ^header(%sum'->%sum)
+//   ^exit: return
+TEST_F(VMBytecodeJitTest, Loop) {
+  enum { kN = 0, kI = 1, kSum = 2, kOne = 3, kCond = 4, kNext = 5 };
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_ConstI32Zero).Reg(kSum);
+  builder.Op(IREE_VM_OP_CORE_ConstI32Zero).Reg(kI);
+  builder.Op(IREE_VM_OP_CORE_ConstI32).I32(1).Reg(kOne);
+  builder.Op(IREE_VM_OP_CORE_Branch);
+  uint32_t entry_target = builder.Target();
+  builder.Remap({});
+  uint32_t header_pc = builder.pc();
+  builder.Patch(entry_target, header_pc);
+  builder.Binary(IREE_VM_OP_CORE_CmpLTI32S, kI, kN, kCond);
+  builder.Op(IREE_VM_OP_CORE_CondBranch).Reg(kCond);
+  uint32_t body_target = builder.Target();
+  builder.Remap({});
+  uint32_t exit_target = builder.Target();
+  builder.Remap({});
+  uint32_t body_pc = builder.pc();
+  builder.Patch(body_target, body_pc);
+  builder.Binary(IREE_VM_OP_CORE_AddI32, kSum, kI, kNext);
+  builder.Binary(IREE_VM_OP_CORE_AddI32, kI, kOne, kI);
+  builder.Op(IREE_VM_OP_CORE_Branch);
+  uint32_t back_target = builder.Target();
+  builder.Remap({{kNext, kSum}});
+  builder.Patch(back_target, header_pc);
+  uint32_t exit_pc = builder.pc();
+  builder.Patch(exit_target, exit_pc);
+  builder.Op(IREE_VM_OP_CORE_Return);
+
+  Compile(builder, header_pc);
+  for (int32_t n : {0, 1, 10, 1000}) {
+    int32_t regs[16] = {0};
+    regs[kN] = n;
+    regs[kOne] = 1;
+    EXPECT_EQ(region_.entry(regs), exit_pc);
+    EXPECT_EQ(regs[kI], n);
+    EXPECT_EQ(regs[kSum], n * (n - 1) / 2);
+  }
+}
+
+// Fused compare-and-branch ops take the true path when the comparison holds.
+TEST_F(VMBytecodeJitTest, FusedCompareBranches) {
+  struct {
+    uint8_t opcode;
+    int32_t lhs;
+    int32_t rhs;
+    bool expected;
+  } cases[] = {
+      {IREE_VM_OP_CORE_CondBranchEQI32, 3, 3, true},
+      {IREE_VM_OP_CORE_CondBranchEQI32, 3, 4, false},
+      {IREE_VM_OP_CORE_CondBranchNEI32, 3, 4, true},
+      {IREE_VM_OP_CORE_CondBranchNEI32, 3, 3, false},
+      {IREE_VM_OP_CORE_CondBranchLTI32S, -1, 0, true},
+      {IREE_VM_OP_CORE_CondBranchLTI32S, 0, -1, false},
+      {IREE_VM_OP_CORE_CondBranchLTI32U, 0, -1, true},
+      {IREE_VM_OP_CORE_CondBranchLTI32U, -1, 0, false},
+  };
+  for (const auto& test_case : cases) {
+    BytecodeBuilder builder;
+    builder.Op(test_case.opcode).Reg(0).Reg(1);
+    uint32_t true_target = builder.Target();
+    builder.Remap({{0, 2}});
+    uint32_t false_target = builder.Target();
+    builder.Remap({});
+    uint32_t true_pc = builder.pc();
+    builder.Patch(true_target, true_pc);
+    builder.Op(IREE_VM_OP_CORE_Return);
+    uint32_t false_pc = builder.pc();
+    builder.Patch(false_target, false_pc);
+    builder.Op(IREE_VM_OP_CORE_Return);
+
+    Compile(builder, 0);
+    int32_t regs[16] = {0};
+    regs[0] = test_case.lhs;
+    regs[1] = test_case.rhs;
+    EXPECT_EQ(region_.entry(regs), test_case.expected ? true_pc : false_pc);
+    EXPECT_EQ(regs[2], test_case.expected ? test_case.lhs : 0);
+    iree_vm_bytecode_jit_region_deinitialize(&region_);
+  }
+}
+
+// Branches that move ref registers are left to the interpreter.
+TEST_F(VMBytecodeJitTest, RefRemapExits) {
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_ConstI32).I32(42).Reg(1);
+  uint32_t branch_pc = builder.pc();
+  builder.Op(IREE_VM_OP_CORE_Branch);
+  builder.Patch(builder.Target(), 0);
+  builder.Remap({{0x8000 | 0, 0x8000 | 1}});
+  Compile(builder, 0);
+  int32_t regs[16] = {0};
+  EXPECT_EQ(region_.entry(regs), branch_pc);
+  EXPECT_EQ(regs[1], 42);
+}
+
+// Ops running past the end of the function are left to the interpreter.
+TEST_F(VMBytecodeJitTest, TruncatedOpExits) {
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_ConstI32).I32(42).Reg(1);
+  uint32_t truncated_pc = builder.pc();
+  builder.Op(IREE_VM_OP_CORE_AddI32).Reg(1);
+  Compile(builder, 0);
+  int32_t regs[16] = {0};
+  EXPECT_EQ(region_.entry(regs), truncated_pc);
+  EXPECT_EQ(regs[1], 42);
+}
+
+TEST_F(VMBytecodeJitTest, UnhandledEntryOp) {
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_Return);
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_UNIMPLEMENTED,
+      iree_vm_bytecode_jit_compile_region(builder.span(), 0, 15,
+                                          iree_allocator_system(), &region_));
+}
+
+// Functions are compiled once they have taken enough backward branches and
+// only entered at the loop header they were compiled for.
+TEST_F(VMBytecodeJitTest, LookupTiersUpHotFunctions) {
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_ConstI32).I32(7).Reg(0);
+  uint32_t exit_pc = builder.pc();
+  builder.Op(IREE_VM_OP_CORE_Return);
+
+  iree_vm_bytecode_jit_t* jit = NULL;
+  IREE_ASSERT_OK(
+      iree_vm_bytecode_jit_create(/*function_count=*/2,
+                                  iree_allocator_system(), &jit));
+  iree_vm_bytecode_jit_entry_fn_t entry = NULL;
+  int lookup_count = 0;
+  while (!entry && lookup_count < 1000000) {
+    entry = iree_vm_bytecode_jit_lookup(jit, 1, builder.span(), 0, 15);
+    ++lookup_count;
+  }
+  ASSERT_NE(entry, nullptr);
+  EXPECT_GT(lookup_count, 1);
+  int32_t regs[16] = {0};
+  EXPECT_EQ(entry(regs), exit_pc);
+  EXPECT_EQ(regs[0], 7);
+  EXPECT_EQ(iree_vm_bytecode_jit_lookup(jit, 1, builder.span(), 0, 15), entry);
+  EXPECT_EQ(iree_vm_bytecode_jit_lookup(jit, 1, builder.span(), exit_pc, 15),
+            nullptr);
+  // Other functions keep their own counters.
+  EXPECT_EQ(iree_vm_bytecode_jit_lookup(jit, 0, builder.span(), 0, 15),
+            nullptr);
+  iree_vm_bytecode_jit_destroy(jit);
+}
+
+// Functions that fail to compile stay interpreted.
+TEST_F(VMBytecodeJitTest, LookupUnhandledFunction) {
+  BytecodeBuilder builder;
+  builder.Op(IREE_VM_OP_CORE_Return);
+  iree_vm_bytecode_jit_t* jit = NULL;
+  IREE_ASSERT_OK(
+      iree_vm_bytecode_jit_create(/*function_count=*/1,
+                                  iree_allocator_system(), &jit));
+  for (int i = 0; i < 100000; ++i) {
+    ASSERT_EQ(iree_vm_bytecode_jit_lookup(jit, 0, builder.span(), 0, 15),
+              nullptr);
+  }
+  iree_vm_bytecode_jit_destroy(jit);
+}
+
+}  // namespace
@@ -243,7 +243,8 @@ static iree_status_t iree_vm_bytecode_module_resolve_types(
 static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     iree_const_byte_span_t archive_contents,
     iree_const_byte_span_t flatbuffer_contents,
-    iree_host_size_t archive_rodata_offset) {
+    iree_host_size_t archive_rodata_offset,
+    const iree_vm_bytecode_module_options_t* options) {
   // Run flatcc generated verification. This ensures all pointers are in-bounds
   // and that we can safely walk the file, but not that the actual contents of
   // the FlatBuffer meet our expectations.
@@ -284,6 +285,36 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
        ++i) {
     iree_vm_RodataSegmentDef_table_t segment =
         iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    iree_vm_CompressionTypeDef_union_t compression_type =
+        iree_vm_RodataSegmentDef_compression_type_union(segment);
+    switch (compression_type.type) {
+      case iree_vm_CompressionTypeDef_NONE:
+      case iree_vm_CompressionTypeDef_UncompressedDataDef:
+        break;
+      case iree_vm_CompressionTypeDef_ZstdDataDef: {
+        if (!options->decompressor.fn) {
+          return iree_make_status(
+              IREE_STATUS_FAILED_PRECONDITION,
+              "rodata[%zu] is zstd compressed but no decompressor was "
+              "provided",
+              i);
+        }
+        uint64_t uncompressed_length = iree_vm_ZstdDataDef_uncompressed_length(
+            (iree_vm_ZstdDataDef_table_t)compression_type.value);
+        if (uncompressed_length > IREE_HOST_SIZE_MAX) {
+          return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                  "rodata[%zu] uncompressed length %" PRIu64
+                                  " exceeds the host size",
+                                  i, uncompressed_length);
+        }
+        break;
+      }
+      default:
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "rodata[%zu] has unsupported compression type "
+                                "%u",
+                                i, (uint32_t)compression_type.type);
+    }
     if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
       continue;  // embedded data is verified by FlatBuffers
     }
@@ -291,6 +322,23 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
         iree_vm_RodataSegmentDef_external_data_offset(segment);
     uint64_t segment_length =
         iree_vm_RodataSegmentDef_external_data_length(segment);
+    if (iree_vm_RodataSegmentDef_external_file(segment)) {
+      if (!options->external_rodata.data) {
+        return iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "rodata[%zu] references an external rodata file but none was "
+            "provided",
+            i);
+      }
+      uint64_t segment_end = segment_offset + segment_length;
+      if (segment_end < segment_offset ||
+          segment_end > options->external_rodata.data_length) {
+        return iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "rodata[%zu] external file reference out of range", i);
+      }
+      continue;
+    }
     uint64_t segment_end =
         archive_rodata_offset + segment_offset + segment_length;
     if (segment_end > archive_contents.data_length) {
@@ -452,6 +500,18 @@ static void iree_vm_bytecode_module_destroy(void* self) {
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  iree_vm_bytecode_jit_destroy(module->jit);
+  module->jit = NULL;
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+
+  iree_vm_bytecode_module_deinitialize_lazy_rodata(module);
+
+  iree_allocator_free(module->external_rodata_allocator,
+                      (void*)module->external_rodata.data);
+  module->external_rodata = iree_const_byte_span_empty();
+  module->external_rodata_allocator = iree_allocator_null();
+
   module->def = NULL;
   iree_allocator_free(module->archive_allocator,
                       (void*)module->archive_contents.data);
@@ -883,6 +943,127 @@ static iree_status_t iree_vm_bytecode_module_resolve_source_location(
   return iree_ok_status();
 }
 
+// Returns the stored (possibly compressed) contents of a rodata |segment|.
+// The referenced range must have been verified to be in bounds.
+static iree_const_byte_span_t iree_vm_bytecode_module_rodata_segment_data(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_RodataSegmentDef_table_t segment) {
+  if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
+    // Data is embedded in the FlatBuffer.
+    flatbuffers_uint8_vec_t embedded_data =
+        iree_vm_RodataSegmentDef_embedded_data(segment);
+    return iree_make_const_byte_span(embedded_data,
+                                     flatbuffers_uint8_vec_len(embedded_data));
+  } else if (iree_vm_RodataSegmentDef_external_file(segment)) {
+    // Data is in the external rodata file at some absolute offset.
+    return iree_make_const_byte_span(
+        module->external_rodata.data +
+            iree_vm_RodataSegmentDef_external_data_offset(segment),
+        iree_vm_RodataSegmentDef_external_data_length(segment));
+  }
+  // Data is concatenated with the FlatBuffer at some relative offset.
+  return iree_make_const_byte_span(
+      module->archive_contents.data + module->archive_rodata_offset +
+          iree_vm_RodataSegmentDef_external_data_offset(segment),
+      iree_vm_RodataSegmentDef_external_data_length(segment));
+}
+
+// Allocates the |module| lazy rodata table if any segments are compressed.
+// Decompression is deferred until the segments are first accessed.
+static iree_status_t iree_vm_bytecode_module_initialize_lazy_rodata(
+    iree_vm_bytecode_module_t* module) {
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module->def);
+  iree_host_size_t rodata_count =
+      iree_vm_RodataSegmentDef_vec_len(rodata_segments);
+  bool any_compressed = false;
+  for (iree_host_size_t i = 0; i < rodata_count; ++i) {
+    if (iree_vm_RodataSegmentDef_compression_type_type(
+            iree_vm_RodataSegmentDef_vec_at(rodata_segments, i)) ==
+        iree_vm_CompressionTypeDef_ZstdDataDef) {
+      any_compressed = true;
+      break;
+    }
+  }
+  if (!any_compressed) return iree_ok_status();
+
+  iree_vm_bytecode_lazy_rodata_t* lazy_rodata_table = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      module->allocator, rodata_count * sizeof(*lazy_rodata_table),
+      (void**)&lazy_rodata_table));
+  for (iree_host_size_t i = 0; i < rodata_count; ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    iree_vm_bytecode_lazy_rodata_t* lazy_rodata = &lazy_rodata_table[i];
+    iree_vm_CompressionTypeDef_union_t compression_type =
+        iree_vm_RodataSegmentDef_compression_type_union(segment);
+    if (compression_type.type != iree_vm_CompressionTypeDef_ZstdDataDef) {
+      continue;  // zero-initialized as NONE
+    }
+    lazy_rodata->compression = IREE_VM_BYTECODE_RODATA_COMPRESSION_ZSTD;
+    lazy_rodata->source_data =
+        iree_vm_bytecode_module_rodata_segment_data(module, segment);
+    lazy_rodata->uncompressed_length =
+        (iree_host_size_t)iree_vm_ZstdDataDef_uncompressed_length(
+            (iree_vm_ZstdDataDef_table_t)compression_type.value);
+  }
+  module->lazy_rodata_table = lazy_rodata_table;
+  return iree_ok_status();
+}
+
+// Releases all decompressed rodata and the |module| lazy rodata table.
+static void iree_vm_bytecode_module_deinitialize_lazy_rodata(
+    iree_vm_bytecode_module_t* module) {
+  if (!module->lazy_rodata_table) return;
+  iree_host_size_t rodata_count = iree_vm_RodataSegmentDef_vec_len(
+      iree_vm_BytecodeModuleDef_rodata_segments(module->def));
+  for (iree_host_size_t i = 0; i < rodata_count; ++i) {
+    iree_vm_buffer_t* buffer = (iree_vm_buffer_t*)iree_atomic_load_intptr(
+        &module->lazy_rodata_table[i].buffer, iree_memory_order_acquire);
+    iree_vm_buffer_release(buffer);
+  }
+  iree_allocator_free(module->allocator, module->lazy_rodata_table);
+  module->lazy_rodata_table = NULL;
+}
+
+iree_status_t iree_vm_bytecode_module_resolve_lazy_rodata(
+    iree_vm_bytecode_module_t* module, iree_host_size_t ordinal,
+    iree_vm_buffer_t** out_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_bytecode_lazy_rodata_t* lazy_rodata =
+      &module->lazy_rodata_table[ordinal];
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)lazy_rodata->uncompressed_length);
+
+  // Decompress into a new read-only module-owned buffer. Multiple threads may
+  // race to resolve the same segment; only one wins and the others drop their
+  // copy.
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_buffer_create(IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE,
+                                lazy_rodata->uncompressed_length,
+                                module->allocator, &buffer));
+  iree_status_t status = module->decompressor.fn(
+      module->decompressor.user_data, lazy_rodata->compression,
+      lazy_rodata->source_data, iree_vm_buffer_data(buffer));
+  if (!iree_status_is_ok(status)) {
+    iree_vm_buffer_release(buffer);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_status_annotate_f(status, "decompressing rodata[%" PRIhsz "]",
+                                  ordinal);
+  }
+
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_intptr(
+          &lazy_rodata->buffer, &expected, (intptr_t)buffer,
+          iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+    iree_vm_buffer_release(buffer);
+    buffer = (iree_vm_buffer_t*)expected;
+  }
+  *out_buffer = buffer;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 // Lays out the nested tables within a |state| structure.
 // Returns the total size of the structure and all tables with padding applied.
 // |state| may be null if only the structure size is required for allocation.
@@ -961,26 +1142,19 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   iree_vm_bytecode_module_layout_state(module_def, state);
 
   // Setup rodata segments to point directly at the FlatBuffer memory.
+  // Compressed segments are shared across states and resolved lazily.
   iree_vm_RodataSegmentDef_vec_t rodata_segments =
       iree_vm_BytecodeModuleDef_rodata_segments(module_def);
   for (int i = 0; i < state->rodata_ref_count; ++i) {
-    iree_vm_RodataSegmentDef_table_t segment =
-        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
     iree_byte_span_t byte_span = iree_byte_span_empty();
-    if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
-      // Data is embedded in the FlatBuffer.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)iree_vm_RodataSegmentDef_embedded_data(segment),
-          flatbuffers_uint8_vec_len(
-              iree_vm_RodataSegmentDef_embedded_data(segment)));
-    } else {
-      // Data is concatenated with the FlatBuffer at some relative offset.
-      // Note that we've already verified the referenced range is in bounds.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)module->archive_contents.data +
-              module->archive_rodata_offset +
-              iree_vm_RodataSegmentDef_external_data_offset(segment),
-          iree_vm_RodataSegmentDef_external_data_length(segment));
+    if (!module->lazy_rodata_table ||
+        module->lazy_rodata_table[i].compression ==
+            IREE_VM_BYTECODE_RODATA_COMPRESSION_NONE) {
+      iree_const_byte_span_t segment_data =
+          iree_vm_bytecode_module_rodata_segment_data(
+              module, iree_vm_RodataSegmentDef_vec_at(rodata_segments, i));
+      byte_span = iree_make_byte_span((uint8_t*)segment_data.data,
+                                      segment_data.data_length);
     }
     iree_vm_buffer_t* ref = &state->rodata_ref_table[i];
     iree_vm_buffer_initialize(IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE, byte_span,
@@ -1016,6 +1190,48 @@ static void iree_vm_bytecode_module_free_state(
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t iree_vm_bytecode_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_module_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  IREE_ASSERT_ARGUMENT(parent_module_state);
+  IREE_ASSERT_ARGUMENT(out_module_state);
+  *out_module_state = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_alloc_state(self, allocator, &module_state));
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)module_state;
+  const iree_vm_bytecode_module_state_t* parent_state =
+      (const iree_vm_bytecode_module_state_t*)parent_module_state;
+
+  // Primitive globals are copied so that the fork can update them without
+  // affecting the parent.
+  memcpy(state->rwdata_storage.data, parent_state->rwdata_storage.data,
+         state->rwdata_storage.data_length);
+
+  // Ref globals are shared with the parent: the constant buffers and
+  // executables created by the initializer are not duplicated. Storing to a
+  // ref global only updates the fork's own table. References to rodata
+  // segments point into the parent state and are rebased onto the fork's.
+  const iree_vm_buffer_t* parent_rodata_begin = parent_state->rodata_ref_table;
+  const iree_vm_buffer_t* parent_rodata_end =
+      parent_rodata_begin + parent_state->rodata_ref_count;
+  for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_t ref = parent_state->global_ref_table[i];
+    const iree_vm_buffer_t* ptr = (const iree_vm_buffer_t*)ref.ptr;
+    if (ptr >= parent_rodata_begin && ptr < parent_rodata_end) {
+      ref.ptr = &state->rodata_ref_table[ptr - parent_rodata_begin];
+    }
+    iree_vm_ref_retain(&ref, &state->global_ref_table[i]);
+  }
+
+  *out_module_state = module_state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -1057,6 +1273,15 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
   import->argument_buffer_size = (uint16_t)argument_buffer_size;
   import->result_buffer_size = (uint16_t)result_buffer_size;
 
+  // Bind directly to native functions when possible. The import table is
+  // populated once per context so the lookup cost is not paid per call.
+  iree_status_t lookup_status = iree_vm_native_module_lookup_function_ptr(
+      import->function, &import->native_function);
+  if (!iree_status_is_ok(lookup_status)) {
+    iree_status_ignore(lookup_status);
+    import->native_function = NULL;
+  }
+
   return iree_ok_status();
 }
 
@@ -1118,11 +1343,32 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+IREE_API_EXPORT void iree_vm_bytecode_module_options_initialize(
+    iree_vm_bytecode_module_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->external_rodata = iree_const_byte_span_empty();
+  out_options->external_rodata_allocator = iree_allocator_null();
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  return iree_vm_bytecode_module_create_with_options(
+      instance, archive_contents, archive_allocator, &options, allocator,
+      out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
+    iree_allocator_t archive_allocator,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
 
@@ -1135,7 +1381,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
 
   IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_module_flatbuffer_verify");
   iree_status_t status = iree_vm_bytecode_module_flatbuffer_verify(
-      archive_contents, flatbuffer_contents, archive_rodata_offset);
+      archive_contents, flatbuffer_contents, archive_rodata_offset, options);
   if (!iree_status_is_ok(status)) {
     IREE_TRACE_ZONE_END(z1);
     IREE_TRACE_ZONE_END(z0);
@@ -1177,6 +1423,10 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   module->archive_contents = archive_contents;
   module->archive_allocator = archive_allocator;
   module->archive_rodata_offset = archive_rodata_offset;
+  module->external_rodata = options->external_rodata;
+  module->external_rodata_allocator = options->external_rodata_allocator;
+  module->decompressor = options->decompressor;
+  module->lazy_rodata_table = NULL;
   module->def = module_def;
 
   module->type_count = iree_vm_TypeDef_vec_len(type_defs);
@@ -1188,6 +1438,26 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     return resolve_status;
   }
 
+  iree_status_t rodata_status =
+      iree_vm_bytecode_module_initialize_lazy_rodata(module);
+  if (!iree_status_is_ok(rodata_status)) {
+    iree_allocator_free(allocator, module);
+    IREE_TRACE_ZONE_END(z0);
+    return rodata_status;
+  }
+
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  module->jit = NULL;
+  iree_status_t jit_status = iree_vm_bytecode_jit_create(
+      module->function_descriptor_count, allocator, &module->jit);
+  if (!iree_status_is_ok(jit_status)) {
+    iree_vm_bytecode_module_deinitialize_lazy_rodata(module);
+    iree_allocator_free(allocator, module);
+    IREE_TRACE_ZONE_END(z0);
+    return jit_status;
+  }
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+
   iree_vm_module_initialize(&module->interface, module);
   module->interface.destroy = iree_vm_bytecode_module_destroy;
   module->interface.name = iree_vm_bytecode_module_name;
@@ -1204,6 +1474,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
       iree_vm_bytecode_module_resolve_source_location;
 #endif  // IREE_VM_BACKTRACE_ENABLE
   module->interface.alloc_state = iree_vm_bytecode_module_alloc_state;
+  module->interface.fork_state = iree_vm_bytecode_module_fork_state;
   module->interface.free_state = iree_vm_bytecode_module_free_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
   module->interface.notify = iree_vm_bytecode_module_notify;
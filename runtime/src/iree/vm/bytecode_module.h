@@ -16,15 +16,74 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Compression formats rodata segments may be stored in.
+typedef enum iree_vm_bytecode_rodata_compression_e {
+  IREE_VM_BYTECODE_RODATA_COMPRESSION_NONE = 0,
+  // Single zstd frame (--iree-vm-bytecode-module-rodata-compression=zstd).
+  IREE_VM_BYTECODE_RODATA_COMPRESSION_ZSTD = 1,
+} iree_vm_bytecode_rodata_compression_t;
+
+// Decompresses |source_data| in the given |compression| format into
+// |target_data|. The target buffer is exactly the uncompressed length
+// recorded in the module and must be entirely populated.
+// May be called from any thread concurrently.
+typedef iree_status_t(IREE_API_PTR* iree_vm_bytecode_rodata_decompress_fn_t)(
+    void* user_data, iree_vm_bytecode_rodata_compression_t compression,
+    iree_const_byte_span_t source_data, iree_byte_span_t target_data);
+
+// Decompressor used for compressed rodata segments.
+// The runtime does not carry any decompression libraries itself and hosting
+// applications that load modules with compressed rodata must provide one.
+typedef struct iree_vm_bytecode_rodata_decompressor_t {
+  iree_vm_bytecode_rodata_decompress_fn_t fn;
+  void* user_data;
+} iree_vm_bytecode_rodata_decompressor_t;
+
+// Options controlling how a bytecode module is loaded.
+typedef struct iree_vm_bytecode_module_options_t {
+  // Contents of the external rodata file referenced by segments that were
+  // compiled with --iree-vm-bytecode-module-external-rodata-path. Usually a
+  // read-only mapping of the file so that segments are accessed in-place
+  // without copies. Must remain valid for the lifetime of the module.
+  // Modules compiled with --iree-vm-bytecode-module-external-rodata-shared
+  // against the same file may all be given the same mapping.
+  iree_const_byte_span_t external_rodata;
+  // Used to free the |external_rodata| when the module is destroyed, if any.
+  iree_allocator_t external_rodata_allocator;
+
+  // Decompressor used on first access to compressed rodata segments.
+  // Modules with compressed segments fail to load if not provided.
+  iree_vm_bytecode_rodata_decompressor_t decompressor;
+} iree_vm_bytecode_module_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_vm_bytecode_module_options_initialize(
+    iree_vm_bytecode_module_options_t* out_options);
+
 // Creates a VM module from an in-memory ModuleDef FlatBuffer archive.
 // If a |archive_allocator| is provided then it will be used to free the
 // |archive_contents| when the module is destroyed and otherwise the ownership
 // of the memory remains with the caller.
+//
+// Uncompressed rodata segments reference the archive contents directly and
+// are never copied.
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module as with iree_vm_bytecode_module_create with additional
+// |options| controlling rodata resolution. Ownership of the external rodata in
+// |options| is transferred to the module on success only.
+//
+// Compressed rodata segments are decompressed once per module on first access
+// and shared across all contexts the module is loaded into.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
+    iree_allocator_t archive_allocator,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
 // Parses the module archive header in |archive_contents|.
 // The subrange containing the FlatBuffer data is returned as well as the
 // offset where external rodata begins. Note that archives may have
@@ -16,7 +16,10 @@
 #endif  // _MSC_VER
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/vm/api.h"
+#include "iree/vm/bytecode_jit.h"
+#include "iree/vm/bytecode_module.h"
 
 // NOTE: include order matters:
 #include "iree/base/internal/flatcc/parsing.h"
@@ -39,7 +42,10 @@ extern "C" {
 // Higher versions are disallowed as they occur when new ops are added that
 // otherwise cannot be executed by older runtimes.
 // Matches BytecodeEncoder::kVersionMinor in the compiler.
-#define IREE_VM_BYTECODE_VERSION_MINOR 0
+//
+// Minor version history:
+//   1: fused i32 compare-and-branch ops (CondBranch{EQ,NE,LTI32S,LTI32U}I32).
+#define IREE_VM_BYTECODE_VERSION_MINOR 1
 
 // Maximum register count per bank.
 // This determines the bits required to reference registers in the VM bytecode.
@@ -52,6 +58,19 @@ extern "C" {
 #define IREE_REF_REGISTER_MOVE_BIT 0x4000
 #define IREE_REF_REGISTER_MASK 0x3FFF
 
+// A rodata segment that is decompressed on first access.
+// Decompressed contents are shared by all states of the module.
+typedef struct iree_vm_bytecode_lazy_rodata_t {
+  // Compression format of |source_data| or NONE if the segment is not lazy.
+  iree_vm_bytecode_rodata_compression_t compression;
+  // Compressed contents in the archive or external rodata.
+  iree_const_byte_span_t source_data;
+  // Total size of the decompressed contents in bytes.
+  iree_host_size_t uncompressed_length;
+  // iree_vm_buffer_t* with the decompressed contents or 0 if not yet resolved.
+  iree_atomic_intptr_t buffer;
+} iree_vm_bytecode_lazy_rodata_t;
+
 // A loaded bytecode module.
 typedef struct iree_vm_bytecode_module_t {
   // Interface routing to the bytecode module functions.
@@ -80,9 +99,25 @@ typedef struct iree_vm_bytecode_module_t {
   // aligned physical offset where content is located.
   iree_host_size_t archive_rodata_offset;
 
+  // Optional external rodata file and allocator (which may be null).
+  iree_const_byte_span_t external_rodata;
+  iree_allocator_t external_rodata_allocator;
+
+  // Decompressor used to resolve |lazy_rodata_table| entries.
+  iree_vm_bytecode_rodata_decompressor_t decompressor;
+
+  // Lazily decompressed rodata segments indexed by rodata ordinal.
+  // NULL if the module has no compressed segments.
+  iree_vm_bytecode_lazy_rodata_t* lazy_rodata_table;
+
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+#if IREE_VM_BYTECODE_JIT_ENABLE
+  // Hotness counters and native code for the internal functions.
+  iree_vm_bytecode_jit_t* jit;
+#endif  // IREE_VM_BYTECODE_JIT_ENABLE
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -108,6 +143,12 @@ typedef struct iree_vm_bytecode_import_t {
   // don't support variadic values (yet).
   uint16_t argument_buffer_size;
   uint16_t result_buffer_size;
+
+  // Function pointers of the import when it is bound directly to a native
+  // module export or NULL if calls must go through the module interface.
+  // Bound calls skip the begin_call indirection and per-call export validation
+  // which is measurable on hot imports like HAL command buffer recording.
+  const iree_vm_native_function_ptr_t* native_function;
 } iree_vm_bytecode_import_t;
 
 // Per-instance module state.
@@ -124,9 +165,9 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_vm_ref_t* global_ref_table;
 
   // TODO(benvanik): move to iree_vm_bytecode_module_t if always static.
-  // Initialized references to rodata segments.
-  // Right now these don't do much, however we can perform lazy caching and
-  // on-the-fly decompression using this information.
+  // Initialized references to rodata segments pointing directly into the
+  // archive or external rodata. Compressed segments have empty entries here
+  // and are resolved with iree_vm_bytecode_module_resolve_rodata instead.
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
 
@@ -138,6 +179,35 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+// Slow path of iree_vm_bytecode_module_resolve_rodata decompressing the
+// segment |ordinal| on first access.
+iree_status_t iree_vm_bytecode_module_resolve_lazy_rodata(
+    iree_vm_bytecode_module_t* module, iree_host_size_t ordinal,
+    iree_vm_buffer_t** out_buffer);
+
+// Returns the buffer for rodata segment |ordinal| used by vm.const.ref.rodata.
+// The buffer is owned by the module or |state| and must be retained to extend
+// its lifetime. |ordinal| must have been verified to be in range.
+static inline iree_status_t iree_vm_bytecode_module_resolve_rodata(
+    iree_vm_bytecode_module_t* module,
+    const iree_vm_bytecode_module_state_t* state, iree_host_size_t ordinal,
+    iree_vm_buffer_t** out_buffer) {
+  if (IREE_LIKELY(!module->lazy_rodata_table) ||
+      module->lazy_rodata_table[ordinal].compression ==
+          IREE_VM_BYTECODE_RODATA_COMPRESSION_NONE) {
+    *out_buffer = &state->rodata_ref_table[ordinal];
+    return iree_ok_status();
+  }
+  iree_vm_buffer_t* buffer = (iree_vm_buffer_t*)iree_atomic_load_intptr(
+      &module->lazy_rodata_table[ordinal].buffer, iree_memory_order_acquire);
+  if (IREE_LIKELY(buffer)) {
+    *out_buffer = buffer;
+    return iree_ok_status();
+  }
+  return iree_vm_bytecode_module_resolve_lazy_rodata(module, ordinal,
+                                                     out_buffer);
+}
+
 // Begins execution of the current frame and continues until either a yield or
 // return.
 iree_status_t iree_vm_bytecode_dispatch_begin(
@@ -38,6 +38,14 @@ struct iree_vm_context_t {
     iree_vm_module_t** modules;
     iree_vm_module_state_t** module_states;
   } list;
+
+  // Pooled iree_vm_stack_t* available for reuse or 0 if the stack is in use or
+  // has not yet been allocated. A single stack covers the common case of one
+  // thread issuing invocations back-to-back.
+  iree_atomic_intptr_t pooled_stack;
+
+  // Optional profiler sampling invocations into the context.
+  iree_vm_profiler_t* profiler;
 };
 
 static void iree_vm_context_destroy(iree_vm_context_t* context);
@@ -321,6 +329,8 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   context->is_frozen = module_count > 0;
   context->is_static = module_count > 0;
   context->flags = flags;
+  iree_atomic_store_intptr(&context->pooled_stack, 0,
+                           iree_memory_order_relaxed);
 
   uint8_t* p = (uint8_t*)context + sizeof(iree_vm_context_t);
   context->list.modules = (iree_vm_module_t**)p;
@@ -343,6 +353,84 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    iree_vm_context_t* parent_context, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(parent_context);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t module_count = parent_context->list.count;
+  iree_host_size_t context_size =
+      sizeof(iree_vm_context_t) + sizeof(iree_vm_module_t*) * module_count +
+      sizeof(iree_vm_module_state_t*) * module_count;
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, context_size, (void**)&context));
+  iree_atomic_ref_count_init(&context->ref_count);
+  context->instance = parent_context->instance;
+  iree_vm_instance_retain(context->instance);
+  context->allocator = allocator;
+
+  context->context_id = iree_vm_context_allocate_id();
+
+  context->is_frozen = 1;
+  context->is_static = 1;
+  context->flags = parent_context->flags;
+  iree_atomic_store_intptr(&context->pooled_stack, 0,
+                           iree_memory_order_relaxed);
+
+  uint8_t* p = (uint8_t*)context + sizeof(iree_vm_context_t);
+  context->list.modules = (iree_vm_module_t**)p;
+  p += sizeof(iree_vm_module_t*) * module_count;
+  context->list.module_states = (iree_vm_module_state_t**)p;
+  p += sizeof(iree_vm_module_state_t*) * module_count;
+  context->list.count = 0;
+  context->list.capacity = module_count;
+
+  // Fork module state in registration order so that imports resolve against
+  // the fork's own states.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < module_count; ++i) {
+    iree_vm_module_t* module = parent_context->list.modules[i];
+    context->list.modules[i] = module;
+    context->list.module_states[i] = NULL;
+    iree_vm_module_retain(module);
+    ++context->list.count;
+
+    iree_vm_module_state_t* module_state = NULL;
+    if (module->fork_state) {
+      status = module->fork_state(module->self,
+                                  parent_context->list.module_states[i],
+                                  allocator, &module_state);
+    } else {
+      status = module->alloc_state(module->self, allocator, &module_state);
+    }
+    if (!iree_status_is_ok(status)) break;
+    context->list.module_states[i] = module_state;
+
+    status =
+        iree_vm_context_resolve_module_imports(context, module, module_state);
+    if (!iree_status_is_ok(status)) {
+      iree_string_view_t module_name = iree_vm_module_name(module);
+      (void)module_name;
+      status = iree_status_annotate_f(status, "resolving module '%.*s' imports",
+                                      (int)module_name.size, module_name.data);
+      break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_context = context;
+  } else {
+    iree_vm_context_destroy(context);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_vm_context_destroy(iree_vm_context_t* context) {
   if (!context) return;
 
@@ -361,6 +449,13 @@ static void iree_vm_context_destroy(iree_vm_context_t* context) {
     context->list.module_states = NULL;
   }
 
+  iree_vm_stack_t* pooled_stack = (iree_vm_stack_t*)iree_atomic_exchange_intptr(
+      &context->pooled_stack, 0, iree_memory_order_acquire);
+  if (pooled_stack) iree_vm_stack_free(pooled_stack);
+
+  iree_vm_profiler_release(context->profiler);
+  context->profiler = NULL;
+
   iree_vm_instance_release(context->instance);
   context->instance = NULL;
 
@@ -664,6 +759,46 @@ static iree_status_t iree_vm_context_notify_reverse(iree_vm_stack_t* stack,
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_acquire_stack(
+    iree_vm_context_t* context, iree_vm_stack_t** out_stack) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_stack);
+  *out_stack = (iree_vm_stack_t*)iree_atomic_exchange_intptr(
+      &context->pooled_stack, 0, iree_memory_order_acquire);
+  if (*out_stack) return iree_ok_status();
+  return iree_vm_stack_allocate(IREE_VM_INVOCATION_FLAG_NONE,
+                                iree_vm_context_state_resolver(context),
+                                context->allocator, out_stack);
+}
+
+IREE_API_EXPORT void iree_vm_context_release_stack(iree_vm_context_t* context,
+                                                   iree_vm_stack_t* stack) {
+  IREE_ASSERT_ARGUMENT(context);
+  if (!stack) return;
+  iree_vm_stack_reset(stack);
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_intptr(
+          &context->pooled_stack, &expected, (intptr_t)stack,
+          iree_memory_order_release, iree_memory_order_relaxed)) {
+    // Pool is full; another stack was returned first.
+    iree_vm_stack_free(stack);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_context_set_profiler(
+    iree_vm_context_t* context, iree_vm_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(context);
+  iree_vm_profiler_retain(profiler);
+  iree_vm_profiler_release(context->profiler);
+  context->profiler = profiler;
+}
+
+IREE_API_EXPORT iree_vm_profiler_t* iree_vm_context_profiler(
+    const iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(context);
+  return context->profiler;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_context_notify(iree_vm_context_t* context,
                                                      iree_vm_signal_t signal) {
   IREE_TRACE_ZONE_BEGIN(z0);
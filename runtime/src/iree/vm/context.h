@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/vm/instance.h"
 #include "iree/vm/module.h"
+#include "iree/vm/profiler.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
 
@@ -69,6 +70,25 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
     iree_host_size_t module_count, iree_vm_module_t** modules,
     iree_allocator_t allocator, iree_vm_context_t** out_context);
 
+// Creates a new context with the same modules as |parent_context| without
+// rerunning their initializers.
+//
+// Module state is forked from the parent with the optional fork_state module
+// method: bytecode modules copy their primitive globals and share their ref
+// globals (such as constant buffers and executables uploaded by `__init`) by
+// reference so that many contexts can serve the same model without
+// multiplying its resident memory. Modules without fork_state receive new
+// state as if registered on a new context.
+//
+// Shared resources are not synchronized and programs must not mutate the
+// contents of buffers held in globals in place if forks execute concurrently.
+// The parent must not be executing while it is forked. Forked contexts cannot
+// have additional modules registered after creation.
+// |out_context| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    iree_vm_context_t* parent_context, iree_allocator_t allocator,
+    iree_vm_context_t** out_context);
+
 // Retains the given |context| for the caller.
 IREE_API_EXPORT void iree_vm_context_retain(iree_vm_context_t* context);
 
@@ -116,6 +136,33 @@ IREE_API_EXPORT iree_status_t iree_vm_context_resolve_function(
     const iree_vm_context_t* context, iree_string_view_t full_name,
     iree_vm_function_t* out_function);
 
+// Acquires a VM stack for invoking functions within |context|.
+// Stacks are pooled by the context so that repeated invocations reuse a stack
+// and any frame storage it has grown to hold instead of setting up a new one.
+// The stack is empty and uses IREE_VM_INVOCATION_FLAG_NONE. It must be
+// returned with iree_vm_context_release_stack prior to releasing |context|.
+//
+// Thread-safe: concurrent acquisitions beyond the pool capacity allocate new
+// stacks that are freed again when released.
+IREE_API_EXPORT iree_status_t iree_vm_context_acquire_stack(
+    iree_vm_context_t* context, iree_vm_stack_t** out_stack);
+
+// Returns a |stack| acquired with iree_vm_context_acquire_stack to the pool.
+// Any frames remaining on the stack are popped.
+IREE_API_EXPORT void iree_vm_context_release_stack(iree_vm_context_t* context,
+                                                   iree_vm_stack_t* stack);
+
+// Sets the |profiler| sampling all invocations made into |context| or NULL to
+// stop profiling. The profiler is retained by the context. Only invocations
+// begun after the call are sampled and no invocations may be in-flight when
+// the profiler is changed.
+IREE_API_EXPORT void iree_vm_context_set_profiler(iree_vm_context_t* context,
+                                                  iree_vm_profiler_t* profiler);
+
+// Returns the profiler sampling invocations made into |context|, if any.
+IREE_API_EXPORT iree_vm_profiler_t* iree_vm_context_profiler(
+    const iree_vm_context_t* context);
+
 // Notifies all modules in the context of a system signal.
 IREE_API_EXPORT iree_status_t iree_vm_context_notify(iree_vm_context_t* context,
                                                      iree_vm_signal_t signal);
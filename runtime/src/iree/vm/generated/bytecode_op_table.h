@@ -128,10 +128,10 @@ typedef enum {
   IREE_VM_OP_CORE_CtlzI64 = 0x76,
   IREE_VM_OP_CORE_AbsI32 = 0x77,
   IREE_VM_OP_CORE_AbsI64 = 0x78,
-  IREE_VM_OP_CORE_RSV_0x79,
-  IREE_VM_OP_CORE_RSV_0x7A,
-  IREE_VM_OP_CORE_RSV_0x7B,
-  IREE_VM_OP_CORE_RSV_0x7C,
+  IREE_VM_OP_CORE_CondBranchEQI32 = 0x79,
+  IREE_VM_OP_CORE_CondBranchNEI32 = 0x7A,
+  IREE_VM_OP_CORE_CondBranchLTI32S = 0x7B,
+  IREE_VM_OP_CORE_CondBranchLTI32U = 0x7C,
   IREE_VM_OP_CORE_RSV_0x7D,
   IREE_VM_OP_CORE_RSV_0x7E,
   IREE_VM_OP_CORE_RSV_0x7F,
@@ -387,10 +387,10 @@ typedef enum {
     OPC(0x76, CtlzI64) \
     OPC(0x77, AbsI32) \
     OPC(0x78, AbsI64) \
-    RSV(0x79) \
-    RSV(0x7A) \
-    RSV(0x7B) \
-    RSV(0x7C) \
+    OPC(0x79, CondBranchEQI32) \
+    OPC(0x7A, CondBranchNEI32) \
+    OPC(0x7B, CondBranchLTI32S) \
+    OPC(0x7C, CondBranchLTI32U) \
     RSV(0x7D) \
     RSV(0x7E) \
     RSV(0x7F) \
@@ -269,11 +269,19 @@ static void iree_vm_invoke_fiber_leave(iree_vm_invocation_id_t invocation_id,
 // Synchronous invocation
 //===----------------------------------------------------------------------===//
 
-IREE_API_EXPORT iree_status_t iree_vm_invoke(
+static iree_status_t iree_vm_begin_invoke_on_stack(
+    iree_vm_invoke_state_t* state, iree_vm_stack_t* external_stack,
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
-    iree_allocator_t host_allocator) {
+    const iree_vm_list_t* inputs, iree_allocator_t host_allocator);
+
+// Synchronously runs an invocation on |external_stack|, if provided, or an
+// inline stack.
+static iree_status_t iree_vm_invoke_on_stack(
+    iree_vm_stack_t* external_stack, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs, iree_allocator_t host_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Bound the synchronous invocation to the timeout specified by the user
@@ -298,9 +306,14 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
   // Perform the initial invocation step, which if synchronous may fully
   // complete the invocation before returning. If it yields we'll need to resume
   // it, possibly after taking care of pending waits.
-  iree_vm_invoke_state_t state = {0};
-  iree_status_t status = iree_vm_begin_invoke(&state, context, function, flags,
-                                              policy, inputs, host_allocator);
+  // NOTE: only the header of the state is cleared; the inline stack storage is
+  // initialized as it is used and clearing it costs more than small
+  // invocations do.
+  iree_vm_invoke_state_t state;
+  memset(&state, 0, offsetof(iree_vm_invoke_state_t, stack_storage));
+  iree_status_t status =
+      iree_vm_begin_invoke_on_stack(&state, external_stack, context, function,
+                                    flags, policy, inputs, host_allocator);
   while (iree_status_is_deferred(status)) {
     // Grab the wait frame from the stack holding the wait parameters.
     // This is optional: if an invocation yields for cooperative scheduling
@@ -368,6 +381,47 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_invoke(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(context);
+
+  // Reuse the stack pooled by the context when the invocation can run on it.
+  // Pooled stacks don't trace execution and concurrent contexts would contend
+  // on the pool so those use inline stacks.
+  iree_vm_context_flags_t context_flags = iree_vm_context_flags(context);
+  iree_vm_stack_t* pooled_stack = NULL;
+  if (!iree_any_bit_set(flags, IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION) &&
+      !iree_any_bit_set(context_flags, IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION |
+                                           IREE_VM_CONTEXT_FLAG_CONCURRENT)) {
+    IREE_RETURN_IF_ERROR(iree_vm_context_acquire_stack(context, &pooled_stack));
+  }
+
+  iree_status_t status =
+      iree_vm_invoke_on_stack(pooled_stack, context, function, flags, policy,
+                              inputs, outputs, host_allocator);
+
+  if (pooled_stack) iree_vm_context_release_stack(context, pooled_stack);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invoke_with_stack(
+    iree_vm_stack_t* stack, iree_vm_context_t* context,
+    iree_vm_function_t function, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(stack);
+  if (IREE_UNLIKELY(iree_vm_stack_current_frame(stack))) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "invocation stacks must be empty");
+  }
+  return iree_vm_invoke_on_stack(stack, context, function,
+                                 iree_vm_stack_invocation_flags(stack), policy,
+                                 inputs, outputs, host_allocator);
+}
+
 //===----------------------------------------------------------------------===//
 // Asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -382,6 +436,21 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
     iree_vm_function_t function, iree_vm_invocation_flags_t flags,
     const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
     iree_allocator_t host_allocator) {
+  return iree_vm_begin_invoke_on_stack(state, /*external_stack=*/NULL, context,
+                                       function, flags, policy, inputs,
+                                       host_allocator);
+}
+
+// Begins an invocation as with iree_vm_begin_invoke. If |external_stack| is
+// provided it is used in place of a stack in the inline state storage.
+//
+// WARNING: this function cannot have any trace markers that span the begin
+// call; the begin may yield with zones still open.
+static iree_status_t iree_vm_begin_invoke_on_stack(
+    iree_vm_invoke_state_t* state, iree_vm_stack_t* external_stack,
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -460,14 +529,17 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
     return status;
   }
 
-  // Initialize the stack with the inline storage.
+  // Initialize the stack with the inline storage unless one was provided.
   // We (probably) sliced off the head of the storage above to use for results
   // and perform an offset here to account for that.
-  iree_vm_stack_t* stack = NULL;
-  status = iree_vm_stack_initialize(
-      iree_make_byte_span(state->stack_storage + reserved_storage_size,
-                          sizeof(state->stack_storage) - reserved_storage_size),
-      flags, iree_vm_context_state_resolver(context), host_allocator, &stack);
+  iree_vm_stack_t* stack = external_stack;
+  if (!stack) {
+    status = iree_vm_stack_initialize(
+        iree_make_byte_span(
+            state->stack_storage + reserved_storage_size,
+            sizeof(state->stack_storage) - reserved_storage_size),
+        flags, iree_vm_context_state_resolver(context), host_allocator, &stack);
+  }
   if (!iree_status_is_ok(status)) {
     iree_vm_invoke_release_argument_storage(cconv_arguments, arguments,
                                             arguments_on_heap, host_allocator);
@@ -479,6 +551,9 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
 
   // NOTE: at this point the stack must be properly deinitialized if we bail.
 
+  // Sample the invocation if the context is being profiled.
+  iree_vm_stack_set_profiler(stack, iree_vm_context_profiler(context));
+
   // Initialize state now that we are confident we're returning OK.
   // If we return a failure the user won't know they have to end() and clean
   // these up.
@@ -487,6 +562,8 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   state->results = results;
   iree_vm_context_retain(context);
   state->stack = stack;
+  state->is_stack_external = external_stack != NULL;
+  state->host_allocator = host_allocator;
 
   // NOTE: we must end the zone here as the begin_call will return with
   // unbalanced zones if we yield.
@@ -673,18 +750,19 @@ IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_allocator_t host_allocator = state->stack
-                                        ? iree_vm_stack_allocator(state->stack)
-                                        : iree_allocator_null();
-
   if (state->stack) {
-    iree_vm_stack_deinitialize(state->stack);
+    if (state->is_stack_external) {
+      iree_vm_stack_reset(state->stack);
+    } else {
+      iree_vm_stack_deinitialize(state->stack);
+    }
     state->stack = NULL;
   }
 
   if (!iree_byte_span_is_empty(state->results)) {
     iree_vm_invoke_release_result_storage(state->cconv_results, state->results,
-                                          state->stack_storage, host_allocator);
+                                          state->stack_storage,
+                                          state->host_allocator);
     state->results = iree_byte_span_empty();
   }
 
@@ -48,6 +48,20 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
     const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
     iree_allocator_t host_allocator);
 
+// Synchronously invokes a function in the VM using the caller-provided |stack|.
+// Behaves as iree_vm_invoke but reuses |stack| and any frame storage it has
+// grown to hold instead of setting up a new stack per invocation. Callers
+// issuing many small invocations can keep a persistent stack per thread.
+//
+// |stack| must be empty and have been initialized with the state resolver of
+// |context| (iree_vm_context_state_resolver). Invocation flags are those the
+// stack was initialized with. The stack is empty again upon return.
+IREE_API_EXPORT iree_status_t iree_vm_invoke_with_stack(
+    iree_vm_stack_t* stack, iree_vm_context_t* context,
+    iree_vm_function_t function, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator);
+
 //===----------------------------------------------------------------------===//
 // Asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -90,8 +104,14 @@ typedef struct iree_vm_invoke_state_t {
   // VM stack used during the invocation. Will retain required resources
   // across invocation stages.
   iree_vm_stack_t* stack;
+  // True if |stack| is owned by the caller and only reset when the invocation
+  // ends instead of being deinitialized.
+  bool is_stack_external;
+  // Allocator used for heap-allocated results storage.
+  iree_allocator_t host_allocator;
   // Inlined stack storage. If the stack grows larger than this amount
-  // additional storage will be allocated automatically.
+  // additional storage will be allocated automatically. Must be the last
+  // member so that callers need not clear it.
   uint8_t stack_storage[IREE_VM_STACK_DEFAULT_SIZE];
 } iree_vm_invoke_state_t;
 
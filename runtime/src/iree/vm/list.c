@@ -299,8 +299,13 @@ iree_vm_list_reserve(iree_vm_list_t* list, iree_host_size_t minimum_capacity) {
   iree_host_size_t new_capacity = iree_host_align(minimum_capacity, 64);
   IREE_RETURN_IF_ERROR(iree_allocator_realloc(
       list->allocator, new_capacity * list->element_size, &list->storage));
-  memset((void*)((uintptr_t)list->storage + old_capacity * list->element_size),
-         0, (new_capacity - old_capacity) * list->element_size);
+  // Ref and variant storage beyond the list size must always be zeroed so that
+  // setting elements does not release garbage. Values are zeroed on resize.
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE) {
+    memset(
+        (void*)((uintptr_t)list->storage + old_capacity * list->element_size),
+        0, (new_capacity - old_capacity) * list->element_size);
+  }
   list->capacity = new_capacity;
   return iree_ok_status();
 }
@@ -324,6 +329,27 @@ IREE_API_EXPORT iree_status_t iree_vm_list_resize(iree_vm_list_t* list,
     IREE_RETURN_IF_ERROR(iree_vm_list_reserve(
         list, iree_max(list->capacity * 2, iree_host_align(new_size, 64))));
   }
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE) {
+    // Value storage beyond the list size may be uninitialized.
+    memset((void*)((uintptr_t)list->storage + list->count * list->element_size),
+           0, (new_size - list->count) * list->element_size);
+  }
+  list->count = new_size;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_resize_uninitialized(
+    iree_vm_list_t* list, iree_host_size_t new_size) {
+  IREE_ASSERT_ARGUMENT(list);
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "only lists of primitive values can be resized "
+                            "without initialization");
+  }
+  if (new_size > list->capacity) {
+    IREE_RETURN_IF_ERROR(iree_vm_list_reserve(
+        list, iree_max(list->capacity * 2, iree_host_align(new_size, 64))));
+  }
   list->count = new_size;
   return iree_ok_status();
 }
@@ -784,6 +810,76 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
   return iree_ok_status();
 }
 
+// Verifies that |list| stores primitive values of exactly |value_type| and
+// that the |length| bytes starting at element |i| are in bounds and returns the
+// storage of the range.
+static iree_status_t iree_vm_list_resolve_value_range(
+    const iree_vm_list_t* list, iree_host_size_t i,
+    iree_vm_value_type_t value_type, iree_host_size_t length,
+    uint8_t** out_ptr) {
+  *out_ptr = NULL;
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE ||
+      list->element_type.value_type != value_type) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "list does not store values of type %d",
+                            (int)value_type);
+  }
+  if (length % list->element_size != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "span length %zu is not a multiple of the element "
+                            "size %zu",
+                            length, list->element_size);
+  }
+  iree_host_size_t count = length / list->element_size;
+  if (i > list->count || count > list->count - i) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%zu, %zu) out of bounds (%zu)", i,
+                            i + count, list->count);
+  }
+  *out_ptr = (uint8_t*)list->storage + i * list->element_size;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i,
+    iree_vm_value_type_t value_type, iree_byte_span_t out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  uint8_t* element_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_resolve_value_range(
+      list, i, value_type, out_values.data_length, &element_ptr));
+  if (out_values.data_length > 0) {
+    memcpy(out_values.data, element_ptr, out_values.data_length);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_vm_value_type_t value_type,
+    iree_const_byte_span_t values) {
+  IREE_ASSERT_ARGUMENT(list);
+  uint8_t* element_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_resolve_value_range(
+      list, i, value_type, values.data_length, &element_ptr));
+  if (values.data_length > 0) {
+    memcpy(element_ptr, values.data, values.data_length);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_list_map_values(iree_vm_list_t* list, iree_vm_value_type_t value_type,
+                        iree_byte_span_t* out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(out_values);
+  *out_values = iree_make_byte_span(NULL, 0);
+  uint8_t* element_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_resolve_value_range(
+      list, 0, value_type, list->count * list->element_size, &element_ptr));
+  *out_values =
+      iree_make_byte_span(element_ptr, list->count * list->element_size);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   iree_host_size_t i = iree_vm_list_size(list);
@@ -101,6 +101,14 @@ IREE_API_EXPORT iree_host_size_t iree_vm_list_size(const iree_vm_list_t* list);
 IREE_API_EXPORT iree_status_t iree_vm_list_resize(iree_vm_list_t* list,
                                                   iree_host_size_t new_size);
 
+// Resizes a list of primitive values to contain |new_size| elements without
+// initializing any new elements. The contents of elements beyond the previous
+// size are undefined until set. Use this to size a list that will be
+// immediately populated with iree_vm_list_set_values or through
+// iree_vm_list_map_values. Fails if the list does not store primitive values.
+IREE_API_EXPORT iree_status_t iree_vm_list_resize_uninitialized(
+    iree_vm_list_t* list, iree_host_size_t new_size);
+
 // Clears the list contents. Equivalent to resizing to 0.
 IREE_API_EXPORT void iree_vm_list_clear(iree_vm_list_t* list);
 
@@ -149,6 +157,31 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_value_as(
 IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
     iree_vm_list_t* list, iree_host_size_t i, const iree_vm_value_t* value);
 
+// Copies the contiguous range of elements starting at index |i| into
+// |out_values|. The number of elements copied is derived from the span length.
+// The list must store primitive values of exactly |value_type| and no
+// conversion is performed: the span holds the values in their native
+// representation (e.g. int32_t for IREE_VM_VALUE_TYPE_I32).
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i,
+    iree_vm_value_type_t value_type, iree_byte_span_t out_values);
+
+// Copies |values| into the contiguous range of elements starting at index |i|.
+// The number of elements set is derived from the span length and the range
+// must already be within the list size. The list must store primitive values of
+// exactly |value_type| and no conversion is performed.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_vm_value_type_t value_type,
+    iree_const_byte_span_t values);
+
+// Returns a span of the backing storage of all elements in the list.
+// The list must store primitive values of exactly |value_type|. The span is
+// valid until the list is resized, reserved, or has its storage swapped and
+// may be used to read or write elements in-place.
+IREE_API_EXPORT iree_status_t
+iree_vm_list_map_values(iree_vm_list_t* list, iree_vm_value_type_t value_type,
+                        iree_byte_span_t* out_values);
+
 // Pushes the value of the element to the end of the list.
 // If the specified |value| type differs from the list storage type the value
 // will be converted using the value type semantics (such as sign/zero extend,
@@ -1269,6 +1269,89 @@ TEST_F(VMListTest, PushPopRef) {
   iree_vm_list_release(list);
 }
 
+// Tests bulk get/set of primitive values and the storage view.
+TEST_F(VMListTest, BulkValuesI32) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 0, iree_allocator_system(), &list));
+
+  // Size without zeroing and then populate in one call.
+  IREE_ASSERT_OK(iree_vm_list_resize_uninitialized(list, 5));
+  EXPECT_EQ(5, iree_vm_list_size(list));
+  const int32_t values[5] = {10, 11, 12, 13, 14};
+  IREE_ASSERT_OK(iree_vm_list_set_values(
+      list, 0, IREE_VM_VALUE_TYPE_I32,
+      iree_make_const_byte_span(values, sizeof(values))));
+  EXPECT_EQ(GetValuesList(list), MakeValuesList(values));
+
+  // Read back a subrange.
+  int32_t subrange[2] = {0};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 2, IREE_VM_VALUE_TYPE_I32,
+                              iree_make_byte_span(subrange, sizeof(subrange))));
+  EXPECT_EQ(12, subrange[0]);
+  EXPECT_EQ(13, subrange[1]);
+
+  // Writes through the mapped storage are visible in the list.
+  iree_byte_span_t storage = iree_make_byte_span(NULL, 0);
+  IREE_ASSERT_OK(
+      iree_vm_list_map_values(list, IREE_VM_VALUE_TYPE_I32, &storage));
+  ASSERT_EQ(sizeof(values), storage.data_length);
+  ((int32_t*)storage.data)[4] = 100;
+  iree_vm_value_t value;
+  IREE_ASSERT_OK(
+      iree_vm_list_get_value_as(list, 4, IREE_VM_VALUE_TYPE_I32, &value));
+  EXPECT_EQ(100, value.i32);
+
+  // Truncating without zeroing and then resizing must still zero-initialize.
+  IREE_ASSERT_OK(iree_vm_list_resize_uninitialized(list, 1));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 3));
+  const int32_t expected_values[3] = {10, 0, 0};
+  EXPECT_EQ(GetValuesList(list), MakeValuesList(expected_values));
+
+  iree_vm_list_release(list);
+}
+
+// Tests that bulk value access validates the type and range.
+TEST_F(VMListTest, BulkValuesInvalid) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 4, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  int64_t wide_values[2] = {0};
+  EXPECT_THAT(Status(iree_vm_list_get_values(
+                  list, 0, IREE_VM_VALUE_TYPE_I64,
+                  iree_make_byte_span(wide_values, sizeof(wide_values)))),
+              StatusIs(StatusCode::kFailedPrecondition));
+  int32_t values[3] = {0};
+  EXPECT_THAT(Status(iree_vm_list_get_values(
+                  list, 2, IREE_VM_VALUE_TYPE_I32,
+                  iree_make_byte_span(values, sizeof(values)))),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_vm_list_set_values(
+                  list, 0, IREE_VM_VALUE_TYPE_I32,
+                  iree_make_const_byte_span(values, sizeof(values) - 1))),
+              StatusIs(StatusCode::kInvalidArgument));
+
+  iree_vm_list_t* variant_list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 4,
+                                     iree_allocator_system(), &variant_list));
+  EXPECT_THAT(Status(iree_vm_list_resize_uninitialized(variant_list, 4)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  iree_byte_span_t storage = iree_make_byte_span(NULL, 0);
+  EXPECT_THAT(Status(iree_vm_list_map_values(variant_list,
+                                             IREE_VM_VALUE_TYPE_I32, &storage)),
+              StatusIs(StatusCode::kFailedPrecondition));
+
+  iree_vm_list_release(variant_list);
+  iree_vm_list_release(list);
+}
+
 // TODO(benvanik): test primitive variant get/set.
 
 // TODO(benvanik): test ref variant get/set.
@@ -415,6 +415,15 @@ typedef struct iree_vm_module_t {
   void(IREE_API_PTR* free_state)(void* self,
                                  iree_vm_module_state_t* module_state);
 
+  // Optional: allocates module state data for a forked context initialized
+  // from the |parent_state| of an existing context. Immutable resources should
+  // be shared with the parent by reference and mutable state copied so that
+  // the fork can run without reinitializing the module. Modules that do not
+  // implement this are given new state with alloc_state.
+  iree_status_t(IREE_API_PTR* fork_state)(
+      void* self, iree_vm_module_state_t* parent_state,
+      iree_allocator_t allocator, iree_vm_module_state_t** out_module_state);
+
   // Resolves the import with the given ordinal to |function|.
   // The function is guaranteed to remain valid for the lifetime of the module
   // state.
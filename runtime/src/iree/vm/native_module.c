@@ -277,6 +277,15 @@ iree_vm_native_module_alloc_state(void* self, iree_allocator_t allocator,
   return iree_ok_status();
 }
 
+static iree_status_t IREE_API_PTR iree_vm_native_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
+  *out_module_state = NULL;
+  return module->user_interface.fork_state(module->self, parent_state,
+                                           allocator, out_module_state);
+}
+
 static void IREE_API_PTR iree_vm_native_module_free_state(
     void* self, iree_vm_module_state_t* module_state) {
   iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
@@ -399,6 +408,27 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_resume_call(
       iree_byte_span_empty(), call_results);  // tail
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_native_module_lookup_function_ptr(
+    iree_vm_function_t function,
+    const iree_vm_native_function_ptr_t** out_function_ptr) {
+  IREE_ASSERT_ARGUMENT(out_function_ptr);
+  *out_function_ptr = NULL;
+  if (!function.module ||
+      function.module->begin_call != iree_vm_native_module_begin_call) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  iree_vm_native_module_t* module =
+      (iree_vm_native_module_t*)function.module->self;
+  if (module->user_interface.begin_call || module->user_interface.resume_call ||
+      !module->descriptor->functions ||
+      function.linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT ||
+      function.ordinal >= module->descriptor->function_count) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  *out_function_ptr = &module->descriptor->functions[function.ordinal];
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_native_module_create(
     const iree_vm_module_t* interface,
     const iree_vm_native_module_descriptor_t* module_descriptor,
@@ -503,6 +533,9 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
       iree_vm_native_module_get_function_attr;
   module->base_interface.alloc_state = iree_vm_native_module_alloc_state;
   module->base_interface.free_state = iree_vm_native_module_free_state;
+  if (module->user_interface.fork_state) {
+    module->base_interface.fork_state = iree_vm_native_module_fork_state;
+  }
   module->base_interface.resolve_import = iree_vm_native_module_resolve_import;
   module->base_interface.notify = iree_vm_native_module_notify;
   module->base_interface.begin_call = iree_vm_native_module_begin_call;
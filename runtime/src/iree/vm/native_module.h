@@ -146,6 +146,19 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
     iree_vm_instance_t* instance, iree_allocator_t allocator,
     iree_vm_module_t* module);
 
+// Looks up the function pointers implementing |function| when it is an export
+// of a native module using the default call support. Callers issuing many calls
+// to the same function may enter a native stack frame for |function| and invoke
+// the shim directly with |function.module->self| as the module, skipping the
+// iree_vm_module_t::begin_call indirection and its per-call validation. Yields
+// resume through the module as usual.
+//
+// Returns IREE_STATUS_UNAVAILABLE if |function| is not a native module export
+// or the module provides its own call handling.
+IREE_API_EXPORT iree_status_t iree_vm_native_module_lookup_function_ptr(
+    iree_vm_function_t function,
+    const iree_vm_native_function_ptr_t** out_function_ptr);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -21,6 +21,8 @@
 namespace iree {
 namespace {
 
+using ::iree::testing::status::StatusIs;
+
 // Test suite that uses module_a and module_b defined in native_module_test.h.
 // Both modules are put in a context and the module_b.entry function can be
 // executed with RunFunction.
@@ -56,8 +58,15 @@ class VMNativeModuleTest : public ::testing::Test {
     iree_vm_instance_release(instance_);
   }
 
-  StatusOr<int32_t> RunFunction(iree_string_view_t function_name,
-                                int32_t arg0) {
+  StatusOr<iree_vm_function_t> ResolveFunction(iree_string_view_t full_name) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_context_resolve_function(context_, full_name, &function));
+    return function;
+  }
+
+  StatusOr<int32_t> RunFunction(iree_string_view_t function_name, int32_t arg0,
+                                iree_vm_stack_t* stack = nullptr) {
     // Lookup the entry function. This can be cached in an application if
     // multiple calls will be made.
     iree_vm_function_t function;
@@ -79,10 +88,16 @@ class VMNativeModuleTest : public ::testing::Test {
         /*element_type=*/nullptr, 1, iree_allocator_system(), &output_list));
 
     // Invoke the entry function to do our work. Runs synchronously.
-    IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
-                       /*policy=*/nullptr, input_list.get(), output_list.get(),
-                       iree_allocator_system()));
+    if (stack) {
+      IREE_RETURN_IF_ERROR(iree_vm_invoke_with_stack(
+          stack, context_, function, /*policy=*/nullptr, input_list.get(),
+          output_list.get(), iree_allocator_system()));
+    } else {
+      IREE_RETURN_IF_ERROR(
+          iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+                         /*policy=*/nullptr, input_list.get(),
+                         output_list.get(), iree_allocator_system()));
+    }
 
     // Load the output result.
     iree_vm_value_t ret0_value;
@@ -91,7 +106,7 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
- private:
+ protected:
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
 };
@@ -108,5 +123,44 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+// A persistent stack can be reused across invocations.
+TEST_F(VMNativeModuleTest, InvokeWithStack) {
+  iree_vm_stack_t* stack = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_acquire_stack(context_, &stack));
+  const int32_t expected_results[] = {1, 4, 8};
+  for (int32_t i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK_AND_ASSIGN(
+        int32_t v,
+        RunFunction(iree_make_cstring_view("module_b.entry"), i + 1, stack));
+    ASSERT_EQ(v, expected_results[i]);
+    ASSERT_EQ(iree_vm_stack_current_frame(stack), nullptr);
+  }
+  iree_vm_context_release_stack(context_, stack);
+}
+
+// Functions of modules using the default call handling can be bound directly.
+TEST_F(VMNativeModuleTest, LookupFunctionPtr) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      iree_vm_function_t function,
+      ResolveFunction(iree_make_cstring_view("module_a.sub_1")));
+  const iree_vm_native_function_ptr_t* function_ptr = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_native_module_lookup_function_ptr(function, &function_ptr));
+  ASSERT_NE(function_ptr, nullptr);
+  EXPECT_EQ(function_ptr->target,
+            (iree_vm_native_function_target_t)module_a_sub_1);
+}
+
+// Functions that are not native module exports cannot be bound.
+TEST_F(VMNativeModuleTest, LookupFunctionPtrUnavailable) {
+  iree_vm_function_t function;
+  memset(&function, 0, sizeof(function));
+  const iree_vm_native_function_ptr_t* function_ptr = nullptr;
+  EXPECT_THAT(Status(iree_vm_native_module_lookup_function_ptr(
+                  function, &function_ptr)),
+              StatusIs(StatusCode::kUnavailable));
+  EXPECT_EQ(function_ptr, nullptr);
+}
+
 }  // namespace
 }  // namespace iree
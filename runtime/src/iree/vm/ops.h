@@ -12,6 +12,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/math.h"
+#include "iree/vm/buffer.h"
 #include "iree/vm/value.h"
 
 // The kernels below has undefined behavior in cases where the corresponding
@@ -150,6 +151,200 @@ static inline int32_t vm_cmp_nz_ref(iree_vm_ref_t* operand) {
   return (operand->ptr != NULL) ? 1 : 0;
 }
 
+//===------------------------------------------------------------------===//
+// Buffers
+//===------------------------------------------------------------------===//
+
+// Buffer offsets and lengths are i64 values the same as in the bytecode
+// interpreter. Load and store offsets are in elements while fill, copy, and
+// compare ranges are in bytes.
+
+static inline iree_status_t vm_buffer_deref(iree_vm_ref_t* buffer_ref,
+                                            iree_vm_buffer_t** out_buffer) {
+  *out_buffer = iree_vm_buffer_deref(*buffer_ref);
+  if (IREE_UNLIKELY(!*out_buffer)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "buffer is null");
+  }
+  return iree_ok_status();
+}
+
+static inline iree_status_t vm_buffer_alloc(iree_allocator_t allocator,
+                                            int64_t length,
+                                            iree_vm_ref_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_create(
+      IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_GUEST,
+      (iree_host_size_t)length, allocator, &buffer));
+  return iree_vm_ref_wrap_assign(buffer, iree_vm_buffer_type_id(), out_result);
+}
+static inline iree_status_t vm_buffer_clone(iree_allocator_t allocator,
+                                            iree_vm_ref_t* source_ref,
+                                            int64_t offset, int64_t length,
+                                            iree_vm_ref_t* out_result) {
+  iree_vm_buffer_t* source = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(source_ref, &source));
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_clone(
+      IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_GUEST,
+      source, (iree_host_size_t)offset, (iree_host_size_t)length, allocator,
+      &buffer));
+  return iree_vm_ref_wrap_assign(buffer, iree_vm_buffer_type_id(), out_result);
+}
+static inline iree_status_t vm_buffer_length(iree_vm_ref_t* buffer_ref,
+                                             int64_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  *out_result = (int64_t)iree_vm_buffer_length(buffer);
+  return iree_ok_status();
+}
+static inline iree_status_t vm_buffer_copy(iree_vm_ref_t* source_ref,
+                                           int64_t source_offset,
+                                           iree_vm_ref_t* target_ref,
+                                           int64_t target_offset,
+                                           int64_t length) {
+  iree_vm_buffer_t* source = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(source_ref, &source));
+  iree_vm_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(target_ref, &target));
+  return iree_vm_buffer_copy_bytes(source, (iree_host_size_t)source_offset,
+                                   target, (iree_host_size_t)target_offset,
+                                   (iree_host_size_t)length);
+}
+static inline iree_status_t vm_buffer_compare(iree_vm_ref_t* lhs_ref,
+                                              int64_t lhs_offset,
+                                              iree_vm_ref_t* rhs_ref,
+                                              int64_t rhs_offset,
+                                              int64_t length,
+                                              int32_t* out_result) {
+  iree_vm_buffer_t* lhs = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(lhs_ref, &lhs));
+  iree_vm_buffer_t* rhs = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(rhs_ref, &rhs));
+  bool result = false;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_compare_bytes(
+      lhs, (iree_host_size_t)lhs_offset, rhs, (iree_host_size_t)rhs_offset,
+      (iree_host_size_t)length, &result));
+  *out_result = result ? 1 : 0;
+  return iree_ok_status();
+}
+
+static inline iree_status_t vm_buffer_fill_i8(iree_vm_ref_t* buffer_ref,
+                                              int64_t offset, int64_t length,
+                                              int32_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint8_t pattern = (uint8_t)value;
+  return iree_vm_buffer_fill_elements(
+      buffer, (iree_host_size_t)offset,
+      (iree_host_size_t)length / sizeof(pattern), sizeof(pattern), &pattern);
+}
+static inline iree_status_t vm_buffer_fill_i16(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset, int64_t length,
+                                               int32_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint16_t pattern = (uint16_t)value;
+  return iree_vm_buffer_fill_elements(
+      buffer, (iree_host_size_t)offset,
+      (iree_host_size_t)length / sizeof(pattern), sizeof(pattern), &pattern);
+}
+static inline iree_status_t vm_buffer_fill_i32(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset, int64_t length,
+                                               int32_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint32_t pattern = (uint32_t)value;
+  return iree_vm_buffer_fill_elements(
+      buffer, (iree_host_size_t)offset,
+      (iree_host_size_t)length / sizeof(pattern), sizeof(pattern), &pattern);
+}
+
+static inline iree_status_t vm_buffer_load_i8u(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset,
+                                               int32_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint8_t result = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(result), &result, 1,
+      sizeof(result)));
+  *out_result = vm_ext_i8i32u(result);
+  return iree_ok_status();
+}
+static inline iree_status_t vm_buffer_load_i8s(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset,
+                                               int32_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  int8_t result = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(result), &result, 1,
+      sizeof(result)));
+  *out_result = vm_ext_i8i32s(result);
+  return iree_ok_status();
+}
+static inline iree_status_t vm_buffer_load_i16u(iree_vm_ref_t* buffer_ref,
+                                                int64_t offset,
+                                                int32_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint16_t result = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(result), &result, 1,
+      sizeof(result)));
+  *out_result = vm_ext_i16i32u(result);
+  return iree_ok_status();
+}
+static inline iree_status_t vm_buffer_load_i16s(iree_vm_ref_t* buffer_ref,
+                                                int64_t offset,
+                                                int32_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  int16_t result = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(result), &result, 1,
+      sizeof(result)));
+  *out_result = vm_ext_i16i32s(result);
+  return iree_ok_status();
+}
+static inline iree_status_t vm_buffer_load_i32(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset,
+                                               int32_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  return iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(*out_result), out_result, 1,
+      sizeof(*out_result));
+}
+
+static inline iree_status_t vm_buffer_store_i8(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset, int32_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint8_t element = (uint8_t)value;
+  return iree_vm_buffer_write_elements(
+      &element, buffer, (iree_host_size_t)offset * sizeof(element), 1,
+      sizeof(element));
+}
+static inline iree_status_t vm_buffer_store_i16(iree_vm_ref_t* buffer_ref,
+                                                int64_t offset, int32_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint16_t element = (uint16_t)value;
+  return iree_vm_buffer_write_elements(
+      &element, buffer, (iree_host_size_t)offset * sizeof(element), 1,
+      sizeof(element));
+}
+static inline iree_status_t vm_buffer_store_i32(iree_vm_ref_t* buffer_ref,
+                                                int64_t offset, int32_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint32_t element = (uint32_t)value;
+  return iree_vm_buffer_write_elements(
+      &element, buffer, (iree_host_size_t)offset * sizeof(element), 1,
+      sizeof(element));
+}
+
 //===------------------------------------------------------------------===//
 // ExtI64: Globals
 //===------------------------------------------------------------------===//
@@ -258,6 +453,39 @@ static inline int32_t vm_cmp_nz_i64(int64_t operand) {
   return (operand != 0) ? 1 : 0;
 }
 
+//===------------------------------------------------------------------===//
+// ExtI64: Buffers
+//===------------------------------------------------------------------===//
+
+static inline iree_status_t vm_buffer_fill_i64(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset, int64_t length,
+                                               int64_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint64_t pattern = (uint64_t)value;
+  return iree_vm_buffer_fill_elements(
+      buffer, (iree_host_size_t)offset,
+      (iree_host_size_t)length / sizeof(pattern), sizeof(pattern), &pattern);
+}
+static inline iree_status_t vm_buffer_load_i64(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset,
+                                               int64_t* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  return iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(*out_result), out_result, 1,
+      sizeof(*out_result));
+}
+static inline iree_status_t vm_buffer_store_i64(iree_vm_ref_t* buffer_ref,
+                                                int64_t offset, int64_t value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  uint64_t element = (uint64_t)value;
+  return iree_vm_buffer_write_elements(
+      &element, buffer, (iree_host_size_t)offset * sizeof(element), 1,
+      sizeof(element));
+}
+
 //===------------------------------------------------------------------===//
 // ExtF32: Globals
 //===------------------------------------------------------------------===//
@@ -382,6 +610,39 @@ static inline int32_t vm_cmp_nan_f32(float operand) {
   return isnan(operand) ? 1 : 0;
 }
 
+//===------------------------------------------------------------------===//
+// ExtF32: Buffers
+//===------------------------------------------------------------------===//
+
+static inline iree_status_t vm_buffer_fill_f32(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset, int64_t length,
+                                               float value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  float pattern = (float)value;
+  return iree_vm_buffer_fill_elements(
+      buffer, (iree_host_size_t)offset,
+      (iree_host_size_t)length / sizeof(pattern), sizeof(pattern), &pattern);
+}
+static inline iree_status_t vm_buffer_load_f32(iree_vm_ref_t* buffer_ref,
+                                               int64_t offset,
+                                               float* out_result) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  return iree_vm_buffer_read_elements(
+      buffer, (iree_host_size_t)offset * sizeof(*out_result), out_result, 1,
+      sizeof(*out_result));
+}
+static inline iree_status_t vm_buffer_store_f32(iree_vm_ref_t* buffer_ref,
+                                                int64_t offset, float value) {
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(vm_buffer_deref(buffer_ref, &buffer));
+  float element = (float)value;
+  return iree_vm_buffer_write_elements(
+      &element, buffer, (iree_host_size_t)offset * sizeof(element), 1,
+      sizeof(element));
+}
+
 #if !IREE_VM_UBSAN_CHECKABLE_ENABLE
 #pragma clang attribute pop
 #endif
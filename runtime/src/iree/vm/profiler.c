@@ -0,0 +1,418 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/profiler.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+// A unique frame chain and its aggregate weight.
+typedef struct iree_vm_profiler_entry_t {
+  // Hash of the frame chain used for lookup.
+  uint64_t hash;
+  // Range of the frames in the profiler frame storage.
+  iree_host_size_t frame_offset;
+  iree_host_size_t frame_count;
+  // Total weight of all samples with this frame chain.
+  iree_duration_t total_weight_ns;
+} iree_vm_profiler_entry_t;
+
+struct iree_vm_profiler_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t allocator;
+
+  // Minimum interval between samples taken from a single stack.
+  iree_duration_t sample_interval_ns;
+
+  // Guards all mutable profile storage below.
+  iree_slim_mutex_t mutex;
+
+  // Frames of all unique entries, referenced by range.
+  iree_host_size_t frame_count;
+  iree_host_size_t frame_capacity;
+  iree_vm_profiler_frame_t* frames;
+
+  // Unique frame chains in the order they were first sampled.
+  iree_host_size_t entry_count;
+  iree_host_size_t entry_capacity;
+  iree_vm_profiler_entry_t* entries;
+
+  // Open-addressed hash table of entry indices + 1 with 0 indicating an empty
+  // bucket. The capacity is always a power of two.
+  iree_host_size_t bucket_capacity;
+  uint32_t* buckets;
+
+  // Modules referenced by any frame, retained until reset.
+  iree_host_size_t module_count;
+  iree_host_size_t module_capacity;
+  iree_vm_module_t** modules;
+};
+
+IREE_API_EXPORT void iree_vm_profiler_options_initialize(
+    iree_vm_profiler_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->sample_interval_ns = IREE_VM_PROFILER_DEFAULT_SAMPLE_INTERVAL_NS;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profiler_create(
+    const iree_vm_profiler_options_t* options, iree_allocator_t allocator,
+    iree_vm_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_profiler_t* profiler = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(allocator, sizeof(*profiler), (void**)&profiler));
+  iree_atomic_ref_count_init(&profiler->ref_count);
+  profiler->allocator = allocator;
+  profiler->sample_interval_ns = options->sample_interval_ns;
+  iree_slim_mutex_initialize(&profiler->mutex);
+
+  *out_profiler = profiler;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_vm_profiler_destroy(iree_vm_profiler_t* profiler) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t allocator = profiler->allocator;
+
+  iree_vm_profiler_reset(profiler);
+  iree_allocator_free(allocator, profiler->frames);
+  iree_allocator_free(allocator, profiler->entries);
+  iree_allocator_free(allocator, profiler->buckets);
+  iree_allocator_free(allocator, profiler->modules);
+  iree_slim_mutex_deinitialize(&profiler->mutex);
+  iree_allocator_free(allocator, profiler);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_profiler_retain(iree_vm_profiler_t* profiler) {
+  if (profiler) {
+    iree_atomic_ref_count_inc(&profiler->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_profiler_release(iree_vm_profiler_t* profiler) {
+  if (profiler && iree_atomic_ref_count_dec(&profiler->ref_count) == 1) {
+    iree_vm_profiler_destroy(profiler);
+  }
+}
+
+IREE_API_EXPORT iree_duration_t
+iree_vm_profiler_sample_interval(const iree_vm_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  return profiler->sample_interval_ns;
+}
+
+//===----------------------------------------------------------------------===//
+// Sample recording
+//===----------------------------------------------------------------------===//
+
+static bool iree_vm_profiler_frame_equal(const iree_vm_profiler_frame_t* lhs,
+                                         const iree_vm_profiler_frame_t* rhs) {
+  return lhs->type == rhs->type &&
+         lhs->function.module == rhs->function.module &&
+         lhs->function.linkage == rhs->function.linkage &&
+         lhs->function.ordinal == rhs->function.ordinal && lhs->pc == rhs->pc;
+}
+
+// FNV-1a over the identifying fields of each frame.
+static uint64_t iree_vm_profiler_hash_frames(
+    iree_host_size_t frame_count, const iree_vm_profiler_frame_t* frames) {
+  uint64_t hash = 14695981039346656037ull;
+  for (iree_host_size_t i = 0; i < frame_count; ++i) {
+    const uint64_t values[4] = {
+        (uint64_t)frames[i].type,
+        (uint64_t)(uintptr_t)frames[i].function.module,
+        ((uint64_t)frames[i].function.linkage << 16) |
+            frames[i].function.ordinal,
+        (uint64_t)frames[i].pc,
+    };
+    for (iree_host_size_t j = 0; j < IREE_ARRAYSIZE(values); ++j) {
+      hash ^= values[j];
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+// Grows |*storage| to hold at least |minimum_capacity| elements.
+static iree_status_t iree_vm_profiler_grow(iree_allocator_t allocator,
+                                           iree_host_size_t element_size,
+                                           iree_host_size_t minimum_capacity,
+                                           iree_host_size_t* capacity,
+                                           void** storage) {
+  if (IREE_LIKELY(minimum_capacity <= *capacity)) return iree_ok_status();
+  iree_host_size_t new_capacity = iree_max(16, *capacity * 2);
+  while (new_capacity < minimum_capacity) new_capacity *= 2;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_realloc(allocator, new_capacity * element_size, storage));
+  *capacity = new_capacity;
+  return iree_ok_status();
+}
+
+// Rebuilds the bucket table with |new_capacity| buckets.
+static iree_status_t iree_vm_profiler_rehash(iree_vm_profiler_t* profiler,
+                                             iree_host_size_t new_capacity) {
+  uint32_t* new_buckets = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(profiler->allocator,
+                                             new_capacity * sizeof(uint32_t),
+                                             (void**)&new_buckets));
+  for (iree_host_size_t i = 0; i < profiler->entry_count; ++i) {
+    iree_host_size_t bucket =
+        (iree_host_size_t)profiler->entries[i].hash & (new_capacity - 1);
+    while (new_buckets[bucket]) bucket = (bucket + 1) & (new_capacity - 1);
+    new_buckets[bucket] = (uint32_t)(i + 1);
+  }
+  iree_allocator_free(profiler->allocator, profiler->buckets);
+  profiler->buckets = new_buckets;
+  profiler->bucket_capacity = new_capacity;
+  return iree_ok_status();
+}
+
+// Retains |module| for the lifetime of the profile if not already retained.
+static iree_status_t iree_vm_profiler_retain_module(
+    iree_vm_profiler_t* profiler, iree_vm_module_t* module) {
+  // NOTE: linear scan as the number of modules is expected to be very small.
+  for (iree_host_size_t i = 0; i < profiler->module_count; ++i) {
+    if (profiler->modules[i] == module) return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(iree_vm_profiler_grow(
+      profiler->allocator, sizeof(iree_vm_module_t*),
+      profiler->module_count + 1, &profiler->module_capacity,
+      (void**)&profiler->modules));
+  iree_vm_module_retain(module);
+  profiler->modules[profiler->module_count++] = module;
+  return iree_ok_status();
+}
+
+// Inserts a new entry for the given frame chain at |bucket|.
+static iree_status_t iree_vm_profiler_insert_entry(
+    iree_vm_profiler_t* profiler, uint64_t hash, iree_host_size_t frame_count,
+    const iree_vm_profiler_frame_t* frames, iree_duration_t weight_ns) {
+  IREE_RETURN_IF_ERROR(iree_vm_profiler_grow(
+      profiler->allocator, sizeof(iree_vm_profiler_frame_t),
+      profiler->frame_count + frame_count, &profiler->frame_capacity,
+      (void**)&profiler->frames));
+  IREE_RETURN_IF_ERROR(iree_vm_profiler_grow(
+      profiler->allocator, sizeof(iree_vm_profiler_entry_t),
+      profiler->entry_count + 1, &profiler->entry_capacity,
+      (void**)&profiler->entries));
+  for (iree_host_size_t i = 0; i < frame_count; ++i) {
+    if (frames[i].function.module) {
+      IREE_RETURN_IF_ERROR(
+          iree_vm_profiler_retain_module(profiler, frames[i].function.module));
+    }
+  }
+
+  // Keep the load factor under 50% to keep probe sequences short.
+  if ((profiler->entry_count + 1) * 2 > profiler->bucket_capacity) {
+    IREE_RETURN_IF_ERROR(iree_vm_profiler_rehash(
+        profiler, iree_max(64, profiler->bucket_capacity * 2)));
+  }
+
+  iree_vm_profiler_entry_t* entry = &profiler->entries[profiler->entry_count];
+  entry->hash = hash;
+  entry->frame_offset = profiler->frame_count;
+  entry->frame_count = frame_count;
+  entry->total_weight_ns = weight_ns;
+  memcpy(&profiler->frames[profiler->frame_count], frames,
+         frame_count * sizeof(*frames));
+  profiler->frame_count += frame_count;
+
+  iree_host_size_t bucket =
+      (iree_host_size_t)hash & (profiler->bucket_capacity - 1);
+  while (profiler->buckets[bucket]) {
+    bucket = (bucket + 1) & (profiler->bucket_capacity - 1);
+  }
+  profiler->buckets[bucket] = (uint32_t)(++profiler->entry_count);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_vm_profiler_record_sample(
+    iree_vm_profiler_t* profiler, iree_host_size_t frame_count,
+    const iree_vm_profiler_frame_t* frames, iree_duration_t weight_ns) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  if (frame_count == 0) return;
+  uint64_t hash = iree_vm_profiler_hash_frames(frame_count, frames);
+
+  iree_slim_mutex_lock(&profiler->mutex);
+
+  // Find an existing entry with the same frame chain and accumulate.
+  if (profiler->bucket_capacity) {
+    iree_host_size_t bucket =
+        (iree_host_size_t)hash & (profiler->bucket_capacity - 1);
+    while (profiler->buckets[bucket]) {
+      iree_vm_profiler_entry_t* entry =
+          &profiler->entries[profiler->buckets[bucket] - 1];
+      if (entry->hash == hash && entry->frame_count == frame_count) {
+        const iree_vm_profiler_frame_t* entry_frames =
+            &profiler->frames[entry->frame_offset];
+        bool equal = true;
+        for (iree_host_size_t i = 0; i < frame_count && equal; ++i) {
+          equal = iree_vm_profiler_frame_equal(&entry_frames[i], &frames[i]);
+        }
+        if (equal) {
+          entry->total_weight_ns += weight_ns;
+          iree_slim_mutex_unlock(&profiler->mutex);
+          return;
+        }
+      }
+      bucket = (bucket + 1) & (profiler->bucket_capacity - 1);
+    }
+  }
+
+  // New frame chain. Failures only drop the sample as profiling must not
+  // change the behavior of the program.
+  iree_status_ignore(iree_vm_profiler_insert_entry(profiler, hash, frame_count,
+                                                   frames, weight_ns));
+
+  iree_slim_mutex_unlock(&profiler->mutex);
+}
+
+IREE_API_EXPORT void iree_vm_profiler_reset(iree_vm_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  iree_slim_mutex_lock(&profiler->mutex);
+  profiler->frame_count = 0;
+  profiler->entry_count = 0;
+  if (profiler->buckets) {
+    memset(profiler->buckets, 0,
+           profiler->bucket_capacity * sizeof(*profiler->buckets));
+  }
+  for (iree_host_size_t i = 0; i < profiler->module_count; ++i) {
+    iree_vm_module_release(profiler->modules[i]);
+  }
+  profiler->module_count = 0;
+  iree_slim_mutex_unlock(&profiler->mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// Folded stack formatting
+//===----------------------------------------------------------------------===//
+
+// Appends |value| to |builder| replacing characters that are reserved in the
+// folded stack format.
+static iree_status_t iree_vm_profiler_append_escaped(
+    iree_string_builder_t* builder, iree_string_view_t value) {
+  for (iree_host_size_t i = 0; i < value.size; ++i) {
+    char c = value.data[i];
+    if (c == ';') {
+      c = ',';
+    } else if (c == '\n' || c == '\r') {
+      c = ' ';
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_string(
+        builder, iree_make_string_view(&c, 1)));
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_profiler_format_frame(
+    const iree_vm_profiler_frame_t* frame,
+    iree_vm_profiler_format_flags_t flags, iree_allocator_t scratch_allocator,
+    iree_string_builder_t* builder) {
+  if (frame->type == IREE_VM_STACK_FRAME_WAIT) {
+    return iree_string_builder_append_cstring(builder, "[wait]");
+  }
+
+  // Common module/function name as used in backtraces.
+  iree_vm_module_t* module = frame->function.module;
+  iree_string_view_t module_name = iree_vm_module_name(module);
+  iree_string_view_t function_name = iree_vm_function_name(&frame->function);
+  if (iree_string_view_is_empty(function_name)) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%.*s@%d", (int)module_name.size, module_name.data,
+        (int)frame->function.ordinal));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%.*s.%.*s", (int)module_name.size, module_name.data,
+        (int)function_name.size, function_name.data));
+  }
+
+  if (!iree_all_bits_set(flags,
+                         IREE_VM_PROFILER_FORMAT_FLAG_SOURCE_LOCATIONS)) {
+    return iree_ok_status();
+  }
+
+  // Source location from the module debug database, if available.
+  iree_vm_stack_frame_t stack_frame;
+  memset(&stack_frame, 0, sizeof(stack_frame));
+  stack_frame.type = frame->type;
+  stack_frame.function = frame->function;
+  stack_frame.pc = frame->pc;
+  iree_vm_source_location_t source_location;
+  iree_status_t status = iree_vm_module_resolve_source_location(
+      module, &stack_frame, &source_location);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    return iree_string_builder_append_format(builder, " (pc %" PRIu64 ")",
+                                             (uint64_t)frame->pc);
+  }
+  iree_string_builder_t location_builder;
+  iree_string_builder_initialize(scratch_allocator, &location_builder);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_source_location_format(
+        &source_location, IREE_VM_SOURCE_LOCATION_FORMAT_FLAG_SINGLE_LINE,
+        &location_builder);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(builder, " (");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_profiler_append_escaped(
+        builder, iree_string_builder_view(&location_builder));
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(builder, ")");
+  }
+  iree_string_builder_deinitialize(&location_builder);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profiler_format_folded(
+    iree_vm_profiler_t* profiler, iree_vm_profiler_format_flags_t flags,
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&profiler->mutex);
+  for (iree_host_size_t i = 0;
+       i < profiler->entry_count && iree_status_is_ok(status); ++i) {
+    const iree_vm_profiler_entry_t* entry = &profiler->entries[i];
+    const iree_vm_profiler_frame_t* frames =
+        &profiler->frames[entry->frame_offset];
+    for (iree_host_size_t j = 0;
+         j < entry->frame_count && iree_status_is_ok(status); ++j) {
+      if (j > 0) status = iree_string_builder_append_cstring(builder, ";");
+      if (iree_status_is_ok(status)) {
+        status =
+            iree_vm_profiler_format_frame(&frames[j], flags,
+                                          profiler->allocator, builder);
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_format(
+          builder, " %" PRId64 "\n", entry->total_weight_ns / 1000);
+    }
+  }
+  iree_slim_mutex_unlock(&profiler->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
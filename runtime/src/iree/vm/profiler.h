@@ -0,0 +1,113 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_PROFILER_H_
+#define IREE_VM_PROFILER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/module.h"
+#include "iree/vm/stack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of frames recorded per sample. Deeper stacks have their
+// outermost frames dropped.
+#define IREE_VM_PROFILER_MAX_DEPTH 64
+
+// Default minimum interval between samples of a stack.
+#define IREE_VM_PROFILER_DEFAULT_SAMPLE_INTERVAL_NS (1000 * 1000)
+
+// Options controlling profiler behavior.
+typedef struct iree_vm_profiler_options_t {
+  // Minimum interval between samples taken from a single stack in nanoseconds.
+  // Smaller intervals increase precision at the cost of higher overhead.
+  iree_duration_t sample_interval_ns;
+} iree_vm_profiler_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_vm_profiler_options_initialize(
+    iree_vm_profiler_options_t* out_options);
+
+enum iree_vm_profiler_format_flag_bits_e {
+  IREE_VM_PROFILER_FORMAT_FLAG_NONE = 0u,
+  // Includes the source location of each frame from the module debug database
+  // (when available). Frames with different locations within the same function
+  // are reported independently.
+  IREE_VM_PROFILER_FORMAT_FLAG_SOURCE_LOCATIONS = 1u << 0,
+};
+typedef uint32_t iree_vm_profiler_format_flags_t;
+
+// A frame within a recorded sample.
+typedef struct iree_vm_profiler_frame_t {
+  // Type of the frame; wait frames have no function.
+  iree_vm_stack_frame_type_t type;
+  // Function the frame was executing.
+  iree_vm_function_t function;
+  // Program counter within the function at the time of the sample.
+  iree_vm_source_offset_t pc;
+} iree_vm_profiler_frame_t;
+
+// Samples the VM stack frame chain of invocations.
+//
+// Samples are taken by the stacks themselves whenever a frame is entered or
+// left (including native import calls and waits) and at least
+// |sample_interval_ns| has passed since the last sample. Each sample is
+// weighted by the wall time elapsed since the prior sample of the same stack
+// such that the aggregate profile reflects where invocation latency goes:
+// bytecode, calls into native modules such as the HAL, or waits.
+//
+// Profiles are aggregated by unique frame chain and can be exported in the
+// folded stack format consumed by flamegraph.pl, speedscope, and inferno.
+//
+// The profiler retains all modules referenced by samples until it is reset or
+// released so that the profile can be formatted after contexts are released.
+//
+// Thread-safe: samples may be recorded from any number of stacks concurrently.
+typedef struct iree_vm_profiler_t iree_vm_profiler_t;
+
+// Creates a new profiler with the given |options|.
+// |out_profiler| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_profiler_create(
+    const iree_vm_profiler_options_t* options, iree_allocator_t allocator,
+    iree_vm_profiler_t** out_profiler);
+
+// Retains the given |profiler| for the caller.
+IREE_API_EXPORT void iree_vm_profiler_retain(iree_vm_profiler_t* profiler);
+
+// Releases the given |profiler| from the caller.
+IREE_API_EXPORT void iree_vm_profiler_release(iree_vm_profiler_t* profiler);
+
+// Returns the minimum interval between samples of a stack.
+IREE_API_EXPORT iree_duration_t
+iree_vm_profiler_sample_interval(const iree_vm_profiler_t* profiler);
+
+// Records a sample of |frame_count| |frames| ordered from the outermost
+// (root) frame to the innermost (top) frame with the given |weight_ns|.
+// Samples that cannot be recorded due to allocation failures are dropped.
+IREE_API_EXPORT void iree_vm_profiler_record_sample(
+    iree_vm_profiler_t* profiler, iree_host_size_t frame_count,
+    const iree_vm_profiler_frame_t* frames, iree_duration_t weight_ns);
+
+// Discards all recorded samples and releases referenced modules.
+IREE_API_EXPORT void iree_vm_profiler_reset(iree_vm_profiler_t* profiler);
+
+// Formats all recorded samples in the folded stack format to |builder|.
+// Each unique frame chain is written on its own line as a `;`-separated list
+// of frames from the root followed by the total weight in microseconds:
+//   module.caller;module.callee;hal.command_buffer.dispatch 1234
+IREE_API_EXPORT iree_status_t iree_vm_profiler_format_folded(
+    iree_vm_profiler_t* profiler, iree_vm_profiler_format_flags_t flags,
+    iree_string_builder_t* builder);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_PROFILER_H_
@@ -0,0 +1,135 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/profiler.h"
+
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/list.h"
+#include "iree/vm/native_module_test.h"
+#include "iree/vm/value.h"
+
+namespace iree {
+namespace {
+
+class VMProfilerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+    iree_vm_module_t* module_a = nullptr;
+    IREE_CHECK_OK(
+        module_a_create(instance_, iree_allocator_system(), &module_a));
+    iree_vm_module_t* module_b = nullptr;
+    IREE_CHECK_OK(
+        module_b_create(instance_, iree_allocator_system(), &module_b));
+    std::vector<iree_vm_module_t*> modules = {module_a, module_b};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(module_a);
+    iree_vm_module_release(module_b);
+  }
+
+  virtual void TearDown() {
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_vm_profiler_frame_t MakeFrame(const char* full_name) {
+    iree_vm_profiler_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.type = IREE_VM_STACK_FRAME_NATIVE;
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view(full_name), &frame.function));
+    return frame;
+  }
+
+  std::string Format(iree_vm_profiler_t* profiler) {
+    iree_string_builder_t builder;
+    iree_string_builder_initialize(iree_allocator_system(), &builder);
+    IREE_CHECK_OK(iree_vm_profiler_format_folded(
+        profiler, IREE_VM_PROFILER_FORMAT_FLAG_NONE, &builder));
+    std::string result(iree_string_builder_buffer(&builder),
+                       iree_string_builder_size(&builder));
+    iree_string_builder_deinitialize(&builder);
+    return result;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+};
+
+// Samples of the same frame chain are aggregated into a single line.
+TEST_F(VMProfilerTest, AggregatesSamples) {
+  iree_vm_profiler_options_t options;
+  iree_vm_profiler_options_initialize(&options);
+  iree_vm_profiler_t* profiler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_profiler_create(&options, iree_allocator_system(), &profiler));
+
+  iree_vm_profiler_frame_t frames[2] = {
+      MakeFrame("module_b.entry"),
+      MakeFrame("module_a.add_1"),
+  };
+  iree_vm_profiler_record_sample(profiler, 2, frames, /*weight_ns=*/1000);
+  iree_vm_profiler_record_sample(profiler, 2, frames, /*weight_ns=*/2000);
+  iree_vm_profiler_record_sample(profiler, 1, frames, /*weight_ns=*/5000);
+
+  std::string folded = Format(profiler);
+  EXPECT_NE(folded.find("module_b.entry;module_a.add_1 3\n"),
+            std::string::npos)
+      << folded;
+  EXPECT_NE(folded.find("module_b.entry 5\n"), std::string::npos) << folded;
+
+  iree_vm_profiler_reset(profiler);
+  EXPECT_TRUE(Format(profiler).empty());
+
+  iree_vm_profiler_release(profiler);
+}
+
+// Invocations on a context with a profiler attached record samples.
+TEST_F(VMProfilerTest, SamplesInvocations) {
+  iree_vm_profiler_options_t options;
+  iree_vm_profiler_options_initialize(&options);
+  options.sample_interval_ns = 0;
+  iree_vm_profiler_t* profiler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_profiler_create(&options, iree_allocator_system(), &profiler));
+  iree_vm_context_set_profiler(context_, profiler);
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context_, iree_make_cstring_view("module_b.entry"), &function));
+  vm::ref<iree_vm_list_t> input_list;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &input_list));
+  auto arg0_value = iree_vm_value_make_i32(1);
+  IREE_ASSERT_OK(iree_vm_list_push_value(input_list.get(), &arg0_value));
+  vm::ref<iree_vm_list_t> output_list;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &output_list));
+  IREE_ASSERT_OK(iree_vm_invoke(context_, function,
+                                IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/nullptr, input_list.get(),
+                                output_list.get(), iree_allocator_system()));
+
+  // The context no longer needs the profiler but the samples remain.
+  iree_vm_context_set_profiler(context_, nullptr);
+  std::string folded = Format(profiler);
+  EXPECT_NE(folded.find("module_b.entry"), std::string::npos) << folded;
+
+  iree_vm_profiler_release(profiler);
+}
+
+}  // namespace
+}  // namespace iree
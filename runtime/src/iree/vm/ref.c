@@ -17,6 +17,28 @@
 // or something more complex).
 #define IREE_VM_MAX_TYPE_ID 64
 
+// Reference counting on ref object counters.
+// With IREE_VM_REF_NONATOMIC_UNSAFE the read-modify-write is split into a
+// relaxed load and store that compile to plain memory operations.
+#if IREE_VM_REF_NONATOMIC_UNSAFE
+static inline void iree_vm_ref_counter_inc(
+    volatile iree_atomic_ref_count_t* volatile_counter) {
+  iree_atomic_ref_count_t* counter = (iree_atomic_ref_count_t*)volatile_counter;
+  int32_t count = iree_atomic_load_int32(counter, iree_memory_order_relaxed);
+  iree_atomic_store_int32(counter, count + 1, iree_memory_order_relaxed);
+}
+static inline int32_t iree_vm_ref_counter_dec(
+    volatile iree_atomic_ref_count_t* volatile_counter) {
+  iree_atomic_ref_count_t* counter = (iree_atomic_ref_count_t*)volatile_counter;
+  int32_t count = iree_atomic_load_int32(counter, iree_memory_order_relaxed);
+  iree_atomic_store_int32(counter, count - 1, iree_memory_order_relaxed);
+  return count;
+}
+#else
+#define iree_vm_ref_counter_inc(counter) iree_atomic_ref_count_inc(counter)
+#define iree_vm_ref_counter_dec(counter) iree_atomic_ref_count_dec(counter)
+#endif  // IREE_VM_REF_NONATOMIC_UNSAFE
+
 static inline volatile iree_atomic_ref_count_t* iree_vm_get_raw_counter_ptr(
     void* ptr, const iree_vm_ref_type_descriptor_t* type_descriptor) {
   return (volatile iree_atomic_ref_count_t*)(((uintptr_t)(ptr)) +
@@ -34,7 +56,7 @@ IREE_API_EXPORT void iree_vm_ref_object_retain(
   if (!ptr) return;
   volatile iree_atomic_ref_count_t* counter =
       iree_vm_get_raw_counter_ptr(ptr, type_descriptor);
-  iree_atomic_ref_count_inc(counter);
+  iree_vm_ref_counter_inc(counter);
 }
 
 IREE_API_EXPORT void iree_vm_ref_object_release(
@@ -42,7 +64,7 @@ IREE_API_EXPORT void iree_vm_ref_object_release(
   if (!ptr) return;
   volatile iree_atomic_ref_count_t* counter =
       iree_vm_get_raw_counter_ptr(ptr, type_descriptor);
-  if (iree_atomic_ref_count_dec(counter) == 1) {
+  if (iree_vm_ref_counter_dec(counter) == 1) {
     if (type_descriptor->destroy) {
       // NOTE: this makes us not re-entrant, but I think that's OK.
       type_descriptor->destroy(ptr);
@@ -150,7 +172,7 @@ IREE_API_EXPORT iree_status_t iree_vm_ref_wrap_retain(void* ptr,
   if (out_ref->ptr) {
     volatile iree_atomic_ref_count_t* counter =
         iree_vm_get_ref_counter_ptr(out_ref);
-    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_counter_inc(counter);
     iree_vm_ref_trace("WRAP RETAIN", out_ref);
   }
   return iree_ok_status();
@@ -160,7 +182,7 @@ IREE_API_EXPORT void iree_vm_ref_retain_inplace(iree_vm_ref_t* ref) {
   if (ref->ptr) {
     volatile iree_atomic_ref_count_t* counter =
         iree_vm_get_ref_counter_ptr(ref);
-    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_counter_inc(counter);
     iree_vm_ref_trace("RETAIN", ref);
   }
 }
@@ -173,7 +195,7 @@ IREE_API_EXPORT void iree_vm_ref_retain(iree_vm_ref_t* ref,
   if (ref->ptr) {
     volatile iree_atomic_ref_count_t* counter =
         iree_vm_get_ref_counter_ptr(ref);
-    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_counter_inc(counter);
     iree_vm_ref_trace("RETAIN", ref);
   }
   if (out_ref->ptr) {
@@ -223,7 +245,7 @@ IREE_API_EXPORT void iree_vm_ref_release(iree_vm_ref_t* ref) {
 
   iree_vm_ref_trace("RELEASE", ref);
   volatile iree_atomic_ref_count_t* counter = iree_vm_get_ref_counter_ptr(ref);
-  if (iree_atomic_ref_count_dec(counter) == 1) {
+  if (iree_vm_ref_counter_dec(counter) == 1) {
     const iree_vm_ref_type_descriptor_t* type_descriptor =
         iree_vm_ref_get_type_descriptor(ref->type);
     if (type_descriptor->destroy) {
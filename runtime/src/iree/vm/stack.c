@@ -15,6 +15,7 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 #include "iree/vm/module.h"
+#include "iree/vm/profiler.h"
 
 #ifndef NDEBUG
 #define VMCHECK(expr) assert(expr)
@@ -188,6 +189,11 @@ struct iree_vm_stack_t {
   // Allocator used for dynamic stack allocations. May be the null allocator
   // if growth is prohibited.
   iree_allocator_t allocator;
+
+  // Optional profiler sampling the stack and the time of the last sample.
+  iree_vm_profiler_t* profiler;
+  iree_duration_t profile_sample_interval_ns;
+  iree_time_t profile_last_sample_ns;
 };
 
 //===----------------------------------------------------------------------===//
@@ -299,6 +305,60 @@ iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack) {
   return stack->flags;
 }
 
+IREE_API_EXPORT void iree_vm_stack_set_profiler(iree_vm_stack_t* stack,
+                                                iree_vm_profiler_t* profiler) {
+  stack->profiler = profiler;
+  if (profiler) {
+    stack->profile_sample_interval_ns =
+        iree_vm_profiler_sample_interval(profiler);
+    stack->profile_last_sample_ns = iree_time_now();
+  }
+}
+
+#if IREE_VM_PROFILING_ENABLE
+
+// Samples the frame chain of |stack| if the sample interval has elapsed.
+// Called on every frame transition prior to changing the frame chain. The
+// sample is weighted by the time since the last sample such that time spent in
+// native calls and waits is attributed to the frames performing them.
+static void iree_vm_stack_sample(iree_vm_stack_t* stack) {
+  iree_time_t now_ns = iree_time_now();
+  iree_duration_t elapsed_ns = now_ns - stack->profile_last_sample_ns;
+  if (elapsed_ns < stack->profile_sample_interval_ns) return;
+  stack->profile_last_sample_ns = now_ns;
+
+  // Walk top->bottom and fill frames bottom->top; frames beyond the maximum
+  // depth are dropped from the root. External frames carry no information.
+  iree_vm_profiler_frame_t frames[IREE_VM_PROFILER_MAX_DEPTH];
+  iree_host_size_t frame_base = IREE_ARRAYSIZE(frames);
+  for (iree_vm_stack_frame_header_t* frame_header = stack->top;
+       frame_header != NULL && frame_base > 0;
+       frame_header = frame_header->parent) {
+    const iree_vm_stack_frame_t* frame = &frame_header->frame;
+    if (frame->type != IREE_VM_STACK_FRAME_WAIT && !frame->function.module) {
+      continue;
+    }
+    iree_vm_profiler_frame_t* profiler_frame = &frames[--frame_base];
+    profiler_frame->type = frame->type;
+    profiler_frame->function = frame->function;
+    profiler_frame->pc = frame->pc;
+  }
+  iree_vm_profiler_record_sample(stack->profiler,
+                                 IREE_ARRAYSIZE(frames) - frame_base,
+                                 &frames[frame_base], elapsed_ns);
+}
+
+#define IREE_VM_STACK_SAMPLE(stack)       \
+  if (IREE_UNLIKELY((stack)->profiler)) { \
+    iree_vm_stack_sample(stack);          \
+  }
+
+#else
+
+#define IREE_VM_STACK_SAMPLE(stack)
+
+#endif  // IREE_VM_PROFILING_ENABLE
+
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack) {
   if (!stack->top) {
@@ -442,6 +502,8 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_enter(
       sizeof(iree_vm_wait_frame_t) + wait_count * sizeof(iree_wait_source_t),
       16);
 
+  IREE_VM_STACK_SAMPLE(stack);
+
   // Allocate stack space and grow stack, if required.
   iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
   iree_host_size_t new_top =
@@ -505,6 +567,9 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_leave(
                             "unbalanced wait leave");
   }
 
+  // Attribute the time spent waiting to the wait frame.
+  IREE_VM_STACK_SAMPLE(stack);
+
   // Fetch wait status from the wait storage.
   iree_vm_wait_frame_t* wait_frame =
       iree_vm_stack_frame_storage(&stack->top->frame);
@@ -551,6 +616,8 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
     iree_vm_stack_frame_t** out_callee_frame) {
   if (out_callee_frame) *out_callee_frame = NULL;
 
+  IREE_VM_STACK_SAMPLE(stack);
+
   // Allocate stack space and grow stack, if required.
   iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
   iree_host_size_t new_top =
@@ -612,6 +679,8 @@ iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
                             "unbalanced stack leave");
   }
 
+  IREE_VM_STACK_SAMPLE(stack);
+
   // Call (optional) frame storage cleanup function.
   if (stack->top->frame_cleanup_fn) {
     stack->top->frame_cleanup_fn(&stack->top->frame);
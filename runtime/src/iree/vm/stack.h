@@ -165,6 +165,9 @@ typedef struct iree_vm_state_resolver_t {
       iree_vm_module_state_t** out_module_state);
 } iree_vm_state_resolver_t;
 
+// Profiler sampling stacks. See iree/vm/profiler.h.
+typedef struct iree_vm_profiler_t iree_vm_profiler_t;
+
 // A fiber stack used for storing stack frame state during execution.
 // All required state is stored within the stack and no host thread-local state
 // is used allowing us to execute multiple fibers on the same host thread.
@@ -251,6 +254,13 @@ iree_vm_stack_allocator(const iree_vm_stack_t* stack);
 IREE_API_EXPORT iree_vm_invocation_flags_t
 iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack);
 
+// Sets the |profiler| sampling the frame chain of |stack| as frames are entered
+// and left or NULL to stop sampling. The profiler is not retained and must
+// remain live while set. Samples are only taken when compiled with
+// IREE_VM_PROFILING_ENABLE.
+IREE_API_EXPORT void iree_vm_stack_set_profiler(iree_vm_stack_t* stack,
+                                                iree_vm_profiler_t* profiler);
+
 // Returns the top stack execution frame, ignore wait frames.
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack);
@@ -0,0 +1,152 @@
+// RUN: iree-run-mlir --iree-input-type=none --iree-hal-target-backends=llvm-cpu %s --input=1x512xf32=1 | FileCheck %s
+// RUN: [[ $IREE_VULKAN_DISABLE == 1 ]] || (iree-run-mlir --iree-input-type=none --iree-hal-target-backends=vulkan-spirv %s --input=1x512xf32=1 | FileCheck %s)
+
+// Single transformer block decode step with placeholder weights, for testing
+// and benchmarking autoregressive decoding.
+//
+// Each call consumes the embedding of one token, appends its keys and values
+// to the KV cache held in globals, and attends over all cached positions. The
+// attended sequence length is dynamic and grows by one per call until the
+// cache capacity (1024) is reached, after which the position wraps around so
+// that repeated invocations sweep through all sequence lengths.
+//
+// Weights are 2^-10 so that the results for uniform inputs are exact.
+
+// CHECK-LABEL: EXEC @decode_step
+// CHECK: 1x512xf32=[2.5 2.5 2.5
+
+module {
+  util.global private @wq = dense<9.765625e-04> : tensor<512x512xf32>
+  util.global private @wk = dense<9.765625e-04> : tensor<512x512xf32>
+  util.global private @wv = dense<9.765625e-04> : tensor<512x512xf32>
+  util.global private @wo = dense<9.765625e-04> : tensor<512x512xf32>
+  util.global private @w1 = dense<9.765625e-04> : tensor<512x2048xf32>
+  util.global private @w2 = dense<9.765625e-04> : tensor<2048x512xf32>
+
+  // Position of the next token in the KV cache.
+  util.global private mutable @position = dense<0> : tensor<i32>
+  // Keys and values of all previous tokens as [position, head, head_dim].
+  util.global private mutable @k_cache = dense<0.0> : tensor<1024x8x64xf32>
+  util.global private mutable @v_cache = dense<0.0> : tensor<1024x8x64xf32>
+
+  func.func @decode_step(%x: tensor<1x512xf32>) -> tensor<1x512xf32> {
+    %c1 = arith.constant 1 : index
+    %c1024 = arith.constant 1024 : index
+    %zero = arith.constant 0.0 : f32
+    %min_f32 = arith.constant -3.40282347E+38 : f32
+    %scale = arith.constant 1.250000e-01 : f32
+
+    %position_tensor = util.global.load @position : tensor<i32>
+    %position_i32 = tensor.extract %position_tensor[] : tensor<i32>
+    %position = arith.index_cast %position_i32 : i32 to index
+    %length = arith.addi %position, %c1 : index
+
+    // Query, key, and value projections.
+    %wq = util.global.load @wq : tensor<512x512xf32>
+    %wk = util.global.load @wk : tensor<512x512xf32>
+    %wv = util.global.load @wv : tensor<512x512xf32>
+    %empty_1x512 = tensor.empty() : tensor<1x512xf32>
+    %zero_1x512 = linalg.fill ins(%zero : f32) outs(%empty_1x512 : tensor<1x512xf32>) -> tensor<1x512xf32>
+    %q = linalg.matmul ins(%x, %wq : tensor<1x512xf32>, tensor<512x512xf32>) outs(%zero_1x512 : tensor<1x512xf32>) -> tensor<1x512xf32>
+    %k = linalg.matmul ins(%x, %wk : tensor<1x512xf32>, tensor<512x512xf32>) outs(%zero_1x512 : tensor<1x512xf32>) -> tensor<1x512xf32>
+    %v = linalg.matmul ins(%x, %wv : tensor<1x512xf32>, tensor<512x512xf32>) outs(%zero_1x512 : tensor<1x512xf32>) -> tensor<1x512xf32>
+    %q_flat = tensor.collapse_shape %q [[0, 1]] : tensor<1x512xf32> into tensor<512xf32>
+    %q_heads = tensor.expand_shape %q_flat [[0, 1]] : tensor<512xf32> into tensor<8x64xf32>
+    %k_heads = tensor.expand_shape %k [[0], [1, 2]] : tensor<1x512xf32> into tensor<1x8x64xf32>
+    %v_heads = tensor.expand_shape %v [[0], [1, 2]] : tensor<1x512xf32> into tensor<1x8x64xf32>
+
+    // Append the key and value to the cache.
+    %k_cache = util.global.load @k_cache : tensor<1024x8x64xf32>
+    %v_cache = util.global.load @v_cache : tensor<1024x8x64xf32>
+    %new_k_cache = tensor.insert_slice %k_heads into %k_cache[%position, 0, 0] [1, 8, 64] [1, 1, 1] : tensor<1x8x64xf32> into tensor<1024x8x64xf32>
+    %new_v_cache = tensor.insert_slice %v_heads into %v_cache[%position, 0, 0] [1, 8, 64] [1, 1, 1] : tensor<1x8x64xf32> into tensor<1024x8x64xf32>
+    util.global.store %new_k_cache, @k_cache : tensor<1024x8x64xf32>
+    util.global.store %new_v_cache, @v_cache : tensor<1024x8x64xf32>
+    %keys = tensor.extract_slice %new_k_cache[0, 0, 0] [%length, 8, 64] [1, 1, 1] : tensor<1024x8x64xf32> to tensor<?x8x64xf32>
+    %values = tensor.extract_slice %new_v_cache[0, 0, 0] [%length, 8, 64] [1, 1, 1] : tensor<1024x8x64xf32> to tensor<?x8x64xf32>
+
+    // Attention scores as [head, position].
+    %empty_scores = tensor.empty(%length) : tensor<8x?xf32>
+    %zero_scores = linalg.fill ins(%zero : f32) outs(%empty_scores : tensor<8x?xf32>) -> tensor<8x?xf32>
+    %scores = linalg.generic {indexing_maps = [affine_map<(h, s, d) -> (h, d)>, affine_map<(h, s, d) -> (s, h, d)>, affine_map<(h, s, d) -> (h, s)>], iterator_types = ["parallel", "parallel", "reduction"]} ins(%q_heads, %keys : tensor<8x64xf32>, tensor<?x8x64xf32>) outs(%zero_scores : tensor<8x?xf32>) {
+    ^bb0(%lhs: f32, %rhs: f32, %acc: f32):
+      %mul = arith.mulf %lhs, %rhs : f32
+      %add = arith.addf %acc, %mul : f32
+      linalg.yield %add : f32
+    } -> tensor<8x?xf32>
+
+    // Softmax over the positions of each head.
+    %empty_8 = tensor.empty() : tensor<8xf32>
+    %min_8 = linalg.fill ins(%min_f32 : f32) outs(%empty_8 : tensor<8xf32>) -> tensor<8xf32>
+    %max = linalg.generic {indexing_maps = [affine_map<(h, s) -> (h, s)>, affine_map<(h, s) -> (h)>], iterator_types = ["parallel", "reduction"]} ins(%scores : tensor<8x?xf32>) outs(%min_8 : tensor<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.maxf %in, %acc : f32
+      linalg.yield %0 : f32
+    } -> tensor<8xf32>
+    %exp = linalg.generic {indexing_maps = [affine_map<(h, s) -> (h, s)>, affine_map<(h, s) -> (h)>, affine_map<(h, s) -> (h, s)>], iterator_types = ["parallel", "parallel"]} ins(%scores, %max : tensor<8x?xf32>, tensor<8xf32>) outs(%empty_scores : tensor<8x?xf32>) {
+    ^bb0(%in: f32, %in_max: f32, %out: f32):
+      %0 = arith.subf %in, %in_max : f32
+      %1 = arith.mulf %0, %scale : f32
+      %2 = math.exp %1 : f32
+      linalg.yield %2 : f32
+    } -> tensor<8x?xf32>
+    %zero_8 = linalg.fill ins(%zero : f32) outs(%empty_8 : tensor<8xf32>) -> tensor<8xf32>
+    %sum = linalg.generic {indexing_maps = [affine_map<(h, s) -> (h, s)>, affine_map<(h, s) -> (h)>], iterator_types = ["parallel", "reduction"]} ins(%exp : tensor<8x?xf32>) outs(%zero_8 : tensor<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.addf %in, %acc : f32
+      linalg.yield %0 : f32
+    } -> tensor<8xf32>
+    %probs = linalg.generic {indexing_maps = [affine_map<(h, s) -> (h, s)>, affine_map<(h, s) -> (h)>, affine_map<(h, s) -> (h, s)>], iterator_types = ["parallel", "parallel"]} ins(%exp, %sum : tensor<8x?xf32>, tensor<8xf32>) outs(%empty_scores : tensor<8x?xf32>) {
+    ^bb0(%in: f32, %in_sum: f32, %out: f32):
+      %0 = arith.divf %in, %in_sum : f32
+      linalg.yield %0 : f32
+    } -> tensor<8x?xf32>
+
+    // Weighted sum of the values as [head, head_dim].
+    %empty_8x64 = tensor.empty() : tensor<8x64xf32>
+    %zero_8x64 = linalg.fill ins(%zero : f32) outs(%empty_8x64 : tensor<8x64xf32>) -> tensor<8x64xf32>
+    %context = linalg.generic {indexing_maps = [affine_map<(h, d, s) -> (h, s)>, affine_map<(h, d, s) -> (s, h, d)>, affine_map<(h, d, s) -> (h, d)>], iterator_types = ["parallel", "parallel", "reduction"]} ins(%probs, %values : tensor<8x?xf32>, tensor<?x8x64xf32>) outs(%zero_8x64 : tensor<8x64xf32>) {
+    ^bb0(%lhs: f32, %rhs: f32, %acc: f32):
+      %mul = arith.mulf %lhs, %rhs : f32
+      %add = arith.addf %acc, %mul : f32
+      linalg.yield %add : f32
+    } -> tensor<8x64xf32>
+    %context_flat = tensor.collapse_shape %context [[0, 1]] : tensor<8x64xf32> into tensor<512xf32>
+    %context_row = tensor.expand_shape %context_flat [[0, 1]] : tensor<512xf32> into tensor<1x512xf32>
+
+    // Output projection and residual.
+    %wo = util.global.load @wo : tensor<512x512xf32>
+    %attention = linalg.matmul ins(%context_row, %wo : tensor<1x512xf32>, tensor<512x512xf32>) outs(%zero_1x512 : tensor<1x512xf32>) -> tensor<1x512xf32>
+    %h = linalg.generic {indexing_maps = [affine_map<(i, j) -> (i, j)>, affine_map<(i, j) -> (i, j)>, affine_map<(i, j) -> (i, j)>], iterator_types = ["parallel", "parallel"]} ins(%x, %attention : tensor<1x512xf32>, tensor<1x512xf32>) outs(%empty_1x512 : tensor<1x512xf32>) {
+    ^bb0(%lhs: f32, %rhs: f32, %out: f32):
+      %0 = arith.addf %lhs, %rhs : f32
+      linalg.yield %0 : f32
+    } -> tensor<1x512xf32>
+
+    // Feed-forward with ReLU and residual.
+    %w1 = util.global.load @w1 : tensor<512x2048xf32>
+    %w2 = util.global.load @w2 : tensor<2048x512xf32>
+    %empty_1x2048 = tensor.empty() : tensor<1x2048xf32>
+    %zero_1x2048 = linalg.fill ins(%zero : f32) outs(%empty_1x2048 : tensor<1x2048xf32>) -> tensor<1x2048xf32>
+    %up = linalg.matmul ins(%h, %w1 : tensor<1x512xf32>, tensor<512x2048xf32>) outs(%zero_1x2048 : tensor<1x2048xf32>) -> tensor<1x2048xf32>
+    %relu = linalg.generic {indexing_maps = [affine_map<(i, j) -> (i, j)>, affine_map<(i, j) -> (i, j)>], iterator_types = ["parallel", "parallel"]} ins(%up : tensor<1x2048xf32>) outs(%empty_1x2048 : tensor<1x2048xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.maxf %in, %zero : f32
+      linalg.yield %0 : f32
+    } -> tensor<1x2048xf32>
+    %down = linalg.matmul ins(%relu, %w2 : tensor<1x2048xf32>, tensor<2048x512xf32>) outs(%zero_1x512 : tensor<1x512xf32>) -> tensor<1x512xf32>
+    %result = linalg.generic {indexing_maps = [affine_map<(i, j) -> (i, j)>, affine_map<(i, j) -> (i, j)>, affine_map<(i, j) -> (i, j)>], iterator_types = ["parallel", "parallel"]} ins(%h, %down : tensor<1x512xf32>, tensor<1x512xf32>) outs(%empty_1x512 : tensor<1x512xf32>) {
+    ^bb0(%lhs: f32, %rhs: f32, %out: f32):
+      %0 = arith.addf %lhs, %rhs : f32
+      linalg.yield %0 : f32
+    } -> tensor<1x512xf32>
+
+    // Advance the position, wrapping around at the cache capacity.
+    %next = arith.remui %length, %c1024 : index
+    %next_i32 = arith.index_cast %next : index to i32
+    %next_tensor = tensor.from_elements %next_i32 : tensor<i32>
+    util.global.store %next_tensor, @position : tensor<i32>
+
+    return %result : tensor<1x512xf32>
+  }
+}
@@ -147,3 +147,12 @@ iree_fetch_artifact(
     "${ROOT_ARTIFACTS_DIR}/model_c393b4fa-beb4-45d5-982a-c6328aa05d08_Resnet50TF"
   UNPACK
 )
+
+iree_fetch_artifact(
+  NAME
+    "model-a4407779-3058-45b8-a507-ce1cd76238ff"
+  SOURCE_URL
+    "file://${IREE_ROOT_DIR}/tests/e2e/models/transformer_decode_fake_weights.mlir"
+  OUTPUT
+    "${ROOT_ARTIFACTS_DIR}/model_a4407779-3058-45b8-a507-ce1cd76238ff_TransformerDecode.mlir"
+)
@@ -51,11 +51,38 @@
 // how the full program will run, though, and YMMV. Always verify timings with
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
-
+//
+// Google Benchmark iterations are closed-loop: each invocation is issued as
+// soon as the prior one completes and queueing delays never show up in the
+// results. To measure a function under a given offered load pass
+// --open_loop_qps=N along with --function=: invocations then arrive at random
+// (Poisson) intervals averaging N per second, up to --open_loop_concurrency of
+// them run concurrently, and the latency of each from its arrival to its
+// completion is reported as percentiles along with the achieved throughput.
+//
+// Benchmarks only report steady-state behavior. To see where cold-start time
+// goes pass --startup_profile=file.json: the time spent reading and creating
+// the module, creating the HAL module, preparing executables and uploading
+// constants during context creation, and the first invocation of --function=
+// versus the following --startup_profile_steady_iterations= invocations is
+// written to the file as JSON before the benchmarks run.
+//
+// To find which dispatches dominate a benchmark pass
+// --device_profiling_mode=executable and optionally --device_profiling_file=:
+// the local CPU (local-sync/local-task), Vulkan and CUDA drivers write a CSV
+// table with the call count and total/mean time of each executable export,
+// sorted with the most expensive first. --device_profiling_mode=dispatch
+// instead lists each dispatch in execution order where the driver supports it.
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <cstdio>
 #include <iterator>
+#include <random>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -68,6 +95,7 @@
 #include "iree/modules/hal/types.h"
 #include "iree/tooling/context_util.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/startup_profile.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/vm/api.h"
 
@@ -92,6 +120,18 @@ IREE_FLAG(string, function, "",
 IREE_FLAG(bool, print_statistics, false,
           "Prints runtime statistics to stderr on exit.");
 
+IREE_FLAG(double, open_loop_qps, 0.0,
+          "Runs --function open-loop at the given target rate of invocations "
+          "per second with Poisson arrivals instead of running Google "
+          "Benchmark iterations. 0 disables the open-loop mode.");
+IREE_FLAG(int32_t, open_loop_concurrency, 1,
+          "Maximum number of open-loop invocations in flight. Each runs on its "
+          "own thread in its own fork of the VM context.");
+IREE_FLAG(int32_t, open_loop_request_count, 1000,
+          "Total number of invocations issued in open-loop mode.");
+IREE_FLAG(int64_t, open_loop_seed, 0,
+          "Seed of the random open-loop arrival process.");
+
 IREE_FLAG_LIST(
     string, input,
     "An input value or buffer of the format:\n"
@@ -103,6 +143,8 @@ IREE_FLAG_LIST(
     "  2x2xi32=@some/file.bin\n"
     "numpy npy files (from numpy.save) can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "safetensors files are mapped to provide 1+ values without copying:\n"
+    "  @some.safetensors\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
 
@@ -403,6 +445,152 @@ void RegisterDispatchBenchmark(const std::string& function_name,
                                   : benchmark::kMicrosecond);
 }
 
+// Invokes |function| once with a copy of |common_inputs| and waits for it to
+// complete, including any asynchronous device work.
+static iree_status_t InvokeOpenLoopRequest(iree_hal_device_t* device,
+                                           iree_vm_context_t* context,
+                                           iree_vm_function_t function,
+                                           iree_vm_list_t* common_inputs) {
+  IREE_TRACE_SCOPE0("OpenLoopRequest");
+  iree_allocator_t host_allocator = iree_allocator_system();
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_clone(common_inputs, host_allocator, &inputs));
+  vm::ref<iree_hal_fence_t> signal_fence;
+  IREE_RETURN_IF_ERROR(iree_tooling_append_async_fence_inputs(
+      inputs.get(), &function, device, /*wait_fence=*/nullptr,
+      &signal_fence));
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 16,
+                                           host_allocator, &outputs));
+  IREE_RETURN_IF_ERROR(iree_vm_invoke(
+      context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+      inputs.get(), outputs.get(), host_allocator));
+  if (signal_fence) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_fence_wait(signal_fence.get(), iree_infinite_timeout()));
+  }
+  return iree_ok_status();
+}
+
+// Returns the |percentile| (0-100) of the sorted |values|.
+static iree_duration_t Percentile(const std::vector<iree_duration_t>& values,
+                                  double percentile) {
+  size_t rank = (size_t)std::ceil(percentile / 100.0 * values.size());
+  return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+}
+
+// Issues |request_count| invocations of |function| arriving at exponentially
+// distributed intervals averaging 1/|qps| seconds and prints the latency
+// distribution and achieved throughput.
+//
+// Requests are served in arrival order by |concurrency| threads each invoking
+// in its own fork of |context|. A request arriving while all threads are busy
+// waits for one to become available and that queueing delay is included in its
+// latency, as it would be for a server under the same load.
+static iree_status_t RunOpenLoop(const std::string& function_name,
+                                 iree_hal_device_t* device,
+                                 iree_vm_context_t* context,
+                                 iree_vm_function_t function,
+                                 iree_vm_list_t* inputs, double qps,
+                                 int32_t concurrency, int32_t request_count) {
+  IREE_TRACE_SCOPE0("RunOpenLoop");
+  if (qps <= 0.0 || concurrency <= 0 || request_count <= 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "open-loop mode requires positive rate, "
+                            "concurrency, and request count");
+  }
+
+  // Warm up once so that lazily loaded resources are shared by all forks and
+  // do not count against the first requests.
+  IREE_RETURN_IF_ERROR(
+      InvokeOpenLoopRequest(device, context, function, inputs));
+
+  std::vector<vm::ref<iree_vm_context_t>> contexts(concurrency);
+  for (int32_t i = 0; i < concurrency; ++i) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_context_fork(context, iree_allocator_system(), &contexts[i]));
+  }
+
+  // Poisson arrivals have exponentially distributed interarrival times.
+  std::mt19937_64 rng((uint64_t)FLAG_open_loop_seed);
+  std::exponential_distribution<double> interarrival_seconds(qps);
+  std::vector<iree_duration_t> arrival_offsets(request_count);
+  double offset_seconds = 0.0;
+  for (int32_t i = 0; i < request_count; ++i) {
+    offset_seconds += interarrival_seconds(rng);
+    arrival_offsets[i] = (iree_duration_t)(offset_seconds * 1e9);
+  }
+
+  std::vector<iree_duration_t> latencies(request_count);
+  std::vector<iree_status_t> worker_statuses(concurrency, iree_ok_status());
+  std::atomic<int32_t> next_request(0);
+  iree_time_t start_time_ns = iree_time_now();
+  std::vector<std::thread> workers;
+  for (int32_t i = 0; i < concurrency; ++i) {
+    workers.emplace_back([&, i]() {
+      for (;;) {
+        int32_t request = next_request.fetch_add(1, std::memory_order_relaxed);
+        if (request >= request_count) break;
+        iree_time_t arrival_time_ns = start_time_ns + arrival_offsets[request];
+        iree_wait_until(arrival_time_ns);
+        iree_status_t status = InvokeOpenLoopRequest(
+            device, contexts[i].get(), function, inputs);
+        if (!iree_status_is_ok(status)) {
+          worker_statuses[i] = status;
+          // Drain the remaining requests so that the other workers stop.
+          next_request.store(request_count, std::memory_order_relaxed);
+          break;
+        }
+        latencies[request] = iree_time_now() - arrival_time_ns;
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  iree_time_t end_time_ns = iree_time_now();
+
+  iree_status_t status = iree_ok_status();
+  for (iree_status_t& worker_status : worker_statuses) {
+    if (iree_status_is_ok(status)) {
+      status = worker_status;
+    } else {
+      iree_status_ignore(worker_status);
+    }
+  }
+  IREE_RETURN_IF_ERROR(status);
+
+  double total_latency_ns = 0.0;
+  for (iree_duration_t latency : latencies) total_latency_ns += latency;
+  std::sort(latencies.begin(), latencies.end());
+
+  benchmark::TimeUnit time_unit =
+      FLAG_time_unit.first ? FLAG_time_unit.second : benchmark::kMillisecond;
+  double ns_per_unit = 1e6;
+  const char* unit_string = kMillisecondsUnitString;
+  if (time_unit == benchmark::kMicrosecond) {
+    ns_per_unit = 1e3;
+    unit_string = kMicrosecondsUnitString;
+  } else if (time_unit == benchmark::kNanosecond) {
+    ns_per_unit = 1.0;
+    unit_string = kNanosecondsUnitString;
+  }
+  double elapsed_seconds = (end_time_ns - start_time_ns) / 1e9;
+  fprintf(stdout,
+          "BM_%s/open_loop target_qps=%.2f concurrency=%d requests=%d\n"
+          "  achieved_qps: %.2f\n"
+          "  latency (%s): mean=%.3f p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f "
+          "max=%.3f\n",
+          function_name.c_str(), qps, concurrency, request_count,
+          request_count / elapsed_seconds, unit_string,
+          total_latency_ns / request_count / ns_per_unit,
+          Percentile(latencies, 50.0) / ns_per_unit,
+          Percentile(latencies, 90.0) / ns_per_unit,
+          Percentile(latencies, 99.0) / ns_per_unit,
+          Percentile(latencies, 99.9) / ns_per_unit,
+          latencies.back() / ns_per_unit);
+  return iree_ok_status();
+}
+
 // The lifetime of IREEBenchmark should be as long as
 // ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
 // benchmarking.
@@ -413,6 +601,10 @@ class IREEBenchmark {
   ~IREEBenchmark() {
     IREE_TRACE_SCOPE0("IREEBenchmark::dtor");
 
+    // Executables are released with the context so counters must be printed
+    // while it is still live.
+    IREE_IGNORE_ERROR(iree_hal_executable_counters_fprint(stderr));
+
     // Order matters. Tear down modules first to release resources.
     inputs_.reset();
     context_.reset();
@@ -424,6 +616,10 @@ class IREEBenchmark {
       IREE_IGNORE_ERROR(iree_hal_allocator_statistics_fprint(
           stderr, device_allocator_.get()));
     }
+    if (device_ && FLAG_print_statistics) {
+      IREE_IGNORE_ERROR(
+          iree_hal_device_task_statistics_fprint(stderr, device_.get()));
+    }
     device_allocator_.reset();
     device_.reset();
   };
@@ -440,17 +636,64 @@ class IREEBenchmark {
     auto function_name = std::string(FLAG_function);
     if (!function_name.empty()) {
       IREE_RETURN_IF_ERROR(RegisterSpecificFunction(function_name));
+      IREE_RETURN_IF_ERROR(ProfileStartup(function_name));
     } else {
       IREE_RETURN_IF_ERROR(RegisterAllExportedFunctions());
+      IREE_RETURN_IF_ERROR(iree_tooling_startup_profile_write_from_flags(
+          IREE_SV("iree-benchmark-module"), iree_string_view_empty()));
     }
     return iree_ok_status();
   }
 
+  // Runs --function in open-loop mode instead of registering benchmarks.
+  iree_status_t RunOpenLoop() {
+    IREE_TRACE_SCOPE0("IREEBenchmark::RunOpenLoop");
+    auto function_name = std::string(FLAG_function);
+    if (function_name.empty()) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "open-loop mode requires --function=");
+    }
+    if (!instance_ || !device_allocator_ || !context_ || !main_module_) {
+      IREE_RETURN_IF_ERROR(Init());
+    }
+
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        main_module_.get(), IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_string_view_t{function_name.data(), function_name.size()},
+        &function));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_set_recording_allocation_label(IREE_SV("inputs")));
+    IREE_RETURN_IF_ERROR(iree_tooling_parse_to_variant_list(
+        device_allocator_.get(), FLAG_input_list().values,
+        FLAG_input_list().count, iree_vm_instance_allocator(instance_.get()),
+        &inputs_));
+    IREE_RETURN_IF_ERROR(iree_hal_set_recording_allocation_label(
+        iree_string_view_t{function_name.data(), function_name.size()}));
+
+    IREE_RETURN_IF_ERROR(iree_hal_begin_profiling_from_flags(device_.get()));
+    iree_status_t status = iree::RunOpenLoop(
+        function_name, device_.get(), context_.get(), function, inputs_.get(),
+        FLAG_open_loop_qps, FLAG_open_loop_concurrency,
+        FLAG_open_loop_request_count);
+    iree_status_t end_status =
+        iree_hal_end_profiling_from_flags(device_.get());
+    if (iree_status_is_ok(status)) {
+      status = end_status;
+    } else {
+      iree_status_ignore(end_status);
+    }
+    return status;
+  }
+
  private:
   iree_status_t Init() {
     IREE_TRACE_SCOPE0("IREEBenchmark::Init");
     IREE_TRACE_FRAME_MARK_BEGIN_NAMED("init");
 
+    // Counter collection must be enabled before any executables are loaded.
+    IREE_RETURN_IF_ERROR(iree_hal_begin_executable_counters_from_flags());
+
     iree_allocator_t host_allocator = iree_allocator_system();
     IREE_RETURN_IF_ERROR(
         iree_tooling_create_instance(host_allocator, &instance_));
@@ -477,10 +720,14 @@ class IREEBenchmark {
         iree_string_view_t{function_name.data(), function_name.size()},
         &function));
 
+    IREE_RETURN_IF_ERROR(
+        iree_hal_set_recording_allocation_label(IREE_SV("inputs")));
     IREE_CHECK_OK(iree_tooling_parse_to_variant_list(
         device_allocator_.get(), FLAG_input_list().values,
         FLAG_input_list().count, iree_vm_instance_allocator(instance_.get()),
         &inputs_));
+    IREE_RETURN_IF_ERROR(iree_hal_set_recording_allocation_label(
+        iree_string_view_t{function_name.data(), function_name.size()}));
 
     iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
         &function, IREE_SV("iree.abi.model"));
@@ -496,6 +743,36 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
+  // Times the first and steady-state invocations of |function_name| ahead of
+  // the benchmarks and writes the startup profile if one was requested.
+  iree_status_t ProfileStartup(const std::string& function_name) {
+    if (!iree_tooling_startup_profile_requested()) return iree_ok_status();
+    IREE_TRACE_SCOPE0("IREEBenchmark::ProfileStartup");
+
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        main_module_.get(), IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_string_view_t{function_name.data(), function_name.size()},
+        &function));
+
+    iree_allocator_t host_allocator = iree_allocator_system();
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 16,
+                                             host_allocator, &outputs));
+    iree_host_size_t call_count =
+        1 + iree_tooling_startup_profile_steady_iteration_count();
+    for (iree_host_size_t i = 0; i < call_count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_tooling_startup_profile_invoke(
+          context_.get(), function, device_.get(), inputs_.get(),
+          outputs.get(), host_allocator));
+      IREE_RETURN_IF_ERROR(iree_vm_list_resize(outputs.get(), 0));
+    }
+
+    return iree_tooling_startup_profile_write_from_flags(
+        IREE_SV("iree-benchmark-module"),
+        iree_string_view_t{function_name.data(), function_name.size()});
+  }
+
   iree_status_t RegisterAllExportedFunctions() {
     IREE_TRACE_SCOPE0("IREEBenchmark::RegisterAllExportedFunctions");
     iree_vm_module_signature_t signature =
@@ -585,6 +862,15 @@ int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   iree::IREEBenchmark iree_benchmark;
+  if (FLAG_open_loop_qps > 0.0) {
+    iree_status_t status = iree_benchmark.RunOpenLoop();
+    if (!iree_status_is_ok(status)) {
+      int ret = static_cast<int>(iree_status_code(status));
+      printf("%s\n", iree::Status(std::move(status)).ToString().c_str());
+      return ret;
+    }
+    return 0;
+  }
   iree_status_t status = iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
     int ret = static_cast<int>(iree_status_code(status));
@@ -6,6 +6,13 @@
 
 // DISCLAIMER: this is leaky under error conditions as it's a benchmark tool and
 // not a correctness test.
+//
+// By default each trace file is its own benchmark replaying its calls in order
+// on one thread. --trace_streams=N replays each trace on N concurrent streams
+// and --concurrent_traces runs all traces side by side in one benchmark so
+// that interference between tenants sharing a device can be reproduced from
+// captured traces; the latency distribution of each stream is printed after
+// the benchmark completes.
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,6 +21,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/internal/path.h"
+#include "iree/base/internal/threading.h"
 #include "iree/hal/api.h"
 #include "iree/testing/benchmark.h"
 #include "iree/tooling/device_util.h"
@@ -28,13 +36,41 @@ IREE_FLAG(int32_t, call_iterations, 1,
           "Number of times to invoke each call in the trace. May break usage "
           "with stateful models.");
 
-// A benchmark registration for each file to run.
-typedef struct iree_replay_benchmark_registration_t {
-  iree_benchmark_def_t benchmark_def;  // Must be first.
+IREE_FLAG(int32_t, trace_streams, 1,
+          "Number of streams replaying each trace concurrently on their own "
+          "threads. Each benchmark iteration replays all calls of the trace "
+          "once on every stream and the latency of each stream's replays is "
+          "reported when the benchmark completes.");
+
+IREE_FLAG(string, trace_stream_contexts, "shared",
+          "How streams replaying the same trace get their VM context: "
+          "`shared` loads the trace once and forks its context for each "
+          "stream so streams share modules, constants, executables and the "
+          "device; `separate` loads the trace independently for each stream "
+          "with its own context and device.");
+
+IREE_FLAG(bool, concurrent_traces, false,
+          "Replays all trace files concurrently as a single benchmark with "
+          "--trace_streams= streams each instead of benchmarking each file on "
+          "its own. Useful for measuring interference between models served "
+          "side by side.");
+
+// A trace file to replay.
+typedef struct iree_replay_benchmark_file_t {
   // Used for relative file path lookup when referencing files in the trace.
   iree_string_view_t root_path;
   // Trace file path.
   iree_string_view_t file_path;
+} iree_replay_benchmark_file_t;
+
+// A benchmark registration for each file to run.
+typedef struct iree_replay_benchmark_registration_t {
+  iree_benchmark_def_t benchmark_def;  // Must be first.
+  // Benchmark name used when reporting stream latencies.
+  iree_string_view_t name;
+  // Trace files replayed concurrently by the benchmark; usually one.
+  iree_host_size_t file_count;
+  const iree_replay_benchmark_file_t* files;
   // Shared VM instance. Unowned; callers must retain for the valid lifetime of
   // the registration.
   iree_vm_instance_t* instance;
@@ -188,19 +224,17 @@ static iree_status_t iree_replay_benchmark_load_trace(
   return status;
 }
 
-// Benchmark function that runs a trace file.
-static iree_status_t iree_replay_benchmark_run_file(
-    const iree_benchmark_def_t* benchmark_def,
-    iree_benchmark_state_t* benchmark_state) {
-  const iree_replay_benchmark_registration_t* registration =
-      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
-
+// Initializes |out_replay| and loads the trace |file| into it, appending its
+// calls to |call_list|.
+static iree_status_t iree_replay_benchmark_load_file(
+    const iree_replay_benchmark_file_t* file, iree_vm_instance_t* instance,
+    iree_trace_replay_t* out_replay,
+    iree_replay_benchmark_call_list_t* call_list) {
   // Setup replay state used for this benchmark.
-  iree_trace_replay_t replay;
   IREE_RETURN_IF_ERROR(iree_trace_replay_initialize(
-      registration->root_path, registration->instance,
-      IREE_VM_CONTEXT_FLAG_NONE, iree_hal_available_driver_registry(),
-      iree_allocator_system(), &replay));
+      file->root_path, instance, IREE_VM_CONTEXT_FLAG_NONE,
+      iree_hal_available_driver_registry(), iree_allocator_system(),
+      out_replay));
 
   // Query device overrides, if any. When omitted the devices from the trace
   // file will be used.
@@ -208,28 +242,49 @@ static iree_status_t iree_replay_benchmark_run_file(
   iree_host_size_t device_uri_count = 0;
   const iree_string_view_t* device_uris = NULL;
   iree_hal_get_devices_flag_list(&device_uri_count, &device_uris);
-  iree_trace_replay_set_hal_devices_override(&replay, device_uri_count,
+  iree_trace_replay_set_hal_devices_override(out_replay, device_uri_count,
                                              device_uris);
 
   // Load YAML file and setup replay state with all modules loaded and ready.
+  return iree_replay_benchmark_load_trace(file->file_path, out_replay,
+                                          call_list);
+}
+
+// Invokes each call in |call_list| in order against |context|.
+static iree_status_t iree_replay_benchmark_invoke_calls(
+    iree_vm_context_t* context, iree_replay_benchmark_call_list_t* call_list,
+    iree_allocator_t host_allocator) {
+  for (size_t i = 0; i < call_list->count; ++i) {
+    iree_replay_benchmark_call_t* call = &call_list->items[i];
+    for (int32_t j = 0; j < FLAG_call_iterations; ++j) {
+      IREE_RETURN_IF_ERROR(iree_vm_invoke(
+          context, call->function, IREE_VM_INVOCATION_FLAG_NONE,
+          /*policy=*/NULL, call->input_list, call->output_list,
+          host_allocator));
+      IREE_RETURN_IF_ERROR(iree_vm_list_resize(call->output_list, 0));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Benchmark function that runs a trace file.
+static iree_status_t iree_replay_benchmark_run_file(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_replay_benchmark_registration_t* registration =
+      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
+
+  iree_trace_replay_t replay;
   iree_replay_benchmark_call_list_t call_list;
   iree_replay_benchmark_call_list_initialize(&call_list);
-  IREE_RETURN_IF_ERROR(iree_replay_benchmark_load_trace(registration->file_path,
-                                                        &replay, &call_list));
+  IREE_RETURN_IF_ERROR(iree_replay_benchmark_load_file(
+      &registration->files[0], registration->instance, &replay, &call_list));
 
   // Call the functions within the trace in order.
   while (iree_benchmark_keep_running(benchmark_state,
                                      /*batch_count=*/FLAG_call_iterations)) {
-    for (size_t i = 0; i < call_list.count; ++i) {
-      iree_replay_benchmark_call_t* call = &call_list.items[i];
-      for (int32_t j = 0; j < FLAG_call_iterations; ++j) {
-        IREE_RETURN_IF_ERROR(iree_vm_invoke(
-            replay.context, call->function, IREE_VM_INVOCATION_FLAG_NONE,
-            /*policy=*/NULL, call->input_list, call->output_list,
-            replay.host_allocator));
-        IREE_RETURN_IF_ERROR(iree_vm_list_resize(call->output_list, 0));
-      }
-    }
+    IREE_RETURN_IF_ERROR(iree_replay_benchmark_invoke_calls(
+        replay.context, &call_list, replay.host_allocator));
   }
 
   iree_replay_benchmark_call_list_deinitialize(&call_list);
@@ -240,18 +295,249 @@ static iree_status_t iree_replay_benchmark_run_file(
   return iree_ok_status();
 }
 
-// Registers benchmarks for each trace file.
+//===----------------------------------------------------------------------===//
+// Concurrent streams
+//===----------------------------------------------------------------------===//
+
+// A stream replaying the calls of one trace on its own thread.
+typedef struct iree_replay_benchmark_stream_t {
+  // Trace file the stream replays.
+  const iree_replay_benchmark_file_t* file;
+  // Set if the stream loaded the trace into |replay| itself; otherwise the
+  // stream invokes in a fork of another stream's context.
+  bool owns_replay;
+  iree_trace_replay_t replay;
+  // Context the calls are invoked in.
+  iree_vm_context_t* context;
+  // Calls with inputs shared with the stream the context was forked from and
+  // outputs owned by this stream.
+  iree_replay_benchmark_call_list_t call_list;
+  // Duration of each replay of the call list.
+  size_t latency_count;
+  size_t latency_capacity;
+  iree_duration_t* latencies;
+  // Failure of the most recent replay, if any.
+  iree_status_t status;
+  // Thread running the current replay, if any.
+  iree_thread_t* thread;
+} iree_replay_benchmark_stream_t;
+
+// Sets up |stream| to replay the calls of |source| in a fork of its context.
+static iree_status_t iree_replay_benchmark_stream_fork(
+    iree_replay_benchmark_stream_t* source,
+    iree_replay_benchmark_stream_t* stream) {
+  IREE_RETURN_IF_ERROR(iree_vm_context_fork(
+      source->context, iree_allocator_system(), &stream->context));
+  for (size_t i = 0; i < source->call_list.count; ++i) {
+    const iree_replay_benchmark_call_t* source_call =
+        &source->call_list.items[i];
+    iree_replay_benchmark_call_t* call =
+        iree_replay_benchmark_call_list_acquire_back(&stream->call_list);
+    memset(call, 0, sizeof(*call));
+    call->function = source_call->function;
+    call->input_list = source_call->input_list;
+    iree_vm_list_retain(call->input_list);
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/NULL, /*initial_capacity=*/8, iree_allocator_system(),
+        &call->output_list));
+  }
+  return iree_ok_status();
+}
+
+// Thread entry point replaying the calls of a stream once.
+static int iree_replay_benchmark_stream_main(void* entry_arg) {
+  iree_replay_benchmark_stream_t* stream =
+      (iree_replay_benchmark_stream_t*)entry_arg;
+  iree_time_t start_time = iree_time_now();
+  stream->status = iree_replay_benchmark_invoke_calls(
+      stream->context, &stream->call_list, iree_allocator_system());
+  if (iree_status_is_ok(stream->status)) {
+    if (stream->latency_count >= stream->latency_capacity) {
+      stream->latency_capacity = iree_max(64, stream->latency_capacity * 2);
+      stream->latencies = (iree_duration_t*)realloc(
+          stream->latencies,
+          stream->latency_capacity * sizeof(*stream->latencies));
+    }
+    stream->latencies[stream->latency_count++] = iree_time_now() - start_time;
+  }
+  return 0;
+}
+
+// Replays all |streams| once concurrently and waits for them to complete.
+static iree_status_t iree_replay_benchmark_run_streams_once(
+    iree_host_size_t stream_count, iree_replay_benchmark_stream_t* streams) {
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = iree_make_cstring_view("iree-replay-stream");
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < stream_count; ++i) {
+    status = iree_thread_create(iree_replay_benchmark_stream_main, &streams[i],
+                                thread_params, iree_allocator_system(),
+                                &streams[i].thread);
+    if (!iree_status_is_ok(status)) break;
+  }
+  // Releasing a thread waits for it to exit.
+  for (iree_host_size_t i = 0; i < stream_count; ++i) {
+    iree_thread_release(streams[i].thread);
+    streams[i].thread = NULL;
+    status = iree_status_join(status, streams[i].status);
+    streams[i].status = iree_ok_status();
+  }
+  return status;
+}
+
+static int iree_replay_benchmark_compare_durations(const void* lhs_ptr,
+                                                   const void* rhs_ptr) {
+  iree_duration_t lhs = *(const iree_duration_t*)lhs_ptr;
+  iree_duration_t rhs = *(const iree_duration_t*)rhs_ptr;
+  return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+// Returns the |percentile| (0-100) of the sorted |values| in milliseconds.
+static double iree_replay_benchmark_percentile_ms(
+    size_t count, const iree_duration_t* values, double percentile) {
+  double exact_rank = percentile / 100.0 * count;
+  size_t rank = (size_t)exact_rank;
+  if ((double)rank < exact_rank) ++rank;
+  rank = iree_min(iree_max(rank, 1), count);
+  return values[rank - 1] / 1e6;
+}
+
+// Prints the latency distribution of each stream's replays.
+static void iree_replay_benchmark_print_stream_latencies(
+    iree_string_view_t name, iree_host_size_t stream_count,
+    iree_replay_benchmark_stream_t* streams) {
+  fprintf(stdout, "BM_%.*s/streams=%d contexts=%s\n", (int)name.size,
+          name.data, FLAG_trace_streams, FLAG_trace_stream_contexts);
+  for (iree_host_size_t i = 0; i < stream_count; ++i) {
+    iree_replay_benchmark_stream_t* stream = &streams[i];
+    iree_string_view_t stem = iree_file_path_stem(stream->file->file_path);
+    if (!stream->latency_count) continue;
+    double total_ms = 0.0;
+    for (size_t j = 0; j < stream->latency_count; ++j) {
+      total_ms += stream->latencies[j] / 1e6;
+    }
+    qsort(stream->latencies, stream->latency_count,
+          sizeof(*stream->latencies), iree_replay_benchmark_compare_durations);
+    fprintf(stdout,
+            "  stream %" PRIhsz " (%.*s): replays=%zu latency (ms): "
+            "mean=%.3f p50=%.3f p90=%.3f p99=%.3f max=%.3f\n",
+            i, (int)stem.size, stem.data, stream->latency_count,
+            total_ms / stream->latency_count,
+            iree_replay_benchmark_percentile_ms(stream->latency_count,
+                                                stream->latencies, 50.0),
+            iree_replay_benchmark_percentile_ms(stream->latency_count,
+                                                stream->latencies, 90.0),
+            iree_replay_benchmark_percentile_ms(stream->latency_count,
+                                                stream->latencies, 99.0),
+            stream->latencies[stream->latency_count - 1] / 1e6);
+  }
+  fflush(stdout);
+}
+
+// Benchmark function that replays one or more trace files on concurrent
+// streams. Each iteration replays all calls once on every stream.
+static iree_status_t iree_replay_benchmark_run_streams(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_replay_benchmark_registration_t* registration =
+      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
+  bool separate_contexts = false;
+  if (strcmp(FLAG_trace_stream_contexts, "separate") == 0) {
+    separate_contexts = true;
+  } else if (strcmp(FLAG_trace_stream_contexts, "shared") != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported --trace_stream_contexts= mode '%s'; "
+                            "expected 'shared' or 'separate'",
+                            FLAG_trace_stream_contexts);
+  }
+  iree_host_size_t streams_per_file =
+      (iree_host_size_t)iree_max(1, FLAG_trace_streams);
+  iree_host_size_t stream_count = registration->file_count * streams_per_file;
+  iree_replay_benchmark_stream_t* streams =
+      (iree_replay_benchmark_stream_t*)calloc(stream_count, sizeof(*streams));
+
+  // Load each trace and set up its streams either by loading it again or by
+  // forking the context of the first stream replaying it.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < stream_count && iree_status_is_ok(status);
+       ++i) {
+    iree_replay_benchmark_stream_t* stream = &streams[i];
+    iree_replay_benchmark_stream_t* first_stream =
+        &streams[i - i % streams_per_file];
+    stream->file = &registration->files[i / streams_per_file];
+    iree_replay_benchmark_call_list_initialize(&stream->call_list);
+    if (stream == first_stream || separate_contexts) {
+      status = iree_replay_benchmark_load_file(
+          stream->file, registration->instance, &stream->replay,
+          &stream->call_list);
+      if (iree_status_is_ok(status)) {
+        stream->owns_replay = true;
+        stream->context = stream->replay.context;
+        iree_vm_context_retain(stream->context);
+      }
+    } else {
+      status = iree_replay_benchmark_stream_fork(first_stream, stream);
+    }
+  }
+
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state,
+                                     /*batch_count=*/FLAG_call_iterations)) {
+    status = iree_replay_benchmark_run_streams_once(stream_count, streams);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_replay_benchmark_print_stream_latencies(registration->name,
+                                                 stream_count, streams);
+  }
+
+  // Release in reverse so forks go away before the contexts they came from.
+  for (iree_host_size_t i = stream_count; i > 0; --i) {
+    iree_replay_benchmark_stream_t* stream = &streams[i - 1];
+    iree_replay_benchmark_call_list_deinitialize(&stream->call_list);
+    iree_vm_context_release(stream->context);
+    if (stream->owns_replay) {
+      iree_trace_replay_deinitialize(
+          &stream->replay, FLAG_print_statistics
+                               ? IREE_TRACE_REPLAY_SHUTDOWN_PRINT_STATISTICS
+                               : IREE_TRACE_REPLAY_SHUTDOWN_QUIET);
+    }
+    free(stream->latencies);
+  }
+  free(streams);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Registration
+//===----------------------------------------------------------------------===//
+
+// Registers benchmarks for each trace file or, with --concurrent_traces, a
+// single benchmark replaying all of them concurrently.
 static void iree_replay_benchmark_register_trace_files(
     int file_count, char** file_paths, iree_vm_instance_t* instance) {
+  static iree_replay_benchmark_file_t* files = NULL;
   static iree_replay_benchmark_registration_t* registrations = NULL;
-  if (!registrations) free(registrations);
+  free(files);
+  free(registrations);
+  files = (iree_replay_benchmark_file_t*)malloc(
+      file_count * sizeof(iree_replay_benchmark_file_t));
   registrations = (iree_replay_benchmark_registration_t*)malloc(
       file_count * sizeof(iree_replay_benchmark_registration_t));
 
+  const bool use_streams = FLAG_trace_streams > 1 || FLAG_concurrent_traces;
+  const int registration_count = FLAG_concurrent_traces ? 1 : file_count;
   for (int i = 0; i < file_count; ++i) {
     iree_string_view_t file_path = iree_make_cstring_view(file_paths[i]);
-    registrations[i].root_path = iree_file_path_dirname(file_path);
-    registrations[i].file_path = file_path;
+    files[i].root_path = iree_file_path_dirname(file_path);
+    files[i].file_path = file_path;
+  }
+  for (int i = 0; i < registration_count; ++i) {
+    registrations[i].name =
+        FLAG_concurrent_traces ? iree_make_cstring_view("concurrent_traces")
+                               : iree_file_path_stem(files[i].file_path);
+    registrations[i].file_count = FLAG_concurrent_traces ? file_count : 1;
+    registrations[i].files = &files[i];
     registrations[i].instance = instance;
     registrations[i].benchmark_def = (iree_benchmark_def_t){
         .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
@@ -259,10 +545,11 @@ static void iree_replay_benchmark_register_trace_files(
         .time_unit = IREE_BENCHMARK_UNIT_MILLISECOND,
         .minimum_duration_ns = 0,
         .iteration_count = 0,
-        .run = iree_replay_benchmark_run_file,
+        .run = use_streams ? iree_replay_benchmark_run_streams
+                           : iree_replay_benchmark_run_file,
         .user_data = &registrations[i],
     };
-    iree_benchmark_register(iree_file_path_stem(file_path),
+    iree_benchmark_register(registrations[i].name,
                             &registrations[i].benchmark_def);
   }
 }
@@ -4,22 +4,176 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
-#include "iree/schemas/bytecode_module_def_json_printer.h"
+#include "iree/base/internal/flags.h"
 #include "iree/vm/bytecode_module.h"
 
-// Today we just print to JSON. We could do something more useful (size
-// analysis, etc), but JSON should be enough.
+// NOTE: include order matters:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/bytecode_module_def_reader.h"
+#include "iree/schemas/bytecode_module_def_json_printer.h"
+
+IREE_FLAG(string, output, "json",
+          "Output format: `json` for the full module structure or `cost` for a "
+          "summary of where runtime cost and size will go.");
+
+// Prefix of the module attributes embedded by the compiler with
+// `--iree-scheduling-embed-cost-summary` describing each dispatched export.
+#define IREE_COST_ATTR_PREFIX "iree.cost."
+
+// Prints the cost summaries of dispatched exports embedded by the compiler.
+static void print_dispatch_costs(iree_vm_BytecodeModuleDef_table_t module_def) {
+  fprintf(stdout, "Dispatches:\n");
+  iree_vm_AttrDef_vec_t attrs = iree_vm_BytecodeModuleDef_attrs(module_def);
+  iree_host_size_t prefix_length = strlen(IREE_COST_ATTR_PREFIX);
+  iree_host_size_t dispatch_count = 0;
+  for (size_t i = 0; i < iree_vm_AttrDef_vec_len(attrs); ++i) {
+    iree_vm_AttrDef_table_t attr = iree_vm_AttrDef_vec_at(attrs, i);
+    flatbuffers_string_t key = iree_vm_AttrDef_key(attr);
+    flatbuffers_string_t value = iree_vm_AttrDef_value(attr);
+    if (!key || !value) continue;
+    if (strncmp(key, IREE_COST_ATTR_PREFIX, prefix_length) != 0) continue;
+    fprintf(stdout, "  %s\n    %s\n", key + prefix_length, value);
+    ++dispatch_count;
+  }
+  if (!dispatch_count) {
+    fprintf(stdout,
+            "  (none embedded; compile with "
+            "--iree-scheduling-embed-cost-summary)\n");
+  }
+}
+
+// Prints the sizes of all read-only data segments and their totals.
+static void print_rodata_sizes(iree_vm_BytecodeModuleDef_table_t module_def) {
+  iree_vm_RodataSegmentDef_vec_t segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module_def);
+  size_t segment_count = iree_vm_RodataSegmentDef_vec_len(segments);
+  fprintf(stdout, "Read-only data segments: %zu\n", segment_count);
+  uint64_t embedded_size = 0;
+  uint64_t external_size = 0;
+  uint64_t external_file_size = 0;
+  uint64_t uncompressed_size = 0;
+  for (size_t i = 0; i < segment_count; ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(segments, i);
+    uint64_t stored_size = 0;
+    const char* location = NULL;
+    if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
+      stored_size = flatbuffers_uint8_vec_len(
+          iree_vm_RodataSegmentDef_embedded_data(segment));
+      embedded_size += stored_size;
+      location = "embedded";
+    } else if (iree_vm_RodataSegmentDef_external_file(segment)) {
+      stored_size = iree_vm_RodataSegmentDef_external_data_length(segment);
+      external_file_size += stored_size;
+      location = "external file";
+    } else {
+      stored_size = iree_vm_RodataSegmentDef_external_data_length(segment);
+      external_size += stored_size;
+      location = "external";
+    }
+    iree_vm_CompressionTypeDef_union_t compression_type =
+        iree_vm_RodataSegmentDef_compression_type_union(segment);
+    if (compression_type.type == iree_vm_CompressionTypeDef_ZstdDataDef) {
+      uint64_t length = iree_vm_ZstdDataDef_uncompressed_length(
+          (iree_vm_ZstdDataDef_table_t)compression_type.value);
+      uncompressed_size += length;
+      fprintf(stdout,
+              "  [%4zu] %12" PRIu64 " B %s (zstd, %" PRIu64
+              " B uncompressed)\n",
+              i, stored_size, location, length);
+    } else {
+      uncompressed_size += stored_size;
+      fprintf(stdout, "  [%4zu] %12" PRIu64 " B %s\n", i, stored_size,
+              location);
+    }
+  }
+  fprintf(stdout, "  Embedded:      %12" PRIu64 " B\n", embedded_size);
+  fprintf(stdout, "  External:      %12" PRIu64 " B\n", external_size);
+  fprintf(stdout, "  External file: %12" PRIu64 " B\n", external_file_size);
+  fprintf(stdout, "  Uncompressed:  %12" PRIu64 " B\n", uncompressed_size);
+}
+
+// Prints a summary of the cost of the module: the embedded dispatch cost
+// summaries, exported functions, constant data and module state sizes.
+static void print_cost_summary(iree_const_byte_span_t flatbuffer_contents,
+                               iree_host_size_t file_size) {
+  iree_vm_BytecodeModuleDef_table_t module_def =
+      iree_vm_BytecodeModuleDef_as_root(flatbuffer_contents.data);
+
+  fprintf(stdout, "Module: %s (version %" PRIu32 ")\n",
+          iree_vm_BytecodeModuleDef_name(module_def),
+          iree_vm_BytecodeModuleDef_version(module_def));
+  fprintf(stdout, "  File:          %12" PRIhsz " B\n", file_size);
+  fprintf(stdout, "  FlatBuffer:    %12" PRIhsz " B\n",
+          flatbuffer_contents.data_length);
+  fprintf(stdout, "  Bytecode:      %12zu B\n",
+          flatbuffers_uint8_vec_len(
+              iree_vm_BytecodeModuleDef_bytecode_data(module_def)));
+  fprintf(stdout, "\n");
+
+  iree_vm_ExportFunctionDef_vec_t exports =
+      iree_vm_BytecodeModuleDef_exported_functions(module_def);
+  fprintf(stdout, "Exported functions: %zu\n",
+          iree_vm_ExportFunctionDef_vec_len(exports));
+  for (size_t i = 0; i < iree_vm_ExportFunctionDef_vec_len(exports); ++i) {
+    fprintf(stdout, "  %s\n",
+            iree_vm_ExportFunctionDef_local_name(
+                iree_vm_ExportFunctionDef_vec_at(exports, i)));
+  }
+  fprintf(stdout, "\n");
+
+  print_dispatch_costs(module_def);
+  fprintf(stdout, "\n");
+
+  print_rodata_sizes(module_def);
+  fprintf(stdout, "\n");
+
+  iree_vm_RwdataSegmentDef_vec_t rwdata_segments =
+      iree_vm_BytecodeModuleDef_rwdata_segments(module_def);
+  int64_t rwdata_size = 0;
+  for (size_t i = 0; i < iree_vm_RwdataSegmentDef_vec_len(rwdata_segments);
+       ++i) {
+    rwdata_size += iree_vm_RwdataSegmentDef_byte_size(
+        iree_vm_RwdataSegmentDef_vec_at(rwdata_segments, i));
+  }
+  iree_vm_ModuleStateDef_table_t module_state =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  fprintf(stdout, "Module state:\n");
+  fprintf(stdout, "  Read-write data: %10" PRId64 " B\n", rwdata_size);
+  fprintf(stdout, "  Global bytes:    %10" PRId32 " B\n",
+          module_state
+              ? iree_vm_ModuleStateDef_global_bytes_capacity(module_state)
+              : 0);
+  fprintf(stdout, "  Global refs:     %10" PRId32 "\n",
+          module_state ? iree_vm_ModuleStateDef_global_ref_count(module_state)
+                       : 0);
+}
+
+// By default the whole module is printed as JSON. The cost summary helps
+// review where runtime cost and size go before deploying a model.
 //
 // We could also move all of this into iree-compile (mlir -> vmfb -> json),
 // though having a tiny little tool not reliant on LLVM is nice (can run this
 // on a device).
 int main(int argc, char** argv) {
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
   if (argc < 2) {
-    fprintf(stderr, "Syntax: iree-dump-module module.vmfb > module.json\n");
+    fprintf(stderr,
+            "Syntax: iree-dump-module [--output=json|cost] module.vmfb > "
+            "module.json\n");
+    return 1;
+  }
+  iree_string_view_t output = iree_make_cstring_view(FLAG_output);
+  bool print_cost = iree_string_view_equal(output, IREE_SV("cost"));
+  if (!print_cost && !iree_string_view_equal(output, IREE_SV("json"))) {
+    fprintf(stderr, "Unsupported --output=%s; expected `json` or `cost`\n",
+            FLAG_output);
     return 1;
   }
 
@@ -32,14 +186,19 @@ int main(int argc, char** argv) {
       file_contents->const_buffer, &flatbuffer_contents,
       /*out_rodata_offset=*/NULL));
 
-  // Print direct to stdout.
-  flatcc_json_printer_t printer;
-  flatcc_json_printer_init(&printer, /*fp=*/NULL);
-  flatcc_json_printer_set_skip_default(&printer, true);
-  bytecode_module_def_print_json(&printer,
-                                 (const char*)flatbuffer_contents.data,
-                                 flatbuffer_contents.data_length);
-  flatcc_json_printer_clear(&printer);
+  if (print_cost) {
+    print_cost_summary(flatbuffer_contents,
+                       file_contents->const_buffer.data_length);
+  } else {
+    // Print direct to stdout.
+    flatcc_json_printer_t printer;
+    flatcc_json_printer_init(&printer, /*fp=*/NULL);
+    flatcc_json_printer_set_skip_default(&printer, true);
+    bytecode_module_def_print_json(&printer,
+                                   (const char*)flatbuffer_contents.data,
+                                   flatbuffer_contents.data_length);
+    flatcc_json_printer_clear(&printer);
+  }
 
   iree_file_contents_free(file_contents);
 
@@ -154,6 +154,8 @@ IREE_FLAG_LIST(
     "\n"
     "Numpy npy files from numpy.save can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "safetensors files are mapped to provide 1+ values without copying:\n"
+    "  @some.safetensors\n"
     "\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
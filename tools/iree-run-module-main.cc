@@ -20,6 +20,7 @@
 #include "iree/tooling/comparison.h"
 #include "iree/tooling/context_util.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/startup_profile.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/vm/api.h"
 
@@ -46,6 +47,8 @@ IREE_FLAG_LIST(
     "\n"
     "Numpy npy files from numpy.save can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "safetensors files are mapped to provide 1+ values without copying:\n"
+    "  @some.safetensors\n"
     "\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
@@ -123,36 +126,50 @@ iree_status_t Run(int* out_exit_code) {
 
   IREE_RETURN_IF_ERROR(iree_hal_begin_profiling_from_flags(device.get()));
 
+  // Attribute allocations to the phase that made them when recording.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_set_recording_allocation_label(IREE_SV("inputs")));
   vm::ref<iree_vm_list_t> inputs;
   IREE_RETURN_IF_ERROR(iree_tooling_parse_to_variant_list(
       device_allocator.get(), FLAG_input_list().values, FLAG_input_list().count,
       host_allocator, &inputs));
 
-  // If the function is async add fences so we can invoke it synchronously.
-  vm::ref<iree_hal_fence_t> finish_fence;
-  IREE_RETURN_IF_ERROR(iree_tooling_append_async_fence_inputs(
-      inputs.get(), &function, device.get(), /*wait_fence=*/NULL,
-      &finish_fence));
-
   vm::ref<iree_vm_list_t> outputs;
   IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 16,
                                            host_allocator, &outputs));
 
+  // Invoke and wait for completion. If the function is async fences are added
+  // so we can invoke it synchronously. The invocation is timed as the first
+  // call for the startup profile.
   printf("EXEC @%s\n", function_name.c_str());
+  IREE_RETURN_IF_ERROR(iree_hal_set_recording_allocation_label(
+      iree_string_view_t{function_name.data(), function_name.size()}));
   IREE_RETURN_IF_ERROR(
-      iree_vm_invoke(context.get(), function, IREE_VM_INVOCATION_FLAG_NONE,
-                     /*policy=*/nullptr, inputs.get(), outputs.get(),
-                     host_allocator),
+      iree_tooling_startup_profile_invoke(context.get(), function,
+                                          device.get(), inputs.get(),
+                                          outputs.get(), host_allocator),
       "invoking function '%s'", function_name.c_str());
 
-  // If the function is async we need to wait for it to complete.
-  if (finish_fence) {
-    IREE_RETURN_IF_ERROR(
-        iree_hal_fence_wait(finish_fence.get(), iree_infinite_timeout()));
-  }
-
   IREE_RETURN_IF_ERROR(iree_hal_end_profiling_from_flags(device.get()));
 
+  // Measure steady-state invocations for comparison against the first. Their
+  // results are discarded.
+  if (iree_tooling_startup_profile_requested()) {
+    vm::ref<iree_vm_list_t> steady_outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 16,
+                                             host_allocator, &steady_outputs));
+    iree_host_size_t steady_iteration_count =
+        iree_tooling_startup_profile_steady_iteration_count();
+    for (iree_host_size_t i = 0; i < steady_iteration_count; ++i) {
+      IREE_RETURN_IF_ERROR(
+          iree_tooling_startup_profile_invoke(
+              context.get(), function, device.get(), inputs.get(),
+              steady_outputs.get(), host_allocator),
+          "invoking function '%s'", function_name.c_str());
+      IREE_RETURN_IF_ERROR(iree_vm_list_resize(steady_outputs.get(), 0));
+    }
+  }
+
   if (FLAG_expected_output_list().count == 0) {
     if (FLAG_output_list().count == 0) {
       IREE_RETURN_IF_ERROR(
@@ -188,6 +205,10 @@ iree_status_t Run(int* out_exit_code) {
     *out_exit_code = did_match ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
+  IREE_RETURN_IF_ERROR(iree_tooling_startup_profile_write_from_flags(
+      IREE_SV("iree-run-module"),
+      iree_string_view_t{function_name.data(), function_name.size()}));
+
   // Release resources before gathering statistics.
   inputs.reset();
   outputs.reset();
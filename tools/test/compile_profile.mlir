@@ -0,0 +1,23 @@
+// RUN: iree-compile %s -o %t.vmfb \
+// RUN:     --iree-hal-target-backends=vmvx \
+// RUN:     --iree-compile-profile-file=%t.json && \
+// RUN: FileCheck %s --input-file=%t.json
+
+// CHECK: "total_seconds":
+// CHECK: "peak_memory_bytes":
+// CHECK: "passes": [
+// CHECK: "argument": "iree-hal-translate-executables"
+// CHECK: "executable_passes": [
+// CHECK: "executable_count": 2
+// CHECK: "parallelism":
+// CHECK: "op": "hal.executable"
+
+func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
+  %result = math.absf %input : tensor<f32>
+  return %result : tensor<f32>
+}
+
+func.func @neg(%input : tensor<4xf32>) -> (tensor<4xf32>) {
+  %result = arith.negf %input : tensor<4xf32>
+  return %result : tensor<4xf32>
+}